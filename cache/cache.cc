@@ -66,6 +66,35 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionTypeFlags::kMutable}},
 };
 
+static std::unordered_map<std::string, OptionTypeInfo>
+    persistent_sec_cache_options_type_info = {
+        {"path",
+         {offsetof(struct PersistentSecondaryCacheOptions, path),
+          OptionType::kString, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"capacity",
+         {offsetof(struct PersistentSecondaryCacheOptions, capacity),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"segment_size",
+         {offsetof(struct PersistentSecondaryCacheOptions, segment_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"write_buffer_size",
+         {offsetof(struct PersistentSecondaryCacheOptions, write_buffer_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"estimated_entry_size",
+         {offsetof(struct PersistentSecondaryCacheOptions,
+                   estimated_entry_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"num_io_threads",
+         {offsetof(struct PersistentSecondaryCacheOptions, num_io_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
 namespace {
 static void NoopDelete(Cache::ObjectPtr /*obj*/,
                        MemoryAllocator* /*allocator*/) {
@@ -123,6 +152,18 @@ Status SecondaryCache::CreateFromString(
       result->swap(sec_cache);
     }
     return status;
+  } else if (value.find("persistent_secondary_cache://") == 0) {
+    std::string args = value;
+    args.erase(0, std::strlen("persistent_secondary_cache://"));
+    PersistentSecondaryCacheOptions sec_cache_opts;
+    sec_cache_opts.env = config_options.env;
+    Status status = OptionTypeInfo::ParseStruct(
+        config_options, "", &persistent_sec_cache_options_type_info, "", args,
+        &sec_cache_opts);
+    if (status.ok()) {
+      status = NewPersistentSecondaryCache(sec_cache_opts, result);
+    }
+    return status;
   } else {
     return LoadSharedObject<SecondaryCache>(config_options, value, result);
   }
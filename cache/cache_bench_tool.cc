@@ -7,6 +7,7 @@
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <set>
@@ -16,13 +17,16 @@
 #include "cache/sharded_cache.h"
 #include "db/db_impl/db_impl.h"
 #include "monitoring/histogram.h"
+#include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache_admission_filter.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/secondary_cache.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table_properties.h"
 #include "table/block_based/block_based_table_reader.h"
@@ -52,11 +56,24 @@ DEFINE_int32(
     eviction_effort_cap,
     ROCKSDB_NAMESPACE::HyperClockCacheOptions(1, 1).eviction_effort_cap,
     "HyperClockCacheOptions::eviction_effort_cap");
+DEFINE_uint64(front_cache_entries_per_core, 0,
+              "HyperClockCacheOptions::front_cache_entries_per_core");
+DEFINE_bool(use_huge_pages_for_table, false,
+            "HyperClockCacheOptions::use_huge_pages_for_table");
+DEFINE_bool(bucketized_table, false,
+            "HyperClockCacheOptions::bucketized_table");
 
 DEFINE_double(resident_ratio, 0.25,
               "Ratio of keys fitting in cache to keyspace.");
 DEFINE_uint64(ops_per_thread, 2000000U, "Number of operations per thread.");
 DEFINE_uint32(value_bytes, 8 * KiB, "Size of each value added.");
+DEFINE_double(value_bytes_spread, 0.0,
+              "If greater than 0.0, the size of each value is drawn uniformly "
+              "from value_bytes * (1 +/- value_bytes_spread), like the sizes "
+              "of compressed blocks.");
+DEFINE_double(compressibility, 0.0,
+              "Portion of each value that compresses away, for the "
+              "compressed secondary cache. 0.0 = incompressible.");
 DEFINE_uint32(value_bytes_estimate, 0,
               "If > 0, overrides estimated_entry_charge or "
               "min_avg_entry_charge depending on cache_type.");
@@ -99,6 +116,17 @@ DEFINE_uint32(gather_stats_entries_per_lock, 256,
 
 DEFINE_uint32(usleep, 0, "Sleep up to this many microseconds after each op.");
 
+DEFINE_uint64(scan_period_ops, 0,
+              "If > 0, each thread starts a scan every this many operations: "
+              "lookups and inserts of keys that are never used again, which "
+              "pollute the cache. 0 = no scans.");
+DEFINE_uint64(scan_ops, 1000, "Number of operations of each scan.");
+
+DEFINE_uint32(async_lookup_batch, 0,
+              "If > 1, the lookups are started with StartAsyncLookup and "
+              "waited for with WaitAll in batches of this many. The latency "
+              "of each lookup of a batch is that of the whole batch.");
+
 DEFINE_bool(lean, false,
             "If true, no additional computation is performed besides cache "
             "operations.");
@@ -117,8 +145,29 @@ DEFINE_uint32(seed, 0, "Hashing/random seed to use. 0 = choose at random");
 DEFINE_string(secondary_cache_uri, "",
               "Full URI for creating a custom secondary cache object");
 
+DEFINE_uint64(compressed_secondary_cache_size, 0,
+              "If > 0, the capacity of a CompressedSecondaryCache behind the "
+              "cache. 0 = none.");
+DEFINE_string(compressed_secondary_cache_compression_type, "kLZ4Compression",
+              "The compression of the CompressedSecondaryCache.");
+
+DEFINE_bool(use_tiered_cache, false,
+            "Combine the cache, the compressed secondary cache and the "
+            "secondary cache of --secondary_cache_uri, if any, into a "
+            "tiered cache with NewTieredCache, which distributes "
+            "cache_size + compressed_secondary_cache_size over the first "
+            "two.");
+DEFINE_string(tiered_adm_policy, "auto",
+              "Admission policy of the tiered cache. Allowed values are "
+              "auto, placeholder, allow_cache_hits, and three_queue.");
+
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
+DEFINE_uint32(tiny_lfu_min_frequency, 0,
+              "If > 0, the cache only takes in an entry while it is full if "
+              "a TinyLFU admission filter estimates that the entry was "
+              "accessed at least this many times recently.");
+
 DEFINE_bool(use_jemalloc_no_dump_allocator, false,
             "Whether to use JemallocNoDumpAllocator");
 
@@ -225,6 +274,10 @@ class SharedState {
     return 1.0 * lookup_hits_ / lookup_count_;
   }
 
+  uint64_t GetLookupCount() const { return lookup_count_; }
+
+  uint64_t GetLookupHits() const { return lookup_hits_; }
+
   size_t GetPinnedCount() const { return pinned_count_; }
 
  private:
@@ -247,6 +300,7 @@ struct ThreadState {
   Random64 rnd;
   SharedState* shared;
   HistogramImpl latency_ns_hist;
+  HistogramImpl lookup_latency_ns_hist;
   uint64_t duration_us = 0;
 
   ThreadState(uint32_t index, SharedState* _shared)
@@ -262,7 +316,10 @@ struct KeyGen {
     for (uint32_t i = 0; i < skew; ++i) {
       raw = std::min(raw, rnd.Next());
     }
-    uint64_t key = FastRange64(raw, max_key);
+    return Get(FastRange64(raw, max_key));
+  }
+
+  Slice Get(uint64_t key) {
     if (FLAGS_degenerate_hash_bits) {
       uint64_t key_hash =
           Hash64(reinterpret_cast<const char*>(&key), sizeof(key));
@@ -290,17 +347,40 @@ struct KeyGen {
   }
 };
 
-Cache::ObjectPtr createValue(Random64& rnd, MemoryAllocator* alloc) {
-  char* rv = AllocateBlock(FLAGS_value_bytes, alloc).release();
-  // Fill with some filler data, and take some CPU time
-  for (uint32_t i = 0; i < FLAGS_value_bytes; i += 8) {
+// The size of a value is in its first 8 bytes
+uint32_t ValueBytes(Cache::ObjectPtr value) {
+  return static_cast<uint32_t>(DecodeFixed64(static_cast<char*>(value)));
+}
+
+Cache::ObjectPtr createValue(Random64& rnd, MemoryAllocator* alloc,
+                             size_t* charge) {
+  uint32_t value_bytes = FLAGS_value_bytes;
+  if (FLAGS_value_bytes_spread > 0.0) {
+    double u = (rnd.Next() >> 11) * (1.0 / (uint64_t{1} << 53));
+    double ratio = 1.0 + FLAGS_value_bytes_spread * (2.0 * u - 1.0);
+    value_bytes =
+        std::max(8U, static_cast<uint32_t>(value_bytes * ratio) & ~7U);
+  }
+  char* rv = AllocateBlock(value_bytes, alloc).release();
+  EncodeFixed64(rv, value_bytes);
+  // Fill with some filler data, and take some CPU time, except for the
+  // compressible tail
+  uint32_t compressible_bytes =
+      static_cast<uint32_t>(value_bytes * FLAGS_compressibility);
+  uint32_t filler_bytes = value_bytes - compressible_bytes;
+  uint32_t i = 8;
+  for (; i < filler_bytes; i += 8) {
     EncodeFixed64(rv + i, rnd.Next());
   }
+  if (i < value_bytes) {
+    memset(rv + i, 0, value_bytes - i);
+  }
+  *charge = value_bytes;
   return rv;
 }
 
 // Callbacks for secondary cache
-size_t SizeFn(Cache::ObjectPtr /*obj*/) { return FLAGS_value_bytes; }
+size_t SizeFn(Cache::ObjectPtr obj) { return ValueBytes(obj); }
 
 Status SaveToFn(Cache::ObjectPtr from_obj, size_t /*from_offset*/,
                 size_t length, char* out) {
@@ -332,23 +412,108 @@ Cache::CacheItemHelper helper3_wos(CacheEntryRole::kFilterBlock, DeleteFn);
 Cache::CacheItemHelper helper3(CacheEntryRole::kFilterBlock, DeleteFn, SizeFn,
                                SaveToFn, CreateFn, &helper3_wos);
 
+bool HasSecondaryCache() {
+  return !FLAGS_secondary_cache_uri.empty() ||
+         FLAGS_compressed_secondary_cache_size > 0;
+}
+
+std::shared_ptr<SecondaryCache> NewSecondaryCacheFromUri() {
+  if (FLAGS_secondary_cache_uri.empty()) {
+    return nullptr;
+  }
+  std::shared_ptr<SecondaryCache> secondary_cache;
+  Status s = SecondaryCache::CreateFromString(
+      ConfigOptions(), FLAGS_secondary_cache_uri, &secondary_cache);
+  if (secondary_cache == nullptr) {
+    fprintf(stderr,
+            "No secondary cache registered matching string: %s status=%s\n",
+            FLAGS_secondary_cache_uri.c_str(), s.ToString().c_str());
+    exit(1);
+  }
+  return secondary_cache;
+}
+
+CompressedSecondaryCacheOptions GetCompressedSecondaryCacheOptions() {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = FLAGS_compressed_secondary_cache_size;
+  auto it = compression_type_string_map.find(
+      FLAGS_compressed_secondary_cache_compression_type);
+  if (it == compression_type_string_map.end()) {
+    fprintf(stderr, "Unknown compression type %s\n",
+            FLAGS_compressed_secondary_cache_compression_type.c_str());
+    exit(1);
+  }
+  opts.compression_type = it->second;
+  return opts;
+}
+
+TieredAdmissionPolicy GetTieredAdmissionPolicy() {
+  if (FLAGS_tiered_adm_policy == "auto") {
+    return kAdmPolicyAuto;
+  } else if (FLAGS_tiered_adm_policy == "placeholder") {
+    return kAdmPolicyPlaceholder;
+  } else if (FLAGS_tiered_adm_policy == "allow_cache_hits") {
+    return kAdmPolicyAllowCacheHits;
+  } else if (FLAGS_tiered_adm_policy == "three_queue") {
+    return kAdmPolicyThreeQueue;
+  }
+  fprintf(stderr, "Cannot parse admission policy %s\n",
+          FLAGS_tiered_adm_policy.c_str());
+  exit(1);
+}
+
 void ConfigureSecondaryCache(ShardedCacheOptions& opts) {
+  if (!FLAGS_secondary_cache_uri.empty() &&
+      FLAGS_compressed_secondary_cache_size > 0) {
+    fprintf(stderr,
+            "Cannot specify both --secondary_cache_uri and "
+            "--compressed_secondary_cache_size without "
+            "--use_tiered_cache\n");
+    exit(1);
+  }
   if (!FLAGS_secondary_cache_uri.empty()) {
-    std::shared_ptr<SecondaryCache> secondary_cache;
-    Status s = SecondaryCache::CreateFromString(
-        ConfigOptions(), FLAGS_secondary_cache_uri, &secondary_cache);
-    if (secondary_cache == nullptr) {
-      fprintf(stderr,
-              "No secondary cache registered matching string: %s status=%s\n",
-              FLAGS_secondary_cache_uri.c_str(), s.ToString().c_str());
-      exit(1);
-    }
-    opts.secondary_cache = secondary_cache;
+    opts.secondary_cache = NewSecondaryCacheFromUri();
+  } else if (FLAGS_compressed_secondary_cache_size > 0) {
+    opts.secondary_cache =
+        NewCompressedSecondaryCache(GetCompressedSecondaryCacheOptions());
   }
 }
 
+void ConfigureAdmissionFilter(ShardedCacheOptions& opts) {
+  if (FLAGS_tiny_lfu_min_frequency > 0) {
+    opts.admission_filter = NewTinyLfuAdmissionFilter(
+        static_cast<size_t>(FLAGS_cache_size / FLAGS_value_bytes),
+        FLAGS_tiny_lfu_min_frequency);
+  }
+}
+
+template <typename Options>
+std::shared_ptr<Cache> MakeCache(Options& opts, PrimaryCacheType type) {
+  ConfigureAdmissionFilter(opts);
+  if (!FLAGS_use_tiered_cache) {
+    ConfigureSecondaryCache(opts);
+    return opts.MakeSharedCache();
+  }
+  TieredCacheOptions tiered_opts;
+  tiered_opts.cache_opts = &opts;
+  tiered_opts.cache_type = type;
+  tiered_opts.adm_policy = GetTieredAdmissionPolicy();
+  tiered_opts.comp_cache_opts = GetCompressedSecondaryCacheOptions();
+  tiered_opts.total_capacity =
+      opts.capacity + FLAGS_compressed_secondary_cache_size;
+  tiered_opts.compressed_secondary_ratio =
+      1.0 * FLAGS_compressed_secondary_cache_size / tiered_opts.total_capacity;
+  tiered_opts.nvm_sec_cache = NewSecondaryCacheFromUri();
+  auto cache = NewTieredCache(tiered_opts);
+  if (cache == nullptr) {
+    fprintf(stderr, "Invalid tiered cache options.\n");
+    exit(1);
+  }
+  return cache;
+}
+
 ShardedCacheBase* AsShardedCache(Cache* c) {
-  if (!FLAGS_secondary_cache_uri.empty()) {
+  if (HasSecondaryCache()) {
     c = static_cast_with_check<CacheWrapper>(c)->GetTarget().get();
   }
   return static_cast_with_check<ShardedCacheBase>(c);
@@ -396,6 +561,10 @@ class CacheBench {
       opts.hash_seed = BitwiseAnd(FLAGS_seed, INT32_MAX);
       opts.memory_allocator = allocator;
       opts.eviction_effort_cap = FLAGS_eviction_effort_cap;
+      opts.front_cache_entries_per_core =
+          static_cast<size_t>(FLAGS_front_cache_entries_per_core);
+      opts.use_huge_pages_for_table = FLAGS_use_huge_pages_for_table;
+      opts.bucketized_table = FLAGS_bucketized_table;
       if (FLAGS_cache_type == "fixed_hyper_clock_cache" ||
           FLAGS_cache_type == "hyper_clock_cache") {
         opts.estimated_entry_charge = FLAGS_value_bytes_estimate > 0
@@ -409,20 +578,22 @@ class CacheBench {
         fprintf(stderr, "Cache type not supported.\n");
         exit(1);
       }
-      ConfigureSecondaryCache(opts);
-      cache_ = opts.MakeSharedCache();
+      cache_ = MakeCache(opts, PrimaryCacheType::kCacheTypeHCC);
     } else if (FLAGS_cache_type == "lru_cache") {
       LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
                            false /* strict_capacity_limit */,
                            0.5 /* high_pri_pool_ratio */);
       opts.hash_seed = BitwiseAnd(FLAGS_seed, INT32_MAX);
       opts.memory_allocator = allocator;
-      ConfigureSecondaryCache(opts);
-      cache_ = NewLRUCache(opts);
+      cache_ = MakeCache(opts, PrimaryCacheType::kCacheTypeLRU);
     } else {
       fprintf(stderr, "Cache type not supported.\n");
       exit(1);
     }
+    if (HasSecondaryCache()) {
+      // For the hits of each tier
+      statistics_ = CreateDBStatistics();
+    }
   }
 
   ~CacheBench() = default;
@@ -449,13 +620,19 @@ class CacheBench {
       }
       keys_since_last_not_found = 0;
 
-      Status s =
-          cache_->Insert(key, createValue(rnd, cache_->memory_allocator()),
-                         &helper1, FLAGS_value_bytes);
+      size_t charge;
+      Cache::ObjectPtr value =
+          createValue(rnd, cache_->memory_allocator(), &charge);
+      Status s = cache_->Insert(key, value, &helper1, charge);
       assert(s.ok());
 
       handle = cache_->Lookup(key);
       if (!handle) {
+        if (FLAGS_tiny_lfu_min_frequency > 0) {
+          // Not admitted into the full cache
+          ++inserts_since_max_occ_increase;
+          continue;
+        }
         fprintf(stderr, "Failed to lookup key just inserted.\n");
         assert(false);
         exit(42);
@@ -532,6 +709,20 @@ class CacheBench {
     printf("Thread ops/sec = %u\n", ops_per_sec);
 
     printf("Lookup hit ratio: %g\n", shared.GetLookupHitRatio());
+    if (statistics_) {
+      const double lookups = static_cast<double>(shared.GetLookupCount());
+      uint64_t secondary_hits =
+          statistics_->getTickerCount(SECONDARY_CACHE_HITS);
+      uint64_t compressed_hits = std::min(
+          statistics_->getTickerCount(COMPRESSED_SECONDARY_CACHE_HITS),
+          secondary_hits);
+      printf("Primary hit ratio: %g\n",
+             (shared.GetLookupHits() - secondary_hits) / lookups);
+      printf("Compressed secondary hit ratio: %g\n",
+             compressed_hits / lookups);
+      printf("Other secondary hit ratio: %g\n",
+             (secondary_hits - compressed_hits) / lookups);
+    }
 
     size_t occ = cache_->GetOccupancyCount();
     size_t slot = cache_->GetTableAddressCount();
@@ -547,6 +738,13 @@ class CacheBench {
       }
       printf("%s", combined.ToString().c_str());
 
+      printf("\nLookup latency (ns):\n");
+      HistogramImpl combined_lookups;
+      for (uint32_t i = 0; i < FLAGS_threads; i++) {
+        combined_lookups.Merge(threads[i]->lookup_latency_ns_hist);
+      }
+      printf("%s", combined_lookups.ToString().c_str());
+
       if (FLAGS_gather_stats) {
         printf("\nGather stats latency (us):\n");
         printf("%s", stats_hist.ToString().c_str());
@@ -566,6 +764,7 @@ class CacheBench {
 
  private:
   std::shared_ptr<Cache> cache_;
+  std::shared_ptr<Statistics> statistics_;
   const uint64_t max_key_;
   // Cumulative thresholds in the space of a random uint64_t
   const uint64_t lookup_insert_threshold_;
@@ -698,10 +897,92 @@ class CacheBench {
     StopWatchNano timer(clock);
     auto system_clock = SystemClock::Default();
     size_t steps_to_next_capacity_change = 0;
+    // The keys of the scans, past the keys of the workload
+    uint64_t next_scan_key = max_key_ + (uint64_t{thread->tid} << 40);
+
+    // The lookups started and not waited for yet
+    const uint32_t batch_size =
+        FLAGS_async_lookup_batch > 1 ? FLAGS_async_lookup_batch : 0;
+    std::unique_ptr<Cache::AsyncLookupHandle[]> async_handles(
+        new Cache::AsyncLookupHandle[batch_size]);
+    std::vector<std::string> async_keys(batch_size);
+    std::vector<bool> async_insert_on_miss(batch_size);
+    uint32_t async_count = 0;
+    StopWatchNano batch_timer(clock);
+
+    auto use_hit = [&](Cache::Handle* handle) {
+      ++lookup_hits;
+      if (!FLAGS_lean) {
+        // do something with the data
+        auto* value = cache_->Value(handle);
+        result += NPHash64(static_cast<char*>(value), ValueBytes(value));
+      }
+      pinned.push_back(handle);
+    };
+    auto insert = [&](const Slice& key, const Cache::CacheItemHelper* helper,
+                      Cache::Handle** handle) {
+      size_t charge;
+      Cache::ObjectPtr value =
+          createValue(thread->rnd, cache_->memory_allocator(), &charge);
+      Status s = cache_->Insert(key, value, helper, charge, handle);
+      assert(s.ok());
+    };
+    auto wait_async_lookups = [&]() {
+      cache_->WaitAll(async_handles.get(), async_count);
+      for (uint32_t j = 0; j < async_count; j++) {
+        Cache::Handle* handle = async_handles[j].Result();
+        if (handle) {
+          use_hit(handle);
+        } else {
+          ++lookup_misses;
+          if (async_insert_on_miss[j]) {
+            insert(async_handles[j].key, &helper2, &pinned.emplace_back());
+          }
+        }
+      }
+      if (FLAGS_histograms) {
+        uint64_t ns = batch_timer.ElapsedNanos();
+        for (uint32_t j = 0; j < async_count; j++) {
+          thread->latency_ns_hist.Add(ns);
+          thread->lookup_latency_ns_hist.Add(ns);
+        }
+      }
+      async_count = 0;
+    };
+    auto lookup = [&](const Slice& key, bool insert_on_miss) {
+      if (batch_size == 0) {
+        auto handle = cache_->Lookup(key, &helper2, /*context*/ nullptr,
+                                     Cache::Priority::LOW, statistics_.get());
+        if (handle) {
+          use_hit(handle);
+        } else {
+          ++lookup_misses;
+          if (insert_on_miss) {
+            insert(key, &helper2, &pinned.emplace_back());
+          }
+        }
+        return;
+      }
+      if (async_count == 0) {
+        batch_timer.Start();
+      }
+      auto& async_handle = async_handles[async_count];
+      async_keys[async_count].assign(key.data(), key.size());
+      async_handle.key = async_keys[async_count];
+      async_handle.helper = &helper2;
+      async_handle.stats = statistics_.get();
+      async_insert_on_miss[async_count] = insert_on_miss;
+      cache_->StartAsyncLookup(async_handle);
+      if (++async_count == batch_size) {
+        wait_async_lookups();
+      }
+    };
 
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       Slice key = gen.GetRand(thread->rnd, max_key_, FLAGS_skew);
       uint64_t random_op = thread->rnd.Next();
+      const bool in_scan = FLAGS_scan_period_ops > 0 &&
+                           i % FLAGS_scan_period_ops < FLAGS_scan_ops;
 
       if (FLAGS_vary_capacity_ratio > 0.0 && thread->tid == 0) {
         if (steps_to_next_capacity_change == 0) {
@@ -719,54 +1000,33 @@ class CacheBench {
       if (FLAGS_histograms) {
         timer.Start();
       }
+      // Whether the latency is that of a lookup, when it is timed here
+      bool is_lookup = false;
 
-      if (random_op < lookup_insert_threshold_) {
-        // do lookup
+      if (in_scan) {
+        // read a block once, and fill the cache with it
+        key = gen.Get(next_scan_key++);
         auto handle = cache_->Lookup(key, &helper2, /*context*/ nullptr,
                                      Cache::Priority::LOW);
         if (handle) {
-          ++lookup_hits;
-          if (!FLAGS_lean) {
-            // do something with the data
-            result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                               FLAGS_value_bytes);
-          }
-          pinned.push_back(handle);
+          cache_->Release(handle);
         } else {
-          ++lookup_misses;
-          // do insert
-          Status s = cache_->Insert(
-              key, createValue(thread->rnd, cache_->memory_allocator()),
-              &helper2, FLAGS_value_bytes, &pinned.emplace_back());
-          assert(s.ok());
+          insert(key, &helper2, nullptr);
         }
+      } else if (random_op < lookup_insert_threshold_) {
+        // do lookup, and insert on not found
+        lookup(key, /*insert_on_miss=*/true);
+        is_lookup = true;
       } else if (random_op < insert_threshold_) {
         // do insert
-        Status s = cache_->Insert(
-            key, createValue(thread->rnd, cache_->memory_allocator()), &helper3,
-            FLAGS_value_bytes, &pinned.emplace_back());
-        assert(s.ok());
+        insert(key, &helper3, &pinned.emplace_back());
       } else if (random_op < blind_insert_threshold_) {
         // insert without keeping a handle
-        Status s = cache_->Insert(
-            key, createValue(thread->rnd, cache_->memory_allocator()), &helper3,
-            FLAGS_value_bytes);
-        assert(s.ok());
+        insert(key, &helper3, nullptr);
       } else if (random_op < lookup_threshold_) {
         // do lookup
-        auto handle = cache_->Lookup(key, &helper2, /*context*/ nullptr,
-                                     Cache::Priority::LOW);
-        if (handle) {
-          ++lookup_hits;
-          if (!FLAGS_lean) {
-            // do something with the data
-            result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                               FLAGS_value_bytes);
-          }
-          pinned.push_back(handle);
-        } else {
-          ++lookup_misses;
-        }
+        lookup(key, /*insert_on_miss=*/false);
+        is_lookup = true;
       } else if (random_op < erase_threshold_) {
         // do erase
         cache_->Erase(key);
@@ -774,8 +1034,12 @@ class CacheBench {
         // Should be extremely unlikely (noop)
         assert(random_op >= kHundredthUint64 * 100U);
       }
-      if (FLAGS_histograms) {
-        thread->latency_ns_hist.Add(timer.ElapsedNanos());
+      if (FLAGS_histograms && !(is_lookup && batch_size > 0)) {
+        uint64_t ns = timer.ElapsedNanos();
+        thread->latency_ns_hist.Add(ns);
+        if (is_lookup) {
+          thread->lookup_latency_ns_hist.Add(ns);
+        }
       }
       if (FLAGS_usleep > 0) {
         unsigned us =
@@ -789,6 +1053,9 @@ class CacheBench {
         pinned.pop_front();
       }
     }
+    if (async_count > 0) {
+      wait_async_lookups();
+    }
     if (FLAGS_early_exit) {
       MutexLock l(thread->shared->GetMutex());
       exit(0);
@@ -832,6 +1099,19 @@ class CacheBench {
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %u%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %u%%\n", FLAGS_erase_percent);
+    printf("TinyLFU min freq    : %u\n", FLAGS_tiny_lfu_min_frequency);
+    printf("Value bytes spread  : %g\n", FLAGS_value_bytes_spread);
+    printf("Compressibility     : %g\n", FLAGS_compressibility);
+    printf("Compressed sec cache: %s\n",
+           BytesToHumanString(FLAGS_compressed_secondary_cache_size).c_str());
+    printf("Secondary cache uri : %s\n", FLAGS_secondary_cache_uri.c_str());
+    printf("Tiered cache        : %s\n",
+           FLAGS_use_tiered_cache ? FLAGS_tiered_adm_policy.c_str()
+                                  : "disabled");
+    printf("Scans               : %" PRIu64 " ops every %" PRIu64 " ops\n",
+           FLAGS_scan_period_ops > 0 ? FLAGS_scan_ops : 0,
+           FLAGS_scan_period_ops);
+    printf("Async lookup batch  : %u\n", FLAGS_async_lookup_batch);
     std::ostringstream stats;
     if (FLAGS_gather_stats) {
       stats << "enabled (" << FLAGS_gather_stats_sleep_ms << "ms, "
@@ -18,6 +18,7 @@
 #include "cache/lru_cache.h"
 #include "cache/typed_cache.h"
 #include "port/stack_trace.h"
+#include "rocksdb/cache_admission_filter.h"
 #include "test_util/secondary_cache_test_util.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
@@ -808,6 +809,55 @@ TEST_P(CacheTest, OverCapacity) {
   }
 }
 
+TEST_P(CacheTest, AdmissionFilter) {
+  const int n = 10;
+  std::shared_ptr<Cache> cache = NewCache(n, [](ShardedCacheOptions& opts) {
+    opts.num_shard_bits = 0;
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    // Oversized, for false positives to be unlikely
+    opts.admission_filter =
+        NewTinyLfuAdmissionFilter(/*expected_entries=*/1024);
+  });
+
+  // All entries are admitted while there is room
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(-1, Lookup(cache, i));
+    Insert(cache, i, 1000 + i);
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(1000 + i, Lookup(cache, i));
+  }
+  ASSERT_EQ(n, cache->GetUsage());
+
+  // A scan of keys read once does not evict any of them
+  for (int i = 100; i < 200; i++) {
+    ASSERT_EQ(-1, Lookup(cache, i));
+    Insert(cache, i, 1000 + i);
+  }
+  ASSERT_EQ(100U, deleted_values_.size());
+  ASSERT_EQ(1100, deleted_values_.front());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(1000 + i, Lookup(cache, i));
+  }
+
+  // A rejected entry is still usable through the handle of the insertion
+  Cache::Handle* handle = nullptr;
+  ASSERT_EQ(-1, Lookup(cache, 200));
+  ASSERT_OK(cache->Insert(EncodeKey(200), EncodeValue(1200), &kHelper,
+                          /*charge=*/1, &handle));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(1200, DecodeValue(cache->Value(handle)));
+  cache->Release(handle);
+  ASSERT_EQ(1200, deleted_values_.back());
+  ASSERT_EQ(-1, Lookup(cache, 200));
+
+  // An entry read again is admitted
+  ASSERT_EQ(-1, Lookup(cache, 100));
+  Insert(cache, 100, 2100);
+  ASSERT_EQ(2100, Lookup(cache, 100));
+  ASSERT_GE(n, cache->GetUsage());
+}
+
 TEST_P(CacheTest, ApplyToAllEntriesTest) {
   std::vector<std::string> callback_state;
   const auto callback = [&](const Slice& key, Cache::ObjectPtr value,
@@ -717,6 +717,31 @@ void BaseClockTable::TEST_ReleaseNMinus1(ClockHandle* h, size_t n) {
 }
 #endif
 
+namespace {
+// Returns a mapping of at least bytes backed by huge pages, or an empty
+// mapping if none can be had
+MemMapping MapHugePages(size_t bytes) {
+  constexpr size_t kHugePageSize = size_t{2} << 20;
+  bytes = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  if (MemMapping::kHugePageSupported) {
+    // Reserved huge pages
+    MemMapping mapping = MemMapping::AllocateHuge(bytes);
+    if (mapping.Get() != nullptr) {
+      return mapping;
+    }
+  }
+#ifdef MADV_HUGEPAGE
+  // Transparent huge pages
+  MemMapping mapping = MemMapping::AllocateLazyZeroed(bytes);
+  if (mapping.Get() != nullptr &&
+      madvise(mapping.Get(), mapping.Length(), MADV_HUGEPAGE) == 0) {
+    return mapping;
+  }
+#endif  // MADV_HUGEPAGE
+  return MemMapping::AllocateLazyZeroed(0);
+}
+}  // namespace
+
 FixedHyperClockTable::FixedHyperClockTable(
     size_t capacity, CacheMetadataChargePolicy metadata_charge_policy,
     MemoryAllocator* allocator,
@@ -729,7 +754,26 @@ FixedHyperClockTable::FixedHyperClockTable(
       length_bits_mask_((size_t{1} << length_bits_) - 1),
       occupancy_limit_(static_cast<size_t>((uint64_t{1} << length_bits_) *
                                            kStrictLoadFactor)),
-      array_(new HandleImpl[size_t{1} << length_bits_]) {
+      probe_group_bits_(opts.bucketized
+                            ? std::min(kProbeGroupBits, length_bits_)
+                            : 0),
+      probe_group_mask_((size_t{1} << probe_group_bits_) - 1),
+      huge_page_mapping_(
+          opts.use_huge_pages
+              ? MapHugePages(sizeof(HandleImpl) << length_bits_)
+              : MemMapping::AllocateLazyZeroed(0)),
+      heap_array_(huge_page_mapping_.Get() != nullptr
+                      ? nullptr
+                      : new HandleImpl[size_t{1} << length_bits_]),
+      array_(huge_page_mapping_.Get() != nullptr
+                 ? static_cast<HandleImpl*>(huge_page_mapping_.Get())
+                 : heap_array_.get()) {
+  if (huge_page_mapping_.Get() != nullptr) {
+    // Mappings are page aligned, thus cache line aligned
+    for (size_t i = 0; i < GetTableSize(); i++) {
+      new (&array_[i]) HandleImpl();
+    }
+  }
   if (metadata_charge_policy ==
       CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
     usage_.FetchAddRelaxed(size_t{GetTableSize()} * sizeof(HandleImpl));
@@ -830,6 +874,15 @@ FixedHyperClockTable::HandleImpl* FixedHyperClockTable::DoInsert(
 
 FixedHyperClockTable::HandleImpl* FixedHyperClockTable::Lookup(
     const UniqueId64x2& hashed_key) {
+  if (IsBucketized()) {
+    // Most lookups end in the group of their first slot, so have all of its
+    // cache lines on their way at once
+    HandleImpl* group =
+        &array_[ModTableSize(hashed_key[1]) & ~probe_group_mask_];
+    for (size_t i = 0; i <= probe_group_mask_; i++) {
+      PREFETCH(&group[i], 0 /* rw */, 3 /* locality */);
+    }
+  }
   HandleImpl* e = FindSlot(
       hashed_key,
       [&](HandleImpl* h) {
@@ -1069,9 +1122,10 @@ inline FixedHyperClockTable::HandleImpl* FixedHyperClockTable::FindSlot(
   // We use an odd increment, which is relatively prime with the power-of-two
   // table size. This implies that we cycle back to the first probe only
   // after probing every slot exactly once.
-  // TODO: we could also reconsider linear probing, though locality benefits
-  // are limited because each slot is a full cache line
-  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
+  // When bucketized, the same goes for groups of slots instead of slots,
+  // each group being probed in full, from the offset of the first slot on
+  // (see NextProbe).
+  size_t increment = ProbeIncrement(hashed_key);
   size_t first = ModTableSize(base);
   size_t current = first;
   bool is_last;
@@ -1083,7 +1137,7 @@ inline FixedHyperClockTable::HandleImpl* FixedHyperClockTable::FindSlot(
     if (abort_fn(h)) {
       return nullptr;
     }
-    current = ModTableSize(current + increment);
+    current = NextProbe(current, first, increment);
     is_last = current == first;
     update_fn(h, is_last);
   } while (!is_last);
@@ -1093,11 +1147,12 @@ inline FixedHyperClockTable::HandleImpl* FixedHyperClockTable::FindSlot(
 
 inline void FixedHyperClockTable::Rollback(const UniqueId64x2& hashed_key,
                                            const HandleImpl* h) {
-  size_t current = ModTableSize(hashed_key[1]);
-  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
+  size_t first = ModTableSize(hashed_key[1]);
+  size_t increment = ProbeIncrement(hashed_key);
+  size_t current = first;
   while (&array_[current] != h) {
     array_[current].displacements.FetchSubRelaxed(1);
-    current = ModTableSize(current + increment);
+    current = NextProbe(current, first, increment);
   }
 }
 
@@ -1424,24 +1479,183 @@ BaseHyperClockCache<Table>::BaseHyperClockCache(
                    opts.metadata_charge_policy, alloc,
                    &this->eviction_callback_, &this->hash_seed_, table_opts);
   });
+  if (opts.front_cache_entries_per_core > 0) {
+    // At least two slots, so that each core's slots fill whole cache lines
+    size_t per_core = 2;
+    while (per_core < opts.front_cache_entries_per_core) {
+      per_core <<= 1;
+    }
+    front_.reset(new CoreLocalArray<FrontSlot*>());
+    front_slot_count_ = per_core * front_->Size();
+    front_slot_mask_ = per_core - 1;
+    front_slots_ = static_cast<FrontSlot*>(
+        port::cacheline_aligned_alloc(sizeof(FrontSlot) * front_slot_count_));
+    for (size_t i = 0; i < front_slot_count_; ++i) {
+      new (front_slots_ + i) FrontSlot();
+    }
+    for (size_t core = 0; core < front_->Size(); ++core) {
+      *front_->AccessAtCore(core) = front_slots_ + core * per_core;
+    }
+  }
+}
+
+template <class Table>
+BaseHyperClockCache<Table>::~BaseHyperClockCache() {
+  if (front_slots_ != nullptr) {
+    for (size_t i = 0; i < front_slot_count_; ++i) {
+      // All handles must have been released before destroying the cache
+      assert(front_slots_[i].state.LoadRelaxed() == 0);
+      ReplaceFrontEntry(front_slots_[i], nullptr,
+                        /*erase_if_last_ref=*/false);
+      front_slots_[i].~FrontSlot();
+    }
+    port::cacheline_aligned_free(front_slots_);
+  }
+}
+
+template <class Table>
+typename BaseHyperClockCache<Table>::FrontSlot*
+BaseHyperClockCache<Table>::AsFrontSlot(Handle* handle) const {
+  auto addr = reinterpret_cast<uintptr_t>(handle);
+  auto begin = reinterpret_cast<uintptr_t>(front_slots_);
+  if (addr >= begin && addr < begin + sizeof(FrontSlot) * front_slot_count_) {
+    return static_cast<FrontSlot*>(handle);
+  }
+  return nullptr;
+}
+
+template <class Table>
+const typename Table::HandleImpl* BaseHyperClockCache<Table>::GetEntry(
+    Handle* handle) const {
+  FrontSlot* slot = AsFrontSlot(handle);
+  if (slot != nullptr) {
+    return slot->entry.LoadRelaxed();
+  }
+  return static_cast<const HandleImpl*>(handle);
+}
+
+template <class Table>
+bool BaseHyperClockCache<Table>::ReplaceFrontEntry(FrontSlot& slot,
+                                                   HandleImpl* entry,
+                                                   bool erase_if_last_ref) {
+  uint64_t expected = 0;
+  if (!slot.state.CasStrong(expected, kFrontSlotLocked)) {
+    // In use
+    return false;
+  }
+  HandleImpl* old_entry = slot.entry.LoadRelaxed();
+  if (entry != nullptr) {
+    this->GetShard(entry->GetHash()).Ref(entry);
+  }
+  slot.entry.StoreRelaxed(entry);
+  slot.misses.StoreRelaxed(0);
+  slot.state.Store(0);
+  if (old_entry == nullptr) {
+    return false;
+  }
+  return this->GetShard(old_entry->GetHash())
+      .Release(old_entry, /*useful=*/true, erase_if_last_ref);
+}
+
+template <class Table>
+Cache::Handle* BaseHyperClockCache<Table>::Lookup(
+    const Slice& key, const CacheItemHelper* helper,
+    Cache::CreateContext* create_context, Cache::Priority priority,
+    Statistics* stats) {
+  if (!front_ || UNLIKELY(key.size() != kCacheKeySize)) {
+    return ShardedCache<Shard>::Lookup(key, helper, create_context, priority,
+                                       stats);
+  }
+  if (this->admission_filter_) {
+    this->admission_filter_->RecordAccess(key);
+  }
+  UniqueId64x2 hashed_key = Shard::ComputeHash(key, this->hash_seed_);
+  FrontSlot& slot = (*front_->Access())[static_cast<size_t>(hashed_key[1]) &
+                                         front_slot_mask_];
+
+  bool stale = false;
+  uint64_t old_state = slot.state.FetchAdd(1);
+  if ((old_state & kFrontSlotLocked) == 0) {
+    HandleImpl* entry = slot.entry.LoadRelaxed();
+    if (entry != nullptr) {
+      // An erased entry stays referenced until replaced, but must not be
+      // found
+      stale = (entry->meta.LoadRelaxed() >> ClockHandle::kStateShift) !=
+              ClockHandle::kStateVisible;
+      if (!stale && entry->hashed_key == hashed_key) {
+        return &slot;
+      }
+    }
+  }
+  slot.state.FetchSub(1);
+
+  HandleImpl* result = this->GetShard(hashed_key)
+                           .Lookup(key, hashed_key, helper, create_context,
+                                   priority, stats);
+  if (result != nullptr) {
+    if (stale || slot.entry.LoadRelaxed() == nullptr ||
+        slot.misses.FetchAddRelaxed(1) + 1 >= kFrontSlotReplaceMisses) {
+      ReplaceFrontEntry(slot, result, /*erase_if_last_ref=*/false);
+    }
+  } else if (stale) {
+    ReplaceFrontEntry(slot, nullptr, /*erase_if_last_ref=*/false);
+  }
+  return result;
+}
+
+template <class Table>
+bool BaseHyperClockCache<Table>::Ref(Handle* handle) {
+  FrontSlot* slot = AsFrontSlot(handle);
+  if (slot != nullptr) {
+    slot->state.FetchAdd(1);
+    return true;
+  }
+  return ShardedCache<Shard>::Ref(handle);
+}
+
+template <class Table>
+bool BaseHyperClockCache<Table>::Release(Handle* handle, bool useful,
+                                         bool erase_if_last_ref) {
+  FrontSlot* slot = AsFrontSlot(handle);
+  if (slot != nullptr) {
+    slot->state.FetchSub(1);
+    if (erase_if_last_ref) {
+      // Give up the slot's reference too, so that the entry can go
+      return ReplaceFrontEntry(*slot, nullptr, /*erase_if_last_ref=*/true);
+    }
+    return false;
+  }
+  return ShardedCache<Shard>::Release(handle, useful, erase_if_last_ref);
+}
+
+template <class Table>
+bool BaseHyperClockCache<Table>::Release(Handle* handle,
+                                         bool erase_if_last_ref) {
+  return Release(handle, /*useful=*/true, erase_if_last_ref);
+}
+
+template <class Table>
+void BaseHyperClockCache<Table>::EraseUnRefEntries() {
+  for (size_t i = 0; i < front_slot_count_; ++i) {
+    ReplaceFrontEntry(front_slots_[i], nullptr, /*erase_if_last_ref=*/false);
+  }
+  ShardedCache<Shard>::EraseUnRefEntries();
 }
 
 template <class Table>
 Cache::ObjectPtr BaseHyperClockCache<Table>::Value(Handle* handle) {
-  return static_cast<const typename Table::HandleImpl*>(handle)->value;
+  return GetEntry(handle)->value;
 }
 
 template <class Table>
 size_t BaseHyperClockCache<Table>::GetCharge(Handle* handle) const {
-  return static_cast<const typename Table::HandleImpl*>(handle)
-      ->GetTotalCharge();
+  return GetEntry(handle)->GetTotalCharge();
 }
 
 template <class Table>
 const Cache::CacheItemHelper* BaseHyperClockCache<Table>::GetCacheItemHelper(
     Handle* handle) const {
-  auto h = static_cast<const typename Table::HandleImpl*>(handle);
-  return h->helper;
+  return GetEntry(handle)->helper;
 }
 
 namespace {
@@ -27,6 +27,7 @@
 #include "rocksdb/secondary_cache.h"
 #include "util/atomic.h"
 #include "util/autovector.h"
+#include "util/core_local.h"
 #include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -547,8 +548,14 @@ class FixedHyperClockTable : public BaseClockTable {
         : BaseOpts(opts.eviction_effort_cap) {
       assert(opts.estimated_entry_charge > 0);
       estimated_value_size = opts.estimated_entry_charge;
+      use_huge_pages = opts.use_huge_pages_for_table;
+      bucketized = opts.bucketized_table;
     }
     size_t estimated_value_size;
+    // See HyperClockCacheOptions::use_huge_pages_for_table
+    bool use_huge_pages = false;
+    // See HyperClockCacheOptions::bucketized_table
+    bool bucketized = false;
   };
 
   FixedHyperClockTable(size_t capacity,
@@ -622,12 +629,37 @@ class FixedHyperClockTable : public BaseClockTable {
   // strict upper bound on the load factor.
   static constexpr double kStrictLoadFactor = 0.84;
 
+  // With Opts::bucketized, the number of slots of a probe group is
+  // 2^kProbeGroupBits
+  static constexpr int kProbeGroupBits = 2;
+
+  bool IsBucketized() const { return probe_group_bits_ > 0; }
+  bool IsInHugePages() const { return huge_page_mapping_.Get() != nullptr; }
+
  private:  // functions
   // Returns x mod 2^{length_bits_}.
   inline size_t ModTableSize(uint64_t x) {
     return BitwiseAnd(x, length_bits_mask_);
   }
 
+  // The step between the probe groups of the probe sequence of hashed_key
+  inline size_t ProbeIncrement(const UniqueId64x2& hashed_key) {
+    // Odd, thus relatively prime with the power-of-two number of groups
+    return (static_cast<size_t>(hashed_key[0]) | 1U) << probe_group_bits_;
+  }
+
+  // Returns the slot probed after current in a probe sequence starting at
+  // first: the next slot of the group, or else the slot of the next group
+  // at the same offset as first. Without groups (a group is a slot), this
+  // is current + increment.
+  inline size_t NextProbe(size_t current, size_t first, size_t increment) {
+    size_t offset = BitwiseAnd(current + 1, probe_group_mask_);
+    if (offset == BitwiseAnd(first, probe_group_mask_)) {
+      return ModTableSize(current + increment);
+    }
+    return (current & ~probe_group_mask_) | offset;
+  }
+
   // Returns the first slot in the probe sequence with a handle e such that
   // match_fn(e) is true. At every step, the function first tests whether
   // match_fn(e) holds. If this is false, it evaluates abort_fn(e) to decide
@@ -671,8 +703,20 @@ class FixedHyperClockTable : public BaseClockTable {
   // Maximum number of elements the user can store in the table.
   const size_t occupancy_limit_;
 
+  // log2 of the number of slots of a probe group, 0 unless bucketized.
+  const int probe_group_bits_;
+
+  // For the offset of a slot in its probe group.
+  const size_t probe_group_mask_;
+
+  // The huge pages holding the slots, if any.
+  const MemMapping huge_page_mapping_;
+
+  // The slots, when not in huge pages.
+  const std::unique_ptr<HandleImpl[]> heap_array_;
+
   // Array of slots comprising the hash table.
-  const std::unique_ptr<HandleImpl[]> array_;
+  HandleImpl* const array_;
 };  // class FixedHyperClockTable
 
 // Hash table for cache entries that resizes automatically based on occupancy.
@@ -1122,6 +1166,22 @@ class BaseHyperClockCache : public ShardedCache<ClockCacheShard<Table>> {
 
   explicit BaseHyperClockCache(const HyperClockCacheOptions& opts);
 
+  ~BaseHyperClockCache() override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 Cache::CreateContext* create_context = nullptr,
+                 Cache::Priority priority = Cache::Priority::LOW,
+                 Statistics* stats = nullptr) override;
+
+  bool Ref(Handle* handle) override;
+
+  bool Release(Handle* handle, bool useful,
+               bool erase_if_last_ref = false) override;
+
+  bool Release(Handle* handle, bool erase_if_last_ref = false) override;
+
+  void EraseUnRefEntries() override;
+
   Cache::ObjectPtr Value(Handle* handle) override;
 
   size_t GetCharge(Handle* handle) const override;
@@ -1130,6 +1190,44 @@ class BaseHyperClockCache : public ShardedCache<ClockCacheShard<Table>> {
 
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
+
+ private:
+  using HandleImpl = typename Table::HandleImpl;
+
+  // A slot of the per-core front cache (see
+  // HyperClockCacheOptions::front_cache_entries_per_core). It holds one
+  // reference to an entry of the shards and hands itself out as the handle
+  // of lookups hitting that entry, counting those references in `state`.
+  struct ALIGN_AS(32) FrontSlot : public Cache::Handle {
+    // Number of references handed out, plus kFrontSlotLocked while `entry`
+    // is being replaced (only done with no references handed out)
+    AcqRelAtomic<uint64_t> state{};
+    // Only changed while locked, so stable while holding a reference
+    RelaxedAtomic<HandleImpl*> entry{};
+    // Lookups through the slot that found another entry in the shards since
+    // `entry` was set
+    RelaxedAtomic<uint32_t> misses{};
+  };
+  static constexpr uint64_t kFrontSlotLocked = uint64_t{1} << 63;
+  // Misses after which an entry hit in the shards takes over an occupied
+  // slot
+  static constexpr uint32_t kFrontSlotReplaceMisses = 4;
+
+  // Returns the slot if `handle` was handed out by the front cache
+  FrontSlot* AsFrontSlot(Handle* handle) const;
+  // Returns the entry of the shards that `handle` refers to
+  const HandleImpl* GetEntry(Handle* handle) const;
+  // Makes `slot` hold `entry` (or nothing) if no references to it are handed
+  // out. Returns whether the entry previously held was erased as a result.
+  bool ReplaceFrontEntry(FrontSlot& slot, HandleImpl* entry,
+                         bool erase_if_last_ref);
+
+  // Slots of all cores in one allocation, or nullptr without a front cache
+  FrontSlot* front_slots_ = nullptr;
+  size_t front_slot_count_ = 0;
+  size_t front_slot_mask_ = 0;
+  // The front cache slots of each core
+  std::unique_ptr<CoreLocalArray<FrontSlot*>> front_;
 };
 
 class FixedHyperClockCache
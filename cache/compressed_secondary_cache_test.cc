@@ -1362,6 +1362,74 @@ TEST_P(CompressedSecCacheTestWithTiered, ReservationOverCapacity) {
   ASSERT_OK(cache_res_mgr()->UpdateCacheReservation(0));
 }
 
+TEST_P(CompressedSecCacheTestWithTiered, AdaptiveRatio) {
+  if (std::get<0>(GetParam()) != PrimaryCacheType::kCacheTypeLRU) {
+    ROCKSDB_GTEST_BYPASS("Test only covers the LRU primary cache");
+    return;
+  }
+  LRUCacheOptions lru_opts;
+  lru_opts.num_shard_bits = 0;
+  lru_opts.high_pri_pool_ratio = 0;
+  lru_opts.hash_seed = 0;  // deterministic tests
+  TieredCacheOptions opts;
+  opts.cache_opts = &lru_opts;
+  opts.cache_type = PrimaryCacheType::kCacheTypeLRU;
+  opts.adm_policy = std::get<1>(GetParam());
+  opts.comp_cache_opts.num_shard_bits = 0;
+  opts.comp_cache_opts.hash_seed = 0;
+  // The values are random anyway
+  opts.comp_cache_opts.compression_type = kNoCompression;
+  opts.total_capacity = 1 << 20;
+  opts.compressed_secondary_ratio = 0.3;
+  opts.adaptive_compressed_secondary_ratio = true;
+  std::shared_ptr<Cache> tiered_cache = NewTieredCache(opts);
+  ASSERT_NE(tiered_cache, nullptr);
+  CacheWithSecondaryAdapter* adapter =
+      static_cast_with_check<CacheWithSecondaryAdapter, Cache>(
+          tiered_cache.get());
+  double ratio = adapter->TEST_GetCacheReservationRatio();
+
+  const size_t kNumKeys = 400;
+  Random rnd(301);
+  std::vector<CacheKey> keys;
+  std::vector<std::string> vals;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    keys.emplace_back(CacheKey::CreateUniqueForCacheLifetime(adapter));
+    vals.emplace_back(rnd.RandomString(4 << 10));
+  }
+  // Reads the first num_keys keys round-robin, inserting the missing ones
+  // like a table reader would
+  auto read = [&](size_t num_keys, size_t rounds) {
+    for (size_t r = 0; r < rounds; ++r) {
+      for (size_t i = 0; i < num_keys; ++i) {
+        Cache::Handle* handle =
+            tiered_cache->Lookup(keys[i].AsSlice(), GetHelper(),
+                                 /*context*/ this, Cache::Priority::LOW);
+        if (handle != nullptr) {
+          tiered_cache->Release(handle);
+        } else {
+          TestItem* item = new TestItem(vals[i].data(), vals[i].length());
+          ASSERT_OK(tiered_cache->Insert(keys[i].AsSlice(), item, GetHelper(),
+                                         vals[i].length()));
+        }
+      }
+    }
+  };
+
+  // Twice the keys that fit in the cache, which a larger compressed
+  // secondary cache would have kept more of
+  read(kNumKeys, 50);
+  ASSERT_GT(adapter->TEST_GetCacheReservationRatio(), ratio);
+  ratio = adapter->TEST_GetCacheReservationRatio();
+  ASSERT_LE(ratio, 0.8);
+
+  // Keys that fit in the cache, but take decompressions unless they fit in
+  // the primary cache
+  read(kNumKeys / 2, 200);
+  ASSERT_LT(adapter->TEST_GetCacheReservationRatio(), ratio);
+  ASSERT_GE(adapter->TEST_GetCacheReservationRatio(), 0.05);
+}
+
 INSTANTIATE_TEST_CASE_P(
     CompressedSecCacheTests, CompressedSecCacheTestWithTiered,
     ::testing::Values(
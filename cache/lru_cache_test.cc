@@ -1024,6 +1024,129 @@ TYPED_TEST(ClockCacheTest, TableSizesTest) {
   }
 }
 
+TEST(FixedHyperClockTableTest, TableLayouts) {
+  for (bool bucketized : {false, true}) {
+    for (bool huge_pages : {false, true}) {
+      SCOPED_TRACE("bucketized = " + std::to_string(bucketized) +
+                   ", huge_pages = " + std::to_string(huge_pages));
+      // Twice the actual charge, for a load factor around 60% when the
+      // cache is 60% full
+      HyperClockCacheOptions opts(
+          1 << 20, /*estimated_entry_charge*/ 32, /*num shard_bits*/ 2,
+          /*strict_capacity_limit*/ false, /*memory_allocator*/ nullptr,
+          kDontChargeCacheMetadata);
+      opts.bucketized_table = bucketized;
+      opts.use_huge_pages_for_table = huge_pages;
+      auto cache = opts.MakeSharedCache();
+
+      // Enough entries for long probe sequences, crossing probe groups, but
+      // no eviction
+      const int num_keys = (1 << 20) / 16 * 6 / 10;
+      auto key = [](int i) {
+        std::string k(16, '\0');
+        EncodeFixed32(&k[0], static_cast<uint32_t>(i));
+        return k;
+      };
+      for (int i = 0; i < num_keys; ++i) {
+        ASSERT_OK(cache->Insert(key(i), nullptr, &kNoopCacheItemHelper,
+                                /*charge*/ 16));
+      }
+      int found = 0;
+      for (int i = 0; i < num_keys; ++i) {
+        Cache::Handle* h = cache->Lookup(key(i));
+        if (h != nullptr) {
+          ++found;
+          cache->Release(h);
+        }
+      }
+      ASSERT_EQ(found, num_keys);
+      for (int i = 0; i < num_keys; i += 2) {
+        cache->Erase(key(i));
+      }
+      for (int i = 0; i < num_keys; ++i) {
+        Cache::Handle* h = cache->Lookup(key(i));
+        if (i % 2 == 0) {
+          ASSERT_EQ(h, nullptr);
+        } else if (h != nullptr) {
+          cache->Release(h);
+        }
+      }
+      // The displacements of the probe sequences are rolled back on
+      // destruction (checked in debug builds)
+    }
+  }
+}
+
+TYPED_TEST(ClockCacheTest, FrontCacheTest) {
+  HyperClockCacheOptions opts(
+      1 << 20,
+      std::is_same<TypeParam, FixedHyperClockCache>::value ? 1U : 0U,
+      /*num shard_bits*/ 2, /*strict_capacity_limit*/ false,
+      /*memory_allocator*/ nullptr, kDontChargeCacheMetadata);
+  opts.front_cache_entries_per_core = 3;
+  auto cache = opts.MakeSharedCache();
+
+  constexpr int kNumKeys = 10;
+  auto key = [](int i) { return std::string(16, static_cast<char>('a' + i)); };
+  auto value = [](int i) {
+    return reinterpret_cast<Cache::ObjectPtr>(static_cast<uintptr_t>(i + 1));
+  };
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(
+        cache->Insert(key(i), value(i), &kNoopCacheItemHelper, /*charge*/ 1));
+  }
+  ASSERT_EQ(cache->GetPinnedUsage(), 0U);
+
+  // Hits keep entries in the front cache, referenced and counted as pinned,
+  // and all handles behave the same wherever they come from
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      Cache::Handle* h = cache->Lookup(key(i));
+      ASSERT_NE(h, nullptr);
+      ASSERT_EQ(cache->Value(h), value(i));
+      ASSERT_EQ(cache->GetCharge(h), 1U);
+      ASSERT_EQ(cache->GetCacheItemHelper(h), &kNoopCacheItemHelper);
+      ASSERT_TRUE(cache->Ref(h));
+      ASSERT_FALSE(cache->Release(h));
+      ASSERT_FALSE(cache->Release(h));
+    }
+  }
+  ASSERT_GT(cache->GetPinnedUsage(), 0U);
+  ASSERT_EQ(cache->GetUsage(), static_cast<size_t>(kNumKeys));
+
+  // Erased entries are not found through the front cache
+  cache->Erase(key(0));
+  ASSERT_EQ(cache->Lookup(key(0)), nullptr);
+
+  // Lookups from many threads
+  std::vector<port::Thread> threads;
+  std::atomic<int> errors{0};
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j) {
+        int i = 1 + j % (kNumKeys - 1);
+        Cache::Handle* h = cache->Lookup(key(i));
+        if (h == nullptr || cache->Value(h) != value(i)) {
+          errors.fetch_add(1);
+        }
+        if (h != nullptr) {
+          cache->Release(h);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(errors.load(), 0);
+
+  // The front cache gives up its references to entries no longer referenced
+  // otherwise
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(cache->GetPinnedUsage(), 0U);
+  ASSERT_EQ(cache->GetUsage(), 0U);
+}
+
 }  // namespace clock_cache
 
 class TestSecondaryCache : public SecondaryCache {
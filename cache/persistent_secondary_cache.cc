@@ -0,0 +1,877 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/persistent_secondary_cache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+#include "rocksdb/env.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/math.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// A segment file starts with
+//   fixed64 kSegmentMagic, fixed32 kFormatVersion, fixed32 0
+// followed by records aligned to kRecordAlignment bytes,
+//   fixed32 masked crc32c of the rest of the record
+//   fixed32 key size
+//   fixed32 value size
+//   char compression type, char source cache tier, 2 zero bytes
+//   key, value, zero padding
+// and, once sealed, by the footer
+//   for each record: fixed32 offset / kRecordAlignment, varint32 key size,
+//                    key
+//   fixed32 masked crc32c of the above, fixed32 number of records,
+//   fixed64 size of the above before the crc, fixed64 kFooterMagic
+constexpr uint64_t kSegmentMagic = 0x3167657363737270;  // "prscsg1"
+constexpr uint64_t kFooterMagic = 0x3174667363737270;   // "prscft1"
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kSegmentHeaderSize = 16;
+constexpr size_t kRecordHeaderSize = 16;
+constexpr size_t kFooterTrailerSize = 24;
+constexpr uint64_t kRecordAlignment = 8;
+constexpr const char* kSegmentFileSuffix = ".pcs";
+
+// An index word is
+//   16-bit tag of the key hash, never 0
+//   lowest 16 bits of the segment sequence number
+//   32-bit offset of the record / kRecordAlignment
+// so a word of 0 is empty, and fewer than 2^16 segments may be live.
+constexpr int kWaysPerBucket = 8;
+constexpr int kTagShift = 48;
+constexpr int kSeqShift = 32;
+constexpr uint64_t kSeqMask = 0xffff;
+constexpr uint64_t kOffsetMask = 0xffffffff;
+constexpr uint64_t kMaxLiveSegments = 1 << 15;
+
+constexpr uint64_t kMinSegmentSize = 1 << 20;
+constexpr uint64_t kMaxSegmentSize = (kOffsetMask + 1) * kRecordAlignment;
+
+uint64_t AlignedRecordSize(size_t key_size, size_t value_size) {
+  const uint64_t size = kRecordHeaderSize + key_size + value_size;
+  return (size + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+size_t FooterEntrySize(size_t key_size) {
+  return sizeof(uint32_t) + VarintLength(key_size) + key_size;
+}
+
+bool ParseSegmentFileName(const std::string& fname, uint64_t* seq) {
+  const size_t suffix_len = strlen(kSegmentFileSuffix);
+  if (fname.size() <= suffix_len ||
+      fname.compare(fname.size() - suffix_len, suffix_len,
+                    kSegmentFileSuffix) != 0) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (size_t i = 0; i < fname.size() - suffix_len; i++) {
+    if (fname[i] < '0' || fname[i] > '9' || value > (UINT64_MAX - 9) / 10) {
+      return false;
+    }
+    value = value * 10 + static_cast<uint64_t>(fname[i] - '0');
+  }
+  *seq = value;
+  return value > 0;
+}
+}  // namespace
+
+class PersistentSecondaryCache::ResultHandle
+    : public SecondaryCacheResultHandle {
+ public:
+  ResultHandle() : cv_(&mutex_) {}
+  ~ResultHandle() override = default;
+
+  ResultHandle(const ResultHandle&) = delete;
+  ResultHandle& operator=(const ResultHandle&) = delete;
+
+  // Takes the mutex, so that the handle cannot be destroyed while Complete()
+  // still holds it
+  bool IsReady() override {
+    MutexLock l(&mutex_);
+    return ready_;
+  }
+
+  void Wait() override {
+    MutexLock l(&mutex_);
+    while (!ready_) {
+      cv_.Wait();
+    }
+  }
+
+  Cache::ObjectPtr Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+  void Complete(Cache::ObjectPtr value, size_t size) {
+    MutexLock l(&mutex_);
+    value_ = value;
+    size_ = size;
+    ready_ = true;
+    cv_.SignalAll();
+  }
+
+ private:
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  bool ready_ = false;
+  Cache::ObjectPtr value_ = nullptr;
+  size_t size_ = 0;
+};
+
+PersistentSecondaryCache::PersistentSecondaryCache(
+    const PersistentSecondaryCacheOptions& opts)
+    : opts_(opts),
+      fs_((opts.env != nullptr ? opts.env : Env::Default())->GetFileSystem()),
+      segment_size_(opts.segment_size),
+      write_buffer_size_(static_cast<size_t>(
+          std::min(uint64_t{opts.write_buffer_size}, opts.segment_size))),
+      capacity_(opts.capacity) {
+  const uint64_t expected_entries = std::max(
+      uint64_t{64},
+      opts.capacity / std::max(size_t{1}, opts.estimated_entry_size));
+  // Buckets at most 80% full at the expected number of entries
+  const uint64_t buckets = uint64_t{1} << (FloorLog2(expected_entries * 5 / 4 /
+                                                     kWaysPerBucket) +
+                                           1);
+  index_bucket_mask_ = buckets - 1;
+  index_.reset(new std::atomic<uint64_t>[buckets * kWaysPerBucket]);
+  for (uint64_t i = 0; i < buckets * kWaysPerBucket; i++) {
+    index_[i].store(0, std::memory_order_relaxed);
+  }
+  read_pool_.reset(NewThreadPool(std::max(1, opts.num_io_threads)));
+}
+
+PersistentSecondaryCache::~PersistentSecondaryCache() {
+  // The pending lookups must complete before their handles are destroyed
+  read_pool_->WaitForJobsAndJoinAllThreads();
+  MutexLock l(&write_mutex_);
+  if (active_ != nullptr) {
+    SealActiveSegment().PermitUncheckedError();
+  }
+}
+
+Status PersistentSecondaryCache::Open() {
+  const IOOptions io_opts;
+  IOStatus s = fs_->CreateDirIfMissing(opts_.path, io_opts, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<std::string> children;
+  s = fs_->GetChildren(opts_.path, io_opts, &children, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  std::map<uint64_t, uint64_t> seq_to_size;
+  uint64_t total_size = 0;
+  for (const auto& child : children) {
+    uint64_t seq = 0;
+    if (!ParseSegmentFileName(child, &seq)) {
+      continue;
+    }
+    uint64_t size = 0;
+    s = fs_->GetFileSize(SegmentFileName(seq), io_opts, &size, nullptr);
+    if (!s.ok()) {
+      return s;
+    }
+    seq_to_size[seq] = size;
+    total_size += size;
+  }
+  // Keep the newest segments that fit, which may be fewer than before if the
+  // capacity shrank
+  while (!seq_to_size.empty() &&
+         (total_size > capacity_.load(std::memory_order_relaxed) ||
+          seq_to_size.rbegin()->first - seq_to_size.begin()->first >=
+              kMaxLiveSegments)) {
+    s = fs_->DeleteFile(SegmentFileName(seq_to_size.begin()->first), io_opts,
+                        nullptr);
+    if (!s.ok()) {
+      return s;
+    }
+    total_size -= seq_to_size.begin()->second;
+    seq_to_size.erase(seq_to_size.begin());
+  }
+  if (!seq_to_size.empty()) {
+    oldest_seq_.store(seq_to_size.begin()->first, std::memory_order_relaxed);
+    newest_seq_.store(seq_to_size.rbegin()->first, std::memory_order_relaxed);
+  }
+
+  // In order, so that the newest record of a key ends up in the index
+  for (const auto& seq_and_size : seq_to_size) {
+    Status rs = RecoverSegment(seq_and_size.first, seq_and_size.second);
+    if (!rs.ok()) {
+      return rs;
+    }
+  }
+  return Status::OK();
+}
+
+std::string PersistentSecondaryCache::SegmentFileName(uint64_t seq) const {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "/%012" PRIu64 "%s", seq, kSegmentFileSuffix);
+  return opts_.path + buf;
+}
+
+uint64_t PersistentSecondaryCache::IndexTag(uint64_t hash) {
+  const uint64_t tag = hash >> kTagShift;
+  return tag == 0 ? 1 : tag;
+}
+
+uint64_t PersistentSecondaryCache::SegmentSeqOf(uint64_t word) const {
+  const uint64_t low = (word >> kSeqShift) & kSeqMask;
+  const uint64_t newest = newest_seq_.load(std::memory_order_acquire);
+  return newest - ((newest - low) & kSeqMask);
+}
+
+bool PersistentSecondaryCache::IsLive(uint64_t word) const {
+  return word != 0 &&
+         SegmentSeqOf(word) >= oldest_seq_.load(std::memory_order_acquire);
+}
+
+void PersistentSecondaryCache::Publish(uint64_t hash, uint64_t seq,
+                                       uint64_t offset) {
+  const uint64_t tag = IndexTag(hash);
+  const uint64_t word = (tag << kTagShift) | ((seq & kSeqMask) << kSeqShift) |
+                        (offset / kRecordAlignment);
+  std::atomic<uint64_t>* bucket =
+      &index_[(hash & index_bucket_mask_) * kWaysPerBucket];
+  // Replace the word of the same tag, or else an empty or dead word, or else
+  // the word of the oldest segment
+  int victim = 0;
+  uint64_t victim_word = bucket[0].load(std::memory_order_relaxed);
+  uint64_t victim_seq = UINT64_MAX;
+  for (int way = 0; way < kWaysPerBucket; way++) {
+    const uint64_t w = bucket[way].load(std::memory_order_relaxed);
+    if ((w >> kTagShift) == tag) {
+      victim = way;
+      victim_word = w;
+      break;
+    }
+    if (victim_seq == 0) {
+      continue;
+    }
+    const uint64_t w_seq = IsLive(w) ? SegmentSeqOf(w) : 0;
+    if (w_seq < victim_seq) {
+      victim = way;
+      victim_word = w;
+      victim_seq = w_seq;
+    }
+  }
+  // Best effort: losing a race with another thread only loses an entry
+  bucket[victim].compare_exchange_strong(victim_word, word,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed);
+}
+
+Status PersistentSecondaryCache::Insert(const Slice& key,
+                                        Cache::ObjectPtr value,
+                                        const Cache::CacheItemHelper* helper,
+                                        bool /*force_insert*/) {
+  if (value == nullptr) {
+    return Status::InvalidArgument();
+  }
+  if (!helper->IsSecondaryCacheCompatible()) {
+    return Status::OK();
+  }
+  const size_t size = (*helper->size_cb)(value);
+  return InsertRecord(key, size, kNoCompression, CacheTier::kVolatileTier,
+                      [&](char* buf) {
+                        return (*helper->saveto_cb)(value, 0, size, buf);
+                      });
+}
+
+Status PersistentSecondaryCache::InsertSaved(const Slice& key,
+                                             const Slice& saved,
+                                             CompressionType type,
+                                             CacheTier source) {
+  return InsertRecord(key, saved.size(), type, source, [&](char* buf) {
+    memcpy(buf, saved.data(), saved.size());
+    return Status::OK();
+  });
+}
+
+Status PersistentSecondaryCache::InsertRecord(
+    const Slice& key, size_t value_size, CompressionType type,
+    CacheTier source, const std::function<Status(char*)>& save_value) {
+  const uint64_t record_size = AlignedRecordSize(key.size(), value_size);
+  const size_t footer_entry_size = FooterEntrySize(key.size());
+  if (kSegmentHeaderSize + record_size + footer_entry_size +
+          kFooterTrailerSize >
+      segment_size_) {
+    // Does not fit in a segment
+    return Status::OK();
+  }
+
+  MutexLock l(&write_mutex_);
+  if (crashed_) {
+    return Status::OK();
+  }
+  if (active_ != nullptr &&
+      active_size_ + record_size + footer_.size() + footer_entry_size +
+              kFooterTrailerSize >
+          segment_size_) {
+    // Without the footer, the segment is scanned on recovery instead
+    SealActiveSegment().PermitUncheckedError();
+  }
+  Status s;
+  if (active_ == nullptr) {
+    s = NewActiveSegment();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  const uint64_t offset = active_size_;
+  const size_t pos = buffer_.size();
+  buffer_.resize(pos + record_size);
+  char* record = &buffer_[pos];
+  EncodeFixed32(record + 4, static_cast<uint32_t>(key.size()));
+  EncodeFixed32(record + 8, static_cast<uint32_t>(value_size));
+  record[12] = static_cast<char>(type);
+  record[13] = static_cast<char>(source);
+  memcpy(record + kRecordHeaderSize, key.data(), key.size());
+  s = save_value(record + kRecordHeaderSize + key.size());
+  if (!s.ok()) {
+    buffer_.resize(pos);
+    return s;
+  }
+  EncodeFixed32(record, crc32c::Mask(crc32c::Value(
+                            record + 4, kRecordHeaderSize - 4 + key.size() +
+                                            value_size)));
+  active_size_ += record_size;
+  pending_.emplace_back(GetSliceNPHash64(key), offset);
+
+  PutFixed32(&footer_, static_cast<uint32_t>(offset / kRecordAlignment));
+  PutVarint32(&footer_, static_cast<uint32_t>(key.size()));
+  footer_.append(key.data(), key.size());
+  footer_num_records_++;
+
+  if (buffer_.size() >= write_buffer_size_) {
+    s = FlushBuffer();
+  }
+  return s;
+}
+
+Status PersistentSecondaryCache::NewActiveSegment() {
+  write_mutex_.AssertHeld();
+  assert(active_ == nullptr);
+  auto segment = std::make_shared<Segment>();
+  segment->seq = newest_seq_.load(std::memory_order_relaxed) + 1;
+  segment->fname = SegmentFileName(segment->seq);
+  const FileOptions file_opts;
+  IOStatus s =
+      fs_->NewWritableFile(segment->fname, file_opts, &writer_, nullptr);
+  if (s.ok()) {
+    s = fs_->NewRandomAccessFile(segment->fname, file_opts, &segment->file,
+                                 nullptr);
+  }
+  if (!s.ok()) {
+    writer_.reset();
+    return s;
+  }
+  {
+    MutexLock sl(&segments_mutex_);
+    segments_[segment->seq] = segment;
+  }
+  newest_seq_.store(segment->seq, std::memory_order_release);
+  active_ = std::move(segment);
+
+  buffer_.clear();
+  PutFixed64(&buffer_, kSegmentMagic);
+  PutFixed32(&buffer_, kFormatVersion);
+  PutFixed32(&buffer_, 0);
+  active_size_ = buffer_.size();
+  pending_.clear();
+  footer_.clear();
+  footer_num_records_ = 0;
+  MaybeEvict();
+  return Status::OK();
+}
+
+Status PersistentSecondaryCache::FlushBuffer() {
+  write_mutex_.AssertHeld();
+  assert(active_ != nullptr);
+  if (buffer_.empty()) {
+    return Status::OK();
+  }
+  const IOOptions io_opts;
+  IOStatus s = writer_->Append(buffer_, io_opts, nullptr);
+  if (s.ok()) {
+    s = writer_->Flush(io_opts, nullptr);
+  }
+  if (!s.ok()) {
+    // The records written so far stay readable, and are recovered by a scan
+    CloseActiveSegment();
+    return s;
+  }
+  total_size_.fetch_add(buffer_.size(), std::memory_order_relaxed);
+  buffer_.clear();
+  for (const auto& hash_and_offset : pending_) {
+    Publish(hash_and_offset.first, active_->seq, hash_and_offset.second);
+  }
+  pending_.clear();
+  MaybeEvict();
+  return Status::OK();
+}
+
+Status PersistentSecondaryCache::SealActiveSegment() {
+  write_mutex_.AssertHeld();
+  Status s = FlushBuffer();
+  if (!s.ok()) {
+    return s;
+  }
+  std::string footer = std::move(footer_);
+  const uint64_t body_size = footer.size();
+  PutFixed32(&footer, crc32c::Mask(crc32c::Value(footer.data(), body_size)));
+  PutFixed32(&footer, footer_num_records_);
+  PutFixed64(&footer, body_size);
+  PutFixed64(&footer, kFooterMagic);
+  // Nothing is synced: after a crash, a torn footer makes the segment be
+  // scanned instead, and the records lost are not found
+  const IOOptions io_opts;
+  IOStatus io_s = writer_->Append(footer, io_opts, nullptr);
+  if (io_s.ok()) {
+    io_s = writer_->Close(io_opts, nullptr);
+    writer_.reset();
+  }
+  if (io_s.ok()) {
+    total_size_.fetch_add(footer.size(), std::memory_order_relaxed);
+  }
+  CloseActiveSegment();
+  return io_s;
+}
+
+void PersistentSecondaryCache::CloseActiveSegment() {
+  write_mutex_.AssertHeld();
+  if (writer_ != nullptr) {
+    writer_->Close(IOOptions(), nullptr).PermitUncheckedError();
+    writer_.reset();
+  }
+  active_.reset();
+  active_size_ = 0;
+  buffer_.clear();
+  pending_.clear();
+  footer_.clear();
+  footer_num_records_ = 0;
+}
+
+void PersistentSecondaryCache::MaybeEvict() {
+  write_mutex_.AssertHeld();
+  const uint64_t active_seq = active_ != nullptr ? active_->seq : 0;
+  while (true) {
+    std::shared_ptr<Segment> oldest;
+    {
+      MutexLock sl(&segments_mutex_);
+      if (segments_.empty() || segments_.begin()->first == active_seq ||
+          (total_size_.load(std::memory_order_relaxed) <=
+               capacity_.load(std::memory_order_relaxed) &&
+           newest_seq_.load(std::memory_order_relaxed) -
+                   segments_.begin()->first <
+               kMaxLiveSegments)) {
+        return;
+      }
+      oldest = segments_.begin()->second;
+      segments_.erase(segments_.begin());
+      // Ends the lookups into the segment, while those under way keep it open
+      oldest_seq_.store(segments_.empty()
+                            ? newest_seq_.load(std::memory_order_relaxed) + 1
+                            : segments_.begin()->first,
+                        std::memory_order_release);
+    }
+    uint64_t size = 0;
+    const IOOptions io_opts;
+    if (fs_->GetFileSize(oldest->fname, io_opts, &size, nullptr).ok()) {
+      total_size_.fetch_sub(
+          std::min(size, total_size_.load(std::memory_order_relaxed)),
+          std::memory_order_relaxed);
+    }
+    fs_->DeleteFile(oldest->fname, io_opts, nullptr).PermitUncheckedError();
+  }
+}
+
+Status PersistentSecondaryCache::RecoverSegment(uint64_t seq,
+                                                uint64_t file_size) {
+  auto segment = std::make_shared<Segment>();
+  segment->seq = seq;
+  segment->fname = SegmentFileName(seq);
+  IOStatus io_s = fs_->NewRandomAccessFile(segment->fname, FileOptions(),
+                                           &segment->file, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+
+  char header[kSegmentHeaderSize];
+  Slice result;
+  io_s = segment->file->Read(0, kSegmentHeaderSize, IOOptions(), &result,
+                             header, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (result.size() < kSegmentHeaderSize ||
+      DecodeFixed64(result.data()) != kSegmentMagic ||
+      DecodeFixed32(result.data() + 8) != kFormatVersion) {
+    // Torn when created, or from another format version
+    segment->file.reset();
+    return fs_->DeleteFile(segment->fname, IOOptions(), nullptr);
+  }
+
+  bool sealed = false;
+  Status s = RecoverFromFooter(*segment, file_size, &sealed);
+  if (s.ok() && !sealed) {
+    s = RecoverByScan(*segment, file_size);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  total_size_.fetch_add(file_size, std::memory_order_relaxed);
+  MutexLock sl(&segments_mutex_);
+  segments_[seq] = std::move(segment);
+  return Status::OK();
+}
+
+Status PersistentSecondaryCache::RecoverFromFooter(const Segment& segment,
+                                                   uint64_t file_size,
+                                                   bool* sealed) {
+  *sealed = false;
+  if (file_size < kSegmentHeaderSize + kFooterTrailerSize) {
+    return Status::OK();
+  }
+  char trailer[kFooterTrailerSize];
+  Slice result;
+  IOStatus io_s =
+      segment.file->Read(file_size - kFooterTrailerSize, kFooterTrailerSize,
+                         IOOptions(), &result, trailer, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (result.size() < kFooterTrailerSize ||
+      DecodeFixed64(result.data() + 16) != kFooterMagic) {
+    return Status::OK();
+  }
+  const uint32_t expected_crc = crc32c::Unmask(DecodeFixed32(result.data()));
+  const uint32_t num_records = DecodeFixed32(result.data() + 4);
+  const uint64_t body_size = DecodeFixed64(result.data() + 8);
+  if (body_size > file_size - kSegmentHeaderSize - kFooterTrailerSize) {
+    return Status::OK();
+  }
+  std::unique_ptr<char[]> body(new char[body_size]);
+  io_s = segment.file->Read(file_size - kFooterTrailerSize - body_size,
+                            body_size, IOOptions(), &result, body.get(),
+                            nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (result.size() < body_size ||
+      crc32c::Value(result.data(), body_size) != expected_crc) {
+    return Status::OK();
+  }
+
+  Slice input = result;
+  for (uint32_t i = 0; i < num_records; i++) {
+    uint32_t offset_units = 0;
+    Slice key;
+    if (!GetFixed32(&input, &offset_units) ||
+        !GetLengthPrefixedSlice(&input, &key)) {
+      return Status::OK();
+    }
+    Publish(GetSliceNPHash64(key), segment.seq,
+            uint64_t{offset_units} * kRecordAlignment);
+  }
+  *sealed = true;
+  return Status::OK();
+}
+
+Status PersistentSecondaryCache::RecoverByScan(const Segment& segment,
+                                               uint64_t file_size) {
+  uint64_t offset = kSegmentHeaderSize;
+  std::string scratch;
+  while (offset + kRecordHeaderSize <= file_size) {
+    char header[kRecordHeaderSize];
+    Slice result;
+    IOStatus io_s = segment.file->Read(offset, kRecordHeaderSize, IOOptions(),
+                                       &result, header, nullptr);
+    if (!io_s.ok()) {
+      return io_s;
+    }
+    if (result.size() < kRecordHeaderSize) {
+      break;
+    }
+    const uint32_t key_size = DecodeFixed32(result.data() + 4);
+    const uint32_t value_size = DecodeFixed32(result.data() + 8);
+    const uint64_t record_size = AlignedRecordSize(key_size, value_size);
+    if (record_size > file_size - offset) {
+      break;
+    }
+    const uint32_t expected_crc =
+        crc32c::Unmask(DecodeFixed32(result.data()));
+    uint32_t crc = crc32c::Value(result.data() + 4, kRecordHeaderSize - 4);
+    scratch.resize(key_size + value_size);
+    io_s = segment.file->Read(offset + kRecordHeaderSize, scratch.size(),
+                              IOOptions(), &result, &scratch[0], nullptr);
+    if (!io_s.ok()) {
+      return io_s;
+    }
+    if (result.size() < scratch.size()) {
+      break;
+    }
+    crc = crc32c::Extend(crc, result.data(), result.size());
+    if (crc != expected_crc) {
+      // The end of the records written before the crash
+      break;
+    }
+    Publish(GetSliceNPHash64(Slice(result.data(), key_size)), segment.seq,
+            offset);
+    offset += record_size;
+  }
+  return Status::OK();
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> PersistentSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool wait, bool /*advise_erase*/,
+    Statistics* /*stats*/, bool& kept_in_sec_cache) {
+  assert(helper);
+  kept_in_sec_cache = false;
+  const uint64_t hash = GetSliceNPHash64(key);
+  const uint64_t tag = IndexTag(hash);
+  const std::atomic<uint64_t>* bucket =
+      &index_[(hash & index_bucket_mask_) * kWaysPerBucket];
+  std::pair<uint64_t, uint64_t> found[kWaysPerBucket];
+  int num_found = 0;
+  for (int way = 0; way < kWaysPerBucket; way++) {
+    const uint64_t w = bucket[way].load(std::memory_order_acquire);
+    if ((w >> kTagShift) == tag && IsLive(w)) {
+      found[num_found++] = {SegmentSeqOf(w),
+                            (w & kOffsetMask) * kRecordAlignment};
+    }
+  }
+  if (num_found == 0) {
+    return nullptr;
+  }
+  // The newest record first, in case of a collision of tags
+  std::sort(found, found + num_found, std::greater<>());
+
+  std::vector<Candidate> candidates;
+  {
+    MutexLock sl(&segments_mutex_);
+    for (int i = 0; i < num_found; i++) {
+      auto it = segments_.find(found[i].first);
+      if (it != segments_.end()) {
+        candidates.push_back({it->second, found[i].second});
+      }
+    }
+  }
+  if (candidates.empty()) {
+    return nullptr;
+  }
+
+  std::unique_ptr<ResultHandle> handle(new ResultHandle());
+  if (wait) {
+    ReadAndCreate(key.ToString(), candidates, helper, create_context,
+                  handle.get());
+    if (handle->Value() == nullptr) {
+      return nullptr;
+    }
+  } else {
+    // The caller may not destroy the handle until it is ready
+    ResultHandle* h = handle.get();
+    read_pool_->SubmitJob([this, k = key.ToString(),
+                           c = std::move(candidates), helper, create_context,
+                           h]() {
+      ReadAndCreate(k, c, helper, create_context, h);
+    });
+  }
+  kept_in_sec_cache = true;
+  return handle;
+}
+
+Status PersistentSecondaryCache::ReadRecord(
+    const Segment& segment, uint64_t offset, const Slice& key,
+    std::unique_ptr<char[]>* buf, Slice* value, CompressionType* type,
+    CacheTier* source) const {
+  // Reads the entries up to estimated_entry_size at once
+  const size_t first_read_size =
+      kRecordHeaderSize + key.size() + opts_.estimated_entry_size;
+  buf->reset(new char[first_read_size]);
+  Slice result;
+  IOStatus io_s = segment.file->Read(offset, first_read_size, IOOptions(),
+                                     &result, buf->get(), nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (result.size() < kRecordHeaderSize + key.size()) {
+    return Status::Corruption("Truncated persistent cache record");
+  }
+  const uint32_t key_size = DecodeFixed32(result.data() + 4);
+  const uint32_t value_size = DecodeFixed32(result.data() + 8);
+  if (key_size != key.size() ||
+      memcmp(result.data() + kRecordHeaderSize, key.data(), key.size()) != 0) {
+    // Another key with the same tag
+    return Status::NotFound();
+  }
+  const size_t record_size = kRecordHeaderSize + key_size + value_size;
+  const char* data = result.data();
+  if (record_size > result.size()) {
+    std::unique_ptr<char[]> record(new char[record_size]);
+    memcpy(record.get(), result.data(), result.size());
+    const size_t read_size = result.size();
+    io_s = segment.file->Read(offset + read_size, record_size - read_size,
+                              IOOptions(), &result, record.get() + read_size,
+                              nullptr);
+    if (!io_s.ok()) {
+      return io_s;
+    }
+    if (result.size() < record_size - read_size) {
+      return Status::Corruption("Truncated persistent cache record");
+    }
+    if (result.data() != record.get() + read_size) {
+      memcpy(record.get() + read_size, result.data(), result.size());
+    }
+    *buf = std::move(record);
+    data = buf->get();
+  }
+  if (crc32c::Unmask(DecodeFixed32(data)) !=
+      crc32c::Value(data + 4, record_size - 4)) {
+    return Status::Corruption("Persistent cache record checksum mismatch");
+  }
+  *type = static_cast<CompressionType>(data[12]);
+  *source = static_cast<CacheTier>(data[13]);
+  *value = Slice(data + kRecordHeaderSize + key_size, value_size);
+  return Status::OK();
+}
+
+void PersistentSecondaryCache::ReadAndCreate(
+    const std::string& key, const std::vector<Candidate>& candidates,
+    const Cache::CacheItemHelper* helper, Cache::CreateContext* create_context,
+    ResultHandle* handle) const {
+  for (const auto& candidate : candidates) {
+    std::unique_ptr<char[]> buf;
+    Slice value;
+    CompressionType type = kNoCompression;
+    CacheTier source = CacheTier::kVolatileTier;
+    Status s = ReadRecord(*candidate.segment, candidate.offset, key, &buf,
+                          &value, &type, &source);
+    if (s.IsNotFound()) {
+      continue;
+    }
+    if (!s.ok()) {
+      break;
+    }
+    Cache::ObjectPtr obj = nullptr;
+    size_t charge = 0;
+    s = helper->create_cb(value, type, source, create_context,
+                          /*allocator=*/nullptr, &obj, &charge);
+    if (s.ok()) {
+      handle->Complete(obj, charge);
+      return;
+    }
+    break;
+  }
+  handle->Complete(nullptr, 0);
+}
+
+void PersistentSecondaryCache::Erase(const Slice& key) {
+  const uint64_t hash = GetSliceNPHash64(key);
+  const uint64_t tag = IndexTag(hash);
+  std::atomic<uint64_t>* bucket =
+      &index_[(hash & index_bucket_mask_) * kWaysPerBucket];
+  for (int way = 0; way < kWaysPerBucket; way++) {
+    uint64_t w = bucket[way].load(std::memory_order_relaxed);
+    if ((w >> kTagShift) == tag) {
+      bucket[way].compare_exchange_strong(w, 0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void PersistentSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  for (SecondaryCacheResultHandle* handle : handles) {
+    handle->Wait();
+  }
+}
+
+Status PersistentSecondaryCache::SetCapacity(size_t capacity) {
+  MutexLock l(&write_mutex_);
+  capacity_.store(capacity, std::memory_order_relaxed);
+  MaybeEvict();
+  return Status::OK();
+}
+
+Status PersistentSecondaryCache::GetCapacity(size_t& capacity) {
+  capacity = static_cast<size_t>(capacity_.load(std::memory_order_relaxed));
+  return Status::OK();
+}
+
+std::string PersistentSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.reserve(20000);
+  const int kBufferSize{200};
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    path : %s\n", opts_.path.c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    capacity : %" PRIu64 "\n",
+           capacity_.load(std::memory_order_relaxed));
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    segment_size : %" PRIu64 "\n",
+           segment_size_);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    write_buffer_size : %" ROCKSDB_PRIszt "\n",
+           write_buffer_size_);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "    estimated_entry_size : %" ROCKSDB_PRIszt "\n",
+           opts_.estimated_entry_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    num_io_threads : %d\n",
+           opts_.num_io_threads);
+  ret.append(buffer);
+  return ret;
+}
+
+Status PersistentSecondaryCache::TEST_Flush() {
+  MutexLock l(&write_mutex_);
+  if (active_ == nullptr) {
+    return Status::OK();
+  }
+  return FlushBuffer();
+}
+
+void PersistentSecondaryCache::TEST_SimulateCrash() {
+  MutexLock l(&write_mutex_);
+  crashed_ = true;
+  // Without the buffered records and the footer
+  CloseActiveSegment();
+}
+
+Status NewPersistentSecondaryCache(const PersistentSecondaryCacheOptions& opts,
+                                   std::shared_ptr<SecondaryCache>* cache) {
+  if (opts.path.empty()) {
+    return Status::InvalidArgument("Persistent cache path is empty");
+  }
+  if (opts.segment_size < kMinSegmentSize ||
+      opts.segment_size > kMaxSegmentSize) {
+    return Status::InvalidArgument(
+        "Persistent cache segment_size must be between 1MB and 32GB");
+  }
+  if (opts.capacity < opts.segment_size ||
+      opts.capacity / opts.segment_size >= kMaxLiveSegments) {
+    return Status::InvalidArgument(
+        "Persistent cache capacity must be between 1 and 32767 segments");
+  }
+  auto persistent_cache = std::make_shared<PersistentSecondaryCache>(opts);
+  Status s = persistent_cache->Open();
+  if (s.ok()) {
+    *cache = std::move(persistent_cache);
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,187 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The PersistentSecondaryCache is a SecondaryCache that keeps the entries in
+// files on a local file system. See PersistentSecondaryCacheOptions.
+//
+// Layout. The entries are appended as records, each with its key and a
+// checksum, to segment files named by increasing sequence numbers. The
+// records are buffered in memory and written write_buffer_size bytes at a
+// time. A full segment is sealed with a footer that lists the keys and
+// offsets of its records, and is never written again. When the segments
+// take more than the capacity, the oldest one is deleted, so the files are
+// only ever appended to and deleted whole.
+//
+// Index. A lock-free, 8-way set-associative hash table of 64-bit words maps
+// a 16-bit tag of the hash of a key to the segment and offset of its latest
+// record. The words that point to deleted segments are dropped lazily. A
+// lookup reads and checks the key and checksum of the record, so a stale or
+// colliding word costs a read, never a wrong entry.
+//
+// Recovery. The index is not persisted. On open, it is rebuilt from the
+// footers of the sealed segments, and by scanning the records of the
+// segments left unsealed by a crash up to the first torn or corrupt one.
+// Thus there is no metadata that could disagree with the data after a
+// crash, and nothing needs to be synced. New records always go to a new
+// segment.
+//
+// Lookup. With wait=false, the record is read and the object created by a
+// pool of I/O threads, and the handle becomes ready once that is done.
+class PersistentSecondaryCache : public SecondaryCache {
+ public:
+  explicit PersistentSecondaryCache(
+      const PersistentSecondaryCacheOptions& opts);
+  ~PersistentSecondaryCache() override;
+
+  // Creates the directory if missing and recovers the index from the
+  // segments in it. Must be called once, before anything else.
+  Status Open();
+
+  const char* Name() const override { return "PersistentSecondaryCache"; }
+
+  Status Insert(const Slice& key, Cache::ObjectPtr value,
+                const Cache::CacheItemHelper* helper,
+                bool force_insert) override;
+
+  Status InsertSaved(const Slice& key, const Slice& saved, CompressionType type,
+                     CacheTier source) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      Statistics* stats, bool& kept_in_sec_cache) override;
+
+  // Records are only deleted with their segment, so an entry is kept in
+  // this cache after it is promoted to the primary cache.
+  bool SupportForceErase() const override { return false; }
+
+  // Drops the entry from the index.
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  Status SetCapacity(size_t capacity) override;
+
+  Status GetCapacity(size_t& capacity) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // The total size of the segment files
+  uint64_t TEST_GetUsage() const {
+    return total_size_.load(std::memory_order_relaxed);
+  }
+
+  // Writes the buffered records, which makes them visible to Lookup()
+  Status TEST_Flush();
+
+  // Drops the buffered records and leaves the active segment unsealed, as if
+  // the process crashed, but still releases the resources of the cache.
+  void TEST_SimulateCrash();
+
+ private:
+  struct Segment {
+    uint64_t seq;
+    std::string fname;
+    std::unique_ptr<FSRandomAccessFile> file;
+  };
+
+  struct Candidate {
+    std::shared_ptr<Segment> segment;
+    uint64_t offset;
+  };
+
+  class ResultHandle;
+
+  // Index words
+  static uint64_t IndexTag(uint64_t hash);
+  uint64_t SegmentSeqOf(uint64_t word) const;
+  bool IsLive(uint64_t word) const;
+  void Publish(uint64_t hash, uint64_t seq, uint64_t offset);
+
+  // Appends a record for the key to the write buffer, with a value of
+  // `value_size` bytes that `save_value` writes at the given address.
+  Status InsertRecord(const Slice& key, size_t value_size,
+                      CompressionType type, CacheTier source,
+                      const std::function<Status(char*)>& save_value);
+
+  // REQUIRES: write_mutex_ held
+  Status NewActiveSegment();
+  Status FlushBuffer();
+  Status SealActiveSegment();
+  void CloseActiveSegment();
+  void MaybeEvict();
+
+  Status RecoverSegment(uint64_t seq, uint64_t file_size);
+  Status RecoverFromFooter(const Segment& segment, uint64_t file_size,
+                           bool* sealed);
+  Status RecoverByScan(const Segment& segment, uint64_t file_size);
+
+  Status ReadRecord(const Segment& segment, uint64_t offset, const Slice& key,
+                    std::unique_ptr<char[]>* buf, Slice* value,
+                    CompressionType* type, CacheTier* source) const;
+  void ReadAndCreate(const std::string& key,
+                     const std::vector<Candidate>& candidates,
+                     const Cache::CacheItemHelper* helper,
+                     Cache::CreateContext* create_context,
+                     ResultHandle* handle) const;
+
+  std::string SegmentFileName(uint64_t seq) const;
+
+  const PersistentSecondaryCacheOptions opts_;
+  const std::shared_ptr<FileSystem> fs_;
+  const uint64_t segment_size_;
+  const size_t write_buffer_size_;
+
+  // 8 words per bucket, see Publish() for the layout
+  uint64_t index_bucket_mask_ = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> index_;
+
+  // The segments are [oldest_seq_, newest_seq_], with newest_seq_ the active
+  // one once there is one
+  std::atomic<uint64_t> oldest_seq_{1};
+  std::atomic<uint64_t> newest_seq_{0};
+  std::atomic<uint64_t> total_size_{0};
+  std::atomic<uint64_t> capacity_;
+
+  mutable port::Mutex segments_mutex_;
+  std::map<uint64_t, std::shared_ptr<Segment>> segments_;
+
+  // The active segment, written by the inserting threads in turn
+  port::Mutex write_mutex_;
+  std::unique_ptr<FSWritableFile> writer_;
+  std::shared_ptr<Segment> active_;
+  // Bytes of the active segment, including the buffered records
+  uint64_t active_size_ = 0;
+  // The buffered records, from offset active_size_ - buffer_.size()
+  std::string buffer_;
+  // The hashes and offsets of the buffered records
+  std::vector<std::pair<uint64_t, uint64_t>> pending_;
+  // The footer body of the active segment so far
+  std::string footer_;
+  uint32_t footer_num_records_ = 0;
+  bool crashed_ = false;
+
+  std::unique_ptr<ThreadPool> read_pool_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
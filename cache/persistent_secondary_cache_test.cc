@@ -0,0 +1,281 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/persistent_secondary_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "file/file_util.h"
+#include "rocksdb/cache.h"
+#include "test_util/secondary_cache_test_util.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+using secondary_cache_test_util::WithCacheType;
+
+class PersistentSecondaryCacheTest : public testing::Test,
+                                     public WithCacheType {
+ public:
+  PersistentSecondaryCacheTest()
+      : path_(test::PerThreadDBPath("persistent_secondary_cache_test")) {
+    EXPECT_OK(DestroyDir(Env::Default(), path_));
+    opts_.path = path_;
+    opts_.capacity = 4 << 20;
+    opts_.segment_size = 1 << 20;
+    opts_.write_buffer_size = 64 << 10;
+    opts_.estimated_entry_size = 1000;
+  }
+  ~PersistentSecondaryCacheTest() override {
+    cache_.reset();
+    EXPECT_OK(DestroyDir(Env::Default(), path_));
+  }
+
+  const std::string& Type() const override {
+    static const std::string type = kLRU;
+    return type;
+  }
+
+ protected:
+  // 16 bytes, like the block cache keys
+  static std::string Key(int i) {
+    std::string key = "persistent______";
+    key.replace(key.size() - 6, 6, std::to_string(100000 + i));
+    return key;
+  }
+
+  static std::string Value(int i, size_t size = 1000) {
+    Random rnd(i);
+    return rnd.RandomString(static_cast<int>(size));
+  }
+
+  void Open() {
+    cache_.reset();
+    std::shared_ptr<SecondaryCache> cache;
+    ASSERT_OK(NewPersistentSecondaryCache(opts_, &cache));
+    cache_ = std::static_pointer_cast<PersistentSecondaryCache>(cache);
+  }
+
+  void Insert(int i, size_t size = 1000) {
+    std::string value = Value(i, size);
+    TestItem item(value.data(), value.size());
+    ASSERT_OK(cache_->Insert(Key(i), &item, GetHelper(),
+                             /*force_insert=*/false));
+  }
+
+  // Returns the value found for the key, or "NOT_FOUND"
+  std::string Lookup(int i) {
+    bool kept_in_sec_cache = false;
+    auto handle =
+        cache_->Lookup(Key(i), GetHelper(), this, /*wait=*/true,
+                       /*advise_erase=*/true, /*stats=*/nullptr,
+                       kept_in_sec_cache);
+    if (handle == nullptr) {
+      return "NOT_FOUND";
+    }
+    EXPECT_TRUE(handle->IsReady());
+    EXPECT_TRUE(kept_in_sec_cache);
+    std::unique_ptr<TestItem> item(static_cast<TestItem*>(handle->Value()));
+    EXPECT_NE(item, nullptr);
+    EXPECT_EQ(handle->Size(), item->Size());
+    return item->ToString();
+  }
+
+  std::string path_;
+  PersistentSecondaryCacheOptions opts_;
+  std::shared_ptr<PersistentSecondaryCache> cache_;
+};
+
+TEST_F(PersistentSecondaryCacheTest, InvalidOptions) {
+  std::shared_ptr<SecondaryCache> cache;
+  PersistentSecondaryCacheOptions opts = opts_;
+  opts.path.clear();
+  ASSERT_TRUE(NewPersistentSecondaryCache(opts, &cache).IsInvalidArgument());
+  opts = opts_;
+  opts.segment_size = 4096;
+  ASSERT_TRUE(NewPersistentSecondaryCache(opts, &cache).IsInvalidArgument());
+  opts = opts_;
+  opts.capacity = opts.segment_size * 100000;
+  ASSERT_TRUE(NewPersistentSecondaryCache(opts, &cache).IsInvalidArgument());
+  ASSERT_EQ(cache, nullptr);
+}
+
+TEST_F(PersistentSecondaryCacheTest, InsertAndLookup) {
+  Open();
+  ASSERT_EQ("NOT_FOUND", Lookup(1));
+  Insert(1);
+  // Not found until written
+  ASSERT_EQ("NOT_FOUND", Lookup(1));
+  ASSERT_OK(cache_->TEST_Flush());
+  ASSERT_EQ(Value(1), Lookup(1));
+  // Kept after a lookup advising to erase
+  ASSERT_EQ(Value(1), Lookup(1));
+  ASSERT_EQ("NOT_FOUND", Lookup(2));
+
+  // The latest value of a key wins
+  std::string value = Value(3);
+  ASSERT_OK(cache_->InsertSaved(Key(1), value, kNoCompression,
+                                 CacheTier::kVolatileTier));
+  ASSERT_OK(cache_->TEST_Flush());
+  ASSERT_EQ(value, Lookup(1));
+
+  cache_->Erase(Key(1));
+  ASSERT_EQ("NOT_FOUND", Lookup(1));
+
+  // The create callback failing
+  Insert(4);
+  ASSERT_OK(cache_->TEST_Flush());
+  SetFailCreate(true);
+  ASSERT_EQ("NOT_FOUND", Lookup(4));
+  SetFailCreate(false);
+  ASSERT_EQ(Value(4), Lookup(4));
+
+  // Entries larger than the first read
+  Insert(5, 100000);
+  ASSERT_OK(cache_->TEST_Flush());
+  ASSERT_EQ(Value(5, 100000), Lookup(5));
+
+  // Entries larger than a segment are not kept
+  Insert(6, opts_.segment_size);
+  ASSERT_OK(cache_->TEST_Flush());
+  ASSERT_EQ("NOT_FOUND", Lookup(6));
+}
+
+TEST_F(PersistentSecondaryCacheTest, AsyncLookup) {
+  opts_.num_io_threads = 2;
+  Open();
+  constexpr int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(i);
+  }
+  ASSERT_OK(cache_->TEST_Flush());
+
+  std::vector<std::unique_ptr<SecondaryCacheResultHandle>> handles;
+  for (int i = 0; i < kNumKeys + 10; i++) {
+    bool kept_in_sec_cache = false;
+    handles.push_back(cache_->Lookup(Key(i), GetHelper(), this,
+                                     /*wait=*/false, /*advise_erase=*/false,
+                                     /*stats=*/nullptr, kept_in_sec_cache));
+    ASSERT_EQ(i < kNumKeys, handles.back() != nullptr);
+  }
+  handles.resize(kNumKeys);
+  std::vector<SecondaryCacheResultHandle*> to_wait;
+  for (auto& handle : handles) {
+    to_wait.push_back(handle.get());
+  }
+  cache_->WaitAll(to_wait);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(handles[i]->IsReady());
+    std::unique_ptr<TestItem> item(
+        static_cast<TestItem*>(handles[i]->Value()));
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(Value(i), item->ToString());
+  }
+}
+
+TEST_F(PersistentSecondaryCacheTest, Recovery) {
+  Open();
+  // Over two segments, the first one sealed when full
+  constexpr int kNumKeys = 1500;
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(i);
+  }
+  // Sealed when closed
+  Open();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(Value(i), Lookup(i));
+  }
+
+  // Left unsealed, with a torn record at the end
+  for (int i = kNumKeys; i < kNumKeys + 100; i++) {
+    Insert(i);
+  }
+  ASSERT_OK(cache_->TEST_Flush());
+  Insert(kNumKeys + 100);
+  cache_->TEST_SimulateCrash();
+  cache_.reset();
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(path_, &children));
+  std::sort(children.begin(), children.end());
+  std::unique_ptr<WritableFile> file;
+  EnvOptions env_opts;
+  ASSERT_OK(Env::Default()->ReopenWritableFile(path_ + "/" + children.back(),
+                                               &file, env_opts));
+  ASSERT_OK(file->Append(Value(0, 100).substr(0, 20)));
+  ASSERT_OK(file->Close());
+
+  Open();
+  for (int i = 0; i < kNumKeys + 100; i++) {
+    ASSERT_EQ(Value(i), Lookup(i));
+  }
+  ASSERT_EQ("NOT_FOUND", Lookup(kNumKeys + 100));
+
+  // New entries go to a new segment
+  Insert(kNumKeys + 100);
+  Open();
+  ASSERT_EQ(Value(kNumKeys + 100), Lookup(kNumKeys + 100));
+  ASSERT_EQ(Value(0), Lookup(0));
+}
+
+TEST_F(PersistentSecondaryCacheTest, Eviction) {
+  Open();
+  constexpr int kNumKeys = 10000;
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(i);
+    ASSERT_LE(cache_->TEST_GetUsage(), opts_.capacity);
+  }
+  ASSERT_OK(cache_->TEST_Flush());
+  // The oldest segments are gone, and the newest are kept
+  ASSERT_EQ("NOT_FOUND", Lookup(0));
+  ASSERT_EQ(Value(kNumKeys - 1), Lookup(kNumKeys - 1));
+  ASSERT_EQ(Value(kNumKeys - 1000), Lookup(kNumKeys - 1000));
+
+  ASSERT_OK(cache_->SetCapacity(2 << 20));
+  size_t capacity = 0;
+  ASSERT_OK(cache_->GetCapacity(capacity));
+  ASSERT_EQ(2 << 20, capacity);
+  ASSERT_LE(cache_->TEST_GetUsage(), 2 << 20);
+  ASSERT_EQ(Value(kNumKeys - 1), Lookup(kNumKeys - 1));
+  ASSERT_EQ("NOT_FOUND", Lookup(kNumKeys - 3000));
+
+  // Segments that do not fit a smaller capacity are deleted on open
+  opts_.capacity = 1 << 20;
+  Open();
+  ASSERT_LE(cache_->TEST_GetUsage(), 1 << 20);
+}
+
+TEST_F(PersistentSecondaryCacheTest, WithPrimaryCache) {
+  Open();
+  std::shared_ptr<Cache> cache =
+      NewCache(/*capacity=*/2500, /*num_shard_bits=*/0,
+               /*strict_capacity_limit=*/false, cache_);
+  for (int i = 0; i < 10; i++) {
+    std::string value = Value(i);
+    ASSERT_OK(cache->Insert(Key(i), new TestItem(value.data(), value.size()),
+                            GetHelper(), value.size()));
+  }
+  ASSERT_OK(cache_->TEST_Flush());
+
+  // Evicted from the primary cache, and found in the persistent cache
+  for (int i = 0; i < 5; i++) {
+    Cache::Handle* handle =
+        cache->Lookup(Key(i), GetHelper(), this, Cache::Priority::LOW);
+    ASSERT_NE(handle, nullptr);
+    auto item = static_cast<TestItem*>(cache->Value(handle));
+    ASSERT_EQ(Value(i), item->ToString());
+    cache->Release(handle);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,12 +5,14 @@
 
 #include "cache/secondary_cache_adapter.h"
 
+#include <algorithm>
 #include <atomic>
 
 #include "cache/tiered_secondary_cache.h"
 #include "monitoring/perf_context_imp.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
+#include "util/hash.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -22,6 +24,22 @@ struct Dummy {
 const Dummy kDummy{};
 Cache::ObjectPtr const kDummyObj = const_cast<Dummy*>(&kDummy);
 const char* kTieredCacheName = "TieredCache";
+// The block size assumed when sizing the ghost table of an adaptive
+// allocation ratio
+constexpr size_t kGhostBlockSize = 4096;
+constexpr size_t kMinGhostSlots = size_t{1} << 10;
+constexpr size_t kMaxGhostSlots = size_t{1} << 20;
+// How much an adaptive allocation ratio changes in one adjustment
+constexpr double kAdaptiveRatioStep = 0.02;
+// How many decompressions a miss, which reads the block from storage, is
+// worth when weighing the two against each other
+constexpr uint64_t kMissCostInDecompressions = 8;
+
+// The fingerprint of a key in the ghost table, with the lowest bit left for
+// the admission flag and never 0, which marks an empty slot
+uint32_t GhostFingerprint(uint64_t hash) {
+  return (Upper32of64(hash) | 2) & ~uint32_t{1};
+}
 }  // namespace
 
 // When CacheWithSecondaryAdapter is constructed with the distribute_cache_res
@@ -86,7 +104,14 @@ CacheWithSecondaryAdapter::CacheWithSecondaryAdapter(
       distribute_cache_res_(distribute_cache_res),
       placeholder_usage_(0),
       reserved_usage_(0),
-      sec_reserved_(0) {
+      sec_reserved_(0),
+      adaptive_ratio_(false),
+      min_ratio_(0.0),
+      max_ratio_(0.0),
+      ghost_mask_(0),
+      primary_misses_(0),
+      secondary_hits_(0),
+      ghost_misses_(0) {
   target_->SetEvictionCallback(
       [this](const Slice& key, Handle* handle, bool was_hit) {
         return EvictionHandler(key, handle, was_hit);
@@ -138,6 +163,9 @@ bool CacheWithSecondaryAdapter::EvictionHandler(const Slice& key,
       if (adm_policy_ == TieredAdmissionPolicy::kAdmPolicyAllowCacheHits) {
         hit = was_hit;
       }
+      if (adaptive_ratio_) {
+        RecordGhost(key, hit);
+      }
       // Spill into secondary cache.
       secondary_cache_->Insert(key, obj, helper, hit).PermitUncheckedError();
     }
@@ -300,6 +328,9 @@ Cache::Handle* CacheWithSecondaryAdapter::Lookup(const Slice& key,
       result = Promote(std::move(secondary_handle), key, helper, priority,
                        stats, found_dummy_entry, kept_in_sec_cache);
     }
+    if (adaptive_ratio_) {
+      RecordSecondaryLookup(key, result != nullptr);
+    }
   }
   return result;
 }
@@ -451,6 +482,9 @@ void CacheWithSecondaryAdapter::WaitAll(AsyncLookupHandle* async_handles,
         std::move(secondary_handle), cur->key, cur->helper, cur->priority,
         cur->stats, cur->found_dummy_entry, cur->kept_in_sec_cache);
     assert(cur->pending_cache == nullptr);
+    if (adaptive_ratio_) {
+      RecordSecondaryLookup(cur->key, cur->result_handle != nullptr);
+    }
   }
 }
 
@@ -573,6 +607,12 @@ Status CacheWithSecondaryAdapter::UpdateCacheReservationRatio(
   }
 
   MutexLock m(&cache_res_mutex_);
+  return UpdateCacheReservationRatioLocked(compressed_secondary_ratio);
+}
+
+Status CacheWithSecondaryAdapter::UpdateCacheReservationRatioLocked(
+    double compressed_secondary_ratio) {
+  cache_res_mutex_.AssertHeld();
   size_t pri_capacity = target_->GetCapacity();
   size_t sec_capacity =
       static_cast<size_t>(pri_capacity * compressed_secondary_ratio);
@@ -639,6 +679,92 @@ Status CacheWithSecondaryAdapter::UpdateAdmissionPolicy(
   return Status::OK();
 }
 
+Status CacheWithSecondaryAdapter::EnableAdaptiveReservationRatio(
+    double min_ratio, double max_ratio) {
+  if (!distribute_cache_res_) {
+    return Status::NotSupported();
+  }
+  // A ratio of 0.0 could not be raised again
+  if (min_ratio <= 0.0 || min_ratio > max_ratio || max_ratio > 1.0) {
+    return Status::InvalidArgument("Invalid adaptive ratio range");
+  }
+  size_t slots = kMinGhostSlots;
+  while (slots < kMaxGhostSlots &&
+         slots * kGhostBlockSize < target_->GetCapacity()) {
+    slots <<= 1;
+  }
+  ghost_.reset(new std::atomic<uint32_t>[slots]);
+  for (size_t i = 0; i < slots; ++i) {
+    ghost_[i].store(0, std::memory_order_relaxed);
+  }
+  ghost_mask_ = slots - 1;
+  min_ratio_ = min_ratio;
+  max_ratio_ = max_ratio;
+  adaptive_ratio_ = true;
+  return Status::OK();
+}
+
+void CacheWithSecondaryAdapter::RecordGhost(const Slice& key, bool was_hit) {
+  uint64_t hash = GetSliceNPHash64(key);
+  std::atomic<uint32_t>& slot = ghost_[hash & ghost_mask_];
+  uint32_t fingerprint = GhostFingerprint(hash);
+  uint32_t old = slot.load(std::memory_order_relaxed);
+  bool admitted;
+  switch (adm_policy_) {
+    case TieredAdmissionPolicy::kAdmPolicyPlaceholder:
+    case TieredAdmissionPolicy::kAdmPolicyAllowCacheHits:
+      // The secondary cache admits a block on its second eviction, or its
+      // first one after a hit with kAdmPolicyAllowCacheHits
+      admitted = was_hit || (old & ~uint32_t{1}) == fingerprint;
+      break;
+    default:
+      admitted = true;
+  }
+  slot.store(fingerprint | (admitted ? 1 : 0), std::memory_order_relaxed);
+}
+
+void CacheWithSecondaryAdapter::RecordSecondaryLookup(const Slice& key,
+                                                      bool found) {
+  if (found) {
+    secondary_hits_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    uint64_t hash = GetSliceNPHash64(key);
+    if (ghost_[hash & ghost_mask_].load(std::memory_order_relaxed) ==
+        (GhostFingerprint(hash) | 1)) {
+      ghost_misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  // Only one of the lookups gets to adjust the ratio
+  if ((primary_misses_.fetch_add(1, std::memory_order_relaxed) + 1) %
+          kAdaptiveRatioInterval ==
+      0) {
+    AdaptCacheReservationRatio();
+  }
+}
+
+// Weighs the decompressions of blocks served by the secondary cache, which
+// a larger primary cache would have spared, against the misses that a
+// larger secondary cache would have spared, and moves one step of the
+// memory budget towards the tier that saves more. The dead band between the
+// two keeps the ratio from oscillating when they are about even.
+void CacheWithSecondaryAdapter::AdaptCacheReservationRatio() {
+  uint64_t decompressions =
+      secondary_hits_.exchange(0, std::memory_order_relaxed);
+  uint64_t misses = ghost_misses_.exchange(0, std::memory_order_relaxed) *
+                    kMissCostInDecompressions;
+
+  MutexLock m(&cache_res_mutex_);
+  double ratio = sec_cache_res_ratio_;
+  if (misses > 2 * decompressions) {
+    ratio = std::min(ratio + kAdaptiveRatioStep, max_ratio_);
+  } else if (decompressions > 2 * misses) {
+    ratio = std::max(ratio - kAdaptiveRatioStep, min_ratio_);
+  }
+  if (ratio != sec_cache_res_ratio_) {
+    UpdateCacheReservationRatioLocked(ratio).PermitUncheckedError();
+  }
+}
+
 std::shared_ptr<Cache> NewTieredCache(const TieredCacheOptions& _opts) {
   if (!_opts.cache_opts) {
     return nullptr;
@@ -711,8 +837,20 @@ std::shared_ptr<Cache> NewTieredCache(const TieredCacheOptions& _opts) {
     }
   }
 
-  return std::make_shared<CacheWithSecondaryAdapter>(
+  auto tiered_cache = std::make_shared<CacheWithSecondaryAdapter>(
       cache, sec_cache, opts.adm_policy, /*distribute_cache_res=*/true);
+  if (opts.adaptive_compressed_secondary_ratio) {
+    if (opts.nvm_sec_cache) {
+      return nullptr;
+    }
+    Status s = tiered_cache->EnableAdaptiveReservationRatio(
+        opts.min_compressed_secondary_ratio,
+        opts.max_compressed_secondary_ratio);
+    if (!s.ok()) {
+      return nullptr;
+    }
+  }
+  return tiered_cache;
 }
 
 Status UpdateTieredCache(const std::shared_ptr<Cache>& cache,
@@ -5,8 +5,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "cache/cache_reservation_manager.h"
 #include "rocksdb/secondary_cache.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -55,12 +59,25 @@ class CacheWithSecondaryAdapter : public CacheWrapper {
 
   Status UpdateAdmissionPolicy(TieredAdmissionPolicy adm_policy);
 
+  // Starts adjusting the secondary/primary allocation ratio between
+  // min_ratio and max_ratio, see
+  // TieredCacheOptions::adaptive_compressed_secondary_ratio
+  Status EnableAdaptiveReservationRatio(double min_ratio, double max_ratio);
+
+  double TEST_GetCacheReservationRatio() {
+    MutexLock l(&cache_res_mutex_);
+    return sec_cache_res_ratio_;
+  }
+
   Cache* TEST_GetCache() { return target_.get(); }
 
   SecondaryCache* TEST_GetSecondaryCache() { return secondary_cache_.get(); }
 
  private:
   static constexpr size_t kReservationChunkSize = 1 << 20;
+  // The number of lookups that miss in the primary cache between two
+  // adjustments of an adaptive allocation ratio
+  static constexpr uint64_t kAdaptiveRatioInterval = 4096;
 
   bool EvictionHandler(const Slice& key, Handle* handle, bool was_hit);
 
@@ -75,6 +92,17 @@ class CacheWithSecondaryAdapter : public CacheWrapper {
 
   void CleanupCacheObject(ObjectPtr obj, const CacheItemHelper* helper);
 
+  Status UpdateCacheReservationRatioLocked(double ratio);
+
+  // Remember a key evicted from the primary cache in ghost_
+  void RecordGhost(const Slice& key, bool was_hit);
+
+  // Count a lookup that missed in the primary cache, and adjust an adaptive
+  // allocation ratio every kAdaptiveRatioInterval of them
+  void RecordSecondaryLookup(const Slice& key, bool found);
+
+  void AdaptCacheReservationRatio();
+
   std::shared_ptr<SecondaryCache> secondary_cache_;
   TieredAdmissionPolicy adm_policy_;
   // Whether to proportionally distribute cache memory reservations, i.e
@@ -98,6 +126,23 @@ class CacheWithSecondaryAdapter : public CacheWrapper {
   // Amount of memory reserved in the secondary cache. This should be
   // reserved_usage_ * sec_cache_res_ratio_ in steady state.
   size_t sec_reserved_;
+  // Whether sec_cache_res_ratio_ is adjusted adaptively, within
+  // [min_ratio_, max_ratio_]. Set before the cache is shared.
+  bool adaptive_ratio_;
+  double min_ratio_;
+  double max_ratio_;
+  // Fingerprints of the keys recently evicted from the primary cache, in a
+  // direct-mapped table. The lowest bit is set once the secondary cache
+  // would have admitted the key, e.g. on its second eviction with
+  // kAdmPolicyPlaceholder.
+  std::unique_ptr<std::atomic<uint32_t>[]> ghost_;
+  size_t ghost_mask_;
+  // Since the last adjustment, the lookups that missed in the primary
+  // cache, those that hit in the secondary cache, and those of keys in
+  // ghost_ that the secondary cache should have admitted but missed
+  std::atomic<uint64_t> primary_misses_;
+  std::atomic<uint64_t> secondary_hits_;
+  std::atomic<uint64_t> ghost_misses_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -62,8 +62,11 @@ ShardedCacheBase::ShardedCacheBase(const ShardedCacheOptions& opts)
       last_id_(1),
       shard_mask_((uint32_t{1} << opts.num_shard_bits) - 1),
       hash_seed_(DetermineSeed(opts.hash_seed)),
+      admission_filter_(opts.admission_filter),
       strict_capacity_limit_(opts.strict_capacity_limit),
-      capacity_(opts.capacity) {}
+      capacity_(opts.capacity) {
+  per_shard_capacity_.StoreRelaxed(ComputePerShardCapacity(capacity_));
+}
 
 size_t ShardedCacheBase::ComputePerShardCapacity(size_t capacity) const {
   uint32_t num_shards = GetNumShards();
@@ -122,10 +125,27 @@ std::string ShardedCacheBase::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    memory_allocator : %s\n",
            memory_allocator() ? memory_allocator()->Name() : "None");
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    admission_filter : %s\n",
+           admission_filter_ ? admission_filter_->Name() : "None");
+  ret.append(buffer);
   AppendPrintableOptions(ret);
   return ret;
 }
 
+Status ShardedCacheBase::RejectInsert(const Slice& key, ObjectPtr obj,
+                                      const CacheItemHelper* helper,
+                                      size_t charge, Handle** handle) {
+  if (handle) {
+    // The caller gets to use the entry, which is just not kept around
+    *handle = CreateStandalone(key, obj, helper, charge,
+                               /*allow_uncharged=*/true);
+    assert(*handle);
+  } else if (helper->del_cb) {
+    helper->del_cb(obj, memory_allocator());
+  }
+  return Status::OK();
+}
+
 int GetDefaultCacheShardBits(size_t capacity, size_t min_shard_size) {
   int num_shard_bits = 0;
   size_t num_shards = capacity / min_shard_size;
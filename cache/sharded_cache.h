@@ -16,6 +16,8 @@
 #include "port/lang.h"
 #include "port/port.h"
 #include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache_admission_filter.h"
+#include "util/atomic.h"
 #include "util/hash.h"
 #include "util/mutexlock.h"
 
@@ -112,11 +114,25 @@ class ShardedCacheBase : public Cache {
   virtual void AppendPrintableOptions(std::string& str) const = 0;
   size_t GetPerShardCapacity() const;
   size_t ComputePerShardCapacity(size_t capacity) const;
+  // Whether an entry of `charge` may go into a shard with `shard_usage`,
+  // according to the admission filter
+  bool AdmitToShard(const Slice& key, size_t charge, size_t shard_usage) {
+    return shard_usage + charge <= per_shard_capacity_.LoadRelaxed() ||
+           admission_filter_->Admit(key);
+  }
+  // Completes an Insert() of an entry that the admission filter rejected
+  Status RejectInsert(const Slice& key, ObjectPtr obj,
+                      const CacheItemHelper* helper, size_t charge,
+                      Handle** handle);
 
  protected:                        // data
   std::atomic<uint64_t> last_id_;  // For NewId
   const uint32_t shard_mask_;
   const uint32_t hash_seed_;
+  const std::shared_ptr<CacheAdmissionFilter> admission_filter_;
+  // Copy of GetPerShardCapacity() for the admission checks, which do not
+  // take config_mutex_
+  RelaxedAtomic<size_t> per_shard_capacity_;
 
   // Dynamic configuration parameters, guarded by config_mutex_
   bool strict_capacity_limit_;
@@ -162,6 +178,7 @@ class ShardedCache : public ShardedCacheBase {
     MutexLock l(&config_mutex_);
     capacity_ = capacity;
     auto per_shard = ComputePerShardCapacity(capacity);
+    per_shard_capacity_.StoreRelaxed(per_shard);
     ForEachShard([=](CacheShard* cs) { cs->SetCapacity(per_shard); });
   }
 
@@ -180,9 +197,13 @@ class ShardedCache : public ShardedCacheBase {
       CompressionType /*type*/ = CompressionType::kNoCompression) override {
     assert(helper);
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
+    CacheShard& shard = GetShard(hash);
+    if (admission_filter_ &&
+        !AdmitToShard(key, charge, shard.GetUsage())) {
+      return RejectInsert(key, obj, helper, charge, handle);
+    }
     auto h_out = reinterpret_cast<HandleImpl**>(handle);
-    return GetShard(hash).Insert(key, hash, obj, helper, charge, h_out,
-                                 priority);
+    return shard.Insert(key, hash, obj, helper, charge, h_out, priority);
   }
 
   Handle* CreateStandalone(const Slice& key, ObjectPtr obj,
@@ -199,6 +220,9 @@ class ShardedCache : public ShardedCacheBase {
                  CreateContext* create_context = nullptr,
                  Priority priority = Priority::LOW,
                  Statistics* stats = nullptr) override {
+    if (admission_filter_) {
+      admission_filter_->RecordAccess(key);
+    }
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
     HandleImpl* result = GetShard(hash).Lookup(key, hash, helper,
                                                create_context, priority, stats);
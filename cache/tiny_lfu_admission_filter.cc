@@ -0,0 +1,221 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/cache_admission_filter.h"
+#include "util/hash.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Rows of the count-min sketch, each indexed with a different hash of the key
+constexpr int kSketchDepth = 4;
+// 4-bit counters, 16 to a word
+constexpr int kCounterBits = 4;
+constexpr uint64_t kCountersPerWord = 64 / kCounterBits;
+constexpr uint64_t kMaxCount = (uint64_t{1} << kCounterBits) - 1;
+// Halving each counter of a word at once
+constexpr uint64_t kHalveMask = 0x7777777777777777;
+// Doorkeeper bits per counter of a row, and bits set per key
+constexpr uint64_t kDoorkeeperBitsPerCounter = 16;
+constexpr int kDoorkeeperProbes = 3;
+// The doorkeeper is cleared after this many accesses per counter of a row,
+// which keeps its false positive rate at about 3%
+constexpr uint64_t kDoorkeeperPeriodMultiplier = 2;
+// The counters are halved after this many accesses per counter of a row
+constexpr uint64_t kSampleSizeMultiplier = 10;
+static_assert(kSampleSizeMultiplier % kDoorkeeperPeriodMultiplier == 0, "");
+constexpr int kMinWidthLog2 = 6;
+// Keeps the doorkeeper bits addressable with 32 bits of hash
+constexpr int kMaxWidthLog2 = 28;
+
+class TinyLfuAdmissionFilter : public CacheAdmissionFilter {
+ public:
+  TinyLfuAdmissionFilter(size_t expected_entries, uint32_t min_frequency)
+      : width_log2_(WidthLog2(expected_entries)),
+        width_mask_((uint64_t{1} << width_log2_) - 1),
+        words_per_row_((width_mask_ + 1) / kCountersPerWord),
+        doorkeeper_mask_((width_mask_ + 1) * kDoorkeeperBitsPerCounter - 1),
+        min_frequency_(
+            std::min(uint64_t{min_frequency}, kMaxCount + /*doorkeeper*/ 1)),
+        doorkeeper_period_((width_mask_ + 1) * kDoorkeeperPeriodMultiplier),
+        sample_size_((width_mask_ + 1) * kSampleSizeMultiplier),
+        counters_(new std::atomic<uint64_t>[kSketchDepth * words_per_row_]),
+        doorkeeper_(new std::atomic<uint64_t>[doorkeeper_mask_ / 64 + 1]),
+        accesses_(0) {
+    for (uint64_t i = 0; i < kSketchDepth * words_per_row_; ++i) {
+      counters_[i].store(0, std::memory_order_relaxed);
+    }
+    for (uint64_t i = 0; i <= doorkeeper_mask_ / 64; ++i) {
+      doorkeeper_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const char* Name() const override { return "TinyLfuAdmissionFilter"; }
+
+  void RecordAccess(const Slice& key) override {
+    const uint64_t hash = NPHash64(key.data(), key.size());
+    // The first access only goes to the doorkeeper
+    if (AddToDoorkeeper(hash)) {
+      IncrementSketch(hash);
+    }
+    const uint64_t accesses =
+        accesses_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (accesses % doorkeeper_period_ == 0) {
+      if (accesses == sample_size_) {
+        HalveCounters();
+        accesses_.fetch_sub(sample_size_, std::memory_order_relaxed);
+      }
+      ClearDoorkeeper();
+    }
+  }
+
+  bool Admit(const Slice& key) override {
+    const uint64_t hash = NPHash64(key.data(), key.size());
+    uint64_t estimate = InDoorkeeper(hash) ? 1 : 0;
+    if (estimate < min_frequency_) {
+      uint64_t counts[kSketchDepth];
+      estimate += MinCount(hash, counts);
+    }
+    return estimate >= min_frequency_;
+  }
+
+ private:
+  static int WidthLog2(size_t expected_entries) {
+    int width_log2 = kMinWidthLog2;
+    if (expected_entries > (size_t{1} << kMinWidthLog2)) {
+      width_log2 = FloorLog2(expected_entries - 1) + 1;
+    }
+    return std::min(width_log2, kMaxWidthLog2);
+  }
+
+  // The counter of the key in the given row
+  uint64_t CounterIndex(uint64_t hash, int row) const {
+    const uint64_t a = Lower32of64(hash);
+    const uint64_t b = Upper32of64(hash) | 1;
+    return (a + static_cast<uint64_t>(row) * b) & width_mask_;
+  }
+
+  std::atomic<uint64_t>& CounterWord(int row, uint64_t index) {
+    return counters_[row * words_per_row_ + index / kCountersPerWord];
+  }
+
+  static int CounterShift(uint64_t index) {
+    return static_cast<int>(index % kCountersPerWord) * kCounterBits;
+  }
+
+  // Returns the smallest counter of the key, and stores each one in counts
+  uint64_t MinCount(uint64_t hash, uint64_t* counts) {
+    uint64_t min_count = kMaxCount;
+    for (int row = 0; row < kSketchDepth; ++row) {
+      const uint64_t index = CounterIndex(hash, row);
+      const uint64_t word =
+          CounterWord(row, index).load(std::memory_order_relaxed);
+      counts[row] = (word >> CounterShift(index)) & kMaxCount;
+      min_count = std::min(min_count, counts[row]);
+    }
+    return min_count;
+  }
+
+  // Conservative update: only the counters at the estimate are incremented,
+  // which keeps the other keys sharing the larger ones from being
+  // overestimated further
+  void IncrementSketch(uint64_t hash) {
+    uint64_t counts[kSketchDepth];
+    const uint64_t min_count = MinCount(hash, counts);
+    if (min_count == kMaxCount) {
+      return;
+    }
+    for (int row = 0; row < kSketchDepth; ++row) {
+      if (counts[row] != min_count) {
+        continue;
+      }
+      const uint64_t index = CounterIndex(hash, row);
+      const int shift = CounterShift(index);
+      auto& word = CounterWord(row, index);
+      uint64_t old_word = word.load(std::memory_order_relaxed);
+      do {
+        if (((old_word >> shift) & kMaxCount) == kMaxCount) {
+          break;
+        }
+      } while (!word.compare_exchange_weak(old_word,
+                                           old_word + (uint64_t{1} << shift),
+                                           std::memory_order_relaxed));
+    }
+  }
+
+  uint64_t DoorkeeperBit(uint64_t hash, int probe) const {
+    // Independent of the bits that index the sketch
+    const uint64_t mixed = (hash ^ static_cast<uint64_t>(probe)) *
+                           0x9E3779B97F4A7C15U;
+    return Upper32of64(mixed) & doorkeeper_mask_;
+  }
+
+  bool InDoorkeeper(uint64_t hash) {
+    for (int probe = 0; probe < kDoorkeeperProbes; ++probe) {
+      const uint64_t bit = DoorkeeperBit(hash, probe);
+      if ((doorkeeper_[bit / 64].load(std::memory_order_relaxed) &
+           (uint64_t{1} << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns whether the key was in the doorkeeper already
+  bool AddToDoorkeeper(uint64_t hash) {
+    bool found = true;
+    for (int probe = 0; probe < kDoorkeeperProbes; ++probe) {
+      const uint64_t bit = DoorkeeperBit(hash, probe);
+      const uint64_t mask = uint64_t{1} << (bit % 64);
+      auto& word = doorkeeper_[bit / 64];
+      if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+        word.fetch_or(mask, std::memory_order_relaxed);
+        found = false;
+      }
+    }
+    return found;
+  }
+
+  // Ages the estimates. Increments racing with this may get lost, which
+  // only makes the estimates a bit lower.
+  void HalveCounters() {
+    for (uint64_t i = 0; i < kSketchDepth * words_per_row_; ++i) {
+      const uint64_t word = counters_[i].load(std::memory_order_relaxed);
+      counters_[i].store((word >> 1) & kHalveMask, std::memory_order_relaxed);
+    }
+  }
+
+  void ClearDoorkeeper() {
+    for (uint64_t i = 0; i <= doorkeeper_mask_ / 64; ++i) {
+      doorkeeper_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const int width_log2_;
+  const uint64_t width_mask_;
+  const uint64_t words_per_row_;
+  const uint64_t doorkeeper_mask_;
+  const uint64_t min_frequency_;
+  const uint64_t doorkeeper_period_;
+  const uint64_t sample_size_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counters_;
+  std::unique_ptr<std::atomic<uint64_t>[]> doorkeeper_;
+  std::atomic<uint64_t> accesses_;
+};
+}  // namespace
+
+std::shared_ptr<CacheAdmissionFilter> NewTinyLfuAdmissionFilter(
+    size_t expected_entries, uint32_t min_frequency) {
+  return std::make_shared<TinyLfuAdmissionFilter>(expected_entries,
+                                                  min_frequency);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
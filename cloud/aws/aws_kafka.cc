@@ -4,9 +4,15 @@
 // A log file maps to a stream in Kinesis.
 //
 
+#include <atomic>
 #include <cinttypes>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "cloud/cloud_log_controller_impl.h"
 #include "rocksdb/cloud/cloud_file_system.h"
@@ -22,6 +28,59 @@ namespace ROCKSDB_NAMESPACE {
 namespace cloud {
 namespace kafka {
 
+/***************************************************/
+/*              KafkaDeliveryTracker               */
+/***************************************************/
+// Messages produced by a writable file whose delivery was not reported yet.
+// Shared with the delivery reports, which can outlive the file.
+struct KafkaDeliveryTracker {
+  explicit KafkaDeliveryTracker(
+      std::shared_ptr<std::atomic<uint64_t>> _in_flight_bytes)
+      : in_flight_bytes(std::move(_in_flight_bytes)) {}
+
+  std::mutex mutex;
+  // Sequence numbers of the messages in flight
+  std::set<uint64_t> in_flight;
+  uint64_t next_seq = 0;
+  // First failed delivery
+  IOStatus status;
+  // Shared by all the files of a controller
+  std::shared_ptr<std::atomic<uint64_t>> in_flight_bytes;
+};
+
+// The opaque of a tracked message
+struct KafkaDelivery {
+  std::shared_ptr<KafkaDeliveryTracker> tracker;
+  uint64_t seq;
+  size_t size;
+};
+
+class KafkaDeliveryReportCb : public RdKafka::DeliveryReportCb {
+ public:
+  // Runs from RdKafka::Producer::poll()
+  void dr_cb(RdKafka::Message& message) override {
+    std::unique_ptr<KafkaDelivery> delivery(
+        static_cast<KafkaDelivery*>(message.msg_opaque()));
+    if (!delivery) {
+      return;
+    }
+    auto& tracker = *delivery->tracker;
+    std::lock_guard<std::mutex> lk(tracker.mutex);
+    tracker.in_flight.erase(delivery->seq);
+    tracker.in_flight_bytes->fetch_sub(delivery->size);
+    if (message.err() != RdKafka::ERR_NO_ERROR && tracker.status.ok()) {
+      tracker.status = IOStatus::IOError(message.topic_name().c_str(),
+                                         RdKafka::err2str(message.err()));
+    }
+  }
+
+  // Stateless, so a single instance outlives every producer
+  static KafkaDeliveryReportCb* Get() {
+    static KafkaDeliveryReportCb cb;
+    return &cb;
+  }
+};
+
 /***************************************************/
 /*                KafkaWritableFile                */
 /***************************************************/
@@ -32,11 +91,18 @@ class KafkaWritableFile : public CloudLogWritableFile {
   KafkaWritableFile(Env* env, CloudFileSystem* cloud_fs,
                     const std::string& fname, const FileOptions& options,
                     std::shared_ptr<RdKafka::Producer> producer,
-                    std::shared_ptr<RdKafka::Topic> topic)
+                    std::shared_ptr<RdKafka::Topic> topic,
+                    std::shared_ptr<std::atomic<uint64_t>> in_flight_bytes)
       : CloudLogWritableFile(env, cloud_fs, fname, options),
         producer_(std::move(producer)),
         topic_(std::move(topic)),
-        current_offset_(0) {
+        current_offset_(0),
+        max_in_flight_(cloud_fs_->GetCloudFileSystemOptions()
+                           .kafka_log_options.max_in_flight_messages) {
+    if (max_in_flight_ > 0) {
+      tracker_ =
+          std::make_shared<KafkaDeliveryTracker>(std::move(in_flight_bytes));
+    }
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
         "[kafka] WritableFile opened file %s", fname_.c_str());
   }
@@ -53,11 +119,22 @@ class KafkaWritableFile : public CloudLogWritableFile {
 
  private:
   IOStatus ProduceRaw(const std::string& operation_name, const Slice& message);
+  // With max_in_flight_messages, serves delivery reports until done()
+  // returns true (called with the tracker mutex held), a delivery fails, or
+  // kFlushTimeout passes.
+  IOStatus WaitForDeliveries(const char* operation_name,
+                             const std::function<bool()>& done);
+  // Waits for the delivery of every message produced so far
+  IOStatus WaitForAllDeliveries(const char* operation_name);
 
   std::shared_ptr<RdKafka::Producer> producer_;
   std::shared_ptr<RdKafka::Topic> topic_;
 
   uint64_t current_offset_;
+
+  const size_t max_in_flight_;
+  // Null unless max_in_flight_messages
+  std::shared_ptr<KafkaDeliveryTracker> tracker_;
 };
 const std::chrono::microseconds KafkaWritableFile::kFlushTimeout =
     std::chrono::seconds(10);
@@ -68,11 +145,34 @@ IOStatus KafkaWritableFile::ProduceRaw(const std::string& operation_name,
     return status_;
   }
 
+  KafkaDelivery* delivery = nullptr;
+  if (tracker_) {
+    // Keep the window bounded
+    auto st = WaitForDeliveries(operation_name.c_str(), [this]() {
+      return tracker_->in_flight.size() < max_in_flight_;
+    });
+    if (!st.ok()) {
+      return st;
+    }
+    std::lock_guard<std::mutex> lk(tracker_->mutex);
+    delivery = new KafkaDelivery{tracker_, tracker_->next_seq++,
+                                 message.size()};
+    tracker_->in_flight.insert(delivery->seq);
+    tracker_->in_flight_bytes->fetch_add(message.size());
+  }
+
   RdKafka::ErrorCode resp;
   resp = producer_->produce(
       topic_.get(), RdKafka::Topic::PARTITION_UA /* UnAssigned */,
       RdKafka::Producer::RK_MSG_COPY /* Copy payload */, (void*)message.data(),
-      message.size(), &fname_ /* Partitioning key */, nullptr);
+      message.size(), &fname_ /* Partitioning key */, delivery);
+  if (resp != RdKafka::ERR_NO_ERROR && delivery != nullptr) {
+    // No delivery report for a message that was not produced
+    std::lock_guard<std::mutex> lk(tracker_->mutex);
+    tracker_->in_flight.erase(delivery->seq);
+    tracker_->in_flight_bytes->fetch_sub(delivery->size);
+    delete delivery;
+  }
 
   if (resp == RdKafka::ERR_NO_ERROR) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
@@ -96,9 +196,46 @@ IOStatus KafkaWritableFile::ProduceRaw(const std::string& operation_name,
     return IOStatus::IOError(topic_->name().c_str(),
                              RdKafka::err2str(resp).c_str());
   }
-  current_offset_ += message.size();
+}
 
-  return IOStatus::OK();
+IOStatus KafkaWritableFile::WaitForDeliveries(
+    const char* operation_name, const std::function<bool()>& done) {
+  std::chrono::microseconds start(env_->NowMicros());
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lk(tracker_->mutex);
+      if (!tracker_->status.ok()) {
+        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+            "[kafka] WritableFile src %s %s delivery error %s",
+            fname_.c_str(), operation_name,
+            tracker_->status.ToString().c_str());
+        return tracker_->status;
+      }
+      if (done()) {
+        return IOStatus::OK();
+      }
+    }
+    if (std::chrono::microseconds(env_->NowMicros()) - start > kFlushTimeout) {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[kafka] WritableFile src %s %s timed out after %" PRId64 "us",
+          fname_.c_str(), operation_name, kFlushTimeout.count());
+      return IOStatus::TimedOut();
+    }
+    producer_->poll(10);
+  }
+}
+
+IOStatus KafkaWritableFile::WaitForAllDeliveries(const char* operation_name) {
+  uint64_t sync_seq;
+  {
+    std::lock_guard<std::mutex> lk(tracker_->mutex);
+    sync_seq = tracker_->next_seq;
+  }
+  // Messages produced after this point don't hold us up
+  return WaitForDeliveries(operation_name, [this, sync_seq]() {
+    return tracker_->in_flight.empty() ||
+           *tracker_->in_flight.begin() >= sync_seq;
+  });
 }
 
 IOStatus KafkaWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
@@ -107,7 +244,11 @@ IOStatus KafkaWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
   CloudLogControllerImpl::SerializeLogRecordAppend(
       fname_, data, current_offset_, &serialized_data);
 
-  return ProduceRaw("Append", serialized_data);
+  auto st = ProduceRaw("Append", serialized_data);
+  if (st.ok()) {
+    current_offset_ += data.size();
+  }
+  return st;
 }
 
 IOStatus KafkaWritableFile::Close(const IOOptions& /*opts*/,
@@ -115,6 +256,14 @@ IOStatus KafkaWritableFile::Close(const IOOptions& /*opts*/,
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
       "[kafka] S3WritableFile closing %s", fname_.c_str());
 
+  if (tracker_) {
+    // The end of the file must not overtake its appends
+    auto st = WaitForAllDeliveries("Close");
+    if (!st.ok()) {
+      return st;
+    }
+  }
+
   std::string serialized_data;
   CloudLogControllerImpl::SerializeLogRecordClosed(fname_, current_offset_,
                                                    &serialized_data);
@@ -125,11 +274,27 @@ IOStatus KafkaWritableFile::Close(const IOOptions& /*opts*/,
 bool KafkaWritableFile::IsSyncThreadSafe() const { return true; }
 
 IOStatus KafkaWritableFile::Sync(const IOOptions& opts, IODebugContext* dbg) {
+  if (tracker_) {
+    if (!status_.ok()) {
+      return status_;
+    }
+    return WaitForAllDeliveries("Sync");
+  }
   return Flush(opts, dbg);
 }
 
 IOStatus KafkaWritableFile::Flush(const IOOptions& /*opts*/,
                                   IODebugContext* /*dbg*/) {
+  if (tracker_) {
+    // Only serve the delivery reports that are ready, Sync does the waiting
+    producer_->poll(0);
+    if (!status_.ok()) {
+      return status_;
+    }
+    std::lock_guard<std::mutex> lk(tracker_->mutex);
+    return tracker_->status;
+  }
+
   std::chrono::microseconds start(env_->NowMicros());
 
   bool done = false;
@@ -181,6 +346,8 @@ IOStatus KafkaWritableFile::LogDelete() {
 class KafkaController : public CloudLogControllerImpl {
  public:
   ~KafkaController() {
+    // The shared tailer polls the partitions until then
+    StopTailingStream();
     for (size_t i = 0; i < partitions_.size(); i++) {
       consumer_->stop(consumer_topic_.get(), partitions_[i]->partition());
     }
@@ -210,20 +377,48 @@ class KafkaController : public CloudLogControllerImpl {
                                            IODebugContext* dbg) override;
   Status PrepareOptions(const ConfigOptions& options) override;
 
+  uint64_t GetInFlightBytes() const override {
+    return in_flight_bytes_->load();
+  }
+
  protected:
+  IOStatus StartSharedTailing() override;
 
  private:
   Status InitializePartitions();
 
+  // Tails partition i until the tailing stops or fails
+  Status TailPartition(size_t i);
+  // Reads and applies a batch of messages of partition i, waiting up to
+  // timeout_ms for the first one. Sets *idle if there was none. Returns
+  // non-OK once it gives up on the partition.
+  Status PollPartition(size_t i, int timeout_ms, bool* idle);
+
   std::shared_ptr<RdKafka::Producer> producer_;
   std::shared_ptr<RdKafka::Consumer> consumer_;
 
   std::shared_ptr<RdKafka::Topic> producer_topic_;
   std::shared_ptr<RdKafka::Topic> consumer_topic_;
 
-  std::shared_ptr<RdKafka::Queue> consuming_queue_;
-
+  // The partitions and their queues. Each partition is consumed from its own
+  // queue by one thread, which alone touches its entries.
   std::vector<std::shared_ptr<RdKafka::TopicPartition>> partitions_;
+  std::vector<std::shared_ptr<RdKafka::Queue>> partition_queues_;
+  // The state of tailing each partition
+  struct PartitionTail {
+    // Of the last batch applied
+    Status status;
+    Status last_error;
+    int retry_attempt = 0;
+  };
+  std::vector<PartitionTail> partition_tails_;
+
+  // Set once a partition tailer gives up, to stop the others
+  std::atomic<bool> tail_failed_{false};
+
+  // Bytes produced by the writable files and not delivered yet
+  std::shared_ptr<std::atomic<uint64_t>> in_flight_bytes_ =
+      std::make_shared<std::atomic<uint64_t>>(0);
 };
 
 Status KafkaController::PrepareOptions(const ConfigOptions& options) {
@@ -252,6 +447,15 @@ Status KafkaController::PrepareOptions(const ConfigOptions& options) {
       return s;
     }
   }
+  if (conf->set("dr_cb", KafkaDeliveryReportCb::Get(), conf_errstr) !=
+      RdKafka::Conf::CONF_OK) {
+    Status s = Status::InvalidArgument(
+        "Failed adding delivery report callback to Kafka conf",
+        conf_errstr.c_str());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+        "Kafka conf set error: %s", s.ToString().c_str());
+    return s;
+  }
 
   producer_.reset(RdKafka::Producer::create(conf.get(), producer_errstr));
   consumer_.reset(RdKafka::Consumer::create(conf.get(), consumer_errstr));
@@ -279,7 +483,6 @@ Status KafkaController::PrepareOptions(const ConfigOptions& options) {
     std::string pt_errstr, ct_errstr;
 
     // Initialize stream name.
-    consuming_queue_.reset(RdKafka::Queue::create(consumer_.get()));
     producer_topic_.reset(
         RdKafka::Topic::create(producer_.get(), topic_name, NULL, pt_errstr));
     consumer_topic_.reset(
@@ -287,7 +490,6 @@ Status KafkaController::PrepareOptions(const ConfigOptions& options) {
 
     assert(producer_topic_ != nullptr);
     assert(consumer_topic_ != nullptr);
-    assert(consuming_queue_ != nullptr);
   }
   if (s.ok()) {
     s = CloudLogControllerImpl::PrepareOptions(options);
@@ -303,70 +505,153 @@ IOStatus KafkaController::TailStream() {
   }
 
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[%s] TailStream topic %s %s", Name(), consumer_topic_->name().c_str(),
+      "[%s] TailStream topic %s %" ROCKSDB_PRIszt " partitions %s", Name(),
+      consumer_topic_->name().c_str(), partitions_.size(),
       status_.ToString().c_str());
 
-  Status lastErrorStatus;
-  int retryAttempt = 0;
-  while (IsRunning()) {
-    if (retryAttempt > 10) {
-      status_ = lastErrorStatus;
+  // The records of a file all go to one partition, keyed by its name, so the
+  // partitions are tailed and applied in parallel, this thread taking the
+  // first one
+  std::vector<Status> statuses(partitions_.size());
+  std::vector<std::thread> tailers;
+  for (size_t i = 1; i < partitions_.size(); i++) {
+    tailers.emplace_back([this, i, &statuses]() {
+      statuses[i] = TailPartition(i);
+    });
+  }
+  if (!partitions_.empty()) {
+    statuses[0] = TailPartition(0);
+  }
+  for (auto& tailer : tailers) {
+    tailer.join();
+  }
+  for (const auto& s : statuses) {
+    if (!s.ok()) {
+      status_ = s;
+      break;
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+      "[%s] TailStream topic %s finished: %s", Name(),
+      consumer_topic_->name().c_str(), status_.ToString().c_str());
+
+  return status_to_io_status(Status(status_));
+}
+
+Status KafkaController::TailPartition(size_t i) {
+  Status st;
+  while (IsRunning() && !tail_failed_) {
+    bool idle = false;
+    st = PollPartition(i, 1000 /* timeout_ms */, &idle);
+    if (!st.ok()) {
       break;
     }
+  }
+  if (st.ok()) {
+    st = partition_tails_[i].status;
+  } else if (IsRunning()) {
+    tail_failed_ = true;
+  }
+  return st;
+}
 
-    std::unique_ptr<RdKafka::Message> message(
-        consumer_->consume(consuming_queue_.get(), 1000));
-
-    switch (message->err()) {
-      case RdKafka::ERR_NO_ERROR: {
-        /* Real message */
-        Slice sl(static_cast<const char*>(message->payload()),
-                 static_cast<size_t>(message->len()));
-
-        // Apply the payload to local filesystem
-        status_ = Apply(sl);
-        if (!status_.ok()) {
-          Log(InfoLogLevel::ERROR_LEVEL, cloud_fs_->GetLogger(),
-              "[%s] error processing message size %ld "
-              "extracted from stream %s %s",
-              Name(), message->len(), consumer_topic_->name().c_str(),
-              status_.ToString().c_str());
-        } else {
-          Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-              "[%s] successfully processed message size %ld "
-              "extracted from stream %s %s",
-              Name(), message->len(), consumer_topic_->name().c_str(),
-              status_.ToString().c_str());
-        }
-
-        // Remember last read offset from topic (currently unused).
-        partitions_[message->partition()]->set_offset(message->offset());
-        break;
-      }
-      case RdKafka::ERR__PARTITION_EOF: {
-        // There are no new messages.
-        consumer_->poll(50);
-        break;
-      }
-      default: {
-        lastErrorStatus =
-            Status::IOError(consumer_topic_->name().c_str(),
-                            RdKafka::err2str(message->err()).c_str());
+Status KafkaController::PollPartition(size_t i, int timeout_ms, bool* idle) {
+  auto& tail = partition_tails_[i];
+  *idle = false;
+  if (tail.retry_attempt > 10) {
+    return tail.last_error;
+  }
 
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] error reading %s %s", Name(), consumer_topic_->name().c_str(),
-            RdKafka::err2str(message->err()).c_str());
+  // Drain the messages that are already queued, so that they are applied
+  // as one batch
+  std::vector<std::unique_ptr<RdKafka::Message>> batch;
+  std::unique_ptr<RdKafka::Message> message;
+  while (batch.size() < kMaxApplyBatch) {
+    message.reset(consumer_->consume(partition_queues_[i].get(),
+                                     batch.empty() ? timeout_ms : 0));
+    if (message->err() != RdKafka::ERR_NO_ERROR) {
+      break;
+    }
+    batch.push_back(std::move(message));
+  }
 
-        ++retryAttempt;
-        break;
-      }
+  if (!batch.empty()) {
+    std::vector<Slice> payloads;
+    payloads.reserve(batch.size());
+    size_t num_bytes = 0;
+    for (const auto& m : batch) {
+      payloads.emplace_back(static_cast<const char*>(m->payload()), m->len());
+      num_bytes += m->len();
+    }
+
+    // Apply the payloads to local filesystem
+    tail.status = ApplyBatch(payloads);
+    if (!tail.status.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] error processing %" ROCKSDB_PRIszt " messages (%" ROCKSDB_PRIszt
+          " bytes) from stream %s [%" PRId32 "] %s",
+          Name(), batch.size(), num_bytes, consumer_topic_->name().c_str(),
+          partitions_[i]->partition(), tail.status.ToString().c_str());
+    } else {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] successfully processed %" ROCKSDB_PRIszt
+          " messages (%" ROCKSDB_PRIszt " bytes) from stream %s [%" PRId32
+          "] %s",
+          Name(), batch.size(), num_bytes, consumer_topic_->name().c_str(),
+          partitions_[i]->partition(), tail.status.ToString().c_str());
     }
+
+    // Remember last read offset from the partition (currently unused).
+    partitions_[i]->set_offset(batch.back()->offset());
+  }
+  if (message == nullptr) {
+    // The batch is full
+    return Status::OK();
   }
-  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[%s] TailStream topic %s finished: %s", Name(),
-      consumer_topic_->name().c_str(), status_.ToString().c_str());
 
-  return status_to_io_status(Status(status_));
+  switch (message->err()) {
+    case RdKafka::ERR__TIMED_OUT:
+      *idle = batch.empty();
+      break;
+    case RdKafka::ERR__PARTITION_EOF: {
+      // There are no new messages.
+      *idle = true;
+      consumer_->poll(0);
+      break;
+    }
+    default: {
+      tail.last_error =
+          Status::IOError(consumer_topic_->name().c_str(),
+                          RdKafka::err2str(message->err()).c_str());
+
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] error reading %s [%" PRId32 "] %s", Name(),
+          consumer_topic_->name().c_str(), partitions_[i]->partition(),
+          RdKafka::err2str(message->err()).c_str());
+
+      ++tail.retry_attempt;
+      *idle = true;
+      break;
+    }
+  }
+  return Status::OK();
+}
+
+IOStatus KafkaController::StartSharedTailing() {
+  InitializePartitions();
+  if (!status_.ok()) {
+    return status_to_io_status(Status(status_));
+  }
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    AddTailerStream([this, i](bool* idle, bool* done) {
+      auto st = PollPartition(i, 0 /* timeout_ms */, idle);
+      if (!st.ok() && !tail_failed_.exchange(true)) {
+        status_ = st;
+      }
+      *done = tail_failed_;
+    });
+  }
+  return IOStatus::OK();
 }
 
 Status KafkaController::InitializePartitions() {
@@ -401,8 +686,6 @@ Status KafkaController::InitializePartitions() {
         RdKafka::TopicPartition::create(topic_metadata->topic(), 0)));
     partitions_.back()->set_offset(0);
   } else {
-    assert(topic_metadata->partitions()->size() == 1);
-
     for (auto partition_metadata : *(topic_metadata->partitions())) {
       partitions_.push_back(std::shared_ptr<RdKafka::TopicPartition>(
           RdKafka::TopicPartition::create(topic_metadata->topic(),
@@ -412,12 +695,14 @@ Status KafkaController::InitializePartitions() {
   }
 
   for (size_t i = 0; i < partitions_.size(); i++) {
+    partition_queues_.emplace_back(RdKafka::Queue::create(consumer_.get()));
+    partition_tails_.emplace_back();
     if (partitions_[i]->offset() > 0) {
       continue;
     }
 
     consumer_->start(consumer_topic_.get(), partitions_[i]->partition(),
-                     partitions_[i]->offset(), consuming_queue_.get());
+                     partitions_[i]->offset(), partition_queues_[i].get());
   }
 
   return status_;
@@ -427,7 +712,7 @@ CloudLogWritableFile* KafkaController::CreateWritableFile(
     const std::string& fname, const FileOptions& options,
     IODebugContext* /*dbg*/) {
   return new KafkaWritableFile(env_, cloud_fs_, fname, options, producer_,
-                               producer_topic_);
+                               producer_topic_, in_flight_bytes_);
 }
 
 }  // namespace kafka
@@ -4,6 +4,7 @@
 // A log file maps to a stream in Kinesis.
 //
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -19,7 +20,10 @@
 #include <aws/core/utils/Outcome.h>
 #include <aws/kinesis/KinesisClient.h>
 #include <aws/kinesis/KinesisErrors.h>
+#include <aws/kinesis/model/ConsumerStatus.h>
 #include <aws/kinesis/model/CreateStreamRequest.h>
+#include <aws/kinesis/model/DescribeStreamConsumerRequest.h>
+#include <aws/kinesis/model/DescribeStreamConsumerResult.h>
 #include <aws/kinesis/model/DescribeStreamRequest.h>
 #include <aws/kinesis/model/DescribeStreamResult.h>
 #include <aws/kinesis/model/GetRecordsRequest.h>
@@ -30,9 +34,17 @@
 #include <aws/kinesis/model/PutRecordResult.h>
 #include <aws/kinesis/model/PutRecordsRequest.h>
 #include <aws/kinesis/model/PutRecordsRequestEntry.h>
+#include <aws/kinesis/model/PutRecordsResult.h>
 #include <aws/kinesis/model/Record.h>
+#include <aws/kinesis/model/RegisterStreamConsumerRequest.h>
+#include <aws/kinesis/model/RegisterStreamConsumerResult.h>
 #include <aws/kinesis/model/ShardIteratorType.h>
+#include <aws/kinesis/model/StartingPosition.h>
 #include <aws/kinesis/model/StreamDescription.h>
+#include <aws/kinesis/model/StreamStatus.h>
+#include <aws/kinesis/model/SubscribeToShardEvent.h>
+#include <aws/kinesis/model/SubscribeToShardHandler.h>
+#include <aws/kinesis/model/SubscribeToShardRequest.h>
 namespace ROCKSDB_NAMESPACE {
 namespace cloud {
 namespace kinesis {
@@ -59,6 +71,8 @@ class KinesisWritableFile : public CloudLogWritableFile {
   using CloudLogWritableFile::Append;
   IOStatus Append(const Slice& data, const IOOptions& io_opts,
                   IODebugContext* dbg) override;
+  IOStatus Flush(const IOOptions& io_opts, IODebugContext* dbg) override;
+  IOStatus Sync(const IOOptions& io_opts, IODebugContext* dbg) override;
   IOStatus Close(const IOOptions& io_opts, IODebugContext* dbg) override;
   IOStatus LogDelete() override;
   uint64_t GetFileSize(const IOOptions& /*options*/,
@@ -67,16 +81,148 @@ class KinesisWritableFile : public CloudLogWritableFile {
   }
 
  private:
+  // Largest appended payload sent in a single record. Kinesis caps records
+  // at 1MB, and the header and partition key need some room.
+  static constexpr size_t kMaxRecordPayload = 1000 * 1024;
+  // PutRecords limits
+  static constexpr size_t kMaxBatchRecords = 500;
+  static constexpr size_t kMaxBatchBytes = 5 * 1024 * 1024;
+  static constexpr int kMaxBatchAttempts = 5;
+
+  // Sends the buffered appends, if any
+  IOStatus FlushBatch();
+  // Sends the records with PutRecords, resending the records that failed
+  IOStatus PutRecords(std::vector<std::string>* records);
+
   std::shared_ptr<Aws::Kinesis::KinesisClient> kinesis_client_;
   Aws::String topic_;
   uint64_t current_offset_;
+
+  // With cloud_log_batch_size, data appended since the last batch. It goes
+  // at current_offset_ - batch_.size() in the file.
+  std::string batch_;
+  uint64_t batch_start_micros_ = 0;
 };
 
+IOStatus KinesisWritableFile::FlushBatch() {
+  if (batch_.empty()) {
+    return IOStatus::OK();
+  }
+  // Appends carry their offset in the file, so the tailer applies them in
+  // any order; only the Closed record has to come after all of them, which
+  // Close guarantees by flushing first.
+  std::vector<std::string> records;
+  uint64_t offset = current_offset_ - batch_.size();
+  Slice left(batch_);
+  while (!left.empty()) {
+    Slice chunk(left.data(), std::min(left.size(), kMaxRecordPayload));
+    records.emplace_back();
+    CloudLogControllerImpl::SerializeLogRecordAppend(fname_, chunk, offset,
+                                                     &records.back());
+    offset += chunk.size();
+    left.remove_prefix(chunk.size());
+  }
+  auto st = PutRecords(&records);
+  if (st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[kinesis] WritableFile Append file %s %ld in %ld records",
+        fname_.c_str(), batch_.size(), records.size());
+    batch_.clear();
+  }
+  return st;
+}
+
+IOStatus KinesisWritableFile::PutRecords(std::vector<std::string>* records) {
+  std::vector<std::string> failed;
+  for (int attempt = 1;; attempt++) {
+    for (size_t next = 0; next < records->size();) {
+      // Fill a request within the PutRecords limits
+      Aws::Kinesis::Model::PutRecordsRequest request;
+      request.SetStreamName(topic_);
+      size_t first = next;
+      size_t request_bytes = 0;
+      while (next < records->size() && next - first < kMaxBatchRecords &&
+             (next == first ||
+              request_bytes + (*records)[next].size() <= kMaxBatchBytes)) {
+        const auto& record = (*records)[next++];
+        Aws::Kinesis::Model::PutRecordsRequestEntry entry;
+        entry.SetPartitionKey(Aws::String(fname_.c_str(), fname_.size()));
+        entry.SetData(Aws::Utils::ByteBuffer(
+            (const unsigned char*)record.c_str(), record.size()));
+        request.AddRecords(std::move(entry));
+        request_bytes += record.size();
+      }
+
+      const auto& outcome = kinesis_client_->PutRecords(request);
+      if (!outcome.IsSuccess()) {
+        const auto& error = outcome.GetError();
+        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+            "[kinesis] WritableFile %s PutRecords error %s", fname_.c_str(),
+            error.GetMessage().c_str());
+        return IOStatus::IOError(fname_, error.GetMessage().c_str());
+      }
+      // Entries of the result match the entries of the request
+      const auto& results = outcome.GetResult().GetRecords();
+      for (size_t i = 0; i < results.size(); i++) {
+        if (!results[i].GetErrorCode().empty()) {
+          failed.push_back(std::move((*records)[first + i]));
+        }
+      }
+    }
+    if (failed.empty()) {
+      return IOStatus::OK();
+    }
+    if (attempt >= kMaxBatchAttempts) {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[kinesis] WritableFile %s PutRecords failed %ld records",
+          fname_.c_str(), failed.size());
+      return IOStatus::IOError(fname_, "PutRecords failed");
+    }
+    // Usually throttling, give the shard some time
+    std::this_thread::sleep_for(std::chrono::milliseconds(100 * attempt));
+    records->swap(failed);
+    failed.clear();
+  }
+}
+
+IOStatus KinesisWritableFile::Flush(const IOOptions& /*opts*/,
+                                    IODebugContext* /*dbg*/) {
+  assert(status_.ok());
+  // Flush makes no durability promise, so only send a stale batch
+  const auto& options = cloud_fs_->GetCloudFileSystemOptions();
+  if (!batch_.empty() && env_->NowMicros() - batch_start_micros_ >=
+                             options.cloud_log_batch_delay_micros) {
+    return FlushBatch();
+  }
+  return status_;
+}
+
+IOStatus KinesisWritableFile::Sync(const IOOptions& /*opts*/,
+                                   IODebugContext* /*dbg*/) {
+  assert(status_.ok());
+  return FlushBatch();
+}
+
 IOStatus KinesisWritableFile::Append(const Slice& data,
                                      const IOOptions& /*opts*/,
                                      IODebugContext* /*dbg*/) {
   assert(status_.ok());
 
+  const auto& options = cloud_fs_->GetCloudFileSystemOptions();
+  if (options.cloud_log_batch_size > 0) {
+    if (batch_.empty()) {
+      batch_start_micros_ = env_->NowMicros();
+    }
+    batch_.append(data.data(), data.size());
+    current_offset_ += data.size();
+    if (batch_.size() >= options.cloud_log_batch_size ||
+        env_->NowMicros() - batch_start_micros_ >=
+            options.cloud_log_batch_delay_micros) {
+      return FlushBatch();
+    }
+    return IOStatus::OK();
+  }
+
   // create write request
   Aws::Kinesis::Model::PutRecordRequest request;
   request.SetStreamName(topic_);
@@ -114,6 +260,12 @@ IOStatus KinesisWritableFile::Close(const IOOptions& /*opts*/,
       "[kinesis] S3WritableFile closing %s", fname_.c_str());
   assert(status_.ok());
 
+  // The Closed record must follow every append
+  auto st = FlushBatch();
+  if (!st.ok()) {
+    return st;
+  }
+
   // create write request
   Aws::Kinesis::Model::PutRecordRequest request;
   request.SetStreamName(topic_);
@@ -192,6 +344,8 @@ IOStatus KinesisWritableFile::LogDelete() {
 class KinesisController : public CloudLogControllerImpl {
  public:
   virtual ~KinesisController() {
+    // The shared tailer polls the shards until then
+    StopTailingStream();
     if (cloud_fs_ != nullptr) {
       Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
           "[%s] KinesisController closed", Name());
@@ -210,21 +364,61 @@ class KinesisController : public CloudLogControllerImpl {
 
   Status PrepareOptions(const ConfigOptions& options) override;
 
+ protected:
+  IOStatus StartSharedTailing() override;
+
  private:
   std::shared_ptr<Aws::Kinesis::KinesisClient> kinesis_client_;
 
   Aws::String topic_;
 
-  // list of shards and their positions
+  // list of shards and their positions. Each shard is tailed by one thread,
+  // which alone touches its entries.
   Aws::Vector<Aws::Kinesis::Model::Shard> shards_;
   Aws::Vector<Aws::String> shards_iterator_;
   std::vector<Aws::String> shards_position_;
+  // The state of polling each shard
+  struct ShardTail {
+    // Of the last records applied
+    Status status;
+    Status last_error;
+    int retry_attempt = 0;
+  };
+  std::vector<ShardTail> shard_tails_;
+
+  // With cloud_log_consumer_name, the ARN of the enhanced fan-out consumer
+  Aws::String consumer_arn_;
+
+  // Set once a shard tailer gives up, to stop the others
+  std::atomic<bool> tail_failed_{false};
 
   Status InitializeShards();
 
-  // Set shard iterator for every shard to position specified by
-  // shards_position_.
-  void SeekShards();
+  // Registers the consumer named cloud_log_consumer_name on the stream, or
+  // finds the one already registered, and waits for it to be active.
+  Status InitializeConsumer(const Aws::String& stream_arn);
+
+  // Set the iterator of shard i, unless it has one, to the position specified
+  // by shards_position_[i].
+  Status SeekShard(size_t i);
+
+  // Tails shard i until the tailing stops or fails, or the shard is closed
+  // and read to its end
+  Status TailShard(size_t i);
+  // TailShard() by GetRecords polls
+  Status PollShard(size_t i);
+  // Reads and applies the records of shard i once. Sets *idle if there were
+  // none or the read failed, and *done once the shard is closed and read to
+  // its end. Returns non-OK once it gives up on the shard.
+  Status PollShardOnce(size_t i, bool* idle, bool* done);
+  // TailShard() by SubscribeToShard subscriptions of the consumer, each
+  // pushing records for up to five minutes
+  Status SubscribeShard(size_t i);
+
+  // Applies records read from shard i and remembers the last one as the
+  // position of the shard
+  Status ApplyRecords(size_t i,
+                      const Aws::Vector<Aws::Kinesis::Model::Record>& records);
 };
 
 Status KinesisController::PrepareOptions(const ConfigOptions& config_options) {
@@ -258,86 +452,240 @@ IOStatus KinesisController::TailStream() {
   status_ = InitializeShards();
 
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[%s] TailStream topic %s %s", Name(), topic_.c_str(),
-      status_.ToString().c_str());
+      "[%s] TailStream topic %s %" ROCKSDB_PRIszt " shards %s", Name(),
+      topic_.c_str(), shards_.size(), status_.ToString().c_str());
+  if (!status_.ok()) {
+    return status_to_io_status(status());
+  }
+
+  // The records of a file all go to one shard, so the shards are tailed and
+  // applied in parallel, this thread taking the first one
+  std::vector<Status> statuses(shards_.size());
+  std::vector<std::thread> tailers;
+  for (size_t i = 1; i < shards_.size(); i++) {
+    tailers.emplace_back([this, i, &statuses]() {
+      statuses[i] = TailShard(i);
+    });
+  }
+  if (!shards_.empty()) {
+    statuses[0] = TailShard(0);
+  }
+  for (auto& tailer : tailers) {
+    tailer.join();
+  }
+  for (const auto& s : statuses) {
+    if (!s.ok()) {
+      status_ = s;
+      break;
+    }
+  }
+  return status_to_io_status(status());
+}
+
+IOStatus KinesisController::StartSharedTailing() {
+  // The records are pushed to the subscriptions of a consumer, on threads
+  // of their own
+  if (!cloud_fs_->GetCloudFileSystemOptions().cloud_log_consumer_name.empty()) {
+    return IOStatus::NotSupported("Shared tailing of a consumer");
+  }
+  status_ = InitializeShards();
+  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+      "[%s] Shared tailing of topic %s %" ROCKSDB_PRIszt " shards %s", Name(),
+      topic_.c_str(), shards_.size(), status_.ToString().c_str());
+  if (!status_.ok()) {
+    return status_to_io_status(status());
+  }
+  for (size_t i = 0; i < shards_.size(); i++) {
+    AddTailerStream([this, i](bool* idle, bool* done) {
+      auto st = PollShardOnce(i, idle, done);
+      if (!st.ok() && !tail_failed_.exchange(true)) {
+        status_ = st;
+      }
+      *done = *done || tail_failed_;
+    });
+  }
+  return IOStatus::OK();
+}
+
+Status KinesisController::TailShard(size_t i) {
+  Status st = consumer_arn_.empty() ? PollShard(i) : SubscribeShard(i);
+  if (!st.ok() && IsRunning()) {
+    tail_failed_ = true;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+      "[%s] stopped tailing shard %s of %s %s", Name(),
+      shards_[i].GetShardId().c_str(), topic_.c_str(),
+      st.ToString().c_str());
+  return st;
+}
+
+Status KinesisController::PollShard(size_t i) {
+  while (IsRunning() && !tail_failed_) {
+    bool idle = false;
+    bool done = false;
+    Status st = PollShardOnce(i, &idle, &done);
+    if (!st.ok()) {
+      return st;
+    }
+    if (done) {
+      break;
+    }
+    // If no records were read in last iteration, then sleep for 50 millis,
+    // and for 200 after an error
+    if (idle) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(
+          shard_tails_[i].retry_attempt > 0 ? 200 : 50));
+    }
+  }
+  return shard_tails_[i].status;
+}
+
+Status KinesisController::PollShardOnce(size_t i, bool* idle, bool* done) {
+  auto& tail = shard_tails_[i];
+  *idle = false;
+  *done = false;
+  if (tail.retry_attempt > 10) {
+    return tail.last_error;
+  }
+  Status seek_status = SeekShard(i);  // read position at last seqno
+  if (!seek_status.ok()) {
+    tail.last_error = seek_status;
+    ++tail.retry_attempt;
+    *idle = true;
+    return Status::OK();
+  }
+
+  // Issue a read from Kinesis stream
+  Aws::Kinesis::Model::GetRecordsRequest request;
+  request.SetShardIterator(shards_iterator_[i]);
+  Aws::Kinesis::Model::GetRecordsOutcome outcome =
+      kinesis_client_->GetRecords(request);
+  bool isSuccess = outcome.IsSuccess();
+  if (!isSuccess) {
+    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
+        outcome.GetError();
+    Aws::Kinesis::KinesisErrors err = error.GetErrorType();
+    if (err == Aws::Kinesis::KinesisErrors::EXPIRED_ITERATOR) {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] expired shard iterator for %s. Reseeking...", Name(),
+          topic_.c_str());
+      shards_iterator_[i] = "";
+    } else {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] error reading %s %s", Name(), topic_.c_str(),
+          error.GetMessage().c_str());
+      tail.last_error =
+          Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+      ++tail.retry_attempt;
+      *idle = true;
+    }
+    return Status::OK();
+  }
+  tail.retry_attempt = 0;
+  Aws::Kinesis::Model::GetRecordsResult& res = outcome.GetResult();
+  const Aws::Vector<Aws::Kinesis::Model::Record>& records = res.GetRecords();
+
+  // skip to the next position in the shard iterator
+  shards_iterator_[i] = res.GetNextShardIterator();
+
+  if (!records.empty()) {
+    tail.status = ApplyRecords(i, records);
+  }
+  // The shard was closed by a resharding and is read to its end
+  *done = shards_iterator_[i].empty();
+  *idle = records.empty() && tail.status.ok();
+  return Status::OK();
+}
 
+Status KinesisController::SubscribeShard(size_t i) {
+  Status st;
   Status lastErrorStatus;
   int retryAttempt = 0;
-  while (IsRunning()) {
+  while (IsRunning() && !tail_failed_) {
     if (retryAttempt > 10) {
-      status_ = lastErrorStatus;
-      break;
+      return lastErrorStatus;
     }
 
-    // Count the number of records that were read in one iteration
-    size_t num_read = 0;
-
-    // Issue a read from Kinesis stream
-    Aws::Kinesis::Model::GetRecordsRequest request;
-    request.SetShardIterator(shards_iterator_[0]);
-    Aws::Kinesis::Model::GetRecordsOutcome outcome =
-        kinesis_client_->GetRecords(request);
-    bool isSuccess = outcome.IsSuccess();
-    if (!isSuccess) {
+    Aws::Kinesis::Model::StartingPosition position;
+    if (shards_position_[i].empty()) {
+      position.SetType(Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
+    } else {
+      position.SetType(
+          Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
+      position.SetSequenceNumber(shards_position_[i]);
+    }
+    // The records are applied as they are pushed, on this thread
+    bool shard_ended = false;
+    Aws::Kinesis::Model::SubscribeToShardHandler handler;
+    handler.SetSubscribeToShardEventCallback(
+        [&](const Aws::Kinesis::Model::SubscribeToShardEvent& event) {
+          if (!event.GetRecords().empty()) {
+            st = ApplyRecords(i, event.GetRecords());
+          }
+          // No continuation once the shard is closed and read to its end
+          shard_ended = event.GetContinuationSequenceNumber().empty();
+        });
+    Aws::Kinesis::Model::SubscribeToShardRequest request;
+    request.SetConsumerARN(consumer_arn_);
+    request.SetShardId(shards_[i].GetShardId());
+    request.SetStartingPosition(position);
+    request.SetEventStreamHandler(handler);
+    // Cut the subscription short when the tailing stops
+    request.SetContinueRequestHandler([this](const Aws::Http::HttpRequest*) {
+      return IsRunning() && !tail_failed_;
+    });
+    auto outcome = kinesis_client_->SubscribeToShard(request);
+    if (shard_ended) {
+      return st;
+    }
+    if (!outcome.IsSuccess() && IsRunning() && !tail_failed_) {
+      // Typically a subscription of the consumer to the shard that is still
+      // open, or throttling
       const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
           outcome.GetError();
-      Aws::Kinesis::KinesisErrors err = error.GetErrorType();
-      if (err == Aws::Kinesis::KinesisErrors::EXPIRED_ITERATOR) {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] expired shard iterator for %s. Reseeking...", Name(),
-            topic_.c_str());
-        shards_iterator_[0] = "";
-        SeekShards();  // read position at last seqno
-      } else {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] error reading %s %s", Name(), topic_.c_str(),
-            error.GetMessage().c_str());
-        lastErrorStatus =
-            Status::IOError(topic_.c_str(), error.GetMessage().c_str());
-        ++retryAttempt;
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-      }
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] error subscribing to %s %s", Name(), topic_.c_str(),
+          error.GetMessage().c_str());
+      lastErrorStatus =
+          Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+      ++retryAttempt;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
       continue;
     }
+    // The subscription expired, renew it from the last record
     retryAttempt = 0;
-    Aws::Kinesis::Model::GetRecordsResult& res = outcome.GetResult();
-    const Aws::Vector<Aws::Kinesis::Model::Record>& records = res.GetRecords();
-
-    // skip to the next position in the shard iterator
-    const Aws::String& next = res.GetNextShardIterator();
-    shards_iterator_[0] = next;
-
-    // read data into buffer
-    num_read = records.size();
-    for (auto r : records) {
-      // extract payload from log record
-      const Aws::Utils::ByteBuffer& b = r.GetData();
-      const unsigned char* data = b.GetUnderlyingData();
-      Slice sl((const char*)data, b.GetLength());
-
-      // apply the payload to local filesystem
-      status_ = Apply(sl);
-      if (!status_.ok()) {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] error processing message size %ld "
-            "extracted from stream %s %s",
-            Name(), b.GetLength(), topic_.c_str(), status_.ToString().c_str());
-      } else {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] successfully processed message size %ld "
-            "extracted from stream %s %s",
-            Name(), b.GetLength(), topic_.c_str(), status_.ToString().c_str());
-      }
+  }
+  return st;
+}
 
-      // remember last read seqno from stream
-      shards_position_[0] = r.GetSequenceNumber();
-    }
-    // If no records were read in last iteration, then sleep for 50 millis
-    if (num_read == 0 && status_.ok()) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
+Status KinesisController::ApplyRecords(
+    size_t i, const Aws::Vector<Aws::Kinesis::Model::Record>& records) {
+  // apply the payloads of the records to local filesystem
+  size_t num_read = records.size();
+  std::vector<Slice> payloads;
+  payloads.reserve(num_read);
+  size_t num_bytes = 0;
+  for (const auto& r : records) {
+    const Aws::Utils::ByteBuffer& b = r.GetData();
+    payloads.emplace_back((const char*)b.GetUnderlyingData(), b.GetLength());
+    num_bytes += b.GetLength();
   }
-  return status_to_io_status(status());
+  Status st = ApplyBatch(payloads);
+  if (!st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] error processing %" ROCKSDB_PRIszt " messages (%" ROCKSDB_PRIszt
+        " bytes) from stream %s %s",
+        Name(), num_read, num_bytes, topic_.c_str(), st.ToString().c_str());
+  } else {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] successfully processed %" ROCKSDB_PRIszt
+        " messages (%" ROCKSDB_PRIszt " bytes) from stream %s %s",
+        Name(), num_read, num_bytes, topic_.c_str(), st.ToString().c_str());
+  }
+
+  // remember last read seqno from stream
+  shards_position_[i] = records.back().GetSequenceNumber();
+  return st;
 }
 
 IOStatus KinesisController::CreateStream(const std::string& bucket) {
@@ -351,7 +699,8 @@ IOStatus KinesisController::CreateStream(const std::string& bucket) {
   // create stream
   Aws::Kinesis::Model::CreateStreamRequest create_request;
   create_request.SetStreamName(topic_);
-  create_request.SetShardCount(1);
+  create_request.SetShardCount(std::max(
+      1, cloud_fs_->GetCloudFileSystemOptions().cloud_log_stream_shards));
   Aws::Kinesis::Model::CreateStreamOutcome outcome =
       kinesis_client_->CreateStream(create_request);
   bool isSuccess = outcome.IsSuccess();
@@ -379,7 +728,7 @@ IOStatus KinesisController::WaitForStreamReady(const std::string& bucket) {
   IOStatus st;
 
   while (!isSuccess) {
-    // Find the number of shards for this stream. It should be 1 shard.
+    // The stream is ready once it is created, with all of its shards
     st = IOStatus::OK();
     Aws::Kinesis::Model::DescribeStreamRequest request;
     request.SetStreamName(topic);
@@ -398,7 +747,9 @@ IOStatus KinesisController::WaitForStreamReady(const std::string& bucket) {
       const Aws::Kinesis::Model::StreamDescription& description =
           result.GetStreamDescription();
       auto& shards = description.GetShards();
-      if (shards.size() != 1) {
+      if (shards.empty() ||
+          description.GetStreamStatus() ==
+              Aws::Kinesis::Model::StreamStatus::CREATING) {
         isSuccess = false;
         std::string msg = "Kinesis timedout initialize shards " +
                           std::string(topic.c_str(), topic.size());
@@ -423,73 +774,130 @@ Status KinesisController::InitializeShards() {
     return st;
   }
 
-  // Find the number of shards for this stream. It should be 1 shard.
-  Aws::Kinesis::Model::DescribeStreamRequest request;
-  request.SetStreamName(topic_);
-  auto outcome = kinesis_client_->DescribeStream(request);
-  bool isSuccess = outcome.IsSuccess();
-  if (!isSuccess) {
-    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-        outcome.GetError();
-    st = Status::IOError(topic_.c_str(), error.GetMessage().c_str()),
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
-        topic_.c_str(), st.ToString().c_str());
-  } else {
-    const Aws::Kinesis::Model::DescribeStreamResult& result =
-        outcome.GetResult();
-    const Aws::Kinesis::Model::StreamDescription& description =
-        result.GetStreamDescription();
-
-    // append all shards to global list
-    auto& shards = description.GetShards();
-    assert(shards.size() == 1);
-    for (auto s : shards) {
-      shards_.push_back(s);
-      shards_iterator_.push_back("");
-      shards_position_.push_back("");
-    }
-  }
-  if (st.ok()) {
-    SeekShards();
-  }
-  return st;
-}
-
-void KinesisController::SeekShards() {
-  // Check all shard iterators
-  for (size_t i = 0; i < shards_.size(); i++) {
-    if (shards_iterator_[i].size() != 0) {
-      continue;  // iterator is still valid, nothing to do
-    }
-    // create new shard iterator at specified seqno
-    Aws::Kinesis::Model::GetShardIteratorRequest request;
+  // Find the shards of this stream, a page of them at a time
+  Aws::String stream_arn;
+  bool has_more_shards = true;
+  while (st.ok() && has_more_shards) {
+    Aws::Kinesis::Model::DescribeStreamRequest request;
     request.SetStreamName(topic_);
-    request.SetShardId(shards_[i].GetShardId());
-    if (shards_position_[i].size() == 0) {
-      request.SetShardIteratorType(
-          Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
-    } else {
-      request.SetShardIteratorType(
-          Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
-      request.SetStartingSequenceNumber(shards_position_[i]);
+    if (!shards_.empty()) {
+      request.SetExclusiveStartShardId(shards_.back().GetShardId());
     }
-    Aws::Kinesis::Model::GetShardIteratorOutcome outcome =
-        kinesis_client_->GetShardIterator(request);
+    auto outcome = kinesis_client_->DescribeStream(request);
     bool isSuccess = outcome.IsSuccess();
     if (!isSuccess) {
       const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
           outcome.GetError();
-      status_ = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+      st = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
       Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
           "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
-          topic_.c_str(), status_.ToString().c_str());
+          topic_.c_str(), st.ToString().c_str());
     } else {
-      const Aws::Kinesis::Model::GetShardIteratorResult& result =
+      const Aws::Kinesis::Model::DescribeStreamResult& result =
           outcome.GetResult();
-      shards_iterator_[i] = result.GetShardIterator();
+      const Aws::Kinesis::Model::StreamDescription& description =
+          result.GetStreamDescription();
+      stream_arn = description.GetStreamARN();
+      has_more_shards = description.GetHasMoreShards();
+
+      // append all shards to global list
+      for (const auto& s : description.GetShards()) {
+        shards_.push_back(s);
+        shards_iterator_.push_back("");
+        shards_position_.push_back("");
+        shard_tails_.emplace_back();
+      }
+      has_more_shards = has_more_shards && !description.GetShards().empty();
     }
   }
+  const auto& consumer_name =
+      cloud_fs_->GetCloudFileSystemOptions().cloud_log_consumer_name;
+  if (st.ok() && !consumer_name.empty()) {
+    st = InitializeConsumer(stream_arn);
+  }
+  return st;
+}
+
+Status KinesisController::InitializeConsumer(const Aws::String& stream_arn) {
+  const auto& name =
+      cloud_fs_->GetCloudFileSystemOptions().cloud_log_consumer_name;
+  Aws::String consumer_name(name.c_str(), name.size());
+
+  Aws::Kinesis::Model::RegisterStreamConsumerRequest request;
+  request.SetStreamARN(stream_arn);
+  request.SetConsumerName(consumer_name);
+  auto outcome = kinesis_client_->RegisterStreamConsumer(request);
+  if (!outcome.IsSuccess() &&
+      outcome.GetError().GetErrorType() !=
+          Aws::Kinesis::KinesisErrors::RESOURCE_IN_USE) {
+    Status st = Status::IOError(consumer_name.c_str(),
+                                outcome.GetError().GetMessage().c_str());
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] unable to register consumer on %s %s", Name(), topic_.c_str(),
+        st.ToString().c_str());
+    return st;
+  }
+
+  // Wait for the consumer, new or registered before, to be active
+  const std::chrono::microseconds start(env_->NowMicros());
+  while (true) {
+    Aws::Kinesis::Model::DescribeStreamConsumerRequest describe;
+    describe.SetStreamARN(stream_arn);
+    describe.SetConsumerName(consumer_name);
+    auto described = kinesis_client_->DescribeStreamConsumer(describe);
+    if (!described.IsSuccess()) {
+      return Status::IOError(consumer_name.c_str(),
+                             described.GetError().GetMessage().c_str());
+    }
+    const auto& consumer = described.GetResult().GetConsumerDescription();
+    if (consumer.GetConsumerStatus() ==
+        Aws::Kinesis::Model::ConsumerStatus::ACTIVE) {
+      consumer_arn_ = consumer.GetConsumerARN();
+      Log(InfoLogLevel::INFO_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] consumer %s of %s is active", Name(), consumer_name.c_str(),
+          topic_.c_str());
+      return Status::OK();
+    }
+    if (start + kRetryPeriod < std::chrono::microseconds(env_->NowMicros())) {
+      return Status::TimedOut("Kinesis consumer not active",
+                              consumer_name.c_str());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  }
+}
+
+Status KinesisController::SeekShard(size_t i) {
+  if (shards_iterator_[i].size() != 0) {
+    return Status::OK();  // iterator is still valid, nothing to do
+  }
+  // create new shard iterator at specified seqno
+  Aws::Kinesis::Model::GetShardIteratorRequest request;
+  request.SetStreamName(topic_);
+  request.SetShardId(shards_[i].GetShardId());
+  if (shards_position_[i].size() == 0) {
+    request.SetShardIteratorType(
+        Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
+  } else {
+    request.SetShardIteratorType(
+        Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
+    request.SetStartingSequenceNumber(shards_position_[i]);
+  }
+  Aws::Kinesis::Model::GetShardIteratorOutcome outcome =
+      kinesis_client_->GetShardIterator(request);
+  bool isSuccess = outcome.IsSuccess();
+  if (!isSuccess) {
+    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
+        outcome.GetError();
+    Status st = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
+        topic_.c_str(), st.ToString().c_str());
+    return st;
+  }
+  const Aws::Kinesis::Model::GetShardIteratorResult& result =
+      outcome.GetResult();
+  shards_iterator_[i] = result.GetShardIterator();
+  return Status::OK();
 }
 
 CloudLogWritableFile* KinesisController::CreateWritableFile(
@@ -2,10 +2,16 @@
 //
 //
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "cloud/aws/aws_file.h"
+#include "cloud/cloud_request_throttler.h"
+#include "monitoring/iostats_context_imp.h"
+#include "monitoring/statistics_impl.h"
 #include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/system_clock.h"
 #ifdef USE_AWS
 #include <aws/core/client/AWSError.h>
 #include <aws/core/client/ClientConfiguration.h>
@@ -20,7 +26,9 @@ namespace ROCKSDB_NAMESPACE {
 //
 class AwsRetryStrategy : public Aws::Client::RetryStrategy {
  public:
-  AwsRetryStrategy(CloudFileSystem* fs) : cfs_(fs) {
+  // Retries are logged to info_log and counted in stats, if not null
+  AwsRetryStrategy(Logger* info_log, const std::shared_ptr<Statistics>& stats)
+      : info_log_(info_log), stats_(stats) {
     // In many environments, AccessDenied and ExpiredToken errors are retryable.
     // This is because HTTP requests are involved in fetching the new tokens and
     // credentials, which can fail.
@@ -31,7 +39,7 @@ class AwsRetryStrategy : public Aws::Client::RetryStrategy {
     default_strategy_ =
         std::make_shared<Aws::Client::SpecifiedRetryableErrorsRetryStrategy>(
             retryableErrors);
-    Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
         "[aws] Configured custom retry policy");
   }
 
@@ -49,8 +57,12 @@ class AwsRetryStrategy : public Aws::Client::RetryStrategy {
       long attemptedRetries) const override;
 
  private:
-  // rocksdb retries, etc
-  CloudFileSystem* cfs_;
+  bool DecideRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+                   long attemptedRetries) const;
+
+  // Not the CloudFileSystem: a shared client can outlive it
+  Logger* info_log_;
+  std::shared_ptr<Statistics> stats_;
 
   // The default strategy implemented by AWS client
   std::shared_ptr<Aws::Client::RetryStrategy> default_strategy_;
@@ -61,12 +73,38 @@ class AwsRetryStrategy : public Aws::Client::RetryStrategy {
 
 //
 // Returns true if the error can be retried given the error and the number of
-// times already tried.
+// times already tried, and counts the retries in the statistics.
 //
 bool AwsRetryStrategy::ShouldRetry(
     const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
     long attemptedRetries) const {
   auto ce = error.GetErrorType();
+  auto http_code = static_cast<int>(error.GetResponseCode());
+  bool throttled = ce == Aws::Client::CoreErrors::THROTTLING ||
+                   ce == Aws::Client::CoreErrors::SLOW_DOWN ||
+                   http_code == 429 || http_code == 503;
+  // The client retries on the thread of the request, the thread of its rate
+  // limit
+  auto throttler = CloudRequestThrottler::Current();
+  if (throttled && throttler != nullptr) {
+    throttler->OnThrottled(SystemClock::Default()->NowMicros());
+  }
+  if (!DecideRetry(error, attemptedRetries)) {
+    return false;
+  }
+  IOSTATS_ADD(cloud_request_retry_count, 1);
+  auto stats = stats_.get();
+  RecordTick(stats, CLOUD_REQUEST_RETRIES);
+  if (throttled) {
+    RecordTick(stats, CLOUD_REQUEST_THROTTLES);
+  }
+  return true;
+}
+
+bool AwsRetryStrategy::DecideRetry(
+    const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+    long attemptedRetries) const {
+  auto ce = error.GetErrorType();
   const Aws::String errmsg = error.GetMessage();
   const Aws::String exceptionMsg = error.GetExceptionName();
   std::string err(errmsg.c_str(), errmsg.size());
@@ -78,7 +116,7 @@ bool AwsRetryStrategy::ShouldRetry(
       ce == Aws::Client::CoreErrors::UNKNOWN ||
       err.find("try again") != std::string::npos) {
     if (attemptedRetries <= internal_failure_num_retries_) {
-      Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
           "[aws] Encountered retriable failure: %s (code %d, http %d). "
           "Exception %s. retry attempt %ld is lesser than max retries %d. "
           "Retrying...",
@@ -87,7 +125,7 @@ bool AwsRetryStrategy::ShouldRetry(
           attemptedRetries, internal_failure_num_retries_);
       return true;
     }
-    Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
         "[aws] Encountered retriable failure: %s (code %d, http %d). Exception "
         "%s. retry attempt %ld exceeds max retries %d. Aborting...",
         err.c_str(), static_cast<int>(ce),
@@ -95,7 +133,7 @@ bool AwsRetryStrategy::ShouldRetry(
         attemptedRetries, internal_failure_num_retries_);
     return false;
   }
-  Log(InfoLogLevel::WARN_LEVEL, cfs_->GetLogger(),
+  Log(InfoLogLevel::WARN_LEVEL, info_log_,
       "[aws] Encountered S3 failure %s (code %d, http %d). Exception %s."
       " retry attempt %ld max retries %d. Using default retry policy...",
       err.c_str(), static_cast<int>(ce),
@@ -111,31 +149,83 @@ bool AwsRetryStrategy::ShouldRetry(
 long AwsRetryStrategy::CalculateDelayBeforeNextRetry(
     const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
     long attemptedRetries) const {
-  return default_strategy_->CalculateDelayBeforeNextRetry(error,
-                                                          attemptedRetries);
+  long delay_ms = default_strategy_->CalculateDelayBeforeNextRetry(
+      error, attemptedRetries);
+  // The retry waits for its turn under the rate limit of the request too
+  auto throttler = CloudRequestThrottler::Current();
+  if (throttler != nullptr) {
+    uint64_t wait_micros =
+        throttler->Reserve(SystemClock::Default()->NowMicros());
+    if (wait_micros > 0) {
+      RecordTick(stats_.get(), CLOUD_REQUEST_THROTTLE_DELAYS);
+      RecordTick(stats_.get(), CLOUD_REQUEST_THROTTLE_DELAY_MICROS,
+                 wait_micros);
+      delay_ms = std::max(delay_ms, static_cast<long>(wait_micros / 1000));
+    }
+  }
+  // Only called before a retry, which the client sleeps for
+  if (delay_ms > 0 && GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex) {
+    IOSTATS_ADD(cloud_request_retry_delay_nanos,
+                static_cast<uint64_t>(delay_ms) * 1000000);
+  }
+  return delay_ms;
 }
 
-Status AwsCloudOptions::GetClientConfiguration(
-    CloudFileSystem* fs, const std::string& region,
-    Aws::Client::ClientConfiguration* config) {
+namespace {
+Status GetConfiguration(CloudFileSystem* fs, const std::string& region,
+                        bool shared, Aws::Client::ClientConfiguration* config) {
   config->connectTimeoutMs = 30000;
   config->requestTimeoutMs = 600000;
 
   const auto& cloud_fs_options = fs->GetCloudFileSystemOptions();
   // Setup how retries need to be done
-  config->retryStrategy = std::make_shared<AwsRetryStrategy>(fs);
+  if (shared) {
+    config->retryStrategy =
+        std::make_shared<AwsRetryStrategy>(nullptr, nullptr);
+  } else {
+    config->retryStrategy = std::make_shared<AwsRetryStrategy>(
+        fs->GetLogger(), cloud_fs_options.statistics);
+  }
   if (cloud_fs_options.request_timeout_ms != 0) {
     config->requestTimeoutMs = cloud_fs_options.request_timeout_ms;
   }
+  if (cloud_fs_options.s3_max_connections > 0) {
+    config->maxConnections =
+        static_cast<unsigned>(cloud_fs_options.s3_max_connections);
+  }
+  config->enableTcpKeepAlive =
+      cloud_fs_options.s3_tcp_keep_alive_interval_ms > 0;
+  if (config->enableTcpKeepAlive) {
+    config->tcpKeepAliveIntervalMs = static_cast<unsigned long>(
+        cloud_fs_options.s3_tcp_keep_alive_interval_ms);
+  }
 
   config->region = ToAwsString(region);
   return Status::OK();
 }
+}  // namespace
+
+Status AwsCloudOptions::GetClientConfiguration(
+    CloudFileSystem* fs, const std::string& region,
+    Aws::Client::ClientConfiguration* config) {
+  return GetConfiguration(fs, region, false /* shared */, config);
+}
+
+Status AwsCloudOptions::GetSharedClientConfiguration(
+    CloudFileSystem* fs, const std::string& region,
+    Aws::Client::ClientConfiguration* config) {
+  return GetConfiguration(fs, region, true /* shared */, config);
+}
 #else
 Status AwsCloudOptions::GetClientConfiguration(
     CloudFileSystem*, const std::string&, Aws::Client::ClientConfiguration*) {
   return Status::NotSupported("Not configured for AWS support");
 }
+
+Status AwsCloudOptions::GetSharedClientConfiguration(
+    CloudFileSystem*, const std::string&, Aws::Client::ClientConfiguration*) {
+  return Status::NotSupported("Not configured for AWS support");
+}
 #endif /* USE_AWS */
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -12,15 +12,24 @@
 #include <aws/core/utils/memory/stl/AWSStreamFwd.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/S3Errors.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
 #include <aws/s3/model/BucketLocationConstraint.h>
+#include <aws/s3/model/CommonPrefix.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
 #include <aws/s3/model/CopyObjectResult.h>
 #include <aws/s3/model/CreateBucketConfiguration.h>
 #include <aws/s3/model/CreateBucketRequest.h>
 #include <aws/s3/model/CreateBucketResult.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
+#include <aws/s3/model/Delete.h>
 #include <aws/s3/model/DeleteBucketRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/DeleteObjectResult.h>
+#include <aws/s3/model/DeleteObjectsRequest.h>
+#include <aws/s3/model/DeleteObjectsResult.h>
 #include <aws/s3/model/GetBucketVersioningRequest.h>
 #include <aws/s3/model/GetBucketVersioningResult.h>
 #include <aws/s3/model/GetObjectRequest.h>
@@ -30,28 +39,44 @@
 #include <aws/s3/model/HeadObjectResult.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/ListObjectsResult.h>
+#include <aws/s3/model/ObjectIdentifier.h>
 #include <aws/s3/model/PutObjectRequest.h>
 #include <aws/s3/model/PutObjectResult.h>
 #include <aws/s3/model/ServerSideEncryption.h>
+#include <aws/s3/model/StorageClass.h>
+#include <aws/s3/model/UploadPartRequest.h>
 #include <aws/transfer/TransferManager.h>
 #endif  // USE_AWS
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "cloud/aws/aws_file.h"
 #include "cloud/aws/aws_file_system.h"
+#include "cloud/cloud_request_hedger.h"
+#include "cloud/cloud_request_throttler.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "cloud/filename.h"
 #include "file/read_write_util.h"
 #include "file/writable_file_writer.h"
+#include "monitoring/statistics_impl.h"
 #include "port/port.h"
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/options.h"
+#include "rocksdb/system_clock.h"
+#include "util/crc32c.h"
 #include "util/stderr_logger.h"
 #include "util/string_util.h"
 
@@ -63,14 +88,21 @@ namespace ROCKSDB_NAMESPACE {
 #ifdef USE_AWS
 class CloudRequestCallbackGuard {
  public:
-  CloudRequestCallbackGuard(CloudRequestCallback* callback,
+  CloudRequestCallbackGuard(CloudRequestCallback* callback, Statistics* stats,
                             CloudRequestOpType type, uint64_t size = 0)
-      : callback_(callback), type_(type), size_(size), start_(now()) {}
+      : callback_(callback),
+        stats_(stats),
+        type_(type),
+        size_(size),
+        start_(now()) {}
 
   ~CloudRequestCallbackGuard() {
+    auto micros = now() - start_;
     if (callback_) {
-      (*callback_)(type_, size_, now() - start_, success_);
+      (*callback_)(type_, size_, micros, success_);
     }
+    CloudStorageProviderImpl::RecordRequest(stats_, type_, size_, micros,
+                                            success_);
   }
 
   void SetSize(uint64_t size) { size_ = size; }
@@ -84,12 +116,38 @@ class CloudRequestCallbackGuard {
         .count();
   }
   CloudRequestCallback* callback_;
+  Statistics* stats_;
   CloudRequestOpType type_;
   uint64_t size_;
   bool success_{false};
   uint64_t start_;
 };
 
+// With s3_adaptive_throttling, delays a request over the rate limit of its
+// bucket and prefix. The client retries the request on the same thread, and
+// the retries go through the limit too (see AwsRetryStrategy).
+class CloudRequestThrottleGuard {
+ public:
+  CloudRequestThrottleGuard(CloudRequestThrottler* throttler,
+                            Statistics* stats)
+      : scope_(throttler) {
+    if (throttler == nullptr) {
+      return;
+    }
+    auto clock = SystemClock::Default();
+    uint64_t delay = throttler->Reserve(clock->NowMicros());
+    if (delay > 0) {
+      RecordTick(stats, CLOUD_REQUEST_THROTTLE_DELAYS);
+      RecordTick(stats, CLOUD_REQUEST_THROTTLE_DELAY_MICROS, delay);
+      clock->SleepForMicroseconds(
+          static_cast<int>(std::min<uint64_t>(delay, INT32_MAX)));
+    }
+  }
+
+ private:
+  CloudRequestThrottler::Scope scope_;
+};
+
 template <typename T>
 void SetEncryptionParameters(const CloudFileSystemOptions& cloud_fs_options,
                              T& put_request) {
@@ -107,23 +165,83 @@ void SetEncryptionParameters(const CloudFileSystemOptions& cloud_fs_options,
 
 /******************** S3ClientWrapper ******************/
 
-class AwsS3ClientWrapper {
- public:
-  AwsS3ClientWrapper(
-      const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& creds,
-      const Aws::Client::ClientConfiguration& config,
-      const CloudFileSystemOptions& cloud_options)
-      : cloud_request_callback_(cloud_options.cloud_request_callback) {
-    if (cloud_options.s3_client_factory) {
-      client_ = cloud_options.s3_client_factory(creds, config);
-    } else if (creds) {
-      client_ = std::make_shared<Aws::S3::S3Client>(
-          creds, config,
-          Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
-          true /* useVirtualAddressing */);
+namespace {
+std::shared_ptr<Aws::S3::S3Client> NewS3Client(
+    const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& creds,
+    const Aws::Client::ClientConfiguration& config) {
+  if (creds) {
+    return std::make_shared<Aws::S3::S3Client>(
+        creds, config,
+        Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
+        true /* useVirtualAddressing */);
+  } else {
+    return std::make_shared<Aws::S3::S3Client>(config);
+  }
+}
+
+// Returns the S3 client, with its connection pool, used by all the providers
+// with the same configuration and credentials (see share_s3_client). A
+// client is released when the last provider using it is.
+std::shared_ptr<Aws::S3::S3Client> GetSharedS3Client(
+    const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& creds,
+    const Aws::Client::ClientConfiguration& config,
+    const AwsCloudAccessCredentials& credentials) {
+  // Leaked, the clients can be released at exit after it is destroyed
+  static auto* mutex = new std::mutex();
+  static auto* clients =
+      new std::unordered_map<std::string, std::weak_ptr<Aws::S3::S3Client>>();
+
+  std::string key;
+  key.append(config.region.c_str()).append("|");
+  key.append(config.endpointOverride.c_str()).append("|");
+  key.append(std::to_string(static_cast<int>(config.scheme))).append("|");
+  key.append(config.verifySSL ? "1|" : "0|");
+  key.append(std::to_string(config.connectTimeoutMs)).append("|");
+  key.append(std::to_string(config.requestTimeoutMs)).append("|");
+  key.append(std::to_string(config.maxConnections)).append("|");
+  key.append(config.enableTcpKeepAlive ? "1|" : "0|");
+  key.append(std::to_string(config.tcpKeepAliveIntervalMs)).append("|");
+  key.append(config.proxyHost.c_str()).append(":");
+  key.append(std::to_string(config.proxyPort)).append("|");
+  if (credentials.provider) {
+    key.append("provider:").append(
+        std::to_string(reinterpret_cast<uintptr_t>(credentials.provider.get())));
+  } else {
+    // The secret itself isn't kept in the key
+    key.append(std::to_string(static_cast<int>(credentials.type))).append("|");
+    key.append(credentials.access_key_id).append("|");
+    key.append(std::to_string(std::hash<std::string>()(credentials.secret_key)))
+        .append("|");
+    key.append(credentials.config_file);
+  }
+
+  std::lock_guard<std::mutex> lock(*mutex);
+  auto& entry = (*clients)[key];
+  auto client = entry.lock();
+  if (!client) {
+    client = NewS3Client(creds, config);
+    entry = client;
+  }
+  // Drop the entries of the clients which were released
+  for (auto it = clients->begin(); it != clients->end();) {
+    if (it->second.expired()) {
+      it = clients->erase(it);
     } else {
-      client_ = std::make_shared<Aws::S3::S3Client>(config);
+      ++it;
     }
+  }
+  return client;
+}
+}  // namespace
+
+class AwsS3ClientWrapper {
+ public:
+  AwsS3ClientWrapper(const std::shared_ptr<Aws::S3::S3Client>& client,
+                     const CloudFileSystemOptions& cloud_options)
+      : client_(client),
+        cloud_request_callback_(cloud_options.cloud_request_callback),
+        statistics_(cloud_options.statistics),
+        adaptive_throttling_(cloud_options.s3_adaptive_throttling) {
     if (cloud_options.use_aws_transfer_manager) {
       Aws::Transfer::TransferManagerConfiguration transferManagerConfig(
           GetAwsTransferManagerExecutor());
@@ -139,8 +257,10 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::ListObjectsOutcome ListCloudObjects(
       const Aws::S3::Model::ListObjectsRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetPrefix()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
-                                CloudRequestOpType::kListOp);
+                                statistics_.get(), CloudRequestOpType::kListOp);
     auto outcome = client_->ListObjects(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
@@ -149,6 +269,7 @@ class AwsS3ClientWrapper {
   Aws::S3::Model::CreateBucketOutcome CreateBucket(
       const Aws::S3::Model::CreateBucketRequest& request) {
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
                                 CloudRequestOpType::kCreateOp);
     auto outcome = client_->CreateBucket(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -157,25 +278,48 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::HeadBucketOutcome HeadBucket(
       const Aws::S3::Model::HeadBucketRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), ""), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
-                                CloudRequestOpType::kInfoOp);
+                                statistics_.get(), CloudRequestOpType::kInfoOp);
     auto outcome = client_->HeadBucket(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
   }
   Aws::S3::Model::DeleteObjectOutcome DeleteCloudObject(
       const Aws::S3::Model::DeleteObjectRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
                                 CloudRequestOpType::kDeleteOp);
     auto outcome = client_->DeleteObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
   }
 
+  Aws::S3::Model::DeleteObjectsOutcome DeleteCloudObjects(
+      const Aws::S3::Model::DeleteObjectsRequest& request) {
+    // The objects deleted at once are in the same directory
+    const auto& objects = request.GetDelete().GetObjects();
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(),
+                  objects.empty() ? Aws::String() : objects[0].GetKey()),
+        statistics_.get());
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
+                                CloudRequestOpType::kDeleteOp);
+    auto outcome = client_->DeleteObjects(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
   Aws::S3::Model::CopyObjectOutcome CopyCloudObject(
       const Aws::S3::Model::CopyObjectRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
-                                CloudRequestOpType::kCopyOp);
+                                statistics_.get(), CloudRequestOpType::kCopyOp);
     auto outcome = client_->CopyObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
@@ -183,8 +327,10 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::GetObjectOutcome GetCloudObject(
       const Aws::S3::Model::GetObjectRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
-                                CloudRequestOpType::kReadOp);
+                                statistics_.get(), CloudRequestOpType::kReadOp);
     auto outcome = client_->GetObject(request);
     if (outcome.IsSuccess()) {
       t.SetSize(outcome.GetResult().GetContentLength());
@@ -196,6 +342,7 @@ class AwsS3ClientWrapper {
   template <class... Args>
   std::shared_ptr<Aws::Transfer::TransferHandle> DownloadFile(Args... args) {
     CloudRequestCallbackGuard guard(cloud_request_callback_.get(),
+                                    statistics_.get(),
                                     CloudRequestOpType::kReadOp);
     auto handle = transfer_manager_->DownloadFile(std::forward<Args>(args)...);
 
@@ -211,22 +358,75 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::PutObjectOutcome PutCloudObject(
       const Aws::S3::Model::PutObjectRequest& request, uint64_t size_hint = 0) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
                                 CloudRequestOpType::kWriteOp, size_hint);
     auto outcome = client_->PutObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
   }
 
+  Aws::S3::Model::CreateMultipartUploadOutcome CreateMultipartUpload(
+      const Aws::S3::Model::CreateMultipartUploadRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
+                                CloudRequestOpType::kCreateOp);
+    auto outcome = client_->CreateMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::UploadPartOutcome UploadPart(
+      const Aws::S3::Model::UploadPartRequest& request, uint64_t size) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
+                                CloudRequestOpType::kWriteOp, size);
+    auto outcome = client_->UploadPart(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::CompleteMultipartUploadOutcome CompleteMultipartUpload(
+      const Aws::S3::Model::CompleteMultipartUploadRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
+                                CloudRequestOpType::kWriteOp);
+    auto outcome = client_->CompleteMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::AbortMultipartUploadOutcome AbortMultipartUpload(
+      const Aws::S3::Model::AbortMultipartUploadRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+                                statistics_.get(),
+                                CloudRequestOpType::kDeleteOp);
+    auto outcome = client_->AbortMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
   std::shared_ptr<Aws::Transfer::TransferHandle> UploadFile(
       const Aws::String& bucket_name, const Aws::String& object_path,
-      const Aws::String& destination, uint64_t file_size) {
+      const Aws::String& destination, uint64_t file_size,
+      const Aws::Map<Aws::String, Aws::String>& metadata) {
     CloudRequestCallbackGuard guard(cloud_request_callback_.get(),
+                                    statistics_.get(),
                                     CloudRequestOpType::kWriteOp, file_size);
 
     auto handle = transfer_manager_->UploadFile(
         destination, bucket_name, object_path, Aws::DEFAULT_CONTENT_TYPE,
-        Aws::Map<Aws::String, Aws::String>());
+        metadata);
 
     handle->WaitUntilFinished();
     guard.SetSuccess(handle->GetStatus() ==
@@ -236,8 +436,10 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::HeadObjectOutcome HeadObject(
       const Aws::S3::Model::HeadObjectRequest& request) {
+    CloudRequestThrottleGuard throttle(
+        Throttler(request.GetBucket(), request.GetKey()), statistics_.get());
     CloudRequestCallbackGuard t(cloud_request_callback_.get(),
-                                CloudRequestOpType::kInfoOp);
+                                statistics_.get(), CloudRequestOpType::kInfoOp);
     auto outcome = client_->HeadObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
@@ -248,6 +450,19 @@ class AwsS3ClientWrapper {
   bool HasTransferManager() const { return transfer_manager_.get() != nullptr; }
 
  private:
+  // The rate limit of the requests to object_path in bucket, null unless
+  // s3_adaptive_throttling
+  CloudRequestThrottler* Throttler(const Aws::String& bucket,
+                                   const Aws::String& object_path) const {
+    if (!adaptive_throttling_) {
+      return nullptr;
+    }
+    return CloudRequestThrottler::Get(
+        std::string(bucket.c_str(), bucket.size()),
+        CloudRequestThrottler::PrefixOf(
+            std::string(object_path.c_str(), object_path.size())));
+  }
+
   static Aws::Utils::Threading::Executor* GetAwsTransferManagerExecutor() {
     static Aws::Utils::Threading::PooledThreadExecutor executor(8);
     return &executor;
@@ -256,6 +471,8 @@ class AwsS3ClientWrapper {
   std::shared_ptr<Aws::S3::S3Client> client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
   std::shared_ptr<CloudRequestCallback> cloud_request_callback_;
+  std::shared_ptr<Statistics> statistics_;
+  const bool adaptive_throttling_;
 };
 
 static bool IsNotFound(const Aws::S3::S3Errors& s3err) {
@@ -264,15 +481,165 @@ static bool IsNotFound(const Aws::S3::S3Errors& s3err) {
           s3err == Aws::S3::S3Errors::RESOURCE_NOT_FOUND);
 }
 
+namespace {
+// The AWS SDK for S3 downloads writes the results to a std::iostream, so
+// to support O_DIRECT on file download we need to customize iostream. The
+// easiest way is to subclass std::streambuf. WritableFileWriter already
+// supports direct I/O, including the necessary buffering and alignment
+// logic, so rather than implement an O_DIRECT-friendly streambuf we just
+// forward streambuf write operations to WritableFileWriter, then wrap the
+// forwarder in an iostream.
+class WritableFileStreamBuf : public std::streambuf {
+ public:
+  // If crc32c isn't null, keeps the CRC32C of the data written there
+  WritableFileStreamBuf(IOStatus* fileCloseStatus,
+                        std::unique_ptr<WritableFileWriter>&& fileWriter,
+                        uint32_t* crc32c = nullptr)
+      : fileCloseStatus_(fileCloseStatus),
+        fileWriter_(std::move(fileWriter)),
+        crc32c_(crc32c) {
+    if (crc32c_ != nullptr) {
+      *crc32c_ = 0;
+    }
+  }
+
+  ~WritableFileStreamBuf() {
+    *fileCloseStatus_ = fileWriter_->Close({});
+  }
+
+ protected:
+  // Appends a block of data to the stream. Must always write n if possible
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    auto st = fileWriter_->Append({}, rocksdb::Slice(s, n));
+    if (!st.ok()) {
+      return EOF;
+    }
+    if (crc32c_ != nullptr) {
+      *crc32c_ = crc32c::Extend(*crc32c_, s, static_cast<size_t>(n));
+    }
+    return n;
+  }
+
+  // Appends a single character
+  int_type overflow(int_type ch) override {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+      return ch;
+    }
+    auto c = traits_type::to_char_type(ch);
+    auto r = xsputn(&c, 1);
+    if (r == EOF) {
+      return traits_type::eof();
+    }
+    // In case of success, the character put is returned
+    return ch;
+  }
+
+  // Flushes any buffered data
+  int sync() override {
+    auto st = fileWriter_->Flush({});
+    return st.ok() ? 0 : -1;
+  }
+
+ private:
+  IOStatus *fileCloseStatus_;
+  std::unique_ptr<WritableFileWriter> fileWriter_;
+  uint32_t* crc32c_;
+};
+
+// std::iostream takes a raw pointer to std::streambuf. This subclass
+// takes a unique_ptr to the streambuf, tying the std::streambuf's
+// lifetime to the iostream's.
+template <class T>
+class IOStreamWithOwnedBuf : public std::iostream {
+ public:
+  IOStreamWithOwnedBuf(std::unique_ptr<T>&& s)
+      : std::iostream(s.get()), s_(std::move(s)) {}
+
+ private:
+  std::unique_ptr<T> s_;
+};
+
+// Lets the SDK write the body of a ranged read straight into the scratch
+// buffer of the caller, instead of into a string stream it is then copied
+// from. Bytes past the end of the buffer are dropped.
+class ScratchStreamBuf : public std::streambuf {
+ public:
+  ScratchStreamBuf(char* scratch, size_t n) { setp(scratch, scratch + n); }
+
+  // Number of bytes written to the buffer
+  size_t size() const { return pptr() - pbase(); }
+
+ protected:
+  int_type overflow(int_type ch) override {
+    return traits_type::eq_int_type(ch, traits_type::eof())
+               ? traits_type::eof()
+               : traits_type::not_eof(ch);
+  }
+};
+
+// Runs fn(0) to fn(n - 1) on up to parallelism threads, the calling thread
+// included, and returns the first error. The tasks not started at the time
+// of an error are skipped.
+IOStatus RunInParallel(size_t n, int parallelism,
+                       const std::function<IOStatus(size_t)>& fn) {
+  std::atomic<size_t> next_task{0};
+  std::atomic<bool> failed{false};
+  std::mutex mutex;
+  IOStatus first_error;
+  auto worker = [&]() {
+    while (!failed.load()) {
+      auto i = next_task.fetch_add(1);
+      if (i >= n) {
+        break;
+      }
+      auto st = fn(i);
+      if (!st.ok()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first_error.ok()) {
+          first_error = st;
+        }
+        failed = true;
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(n, static_cast<size_t>(parallelism)); i++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& w : workers) {
+    w.join();
+  }
+  return first_error;
+}
+
+// The keys at which the top level of a path listed in parallel is split, after
+// its first page: most objects of a DB are the numbered files, whose names
+// start with zeros
+std::vector<std::string> ListBoundaries() {
+  std::vector<std::string> boundaries;
+  for (const char* lead : {"00", "0", ""}) {
+    for (char digit = '1'; digit <= '9'; digit++) {
+      boundaries.push_back(std::string(lead) + digit);
+    }
+  }
+  return boundaries;
+}
+}  // namespace
+
 /******************** S3ReadableFile ******************/
 class S3ReadableFile : public CloudStorageReadableFileImpl {
  public:
   S3ReadableFile(const std::shared_ptr<AwsS3ClientWrapper>& s3client,
+                 const std::shared_ptr<CloudRequestHedger>& hedger,
+                 const std::shared_ptr<CloudLatencyTracker>& read_latency,
                  Logger* info_log, const std::string& bucket,
                  const std::string& fname, uint64_t size,
                  std::string content_hash)
       : CloudStorageReadableFileImpl(info_log, bucket, fname, size),
         s3client_(s3client),
+        hedger_(hedger),
+        read_latency_(read_latency),
         content_hash_(std::move(content_hash)) {}
 
   virtual const char* Type() const { return "s3"; }
@@ -288,9 +655,59 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
   }
 
   // random access, read data from specified offset in file
-  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& /*options*/,
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& options,
                        char* scratch, uint64_t* bytes_read,
                        IODebugContext* /*dbg*/) const override {
+    // ReadOptions::deadline and io_timeout are passed down as the timeout
+    auto timeout = static_cast<uint64_t>(options.timeout.count());
+    if (!hedger_ ||
+        !CloudRequestHedger::ShouldRun(read_latency_.get(), timeout)) {
+      auto start = SystemClock::Default()->NowMicros();
+      auto st = ReadRange(s3client_.get(), info_log_, bucket_, fname_, offset,
+                          n, scratch, bytes_read);
+      if (st.ok() && read_latency_) {
+        read_latency_->Record(SystemClock::Default()->NowMicros() - start);
+      }
+      return st;
+    }
+
+    // An attempt which lost can outlive this call, and the file, so each
+    // attempt reads into a buffer of its own and uses copies of the state
+    // of the file
+    struct Result {
+      std::string data;
+      uint64_t bytes_read = 0;
+    };
+    auto results = std::make_shared<std::array<Result, 2>>();
+    auto attempt = [results, s3client = s3client_, info_log = info_log_,
+                    bucket = bucket_, fname = fname_, offset, n](int i) {
+      auto& result = (*results)[i];
+      result.data.resize(n);
+      return ReadRange(s3client.get(), info_log, bucket, fname, offset, n,
+                       &result.data[0], &result.bytes_read);
+    };
+    int winner = -1;
+    auto st = hedger_->Run(read_latency_, attempt, nullptr /* discard */,
+                           timeout, &winner);
+    if (st.ok()) {
+      const auto& result = (*results)[winner];
+      memcpy(scratch, result.data.data(), result.bytes_read);
+      *bytes_read = result.bytes_read;
+    } else if (st.IsTimedOut()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[s3] S3ReadableFile read of %s offset %" PRIu64
+          " size %" ROCKSDB_PRIszt " timed out after %" PRIu64 "us",
+          fname_.c_str(), offset, n, timeout);
+    }
+    return st;
+  }
+
+ private:
+  // Reads a range of the object with a single request
+  static IOStatus ReadRange(AwsS3ClientWrapper* s3client, Logger* info_log,
+                            const std::string& bucket,
+                            const std::string& fname, uint64_t offset,
+                            size_t n, char* scratch, uint64_t* bytes_read) {
     // create a range read request
     // Ranges are inclusive, so we can't read 0 bytes; read 1 instead and
     // drop it later.
@@ -299,22 +716,34 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
     int ret = snprintf(buffer, sizeof(buffer), "bytes=%" PRIu64 "-%" PRIu64,
                        offset, offset + rangeLen - 1);
     if (ret < 0) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+      Log(InfoLogLevel::ERROR_LEVEL, info_log,
           "[s3] S3ReadableFile vsnprintf error %s offset %" PRIu64
           " rangelen %" ROCKSDB_PRIszt "\n",
-          fname_.c_str(), offset, rangeLen);
-      return IOStatus::IOError("S3ReadableFile vsnprintf ", fname_.c_str());
+          fname.c_str(), offset, rangeLen);
+      return IOStatus::IOError("S3ReadableFile vsnprintf ", fname.c_str());
     }
     Aws::String range(buffer);
 
     // set up S3 request to read this range
     Aws::S3::Model::GetObjectRequest request;
-    request.SetBucket(ToAwsString(bucket_));
-    request.SetKey(ToAwsString(fname_));
+    request.SetBucket(ToAwsString(bucket));
+    request.SetKey(ToAwsString(fname));
     request.SetRange(range);
+    // The factory is called again when the request is retried, each stream
+    // writes from the start of scratch
+    ScratchStreamBuf* scratch_buf = nullptr;
+    if (n != 0) {
+      request.SetResponseStreamFactory([scratch, n, &scratch_buf]() {
+        std::unique_ptr<ScratchStreamBuf> buf(
+            new ScratchStreamBuf(scratch, n));
+        scratch_buf = buf.get();
+        return Aws::New<IOStreamWithOwnedBuf<ScratchStreamBuf>>(
+            Aws::Utils::ARRAY_ALLOCATION_TAG, std::move(buf));
+      });
+    }
 
     Aws::S3::Model::GetObjectOutcome outcome =
-        s3client_->GetCloudObject(request);
+        s3client->GetCloudObject(request);
     bool isSuccess = outcome.IsSuccess();
     if (!isSuccess) {
       const Aws::Client::AWSError<Aws::S3::S3Errors>& error =
@@ -322,36 +751,34 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
       std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
       if (IsNotFound(error.GetErrorType()) ||
           errmsg.find("Response code: 404") != std::string::npos) {
-        Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+        Log(InfoLogLevel::ERROR_LEVEL, info_log,
             "[s3] S3ReadableFile error in reading not-existent %s %s",
-            fname_.c_str(), errmsg.c_str());
-        return IOStatus::NotFound(fname_, errmsg.c_str());
+            fname.c_str(), errmsg.c_str());
+        return IOStatus::NotFound(fname, errmsg.c_str());
       }
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+      Log(InfoLogLevel::ERROR_LEVEL, info_log,
           "[s3] S3ReadableFile error in reading %s %" PRIu64 " %s %s",
-          fname_.c_str(), offset, buffer, error.GetMessage().c_str());
-      return IOStatus::IOError(fname_, errmsg.c_str());
+          fname.c_str(), offset, buffer, error.GetMessage().c_str());
+      return IOStatus::IOError(fname, errmsg.c_str());
     }
-    std::stringstream ss;
-    // const Aws::S3::Model::GetObjectResult& res = outcome.GetResult();
-
-    // extract data payload
-    Aws::IOStream& body = outcome.GetResult().GetBody();
+    // the payload is already in scratch
     *bytes_read = 0;
     if (n != 0) {
-      body.read(scratch, n);
-      *bytes_read = body.gcount();
+      assert(scratch_buf != nullptr);
+      *bytes_read = scratch_buf->size();
       assert(*bytes_read <= n);
     }
-    Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
-        "[s3] S3ReadableFile file %s filesize %" PRIu64 " read %" PRIu64
+    Log(InfoLogLevel::DEBUG_LEVEL, info_log,
+        "[s3] S3ReadableFile file %s offset %" PRIu64 " read %" PRIu64
         " bytes",
-        fname_.c_str(), file_size_, *bytes_read);
+        fname.c_str(), offset, *bytes_read);
     return IOStatus::OK();
   }
 
- private:
   std::shared_ptr<AwsS3ClientWrapper> s3client_;
+  std::shared_ptr<CloudRequestHedger> hedger_;
+  // Null if reads aren't hedged
+  std::shared_ptr<CloudLatencyTracker> read_latency_;
   std::string content_hash_;
 };  // End class S3ReadableFile
 
@@ -380,9 +807,15 @@ class S3StorageProvider : public CloudStorageProviderImpl {
                        const std::string& object_path) override;
   IOStatus DeleteCloudObject(const std::string& bucket_name,
                              const std::string& object_path) override;
+  IOStatus DeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths) override;
   IOStatus ListCloudObjects(const std::string& bucket_name,
                             const std::string& object_path,
                             std::vector<std::string>* result) override;
+  IOStatus ListCloudObjectsInBatches(
+      const std::string& bucket_name, const std::string& object_path,
+      const ListCloudObjectsCallback& fn) override;
   IOStatus ExistsCloudObject(const std::string& bucket_name,
                              const std::string& object_path) override;
   IOStatus GetCloudObjectSize(const std::string& bucket_name,
@@ -407,21 +840,41 @@ class S3StorageProvider : public CloudStorageProviderImpl {
       const std::string& content_hash, const FileOptions& options,
       std::unique_ptr<CloudStorageReadableFile>* result,
       IODebugContext* dbg) override;
-  IOStatus NewCloudWritableFile(
+  IOStatus DoReadCloudObjectTail(const std::string& bucket_name,
+                                 const std::string& object_path, size_t n,
+                                 std::string* tail,
+                                 CloudObjectInformation* info) override;
+  IOStatus CreateMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata,
+      std::string* upload_id) override;
+  IOStatus CompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
+  IOStatus AbortMultipartUpload(const std::string& bucket_name,
+                                const std::string& object_path,
+                                const std::string& upload_id) override;
+  Status PrepareOptions(const ConfigOptions& options) override;
+ protected:
+  IOStatus DoNewCloudWritableFile(
       const std::string& local_path, const std::string& bucket_name,
       const std::string& object_path, const FileOptions& options,
       std::unique_ptr<CloudStorageWritableFile>* result,
       IODebugContext* dbg) override;
-  Status PrepareOptions(const ConfigOptions& options) override;
- protected:
   IOStatus DoGetCloudObject(const std::string& bucket_name,
                             const std::string& object_path,
                             const std::string& destination,
                             uint64_t* remote_size) override;
-  IOStatus DoPutCloudObject(const std::string& local_file,
-                            const std::string& bucket_name,
-                            const std::string& object_path,
-                            uint64_t file_size) override;
+  IOStatus DoPutCloudObject(
+      const std::string& local_file, const std::string& bucket_name,
+      const std::string& object_path, uint64_t file_size,
+      const std::unordered_map<std::string, std::string>& metadata,
+      const std::string& storage_class) override;
+  IOStatus DoUploadPart(const std::string& bucket_name,
+                        const std::string& object_path,
+                        const std::string& upload_id, int part_number,
+                        const Slice& data, std::string* part_id) override;
 
  private:
   struct HeadObjectResult {
@@ -430,19 +883,63 @@ class S3StorageProvider : public CloudStorageProviderImpl {
     uint64_t* size = nullptr;
     uint64_t* modtime = nullptr;
     std::string* etag = nullptr;
+    std::string* storage_class = nullptr;
   };
 
   // Retrieves metadata from an object
   IOStatus HeadObject(const std::string& bucket, const std::string& path,
                       HeadObjectResult* result);
 
+  // Lists one page of the objects whose keys start with prefix and sort
+  // after marker, appending their keys to keys. If delimited, the
+  // sub-directories of prefix are appended to sub_prefixes instead of their
+  // objects. Sets next_marker to where the next page starts, or to empty
+  // after the last page.
+  IOStatus ListObjectsPage(const std::string& bucket_name,
+                           const std::string& prefix,
+                           const std::string& marker, bool delimited,
+                           std::vector<std::string>* keys,
+                           std::vector<std::string>* sub_prefixes,
+                           std::string* next_marker);
+
+  // Lists the objects of prefix with keys after start_after and up to last,
+  // or to the end if last is empty, calling fn with the names of each page
+  // relative to name_prefix. If sub_prefixes is not null, the
+  // sub-directories of prefix are appended to it instead of being listed.
+  IOStatus ListObjectRange(const std::string& bucket_name,
+                           const std::string& prefix,
+                           const std::string& name_prefix,
+                           const std::string& start_after,
+                           const std::string& last,
+                           std::vector<std::string>* sub_prefixes,
+                           const ListCloudObjectsCallback& fn);
+
   // Retrieves metadata from an object based on a HeadObject request
   // REQUIRES: result != nullptr
   IOStatus HeadObject(const Aws::S3::Model::HeadObjectRequest& request,
                       HeadObjectResult* result);
 
+  // Downloads an object with a single request
+  IOStatus DownloadObject(const std::string& bucket_name,
+                          const std::string& object_path,
+                          const std::string& destination,
+                          uint64_t* remote_size);
+
+  // Threads of each hedger
+  static constexpr int kHedgeThreads = 16;
+
   // The S3 client
   std::shared_ptr<AwsS3ClientWrapper> s3client_;
+  // Runs the reads with a timeout and the hedged reads. Shared with the
+  // readable files.
+  std::shared_ptr<CloudRequestHedger> hedger_;
+  // Runs the hedged downloads, whose attempts use this provider. Declared
+  // after s3client_, so that the attempts still running are waited for
+  // before it's destroyed.
+  std::unique_ptr<CloudRequestHedger> download_hedger_;
+  // Null if reads aren't hedged
+  std::shared_ptr<CloudLatencyTracker> read_latency_;
+  std::shared_ptr<CloudLatencyTracker> download_latency_;
 };
 
 Status S3StorageProvider::PrepareOptions(const ConfigOptions& options) {
@@ -466,9 +963,14 @@ Status S3StorageProvider::PrepareOptions(const ConfigOptions& options) {
       return Status::InvalidArgument("Two different regions not supported");
     }
   }
+  // A client from the factory isn't shared
+  bool shared = cloud_opts.share_s3_client && !cloud_opts.s3_client_factory;
   Aws::Client::ClientConfiguration config;
-  Status status = AwsCloudOptions::GetClientConfiguration(
-      cfs, cloud_opts.src_bucket.GetRegion(), &config);
+  Status status =
+      shared ? AwsCloudOptions::GetSharedClientConfiguration(
+                   cfs, cloud_opts.src_bucket.GetRegion(), &config)
+             : AwsCloudOptions::GetClientConfiguration(
+                   cfs, cloud_opts.src_bucket.GetRegion(), &config);
   if (status.ok()) {
     std::shared_ptr<Aws::Auth::AWSCredentialsProvider> creds;
     status = cloud_opts.credentials.GetCredentialsProvider(&creds);
@@ -478,8 +980,27 @@ Status S3StorageProvider::PrepareOptions(const ConfigOptions& options) {
     } else {
       Header(cfs->GetLogger(), "S3 connection to endpoint in region: %s",
              config.region.c_str());
-      s3client_ =
-          std::make_shared<AwsS3ClientWrapper>(creds, config, cloud_opts);
+      std::shared_ptr<Aws::S3::S3Client> client;
+      if (cloud_opts.s3_client_factory) {
+        client = cloud_opts.s3_client_factory(creds, config);
+      } else if (shared) {
+        client = GetSharedS3Client(creds, config, cloud_opts.credentials);
+      } else {
+        client = NewS3Client(creds, config);
+      }
+      s3client_ = std::make_shared<AwsS3ClientWrapper>(client, cloud_opts);
+      hedger_ = std::make_shared<CloudRequestHedger>(kHedgeThreads);
+      download_hedger_.reset(new CloudRequestHedger(kHedgeThreads));
+      if (cloud_opts.cloud_read_hedge_percentile > 0) {
+        // Ranged reads and downloads of whole objects have latencies of
+        // their own
+        read_latency_ = std::make_shared<CloudLatencyTracker>(
+            cloud_opts.cloud_read_hedge_percentile,
+            cloud_opts.cloud_read_hedge_min_delay_micros);
+        download_latency_ = std::make_shared<CloudLatencyTracker>(
+            cloud_opts.cloud_read_hedge_percentile,
+            cloud_opts.cloud_read_hedge_min_delay_micros);
+      }
     }
   }
   if (!status.ok()) {
@@ -564,17 +1085,60 @@ IOStatus S3StorageProvider::EmptyBucket(const std::string& bucket_name,
       results.size(), bucket_name.c_str());
 
   // Delete all objects from bucket
-  for (const auto& path : results) {
-    st = DeleteCloudObject(bucket_name, object_path + "/" + path);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-          "[s3] EmptyBucket Unable to delete %s in bucket %s %s", path.c_str(),
-          bucket_name.c_str(), st.ToString().c_str());
-    }
+  for (auto& path : results) {
+    path = object_path + "/" + path;
+  }
+  st = DeleteCloudObjects(bucket_name, results);
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] EmptyBucket Unable to delete objects in bucket %s %s",
+        bucket_name.c_str(), st.ToString().c_str());
   }
   return st;
 }
 
+IOStatus S3StorageProvider::DeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  // The most keys a DeleteObjects request takes
+  constexpr size_t kMaxKeysPerRequest = 1000;
+  IOStatus first_error;
+  for (size_t start = 0; start < object_paths.size();
+       start += kMaxKeysPerRequest) {
+    auto end = std::min(start + kMaxKeysPerRequest, object_paths.size());
+    Aws::S3::Model::Delete del;
+    for (size_t i = start; i < end; i++) {
+      del.AddObjects(
+          Aws::S3::Model::ObjectIdentifier().WithKey(ToAwsString(
+              object_paths[i])));
+    }
+    // Only the failures are reported back
+    del.SetQuiet(true);
+    Aws::S3::Model::DeleteObjectsRequest request;
+    request.SetBucket(ToAwsString(bucket_name));
+    request.SetDelete(std::move(del));
+
+    auto outcome = s3client_->DeleteCloudObjects(request);
+    IOStatus st;
+    if (!outcome.IsSuccess()) {
+      st = IOStatus::IOError(bucket_name,
+                             outcome.GetError().GetMessage().c_str());
+    } else if (!outcome.GetResult().GetErrors().empty()) {
+      const auto& error = outcome.GetResult().GetErrors().front();
+      st = IOStatus::IOError(error.GetKey().c_str(),
+                             error.GetMessage().c_str());
+    }
+    Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+        cfs_->GetLogger(),
+        "[s3] DeleteObjects %" ROCKSDB_PRIszt " objects from %s, %s",
+        end - start, bucket_name.c_str(), st.ToString().c_str());
+    if (!st.ok() && first_error.ok()) {
+      first_error = st;
+    }
+  }
+  return first_error;
+}
+
 IOStatus S3StorageProvider::DeleteCloudObject(const std::string& bucket_name,
                                               const std::string& object_path) {
   IOStatus st;
@@ -612,71 +1176,194 @@ IOStatus S3StorageProvider::DeleteCloudObject(const std::string& bucket_name,
 IOStatus S3StorageProvider::ListCloudObjects(const std::string& bucket_name,
                                              const std::string& object_path,
                                              std::vector<std::string>* result) {
+  auto old_size = result->size();
+  auto st = ListCloudObjectsInBatches(
+      bucket_name, object_path,
+      [result](const std::vector<std::string>& path_names) {
+        result->insert(result->end(), path_names.begin(), path_names.end());
+        return IOStatus::OK();
+      });
+  // The batches of a parallel listing come in any order
+  std::sort(result->begin() + old_size, result->end());
+  return st;
+}
+
+IOStatus S3StorageProvider::ListCloudObjectsInBatches(
+    const std::string& bucket_name, const std::string& object_path,
+    const ListCloudObjectsCallback& fn) {
   // S3 paths don't start with '/'
   auto prefix = ltrim_if(object_path, '/');
   // S3 paths better end with '/', otherwise we might also get a list of files
   // in a directory for which our path is a prefix
   prefix = ensure_ends_with_pathsep(std::move(prefix));
-  // the starting object marker
-  Aws::String marker;
-  bool loop = true;
-
-  // get info of bucket+object
-  while (loop) {
-    Aws::S3::Model::ListObjectsRequest request;
-    request.SetBucket(ToAwsString(bucket_name));
-    request.SetMaxKeys(cfs_->GetCloudFileSystemOptions()
-                           .number_objects_listed_in_one_iteration);
-
-    request.SetPrefix(ToAwsString(prefix));
-    request.SetMarker(marker);
+  int parallelism =
+      cfs_->GetCloudFileSystemOptions().list_objects_parallelism;
+  if (parallelism <= 1) {
+    return ListObjectRange(bucket_name, prefix, prefix, "", "", nullptr, fn);
+  }
 
-    Aws::S3::Model::ListObjectsOutcome outcome =
-        s3client_->ListCloudObjects(request);
-    bool isSuccess = outcome.IsSuccess();
-    if (!isSuccess) {
-      const Aws::Client::AWSError<Aws::S3::S3Errors>& error =
-          outcome.GetError();
-      std::string errmsg(error.GetMessage().c_str());
-      if (IsNotFound(error.GetErrorType())) {
-        Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-            "[s3] GetChildren dir %s does not exist: %s", object_path.c_str(),
-            errmsg.c_str());
-        return IOStatus::NotFound(object_path, errmsg.c_str());
-      }
-      return IOStatus::IOError(object_path, errmsg.c_str());
+  std::mutex mutex;
+  auto serialized_fn = [&](const std::vector<std::string>& path_names) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fn(path_names);
+  };
+  // The first page of the top level of the path tells whether the path is
+  // large enough to be split
+  std::vector<std::string> keys;
+  std::vector<std::string> sub_prefixes;
+  std::string marker;
+  auto st = ListObjectsPage(bucket_name, prefix, "", true, &keys,
+                            &sub_prefixes, &marker);
+  if (st.ok() && !keys.empty()) {
+    for (auto& key : keys) {
+      key.erase(0, prefix.size());
     }
-    const Aws::S3::Model::ListObjectsResult& res = outcome.GetResult();
-    const Aws::Vector<Aws::S3::Model::Object>& objs = res.GetContents();
-    for (const auto& o : objs) {
-      const Aws::String& key = o.GetKey();
-      // Our path should be a prefix of the fetched value
-      std::string keystr(key.c_str(), key.size());
-      assert(keystr.find(prefix) == 0);
-      if (keystr.find(prefix) != 0) {
-        return IOStatus::IOError("Unexpected result from AWS S3: " + keystr);
+    st = fn(keys);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+
+  // The rest of the top level, by key range
+  std::vector<std::pair<std::string, std::string>> ranges;
+  if (!marker.empty()) {
+    for (const auto& boundary : ListBoundaries()) {
+      auto last = prefix + boundary;
+      if (last > marker) {
+        ranges.emplace_back(marker, last);
+        marker = last;
       }
-      auto fname = keystr.substr(prefix.size());
-      result->push_back(std::move(fname));
     }
+    ranges.emplace_back(marker, "");
+  }
+  std::vector<std::vector<std::string>> range_sub_prefixes(ranges.size());
+  st = RunInParallel(ranges.size(), parallelism, [&](size_t i) {
+    return ListObjectRange(bucket_name, prefix, prefix, ranges[i].first,
+                           ranges[i].second, &range_sub_prefixes[i],
+                           serialized_fn);
+  });
+  if (!st.ok()) {
+    return st;
+  }
+  for (const auto& range : range_sub_prefixes) {
+    sub_prefixes.insert(sub_prefixes.end(), range.begin(), range.end());
+  }
+  std::sort(sub_prefixes.begin(), sub_prefixes.end());
+  sub_prefixes.erase(std::unique(sub_prefixes.begin(), sub_prefixes.end()),
+                     sub_prefixes.end());
+
+  // Then each sub-directory in full
+  return RunInParallel(sub_prefixes.size(), parallelism, [&](size_t i) {
+    return ListObjectRange(bucket_name, sub_prefixes[i], prefix, "", "",
+                           nullptr, serialized_fn);
+  });
+}
+
+IOStatus S3StorageProvider::ListObjectsPage(
+    const std::string& bucket_name, const std::string& prefix,
+    const std::string& marker, bool delimited, std::vector<std::string>* keys,
+    std::vector<std::string>* sub_prefixes, std::string* next_marker) {
+  Aws::S3::Model::ListObjectsRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetMaxKeys(
+      cfs_->GetCloudFileSystemOptions().number_objects_listed_in_one_iteration);
+  request.SetPrefix(ToAwsString(prefix));
+  request.SetMarker(ToAwsString(marker));
+  if (delimited) {
+    request.SetDelimiter("/");
+  }
 
-    // If there are no more entries, then we are done.
-    if (!res.GetIsTruncated()) {
-      break;
+  Aws::S3::Model::ListObjectsOutcome outcome =
+      s3client_->ListCloudObjects(request);
+  bool isSuccess = outcome.IsSuccess();
+  if (!isSuccess) {
+    const Aws::Client::AWSError<Aws::S3::S3Errors>& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str());
+    if (IsNotFound(error.GetErrorType())) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+          "[s3] GetChildren dir %s does not exist: %s", prefix.c_str(),
+          errmsg.c_str());
+      return IOStatus::NotFound(prefix, errmsg.c_str());
+    }
+    return IOStatus::IOError(prefix, errmsg.c_str());
+  }
+  const Aws::S3::Model::ListObjectsResult& res = outcome.GetResult();
+  std::string last_listed;
+  for (const auto& o : res.GetContents()) {
+    const Aws::String& key = o.GetKey();
+    // Our path should be a prefix of the fetched value
+    std::string keystr(key.c_str(), key.size());
+    assert(keystr.find(prefix) == 0);
+    if (keystr.find(prefix) != 0) {
+      return IOStatus::IOError("Unexpected result from AWS S3: " + keystr);
     }
-    // The new starting point
-    marker = res.GetNextMarker();
-    if (marker.empty()) {
+    last_listed = keystr;
+    keys->push_back(std::move(keystr));
+  }
+  for (const auto& p : res.GetCommonPrefixes()) {
+    std::string sub_prefix(p.GetPrefix().c_str(), p.GetPrefix().size());
+    last_listed = std::max(last_listed, sub_prefix);
+    sub_prefixes->push_back(std::move(sub_prefix));
+  }
+
+  next_marker->clear();
+  // If there are no more entries, then we are done.
+  if (res.GetIsTruncated()) {
+    const Aws::String& marker_str = res.GetNextMarker();
+    next_marker->assign(marker_str.c_str(), marker_str.size());
+    if (next_marker->empty()) {
       // If response does not include the NextMaker and it is
       // truncated, you can use the value of the last Key in the response
       // as the marker in the subsequent request because all objects
       // are returned in alphabetical order
-      marker = objs.back().GetKey();
+      *next_marker = last_listed;
     }
   }
   return IOStatus::OK();
 }
 
+IOStatus S3StorageProvider::ListObjectRange(
+    const std::string& bucket_name, const std::string& prefix,
+    const std::string& name_prefix, const std::string& start_after,
+    const std::string& last, std::vector<std::string>* sub_prefixes,
+    const ListCloudObjectsCallback& fn) {
+  std::string marker = start_after;
+  std::vector<std::string> keys;
+  do {
+    keys.clear();
+    auto num_sub_prefixes = sub_prefixes ? sub_prefixes->size() : 0;
+    auto st = ListObjectsPage(bucket_name, prefix, marker,
+                              sub_prefixes != nullptr, &keys, sub_prefixes,
+                              &marker);
+    if (!st.ok()) {
+      return st;
+    }
+    if (!last.empty()) {
+      // Both lists are sorted
+      while (!keys.empty() && keys.back() > last) {
+        keys.pop_back();
+      }
+      while (sub_prefixes && sub_prefixes->size() > num_sub_prefixes &&
+             sub_prefixes->back() > last) {
+        sub_prefixes->pop_back();
+      }
+      if (marker >= last) {
+        marker.clear();
+      }
+    }
+    if (!keys.empty()) {
+      for (auto& key : keys) {
+        key.erase(0, name_prefix.size());
+      }
+      st = fn(keys);
+      if (!st.ok()) {
+        return st;
+      }
+    }
+  } while (!marker.empty());
+  return IOStatus::OK();
+}
+
 // check existence of the cloud object
 IOStatus S3StorageProvider::ExistsCloudObject(const std::string& bucket_name,
                                               const std::string& object_path) {
@@ -710,6 +1397,7 @@ IOStatus S3StorageProvider::GetCloudObjectMetadata(
   result.size = &info->size;
   result.modtime = &info->modification_time;
   result.etag = &info->content_hash;
+  result.storage_class = &info->storage_class;
   return HeadObject(bucket_name, object_path, &result);
 }
 
@@ -744,12 +1432,58 @@ IOStatus S3StorageProvider::DoNewCloudReadableFile(
     const std::string& content_hash, const FileOptions& /*options*/,
     std::unique_ptr<CloudStorageReadableFile>* result,
     IODebugContext* /*dbg*/) {
-  result->reset(new S3ReadableFile(s3client_, cfs_->GetLogger(), bucket, fname,
-                                   fsize, content_hash));
+  result->reset(new S3ReadableFile(s3client_, hedger_, read_latency_,
+                                   cfs_->GetLogger(), bucket, fname, fsize,
+                                   content_hash));
   return IOStatus::OK();
 }
 
-IOStatus S3StorageProvider::NewCloudWritableFile(
+IOStatus S3StorageProvider::DoReadCloudObjectTail(
+    const std::string& bucket_name, const std::string& object_path, size_t n,
+    std::string* tail, CloudObjectInformation* info) {
+  // A suffix range, S3 returns the whole object if it is smaller
+  Aws::S3::Model::GetObjectRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetRange(ToAwsString("bytes=-" + std::to_string(n)));
+  auto outcome = s3client_->GetCloudObject(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    if (IsNotFound(error.GetErrorType())) {
+      return IOStatus::NotFound(object_path, errmsg.c_str());
+    }
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] GetObject tail %s/%s error %s.", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg.c_str());
+  }
+  const auto& res = outcome.GetResult();
+  auto& body = res.GetBody();
+  tail->assign(std::istreambuf_iterator<char>(body),
+               std::istreambuf_iterator<char>());
+  if (static_cast<int64_t>(tail->size()) != res.GetContentLength()) {
+    return IOStatus::IOError(object_path, "Short tail read");
+  }
+  // "bytes first-last/size", absent if the whole object came back
+  const auto& range = res.GetContentRange();
+  auto slash = range.find('/');
+  if (slash != Aws::String::npos) {
+    info->size = std::strtoull(range.c_str() + slash + 1, nullptr, 10);
+  } else {
+    info->size = tail->size();
+  }
+  if (info->size < tail->size()) {
+    return IOStatus::IOError(object_path, "Bad content range");
+  }
+  info->content_hash.assign(res.GetETag().data(), res.GetETag().size());
+  for (const auto& m : res.GetMetadata()) {
+    info->metadata[m.first.c_str()] = m.second.c_str();
+  }
+  return IOStatus::OK();
+}
+
+IOStatus S3StorageProvider::DoNewCloudWritableFile(
     const std::string& local_path, const std::string& bucket_name,
     const std::string& object_path, const FileOptions& file_opts,
     std::unique_ptr<CloudStorageWritableFile>* result,
@@ -799,6 +1533,13 @@ IOStatus S3StorageProvider::HeadObject(
   if ((result->etag) != nullptr) {
     *(result->etag) = std::string(res.GetETag().data(), res.GetETag().length());
   }
+  // Objects in the default storage class have none
+  if (result->storage_class != nullptr &&
+      res.GetStorageClass() != Aws::S3::Model::StorageClass::NOT_SET) {
+    auto name = Aws::S3::Model::StorageClassMapper::GetNameForStorageClass(
+        res.GetStorageClass());
+    *(result->storage_class) = std::string(name.data(), name.size());
+  }
   return IOStatus::OK();
 }
 
@@ -841,78 +1582,159 @@ IOStatus S3StorageProvider::CopyCloudObject(
   return IOStatus::OK();
 }
 
-namespace {
-// The AWS SDK for S3 downloads writes the results to a std::iostream, so
-// to support O_DIRECT on file download we need to customize iostream. The
-// easiest way is to subclass std::streambuf. WritableFileWriter already
-// supports direct I/O, including the necessary buffering and alignment
-// logic, so rather than implement an O_DIRECT-friendly streambuf we just
-// forward streambuf write operations to WritableFileWriter, then wrap the
-// forwarder in an iostream.
-class WritableFileStreamBuf : public std::streambuf {
- public:
-  WritableFileStreamBuf(IOStatus* fileCloseStatus,
-			std::unique_ptr<WritableFileWriter>&& fileWriter)
-    : fileCloseStatus_(fileCloseStatus), fileWriter_(std::move(fileWriter)) {}
-
-  ~WritableFileStreamBuf() {
-    *fileCloseStatus_ = fileWriter_->Close({});
-  }
-
- protected:
-  // Appends a block of data to the stream. Must always write n if possible
-  std::streamsize xsputn(const char* s, std::streamsize n) override {
-    auto st = fileWriter_->Append({}, rocksdb::Slice(s, n));
-    if (!st.ok()) {
-      return EOF;
+IOStatus S3StorageProvider::CreateMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata,
+    std::string* upload_id) {
+  Aws::S3::Model::CreateMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  if (!metadata.empty()) {
+    Aws::Map<Aws::String, Aws::String> aws_metadata;
+    for (const auto& m : metadata) {
+      aws_metadata[ToAwsString(m.first)] = ToAwsString(m.second);
     }
-    return n;
+    request.SetMetadata(aws_metadata);
   }
+  SetEncryptionParameters(cfs_->GetCloudFileSystemOptions(), request);
 
-  // Appends a single character
-  int_type overflow(int_type ch) override {
-    if (traits_type::eq_int_type(ch, traits_type::eof())) {
-      return ch;
-    }
-    auto c = traits_type::to_char_type(ch);
-    auto r = xsputn(&c, 1);
-    if (r == EOF) {
-      return traits_type::eof();
-    }
-    // In case of success, the character put is returned
-    return ch;
+  auto outcome = s3client_->CreateMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] CreateMultipartUpload %s/%s error %s", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
   }
+  const auto& id = outcome.GetResult().GetUploadId();
+  upload_id->assign(id.c_str(), id.size());
+  return IOStatus::OK();
+}
 
-  // Flushes any buffered data
-  int sync() override {
-    auto st = fileWriter_->Flush({});
-    return st.ok() ? 0 : -1;
+IOStatus S3StorageProvider::DoUploadPart(const std::string& bucket_name,
+                                         const std::string& object_path,
+                                         const std::string& upload_id,
+                                         int part_number, const Slice& data,
+                                         std::string* part_id) {
+  auto body = Aws::MakeShared<Aws::StringStream>(object_path.c_str());
+  body->write(data.data(), data.size());
+
+  Aws::S3::Model::UploadPartRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
+  request.SetPartNumber(part_number);
+  request.SetContentLength(data.size());
+  request.SetBody(body);
+
+  auto outcome = s3client_->UploadPart(request, data.size());
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] UploadPart %s/%s part %d size %" ROCKSDB_PRIszt " error %s",
+        bucket_name.c_str(), object_path.c_str(), part_number, data.size(),
+        errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
   }
+  const auto& etag = outcome.GetResult().GetETag();
+  part_id->assign(etag.c_str(), etag.size());
+  return IOStatus::OK();
+}
 
- private:
-  IOStatus *fileCloseStatus_;
-  std::unique_ptr<WritableFileWriter> fileWriter_;
-};
+IOStatus S3StorageProvider::CompleteMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
+  Aws::S3::Model::CompletedMultipartUpload upload;
+  for (size_t i = 0; i < part_ids.size(); i++) {
+    Aws::S3::Model::CompletedPart part;
+    part.SetPartNumber(static_cast<int>(i + 1));
+    part.SetETag(ToAwsString(part_ids[i]));
+    upload.AddParts(std::move(part));
+  }
+  Aws::S3::Model::CompleteMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
+  request.SetMultipartUpload(std::move(upload));
 
-// std::iostream takes a raw pointer to std::streambuf. This subclass
-// takes a unique_ptr to the streambuf, tying the std::streambuf's
-// lifetime to the iostream's.
-template <class T>
-class IOStreamWithOwnedBuf : public std::iostream {
- public:
-  IOStreamWithOwnedBuf(std::unique_ptr<T>&& s)
-      : std::iostream(s.get()), s_(std::move(s)) {}
+  auto outcome = s3client_->CompleteMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] CompleteMultipartUpload %s/%s error %s", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  return IOStatus::OK();
+}
 
- private:
-  std::unique_ptr<T> s_;
-};
+IOStatus S3StorageProvider::AbortMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id) {
+  Aws::S3::Model::AbortMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
 
-}  // namespace
+  auto outcome = s3client_->AbortMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  return IOStatus::OK();
+}
 
 IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
                                              const std::string& object_path,
                                              const std::string& destination,
                                              uint64_t* remote_size) {
+  if (!CloudRequestHedger::ShouldRun(download_latency_.get(),
+                                     0 /* timeout */)) {
+    auto start = SystemClock::Default()->NowMicros();
+    auto st =
+        DownloadObject(bucket_name, object_path, destination, remote_size);
+    if (st.ok() && download_latency_) {
+      download_latency_->Record(SystemClock::Default()->NowMicros() - start);
+    }
+    return st;
+  }
+
+  // Each attempt downloads to a file of its own. The file of the one used
+  // is renamed to destination, the others are deleted.
+  auto sizes = std::make_shared<std::array<uint64_t, 2>>();
+  auto attempt_path = [destination](int i) {
+    return destination + ".hedge" + std::to_string(i);
+  };
+  auto attempt = [this, sizes, attempt_path, bucket_name,
+                  object_path](int i) {
+    return DownloadObject(bucket_name, object_path, attempt_path(i),
+                          &(*sizes)[i]);
+  };
+  auto discard = [base_fs = cfs_->GetBaseFileSystem(), attempt_path](int i) {
+    base_fs->DeleteFile(attempt_path(i), IOOptions(), nullptr /*dbg*/)
+        .PermitUncheckedError();
+  };
+  int winner = -1;
+  auto st = download_hedger_->Run(download_latency_, attempt, discard,
+                                  0 /* timeout */, &winner);
+  if (st.ok()) {
+    *remote_size = (*sizes)[winner];
+    st = cfs_->GetBaseFileSystem()->RenameFile(
+        attempt_path(winner), destination, IOOptions(), nullptr /*dbg*/);
+  } else if (winner >= 0) {
+    discard(winner);
+  }
+  return st;
+}
+
+IOStatus S3StorageProvider::DownloadObject(const std::string& bucket_name,
+                                           const std::string& object_path,
+                                           const std::string& destination,
+                                           uint64_t* remote_size) {
   if (s3client_->HasTransferManager()) {
     // AWS Transfer manager does not work if we provide our stream
     // implementation because of https://github.com/aws/aws-sdk-cpp/issues/1732.
@@ -946,11 +1768,18 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
     }
   } else {
     IOStatus fileCloseStatus;
+    // The CRC32C of the bytes received, valid unless written with FStream,
+    // and the one in the metadata of the object
+    const bool verify = cfs_->GetCloudFileSystemOptions().cloud_object_checksums;
+    uint32_t crc32c = 0;
+    bool crc32c_valid = false;
+    std::string expected_checksum;
     {
       // Close() will be called in the destructor of the object returned by
       // this factory. Adding an inner scope so that the destructor is called
       // before checking fileCloseStatus.
-      auto ioStreamFactory = [this, destination, &fileCloseStatus]() -> Aws::IOStream* {
+      auto ioStreamFactory = [this, destination, &fileCloseStatus, verify,
+                              &crc32c, &crc32c_valid]() -> Aws::IOStream* {
         FileOptions foptions;
         foptions.use_direct_writes =
             cfs_->GetCloudFileSystemOptions().use_direct_io_for_cloud_download;
@@ -959,16 +1788,19 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
                                   &file, foptions);
         if (!st.ok()) {
           // fallback to FStream
+          crc32c_valid = false;
           return Aws::New<Aws::FStream>(
               Aws::Utils::ARRAY_ALLOCATION_TAG, destination,
               std::ios_base::out | std::ios_base::trunc);
         }
+        crc32c_valid = verify;
         return Aws::New<IOStreamWithOwnedBuf<WritableFileStreamBuf>>(
             Aws::Utils::ARRAY_ALLOCATION_TAG,
             std::unique_ptr<WritableFileStreamBuf>(new WritableFileStreamBuf(
                 &fileCloseStatus,
                 std::unique_ptr<WritableFileWriter>(new WritableFileWriter(
-                        std::move(file), destination, foptions)))));
+                        std::move(file), destination, foptions)),
+                verify ? &crc32c : nullptr)));
       };
 
       Aws::S3::Model::GetObjectRequest request;
@@ -979,6 +1811,12 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
       auto outcome = s3client_->GetCloudObject(request);
       if (outcome.IsSuccess()) {
         *remote_size = outcome.GetResult().GetContentLength();
+        const auto& metadata = outcome.GetResult().GetMetadata();
+        auto it = metadata.find(
+            ToAwsString(CloudStorageProviderImpl::kChecksumMetadataKey()));
+        if (it != metadata.end()) {
+          expected_checksum.assign(it->second.c_str(), it->second.size());
+        }
       } else {
         const auto& error = outcome.GetError();
         std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
@@ -1003,18 +1841,33 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
           object_path.c_str(), errmsg.c_str());
       return IOStatus::IOError(std::move(errmsg));
     }
+    if (crc32c_valid) {
+      auto st = VerifyChecksum(object_path, expected_checksum, crc32c);
+      if (!st.ok()) {
+        Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+            "[s3] GetObject %s/%s %s", bucket_name.c_str(),
+            object_path.c_str(), st.ToString().c_str());
+        return st;
+      }
+    }
   }
   return IOStatus::OK();
 }
 
-IOStatus S3StorageProvider::DoPutCloudObject(const std::string& local_file,
-                                             const std::string& bucket_name,
-                                             const std::string& object_path,
-                                             uint64_t file_size) {
-  if (s3client_->HasTransferManager()) {
-    auto handle = s3client_->UploadFile(ToAwsString(bucket_name),
-                                        ToAwsString(object_path),
-                                        ToAwsString(local_file), file_size);
+IOStatus S3StorageProvider::DoPutCloudObject(
+    const std::string& local_file, const std::string& bucket_name,
+    const std::string& object_path, uint64_t file_size,
+    const std::unordered_map<std::string, std::string>& metadata,
+    const std::string& storage_class) {
+  Aws::Map<Aws::String, Aws::String> aws_metadata;
+  for (const auto& m : metadata) {
+    aws_metadata[ToAwsString(m.first)] = ToAwsString(m.second);
+  }
+  // The transfer manager uploads in the default storage class
+  if (s3client_->HasTransferManager() && storage_class.empty()) {
+    auto handle = s3client_->UploadFile(
+        ToAwsString(bucket_name), ToAwsString(object_path),
+        ToAwsString(local_file), file_size, aws_metadata);
     if (handle->GetStatus() != Aws::Transfer::TransferStatus::COMPLETED) {
       auto error = handle->GetLastError();
       std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
@@ -1032,6 +1885,14 @@ IOStatus S3StorageProvider::DoPutCloudObject(const std::string& local_file,
     putRequest.SetBucket(ToAwsString(bucket_name));
     putRequest.SetKey(ToAwsString(object_path));
     putRequest.SetBody(inputData);
+    if (!aws_metadata.empty()) {
+      putRequest.SetMetadata(aws_metadata);
+    }
+    if (!storage_class.empty()) {
+      putRequest.SetStorageClass(
+          Aws::S3::Model::StorageClassMapper::GetStorageClassForName(
+              ToAwsString(storage_class)));
+    }
     SetEncryptionParameters(cfs_->GetCloudFileSystemOptions(), putRequest);
 
     auto outcome = s3client_->PutCloudObject(putRequest, file_size);
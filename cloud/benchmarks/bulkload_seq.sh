@@ -1,2 +0,0 @@
-echo "Load 500M keys of size 1 KB each sequentially into rocksdb-cloud....."
-local=1;mbf=4;scm=4;bpl=536870912;mcz=2;del=300000000;levels=5;ctrig=4; delay=8; stop=12; wbn=4; mbc=20; mb=67108864;wbs=134217728; sync=0; r=500000000; t=1; vs=800; bs=65536; cs=1048576; of=500000; si=1000000; ./db_bench --env_uri="s3://" --benchmarks=fillseq --disable_seek_compaction=1 --mmap_read=0 --statistics=1 --histogram=1 --num=$r --threads=$t --value_size=$vs --block_size=$bs --cache_size=$cs --bloom_bits=10 --cache_numshardbits=4 --open_files=$of --verify_checksum=1 --db=/tmp/rocksdb_cloud --sync=$sync --disable_wal=1 --compression_type=zlib --stats_interval=$si --compression_ratio=0.5 --write_buffer_size=$wbs --target_file_size_base=$mb --max_write_buffer_number=$wbn --max_background_compactions=$mbc --level0_file_num_compaction_trigger=$ctrig --level0_slowdown_writes_trigger=$delay --level0_stop_writes_trigger=$stop --num_levels=$levels --delete_obsolete_files_period_micros=$del --min_level_to_compress=$mcz --stats_per_interval=1 --max_bytes_for_level_base=$bpl --use_existing_db=0 --keep_local_sst_files=$local --max_background_flushes=$mbf --subcompactions=$scm
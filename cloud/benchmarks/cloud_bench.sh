@@ -0,0 +1,92 @@
+#!/usr/bin/env bash
+# Benchmarks the cloud code paths of db_bench for a range of DB sizes:
+# load, open, clone (cold start), checkpoint, cold and warm point reads with
+# keep_local_sst_files=false, and the purger. Optionally the write
+# throughput with the WAL in Kinesis or Kafka, and the bulk load of 500M keys
+# that bulkload_seq.sh used to run.
+#
+# By default the objects are stored by the "local" storage provider under
+# $ROOT/store with simulated S3 latencies, so the suite needs no AWS account
+# and runs reproducibly in CI. Set PROVIDER to benchmark another store.
+#
+# Every benchmark run appends a line of JSON to $RESULTS, with the number of
+# keys of the DB as "num".
+#
+# Environment:
+#   DB_BENCH        db_bench binary (./db_bench)
+#   ROOT            working directory, emptied first (/tmp/rocksdb_cloud_bench)
+#   RESULTS         JSON results file ($ROOT/results.json)
+#   SIZES           numbers of keys of the DBs ("100000 1000000")
+#   VALUE_SIZE      size of the values (800)
+#   READS           number of point reads per read benchmark (10000)
+#   PROVIDER        storage provider
+#                   ({id=local;root=$ROOT/store;request_latency_micros=20000;
+#                     latency_jitter_micros=10000;tail_latency_probability=0.01;
+#                     tail_latency_micros=200000;
+#                     bandwidth_bytes_per_sec=100000000;seed=1})
+#   LOG_CONTROLLER  "kinesis" or "kafka" to also benchmark writes with the WAL
+#                   in the cloud log
+#   BULKLOAD        1 to also bulk load 500M keys of 1 KB sequentially
+
+set -e
+
+DB_BENCH=${DB_BENCH:-./db_bench}
+ROOT=${ROOT:-/tmp/rocksdb_cloud_bench}
+RESULTS=${RESULTS:-$ROOT/results.json}
+SIZES=${SIZES:-"100000 1000000"}
+VALUE_SIZE=${VALUE_SIZE:-800}
+READS=${READS:-10000}
+PROVIDER=${PROVIDER:-"{id=local;root=$ROOT/store;request_latency_micros=20000;latency_jitter_micros=10000;tail_latency_probability=0.01;tail_latency_micros=200000;bandwidth_bytes_per_sec=100000000;seed=1}"}
+
+rm -rf "$ROOT"
+mkdir -p "$ROOT/store"
+
+# run <num> <cloud options> <db_bench arguments...>
+run() {
+  local num=$1
+  local cloud=$2
+  shift 2
+  local out=$ROOT/run.json
+  rm -f "$out"
+  "$DB_BENCH" \
+    --fs_uri="id=cloud;provider=$PROVIDER;create_bucket_if_missing=true;src={bucket=bench;object=db$num};dest={bucket=bench;object=db$num};$cloud" \
+    --db="$ROOT/db$num" --num="$num" --value_size="$VALUE_SIZE" \
+    --histogram=1 --statistics=1 --json_results_file="$out" "$@"
+  if [ -f "$out" ]; then
+    sed "s/^{/{\"num\": $num, /" "$out" >> "$RESULTS"
+  fi
+}
+
+for num in $SIZES; do
+  echo "Benchmarking a DB of $num keys....."
+  run "$num" "keep_local_sst_files=true" --benchmarks=fillrandom \
+    --use_existing_db=0
+  run "$num" "keep_local_sst_files=true" --use_existing_db=1 \
+    --benchmarks=cloudopen,cloudclone,cloudcheckpoint,cloudpurge
+  run "$num" "keep_local_sst_files=false" --use_existing_db=1 \
+    --reads="$READS" --benchmarks=readrandomcold,readrandom
+
+  if [ -n "$LOG_CONTROLLER" ]; then
+    run "$num" "controller={id=$LOG_CONTROLLER};keep_local_log_files=false" \
+      --use_existing_db=1 --disable_wal=0 --benchmarks=overwrite
+  fi
+done
+
+if [ "$BULKLOAD" = "1" ]; then
+  echo "Load 500M keys of size 1 KB each sequentially into rocksdb-cloud....."
+  run 500000000 "keep_local_sst_files=true" --benchmarks=fillseq \
+    --disable_seek_compaction=1 --mmap_read=0 --threads=1 --value_size=800 \
+    --block_size=65536 --cache_size=1048576 --bloom_bits=10 \
+    --cache_numshardbits=4 --open_files=500000 --verify_checksum=1 --sync=0 \
+    --disable_wal=1 --compression_type=zlib --stats_interval=1000000 \
+    --compression_ratio=0.5 --write_buffer_size=134217728 \
+    --target_file_size_base=67108864 --max_write_buffer_number=4 \
+    --max_background_compactions=20 --level0_file_num_compaction_trigger=4 \
+    --level0_slowdown_writes_trigger=8 --level0_stop_writes_trigger=12 \
+    --num_levels=5 --delete_obsolete_files_period_micros=300000000 \
+    --min_level_to_compress=2 --stats_per_interval=1 \
+    --max_bytes_for_level_base=536870912 --use_existing_db=0 \
+    --max_background_flushes=4 --subcompactions=4
+fi
+
+echo "Results in $RESULTS"
@@ -0,0 +1,243 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_block_cache_warmer.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "cache/cache_entry_roles.h"
+#include "cache/cache_key.h"
+#include "cloud/filename.h"
+#include "db/db_impl/db_impl.h"
+#include "db/dbformat.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/table.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_based_table_reader.h"
+#include "table/block_based/block_cache.h"
+#include "util/cast_util.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const uint32_t kHotBlockKeysFormatVersion = 1;
+
+// Column family id and user key of each hot block
+using HotBlockKeys = std::vector<std::pair<uint32_t, std::string>>;
+
+Status DecodeHotBlockKeys(Slice src, HotBlockKeys* keys) {
+  uint32_t version = 0;
+  if (!GetVarint32(&src, &version) || version != kHotBlockKeysFormatVersion) {
+    return Status::Corruption("Unknown hot block keys format");
+  }
+  while (!src.empty()) {
+    uint32_t cf_id = 0;
+    Slice key;
+    if (!GetVarint32(&src, &cf_id) || !GetLengthPrefixedSlice(&src, &key)) {
+      return Status::Corruption("Bad hot block keys");
+    }
+    keys->emplace_back(cf_id, key.ToString());
+  }
+  return Status::OK();
+}
+}  // namespace
+
+CloudBlockCacheWarmer::CloudBlockCacheWarmer(
+    DB* db, CloudFileSystem* cfs, const std::string& local_dbname,
+    const std::vector<uint32_t>& cf_ids)
+    : db_(db), cfs_(cfs), local_dbname_(local_dbname) {
+  auto* db_impl = static_cast_with_check<DBImpl>(db_->GetRootDB());
+  for (auto cf_id : cf_ids) {
+    auto handle = db_impl->GetColumnFamilyHandleUnlocked(cf_id);
+    if (handle) {
+      handles_.push_back(std::move(handle));
+    }
+  }
+}
+
+CloudBlockCacheWarmer::~CloudBlockCacheWarmer() {
+  stop_ = true;
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+}
+
+std::string CloudBlockCacheWarmer::LocalFile(const char* suffix) const {
+  return local_dbname_ + "/" + kHotBlockKeysFile + suffix;
+}
+
+Status CloudBlockCacheWarmer::CollectHotBlockKeys(std::string* encoded) {
+  // The column family of the blocks of each table, by the common prefix of
+  // their cache keys
+  std::unordered_map<std::string, uint32_t> cf_by_prefix;
+  std::unordered_set<Cache*> caches;
+  for (const auto& handle : handles_) {
+    TablePropertiesCollection props;
+    auto s = db_->GetPropertiesOfAllTables(handle.get(), &props);
+    if (!s.ok()) {
+      return s;
+    }
+    for (const auto& prop : props) {
+      OffsetableCacheKey base;
+      // Only stable keys can be told apart from the blocks of other DBs
+      bool is_stable = false;
+      BlockBasedTable::SetupBaseCacheKey(prop.second.get(),
+                                         /*cur_db_session_id*/ "",
+                                         /*cur_file_num*/ 0, &base,
+                                         &is_stable);
+      if (is_stable) {
+        cf_by_prefix[base.CommonPrefixSlice().ToString()] = handle->GetID();
+      }
+    }
+    auto cf_options = db_->GetOptions(handle.get());
+    auto* table_options =
+        cf_options.table_factory->GetOptions<BlockBasedTableOptions>();
+    if (table_options != nullptr && table_options->block_cache) {
+      caches.insert(table_options->block_cache.get());
+    }
+  }
+
+  std::unordered_set<std::string> seen;
+  encoded->clear();
+  PutVarint32(encoded, kHotBlockKeysFormatVersion);
+  for (auto* cache : caches) {
+    cache->ApplyToAllEntries(
+        [&](const Slice& key, Cache::ObjectPtr value, size_t /*charge*/,
+            const Cache::CacheItemHelper* helper) {
+          if (value == nullptr || helper == nullptr ||
+              helper->role != CacheEntryRole::kDataBlock ||
+              key.size() < OffsetableCacheKey::kCommonPrefixSize) {
+            return;
+          }
+          auto it = cf_by_prefix.find(
+              Slice(key.data(), OffsetableCacheKey::kCommonPrefixSize)
+                  .ToString());
+          if (it == cf_by_prefix.end()) {
+            return;
+          }
+          auto* block = static_cast<Block_kData*>(value);
+          std::unique_ptr<DataBlockIter> iter(block->NewDataIterator(
+              BytewiseComparator(), kDisableGlobalSequenceNumber));
+          iter->SeekToFirst();
+          if (!iter->Valid()) {
+            iter->status().PermitUncheckedError();
+            return;
+          }
+          std::string entry;
+          PutVarint32(&entry, it->second);
+          PutLengthPrefixedSlice(&entry, ExtractUserKey(iter->key()));
+          if (seen.insert(entry).second) {
+            encoded->append(entry);
+          }
+        },
+        {});
+  }
+  return Status::OK();
+}
+
+Status CloudBlockCacheWarmer::SaveHotBlockKeys() {
+  std::string encoded;
+  auto s = CollectHotBlockKeys(&encoded);
+  const auto& local_fs = cfs_->GetBaseFileSystem();
+  const auto local_file = LocalFile(".save");
+  if (s.ok()) {
+    s = WriteStringToFile(local_fs.get(), encoded, local_file);
+  }
+  if (s.ok()) {
+    s = cfs_->GetStorageProvider()->PutCloudObject(
+        local_file, cfs_->GetDestBucketName(),
+        cfs_->GetDestObjectPath() + pathsep + kHotBlockKeysFile);
+  }
+  local_fs->DeleteFile(local_file, IOOptions(), nullptr /*dbg*/)
+      .PermitUncheckedError();
+  Log(s.ok() ? InfoLogLevel::DEBUG_LEVEL : InfoLogLevel::WARN_LEVEL,
+      cfs_->GetLogger(), "[block_cache_warmer] Saved %" ROCKSDB_PRIszt
+      " bytes of hot block keys: %s",
+      encoded.size(), s.ToString().c_str());
+  return s;
+}
+
+Status CloudBlockCacheWarmer::LoadHotBlockKeys(std::string* encoded) {
+  const auto& local_fs = cfs_->GetBaseFileSystem();
+  const auto local_file = LocalFile(".load");
+  Status s = cfs_->GetStorageProvider()->GetCloudObject(
+      cfs_->GetSrcBucketName(),
+      cfs_->GetSrcObjectPath() + pathsep + kHotBlockKeysFile, local_file);
+  if (s.ok()) {
+    s = ReadFileToString(local_fs.get(), local_file, encoded);
+  }
+  local_fs->DeleteFile(local_file, IOOptions(), nullptr /*dbg*/)
+      .PermitUncheckedError();
+  return s;
+}
+
+Status CloudBlockCacheWarmer::WarmUp(int threads) {
+  std::string encoded;
+  HotBlockKeys keys;
+  auto s = LoadHotBlockKeys(&encoded);
+  if (s.ok()) {
+    s = DecodeHotBlockKeys(encoded, &keys);
+  }
+  if (!s.ok()) {
+    Log(s.IsNotFound() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::WARN_LEVEL,
+        cfs_->GetLogger(),
+        "[block_cache_warmer] Unable to load hot block keys: %s",
+        s.ToString().c_str());
+    return s;
+  }
+  std::unordered_map<uint32_t, ColumnFamilyHandle*> handles;
+  for (const auto& handle : handles_) {
+    handles[handle->GetID()] = handle.get();
+  }
+
+  // Point lookups read the index, filter and data blocks a read of the key
+  // goes through
+  std::atomic<size_t> next_key(0);
+  std::atomic<size_t> num_read(0);
+  auto warm_up = [&]() {
+    ReadOptions read_options;
+    PinnableSlice value;
+    while (!stop_) {
+      auto idx = next_key.fetch_add(1);
+      if (idx >= keys.size()) {
+        break;
+      }
+      auto it = handles.find(keys[idx].first);
+      if (it == handles.end()) {
+        // Dropped column family
+        continue;
+      }
+      value.Reset();
+      db_->Get(read_options, it->second, keys[idx].second, &value)
+          .PermitUncheckedError();
+      num_read++;
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++) {
+    workers.emplace_back(warm_up);
+  }
+  warm_up();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+      "[block_cache_warmer] Read %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+      " hot block keys%s",
+      num_read.load(), keys.size(), stop_ ? ", stopped" : "");
+  return Status::OK();
+}
+
+void CloudBlockCacheWarmer::StartWarmUp(int threads) {
+  assert(!warmup_thread_.joinable());
+  warmup_thread_ = std::thread([this, threads]() {
+    WarmUp(threads).PermitUncheckedError();
+  });
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,59 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class CloudFileSystem;
+class Logger;
+
+// Carries the content of the block cache of a DBCloud over to another
+// instance of the DB, possibly on another host. The hot block keys, the
+// first key of each data block in the block cache, are saved to the
+// HOTBLOCKKEYS object of the dest bucket. Reading those keys back in another
+// instance loads the same blocks into its block cache. See
+// CloudFileSystemOptions::hot_block_keys_interval_secs.
+//
+// Thread safe.
+class CloudBlockCacheWarmer {
+ public:
+  // The column families of db with ids cf_ids are saved and warmed up
+  CloudBlockCacheWarmer(DB* db, CloudFileSystem* cfs,
+                        const std::string& local_dbname,
+                        const std::vector<uint32_t>& cf_ids);
+  // Stops the warm-up
+  ~CloudBlockCacheWarmer();
+
+  // Saves the hot block keys to the dest bucket
+  Status SaveHotBlockKeys();
+
+  // Reads the hot block keys saved in the src bucket with threads threads.
+  // Returns NotFound if none were saved.
+  Status WarmUp(int threads);
+
+  // Runs WarmUp in the background
+  void StartWarmUp(int threads);
+
+ private:
+  Status CollectHotBlockKeys(std::string* encoded);
+  Status LoadHotBlockKeys(std::string* encoded);
+  // Local path of the keys while they are transferred
+  std::string LocalFile(const char* suffix) const;
+
+  DB* const db_;
+  CloudFileSystem* const cfs_;
+  const std::string local_dbname_;
+  std::vector<std::unique_ptr<ColumnFamilyHandle>> handles_;
+  std::atomic<bool> stop_{false};
+  std::thread warmup_thread_;
+};
+
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,233 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "rocksdb/cloud/cloud_compaction_service.h"
+
+#include "cloud/filename.h"
+#include "db/compaction/compaction_job.h"
+#include "file/file_util.h"
+#include "file/filename.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/db.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// What CloudCompactionService sends to the workers
+struct CloudCompactionJob {
+  std::string job_id;
+  // Local directory of the DB
+  std::string db_name;
+  // Dest bucket of the DB
+  std::string bucket_prefix;
+  std::string bucket;
+  std::string object_path;
+  std::string region;
+  std::string compaction_service_input;
+  // See CompactionServiceJobInfo
+  uint64_t first_reserved_file_number = 0;
+  uint64_t num_reserved_file_numbers = 0;
+
+  void EncodeTo(std::string* dst) const {
+    PutLengthPrefixedSlice(dst, job_id);
+    PutLengthPrefixedSlice(dst, db_name);
+    PutLengthPrefixedSlice(dst, bucket_prefix);
+    PutLengthPrefixedSlice(dst, bucket);
+    PutLengthPrefixedSlice(dst, object_path);
+    PutLengthPrefixedSlice(dst, region);
+    PutLengthPrefixedSlice(dst, compaction_service_input);
+    PutVarint64(dst, first_reserved_file_number);
+    PutVarint64(dst, num_reserved_file_numbers);
+  }
+
+  Status DecodeFrom(Slice src) {
+    Slice fields[7];
+    for (auto& field : fields) {
+      if (!GetLengthPrefixedSlice(&src, &field)) {
+        return Status::Corruption("Bad cloud compaction job");
+      }
+    }
+    if (!GetVarint64(&src, &first_reserved_file_number) ||
+        !GetVarint64(&src, &num_reserved_file_numbers)) {
+      return Status::Corruption("Bad cloud compaction job");
+    }
+    job_id = fields[0].ToString();
+    db_name = fields[1].ToString();
+    bucket_prefix = fields[2].ToString();
+    bucket = fields[3].ToString();
+    object_path = fields[4].ToString();
+    region = fields[5].ToString();
+    compaction_service_input = fields[6].ToString();
+    return Status::OK();
+  }
+};
+}  // namespace
+
+CloudCompactionService::CloudCompactionService(
+    BucketOptions dest_bucket, Dispatcher dispatcher,
+    uint64_t num_reserved_file_numbers)
+    : dest_bucket_(std::move(dest_bucket)),
+      dispatcher_(std::move(dispatcher)),
+      num_reserved_file_numbers_(num_reserved_file_numbers) {}
+
+CompactionServiceScheduleResponse CloudCompactionService::Schedule(
+    const CompactionServiceJobInfo& info,
+    const std::string& compaction_service_input) {
+  if (!dest_bucket_.IsValid()) {
+    return CompactionServiceScheduleResponse(
+        CompactionServiceJobStatus::kUseLocal);
+  }
+  CloudCompactionJob job;
+  // The job id is also a directory name in the bucket
+  job.job_id = info.db_session_id + "-" + std::to_string(info.job_id);
+  job.db_name = info.db_name;
+  job.bucket_prefix = dest_bucket_.GetBucketPrefix();
+  job.bucket = dest_bucket_.GetBucketName(false);
+  job.object_path = dest_bucket_.GetObjectPath();
+  job.region = dest_bucket_.GetRegion();
+  job.compaction_service_input = compaction_service_input;
+  job.first_reserved_file_number = info.first_reserved_file_number;
+  job.num_reserved_file_numbers = info.num_reserved_file_numbers;
+  std::string encoded;
+  job.EncodeTo(&encoded);
+  std::lock_guard<std::mutex> lk(mutex_);
+  jobs_[job.job_id] = std::move(encoded);
+  return CompactionServiceScheduleResponse(
+      job.job_id, CompactionServiceJobStatus::kSuccess);
+}
+
+CompactionServiceJobStatus CloudCompactionService::Wait(
+    const std::string& scheduled_job_id, std::string* result) {
+  std::string job;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = jobs_.find(scheduled_job_id);
+    if (it == jobs_.end()) {
+      return CompactionServiceJobStatus::kFailure;
+    }
+    job = std::move(it->second);
+    jobs_.erase(it);
+  }
+  return dispatcher_(job, result);
+}
+
+Status CloudCompactionWorker::Run(const CloudCompactionWorkerOptions& options,
+                                  const std::string& encoded_job,
+                                  std::string* result) {
+  CloudCompactionJob job;
+  auto s = job.DecodeFrom(encoded_job);
+  if (!s.ok()) {
+    return s;
+  }
+
+  ConfigOptions config_options;
+  config_options.env = Env::Default();
+  std::unique_ptr<CloudFileSystem> cloud_fs;
+  s = CloudFileSystemEnv::CreateFromString(config_options,
+                                           options.cloud_fs_config, &cloud_fs);
+  if (!s.ok()) {
+    return s;
+  }
+  if (cloud_fs->HasDestBucket()) {
+    return Status::InvalidArgument(
+        "A compaction worker can't have a dest bucket");
+  }
+  // The worker reads the DB where the DB writes it
+  auto& src_bucket =
+      cloud_fs->GetOptions<CloudFileSystemOptions>()->src_bucket;
+  src_bucket.SetBucketPrefix(job.bucket_prefix);
+  src_bucket.SetBucketName(job.bucket);
+  src_bucket.SetObjectPath(job.object_path);
+  src_bucket.SetRegion(job.region);
+  auto* cfs = dynamic_cast<CloudFileSystemImpl*>(cloud_fs.get());
+  assert(cfs);
+  auto provider = cfs->GetStorageProvider();
+  std::shared_ptr<FileSystem> fs(cloud_fs.release());
+  auto env = CloudFileSystemEnv::NewCompositeEnv(Env::Default(), fs);
+
+  const auto job_dir = options.local_dir + "/" + job.job_id;
+  const auto dbname = job_dir + "/db";
+  const auto output_dir = job_dir + "/output";
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  s = local_fs->CreateDirIfMissing(options.local_dir, IOOptions(), nullptr);
+  if (s.ok()) {
+    s = local_fs->CreateDirIfMissing(job_dir, IOOptions(), nullptr);
+  }
+  if (s.ok()) {
+    s = local_fs->CreateDirIfMissing(dbname, IOOptions(), nullptr);
+  }
+  // Fetch the MANIFEST, as a follower does
+  if (s.ok()) {
+    DBOptions db_options;
+    db_options.env = env.get();
+    s = cfs->SanitizeLocalDirectory(db_options, dbname, false /* read_only */);
+  }
+  if (s.ok()) {
+    s = cfs->LoadCloudManifest(dbname, false /* read_only */);
+  }
+  if (s.ok()) {
+    s = cfs->RefreshFollowerManifest(dbname);
+  }
+
+  std::string output;
+  if (s.ok()) {
+    auto override_options = options.override_options;
+    override_options.env = env.get();
+    s = DB::OpenAndCompact(options.open_and_compact_options, dbname,
+                           output_dir, job.compaction_service_input, &output,
+                           override_options);
+  }
+
+  // Put the output files where the DB installs them from
+  CompactionServiceResult compaction_result;
+  if (s.ok()) {
+    s = CompactionServiceResult::Read(output, &compaction_result);
+  }
+  if (s.ok()) {
+    // In place of the DB's files of the reserved numbers, named with the
+    // epoch of the DB's CLOUDMANIFEST, if they all fit
+    auto& output_files = compaction_result.output_files;
+    const bool in_place = !output_files.empty() &&
+                          output_files.size() <= job.num_reserved_file_numbers;
+    const auto output_path =
+        in_place ? job.db_name
+                 : RemoteCompactionOutputDir(job.db_name, job.job_id);
+    for (size_t i = 0; i < output_files.size(); i++) {
+      auto& file = output_files[i];
+      auto local_file = cfs->RemapFilename(output_dir + "/" + file.file_name);
+      std::string object_name;
+      if (in_place) {
+        file.file_name =
+            MakeTableFileName(job.first_reserved_file_number + i);
+        object_name = cfs->ObjectName(cfs->RemapFilename(file.file_name));
+      } else {
+        object_name =
+            RemoteCompactionOutputPath(output_path + "/" + file.file_name);
+      }
+      s = provider->PutCloudObject(local_file, cfs->GetSrcBucketName(),
+                                   job.object_path + "/" + object_name);
+      if (!s.ok()) {
+        break;
+      }
+    }
+    compaction_result.output_path = output_path;
+  }
+  if (s.ok()) {
+    s = compaction_result.Write(result);
+  } else if (!output.empty()) {
+    *result = std::move(output);
+  }
+  compaction_result.status.PermitUncheckedError();
+
+  // Let the file system go before its directory
+  env.reset();
+  fs.reset();
+  DestroyDir(Env::Default(), job_dir).PermitUncheckedError();
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
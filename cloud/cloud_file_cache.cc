@@ -0,0 +1,344 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+//
+#ifndef ROCKSDB_LITE
+#include "rocksdb/cloud/cloud_file_cache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const std::string kExtentSuffix = ".cache";
+const std::string kTmpSuffix = ".tmp";
+
+// Every extent is stored in its own file named <object hash>-<extent>.cache.
+// File format:
+//   object key (length prefixed slice)
+//   extent data
+//   masked crc32c of the extent data (fixed32)
+// The object key is stored so that hash collisions are detected on lookup.
+class CloudFileCacheImpl : public CloudFileCache {
+ public:
+  explicit CloudFileCacheImpl(const CloudFileCacheOptions& options)
+      : options_(options) {
+    if (!options_.fs) {
+      options_.fs = FileSystem::Default();
+    }
+  }
+
+  const char* Name() const override { return "CloudFileCache"; }
+
+  // Creates the cache directory and re-indexes extents from a previous run.
+  IOStatus Open();
+
+  IOStatus Lookup(const std::string& object_key, uint64_t extent,
+                  std::string* data) override;
+  IOStatus Insert(const std::string& object_key, uint64_t extent,
+                  const Slice& data) override;
+  void Erase(const std::string& object_key) override;
+
+  uint64_t GetExtentSize() const override { return options_.extent_size; }
+  uint64_t GetCapacity() const override { return options_.capacity; }
+  uint64_t GetUsage() const override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return usage_;
+  }
+
+ private:
+  struct Entry {
+    uint64_t object_hash;
+    uint64_t extent;
+    uint64_t charge;
+    std::list<std::string>::iterator lru_pos;
+  };
+
+  static uint64_t ObjectHash(const std::string& object_key) {
+    return GetSliceHash64(object_key);
+  }
+  static std::string ExtentId(uint64_t object_hash, uint64_t extent) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%016" PRIx64 "-%" PRIu64, object_hash, extent);
+    return buf;
+  }
+  static bool ParseExtentId(const std::string& id, uint64_t* object_hash,
+                            uint64_t* extent);
+  std::string ExtentPath(const std::string& id) const {
+    return options_.cache_dir + "/" + id + kExtentSuffix;
+  }
+
+  // REQUIRES: mutex_ held
+  void AddEntryLocked(const std::string& id, uint64_t object_hash,
+                      uint64_t extent, uint64_t charge,
+                      std::vector<std::string>* to_delete);
+  // REQUIRES: mutex_ held
+  void RemoveEntryLocked(const std::string& id,
+                         std::vector<std::string>* to_delete);
+  void DeleteFiles(const std::vector<std::string>& ids);
+
+  CloudFileCacheOptions options_;
+
+  mutable std::mutex mutex_;
+  uint64_t usage_{0};
+  // Most recently used extent is at the front
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> entries_;
+  // object hash -> cached extent numbers of that object
+  std::unordered_map<uint64_t, std::set<uint64_t>> objects_;
+};
+
+bool CloudFileCacheImpl::ParseExtentId(const std::string& id,
+                                       uint64_t* object_hash,
+                                       uint64_t* extent) {
+  auto dash = id.find('-');
+  if (dash != 16 || id.size() == dash + 1) {
+    return false;
+  }
+  char* end = nullptr;
+  *object_hash = std::strtoull(id.substr(0, dash).c_str(), &end, 16);
+  if (end == nullptr || *end != '\0') {
+    return false;
+  }
+  auto extent_str = id.substr(dash + 1);
+  *extent = std::strtoull(extent_str.c_str(), &end, 10);
+  return end != nullptr && *end == '\0';
+}
+
+IOStatus CloudFileCacheImpl::Open() {
+  if (options_.cache_dir.empty()) {
+    return IOStatus::InvalidArgument("CloudFileCache requires cache_dir");
+  }
+  if (options_.extent_size == 0) {
+    return IOStatus::InvalidArgument("CloudFileCache extent_size must be > 0");
+  }
+  const IOOptions io_opts;
+  auto st = options_.fs->CreateDirIfMissing(options_.cache_dir, io_opts,
+                                            nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::vector<std::string> children;
+  st = options_.fs->GetChildren(options_.cache_dir, io_opts, &children,
+                                nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+
+  // Re-index the extents of a previous run, oldest first so that the LRU
+  // order roughly survives the restart.
+  std::vector<std::pair<uint64_t, std::string>> found;
+  for (const auto& child : children) {
+    auto path = options_.cache_dir + "/" + child;
+    if (EndsWith(child, kTmpSuffix)) {
+      // Partially written extent
+      options_.fs->DeleteFile(path, io_opts, nullptr /*dbg*/);
+      continue;
+    }
+    if (!EndsWith(child, kExtentSuffix)) {
+      continue;
+    }
+    uint64_t mtime = 0;
+    if (!options_.fs->GetFileModificationTime(path, io_opts, &mtime,
+                                              nullptr /*dbg*/)
+             .ok()) {
+      continue;
+    }
+    found.emplace_back(mtime,
+                       child.substr(0, child.size() - kExtentSuffix.size()));
+  }
+  std::sort(found.begin(), found.end());
+
+  std::vector<std::string> to_delete;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& f : found) {
+      uint64_t object_hash = 0, extent = 0, size = 0;
+      if (!ParseExtentId(f.second, &object_hash, &extent) ||
+          !options_.fs
+               ->GetFileSize(ExtentPath(f.second), io_opts, &size,
+                             nullptr /*dbg*/)
+               .ok()) {
+        to_delete.push_back(f.second);
+        continue;
+      }
+      AddEntryLocked(f.second, object_hash, extent, size, &to_delete);
+    }
+  }
+  DeleteFiles(to_delete);
+  Log(InfoLogLevel::INFO_LEVEL, options_.info_log,
+      "[CloudFileCache] Opened %s with %" ROCKSDB_PRIszt
+      " extents, usage %" PRIu64 " capacity %" PRIu64,
+      options_.cache_dir.c_str(), entries_.size(), GetUsage(),
+      options_.capacity);
+  return IOStatus::OK();
+}
+
+void CloudFileCacheImpl::AddEntryLocked(const std::string& id,
+                                        uint64_t object_hash, uint64_t extent,
+                                        uint64_t charge,
+                                        std::vector<std::string>* to_delete) {
+  if (entries_.find(id) != entries_.end()) {
+    RemoveEntryLocked(id, nullptr);
+  }
+  lru_.push_front(id);
+  entries_[id] = Entry{object_hash, extent, charge, lru_.begin()};
+  objects_[object_hash].insert(extent);
+  usage_ += charge;
+  while (usage_ > options_.capacity && !lru_.empty()) {
+    auto victim = lru_.back();
+    RemoveEntryLocked(victim, to_delete);
+  }
+}
+
+void CloudFileCacheImpl::RemoveEntryLocked(
+    const std::string& id, std::vector<std::string>* to_delete) {
+  auto it = entries_.find(id);
+  if (it == entries_.end()) {
+    return;
+  }
+  auto& entry = it->second;
+  usage_ -= entry.charge;
+  lru_.erase(entry.lru_pos);
+  auto obj = objects_.find(entry.object_hash);
+  if (obj != objects_.end()) {
+    obj->second.erase(entry.extent);
+    if (obj->second.empty()) {
+      objects_.erase(obj);
+    }
+  }
+  entries_.erase(it);
+  if (to_delete != nullptr) {
+    to_delete->push_back(id);
+  }
+}
+
+void CloudFileCacheImpl::DeleteFiles(const std::vector<std::string>& ids) {
+  for (const auto& id : ids) {
+    options_.fs->DeleteFile(ExtentPath(id), IOOptions(), nullptr /*dbg*/);
+  }
+}
+
+IOStatus CloudFileCacheImpl::Lookup(const std::string& object_key,
+                                    uint64_t extent, std::string* data) {
+  auto id = ExtentId(ObjectHash(object_key), extent);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+      return IOStatus::NotFound();
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  }
+
+  // The extent might get evicted while we read it. Any failure below is
+  // reported as a miss.
+  std::string contents;
+  auto st = ReadFileToString(options_.fs.get(), ExtentPath(id), &contents);
+  Slice input(contents);
+  Slice stored_key;
+  bool valid = st.ok() && GetLengthPrefixedSlice(&input, &stored_key) &&
+               stored_key == object_key && input.size() >= sizeof(uint32_t);
+  if (valid) {
+    size_t data_size = input.size() - sizeof(uint32_t);
+    uint32_t expected = crc32c::Unmask(DecodeFixed32(input.data() + data_size));
+    valid = crc32c::Value(input.data(), data_size) == expected;
+    if (valid) {
+      data->assign(input.data(), data_size);
+      return IOStatus::OK();
+    }
+  }
+  if (st.ok()) {
+    Log(InfoLogLevel::WARN_LEVEL, options_.info_log,
+        "[CloudFileCache] Dropping invalid extent %s", id.c_str());
+    std::vector<std::string> to_delete;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      RemoveEntryLocked(id, &to_delete);
+    }
+    DeleteFiles(to_delete);
+  }
+  return IOStatus::NotFound();
+}
+
+IOStatus CloudFileCacheImpl::Insert(const std::string& object_key,
+                                    uint64_t extent, const Slice& data) {
+  if (data.size() > options_.capacity) {
+    return IOStatus::OK();
+  }
+  auto object_hash = ObjectHash(object_key);
+  auto id = ExtentId(object_hash, extent);
+  auto path = ExtentPath(id);
+  auto tmp_path = path + kTmpSuffix;
+
+  std::string contents;
+  contents.reserve(object_key.size() + data.size() + 2 * sizeof(uint32_t));
+  PutLengthPrefixedSlice(&contents, object_key);
+  contents.append(data.data(), data.size());
+  PutFixed32(&contents, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+
+  const IOOptions io_opts;
+  auto st = WriteStringToFile(options_.fs.get(), contents, tmp_path,
+                              false /* should_sync */);
+  if (st.ok()) {
+    st = options_.fs->RenameFile(tmp_path, path, io_opts, nullptr /*dbg*/);
+  }
+  if (!st.ok()) {
+    options_.fs->DeleteFile(tmp_path, io_opts, nullptr /*dbg*/);
+    Log(InfoLogLevel::WARN_LEVEL, options_.info_log,
+        "[CloudFileCache] Failed to insert extent %s: %s", id.c_str(),
+        st.ToString().c_str());
+    return st;
+  }
+
+  std::vector<std::string> to_delete;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    AddEntryLocked(id, object_hash, extent, contents.size(), &to_delete);
+  }
+  DeleteFiles(to_delete);
+  return IOStatus::OK();
+}
+
+void CloudFileCacheImpl::Erase(const std::string& object_key) {
+  auto object_hash = ObjectHash(object_key);
+  std::vector<std::string> to_delete;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto obj = objects_.find(object_hash);
+    if (obj == objects_.end()) {
+      return;
+    }
+    auto extents = obj->second;
+    for (auto extent : extents) {
+      RemoveEntryLocked(ExtentId(object_hash, extent), &to_delete);
+    }
+  }
+  DeleteFiles(to_delete);
+}
+}  // namespace
+
+Status NewCloudFileCache(const CloudFileCacheOptions& options,
+                         std::shared_ptr<CloudFileCache>* cache) {
+  auto impl = std::make_shared<CloudFileCacheImpl>(options);
+  auto st = impl->Open();
+  if (st.ok()) {
+    *cache = std::move(impl);
+  }
+  return st;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,123 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "rocksdb/cloud/cloud_file_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "file/file_util.h"
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudFileCacheTest : public testing::Test {
+ public:
+  CloudFileCacheTest() {
+    options_.cache_dir = test::PerThreadDBPath("cloud_file_cache_test");
+    options_.extent_size = 16;
+    options_.capacity = 1024;
+    DestroyDir(Env::Default(), options_.cache_dir).PermitUncheckedError();
+  }
+  ~CloudFileCacheTest() {
+    cache_.reset();
+    DestroyDir(Env::Default(), options_.cache_dir).PermitUncheckedError();
+  }
+
+  void Open() { ASSERT_OK(NewCloudFileCache(options_, &cache_)); }
+
+  bool Cached(const std::string& key, uint64_t extent) {
+    std::string data;
+    return cache_->Lookup(key, extent, &data).ok();
+  }
+
+  CloudFileCacheOptions options_;
+  std::shared_ptr<CloudFileCache> cache_;
+};
+
+TEST_F(CloudFileCacheTest, InsertLookup) {
+  Open();
+  std::string data;
+  ASSERT_TRUE(cache_->Lookup("bucket/a.sst", 0, &data).IsNotFound());
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 0, "0123456789abcdef"));
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 1, "tail"));
+  ASSERT_OK(cache_->Lookup("bucket/a.sst", 0, &data));
+  ASSERT_EQ(data, "0123456789abcdef");
+  ASSERT_OK(cache_->Lookup("bucket/a.sst", 1, &data));
+  ASSERT_EQ(data, "tail");
+  ASSERT_TRUE(cache_->Lookup("bucket/b.sst", 0, &data).IsNotFound());
+  ASSERT_GT(cache_->GetUsage(), 0);
+}
+
+TEST_F(CloudFileCacheTest, Eviction) {
+  options_.capacity = 200;
+  Open();
+  const std::string value(40, 'x');
+  for (uint64_t i = 0; i < 10; i++) {
+    ASSERT_OK(cache_->Insert("bucket/a.sst", i, value));
+    // keep extent 0 hot
+    ASSERT_TRUE(Cached("bucket/a.sst", 0));
+  }
+  ASSERT_LE(cache_->GetUsage(), options_.capacity);
+  ASSERT_TRUE(Cached("bucket/a.sst", 0));
+  ASSERT_TRUE(Cached("bucket/a.sst", 9));
+  ASSERT_FALSE(Cached("bucket/a.sst", 1));
+}
+
+TEST_F(CloudFileCacheTest, Erase) {
+  Open();
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 0, "a0"));
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 3, "a3"));
+  ASSERT_OK(cache_->Insert("bucket/b.sst", 0, "b0"));
+  cache_->Erase("bucket/a.sst");
+  ASSERT_FALSE(Cached("bucket/a.sst", 0));
+  ASSERT_FALSE(Cached("bucket/a.sst", 3));
+  ASSERT_TRUE(Cached("bucket/b.sst", 0));
+}
+
+TEST_F(CloudFileCacheTest, Reopen) {
+  Open();
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 2, "persisted"));
+  auto usage = cache_->GetUsage();
+  cache_.reset();
+
+  Open();
+  ASSERT_EQ(cache_->GetUsage(), usage);
+  std::string data;
+  ASSERT_OK(cache_->Lookup("bucket/a.sst", 2, &data));
+  ASSERT_EQ(data, "persisted");
+}
+
+TEST_F(CloudFileCacheTest, CorruptExtent) {
+  Open();
+  ASSERT_OK(cache_->Insert("bucket/a.sst", 0, "0123456789"));
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(options_.cache_dir, &children));
+  for (const auto& child : children) {
+    if (child != "." && child != "..") {
+      ASSERT_OK(WriteStringToFile(Env::Default(), "garbage",
+                                  options_.cache_dir + "/" + child));
+    }
+  }
+  ASSERT_FALSE(Cached("bucket/a.sst", 0));
+  ASSERT_EQ(cache_->GetUsage(), 0);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudFileCacheTest is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
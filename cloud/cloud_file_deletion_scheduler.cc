@@ -27,7 +27,10 @@ void CloudFileDeletionScheduler::UnscheduleFileDeletion(const std::string& filen
   std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
   auto itr = files_to_delete_.find(filename);
   if (itr != files_to_delete_.end()) {
-    scheduler_->CancelJob(itr->second);
+    // A batch skips the files that are no longer scheduled
+    if (!itr->second.batch) {
+      scheduler_->CancelJob(itr->second.job_handle);
+    }
     files_to_delete_.erase(itr);
   }
 }
@@ -57,13 +60,68 @@ rocksdb::IOStatus CloudFileDeletionScheduler::ScheduleFileDeletion(
       return IOStatus::OK();
     }
 
-    auto handle = scheduler_->ScheduleJob(file_deletion_delay_,
-                                          std::move(doDeleteFile), nullptr);
-    files_to_delete_.emplace(fname, std::move(handle));
+    ScheduledDeletion deletion;
+    deletion.job_handle = scheduler_->ScheduleJob(
+        file_deletion_delay_, std::move(doDeleteFile), nullptr);
+    files_to_delete_.emplace(fname, std::move(deletion));
+  }
+  return IOStatus::OK();
+}
+
+rocksdb::IOStatus CloudFileDeletionScheduler::ScheduleBatchedFileDeletion(
+    const std::string& fname, const std::string& object_path,
+    BatchFileDeletionRunnable runnable) {
+  std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
+  if (files_to_delete_.find(fname) != files_to_delete_.end()) {
+    // already in the queue
+    return IOStatus::OK();
   }
+  auto now = std::chrono::steady_clock::now();
+  if (!open_batch_ || now > open_batch_->open_until ||
+      open_batch_->files.size() >= kMaxBatchSize) {
+    open_batch_ = std::make_shared<FileDeletionBatch>();
+    open_batch_->open_until = now + kBatchWindow;
+    open_batch_->runnable = std::move(runnable);
+    // Late enough for the last deletion that can join
+    auto doDeleteBatch = [wp = weak_from_this(), batch = open_batch_](void*) {
+      auto sp = wp.lock();
+      if (sp) {
+        sp->DoDeleteBatch(batch);
+      }
+    };
+    scheduler_->ScheduleJob(file_deletion_delay_ + kBatchWindow,
+                            std::move(doDeleteBatch), nullptr);
+  }
+  open_batch_->files.emplace_back(fname, object_path);
+  ScheduledDeletion deletion;
+  deletion.batch = open_batch_;
+  files_to_delete_.emplace(fname, std::move(deletion));
   return IOStatus::OK();
 }
 
+void CloudFileDeletionScheduler::DoDeleteBatch(
+    const std::shared_ptr<FileDeletionBatch>& batch) {
+  std::vector<std::string> object_paths;
+  {
+    std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
+    if (open_batch_ == batch) {
+      open_batch_.reset();
+    }
+    for (auto& [fname, object_path] : batch->files) {
+      auto itr = files_to_delete_.find(fname);
+      // Unscheduled, possibly scheduled again in a later batch
+      if (itr == files_to_delete_.end() || itr->second.batch != batch) {
+        continue;
+      }
+      files_to_delete_.erase(itr);
+      object_paths.push_back(std::move(object_path));
+    }
+  }
+  if (!object_paths.empty()) {
+    batch->runnable(object_paths);
+  }
+}
+
 void CloudFileDeletionScheduler::DoDeleteFile(const std::string& fname,
                                               FileDeletionRunnable runnable) {
   {
@@ -0,0 +1,220 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_file_hydrator.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Reads from the cloud until the local copy is downloaded, then from the
+// local copy
+class HydratingRandomAccessFile : public FSRandomAccessFile {
+ public:
+  HydratingRandomAccessFile(
+      const std::string& local_path, const FileOptions& file_opts,
+      std::unique_ptr<FSRandomAccessFile> cloud_file,
+      std::shared_ptr<CloudFileHydrator::FileState> state,
+      const std::shared_ptr<FileSystem>& base_fs)
+      : local_path_(local_path),
+        file_opts_(file_opts),
+        cloud_file_(std::move(cloud_file)),
+        state_(std::move(state)),
+        base_fs_(base_fs) {
+    // The reader was handed out as a cloud file, keep its buffer
+    // requirements
+    file_opts_.use_direct_reads = false;
+  }
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
+                Slice* result, char* scratch,
+                IODebugContext* dbg) const override {
+    return Current()->Read(offset, n, options, result, scratch, dbg);
+  }
+
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override {
+    return Current()->MultiRead(reqs, num_reqs, options, dbg);
+  }
+
+  IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
+                    IODebugContext* dbg) override {
+    return Current()->Prefetch(offset, n, options, dbg);
+  }
+
+  size_t GetRequiredBufferAlignment() const override {
+    return cloud_file_->GetRequiredBufferAlignment();
+  }
+
+ private:
+  FSRandomAccessFile* Current() const {
+    if (switched_.load(std::memory_order_acquire)) {
+      return local_file_.get();
+    }
+    if (!state_->downloaded.load(std::memory_order_acquire) ||
+        local_missing_.load(std::memory_order_relaxed)) {
+      return cloud_file_.get();
+    }
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!switched_.load(std::memory_order_relaxed)) {
+      auto st = base_fs_->NewRandomAccessFile(local_path_, file_opts_,
+                                              &local_file_, nullptr /*dbg*/);
+      if (!st.ok()) {
+        // Keep reading from the cloud, e.g. the local copy was evicted
+        local_missing_.store(true, std::memory_order_relaxed);
+        return cloud_file_.get();
+      }
+      switched_.store(true, std::memory_order_release);
+    }
+    return local_file_.get();
+  }
+
+  const std::string local_path_;
+  FileOptions file_opts_;
+  std::unique_ptr<FSRandomAccessFile> cloud_file_;
+  std::shared_ptr<CloudFileHydrator::FileState> state_;
+  std::shared_ptr<FileSystem> base_fs_;
+
+  mutable std::mutex mutex_;
+  // Set once, before switched_
+  mutable std::unique_ptr<FSRandomAccessFile> local_file_;
+  mutable std::atomic<bool> switched_{false};
+  mutable std::atomic<bool> local_missing_{false};
+};
+}  // namespace
+
+CloudFileHydrator::CloudFileHydrator(std::shared_ptr<ThreadPool> executor,
+                                     DownloadFunc download,
+                                     const std::shared_ptr<FileSystem>& base_fs,
+                                     Logger* info_log)
+    : num_threads_(std::max(executor->GetBackgroundThreads(), 1)),
+      download_(std::move(download)),
+      base_fs_(base_fs),
+      info_log_(info_log),
+      executor_(std::move(executor)) {}
+
+CloudFileHydrator::~CloudFileHydrator() {
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    shutdown_ = true;
+    cv_.wait(lk, [this] { return active_workers_ == 0; });
+  }
+  executor_->WaitForJobsAndJoinAllThreads();
+}
+
+void CloudFileHydrator::Hydrate(const std::vector<std::string>& local_paths) {
+  int new_workers = 0;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& path : local_paths) {
+      if (pending_.emplace(path, std::make_shared<FileState>()).second) {
+        queue_.push_back(path);
+      }
+    }
+    new_workers = static_cast<int>(std::min<size_t>(
+        num_threads_ - active_workers_, queue_.size()));
+    active_workers_ += new_workers;
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[CloudFileHydrator] Queued %" ROCKSDB_PRIszt " files for download",
+      local_paths.size());
+  for (int i = 0; i < new_workers; i++) {
+    executor_->SubmitJob([this]() { RunWorker(); });
+  }
+}
+
+void CloudFileHydrator::RunWorker() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (!shutdown_ && !queue_.empty()) {
+    auto path = std::move(queue_.front());
+    queue_.pop_front();
+    auto state = pending_[path];
+    if (state->cancelled) {
+      pending_.erase(path);
+      continue;
+    }
+    lk.unlock();
+    auto st = download_(path);
+    lk.lock();
+    if (state->cancelled) {
+      // The file was deleted while it downloaded
+      base_fs_->DeleteFile(path, IOOptions(), nullptr /*dbg*/)
+          .PermitUncheckedError();
+    } else if (st.ok()) {
+      state->downloaded.store(true, std::memory_order_release);
+    } else {
+      // Readers stay on the cloud, new ones download the file themselves
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[CloudFileHydrator] Failed to download %s: %s", path.c_str(),
+          st.ToString().c_str());
+    }
+    pending_.erase(path);
+    if (pending_.empty()) {
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
+          "[CloudFileHydrator] All queued files downloaded");
+    }
+    cv_.notify_all();
+  }
+  if (shutdown_) {
+    for (const auto& path : queue_) {
+      pending_.erase(path);
+    }
+    queue_.clear();
+  }
+  active_workers_--;
+  cv_.notify_all();
+}
+
+bool CloudFileHydrator::IsPending(const std::string& local_path) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = pending_.find(local_path);
+  return it != pending_.end() && !it->second->cancelled;
+}
+
+std::unique_ptr<FSRandomAccessFile> CloudFileHydrator::NewHydratingFile(
+    const std::string& local_path, const FileOptions& file_opts,
+    std::unique_ptr<FSRandomAccessFile> cloud_file) {
+  std::shared_ptr<FileState> state;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = pending_.find(local_path);
+    if (it != pending_.end()) {
+      state = it->second;
+    }
+  }
+  if (!state) {
+    // Downloaded since the caller checked, read it locally right away
+    state = std::make_shared<FileState>();
+    state->downloaded = true;
+  }
+  return std::make_unique<HydratingRandomAccessFile>(
+      local_path, file_opts, std::move(cloud_file), std::move(state),
+      base_fs_);
+}
+
+void CloudFileHydrator::Cancel(const std::string& local_path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = pending_.find(local_path);
+  if (it != pending_.end()) {
+    it->second->cancelled = true;
+  }
+}
+
+void CloudFileHydrator::WaitForAll() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  cv_.wait(lk, [this] { return pending_.empty() && active_workers_ == 0; });
+}
+
+size_t CloudFileHydrator::NumPending() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return pending_.size();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,87 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class Logger;
+class ThreadPool;
+
+// Downloads SST files into the local directory in the background, so that a
+// DB can serve reads before all of its files are local. A reader opened on
+// a file that is still queued reads from the cloud, and switches to the
+// local copy once it is downloaded (see NewHydratingFile).
+//
+// Thread safe.
+class CloudFileHydrator {
+ public:
+  // Downloads the cloud object of a local path to that path, atomically
+  using DownloadFunc = std::function<IOStatus(const std::string& local_path)>;
+
+  // The downloads run on executor, as many at once as its background threads
+  CloudFileHydrator(std::shared_ptr<ThreadPool> executor,
+                    DownloadFunc download,
+                    const std::shared_ptr<FileSystem>& base_fs,
+                    Logger* info_log);
+  // Drops the queued files and waits for the downloads in flight
+  ~CloudFileHydrator();
+
+  // Queues local_paths for download. They are downloaded in order.
+  void Hydrate(const std::vector<std::string>& local_paths);
+
+  // Returns true if local_path is queued or being downloaded
+  bool IsPending(const std::string& local_path) const;
+
+  // Wraps cloud_file, a reader of the cloud object of local_path, so that it
+  // reads the local copy once local_path is downloaded.
+  std::unique_ptr<FSRandomAccessFile> NewHydratingFile(
+      const std::string& local_path, const FileOptions& file_opts,
+      std::unique_ptr<FSRandomAccessFile> cloud_file);
+
+  // local_path is being deleted: don't download it, and remove the copy a
+  // download in flight leaves behind.
+  void Cancel(const std::string& local_path);
+
+  // Waits until nothing is queued or being downloaded
+  void WaitForAll();
+
+  size_t NumPending() const;
+
+  // Shared with the hydrating readers of a file
+  struct FileState {
+    std::atomic<bool> downloaded{false};
+    // under mutex_
+    bool cancelled = false;
+  };
+
+ private:
+  void RunWorker();
+
+  const int num_threads_;
+  DownloadFunc download_;
+  std::shared_ptr<FileSystem> base_fs_;
+  Logger* info_log_;
+  std::shared_ptr<ThreadPool> executor_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::string> queue_;
+  // Files queued or being downloaded
+  std::unordered_map<std::string, std::shared_ptr<FileState>> pending_;
+  int active_workers_ = 0;
+  bool shutdown_ = false;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_file_hydrator.h"
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "cloud/cloud_transfer_executor.h"
+#include "file/file_util.h"
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/threadpool.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Every byte reads 'c'
+class CloudFile : public FSRandomAccessFile {
+ public:
+  IOStatus Read(uint64_t /*offset*/, size_t n, const IOOptions& /*options*/,
+                Slice* result, char* scratch,
+                IODebugContext* /*dbg*/) const override {
+    memset(scratch, 'c', n);
+    *result = Slice(scratch, n);
+    return IOStatus::OK();
+  }
+};
+}  // namespace
+
+class CloudFileHydratorTest : public testing::Test {
+ public:
+  CloudFileHydratorTest()
+      : fs_(FileSystem::Default()),
+        dir_(test::PerThreadDBPath("cloud_file_hydrator_test")) {
+    EXPECT_OK(fs_->CreateDirIfMissing(dir_, IOOptions(), nullptr));
+  }
+  ~CloudFileHydratorTest() override {
+    EXPECT_OK(DestroyDir(Env::Default(), dir_));
+  }
+
+  std::unique_ptr<CloudFileHydrator> NewHydrator(int num_threads) {
+    return std::make_unique<CloudFileHydrator>(
+        std::make_shared<CloudTransferExecutor>(num_threads,
+                                                std::vector<int>())
+            ->NewThreadPool(CloudTransferExecutor::kHydrate),
+        [this](const std::string& path) {
+          {
+            std::unique_lock<std::mutex> lk(mutex_);
+            cv_.wait(lk, [this] { return released_; });
+            downloads_++;
+          }
+          return WriteStringToFile(fs_.get(), std::string(16, 'l'), path);
+        },
+        fs_, nullptr);
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  static std::string ReadAll(FSRandomAccessFile* file) {
+    char scratch[16];
+    Slice result;
+    EXPECT_OK(file->Read(0, sizeof(scratch), IOOptions(), &result, scratch,
+                         nullptr));
+    return result.ToString();
+  }
+
+  std::shared_ptr<FileSystem> fs_;
+  std::string dir_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_ = false;
+  int downloads_ = 0;
+};
+
+TEST_F(CloudFileHydratorTest, SwitchToLocalCopy) {
+  auto hydrator = NewHydrator(2);
+  auto path = dir_ + "/000010.sst";
+  hydrator->Hydrate({path});
+  ASSERT_TRUE(hydrator->IsPending(path));
+
+  auto file = hydrator->NewHydratingFile(path, FileOptions(),
+                                         std::make_unique<CloudFile>());
+  ASSERT_EQ(ReadAll(file.get()), std::string(16, 'c'));
+
+  Release();
+  hydrator->WaitForAll();
+  ASSERT_FALSE(hydrator->IsPending(path));
+  ASSERT_EQ(ReadAll(file.get()), std::string(16, 'l'));
+  ASSERT_EQ(downloads_, 1);
+}
+
+TEST_F(CloudFileHydratorTest, Cancel) {
+  auto hydrator = NewHydrator(1);
+  auto first = dir_ + "/000010.sst";
+  auto second = dir_ + "/000011.sst";
+  hydrator->Hydrate({first, second});
+  // first is likely in flight and second is queued, both must go away
+  hydrator->Cancel(first);
+  hydrator->Cancel(second);
+  ASSERT_FALSE(hydrator->IsPending(first));
+  ASSERT_FALSE(hydrator->IsPending(second));
+
+  Release();
+  hydrator->WaitForAll();
+  ASSERT_EQ(hydrator->NumPending(), 0u);
+  ASSERT_LE(downloads_, 1);
+  ASSERT_TRUE(fs_->FileExists(first, IOOptions(), nullptr).IsNotFound());
+  ASSERT_TRUE(fs_->FileExists(second, IOOptions(), nullptr).IsNotFound());
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudFileHydratorTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
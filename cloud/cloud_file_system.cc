@@ -7,6 +7,8 @@
 #else
 #include <windows.h>
 #endif
+#include <algorithm>
+#include <cinttypes>
 #include <unordered_map>
 
 #include "cloud/aws/aws_file_system.h"
@@ -18,12 +20,16 @@
 #include "options/configurable_helper.h"
 #include "options/options_helper.h"
 #include "port/likely.h"
+#include "rocksdb/cloud/cloud_file_cache.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
+#include "rocksdb/cloud/cloud_log_tailer.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/env_encryption.h"
 #include "rocksdb/options.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/options_type.h"
@@ -31,6 +37,30 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+bool CloudFileSystemOptions::KeepLocalSstFile(Temperature temperature) const {
+  return keep_local_sst_files &&
+         std::find(cloud_only_sst_temperatures.begin(),
+                   cloud_only_sst_temperatures.end(),
+                   temperature) == cloud_only_sst_temperatures.end();
+}
+
+std::string CloudFileSystemOptions::SstStorageClass(
+    Temperature temperature) const {
+  return std::find(cloud_only_sst_temperatures.begin(),
+                   cloud_only_sst_temperatures.end(),
+                   temperature) != cloud_only_sst_temperatures.end()
+             ? cloud_only_sst_storage_class
+             : std::string();
+}
+
+bool CloudFileSystemOptions::UseLowLatencyBucket(
+    Temperature temperature) const {
+  return !low_latency_bucket.empty() &&
+         std::find(low_latency_sst_temperatures.begin(),
+                   low_latency_sst_temperatures.end(),
+                   temperature) != low_latency_sst_temperatures.end();
+}
+
 void CloudFileSystemOptions::Dump(Logger* log) const {
   auto provider = storage_provider.get();
   auto controller = cloud_log_controller.get();
@@ -52,12 +82,27 @@ void CloudFileSystemOptions::Dump(Logger* log) const {
          (controller != nullptr) ? controller->Name() : "None");
   Header(log, "               COptions.keep_local_sst_files: %d",
          keep_local_sst_files);
+  std::string cloud_only_temperatures;
+  for (auto temperature : cloud_only_sst_temperatures) {
+    if (!cloud_only_temperatures.empty()) {
+      cloud_only_temperatures.append(",");
+    }
+    cloud_only_temperatures.append(temperature_to_string[temperature]);
+  }
+  Header(log, "        COptions.cloud_only_sst_temperatures: %s",
+         cloud_only_temperatures.c_str());
+  Header(log, "       COptions.cloud_only_sst_storage_class: %s",
+         cloud_only_sst_storage_class.c_str());
+  Header(log, "          COptions.local_sst_retention_bytes: %" PRIu64,
+         local_sst_retention_bytes);
   Header(log, "               COptions.keep_local_log_files: %d",
          keep_local_log_files);
   Header(log, "             COptions.server_side_encryption: %d",
          server_side_encryption);
   Header(log, "                  COptions.encryption_key_id: %s",
          encryption_key_id.c_str());
+  Header(log, "            COptions.cloud_encryption_cipher: %s",
+         cloud_encryption_cipher ? cloud_encryption_cipher->Name() : "none");
   Header(log, "           COptions.create_bucket_if_missing: %s",
          create_bucket_if_missing ? "true" : "false");
   Header(log, "                         COptions.run_purger: %s",
@@ -84,6 +129,129 @@ void CloudFileSystemOptions::Dump(Logger* log) const {
     Header(log, "          COptions.cloud_file_deletion_delay: %ld",
            cloud_file_deletion_delay->count());
   }
+  if (sst_file_cache) {
+    Header(log, "                      COptions.sst_file_cache: %s",
+           sst_file_cache->Name());
+    Header(log, "             COptions.sst_file_cache.capacity: %" PRIu64,
+           sst_file_cache->GetCapacity());
+  }
+  Header(log, "                  COptions.async_read_threads: %d",
+         async_read_threads);
+  Header(log, "                COptions.cloud_readahead_size: %" PRIu64,
+         cloud_readahead_size);
+  Header(log, "             COptions.cloud_readahead_streams: %d",
+         cloud_readahead_streams);
+  Header(log, "                  COptions.sst_open_tail_size: %" PRIu64,
+         sst_open_tail_size);
+  Header(log, "         COptions.cloud_read_hedge_percentile: %f",
+         cloud_read_hedge_percentile);
+  Header(log, "   COptions.cloud_read_hedge_min_delay_micros: %" PRIu64,
+         cloud_read_hedge_min_delay_micros);
+  Header(log, "              COptions.cloud_download_streams: %d",
+         cloud_download_streams);
+  Header(log, "              COptions.cloud_object_checksums: %d",
+         cloud_object_checksums);
+  Header(log, "                  COptions.s3_max_connections: %d",
+         s3_max_connections);
+  Header(log, "       COptions.s3_tcp_keep_alive_interval_ms: %" PRIu64,
+         s3_tcp_keep_alive_interval_ms);
+  Header(log, "                     COptions.share_s3_client: %d",
+         share_s3_client);
+  Header(log, "              COptions.s3_adaptive_throttling: %d",
+         s3_adaptive_throttling);
+  Header(log, "          COptions.multipart_upload_part_size: %" PRIu64,
+         multipart_upload_part_size);
+  Header(log, "                      COptions.upload_threads: %d",
+         upload_threads);
+  Header(log, "                    COptions.async_sst_upload: %d",
+         async_sst_upload);
+  Header(log, "             COptions.max_pending_sst_uploads: %d",
+         max_pending_sst_uploads);
+  Header(log, "                  COptions.sst_pack_threshold: %" PRIu64,
+         sst_pack_threshold);
+  Header(log, "                COptions.sst_pack_target_size: %" PRIu64,
+         sst_pack_target_size);
+  Header(log, "                COptions.cloud_log_batch_size: %" PRIu64,
+         cloud_log_batch_size);
+  Header(log, "        COptions.cloud_log_batch_delay_micros: %" PRIu64,
+         cloud_log_batch_delay_micros);
+  Header(log, "             COptions.cloud_log_apply_threads: %d",
+         cloud_log_apply_threads);
+  Header(log, "            COptions.cloud_log_max_open_files: %d",
+         cloud_log_max_open_files);
+  Header(log, "        COptions.cloud_log_preallocation_size: %" PRIu64,
+         cloud_log_preallocation_size);
+  Header(log, "             COptions.cloud_log_stream_shards: %d",
+         cloud_log_stream_shards);
+  Header(log, "             COptions.cloud_log_consumer_name: %s",
+         cloud_log_consumer_name.c_str());
+  if (cloud_log_tailer) {
+    Header(log, "                    COptions.cloud_log_tailer: %s",
+           cloud_log_tailer->Name());
+    Header(log, "        COptions.cloud_log_tailer.num_threads: %d",
+           cloud_log_tailer->GetNumThreads());
+  }
+  Header(log, "                COptions.sst_download_threads: %d",
+         sst_download_threads);
+  Header(log, "               COptions.hydrate_in_background: %d",
+         hydrate_in_background);
+  Header(log, "                    COptions.transfer_threads: %d",
+         transfer_threads);
+  Header(log, "            COptions.max_checkpoint_transfers: %d",
+         max_checkpoint_transfers);
+  Header(log, "                      COptions.purger_threads: %d",
+         purger_threads);
+  Header(log, "     COptions.cloud_metadata_cache_ttl_micros: %" PRIu64,
+         cloud_metadata_cache_ttl_micros);
+  Header(log, "       COptions.cloud_metadata_cache_capacity: %" ROCKSDB_PRIszt,
+         cloud_metadata_cache_capacity);
+  Header(log, "           COptions.getchildren_from_manifest: %d",
+         getchildren_from_manifest);
+  Header(log, "         COptions.prune_cloud_manifest_epochs: %d",
+         prune_cloud_manifest_epochs);
+  Header(log, "       COptions.cloud_manifest_format_version: %d",
+         cloud_manifest_format_version);
+  Header(log, "     COptions.manifest_upload_interval_millis: %" PRIu64,
+         manifest_upload_interval_millis);
+  Header(log, "        COptions.hot_block_keys_interval_secs: %" PRIu64,
+         hot_block_keys_interval_secs);
+  Header(log, "          COptions.block_cache_warmup_threads: %d",
+         block_cache_warmup_threads);
+  Header(log, "    COptions.block_cache_warmup_in_background: %d",
+         block_cache_warmup_in_background);
+  Header(log, "                 COptions.scrub_interval_secs: %" PRIu64,
+         scrub_interval_secs);
+  Header(log, "                 COptions.scrub_bytes_per_sec: %" PRIu64,
+         scrub_bytes_per_sec);
+  Header(log, "              COptions.table_prefetch_threads: %d",
+         table_prefetch_threads);
+  Header(log, "            COptions.table_prefetch_max_bytes: %" PRIu64,
+         table_prefetch_max_bytes);
+  Header(log, "                    COptions.cloud_blob_files: %d",
+         cloud_blob_files);
+  Header(log, "             COptions.shard_data_object_names: %d",
+         shard_data_object_names);
+  std::string low_latency_temperatures;
+  for (auto temperature : low_latency_sst_temperatures) {
+    if (!low_latency_temperatures.empty()) {
+      low_latency_temperatures.append(",");
+    }
+    low_latency_temperatures.append(temperature_to_string[temperature]);
+  }
+  Header(log, "                  COptions.low_latency_bucket: %s",
+         low_latency_bucket.c_str());
+  Header(log, "        COptions.low_latency_sst_temperatures: %s",
+         low_latency_temperatures.c_str());
+  Header(log, "            COptions.list_objects_parallelism: %d",
+         list_objects_parallelism);
+  Header(log, "                COptions.copy_on_write_clones: %d",
+         copy_on_write_clones);
+  Header(log, "                  COptions.request_trace_file: %s",
+         request_trace_file.c_str());
+  if (transfer_rate_limiter) {
+    Header(log, "               COptions.transfer_rate_limiter: %" PRId64,
+           transfer_rate_limiter->GetBytesPerSecond());
+  }
 }
 
 bool CloudFileSystemOptions::GetNameFromEnvironment(const char* name,
@@ -305,6 +473,17 @@ const std::unordered_map<std::string, OptionTypeInfo>
         {"keep_local_sst_files",
          {offset_of(&CloudFileSystemOptions::keep_local_sst_files),
           OptionType::kBoolean}},
+        {"cloud_only_sst_temperatures",
+         OptionTypeInfo::Vector<Temperature>(
+             offset_of(&CloudFileSystemOptions::cloud_only_sst_temperatures),
+             OptionVerificationType::kNormal, OptionTypeFlags::kNone,
+             {0, OptionType::kTemperature})},
+        {"cloud_only_sst_storage_class",
+         {offset_of(&CloudFileSystemOptions::cloud_only_sst_storage_class),
+          OptionType::kString}},
+        {"local_sst_retention_bytes",
+         {offset_of(&CloudFileSystemOptions::local_sst_retention_bytes),
+          OptionType::kUInt64T}},
         {"keep_local_log_files",
          {offset_of(&CloudFileSystemOptions::keep_local_log_files),
           OptionType::kBoolean}},
@@ -333,6 +512,164 @@ const std::unordered_map<std::string, OptionTypeInfo>
         {"purger_periodicity_ms",
          {offset_of(&CloudFileSystemOptions::purger_periodicity_millis),
           OptionType::kUInt64T}},
+        {"async_read_threads",
+         {offset_of(&CloudFileSystemOptions::async_read_threads),
+          OptionType::kInt}},
+        {"cloud_readahead_size",
+         {offset_of(&CloudFileSystemOptions::cloud_readahead_size),
+          OptionType::kUInt64T}},
+        {"cloud_readahead_streams",
+         {offset_of(&CloudFileSystemOptions::cloud_readahead_streams),
+          OptionType::kInt}},
+        {"sst_open_tail_size",
+         {offset_of(&CloudFileSystemOptions::sst_open_tail_size),
+          OptionType::kUInt64T}},
+        {"cloud_read_hedge_percentile",
+         {offset_of(&CloudFileSystemOptions::cloud_read_hedge_percentile),
+          OptionType::kDouble}},
+        {"cloud_read_hedge_min_delay_micros",
+         {offset_of(
+              &CloudFileSystemOptions::cloud_read_hedge_min_delay_micros),
+          OptionType::kUInt64T}},
+        {"cloud_download_streams",
+         {offset_of(&CloudFileSystemOptions::cloud_download_streams),
+          OptionType::kInt}},
+        {"cloud_object_checksums",
+         {offset_of(&CloudFileSystemOptions::cloud_object_checksums),
+          OptionType::kBoolean}},
+        {"cloud_encryption_cipher",
+         OptionTypeInfo::AsCustomSharedPtr<BlockCipher>(
+             offset_of(&CloudFileSystemOptions::cloud_encryption_cipher),
+             OptionVerificationType::kByNameAllowNull,
+             OptionTypeFlags::kNone)},
+        {"s3_max_connections",
+         {offset_of(&CloudFileSystemOptions::s3_max_connections),
+          OptionType::kInt}},
+        {"s3_tcp_keep_alive_interval_ms",
+         {offset_of(&CloudFileSystemOptions::s3_tcp_keep_alive_interval_ms),
+          OptionType::kUInt64T}},
+        {"share_s3_client",
+         {offset_of(&CloudFileSystemOptions::share_s3_client),
+          OptionType::kBoolean}},
+        {"s3_adaptive_throttling",
+         {offset_of(&CloudFileSystemOptions::s3_adaptive_throttling),
+          OptionType::kBoolean}},
+        {"multipart_upload_part_size",
+         {offset_of(&CloudFileSystemOptions::multipart_upload_part_size),
+          OptionType::kUInt64T}},
+        {"upload_threads",
+         {offset_of(&CloudFileSystemOptions::upload_threads),
+          OptionType::kInt}},
+        {"async_sst_upload",
+         {offset_of(&CloudFileSystemOptions::async_sst_upload),
+          OptionType::kBoolean}},
+        {"max_pending_sst_uploads",
+         {offset_of(&CloudFileSystemOptions::max_pending_sst_uploads),
+          OptionType::kInt}},
+        {"sst_pack_threshold",
+         {offset_of(&CloudFileSystemOptions::sst_pack_threshold),
+          OptionType::kUInt64T}},
+        {"sst_pack_target_size",
+         {offset_of(&CloudFileSystemOptions::sst_pack_target_size),
+          OptionType::kUInt64T}},
+        {"cloud_log_batch_size",
+         {offset_of(&CloudFileSystemOptions::cloud_log_batch_size),
+          OptionType::kUInt64T}},
+        {"cloud_log_batch_delay_micros",
+         {offset_of(&CloudFileSystemOptions::cloud_log_batch_delay_micros),
+          OptionType::kUInt64T}},
+        {"cloud_log_apply_threads",
+         {offset_of(&CloudFileSystemOptions::cloud_log_apply_threads),
+          OptionType::kInt}},
+        {"cloud_log_max_open_files",
+         {offset_of(&CloudFileSystemOptions::cloud_log_max_open_files),
+          OptionType::kInt}},
+        {"cloud_log_preallocation_size",
+         {offset_of(&CloudFileSystemOptions::cloud_log_preallocation_size),
+          OptionType::kUInt64T}},
+        {"cloud_log_stream_shards",
+         {offset_of(&CloudFileSystemOptions::cloud_log_stream_shards),
+          OptionType::kInt}},
+        {"cloud_log_consumer_name",
+         {offset_of(&CloudFileSystemOptions::cloud_log_consumer_name),
+          OptionType::kString}},
+        {"sst_download_threads",
+         {offset_of(&CloudFileSystemOptions::sst_download_threads),
+          OptionType::kInt}},
+        {"hydrate_in_background",
+         {offset_of(&CloudFileSystemOptions::hydrate_in_background),
+          OptionType::kBoolean}},
+        {"transfer_threads",
+         {offset_of(&CloudFileSystemOptions::transfer_threads),
+          OptionType::kInt}},
+        {"max_checkpoint_transfers",
+         {offset_of(&CloudFileSystemOptions::max_checkpoint_transfers),
+          OptionType::kInt}},
+        {"purger_threads",
+         {offset_of(&CloudFileSystemOptions::purger_threads),
+          OptionType::kInt}},
+        {"cloud_metadata_cache_ttl_micros",
+         {offset_of(&CloudFileSystemOptions::cloud_metadata_cache_ttl_micros),
+          OptionType::kUInt64T}},
+        {"cloud_metadata_cache_capacity",
+         {offset_of(&CloudFileSystemOptions::cloud_metadata_cache_capacity),
+          OptionType::kSizeT}},
+        {"getchildren_from_manifest",
+         {offset_of(&CloudFileSystemOptions::getchildren_from_manifest),
+          OptionType::kBoolean}},
+        {"prune_cloud_manifest_epochs",
+         {offset_of(&CloudFileSystemOptions::prune_cloud_manifest_epochs),
+          OptionType::kBoolean}},
+        {"cloud_manifest_format_version",
+         {offset_of(&CloudFileSystemOptions::cloud_manifest_format_version),
+          OptionType::kInt}},
+        {"manifest_upload_interval_millis",
+         {offset_of(&CloudFileSystemOptions::manifest_upload_interval_millis),
+          OptionType::kUInt64T}},
+        {"hot_block_keys_interval_secs",
+         {offset_of(&CloudFileSystemOptions::hot_block_keys_interval_secs),
+          OptionType::kUInt64T}},
+        {"block_cache_warmup_threads",
+         {offset_of(&CloudFileSystemOptions::block_cache_warmup_threads),
+          OptionType::kInt}},
+        {"block_cache_warmup_in_background",
+         {offset_of(&CloudFileSystemOptions::block_cache_warmup_in_background),
+          OptionType::kBoolean}},
+        {"scrub_interval_secs",
+         {offset_of(&CloudFileSystemOptions::scrub_interval_secs),
+          OptionType::kUInt64T}},
+        {"scrub_bytes_per_sec",
+         {offset_of(&CloudFileSystemOptions::scrub_bytes_per_sec),
+          OptionType::kUInt64T}},
+        {"table_prefetch_threads",
+         {offset_of(&CloudFileSystemOptions::table_prefetch_threads),
+          OptionType::kInt}},
+        {"table_prefetch_max_bytes",
+         {offset_of(&CloudFileSystemOptions::table_prefetch_max_bytes),
+          OptionType::kUInt64T}},
+        {"cloud_blob_files",
+         {offset_of(&CloudFileSystemOptions::cloud_blob_files),
+          OptionType::kBoolean}},
+        {"shard_data_object_names",
+         {offset_of(&CloudFileSystemOptions::shard_data_object_names),
+          OptionType::kBoolean}},
+        {"low_latency_bucket",
+         {offset_of(&CloudFileSystemOptions::low_latency_bucket),
+          OptionType::kString}},
+        {"low_latency_sst_temperatures",
+         OptionTypeInfo::Vector<Temperature>(
+             offset_of(&CloudFileSystemOptions::low_latency_sst_temperatures),
+             OptionVerificationType::kNormal, OptionTypeFlags::kNone,
+             {0, OptionType::kTemperature})},
+        {"list_objects_parallelism",
+         {offset_of(&CloudFileSystemOptions::list_objects_parallelism),
+          OptionType::kInt}},
+        {"copy_on_write_clones",
+         {offset_of(&CloudFileSystemOptions::copy_on_write_clones),
+          OptionType::kBoolean}},
+        {"request_trace_file",
+         {offset_of(&CloudFileSystemOptions::request_trace_file),
+          OptionType::kString}},
 
         {"provider",
          {offset_of(&CloudFileSystemOptions::storage_provider),
@@ -426,6 +763,11 @@ Status CloudFileSystemOptions::Serialize(const ConfigOptions& config_options,
       reinterpret_cast<const char*>(this), value);
 }
 
+std::string CloudFileSystem::CloudObjectFilePath(
+    const std::string& bucket_name, const std::string& object_path) {
+  return MakeCloudObjectFilePath(bucket_name, object_path);
+}
+
 Status CloudFileSystemEnv::NewAwsFileSystem(
     const std::shared_ptr<FileSystem>& base_fs,
     const std::string& src_cloud_bucket, const std::string& src_cloud_object,
@@ -464,6 +806,18 @@ int DoRegisterCloudObjects(ObjectLibrary& library, const std::string& arg) {
 
   count += CloudFileSystemImpl::RegisterAwsObjects(library, arg);
 
+  library.AddFactory<CloudStorageProvider>(
+      CloudStorageProviderImpl::kLocal(),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<CloudStorageProvider>* guard,
+         std::string* /*errmsg*/) {
+        CloudStorageProviderImpl::CreateLocalProvider(LocalStorageOptions(),
+                                                      guard)
+            .PermitUncheckedError();
+        return guard->get();
+      });
+  count++;
+
   // Register the Cloud Log Controllers
 
   library.AddFactory<CloudLogController>(
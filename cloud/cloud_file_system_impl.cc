@@ -4,30 +4,56 @@
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 
 #include <cinttypes>
+#include <limits>
 
+#include "cloud/cloud_file_hydrator.h"
 #include "cloud/cloud_log_controller_impl.h"
 #include "cloud/cloud_manifest.h"
+#include "cloud/cloud_metadata_cache.h"
 #include "cloud/cloud_scheduler.h"
+#include "cloud/cloud_sst_file_manager.h"
+#include "cloud/cloud_sst_packer.h"
+#include "cloud/cloud_sst_retention.h"
+#include "cloud/cloud_transfer_executor.h"
+#include "cloud/cloud_upload_queue.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
 #include "file/file_util.h"
 #include "file/filename.h"
 #include "file/writable_file_writer.h"
 #include "port/port_posix.h"
+#include "rocksdb/cloud/cloud_file_cache.h"
 #include "rocksdb/cloud/cloud_file_deletion_scheduler.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/options_type.h"
 #include "test_util/sync_point.h"
 #include "util/xxhash.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+struct CloudFileSystemImpl::DeferredManifestUpload {
+  std::mutex mutex;
+  // Null once the file system is destroyed
+  CloudFileSystemImpl* cfs;
+  // The MANIFEST to upload, none if local_name is empty
+  std::string local_name;
+  std::string cloud_name;
+  std::chrono::steady_clock::time_point last_upload;
+  bool scheduled = false;
+  // Error of the last scheduled upload, returned by the next sync
+  IOStatus status;
+
+  explicit DeferredManifestUpload(CloudFileSystemImpl* _cfs) : cfs(_cfs) {}
+};
+
 CloudFileSystemImpl::CloudFileSystemImpl(
     const CloudFileSystemOptions& opts, const std::shared_ptr<FileSystem>& base,
     const std::shared_ptr<Logger>& logger)
@@ -41,9 +67,69 @@ CloudFileSystemImpl::CloudFileSystemImpl(
     cloud_file_deletion_scheduler_ = CloudFileDeletionScheduler::Create(
         CloudScheduler::Get(), *opts.cloud_file_deletion_delay);
   }
+  std::vector<int> max_running(CloudTransferExecutor::kNumTransferClasses);
+  max_running[CloudTransferExecutor::kUpload] = opts.upload_threads;
+  max_running[CloudTransferExecutor::kHydrate] = opts.sst_download_threads;
+  max_running[CloudTransferExecutor::kPrefetch] = opts.table_prefetch_threads;
+  max_running[CloudTransferExecutor::kCheckpoint] =
+      opts.max_checkpoint_transfers;
+  // Deletions are cheap, don't let them crowd out the transfers
+  max_running[CloudTransferExecutor::kDelete] = 1;
+  max_running[CloudTransferExecutor::kPurge] = opts.purger_threads;
+  transfer_executor_ = std::make_shared<CloudTransferExecutor>(
+      opts.transfer_threads, max_running);
+  if (opts.async_sst_upload) {
+    upload_queue_ = std::make_unique<CloudUploadQueue>(
+        transfer_executor_->NewThreadPool(CloudTransferExecutor::kUpload),
+        opts.max_pending_sst_uploads, info_log_.get());
+  }
+  if (opts.manifest_upload_interval_millis > 0) {
+    manifest_upload_ = std::make_shared<DeferredManifestUpload>(this);
+    manifest_upload_scheduler_ = CloudScheduler::Get();
+  }
+  if (opts.cloud_metadata_cache_ttl_micros > 0) {
+    metadata_cache_ = std::make_shared<CloudMetadataCache>(
+        SystemClock::Default(), opts.cloud_metadata_cache_ttl_micros,
+        opts.cloud_metadata_cache_capacity);
+  }
+  if (opts.local_sst_retention_bytes > 0) {
+    sst_retention_ =
+        std::make_unique<CloudSstRetention>(opts.local_sst_retention_bytes);
+    retention_hydrator_ = std::make_unique<CloudFileHydrator>(
+        transfer_executor_->NewThreadPool(CloudTransferExecutor::kHydrate),
+        [this](const std::string& local_path) {
+          auto st = GetCloudObject(local_path);
+          if (st.ok()) {
+            st = RetainLocalSstFile(local_path);
+          }
+          if (st.ok() && !retention_hydrator_->IsPending(local_path)) {
+            // Deleted while it downloaded, the hydrator removes the copy
+            sst_retention_->Erase(local_path);
+          }
+          return st;
+        },
+        base_fs_, info_log_.get());
+  }
+  if (opts.sst_pack_threshold > 0) {
+    sst_packer_ = std::make_unique<CloudSstPacker>();
+  }
 }
 
 CloudFileSystemImpl::~CloudFileSystemImpl() {
+  if (manifest_upload_) {
+    FlushManifestUpload().PermitUncheckedError();
+    std::lock_guard<std::mutex> lk(manifest_upload_->mutex);
+    manifest_upload_->cfs = nullptr;
+  }
+  if (sst_packer_) {
+    // The files of a MANIFEST that was not uploaded
+    WaitForPendingUploads().PermitUncheckedError();
+  }
+  // Drain the uploads and downloads while the storage provider is still
+  // around
+  upload_queue_.reset();
+  hydrator_.reset();
+  retention_hydrator_.reset();
   if (cloud_fs_options.cloud_log_controller) {
     cloud_fs_options.cloud_log_controller->StopTailingStream();
   }
@@ -52,56 +138,204 @@ CloudFileSystemImpl::~CloudFileSystemImpl() {
   cloud_fs_options.storage_provider.reset();
 }
 
-IOStatus CloudFileSystemImpl::ExistsCloudObject(const std::string& fname) {
+IOStatus CloudFileSystemImpl::StatCloudObject(
+    const std::string& bucket, const std::string& object_path,
+    CloudObjectInformation* info) {
+  // SST files are immutable, their metadata only changes when they are
+  // uploaded or deleted
+  bool cacheable = metadata_cache_ && IsSstFile(object_path);
+  CloudMetadataCache::ObjectInfo cached;
+  if (cacheable && metadata_cache_->Lookup(bucket, object_path, &cached)) {
+    if (!cached.exists) {
+      return IOStatus::NotFound(object_path);
+    }
+    info->size = cached.size;
+    info->modification_time = cached.modification_time;
+    return IOStatus::OK();
+  }
+  auto st =
+      GetStorageProvider()->GetCloudObjectMetadata(bucket, object_path, info);
+  if (cacheable && (st.ok() || st.IsNotFound())) {
+    cached.exists = st.ok();
+    cached.size = st.ok() ? info->size : 0;
+    cached.modification_time = st.ok() ? info->modification_time : 0;
+    metadata_cache_->Insert(bucket, object_path, cached);
+  }
+  return st;
+}
+
+std::vector<std::pair<std::string, std::string>>
+CloudFileSystemImpl::CloudObjectLocations(const std::string& fname,
+                                          Temperature temperature) {
+  std::vector<std::pair<std::string, std::string>> locations;
+  const auto& low_latency_bucket = cloud_fs_options.low_latency_bucket;
+  bool low_latency = !low_latency_bucket.empty() && IsCloudDataFile(fname);
+  bool low_latency_first =
+      low_latency && cloud_fs_options.UseLowLatencyBucket(temperature);
+  auto add_locations = [&](bool in_low_latency_bucket) {
+    if (HasDestBucket()) {
+      locations.emplace_back(
+          in_low_latency_bucket ? low_latency_bucket : GetDestBucketName(),
+          destname(fname));
+    }
+    if (HasSrcBucket() && !SrcMatchesDest() &&
+        !(in_low_latency_bucket && HasDestBucket() &&
+          srcname(fname) == destname(fname))) {
+      locations.emplace_back(
+          in_low_latency_bucket ? low_latency_bucket : GetSrcBucketName(),
+          srcname(fname));
+    }
+  };
+  if (low_latency_first) {
+    add_locations(true);
+  }
+  add_locations(false);
+  if (low_latency && !low_latency_first) {
+    add_locations(true);
+  }
+  if (!clone_ancestors_.empty() && IsCloudDataFile(fname)) {
+    for (const auto& ancestor : clone_ancestors_) {
+      locations.emplace_back(ancestor.first,
+                             ancestor.second + "/" + ObjectName(fname));
+    }
+  }
+  return locations;
+}
+
+IOStatus CloudFileSystemImpl::StatCloudObject(const std::string& fname,
+                                              CloudObjectInformation* info) {
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {
-    st = GetStorageProvider()->ExistsCloudObject(GetDestBucketName(),
-                                                 destname(fname));
+  for (const auto& location : CloudObjectLocations(fname)) {
+    st = StatCloudObject(location.first, location.second, info);
+    if (!st.IsNotFound()) {
+      break;
+    }
+  }
+  return st;
+}
+
+void CloudFileSystemImpl::InvalidateCloudObjectMetadata(
+    const std::string& bucket, const std::string& object_path) {
+  if (metadata_cache_) {
+    metadata_cache_->Invalidate(bucket, object_path);
   }
-  if (st.IsNotFound() && HasSrcBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->ExistsCloudObject(GetSrcBucketName(),
-                                                 srcname(fname));
+}
+
+IOStatus CloudFileSystemImpl::ExistsCloudObject(const std::string& fname) {
+  CloudPackedFile packed;
+  if (LookupPackedFile(fname, &packed)) {
+    return IOStatus::OK();
+  }
+  if (metadata_cache_) {
+    CloudObjectInformation info;
+    return StatCloudObject(fname, &info);
+  }
+  auto st = IOStatus::NotFound();
+  for (const auto& location : CloudObjectLocations(fname)) {
+    st = GetStorageProvider()->ExistsCloudObject(location.first,
+                                                 location.second);
+    if (!st.IsNotFound()) {
+      break;
+    }
   }
   return st;
 }
 
 IOStatus CloudFileSystemImpl::GetCloudObject(const std::string& fname) {
+  CloudPackedFile packed;
+  if (LookupPackedFile(fname, &packed)) {
+    return GetPackedFile(packed, fname);
+  }
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {
-    st = GetStorageProvider()->GetCloudObject(GetDestBucketName(),
-                                              destname(fname), fname);
+  for (const auto& location : CloudObjectLocations(fname)) {
+    st = GetStorageProvider()->GetCloudObject(location.first, location.second,
+                                              fname);
+    if (!st.IsNotFound()) {
+      break;
+    }
   }
-  if (st.IsNotFound() && HasSrcBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->GetCloudObject(GetSrcBucketName(),
-                                              srcname(fname), fname);
+  if (st.IsNotFound() && sst_packer_ && LoadSstPacks().ok() &&
+      LookupPackedFile(fname, &packed)) {
+    // Packed by another instance of the DB since the packs were indexed
+    st = GetPackedFile(packed, fname);
+  }
+  if (st.ok()) {
+    OnLocalSstCopyChanged(fname, true /* added */);
   }
   return st;
 }
 
 IOStatus CloudFileSystemImpl::GetCloudObjectSize(const std::string& fname,
                                                  uint64_t* remote_size) {
-  auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {
-    st = GetStorageProvider()->GetCloudObjectSize(GetDestBucketName(),
-                                                  destname(fname), remote_size);
+  CloudPackedFile packed;
+  if (LookupPackedFile(fname, &packed)) {
+    *remote_size = packed.size;
+    return IOStatus::OK();
   }
-  if (st.IsNotFound() && HasSrcBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->GetCloudObjectSize(GetSrcBucketName(),
-                                                  srcname(fname), remote_size);
+  if (metadata_cache_) {
+    CloudObjectInformation info;
+    auto st = StatCloudObject(fname, &info);
+    if (st.ok()) {
+      *remote_size = info.size;
+    }
+    return st;
+  }
+  auto st = IOStatus::NotFound();
+  for (const auto& location : CloudObjectLocations(fname)) {
+    st = GetStorageProvider()->GetCloudObjectSize(
+        location.first, location.second, remote_size);
+    if (!st.IsNotFound()) {
+      break;
+    }
   }
   return st;
 }
 
 IOStatus CloudFileSystemImpl::GetCloudObjectModificationTime(
     const std::string& fname, uint64_t* time) {
+  CloudPackedFile packed;
+  if (LookupPackedFile(fname, &packed)) {
+    return GetStorageProvider()->GetCloudObjectModificationTime(
+        packed.bucket, packed.pack_path, time);
+  }
+  if (metadata_cache_) {
+    CloudObjectInformation info;
+    auto st = StatCloudObject(fname, &info);
+    if (st.ok()) {
+      *time = info.modification_time;
+    }
+    return st;
+  }
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {
+  for (const auto& location : CloudObjectLocations(fname)) {
     st = GetStorageProvider()->GetCloudObjectModificationTime(
-        GetDestBucketName(), destname(fname), time);
+        location.first, location.second, time);
+    if (!st.IsNotFound()) {
+      break;
+    }
   }
-  if (st.IsNotFound() && HasSrcBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->GetCloudObjectModificationTime(
-        GetSrcBucketName(), srcname(fname), time);
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::ListCloudObjects(const std::string& bucket,
+                                               const std::string& object_path,
+                                               std::vector<std::string>* result) {
+  auto first = result->size();
+  IOStatus st;
+  if (!metadata_cache_) {
+    st = GetStorageProvider()->ListCloudObjects(bucket, object_path, result);
+  } else if (!metadata_cache_->LookupListing(bucket, object_path, result)) {
+    std::vector<std::string> children;
+    st = GetStorageProvider()->ListCloudObjects(bucket, object_path,
+                                                &children);
+    if (st.ok()) {
+      metadata_cache_->InsertListing(bucket, object_path, children);
+      result->insert(result->end(), children.begin(), children.end());
+    }
+  }
+  // The data objects of the sharded layout are listed by their file names
+  for (auto i = first; i < result->size(); i++) {
+    (*result)[i] = RemoveObjectShard((*result)[i]);
   }
   return st;
 }
@@ -111,8 +345,7 @@ IOStatus CloudFileSystemImpl::ListCloudObjects(
   IOStatus st;
   // Fetch the list of children from both cloud buckets
   if (HasSrcBucket()) {
-    st = GetStorageProvider()->ListCloudObjects(GetSrcBucketName(),
-                                                GetSrcObjectPath(), result);
+    st = ListCloudObjects(GetSrcBucketName(), GetSrcObjectPath(), result);
     if (!st.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[%s] GetChildren src bucket %s %s error from %s %s", Name(),
@@ -122,8 +355,7 @@ IOStatus CloudFileSystemImpl::ListCloudObjects(
     }
   }
   if (HasDestBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->ListCloudObjects(GetDestBucketName(),
-                                                GetDestObjectPath(), result);
+    st = ListCloudObjects(GetDestBucketName(), GetDestObjectPath(), result);
     if (!st.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[%s] GetChildren dest bucket %s %s error from %s %s", Name(),
@@ -131,23 +363,63 @@ IOStatus CloudFileSystemImpl::ListCloudObjects(
           GetStorageProvider()->Name(), st.ToString().c_str());
     }
   }
+  // The data files in the low-latency bucket, under the same object paths
+  const auto& low_latency_bucket = cloud_fs_options.low_latency_bucket;
+  if (st.ok() && !low_latency_bucket.empty()) {
+    std::vector<std::string> object_paths;
+    if (HasSrcBucket()) {
+      object_paths.push_back(GetSrcObjectPath());
+    }
+    if (HasDestBucket() && (!HasSrcBucket() ||
+                            GetDestObjectPath() != GetSrcObjectPath())) {
+      object_paths.push_back(GetDestObjectPath());
+    }
+    for (const auto& object_path : object_paths) {
+      st = ListCloudObjects(low_latency_bucket, object_path, result);
+      if (!st.ok()) {
+        Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+            "[%s] GetChildren low-latency bucket %s %s error from %s %s",
+            Name(), low_latency_bucket.c_str(), path.c_str(),
+            GetStorageProvider()->Name(), st.ToString().c_str());
+        break;
+      }
+    }
+  }
+  if (st.ok() && sst_packer_) {
+    sst_packer_->ListFiles(result);
+  }
   return st;
 }
 
 IOStatus CloudFileSystemImpl::NewCloudReadableFile(
     const std::string& fname, const FileOptions& options,
     std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
+  auto open_packed = [&](const CloudPackedFile& packed) {
+    std::unique_ptr<CloudStorageReadableFile> pack;
+    auto pack_st = GetStorageProvider()->NewCloudReadableFile(
+        packed.bucket, packed.pack_path, options, &pack, dbg);
+    if (pack_st.ok()) {
+      *result = NewPackedReadableFile(std::move(pack), packed);
+    }
+    return pack_st;
+  };
+  CloudPackedFile packed;
+  if (LookupPackedFile(fname, &packed)) {
+    return open_packed(packed);
+  }
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {  // read from destination
+  for (const auto& location :
+       CloudObjectLocations(fname, options.temperature)) {
     st = GetStorageProvider()->NewCloudReadableFile(
-        GetDestBucketName(), destname(fname), options, result, dbg);
+        location.first, location.second, options, result, dbg);
     if (st.ok()) {
       return st;
     }
   }
-  if (HasSrcBucket() && !SrcMatchesDest()) {  // read from src bucket
-    st = GetStorageProvider()->NewCloudReadableFile(
-        GetSrcBucketName(), srcname(fname), options, result, dbg);
+  if (st.IsNotFound() && sst_packer_ && LoadSstPacks().ok() &&
+      LookupPackedFile(fname, &packed)) {
+    // Packed by another instance of the DB since the packs were indexed
+    st = open_packed(packed);
   }
   return st;
 }
@@ -158,9 +430,15 @@ IOStatus CloudFileSystemImpl::NewSequentialFile(
     std::unique_ptr<FSSequentialFile>* result, IODebugContext* dbg) {
   result->reset();
 
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(logical_fname, &bucket, &object_path)) {
+    return NewSequentialFileCloud(bucket, object_path, file_opts, result, dbg);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
@@ -171,10 +449,19 @@ IOStatus CloudFileSystemImpl::NewSequentialFile(
   }
 
   if (sstfile || manifest || identity) {
-    if (cloud_fs_options.keep_local_sst_files || !sstfile) {
+    if (!sstfile || cloud_fs_options.KeepLocalSstFile(file_opts.temperature)) {
       // We read first from local storage and then from cloud storage.
       st = base_fs_->NewSequentialFile(fname, file_opts, result, dbg);
-      if (!st.ok()) {
+      if (!st.ok() && sstfile &&
+          !cloud_fs_options.cloud_only_sst_temperatures.empty()) {
+        // Likely a cloud-only file opened without its temperature, read it
+        // from the cloud rather than download it
+        std::unique_ptr<CloudStorageReadableFile> file;
+        st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+        if (st.ok()) {
+          result->reset(file.release());
+        }
+      } else if (!st.ok()) {
         // copy the file to the local storage if keep_local_sst_files is true
         st = GetCloudObject(fname);
         if (st.ok()) {
@@ -183,10 +470,22 @@ IOStatus CloudFileSystemImpl::NewSequentialFile(
         }
       }
     } else {
-      std::unique_ptr<CloudStorageReadableFile> file;
-      st = NewCloudReadableFile(fname, file_opts, &file, dbg);
-      if (st.ok()) {
-        result->reset(file.release());
+      // A cloud-only file of keep_local_sst_files is local until uploaded,
+      // a retained one until it is evicted, and a small one until packed
+      st = IOStatus::NotFound();
+      if (cloud_fs_options.keep_local_sst_files || sst_retention_ ||
+          (sst_packer_ && sst_packer_->IsPending(basename(fname)))) {
+        st = base_fs_->NewSequentialFile(fname, file_opts, result, dbg);
+      }
+      if (st.ok() && sst_retention_) {
+        sst_retention_->Touch(fname);
+      }
+      if (!st.ok()) {
+        std::unique_ptr<CloudStorageReadableFile> file;
+        st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+        if (st.ok()) {
+          result->reset(file.release());
+        }
       }
     }
     Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
@@ -225,9 +524,23 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
     std::unique_ptr<FSRandomAccessFile>* result, IODebugContext* dbg) {
   result->reset();
 
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(logical_fname, &bucket, &object_path)) {
+    // E.g. an SST file to ingest: the table reader only reads its footer and
+    // meta blocks
+    std::unique_ptr<CloudStorageReadableFile> file;
+    auto st = GetStorageProvider()->NewCloudReadableFile(
+        bucket, object_path, file_opts, &file, dbg);
+    if (st.ok()) {
+      result->reset(file.release());
+    }
+    return st;
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
@@ -240,7 +553,7 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
 
   const IOOptions io_opts;
   if (sstfile || manifest || identity) {
-    if (cloud_fs_options.keep_local_sst_files || !sstfile) {
+    if (!sstfile || cloud_fs_options.KeepLocalSstFile(file_opts.temperature)) {
       // Read from local storage and then from cloud storage.
       st = base_fs_->NewRandomAccessFile(fname, file_opts, result, dbg);
 
@@ -249,17 +562,36 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
         return st;
       }
 
+      if (!st.ok() && sstfile && hydrator_ && hydrator_->IsPending(fname)) {
+        // Being downloaded in the background, read from the cloud meanwhile
+        std::unique_ptr<CloudStorageReadableFile> file;
+        st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+        if (st.ok()) {
+          *result =
+              hydrator_->NewHydratingFile(fname, file_opts, std::move(file));
+        }
+        Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+            "[%s] NewRandomAccessFile file %s from cloud while hydrating %s",
+            Name(), fname.c_str(), st.ToString().c_str());
+        return st;
+      }
+      bool downloaded = false;
       if (!st.ok()) {
         // copy the file to the local storage
         st = GetCloudObject(fname);
         if (st.ok()) {
           // we successfully copied the file, try opening it locally now
+          downloaded = true;
           st = base_fs_->NewRandomAccessFile(fname, file_opts, result, dbg);
         }
       }
       // If we are being paranoic, then we validate that our file size is
-      // the same as in cloud storage.
-      if (st.ok() && sstfile && cloud_fs_options.validate_filesize) {
+      // the same as in cloud storage. GetCloudObject already did for the
+      // files it just downloaded. With cloud_object_checksums, downloads
+      // are verified and the size of the files is left to the table reader,
+      // which checks it against the MANIFEST.
+      if (st.ok() && sstfile && cloud_fs_options.validate_filesize &&
+          !cloud_fs_options.cloud_object_checksums && !downloaded) {
         uint64_t remote_size = 0;
         uint64_t local_size = 0;
         auto stax = base_fs_->GetFileSize(fname, io_opts, &local_size, dbg);
@@ -283,11 +615,28 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
         }
       }
     } else {
-      // Only execute this code path if files are not cached locally
-      std::unique_ptr<CloudStorageReadableFile> file;
-      st = NewCloudReadableFile(fname, file_opts, &file, dbg);
-      if (st.ok()) {
-        result->reset(file.release());
+      // Only execute this code path if files are not cached locally. A
+      // cloud-only file of keep_local_sst_files is local until uploaded, a
+      // retained one until it is evicted, and a small one until packed.
+      st = IOStatus::NotFound();
+      if (cloud_fs_options.keep_local_sst_files || sst_retention_ ||
+          (sst_packer_ && sst_packer_->IsPending(basename(fname)))) {
+        st = base_fs_->NewRandomAccessFile(fname, file_opts, result, dbg);
+      }
+      if (st.ok() && sst_retention_) {
+        sst_retention_->Touch(fname);
+      }
+      if (!st.ok()) {
+        std::unique_ptr<CloudStorageReadableFile> file;
+        st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+        if (st.ok() && sstfile && retention_hydrator_) {
+          // Read from the cloud until the file is downloaded into the pool
+          retention_hydrator_->Hydrate({fname});
+          *result = retention_hydrator_->NewHydratingFile(fname, file_opts,
+                                                          std::move(file));
+        } else if (st.ok()) {
+          result->reset(file.release());
+        }
       }
     }
     Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
@@ -314,7 +663,7 @@ IOStatus CloudFileSystemImpl::NewWritableFile(
 
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
@@ -322,8 +671,12 @@ IOStatus CloudFileSystemImpl::NewWritableFile(
   IOStatus s;
   if (HasDestBucket() && (sstfile || identity || manifest)) {
     std::unique_ptr<CloudStorageWritableFile> f;
+    const auto& bucket =
+        sstfile && cloud_fs_options.UseLowLatencyBucket(file_opts.temperature)
+            ? cloud_fs_options.low_latency_bucket
+            : GetDestBucketName();
     s = GetStorageProvider()->NewCloudWritableFile(
-        fname, GetDestBucketName(), destname(fname), file_opts, &f, dbg);
+        fname, bucket, destname(fname), file_opts, &f, dbg);
     if (!s.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[%s] NewWritableFile fails while NewCloudWritableFile, src %s %s",
@@ -339,6 +692,9 @@ IOStatus CloudFileSystemImpl::NewWritableFile(
       return s;
     }
     result->reset(f.release());
+    if (sstfile) {
+      UpdateManifestChildren(fname, true /* created */);
+    }
   } else if (logfile && !cloud_fs_options.keep_local_log_files) {
     std::unique_ptr<CloudLogWritableFile> f(
         cloud_fs_options.cloud_log_controller->CreateWritableFile(
@@ -360,12 +716,19 @@ IOStatus CloudFileSystemImpl::NewWritableFile(
 }
 
 IOStatus CloudFileSystemImpl::ReopenWritableFile(
-    const std::string& fname, const FileOptions& file_opts,
+    const std::string& logical_fname, const FileOptions& file_opts,
     std::unique_ptr<FSWritableFile>* result, IODebugContext* dbg) {
   // This is not accurately correct because there is no wasy way to open
   // an provider file in append mode. We still need to support this because
   // rocksdb's ExternalSstFileIngestionJob invokes this api to reopen
   // a pre-created file to flush/sync it.
+  auto fname = RemapFilename(logical_fname);
+  if (IsCloudDataFile(fname) &&
+      base_fs_->FileExists(fname, IOOptions(), dbg).IsNotFound()) {
+    // Linked to a cloud object only (see LinkFile()): there is nothing to
+    // sync, and reopening would create an empty local file
+    return IOStatus::NotSupported("File is only in the cloud", fname);
+  }
   return base_fs_->ReopenWritableFile(fname, file_opts, result, dbg);
 }
 
@@ -377,9 +740,15 @@ IOStatus CloudFileSystemImpl::FileExists(const std::string& logical_fname,
                                          IODebugContext* dbg) {
   IOStatus st;
 
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(logical_fname, &bucket, &object_path)) {
+    return GetStorageProvider()->ExistsCloudObject(bucket, object_path);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
@@ -410,7 +779,8 @@ IOStatus CloudFileSystemImpl::GetChildren(const std::string& path,
   result->clear();
 
   IOStatus st;
-  if (!cloud_fs_options.skip_cloud_files_in_getchildren) {
+  if (!cloud_fs_options.skip_cloud_files_in_getchildren &&
+      !GetManifestChildren(path, result)) {
     // Fetch the list of children from the cloud
     st = ListCloudObjects(path, result);
     if (!st.ok()) {
@@ -431,25 +801,24 @@ IOStatus CloudFileSystemImpl::GetChildren(const std::string& path,
     result->push_back(value);
   }
 
-  // Remove all results that are not supposed to be visible.
-  result->erase(
-      std::remove_if(result->begin(), result->end(),
-                     [&](const std::string& f) {
-                       auto noepoch = RemoveEpoch(f);
-                       if (!IsSstFile(noepoch) && !IsManifestFile(noepoch)) {
-                         return false;
-                       }
-                       return RemapFilename(noepoch) != f;
-                     }),
-      result->end());
-  // Remove the epoch, remap into RocksDB's domain
-  for (size_t i = 0; i < result->size(); ++i) {
-    auto noepoch = RemoveEpoch(result->at(i));
-    if (IsSstFile(noepoch) || IsManifestFile(noepoch)) {
-      // remap sst and manifest files
-      result->at(i) = noepoch;
+  // Remove all results that are not supposed to be visible, and remove the
+  // epoch of the others to remap them into RocksDB's domain, in one pass
+  // since there are a lot of them
+  size_t num_visible = 0;
+  for (auto& f : *result) {
+    auto noepoch = RemoveEpoch(f);
+    if (IsCloudDataFile(noepoch) || IsManifestFile(noepoch)) {
+      if (RemapFilename(noepoch) != f) {
+        continue;
+      }
+      f = std::move(noepoch);
     }
+    if (&(*result)[num_visible] != &f) {
+      (*result)[num_visible] = std::move(f);
+    }
+    num_visible++;
   }
+  result->resize(num_visible);
   // remove duplicates
   std::sort(result->begin(), result->end());
   result->erase(std::unique(result->begin(), result->end()), result->end());
@@ -465,9 +834,15 @@ IOStatus CloudFileSystemImpl::GetFileSize(const std::string& logical_fname,
                                           uint64_t* size, IODebugContext* dbg) {
   *size = 0L;
 
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(logical_fname, &bucket, &object_path)) {
+    return GetStorageProvider()->GetCloudObjectSize(bucket, object_path, size);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        logfile = (file_type == RocksDBFileType::kLogFile);
 
   IOStatus st;
@@ -495,7 +870,7 @@ IOStatus CloudFileSystemImpl::GetFileModificationTime(
 
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        logfile = (file_type == RocksDBFileType::kLogFile);
 
   IOStatus st;
@@ -527,13 +902,17 @@ IOStatus CloudFileSystemImpl::RenameFile(const std::string& logical_src,
   auto target = RemapFilename(logical_target);
   // Get file type of target
   auto file_type = GetFileType(target);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(target),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
 
-  // Rename should never be called on sst files.
-  if (sstfile) {
+  // Rename should never be called on sst files, except to install the output
+  // of a remote compaction
+  if (sstfile && HasDestBucket() &&
+      !RemoteCompactionOutputPath(logical_src).empty()) {
+    return InstallRemoteCompactionOutput(logical_src, target);
+  } else if (sstfile) {
     Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
         "[%s] RenameFile source sstfile %s %s is not supported", Name(),
         src.c_str(), target.c_str());
@@ -579,6 +958,11 @@ IOStatus CloudFileSystemImpl::LinkFile(const std::string& src,
                                        const std::string& target,
                                        const IOOptions& io_opts,
                                        IODebugContext* dbg) {
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(src, &bucket, &object_path)) {
+    return LinkCloudObject(bucket, object_path, target);
+  }
   // We only know how to link file if both src and dest buckets are empty
   if (HasDestBucket() || HasSrcBucket()) {
     return IOStatus::NotSupported();
@@ -693,9 +1077,15 @@ IOStatus CloudFileSystemImpl::DeleteDir(const std::string& dirname,
 IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
                                          const IOOptions& io_opts,
                                          IODebugContext* dbg) {
+  std::string bucket;
+  std::string object_path;
+  if (ParseCloudObjectFilePath(logical_fname, &bucket, &object_path)) {
+    return GetStorageProvider()->DeleteCloudObject(bucket, object_path);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
-  bool sstfile = (file_type == RocksDBFileType::kSstFile),
+  bool sstfile = IsCloudDataFile(fname),
        manifest = (file_type == RocksDBFileType::kManifestFile),
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
@@ -729,7 +1119,38 @@ IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
   IOStatus st;
   // Delete from destination bucket and local dir
   if (sstfile || manifest || identity) {
-    if (HasDestBucket()) {
+    if (sstfile && upload_queue_) {
+      // Don't let a background upload resurrect the file we delete
+      upload_queue_->Wait(basename(fname)).PermitUncheckedError();
+    }
+    if (sstfile && hydrator_) {
+      hydrator_->Cancel(fname);
+    }
+    if (sstfile && sst_retention_) {
+      retention_hydrator_->Cancel(fname);
+      sst_retention_->Erase(fname);
+    }
+    if (sstfile) {
+      UpdateManifestChildren(fname, false /* created */);
+    }
+    // A small file waiting for its pack never reached the cloud, and a
+    // packed one goes away with the last file of its pack
+    bool pending_pack = false;
+    bool packed = false;
+    std::string emptied_pack_path;
+    if (sstfile && sst_packer_) {
+      if (sst_packer_->IsPending(basename(fname))) {
+        // Not while its pack is being uploaded
+        std::lock_guard<std::mutex> lk(sst_pack_mutex_);
+        pending_pack = sst_packer_->RemovePending(basename(fname));
+      }
+      if (!pending_pack) {
+        packed = sst_packer_->Remove(basename(fname), &emptied_pack_path);
+      }
+    }
+    if (HasDestBucket() && !emptied_pack_path.empty()) {
+      st = DeleteCloudFileFromDest(basename(emptied_pack_path));
+    } else if (HasDestBucket() && !pending_pack && !packed) {
       // add the remote file deletion to the queue
       st = DeleteCloudFileFromDest(basename(fname));
     }
@@ -762,47 +1183,460 @@ IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
   return st;
 }
 
+IOStatus CloudFileSystemImpl::Poll(std::vector<void*>& io_handles,
+                                   size_t min_completions) {
+  std::vector<void*> local_handles;
+  auto st = CloudStorageReadableFileImpl::PollAsyncReads(io_handles,
+                                                         &local_handles);
+  if (st.ok() && !local_handles.empty()) {
+    st = base_fs_->Poll(local_handles,
+                        std::min(min_completions, local_handles.size()));
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::AbortIO(std::vector<void*>& io_handles) {
+  std::vector<void*> local_handles;
+  auto st = CloudStorageReadableFileImpl::AbortAsyncReads(io_handles,
+                                                          &local_handles);
+  if (st.ok() && !local_handles.empty()) {
+    st = base_fs_->AbortIO(local_handles);
+  }
+  return st;
+}
+
 IOStatus CloudFileSystemImpl::CopyLocalFileToDest(
-    const std::string& local_name, const std::string& dest_name) {
+    const std::string& local_name, const std::string& dest_name,
+    const std::string& storage_class) {
   if (cloud_file_deletion_scheduler_) {
     // Remove file from deletion queue
     cloud_file_deletion_scheduler_->UnscheduleFileDeletion(
         basename(local_name));
   }
+  if (!storage_class.empty()) {
+    return GetStorageProvider()->PutCloudObjectInStorageClass(
+        local_name, GetDestBucketName(), dest_name, storage_class);
+  }
   return GetStorageProvider()->PutCloudObject(local_name, GetDestBucketName(),
                                               dest_name);
 }
 
+IOStatus CloudFileSystemImpl::SyncManifestToDest(const std::string& local_name,
+                                                 const std::string& cloud_name,
+                                                 bool force) {
+  if (!manifest_upload_) {
+    // The MANIFEST may reference SST files whose upload is still queued
+    auto st = WaitForPendingUploads();
+    if (st.ok()) {
+      st = CopyLocalFileToDest(local_name, cloud_name);
+    }
+    return st;
+  }
+  std::lock_guard<std::mutex> lk(manifest_upload_->mutex);
+  if (!manifest_upload_->status.ok()) {
+    // The MANIFEST stays pending, the next sync retries
+    auto st = manifest_upload_->status;
+    manifest_upload_->status = IOStatus::OK();
+    return st;
+  }
+  manifest_upload_->local_name = local_name;
+  manifest_upload_->cloud_name = cloud_name;
+  const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::milliseconds(
+          cloud_fs_options.manifest_upload_interval_millis));
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - manifest_upload_->last_upload);
+  if (force || elapsed >= interval) {
+    return UploadDeferredManifest();
+  }
+  if (!manifest_upload_->scheduled) {
+    ScheduleManifestUpload(interval - elapsed);
+  }
+  return IOStatus::OK();
+}
+
+IOStatus CloudFileSystemImpl::FlushManifestUpload() {
+  if (!manifest_upload_) {
+    return IOStatus::OK();
+  }
+  std::lock_guard<std::mutex> lk(manifest_upload_->mutex);
+  if (manifest_upload_->local_name.empty()) {
+    auto st = manifest_upload_->status;
+    manifest_upload_->status = IOStatus::OK();
+    return st;
+  }
+  return UploadDeferredManifest();
+}
+
+IOStatus CloudFileSystemImpl::UploadDeferredManifest() {
+  auto& upload = *manifest_upload_;
+  auto st = WaitForPendingUploads();
+  if (st.ok()) {
+    st = CopyLocalFileToDest(upload.local_name, upload.cloud_name);
+  }
+  if (st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+        "[cloud_fs_impl] Uploaded deferred manifest %s",
+        upload.local_name.c_str());
+    upload.last_upload = std::chrono::steady_clock::now();
+    upload.local_name.clear();
+    upload.cloud_name.clear();
+  }
+  return st;
+}
+
+void CloudFileSystemImpl::ScheduleManifestUpload(
+    std::chrono::microseconds delay) {
+  std::weak_ptr<DeferredManifestUpload> wp = manifest_upload_;
+  auto do_upload = [wp](void*) {
+    auto upload = wp.lock();
+    if (!upload) {
+      return;
+    }
+    std::lock_guard<std::mutex> lk(upload->mutex);
+    upload->scheduled = false;
+    if (upload->cfs == nullptr || upload->local_name.empty()) {
+      return;
+    }
+    auto st = upload->cfs->UploadDeferredManifest();
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, upload->cfs->info_log_,
+          "[cloud_fs_impl] Failed to upload deferred manifest %s: %s",
+          upload->local_name.c_str(), st.ToString().c_str());
+      upload->status = st;
+    }
+  };
+  manifest_upload_->scheduled = true;
+  manifest_upload_scheduler_->ScheduleJob(delay, std::move(do_upload),
+                                          nullptr);
+}
+
+IOStatus CloudFileSystemImpl::ScheduleUpload(const std::string& local_name,
+                                             std::function<IOStatus()> upload) {
+  if (!upload_queue_) {
+    return upload();
+  }
+  upload_queue_->Enqueue(basename(local_name), std::move(upload));
+  return IOStatus::OK();
+}
+
+IOStatus CloudFileSystemImpl::WaitForPendingUploads() {
+  IOStatus st;
+  if (upload_queue_) {
+    st = upload_queue_->WaitAll();
+  }
+  if (st.ok() && sst_packer_) {
+    st = UploadSstPack();
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::ReleaseLocalSstFile(
+    const std::string& local_name) {
+  if (sst_retention_) {
+    return RetainLocalSstFile(local_name);
+  }
+  auto st = base_fs_->DeleteFile(local_name, IOOptions(), nullptr /*dbg*/);
+  if (st.ok()) {
+    OnLocalSstCopyChanged(local_name, false /* added */);
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::RetainLocalSstFile(const std::string& fname) {
+  uint64_t size = 0;
+  auto st = base_fs_->GetFileSize(fname, IOOptions(), &size, nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::vector<std::string> evicted;
+  sst_retention_->Insert(fname, size, &evicted);
+  for (const auto& path : evicted) {
+    // The file stays in the cloud
+    auto dst = base_fs_->DeleteFile(path, IOOptions(), nullptr /*dbg*/);
+    if (dst.ok()) {
+      OnLocalSstCopyChanged(path, false /* added */);
+    }
+    Log(dst.ok() || dst.IsNotFound() ? InfoLogLevel::DEBUG_LEVEL
+                                     : InfoLogLevel::WARN_LEVEL,
+        info_log_, "[cloud_fs_impl] Evicted local copy of %s: %s",
+        path.c_str(), dst.ToString().c_str());
+  }
+  return IOStatus::OK();
+}
+
+void CloudFileSystemImpl::SetSstFileManager(
+    const std::shared_ptr<CloudSstFileManager>& sst_file_manager) {
+  std::lock_guard<std::mutex> lk(sst_file_manager_mutex_);
+  sst_file_manager_ = sst_file_manager;
+}
+
+void CloudFileSystemImpl::OnLocalSstCopyChanged(const std::string& fname,
+                                                bool added) {
+  std::shared_ptr<CloudSstFileManager> sfm;
+  {
+    std::lock_guard<std::mutex> lk(sst_file_manager_mutex_);
+    sfm = sst_file_manager_.lock();
+  }
+  if (!sfm) {
+    return;
+  }
+  if (!added) {
+    sfm->OnLocalCopyRemoved(fname);
+    return;
+  }
+  uint64_t size = 0;
+  if (base_fs_->GetFileSize(fname, IOOptions(), &size, nullptr /*dbg*/)
+          .ok()) {
+    sfm->OnLocalCopyAdded(fname, size);
+  }
+}
+
+IOStatus CloudFileSystemImpl::PackSstFile(const std::string& local_name,
+                                          bool keep_local, bool* packed) {
+  *packed = false;
+  if (!sst_packer_ || !HasDestBucket() ||
+      !IsSstFile(RemoveEpoch(local_name))) {
+    return IOStatus::OK();
+  }
+  uint64_t size = 0;
+  auto st =
+      base_fs_->GetFileSize(local_name, IOOptions(), &size, nullptr /*dbg*/);
+  if (!st.ok() || size >= cloud_fs_options.sst_pack_threshold) {
+    return st;
+  }
+  if (cloud_file_deletion_scheduler_) {
+    // Remove file from deletion queue
+    cloud_file_deletion_scheduler_->UnscheduleFileDeletion(
+        basename(local_name));
+  }
+  *packed = true;
+  auto pending_bytes = sst_packer_->AddPending(
+      basename(local_name),
+      CloudSstPacker::PendingFile{local_name, size, keep_local});
+  if (pending_bytes < cloud_fs_options.sst_pack_target_size) {
+    return IOStatus::OK();
+  }
+  return ScheduleUpload(kSstPackDir, [this]() { return UploadSstPack(); });
+}
+
+IOStatus CloudFileSystemImpl::UploadSstPack() {
+  std::lock_guard<std::mutex> lk(sst_pack_mutex_);
+  auto pending = sst_packer_->GetPending();
+  if (pending.empty()) {
+    return IOStatus::OK();
+  }
+  std::string data;
+  std::vector<CloudSstPacker::Entry> files;
+  IOStatus st;
+  for (const auto& file : pending) {
+    std::string file_data;
+    st = ReadFileToString(base_fs_.get(), file.second.local_path, &file_data);
+    if (!st.ok()) {
+      break;
+    }
+    files.push_back(
+        CloudSstPacker::Entry{file.first, data.size(), file_data.size()});
+    data.append(file_data);
+  }
+  auto data_size = data.size();
+  CloudSstPacker::EncodeIndex(files, data_size, &data);
+  const auto& first_path = pending.front().second.local_path;
+  auto pack_name = SstPackFileName(first_path);
+  auto local_pack = dirname(first_path) + pathsep + pack_name;
+  if (st.ok()) {
+    st = WriteStringToFile(base_fs_.get(), data, local_pack);
+  }
+  if (st.ok()) {
+    st = CopyLocalFileToDest(local_pack, destname(pack_name));
+  }
+  base_fs_->DeleteFile(local_pack, IOOptions(), nullptr /*dbg*/)
+      .PermitUncheckedError();
+  if (!st.ok()) {
+    // The files stay pending, the next pack retries
+    Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+        "[cloud_fs_impl] Failed to upload pack %s: %s", pack_name.c_str(),
+        st.ToString().c_str());
+    return st;
+  }
+  sst_packer_->AddPack(GetDestBucketName(), destname(pack_name),
+                       true /* owned */, files);
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[cloud_fs_impl] Uploaded pack %s of %" ROCKSDB_PRIszt
+      " files, %" PRIu64 " bytes",
+      pack_name.c_str(), files.size(), static_cast<uint64_t>(data_size));
+  for (const auto& file : pending) {
+    if (file.second.keep_local) {
+      continue;
+    }
+    auto release_st = ReleaseLocalSstFile(file.second.local_path);
+    if (!release_st.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[cloud_fs_impl] Failed to release packed file %s: %s",
+          file.second.local_path.c_str(), release_st.ToString().c_str());
+    }
+  }
+  return IOStatus::OK();
+}
+
+bool CloudFileSystemImpl::LookupPackedFile(const std::string& fname,
+                                           CloudPackedFile* packed) {
+  return sst_packer_ && sst_packer_->Lookup(basename(fname), packed);
+}
+
+IOStatus CloudFileSystemImpl::GetPackedFile(const CloudPackedFile& packed,
+                                            const std::string& local_path) {
+  std::unique_ptr<CloudStorageReadableFile> file;
+  auto st = GetStorageProvider()->NewCloudReadableFile(
+      packed.bucket, packed.pack_path, FileOptions(), &file, nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::string scratch(packed.size, '\0');
+  Slice data;
+  FSRandomAccessFile* pack = file.get();
+  st = pack->Read(packed.offset, packed.size, IOOptions(), &data, &scratch[0],
+                  nullptr /*dbg*/);
+  if (st.ok() && data.size() != packed.size) {
+    st = IOStatus::Corruption("Truncated pack " + packed.pack_path,
+                              local_path);
+  }
+  // Like the downloads of the storage provider, the file only appears once
+  // complete
+  auto tmp_path = local_path + ".tmp";
+  if (st.ok()) {
+    st = WriteStringToFile(base_fs_.get(), data, tmp_path,
+                           true /* should_sync */);
+  }
+  if (st.ok()) {
+    st = base_fs_->RenameFile(tmp_path, local_path, IOOptions(),
+                              nullptr /*dbg*/);
+  }
+  if (!st.ok()) {
+    base_fs_->DeleteFile(tmp_path, IOOptions(), nullptr /*dbg*/)
+        .PermitUncheckedError();
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::CopyPackedFileToDest(const std::string& fname) {
+  CloudPackedFile packed;
+  if (!LookupPackedFile(fname, &packed)) {
+    return IOStatus::NotFound(fname);
+  }
+  if (packed.bucket == GetDestBucketName() &&
+      packed.pack_path == destname(basename(packed.pack_path))) {
+    return IOStatus::OK();
+  }
+  auto local_copy = fname + ".copy";
+  auto st = GetPackedFile(packed, local_copy);
+  if (st.ok()) {
+    st = GetStorageProvider()->PutCloudObject(local_copy, GetDestBucketName(),
+                                              destname(fname));
+    InvalidateCloudObjectMetadata(GetDestBucketName(), destname(fname));
+  }
+  base_fs_->DeleteFile(local_copy, IOOptions(), nullptr /*dbg*/)
+      .PermitUncheckedError();
+  return st;
+}
+
 IOStatus CloudFileSystemImpl::DeleteCloudFileFromDest(
     const std::string& fname) {
+  return DeleteCloudFilesFromDest({fname});
+}
+
+IOStatus CloudFileSystemImpl::DeleteCloudFilesFromDest(
+    const std::vector<std::string>& fnames) {
   assert(HasDestBucket());
-  auto base = basename(fname);
-  auto path = GetDestObjectPath() + pathsep + base;
-  auto bucket = GetDestBucketName();
+  // The MANIFEST in the cloud must not reference the deleted files
+  auto flush_st = FlushManifestUpload();
+  if (!flush_st.ok()) {
+    return flush_st;
+  }
+  // A data file can be in the low-latency bucket too. Deleting an object
+  // that does not exist is not an error.
+  std::vector<std::string> buckets{GetDestBucketName()};
+  if (!cloud_fs_options.low_latency_bucket.empty()) {
+    buckets.push_back(cloud_fs_options.low_latency_bucket);
+  }
+  std::vector<std::string> paths;
+  paths.reserve(fnames.size());
+  for (const auto& fname : fnames) {
+    auto path = destname(fname);
+    for (const auto& bucket : buckets) {
+      if (cloud_fs_options.sst_file_cache) {
+        // The object is going away, drop its extents right now. A delayed
+        // deletion that gets unscheduled only costs a refetch.
+        cloud_fs_options.sst_file_cache->Erase(bucket + pathsep + path);
+      }
+      // With a delayed deletion, the metadata is forgotten once more after
+      // the deletion, in case it was fetched again meanwhile
+      InvalidateCloudObjectMetadata(bucket, path);
+    }
+    paths.push_back(std::move(path));
+  }
   if (!cloud_file_deletion_scheduler_) {
-    return GetStorageProvider()->DeleteCloudObject(bucket, path);
+    IOStatus st;
+    for (const auto& bucket : buckets) {
+      auto bucket_st = GetStorageProvider()->DeleteCloudObjects(bucket, paths);
+      for (const auto& path : paths) {
+        InvalidateCloudObjectMetadata(bucket, path);
+      }
+      if (st.ok()) {
+        st = bucket_st;
+      }
+    }
+    return st;
   }
+  std::weak_ptr<CloudMetadataCache> metadata_cache_wp = metadata_cache_;
   std::weak_ptr<Logger> info_log_wp = info_log_;
   std::weak_ptr<CloudStorageProvider> storage_provider_wp =
       GetStorageProvider();
+  std::weak_ptr<CloudTransferExecutor> transfer_executor_wp =
+      transfer_executor_;
+  // Deletes the batch of deletions due at the same time
   auto file_deletion_runnable =
-      [path = std::move(path), bucket = std::move(bucket),
-       info_log_wp = std::move(info_log_wp),
-       storage_provider_wp = std::move(storage_provider_wp)]() {
+      [buckets, info_log_wp = std::move(info_log_wp),
+       storage_provider_wp = std::move(storage_provider_wp),
+       transfer_executor_wp = std::move(transfer_executor_wp),
+       metadata_cache_wp = std::move(metadata_cache_wp)](
+          const std::vector<std::string>& object_paths) {
         auto storage_provider = storage_provider_wp.lock();
         auto info_log = info_log_wp.lock();
-        if (!storage_provider || !info_log) {
+        auto transfer_executor = transfer_executor_wp.lock();
+        if (!storage_provider || !info_log || !transfer_executor) {
           return;
         }
-        auto st = storage_provider->DeleteCloudObject(bucket, path);
-        if (!st.ok() && !st.IsNotFound()) {
+        // Counted against the deletions running on the transfer threads
+        auto st = transfer_executor->RunAll(
+            CloudTransferExecutor::kDelete, buckets.size(),
+            [&](size_t idx) {
+              return storage_provider->DeleteCloudObjects(buckets[idx],
+                                                          object_paths);
+            },
+            1);
+        if (auto metadata_cache = metadata_cache_wp.lock()) {
+          for (const auto& bucket : buckets) {
+            for (const auto& path : object_paths) {
+              metadata_cache->Invalidate(bucket, path);
+            }
+          }
+        }
+        if (!st.ok()) {
           Log(InfoLogLevel::ERROR_LEVEL, info_log,
-              "[CloudFileSystemImpl] DeleteFile file %s error %s", path.c_str(),
-              st.ToString().c_str());
+              "[CloudFileSystemImpl] DeleteFile of %" ROCKSDB_PRIszt
+              " files error %s",
+              object_paths.size(), st.ToString().c_str());
         }
       };
-  return cloud_file_deletion_scheduler_->ScheduleFileDeletion(
-      base, std::move(file_deletion_runnable));
+  for (size_t i = 0; i < fnames.size(); i++) {
+    auto st = cloud_file_deletion_scheduler_->ScheduleBatchedFileDeletion(
+        basename(fnames[i]), paths[i], file_deletion_runnable);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return IOStatus::OK();
 }
 
 // Copy my IDENTITY file to cloud storage. Update dbid registry.
@@ -828,6 +1662,55 @@ IOStatus CloudFileSystemImpl::SaveIdentityToCloud(const std::string& localfile,
   return st;
 }
 
+IOStatus CloudFileSystemImpl::InstallRemoteCompactionOutput(
+    const std::string& logical_src, const std::string& fname) {
+  auto src_object =
+      GetDestObjectPath() + "/" + RemoteCompactionOutputPath(logical_src);
+  // The output is copied in the cloud, it is never downloaded
+  auto st = GetStorageProvider()->CopyCloudObject(
+      GetDestBucketName(), src_object, GetDestBucketName(), destname(fname));
+  InvalidateCloudObjectMetadata(GetDestBucketName(), destname(fname));
+  if (st.ok()) {
+    UpdateManifestChildren(fname, true /* created */);
+    // If this fails, the copy is only left behind in the job directory
+    GetStorageProvider()
+        ->DeleteCloudObject(GetDestBucketName(), src_object)
+        .PermitUncheckedError();
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] InstallRemoteCompactionOutput %s to %s: %s", Name(),
+      src_object.c_str(), fname.c_str(), st.ToString().c_str());
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::LinkCloudObject(
+    const std::string& bucket, const std::string& object_path,
+    const std::string& logical_target) {
+  auto fname = RemapFilename(logical_target);
+  if (!HasDestBucket() || !IsCloudDataFile(fname)) {
+    return IOStatus::NotSupported(
+        "Only the data files of a DB with a dest bucket can be linked to a "
+        "cloud object",
+        fname);
+  }
+  // The object is copied in the cloud, it is never downloaded unless the DB
+  // keeps local SST files
+  auto st = GetStorageProvider()->CopyCloudObject(
+      bucket, object_path, GetDestBucketName(), destname(fname));
+  InvalidateCloudObjectMetadata(GetDestBucketName(), destname(fname));
+  if (st.ok()) {
+    UpdateManifestChildren(fname, true /* created */);
+    if (cloud_fs_options.KeepLocalSstFile(Temperature::kUnknown)) {
+      st = GetStorageProvider()->GetCloudObject(GetDestBucketName(),
+                                                destname(fname), fname);
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] LinkCloudObject %s/%s to %s: %s", Name(), bucket.c_str(),
+      object_path.c_str(), fname.c_str(), st.ToString().c_str());
+  return st;
+}
+
 void CloudFileSystemImpl::StopPurger() {
   {
     std::lock_guard<std::mutex> lk(purger_lock_);
@@ -855,42 +1738,98 @@ IOStatus CloudFileSystemImpl::LoadLocalCloudManifest(
                                                cookie, &cloud_manifest_);
 }
 
+namespace {
+// Parses "<number>.sst" and "<number>.blob", the names most remapped, without
+// the allocations of ParseFileName()
+bool ParseDataFileName(const Slice& name, uint64_t* number, FileType* type) {
+  size_t i = 0;
+  uint64_t n = 0;
+  for (; i < name.size() && name[i] >= '0' && name[i] <= '9'; i++) {
+    if (n > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+      return false;
+    }
+    n = n * 10 + static_cast<uint64_t>(name[i] - '0');
+  }
+  if (i == 0) {
+    return false;
+  }
+  Slice ext(name.data() + i, name.size() - i);
+  if (ext == Slice(".sst")) {
+    *type = kTableFile;
+  } else if (ext == Slice(".blob")) {
+    *type = kBlobFile;
+  } else {
+    return false;
+  }
+  *number = n;
+  return true;
+}
+}  // namespace
+
 std::string RemapFilenameWithCloudManifest(const std::string& logical_path,
-                                           CloudManifest* cloud_manifest) {
-  auto file_name = basename(logical_path);
+                                           CloudManifest* cloud_manifest,
+                                           bool remap_blob_files) {
+  // Slices of logical_path, the result is the only allocation
+  const auto slash = logical_path.rfind('/');
+  Slice dir;
+  Slice file_name(logical_path);
+  if (slash != std::string::npos) {
+    dir = Slice(logical_path.data(), slash);
+    file_name.remove_prefix(slash + 1);
+  }
   uint64_t fileNumber;
   FileType type;
   WalFileType walType;
-  if (file_name == "MANIFEST") {
+  if (file_name == Slice("MANIFEST")) {
     type = kDescriptorFile;
-  } else {
-    bool ok = ParseFileName(file_name, &fileNumber, &type, &walType);
+  } else if (!ParseDataFileName(file_name, &fileNumber, &type)) {
+    bool ok =
+        ParseFileName(file_name.ToString(), &fileNumber, &type, &walType);
     if (!ok) {
       return logical_path;
     }
   }
-  std::string epoch;
+  // Points into cloud_manifest, no copy
+  const std::string* epoch;
   switch (type) {
     case kTableFile:
       // We should not be accessing sst files before CLOUDMANIFEST is loaded
       assert(cloud_manifest);
-      epoch = cloud_manifest->GetEpoch(fileNumber);
+      epoch = &cloud_manifest->GetEpoch(fileNumber);
+      break;
+    case kBlobFile:
+      if (!remap_blob_files) {
+        return logical_path;
+      }
+      // Blob files are numbered like sst files, so their epochs are found
+      // the same way
+      assert(cloud_manifest);
+      epoch = &cloud_manifest->GetEpoch(fileNumber);
       break;
     case kDescriptorFile:
       // We should not be accessing MANIFEST files before CLOUDMANIFEST is
       // loaded
       // Even though logical file might say MANIFEST-000001, we cut the number
       // suffix and store MANIFEST-[epoch] in the cloud and locally.
-      file_name = "MANIFEST";
+      file_name = Slice("MANIFEST");
       assert(cloud_manifest);
-      epoch = cloud_manifest->GetCurrentEpoch();
+      epoch = &cloud_manifest->GetCurrentEpoch();
       break;
     default:
       return logical_path;
   };
-  auto dir = dirname(logical_path);
-  return dir + (dir.empty() ? "" : "/") + file_name +
-         (epoch.empty() ? "" : ("-" + epoch));
+  std::string result;
+  result.reserve(dir.size() + file_name.size() + epoch->size() + 2);
+  result.append(dir.data(), dir.size());
+  if (!dir.empty()) {
+    result.push_back('/');
+  }
+  result.append(file_name.data(), file_name.size());
+  if (!epoch->empty()) {
+    result.push_back('-');
+    result.append(*epoch);
+  }
+  return result;
 }
 
 std::string CloudFileSystemImpl::RemapFilename(
@@ -898,15 +1837,41 @@ std::string CloudFileSystemImpl::RemapFilename(
   if (UNLIKELY(test_disable_cloud_manifest_)) {
     return logical_path;
   }
-  return RemapFilenameWithCloudManifest(logical_path, cloud_manifest_.get());
+  return RemapFilenameWithCloudManifest(logical_path, cloud_manifest_.get(),
+                                        cloud_fs_options.cloud_blob_files);
+}
+
+bool CloudFileSystemImpl::IsCloudDataFile(const std::string& fname) const {
+  auto file_type = GetFileType(fname);
+  return file_type == RocksDBFileType::kSstFile ||
+         (file_type == RocksDBFileType::kBlobFile &&
+          cloud_fs_options.cloud_blob_files);
 }
 
 IOStatus CloudFileSystemImpl::DeleteCloudInvisibleFiles(
     const std::vector<std::string>& active_cookies) {
   assert(HasDestBucket());
-  std::vector<std::string> pathnames;
-  auto s = GetStorageProvider()->ListCloudObjects(
-      GetDestBucketName(), GetDestObjectPath(), &pathnames);
+  std::vector<std::string> invisible_files;
+  auto collect_invisible = [&](const std::vector<std::string>& pathnames) {
+    for (auto& pathname : pathnames) {
+      auto fname = RemoveObjectShard(pathname);
+      if (IsFileInvisible(active_cookies, fname)) {
+        Log(InfoLogLevel::INFO_LEVEL, info_log_,
+            "DeleteCloudInvisibleFiles deleting %s from destination bucket",
+            fname.c_str());
+        invisible_files.push_back(fname);
+      }
+    }
+    return IOStatus::OK();
+  };
+  auto s = GetStorageProvider()->ListCloudObjectsInBatches(
+      GetDestBucketName(), GetDestObjectPath(), collect_invisible);
+  if (s.ok() && !cloud_fs_options.low_latency_bucket.empty()) {
+    // DeleteCloudFilesFromDest() deletes from both buckets
+    s = GetStorageProvider()->ListCloudObjectsInBatches(
+        cloud_fs_options.low_latency_bucket, GetDestObjectPath(),
+        collect_invisible);
+  }
   if (!s.ok()) {
     Log(InfoLogLevel::WARN_LEVEL, info_log_,
         "Files in cloud are not scheduled to be deleted since listing cloud "
@@ -915,15 +1880,8 @@ IOStatus CloudFileSystemImpl::DeleteCloudInvisibleFiles(
     return s;
   }
 
-  for (auto& fname : pathnames) {
-    if (IsFileInvisible(active_cookies, fname)) {
-      // Ignore returned status on purpose.
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "DeleteCloudInvisibleFiles deleting %s from destination bucket",
-          fname.c_str());
-      DeleteCloudFileFromDest(fname);
-    }
-  }
+  // Ignore returned status on purpose.
+  DeleteCloudFilesFromDest(invisible_files).PermitUncheckedError();
   return s;
 }
 
@@ -976,7 +1934,7 @@ bool CloudFileSystemImpl::IsFileInvisible(
     return !is_active;
   } else {
     auto noepoch = RemoveEpoch(fname);
-    if ((IsSstFile(noepoch) || IsManifestFile(noepoch)) &&
+    if ((IsCloudDataFile(noepoch) || IsManifestFile(noepoch)) &&
         (RemapFilename(noepoch) != fname)) {
       return true;
     }
@@ -1036,7 +1994,9 @@ IOStatus CloudFileSystemImpl::WriteCloudManifest(
   auto s = WritableFileWriter::Create(local_fs, tmp_fname, FileOptions(),
                                       &writer, nullptr);
   if (s.ok()) {
-    s = manifest->WriteToLog(std::move(writer));
+    s = manifest->WriteToLog(
+        std::move(writer),
+        static_cast<uint32_t>(cloud_fs_options.cloud_manifest_format_version));
   }
   if (s.ok()) {
     s = local_fs->RenameFile(tmp_fname, fname, IOOptions(), nullptr /*dbg*/);
@@ -1063,7 +2023,8 @@ std::string CloudFileSystemImpl::GenerateNewEpochId() {
 Status CloudFileSystemImpl::CheckOption(const FileOptions& file_opts) {
   // Cannot mmap files that reside on cloud storage, unless the file is also
   // local
-  if (file_opts.use_mmap_reads && !cloud_fs_options.keep_local_sst_files) {
+  if (file_opts.use_mmap_reads &&
+      !cloud_fs_options.KeepLocalSstFile(file_opts.temperature)) {
     std::string msg = "Mmap only if keep_local_sst_files is set";
     return Status::InvalidArgument(msg);
   }
@@ -1076,7 +2037,7 @@ Status CloudFileSystemImpl::CheckOption(const FileOptions& file_opts) {
 std::string CloudFileSystemImpl::srcname(const std::string& localname) {
   assert(cloud_fs_options.src_bucket.IsValid());
   return cloud_fs_options.src_bucket.GetObjectPath() + "/" +
-         basename(localname);
+         ObjectName(localname);
 }
 
 //
@@ -1085,7 +2046,18 @@ std::string CloudFileSystemImpl::srcname(const std::string& localname) {
 std::string CloudFileSystemImpl::destname(const std::string& localname) {
   assert(cloud_fs_options.dest_bucket.IsValid());
   return cloud_fs_options.dest_bucket.GetObjectPath() + "/" +
-         basename(localname);
+         ObjectName(localname);
+}
+
+std::string CloudFileSystemImpl::ObjectName(const std::string& fname) const {
+  auto name = basename(fname);
+  if (cloud_fs_options.shard_data_object_names && IsCloudDataFile(name)) {
+    return ShardedObjectName(name);
+  }
+  if (IsSstPackFile(name)) {
+    return kSstPackDir + pathsep + name;
+  }
+  return name;
 }
 
 //
@@ -1512,6 +2484,12 @@ IOStatus CloudFileSystemImpl::PreloadCloudManifest(
   local_fs->CreateDirIfMissing(local_dbname, IOOptions(), nullptr /*dbg*/);
   // Init cloud manifest
   auto st = FetchCloudManifest(local_dbname);
+  if (st.ok()) {
+    st = LoadCloneAncestors();
+  }
+  if (st.ok()) {
+    st = LoadSstPacks();
+  }
   if (st.ok()) {
     // Inits CloudFileSystemImpl::cloud_manifest_, which will enable us to
     // read files from the cloud
@@ -1522,17 +2500,56 @@ IOStatus CloudFileSystemImpl::PreloadCloudManifest(
 
 IOStatus CloudFileSystemImpl::LoadCloudManifest(const std::string& local_dbname,
                                                 bool read_only) {
+  // The CLOUDMANIFEST names the MANIFEST to fetch, but rarely changes between
+  // two opens of the same directory. So the MANIFEST of the epoch of the local
+  // CLOUDMANIFEST, if any, is fetched while the CLOUDMANIFEST is, which saves
+  // a round trip to the cloud when that epoch is still the current one.
+  bool prefetching = false;
+  std::string prefetched_epoch;
+  IOStatus prefetch_st;
+  std::thread prefetch_thread;
+  if (cloud_fs_options.resync_on_open) {
+    std::unique_ptr<CloudManifest> local_cloud_manifest;
+    if (CloudFileSystemEnv::LoadCloudManifest(
+            local_dbname, GetBaseFileSystem(), cloud_fs_options.cookie_on_open,
+            &local_cloud_manifest)
+            .ok()) {
+      prefetching = true;
+      prefetched_epoch = local_cloud_manifest->GetCurrentEpoch();
+      prefetch_thread = std::thread([&]() {
+        prefetch_st = FetchManifest(local_dbname, prefetched_epoch);
+      });
+    }
+  }
+
   // Init cloud manifest
   auto st = FetchCloudManifest(local_dbname);
+  if (st.ok()) {
+    st = LoadCloneAncestors();
+  }
+  if (st.ok()) {
+    st = LoadSstPacks();
+  }
   if (st.ok()) {
     // Inits CloudFileSystemImpl::cloud_manifest_, which will enable us to
     // read files from the cloud
     st = LoadLocalCloudManifest(local_dbname);
   }
+  if (prefetch_thread.joinable()) {
+    prefetch_thread.join();
+  }
 
   if (st.ok() && cloud_fs_options.resync_on_open) {
     auto epoch = cloud_manifest_->GetCurrentEpoch();
-    st = FetchManifest(local_dbname, epoch);
+    bool prefetched = prefetching && epoch == prefetched_epoch;
+    TEST_SYNC_POINT_CALLBACK(
+        "CloudFileSystemImpl::LoadCloudManifest:Prefetched", &prefetched);
+    if (prefetched) {
+      st = prefetch_st;
+    } else {
+      prefetch_st.PermitUncheckedError();
+      st = FetchManifest(local_dbname, epoch);
+    }
     if (st.IsNotFound()) {
       // We always upload MANIFEST first before uploading CLOUDMANIFEST. So it's
       // not expected to have CLOUDMANIFEST in s3 which points to MANIFEST file
@@ -1596,6 +2613,7 @@ IOStatus CloudFileSystemImpl::LoadCloudManifest(const std::string& local_dbname,
       return st;
     }
   }
+  LoadManifestChildren(local_dbname, false /* new_db */);
 
   return st;
 }
@@ -1767,11 +2785,408 @@ IOStatus CloudFileSystemImpl::SanitizeLocalDirectory(
     if (!st.ok()) {
       return st;
     }
+    if (cloud_fs_options.copy_on_write_clones && HasDestBucket() &&
+        !read_only) {
+      st = WriteCloudParent(local_name);
+      if (!st.ok()) {
+        return st;
+      }
+    }
+  }
+
+  return IOStatus::OK();
+}
+
+IOStatus CloudFileSystemImpl::WriteCloudParent(
+    const std::string& local_dbname) {
+  auto local_file = CloudParentFileName(local_dbname);
+  auto st = WriteStringToFile(
+      GetBaseFileSystem().get(),
+      MakeCloudObjectFilePath(GetSrcBucketName(), GetSrcObjectPath()),
+      local_file);
+  if (st.ok()) {
+    st = GetStorageProvider()->PutCloudObject(
+        local_file, GetDestBucketName(),
+        CloudParentFileName(GetDestObjectPath()));
+  }
+  GetBaseFileSystem()
+      ->DeleteFile(local_file, IOOptions(), nullptr /*dbg*/)
+      .PermitUncheckedError();
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[cloud_fs_impl] Clone %s/%s of %s/%s: %s", GetDestBucketName().c_str(),
+      GetDestObjectPath().c_str(), GetSrcBucketName().c_str(),
+      GetSrcObjectPath().c_str(), st.ToString().c_str());
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::ReadCloudParent(const std::string& bucket,
+                                              const std::string& object_path,
+                                              std::string* parent_bucket,
+                                              std::string* parent_path) {
+  std::unique_ptr<FSSequentialFile> file;
+  auto fname = CloudParentFileName(object_path);
+  auto st = NewSequentialFileCloud(bucket, fname, FileOptions(), &file,
+                                   nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::string scratch(4096, '\0');
+  Slice data;
+  st = file->Read(scratch.size(), IOOptions(), &data, &scratch[0],
+                  nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  auto parent = data.ToString();
+  parent = rtrim_if(trim(parent), '\n');
+  if (!ParseCloudObjectFilePath(parent, parent_bucket, parent_path)) {
+    return IOStatus::Corruption("Bad " + bucket + "/" + fname, parent);
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::LoadCloneAncestors() {
+  clone_ancestors_.clear();
+  if (!cloud_fs_options.copy_on_write_clones || !HasDestBucket()) {
+    return IOStatus::OK();
+  }
+  // Bounds the requests of a long or cyclic chain
+  const size_t kMaxCloneDepth = 16;
+  auto bucket = GetDestBucketName();
+  auto path = GetDestObjectPath();
+  for (size_t depth = 0; depth < kMaxCloneDepth; depth++) {
+    std::string parent_bucket;
+    std::string parent_path;
+    auto st = ReadCloudParent(bucket, path, &parent_bucket, &parent_path);
+    if (st.IsNotFound()) {
+      if (depth > 0 || !HasSrcBucket() || SrcMatchesDest()) {
+        break;
+      }
+      // A clone first opened read-only has no CLOUDPARENT, but its src may
+      // have one
+      bucket = GetSrcBucketName();
+      path = GetSrcObjectPath();
+      continue;
+    }
+    if (!st.ok()) {
+      return st;
+    }
+    bucket = std::move(parent_bucket);
+    path = std::move(parent_path);
+    auto location = std::make_pair(bucket, path);
+    if ((bucket == GetDestBucketName() && path == GetDestObjectPath()) ||
+        std::find(clone_ancestors_.begin(), clone_ancestors_.end(),
+                  location) != clone_ancestors_.end()) {
+      break;
+    }
+    if (!HasSrcBucket() || bucket != GetSrcBucketName() ||
+        path != GetSrcObjectPath()) {
+      clone_ancestors_.push_back(std::move(location));
+    }
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[cloud_fs_impl] %" ROCKSDB_PRIszt " clone ancestors",
+      clone_ancestors_.size());
+  return IOStatus::OK();
+}
+
+namespace {
+// Reads the index of the pack at bucket/pack_path
+IOStatus ReadSstPackIndex(CloudStorageProvider* provider,
+                          const std::string& bucket,
+                          const std::string& pack_path,
+                          std::vector<CloudSstPacker::Entry>* files) {
+  uint64_t size = 0;
+  auto st = provider->GetCloudObjectSize(bucket, pack_path, &size);
+  std::unique_ptr<CloudStorageReadableFile> file;
+  if (st.ok()) {
+    st = provider->NewCloudReadableFile(bucket, pack_path, FileOptions(),
+                                        &file, nullptr /*dbg*/);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  if (size < CloudSstPacker::kFooterSize) {
+    return IOStatus::Corruption("Truncated pack", pack_path);
+  }
+  // The index of most packs is read with their footer
+  const uint64_t kTailSize = 64 << 10;
+  auto tail_size = static_cast<size_t>(std::min(size, kTailSize));
+  FSRandomAccessFile* pack = file.get();
+  std::string tail(tail_size, '\0');
+  Slice data;
+  st = pack->Read(size - tail_size, tail_size, IOOptions(), &data, &tail[0],
+                  nullptr /*dbg*/);
+  if (st.ok() && data.size() != tail_size) {
+    st = IOStatus::Corruption("Truncated pack", pack_path);
+  }
+  uint64_t index_offset = 0;
+  if (st.ok()) {
+    st = CloudSstPacker::DecodeFooter(
+        Slice(data.data() + tail_size - CloudSstPacker::kFooterSize,
+              CloudSstPacker::kFooterSize),
+        &index_offset);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  if (index_offset > size - CloudSstPacker::kFooterSize) {
+    return IOStatus::Corruption("Bad pack index offset", pack_path);
+  }
+  auto index_size = static_cast<size_t>(size - CloudSstPacker::kFooterSize -
+                                        index_offset);
+  if (index_size <= tail_size - CloudSstPacker::kFooterSize) {
+    return CloudSstPacker::DecodeIndex(
+        Slice(data.data() + tail_size - CloudSstPacker::kFooterSize -
+                  index_size,
+              index_size),
+        files);
+  }
+  std::string index(index_size, '\0');
+  st = pack->Read(index_offset, index_size, IOOptions(), &data, &index[0],
+                  nullptr /*dbg*/);
+  if (st.ok() && data.size() != index_size) {
+    st = IOStatus::Corruption("Truncated pack", pack_path);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  return CloudSstPacker::DecodeIndex(data, files);
+}
+}  // namespace
+
+IOStatus CloudFileSystemImpl::LoadSstPacks() {
+  if (!sst_packer_) {
+    return IOStatus::OK();
+  }
+  std::vector<std::pair<std::string, std::string>> object_paths;
+  if (HasDestBucket()) {
+    object_paths.emplace_back(GetDestBucketName(), GetDestObjectPath());
+  }
+  if (HasSrcBucket() && !SrcMatchesDest()) {
+    object_paths.emplace_back(GetSrcBucketName(), GetSrcObjectPath());
+  }
+  // (bucket, object path) of the packs not indexed yet
+  std::vector<std::pair<std::string, std::string>> packs;
+  for (const auto& object_path : object_paths) {
+    auto pack_dir = object_path.second + pathsep + kSstPackDir;
+    std::vector<std::string> names;
+    auto st = GetStorageProvider()->ListCloudObjects(object_path.first,
+                                                     pack_dir, &names);
+    if (!st.ok() && !st.IsNotFound()) {
+      return st;
+    }
+    for (const auto& name : names) {
+      auto pack_path = pack_dir + pathsep + name;
+      if (IsSstPackFile(name) &&
+          !sst_packer_->HasPack(object_path.first, pack_path)) {
+        packs.emplace_back(object_path.first, std::move(pack_path));
+      }
+    }
+  }
+  auto st = transfer_executor_->RunAll(
+      CloudTransferExecutor::kHydrate, packs.size(),
+      [&](size_t idx) {
+        const auto& bucket = packs[idx].first;
+        const auto& pack_path = packs[idx].second;
+        std::vector<CloudSstPacker::Entry> files;
+        auto pack_st = ReadSstPackIndex(GetStorageProvider().get(), bucket,
+                                        pack_path, &files);
+        if (pack_st.IsNotFound()) {
+          // Deleted since it was listed
+          return IOStatus::OK();
+        }
+        if (!pack_st.ok()) {
+          return pack_st;
+        }
+        bool owned = HasDestBucket() && bucket == GetDestBucketName() &&
+                     pack_path == destname(basename(pack_path));
+        if (!sst_packer_->AddPack(bucket, pack_path, owned, files)) {
+          Log(InfoLogLevel::WARN_LEVEL, info_log_,
+              "[cloud_fs_impl] Pack %s/%s has no file of its own",
+              bucket.c_str(), pack_path.c_str());
+        }
+        return IOStatus::OK();
+      },
+      cloud_fs_options.sst_download_threads);
+  Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      info_log_,
+      "[cloud_fs_impl] Indexed %" ROCKSDB_PRIszt " packs, %" ROCKSDB_PRIszt
+      " packed files: %s",
+      packs.size(), sst_packer_->NumFiles(), st.ToString().c_str());
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::FindLiveFilesToHydrate(
+    const std::string& local_dbname, std::vector<std::string>* local_paths,
+    std::vector<std::string>* retained_paths) {
+  LocalManifestReader reader(info_log_, this);
+  std::set<uint64_t> file_nums;
+  std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo> infos;
+  auto st = reader.GetLiveFilesLocally(local_dbname, &file_nums, &infos);
+  if (!st.ok()) {
+    return st;
   }
+  // The top of the tree serves most reads and is the cheapest to fetch. The
+  // MANIFEST doesn't know the filter and index sizes, file size is the best
+  // proxy we have for how long a file takes.
+  std::vector<uint64_t> order(file_nums.begin(), file_nums.end());
+  std::sort(order.begin(), order.end(), [&infos](uint64_t a, uint64_t b) {
+    const auto& ia = infos[a];
+    const auto& ib = infos[b];
+    if (ia.level != ib.level) {
+      return ia.level < ib.level;
+    }
+    return ia.file_size < ib.file_size;
+  });
 
+  const IOOptions io_opts;
+  for (auto num : order) {
+    bool keep_local = cloud_fs_options.KeepLocalSstFile(infos[num].temperature);
+    if (!keep_local && retained_paths == nullptr) {
+      continue;
+    }
+    auto local_path = RemapFilename(MakeTableFileName(local_dbname, num));
+    bool exists =
+        base_fs_->FileExists(local_path, io_opts, nullptr /*dbg*/).ok();
+    if (!keep_local && exists) {
+      retained_paths->push_back(std::move(local_path));
+    } else if (keep_local && !exists) {
+      local_paths->push_back(std::move(local_path));
+    }
+  }
   return IOStatus::OK();
 }
 
+void CloudFileSystemImpl::LoadManifestChildren(const std::string& local_dbname,
+                                               bool new_db) {
+  if (!cloud_fs_options.getchildren_from_manifest) {
+    return;
+  }
+  std::unordered_set<std::string> children;
+  if (!new_db) {
+    LocalManifestReader reader(info_log_, this);
+    std::set<uint64_t> file_nums;
+    std::set<uint64_t> blob_file_nums;
+    auto st = reader.GetLiveFilesLocally(
+        local_dbname, &file_nums, nullptr /* infos */,
+        cloud_fs_options.cloud_blob_files ? &blob_file_nums : nullptr);
+    if (!st.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[cloud_fs_impl] LoadManifestChildren %s failed to read the live "
+          "files, GetChildren lists the cloud: %s",
+          local_dbname.c_str(), st.ToString().c_str());
+      return;
+    }
+    std::vector<std::string> sst_files;
+    RemapFileNumbers(file_nums, &sst_files);
+    for (auto& f : sst_files) {
+      children.insert(basename(f));
+    }
+    for (auto num : blob_file_nums) {
+      children.insert(basename(RemapFilename(BlobFileName("", num))));
+    }
+  }
+  std::lock_guard<std::mutex> lk(manifest_children_mutex_);
+  manifest_children_dir_ = ensure_ends_with_pathsep(local_dbname);
+  manifest_children_ = std::move(children);
+}
+
+bool CloudFileSystemImpl::GetManifestChildren(
+    const std::string& dir, std::vector<std::string>* result) {
+  if (!cloud_fs_options.getchildren_from_manifest) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lk(manifest_children_mutex_);
+  if (manifest_children_dir_.empty() ||
+      ensure_ends_with_pathsep(dir) != manifest_children_dir_) {
+    return false;
+  }
+  result->insert(result->end(), manifest_children_.begin(),
+                 manifest_children_.end());
+  // The one MANIFEST GetChildren would have kept
+  result->push_back(basename(
+      RemapFilename(ManifestFileWithEpoch("" /* dbname */, "" /* epoch */))));
+  return true;
+}
+
+void CloudFileSystemImpl::UpdateManifestChildren(const std::string& fname,
+                                                 bool created) {
+  if (!cloud_fs_options.getchildren_from_manifest) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(manifest_children_mutex_);
+  if (manifest_children_dir_.empty() ||
+      ensure_ends_with_pathsep(dirname(fname)) != manifest_children_dir_) {
+    return;
+  }
+  if (created) {
+    manifest_children_.insert(basename(fname));
+  } else {
+    manifest_children_.erase(basename(fname));
+  }
+}
+
+IOStatus CloudFileSystemImpl::HydrateLocalDirectory(
+    const std::string& local_dbname) {
+  bool hydrate = cloud_fs_options.keep_local_sst_files &&
+                 cloud_fs_options.sst_download_threads > 0;
+  if (!hydrate && !sst_retention_) {
+    return IOStatus::OK();
+  }
+  std::vector<std::string> local_paths;
+  std::vector<std::string> retained_paths;
+  auto st = FindLiveFilesToHydrate(local_dbname, &local_paths,
+                                   sst_retention_ ? &retained_paths : nullptr);
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+        "[cloud_fs_impl] HydrateLocalDirectory %s failed to list live files "
+        "%s",
+        local_dbname.c_str(), st.ToString().c_str());
+    // The retention pool just starts empty
+    return hydrate ? st : IOStatus::OK();
+  }
+  // Hottest files last, as the most recently used ones
+  for (auto it = retained_paths.rbegin(); it != retained_paths.rend(); ++it) {
+    st = RetainLocalSstFile(*it);
+    if (!st.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[cloud_fs_impl] HydrateLocalDirectory failed to retain %s: %s",
+          it->c_str(), st.ToString().c_str());
+    }
+  }
+  if (!hydrate || local_paths.empty()) {
+    return IOStatus::OK();
+  }
+  if (cloud_fs_options.hydrate_in_background) {
+    if (!hydrator_) {
+      hydrator_ = std::make_unique<CloudFileHydrator>(
+          transfer_executor_->NewThreadPool(CloudTransferExecutor::kHydrate),
+          [this](const std::string& local_path) {
+            return GetCloudObject(local_path);
+          },
+          base_fs_, info_log_.get());
+    }
+    hydrator_->Hydrate(local_paths);
+    return IOStatus::OK();
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[cloud_fs_impl] HydrateLocalDirectory downloading %" ROCKSDB_PRIszt
+      " sst files into %s with %d threads",
+      local_paths.size(), local_dbname.c_str(),
+      cloud_fs_options.sst_download_threads);
+
+  // The downloads start in order, so they follow the priority order
+  auto first_error = transfer_executor_->RunAll(
+      CloudTransferExecutor::kHydrate, local_paths.size(),
+      [&](size_t idx) { return GetCloudObject(local_paths[idx]); },
+      cloud_fs_options.sst_download_threads);
+  Log(first_error.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      info_log_, "[cloud_fs_impl] HydrateLocalDirectory %s done %s",
+      local_dbname.c_str(), first_error.ToString().c_str());
+  return first_error;
+}
+
 IOStatus CloudFileSystemImpl::FetchCloudManifest(
     const std::string& local_dbname) {
   return FetchCloudManifest(local_dbname, cloud_fs_options.cookie_on_open);
@@ -1909,6 +3324,9 @@ IOStatus CloudFileSystemImpl::CreateCloudManifest(
   if (st.ok()) {
     st = LoadLocalCloudManifest(local_dbname, cookie);
   }
+  if (st.ok()) {
+    LoadManifestChildren(local_dbname, true /* new_db */);
+  }
   return st;
 }
 
@@ -1932,6 +3350,26 @@ IOStatus CloudFileSystemImpl::RollNewEpoch(const std::string& local_dbname) {
     // uh oh
     return st;
   }
+  if (cloud_fs_options.prune_cloud_manifest_epochs) {
+    // The MANIFEST was fetched by GetMaxFileNumberFromManifest
+    LocalManifestReader reader(info_log_, this);
+    std::set<uint64_t> liveFileNumbers;
+    // The epochs of the live blob files in the cloud have to be kept too
+    std::set<uint64_t> liveBlobFileNumbers;
+    st = reader.GetLiveFilesLocally(
+        local_dbname, &liveFileNumbers, nullptr /* infos */,
+        cloud_fs_options.cloud_blob_files ? &liveBlobFileNumbers : nullptr);
+    if (!st.ok()) {
+      return st;
+    }
+    liveFileNumbers.insert(liveBlobFileNumbers.begin(),
+                           liveBlobFileNumbers.end());
+    auto pruned = cloud_manifest_->PruneEpochs(liveFileNumbers);
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] RollNewEpoch: pruned %" ROCKSDB_PRIszt
+        " epochs without live files from CLOUDMANIFEST",
+        pruned);
+  }
   // roll new epoch
   auto newEpoch = GenerateNewEpochId();
   // To make sure `RollNewEpoch` is backwards compatible, we don't change
@@ -1987,6 +3425,174 @@ IOStatus CloudFileSystemImpl::UploadCloudManifest(
   return st;
 }
 
+IOStatus CloudFileSystemImpl::RefreshFollowerManifest(
+    const std::string& local_dbname) {
+  if (!HasSrcBucket()) {
+    return IOStatus::InvalidArgument(
+        "Followers read the database of the leader from the src bucket");
+  }
+  assert(cloud_manifest_);
+  const auto& local_fs = GetBaseFileSystem();
+  const IOOptions io_opts;
+  IODebugContext* dbg = nullptr;
+  const auto& cookie = cloud_fs_options.cookie_on_open;
+  auto provider = GetStorageProvider();
+  std::string old_epoch = cloud_manifest_->GetCurrentEpoch();
+
+  // 1. Apply the epochs the leader added since ours
+  auto local_cloud_manifest = MakeCloudManifestFile(local_dbname, cookie);
+  auto tmp_cloud_manifest = local_cloud_manifest + ".tmp";
+  auto st = provider->GetCloudObject(
+      GetSrcBucketName(), MakeCloudManifestFile(GetSrcObjectPath(), cookie),
+      tmp_cloud_manifest);
+  std::unique_ptr<CloudManifest> leader;
+  if (st.ok()) {
+    std::unique_ptr<SequentialFileReader> reader;
+    st = SequentialFileReader::Create(local_fs, tmp_cloud_manifest,
+                                      FileOptions(), &reader, dbg,
+                                      nullptr /* rate_limiter */);
+    if (st.ok()) {
+      st = CloudManifest::LoadFromLog(std::move(reader), &leader);
+    }
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  if (leader->GetCurrentEpoch() != old_epoch) {
+    auto past_epochs = leader->GetPastEpochs();
+    auto it = std::find_if(
+        past_epochs.begin(), past_epochs.end(),
+        [&old_epoch](const std::pair<uint64_t, std::string>& pe) {
+          return pe.second == old_epoch;
+        });
+    if (it == past_epochs.end()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[cloud_fs_impl] RefreshFollowerManifest: CLOUDMANIFEST of the "
+          "leader no longer contains epoch %s",
+          old_epoch.c_str());
+      return IOStatus::Aborted(
+          "Epochs of the leader diverged, the follower has to be reopened");
+    }
+    // Each epoch starts where the previous one ended
+    for (; it != past_epochs.end(); ++it) {
+      auto next = std::next(it);
+      cloud_manifest_->AddEpoch(it->first, next == past_epochs.end()
+                                               ? leader->GetCurrentEpoch()
+                                               : next->second);
+    }
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] RefreshFollowerManifest: leader moved from epoch %s "
+        "to %s",
+        old_epoch.c_str(), cloud_manifest_->GetCurrentEpoch().c_str());
+  }
+  st = local_fs->RenameFile(tmp_cloud_manifest, local_cloud_manifest, io_opts,
+                            dbg);
+  if (!st.ok()) {
+    return st;
+  }
+
+  // 2. Bring the MANIFEST of the current epoch up to date
+  const auto& epoch = cloud_manifest_->GetCurrentEpoch();
+  auto local_manifest = ManifestFileWithEpoch(local_dbname, epoch);
+  auto cloud_manifest = ManifestFileWithEpoch(GetSrcObjectPath(), epoch);
+  uint64_t cloud_size = 0;
+  uint64_t local_size = 0;
+  bool reload = epoch != old_epoch;
+  if (!reload) {
+    st = provider->GetCloudObjectSize(GetSrcBucketName(), cloud_manifest,
+                                      &cloud_size);
+    if (!st.ok()) {
+      return st;
+    }
+    reload = !local_fs->GetFileSize(local_manifest, io_opts, &local_size, dbg)
+                  .ok() ||
+             cloud_size < local_size;
+  }
+  if (!reload && cloud_size == local_size) {
+    // No change
+    return IOStatus::OK();
+  }
+  if (!reload) {
+    // Read the new records along with the end of our copy. If the ends don't
+    // match, the leader started a new MANIFEST.
+    static const uint64_t kOverlapBytes = 4096;
+    auto overlap = std::min(local_size, kOverlapBytes);
+    auto offset = local_size - overlap;
+    std::unique_ptr<CloudStorageReadableFile> cloud_file;
+    st = provider->NewCloudReadableFile(GetSrcBucketName(), cloud_manifest,
+                                        FileOptions(), &cloud_file, dbg);
+    std::string cloud_data(static_cast<size_t>(cloud_size - offset), '\0');
+    Slice cloud_result;
+    if (st.ok()) {
+      st = static_cast<FSRandomAccessFile*>(cloud_file.get())
+               ->Read(offset, cloud_data.size(), io_opts, &cloud_result,
+                      &cloud_data[0], dbg);
+    }
+    std::unique_ptr<FSRandomAccessFile> local_file;
+    std::string local_data(static_cast<size_t>(overlap), '\0');
+    Slice local_result;
+    if (st.ok()) {
+      st = local_fs->NewRandomAccessFile(local_manifest, FileOptions(),
+                                         &local_file, dbg);
+    }
+    if (st.ok()) {
+      st = local_file->Read(offset, local_data.size(), io_opts, &local_result,
+                            &local_data[0], dbg);
+    }
+    if (!st.ok()) {
+      return st;
+    }
+    if (cloud_result.size() != cloud_data.size() ||
+        !cloud_result.starts_with(local_result)) {
+      reload = true;
+    } else {
+      std::unique_ptr<FSWritableFile> writer;
+      st = local_fs->ReopenWritableFile(local_manifest, FileOptions(), &writer,
+                                        dbg);
+      if (st.ok()) {
+        cloud_result.remove_prefix(local_result.size());
+        st = writer->Append(cloud_result, io_opts, dbg);
+      }
+      if (st.ok()) {
+        st = writer->Sync(io_opts, dbg);
+      }
+      if (st.ok()) {
+        st = writer->Close(io_opts, dbg);
+      }
+      return st;
+    }
+  }
+
+  // The secondary still reads the old file through its open handle, so the
+  // new one replaces it under a new CURRENT
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[cloud_fs_impl] RefreshFollowerManifest: downloading new MANIFEST-%s",
+      epoch.c_str());
+  auto tmp_manifest = local_manifest + ".tmp";
+  st = provider->GetCloudObject(GetSrcBucketName(), cloud_manifest,
+                                tmp_manifest);
+  if (st.ok()) {
+    st = local_fs->RenameFile(tmp_manifest, local_manifest, io_opts, dbg);
+  }
+  uint64_t manifest_number = 1;
+  if (st.ok()) {
+    std::string current;
+    if (ReadFileToString(local_fs.get(), CurrentFileName(local_dbname),
+                         &current)
+            .ok()) {
+      FileType type;
+      uint64_t number;
+      if (ParseFileName(rtrim_if(current, '\n'), &number, &type) &&
+          type == kDescriptorFile) {
+        manifest_number = number + 1;
+      }
+    }
+    st = SetCurrentFile(WriteOptions(), local_fs.get(), local_dbname,
+                        manifest_number, nullptr /* dir */);
+  }
+  return st;
+}
+
 IOStatus CloudFileSystemImpl::ApplyCloudManifestDelta(
     const CloudManifestDelta& delta, bool* delta_applied) {
   *delta_applied = cloud_manifest_->AddEpoch(delta.file_num, delta.epoch);
@@ -2021,9 +3627,6 @@ IOStatus CloudFileSystemImpl::RollNewCookie(
     return st;
   }
 
-  // TODO(igor): Compact cloud manifest by looking at live files in the database
-  // and removing epochs that don't contain any live files.
-
   TEST_SYNC_POINT_CALLBACK(
       "CloudFileSystemImpl::RollNewCookie:AfterManifestCopy", &st);
   if (!st.ok()) {
@@ -2137,18 +3740,28 @@ IOStatus CloudFileSystemImpl::GetDbidList(const std::string& bucket,
         bucket.c_str(), st.ToString().c_str());
     return st;
   }
-  // for each dbid, fetch the db directory where the db data should reside
-  for (auto dbid : dbid_list) {
-    std::string dirname;
-    st = GetPathForDbid(bucket, dbid, &dirname);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-          "[%s] %s GetDbidList error in GetPathForDbid(%s) %s", Name(),
-          bucket.c_str(), dbid.c_str(), st.ToString().c_str());
-      return st;
-    }
+  // for each dbid, fetch the db directory where the db data should reside.
+  // The registry holds one object per dbid, so their metadata are fetched
+  // in parallel.
+  std::vector<std::string> dirnames(dbid_list.size());
+  st = transfer_executor_->RunAll(
+      CloudTransferExecutor::kPurge, dbid_list.size(),
+      [&](size_t idx) {
+        auto s = GetPathForDbid(bucket, dbid_list[idx], &dirnames[idx]);
+        if (!s.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[%s] %s GetDbidList error in GetPathForDbid(%s) %s", Name(),
+              bucket.c_str(), dbid_list[idx].c_str(), s.ToString().c_str());
+        }
+        return s;
+      },
+      transfer_executor_->GetMaxRunning(CloudTransferExecutor::kPurge));
+  if (!st.ok()) {
+    return st;
+  }
+  for (size_t i = 0; i < dbid_list.size(); i++) {
     // insert item into result set
-    (*dblist)[dbid] = dirname;
+    (*dblist)[dbid_list[i]] = std::move(dirnames[i]);
   }
   return st;
 }
@@ -2318,6 +3931,12 @@ void CloudFileSystemImpl::TEST_InitEmptyCloudManifest() {
   CloudManifest::CreateForEmptyDatabase("", &cloud_manifest_);
 }
 
+void CloudFileSystemImpl::TEST_WaitForHydration() {
+  if (hydrator_) {
+    hydrator_->WaitForAll();
+  }
+}
+
 size_t CloudFileSystemImpl::TEST_NumScheduledJobs() const {
   return cloud_file_deletion_scheduler_
              ? cloud_file_deletion_scheduler_->TEST_NumScheduledJobs()
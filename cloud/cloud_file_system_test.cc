@@ -3,6 +3,8 @@
 #include "rocksdb/cloud/cloud_file_system.h"
 
 #include "cloud/cloud_log_controller_impl.h"
+#include "env/composite_env_wrapper.h"
+#include "file/file_util.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
@@ -238,6 +240,199 @@ TEST(CloudFileSystemTest, ConfigureKafkaController) {
 #endif
 }
 
+// Applies the records given to it rather than tailing a stream
+class TestLogController : public CloudLogControllerImpl {
+ public:
+  const char* Name() const override { return "test"; }
+  IOStatus CreateStream(const std::string& /*topic*/) override {
+    return IOStatus::OK();
+  }
+  IOStatus WaitForStreamReady(const std::string& /*topic*/) override {
+    return IOStatus::OK();
+  }
+  IOStatus TailStream() override { return IOStatus::OK(); }
+  CloudLogWritableFile* CreateWritableFile(const std::string& /*fname*/,
+                                           const FileOptions& /*options*/,
+                                           IODebugContext* /*dbg*/) override {
+    return nullptr;
+  }
+
+  using CloudLogControllerImpl::ApplyBatch;
+  using CloudLogControllerImpl::GetCachePath;
+
+  size_t NumCacheFds() {
+    std::lock_guard<std::mutex> lock(cache_fds_mutex_);
+    return cache_fds_.size();
+  }
+};
+
+TEST(CloudFileSystemTest, ApplyLogBatch) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  ConfigOptions config_options;
+  config_options.invoke_prepare_options = false;
+  ASSERT_OK(CloudFileSystemEnv::CreateFromString(
+      config_options,
+      "id=cloud; TEST=cloudenvtest:/test/path; cloud_log_apply_threads=3",
+      &cfs));
+  ASSERT_EQ(cfs->GetCloudFileSystemOptions().cloud_log_apply_threads, 3);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs.release())));
+  config_options.env = env.get();
+  TestLogController controller;
+  ASSERT_OK(controller.PrepareOptions(config_options));
+
+  std::vector<std::string> records(8);
+  // Contiguous appends, a hole and the close of a.log
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/a.log", "ab", 0,
+                                                   &records[0]);
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/b.log", "12", 0,
+                                                   &records[1]);
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/a.log", "cd", 2,
+                                                   &records[2]);
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/a.log", "x", 6,
+                                                   &records[3]);
+  CloudLogControllerImpl::SerializeLogRecordClosed("/db/a.log", 7,
+                                                   &records[4]);
+  // b.log is deleted while open
+  CloudLogControllerImpl::SerializeLogRecordDelete("/db/b.log", &records[5]);
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/c.log", "abc", 0,
+                                                   &records[6]);
+  records[7] = "garbage";
+  std::vector<Slice> batch(records.begin(), records.end());
+  // The bad record doesn't keep the others from being applied. The files
+  // are in the local cache directory.
+  ASSERT_TRUE(controller.ApplyBatch(batch).IsIOError());
+
+  std::string data;
+  ASSERT_OK(ReadFileToString(
+      Env::Default(), controller.GetCachePath("/db/a.log"), &data));
+  ASSERT_EQ(data, std::string("abcd\0\0x", 7));
+  ASSERT_TRUE(Env::Default()->FileExists(controller.GetCachePath("/db/b.log"))
+                  .IsNotFound());
+
+  // c.log stays open across batches
+  records.assign(2, "");
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/c.log", "de", 3,
+                                                   &records[0]);
+  CloudLogControllerImpl::SerializeLogRecordClosed("/db/c.log", 5,
+                                                   &records[1]);
+  ASSERT_OK(controller.ApplyBatch({records[0], records[1]}));
+  ASSERT_OK(ReadFileToString(
+      Env::Default(), controller.GetCachePath("/db/c.log"), &data));
+  ASSERT_EQ(data, "abcde");
+  ASSERT_OK(DestroyDir(Env::Default(), controller.GetCacheDir()));
+}
+
+TEST(CloudFileSystemTest, ApplyLogBatchBoundedFds) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  ConfigOptions config_options;
+  config_options.invoke_prepare_options = false;
+  ASSERT_OK(CloudFileSystemEnv::CreateFromString(
+      config_options,
+      "id=cloud; TEST=cloudenvtest:/test/path; cloud_log_max_open_files=2; "
+      "cloud_log_preallocation_size=4096",
+      &cfs));
+  ASSERT_EQ(cfs->GetCloudFileSystemOptions().cloud_log_max_open_files, 2);
+  ASSERT_EQ(cfs->GetCloudFileSystemOptions().cloud_log_preallocation_size,
+            4096u);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs.release())));
+  config_options.env = env.get();
+  TestLogController controller;
+  ASSERT_OK(controller.PrepareOptions(config_options));
+
+  // The least recently appended file is closed
+  const std::vector<std::string> fnames = {"/db/a.log", "/db/b.log",
+                                           "/db/c.log"};
+  std::string record;
+  for (const auto& fname : fnames) {
+    record.clear();
+    CloudLogControllerImpl::SerializeLogRecordAppend(fname, "abc", 0,
+                                                     &record);
+    ASSERT_OK(controller.ApplyBatch({record}));
+  }
+  ASSERT_EQ(controller.NumCacheFds(), 2u);
+
+  // and opened again by its next append, which crosses an extent
+  std::string data(5000, 'x');
+  record.clear();
+  CloudLogControllerImpl::SerializeLogRecordAppend(fnames[0], data, 3,
+                                                   &record);
+  ASSERT_OK(controller.ApplyBatch({record}));
+  ASSERT_EQ(controller.NumCacheFds(), 2u);
+
+  // The preallocated space is not part of the files
+  std::string contents;
+  ASSERT_OK(ReadFileToString(Env::Default(),
+                             controller.GetCachePath(fnames[0]), &contents));
+  ASSERT_EQ(contents, "abc" + data);
+  for (size_t i = 1; i < fnames.size(); i++) {
+    ASSERT_OK(ReadFileToString(Env::Default(),
+                               controller.GetCachePath(fnames[i]), &contents));
+    ASSERT_EQ(contents, "abc");
+  }
+  ASSERT_OK(DestroyDir(Env::Default(), controller.GetCacheDir()));
+}
+
+TEST(CloudFileSystemTest, ApplyLogBatchFromShards) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  ConfigOptions config_options;
+  config_options.invoke_prepare_options = false;
+  ASSERT_OK(CloudFileSystemEnv::CreateFromString(
+      config_options,
+      "id=cloud; TEST=cloudenvtest:/test/path; cloud_log_stream_shards=4; "
+      "cloud_log_consumer_name=follower",
+      &cfs));
+  ASSERT_EQ(cfs->GetCloudFileSystemOptions().cloud_log_stream_shards, 4);
+  ASSERT_EQ(cfs->GetCloudFileSystemOptions().cloud_log_consumer_name,
+            "follower");
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs.release())));
+  config_options.env = env.get();
+  TestLogController controller;
+  ASSERT_OK(controller.PrepareOptions(config_options));
+
+  // Like the tailers of a stream with a shard per file, each applying the
+  // records of its shard in small batches
+  constexpr int kShards = 4;
+  constexpr int kBatches = 50;
+  auto fname = [](int shard) {
+    return "/db/" + std::to_string(shard) + ".log";
+  };
+  std::vector<port::Thread> tailers;
+  std::atomic<int> errors{0};
+  for (int shard = 0; shard < kShards; shard++) {
+    tailers.emplace_back([&, shard]() {
+      for (int b = 0; b < kBatches; b++) {
+        std::vector<std::string> records(2);
+        CloudLogControllerImpl::SerializeLogRecordAppend(
+            fname(shard), "ab", 4 * b, &records[0]);
+        CloudLogControllerImpl::SerializeLogRecordAppend(
+            fname(shard), "cd", 4 * b + 2, &records[1]);
+        if (!controller.ApplyBatch({records[0], records[1]}).ok()) {
+          errors.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& tailer : tailers) {
+    tailer.join();
+  }
+  ASSERT_EQ(errors.load(), 0);
+
+  std::string expected;
+  for (int b = 0; b < kBatches; b++) {
+    expected += "abcd";
+  }
+  for (int shard = 0; shard < kShards; shard++) {
+    std::string data;
+    ASSERT_OK(ReadFileToString(Env::Default(),
+                               controller.GetCachePath(fname(shard)), &data));
+    ASSERT_EQ(data, expected);
+  }
+  ASSERT_OK(DestroyDir(Env::Default(), controller.GetCacheDir()));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
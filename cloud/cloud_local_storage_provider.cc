@@ -0,0 +1,895 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cinttypes>
+#include <climits>
+#include <mutex>
+#include <random>
+
+#include "cloud/filename.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/utilities/options_type.h"
+#include "util/crc32c.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+std::unordered_map<std::string, OptionTypeInfo>
+    local_storage_options_type_info = {
+        {"root",
+         {offsetof(struct LocalStorageOptions, root), OptionType::kString}},
+        {"request_latency_micros",
+         {offsetof(struct LocalStorageOptions, request_latency_micros),
+          OptionType::kUInt64T}},
+        {"latency_jitter_micros",
+         {offsetof(struct LocalStorageOptions, latency_jitter_micros),
+          OptionType::kUInt64T}},
+        {"tail_latency_probability",
+         {offsetof(struct LocalStorageOptions, tail_latency_probability),
+          OptionType::kDouble}},
+        {"tail_latency_micros",
+         {offsetof(struct LocalStorageOptions, tail_latency_micros),
+          OptionType::kUInt64T}},
+        {"bandwidth_bytes_per_sec",
+         {offsetof(struct LocalStorageOptions, bandwidth_bytes_per_sec),
+          OptionType::kUInt64T}},
+        {"error_probability",
+         {offsetof(struct LocalStorageOptions, error_probability),
+          OptionType::kDouble}},
+        {"seed",
+         {offsetof(struct LocalStorageOptions, seed), OptionType::kUInt64T}},
+};
+
+// Directories of root that are not buckets: bucket names can't start with
+// a dot
+const char* kMetadataDir = ".metadata";
+const char* kUploadsDir = ".uploads";
+const char* kTempDir = ".tmp";
+
+// Makes the requests of a provider behave like the requests to a remote
+// object store. Shared with the readable files, which can outlive the
+// provider.
+class LocalStorageSimulator {
+ public:
+  LocalStorageSimulator(const LocalStorageOptions& options,
+                        const std::shared_ptr<Statistics>& stats,
+                        const std::shared_ptr<CloudRequestCallback>& callback)
+      : options_(options), stats_(stats), callback_(callback),
+        rng_(options.seed) {}
+
+  // Runs op, a request of the given type on object, after the latency of
+  // the request. Fails it instead if it is drawn to fail. The bytes op sets
+  // take the time they take to transfer at the bandwidth of a request.
+  template <typename Op>
+  IOStatus Run(CloudRequestOpType type, const std::string& object, Op op) {
+    auto clock = SystemClock::Default();
+    auto start = clock->NowMicros();
+    uint64_t latency;
+    bool fail;
+    Draw(&latency, &fail);
+    Sleep(latency);
+    uint64_t bytes = 0;
+    IOStatus st = fail ? IOStatus::IOError(object, "Injected request failure")
+                       : op(&bytes);
+    if (st.IsPathNotFound()) {
+      // What the object store returns for missing objects
+      st = IOStatus::NotFound(object, st.ToString());
+    }
+    if (st.ok() && options_.bandwidth_bytes_per_sec > 0) {
+      Sleep(bytes * 1000000 / options_.bandwidth_bytes_per_sec);
+    }
+    auto micros = clock->NowMicros() - start;
+    if (callback_) {
+      (*callback_)(type, bytes, micros, st.ok());
+    }
+    CloudStorageProviderImpl::RecordRequest(stats_.get(), type, bytes, micros,
+                                            st.ok());
+    return st;
+  }
+
+ private:
+  void Draw(uint64_t* latency, bool* fail) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::lock_guard<std::mutex> lk(mutex_);
+    *latency = options_.request_latency_micros;
+    if (options_.latency_jitter_micros > 0) {
+      *latency += rng_() % (options_.latency_jitter_micros + 1);
+    }
+    if (options_.tail_latency_probability > 0 &&
+        uniform(rng_) < options_.tail_latency_probability) {
+      *latency += options_.tail_latency_micros;
+    }
+    *fail = options_.error_probability > 0 &&
+            uniform(rng_) < options_.error_probability;
+  }
+
+  static void Sleep(uint64_t micros) {
+    if (micros > 0) {
+      SystemClock::Default()->SleepForMicroseconds(
+          static_cast<int>(std::min<uint64_t>(micros, INT_MAX)));
+    }
+  }
+
+  const LocalStorageOptions options_;
+  const std::shared_ptr<Statistics> stats_;
+  const std::shared_ptr<CloudRequestCallback> callback_;
+  std::mutex mutex_;
+  std::mt19937_64 rng_;
+};
+
+class LocalReadableFile : public CloudStorageReadableFileImpl {
+ public:
+  LocalReadableFile(const std::shared_ptr<LocalStorageSimulator>& simulator,
+                    std::unique_ptr<FSRandomAccessFile>&& file,
+                    Logger* info_log, const std::string& bucket,
+                    const std::string& fname, uint64_t size,
+                    std::string content_hash)
+      : CloudStorageReadableFileImpl(info_log, bucket, fname, size),
+        simulator_(simulator),
+        file_(std::move(file)),
+        content_hash_(std::move(content_hash)) {}
+
+  const char* Name() const override {
+    return CloudStorageProviderImpl::kLocal();
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const override {
+    max_size = std::min(content_hash_.size(), max_size);
+    memcpy(id, content_hash_.c_str(), max_size);
+    return max_size;
+  }
+
+ protected:
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                       char* scratch, uint64_t* bytes_read,
+                       IODebugContext* dbg) const override {
+    *bytes_read = 0;
+    return simulator_->Run(
+        CloudRequestOpType::kReadOp, fname_, [&](uint64_t* bytes) {
+          Slice result;
+          auto st = file_->Read(offset, n, options, &result, scratch, dbg);
+          if (st.ok()) {
+            if (result.data() != scratch) {
+              memcpy(scratch, result.data(), result.size());
+            }
+            *bytes = *bytes_read = result.size();
+          }
+          return st;
+        });
+  }
+
+ private:
+  std::shared_ptr<LocalStorageSimulator> simulator_;
+  std::unique_ptr<FSRandomAccessFile> file_;
+  std::string content_hash_;
+};
+
+class LocalWritableFile : public CloudStorageWritableFileImpl {
+ public:
+  LocalWritableFile(CloudFileSystem* fs, const std::string& local_fname,
+                    const std::string& bucket, const std::string& cloud_fname,
+                    const FileOptions& options)
+      : CloudStorageWritableFileImpl(fs, local_fname, bucket, cloud_fname,
+                                     options) {}
+  const char* Name() const override {
+    return CloudStorageProviderImpl::kLocal();
+  }
+};
+
+class LocalStorageProvider : public CloudStorageProviderImpl {
+ public:
+  explicit LocalStorageProvider(const LocalStorageOptions& options)
+      : options_(options) {
+    RegisterOptions(&options_, &local_storage_options_type_info);
+  }
+  const char* Name() const override { return kLocal(); }
+  Status PrepareOptions(const ConfigOptions& options) override;
+
+  IOStatus CreateBucket(const std::string& bucket) override;
+  IOStatus ExistsBucket(const std::string& bucket) override;
+  IOStatus EmptyBucket(const std::string& bucket_name,
+                       const std::string& object_path) override;
+  IOStatus DeleteCloudObject(const std::string& bucket_name,
+                             const std::string& object_path) override;
+  IOStatus ListCloudObjects(const std::string& bucket_name,
+                            const std::string& object_path,
+                            std::vector<std::string>* result) override;
+  IOStatus ExistsCloudObject(const std::string& bucket_name,
+                             const std::string& object_path) override;
+  IOStatus GetCloudObjectSize(const std::string& bucket_name,
+                              const std::string& object_path,
+                              uint64_t* filesize) override;
+  IOStatus GetCloudObjectModificationTime(const std::string& bucket_name,
+                                          const std::string& object_path,
+                                          uint64_t* time) override;
+  IOStatus GetCloudObjectMetadata(const std::string& bucket_name,
+                                  const std::string& object_path,
+                                  CloudObjectInformation* info) override;
+  IOStatus PutCloudObjectMetadata(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata) override;
+  IOStatus CopyCloudObject(const std::string& bucket_name_src,
+                           const std::string& object_path_src,
+                           const std::string& bucket_name_dest,
+                           const std::string& object_path_dest) override;
+  IOStatus CreateMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata,
+      std::string* upload_id) override;
+  IOStatus CompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
+  IOStatus AbortMultipartUpload(const std::string& bucket_name,
+                                const std::string& object_path,
+                                const std::string& upload_id) override;
+
+ protected:
+  IOStatus DoNewCloudReadableFile(
+      const std::string& bucket, const std::string& fname, uint64_t fsize,
+      const std::string& content_hash, const FileOptions& options,
+      std::unique_ptr<CloudStorageReadableFile>* result,
+      IODebugContext* dbg) override;
+  IOStatus DoReadCloudObjectTail(const std::string& bucket_name,
+                                 const std::string& object_path, size_t n,
+                                 std::string* tail,
+                                 CloudObjectInformation* info) override;
+  IOStatus DoNewCloudWritableFile(
+      const std::string& local_path, const std::string& bucket_name,
+      const std::string& object_path, const FileOptions& options,
+      std::unique_ptr<CloudStorageWritableFile>* result,
+      IODebugContext* dbg) override;
+  IOStatus DoGetCloudObject(const std::string& bucket_name,
+                            const std::string& object_path,
+                            const std::string& local_path,
+                            uint64_t* remote_size) override;
+  IOStatus DoPutCloudObject(
+      const std::string& local_file, const std::string& bucket_name,
+      const std::string& object_path, uint64_t file_size,
+      const std::unordered_map<std::string, std::string>& metadata,
+      const std::string& storage_class) override;
+  IOStatus DoUploadPart(const std::string& bucket_name,
+                        const std::string& object_path,
+                        const std::string& upload_id, int part_number,
+                        const Slice& data, std::string* part_id) override;
+
+ private:
+  std::string BucketPath(const std::string& bucket) const {
+    return options_.root + "/" + bucket;
+  }
+  std::string ObjectPath(const std::string& bucket,
+                         const std::string& object) const {
+    return BucketPath(bucket) + "/" + ltrim_if(object, '/');
+  }
+  std::string MetadataPath(const std::string& bucket,
+                           const std::string& object) const {
+    return options_.root + "/" + kMetadataDir + "/" + bucket + "/" +
+           ltrim_if(object, '/');
+  }
+  std::string UploadPath(const std::string& upload_id) const {
+    return options_.root + "/" + kUploadsDir + "/" + upload_id;
+  }
+  // A unique name, for temporary files and upload ids
+  std::string NewId() {
+    return std::to_string(SystemClock::Default()->NowMicros()) + "-" +
+           std::to_string(next_id_.fetch_add(1, std::memory_order_relaxed));
+  }
+
+  // Creates dir and its missing parents
+  IOStatus CreateDirs(const std::string& dir);
+  // Copies src to dst, files of the base file system, and returns the
+  // number of bytes copied and their CRC32C
+  IOStatus CopyData(const std::string& src, const std::string& dst,
+                    uint64_t* size, uint32_t* crc32c);
+  // Moves a temporary file to path, whose directory may not exist yet
+  IOStatus Publish(const std::string& tmp, const std::string& path);
+  // Writes the object of path from src through a temporary file
+  IOStatus WriteObject(const std::string& src, const std::string& path,
+                       uint64_t* size);
+
+  // The metadata file of an object holds its content hash, then its
+  // metadata, one "key=value" per line, and its storage class, if any, on a
+  // line "@<storage class>". A new content hash is generated if content_hash
+  // is empty.
+  IOStatus WriteMetadata(
+      const std::string& bucket, const std::string& object,
+      std::string content_hash,
+      const std::unordered_map<std::string, std::string>& metadata,
+      const std::string& storage_class);
+  // Objects without a metadata file have an empty content hash, metadata and
+  // storage class
+  IOStatus ReadMetadata(const std::string& bucket, const std::string& object,
+                        std::string* content_hash,
+                        std::unordered_map<std::string, std::string>* metadata,
+                        std::string* storage_class);
+
+  // Appends to result the files under dir, with prefix
+  IOStatus ListFiles(const std::string& dir, const std::string& prefix,
+                     std::vector<std::string>* result);
+
+  LocalStorageOptions options_;
+  std::shared_ptr<FileSystem> fs_;
+  std::shared_ptr<LocalStorageSimulator> simulator_;
+  std::atomic<uint64_t> next_id_{0};
+};
+
+Status LocalStorageProvider::PrepareOptions(const ConfigOptions& options) {
+  // Set up before CloudStorageProviderImpl::PrepareOptions checks the buckets
+  auto cfs = dynamic_cast<CloudFileSystem*>(options.env->GetFileSystem().get());
+  assert(cfs);
+  if (options_.root.empty()) {
+    return Status::InvalidArgument(
+        "Local storage provider requires a root directory");
+  }
+  options_.root = rtrim_if(options_.root, '/');
+  fs_ = cfs->GetBaseFileSystem();
+  const auto& cfs_options = cfs->GetCloudFileSystemOptions();
+  simulator_ = std::make_shared<LocalStorageSimulator>(
+      options_, cfs_options.statistics, cfs_options.cloud_request_callback);
+  Header(cfs->GetLogger(),
+         "Local storage in %s: latency %" PRIu64 "us (+%" PRIu64
+         "us jitter, +%" PRIu64 "us for %.3f), bandwidth %" PRIu64
+         " bytes/s, errors %.3f",
+         options_.root.c_str(), options_.request_latency_micros,
+         options_.latency_jitter_micros, options_.tail_latency_micros,
+         options_.tail_latency_probability, options_.bandwidth_bytes_per_sec,
+         options_.error_probability);
+  auto st = CreateDirs(options_.root + "/" + kTempDir);
+  if (!st.ok()) {
+    return st;
+  }
+  return CloudStorageProviderImpl::PrepareOptions(options);
+}
+
+IOStatus LocalStorageProvider::CreateDirs(const std::string& dir) {
+  for (size_t pos = dir.find('/', 1);; pos = dir.find('/', pos + 1)) {
+    auto st = fs_->CreateDirIfMissing(dir.substr(0, pos), IOOptions(),
+                                      nullptr /*dbg*/);
+    if (!st.ok() || pos == std::string::npos) {
+      return st;
+    }
+  }
+}
+
+IOStatus LocalStorageProvider::CopyData(const std::string& src,
+                                        const std::string& dst, uint64_t* size,
+                                        uint32_t* crc32c) {
+  *size = 0;
+  *crc32c = 0;
+  std::unique_ptr<FSSequentialFile> in;
+  std::unique_ptr<FSWritableFile> out;
+  IODebugContext* dbg = nullptr;
+  auto st = fs_->NewSequentialFile(src, FileOptions(), &in, dbg);
+  if (st.ok()) {
+    st = fs_->NewWritableFile(dst, FileOptions(), &out, dbg);
+    if (st.IsPathNotFound()) {
+      // The object exists, the destination doesn't
+      st = IOStatus::IOError("Cannot create " + dst, st.ToString());
+    }
+  }
+  constexpr size_t kBufferSize = 1 << 20;
+  std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+  while (st.ok()) {
+    Slice chunk;
+    st = in->Read(kBufferSize, IOOptions(), &chunk, buffer.get(), dbg);
+    if (!st.ok() || chunk.empty()) {
+      break;
+    }
+    *crc32c = crc32c::Extend(*crc32c, chunk.data(), chunk.size());
+    *size += chunk.size();
+    st = out->Append(chunk, IOOptions(), dbg);
+  }
+  if (out) {
+    auto close_st = out->Close(IOOptions(), dbg);
+    if (st.ok()) {
+      st = close_st;
+    }
+  }
+  return st;
+}
+
+IOStatus LocalStorageProvider::Publish(const std::string& tmp,
+                                       const std::string& path) {
+  auto st = CreateDirs(dirname(path));
+  if (st.ok()) {
+    st = fs_->RenameFile(tmp, path, IOOptions(), nullptr /*dbg*/);
+  }
+  if (!st.ok()) {
+    fs_->DeleteFile(tmp, IOOptions(), nullptr /*dbg*/).PermitUncheckedError();
+  }
+  return st;
+}
+
+IOStatus LocalStorageProvider::WriteObject(const std::string& src,
+                                           const std::string& path,
+                                           uint64_t* size) {
+  auto tmp = options_.root + "/" + kTempDir + "/" + NewId();
+  uint32_t crc32c;
+  auto st = CopyData(src, tmp, size, &crc32c);
+  if (!st.ok()) {
+    fs_->DeleteFile(tmp, IOOptions(), nullptr /*dbg*/).PermitUncheckedError();
+    return st;
+  }
+  return Publish(tmp, path);
+}
+
+IOStatus LocalStorageProvider::WriteMetadata(
+    const std::string& bucket, const std::string& object,
+    std::string content_hash,
+    const std::unordered_map<std::string, std::string>& metadata,
+    const std::string& storage_class) {
+  if (content_hash.empty()) {
+    content_hash = NewId();
+  }
+  std::string data = content_hash + "\n";
+  for (const auto& m : metadata) {
+    data.append(m.first).append("=").append(m.second).append("\n");
+  }
+  if (!storage_class.empty()) {
+    data.append("@").append(storage_class).append("\n");
+  }
+  auto tmp = options_.root + "/" + kTempDir + "/" + NewId();
+  auto st = WriteStringToFile(fs_.get(), data, tmp, false /*should_sync*/);
+  if (st.ok()) {
+    st = Publish(tmp, MetadataPath(bucket, object));
+  }
+  return st;
+}
+
+IOStatus LocalStorageProvider::ReadMetadata(
+    const std::string& bucket, const std::string& object,
+    std::string* content_hash,
+    std::unordered_map<std::string, std::string>* metadata,
+    std::string* storage_class) {
+  content_hash->clear();
+  std::string data;
+  auto st = ReadFileToString(fs_.get(), MetadataPath(bucket, object), &data);
+  if (st.IsNotFound() || st.IsPathNotFound()) {
+    return IOStatus::OK();
+  } else if (!st.ok()) {
+    return st;
+  }
+  bool first = true;
+  for (const auto& line : StringSplit(data, '\n')) {
+    if (first) {
+      *content_hash = line;
+      first = false;
+      continue;
+    }
+    auto pos = line.find('=');
+    if (metadata != nullptr && pos != std::string::npos) {
+      (*metadata)[line.substr(0, pos)] = line.substr(pos + 1);
+    } else if (storage_class != nullptr && pos == std::string::npos &&
+               !line.empty() && line[0] == '@') {
+      *storage_class = line.substr(1);
+    }
+  }
+  return IOStatus::OK();
+}
+
+IOStatus LocalStorageProvider::ListFiles(const std::string& dir,
+                                         const std::string& prefix,
+                                         std::vector<std::string>* result) {
+  std::vector<std::string> children;
+  auto st = fs_->GetChildren(dir, IOOptions(), &children, nullptr /*dbg*/);
+  for (size_t i = 0; st.ok() && i < children.size(); i++) {
+    const auto& child = children[i];
+    if (child == "." || child == "..") {
+      continue;
+    }
+    bool is_dir = false;
+    st = fs_->IsDirectory(dir + "/" + child, IOOptions(), &is_dir,
+                          nullptr /*dbg*/);
+    if (st.ok() && is_dir) {
+      st = ListFiles(dir + "/" + child, prefix + child + "/", result);
+    } else if (st.ok()) {
+      result->push_back(prefix + child);
+    }
+  }
+  return st;
+}
+
+IOStatus LocalStorageProvider::CreateBucket(const std::string& bucket) {
+  return simulator_->Run(CloudRequestOpType::kCreateOp, bucket,
+                         [&](uint64_t* /*bytes*/) {
+                           return CreateDirs(BucketPath(bucket));
+                         });
+}
+
+IOStatus LocalStorageProvider::ExistsBucket(const std::string& bucket) {
+  return simulator_->Run(
+      CloudRequestOpType::kInfoOp, bucket, [&](uint64_t* /*bytes*/) {
+        bool is_dir = false;
+        auto st = fs_->FileExists(BucketPath(bucket), IOOptions(),
+                                  nullptr /*dbg*/);
+        if (st.ok()) {
+          st = fs_->IsDirectory(BucketPath(bucket), IOOptions(), &is_dir,
+                                nullptr /*dbg*/);
+        }
+        if (st.ok() && !is_dir) {
+          st = IOStatus::NotFound(bucket, "Not a bucket");
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::EmptyBucket(const std::string& bucket_name,
+                                           const std::string& object_path) {
+  std::vector<std::string> results;
+  auto st = ListCloudObjects(bucket_name, object_path, &results);
+  if (!st.ok()) {
+    return st;
+  }
+  for (auto& path : results) {
+    path = object_path + "/" + path;
+  }
+  return DeleteCloudObjects(bucket_name, results);
+}
+
+IOStatus LocalStorageProvider::DeleteCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
+  return simulator_->Run(
+      CloudRequestOpType::kDeleteOp, object_path, [&](uint64_t* /*bytes*/) {
+        auto st = fs_->DeleteFile(ObjectPath(bucket_name, object_path),
+                                  IOOptions(), nullptr /*dbg*/);
+        if (st.ok()) {
+          fs_->DeleteFile(MetadataPath(bucket_name, object_path), IOOptions(),
+                          nullptr /*dbg*/)
+              .PermitUncheckedError();
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::ListCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    std::vector<std::string>* result) {
+  return simulator_->Run(
+      CloudRequestOpType::kListOp, object_path, [&](uint64_t* /*bytes*/) {
+        auto dir = rtrim_if(ObjectPath(bucket_name, object_path), '/');
+        auto st = ListFiles(dir, "", result);
+        // As in S3, listing a prefix without objects is not an error
+        return st.IsNotFound() || st.IsPathNotFound() ? IOStatus::OK() : st;
+      });
+}
+
+IOStatus LocalStorageProvider::ExistsCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
+  return simulator_->Run(CloudRequestOpType::kInfoOp, object_path,
+                         [&](uint64_t* /*bytes*/) {
+                           return fs_->FileExists(
+                               ObjectPath(bucket_name, object_path),
+                               IOOptions(), nullptr /*dbg*/);
+                         });
+}
+
+IOStatus LocalStorageProvider::GetCloudObjectSize(
+    const std::string& bucket_name, const std::string& object_path,
+    uint64_t* filesize) {
+  return simulator_->Run(CloudRequestOpType::kInfoOp, object_path,
+                         [&](uint64_t* /*bytes*/) {
+                           return fs_->GetFileSize(
+                               ObjectPath(bucket_name, object_path),
+                               IOOptions(), filesize, nullptr /*dbg*/);
+                         });
+}
+
+IOStatus LocalStorageProvider::GetCloudObjectModificationTime(
+    const std::string& bucket_name, const std::string& object_path,
+    uint64_t* time) {
+  return simulator_->Run(
+      CloudRequestOpType::kInfoOp, object_path, [&](uint64_t* /*bytes*/) {
+        uint64_t seconds = 0;
+        auto st = fs_->GetFileModificationTime(
+            ObjectPath(bucket_name, object_path), IOOptions(), &seconds,
+            nullptr /*dbg*/);
+        // In milliseconds, as in S3
+        *time = seconds * 1000;
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::GetCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    CloudObjectInformation* info) {
+  return simulator_->Run(
+      CloudRequestOpType::kInfoOp, object_path, [&](uint64_t* /*bytes*/) {
+        auto path = ObjectPath(bucket_name, object_path);
+        uint64_t seconds = 0;
+        auto st = fs_->GetFileSize(path, IOOptions(), &info->size,
+                                   nullptr /*dbg*/);
+        if (st.ok()) {
+          st = fs_->GetFileModificationTime(path, IOOptions(), &seconds,
+                                            nullptr /*dbg*/);
+          info->modification_time = seconds * 1000;
+        }
+        if (st.ok()) {
+          st = ReadMetadata(bucket_name, object_path, &info->content_hash,
+                            &info->metadata, &info->storage_class);
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::PutCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata) {
+  // As in S3, the object is replaced by an empty one with this metadata
+  return simulator_->Run(
+      CloudRequestOpType::kWriteOp, object_path, [&](uint64_t* /*bytes*/) {
+        auto tmp = options_.root + "/" + kTempDir + "/" + NewId();
+        auto st = WriteStringToFile(fs_.get(), "", tmp, false /*should_sync*/);
+        if (st.ok()) {
+          st = Publish(tmp, ObjectPath(bucket_name, object_path));
+        }
+        if (st.ok()) {
+          st = WriteMetadata(bucket_name, object_path, "", metadata, "");
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::CopyCloudObject(
+    const std::string& bucket_name_src, const std::string& object_path_src,
+    const std::string& bucket_name_dest, const std::string& object_path_dest) {
+  return simulator_->Run(
+      CloudRequestOpType::kCopyOp, object_path_dest, [&](uint64_t* /*bytes*/) {
+        std::string content_hash;
+        std::unordered_map<std::string, std::string> metadata;
+        auto st = ReadMetadata(bucket_name_src, object_path_src, &content_hash,
+                               &metadata, nullptr /* storage_class */);
+        uint64_t size;
+        if (st.ok()) {
+          st = WriteObject(ObjectPath(bucket_name_src, object_path_src),
+                           ObjectPath(bucket_name_dest, object_path_dest),
+                           &size);
+        }
+        if (st.ok()) {
+          // As in S3, the copy is in the default storage class
+          st = WriteMetadata(bucket_name_dest, object_path_dest, content_hash,
+                             metadata, "");
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::CreateMultipartUpload(
+    const std::string& /*bucket_name*/, const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata,
+    std::string* upload_id) {
+  return simulator_->Run(
+      CloudRequestOpType::kCreateOp, object_path, [&](uint64_t* /*bytes*/) {
+        *upload_id = NewId();
+        auto st = CreateDirs(UploadPath(*upload_id));
+        if (st.ok() && !metadata.empty()) {
+          // Given to the object once completed, in the format of the
+          // metadata files
+          std::string data;
+          for (const auto& m : metadata) {
+            data.append(m.first).append("=").append(m.second).append("\n");
+          }
+          st = WriteStringToFile(fs_.get(), data,
+                                 UploadPath(*upload_id) + "/metadata",
+                                 false /*should_sync*/);
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::DoUploadPart(const std::string& /*bucket_name*/,
+                                            const std::string& object_path,
+                                            const std::string& upload_id,
+                                            int part_number, const Slice& data,
+                                            std::string* part_id) {
+  return simulator_->Run(
+      CloudRequestOpType::kWriteOp, object_path, [&](uint64_t* bytes) {
+        auto st = WriteStringToFile(
+            fs_.get(), data,
+            UploadPath(upload_id) + "/" + std::to_string(part_number),
+            false /*should_sync*/);
+        if (st.ok()) {
+          *part_id = ChecksumToString(crc32c::Value(data.data(), data.size()));
+          *bytes = data.size();
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::CompleteMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
+  return simulator_->Run(
+      CloudRequestOpType::kWriteOp, object_path, [&](uint64_t* /*bytes*/) {
+        std::unique_ptr<FSWritableFile> out;
+        auto tmp = options_.root + "/" + kTempDir + "/" + NewId();
+        auto st = fs_->NewWritableFile(tmp, FileOptions(), &out,
+                                       nullptr /*dbg*/);
+        for (size_t i = 0; st.ok() && i < part_ids.size(); i++) {
+          std::string part;
+          st = ReadFileToString(
+              fs_.get(), UploadPath(upload_id) + "/" + std::to_string(i + 1),
+              &part);
+          if (st.ok() &&
+              ChecksumToString(crc32c::Value(part.data(), part.size())) !=
+                  part_ids[i]) {
+            st = IOStatus::Corruption(object_path, "Mismatched upload part");
+          }
+          if (st.ok()) {
+            st = out->Append(part, IOOptions(), nullptr /*dbg*/);
+          }
+        }
+        if (out) {
+          auto close_st = out->Close(IOOptions(), nullptr /*dbg*/);
+          if (st.ok()) {
+            st = close_st;
+          }
+        }
+        if (st.ok()) {
+          st = Publish(tmp, ObjectPath(bucket_name, object_path));
+        } else {
+          fs_->DeleteFile(tmp, IOOptions(), nullptr /*dbg*/)
+              .PermitUncheckedError();
+        }
+        std::unordered_map<std::string, std::string> metadata;
+        if (st.ok()) {
+          // Absent if the upload has no metadata
+          std::string data;
+          if (ReadFileToString(fs_.get(), UploadPath(upload_id) + "/metadata",
+                               &data)
+                  .ok()) {
+            for (const auto& line : StringSplit(data, '\n')) {
+              auto pos = line.find('=');
+              if (pos != std::string::npos) {
+                metadata[line.substr(0, pos)] = line.substr(pos + 1);
+              }
+            }
+          }
+          st = WriteMetadata(bucket_name, object_path, "", metadata, "");
+        }
+        if (st.ok()) {
+          fs_->DeleteDir(UploadPath(upload_id), IOOptions(), nullptr /*dbg*/)
+              .PermitUncheckedError();
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::AbortMultipartUpload(
+    const std::string& /*bucket_name*/, const std::string& object_path,
+    const std::string& upload_id) {
+  return simulator_->Run(
+      CloudRequestOpType::kDeleteOp, object_path, [&](uint64_t* /*bytes*/) {
+        std::vector<std::string> parts;
+        auto st = ListFiles(UploadPath(upload_id), "", &parts);
+        for (const auto& part : parts) {
+          fs_->DeleteFile(UploadPath(upload_id) + "/" + part, IOOptions(),
+                          nullptr /*dbg*/)
+              .PermitUncheckedError();
+        }
+        if (st.ok()) {
+          st = fs_->DeleteDir(UploadPath(upload_id), IOOptions(),
+                              nullptr /*dbg*/);
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::DoNewCloudReadableFile(
+    const std::string& bucket, const std::string& fname, uint64_t fsize,
+    const std::string& content_hash, const FileOptions& options,
+    std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
+  std::unique_ptr<FSRandomAccessFile> file;
+  FileOptions file_opts(options);
+  // The object store is not read with the options of the local files
+  file_opts.use_direct_reads = false;
+  auto st =
+      fs_->NewRandomAccessFile(ObjectPath(bucket, fname), file_opts, &file, dbg);
+  if (st.ok()) {
+    result->reset(new LocalReadableFile(simulator_, std::move(file),
+                                        cfs_->GetLogger(), bucket, fname,
+                                        fsize, content_hash));
+  }
+  return st;
+}
+
+IOStatus LocalStorageProvider::DoReadCloudObjectTail(
+    const std::string& bucket_name, const std::string& object_path, size_t n,
+    std::string* tail, CloudObjectInformation* info) {
+  return simulator_->Run(
+      CloudRequestOpType::kReadOp, object_path, [&](uint64_t* bytes) {
+        auto path = ObjectPath(bucket_name, object_path);
+        auto st = fs_->GetFileSize(path, IOOptions(), &info->size,
+                                   nullptr /*dbg*/);
+        std::unique_ptr<FSRandomAccessFile> file;
+        if (st.ok()) {
+          st = fs_->NewRandomAccessFile(path, FileOptions(), &file,
+                                        nullptr /*dbg*/);
+        }
+        if (st.ok()) {
+          auto len = static_cast<size_t>(std::min<uint64_t>(n, info->size));
+          tail->resize(len);
+          Slice result;
+          st = file->Read(info->size - len, len, IOOptions(), &result,
+                          &(*tail)[0], nullptr /*dbg*/);
+          if (st.ok()) {
+            if (result.data() != tail->data()) {
+              memcpy(&(*tail)[0], result.data(), result.size());
+            }
+            tail->resize(result.size());
+            *bytes = result.size();
+          }
+        }
+        if (st.ok()) {
+          st = ReadMetadata(bucket_name, object_path, &info->content_hash,
+                            &info->metadata, &info->storage_class);
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::DoNewCloudWritableFile(
+    const std::string& local_path, const std::string& bucket_name,
+    const std::string& object_path, const FileOptions& file_opts,
+    std::unique_ptr<CloudStorageWritableFile>* result,
+    IODebugContext* /*dbg*/) {
+  result->reset(new LocalWritableFile(cfs_, local_path, bucket_name,
+                                      object_path, file_opts));
+  return (*result)->status();
+}
+
+IOStatus LocalStorageProvider::DoGetCloudObject(const std::string& bucket_name,
+                                                const std::string& object_path,
+                                                const std::string& local_path,
+                                                uint64_t* remote_size) {
+  return simulator_->Run(
+      CloudRequestOpType::kReadOp, object_path, [&](uint64_t* bytes) {
+        std::string content_hash;
+        std::unordered_map<std::string, std::string> metadata;
+        auto st = ReadMetadata(bucket_name, object_path, &content_hash,
+                               &metadata, nullptr /* storage_class */);
+        uint32_t crc32c = 0;
+        if (st.ok()) {
+          st = CopyData(ObjectPath(bucket_name, object_path), local_path,
+                        remote_size, &crc32c);
+        }
+        if (st.ok()) {
+          *bytes = *remote_size;
+          st = VerifyChecksum(object_path, metadata[kChecksumMetadataKey()],
+                              crc32c);
+        }
+        return st;
+      });
+}
+
+IOStatus LocalStorageProvider::DoPutCloudObject(
+    const std::string& local_file, const std::string& bucket_name,
+    const std::string& object_path, uint64_t /*file_size*/,
+    const std::unordered_map<std::string, std::string>& metadata,
+    const std::string& storage_class) {
+  return simulator_->Run(
+      CloudRequestOpType::kWriteOp, object_path, [&](uint64_t* bytes) {
+        auto st =
+            WriteObject(local_file, ObjectPath(bucket_name, object_path), bytes);
+        if (st.ok()) {
+          st = WriteMetadata(bucket_name, object_path, "", metadata,
+                             storage_class);
+        }
+        return st;
+      });
+}
+}  // namespace
+
+Status CloudStorageProviderImpl::CreateLocalProvider(
+    const LocalStorageOptions& options,
+    std::unique_ptr<CloudStorageProvider>* result) {
+  result->reset(new LocalStorageProvider(options));
+  return Status::OK();
+}
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,1403 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include "cloud/cloud_request_tracer.h"
+#include "cloud/filename.h"
+#include "cloud/manifest_reader.h"
+#include "file/file_util.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/cloud/cloud_compaction_service.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "rocksdb/cloud/db_cloud.h"
+#include "rocksdb/cloud/replication_bootstrap.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/file_checksum.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/sst_file_writer.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/table.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudLocalStorageProviderTest : public testing::Test {
+ public:
+  CloudLocalStorageProviderTest() {
+    test_dir_ = test::PerThreadDBPath("cloud_local_storage_provider_test");
+    root_ = test_dir_ + "/store";
+    local_dir_ = test_dir_ + "/local";
+    DestroyDir(Env::Default(), test_dir_).PermitUncheckedError();
+    EXPECT_OK(Env::Default()->CreateDirIfMissing(test_dir_));
+    EXPECT_OK(Env::Default()->CreateDirIfMissing(local_dir_));
+  }
+  ~CloudLocalStorageProviderTest() override {
+    cfs_.reset();
+    env_.reset();
+    DestroyDir(Env::Default(), test_dir_).PermitUncheckedError();
+  }
+
+  // Creates cfs_, whose provider stores in root_ with the given options
+  void CreateFileSystem(const std::string& provider_options = "",
+                        const std::string& fs_options = "",
+                        const std::string& buckets =
+                            "src={bucket=test;object=db};"
+                            "dest={bucket=test;object=db}") {
+    ConfigOptions config_options;
+    config_options.env = Env::Default();
+    ASSERT_OK(CloudFileSystemEnv::CreateFromString(
+        config_options,
+        fs_options + "provider={id=local;root=" + root_ + ";" +
+            provider_options + "};" + buckets,
+        &cfs_));
+    ASSERT_STREQ(cfs_->GetStorageProvider()->Name(),
+                 CloudStorageProviderImpl::kLocal());
+  }
+
+  std::string LocalFile(const std::string& name, const std::string& data) {
+    auto path = local_dir_ + "/" + name;
+    EXPECT_OK(WriteStringToFile(Env::Default(), data, path));
+    return path;
+  }
+
+  std::string test_dir_;
+  std::string root_;
+  std::string local_dir_;
+  std::unique_ptr<CloudFileSystem> cfs_;
+  std::unique_ptr<Env> env_;
+};
+
+TEST_F(CloudLocalStorageProviderTest, Objects) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto provider = cfs_->GetStorageProvider();
+  ASSERT_TRUE(provider->ExistsBucket("test").IsNotFound());
+  ASSERT_OK(provider->CreateBucket("test"));
+  ASSERT_OK(provider->ExistsBucket("test"));
+
+  ASSERT_OK(provider->PutCloudObject(LocalFile("a", "hello"), "test",
+                                     "db/000010.sst"));
+  ASSERT_OK(provider->PutCloudObject(LocalFile("b", "world!"), "test",
+                                     "db/sub/000011.sst"));
+  ASSERT_OK(provider->ExistsCloudObject("test", "db/000010.sst"));
+  ASSERT_TRUE(provider->ExistsCloudObject("test", "db/000012.sst").IsNotFound());
+  std::vector<std::string> children;
+  ASSERT_OK(provider->ListCloudObjects("test", "db", &children));
+  std::sort(children.begin(), children.end());
+  ASSERT_EQ(children,
+            std::vector<std::string>({"000010.sst", "sub/000011.sst"}));
+  children.clear();
+  ASSERT_OK(provider->ListCloudObjects("test", "none", &children));
+  ASSERT_TRUE(children.empty());
+  // The same objects in batches, until the callback fails
+  ASSERT_OK(provider->ListCloudObjectsInBatches(
+      "test", "db", [&](const std::vector<std::string>& batch) {
+        children.insert(children.end(), batch.begin(), batch.end());
+        return IOStatus::OK();
+      }));
+  std::sort(children.begin(), children.end());
+  ASSERT_EQ(children,
+            std::vector<std::string>({"000010.sst", "sub/000011.sst"}));
+  auto st = provider->ListCloudObjectsInBatches(
+      "test", "db", [](const std::vector<std::string>& /*batch*/) {
+        return IOStatus::Aborted();
+      });
+  ASSERT_TRUE(st.IsAborted());
+  children.clear();
+
+  CloudObjectInformation info;
+  ASSERT_OK(provider->GetCloudObjectMetadata("test", "db/sub/000011.sst",
+                                             &info));
+  ASSERT_EQ(info.size, 6u);
+  ASSERT_FALSE(info.content_hash.empty());
+  ASSERT_GT(info.modification_time, 0u);
+
+  std::string data;
+  auto copy = local_dir_ + "/copy";
+  ASSERT_OK(provider->GetCloudObject("test", "db/000010.sst", copy));
+  ASSERT_OK(ReadFileToString(Env::Default(), copy, &data));
+  ASSERT_EQ(data, "hello");
+
+  // Reads go through the provider too
+  std::unique_ptr<CloudStorageReadableFile> file;
+  ASSERT_OK(provider->NewCloudReadableFile("test", "db/sub/000011.sst",
+                                           FileOptions(), &file, nullptr));
+  char scratch[8];
+  Slice result;
+  FSRandomAccessFile* random_file = file.get();
+  ASSERT_OK(random_file->Read(2, 3, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), "rld");
+
+  // Copies keep the metadata
+  ASSERT_OK(provider->PutCloudObjectMetadata("test", "db/IDENTITY",
+                                             {{"dirname", "db"}}));
+  ASSERT_OK(provider->CopyCloudObject("test", "db/IDENTITY", "test",
+                                      "db2/IDENTITY"));
+  CloudObjectInformation copy_info;
+  ASSERT_OK(provider->GetCloudObjectMetadata("test", "db/IDENTITY", &info));
+  ASSERT_OK(provider->GetCloudObjectMetadata("test", "db2/IDENTITY",
+                                             &copy_info));
+  ASSERT_EQ(copy_info.size, 0u);
+  ASSERT_EQ(copy_info.metadata["dirname"], "db");
+  ASSERT_EQ(copy_info.content_hash, info.content_hash);
+
+  ASSERT_OK(provider->DeleteCloudObject("test", "db/000010.sst"));
+  ASSERT_TRUE(provider->DeleteCloudObject("test", "db/000010.sst").IsNotFound());
+  ASSERT_OK(provider->EmptyBucket("test", "db"));
+  children.clear();
+  ASSERT_OK(provider->ListCloudObjects("test", "db", &children));
+  ASSERT_TRUE(children.empty());
+}
+
+TEST_F(CloudLocalStorageProviderTest, MultipartUpload) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto provider = cfs_->GetStorageProvider();
+  ASSERT_OK(provider->CreateBucket("test"));
+  std::string upload_id;
+  ASSERT_OK(provider->CreateMultipartUpload("test", "db/big.sst",
+                                            {{"key", "value"}}, &upload_id));
+  std::vector<std::string> part_ids(2);
+  ASSERT_OK(provider->UploadPart("test", "db/big.sst", upload_id, 2, "world",
+                                 &part_ids[1]));
+  ASSERT_OK(provider->UploadPart("test", "db/big.sst", upload_id, 1, "hello ",
+                                 &part_ids[0]));
+  ASSERT_TRUE(provider->ExistsCloudObject("test", "db/big.sst").IsNotFound());
+  ASSERT_OK(provider->CompleteMultipartUpload("test", "db/big.sst", upload_id,
+                                              part_ids));
+  uint64_t size = 0;
+  ASSERT_OK(provider->GetCloudObjectSize("test", "db/big.sst", &size));
+  ASSERT_EQ(size, 11u);
+  CloudObjectInformation info;
+  ASSERT_OK(provider->GetCloudObjectMetadata("test", "db/big.sst", &info));
+  ASSERT_EQ(info.metadata["key"], "value");
+
+  ASSERT_OK(
+      provider->CreateMultipartUpload("test", "db/gone.sst", {}, &upload_id));
+  ASSERT_OK(provider->UploadPart("test", "db/gone.sst", upload_id, 1, "x",
+                                 &part_ids[0]));
+  ASSERT_OK(provider->AbortMultipartUpload("test", "db/gone.sst", upload_id));
+  ASSERT_TRUE(provider->ExistsCloudObject("test", "db/gone.sst").IsNotFound());
+}
+
+TEST_F(CloudLocalStorageProviderTest, EncryptedObjects) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "", "cloud_encryption_cipher=ROT13;cloud_object_checksums=true;"
+          "sst_open_tail_size=4096;"));
+  auto provider = cfs_->GetStorageProvider();
+  ASSERT_OK(provider->CreateBucket("test"));
+  Random rnd(301);
+  const auto data = rnd.RandomString(100000);
+  ASSERT_OK(provider->PutCloudObject(LocalFile("a", data), "test",
+                                     "db/000010.sst"));
+  ASSERT_OK(provider->PutCloudObject(LocalFile("b", data), "test",
+                                     "db/000011.sst"));
+  // Stored encrypted, at the size of the file, with IVs of their own
+  std::string stored;
+  std::string stored2;
+  ASSERT_OK(ReadFileToString(Env::Default(), root_ + "/test/db/000010.sst",
+                             &stored));
+  ASSERT_OK(ReadFileToString(Env::Default(), root_ + "/test/db/000011.sst",
+                             &stored2));
+  ASSERT_EQ(stored.size(), data.size());
+  ASSERT_NE(stored, data);
+  ASSERT_NE(stored, stored2);
+
+  // Decrypted by the downloads, which verify the checksum of the object
+  std::string downloaded;
+  auto copy = local_dir_ + "/copy";
+  ASSERT_OK(provider->GetCloudObject("test", "db/000010.sst", copy));
+  ASSERT_OK(ReadFileToString(Env::Default(), copy, &downloaded));
+  ASSERT_EQ(downloaded, data);
+
+  // And by the ranged reads, in the tail read on open too
+  std::unique_ptr<CloudStorageReadableFile> file;
+  ASSERT_OK(provider->NewCloudReadableFile("test", "db/000010.sst",
+                                           FileOptions(), &file, nullptr));
+  std::string scratch(1000, '\0');
+  Slice result;
+  FSRandomAccessFile* random_file = file.get();
+  for (uint64_t offset : {12345, 99000}) {
+    ASSERT_OK(random_file->Read(offset, 1000, IOOptions(), &result,
+                                &scratch[0], nullptr));
+    ASSERT_EQ(result.ToString(), data.substr(offset, 1000));
+  }
+
+  // Not readable without the cipher
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  provider = cfs_->GetStorageProvider();
+  ASSERT_TRUE(provider
+                  ->NewCloudReadableFile("test", "db/000010.sst",
+                                         FileOptions(), &file, nullptr)
+                  .IsInvalidArgument());
+}
+
+TEST_F(CloudLocalStorageProviderTest, RequestTrace) {
+  auto trace_file = test_dir_ + "/requests.trace";
+  ASSERT_NO_FATAL_FAILURE(
+      CreateFileSystem("", "request_trace_file=" + trace_file + ";"));
+  auto provider = cfs_->GetStorageProvider();
+  ASSERT_OK(provider->CreateBucket("test"));
+  ASSERT_OK(provider->PutCloudObject(LocalFile("a", "hello world"), "test",
+                                     "db/000010.sst"));
+  std::unique_ptr<CloudStorageReadableFile> file;
+  ASSERT_OK(provider->NewCloudReadableFile("test", "db/000010.sst",
+                                           FileOptions(), &file, nullptr));
+  char scratch[8];
+  Slice result;
+  FSRandomAccessFile* random_file = file.get();
+  ASSERT_OK(random_file->Read(6, 8, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), "world");
+  ASSERT_OK(provider->GetCloudObject("test", "db/000010.sst",
+                                     local_dir_ + "/copy"));
+  // Flushes the trace
+  file.reset();
+  cfs_.reset();
+
+  std::vector<CloudRequestTraceRecord> records;
+  ASSERT_OK(CloudRequestTracer::ReadTrace(FileSystem::Default(), trace_file,
+                                          &records));
+  ASSERT_EQ(records.size(), 4u);
+  for (const auto& record : records) {
+    ASSERT_TRUE(record.ok);
+    ASSERT_EQ(record.bucket, "test");
+    ASSERT_EQ(record.object, "db/000010.sst");
+  }
+  ASSERT_EQ(records[0].op, CloudRequestOpType::kWriteOp);
+  ASSERT_EQ(records[0].bytes, 11u);
+  ASSERT_EQ(records[1].op, CloudRequestOpType::kInfoOp);
+  ASSERT_EQ(records[1].length, 11u);
+  // The read is trimmed to the size of the object
+  ASSERT_EQ(records[2].op, CloudRequestOpType::kReadOp);
+  ASSERT_EQ(records[2].offset, 6u);
+  ASSERT_EQ(records[2].length, 5u);
+  ASSERT_EQ(records[2].bytes, 5u);
+  ASSERT_EQ(records[3].op, CloudRequestOpType::kReadOp);
+  ASSERT_EQ(records[3].offset, 0u);
+  ASSERT_EQ(records[3].bytes, 11u);
+}
+
+TEST_F(CloudLocalStorageProviderTest, InjectedFaults) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "request_latency_micros=20000;bandwidth_bytes_per_sec=1000000;"
+      "error_probability=0.5;seed=7"));
+  auto provider = cfs_->GetStorageProvider();
+  auto clock = SystemClock::Default();
+  auto start = clock->NowMicros();
+  int failed = 0;
+  for (int i = 0; i < 10; i++) {
+    auto st = provider->CreateBucket("test");
+    if (!st.ok()) {
+      ASSERT_TRUE(st.IsIOError());
+      failed++;
+    }
+  }
+  ASSERT_GE(clock->NowMicros() - start, 10u * 20000u);
+  ASSERT_GT(failed, 0);
+  ASSERT_LT(failed, 10);
+
+  // Transfers take their time at the bandwidth
+  auto local = LocalFile("big", std::string(100000, 'x'));
+  IOStatus st;
+  start = clock->NowMicros();
+  do {
+    st = provider->PutCloudObject(local, "test", "db/big.sst");
+  } while (!st.ok());
+  ASSERT_GE(clock->NowMicros() - start, 20000u + 100000u);
+}
+
+TEST_F(CloudLocalStorageProviderTest, OpenDB) {
+  auto open = [this](DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    Options options;
+    options.env = env_.get();
+    options.create_if_missing = true;
+    ASSERT_OK(DBCloud::Open(options, local_dir_ + "/db", "", 0, db));
+  };
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  delete db;
+  db = nullptr;
+
+  // The SST files are only in the store: the wiped local directory is
+  // restored from it
+  ASSERT_OK(DestroyDir(Env::Default(), local_dir_ + "/db"));
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, IncrementalCheckpoint) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto checkpoint = cfs_->GetCloudFileSystemOptions().dest_bucket;
+  checkpoint.SetObjectPath("ckpt");
+  auto* cfs = cfs_.get();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/db", "", 0, &db));
+  CheckpointToCloudOptions checkpoint_options;
+  checkpoint_options.incremental = true;
+  ASSERT_OK(db->Put(WriteOptions(), "a", "b"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->CheckpointToCloud(checkpoint, checkpoint_options));
+  ASSERT_OK(db->Put(WriteOptions(), "c", "d"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->CheckpointToCloud(checkpoint, checkpoint_options));
+
+  // The MANIFEST of the checkpoint identifies its files like the DB does
+  ManifestReader reader(options.info_log, cfs, checkpoint.GetBucketName());
+  std::string manifest;
+  ASSERT_OK(reader.GetCurrentManifestFile(checkpoint.GetObjectPath(),
+                                          &manifest));
+  std::set<uint64_t> list;
+  std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo> infos;
+  ASSERT_OK(reader.GetManifestLiveFilesFromCloud(manifest, &list, &infos));
+  ASSERT_EQ(list.size(), 2u);
+  std::set<uint64_t> local_list;
+  std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo> local_infos;
+  ASSERT_OK(reader.GetLiveFilesLocally(local_dir_ + "/db", &local_list,
+                                       &local_infos));
+  ASSERT_EQ(list, local_list);
+  for (auto number : list) {
+    ASSERT_NE(infos[number].unique_id, kNullUniqueId64x2);
+    ASSERT_EQ(infos[number].unique_id, local_infos[number].unique_id);
+    ASSERT_EQ(infos[number].file_checksum, local_infos[number].file_checksum);
+  }
+  delete db;
+
+  ASSERT_NO_FATAL_FAILURE(
+      CreateFileSystem("", "", "src={bucket=test;object=ckpt}"));
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  options.env = env_.get();
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/restored", "", 0, &db));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(db->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ(value, "d");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, IncrementalManifestRead) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto* cfs = cfs_.get();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/db", "", 0, &db));
+  ManifestReader reader(options.info_log, cfs, "test");
+  std::string manifest;
+  ASSERT_OK(reader.GetCurrentManifestFile("db", &manifest));
+  std::shared_ptr<CloudManifestReadState> state;
+  std::vector<uint64_t> list;
+  auto check_live_files = [&](size_t num_files) {
+    ASSERT_OK(reader.GetManifestLiveFilesIncrementally(manifest, &state,
+                                                       &list));
+    std::set<uint64_t> full_list;
+    ASSERT_OK(reader.GetManifestLiveFilesFromCloud(manifest, &full_list));
+    ASSERT_EQ(list, std::vector<uint64_t>(full_list.begin(), full_list.end()));
+    ASSERT_EQ(list.size(), num_files);
+  };
+  ASSERT_NO_FATAL_FAILURE(check_live_files(0));
+  auto* first_state = state.get();
+
+  // The records appended to the MANIFEST are read where the last read
+  // stopped
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+    ASSERT_NO_FATAL_FAILURE(check_live_files(i + 1));
+  }
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_NO_FATAL_FAILURE(check_live_files(1));
+  ASSERT_EQ(state.get(), first_state);
+  delete db;
+
+  // A rewritten MANIFEST is read from the start
+  ASSERT_OK(cfs->GetStorageProvider()->PutCloudObject(
+      LocalFile("garbage", std::string(100 << 10, 'x')), "test", manifest));
+  ASSERT_NOK(
+      reader.GetManifestLiveFilesIncrementally(manifest, &state, &list));
+  ASSERT_EQ(state, nullptr);
+}
+
+TEST_F(CloudLocalStorageProviderTest, CopyOnWriteClone) {
+  Options options;
+  options.create_if_missing = true;
+  auto open = [&](const std::string& dbname, const std::string& buckets,
+                  DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+        "", "keep_local_sst_files=false;copy_on_write_clones=true;",
+        buckets));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, local_dir_ + "/" + dbname, "", 0, db));
+  };
+  auto num_sst_objects = [&](const std::string& object_path) {
+    auto cfs = static_cast<CloudFileSystem*>(env_->GetFileSystem().get());
+    std::vector<std::string> objects;
+    EXPECT_OK(cfs->GetStorageProvider()->ListCloudObjects("test", object_path,
+                                                          &objects));
+    return std::count_if(
+        objects.begin(), objects.end(),
+        [](const std::string& object) { return IsSstFile(object); });
+  };
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(
+      "db", "src={bucket=test;object=db};dest={bucket=test;object=db}", &db));
+  ASSERT_OK(db->Put(WriteOptions(), "parent", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  delete db;
+
+  // The clone writes its own files only
+  ASSERT_NO_FATAL_FAILURE(open(
+      "clone", "src={bucket=test;object=db};dest={bucket=test;object=clone}",
+      &db));
+  ASSERT_OK(db->Put(WriteOptions(), "clone", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  delete db;
+  ASSERT_EQ(num_sst_objects("clone"), 1);
+
+  // A clone of the clone, reopened without its src, reads the files of both
+  ASSERT_NO_FATAL_FAILURE(open(
+      "clone2",
+      "src={bucket=test;object=clone};dest={bucket=test;object=clone2}", &db));
+  delete db;
+  ASSERT_OK(DestroyDir(Env::Default(), local_dir_ + "/clone2"));
+  ASSERT_NO_FATAL_FAILURE(open(
+      "clone2",
+      "src={bucket=test;object=clone2};dest={bucket=test;object=clone2}",
+      &db));
+  auto cfs = static_cast<CloudFileSystemImpl*>(env_->GetFileSystem().get());
+  ASSERT_EQ(cfs->GetCloneAncestors().size(), 2u);
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "parent", &value));
+  ASSERT_OK(db->Get(ReadOptions(), "clone", &value));
+  ASSERT_EQ(num_sst_objects("clone2"), 0);
+
+  // A savepoint copies them
+  ASSERT_OK(db->Savepoint());
+  ASSERT_EQ(num_sst_objects("clone2"), 2);
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, BackgroundSavepoint) {
+  Options options;
+  options.create_if_missing = true;
+  auto open = [&](const std::string& dbname, const std::string& buckets,
+                  DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(
+        CreateFileSystem("", "keep_local_sst_files=false;", buckets));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, local_dir_ + "/" + dbname, "", 0, db));
+  };
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(
+      "db", "src={bucket=test;object=db};dest={bucket=test;object=db}", &db));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+  }
+  delete db;
+
+  ASSERT_NO_FATAL_FAILURE(open(
+      "clone", "src={bucket=test;object=db};dest={bucket=test;object=clone}",
+      &db));
+  ASSERT_OK(db->StartSavepoint());
+  DBCloud::SavepointProgress progress;
+  db->GetSavepointProgress(&progress);
+  ASSERT_EQ(progress.num_files, 3u);
+  ASSERT_GT(progress.total_bytes, 0u);
+  ASSERT_OK(db->WaitForSavepoint());
+  db->GetSavepointProgress(&progress);
+  ASSERT_TRUE(progress.done);
+  ASSERT_EQ(progress.num_copied, 3u);
+  ASSERT_EQ(progress.copied_bytes, progress.total_bytes);
+
+  // The next savepoint finds the files in the destination
+  ASSERT_OK(db->Savepoint());
+  db->GetSavepointProgress(&progress);
+  ASSERT_EQ(progress.num_files, 0u);
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, ShardedDataObjectNames) {
+  const std::string fs_options =
+      "keep_local_sst_files=false;shard_data_object_names=true;";
+  Options options;
+  options.create_if_missing = true;
+  auto open = [&](const std::string& dbname, const std::string& buckets,
+                  DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem("", fs_options, buckets));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+  const std::string buckets =
+      "src={bucket=test;object=db};dest={bucket=test;object=db}";
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(local_dir_ + "/db", buckets, &db));
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+
+  // The SST object is in its shard directory, the other objects are not
+  auto cfs = static_cast<CloudFileSystem*>(env_->GetFileSystem().get());
+  std::vector<std::string> objects;
+  ASSERT_OK(
+      cfs->GetStorageProvider()->ListCloudObjects("test", "db", &objects));
+  size_t num_sst_objects = 0;
+  for (const auto& object : objects) {
+    auto name = RemoveObjectShard(object);
+    if (IsSstFile(RemoveEpoch(name))) {
+      num_sst_objects++;
+      ASSERT_EQ(object, ShardedObjectName(name));
+    } else {
+      ASSERT_EQ(object, name);
+    }
+  }
+  ASSERT_EQ(num_sst_objects, 1u);
+  // The DB sees the SST file under its name
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(local_dir_ + "/db", &children));
+  auto num_sst_files =
+      std::count_if(children.begin(), children.end(),
+                    [](const std::string& child) { return IsSstFile(child); });
+  ASSERT_EQ(num_sst_files, 1);
+
+  // A checkpoint has the same layout
+  auto checkpoint = cfs->GetCloudFileSystemOptions().dest_bucket;
+  checkpoint.SetObjectPath("ckpt");
+  CheckpointToCloudOptions checkpoint_options;
+  checkpoint_options.incremental = true;
+  ASSERT_OK(db->CheckpointToCloud(checkpoint, checkpoint_options));
+  ASSERT_OK(db->CheckpointToCloud(checkpoint, checkpoint_options));
+  delete db;
+  db = nullptr;
+
+  // The SST file is read from its shard directory
+  ASSERT_OK(DestroyDir(Env::Default(), local_dir_ + "/db"));
+  ASSERT_NO_FATAL_FAILURE(open(local_dir_ + "/db", buckets, &db));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+  db = nullptr;
+
+  ASSERT_NO_FATAL_FAILURE(open(local_dir_ + "/restored",
+                               "src={bucket=test;object=ckpt}", &db));
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, LowLatencyBucket) {
+  auto dbname = local_dir_ + "/db";
+  Options options;
+  options.create_if_missing = true;
+  options.num_levels = 3;
+  options.default_write_temperature = Temperature::kHot;
+  options.last_level_temperature = Temperature::kWarm;
+  auto open = [&](DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+        "",
+        "keep_local_sst_files=false;low_latency_bucket=fast;"
+        "low_latency_sst_temperatures=kHot;"));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+  auto list_ssts = [&](const std::string& bucket) {
+    auto cfs = static_cast<CloudFileSystem*>(env_->GetFileSystem().get());
+    std::vector<std::string> objects;
+    EXPECT_OK(
+        cfs->GetStorageProvider()->ListCloudObjects(bucket, "db", &objects));
+    std::vector<std::string> ssts;
+    std::copy_if(objects.begin(), objects.end(), std::back_inserter(ssts),
+                 [](const std::string& object) {
+                   return object.find(".sst") != std::string::npos;
+                 });
+    return ssts;
+  };
+
+  // A flushed file is hot, in the low-latency bucket
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  ASSERT_OK(db->Put(WriteOptions(), "a", "1"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_EQ(list_ssts("fast").size(), 1u);
+  ASSERT_TRUE(list_ssts("test").empty());
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "1");
+
+  // Compacted to the last level, its data is in the dest bucket
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1u);
+  ASSERT_EQ(files[0].temperature, Temperature::kWarm);
+  ASSERT_EQ(list_ssts("test").size(), 1u);
+  ASSERT_OK(db->Put(WriteOptions(), "b", "2"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  delete db;
+  db = nullptr;
+
+  // The files of both buckets are found without the local directory
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  ASSERT_OK(db->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "1");
+  ASSERT_OK(db->Get(ReadOptions(), "b", &value));
+  ASSERT_EQ(value, "2");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, IngestCloudObject) {
+  auto dbname = local_dir_ + "/db";
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem("", "keep_local_sst_files=false;"));
+  auto provider = cfs_->GetStorageProvider();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+
+  // An SST file produced offline, already in the bucket
+  auto sst = local_dir_ + "/offline.sst";
+  {
+    SstFileWriter writer{EnvOptions(), Options()};
+    ASSERT_OK(writer.Open(sst));
+    ASSERT_OK(writer.Put("a", "1"));
+    ASSERT_OK(writer.Put("b", "2"));
+    ASSERT_OK(writer.Finish());
+  }
+  ASSERT_OK(provider->PutCloudObject(sst, "test", "bulk/offline.sst"));
+  IngestExternalFileOptions ingest_options;
+  ingest_options.move_files = true;
+  ASSERT_OK(db->IngestExternalFile(
+      {CloudFileSystem::CloudObjectFilePath("test", "bulk/offline.sst")},
+      ingest_options));
+  // It was moved in the cloud, nothing is local
+  ASSERT_TRUE(
+      provider->ExistsCloudObject("test", "bulk/offline.sst").IsNotFound());
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(dbname, &children));
+  for (const auto& c : children) {
+    ASSERT_EQ(c.find(".sst"), std::string::npos);
+  }
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "1");
+  delete db;
+
+  // It is in the DB in the cloud
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  ASSERT_OK(db->Get(ReadOptions(), "b", &value));
+  ASSERT_EQ(value, "2");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, TieredPlacement) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "", "keep_local_sst_files=true;cloud_only_sst_temperatures=kCold;"));
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.num_levels = 3;
+  options.last_level_temperature = Temperature::kCold;
+  DBCloud* db = nullptr;
+  auto dbname = local_dir_ + "/db";
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  auto count_local_ssts = [&]() {
+    std::vector<std::string> children;
+    EXPECT_OK(Env::Default()->GetChildren(dbname, &children));
+    return std::count_if(children.begin(), children.end(),
+                         [](const std::string& c) {
+                           return c.find(".sst") != std::string::npos;
+                         });
+  };
+
+  // Flushed files are hot, in L0, and stay local
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_EQ(count_local_ssts(), 1);
+
+  // Compacted to the last level, they are cold, and only in the cloud
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1u);
+  ASSERT_EQ(files[0].temperature, Temperature::kCold);
+  ASSERT_EQ(count_local_ssts(), 0);
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+
+  // Reopening doesn't download them
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  ASSERT_EQ(count_local_ssts(), 0);
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, ColdStorageClass) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "",
+      "keep_local_sst_files=true;cloud_only_sst_temperatures=kCold;"
+      "cloud_only_sst_storage_class=STANDARD_IA;"));
+  auto provider = cfs_->GetStorageProvider();
+  CloudObjectInformation info;
+  ASSERT_OK(provider->PutCloudObjectInStorageClass(
+      LocalFile("a", "data"), "test", "db/a", "GLACIER_IR"));
+  ASSERT_OK(provider->GetCloudObjectMetadata("test", "db/a", &info));
+  ASSERT_EQ(info.storage_class, "GLACIER_IR");
+  ASSERT_EQ(info.size, 4u);
+  ASSERT_OK(provider->DeleteCloudObject("test", "db/a"));
+
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.num_levels = 3;
+  options.last_level_temperature = Temperature::kCold;
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/db", "", 0, &db));
+  auto sst_storage_classes = [&]() {
+    std::vector<std::string> objects;
+    EXPECT_OK(provider->ListCloudObjects("test", "db", &objects));
+    std::multiset<std::string> storage_classes;
+    for (const auto& object : objects) {
+      if (object.find(".sst") != std::string::npos) {
+        EXPECT_OK(
+            provider->GetCloudObjectMetadata("test", "db/" + object, &info));
+        storage_classes.insert(info.storage_class);
+      }
+    }
+    return storage_classes;
+  };
+
+  // Hot files are in the default storage class
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_EQ(sst_storage_classes(), std::multiset<std::string>{""});
+
+  // Cold ones in the configured one, and are still read from there
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(sst_storage_classes().count("STANDARD_IA"), 1u);
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, LocalSstRetention) {
+  auto dbname = local_dir_ + "/db";
+  Options options;
+  options.create_if_missing = true;
+  auto open = [&](const std::string& retention_bytes, DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+        "", "keep_local_sst_files=false;local_sst_retention_bytes=" +
+                retention_bytes + ";"));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+  auto count_local_ssts = [&]() {
+    std::vector<std::string> children;
+    EXPECT_OK(Env::Default()->GetChildren(dbname, &children));
+    return std::count_if(children.begin(), children.end(),
+                         [](const std::string& c) {
+                           return c.find(".sst") != std::string::npos;
+                         });
+  };
+
+  // Flushed files stay local after their upload
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open("1048576", &db));
+  ASSERT_OK(db->Put(WriteOptions(), "key", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_EQ(count_local_ssts(), 1);
+  delete db;
+
+  // A smaller pool evicts them, they are read from the cloud
+  ASSERT_NO_FATAL_FAILURE(open("1", &db));
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, "value");
+  delete db;
+  // Waits for the downloads into the pool
+  env_.reset();
+  ASSERT_EQ(count_local_ssts(), 0);
+}
+
+TEST_F(CloudLocalStorageProviderTest, BlobFiles) {
+  auto dbname = local_dir_ + "/db";
+  Options options;
+  options.create_if_missing = true;
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.blob_cache = NewLRUCache(1 << 20);
+  auto open = [&](DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem("", "cloud_blob_files=true;"));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+  auto blob_files = [](const std::vector<std::string>& names) {
+    std::vector<std::string> result;
+    std::copy_if(names.begin(), names.end(), std::back_inserter(result),
+                 [](const std::string& name) {
+                   return name.find(".blob") != std::string::npos;
+                 });
+    return result;
+  };
+
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  ASSERT_OK(db->Put(WriteOptions(), "key", std::string(1000, 'v')));
+  ASSERT_OK(db->Flush(FlushOptions()));
+
+  // The blob file is only in the cloud, with the epoch of its number
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(dbname, &children));
+  ASSERT_TRUE(blob_files(children).empty());
+  auto cfs = static_cast<CloudFileSystem*>(env_->GetFileSystem().get());
+  std::vector<std::string> objects;
+  ASSERT_OK(
+      cfs->GetStorageProvider()->ListCloudObjects("test", "db", &objects));
+  auto blob_objects = blob_files(objects);
+  ASSERT_EQ(blob_objects.size(), 1u);
+  const auto& object = blob_objects[0];
+  ASSERT_NE(object.find('-'), std::string::npos);
+  ASSERT_EQ(object, cfs->RemapFilename(object.substr(0, object.find('-'))));
+
+  // It is read from the cloud
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, std::string(1000, 'v'));
+  delete db;
+
+  // Blob files don't need to be local
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_NO_FATAL_FAILURE(open(&db));
+  ASSERT_OK(db->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ(value, std::string(1000, 'v'));
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, RemoteCompaction) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto dest_bucket = cfs_->GetCloudFileSystemOptions().dest_bucket;
+  auto provider = cfs_->GetStorageProvider();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  CloudCompactionWorkerOptions worker_options;
+  worker_options.cloud_fs_config = "provider={id=local;root=" + root_ + "}";
+  worker_options.local_dir = test_dir_ + "/worker";
+  int num_jobs = 0;
+  auto dispatcher = [&](const std::string& job, std::string* result) {
+    ++num_jobs;
+    auto st = CloudCompactionWorker::Run(worker_options, job, result);
+    return st.ok() ? CompactionServiceJobStatus::kSuccess
+                   : CompactionServiceJobStatus::kFailure;
+  };
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.compaction_service =
+      std::make_shared<CloudCompactionService>(dest_bucket, dispatcher);
+  auto dbname = local_dir_ + "/db";
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+  }
+
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(num_jobs, 1);
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1u);
+  ASSERT_GT(files[0].level, 0);
+  // The worker cleaned up after itself, and the output was moved
+  std::vector<std::string> children;
+  ASSERT_OK(Env::Default()->GetChildren(worker_options.local_dir, &children));
+  ASSERT_TRUE(children.empty());
+  children.clear();
+  ASSERT_OK(provider->ListCloudObjects(dest_bucket.GetBucketName(),
+                                       dest_bucket.GetObjectPath() +
+                                           "/remote_compaction",
+                                       &children));
+  ASSERT_TRUE(children.empty());
+  delete db;
+
+  // The output is in the cloud
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  for (int i = 0; i < 4; i++) {
+    std::string value;
+    ASSERT_OK(db->Get(ReadOptions(), "key" + std::to_string(i), &value));
+    ASSERT_EQ(value, "value");
+  }
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, RemoteCompactionInPlace) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto dest_bucket = cfs_->GetCloudFileSystemOptions().dest_bucket;
+  auto provider = cfs_->GetStorageProvider();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  CloudCompactionWorkerOptions worker_options;
+  worker_options.cloud_fs_config = "provider={id=local;root=" + root_ + "}";
+  worker_options.local_dir = test_dir_ + "/worker";
+  auto list_sst_objects = [&](const std::string& dir) {
+    std::vector<std::string> children;
+    EXPECT_OK(provider->ListCloudObjects(
+        dest_bucket.GetBucketName(), dest_bucket.GetObjectPath() + dir,
+        &children));
+    std::vector<std::string> sst_objects;
+    for (const auto& child : children) {
+      if (child.find(".sst") != std::string::npos) {
+        sst_objects.push_back(child);
+      }
+    }
+    return sst_objects;
+  };
+  size_t num_sst_objects = 0;
+  auto dispatcher = [&](const std::string& job, std::string* result) {
+    auto st = CloudCompactionWorker::Run(worker_options, job, result);
+    // The output went right among the SST files of the DB
+    EXPECT_TRUE(list_sst_objects("/remote_compaction").empty());
+    num_sst_objects = list_sst_objects("").size();
+    return st.ok() ? CompactionServiceJobStatus::kSuccess
+                   : CompactionServiceJobStatus::kFailure;
+  };
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.compaction_service = std::make_shared<CloudCompactionService>(
+      dest_bucket, dispatcher, 4 /* num_reserved_file_numbers */);
+  auto dbname = local_dir_ + "/db";
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+  }
+
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(num_sst_objects, 5u);
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1u);
+  ASSERT_GT(files[0].level, 0);
+  delete db;
+
+  // The output is in the cloud
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  for (int i = 0; i < 4; i++) {
+    std::string value;
+    ASSERT_OK(db->Get(ReadOptions(), "key" + std::to_string(i), &value));
+    ASSERT_EQ(value, "value");
+  }
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, CoalescedManifestUploads) {
+  ASSERT_NO_FATAL_FAILURE(
+      CreateFileSystem("", "manifest_upload_interval_millis=3600000;"));
+  auto dest_bucket = cfs_->GetCloudFileSystemOptions().dest_bucket;
+  auto provider = cfs_->GetStorageProvider();
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  auto dbname = local_dir_ + "/db";
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  std::vector<std::string> children;
+  ASSERT_OK(provider->ListCloudObjects(dest_bucket.GetBucketName(),
+                                       dest_bucket.GetObjectPath(),
+                                       &children));
+  auto it = std::find_if(
+      children.begin(), children.end(),
+      [](const std::string& c) { return c.rfind("MANIFEST", 0) == 0; });
+  ASSERT_TRUE(it != children.end());
+  const auto manifest = *it;
+  auto cloud_size = [&]() {
+    uint64_t size = 0;
+    EXPECT_OK(provider->GetCloudObjectSize(
+        dest_bucket.GetBucketName(),
+        dest_bucket.GetObjectPath() + "/" + manifest, &size));
+    return size;
+  };
+  // The new MANIFEST was uploaded on its first sync
+  const auto size_at_open = cloud_size();
+  ASSERT_GT(size_at_open, 0u);
+
+  // The flushes sync the MANIFEST within the interval
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+  }
+  ASSERT_EQ(cloud_size(), size_at_open);
+
+  // Closing uploads it
+  delete db;
+  uint64_t local_size = 0;
+  ASSERT_OK(Env::Default()->GetFileSize(dbname + "/" + manifest, &local_size));
+  ASSERT_GT(local_size, size_at_open);
+  ASSERT_EQ(cloud_size(), local_size);
+
+  // The cloud has the flushed files
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_OK(DBCloud::Open(options, dbname, "", 0, &db));
+  for (int i = 0; i < 3; i++) {
+    std::string value;
+    ASSERT_OK(db->Get(ReadOptions(), "key" + std::to_string(i), &value));
+    ASSERT_EQ(value, "value");
+  }
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, BlockCacheWarmUp) {
+  auto dbname = local_dir_ + "/db";
+  Options options;
+  options.create_if_missing = true;
+  auto open = [&](const std::string& fs_options, DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem("", fs_options));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = NewLRUCache(8 << 20);
+    table_options.block_size = 256;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    options.statistics = CreateDBStatistics();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+
+  // The leader reads some of its blocks, and saves their keys
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open("hot_block_keys_interval_secs=1;", &db));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i),
+                      std::string(100, 'v')));
+  }
+  ASSERT_OK(db->Flush(FlushOptions()));
+  for (int i = 0; i < 10; i++) {
+    std::string value;
+    ASSERT_OK(db->Get(ReadOptions(), "key" + std::to_string(i), &value));
+  }
+  const auto hot_blocks =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD);
+  ASSERT_GT(hot_blocks, 0u);
+  auto* cfs = dynamic_cast<CloudFileSystem*>(env_->GetFileSystem().get());
+  ASSERT_NE(cfs, nullptr);
+  auto storage = cfs->GetStorageProvider();
+  const auto bucket = cfs->GetDestBucketName();
+  const auto object = cfs->GetDestObjectPath() + "/HOTBLOCKKEYS";
+  for (int i = 0; i < 100 && !storage->ExistsCloudObject(bucket, object).ok();
+       i++) {
+    SystemClock::Default()->SleepForMicroseconds(100000);
+  }
+  ASSERT_OK(storage->ExistsCloudObject(bucket, object));
+  delete db;
+
+  // A new instance, with an empty local directory, reads them on open
+  ASSERT_OK(DestroyDir(Env::Default(), dbname));
+  ASSERT_NO_FATAL_FAILURE(open("block_cache_warmup_threads=2;", &db));
+  const auto warmed_blocks =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD);
+  ASSERT_GE(warmed_blocks, hot_blocks);
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "key0", &value));
+  ASSERT_EQ(options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD),
+            warmed_blocks);
+  delete db;
+}
+
+TEST_F(CloudLocalStorageProviderTest, TablePrefetch) {
+  auto dbname = local_dir_ + "/db";
+  Options options;
+  options.create_if_missing = true;
+  // The tables are not opened with their metadata on open
+  options.max_open_files = 100;
+  auto open = [&](const std::string& fs_options, DBCloud** db) {
+    ASSERT_NO_FATAL_FAILURE(CreateFileSystem("", fs_options));
+    env_ = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+    options.env = env_.get();
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = NewLRUCache(8 << 20);
+    table_options.block_size = 256;
+    table_options.metadata_block_size = 256;
+    table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+    table_options.partition_filters = true;
+    table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+    table_options.cache_index_and_filter_blocks = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    options.statistics = CreateDBStatistics();
+    ASSERT_OK(DBCloud::Open(options, dbname, "", 0, db));
+  };
+  auto metadata_blocks = [&]() {
+    return options.statistics->getTickerCount(BLOCK_CACHE_INDEX_ADD) +
+           options.statistics->getTickerCount(BLOCK_CACHE_FILTER_ADD);
+  };
+  auto read_all = [&](DBCloud* db) {
+    for (int i = 0; i < 200; i++) {
+      std::string value;
+      ASSERT_OK(db->Get(ReadOptions(), "key" + std::to_string(1000 + i),
+                        &value));
+    }
+  };
+
+  DBCloud* db = nullptr;
+  ASSERT_NO_FATAL_FAILURE(open("", &db));
+  for (int i = 0; i < 200; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(1000 + i),
+                      std::string(100, 'v')));
+    if (i % 100 == 99) {
+      ASSERT_OK(db->Flush(FlushOptions()));
+    }
+  }
+  delete db;
+
+  // Without the prefetch, the lookups load all the partitions
+  ASSERT_NO_FATAL_FAILURE(open("", &db));
+  ASSERT_EQ(metadata_blocks(), 0u);
+  ASSERT_NO_FATAL_FAILURE(read_all(db));
+  const auto all_blocks = metadata_blocks();
+  ASSERT_GT(all_blocks, 4u);
+  delete db;
+
+  // With it, they are all cached before the first lookup
+  ASSERT_NO_FATAL_FAILURE(open("table_prefetch_threads=2;", &db));
+  for (int i = 0; i < 100 && metadata_blocks() < all_blocks; i++) {
+    SystemClock::Default()->SleepForMicroseconds(100000);
+  }
+  ASSERT_EQ(metadata_blocks(), all_blocks);
+  ASSERT_NO_FATAL_FAILURE(read_all(db));
+  ASSERT_EQ(metadata_blocks(), all_blocks);
+  delete db;
+}
+
+namespace {
+// Keeps the replication log of a leader, with the record indexes as
+// replication sequences
+class TailListener : public ReplicationLogListener {
+ public:
+  std::string OnReplicationLogRecord(ReplicationLogRecord record) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto replication_sequence = std::to_string(records_.size());
+    records_.emplace_back(std::move(record), replication_sequence);
+    return replication_sequence;
+  }
+
+  std::vector<DB::ReplicationLogRecordAndSequence> Records(size_t from) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return {records_.begin() + from, records_.end()};
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<DB::ReplicationLogRecordAndSequence> records_;
+};
+}  // namespace
+
+TEST_F(CloudLocalStorageProviderTest, ReplicationBootstrap) {
+  auto listener = std::make_shared<TailListener>();
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem());
+  auto checkpoint = cfs_->GetCloudFileSystemOptions().dest_bucket;
+  checkpoint.SetObjectPath("ckpt");
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.atomic_flush = true;
+  options.replication_log_listener = listener;
+  DBCloud* leader = nullptr;
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/leader", "", 0, &leader));
+  WriteOptions wo;
+  wo.disableWAL = true;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_OK(leader->Put(wo, "key" + std::to_string(i), "flushed"));
+  }
+  ASSERT_OK(leader->Flush(FlushOptions()));
+  ASSERT_OK(leader->CheckpointToCloud(checkpoint, CheckpointToCloudOptions()));
+  for (int i = 5; i < 10; i++) {
+    ASSERT_OK(leader->Put(wo, "key" + std::to_string(i), "tail"));
+  }
+
+  // The follower opens the checkpoint while the whole log is added
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "", "sst_download_threads=2;hydrate_in_background=true;",
+      "src={bucket=test;object=ckpt}"));
+  auto follower_env = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options follower_options;
+  follower_options.env = follower_env.get();
+  follower_options.create_if_missing = true;
+  follower_options.atomic_flush = true;
+  ReplicationBootstrapOptions bootstrap_options;
+  bootstrap_options.cf_options_factory = [](Slice) {
+    return ColumnFamilyOptions();
+  };
+  std::unique_ptr<ReplicationBootstrap> bootstrap;
+  ASSERT_OK(ReplicationBootstrap::Start(
+      follower_options, local_dir_ + "/follower",
+      {ColumnFamilyDescriptor(kDefaultColumnFamilyName, ColumnFamilyOptions())},
+      "", 0, bootstrap_options, &bootstrap));
+  DB::ApplyReplicationLogRecordInfo info;
+  auto records = listener->Records(0);
+  for (auto& r : records) {
+    ASSERT_OK(bootstrap->AddRecord(r.first, r.second, &info));
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DBCloud* follower = nullptr;
+  ASSERT_OK(bootstrap->WaitForOpen(&info, &handles, &follower));
+  ASSERT_EQ(handles.size(), 1u);
+  ASSERT_TRUE(bootstrap->WaitForOpen(&info, &handles, &follower)
+                  .IsInvalidArgument());
+  // Only the writes after the checkpoint are applied
+  std::map<std::string, std::string> stats;
+  ASSERT_TRUE(
+      follower->GetMapProperty(DB::Properties::kReplicationStats, &stats));
+  ASSERT_EQ(stats["memtable-writes-applied"], "5");
+  ASSERT_GE(bootstrap->GetNumSkippedRecords(), 5u);
+
+  // The next records are applied right away
+  ASSERT_OK(leader->Put(wo, "key10", "tail"));
+  for (auto& r : listener->Records(records.size())) {
+    ASSERT_OK(bootstrap->AddRecord(r.first, r.second, &info));
+  }
+  for (int i = 0; i < 11; i++) {
+    std::string value;
+    ASSERT_OK(follower->Get(ReadOptions(), "key" + std::to_string(i), &value));
+    ASSERT_EQ(value, i < 5 ? "flushed" : "tail");
+  }
+
+  bootstrap.reset();
+  follower->DestroyColumnFamilyHandle(handles[0]);
+  delete follower;
+  delete leader;
+}
+
+TEST_F(CloudLocalStorageProviderTest, Scrub) {
+  ASSERT_NO_FATAL_FAILURE(CreateFileSystem(
+      "", "keep_local_sst_files=true;scrub_interval_secs=1;"));
+  env_ = CloudFileSystemEnv::NewCompositeEnv(
+      Env::Default(), std::shared_ptr<FileSystem>(cfs_.release()));
+  Options options;
+  options.env = env_.get();
+  options.create_if_missing = true;
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DBCloud* db = nullptr;
+  ASSERT_OK(DBCloud::Open(options, local_dir_ + "/db", "", 0, &db));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(i), "value"));
+  }
+  ASSERT_OK(db->Flush(FlushOptions()));
+  DBCloud::ScrubStats stats;
+  for (int i = 0; i < 100; i++) {
+    db->GetScrubStats(&stats);
+    if (stats.num_passes > 0) {
+      break;
+    }
+    SystemClock::Default()->SleepForMicroseconds(100000);
+  }
+  ASSERT_GT(stats.num_passes, 0u);
+  // The local copy and the object
+  ASSERT_GE(stats.num_verified, 2u);
+  ASSERT_EQ(stats.num_corrupted, 0u);
+
+  // A corrupted local copy is downloaded again
+  std::vector<LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1u);
+  auto path = local_dir_ + "/db/" + basename(files[0].name);
+  std::string contents;
+  ASSERT_OK(ReadFileToString(Env::Default(), path, &contents));
+  auto corrupted = contents;
+  corrupted[corrupted.size() / 2] ^= 0x55;
+  ASSERT_OK(WriteStringToFile(Env::Default(), corrupted, path));
+  std::string repaired;
+  for (int i = 0; i < 100; i++) {
+    db->GetScrubStats(&stats);
+    ASSERT_OK(ReadFileToString(Env::Default(), path, &repaired));
+    if (stats.num_repaired > 0 && repaired == contents) {
+      break;
+    }
+    SystemClock::Default()->SleepForMicroseconds(100000);
+  }
+  ASSERT_GE(stats.num_corrupted, 1u);
+  ASSERT_GE(stats.num_repaired, 1u);
+  ASSERT_EQ(repaired, contents);
+  delete db;
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudLocalStorageProviderTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
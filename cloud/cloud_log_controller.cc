@@ -7,14 +7,20 @@
 #include "rocksdb/cloud/cloud_log_controller.h"
 
 #include <cinttypes>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 #include "cloud/cloud_log_controller_impl.h"
+#include "cloud/cloud_log_tailer.h"
 #include "cloud/filename.h"
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/convenience.h"
+#include "rocksdb/memory_tracker.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "util/coding.h"
 #include "util/stderr_logger.h"
@@ -52,6 +58,15 @@ CloudLogControllerImpl::~CloudLogControllerImpl() {
         "CloudLogController closing.  Stopping stream.");
     StopTailingStream();
   }
+  if (apply_pool_ != nullptr) {
+    apply_pool_->JoinAllThreads();
+  }
+  {
+    std::lock_guard<std::mutex> lock(cache_fds_mutex_);
+    cache_fds_.clear();
+    cache_fds_lru_.clear();
+    ChargeCacheFds();
+  }
   if (env_ != nullptr) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
         "CloudLogController closed.");
@@ -82,6 +97,12 @@ Status CloudLogControllerImpl::PrepareOptions(const ConfigOptions& options) {
   if (status_.ok()) {
     status_ = base->CreateDirIfMissing(cache_dir_, io_opts, dbg);
   }
+  const int apply_threads =
+      cloud_fs_->GetCloudFileSystemOptions().cloud_log_apply_threads;
+  if (status_.ok() && apply_threads > 1 && apply_pool_ == nullptr) {
+    // The tailer thread applies a share of every batch itself
+    apply_pool_.reset(NewThreadPool(apply_threads - 1));
+  }
   if (status_.ok()) {
     status_ = StartTailingStream(cloud_fs_->GetSrcBucketName());
   }
@@ -135,106 +156,278 @@ bool CloudLogControllerImpl::ExtractLogRecord(
 }
 
 IOStatus CloudLogControllerImpl::Apply(const Slice& in) {
-  uint32_t operation;
-  uint64_t offset_in_file;
-  uint64_t file_size;
-  Slice original_pathname;
-  Slice payload;
+  return ApplyBatch(std::vector<Slice>(1, in));
+}
+
+IOStatus CloudLogControllerImpl::ApplyBatch(const std::vector<Slice>& records) {
   IOStatus st;
-  bool ret = ExtractLogRecord(in, &operation, &original_pathname,
-                              &offset_in_file, &file_size, &payload);
-  if (!ret) {
-    return IOStatus::IOError("Unable to parse payload from stream");
+  // Group the records by file, keeping their order
+  std::vector<FileRecords> files;
+  std::unordered_map<std::string, size_t> file_index;
+  for (const auto& in : records) {
+    LogRecord record;
+    Slice original_pathname;
+    if (!ExtractLogRecord(in, &record.operation, &original_pathname,
+                          &record.offset_in_file, &record.file_size,
+                          &record.payload)) {
+      if (st.ok()) {
+        st = IOStatus::IOError("Unable to parse payload from stream");
+      }
+      continue;
+    }
+    // Convert original pathname to a local file path.
+    std::string pathname = GetCachePath(original_pathname);
+    auto inserted = file_index.emplace(pathname, files.size());
+    if (inserted.second) {
+      files.emplace_back();
+      files.back().pathname = std::move(pathname);
+    }
+    files[inserted.first->second].records.push_back(record);
+  }
+
+  // The files own their descriptors while they are applied, so that the
+  // threads don't share cache_fds_
+  {
+    std::lock_guard<std::mutex> lock(cache_fds_mutex_);
+    for (auto& file : files) {
+      auto iter = cache_fds_.find(file.pathname);
+      if (iter != cache_fds_.end()) {
+        file.fd = std::move(iter->second.fd);
+        file.allocated_end = iter->second.allocated_end;
+        cache_fds_lru_.erase(iter->second.lru);
+        cache_fds_.erase(iter);
+      }
+    }
   }
 
-  // Convert original pathname to a local file path.
-  std::string pathname = GetCachePath(original_pathname);
+  std::vector<IOStatus> statuses(files.size());
+  if (apply_pool_ == nullptr || files.size() < 2) {
+    for (size_t i = 0; i < files.size(); i++) {
+      statuses[i] = ApplyFileRecords(&files[i]);
+    }
+  } else {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = files.size() - 1;
+    for (size_t i = 1; i < files.size(); i++) {
+      apply_pool_->SubmitJob([&, i]() {
+        statuses[i] = ApplyFileRecords(&files[i]);
+        std::lock_guard<std::mutex> lk(mutex);
+        if (--pending == 0) {
+          cv.notify_one();
+        }
+      });
+    }
+    // The tailer thread takes its share
+    statuses[0] = ApplyFileRecords(&files[0]);
+    std::unique_lock<std::mutex> lk(mutex);
+    cv.wait(lk, [&]() { return pending == 0; });
+  }
 
+  // Closed out of the lock
+  std::vector<std::unique_ptr<FSRandomRWFile>> evicted;
+  {
+    std::lock_guard<std::mutex> lock(cache_fds_mutex_);
+    for (size_t i = 0; i < files.size(); i++) {
+      if (files[i].fd) {
+        cache_fds_lru_.push_front(files[i].pathname);
+        auto& cache_fd = cache_fds_[files[i].pathname];
+        cache_fd.fd = std::move(files[i].fd);
+        cache_fd.allocated_end = files[i].allocated_end;
+        cache_fd.lru = cache_fds_lru_.begin();
+      }
+      if (st.ok() && !statuses[i].ok()) {
+        st = statuses[i];
+      }
+    }
+    // The least recently applied files are reopened if appended again
+    const int max_open_files =
+        cloud_fs_->GetCloudFileSystemOptions().cloud_log_max_open_files;
+    while (max_open_files > 0 &&
+           cache_fds_.size() > static_cast<size_t>(max_open_files)) {
+      auto iter = cache_fds_.find(cache_fds_lru_.back());
+      evicted.push_back(std::move(iter->second.fd));
+      cache_fds_.erase(iter);
+      cache_fds_lru_.pop_back();
+    }
+    ChargeCacheFds();
+  }
+  for (auto& fd : evicted) {
+    fd->Close(IOOptions(), nullptr /*dbg*/).PermitUncheckedError();
+  }
+  return st;
+}
+
+void CloudLogControllerImpl::ChargeCacheFds() {
+  // The map node, the pathname and a descriptor object of a few pointers,
+  // and the list node with a copy of the pathname
+  constexpr size_t kEntryOverhead =
+      4 * sizeof(void*) + sizeof(decltype(cache_fds_)::value_type) +
+      8 * sizeof(void*) + 2 * sizeof(void*) + sizeof(std::string);
+  size_t charge = 0;
+  for (const auto& entry : cache_fds_) {
+    charge += kEntryOverhead + 2 * entry.first.capacity();
+  }
+  auto* tracker =
+      MemoryTracker::Get(MemoryTrackerNames::kCloudLogController());
+  if (charge > cache_fds_charge_) {
+    tracker->Add(charge - cache_fds_charge_);
+  } else {
+    tracker->Release(cache_fds_charge_ - charge);
+  }
+  cache_fds_charge_ = charge;
+}
+
+IOStatus CloudLogControllerImpl::OpenCacheFile(
+    const std::string& pathname, std::unique_ptr<FSRandomRWFile>* result) {
   const FileOptions fo;
-  const IOOptions io_opts;
   IODebugContext* dbg = nullptr;
+  const auto& base = cloud_fs_->GetBaseFileSystem();
+  auto st = base->NewRandomRWFile(pathname, fo, result, dbg);
+  if (!st.ok()) {
+    // create the file
+    std::unique_ptr<FSWritableFile> tmp_writable_file;
+    base->NewWritableFile(pathname, fo, &tmp_writable_file, dbg);
+    tmp_writable_file.reset();
+    // Try again.
+    st = base->NewRandomRWFile(pathname, fo, result, dbg);
+  }
+  if (st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] Tailer: Successfully opened file %s and cached", Name(),
+        pathname.c_str());
+  }
+  return st;
+}
 
-  // Apply operation on cache file.
-  if (operation == kAppend) {
+void CloudLogControllerImpl::PreallocateCacheFile(FileRecords* file,
+                                                  uint64_t offset,
+                                                  uint64_t end) {
+  const uint64_t extent =
+      cloud_fs_->GetCloudFileSystemOptions().cloud_log_preallocation_size;
+  if (extent == 0) {
+    return;
+  }
+  // The extents of the append that are not allocated yet
+  const uint64_t start =
+      std::max(file->allocated_end, offset / extent * extent);
+  const uint64_t new_end = (end - 1) / extent * extent + extent;
+  // A random-RW file can't allocate, a writable file of the same path can.
+  // Allocate() keeps the size of the file, and Close() of a file that had
+  // no PrepareWrite() doesn't trim it.
+  std::unique_ptr<FSWritableFile> writable;
+  auto st = cloud_fs_->GetBaseFileSystem()->ReopenWritableFile(
+      file->pathname, FileOptions(), &writable, nullptr /*dbg*/);
+  if (st.ok()) {
+    st = writable->Allocate(start, new_end - start, IOOptions(),
+                            nullptr /*dbg*/);
+    writable->Close(IOOptions(), nullptr /*dbg*/).PermitUncheckedError();
+  }
+  if (!st.ok()) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] Tailer: Appending %ld bytes to %s at offset %" PRIu64, Name(),
-        payload.size(), pathname.c_str(), offset_in_file);
-
-    auto iter = cache_fds_.find(pathname);
-
-    // If this file is not yet open, open it and store it in cache.
-    if (iter == cache_fds_.end()) {
-      std::unique_ptr<FSRandomRWFile> result;
-      st = cloud_fs_->GetBaseFileSystem()->NewRandomRWFile(pathname, fo,
-                                                           &result, dbg);
-
-      if (!st.ok()) {
-        // create the file
-        std::unique_ptr<FSWritableFile> tmp_writable_file;
-        cloud_fs_->GetBaseFileSystem()->NewWritableFile(
-            pathname, fo, &tmp_writable_file, dbg);
-        tmp_writable_file.reset();
-        // Try again.
-        st = cloud_fs_->GetBaseFileSystem()->NewRandomRWFile(pathname, fo,
-                                                             &result, dbg);
-      }
+        "[%s] Tailer: Unable to preallocate %s up to %" PRIu64 ": %s", Name(),
+        file->pathname.c_str(), new_end, st.ToString().c_str());
+  }
+  // Not tried again for this extent if it failed
+  file->allocated_end = new_end;
+}
 
+IOStatus CloudLogControllerImpl::ApplyFileRecords(FileRecords* file) {
+  const IOOptions io_opts;
+  IODebugContext* dbg = nullptr;
+  const std::string& pathname = file->pathname;
+  const auto& records = file->records;
+  // The first error; the records after it are still applied, as they were
+  // when records were applied one at a time
+  IOStatus result;
+  std::string buffer;
+
+  for (size_t i = 0; i < records.size();) {
+    const auto& record = records[i];
+    IOStatus st;
+    if (record.operation == kAppend) {
+      // Coalesce the appends that continue where the previous one ended
+      size_t end = i + 1;
+      uint64_t next_offset = record.offset_in_file + record.payload.size();
+      while (end < records.size() && records[end].operation == kAppend &&
+             records[end].offset_in_file == next_offset) {
+        next_offset += records[end].payload.size();
+        end++;
+      }
+      Slice data = record.payload;
+      if (end > i + 1) {
+        buffer.clear();
+        buffer.reserve(next_offset - record.offset_in_file);
+        for (size_t j = i; j < end; j++) {
+          buffer.append(records[j].payload.data(), records[j].payload.size());
+        }
+        data = buffer;
+      }
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] Tailer: Appending %" ROCKSDB_PRIszt " bytes of %" ROCKSDB_PRIszt
+          " records to %s at offset %" PRIu64,
+          Name(), data.size(), end - i, pathname.c_str(),
+          record.offset_in_file);
+      i = end;
+
+      // If this file is not yet open, open it and store it in cache.
+      if (!file->fd) {
+        st = OpenCacheFile(pathname, &file->fd);
+      }
+      const uint64_t append_end = record.offset_in_file + data.size();
+      if (st.ok() && append_end > file->allocated_end) {
+        PreallocateCacheFile(file, record.offset_in_file, append_end);
+      }
       if (st.ok()) {
-        cache_fds_[pathname] = std::move(result);
+        st = file->fd->Write(record.offset_in_file, data, io_opts, dbg);
+        if (!st.ok()) {
+          Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+              "[%s] Tailer: Error writing to cached file %s: %s", Name(),
+              pathname.c_str(), st.ToString().c_str());
+        }
+      }
+    } else if (record.operation == kDelete) {
+      i++;
+      // Delete file from cache directory.
+      if (file->fd) {
         Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] Tailer: Successfully opened file %s and cached", Name(),
-            pathname.c_str());
-      } else {
-        return st;
+            "[%s] Tailer: Delete file %s, but it is still open."
+            " Closing it now..",
+            Name(), pathname.c_str());
+        file->fd->Close(io_opts, dbg);
+        file->fd.reset();
       }
-    }
+      file->allocated_end = 0;
 
-    FSRandomRWFile* fd = cache_fds_[pathname].get();
-    st = fd->Write(offset_in_file, payload, io_opts, dbg);
-    if (!st.ok()) {
-      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-          "[%s] Tailer: Error writing to cached file %s: %s", pathname.c_str(),
-          Name(), st.ToString().c_str());
-    }
-  } else if (operation == kDelete) {
-    // Delete file from cache directory.
-    auto iter = cache_fds_.find(pathname);
-    if (iter != cache_fds_.end()) {
+      st = cloud_fs_->GetBaseFileSystem()->DeleteFile(pathname, io_opts, dbg);
       Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-          "[%s] Tailer: Delete file %s, but it is still open."
-          " Closing it now..",
-          Name(), pathname.c_str());
-      FSRandomRWFile* fd = iter->second.get();
-      fd->Close(io_opts, dbg);
-      cache_fds_.erase(iter);
-    }
-
-    st = cloud_fs_->GetBaseFileSystem()->DeleteFile(pathname, io_opts, dbg);
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] Tailer: Deleted file: %s %s", Name(), pathname.c_str(),
-        st.ToString().c_str());
+          "[%s] Tailer: Deleted file: %s %s", Name(), pathname.c_str(),
+          st.ToString().c_str());
 
-    if (st.IsNotFound()) {
-      st = IOStatus::OK();
+      if (st.IsNotFound()) {
+        st = IOStatus::OK();
+      }
+    } else if (record.operation == kClosed) {
+      i++;
+      if (file->fd) {
+        st = file->fd->Close(io_opts, dbg);
+        file->fd.reset();
+      }
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] Tailer: Closed file %s %s", Name(), pathname.c_str(),
+          st.ToString().c_str());
+    } else {
+      i++;
+      st = IOStatus::IOError("Unknown operation");
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] Tailer: Unknown operation '%x': File %s %s", Name(),
+          record.operation, pathname.c_str(), st.ToString().c_str());
     }
-  } else if (operation == kClosed) {
-    auto iter = cache_fds_.find(pathname);
-    if (iter != cache_fds_.end()) {
-      FSRandomRWFile* fd = iter->second.get();
-      st = fd->Close(io_opts, dbg);
-      cache_fds_.erase(iter);
+    if (result.ok() && !st.ok()) {
+      result = st;
     }
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] Tailer: Closed file %s %s", Name(), pathname.c_str(),
-        st.ToString().c_str());
-  } else {
-    st = IOStatus::IOError("Unknown operation");
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] Tailer: Unknown operation '%x': File %s %s", Name(), operation,
-        pathname.c_str(), st.ToString().c_str());
   }
-
-  return st;
+  return result;
 }
 
 void CloudLogControllerImpl::SerializeLogRecordAppend(const Slice& filename,
@@ -277,13 +470,26 @@ void CloudLogControllerImpl::SerializeLogRecordDelete(
 }
 
 IOStatus CloudLogControllerImpl::StartTailingStream(const std::string& topic) {
-  if (tid_) {
+  if (tid_ || tailer_) {
     return IOStatus::Busy("Tailer already started");
   }
 
   auto st = CreateStream(topic);
   if (st.ok()) {
     running_ = true;
+    tailer_ = std::dynamic_pointer_cast<CloudLogTailerImpl>(
+        cloud_fs_->GetCloudFileSystemOptions().cloud_log_tailer);
+    if (tailer_) {
+      st = StartSharedTailing();
+      if (st.IsNotSupported()) {
+        tailer_.reset();
+        st = IOStatus::OK();
+      } else if (!st.ok()) {
+        StopTailingStream();
+      }
+    }
+  }
+  if (st.ok() && !tailer_) {
     // create tailer thread
     auto lambda = [this]() { TailStream(); };
     tid_.reset(new std::thread(lambda));
@@ -293,11 +499,22 @@ IOStatus CloudLogControllerImpl::StartTailingStream(const std::string& topic) {
 
 void CloudLogControllerImpl::StopTailingStream() {
   running_ = false;
+  for (auto id : tailer_streams_) {
+    tailer_->RemoveStream(id);
+  }
+  tailer_streams_.clear();
+  tailer_.reset();
   if (tid_ && tid_->joinable()) {
     tid_->join();
   }
   tid_.reset();
 }
+
+void CloudLogControllerImpl::AddTailerStream(
+    std::function<void(bool* idle, bool* done)> poll) {
+  assert(tailer_);
+  tailer_streams_.push_back(tailer_->AddStream(std::move(poll)));
+}
 //
 // Keep retrying the command until it is successful or the timeout has expired
 //
@@ -3,12 +3,18 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "rocksdb/cloud/cloud_log_controller.h"
 
 namespace ROCKSDB_NAMESPACE {
 class CloudFileSystem;
+class CloudLogTailerImpl;
+class ThreadPool;
 
 class CloudLogControllerImpl : public CloudLogController {
  public:
@@ -27,6 +33,10 @@ class CloudLogControllerImpl : public CloudLogController {
   static const uint32_t kDelete = 0x2;  // delete a log file
   static const uint32_t kClosed = 0x4;  // closing a file
 
+  // Largest number of records the tailers read from the stream before
+  // applying them
+  static constexpr size_t kMaxApplyBatch = 500;
+
   CloudLogControllerImpl();
   virtual ~CloudLogControllerImpl();
   static Status CreateKinesisController(
@@ -76,15 +86,80 @@ class CloudLogControllerImpl : public CloudLogController {
   CloudFileSystem* cloud_fs_;
   Status status_;
   std::string cache_dir_;
-  // A cache of pathnames to their open file _escriptors
-  std::map<std::string, std::unique_ptr<FSRandomRWFile>> cache_fds_;
+  // An open cache file
+  struct CacheFd {
+    std::unique_ptr<FSRandomRWFile> fd;
+    // The end of the space preallocated for the appends, as far as known
+    uint64_t allocated_end = 0;
+    // The position of the pathname in cache_fds_lru_
+    std::list<std::string>::iterator lru;
+  };
+  // Guards cache_fds_, cache_fds_lru_ and cache_fds_charge_
+  std::mutex cache_fds_mutex_;
+  // A cache of pathnames to their open file descriptors, at most
+  // cloud_log_max_open_files of them
+  std::map<std::string, CacheFd> cache_fds_;
+  // The pathnames of cache_fds_, the most recently applied first
+  std::list<std::string> cache_fds_lru_;
+  // The estimated memory of cache_fds_ charged to the
+  // MemoryTrackerNames::kCloudLogController() tracker
+  size_t cache_fds_charge_ = 0;
+  // Charges the tracker for the current content of cache_fds_. Requires
+  // cache_fds_mutex_.
+  void ChargeCacheFds();
 
   IOStatus Apply(const Slice& data);
+  // Applies a batch of records read from the stream. The records of a file
+  // are applied in stream order, with the data of contiguous appends written
+  // at once; different files are applied in parallel on
+  // cloud_log_apply_threads threads. Returns the first error.
+  // Thread safe, for tailers reading several partitions of the stream at
+  // once, provided that the records of a file all come from one partition.
+  IOStatus ApplyBatch(const std::vector<Slice>& records);
   bool IsRunning() const { return running_; }
 
+  // Has the shared cloud_log_tailer tail the stream instead of TailStream()
+  // on a thread of its own, adding the partitions of the stream to it with
+  // AddTailerStream(). Returns NotSupported if the controller can't.
+  virtual IOStatus StartSharedTailing() {
+    return IOStatus::NotSupported("Shared tailing");
+  }
+  // Has the shared tailer poll a partition of the stream until the tailing
+  // stops, see CloudLogTailerImpl::PollFunc
+  void AddTailerStream(std::function<void(bool* idle, bool* done)> poll);
+
  private:
+  struct LogRecord {
+    uint32_t operation;
+    uint64_t offset_in_file;
+    uint64_t file_size;
+    Slice payload;
+  };
+  // The records of a batch for one cache file, and its open descriptor
+  struct FileRecords {
+    std::string pathname;
+    std::vector<LogRecord> records;
+    std::unique_ptr<FSRandomRWFile> fd;
+    uint64_t allocated_end = 0;
+  };
+  // Applies the records of one file in order. Opens file->fd on demand and
+  // resets it once the file is closed or deleted.
+  IOStatus ApplyFileRecords(FileRecords* file);
+  IOStatus OpenCacheFile(const std::string& pathname,
+                         std::unique_ptr<FSRandomRWFile>* result);
+  // Preallocates the whole cloud_log_preallocation_size extents of the file
+  // that an append from offset to end falls in, so that the appends don't
+  // allocate blocks one at a time
+  void PreallocateCacheFile(FileRecords* file, uint64_t offset, uint64_t end);
+
+  // Applies batches on more than one thread, null if cloud_log_apply_threads
+  // is at most 1
+  std::unique_ptr<ThreadPool> apply_pool_;
   // Background thread to tail stream
   std::unique_ptr<std::thread> tid_;
+  // Or the shared tailer, and the ids of the partitions added to it
+  std::shared_ptr<CloudLogTailerImpl> tailer_;
+  std::vector<uint64_t> tailer_streams_;
   std::atomic<bool> running_;
 };
 }  // namespace ROCKSDB_NAMESPACE
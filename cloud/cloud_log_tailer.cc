@@ -0,0 +1,116 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "cloud/cloud_log_tailer.h"
+
+#include <algorithm>
+
+namespace ROCKSDB_NAMESPACE {
+
+constexpr std::chrono::milliseconds CloudLogTailerImpl::kIdleDelay;
+
+CloudLogTailerImpl::CloudLogTailerImpl(int num_threads,
+                                       std::chrono::microseconds idle_delay)
+    : idle_delay_(idle_delay) {
+  for (int i = 0; i < std::max(num_threads, 1); i++) {
+    threads_.emplace_back(&CloudLogTailerImpl::Run, this);
+  }
+}
+
+CloudLogTailerImpl::~CloudLogTailerImpl() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+size_t CloudLogTailerImpl::GetNumStreams() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return streams_.size();
+}
+
+uint64_t CloudLogTailerImpl::AddStream(PollFunc poll) {
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    id = next_id_++;
+    streams_[id].poll = std::move(poll);
+    due_.emplace(Clock::now(), id);
+  }
+  cv_.notify_one();
+  return id;
+}
+
+void CloudLogTailerImpl::RemoveStream(uint64_t id) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto it = streams_.find(id);
+  if (it == streams_.end()) {
+    // Done
+    return;
+  }
+  if (!it->second.polling) {
+    streams_.erase(it);
+    return;
+  }
+  it->second.removed = true;
+  removed_cv_.wait(lk, [&]() { return streams_.count(id) == 0; });
+}
+
+void CloudLogTailerImpl::Run() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (!shutdown_) {
+    if (due_.empty()) {
+      cv_.wait(lk);
+      continue;
+    }
+    if (due_.top().first > Clock::now()) {
+      cv_.wait_until(lk, due_.top().first);
+      continue;
+    }
+    const uint64_t id = due_.top().second;
+    due_.pop();
+    auto it = streams_.find(id);
+    if (it == streams_.end()) {
+      continue;
+    }
+    // Not in due_ while it is polled, so no other thread polls it. The map
+    // nodes are stable, and this one is not erased before the poll returns.
+    Stream* stream = &it->second;
+    stream->polling = true;
+    lk.unlock();
+    bool idle = false;
+    bool done = false;
+    stream->poll(&idle, &done);
+    lk.lock();
+    stream->polling = false;
+    if (stream->removed || done) {
+      const bool removed = stream->removed;
+      streams_.erase(id);
+      if (removed) {
+        removed_cv_.notify_all();
+      }
+      continue;
+    }
+    auto next = Clock::now();
+    if (idle) {
+      next += idle_delay_;
+    }
+    // No need to wake another thread, this one waits for it if it is due
+    // before the others
+    due_.emplace(next, id);
+  }
+}
+
+Status NewCloudLogTailer(int num_threads,
+                         std::shared_ptr<CloudLogTailer>* tailer) {
+  if (num_threads < 1) {
+    return Status::InvalidArgument("A log tailer needs a thread");
+  }
+  tailer->reset(new CloudLogTailerImpl(num_threads));
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,77 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cloud/cloud_log_tailer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudLogTailerImpl : public CloudLogTailer {
+ public:
+  // Polls a partition of a stream once, without blocking for long. Sets
+  // *idle if there was nothing new to read, so that the partition is polled
+  // again after the idle delay, and *done once there is nothing more to read
+  // from it, so that it is not polled anymore.
+  using PollFunc = std::function<void(bool* idle, bool* done)>;
+
+  static constexpr std::chrono::milliseconds kIdleDelay{50};
+
+  explicit CloudLogTailerImpl(
+      int num_threads,
+      std::chrono::microseconds idle_delay = kIdleDelay);
+  ~CloudLogTailerImpl() override;
+
+  const char* Name() const override { return "CloudLogTailer"; }
+  int GetNumThreads() const override {
+    return static_cast<int>(threads_.size());
+  }
+  size_t GetNumStreams() const override;
+
+  // Starts polling a partition with poll, right away. Returns the id to
+  // remove it with.
+  uint64_t AddStream(PollFunc poll);
+
+  // Stops polling the partition, once the poll in progress, if any, has
+  // returned. REQUIRES: not called from a PollFunc.
+  void RemoveStream(uint64_t id);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stream {
+    PollFunc poll;
+    bool polling = false;
+    // Set by RemoveStream() while it is polled
+    bool removed = false;
+  };
+
+  void Run();
+
+  const std::chrono::microseconds idle_delay_;
+  mutable std::mutex mutex_;
+  // Signaled when a stream is due earlier, or on shutdown
+  std::condition_variable cv_;
+  // Signaled when a removed stream has been polled for the last time
+  std::condition_variable removed_cv_;
+  std::unordered_map<uint64_t, Stream> streams_;
+  // When the streams are to be polled next, the earliest first. Removed
+  // streams are skipped.
+  std::priority_queue<std::pair<Clock::time_point, uint64_t>,
+                      std::vector<std::pair<Clock::time_point, uint64_t>>,
+                      std::greater<std::pair<Clock::time_point, uint64_t>>>
+      due_;
+  uint64_t next_id_ = 1;
+  bool shutdown_ = false;
+  std::vector<port::Thread> threads_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,120 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_log_tailer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+TEST(CloudLogTailerTest, PollsStreamsOneThreadEach) {
+  CloudLogTailerImpl tailer(2);
+  ASSERT_EQ(tailer.GetNumThreads(), 2);
+  constexpr int kStreams = 8;
+  constexpr int kPolls = 100;
+  std::atomic<int> polls[kStreams];
+  std::atomic<bool> polling[kStreams];
+  std::atomic<bool> concurrent{false};
+  std::vector<uint64_t> ids;
+  for (int i = 0; i < kStreams; i++) {
+    polls[i] = 0;
+    polling[i] = false;
+    ids.push_back(tailer.AddStream([&, i](bool* /*idle*/, bool* done) {
+      if (polling[i].exchange(true)) {
+        concurrent = true;
+      }
+      std::this_thread::yield();
+      polling[i] = false;
+      *done = ++polls[i] == kPolls;
+    }));
+  }
+  // The streams that are done are not polled anymore
+  while (tailer.GetNumStreams() > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (int i = 0; i < kStreams; i++) {
+    ASSERT_EQ(polls[i].load(), kPolls);
+    tailer.RemoveStream(ids[i]);
+  }
+  ASSERT_FALSE(concurrent.load());
+}
+
+TEST(CloudLogTailerTest, IdleDelay) {
+  CloudLogTailerImpl tailer(1, std::chrono::seconds(100));
+  std::atomic<int> idle_polls{0};
+  std::atomic<int> busy_polls{0};
+  auto idle_id = tailer.AddStream([&](bool* idle, bool* /*done*/) {
+    idle_polls++;
+    *idle = true;
+  });
+  // An idle stream doesn't hold back a busy one on the same thread
+  auto busy_id = tailer.AddStream([&](bool* /*idle*/, bool* done) {
+    *done = ++busy_polls == 10;
+  });
+  while (busy_polls < 10) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(idle_polls.load(), 1);
+  ASSERT_EQ(tailer.GetNumStreams(), 1u);
+  tailer.RemoveStream(idle_id);
+  tailer.RemoveStream(busy_id);
+  ASSERT_EQ(tailer.GetNumStreams(), 0u);
+}
+
+TEST(CloudLogTailerTest, RemoveWaitsForPoll) {
+  CloudLogTailerImpl tailer(1);
+  std::atomic<bool> started{false};
+  std::atomic<bool> release{false};
+  std::atomic<int> polls{0};
+  auto id = tailer.AddStream([&](bool* /*idle*/, bool* /*done*/) {
+    started = true;
+    while (!release) {
+      std::this_thread::yield();
+    }
+    polls++;
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  std::thread releaser([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    release = true;
+  });
+  tailer.RemoveStream(id);
+  // Returned after the poll, and no poll follows
+  ASSERT_EQ(polls.load(), 1);
+  releaser.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(polls.load(), 1);
+  ASSERT_EQ(tailer.GetNumStreams(), 0u);
+}
+
+TEST(CloudLogTailerTest, New) {
+  std::shared_ptr<CloudLogTailer> tailer;
+  ASSERT_TRUE(NewCloudLogTailer(0, &tailer).IsInvalidArgument());
+  ASSERT_OK(NewCloudLogTailer(3, &tailer));
+  ASSERT_EQ(tailer->GetNumThreads(), 3);
+  ASSERT_EQ(tailer->GetNumStreams(), 0u);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudLogTailerTest is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
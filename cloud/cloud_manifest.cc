@@ -33,11 +33,16 @@ enum class RecordTags : uint32_t {
 
 }  // namespace
 
-// Format:
+// Format (version 1):
 // header: format_version (varint) number of records (varint)
 // record: tag (varint, 1 or 2)
 // record 1: epoch (slice), file number
 // record 2: current epoch
+//
+// Format (version 2), a single record:
+// format_version (varint) number of past epochs (varint)
+// past epoch: file number minus the previous one (varint), epoch (slice)
+// current epoch (slice)
 IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
                                     std::unique_ptr<CloudManifest>* manifest) {
   Status status;
@@ -64,7 +69,27 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
       if (!ok) {
         return IOStatus::Corruption("Corruption in cloud manifest header");
       }
-      if (formatVersion != kCurrentFormatVersion) {
+      if (formatVersion == kCompactFormatVersion) {
+        // expectedRecords is the number of past epochs, all in this record
+        uint64_t fileNumber = 0;
+        for (uint32_t i = 0; ok && i < expectedRecords; i++) {
+          uint64_t delta;
+          Slice epoch;
+          ok = GetVarint64(&record, &delta) &&
+               GetLengthPrefixedSlice(&record, &epoch);
+          if (ok) {
+            fileNumber += delta;
+            pastEpochs.emplace_back(fileNumber, epoch.ToString());
+          }
+        }
+        Slice epoch;
+        if (!ok || !GetLengthPrefixedSlice(&record, &epoch)) {
+          return IOStatus::Corruption("Failed to read cloud manifest record");
+        }
+        currentEpoch = epoch.ToString();
+        // No more records expected
+        expectedRecords = 0;
+      } else if (formatVersion != kDefaultFormatVersion) {
         return IOStatus::Corruption("Unknown cloud manifest format version");
       }
       headerRead = true;
@@ -116,6 +141,28 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
   return status_to_io_status(std::move(status));
 }
 
+CloudManifest::CloudManifest(
+    std::vector<std::pair<uint64_t, std::string>> pastEpochs,
+    std::string currentEpoch) {
+  MutexLock lck(&mutex_);
+  std::unique_ptr<Snapshot> snapshot(new Snapshot());
+  snapshot->pastEpochs.reserve(pastEpochs.size());
+  for (auto& pe : pastEpochs) {
+    snapshot->pastEpochs.emplace_back(pe.first, Intern(std::move(pe.second)));
+  }
+  snapshot->currentEpoch = Intern(std::move(currentEpoch));
+  Publish(std::move(snapshot));
+}
+
+const std::string* CloudManifest::Intern(std::string epochId) {
+  return &*epochIds_.insert(std::move(epochId)).first;
+}
+
+void CloudManifest::Publish(std::unique_ptr<Snapshot> snapshot) {
+  snapshot_.store(snapshot.get(), std::memory_order_release);
+  snapshots_.emplace_back(std::move(snapshot));
+}
+
 IOStatus CloudManifest::CreateForEmptyDatabase(
     std::string currentEpoch, std::unique_ptr<CloudManifest>* manifest) {
   manifest->reset(new CloudManifest({}, std::move(currentEpoch)));
@@ -123,9 +170,14 @@ IOStatus CloudManifest::CreateForEmptyDatabase(
 }
 
 std::unique_ptr<CloudManifest> CloudManifest::clone() const {
-  ReadLock lck(&mutex_);
+  auto snapshot = GetSnapshot();
+  std::vector<std::pair<uint64_t, std::string>> pastEpochs;
+  pastEpochs.reserve(snapshot->pastEpochs.size());
+  for (auto& pe : snapshot->pastEpochs) {
+    pastEpochs.emplace_back(pe.first, *pe.second);
+  }
   return std::unique_ptr<CloudManifest>(
-      new CloudManifest(pastEpochs_, currentEpoch_));
+      new CloudManifest(std::move(pastEpochs), *snapshot->currentEpoch));
 }
 
 // Serialization format is quite simple:
@@ -138,26 +190,48 @@ std::unique_ptr<CloudManifest> CloudManifest::clone() const {
 // varint)
 //
 // Header comes first, and is followed with number_of_records Records.
-IOStatus CloudManifest::WriteToLog(
-    std::unique_ptr<WritableFileWriter> log) const {
+IOStatus CloudManifest::WriteToLog(std::unique_ptr<WritableFileWriter> log,
+                                   uint32_t formatVersion) const {
+  if (formatVersion != kDefaultFormatVersion &&
+      formatVersion != kCompactFormatVersion) {
+    return IOStatus::InvalidArgument("Unknown cloud manifest format version");
+  }
   log::Writer writer(std::move(log), 0, false);
   std::string record;
 
-  ReadLock lck(&mutex_);
+  auto snapshot = GetSnapshot();
+
+  if (formatVersion == kCompactFormatVersion) {
+    PutVarint32(&record, kCompactFormatVersion);
+    PutVarint32(&record, static_cast<uint32_t>(snapshot->pastEpochs.size()));
+    uint64_t fileNumber = 0;
+    for (auto& pe : snapshot->pastEpochs) {
+      PutVarint64(&record, pe.first - fileNumber);
+      PutLengthPrefixedSlice(&record, *pe.second);
+      fileNumber = pe.first;
+    }
+    PutLengthPrefixedSlice(&record, *snapshot->currentEpoch);
+    auto status = writer.AddRecord({}, record);
+    if (!status.ok()) {
+      return status;
+    }
+    return writer.file()->Sync({}, true);
+  }
 
   // 1. write header
-  PutVarint32(&record, kCurrentFormatVersion);
-  PutVarint32(&record, static_cast<uint32_t>(pastEpochs_.size() + 1));
+  PutVarint32(&record, kDefaultFormatVersion);
+  PutVarint32(&record,
+              static_cast<uint32_t>(snapshot->pastEpochs.size() + 1));
   auto status = writer.AddRecord({}, record);
   if (!status.ok()) {
     return status;
   }
 
   // 2. put past epochs
-  for (auto& pe : pastEpochs_) {
+  for (auto& pe : snapshot->pastEpochs) {
     record.clear();
     PutVarint32(&record, static_cast<uint32_t>(RecordTags::kPastEpoch));
-    PutLengthPrefixedSlice(&record, pe.second);
+    PutLengthPrefixedSlice(&record, *pe.second);
     PutVarint64(&record, pe.first);
     status = writer.AddRecord({}, record);
     if (!status.ok()) {
@@ -168,7 +242,7 @@ IOStatus CloudManifest::WriteToLog(
   // 3. put current epoch
   record.clear();
   PutVarint32(&record, static_cast<uint32_t>(RecordTags::kCurrentEpoch));
-  PutLengthPrefixedSlice(&record, currentEpoch_);
+  PutLengthPrefixedSlice(&record, *snapshot->currentEpoch);
 
   status = writer.AddRecord({}, record);
   if (!status.ok()) {
@@ -178,66 +252,103 @@ IOStatus CloudManifest::WriteToLog(
 }
 
 bool CloudManifest::AddEpoch(uint64_t startFileNumber, std::string epochId) {
-  WriteLock lck(&mutex_);
-  if (!pastEpochs_.empty() && startFileNumber < pastEpochs_.back().first) {
+  MutexLock lck(&mutex_);
+  auto current = GetSnapshot();
+  const auto& pastEpochs = current->pastEpochs;
+  if (!pastEpochs.empty() && startFileNumber < pastEpochs.back().first) {
     return false;
   }
 
   // Check all the epochs with same file number
-  // For each (filenum, epoch) pair in `pastEpochs_`, it means next epoch of `epoch`
+  // For each (filenum, epoch) pair in `pastEpochs`, it means next epoch of `epoch`
   // starts at `filenum`. So we should compare epochId with next epoch of `epoch`.
-  auto nxtEpoch = &currentEpoch_;
-  for (auto rit = pastEpochs_.rbegin(); rit != pastEpochs_.rend(); rit++) {
+  auto nxtEpoch = current->currentEpoch;
+  for (auto rit = pastEpochs.rbegin(); rit != pastEpochs.rend(); rit++) {
     if (rit->first == startFileNumber && *nxtEpoch == epochId) {
       return false;
     }
     if (rit->first < startFileNumber) {
       break;
     }
-    nxtEpoch = &(rit->second);
+    nxtEpoch = rit->second;
   }
 
-  pastEpochs_.emplace_back(startFileNumber, std::move(currentEpoch_));
-  currentEpoch_ = std::move(epochId);
+  std::unique_ptr<Snapshot> snapshot(new Snapshot());
+  snapshot->pastEpochs.reserve(pastEpochs.size() + 1);
+  snapshot->pastEpochs.insert(snapshot->pastEpochs.end(), pastEpochs.begin(),
+                              pastEpochs.end());
+  snapshot->pastEpochs.emplace_back(startFileNumber, current->currentEpoch);
+  snapshot->currentEpoch = Intern(std::move(epochId));
+  Publish(std::move(snapshot));
   return true;
 }
 
-std::string CloudManifest::GetEpoch(uint64_t fileNumber) {
-  ReadLock lck(&mutex_);
-  // Note: We are looking for fileNumber + 1 because fileNumbers in pastEpochs_
-  // are exclusive. In other words, if pastEpochs_ contains (10, "x"), it means
-  // that "x" epoch ends at 9, not 10.
-  auto itr =
-      std::lower_bound(pastEpochs_.begin(), pastEpochs_.end(),
-                       std::pair<uint64_t, std::string>(fileNumber + 1, ""));
-  if (itr == pastEpochs_.end()) {
-    return currentEpoch_;
-  }
-  return itr->second;
+size_t CloudManifest::PruneEpochs(const std::set<uint64_t>& liveFileNumbers) {
+  MutexLock lck(&mutex_);
+  auto current = GetSnapshot();
+  const auto& pastEpochs = current->pastEpochs;
+  std::unique_ptr<Snapshot> snapshot(new Snapshot());
+  uint64_t start = 0;
+  for (size_t i = 0; i < pastEpochs.size(); i++) {
+    // The epoch covers file numbers [start, pastEpochs[i].first). Once it is
+    // dropped, they map to the next epoch kept instead. The last past epoch
+    // is kept so that AddEpoch keeps rejecting deltas already applied.
+    auto it = liveFileNumbers.lower_bound(start);
+    if (i + 1 == pastEpochs.size() ||
+        (it != liveFileNumbers.end() && *it < pastEpochs[i].first)) {
+      snapshot->pastEpochs.push_back(pastEpochs[i]);
+    }
+    start = pastEpochs[i].first;
+  }
+  auto pruned = pastEpochs.size() - snapshot->pastEpochs.size();
+  if (pruned > 0) {
+    snapshot->currentEpoch = current->currentEpoch;
+    Publish(std::move(snapshot));
+  }
+  return pruned;
 }
 
-std::string CloudManifest::GetCurrentEpoch() {
-  ReadLock lck(&mutex_);
-  return currentEpoch_;
+const std::string& CloudManifest::GetEpoch(uint64_t fileNumber) const {
+  auto snapshot = GetSnapshot();
+  const auto& pastEpochs = snapshot->pastEpochs;
+  // Note: We are looking for the first epoch that ends after fileNumber
+  // because fileNumbers in pastEpochs are exclusive. In other words, if
+  // pastEpochs contains (10, "x"), it means that "x" epoch ends at 9, not 10.
+  auto itr = std::upper_bound(
+      pastEpochs.begin(), pastEpochs.end(), fileNumber,
+      [](uint64_t number, const std::pair<uint64_t, const std::string*>& pe) {
+        return number < pe.first;
+      });
+  if (itr == pastEpochs.end()) {
+    return *snapshot->currentEpoch;
+  }
+  return *itr->second;
 }
 
-std::vector<std::pair<uint64_t, std::string>>
-CloudManifest::TEST_GetPastEpochs() const {
-  ReadLock lck(&mutex_);
-  return pastEpochs_;
+const std::string& CloudManifest::GetCurrentEpoch() const {
+  return *GetSnapshot()->currentEpoch;
+}
+
+std::vector<std::pair<uint64_t, std::string>> CloudManifest::GetPastEpochs()
+    const {
+  std::vector<std::pair<uint64_t, std::string>> pastEpochs;
+  for (auto& pe : GetSnapshot()->pastEpochs) {
+    pastEpochs.emplace_back(pe.first, *pe.second);
+  }
+  return pastEpochs;
 }
 
-std::string CloudManifest::ToString(bool include_past_epochs) {
-  ReadLock lck(&mutex_);
+std::string CloudManifest::ToString(bool include_past_epochs) const {
+  auto snapshot = GetSnapshot();
   std::ostringstream oss;
   if (include_past_epochs) {
     oss << "Past Epochs: [\n";
-    for (auto& pe : pastEpochs_) {
-      oss << "\t(" << pe.first << ", " << pe.second << "), \n";
+    for (auto& pe : snapshot->pastEpochs) {
+      oss << "\t(" << pe.first << ", " << *pe.second << "), \n";
     }
     oss << "]\n";
   }
-  oss << "Current Epoch: " << currentEpoch_;
+  oss << "Current Epoch: " << *snapshot->currentEpoch;
   return oss.str();
 }
 
@@ -3,6 +3,11 @@
 #pragma once
 #include <rocksdb/status.h>
 
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "db/log_reader.h"
@@ -32,7 +37,8 @@ namespace ROCKSDB_NAMESPACE {
 // In this case, we should expect to see files 1-[e1], 2-[e1], 3-[e1] and
 // 4-[e2]. Files with same file number, but different suffix should be
 // eliminated.
-// CloudManifest is thread safe after Finalize() is called.
+// CloudManifest is thread safe. Lookups don't lock: they read an immutable
+// snapshot of the epochs, which AddEpoch replaces.
 class CloudManifest {
  public:
   static IOStatus LoadFromLog(std::unique_ptr<SequentialFileReader> log,
@@ -43,7 +49,13 @@ class CloudManifest {
 
   std::unique_ptr<CloudManifest> clone() const;
 
-  IOStatus WriteToLog(std::unique_ptr<WritableFileWriter> log) const;
+  // Formats of the CLOUDMANIFEST file, see the comment of LoadFromLog
+  static constexpr uint32_t kDefaultFormatVersion = 1;
+  // All epochs in a single record, with delta-encoded file numbers
+  static constexpr uint32_t kCompactFormatVersion = 2;
+
+  IOStatus WriteToLog(std::unique_ptr<WritableFileWriter> log,
+                      uint32_t formatVersion = kDefaultFormatVersion) const;
 
   // Add an epoch that starts with startFileNumber and is identified by epochId.
   // GetEpoch(startFileNumber) == epochId
@@ -57,27 +69,52 @@ class CloudManifest {
   // existing epochs(same sequence of <filenumm, epoch> is re-added)
   bool AddEpoch(uint64_t startFileNumber, std::string epochId);
 
-  std::string GetEpoch(uint64_t fileNumber);
-
-  std::string GetCurrentEpoch();
-  std::string ToString(bool include_past_epochs=false);
-  std::vector<std::pair<uint64_t, std::string>> TEST_GetPastEpochs() const;
+  // The returned epochs live as long as the CloudManifest
+  const std::string& GetEpoch(uint64_t fileNumber) const;
 
- private:
-  CloudManifest(std::vector<std::pair<uint64_t, std::string>> pastEpochs,
-                std::string currentEpoch)
-      : pastEpochs_(std::move(pastEpochs)),
-        currentEpoch_(std::move(currentEpoch)) {}
+  const std::string& GetCurrentEpoch() const;
 
-  mutable port::RWMutex mutex_;
+  // Drops the past epochs that contain none of liveFileNumbers, except the
+  // most recent one. Epochs of liveFileNumbers don't change. Returns the
+  // number of epochs dropped.
+  size_t PruneEpochs(const std::set<uint64_t>& liveFileNumbers);
+  std::string ToString(bool include_past_epochs=false) const;
+  // (fileNumber, epochId) pairs, where fileNumber is the first file number
+  // past the epoch, in ascending order
+  std::vector<std::pair<uint64_t, std::string>> GetPastEpochs() const;
+  std::vector<std::pair<uint64_t, std::string>> TEST_GetPastEpochs() const {
+    return GetPastEpochs();
+  }
 
-  // sorted
-  // a set of (fileNumber, epochId) where fileNumber is the last file number
-  // (exclusive) of an epoch
-  std::vector<std::pair<uint64_t, std::string>> pastEpochs_;
-  std::string currentEpoch_;
+ private:
+  struct Snapshot {
+    // sorted
+    // a set of (fileNumber, epochId) where fileNumber is the last file number
+    // (exclusive) of an epoch
+    std::vector<std::pair<uint64_t, const std::string*>> pastEpochs;
+    const std::string* currentEpoch;
+  };
 
-  static constexpr uint32_t kCurrentFormatVersion = 1;
+  CloudManifest(std::vector<std::pair<uint64_t, std::string>> pastEpochs,
+                std::string currentEpoch);
+
+  const Snapshot* GetSnapshot() const {
+    return snapshot_.load(std::memory_order_acquire);
+  }
+  // REQUIRES: mutex_ is held
+  const std::string* Intern(std::string epochId);
+  // REQUIRES: mutex_ is held
+  void Publish(std::unique_ptr<Snapshot> snapshot);
+
+  // Serializes AddEpoch
+  port::Mutex mutex_;
+  // Each epoch id once. Only grows, so the snapshots can point into it
+  std::unordered_set<std::string> epochIds_;
+  // All snapshots published. Readers may hold any of them, and epochs are
+  // only added when a database is opened, so they are kept until the
+  // CloudManifest is destroyed.
+  std::vector<std::unique_ptr<const Snapshot>> snapshots_;
+  std::atomic<const Snapshot*> snapshot_{nullptr};
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -2,6 +2,10 @@
 
 #include "cloud/cloud_manifest.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "env/composite_env_wrapper.h"
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
@@ -18,7 +22,9 @@ class CloudManifestTest : public testing::Test {
   }
 
  protected:
-  Status DumpToRandomFile(const CloudManifest* manifest, std::string *filepath) {
+  Status DumpToRandomFile(
+      const CloudManifest* manifest, std::string* filepath,
+      uint32_t formatVersion = CloudManifest::kDefaultFormatVersion) {
     Random rnd(301);
     std::string filename = "CLOUDMANIFEST" + rnd.RandomString(7);
     *filepath = tmp_dir_ + "/" + filename;
@@ -29,7 +35,7 @@ class CloudManifestTest : public testing::Test {
       return st;
     }
 
-    st = manifest->WriteToLog(std::move(writer));
+    st = manifest->WriteToLog(std::move(writer), formatVersion);
     return st;
   }
 
@@ -118,6 +124,105 @@ TEST_F(CloudManifestTest, IdempotencyTest) {
   ASSERT_OK(LoadFromFile(filepath, &manifest));
 }
 
+TEST_F(CloudManifestTest, CompactFormat) {
+  std::unique_ptr<CloudManifest> manifest;
+  ASSERT_OK(CloudManifest::CreateForEmptyDatabase("epoch0", &manifest));
+  std::string filepath;
+  ASSERT_OK(DumpToRandomFile(manifest.get(), &filepath,
+                             CloudManifest::kCompactFormatVersion));
+  ASSERT_OK(LoadFromFile(filepath, &manifest));
+  ASSERT_EQ(manifest->GetCurrentEpoch(), "epoch0");
+  ASSERT_TRUE(manifest->TEST_GetPastEpochs().empty());
+
+  for (uint64_t i = 1; i <= 100; i++) {
+    ASSERT_TRUE(manifest->AddEpoch(i * i, "epoch" + std::to_string(i)));
+  }
+  auto pastEpochs = manifest->TEST_GetPastEpochs();
+  uint64_t defaultSize, compactSize;
+  ASSERT_OK(DumpToRandomFile(manifest.get(), &filepath));
+  ASSERT_OK(env_->GetFileSize(filepath, &defaultSize));
+  ASSERT_OK(DumpToRandomFile(manifest.get(), &filepath,
+                             CloudManifest::kCompactFormatVersion));
+  ASSERT_OK(env_->GetFileSize(filepath, &compactSize));
+  ASSERT_LT(compactSize, defaultSize);
+
+  ASSERT_OK(LoadFromFile(filepath, &manifest));
+  ASSERT_EQ(manifest->TEST_GetPastEpochs(), pastEpochs);
+  ASSERT_EQ(manifest->GetCurrentEpoch(), "epoch100");
+  ASSERT_EQ(manifest->GetEpoch(50), "epoch7");
+
+  std::unique_ptr<WritableFileWriter> writer;
+  ASSERT_OK(WritableFileWriter::Create(env_->GetFileSystem(), filepath,
+                                       FileOptions(), &writer, nullptr));
+  ASSERT_TRUE(manifest->WriteToLog(std::move(writer), 3).IsInvalidArgument());
+}
+
+TEST_F(CloudManifestTest, PruneEpochs) {
+  std::unique_ptr<CloudManifest> manifest;
+  ASSERT_OK(CloudManifest::CreateForEmptyDatabase("epoch0", &manifest));
+  // epoch0: [0, 10), epoch1: [10, 20), epoch2: empty, epoch3: [20, 30),
+  // epoch4: [30, 40), epoch5: [40, ...)
+  ASSERT_TRUE(manifest->AddEpoch(10, "epoch1"));
+  ASSERT_TRUE(manifest->AddEpoch(20, "epoch2"));
+  ASSERT_TRUE(manifest->AddEpoch(20, "epoch3"));
+  ASSERT_TRUE(manifest->AddEpoch(30, "epoch4"));
+  ASSERT_TRUE(manifest->AddEpoch(40, "epoch5"));
+
+  std::set<uint64_t> live{3, 25, 41};
+  ASSERT_EQ(manifest->PruneEpochs(live), 2u);
+  for (auto number : live) {
+    ASSERT_EQ(manifest->GetEpoch(number),
+              "epoch" + std::to_string(number <= 20 ? number / 10
+                                                    : number / 10 + 1));
+  }
+  // The last past epoch is kept, so old deltas are still rejected
+  std::vector<std::pair<uint64_t, std::string>> pastEpochs{
+      {10, "epoch0"}, {30, "epoch3"}, {40, "epoch4"}};
+  ASSERT_EQ(manifest->TEST_GetPastEpochs(), pastEpochs);
+  ASSERT_FALSE(manifest->AddEpoch(40, "epoch5"));
+  ASSERT_EQ(manifest->PruneEpochs(live), 0u);
+
+  ASSERT_EQ(manifest->PruneEpochs({}), 2u);
+  ASSERT_EQ(manifest->TEST_GetPastEpochs().size(), 1u);
+  ASSERT_EQ(manifest->GetEpoch(41), "epoch5");
+}
+
+// Lookups don't block on, and always see a consistent table during, AddEpoch
+TEST_F(CloudManifestTest, ConcurrentLookups) {
+  std::unique_ptr<CloudManifest> manifest;
+  ASSERT_OK(CloudManifest::CreateForEmptyDatabase("epoch0", &manifest));
+  const uint64_t kNumEpochs = 200;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      uint64_t current = 0;
+      while (!done.load()) {
+        // Epoch k starts at file number 10 * k
+        for (uint64_t number = 0; number < 10 * kNumEpochs; number += 7) {
+          uint64_t k = std::stoull(manifest->GetEpoch(number).substr(5));
+          // Either the epoch of the file, or the current epoch of the
+          // database before the file was created
+          ASSERT_LE(k, number / 10);
+          ASSERT_TRUE(k == number / 10 || k >= current);
+        }
+        uint64_t latest = std::stoull(manifest->GetCurrentEpoch().substr(5));
+        ASSERT_GE(latest, current);
+        current = latest;
+      }
+    });
+  }
+  for (uint64_t k = 1; k < kNumEpochs; k++) {
+    ASSERT_TRUE(manifest->AddEpoch(10 * k, "epoch" + std::to_string(k)));
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+  ASSERT_EQ(manifest->GetEpoch(10 * kNumEpochs), "epoch199");
+  ASSERT_EQ(manifest->GetEpoch(15), "epoch1");
+}
+
 }  //  namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,122 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_metadata_cache.h"
+
+#include <algorithm>
+
+#include "cloud/filename.h"
+#include "rocksdb/system_clock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudMetadataCache::CloudMetadataCache(
+    const std::shared_ptr<SystemClock>& clock, uint64_t ttl_micros,
+    size_t capacity)
+    : clock_(clock),
+      ttl_micros_(ttl_micros),
+      capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::string CloudMetadataCache::Key(const std::string& bucket,
+                                    const std::string& path) {
+  // Bucket names can't contain '/', so the listing of a directory is a
+  // prefix of the keys of its objects
+  return bucket + pathsep + ltrim_if(path, '/');
+}
+
+template <typename T>
+void CloudMetadataCache::Evict(std::unordered_map<std::string, Entry<T>>* map,
+                               uint64_t now) {
+  if (map->size() < capacity_) {
+    return;
+  }
+  for (auto it = map->begin(); it != map->end();) {
+    if (it->second.expiration_micros <= now) {
+      it = map->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Still full: drop a quarter of the entries rather than one per insert
+  auto target = capacity_ - capacity_ / 4;
+  while (map->size() >= target && !map->empty()) {
+    map->erase(map->begin());
+  }
+}
+
+bool CloudMetadataCache::Lookup(const std::string& bucket,
+                                const std::string& object_path,
+                                ObjectInfo* info) {
+  auto now = clock_->NowMicros();
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = objects_.find(Key(bucket, object_path));
+  if (it == objects_.end()) {
+    return false;
+  }
+  if (it->second.expiration_micros <= now) {
+    objects_.erase(it);
+    return false;
+  }
+  *info = it->second.value;
+  return true;
+}
+
+void CloudMetadataCache::Insert(const std::string& bucket,
+                                const std::string& object_path,
+                                const ObjectInfo& info) {
+  auto now = clock_->NowMicros();
+  std::lock_guard<std::mutex> lk(mutex_);
+  Evict(&objects_, now);
+  objects_[Key(bucket, object_path)] = {info, now + ttl_micros_};
+}
+
+bool CloudMetadataCache::LookupListing(const std::string& bucket,
+                                       const std::string& dir_path,
+                                       std::vector<std::string>* result) {
+  auto now = clock_->NowMicros();
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = listings_.find(ensure_ends_with_pathsep(Key(bucket, dir_path)));
+  if (it == listings_.end()) {
+    return false;
+  }
+  if (it->second.expiration_micros <= now) {
+    listings_.erase(it);
+    return false;
+  }
+  result->insert(result->end(), it->second.value.begin(),
+                 it->second.value.end());
+  return true;
+}
+
+void CloudMetadataCache::InsertListing(
+    const std::string& bucket, const std::string& dir_path,
+    const std::vector<std::string>& children) {
+  auto now = clock_->NowMicros();
+  std::lock_guard<std::mutex> lk(mutex_);
+  Evict(&listings_, now);
+  listings_[ensure_ends_with_pathsep(Key(bucket, dir_path))] = {
+      children, now + ttl_micros_};
+}
+
+void CloudMetadataCache::Invalidate(const std::string& bucket,
+                                    const std::string& object_path) {
+  auto key = Key(bucket, object_path);
+  std::lock_guard<std::mutex> lk(mutex_);
+  objects_.erase(key);
+  for (auto it = listings_.begin(); it != listings_.end();) {
+    if (StartsWith(key, it->first)) {
+      it = listings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t CloudMetadataCache::NumObjects() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return objects_.size();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
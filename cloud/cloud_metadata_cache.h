@@ -0,0 +1,79 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class SystemClock;
+
+// In-process cache of the metadata of cloud objects (existence, size,
+// modification time) and of the listings of cloud directories, keyed by
+// bucket and object path. Lets the file system answer FileExists,
+// GetFileSize and GetChildren without a HEAD or LIST per call.
+//
+// The owner invalidates the entries of the objects it writes or deletes.
+// Changes made by other writers go unnoticed until the entries expire,
+// ttl_micros after they were fetched.
+//
+// Thread safe.
+class CloudMetadataCache {
+ public:
+  struct ObjectInfo {
+    bool exists = false;
+    // Valid if exists
+    uint64_t size = 0;
+    uint64_t modification_time = 0;
+  };
+
+  // Holds at most capacity objects (and as many listings); entries are
+  // dropped to make room, expired ones first.
+  CloudMetadataCache(const std::shared_ptr<SystemClock>& clock,
+                     uint64_t ttl_micros, size_t capacity);
+
+  // Returns true and sets *info if the metadata of the object is cached
+  bool Lookup(const std::string& bucket, const std::string& object_path,
+              ObjectInfo* info);
+  void Insert(const std::string& bucket, const std::string& object_path,
+              const ObjectInfo& info);
+
+  // Returns true and appends the cached listing of the directory to *result
+  bool LookupListing(const std::string& bucket, const std::string& dir_path,
+                     std::vector<std::string>* result);
+  void InsertListing(const std::string& bucket, const std::string& dir_path,
+                     const std::vector<std::string>& children);
+
+  // The object was written or deleted: drops its metadata and the listings
+  // of the directories that contain it
+  void Invalidate(const std::string& bucket, const std::string& object_path);
+
+  size_t NumObjects() const;
+
+ private:
+  template <typename T>
+  struct Entry {
+    T value;
+    uint64_t expiration_micros;
+  };
+
+  static std::string Key(const std::string& bucket, const std::string& path);
+  // Makes room for one more entry in map. REQUIRES: mutex_ is held
+  template <typename T>
+  void Evict(std::unordered_map<std::string, Entry<T>>* map, uint64_t now);
+
+  std::shared_ptr<SystemClock> clock_;
+  const uint64_t ttl_micros_;
+  const size_t capacity_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry<ObjectInfo>> objects_;
+  std::unordered_map<std::string, Entry<std::vector<std::string>>> listings_;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
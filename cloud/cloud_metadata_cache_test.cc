@@ -0,0 +1,131 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_metadata_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "rocksdb/system_clock.h"
+#include "test_util/mock_time_env.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudMetadataCacheTest : public testing::Test {
+ public:
+  CloudMetadataCacheTest()
+      : clock_(std::make_shared<MockSystemClock>(SystemClock::Default())) {}
+
+  static CloudMetadataCache::ObjectInfo Exists(uint64_t size) {
+    CloudMetadataCache::ObjectInfo info;
+    info.exists = true;
+    info.size = size;
+    info.modification_time = 1;
+    return info;
+  }
+
+  std::shared_ptr<MockSystemClock> clock_;
+};
+
+TEST_F(CloudMetadataCacheTest, Expiry) {
+  CloudMetadataCache cache(clock_, 1000, 100);
+  CloudMetadataCache::ObjectInfo info;
+  ASSERT_FALSE(cache.Lookup("bucket", "db/000010.sst", &info));
+
+  cache.Insert("bucket", "db/000010.sst", Exists(42));
+  cache.Insert("bucket", "db/000011.sst", CloudMetadataCache::ObjectInfo());
+  ASSERT_TRUE(cache.Lookup("bucket", "db/000010.sst", &info));
+  ASSERT_TRUE(info.exists);
+  ASSERT_EQ(info.size, 42u);
+  // Misses are cached, too
+  ASSERT_TRUE(cache.Lookup("bucket", "db/000011.sst", &info));
+  ASSERT_FALSE(info.exists);
+  // Leading slashes don't matter, buckets do
+  ASSERT_TRUE(cache.Lookup("bucket", "/db/000010.sst", &info));
+  ASSERT_FALSE(cache.Lookup("other", "db/000010.sst", &info));
+
+  clock_->SleepForMicroseconds(999);
+  ASSERT_TRUE(cache.Lookup("bucket", "db/000010.sst", &info));
+  clock_->SleepForMicroseconds(1);
+  ASSERT_FALSE(cache.Lookup("bucket", "db/000010.sst", &info));
+  ASSERT_FALSE(cache.Lookup("bucket", "db/000011.sst", &info));
+}
+
+TEST_F(CloudMetadataCacheTest, Listings) {
+  CloudMetadataCache cache(clock_, 1000, 100);
+  std::vector<std::string> children;
+  ASSERT_FALSE(cache.LookupListing("bucket", "db", &children));
+
+  cache.InsertListing("bucket", "db", {"000010.sst", "MANIFEST-1"});
+  cache.InsertListing("bucket", "db2", {"000020.sst"});
+  children.push_back("local");
+  ASSERT_TRUE(cache.LookupListing("bucket", "db/", &children));
+  ASSERT_EQ(children,
+            std::vector<std::string>({"local", "000010.sst", "MANIFEST-1"}));
+
+  clock_->SleepForMicroseconds(1000);
+  children.clear();
+  ASSERT_FALSE(cache.LookupListing("bucket", "db", &children));
+  ASSERT_TRUE(children.empty());
+}
+
+TEST_F(CloudMetadataCacheTest, Invalidate) {
+  CloudMetadataCache cache(clock_, 1000, 100);
+  cache.Insert("bucket", "db/000010.sst", Exists(42));
+  cache.Insert("bucket", "db/000011.sst", Exists(43));
+  cache.InsertListing("bucket", "db", {"000010.sst", "000011.sst"});
+  cache.InsertListing("bucket", "db2", {"000020.sst"});
+  cache.InsertListing("other", "db", {"000010.sst"});
+
+  cache.Invalidate("bucket", "db/000010.sst");
+  CloudMetadataCache::ObjectInfo info;
+  ASSERT_FALSE(cache.Lookup("bucket", "db/000010.sst", &info));
+  ASSERT_TRUE(cache.Lookup("bucket", "db/000011.sst", &info));
+  // Only the listing of the directory of the object is dropped
+  std::vector<std::string> children;
+  ASSERT_FALSE(cache.LookupListing("bucket", "db", &children));
+  ASSERT_TRUE(cache.LookupListing("bucket", "db2", &children));
+  ASSERT_TRUE(cache.LookupListing("other", "db", &children));
+}
+
+TEST_F(CloudMetadataCacheTest, Capacity) {
+  CloudMetadataCache cache(clock_, 1000, 8);
+  for (int i = 0; i < 8; i++) {
+    cache.Insert("bucket", "db/" + std::to_string(i) + ".sst", Exists(i));
+  }
+  ASSERT_EQ(cache.NumObjects(), 8u);
+  cache.Insert("bucket", "db/8.sst", Exists(8));
+  ASSERT_LE(cache.NumObjects(), 8u);
+  CloudMetadataCache::ObjectInfo info;
+  ASSERT_TRUE(cache.Lookup("bucket", "db/8.sst", &info));
+
+  // Expired entries go first
+  clock_->SleepForMicroseconds(1000);
+  cache.Insert("bucket", "db/9.sst", Exists(9));
+  for (int i = 10; i < 16; i++) {
+    cache.Insert("bucket", "db/" + std::to_string(i) + ".sst", Exists(i));
+  }
+  ASSERT_EQ(cache.NumObjects(), 7u);
+  for (int i = 9; i < 16; i++) {
+    ASSERT_TRUE(
+        cache.Lookup("bucket", "db/" + std::to_string(i) + ".sst", &info));
+  }
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudMetadataCacheTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,191 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_multipart_uploader.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "cloud/cloud_transfer_executor.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/env.h"
+#include "rocksdb/env_encryption.h"
+#include "rocksdb/memory_tracker.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudMultipartUploader::CloudMultipartUploader(
+    CloudStorageProvider* provider, const std::shared_ptr<ThreadPool>& executor,
+    Logger* info_log, const std::string& bucket,
+    const std::string& object_path, uint64_t part_size,
+    size_t max_pending_parts)
+    : provider_(provider),
+      executor_(executor),
+      info_log_(info_log),
+      bucket_(bucket),
+      object_path_(object_path),
+      part_size_(part_size),
+      max_pending_parts_(std::max<size_t>(max_pending_parts, 1)),
+      memory_tracker_(
+          MemoryTracker::Get(MemoryTrackerNames::kCloudMultipartUpload())),
+      state_(std::make_shared<State>()) {}
+
+CloudMultipartUploader::~CloudMultipartUploader() {
+  if (!done_) {
+    Abort();
+  }
+}
+
+void CloudMultipartUploader::SetEncryption(
+    std::shared_ptr<BlockAccessCipherStream> cipher,
+    std::unordered_map<std::string, std::string> metadata) {
+  assert(upload_id_.empty() && buffer_.empty());
+  cipher_ = std::move(cipher);
+  metadata_ = std::move(metadata);
+}
+
+IOStatus CloudMultipartUploader::Append(const Slice& data) {
+  assert(!done_);
+  Slice left = data;
+  while (!left.empty()) {
+    size_t len = static_cast<size_t>(
+        std::min<uint64_t>(left.size(), part_size_ - buffer_.size()));
+    buffer_.append(left.data(), len);
+    left.remove_prefix(len);
+    if (buffer_.size() < part_size_) {
+      break;
+    }
+    if (upload_id_.empty()) {
+      auto st = provider_->CreateMultipartUpload(bucket_, object_path_,
+                                                 metadata_, &upload_id_);
+      if (!st.ok()) {
+        upload_id_.clear();
+        return st;
+      }
+      Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+          "[%s] CloudMultipartUploader started upload of %s/%s",
+          provider_->Name(), bucket_.c_str(), object_path_.c_str());
+    }
+    auto st = WaitForParts(max_pending_parts_ - 1);
+    if (!st.ok()) {
+      return st;
+    }
+    SubmitPart();
+  }
+  std::lock_guard<std::mutex> lk(state_->mutex);
+  return state_->status;
+}
+
+void CloudMultipartUploader::SubmitPart() {
+  auto part_number = next_part_number_++;
+  auto data = std::make_shared<std::string>();
+  data->swap(buffer_);
+  buffer_.reserve(static_cast<size_t>(part_size_));
+  {
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    state_->pending_parts++;
+    if (state_->part_ids.size() < static_cast<size_t>(part_number)) {
+      state_->part_ids.resize(part_number);
+    }
+  }
+  memory_tracker_->Add(data->size());
+  executor_->SubmitJob([provider = provider_, state = state_, data,
+                        part_number, bucket = bucket_, path = object_path_,
+                        upload_id = upload_id_, io_priority = io_priority_,
+                        tracker = memory_tracker_, cipher = cipher_,
+                        part_size = part_size_]() {
+    CloudTransferExecutor::ScopedIOPriority scoped_priority(io_priority);
+    std::string part_id;
+    IOStatus st;
+    {
+      std::lock_guard<std::mutex> lk(state->mutex);
+      st = state->status;
+    }
+    if (st.ok() && cipher && !data->empty()) {
+      // All the parts but the last are part_size long
+      st = status_to_io_status(cipher->Encrypt(
+          (part_number - 1) * part_size, &(*data)[0], data->size()));
+    }
+    if (st.ok()) {
+      // don't bother uploading after a part failed
+      st = provider->UploadPart(bucket, path, upload_id, part_number, *data,
+                                &part_id);
+    }
+    tracker->Release(data->size());
+    std::lock_guard<std::mutex> lk(state->mutex);
+    if (st.ok()) {
+      state->part_ids[part_number - 1] = std::move(part_id);
+    } else if (state->status.ok()) {
+      state->status = st;
+    }
+    state->pending_parts--;
+    state->cv.notify_all();
+  });
+}
+
+IOStatus CloudMultipartUploader::WaitForParts(size_t max_pending) {
+  std::unique_lock<std::mutex> lk(state_->mutex);
+  state_->cv.wait(lk, [this, max_pending] {
+    return state_->pending_parts <= max_pending;
+  });
+  return state_->status;
+}
+
+IOStatus CloudMultipartUploader::Finish(bool* uploaded) {
+  assert(!done_);
+  *uploaded = false;
+  if (upload_id_.empty()) {
+    done_ = true;
+    buffer_.clear();
+    return IOStatus::OK();
+  }
+  if (!buffer_.empty()) {
+    SubmitPart();
+  }
+  auto st = WaitForParts(0);
+  if (st.ok()) {
+    std::vector<std::string> part_ids;
+    {
+      std::lock_guard<std::mutex> lk(state_->mutex);
+      part_ids = state_->part_ids;
+    }
+    st = provider_->CompleteMultipartUpload(bucket_, object_path_, upload_id_,
+                                            part_ids);
+  }
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+        "[%s] CloudMultipartUploader failed to upload %s/%s: %s",
+        provider_->Name(), bucket_.c_str(), object_path_.c_str(),
+        st.ToString().c_str());
+    Abort();
+    return st;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] CloudMultipartUploader uploaded %s/%s in %d parts",
+      provider_->Name(), bucket_.c_str(), object_path_.c_str(),
+      next_part_number_ - 1);
+  done_ = true;
+  *uploaded = true;
+  return st;
+}
+
+void CloudMultipartUploader::Abort() {
+  done_ = true;
+  buffer_.clear();
+  if (upload_id_.empty()) {
+    return;
+  }
+  WaitForParts(0).PermitUncheckedError();
+  auto st = provider_->AbortMultipartUpload(bucket_, object_path_, upload_id_);
+  if (!st.ok()) {
+    Log(InfoLogLevel::WARN_LEVEL, info_log_,
+        "[%s] CloudMultipartUploader failed to abort upload of %s/%s: %s",
+        provider_->Name(), bucket_.c_str(), object_path_.c_str(),
+        st.ToString().c_str());
+  }
+  upload_id_.clear();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,102 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/io_status.h"
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class BlockAccessCipherStream;
+class CloudStorageProvider;
+class Logger;
+class MemoryTracker;
+class ThreadPool;
+
+// Streams an object to the cloud with a multipart upload while it is still
+// being written. Appended data is buffered until part_size bytes are
+// available, and the part is then uploaded on the executor. At most
+// max_pending_parts parts are buffered or in flight; Append blocks beyond
+// that.
+//
+// The multipart upload is only created once the first part is full, so
+// objects smaller than part_size never touch the cloud here and have to be
+// uploaded by the caller (see Finish).
+//
+// Not thread safe, like the writable file that owns it.
+class CloudMultipartUploader {
+ public:
+  CloudMultipartUploader(CloudStorageProvider* provider,
+                         const std::shared_ptr<ThreadPool>& executor,
+                         Logger* info_log, const std::string& bucket,
+                         const std::string& object_path, uint64_t part_size,
+                         size_t max_pending_parts = 4);
+  // Aborts the upload if it was not finished
+  ~CloudMultipartUploader();
+
+  // Returns the error of a failed part, if any. The upload must then be
+  // aborted.
+  IOStatus Append(const Slice& data);
+
+  // Uploads the buffered tail and completes the upload. Sets *uploaded to
+  // false if the data never reached part_size, in which case nothing was
+  // uploaded and the caller has to upload the object itself.
+  IOStatus Finish(bool* uploaded);
+
+  // Waits for the parts in flight and discards the upload
+  void Abort();
+
+  // Charges the parts submitted from now on at priority, see
+  // CloudTransferExecutor::ScopedIOPriority
+  void SetIOPriority(Env::IOPriority priority) { io_priority_ = priority; }
+
+  // Encrypts the parts with cipher, at their offset in the object, on the
+  // executor before they are uploaded, and creates the upload with
+  // metadata. REQUIRES: called before the first Append.
+  void SetEncryption(std::shared_ptr<BlockAccessCipherStream> cipher,
+                     std::unordered_map<std::string, std::string> metadata);
+
+ private:
+  // State shared with the part upload jobs
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending_parts = 0;
+    IOStatus status;
+    std::vector<std::string> part_ids;
+  };
+
+  void SubmitPart();
+  // Waits until at most max_pending parts are in flight
+  IOStatus WaitForParts(size_t max_pending);
+
+  CloudStorageProvider* provider_;
+  std::shared_ptr<ThreadPool> executor_;
+  Logger* info_log_;
+  const std::string bucket_;
+  const std::string object_path_;
+  const uint64_t part_size_;
+  const size_t max_pending_parts_;
+  // Charged for the parts in flight
+  MemoryTracker* memory_tracker_;
+  // Null if the object isn't encrypted
+  std::shared_ptr<BlockAccessCipherStream> cipher_;
+  std::unordered_map<std::string, std::string> metadata_;
+
+  std::string upload_id_;
+  std::string buffer_;
+  int next_part_number_ = 1;
+  Env::IOPriority io_priority_ = Env::IO_TOTAL;
+  bool done_ = false;
+  std::shared_ptr<State> state_;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,246 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_multipart_uploader.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <mutex>
+
+#include "env/env_encryption_ctr.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/threadpool.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Keeps the parts of a single multipart upload in memory
+class MultipartStorageProvider : public CloudStorageProvider {
+ public:
+  const char* Name() const override { return "MultipartTest"; }
+  IOStatus CreateBucket(const std::string&) override { return NotSup(); }
+  IOStatus ExistsBucket(const std::string&) override { return NotSup(); }
+  IOStatus EmptyBucket(const std::string&, const std::string&) override {
+    return NotSup();
+  }
+  IOStatus DeleteCloudObject(const std::string&, const std::string&) override {
+    return NotSup();
+  }
+  IOStatus ListCloudObjects(const std::string&, const std::string&,
+                            std::vector<std::string>*) override {
+    return NotSup();
+  }
+  IOStatus ExistsCloudObject(const std::string&, const std::string&) override {
+    return NotSup();
+  }
+  IOStatus GetCloudObjectSize(const std::string&, const std::string&,
+                              uint64_t*) override {
+    return NotSup();
+  }
+  IOStatus GetCloudObjectModificationTime(const std::string&,
+                                          const std::string&,
+                                          uint64_t*) override {
+    return NotSup();
+  }
+  IOStatus GetCloudObjectMetadata(const std::string&, const std::string&,
+                                  CloudObjectInformation*) override {
+    return NotSup();
+  }
+  IOStatus CopyCloudObject(const std::string&, const std::string&,
+                           const std::string&, const std::string&) override {
+    return NotSup();
+  }
+  IOStatus GetCloudObject(const std::string&, const std::string&,
+                          const std::string&) override {
+    return NotSup();
+  }
+  IOStatus PutCloudObject(const std::string&, const std::string&,
+                          const std::string&) override {
+    return NotSup();
+  }
+  IOStatus PutCloudObjectMetadata(
+      const std::string&, const std::string&,
+      const std::unordered_map<std::string, std::string>&) override {
+    return NotSup();
+  }
+  IOStatus NewCloudWritableFile(const std::string&, const std::string&,
+                                const std::string&, const FileOptions&,
+                                std::unique_ptr<CloudStorageWritableFile>*,
+                                IODebugContext*) override {
+    return NotSup();
+  }
+  IOStatus NewCloudReadableFile(const std::string&, const std::string&,
+                                const FileOptions&,
+                                std::unique_ptr<CloudStorageReadableFile>*,
+                                IODebugContext*) override {
+    return NotSup();
+  }
+
+  IOStatus CreateMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::unordered_map<std::string, std::string>& metadata,
+      std::string* upload_id) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    created_++;
+    metadata_ = metadata;
+    *upload_id = "upload";
+    return IOStatus::OK();
+  }
+  IOStatus UploadPart(const std::string& /*bucket_name*/,
+                      const std::string& /*object_path*/,
+                      const std::string& upload_id, int part_number,
+                      const Slice& data, std::string* part_id) override {
+    EXPECT_EQ(upload_id, "upload");
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (part_number == fail_part_) {
+      return IOStatus::IOError("injected");
+    }
+    parts_[part_number] = data.ToString();
+    *part_id = "etag" + std::to_string(part_number);
+    return IOStatus::OK();
+  }
+  IOStatus CompleteMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::string& /*upload_id*/,
+      const std::vector<std::string>& part_ids) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (size_t i = 0; i < part_ids.size(); i++) {
+      EXPECT_EQ(part_ids[i], "etag" + std::to_string(i + 1));
+      object_ += parts_[static_cast<int>(i + 1)];
+    }
+    return IOStatus::OK();
+  }
+  IOStatus AbortMultipartUpload(const std::string& /*bucket_name*/,
+                                const std::string& /*object_path*/,
+                                const std::string& /*upload_id*/) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    aborted_++;
+    return IOStatus::OK();
+  }
+
+  static IOStatus NotSup() { return IOStatus::NotSupported(); }
+
+  std::mutex mutex_;
+  int created_ = 0;
+  int aborted_ = 0;
+  int fail_part_ = 0;
+  std::map<int, std::string> parts_;
+  std::string object_;
+  std::unordered_map<std::string, std::string> metadata_;
+};
+}  // namespace
+
+class CloudMultipartUploaderTest : public testing::Test {
+ public:
+  CloudMultipartUploaderTest()
+      : executor_(NewThreadPool(2), [](ThreadPool* p) {
+          p->WaitForJobsAndJoinAllThreads();
+          delete p;
+        }) {}
+
+  std::unique_ptr<CloudMultipartUploader> NewUploader() {
+    return std::make_unique<CloudMultipartUploader>(
+        &provider_, executor_, nullptr, "bucket", "path/000010.sst",
+        kPartSize);
+  }
+
+  static constexpr uint64_t kPartSize = 100;
+  MultipartStorageProvider provider_;
+  std::shared_ptr<ThreadPool> executor_;
+};
+
+TEST_F(CloudMultipartUploaderTest, SmallObject) {
+  auto uploader = NewUploader();
+  ASSERT_OK(uploader->Append(std::string(kPartSize - 1, 'a')));
+  bool uploaded = true;
+  ASSERT_OK(uploader->Finish(&uploaded));
+  ASSERT_FALSE(uploaded);
+  ASSERT_EQ(provider_.created_, 0);
+}
+
+TEST_F(CloudMultipartUploaderTest, StreamParts) {
+  auto uploader = NewUploader();
+  std::string expected;
+  for (int i = 0; i < 25; i++) {
+    std::string data(37, static_cast<char>('a' + i));
+    ASSERT_OK(uploader->Append(data));
+    expected += data;
+  }
+  bool uploaded = false;
+  ASSERT_OK(uploader->Finish(&uploaded));
+  ASSERT_TRUE(uploaded);
+  ASSERT_EQ(provider_.created_, 1);
+  ASSERT_EQ(provider_.aborted_, 0);
+  ASSERT_EQ(provider_.parts_.size(), (expected.size() + kPartSize - 1) /
+                                         kPartSize);
+  ASSERT_EQ(provider_.object_, expected);
+}
+
+TEST_F(CloudMultipartUploaderTest, EncryptedParts) {
+  std::shared_ptr<BlockCipher> block_cipher;
+  ASSERT_OK(
+      BlockCipher::CreateFromString(ConfigOptions(), "ROT13", &block_cipher));
+  const std::string iv(block_cipher->BlockSize(), 'i');
+  auto uploader = NewUploader();
+  uploader->SetEncryption(
+      std::make_shared<CTRCipherStream>(block_cipher, iv.data(), 7),
+      {{"key", "value"}});
+  std::string expected;
+  for (int i = 0; i < 25; i++) {
+    std::string data(37, static_cast<char>('a' + i));
+    ASSERT_OK(uploader->Append(data));
+    expected += data;
+  }
+  bool uploaded = false;
+  ASSERT_OK(uploader->Finish(&uploaded));
+  ASSERT_TRUE(uploaded);
+  ASSERT_EQ(provider_.metadata_["key"], "value");
+  // Each part was encrypted at its offset in the object
+  ASSERT_EQ(provider_.object_.size(), expected.size());
+  ASSERT_NE(provider_.object_, expected);
+  CTRCipherStream cipher(block_cipher, iv.data(), 7);
+  ASSERT_OK(cipher.Decrypt(0, &provider_.object_[0], provider_.object_.size()));
+  ASSERT_EQ(provider_.object_, expected);
+}
+
+TEST_F(CloudMultipartUploaderTest, FailedPart) {
+  provider_.fail_part_ = 2;
+  auto uploader = NewUploader();
+  ASSERT_OK(uploader->Append(std::string(kPartSize, 'a')));
+  IOStatus st;
+  for (int i = 0; i < 10 && st.ok(); i++) {
+    st = uploader->Append(std::string(kPartSize, 'b'));
+  }
+  bool uploaded = true;
+  if (st.ok()) {
+    st = uploader->Finish(&uploaded);
+  } else {
+    uploader->Abort();
+    uploaded = false;
+  }
+  ASSERT_TRUE(st.IsIOError());
+  ASSERT_FALSE(uploaded);
+  ASSERT_EQ(provider_.aborted_, 1);
+  ASSERT_TRUE(provider_.object_.empty());
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudMultipartUploaderTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,175 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_hedger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+uint64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+CloudLatencyTracker::CloudLatencyTracker(double percentile,
+                                         uint64_t min_delay_micros)
+    : percentile_(std::min(std::max(percentile, 0.0), 100.0)),
+      min_delay_micros_(std::max<uint64_t>(min_delay_micros, 1)) {
+  latencies_.reserve(kWindow);
+}
+
+void CloudLatencyTracker::Record(uint64_t micros) {
+  std::vector<uint64_t> sorted;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (latencies_.size() < kWindow) {
+      latencies_.push_back(micros);
+    } else {
+      latencies_[next_] = micros;
+      next_ = (next_ + 1) % kWindow;
+    }
+    if (++recorded_ % kUpdateInterval != 0) {
+      return;
+    }
+    sorted = latencies_;
+  }
+  auto nth = static_cast<size_t>(
+      std::ceil(percentile_ / 100 * static_cast<double>(sorted.size())));
+  nth = std::min(std::max<size_t>(nth, 1), sorted.size()) - 1;
+  std::nth_element(sorted.begin(), sorted.begin() + nth, sorted.end());
+  hedge_delay_.store(std::max(sorted[nth], min_delay_micros_),
+                     std::memory_order_relaxed);
+}
+
+// Shared by Run() and the attempts of a request
+struct CloudRequestHedger::Request {
+  Request(const Attempt& _attempt, const Discard& _discard)
+      : attempt(_attempt), discard(_discard) {}
+
+  const Attempt attempt;
+  const Discard discard;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  IOStatus status[2];
+  bool completed[2] = {false, false};
+  int num_completed = 0;
+  // Set when Run() returned, with the attempt it used (-1 on timeout)
+  bool done = false;
+  int winner = -1;
+};
+
+CloudRequestHedger::CloudRequestHedger(int threads)
+    : pool_(NewThreadPool(std::max(threads, 1))) {}
+
+CloudRequestHedger::~CloudRequestHedger() {
+  pool_->WaitForJobsAndJoinAllThreads();
+}
+
+void CloudRequestHedger::Launch(
+    const std::shared_ptr<Request>& request, int attempt,
+    const std::shared_ptr<CloudLatencyTracker>& tracker) {
+  pool_->SubmitJob([request, attempt, tracker]() {
+    auto start = NowMicros();
+    auto st = request->attempt(attempt);
+    if (st.ok() && tracker) {
+      tracker->Record(NowMicros() - start);
+    }
+    bool discard;
+    {
+      std::lock_guard<std::mutex> lk(request->mutex);
+      request->status[attempt] = st;
+      request->completed[attempt] = true;
+      request->num_completed++;
+      discard = request->done && request->winner != attempt;
+      request->cv.notify_all();
+    }
+    if (discard && request->discard) {
+      request->discard(attempt);
+    }
+  });
+}
+
+IOStatus CloudRequestHedger::Run(
+    const std::shared_ptr<CloudLatencyTracker>& tracker,
+    const Attempt& attempt, const Discard& discard, uint64_t timeout_micros,
+    int* winner) {
+  auto request = std::make_shared<Request>(attempt, discard);
+  auto start = NowMicros();
+  auto deadline = timeout_micros > 0 ? start + timeout_micros : UINT64_MAX;
+  auto hedge_delay = tracker ? tracker->HedgeDelay() : 0;
+  auto hedge_at = hedge_delay > 0 ? start + hedge_delay : UINT64_MAX;
+
+  Launch(request, 0, tracker);
+  int launched = 1;
+  std::unique_lock<std::mutex> lk(request->mutex);
+  while (true) {
+    int found = -1;
+    for (int i = 0; i < launched; i++) {
+      if (request->completed[i] && request->status[i].ok()) {
+        found = i;
+        break;
+      }
+    }
+    if (found < 0 && request->num_completed == launched) {
+      // All failed. A failed first attempt isn't hedged, the client already
+      // retried it.
+      found = launched - 1;
+    }
+    if (found >= 0) {
+      request->done = true;
+      request->winner = found;
+      break;
+    }
+    auto now = NowMicros();
+    if (now >= deadline) {
+      request->done = true;
+      break;
+    }
+    if (launched == 1 && now >= hedge_at) {
+      lk.unlock();
+      num_hedged_.fetch_add(1, std::memory_order_relaxed);
+      Launch(request, 1, tracker);
+      launched++;
+      lk.lock();
+      continue;
+    }
+    auto wake = launched == 1 ? std::min(deadline, hedge_at) : deadline;
+    if (wake == UINT64_MAX) {
+      request->cv.wait(lk);
+    } else {
+      request->cv.wait_for(lk, std::chrono::microseconds(wake - now));
+    }
+  }
+  // The attempts which completed and weren't used are released here, the
+  // others when they complete
+  std::vector<int> unused;
+  for (int i = 0; i < launched; i++) {
+    if (request->completed[i] && i != request->winner) {
+      unused.push_back(i);
+    }
+  }
+  *winner = request->winner;
+  auto st = request->winner >= 0
+                ? request->status[request->winner]
+                : IOStatus::TimedOut("Cloud request did not complete within " +
+                                     std::to_string(timeout_micros) + "us");
+  lk.unlock();
+  if (discard) {
+    for (auto i : unused) {
+      discard(i);
+    }
+  }
+  return st;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
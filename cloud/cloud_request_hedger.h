@@ -0,0 +1,102 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class ThreadPool;
+
+// Latencies of the recent requests of one kind, from which the delay after
+// which a request of that kind is hedged is derived.
+//
+// Thread safe.
+class CloudLatencyTracker {
+ public:
+  // Requests are hedged after the given percentile of the recent latencies,
+  // and no sooner than min_delay_micros.
+  CloudLatencyTracker(double percentile, uint64_t min_delay_micros);
+
+  void Record(uint64_t micros);
+
+  // Returns 0 (do not hedge) until enough latencies have been recorded
+  uint64_t HedgeDelay() const {
+    return hedge_delay_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Number of recent latencies kept
+  static constexpr size_t kWindow = 1000;
+  // The delay is recomputed every kUpdateInterval latencies
+  static constexpr size_t kUpdateInterval = 100;
+
+  const double percentile_;
+  const uint64_t min_delay_micros_;
+  std::atomic<uint64_t> hedge_delay_{0};
+
+  std::mutex mutex_;
+  std::vector<uint64_t> latencies_;
+  size_t next_ = 0;
+  size_t recorded_ = 0;
+};
+
+// Runs cloud requests with a deadline and hedges the slow ones: if the first
+// attempt of a request hasn't completed after the hedge delay of its kind, a
+// second one is started and the first to succeed is used.
+//
+// The attempts run on threads of the hedger. They aren't cancelled when the
+// request is over, so the attempt of a request which lost (or timed out) can
+// still be running after Run() returned.
+class CloudRequestHedger {
+ public:
+  // Runs an attempt (0 or 1) of the request. May outlive the call to Run():
+  // it must only use the state it shares ownership of.
+  using Attempt = std::function<IOStatus(int attempt)>;
+  // Releases the result of an attempt that isn't used, once it completed
+  using Discard = std::function<void(int attempt)>;
+
+  explicit CloudRequestHedger(int threads);
+  // Waits for the attempts that are still running
+  ~CloudRequestHedger();
+
+  // Returns true if the requests tracked by tracker (may be null) which
+  // have to complete within timeout_micros (0 for no timeout) have to go
+  // through Run(). Otherwise the caller runs them itself, and records their
+  // latency in tracker.
+  static bool ShouldRun(const CloudLatencyTracker* tracker,
+                        uint64_t timeout_micros) {
+    return timeout_micros > 0 ||
+           (tracker != nullptr && tracker->HedgeDelay() > 0);
+  }
+
+  // Runs attempt 0 of the request, and attempt 1 too if attempt 0 hasn't
+  // completed after the hedge delay of tracker. Stores in *winner the index
+  // of the first attempt which succeeded or, if they all failed, of the last
+  // one, and returns its status. Returns TimedOut if that didn't happen
+  // within timeout_micros. The results of the other attempts are passed to
+  // discard.
+  IOStatus Run(const std::shared_ptr<CloudLatencyTracker>& tracker,
+               const Attempt& attempt, const Discard& discard,
+               uint64_t timeout_micros, int* winner);
+
+  // Number of requests for which a second attempt was started
+  uint64_t NumHedged() const {
+    return num_hedged_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Request;
+  void Launch(const std::shared_ptr<Request>& request, int attempt,
+              const std::shared_ptr<CloudLatencyTracker>& tracker);
+
+  std::unique_ptr<ThreadPool> pool_;
+  std::atomic<uint64_t> num_hedged_{0};
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,164 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_hedger.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "rocksdb/env.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudRequestHedgerTest : public testing::Test {
+ public:
+  // Blocks the calling attempt until Release()
+  void Blocked() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return released_; });
+  }
+  void Release() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  // A tracker whose hedge delay is delay_micros
+  static std::shared_ptr<CloudLatencyTracker> Tracker(uint64_t delay_micros) {
+    auto tracker = std::make_shared<CloudLatencyTracker>(95, 1);
+    for (int i = 0; i < 100; i++) {
+      tracker->Record(delay_micros);
+    }
+    return tracker;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_ = false;
+};
+
+TEST_F(CloudRequestHedgerTest, HedgeDelay) {
+  CloudLatencyTracker tracker(90, 50);
+  ASSERT_FALSE(CloudRequestHedger::ShouldRun(&tracker, 0));
+  ASSERT_TRUE(CloudRequestHedger::ShouldRun(&tracker, 1000));
+  ASSERT_FALSE(CloudRequestHedger::ShouldRun(nullptr, 0));
+  for (uint64_t i = 1; i <= 99; i++) {
+    tracker.Record(i);
+  }
+  ASSERT_EQ(tracker.HedgeDelay(), 0u);
+  tracker.Record(100);
+  ASSERT_EQ(tracker.HedgeDelay(), 90u);
+  ASSERT_TRUE(CloudRequestHedger::ShouldRun(&tracker, 0));
+
+  // Fast requests are hedged no sooner than the minimum delay
+  for (int i = 0; i < 1000; i++) {
+    tracker.Record(10);
+  }
+  ASSERT_EQ(tracker.HedgeDelay(), 50u);
+}
+
+TEST_F(CloudRequestHedgerTest, Hedge) {
+  CloudRequestHedger hedger(4);
+  std::atomic<int> discarded{-1};
+  int winner = -1;
+  // The first attempt is stuck, the second is used
+  auto st = hedger.Run(
+      Tracker(1000),
+      [this](int attempt) {
+        if (attempt == 0) {
+          Blocked();
+        }
+        return IOStatus::OK();
+      },
+      [&discarded](int attempt) { discarded = attempt; }, 0, &winner);
+  ASSERT_OK(st);
+  ASSERT_EQ(winner, 1);
+  ASSERT_EQ(hedger.NumHedged(), 1u);
+  ASSERT_EQ(discarded.load(), -1);
+  // The loser is discarded when it completes
+  Release();
+  while (discarded.load() != 0) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+
+  // Fast requests aren't hedged
+  st = hedger.Run(
+      Tracker(1000000), [](int /*attempt*/) { return IOStatus::OK(); },
+      nullptr, 0, &winner);
+  ASSERT_OK(st);
+  ASSERT_EQ(winner, 0);
+  ASSERT_EQ(hedger.NumHedged(), 1u);
+}
+
+TEST_F(CloudRequestHedgerTest, Failures) {
+  CloudRequestHedger hedger(4);
+  int winner = -1;
+  std::atomic<int> attempts{0};
+  // Failed first attempts aren't hedged
+  auto st = hedger.Run(
+      Tracker(1000000),
+      [&attempts](int /*attempt*/) {
+        attempts++;
+        return IOStatus::IOError("failed");
+      },
+      nullptr, 0, &winner);
+  ASSERT_TRUE(st.IsIOError());
+  ASSERT_EQ(winner, 0);
+  ASSERT_EQ(attempts.load(), 1);
+
+  // A failed hedge waits for the first attempt
+  st = hedger.Run(
+      Tracker(1000),
+      [](int attempt) {
+        if (attempt == 1) {
+          return IOStatus::IOError("failed");
+        }
+        Env::Default()->SleepForMicroseconds(100000);
+        return IOStatus::OK();
+      },
+      nullptr, 0, &winner);
+  ASSERT_OK(st);
+  ASSERT_EQ(winner, 0);
+}
+
+TEST_F(CloudRequestHedgerTest, Timeout) {
+  CloudRequestHedger hedger(4);
+  std::atomic<int> discarded{0};
+  int winner = 0;
+  auto st = hedger.Run(
+      nullptr,
+      [this](int /*attempt*/) {
+        Blocked();
+        return IOStatus::OK();
+      },
+      [&discarded](int /*attempt*/) { discarded++; }, 10000, &winner);
+  ASSERT_TRUE(st.IsTimedOut());
+  ASSERT_EQ(winner, -1);
+  Release();
+  while (discarded.load() != 1) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  ASSERT_EQ(hedger.NumHedged(), 0u);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudRequestHedgerTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
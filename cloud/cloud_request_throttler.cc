@@ -0,0 +1,160 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_throttler.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+// Duration over which the rate of the requests is measured
+constexpr uint64_t kWindowMicros = 1000 * 1000;
+
+struct ThrottlerRegistry {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<CloudRequestThrottler>> throttlers;
+};
+
+ThrottlerRegistry* GetRegistry() {
+  // Never destroyed, requests can still run in static destructors
+  static ThrottlerRegistry* registry = new ThrottlerRegistry();
+  return registry;
+}
+
+thread_local CloudRequestThrottler* current_throttler = nullptr;
+}  // namespace
+
+CloudRequestThrottler* CloudRequestThrottler::Get(const std::string& bucket,
+                                                  const std::string& prefix) {
+  auto* registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  auto& throttler = registry->throttlers[bucket + "/" + prefix];
+  if (!throttler) {
+    throttler.reset(new CloudRequestThrottler(bucket, prefix));
+  }
+  return throttler.get();
+}
+
+std::string CloudRequestThrottler::PrefixOf(const std::string& object_path) {
+  auto pos = object_path.rfind('/');
+  return pos == std::string::npos ? std::string()
+                                  : object_path.substr(0, pos + 1);
+}
+
+void CloudRequestThrottler::GetAllStates(
+    std::vector<CloudRequestRateLimitState>* states) {
+  states->clear();
+  auto* registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  for (const auto& throttler : registry->throttlers) {
+    states->push_back(throttler.second->GetState());
+  }
+}
+
+CloudRequestThrottler* CloudRequestThrottler::Current() {
+  return current_throttler;
+}
+
+CloudRequestThrottler::Scope::Scope(CloudRequestThrottler* throttler)
+    : saved_(current_throttler) {
+  current_throttler = throttler;
+}
+
+CloudRequestThrottler::Scope::~Scope() { current_throttler = saved_; }
+
+CloudRequestThrottler::CloudRequestThrottler(const std::string& bucket,
+                                             const std::string& prefix)
+    : bucket_(bucket), prefix_(prefix) {}
+
+uint64_t CloudRequestThrottler::Reserve(uint64_t now_micros) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (now_micros >= window_start_micros_ + kWindowMicros) {
+    if (window_start_micros_ > 0) {
+      measured_rate_ = window_requests_ * 1e6 /
+                       static_cast<double>(now_micros - window_start_micros_);
+    }
+    window_start_micros_ = now_micros;
+    window_requests_ = 0;
+  }
+  window_requests_++;
+
+  if (rate_ == 0) {
+    return 0;
+  }
+  if (now_micros >= last_decrease_micros_ + kRelaxMicros) {
+    rate_ = 0;
+    tokens_ = 0;
+    return 0;
+  }
+  Refill(now_micros);
+  tokens_ -= 1;
+  if (tokens_ >= 0) {
+    return 0;
+  }
+  uint64_t delay = static_cast<uint64_t>(-tokens_ / rate_ * 1e6);
+  delayed_requests_++;
+  delay_micros_ += delay;
+  return delay;
+}
+
+void CloudRequestThrottler::Refill(uint64_t now_micros) {
+  if (now_micros <= last_refill_micros_) {
+    return;
+  }
+  double seconds = (now_micros - last_refill_micros_) / 1e6;
+  // Additive increase
+  rate_ += kRateIncreasePerSecond * seconds;
+  // Bursts of up to a tenth of a second of requests
+  tokens_ = std::min(tokens_ + rate_ * seconds, std::max(1.0, rate_ / 10));
+  last_refill_micros_ = now_micros;
+}
+
+void CloudRequestThrottler::OnThrottled(uint64_t now_micros) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  throttles_++;
+  if (rate_ > 0 &&
+      now_micros < last_decrease_micros_ + kDecreaseIntervalMicros) {
+    // Part of the burst of throttled responses already accounted for
+    return;
+  }
+  if (rate_ > 0) {
+    Refill(now_micros);
+  }
+  double base = rate_;
+  if (base == 0) {
+    // Not limiting yet, start from the rate at which requests were sent
+    uint64_t elapsed = now_micros > window_start_micros_
+                           ? now_micros - window_start_micros_
+                           : 0;
+    elapsed = std::max(elapsed, kWindowMicros / 10);
+    base = std::max(measured_rate_, window_requests_ * 1e6 / elapsed);
+    tokens_ = 0;
+    last_refill_micros_ = now_micros;
+  }
+  // Multiplicative decrease
+  rate_ = std::max(kMinRate, base / 2);
+  tokens_ = std::min(tokens_, 0.0);
+  last_decrease_micros_ = now_micros;
+}
+
+CloudRequestRateLimitState CloudRequestThrottler::GetState() const {
+  CloudRequestRateLimitState state;
+  state.bucket = bucket_;
+  state.prefix = prefix_;
+  std::lock_guard<std::mutex> lock(mutex_);
+  state.rate = rate_;
+  state.throttles = throttles_;
+  state.delayed_requests = delayed_requests_;
+  state.delay_micros = delay_micros_;
+  return state;
+}
+
+void CloudStorageProvider::GetRequestRateLimits(
+    std::vector<CloudRequestRateLimitState>* states) {
+  CloudRequestThrottler::GetAllStates(states);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
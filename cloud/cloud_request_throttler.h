@@ -0,0 +1,109 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cloud/cloud_storage_provider.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+
+// Client-side limit on the rate of the requests sent to a prefix of a
+// bucket, which cloud object stores throttle past a request rate (S3 answers
+// 503 SlowDown). It does not limit anything until a request is throttled.
+// Then it cuts the allowed rate to half of the rate measured or allowed, at
+// most once per decrease interval so that a burst of throttled responses
+// counts as one, and raises it again linearly for as long as no request is
+// throttled (AIMD). It stops limiting once no request was throttled for a
+// while. Requests over the allowed rate are delayed, not failed.
+//
+// The throttlers are shared by all the users of a prefix in the process.
+// Thread safe.
+class CloudRequestThrottler {
+ public:
+  // Requests per second allowed at least
+  static constexpr double kMinRate = 10;
+  // Requests per second the allowed rate grows by every second without
+  // throttling
+  static constexpr double kRateIncreasePerSecond = 25;
+  static constexpr uint64_t kDecreaseIntervalMicros = 200 * 1000;
+  // Without throttling for that long, the requests are no longer limited
+  static constexpr uint64_t kRelaxMicros = 60 * 1000 * 1000;
+
+  // Returns the throttler of the prefix of bucket, created on first use and
+  // kept until the process exits
+  static CloudRequestThrottler* Get(const std::string& bucket,
+                                    const std::string& prefix);
+
+  // The prefix of object_path which the store limits requests to: its path
+  // up to the last slash
+  static std::string PrefixOf(const std::string& object_path);
+
+  // Returns the states of all the throttlers of the process
+  static void GetAllStates(std::vector<CloudRequestRateLimitState>* states);
+
+  // The throttler the request running on the calling thread goes through,
+  // null if none
+  static CloudRequestThrottler* Current();
+
+  // Sets the throttler of the requests of the calling thread for its
+  // lifetime
+  class Scope {
+   public:
+    explicit Scope(CloudRequestThrottler* throttler);
+    ~Scope();
+
+    // No copying allowed
+    Scope(const Scope&) = delete;
+    void operator=(const Scope&) = delete;
+
+   private:
+    CloudRequestThrottler* saved_;
+  };
+
+  CloudRequestThrottler(const std::string& bucket, const std::string& prefix);
+
+  // No copying allowed
+  CloudRequestThrottler(const CloudRequestThrottler&) = delete;
+  void operator=(const CloudRequestThrottler&) = delete;
+
+  // Takes the slot of a request to be sent at now_micros, and returns how
+  // long to wait before sending it
+  uint64_t Reserve(uint64_t now_micros);
+
+  // A request sent through Reserve() was throttled by the store
+  void OnThrottled(uint64_t now_micros);
+
+  CloudRequestRateLimitState GetState() const;
+
+ private:
+  // Adds the tokens and the rate increase accrued since the last refill.
+  // Requires mutex_ and a limit.
+  void Refill(uint64_t now_micros);
+
+  const std::string bucket_;
+  const std::string prefix_;
+
+  mutable std::mutex mutex_;
+  // Allowed requests per second, 0 when not limiting
+  double rate_ = 0;
+  // Requests that can be sent right away, negative when the requests are
+  // delayed
+  double tokens_ = 0;
+  uint64_t last_refill_micros_ = 0;
+  uint64_t last_decrease_micros_ = 0;
+  // Requests counted in the current measurement window, and the rate
+  // measured over the previous one
+  uint64_t window_start_micros_ = 0;
+  uint64_t window_requests_ = 0;
+  double measured_rate_ = 0;
+
+  uint64_t throttles_ = 0;
+  uint64_t delayed_requests_ = 0;
+  uint64_t delay_micros_ = 0;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
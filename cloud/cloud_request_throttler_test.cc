@@ -0,0 +1,110 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_throttler.h"
+
+#include <gtest/gtest.h>
+
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+TEST(CloudRequestThrottlerTest, Registry) {
+  ASSERT_EQ(CloudRequestThrottler::PrefixOf("db/000012.sst"), "db/");
+  ASSERT_EQ(CloudRequestThrottler::PrefixOf("a/b/CURRENT"), "a/b/");
+  ASSERT_EQ(CloudRequestThrottler::PrefixOf("CURRENT"), "");
+
+  auto* throttler = CloudRequestThrottler::Get("bucket", "db/");
+  ASSERT_EQ(throttler, CloudRequestThrottler::Get("bucket", "db/"));
+  ASSERT_NE(throttler, CloudRequestThrottler::Get("bucket", "other/"));
+  ASSERT_NE(throttler, CloudRequestThrottler::Get("other", "db/"));
+
+  ASSERT_EQ(CloudRequestThrottler::Current(), nullptr);
+  {
+    CloudRequestThrottler::Scope scope(throttler);
+    ASSERT_EQ(CloudRequestThrottler::Current(), throttler);
+  }
+  ASSERT_EQ(CloudRequestThrottler::Current(), nullptr);
+
+  std::vector<CloudRequestRateLimitState> states;
+  CloudStorageProvider::GetRequestRateLimits(&states);
+  bool found = false;
+  for (const auto& state : states) {
+    if (state.bucket == "bucket" && state.prefix == "db/") {
+      found = true;
+    }
+  }
+  ASSERT_TRUE(found);
+}
+
+TEST(CloudRequestThrottlerTest, AdditiveIncreaseMultiplicativeDecrease) {
+  CloudRequestThrottler throttler("bucket", "aimd/");
+  // 1000 requests per second go through until one is throttled
+  uint64_t now = 1000000;
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_EQ(throttler.Reserve(now), 0u);
+    now += 1000;
+  }
+  ASSERT_EQ(throttler.GetState().rate, 0);
+
+  // The rate is halved
+  throttler.OnThrottled(now);
+  auto state = throttler.GetState();
+  ASSERT_EQ(state.throttles, 1u);
+  ASSERT_NEAR(state.rate, 500, 1);
+  // Requests sent at once are spread at 500 per second
+  ASSERT_NEAR(throttler.Reserve(now), 2000, 1);
+  ASSERT_NEAR(throttler.Reserve(now), 4000, 1);
+  state = throttler.GetState();
+  ASSERT_EQ(state.delayed_requests, 2u);
+  ASSERT_NEAR(state.delay_micros, 6000, 2);
+
+  // A burst of throttled responses halves the rate once
+  throttler.OnThrottled(now + 1000);
+  ASSERT_EQ(throttler.GetState().throttles, 2u);
+  ASSERT_NEAR(throttler.GetState().rate, 500, 1);
+  // ... including what it grew by since
+  now += CloudRequestThrottler::kDecreaseIntervalMicros;
+  throttler.OnThrottled(now);
+  double rate = (500 + CloudRequestThrottler::kRateIncreasePerSecond *
+                           CloudRequestThrottler::kDecreaseIntervalMicros /
+                           1e6) /
+                2;
+  ASSERT_NEAR(throttler.GetState().rate, rate, 0.01);
+
+  // Without throttling, the rate grows back steadily
+  now += 2000000;
+  throttler.Reserve(now);
+  rate += 2 * CloudRequestThrottler::kRateIncreasePerSecond;
+  ASSERT_NEAR(throttler.GetState().rate, rate, 0.01);
+  // The rate never drops below the minimum
+  for (int i = 0; i < 20; i++) {
+    now += CloudRequestThrottler::kDecreaseIntervalMicros;
+    throttler.OnThrottled(now);
+  }
+  ASSERT_EQ(throttler.GetState().rate, CloudRequestThrottler::kMinRate);
+
+  // And requests are no longer limited after a while without throttling
+  now += CloudRequestThrottler::kRelaxMicros;
+  ASSERT_EQ(throttler.Reserve(now), 0u);
+  ASSERT_EQ(throttler.GetState().rate, 0);
+  ASSERT_EQ(throttler.Reserve(now), 0u);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudRequestThrottlerTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,442 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_tracer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+#include "cloud/filename.h"
+#include "file/line_file_reader.h"
+#include "file/writable_file_writer.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const char* const kOpTypeNames[kNumCloudRequestOpTypes] = {
+    "read", "write", "list", "create", "delete", "copy", "info"};
+
+bool ParseOpType(const std::string& name, CloudRequestOpType* op) {
+  for (size_t i = 0; i < kNumCloudRequestOpTypes; i++) {
+    if (name == kOpTypeNames[i]) {
+      *op = static_cast<CloudRequestOpType>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// A LRU cache of the extents of objects, charged by their size
+class ExtentLRU {
+ public:
+  explicit ExtentLRU(uint64_t capacity) : capacity_(capacity) {}
+
+  bool Lookup(const std::string& object, uint64_t extent) {
+    auto it = index_.find(Key(object, extent));
+    if (it == index_.end()) {
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.first);
+    return true;
+  }
+
+  void Insert(const std::string& object, uint64_t extent, uint64_t size) {
+    if (size > capacity_) {
+      return;
+    }
+    while (usage_ + size > capacity_) {
+      auto victim = index_.find(lru_.back());
+      usage_ -= victim->second.second;
+      index_.erase(victim);
+      lru_.pop_back();
+    }
+    lru_.push_front(Key(object, extent));
+    index_.emplace(lru_.front(), std::make_pair(lru_.begin(), size));
+    usage_ += size;
+  }
+
+  void Erase(const std::string& object) {
+    auto it = index_.lower_bound(Key(object, 0));
+    while (it != index_.end() && it->first.first == object) {
+      usage_ -= it->second.second;
+      lru_.erase(it->second.first);
+      it = index_.erase(it);
+    }
+  }
+
+ private:
+  using Key = std::pair<std::string, uint64_t>;
+
+  const uint64_t capacity_;
+  uint64_t usage_ = 0;
+  // Most recently used first
+  std::list<Key> lru_;
+  // Ordered, to find the extents of an object
+  std::map<Key, std::pair<std::list<Key>::iterator, uint64_t>> index_;
+};
+
+// A LRU cache of the metadata of objects, whose entries expire
+class MetadataLRU {
+ public:
+  MetadataLRU(size_t capacity, uint64_t ttl_micros)
+      : capacity_(std::max<size_t>(capacity, 1)), ttl_micros_(ttl_micros) {}
+
+  bool Lookup(const std::string& object, uint64_t now) {
+    auto it = index_.find(object);
+    if (it == index_.end()) {
+      return false;
+    }
+    if (it->second.second + ttl_micros_ <= now) {
+      Erase(object);
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.first);
+    return true;
+  }
+
+  void Insert(const std::string& object, uint64_t now) {
+    Erase(object);
+    if (index_.size() >= capacity_) {
+      index_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(object);
+    index_.emplace(object, std::make_pair(lru_.begin(), now));
+  }
+
+  void Erase(const std::string& object) {
+    auto it = index_.find(object);
+    if (it != index_.end()) {
+      lru_.erase(it->second.first);
+      index_.erase(it);
+    }
+  }
+
+ private:
+  const size_t capacity_;
+  const uint64_t ttl_micros_;
+  std::list<std::string> lru_;
+  std::unordered_map<std::string,
+                     std::pair<std::list<std::string>::iterator, uint64_t>>
+      index_;
+};
+}  // namespace
+
+const char* CloudRequestOpTypeName(CloudRequestOpType op) {
+  auto idx = static_cast<size_t>(op);
+  return idx < kNumCloudRequestOpTypes ? kOpTypeNames[idx] : "unknown";
+}
+
+CloudRequestTracer::CloudRequestTracer(
+    std::unique_ptr<WritableFileWriter>&& writer,
+    const std::shared_ptr<SystemClock>& clock)
+    : clock_(clock), writer_(std::move(writer)) {}
+
+CloudRequestTracer::~CloudRequestTracer() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  writer_->Close(IOOptions()).PermitUncheckedError();
+  status_.PermitUncheckedError();
+}
+
+IOStatus CloudRequestTracer::Create(
+    const std::shared_ptr<FileSystem>& fs, const std::string& trace_file,
+    std::unique_ptr<CloudRequestTracer>* result) {
+  std::unique_ptr<WritableFileWriter> writer;
+  auto st = WritableFileWriter::Create(fs, trace_file, FileOptions(), &writer,
+                                       nullptr /*dbg*/);
+  if (st.ok()) {
+    result->reset(
+        new CloudRequestTracer(std::move(writer), SystemClock::Default()));
+  }
+  return st;
+}
+
+uint64_t CloudRequestTracer::NowMicros() const { return clock_->NowMicros(); }
+
+void CloudRequestTracer::Record(CloudRequestOpType op,
+                                const std::string& bucket,
+                                const std::string& object, uint64_t offset,
+                                uint64_t length, uint64_t bytes,
+                                uint64_t start_micros,
+                                const IOStatus& status) {
+  const uint64_t micros = NowMicros() - start_micros;
+  char buf[200];
+  snprintf(buf, sizeof(buf),
+           "%" PRIu64 " %s %d %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64
+           " ",
+           start_micros, CloudRequestOpTypeName(op), status.ok() ? 1 : 0,
+           offset, length, status.ok() ? bytes : 0, micros);
+  std::string line = buf;
+  line.append(bucket);
+  line.push_back(' ');
+  line.append(object);
+  line.push_back('\n');
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (status_.ok()) {
+    status_ = writer_->Append(IOOptions(), line);
+  }
+}
+
+IOStatus CloudRequestTracer::Flush() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (status_.ok()) {
+    status_ = writer_->Flush(IOOptions());
+  }
+  return status_;
+}
+
+IOStatus CloudRequestTracer::ReadTrace(
+    const std::shared_ptr<FileSystem>& fs, const std::string& trace_file,
+    std::vector<CloudRequestTraceRecord>* records) {
+  std::unique_ptr<LineFileReader> reader;
+  auto st = LineFileReader::Create(fs, trace_file, FileOptions(), &reader,
+                                   nullptr /*dbg*/, nullptr /*rate_limiter*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::string line;
+  while (reader->ReadLine(&line, Env::IO_TOTAL)) {
+    std::istringstream in(line);
+    CloudRequestTraceRecord record;
+    std::string op;
+    int ok = 0;
+    in >> record.start_micros >> op >> ok >> record.offset >> record.length >>
+        record.bytes >> record.micros >> record.bucket;
+    // The object is the rest of the line, spaces included
+    if (!in || in.get() != ' ' || !std::getline(in, record.object) ||
+        !ParseOpType(op, &record.op)) {
+      return IOStatus::Corruption(
+          trace_file,
+          "Bad request at line " + std::to_string(reader->GetLineNumber()));
+    }
+    record.ok = ok != 0;
+    records->push_back(std::move(record));
+  }
+  return reader->GetStatus();
+}
+
+uint64_t CloudRequestSimulationStats::TotalRequests() const {
+  uint64_t total = 0;
+  for (auto n : requests) {
+    total += n;
+  }
+  return total;
+}
+
+std::string CloudRequestSimulationStats::ToString() const {
+  std::string result = "requests=" + std::to_string(TotalRequests()) + " (";
+  for (size_t i = 0; i < kNumCloudRequestOpTypes; i++) {
+    if (i > 0) {
+      result.push_back(' ');
+    }
+    result.append(kOpTypeNames[i]);
+    result.push_back('=');
+    result.append(std::to_string(requests[i]));
+  }
+  result.append(") read_bytes=" + std::to_string(read_bytes));
+  result.append(" latency_micros=" + std::to_string(latency_micros));
+  result.append(" cache_hit_bytes=" + std::to_string(cache_hit_bytes));
+  result.append(" readahead_hit_bytes=" + std::to_string(readahead_hit_bytes));
+  result.append(" metadata_cache_hits=" + std::to_string(metadata_cache_hits));
+  return result;
+}
+
+CloudRequestSimulator::CloudRequestSimulator(
+    std::vector<CloudRequestTraceRecord> records)
+    : records_(std::move(records)) {
+  std::stable_sort(records_.begin(), records_.end(),
+                   [](const CloudRequestTraceRecord& a,
+                      const CloudRequestTraceRecord& b) {
+                     return a.start_micros < b.start_micros;
+                   });
+
+  // Least squares fit of micros = base + bytes * micros_per_byte of the
+  // requests that succeeded
+  struct Sums {
+    double n = 0, x = 0, y = 0, xx = 0, xy = 0;
+  } sums[kNumCloudRequestOpTypes];
+  for (const auto& record : records_) {
+    const auto idx = static_cast<size_t>(record.op);
+    trace_stats_.requests[idx]++;
+    trace_stats_.latency_micros += record.micros;
+    if (record.op == CloudRequestOpType::kReadOp) {
+      trace_stats_.read_bytes += record.bytes;
+    }
+    if (record.ok) {
+      auto& s = sums[idx];
+      const double x = static_cast<double>(record.bytes);
+      const double y = static_cast<double>(record.micros);
+      s.n++;
+      s.x += x;
+      s.y += y;
+      s.xx += x * x;
+      s.xy += x * y;
+    }
+  }
+  for (size_t i = 0; i < kNumCloudRequestOpTypes; i++) {
+    const auto& s = sums[i];
+    if (s.n == 0) {
+      continue;
+    }
+    auto& model = latency_[i];
+    const double denom = s.n * s.xx - s.x * s.x;
+    if (denom > 0) {
+      model.micros_per_byte = std::max((s.n * s.xy - s.x * s.y) / denom, 0.0);
+    }
+    model.base_micros =
+        std::max((s.y - model.micros_per_byte * s.x) / s.n, 0.0);
+  }
+}
+
+uint64_t CloudRequestSimulator::EstimateLatency(CloudRequestOpType op,
+                                                uint64_t bytes) const {
+  const auto& model = latency_[static_cast<size_t>(op)];
+  return static_cast<uint64_t>(model.base_micros +
+                               model.micros_per_byte * bytes);
+}
+
+CloudRequestSimulationStats CloudRequestSimulator::Simulate(
+    const CloudRequestSimulationOptions& options) const {
+  CloudRequestSimulationStats stats;
+  const uint64_t extent_size = std::max<uint64_t>(options.cache_extent_size, 1);
+  std::unique_ptr<ExtentLRU> cache;
+  if (options.cache_size > 0) {
+    cache.reset(new ExtentLRU(options.cache_size));
+  }
+  std::unique_ptr<MetadataLRU> metadata_cache;
+  if (options.metadata_cache_ttl_micros > 0) {
+    metadata_cache.reset(new MetadataLRU(options.metadata_cache_capacity,
+                                         options.metadata_cache_ttl_micros));
+  }
+  // The sizes of the objects, as far as the trace tells
+  std::unordered_map<std::string, uint64_t> sizes;
+  // The range of each object last read ahead
+  std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> readahead;
+
+  auto send = [&](CloudRequestOpType op, uint64_t bytes, uint64_t micros) {
+    stats.requests[static_cast<size_t>(op)]++;
+    stats.latency_micros += micros;
+    if (op == CloudRequestOpType::kReadOp) {
+      stats.read_bytes += bytes;
+    }
+  };
+  // Reads [start, end) of object, through the cache, for record
+  auto fetch = [&](const CloudRequestTraceRecord& record,
+                   const std::string& object, uint64_t start, uint64_t end) {
+    if (!cache) {
+      const bool same = start == record.offset &&
+                        end == record.offset + record.bytes;
+      send(CloudRequestOpType::kReadOp, end - start,
+           same ? record.micros
+                : EstimateLatency(CloudRequestOpType::kReadOp, end - start));
+      return;
+    }
+    auto size_it = sizes.find(object);
+    for (uint64_t extent = start / extent_size; extent * extent_size < end;
+         extent++) {
+      const uint64_t extent_start = extent * extent_size;
+      uint64_t extent_end = extent_start + extent_size;
+      if (size_it != sizes.end() && size_it->second > extent_start) {
+        extent_end = std::min(extent_end, size_it->second);
+      }
+      if (cache->Lookup(object, extent)) {
+        stats.cache_hit_bytes +=
+            std::min(end, extent_end) - std::max(start, extent_start);
+        continue;
+      }
+      const uint64_t len = extent_end - extent_start;
+      send(CloudRequestOpType::kReadOp, len,
+           EstimateLatency(CloudRequestOpType::kReadOp, len));
+      cache->Insert(object, extent, len);
+    }
+  };
+
+  for (const auto& record : records_) {
+    const std::string object = record.bucket + pathsep + record.object;
+    switch (record.op) {
+      case CloudRequestOpType::kReadOp: {
+        const uint64_t start = record.offset;
+        const uint64_t end = record.offset + record.bytes;
+        if (!record.ok || start == end) {
+          send(record.op, record.bytes, record.micros);
+          break;
+        }
+        if (record.bytes < record.length) {
+          // A short read ends at the end of the object
+          sizes[object] = end;
+        }
+        if (options.readahead_size == 0) {
+          fetch(record, object, start, end);
+          break;
+        }
+        auto it = readahead.find(object);
+        if (it != readahead.end() && it->second.first <= start &&
+            end <= it->second.second) {
+          stats.readahead_hit_bytes += end - start;
+          break;
+        }
+        uint64_t fetch_start = start;
+        uint64_t fetch_end = end;
+        if (it != readahead.end() && it->second.first <= start &&
+            start <= it->second.second) {
+          // A sequential read: fetch what follows, further ahead
+          const auto& range = it->second;
+          stats.readahead_hit_bytes += range.second - start;
+          fetch_start = range.second;
+          fetch_end = std::max(
+              end, fetch_start + std::min(options.readahead_size,
+                                          2 * (range.second - range.first)));
+          auto size_it = sizes.find(object);
+          if (size_it != sizes.end()) {
+            fetch_end = std::max(end, std::min(fetch_end, size_it->second));
+          }
+        }
+        readahead[object] = std::make_pair(fetch_start, fetch_end);
+        fetch(record, object, fetch_start, fetch_end);
+        break;
+      }
+      case CloudRequestOpType::kInfoOp:
+        if (record.ok) {
+          sizes[object] = record.length;
+        }
+        if (metadata_cache && record.ok) {
+          if (metadata_cache->Lookup(object, record.start_micros)) {
+            stats.metadata_cache_hits++;
+            break;
+          }
+          metadata_cache->Insert(object, record.start_micros);
+        }
+        send(record.op, record.bytes, record.micros);
+        break;
+      case CloudRequestOpType::kWriteOp:
+      case CloudRequestOpType::kDeleteOp:
+      case CloudRequestOpType::kCopyOp:
+        // The object changed
+        sizes.erase(object);
+        readahead.erase(object);
+        if (cache) {
+          cache->Erase(object);
+        }
+        if (metadata_cache) {
+          metadata_cache->Erase(object);
+        }
+        send(record.op, record.bytes, record.micros);
+        break;
+      default:
+        send(record.op, record.bytes, record.micros);
+        break;
+    }
+  }
+  return stats;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,146 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class FileSystem;
+class SystemClock;
+class WritableFileWriter;
+
+// A request sent to the storage provider
+struct CloudRequestTraceRecord {
+  // When the request was sent
+  uint64_t start_micros = 0;
+  CloudRequestOpType op = CloudRequestOpType::kReadOp;
+  bool ok = false;
+  // The range requested. Whole objects are read and written from offset 0.
+  // The length of an info request is the size of the object.
+  uint64_t offset = 0;
+  uint64_t length = 0;
+  // The bytes read or written, 0 if the request failed
+  uint64_t bytes = 0;
+  uint64_t micros = 0;
+  std::string bucket;
+  std::string object;
+};
+
+constexpr size_t kNumCloudRequestOpTypes =
+    static_cast<size_t>(CloudRequestOpType::kInfoOp) + 1;
+
+const char* CloudRequestOpTypeName(CloudRequestOpType op);
+
+// Appends the requests sent to the storage provider to a trace file, one
+// line per request:
+//   <start_micros> <op> <ok> <offset> <length> <bytes> <micros> <bucket>
+//   <object>
+// The requests are written as they complete, so that the lines are roughly
+// but not strictly ordered by start_micros.
+//
+// Thread safe.
+class CloudRequestTracer {
+ public:
+  static IOStatus Create(const std::shared_ptr<FileSystem>& fs,
+                         const std::string& trace_file,
+                         std::unique_ptr<CloudRequestTracer>* result);
+  // Flushes the trace
+  ~CloudRequestTracer();
+
+  uint64_t NowMicros() const;
+
+  // Records a request sent at start_micros that completed now with status
+  void Record(CloudRequestOpType op, const std::string& bucket,
+              const std::string& object, uint64_t offset, uint64_t length,
+              uint64_t bytes, uint64_t start_micros, const IOStatus& status);
+
+  IOStatus Flush();
+
+  // Parses a trace written by a CloudRequestTracer
+  static IOStatus ReadTrace(const std::shared_ptr<FileSystem>& fs,
+                            const std::string& trace_file,
+                            std::vector<CloudRequestTraceRecord>* records);
+
+ private:
+  CloudRequestTracer(std::unique_ptr<WritableFileWriter>&& writer,
+                     const std::shared_ptr<SystemClock>& clock);
+
+  std::shared_ptr<SystemClock> clock_;
+  std::mutex mutex_;
+  std::unique_ptr<WritableFileWriter> writer_;
+  // The first error writing the trace, which stops it
+  IOStatus status_;
+};
+
+// What would change in front of the storage provider
+struct CloudRequestSimulationOptions {
+  // Capacity of a local LRU cache of the extents of the objects read, as
+  // CloudFileSystemOptions::sst_file_cache. 0 for no cache.
+  uint64_t cache_size = 0;
+  uint64_t cache_extent_size = 1ull << 20;
+
+  // The reads that continue the last one of an object fetch up to this many
+  // bytes ahead, as CloudFileSystemOptions::cloud_readahead_size. 0 for no
+  // readahead.
+  uint64_t readahead_size = 0;
+
+  // How long the results of the info requests are cached, as
+  // CloudFileSystemOptions::cloud_metadata_cache_ttl_micros. 0 for no cache.
+  uint64_t metadata_cache_ttl_micros = 0;
+  // Capacity in objects of the metadata cache
+  size_t metadata_cache_capacity = 100000;
+};
+
+struct CloudRequestSimulationStats {
+  uint64_t requests[kNumCloudRequestOpTypes] = {};
+  uint64_t read_bytes = 0;
+  uint64_t latency_micros = 0;
+  // The reads, or parts of them, served locally
+  uint64_t cache_hit_bytes = 0;
+  uint64_t readahead_hit_bytes = 0;
+  uint64_t metadata_cache_hits = 0;
+
+  uint64_t TotalRequests() const;
+  std::string ToString() const;
+};
+
+// Replays a trace of cloud requests in front of simulated caches and
+// readahead, to estimate the requests they would save. The requests that
+// are not served locally are charged the latency of the requests of the
+// trace of the same type and size, from a linear fit of the trace. Best used
+// with a trace captured without sst_file_cache and cloud_readahead_size, the
+// requests of which are the reads of the DB.
+class CloudRequestSimulator {
+ public:
+  explicit CloudRequestSimulator(std::vector<CloudRequestTraceRecord> records);
+
+  // The requests of the trace, as they were sent
+  const CloudRequestSimulationStats& GetTraceStats() const {
+    return trace_stats_;
+  }
+
+  CloudRequestSimulationStats Simulate(
+      const CloudRequestSimulationOptions& options) const;
+
+  // The estimated latency of a request of the given type and size
+  uint64_t EstimateLatency(CloudRequestOpType op, uint64_t bytes) const;
+
+ private:
+  struct LatencyModel {
+    double base_micros = 0;
+    double micros_per_byte = 0;
+  };
+
+  std::vector<CloudRequestTraceRecord> records_;
+  LatencyModel latency_[kNumCloudRequestOpTypes];
+  CloudRequestSimulationStats trace_stats_;
+};
+
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
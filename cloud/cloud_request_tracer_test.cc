@@ -0,0 +1,182 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_request_tracer.h"
+
+#include <gtest/gtest.h>
+
+#include "file/file_util.h"
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudRequestTracerTest : public testing::Test {
+ public:
+  // Adds a request that takes 1000us plus 10us per byte
+  void Add(uint64_t start_micros, CloudRequestOpType op, uint64_t offset,
+           uint64_t length, const std::string& object = "db/000010.sst") {
+    CloudRequestTraceRecord record;
+    record.start_micros = start_micros;
+    record.op = op;
+    record.ok = true;
+    record.offset = offset;
+    record.length = length;
+    record.bytes = op == CloudRequestOpType::kInfoOp ? 0 : length;
+    record.micros = 1000 + 10 * record.bytes;
+    record.bucket = "test";
+    record.object = object;
+    records_.push_back(record);
+  }
+
+  std::vector<CloudRequestTraceRecord> records_;
+};
+
+TEST_F(CloudRequestTracerTest, ReadTrace) {
+  auto fs = FileSystem::Default();
+  auto trace_file = test::PerThreadDBPath("cloud_request_tracer_test");
+  {
+    std::unique_ptr<CloudRequestTracer> tracer;
+    ASSERT_OK(CloudRequestTracer::Create(fs, trace_file, &tracer));
+    auto start = tracer->NowMicros();
+    tracer->Record(CloudRequestOpType::kReadOp, "test", "db/000010.sst", 100,
+                   50, 40, start, IOStatus::OK());
+    tracer->Record(CloudRequestOpType::kInfoOp, "test", "db/with space", 0, 7,
+                   0, start, IOStatus::OK());
+    tracer->Record(CloudRequestOpType::kWriteOp, "test", "db/000011.sst", 0,
+                   10, 10, start, IOStatus::IOError("failed"));
+  }
+  std::vector<CloudRequestTraceRecord> records;
+  ASSERT_OK(CloudRequestTracer::ReadTrace(fs, trace_file, &records));
+  ASSERT_EQ(records.size(), 3u);
+  ASSERT_EQ(records[0].op, CloudRequestOpType::kReadOp);
+  ASSERT_TRUE(records[0].ok);
+  ASSERT_EQ(records[0].offset, 100u);
+  ASSERT_EQ(records[0].length, 50u);
+  ASSERT_EQ(records[0].bytes, 40u);
+  ASSERT_EQ(records[0].bucket, "test");
+  ASSERT_EQ(records[0].object, "db/000010.sst");
+  ASSERT_EQ(records[1].op, CloudRequestOpType::kInfoOp);
+  ASSERT_EQ(records[1].length, 7u);
+  ASSERT_EQ(records[1].object, "db/with space");
+  ASSERT_EQ(records[2].op, CloudRequestOpType::kWriteOp);
+  ASSERT_FALSE(records[2].ok);
+  ASSERT_EQ(records[2].bytes, 0u);
+
+  ASSERT_OK(WriteStringToFile(Env::Default(), "1 read 1 0\n", trace_file));
+  ASSERT_TRUE(
+      CloudRequestTracer::ReadTrace(fs, trace_file, &records).IsCorruption());
+  ASSERT_OK(fs->DeleteFile(trace_file, IOOptions(), nullptr));
+}
+
+TEST_F(CloudRequestTracerTest, SimulateNothing) {
+  Add(0, CloudRequestOpType::kInfoOp, 0, 1 << 20);
+  Add(1, CloudRequestOpType::kReadOp, 0, 100);
+  Add(2, CloudRequestOpType::kReadOp, 100, 300);
+  Add(3, CloudRequestOpType::kWriteOp, 0, 1000, "db/000011.sst");
+  CloudRequestSimulator simulator(records_);
+  const auto& trace = simulator.GetTraceStats();
+  ASSERT_EQ(trace.TotalRequests(), 4u);
+  ASSERT_EQ(trace.requests[static_cast<size_t>(CloudRequestOpType::kReadOp)],
+            2u);
+  ASSERT_EQ(trace.read_bytes, 400u);
+
+  // The requests are replayed as they were
+  auto stats = simulator.Simulate(CloudRequestSimulationOptions());
+  ASSERT_EQ(stats.ToString(), trace.ToString());
+
+  // Latencies are fitted from the trace
+  ASSERT_NEAR(simulator.EstimateLatency(CloudRequestOpType::kReadOp, 1000),
+              11000, 1);
+  ASSERT_NEAR(simulator.EstimateLatency(CloudRequestOpType::kInfoOp, 0), 1000,
+              1);
+}
+
+TEST_F(CloudRequestTracerTest, SimulateCache) {
+  const uint64_t kExtent = 1 << 20;
+  Add(0, CloudRequestOpType::kInfoOp, 0, 4 * kExtent);
+  Add(1, CloudRequestOpType::kReadOp, 0, 100);
+  Add(2, CloudRequestOpType::kReadOp, kExtent - 100, 200);
+  Add(3, CloudRequestOpType::kReadOp, 1000, 100);
+  // Overwritten, the cached extents are dropped
+  Add(4, CloudRequestOpType::kWriteOp, 0, 4 * kExtent);
+  Add(5, CloudRequestOpType::kReadOp, 0, 100);
+  CloudRequestSimulator simulator(records_);
+
+  CloudRequestSimulationOptions options;
+  options.cache_size = 10 * kExtent;
+  options.cache_extent_size = kExtent;
+  auto stats = simulator.Simulate(options);
+  // Extents 0, 1 and 0 again
+  ASSERT_EQ(stats.requests[static_cast<size_t>(CloudRequestOpType::kReadOp)],
+            3u);
+  ASSERT_EQ(stats.read_bytes, 3 * kExtent);
+  ASSERT_EQ(stats.cache_hit_bytes, 200u);
+
+  // Only one extent fits
+  options.cache_size = kExtent;
+  stats = simulator.Simulate(options);
+  ASSERT_EQ(stats.requests[static_cast<size_t>(CloudRequestOpType::kReadOp)],
+            4u);
+}
+
+TEST_F(CloudRequestTracerTest, SimulateReadahead) {
+  Add(0, CloudRequestOpType::kReadOp, 0, 100);
+  Add(1, CloudRequestOpType::kReadOp, 100, 100);
+  Add(2, CloudRequestOpType::kReadOp, 200, 100);
+  Add(3, CloudRequestOpType::kReadOp, 300, 100);
+  Add(4, CloudRequestOpType::kReadOp, 0, 100);
+  CloudRequestSimulator simulator(records_);
+
+  CloudRequestSimulationOptions options;
+  options.readahead_size = 1 << 20;
+  auto stats = simulator.Simulate(options);
+  // [0, 100), then [100, 300) read ahead, then [300, 700), then [0, 100)
+  ASSERT_EQ(stats.requests[static_cast<size_t>(CloudRequestOpType::kReadOp)],
+            4u);
+  ASSERT_EQ(stats.readahead_hit_bytes, 100u);
+  ASSERT_EQ(stats.read_bytes, 100u + 200u + 400u + 100u);
+}
+
+TEST_F(CloudRequestTracerTest, SimulateMetadataCache) {
+  Add(0, CloudRequestOpType::kInfoOp, 0, 100);
+  Add(10, CloudRequestOpType::kInfoOp, 0, 100);
+  Add(20, CloudRequestOpType::kInfoOp, 0, 100, "db/000011.sst");
+  Add(100, CloudRequestOpType::kInfoOp, 0, 100);
+  CloudRequestSimulator simulator(records_);
+
+  CloudRequestSimulationOptions options;
+  options.metadata_cache_ttl_micros = 50;
+  auto stats = simulator.Simulate(options);
+  ASSERT_EQ(stats.requests[static_cast<size_t>(CloudRequestOpType::kInfoOp)],
+            3u);
+  ASSERT_EQ(stats.metadata_cache_hits, 1u);
+
+  options.metadata_cache_ttl_micros = 1000;
+  stats = simulator.Simulate(options);
+  ASSERT_EQ(stats.metadata_cache_hits, 2u);
+
+  // Only the last object fits
+  options.metadata_cache_capacity = 1;
+  stats = simulator.Simulate(options);
+  ASSERT_EQ(stats.metadata_cache_hits, 1u);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudRequestTracerTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
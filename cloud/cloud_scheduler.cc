@@ -2,42 +2,34 @@
 #ifndef ROCKSDB_LITE
 #include "cloud/cloud_scheduler.h"
 
+#include <cassert>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-struct ScheduledJob {
-  ScheduledJob(long _id, std::chrono::steady_clock::time_point _when,
-               std::chrono::microseconds _frequency,
-               std::function<void(void*)> _callback, void* _arg)
-      : id(_id),
-        when(_when),
-        frequency(_frequency),
-        callback(_callback),
-        arg(_arg) {}
-
-  long id;
-  std::chrono::steady_clock::time_point when;
-  std::chrono::microseconds frequency;
-  std::function<void(void*)> callback;
-
-  // Caller is responsible for the lifetime of arg.
-  void* arg;
-};
-
-struct Comp {
-  bool operator()(const ScheduledJob& a, const ScheduledJob& b) const {
-    return a.when < b.when;
-  }
-};
-
+// Jobs are kept in a hierarchical timer wheel: kWheelLevels levels of
+// kWheelSlots slots each, where a slot of level 0 spans one tick and a slot of
+// level l spans kWheelSlots^l ticks. Scheduling and canceling a job are O(1)
+// regardless of how many jobs are pending. When the wheel reaches a slot of a
+// higher level, its jobs are cascaded to the lower levels; when it reaches a
+// slot of level 0, its jobs move to a small heap ordered by their exact due
+// time, so that jobs still run on time rather than on a tick boundary.
+//
+// A timer thread only moves due jobs to a pool of executor threads, so that a
+// long running callback does not delay the other jobs. A recurring job is
+// rescheduled once its callback returns, and so never runs concurrently with
+// itself.
 class CloudSchedulerImpl : public CloudScheduler {
  public:
   CloudSchedulerImpl();
@@ -53,24 +45,96 @@ class CloudSchedulerImpl : public CloudScheduler {
 
   size_t TEST_NumScheduledJobs() const override {
     std::lock_guard<std::mutex> lk(mutex_);
-    return scheduled_jobs_.size();
+    return jobs_.size();
   }
 
  private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::microseconds kTick{1000};
+  static constexpr int kWheelBits = 8;
+  static constexpr uint64_t kWheelSlots = 1ull << kWheelBits;
+  static constexpr uint64_t kWheelMask = kWheelSlots - 1;
+  // With 1ms ticks, the wheel spans about 49 days. Jobs due later are parked
+  // in the last slots of the top level and cascaded again.
+  static constexpr int kWheelLevels = 4;
+  static constexpr size_t kNumExecutorThreads = 4;
+
+  enum class JobState {
+    kWheel,    // In a slot of the wheel
+    kDue,      // In due_jobs_ until its exact due time
+    kReady,    // In ready_jobs_, waiting for an executor thread
+    kRunning,  // Its callback is running
+  };
+
+  struct ScheduledJob {
+    Clock::time_point when;
+    std::chrono::microseconds frequency;
+    std::function<void(void*)> callback;
+    // Caller is responsible for the lifetime of arg.
+    void* arg;
+
+    JobState state;
+    // Valid if state is kWheel
+    int level;
+    uint64_t slot;
+    std::list<long>::iterator pos;
+    // Valid if state is kRunning
+    std::thread::id thread;
+    // Canceled by its own callback; not rescheduled
+    bool canceled = false;
+  };
+
+  using DueJob = std::pair<Clock::time_point, long>;
+
+  long AddJob(std::chrono::microseconds when,
+              std::chrono::microseconds frequency,
+              std::function<void(void*)> callback, void* arg);
+  // The following REQUIRE: mutex_ is held
+  uint64_t TickOf(Clock::time_point time) const;
+  Clock::time_point StartOf(uint64_t tick) const;
+  // Queues the job according to its due time
+  void Enqueue(long id, ScheduledJob* job);
+  // Removes the job from the wheel. Entries of due_jobs_ and ready_jobs_ are
+  // dropped when they are popped and the job is gone.
+  void Unlink(ScheduledJob* job);
+  // Moves the wheel up to the tick of now
+  void Advance(Clock::time_point now);
+  // The time at which the timer thread may have something to do next
+  Clock::time_point NextWakeup() const;
+  void Cascade(int level, uint64_t slot);
+
+  // Body of the timer thread
+  void RunTimer();
+  // Body of the executor threads
   void DoWork();
-  long next_id_;
 
   mutable std::mutex mutex_;
-  // Notified when the earliest job to be scheduled has changed or
-  // currently_running_ has changed.
-  std::condition_variable jobs_changed_cv_;
-  std::multiset<ScheduledJob, Comp> scheduled_jobs_;
-  // Whether the job in the front of scheduled_jobs_ is running
-  bool currently_running_;
+  // Notified when a job was queued ahead of next_wakeup_
+  std::condition_variable timer_cv_;
+  // Notified when a job was added to ready_jobs_
+  std::condition_variable ready_cv_;
+  // Notified when a callback has returned
+  std::condition_variable done_cv_;
+
+  long next_id_{1};
+  // All jobs that are scheduled or running, by id
+  std::unordered_map<long, ScheduledJob> jobs_;
+
+  const Clock::time_point start_;
+  // The last tick the wheel was moved to
+  uint64_t current_tick_{0};
+  std::vector<std::list<long>> wheel_[kWheelLevels];
+  size_t wheel_size_{0};
+  std::priority_queue<DueJob, std::vector<DueJob>, std::greater<DueJob>>
+      due_jobs_;
+  std::deque<long> ready_jobs_;
+  Clock::time_point next_wakeup_;
 
   bool shutting_down_{false};
 
-  std::unique_ptr<std::thread> thread_;
+  std::unique_ptr<std::thread> timer_thread_;
+  std::vector<std::thread> executor_threads_;
 };
 // Implementation of a CloudScheduler that keeps track of the jobs
 // it scheduled.  Only cleans up those jobs on exit or cancel.
@@ -205,70 +269,79 @@ std::shared_ptr<CloudScheduler> CloudScheduler::Get() {
   return result;
 }
 
-CloudSchedulerImpl::CloudSchedulerImpl() {
-  next_id_ = 1;
-  currently_running_ = false;
-  auto lambda = [this]() { DoWork(); };
-  thread_.reset(new std::thread(lambda));
+CloudSchedulerImpl::CloudSchedulerImpl()
+    : start_(Clock::now()), next_wakeup_(Clock::time_point::max()) {
+  for (auto& level : wheel_) {
+    level.resize(kWheelSlots);
+  }
+  timer_thread_.reset(new std::thread([this]() { RunTimer(); }));
+  for (size_t i = 0; i < kNumExecutorThreads; i++) {
+    executor_threads_.emplace_back([this]() { DoWork(); });
+  }
 }
 
 CloudSchedulerImpl::~CloudSchedulerImpl() {
+  // Destroy the callbacks once mutex_ is released
+  std::unordered_map<long, ScheduledJob> jobs;
   {
     std::lock_guard<std::mutex> lk(mutex_);
     shutting_down_ = true;
-    scheduled_jobs_.clear();
-    jobs_changed_cv_.notify_all();
+    jobs.swap(jobs_);
+    for (auto& level : wheel_) {
+      for (auto& slot : level) {
+        slot.clear();
+      }
+    }
+    wheel_size_ = 0;
+    due_jobs_ = decltype(due_jobs_)();
+    ready_jobs_.clear();
+    timer_cv_.notify_all();
+    ready_cv_.notify_all();
+    done_cv_.notify_all();
+  }
+  if (timer_thread_ && timer_thread_->joinable()) {
+    timer_thread_->join();
   }
-  if (thread_ && thread_->joinable()) {
-    thread_->join();
+  timer_thread_.reset();
+  for (auto& t : executor_threads_) {
+    t.join();
   }
-  thread_.reset();
+  executor_threads_.clear();
 }
 
 long CloudSchedulerImpl::ScheduleJob(std::chrono::microseconds when,
                                      std::function<void(void*)> callback,
                                      void* arg) {
-  std::lock_guard<std::mutex> lk(mutex_);
-  long id = next_id_++;
-
-  auto time = std::chrono::steady_clock::now() + when;
-  auto itr = scheduled_jobs_.emplace(id, time, std::chrono::microseconds(0),
-                                     callback, arg);
-
-  if (itr == scheduled_jobs_.begin()) {
-    jobs_changed_cv_.notify_all();
-  }
-  return id;
+  return AddJob(when, std::chrono::microseconds(0), std::move(callback), arg);
 }
 
 long CloudSchedulerImpl::ScheduleRecurringJob(
     std::chrono::microseconds when, std::chrono::microseconds frequency,
     std::function<void(void*)> callback, void* arg) {
+  return AddJob(when, frequency, std::move(callback), arg);
+}
+
+long CloudSchedulerImpl::AddJob(std::chrono::microseconds when,
+                                std::chrono::microseconds frequency,
+                                std::function<void(void*)> callback,
+                                void* arg) {
   std::lock_guard<std::mutex> lk(mutex_);
   long id = next_id_++;
-
-  auto time = std::chrono::steady_clock::now() + when;
-  auto itr = scheduled_jobs_.emplace(id, time, frequency, callback, arg);
-  if (itr == scheduled_jobs_.begin()) {
-    jobs_changed_cv_.notify_all();
-  }
+  auto& job = jobs_[id];
+  job.when = Clock::now() + when;
+  job.frequency = frequency;
+  job.callback = std::move(callback);
+  job.arg = arg;
+  Enqueue(id, &job);
   return id;
 }
 
 bool CloudSchedulerImpl::IsScheduled(long id) {
   if (id < 0) {
     return false;
-  } else {
-    std::unique_lock<std::mutex> lk(mutex_);
-    if (!scheduled_jobs_.empty()) {
-      for (const auto& job : scheduled_jobs_) {
-        if (job.id == id) {
-          return true;
-        }
-      }
-    }
-    return false;
   }
+  std::lock_guard<std::mutex> lk(mutex_);
+  return jobs_.find(id) != jobs_.end();
 }
 
 bool CloudSchedulerImpl::CancelJob(long id) {
@@ -276,78 +349,219 @@ bool CloudSchedulerImpl::CancelJob(long id) {
     return false;
   }
 
+  // Destroyed once mutex_ is released
+  std::function<void(void*)> callback;
   std::unique_lock<std::mutex> lk(mutex_);
-  jobs_changed_cv_.wait(lk, [this, id]() {
-    // No job is scheduled. Good to continue.
-    if (scheduled_jobs_.empty()) {
-      return true;
+  auto it = jobs_.find(id);
+  if (it == jobs_.end()) {
+    return false;
+  }
+  if (it->second.state == JobState::kRunning) {
+    if (it->second.thread == std::this_thread::get_id()) {
+      // Canceled by its own callback, which can't be waited for
+      it->second.canceled = true;
+      return it->second.frequency.count() > 0;
     }
+    // The job is running. Wait for it to finish: it is either done or, if it
+    // is recurring, rescheduled
+    done_cv_.wait(lk, [this, id, &it]() {
+      it = jobs_.find(id);
+      return it == jobs_.end() || it->second.state != JobState::kRunning;
+    });
+    if (it == jobs_.end()) {
+      return false;
+    }
+  }
+  Unlink(&it->second);
+  callback = std::move(it->second.callback);
+  jobs_.erase(it);
+  return true;
+}
 
-    // Front of the queue is not this job. That means this job is not running.
-    // We're clear to cancel this job.
-    if (scheduled_jobs_.begin()->id != id) {
-      return true;
+uint64_t CloudSchedulerImpl::TickOf(Clock::time_point time) const {
+  if (time <= start_) {
+    return 0;
+  }
+  return static_cast<uint64_t>((time - start_) / kTick);
+}
+
+CloudSchedulerImpl::Clock::time_point CloudSchedulerImpl::StartOf(
+    uint64_t tick) const {
+  return start_ + static_cast<int64_t>(tick) * kTick;
+}
+
+void CloudSchedulerImpl::Enqueue(long id, ScheduledJob* job) {
+  auto tick = TickOf(job->when);
+  if (tick <= current_tick_) {
+    job->state = JobState::kDue;
+    due_jobs_.emplace(job->when, id);
+  } else {
+    // The lowest level whose span covers the due time; slots of the current
+    // rotation of each level were cascaded already, so the job always lands in
+    // a slot ahead
+    auto delta = tick - current_tick_;
+    int level = 0;
+    while (level < kWheelLevels - 1 &&
+           (delta >> (kWheelBits * (level + 1))) != 0) {
+      level++;
+    }
+    if ((delta >> (kWheelBits * kWheelLevels)) != 0) {
+      tick = current_tick_ + (1ull << (kWheelBits * kWheelLevels)) - 1;
     }
+    job->state = JobState::kWheel;
+    job->level = level;
+    job->slot = (tick >> (kWheelBits * level)) & kWheelMask;
+    auto& slot = wheel_[level][job->slot];
+    job->pos = slot.insert(slot.end(), id);
+    wheel_size_++;
+  }
+  if (job->when < next_wakeup_) {
+    next_wakeup_ = job->when;
+    timer_cv_.notify_one();
+  }
+}
 
-    // Front of the queue is the current job. That means only continue if this
-    // job is not running. If it's still running, wait.
-    return !currently_running_;
-  });
-
-  for (auto it = scheduled_jobs_.begin(); it != scheduled_jobs_.end(); ++it) {
-    if (it->id == id) {
-      bool is_first = (it == scheduled_jobs_.begin());
-      scheduled_jobs_.erase(it);
-      if (is_first) {
-        jobs_changed_cv_.notify_all();
+void CloudSchedulerImpl::Unlink(ScheduledJob* job) {
+  if (job->state == JobState::kWheel) {
+    wheel_[job->level][job->slot].erase(job->pos);
+    wheel_size_--;
+  }
+}
+
+void CloudSchedulerImpl::Cascade(int level, uint64_t slot) {
+  std::list<long> ids;
+  ids.swap(wheel_[level][slot]);
+  wheel_size_ -= ids.size();
+  for (auto id : ids) {
+    auto it = jobs_.find(id);
+    assert(it != jobs_.end());
+    Enqueue(id, &it->second);
+  }
+}
+
+void CloudSchedulerImpl::Advance(Clock::time_point now) {
+  auto now_tick = TickOf(now);
+  while (current_tick_ < now_tick) {
+    if (wheel_size_ == 0) {
+      current_tick_ = now_tick;
+      break;
+    }
+    current_tick_++;
+    // Higher levels first, as they cascade to the slots of the lower ones
+    // reached at the same tick
+    for (int level = kWheelLevels - 1; level >= 0; level--) {
+      auto shift = kWheelBits * level;
+      if ((current_tick_ & ((1ull << shift) - 1)) == 0) {
+        Cascade(level, (current_tick_ >> shift) & kWheelMask);
       }
-      return true;
     }
   }
-  return false;
+}
+
+CloudSchedulerImpl::Clock::time_point CloudSchedulerImpl::NextWakeup() const {
+  auto next = Clock::time_point::max();
+  if (!due_jobs_.empty()) {
+    next = due_jobs_.top().first;
+  }
+  if (wheel_size_ > 0) {
+    // The next slot of level 0 that has jobs, or the next cascade
+    auto tick = current_tick_ + 1;
+    while ((tick & kWheelMask) != 0 && wheel_[0][tick & kWheelMask].empty()) {
+      tick++;
+    }
+    next = std::min(next, StartOf(tick));
+  }
+  return next;
+}
+
+void CloudSchedulerImpl::RunTimer() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (!shutting_down_) {
+    auto now = Clock::now();
+    Advance(now);
+    bool ready = false;
+    while (!due_jobs_.empty() && due_jobs_.top().first <= now) {
+      auto id = due_jobs_.top().second;
+      due_jobs_.pop();
+      auto it = jobs_.find(id);
+      if (it == jobs_.end() || it->second.state != JobState::kDue) {
+        // Canceled
+        continue;
+      }
+      it->second.state = JobState::kReady;
+      ready_jobs_.push_back(id);
+      ready = true;
+    }
+    if (ready) {
+      ready_cv_.notify_all();
+    }
+    next_wakeup_ = NextWakeup();
+    if (next_wakeup_ == Clock::time_point::max()) {
+      timer_cv_.wait(lk);
+    } else {
+      timer_cv_.wait_until(lk, next_wakeup_);
+    }
+  }
 }
 
 void CloudSchedulerImpl::DoWork() {
+  std::unique_lock<std::mutex> lk(mutex_);
   while (true) {
+    ready_cv_.wait(lk,
+                   [this]() { return shutting_down_ || !ready_jobs_.empty(); });
+    if (shutting_down_) {
+      break;
+    }
     // This sync point has to be put before locking mutex_, otherwise
     // CancelJob won't be able to acquire mutex when called
+    lk.unlock();
     TEST_SYNC_POINT("CloudSchedulerImpl::DoWork:BeforeGetJob");
-    std::unique_lock<std::mutex> lk(mutex_);
+    lk.lock();
     if (shutting_down_) {
       break;
     }
-    if (scheduled_jobs_.empty()) {
-      jobs_changed_cv_.wait(lk);
+    if (ready_jobs_.empty()) {
       continue;
     }
-    auto earliest_job = scheduled_jobs_.begin();
-    auto earliest_job_time = earliest_job->when;
-    if (earliest_job_time >= std::chrono::steady_clock::now()) {
-      jobs_changed_cv_.wait_until(lk, earliest_job_time);
+    auto id = ready_jobs_.front();
+    ready_jobs_.pop_front();
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || it->second.state != JobState::kReady) {
+      // Canceled
       continue;
     }
-
-    currently_running_ = true;
+    auto& job = it->second;
+    job.state = JobState::kRunning;
+    job.thread = std::this_thread::get_id();
+    auto callback = job.callback;
+    auto arg = job.arg;
     lk.unlock();
 
     // invoke the function
-    earliest_job->callback(earliest_job->arg);
+    callback(arg);
+    callback = nullptr;
 
     lk.lock();
-    // Finished running the job. Remove it from the queue.
-    currently_running_ = false;
-
-    // If this is a recurring job, add back to the queue.
-    if (earliest_job->frequency.count() > 0) {
-      ScheduledJob new_job = *earliest_job;
-      new_job.when = std::chrono::steady_clock::now() + new_job.frequency;
-      scheduled_jobs_.emplace(new_job);
+    // The job is gone if the scheduler is shutting down
+    it = jobs_.find(id);
+    if (it != jobs_.end()) {
+      auto& done = it->second;
+      if (done.frequency.count() > 0 && !done.canceled) {
+        // If this is a recurring job, add back to the queue.
+        done.when = Clock::now() + done.frequency;
+        Enqueue(id, &done);
+      } else {
+        callback = std::move(done.callback);
+        jobs_.erase(it);
+      }
+    }
+    // We might be waiting for the job to finish when cancelling it.
+    done_cv_.notify_all();
+    if (callback) {
+      lk.unlock();
+      callback = nullptr;
+      lk.lock();
     }
-    scheduled_jobs_.erase(earliest_job);
-
-    // We might be waiting for the change in currently_running_job_id_ when
-    // cancelling a job.
-    jobs_changed_cv_.notify_all();
   }
 }
 }  // namespace ROCKSDB_NAMESPACE
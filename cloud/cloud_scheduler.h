@@ -12,7 +12,9 @@
 
 namespace ROCKSDB_NAMESPACE {
 #ifndef ROCKSDB_LITE
-// Class for scheduling jobs to run on a separate thread
+// Class for scheduling jobs to run on background threads. Jobs may run
+// concurrently with each other, but a recurring job never runs concurrently
+// with itself.
 class CloudScheduler {
  public:
   virtual ~CloudScheduler() {}
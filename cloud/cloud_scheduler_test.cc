@@ -11,6 +11,7 @@
 #include <mutex>
 #include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "test_util/sync_point.h"
 
@@ -173,6 +174,84 @@ TEST_F(CloudSchedulerTest, TestLongRunningJobCancel) {
   ASSERT_EQ(status.load(), JobStatus::FINISHED);
 }
 
+// A long running callback must not delay the other jobs
+TEST_F(CloudSchedulerTest, TestLongRunningJobDoesNotDelayOthers) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool started = false;
+  bool released = false;
+  std::atomic<bool> ran{false};
+
+  auto blocked = [&](void *) {
+    std::unique_lock<std::mutex> lk(mutex);
+    started = true;
+    cv.notify_all();
+    cv.wait(lk, [&]() { return released; });
+  };
+  auto handle1 =
+      scheduler_->ScheduleJob(std::chrono::microseconds(0), blocked, nullptr);
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    cv.wait(lk, [&]() { return started; });
+  }
+  auto handle2 = scheduler_->ScheduleJob(
+      std::chrono::milliseconds(10), [&ran](void *) { ran = true; }, nullptr);
+  WaitForJobs({handle2}, 1000);
+  ASSERT_TRUE(ran.load());
+  ASSERT_TRUE(scheduler_->IsScheduled(handle1));
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    released = true;
+    cv.notify_all();
+  }
+  WaitForJobs({handle1}, 1000);
+}
+
+// Jobs due after a full rotation of the lowest level of the timer wheel are
+// cascaded down and run on time
+TEST_F(CloudSchedulerTest, TestCascade) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::chrono::milliseconds> delays = {
+      std::chrono::milliseconds(5), std::chrono::milliseconds(300),
+      std::chrono::milliseconds(600)};
+  std::vector<std::chrono::steady_clock::time_point> ran(delays.size());
+  std::vector<long> handles;
+  for (size_t i = 0; i < delays.size(); i++) {
+    handles.push_back(scheduler_->ScheduleJob(
+        delays[i],
+        [&ran, i](void *) { ran[i] = std::chrono::steady_clock::now(); },
+        nullptr));
+  }
+  WaitForJobs(handles, 1000);
+  for (size_t i = 0; i < delays.size(); i++) {
+    ASSERT_GE(ran[i] - start, delays[i]);
+  }
+}
+
+TEST_F(CloudSchedulerTest, TestManyJobs) {
+  const int kNumJobs = 100000;
+  std::atomic<int> runs{0};
+  auto doJob = [&runs](void *) { runs++; };
+  std::vector<long> handles;
+  for (int i = 0; i < kNumJobs; i++) {
+    handles.push_back(
+        scheduler_->ScheduleJob(std::chrono::hours(1 + i % 100), doJob, nullptr));
+  }
+  ASSERT_EQ(scheduler_->TEST_NumScheduledJobs(), kNumJobs);
+  for (int i = 0; i < kNumJobs; i += 2) {
+    ASSERT_TRUE(scheduler_->CancelJob(handles[i]));
+  }
+  ASSERT_EQ(scheduler_->TEST_NumScheduledJobs(), kNumJobs / 2);
+  auto handle =
+      scheduler_->ScheduleJob(std::chrono::milliseconds(1), doJob, nullptr);
+  WaitForJobs({handle}, 1000);
+  ASSERT_EQ(runs.load(), 1);
+  for (int i = 1; i < kNumJobs; i += 2) {
+    ASSERT_TRUE(scheduler_->CancelJob(handles[i]));
+  }
+  ASSERT_EQ(scheduler_->TEST_NumScheduledJobs(), 0);
+}
+
 // Once cloud scheduler is destructed, jobs shouldn't be erased after it's scheduled
 TEST(CloudSchedulerRaceTest, SkipJobEraseOnceDestructedTest) {
   // Verify that cloud scheduler can handle the race between LocalCloudScheduler destruction
@@ -0,0 +1,115 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_file_manager.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudSstFileManager::CloudSstFileManager(
+    int64_t constant_file_size, const std::shared_ptr<SystemClock>& clock,
+    const std::shared_ptr<FileSystem>& fs,
+    const std::shared_ptr<FileSystem>& local_fs,
+    std::shared_ptr<Logger> logger, int64_t rate_bytes_per_sec,
+    double max_trash_db_ratio, uint64_t bytes_max_delete_chunk)
+    : SstFileManagerImpl(clock, fs, std::move(logger), rate_bytes_per_sec,
+                         max_trash_db_ratio, bytes_max_delete_chunk),
+      constant_file_size_(constant_file_size),
+      fs_(fs),
+      local_fs_(local_fs) {}
+
+Status CloudSstFileManager::OnAddFile(const std::string& file_path) {
+  uint64_t size = 0;
+  bool local = true;
+  auto st =
+      local_fs_->GetFileSize(file_path, IOOptions(), &size, nullptr /*dbg*/);
+  if (st.IsNotFound()) {
+    local = false;
+    if (constant_file_size_ >= 0) {
+      st = IOStatus::OK();
+    } else {
+      st = fs_->GetFileSize(file_path, IOOptions(), &size, nullptr /*dbg*/);
+    }
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  if (constant_file_size_ >= 0) {
+    size = static_cast<uint64_t>(constant_file_size_);
+  }
+  AddFile(file_path, size, local);
+  return Status::OK();
+}
+
+Status CloudSstFileManager::OnAddFile(const std::string& file_path,
+                                      uint64_t file_size) {
+  AddFile(file_path, file_size, HasLocalCopy(file_path));
+  return Status::OK();
+}
+
+Status CloudSstFileManager::OnDeleteFile(const std::string& file_path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(file_path);
+  if (it != files_.end()) {
+    if (!it->second.local) {
+      cloud_resident_size_ -= it->second.size;
+    }
+    files_.erase(it);
+  }
+  return SstFileManagerImpl::OnDeleteFile(file_path);
+}
+
+void CloudSstFileManager::OnLocalCopyAdded(const std::string& file_path,
+                                           uint64_t size) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(file_path);
+  if (it == files_.end() || it->second.local) {
+    // Added by the DB once it is done with the file
+    return;
+  }
+  cloud_resident_size_ -= it->second.size;
+  if (constant_file_size_ < 0) {
+    it->second.size = size;
+  }
+  it->second.local = true;
+  SstFileManagerImpl::OnAddFile(file_path, it->second.size)
+      .PermitUncheckedError();
+}
+
+void CloudSstFileManager::OnLocalCopyRemoved(const std::string& file_path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(file_path);
+  if (it == files_.end() || !it->second.local) {
+    return;
+  }
+  it->second.local = false;
+  cloud_resident_size_ += it->second.size;
+  SstFileManagerImpl::OnDeleteFile(file_path).PermitUncheckedError();
+}
+
+uint64_t CloudSstFileManager::GetCloudResidentSize() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return cloud_resident_size_;
+}
+
+void CloudSstFileManager::AddFile(const std::string& file_path, uint64_t size,
+                                  bool local) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(file_path);
+  if (it != files_.end() && !it->second.local) {
+    cloud_resident_size_ -= it->second.size;
+  }
+  files_[file_path] = File{size, local};
+  if (local) {
+    SstFileManagerImpl::OnAddFile(file_path, size).PermitUncheckedError();
+  } else {
+    cloud_resident_size_ += size;
+    SstFileManagerImpl::OnDeleteFile(file_path).PermitUncheckedError();
+  }
+}
+
+bool CloudSstFileManager::HasLocalCopy(const std::string& file_path) const {
+  return local_fs_->FileExists(file_path, IOOptions(), nullptr /*dbg*/).ok();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
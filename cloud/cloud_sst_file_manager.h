@@ -0,0 +1,72 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "file/sst_file_manager_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+
+// The SstFileManager of a DBCloud. It tells the files that have a local copy
+// from the ones that are only in the cloud: the total size, the space limits
+// and the compaction reservations of SstFileManagerImpl only count the local
+// copies, the cloud-resident bytes are tracked on the side. The cloud file
+// system reports the local copies it downloads and evicts.
+//
+// Sizes come from the callers where they have them, e.g. from the MANIFEST at
+// open, so only the files the DB adds without a size cost a stat, of the
+// local copy if there is one, else of the object, or none with a
+// non-negative constant_file_size. See
+// CloudFileSystemOptions::constant_sst_file_size_in_sst_file_manager.
+//
+// Thread safe.
+class CloudSstFileManager : public SstFileManagerImpl {
+ public:
+  // fs deletes the files, local_fs tells if they have a local copy
+  CloudSstFileManager(int64_t constant_file_size,
+                      const std::shared_ptr<SystemClock>& clock,
+                      const std::shared_ptr<FileSystem>& fs,
+                      const std::shared_ptr<FileSystem>& local_fs,
+                      std::shared_ptr<Logger> logger,
+                      int64_t rate_bytes_per_sec, double max_trash_db_ratio,
+                      uint64_t bytes_max_delete_chunk);
+
+  Status OnAddFile(const std::string& file_path) override;
+  Status OnAddFile(const std::string& file_path, uint64_t file_size) override;
+  Status OnDeleteFile(const std::string& file_path) override;
+
+  // A tracked file was downloaded into a local copy of size bytes
+  void OnLocalCopyAdded(const std::string& file_path, uint64_t size);
+
+  // The local copy of a tracked file was deleted, it stays in the cloud
+  void OnLocalCopyRemoved(const std::string& file_path);
+
+  // The total size of the tracked files without a local copy. GetTotalSize()
+  // is the one of the local copies.
+  uint64_t GetCloudResidentSize() const;
+
+ private:
+  struct File {
+    uint64_t size;
+    bool local;
+  };
+
+  void AddFile(const std::string& file_path, uint64_t size, bool local);
+  bool HasLocalCopy(const std::string& file_path) const;
+
+  const int64_t constant_file_size_;
+  const std::shared_ptr<FileSystem> fs_;
+  const std::shared_ptr<FileSystem> local_fs_;
+
+  // Held before the mutex of SstFileManagerImpl
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, File> files_;
+  uint64_t cloud_resident_size_ = 0;
+};
+
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,140 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_file_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "file/file_util.h"
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Every object is 1000 bytes, and the stats are counted
+class MockCloudFileSystem : public FileSystemWrapper {
+ public:
+  MockCloudFileSystem() : FileSystemWrapper(FileSystem::Default()) {}
+  const char* Name() const override { return "MockCloudFileSystem"; }
+
+  IOStatus GetFileSize(const std::string& /*fname*/,
+                       const IOOptions& /*options*/, uint64_t* size,
+                       IODebugContext* /*dbg*/) override {
+    num_stats++;
+    *size = 1000;
+    return IOStatus::OK();
+  }
+
+  std::atomic<int> num_stats{0};
+};
+}  // namespace
+
+class CloudSstFileManagerTest : public testing::Test {
+ public:
+  CloudSstFileManagerTest()
+      : fs_(FileSystem::Default()),
+        cloud_fs_(std::make_shared<MockCloudFileSystem>()),
+        dir_(test::PerThreadDBPath("cloud_sst_file_manager_test")) {
+    EXPECT_OK(fs_->CreateDirIfMissing(dir_, IOOptions(), nullptr));
+  }
+  ~CloudSstFileManagerTest() override {
+    EXPECT_OK(DestroyDir(Env::Default(), dir_));
+  }
+
+  std::unique_ptr<CloudSstFileManager> NewSstFileManager(
+      int64_t constant_file_size) {
+    return std::make_unique<CloudSstFileManager>(
+        constant_file_size, SystemClock::Default(), cloud_fs_, fs_, nullptr,
+        0 /* rate_bytes_per_sec */, 0.25 /* max_trash_db_ratio */,
+        64 * 1024 * 1024 /* bytes_max_delete_chunk */);
+  }
+
+  // Writes a local copy of size bytes
+  void WriteLocalCopy(const std::string& path, size_t size) {
+    ASSERT_OK(WriteStringToFile(fs_.get(), std::string(size, 'l'), path));
+  }
+
+  std::shared_ptr<FileSystem> fs_;
+  std::shared_ptr<MockCloudFileSystem> cloud_fs_;
+  std::string dir_;
+};
+
+TEST_F(CloudSstFileManagerTest, LocalAndCloudResident) {
+  auto sfm = NewSstFileManager(-1);
+  const auto local = dir_ + "/000001.sst";
+  const auto cloud = dir_ + "/000002.sst";
+  WriteLocalCopy(local, 10);
+
+  // With the sizes of the MANIFEST, nothing is stat'ed in the cloud
+  ASSERT_OK(sfm->OnAddFile(local, 10));
+  ASSERT_OK(sfm->OnAddFile(cloud, 500));
+  ASSERT_EQ(cloud_fs_->num_stats, 0);
+  ASSERT_EQ(sfm->GetTotalSize(), 10u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 500u);
+
+  // The space limit only applies to the local copies
+  sfm->SetMaxAllowedSpaceUsage(100);
+  ASSERT_FALSE(sfm->IsMaxAllowedSpaceReached());
+
+  sfm->OnLocalCopyAdded(cloud, 500);
+  ASSERT_EQ(sfm->GetTotalSize(), 510u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 0u);
+  ASSERT_TRUE(sfm->IsMaxAllowedSpaceReached());
+
+  sfm->OnLocalCopyRemoved(cloud);
+  ASSERT_EQ(sfm->GetTotalSize(), 10u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 500u);
+  ASSERT_FALSE(sfm->IsMaxAllowedSpaceReached());
+
+  // Untracked files are left to the DB
+  sfm->OnLocalCopyAdded(dir_ + "/000003.sst", 50);
+  ASSERT_EQ(sfm->GetTotalSize(), 10u);
+
+  ASSERT_OK(sfm->OnDeleteFile(cloud));
+  ASSERT_OK(sfm->OnDeleteFile(local));
+  ASSERT_EQ(sfm->GetTotalSize(), 0u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 0u);
+}
+
+TEST_F(CloudSstFileManagerTest, StatsWithoutSize) {
+  auto sfm = NewSstFileManager(-1);
+  const auto local = dir_ + "/000001.sst";
+  WriteLocalCopy(local, 10);
+
+  // The local copy is stat'ed, else the object
+  ASSERT_OK(sfm->OnAddFile(local));
+  ASSERT_OK(sfm->OnAddFile(dir_ + "/000002.sst"));
+  ASSERT_EQ(cloud_fs_->num_stats, 1);
+  ASSERT_EQ(sfm->GetTotalSize(), 10u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 1000u);
+
+  // Or neither with a constant size
+  sfm = NewSstFileManager(7);
+  ASSERT_OK(sfm->OnAddFile(local));
+  ASSERT_OK(sfm->OnAddFile(dir_ + "/000002.sst"));
+  ASSERT_EQ(cloud_fs_->num_stats, 1);
+  ASSERT_EQ(sfm->GetTotalSize(), 7u);
+  ASSERT_EQ(sfm->GetCloudResidentSize(), 7u);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudSstFileManagerTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
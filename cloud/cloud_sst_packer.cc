@@ -0,0 +1,241 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_packer.h"
+
+#include <algorithm>
+
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+const uint64_t CloudSstPacker::kMagicNumber = 0x8c3f9e2d51a7b064ull;
+
+void CloudSstPacker::EncodeIndex(const std::vector<Entry>& files,
+                                 uint64_t data_size, std::string* dst) {
+  PutVarint32(dst, static_cast<uint32_t>(files.size()));
+  for (const auto& file : files) {
+    PutLengthPrefixedSlice(dst, file.name);
+    PutVarint64(dst, file.offset);
+    PutVarint64(dst, file.size);
+  }
+  PutFixed64(dst, data_size);
+  PutFixed64(dst, kMagicNumber);
+}
+
+IOStatus CloudSstPacker::DecodeFooter(const Slice& footer,
+                                      uint64_t* index_offset) {
+  if (footer.size() != kFooterSize ||
+      DecodeFixed64(footer.data() + 8) != kMagicNumber) {
+    return IOStatus::Corruption("Bad SST pack footer");
+  }
+  *index_offset = DecodeFixed64(footer.data());
+  return IOStatus::OK();
+}
+
+IOStatus CloudSstPacker::DecodeIndex(Slice index, std::vector<Entry>* files) {
+  uint32_t num_files = 0;
+  if (!GetVarint32(&index, &num_files)) {
+    return IOStatus::Corruption("Bad SST pack index");
+  }
+  files->clear();
+  for (uint32_t i = 0; i < num_files; i++) {
+    Slice name;
+    Entry entry;
+    if (!GetLengthPrefixedSlice(&index, &name) ||
+        !GetVarint64(&index, &entry.offset) ||
+        !GetVarint64(&index, &entry.size)) {
+      return IOStatus::Corruption("Bad SST pack index");
+    }
+    entry.name = name.ToString();
+    files->push_back(std::move(entry));
+  }
+  return IOStatus::OK();
+}
+
+uint64_t CloudSstPacker::AddPending(const std::string& name,
+                                    PendingFile file) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto& pending = pending_[name];
+  pending_bytes_ += file.size - pending.size;
+  pending = std::move(file);
+  return pending_bytes_;
+}
+
+bool CloudSstPacker::IsPending(const std::string& name) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return pending_.count(name) > 0;
+}
+
+bool CloudSstPacker::RemovePending(const std::string& name) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = pending_.find(name);
+  if (it == pending_.end()) {
+    return false;
+  }
+  pending_bytes_ -= it->second.size;
+  pending_.erase(it);
+  return true;
+}
+
+std::vector<std::pair<std::string, CloudSstPacker::PendingFile>>
+CloudSstPacker::GetPending() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return {pending_.begin(), pending_.end()};
+}
+
+bool CloudSstPacker::AddPack(const std::string& bucket,
+                             const std::string& pack_path, bool owned,
+                             const std::vector<Entry>& files) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto pack_it =
+      packs_.emplace(PackKey(bucket, pack_path), Pack{owned, 0}).first;
+  auto& pack = pack_it->second;
+  for (const auto& entry : files) {
+    auto pending_it = pending_.find(entry.name);
+    if (pending_it != pending_.end()) {
+      pending_bytes_ -= pending_it->second.size;
+      pending_.erase(pending_it);
+    }
+    // A file already in another pack, e.g. of a pack whose upload was
+    // retried under another name, stays there
+    if (files_.emplace(entry.name, File{&pack_it->first, entry.offset,
+                                        entry.size})
+            .second) {
+      pack.num_files++;
+    }
+  }
+  return !pack.owned || pack.num_files > 0;
+}
+
+bool CloudSstPacker::HasPack(const std::string& bucket,
+                             const std::string& pack_path) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return packs_.count(PackKey(bucket, pack_path)) > 0;
+}
+
+bool CloudSstPacker::Lookup(const std::string& name,
+                            CloudPackedFile* file) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(name);
+  if (it == files_.end()) {
+    return false;
+  }
+  file->bucket = it->second.pack->first;
+  file->pack_path = it->second.pack->second;
+  file->offset = it->second.offset;
+  file->size = it->second.size;
+  return true;
+}
+
+bool CloudSstPacker::Remove(const std::string& name,
+                            std::string* emptied_pack_path) {
+  emptied_pack_path->clear();
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(name);
+  if (it == files_.end()) {
+    return false;
+  }
+  auto& pack = packs_[*it->second.pack];
+  if (--pack.num_files == 0 && pack.owned) {
+    *emptied_pack_path = it->second.pack->second;
+  }
+  files_.erase(it);
+  return true;
+}
+
+void CloudSstPacker::ListFiles(std::vector<std::string>* names) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (const auto& file : files_) {
+    names->push_back(file.first);
+  }
+}
+
+size_t CloudSstPacker::NumFiles() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return files_.size();
+}
+
+namespace {
+// Reads [offset, offset + size) of the file of a pack
+class PackedReadableFile : public CloudStorageReadableFile {
+ public:
+  PackedReadableFile(std::unique_ptr<CloudStorageReadableFile> pack,
+                     uint64_t offset, uint64_t size)
+      : pack_(std::move(pack)), offset_(offset), size_(size) {}
+
+  IOStatus Read(size_t n, const IOOptions& options, Slice* result,
+                char* scratch, IODebugContext* dbg) override {
+    auto st = Read(pos_, n, options, result, scratch, dbg);
+    if (st.ok()) {
+      pos_ += result->size();
+    }
+    return st;
+  }
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& options,
+                Slice* result, char* scratch,
+                IODebugContext* dbg) const override {
+    if (offset >= size_) {
+      *result = Slice();
+      return IOStatus::OK();
+    }
+    n = static_cast<size_t>(std::min<uint64_t>(n, size_ - offset));
+    return RandomAccess()->Read(offset_ + offset, n, options, result,
+                                scratch, dbg);
+  }
+
+  IOStatus Skip(uint64_t n) override {
+    pos_ = std::min(pos_ + n, size_);
+    return IOStatus::OK();
+  }
+
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override {
+    std::vector<FSReadRequest> pack_reqs(num_reqs);
+    for (size_t i = 0; i < num_reqs; i++) {
+      auto offset = std::min(reqs[i].offset, size_);
+      pack_reqs[i].offset = offset_ + offset;
+      pack_reqs[i].len =
+          static_cast<size_t>(std::min<uint64_t>(reqs[i].len, size_ - offset));
+      pack_reqs[i].scratch = reqs[i].scratch;
+    }
+    auto st = RandomAccess()->MultiRead(pack_reqs.data(), num_reqs, options,
+                                        dbg);
+    for (size_t i = 0; i < num_reqs; i++) {
+      reqs[i].result = pack_reqs[i].result;
+      reqs[i].status = pack_reqs[i].status;
+    }
+    return st;
+  }
+
+  IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
+                    IODebugContext* dbg) override {
+    if (offset >= size_) {
+      return IOStatus::OK();
+    }
+    n = static_cast<size_t>(std::min<uint64_t>(n, size_ - offset));
+    return RandomAccess()->Prefetch(offset_ + offset, n, options, dbg);
+  }
+
+ private:
+  FSRandomAccessFile* RandomAccess() const { return pack_.get(); }
+
+  std::unique_ptr<CloudStorageReadableFile> pack_;
+  const uint64_t offset_;
+  const uint64_t size_;
+  // Position of the sequential reads
+  uint64_t pos_ = 0;
+};
+}  // namespace
+
+std::unique_ptr<CloudStorageReadableFile> NewPackedReadableFile(
+    std::unique_ptr<CloudStorageReadableFile> pack,
+    const CloudPackedFile& file) {
+  return std::make_unique<PackedReadableFile>(std::move(pack), file.offset,
+                                              file.size);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,127 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/io_status.h"
+#include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class CloudStorageReadableFile;
+
+// Where the bytes of a packed SST file are in the cloud
+struct CloudPackedFile {
+  std::string bucket;
+  // Object path of the pack
+  std::string pack_path;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+// Packs small SST files several to a cloud object, which saves the requests
+// of their uploads, deletions and listings (see
+// CloudFileSystemOptions::sst_pack_threshold). A pack holds the data of its
+// files back to back, followed by their index and a fixed-size footer:
+//
+//   file data...
+//   index:  varint32 number of files, then for each file its
+//           length-prefixed name, varint64 offset and varint64 size
+//   footer: fixed64 offset of the index, fixed64 kMagicNumber
+//
+// The packer keeps the closed files waiting for their pack, and the index of
+// the packs it was told about. It does no I/O: its owner builds, uploads,
+// reads and deletes the packs.
+//
+// Thread safe.
+class CloudSstPacker {
+ public:
+  static const uint64_t kMagicNumber;
+  static const size_t kFooterSize = 16;
+
+  struct Entry {
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // A closed file waiting for its pack
+  struct PendingFile {
+    std::string local_path;
+    uint64_t size;
+    // Whether the local copy stays once the file is packed
+    bool keep_local;
+  };
+
+  // Appends to *dst the index and footer of a pack of files, whose data ends
+  // at data_size
+  static void EncodeIndex(const std::vector<Entry>& files, uint64_t data_size,
+                          std::string* dst);
+  // Reads the offset of the index of a pack from its footer
+  static IOStatus DecodeFooter(const Slice& footer, uint64_t* index_offset);
+  // Reads the index of a pack, without its footer
+  static IOStatus DecodeIndex(Slice index, std::vector<Entry>* files);
+
+  // Adds the closed file name to the next pack. Returns the number of bytes
+  // waiting for a pack.
+  uint64_t AddPending(const std::string& name, PendingFile file);
+  bool IsPending(const std::string& name) const;
+  // Returns false if name was not waiting for a pack
+  bool RemovePending(const std::string& name);
+  // The files waiting for a pack, in name order
+  std::vector<std::pair<std::string, PendingFile>> GetPending() const;
+
+  // Indexes the files of the pack at bucket/pack_path, and removes them from
+  // the pending files. An owned pack is one of the DB, that it deletes once
+  // its files are deleted. Returns false if the pack is owned and has no
+  // file: the files were all indexed in other packs, or deleted already.
+  bool AddPack(const std::string& bucket, const std::string& pack_path,
+               bool owned, const std::vector<Entry>& files);
+  bool HasPack(const std::string& bucket, const std::string& pack_path) const;
+
+  // Returns true and sets *file if name is in a pack
+  bool Lookup(const std::string& name, CloudPackedFile* file) const;
+  // Returns false if name is not in a pack. Sets *emptied_pack_path to the
+  // object path of its pack if the pack is owned and name was its last file,
+  // or else clears it.
+  bool Remove(const std::string& name, std::string* emptied_pack_path);
+  // Appends the names of the packed files to *names
+  void ListFiles(std::vector<std::string>* names) const;
+
+  size_t NumFiles() const;
+
+ private:
+  struct Pack {
+    bool owned;
+    size_t num_files;
+  };
+  using PackKey = std::pair<std::string, std::string>;
+  struct File {
+    // Points into packs_
+    const PackKey* pack;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::string, PendingFile> pending_;
+  uint64_t pending_bytes_ = 0;
+  // By bucket and object path. Emptied packs stay, so that a pack whose
+  // deletion is delayed is not indexed again.
+  std::map<PackKey, Pack> packs_;
+  std::unordered_map<std::string, File> files_;
+};
+
+// Returns a file reading the packed file out of pack, the file of its pack
+std::unique_ptr<CloudStorageReadableFile> NewPackedReadableFile(
+    std::unique_ptr<CloudStorageReadableFile> pack,
+    const CloudPackedFile& file);
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
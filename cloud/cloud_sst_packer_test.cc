@@ -0,0 +1,190 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_packer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The object of a pack, in memory
+class StringReadableFile : public CloudStorageReadableFile {
+ public:
+  explicit StringReadableFile(std::string data) : data_(std::move(data)) {}
+
+  IOStatus Read(size_t n, const IOOptions& options, Slice* result,
+                char* scratch, IODebugContext* dbg) override {
+    auto st = Read(pos_, n, options, result, scratch, dbg);
+    pos_ += result->size();
+    return st;
+  }
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& /*options*/,
+                Slice* result, char* scratch,
+                IODebugContext* /*dbg*/) const override {
+    if (offset >= data_.size()) {
+      *result = Slice();
+      return IOStatus::OK();
+    }
+    n = std::min<size_t>(n, data_.size() - offset);
+    memcpy(scratch, data_.data() + offset, n);
+    *result = Slice(scratch, n);
+    return IOStatus::OK();
+  }
+
+  IOStatus Skip(uint64_t n) override {
+    pos_ += n;
+    return IOStatus::OK();
+  }
+
+ private:
+  const std::string data_;
+  uint64_t pos_ = 0;
+};
+}  // namespace
+
+class CloudSstPackerTest : public testing::Test {};
+
+TEST_F(CloudSstPackerTest, EncodeDecodeIndex) {
+  std::vector<CloudSstPacker::Entry> files = {{"000010.sst", 0, 100},
+                                              {"000012.sst", 100, 50}};
+  std::string pack(150, 'x');
+  CloudSstPacker::EncodeIndex(files, pack.size(), &pack);
+
+  uint64_t index_offset = 0;
+  Slice footer(pack.data() + pack.size() - CloudSstPacker::kFooterSize,
+               CloudSstPacker::kFooterSize);
+  ASSERT_OK(CloudSstPacker::DecodeFooter(footer, &index_offset));
+  ASSERT_EQ(index_offset, 150u);
+
+  std::vector<CloudSstPacker::Entry> decoded;
+  ASSERT_OK(CloudSstPacker::DecodeIndex(
+      Slice(pack.data() + index_offset,
+            pack.size() - index_offset - CloudSstPacker::kFooterSize),
+      &decoded));
+  ASSERT_EQ(decoded.size(), 2u);
+  ASSERT_EQ(decoded[1].name, "000012.sst");
+  ASSERT_EQ(decoded[1].offset, 100u);
+  ASSERT_EQ(decoded[1].size, 50u);
+
+  // Not a pack
+  std::string bad(CloudSstPacker::kFooterSize, 'x');
+  ASSERT_TRUE(CloudSstPacker::DecodeFooter(bad, &index_offset).IsCorruption());
+  ASSERT_TRUE(
+      CloudSstPacker::DecodeIndex(Slice("\x02", 1), &decoded).IsCorruption());
+}
+
+TEST_F(CloudSstPackerTest, PendingAndPackedFiles) {
+  CloudSstPacker packer;
+  ASSERT_EQ(packer.AddPending("000010.sst", {"/db/000010.sst", 100, false}),
+            100u);
+  ASSERT_EQ(packer.AddPending("000012.sst", {"/db/000012.sst", 50, true}),
+            150u);
+  ASSERT_TRUE(packer.IsPending("000010.sst"));
+  ASSERT_EQ(packer.GetPending().size(), 2u);
+
+  // Packing removes the files from the pending ones
+  ASSERT_TRUE(
+      packer.AddPack("dest", "db/packs/000010.pack", true,
+                     {{"000010.sst", 0, 100}, {"000012.sst", 100, 50}}));
+  ASSERT_FALSE(packer.IsPending("000010.sst"));
+  ASSERT_TRUE(packer.GetPending().empty());
+  ASSERT_EQ(packer.AddPending("000014.sst", {"/db/000014.sst", 10, false}),
+            10u);
+  ASSERT_TRUE(packer.RemovePending("000014.sst"));
+  ASSERT_FALSE(packer.RemovePending("000014.sst"));
+
+  ASSERT_TRUE(packer.HasPack("dest", "db/packs/000010.pack"));
+  ASSERT_FALSE(packer.HasPack("src", "db/packs/000010.pack"));
+  CloudPackedFile file;
+  ASSERT_TRUE(packer.Lookup("000012.sst", &file));
+  ASSERT_EQ(file.bucket, "dest");
+  ASSERT_EQ(file.pack_path, "db/packs/000010.pack");
+  ASSERT_EQ(file.offset, 100u);
+  ASSERT_EQ(file.size, 50u);
+  ASSERT_FALSE(packer.Lookup("000014.sst", &file));
+
+  // A file of a pack of another DB stays in the pack it was first found in
+  ASSERT_TRUE(packer.AddPack("src", "base/packs/000008.pack", false,
+                             {{"000008.sst", 0, 20}, {"000010.sst", 20, 100}}));
+  ASSERT_TRUE(packer.Lookup("000010.sst", &file));
+  ASSERT_EQ(file.bucket, "dest");
+  ASSERT_EQ(packer.NumFiles(), 3u);
+  std::vector<std::string> names;
+  packer.ListFiles(&names);
+  ASSERT_EQ(names.size(), 3u);
+
+  // The owned pack empties with its last file, not the other one
+  std::string emptied;
+  ASSERT_TRUE(packer.Remove("000010.sst", &emptied));
+  ASSERT_TRUE(emptied.empty());
+  ASSERT_TRUE(packer.Remove("000008.sst", &emptied));
+  ASSERT_TRUE(emptied.empty());
+  ASSERT_TRUE(packer.Remove("000012.sst", &emptied));
+  ASSERT_EQ(emptied, "db/packs/000010.pack");
+  ASSERT_FALSE(packer.Remove("000012.sst", &emptied));
+  ASSERT_EQ(packer.NumFiles(), 0u);
+
+  // An owned pack whose files are all elsewhere is empty
+  ASSERT_FALSE(packer.AddPack("dest", "db/packs/000016.pack", true, {}));
+}
+
+TEST_F(CloudSstPackerTest, PackedReadableFile) {
+  CloudPackedFile packed;
+  packed.offset = 3;
+  packed.size = 4;
+  auto file = NewPackedReadableFile(
+      std::make_unique<StringReadableFile>("abcdefghij"), packed);
+  FSRandomAccessFile* random_access = file.get();
+  FSSequentialFile* sequential = file.get();
+
+  char scratch[16];
+  Slice result;
+  ASSERT_OK(random_access->Read(1, 10, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), "efg");
+  ASSERT_OK(random_access->Read(4, 1, IOOptions(), &result, scratch, nullptr));
+  ASSERT_TRUE(result.empty());
+
+  ASSERT_OK(sequential->Read(2, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), "de");
+  ASSERT_OK(sequential->Skip(1));
+  ASSERT_OK(sequential->Read(10, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), "g");
+
+  std::vector<FSReadRequest> reqs(2);
+  char scratch2[16];
+  reqs[0].offset = 0;
+  reqs[0].len = 2;
+  reqs[0].scratch = scratch;
+  reqs[1].offset = 2;
+  reqs[1].len = 8;
+  reqs[1].scratch = scratch2;
+  ASSERT_OK(random_access->MultiRead(reqs.data(), reqs.size(), IOOptions(),
+                                     nullptr));
+  ASSERT_EQ(reqs[0].result.ToString(), "de");
+  ASSERT_EQ(reqs[1].result.ToString(), "fg");
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudSstPackerTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
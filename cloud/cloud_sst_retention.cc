@@ -0,0 +1,63 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_retention.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudSstRetention::CloudSstRetention(uint64_t capacity) : capacity_(capacity) {}
+
+void CloudSstRetention::Insert(const std::string& path, uint64_t size,
+                               std::vector<std::string>* evicted) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(path);
+  if (it != files_.end()) {
+    usage_ -= it->second.size;
+    lru_.erase(it->second.pos);
+    files_.erase(it);
+  }
+  lru_.push_front(path);
+  files_[path] = Entry{size, lru_.begin()};
+  usage_ += size;
+  while (usage_ > capacity_ && !lru_.empty()) {
+    auto& victim = lru_.back();
+    auto victim_it = files_.find(victim);
+    usage_ -= victim_it->second.size;
+    files_.erase(victim_it);
+    evicted->push_back(std::move(victim));
+    lru_.pop_back();
+  }
+}
+
+bool CloudSstRetention::Touch(const std::string& path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(path);
+  if (it == files_.end()) {
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.pos);
+  return true;
+}
+
+void CloudSstRetention::Erase(const std::string& path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(path);
+  if (it != files_.end()) {
+    usage_ -= it->second.size;
+    lru_.erase(it->second.pos);
+    files_.erase(it);
+  }
+}
+
+uint64_t CloudSstRetention::GetUsage() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return usage_;
+}
+
+size_t CloudSstRetention::NumFiles() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return files_.size();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
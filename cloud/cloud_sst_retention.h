@@ -0,0 +1,57 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+
+// Byte-capped pool of the local copies of cloud SST files, in order of
+// access recency. It only does the accounting: the owner deletes the local
+// files the pool evicts. See CloudFileSystemOptions::local_sst_retention_bytes.
+//
+// Thread safe.
+class CloudSstRetention {
+ public:
+  explicit CloudSstRetention(uint64_t capacity);
+
+  // Adds the local file path of size bytes as the most recently used one,
+  // and appends to *evicted the least recently used files that no longer
+  // fit. A file larger than the capacity is evicted right away.
+  void Insert(const std::string& path, uint64_t size,
+              std::vector<std::string>* evicted);
+
+  // Returns true and marks path as the most recently used file if it is in
+  // the pool
+  bool Touch(const std::string& path);
+
+  // The local file was deleted
+  void Erase(const std::string& path);
+
+  uint64_t GetCapacity() const { return capacity_; }
+  uint64_t GetUsage() const;
+  size_t NumFiles() const;
+
+ private:
+  struct Entry {
+    uint64_t size;
+    // Position in lru_
+    std::list<std::string>::iterator pos;
+  };
+
+  const uint64_t capacity_;
+
+  mutable std::mutex mutex_;
+  // Most recently used first
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> files_;
+  uint64_t usage_ = 0;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_retention.h"
+
+#include <gtest/gtest.h>
+
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudSstRetentionTest : public testing::Test {};
+
+TEST_F(CloudSstRetentionTest, EvictsLeastRecentlyUsed) {
+  CloudSstRetention retention(100);
+  std::vector<std::string> evicted;
+  retention.Insert("db/1.sst", 40, &evicted);
+  retention.Insert("db/2.sst", 40, &evicted);
+  ASSERT_TRUE(evicted.empty());
+  ASSERT_EQ(retention.GetUsage(), 80u);
+
+  // 1 is now more recent than 2
+  ASSERT_TRUE(retention.Touch("db/1.sst"));
+  ASSERT_FALSE(retention.Touch("db/3.sst"));
+  retention.Insert("db/3.sst", 40, &evicted);
+  ASSERT_EQ(evicted, std::vector<std::string>({"db/2.sst"}));
+  ASSERT_EQ(retention.GetUsage(), 80u);
+  ASSERT_EQ(retention.NumFiles(), 2u);
+
+  // Re-inserting a file updates its size
+  evicted.clear();
+  retention.Insert("db/1.sst", 50, &evicted);
+  ASSERT_TRUE(evicted.empty());
+  ASSERT_EQ(retention.GetUsage(), 90u);
+
+  retention.Erase("db/3.sst");
+  retention.Erase("db/4.sst");
+  ASSERT_EQ(retention.GetUsage(), 50u);
+  ASSERT_EQ(retention.NumFiles(), 1u);
+}
+
+TEST_F(CloudSstRetentionTest, OversizedFile) {
+  CloudSstRetention retention(100);
+  std::vector<std::string> evicted;
+  retention.Insert("db/1.sst", 60, &evicted);
+  retention.Insert("db/2.sst", 200, &evicted);
+  ASSERT_EQ(evicted, std::vector<std::string>({"db/1.sst", "db/2.sst"}));
+  ASSERT_EQ(retention.GetUsage(), 0u);
+  ASSERT_EQ(retention.NumFiles(), 0u);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudSstRetentionTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
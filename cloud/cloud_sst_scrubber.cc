@@ -0,0 +1,241 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_sst_scrubber.h"
+
+#include <algorithm>
+
+#include "cloud/filename.h"
+#include "db/db_impl/db_impl.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/file_checksum.h"
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/sst_file_reader.h"
+#include "util/cast_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The size of the reads of the full-file checksums
+constexpr size_t kReadSize = 1 << 20;
+}  // namespace
+
+CloudSstScrubber::CloudSstScrubber(DB* db, CloudFileSystemImpl* cfs,
+                                   Env* local_env,
+                                   const std::vector<uint32_t>& cf_ids,
+                                   uint64_t bytes_per_sec)
+    : db_(db), cfs_(cfs), local_env_(local_env) {
+  auto* db_impl = static_cast_with_check<DBImpl>(db_->GetRootDB());
+  for (auto cf_id : cf_ids) {
+    auto handle = db_impl->GetColumnFamilyHandleUnlocked(cf_id);
+    if (handle) {
+      cf_options_.emplace(handle->GetName(), db_->GetOptions(handle.get()));
+    }
+  }
+  if (bytes_per_sec > 0) {
+    rate_limiter_.reset(
+        NewGenericRateLimiter(static_cast<int64_t>(bytes_per_sec)));
+  }
+}
+
+CloudSstScrubber::~CloudSstScrubber() { Stop(); }
+
+void CloudSstScrubber::GetStats(DBCloud::ScrubStats* stats) const {
+  stats->num_passes = num_passes_.load(std::memory_order_relaxed);
+  stats->num_verified = num_verified_.load(std::memory_order_relaxed);
+  stats->verified_bytes = verified_bytes_.load(std::memory_order_relaxed);
+  stats->num_corrupted = num_corrupted_.load(std::memory_order_relaxed);
+  stats->num_repaired = num_repaired_.load(std::memory_order_relaxed);
+}
+
+Status CloudSstScrubber::RunPass() {
+  std::vector<LiveFileMetaData> metadata;
+  db_->GetLiveFilesMetaData(&metadata);
+  std::vector<File> files;
+  for (const auto& md : metadata) {
+    File file;
+    auto fname = cfs_->RemapFilename(md.name);
+    file.local_path = md.db_path + "/" + basename(fname);
+    if (cfs_->HasDestBucket()) {
+      file.object_path =
+          cfs_->GetDestObjectPath() + "/" + cfs_->ObjectName(fname);
+    }
+    file.size = md.size;
+    file.checksum_func_name = md.file_checksum_func_name;
+    file.checksum = md.file_checksum;
+    file.cf_name = md.column_family_name;
+    files.push_back(std::move(file));
+  }
+
+  // The local copies first, they are read the most
+  for (const auto& file : files) {
+    if (stop_.load(std::memory_order_relaxed)) {
+      return Status::Aborted("Scrubber stopped");
+    }
+    ScrubLocalCopy(file);
+  }
+  for (const auto& file : files) {
+    if (stop_.load(std::memory_order_relaxed)) {
+      return Status::Aborted("Scrubber stopped");
+    }
+    ScrubObject(file);
+  }
+  num_passes_++;
+  Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+      "[sst_scrubber] Verified %" ROCKSDB_PRIszt " live SST files",
+      files.size());
+  return Status::OK();
+}
+
+void CloudSstScrubber::ScrubLocalCopy(const File& file) {
+  if (!local_env_->FileExists(file.local_path).ok()) {
+    return;
+  }
+  auto st = VerifyFile(file, true /* local */);
+  if (!st.IsCorruption()) {
+    return;
+  }
+  Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+      "[sst_scrubber] Local copy %s is corrupted: %s", file.local_path.c_str(),
+      st.ToString().c_str());
+  if (file.object_path.empty() || !VerifyFile(file, false /* local */).ok()) {
+    return;
+  }
+  // Replaced by a download into a temporary file, the open table readers
+  // keep reading the old one
+  auto io_st = cfs_->GetStorageProvider()->GetCloudObject(
+      cfs_->GetDestBucketName(), file.object_path, file.local_path);
+  if (io_st.ok()) {
+    num_repaired_++;
+  }
+  Log(InfoLogLevel::WARN_LEVEL, cfs_->GetLogger(),
+      "[sst_scrubber] Downloaded %s again: %s", file.local_path.c_str(),
+      io_st.ToString().c_str());
+}
+
+void CloudSstScrubber::ScrubObject(const File& file) {
+  if (file.object_path.empty()) {
+    return;
+  }
+  auto st = VerifyFile(file, false /* local */);
+  if (!st.IsCorruption()) {
+    // NotFound if the file is an object of another bucket, e.g. of the src
+    return;
+  }
+  Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+      "[sst_scrubber] Object %s/%s is corrupted: %s",
+      cfs_->GetDestBucketName().c_str(), file.object_path.c_str(),
+      st.ToString().c_str());
+  if (!local_env_->FileExists(file.local_path).ok() ||
+      !VerifyFile(file, true /* local */).ok()) {
+    return;
+  }
+  auto io_st = cfs_->GetStorageProvider()->PutCloudObject(
+      file.local_path, cfs_->GetDestBucketName(), file.object_path);
+  cfs_->InvalidateCloudObjectMetadata(cfs_->GetDestBucketName(),
+                                      file.object_path);
+  if (io_st.ok()) {
+    num_repaired_++;
+  }
+  Log(InfoLogLevel::WARN_LEVEL, cfs_->GetLogger(),
+      "[sst_scrubber] Uploaded %s/%s again: %s",
+      cfs_->GetDestBucketName().c_str(), file.object_path.c_str(),
+      io_st.ToString().c_str());
+}
+
+Status CloudSstScrubber::VerifyFile(const File& file, bool local) {
+  Env* env = local ? local_env_ : db_->GetEnv();
+  const auto path =
+      local ? file.local_path
+            : CloudFileSystem::CloudObjectFilePath(cfs_->GetDestBucketName(),
+                                                   file.object_path);
+  auto it = cf_options_.find(file.cf_name);
+  Options options = it != cf_options_.end() ? it->second : db_->GetOptions();
+  const auto& factory = options.file_checksum_gen_factory;
+  Status st;
+  if (factory != nullptr && !file.checksum.empty() &&
+      file.checksum_func_name != kUnknownFileChecksumFuncName) {
+    st = VerifyFileChecksum(file, path, env);
+  } else {
+    // By the block checksums, read at the rate of the scrubber
+    options.env = env;
+    options.rate_limiter = rate_limiter_;
+    SstFileReader reader(options);
+    st = reader.Open(path);
+    if (st.ok()) {
+      ReadOptions read_options;
+      read_options.fill_cache = false;
+      read_options.rate_limiter_priority = Env::IO_LOW;
+      st = reader.VerifyChecksum(read_options);
+    }
+  }
+  if (st.ok()) {
+    num_verified_++;
+    verified_bytes_ += file.size;
+  } else if (st.IsCorruption()) {
+    num_corrupted_++;
+  }
+  return st;
+}
+
+Status CloudSstScrubber::VerifyFileChecksum(const File& file,
+                                            const std::string& path,
+                                            Env* env) {
+  auto it = cf_options_.find(file.cf_name);
+  const auto& factory = it != cf_options_.end()
+                            ? it->second.file_checksum_gen_factory
+                            : db_->GetOptions().file_checksum_gen_factory;
+  FileChecksumGenContext context;
+  context.file_name = path;
+  context.requested_checksum_func_name = file.checksum_func_name;
+  auto generator = factory->CreateFileChecksumGenerator(context);
+  if (generator == nullptr ||
+      generator->Name() != file.checksum_func_name) {
+    return Status::NotSupported("Unknown file checksum function",
+                                file.checksum_func_name);
+  }
+
+  std::unique_ptr<FSRandomAccessFile> reader;
+  auto io_st = env->GetFileSystem()->NewRandomAccessFile(path, FileOptions(),
+                                                         &reader, nullptr);
+  if (!io_st.ok()) {
+    return io_st;
+  }
+  size_t read_size = kReadSize;
+  if (rate_limiter_) {
+    read_size = std::min<size_t>(
+        read_size, static_cast<size_t>(rate_limiter_->GetSingleBurstBytes()));
+  }
+  std::unique_ptr<char[]> scratch(new char[read_size]);
+  for (uint64_t offset = 0; offset < file.size;) {
+    if (stop_.load(std::memory_order_relaxed)) {
+      return Status::Aborted("Scrubber stopped");
+    }
+    auto n = static_cast<size_t>(
+        std::min<uint64_t>(read_size, file.size - offset));
+    if (rate_limiter_) {
+      rate_limiter_->Request(static_cast<int64_t>(n), Env::IO_LOW,
+                             nullptr /* stats */, RateLimiter::OpType::kRead);
+    }
+    Slice result;
+    io_st = reader->Read(offset, n, IOOptions(), &result, scratch.get(),
+                         nullptr);
+    if (!io_st.ok()) {
+      return io_st;
+    }
+    if (result.size() != n) {
+      return Status::Corruption("File too short", path);
+    }
+    generator->Update(result.data(), result.size());
+    offset += n;
+  }
+  generator->Finalize();
+  if (generator->GetChecksum() != file.checksum) {
+    return Status::Corruption("File checksum mismatch", path);
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,83 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/cloud/db_cloud.h"
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class CloudFileSystemImpl;
+class RateLimiter;
+
+// Verifies the live SST files of a DBCloud in the background, so that bit
+// rot in the local copies or in the objects of the dest bucket is found
+// before a read fails. Each pass verifies the local copies first, then the
+// objects, with ranged reads, at most bytes_per_sec bytes per second. A file
+// is checked against the file_checksum that the MANIFEST recorded for it if
+// the DB has the file_checksum_gen_factory that made it, else by its block
+// checksums. A corrupted local copy of a sound object is downloaded again,
+// and a corrupted object of a sound local copy is uploaded again. See
+// CloudFileSystemOptions::scrub_interval_secs.
+//
+// Thread safe.
+class CloudSstScrubber {
+ public:
+  // The files of the column families of db with ids cf_ids are read with
+  // their options. local_env reads the local directory.
+  CloudSstScrubber(DB* db, CloudFileSystemImpl* cfs, Env* local_env,
+                   const std::vector<uint32_t>& cf_ids,
+                   uint64_t bytes_per_sec);
+  ~CloudSstScrubber();
+
+  // Verifies the live SST files once. Returns Aborted if stopped, or the
+  // first error other than a corruption, which only stops the pass.
+  // REQUIRES: not called concurrently with itself.
+  Status RunPass();
+
+  // Makes a running pass return soon
+  void Stop() { stop_.store(true, std::memory_order_relaxed); }
+
+  void GetStats(DBCloud::ScrubStats* stats) const;
+
+ private:
+  // A live SST file
+  struct File {
+    std::string local_path;
+    // Empty if the dest bucket doesn't hold it
+    std::string object_path;
+    uint64_t size;
+    std::string checksum_func_name;
+    std::string checksum;
+    std::string cf_name;
+  };
+
+  // Verifies the local copy or the object of file with env
+  Status VerifyFile(const File& file, bool local);
+  Status VerifyFileChecksum(const File& file, const std::string& path,
+                            Env* env);
+  void ScrubLocalCopy(const File& file);
+  void ScrubObject(const File& file);
+
+  DB* const db_;
+  CloudFileSystemImpl* const cfs_;
+  Env* const local_env_;
+  // The options of the files of each column family, by name
+  std::unordered_map<std::string, Options> cf_options_;
+  std::shared_ptr<RateLimiter> rate_limiter_;
+  std::atomic<bool> stop_{false};
+
+  std::atomic<uint64_t> num_passes_{0};
+  std::atomic<uint64_t> num_verified_{0};
+  std::atomic<uint64_t> verified_bytes_{0};
+  std::atomic<uint64_t> num_corrupted_{0};
+  std::atomic<uint64_t> num_repaired_{0};
+};
+
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -3,24 +3,158 @@
 
 #include "rocksdb/cloud/cloud_storage_provider.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <unordered_set>
 
+#include "cloud/cloud_multipart_uploader.h"
+#include "cloud/cloud_request_tracer.h"
+#include "cloud/cloud_transfer_executor.h"
 #include "cloud/filename.h"
+#include "env/env_encryption_ctr.h"
 #include "file/filename.h"
+#include "monitoring/iostats_context_imp.h"
+#include "monitoring/statistics_impl.h"
+#include "rocksdb/cloud/cloud_file_cache.h"
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/env.h"
+#include "rocksdb/env_encryption.h"
 #include "rocksdb/options.h"
+#include "rocksdb/perf_level.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/object_registry.h"
+#include "util/aligned_buffer.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
 #include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 #ifndef ROCKSDB_LITE
 /******************** Readablefile ******************/
+namespace {
+// MultiRead requests that are at most this many bytes apart are served by a
+// single cloud read. Fetching the gap is cheaper than another round trip.
+constexpr uint64_t kMultiReadCoalesceGap = 32 * 1024;
+
+// State of one ReadAsync/MultiReadAsync call, shared between the io handle
+// given to the caller and the job running on the async read executor.
+struct CloudAsyncRead {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  // Runs the caller's callback. Invoked at most once, by PollAsyncReads.
+  std::function<void()> complete;
+};
+
+struct CloudAsyncReadHandle {
+  std::shared_ptr<CloudAsyncRead> read;
+};
+
+// Registry of the outstanding handles, so that Poll can tell them apart from
+// the handles of the local file system.
+struct CloudAsyncReadRegistry {
+  std::mutex mutex;
+  std::unordered_set<void*> handles;
+
+  bool Contains(void* handle) {
+    std::lock_guard<std::mutex> lk(mutex);
+    return handles.count(handle) > 0;
+  }
+};
+
+CloudAsyncReadRegistry& GetCloudAsyncReadRegistry() {
+  // Intentionally leaked, handles may outlive static destruction
+  static auto* registry = new CloudAsyncReadRegistry();
+  return *registry;
+}
+
+void WaitForAsyncRead(CloudAsyncRead* read) {
+  std::unique_lock<std::mutex> lk(read->mutex);
+  read->cv.wait(lk, [read] { return read->done; });
+}
+
+// The object was just written, its cached metadata is stale
+void InvalidateCloudObjectMetadata(CloudFileSystem* cfs,
+                                   const std::string& bucket_name,
+                                   const std::string& object_path) {
+  auto cfs_impl = dynamic_cast<CloudFileSystemImpl*>(cfs);
+  if (cfs_impl) {
+    cfs_impl->InvalidateCloudObjectMetadata(bucket_name, object_path);
+  }
+}
+
+// Sets *crc32c to the CRC32C of the contents of a local file
+IOStatus ComputeFileChecksum(FileSystem* fs, const std::string& path,
+                             uint32_t* crc32c) {
+  std::unique_ptr<FSSequentialFile> file;
+  auto st = fs->NewSequentialFile(path, FileOptions(), &file, nullptr /*dbg*/);
+  if (!st.ok()) {
+    return st;
+  }
+  std::string scratch(1 << 20, '\0');
+  *crc32c = 0;
+  while (true) {
+    Slice result;
+    st = file->Read(scratch.size(), IOOptions(), &result, &scratch[0],
+                    nullptr /*dbg*/);
+    if (!st.ok() || result.empty()) {
+      return st;
+    }
+    *crc32c = crc32c::Extend(*crc32c, result.data(), result.size());
+  }
+}
+
+// Writes the contents of the local file src, encrypted or decrypted with
+// cipher, to the new local file dst
+IOStatus CopyThroughCipher(FileSystem* fs, const std::string& src,
+                           const std::string& dst,
+                           BlockAccessCipherStream* cipher, bool encrypt) {
+  std::unique_ptr<FSSequentialFile> in;
+  auto st = fs->NewSequentialFile(src, FileOptions(), &in, nullptr /*dbg*/);
+  std::unique_ptr<FSWritableFile> out;
+  if (st.ok()) {
+    st = fs->NewWritableFile(dst, FileOptions(), &out, nullptr /*dbg*/);
+  }
+  std::string scratch(1 << 20, '\0');
+  uint64_t offset = 0;
+  while (st.ok()) {
+    Slice result;
+    st = in->Read(scratch.size(), IOOptions(), &result, &scratch[0],
+                  nullptr /*dbg*/);
+    if (!st.ok() || result.empty()) {
+      break;
+    }
+    if (result.data() != scratch.data()) {
+      memcpy(&scratch[0], result.data(), result.size());
+    }
+    st = status_to_io_status(
+        encrypt ? cipher->Encrypt(offset, &scratch[0], result.size())
+                : cipher->Decrypt(offset, &scratch[0], result.size()));
+    if (st.ok()) {
+      st = out->Append(Slice(scratch.data(), result.size()), IOOptions(),
+                       nullptr /*dbg*/);
+    }
+    offset += result.size();
+  }
+  if (out) {
+    auto close_st = out->Close(IOOptions(), nullptr /*dbg*/);
+    if (st.ok()) {
+      st = close_st;
+    }
+  }
+  return st;
+}
+}  // namespace
+
 CloudStorageReadableFileImpl::CloudStorageReadableFileImpl(
     Logger* info_log, const std::string& bucket, const std::string& fname,
     uint64_t file_size)
@@ -75,9 +209,32 @@ IOStatus CloudStorageReadableFileImpl::Read(uint64_t offset, size_t n,
         " trimmed size %ld",
         Name(), fname_.c_str(), offset, n);
   }
-  uint64_t bytes_read;
-  auto st = DoCloudRead(offset, n, options, scratch, &bytes_read, dbg);
+  // The end of the read may be in the tail read when the file was opened
+  size_t from_tail = 0;
+  if (tail_ != nullptr && offset + n > tail_offset_) {
+    uint64_t tail_start = std::max(offset, tail_offset_);
+    from_tail = static_cast<size_t>(offset + n - tail_start);
+    memcpy(scratch + (tail_start - offset),
+           tail_->data() + (tail_start - tail_offset_), from_tail);
+    n -= from_tail;
+  }
+  uint64_t bytes_read = 0;
+  IOStatus st;
+  if (n == 0) {
+    // All in the tail
+  } else if (readahead_size_ > 0 && ReadFromReadahead(offset, n, scratch)) {
+    bytes_read = n;
+    IOSTATS_ADD(cloud_readahead_hit_bytes, n);
+  } else if (file_cache_) {
+    st = ReadThroughFileCache(offset, n, options, scratch, &bytes_read, dbg);
+  } else {
+    st = CloudRead(offset, n, options, scratch, &bytes_read, dbg);
+  }
   if (st.ok()) {
+    // Unless a short read leaves a gap before it
+    if (bytes_read == n) {
+      bytes_read += from_tail;
+    }
     *result = Slice(scratch, bytes_read);
     Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
         "[%s] CloudReadableFile file %s filesize %" PRIu64 " read %" PRIu64
@@ -87,6 +244,393 @@ IOStatus CloudStorageReadableFileImpl::Read(uint64_t offset, size_t n,
   return st;
 }
 
+IOStatus CloudStorageReadableFileImpl::MultiRead(FSReadRequest* reqs,
+                                                 size_t num_reqs,
+                                                 const IOOptions& options,
+                                                 IODebugContext* dbg) {
+  std::vector<size_t> order(num_reqs);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [reqs](size_t a, size_t b) {
+    return reqs[a].offset < reqs[b].offset;
+  });
+
+  std::string buffer;
+  size_t num_cloud_reads = 0;
+  for (size_t i = 0; i < num_reqs;) {
+    uint64_t start = reqs[order[i]].offset;
+    uint64_t end = start + reqs[order[i]].len;
+    size_t j = i + 1;
+    for (; j < num_reqs && reqs[order[j]].offset <= end + kMultiReadCoalesceGap;
+         j++) {
+      end = std::max(end, reqs[order[j]].offset + reqs[order[j]].len);
+    }
+    num_cloud_reads++;
+
+    if (j == i + 1) {
+      auto& req = reqs[order[i]];
+      req.status =
+          Read(req.offset, req.len, options, &req.result, req.scratch, dbg);
+    } else {
+      buffer.resize(end - start);
+      Slice data;
+      auto st = Read(start, end - start, options, &data, &buffer[0], dbg);
+      for (size_t k = i; k < j; k++) {
+        auto& req = reqs[order[k]];
+        req.status = st;
+        req.result = Slice();
+        uint64_t pos = req.offset - start;
+        if (st.ok() && pos < data.size()) {
+          size_t len = static_cast<size_t>(
+              std::min<uint64_t>(req.len, data.size() - pos));
+          memcpy(req.scratch, data.data() + pos, len);
+          req.result = Slice(req.scratch, len);
+        }
+      }
+    }
+    i = j;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] CloudReadableFile %s MultiRead %" ROCKSDB_PRIszt
+      " requests with %" ROCKSDB_PRIszt " cloud reads",
+      Name(), fname_.c_str(), num_reqs, num_cloud_reads);
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::ReadAsync(
+    FSReadRequest& req, const IOOptions& options,
+    std::function<void(FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  if (!async_read_executor_) {
+    return CloudStorageReadableFile::ReadAsync(req, options, cb, cb_arg,
+                                               io_handle, del_fn, dbg);
+  }
+  SubmitAsyncRead(
+      &req, 1, options, [cb, &req, cb_arg]() { cb(req, cb_arg); }, io_handle,
+      del_fn);
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::MultiReadAsync(
+    FSReadRequest* reqs, size_t num_reqs, const IOOptions& options,
+    std::function<void(const FSReadRequest*, size_t, void*)> cb, void* cb_arg,
+    void** io_handles, size_t* num_io_handles, IOHandleDeleter* del_fns,
+    IODebugContext* dbg) {
+  if (!async_read_executor_ || num_reqs == 0) {
+    return CloudStorageReadableFile::MultiReadAsync(
+        reqs, num_reqs, options, cb, cb_arg, io_handles, num_io_handles,
+        del_fns, dbg);
+  }
+  assert(*num_io_handles == num_reqs);
+  // The whole batch is a single job, so that MultiRead can coalesce it
+  SubmitAsyncRead(
+      reqs, num_reqs, options,
+      [cb, reqs, num_reqs, cb_arg]() { cb(reqs, num_reqs, cb_arg); },
+      &io_handles[0], &del_fns[0]);
+  *num_io_handles = 1;
+  return IOStatus::OK();
+}
+
+void CloudStorageReadableFileImpl::SubmitAsyncRead(
+    FSReadRequest* reqs, size_t num_reqs, const IOOptions& options,
+    std::function<void()> complete, void** io_handle,
+    IOHandleDeleter* del_fn) {
+  auto read = std::make_shared<CloudAsyncRead>();
+  read->complete = std::move(complete);
+  auto* handle = new CloudAsyncReadHandle{read};
+  {
+    auto& registry = GetCloudAsyncReadRegistry();
+    std::lock_guard<std::mutex> lk(registry.mutex);
+    registry.handles.insert(handle);
+  }
+  *io_handle = handle;
+  *del_fn = [](void* h) {
+    auto& registry = GetCloudAsyncReadRegistry();
+    {
+      std::lock_guard<std::mutex> lk(registry.mutex);
+      registry.handles.erase(h);
+    }
+    delete static_cast<CloudAsyncReadHandle*>(h);
+  };
+
+  async_read_executor_->SubmitJob([this, read, reqs, num_reqs, options]() {
+    auto st = MultiRead(reqs, num_reqs, options, nullptr /*dbg*/);
+    if (!st.ok()) {
+      for (size_t i = 0; i < num_reqs; i++) {
+        reqs[i].status = st;
+      }
+    }
+    std::lock_guard<std::mutex> lk(read->mutex);
+    read->done = true;
+    read->cv.notify_all();
+  });
+}
+
+IOStatus CloudStorageReadableFileImpl::PollAsyncReads(
+    const std::vector<void*>& io_handles, std::vector<void*>* other_handles) {
+  auto& registry = GetCloudAsyncReadRegistry();
+  for (auto* h : io_handles) {
+    if (!registry.Contains(h)) {
+      other_handles->push_back(h);
+      continue;
+    }
+    auto* read = static_cast<CloudAsyncReadHandle*>(h)->read.get();
+    {
+      IOSTATS_TIMER_GUARD(cloud_read_wait_nanos);
+      WaitForAsyncRead(read);
+    }
+    if (read->complete) {
+      read->complete();
+      read->complete = nullptr;
+    }
+  }
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::AbortAsyncReads(
+    const std::vector<void*>& io_handles, std::vector<void*>* other_handles) {
+  auto& registry = GetCloudAsyncReadRegistry();
+  for (auto* h : io_handles) {
+    if (!registry.Contains(h)) {
+      other_handles->push_back(h);
+      continue;
+    }
+    // A cloud read in flight cannot be cancelled. Wait for it so that the
+    // caller's buffers are not written to after AbortIO returns.
+    auto* read = static_cast<CloudAsyncReadHandle*>(h)->read.get();
+    WaitForAsyncRead(read);
+    read->complete = nullptr;
+  }
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::CloudRead(uint64_t offset, size_t n,
+                                                 const IOOptions& options,
+                                                 char* scratch,
+                                                 uint64_t* bytes_read,
+                                                 IODebugContext* dbg) const {
+  IOStatus st;
+  if (!request_tracer_) {
+    st = DoCloudRead(offset, n, options, scratch, bytes_read, dbg);
+  } else {
+    auto start = request_tracer_->NowMicros();
+    st = DoCloudRead(offset, n, options, scratch, bytes_read, dbg);
+    request_tracer_->Record(CloudRequestOpType::kReadOp, bucket_, fname_,
+                            offset, n, st.ok() ? *bytes_read : 0, start, st);
+  }
+  if (st.ok() && cipher_ && *bytes_read > 0) {
+    // CTR: only the blocks read are decrypted
+    st = status_to_io_status(
+        cipher_->Decrypt(offset, scratch, static_cast<size_t>(*bytes_read)));
+  }
+  return st;
+}
+
+IOStatus CloudStorageReadableFileImpl::ReadThroughFileCache(
+    uint64_t offset, size_t n, const IOOptions& options, char* scratch,
+    uint64_t* bytes_read, IODebugContext* dbg) const {
+  const uint64_t extent_size = file_cache_->GetExtentSize();
+  const std::string cache_key = bucket_ + pathsep + fname_;
+  std::string extent_data;
+  *bytes_read = 0;
+  while (*bytes_read < n) {
+    uint64_t pos = offset + *bytes_read;
+    uint64_t extent = pos / extent_size;
+    uint64_t extent_start = extent * extent_size;
+    uint64_t extent_len = std::min(extent_size, file_size_ - extent_start);
+
+    auto st = file_cache_->Lookup(cache_key, extent, &extent_data);
+    const bool hit = st.ok() && extent_data.size() == extent_len;
+    if (!hit) {
+      // Cache miss. Fetch the whole extent so that the following reads of
+      // this extent are served locally.
+      Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+          "[%s] CloudReadableFile %s file cache miss extent %" PRIu64, Name(),
+          fname_.c_str(), extent);
+      extent_data.resize(extent_len);
+      uint64_t fetched = 0;
+      st = CloudRead(extent_start, extent_len, options, &extent_data[0],
+                     &fetched, dbg);
+      if (!st.ok()) {
+        return st;
+      }
+      extent_data.resize(fetched);
+      if (fetched == extent_len) {
+        // Failing to populate the cache does not fail the read.
+        file_cache_->Insert(cache_key, extent, extent_data)
+            .PermitUncheckedError();
+      }
+    }
+
+    uint64_t pos_in_extent = pos - extent_start;
+    if (pos_in_extent >= extent_data.size()) {
+      // short read from the provider
+      break;
+    }
+    size_t len = static_cast<size_t>(std::min<uint64_t>(
+        n - *bytes_read, extent_data.size() - pos_in_extent));
+    memcpy(scratch + *bytes_read, extent_data.data() + pos_in_extent, len);
+    *bytes_read += len;
+    if (hit) {
+      IOSTATS_ADD(cloud_file_cache_hit_bytes, len);
+    }
+  }
+  return IOStatus::OK();
+}
+
+void CloudStorageReadableFileImpl::SetTail(std::string tail) {
+  assert(tail.size() <= file_size_);
+  tail_offset_ = file_size_ - tail.size();
+  tail_.reset(new std::string(std::move(tail)));
+}
+
+void CloudStorageReadableFileImpl::SetReadahead(
+    const std::shared_ptr<CloudTransferExecutor>& executor,
+    uint64_t readahead_size, int streams) {
+  readahead_executor_ = executor;
+  readahead_size_ = readahead_size;
+  readahead_streams_ = std::max(streams, 1);
+}
+
+CloudStorageReadableFileImpl::ReadaheadBuffer*
+CloudStorageReadableFileImpl::FindReadahead(uint64_t offset) const {
+  for (auto& buffer : readahead_buffers_) {
+    if (buffer.offset <= offset &&
+        offset < buffer.offset + buffer.data->size()) {
+      return &buffer;
+    }
+  }
+  return nullptr;
+}
+
+bool CloudStorageReadableFileImpl::ReadFromReadahead(uint64_t offset, size_t n,
+                                                     char* scratch) const {
+  // The buffers are copied from outside of the mutex
+  std::vector<std::pair<uint64_t, std::shared_ptr<const std::string>>> pieces;
+  const uint64_t end = offset + n;
+  {
+    std::lock_guard<std::mutex> lk(readahead_mutex_);
+    for (uint64_t pos = offset; pos < end;) {
+      auto buffer = FindReadahead(pos);
+      if (buffer == nullptr) {
+        return false;
+      }
+      buffer->last_use = ++readahead_clock_;
+      pieces.emplace_back(buffer->offset, buffer->data);
+      pos = buffer->offset + buffer->data->size();
+    }
+  }
+  uint64_t pos = offset;
+  for (const auto& piece : pieces) {
+    auto len = std::min(end, piece.first + piece.second->size()) - pos;
+    memcpy(scratch + (pos - offset), piece.second->data() + (pos - piece.first),
+           static_cast<size_t>(len));
+    pos += len;
+  }
+  return true;
+}
+
+IOStatus CloudStorageReadableFileImpl::Prefetch(uint64_t offset, size_t n,
+                                                const IOOptions& options,
+                                                IODebugContext* dbg) {
+  // The tail read when the file was opened is not fetched again
+  if (tail_ != nullptr && offset + n > tail_offset_) {
+    if (offset >= tail_offset_) {
+      return IOStatus::OK();
+    }
+    n = static_cast<size_t>(tail_offset_ - offset);
+  }
+  if (readahead_size_ == 0) {
+    return IOStatus::NotSupported("Prefetch");
+  }
+  uint64_t end = std::min<uint64_t>(offset + n, file_size_);
+  uint64_t start = offset;
+  {
+    std::lock_guard<std::mutex> lk(readahead_mutex_);
+    for (const auto& buffer : readahead_buffers_) {
+      uint64_t buffer_end = buffer.offset + buffer.data->size();
+      if (offset < buffer.offset || offset > buffer_end) {
+        continue;
+      }
+      if (end <= buffer_end) {
+        return IOStatus::OK();
+      }
+      // A sequential scan: fetch what follows the buffer, further ahead
+      start = buffer_end;
+      end = std::max(
+          end, start + std::min<uint64_t>(readahead_size_,
+                                          2 * buffer.data->size()));
+      end = std::min(end, file_size_);
+      break;
+    }
+  }
+  if (start >= end) {
+    return IOStatus::OK();
+  }
+
+  const uint64_t len = end - start;
+  const size_t num_streams = static_cast<size_t>(std::min<uint64_t>(
+      readahead_streams_,
+      (len + kMinReadaheadStreamSize - 1) / kMinReadaheadStreamSize));
+  const uint64_t stream_size = (len + num_streams - 1) / num_streams;
+  std::string data;
+  data.resize(static_cast<size_t>(len));
+  std::vector<uint64_t> bytes_read(num_streams, 0);
+  auto read_stream = [&](size_t i) {
+    uint64_t stream_start = i * stream_size;
+    auto stream_len = std::min(stream_size, len - stream_start);
+    return CloudRead(start + stream_start, static_cast<size_t>(stream_len),
+                     options, &data[stream_start], &bytes_read[i], dbg);
+  };
+  IOStatus st;
+  if (readahead_executor_ != nullptr && num_streams > 1) {
+    IOSTATS_TIMER_GUARD(cloud_read_wait_nanos);
+    st = readahead_executor_->RunAll(CloudTransferExecutor::kHydrate,
+                                     num_streams, read_stream, num_streams);
+  } else {
+    for (size_t i = 0; i < num_streams && st.ok(); i++) {
+      st = read_stream(i);
+    }
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  // Keep what was read up to the first short read
+  uint64_t valid = 0;
+  for (size_t i = 0; i < num_streams; i++) {
+    valid += bytes_read[i];
+    if (bytes_read[i] < std::min(stream_size, len - i * stream_size)) {
+      break;
+    }
+  }
+  data.resize(static_cast<size_t>(valid));
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] CloudReadableFile %s prefetched %" PRIu64
+      " bytes at offset %" PRIu64 " with %" ROCKSDB_PRIszt " reads",
+      Name(), fname_.c_str(), valid, start, num_streams);
+  if (valid == 0) {
+    return IOStatus::OK();
+  }
+
+  std::lock_guard<std::mutex> lk(readahead_mutex_);
+  auto lru = readahead_buffers_.end();
+  if (readahead_buffers_.size() >= kMaxReadaheadBuffers) {
+    lru = std::min_element(readahead_buffers_.begin(), readahead_buffers_.end(),
+                           [](const ReadaheadBuffer& a,
+                              const ReadaheadBuffer& b) {
+                             return a.last_use < b.last_use;
+                           });
+  }
+  ReadaheadBuffer buffer{
+      start, std::make_shared<const std::string>(std::move(data)),
+      ++readahead_clock_};
+  if (lru != readahead_buffers_.end()) {
+    *lru = std::move(buffer);
+  } else {
+    readahead_buffers_.push_back(std::move(buffer));
+  }
+  return IOStatus::OK();
+}
+
 IOStatus CloudStorageReadableFileImpl::Skip(uint64_t n) {
   Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
       "[%s] CloudReadableFile file %s skip %" PRIu64, Name(), fname_.c_str(),
@@ -101,6 +645,62 @@ IOStatus CloudStorageReadableFileImpl::Skip(uint64_t n) {
 
 /******************** Writablefile ******************/
 
+namespace {
+// Makes a closed SST file durable in the cloud, in storage_class if not
+// empty, and drops the local copy unless keep_local. uploader, if any, has
+// streamed most of the file already.
+IOStatus UploadClosedSstFile(CloudFileSystem* cfs, const char* name,
+                             const std::string& fname,
+                             const std::string& bucket,
+                             const std::string& cloud_fname, bool keep_local,
+                             const std::string& storage_class,
+                             CloudMultipartUploader* uploader) {
+  bool uploaded = false;
+  if (uploader) {
+    // Most of the file is already in the cloud, send the tail
+    auto upload_st = uploader->Finish(&uploaded);
+    if (!upload_st.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, cfs->GetLogger(),
+          "[%s] CloudWritableFile %s streaming upload failed, retrying "
+          "with a single upload: %s",
+          name, fname.c_str(), upload_st.ToString().c_str());
+    }
+  }
+  // SST files are never overwritten, so unlike CopyLocalFileToDest the
+  // streamed upload doesn't have to cancel a pending deletion.
+  IOStatus st;
+  if (uploaded) {
+    InvalidateCloudObjectMetadata(cfs, bucket, cloud_fname);
+  } else if (bucket == cfs->GetDestBucketName()) {
+    st = cfs->CopyLocalFileToDest(fname, cloud_fname, storage_class);
+  } else {
+    // In the low-latency bucket
+    st = cfs->GetStorageProvider()->PutCloudObjectInStorageClass(
+        fname, bucket, cloud_fname, storage_class);
+  }
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+        "[%s] CloudWritableFile closing PutObject failed on local file %s",
+        name, fname.c_str());
+    return st;
+  }
+
+  // delete local file, unless it is retained
+  if (!keep_local) {
+    st = cfs->ReleaseLocalSstFile(fname);
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+          "[%s] CloudWritableFile closing release failed on local file %s",
+          name, fname.c_str());
+      return st;
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cfs->GetLogger(),
+      "[%s] CloudWritableFile closed file %s", name, fname.c_str());
+  return st;
+}
+}  // namespace
+
 CloudStorageWritableFileImpl::CloudStorageWritableFileImpl(
     CloudFileSystem* fs, const std::string& local_fname,
     const std::string& bucket, const std::string& cloud_fname,
@@ -108,11 +708,16 @@ CloudStorageWritableFileImpl::CloudStorageWritableFileImpl(
     : cfs_(fs),
       fname_(local_fname),
       bucket_(bucket),
-      cloud_fname_(cloud_fname) {
+      cloud_fname_(cloud_fname),
+      keep_local_(fs->GetCloudFileSystemOptions().KeepLocalSstFile(
+          file_opts.temperature)),
+      storage_class_(fs->GetCloudFileSystemOptions().SstStorageClass(
+          file_opts.temperature)) {
   auto fname_no_epoch = RemoveEpoch(fname_);
   // Is this a manifest file?
   is_manifest_ = IsManifestFile(fname_no_epoch);
-  assert(IsSstFile(fname_no_epoch) || is_manifest_);
+  assert(IsSstFile(fname_no_epoch) || IsBlobFile(fname_no_epoch) ||
+         is_manifest_);
 
   Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
       "[%s] CloudWritableFile bucket %s opened local file %s "
@@ -155,6 +760,38 @@ CloudStorageWritableFileImpl::~CloudStorageWritableFileImpl() {
   }
 }
 
+void CloudStorageWritableFileImpl::SetMultipartUploader(
+    std::unique_ptr<CloudMultipartUploader> uploader) {
+  uploader_ = std::move(uploader);
+  uploader_->SetIOPriority(GetIOPriority());
+}
+
+void CloudStorageWritableFileImpl::SetIOPriority(Env::IOPriority pri) {
+  CloudStorageWritableFile::SetIOPriority(pri);
+  if (local_file_) {
+    local_file_->SetIOPriority(pri);
+  }
+  if (uploader_) {
+    uploader_->SetIOPriority(pri);
+  }
+}
+
+void CloudStorageWritableFileImpl::AppendToUploader(const Slice& data) {
+  auto st = uploader_->Append(data);
+  if (!st.ok()) {
+    CancelUploader(st.ToString().c_str());
+  }
+}
+
+void CloudStorageWritableFileImpl::CancelUploader(const char* reason) {
+  Log(InfoLogLevel::WARN_LEVEL, cfs_->GetLogger(),
+      "[%s] CloudWritableFile %s streaming upload cancelled (%s), uploading "
+      "on close",
+      Name(), fname_.c_str(), reason);
+  uploader_->Abort();
+  uploader_.reset();
+}
+
 IOStatus CloudStorageWritableFileImpl::Close(const IOOptions& opts,
                                              IODebugContext* dbg) {
   if (local_file_ == nullptr) {  // already closed
@@ -174,27 +811,41 @@ IOStatus CloudStorageWritableFileImpl::Close(const IOOptions& opts,
   }
   local_file_.reset();
 
-  if (!is_manifest_) {
-    status_ = cfs_->CopyLocalFileToDest(fname_, cloud_fname_);
+  bool packed = false;
+  if (!is_manifest_ && bucket_ == cfs_->GetDestBucketName() &&
+      storage_class_.empty()) {
+    // A small SST file waits for a pack instead
+    status_ = cfs_->PackSstFile(fname_, keep_local_, &packed);
     if (!status_.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-          "[%s] CloudWritableFile closing PutObject failed on local file %s",
-          Name(), fname_.c_str());
       return status_;
     }
-
-    // delete local file
-    if (!cfs_->GetCloudFileSystemOptions().keep_local_sst_files) {
-      status_ = cfs_->GetBaseFileSystem()->DeleteFile(fname_, opts, dbg);
-      if (!status_.ok()) {
-        Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-            "[%s] CloudWritableFile closing delete failed on local file %s",
-            Name(), fname_.c_str());
-        return status_;
-      }
+    if (packed && uploader_) {
+      uploader_->Abort();
+      uploader_.reset();
+    }
+  }
+  if (!is_manifest_ && !packed) {
+    // The upload may run after this file is gone, so it only works on copies
+    std::shared_ptr<CloudMultipartUploader> uploader(std::move(uploader_));
+    auto upload = [cfs = cfs_, fname = fname_, bucket = bucket_,
+                   cloud_fname = cloud_fname_, keep_local = keep_local_,
+                   storage_class = storage_class_, name = std::string(Name()),
+                   uploader, io_priority = GetIOPriority()]() {
+      CloudTransferExecutor::ScopedIOPriority scoped_priority(io_priority);
+      return UploadClosedSstFile(cfs, name.c_str(), fname, bucket,
+                                 cloud_fname, keep_local, storage_class,
+                                 uploader.get());
+    };
+    status_ = cfs_->ScheduleUpload(fname_, std::move(upload));
+    if (!status_.ok()) {
+      return status_;
+    }
+  } else if (is_manifest_) {
+    // Don't leave a closed MANIFEST waiting for its deferred upload
+    status_ = cfs_->FlushManifestUpload();
+    if (!status_.ok()) {
+      return status_;
     }
-    Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
-        "[%s] CloudWritableFile closed file %s", Name(), fname_.c_str());
   }
   return IOStatus::OK();
 }
@@ -210,7 +861,9 @@ IOStatus CloudStorageWritableFileImpl::Sync(const IOOptions& opts,
   // sync local file
   auto stat = local_file_->Sync(opts, dbg);
 
-  if (stat.ok() && !tmp_file_.empty()) {
+  // A new MANIFEST file is uploaded right away
+  const bool first_sync = !tmp_file_.empty();
+  if (stat.ok() && first_sync) {
     assert(is_manifest_);
     // We are writing to the temporary file. On a first sync we need to rename
     // the file to the real filename.
@@ -220,12 +873,13 @@ IOStatus CloudStorageWritableFileImpl::Sync(const IOOptions& opts,
     tmp_file_.clear();
   }
 
-  // We copy MANIFEST to cloud on every Sync()
+  // We copy MANIFEST to cloud on every Sync(), unless the uploads are
+  // coalesced by manifest_upload_interval_millis
   if (is_manifest_ && stat.ok()) {
-    stat = cfs_->CopyLocalFileToDest(fname_, cloud_fname_);
+    stat = cfs_->SyncManifestToDest(fname_, cloud_fname_, first_sync);
     if (stat.ok()) {
       Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
-          "[%s] CloudWritableFile made manifest %s durable to "
+          "[%s] CloudWritableFile synced manifest %s to "
           "bucket %s bucketpath %s.",
           Name(), fname_.c_str(), bucket_.c_str(), cloud_fname_.c_str());
     } else {
@@ -241,16 +895,62 @@ IOStatus CloudStorageWritableFileImpl::Sync(const IOOptions& opts,
 
 CloudStorageProvider::~CloudStorageProvider() {}
 
+IOStatus CloudStorageProvider::DeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  IOStatus first_error;
+  for (const auto& object_path : object_paths) {
+    auto st = DeleteCloudObject(bucket_name, object_path);
+    if (!st.ok() && !st.IsNotFound() && first_error.ok()) {
+      first_error = st;
+    }
+  }
+  return first_error;
+}
+
+IOStatus CloudStorageProvider::ListCloudObjectsInBatches(
+    const std::string& bucket_name, const std::string& object_path,
+    const ListCloudObjectsCallback& fn) {
+  std::vector<std::string> path_names;
+  auto st = ListCloudObjects(bucket_name, object_path, &path_names);
+  if (st.ok()) {
+    st = fn(path_names);
+  }
+  return st;
+}
+
 Status CloudStorageProvider::CreateFromString(
-    const ConfigOptions& /*config_options*/, const std::string& id,
+    const ConfigOptions& config_options, const std::string& value,
     std::shared_ptr<CloudStorageProvider>* provider) {
-  if (id.empty()) {
+  if (value.empty()) {
     provider->reset();
     return Status::OK();
-  } else {
-    return ObjectRegistry::NewInstance()->NewSharedObject<CloudStorageProvider>(
-        id, provider);
   }
+  // Either an id, or "id=<id>;<option>=<value>;..."
+  std::string id = value;
+  std::unordered_map<std::string, std::string> options;
+  if (value.find('=') != std::string::npos) {
+    Status s = StringToMap(value, &options);
+    if (!s.ok()) {
+      return s;
+    }
+    auto iter = options.find("id");
+    if (iter == options.end()) {
+      return Status::InvalidArgument("Storage provider id missing: " + value);
+    }
+    id = iter->second;
+    options.erase(iter);
+  }
+  Status s =
+      ObjectRegistry::NewInstance()->NewSharedObject<CloudStorageProvider>(
+          id, provider);
+  if (s.ok() && !options.empty()) {
+    ConfigOptions copy = config_options;
+    // Prepared with the file system it belongs to
+    copy.invoke_prepare_options = false;
+    s = (*provider)->ConfigureFromMap(copy, options);
+  }
+  return s;
 }
 
 Status CloudStorageProviderImpl::PrepareOptions(const ConfigOptions& options) {
@@ -259,7 +959,44 @@ Status CloudStorageProviderImpl::PrepareOptions(const ConfigOptions& options) {
   Status st = CloudStorageProvider::PrepareOptions(options);
   if (!st.ok()) {
     return st;
-  } else if (cfs_->HasDestBucket()) {
+  }
+  const auto& cfs_options = cfs_->GetCloudFileSystemOptions();
+  auto new_executor = [](int num_threads) {
+    return std::shared_ptr<ThreadPool>(NewThreadPool(num_threads),
+                                       [](ThreadPool* pool) {
+                                         pool->WaitForJobsAndJoinAllThreads();
+                                         delete pool;
+                                       });
+  };
+  if (cfs_options.async_read_threads > 0 && !async_read_executor_) {
+    async_read_executor_ = new_executor(cfs_options.async_read_threads);
+  }
+  if (cfs_options.cloud_download_streams > 1 && !download_executor_) {
+    // Not the transfer executor: downloads run in its jobs
+    download_executor_ = new_executor(cfs_options.cloud_download_streams - 1);
+  }
+  if (!cfs_options.request_trace_file.empty() && !request_tracer_) {
+    std::unique_ptr<CloudRequestTracer> tracer;
+    st = CloudRequestTracer::Create(cfs_->GetBaseFileSystem(),
+                                    cfs_options.request_trace_file, &tracer);
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+          "[%s] Unable to create request trace %s: %s", Name(),
+          cfs_options.request_trace_file.c_str(), st.ToString().c_str());
+      return st;
+    }
+    request_tracer_ = std::move(tracer);
+  }
+  if (cfs_options.multipart_upload_part_size > 0 && !upload_executor_) {
+    auto cfs_impl = dynamic_cast<CloudFileSystemImpl*>(cfs_);
+    if (cfs_impl != nullptr && cfs_impl->GetTransferExecutor()) {
+      upload_executor_ = cfs_impl->GetTransferExecutor()->NewThreadPool(
+          CloudTransferExecutor::kUpload);
+    } else {
+      upload_executor_ = new_executor(std::max(cfs_options.upload_threads, 1));
+    }
+  }
+  if (cfs_->HasDestBucket()) {
     // create dest bucket if specified
     if (ExistsBucket(cfs_->GetDestBucketName()).ok()) {
       Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
@@ -291,18 +1028,204 @@ CloudStorageProviderImpl::CloudStorageProviderImpl()
 
 CloudStorageProviderImpl::~CloudStorageProviderImpl() {}
 
+void CloudStorageProviderImpl::RecordRequest(Statistics* stats,
+                                             CloudRequestOpType type,
+                                             uint64_t bytes, uint64_t micros,
+                                             bool success) {
+  static_assert(CLOUD_INFO_REQUESTS - CLOUD_READ_REQUESTS ==
+                    static_cast<uint32_t>(CloudRequestOpType::kInfoOp),
+                "The cloud request tickers follow CloudRequestOpType");
+  static_assert(CLOUD_INFO_MICROS - CLOUD_READ_MICROS ==
+                    static_cast<uint32_t>(CloudRequestOpType::kInfoOp),
+                "The cloud request histograms follow CloudRequestOpType");
+  if (!success) {
+    bytes = 0;
+  }
+  if (type == CloudRequestOpType::kReadOp) {
+    IOSTATS_ADD(cloud_read_count, 1);
+    IOSTATS_ADD(cloud_read_bytes, bytes);
+    if (GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex) {
+      IOSTATS_ADD(cloud_read_nanos, micros * 1000);
+    }
+  }
+  if (stats == nullptr) {
+    return;
+  }
+  const auto idx = static_cast<uint32_t>(type);
+  RecordTick(stats, static_cast<Tickers>(CLOUD_READ_REQUESTS + idx));
+  if (!success) {
+    RecordTick(stats, CLOUD_REQUEST_FAILURES);
+  } else if (type == CloudRequestOpType::kReadOp) {
+    RecordTick(stats, CLOUD_READ_BYTES, bytes);
+  } else if (type == CloudRequestOpType::kWriteOp) {
+    RecordTick(stats, CLOUD_WRITE_BYTES, bytes);
+  }
+  // Latencies are timers, like the ones of StopWatch
+  if (stats->get_stats_level() > StatsLevel::kExceptTimers) {
+    RecordInHistogram(stats, static_cast<Histograms>(CLOUD_READ_MICROS + idx),
+                      micros);
+  }
+}
+
 IOStatus CloudStorageProviderImpl::NewCloudReadableFile(
     const std::string& bucket, const std::string& fname,
     const FileOptions& options,
     std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
   CloudObjectInformation info;
-  auto st = GetCloudObjectMetadata(bucket, fname, &info);
+  const auto& cfs_options = cfs_->GetCloudFileSystemOptions();
+  // The size comes with the tail of an SST file, that is read next anyway
+  std::string tail;
+  auto st = IOStatus::NotSupported();
+  if (cfs_options.sst_open_tail_size > 0 && IsSstFile(RemoveEpoch(fname))) {
+    auto start = request_tracer_ ? request_tracer_->NowMicros() : 0;
+    st = DoReadCloudObjectTail(
+        bucket, fname, static_cast<size_t>(cfs_options.sst_open_tail_size),
+        &tail, &info);
+    if (request_tracer_ && !st.IsNotSupported()) {
+      request_tracer_->Record(CloudRequestOpType::kReadOp, bucket, fname,
+                              st.ok() ? info.size - tail.size() : 0,
+                              tail.size(), tail.size(), start, st);
+    }
+  }
+  const bool has_tail = st.ok();
+  if (st.IsNotSupported()) {
+    auto start = request_tracer_ ? request_tracer_->NowMicros() : 0;
+    st = GetCloudObjectMetadata(bucket, fname, &info);
+    if (request_tracer_) {
+      request_tracer_->Record(CloudRequestOpType::kInfoOp, bucket, fname, 0,
+                              st.ok() ? info.size : 0, 0, start, st);
+    }
+  }
+
+  std::shared_ptr<BlockAccessCipherStream> cipher;
+  if (st.ok()) {
+    st = GetObjectCipher(fname, info.metadata, &cipher);
+  }
+  if (st.ok() && cipher && !tail.empty()) {
+    st = status_to_io_status(
+        cipher->Decrypt(info.size - tail.size(), &tail[0], tail.size()));
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  st = DoNewCloudReadableFile(bucket, fname, info.size, info.content_hash,
+                              options, result, dbg);
+  if (!st.ok()) {
+    return st;
+  }
+  auto file = dynamic_cast<CloudStorageReadableFileImpl*>(result->get());
+  if (file == nullptr && cipher) {
+    result->reset();
+    return IOStatus::NotSupported("Can't decrypt reads of", fname);
+  }
+  if (file != nullptr) {
+    if (has_tail) {
+      file->SetTail(std::move(tail));
+    }
+    file->SetCipher(std::move(cipher));
+    const auto& file_cache = cfs_->GetCloudFileSystemOptions().sst_file_cache;
+    if (file_cache && IsSstFile(RemoveEpoch(fname))) {
+      file->SetFileCache(file_cache);
+    }
+    file->SetAsyncReadExecutor(async_read_executor_);
+    file->SetRequestTracer(request_tracer_);
+    if (cfs_options.cloud_readahead_size > 0) {
+      auto cfs_impl = dynamic_cast<CloudFileSystemImpl*>(cfs_);
+      file->SetReadahead(
+          cfs_impl != nullptr ? cfs_impl->GetTransferExecutor() : nullptr,
+          cfs_options.cloud_readahead_size,
+          cfs_options.cloud_readahead_streams);
+    }
+  }
+  return st;
+}
 
+IOStatus CloudStorageProviderImpl::NewCloudWritableFile(
+    const std::string& local_path, const std::string& bucket_name,
+    const std::string& object_path, const FileOptions& options,
+    std::unique_ptr<CloudStorageWritableFile>* result, IODebugContext* dbg) {
+  auto st = DoNewCloudWritableFile(local_path, bucket_name, object_path,
+                                   options, result, dbg);
   if (!st.ok()) {
     return st;
   }
-  return DoNewCloudReadableFile(bucket, fname, info.size, info.content_hash,
-                                options, result, dbg);
+  const auto& cfs_options = cfs_->GetCloudFileSystemOptions();
+  const auto local_path_no_epoch = RemoveEpoch(local_path);
+  // The files of a storage class are uploaded whole, in that class
+  if (upload_executor_ &&
+      (IsSstFile(local_path_no_epoch) || IsBlobFile(local_path_no_epoch)) &&
+      cfs_options.SstStorageClass(options.temperature).empty()) {
+    auto file = dynamic_cast<CloudStorageWritableFileImpl*>(result->get());
+    if (file != nullptr) {
+      auto uploader = std::make_unique<CloudMultipartUploader>(
+          this, upload_executor_, cfs_->GetLogger(), bucket_name, object_path,
+          cfs_options.multipart_upload_part_size);
+      if (cfs_options.cloud_encryption_cipher) {
+        std::unordered_map<std::string, std::string> metadata;
+        std::shared_ptr<BlockAccessCipherStream> cipher;
+        st = NewObjectCipher(&metadata[kEncryptionMetadataKey()], &cipher);
+        if (!st.ok()) {
+          result->reset();
+          return st;
+        }
+        uploader->SetEncryption(std::move(cipher), std::move(metadata));
+      }
+      file->SetMultipartUploader(std::move(uploader));
+    }
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::NewObjectCipher(
+    std::string* encoded, std::shared_ptr<BlockAccessCipherStream>* cipher) {
+  const auto& block_cipher =
+      cfs_->GetCloudFileSystemOptions().cloud_encryption_cipher;
+  assert(block_cipher);
+  const size_t block_size = block_cipher->BlockSize();
+  if (block_size < sizeof(uint64_t)) {
+    return IOStatus::InvalidArgument("Block of the encryption cipher too small",
+                                     block_cipher->Name());
+  }
+  // The initial counter, then the IV. They come from the OS rather than
+  // from a Random seeded with the clock as in CTREncryptionProvider: the
+  // objects that would share them would reveal each other's contents.
+  std::random_device rd;
+  std::string params(sizeof(uint64_t) + block_size, '\0');
+  for (size_t i = 0; i < params.size(); i += sizeof(uint32_t)) {
+    uint32_t r = static_cast<uint32_t>(rd());
+    memcpy(&params[i], &r, std::min(sizeof(r), params.size() - i));
+  }
+  *encoded = Slice(params).ToString(true /* hex */);
+  cipher->reset(new CTRCipherStream(block_cipher,
+                                    params.data() + sizeof(uint64_t),
+                                    DecodeFixed64(params.data())));
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageProviderImpl::GetObjectCipher(
+    const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata,
+    std::shared_ptr<BlockAccessCipherStream>* cipher) {
+  cipher->reset();
+  auto it = metadata.find(kEncryptionMetadataKey());
+  if (it == metadata.end()) {
+    return IOStatus::OK();
+  }
+  const auto& block_cipher =
+      cfs_->GetCloudFileSystemOptions().cloud_encryption_cipher;
+  if (!block_cipher) {
+    return IOStatus::InvalidArgument(
+        "Encrypted object without cloud_encryption_cipher", object_path);
+  }
+  std::string params;
+  if (!Slice(it->second).DecodeHex(&params) ||
+      params.size() != sizeof(uint64_t) + block_cipher->BlockSize()) {
+    return IOStatus::Corruption("Bad encryption metadata", object_path);
+  }
+  cipher->reset(new CTRCipherStream(block_cipher,
+                                    params.data() + sizeof(uint64_t),
+                                    DecodeFixed64(params.data())));
+  return IOStatus::OK();
 }
 
 IOStatus CloudStorageProviderImpl::GetCloudObject(
@@ -311,16 +1234,62 @@ IOStatus CloudStorageProviderImpl::GetCloudObject(
   const auto& local_fs = cfs_->GetBaseFileSystem();
   std::string tmp_destination =
       local_destination + ".tmp-" + std::to_string(rng_->Next());
-
-  uint64_t remote_size;
-  auto s =
-      DoGetCloudObject(bucket_name, object_path, tmp_destination, &remote_size);
   const IOOptions io_opts;
   IODebugContext* dbg = nullptr;
+
+  // An encrypted object is downloaded as it is, then decrypted into
+  // tmp_destination
+  std::shared_ptr<BlockAccessCipherStream> cipher;
+  CloudObjectInformation info;
+  if (cfs_->GetCloudFileSystemOptions().cloud_encryption_cipher) {
+    auto s = GetCloudObjectMetadata(bucket_name, object_path, &info);
+    if (s.ok()) {
+      s = GetObjectCipher(object_path, info.metadata, &cipher);
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const std::string download_path =
+      cipher ? tmp_destination + ".enc" : tmp_destination;
+
+  uint64_t remote_size = 0;
+  auto start = request_tracer_ ? request_tracer_->NowMicros() : 0;
+  auto s = download_executor_ ? DownloadInParts(bucket_name, object_path,
+                                                download_path, &remote_size)
+                              : DoGetCloudObject(bucket_name, object_path,
+                                                 download_path, &remote_size);
+  if (request_tracer_) {
+    request_tracer_->Record(CloudRequestOpType::kReadOp, bucket_name,
+                            object_path, 0, remote_size, remote_size, start,
+                            s);
+  }
+  if (s.ok() && cipher) {
+    s = CopyThroughCipher(local_fs.get(), download_path, tmp_destination,
+                          cipher.get(), false /* encrypt */);
+    local_fs->DeleteFile(download_path, io_opts, dbg).PermitUncheckedError();
+    if (s.ok()) {
+      // Decrypted with the IV of the object the metadata came from
+      CloudObjectInformation after;
+      s = GetCloudObjectMetadata(bucket_name, object_path, &after);
+      if (s.ok() && after.content_hash != info.content_hash) {
+        s = IOStatus::IOError("Object changed while downloaded: " +
+                              bucket_name + "/" + object_path);
+      }
+    }
+  }
   if (!s.ok()) {
+    if (cipher) {
+      local_fs->DeleteFile(download_path, io_opts, dbg)
+          .PermitUncheckedError();
+    }
     local_fs->DeleteFile(tmp_destination, io_opts, dbg);
     return s;
   }
+  // Charged once downloaded, the size is only known now
+  CloudTransferExecutor::RequestBytes(
+      cfs_->GetCloudFileSystemOptions().transfer_rate_limiter.get(),
+      remote_size);
 
   // Check if our local file is the same as promised
   uint64_t local_size{0};
@@ -345,9 +1314,202 @@ IOStatus CloudStorageProviderImpl::GetCloudObject(
   return s;
 }
 
+IOStatus CloudStorageProviderImpl::DownloadInParts(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& local_path, uint64_t* remote_size) {
+  CloudObjectInformation info;
+  auto s = GetCloudObjectMetadata(bucket_name, object_path, &info);
+  if (s.IsNotSupported() || (s.ok() && info.size < 2 * kDownloadPartSize)) {
+    return DoGetCloudObject(bucket_name, object_path, local_path,
+                            remote_size);
+  } else if (!s.ok()) {
+    return s;
+  }
+  const auto& cfs_options = cfs_->GetCloudFileSystemOptions();
+  std::unique_ptr<CloudStorageReadableFile> src;
+  s = DoNewCloudReadableFile(bucket_name, object_path, info.size,
+                             info.content_hash, FileOptions(), &src,
+                             nullptr /*dbg*/);
+  std::unique_ptr<FSWritableFile> dst;
+  if (s.ok()) {
+    FileOptions foptions;
+    foptions.use_direct_writes = cfs_options.use_direct_io_for_cloud_download;
+    s = cfs_->GetBaseFileSystem()->NewWritableFile(local_path, foptions, &dst,
+                                                   nullptr /*dbg*/);
+  }
+  uint32_t crc32c = 0;
+  if (s.ok()) {
+    s = DownloadRanges(src.get(), info.size, dst.get(),
+                       download_executor_.get(),
+                       cfs_options.cloud_download_streams, kDownloadPartSize,
+                       &crc32c);
+    auto close_st = dst->Close(IOOptions(), nullptr /*dbg*/);
+    if (s.ok()) {
+      s = close_st;
+    }
+  }
+  if (s.ok() && cfs_options.cloud_object_checksums) {
+    auto it = info.metadata.find(kChecksumMetadataKey());
+    if (it != info.metadata.end()) {
+      s = VerifyChecksum(object_path, it->second, crc32c);
+    }
+  }
+  if (s.IsNotSupported()) {
+    // E.g. a local file system without positioned writes
+    Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+        "[%s] GetCloudObject %s/%s can't be downloaded in parts: %s", Name(),
+        bucket_name.c_str(), object_path.c_str(), s.ToString().c_str());
+    return DoGetCloudObject(bucket_name, object_path, local_path,
+                            remote_size);
+  }
+  if (s.ok()) {
+    // The parts were read by separate requests: they are from the same
+    // version of the object if it is the same after the download
+    CloudObjectInformation after;
+    s = GetCloudObjectMetadata(bucket_name, object_path, &after);
+    if (s.ok() && (after.size != info.size ||
+                   after.content_hash != info.content_hash)) {
+      s = IOStatus::IOError("Object changed while downloaded: " +
+                            bucket_name + "/" + object_path);
+    }
+  }
+  if (!s.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[%s] GetCloudObject %s/%s download in parts failed: %s", Name(),
+        bucket_name.c_str(), object_path.c_str(), s.ToString().c_str());
+    return s;
+  }
+  *remote_size = info.size;
+  return s;
+}
+
+IOStatus CloudStorageProviderImpl::DownloadRanges(
+    FSRandomAccessFile* src, uint64_t size, FSWritableFile* dst,
+    ThreadPool* pool, int streams, size_t part_size, uint32_t* crc32c) {
+  const bool direct = dst->use_direct_io();
+  const size_t alignment = direct ? dst->GetRequiredBufferAlignment() : 1;
+  part_size = Roundup(std::max(part_size, alignment), alignment);
+  const uint64_t num_parts = (size + part_size - 1) / part_size;
+  // Only saves the file system from growing the file part by part
+  dst->Allocate(0, size, IOOptions(), nullptr /*dbg*/).PermitUncheckedError();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint64_t next_part = 0;
+  int running = 0;
+  IOStatus first_error;
+  std::mutex write_mutex;
+  // Of each part, combined in order at the end
+  std::vector<uint32_t> part_crcs(crc32c != nullptr ? num_parts : 0);
+  auto stream = [&]() {
+    AlignedBuffer buf;
+    buf.Alignment(alignment);
+    buf.AllocateNewBuffer(part_size);
+    while (true) {
+      uint64_t part;
+      {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (!first_error.ok() || next_part == num_parts) {
+          break;
+        }
+        part = next_part++;
+      }
+      const uint64_t offset = part * part_size;
+      const auto len = static_cast<size_t>(std::min<uint64_t>(
+          part_size, size - offset));
+      Slice result;
+      auto st = src->Read(offset, len, IOOptions(), &result,
+                          buf.BufferStart(), nullptr /*dbg*/);
+      if (st.ok() && result.size() != len) {
+        st = IOStatus::IOError("Short read of " + std::to_string(len) +
+                               " bytes at " + std::to_string(offset) +
+                               " in download");
+      }
+      if (st.ok()) {
+        if (result.data() != buf.BufferStart()) {
+          memcpy(buf.BufferStart(), result.data(), len);
+        }
+        if (crc32c != nullptr) {
+          part_crcs[part] = crc32c::Value(buf.BufferStart(), len);
+        }
+        // Direct writes are padded, the file is truncated to size at the end
+        auto write_len = direct ? Roundup(len, alignment) : len;
+        memset(buf.BufferStart() + len, 0, write_len - len);
+        // PositionedAppend isn't thread safe: it tracks the file size
+        std::lock_guard<std::mutex> lk(write_mutex);
+        st = dst->PositionedAppend(Slice(buf.BufferStart(), write_len),
+                                   offset, IOOptions(), nullptr /*dbg*/);
+      }
+      if (!st.ok()) {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (first_error.ok()) {
+          first_error = st;
+        }
+      }
+    }
+  };
+  for (int i = 1; pool != nullptr && i < streams &&
+                  static_cast<uint64_t>(i) < num_parts;
+       i++) {
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      running++;
+    }
+    pool->SubmitJob([&]() {
+      stream();
+      std::lock_guard<std::mutex> lk(mutex);
+      running--;
+      cv.notify_all();
+    });
+  }
+  stream();
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    cv.wait(lk, [&] { return running == 0; });
+  }
+  if (!first_error.ok()) {
+    return first_error;
+  }
+  if (crc32c != nullptr) {
+    *crc32c = 0;
+    for (uint64_t part = 0; part < num_parts; part++) {
+      auto len = std::min<uint64_t>(part_size, size - part * part_size);
+      *crc32c = crc32c::Crc32cCombine(*crc32c, part_crcs[part],
+                                      static_cast<size_t>(len));
+    }
+  }
+  // Drops the padding and the preallocated space. dst tracks the end of the
+  // part it wrote last, which may not be the last part.
+  return dst->Truncate(size, IOOptions(), nullptr /*dbg*/);
+}
+
+std::string CloudStorageProviderImpl::ChecksumToString(uint32_t crc32c) {
+  char buf[9];
+  snprintf(buf, sizeof(buf), "%08x", crc32c);
+  return buf;
+}
+
+IOStatus CloudStorageProviderImpl::VerifyChecksum(
+    const std::string& object_path, const std::string& expected,
+    uint32_t actual) {
+  if (expected.empty() || expected == ChecksumToString(actual)) {
+    return IOStatus::OK();
+  }
+  return IOStatus::Corruption("Checksum mismatch in download of " +
+                              object_path + ": expected " + expected +
+                              ", got " + ChecksumToString(actual));
+}
+
 IOStatus CloudStorageProviderImpl::PutCloudObject(
     const std::string& local_file, const std::string& bucket_name,
     const std::string& object_path) {
+  return PutCloudObjectInStorageClass(local_file, bucket_name, object_path,
+                                      "");
+}
+
+IOStatus CloudStorageProviderImpl::PutCloudObjectInStorageClass(
+    const std::string& local_file, const std::string& bucket_name,
+    const std::string& object_path, const std::string& storage_class) {
   uint64_t fsize = 0;
   // debugging paranoia. Files uploaded to Cloud can never be zero size.
   auto st = cfs_->GetBaseFileSystem()->GetFileSize(local_file, IOOptions(),
@@ -365,7 +1527,74 @@ IOStatus CloudStorageProviderImpl::PutCloudObject(
     return IOStatus::IOError(local_file + " Zero size.");
   }
 
-  return DoPutCloudObject(local_file, bucket_name, object_path, fsize);
+  std::unordered_map<std::string, std::string> metadata;
+  const auto& local_fs = cfs_->GetBaseFileSystem();
+  // An encrypted object is uploaded from an encrypted copy of local_file
+  std::string upload_file = local_file;
+  if (cfs_->GetCloudFileSystemOptions().cloud_encryption_cipher) {
+    std::shared_ptr<BlockAccessCipherStream> cipher;
+    st = NewObjectCipher(&metadata[kEncryptionMetadataKey()], &cipher);
+    if (st.ok()) {
+      upload_file = local_file + ".enc-" + std::to_string(rng_->Next());
+      st = CopyThroughCipher(local_fs.get(), local_file, upload_file,
+                             cipher.get(), true /* encrypt */);
+    }
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+          "[%s] PutCloudObject localpath %s error encrypting %s", Name(),
+          local_file.c_str(), st.ToString().c_str());
+    }
+  }
+  if (st.ok() && cfs_->GetCloudFileSystemOptions().cloud_object_checksums) {
+    uint32_t crc32c = 0;
+    st = ComputeFileChecksum(local_fs.get(), upload_file, &crc32c);
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+          "[%s] PutCloudObject localpath %s error computing checksum %s",
+          Name(), local_file.c_str(), st.ToString().c_str());
+    }
+    metadata[kChecksumMetadataKey()] = ChecksumToString(crc32c);
+  }
+
+  if (st.ok()) {
+    CloudTransferExecutor::RequestBytes(
+        cfs_->GetCloudFileSystemOptions().transfer_rate_limiter.get(), fsize);
+    auto start = request_tracer_ ? request_tracer_->NowMicros() : 0;
+    st = DoPutCloudObject(upload_file, bucket_name, object_path, fsize,
+                          metadata, storage_class);
+    if (request_tracer_) {
+      request_tracer_->Record(CloudRequestOpType::kWriteOp, bucket_name,
+                              object_path, 0, fsize, fsize, start, st);
+    }
+  }
+  if (upload_file != local_file) {
+    local_fs->DeleteFile(upload_file, IOOptions(), nullptr /*dbg*/)
+        .PermitUncheckedError();
+  }
+  if (st.ok()) {
+    InvalidateCloudObjectMetadata(cfs_, bucket_name, object_path);
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::UploadPart(const std::string& bucket_name,
+                                              const std::string& object_path,
+                                              const std::string& upload_id,
+                                              int part_number,
+                                              const Slice& data,
+                                              std::string* part_id) {
+  CloudTransferExecutor::RequestBytes(
+      cfs_->GetCloudFileSystemOptions().transfer_rate_limiter.get(),
+      data.size());
+  auto start = request_tracer_ ? request_tracer_->NowMicros() : 0;
+  auto st = DoUploadPart(bucket_name, object_path, upload_id, part_number,
+                         data, part_id);
+  if (request_tracer_) {
+    request_tracer_->Record(CloudRequestOpType::kWriteOp, bucket_name,
+                            object_path, 0, data.size(), data.size(), start,
+                            st);
+  }
+  return st;
 }
 
 #endif  // ROCKSDB_LITE
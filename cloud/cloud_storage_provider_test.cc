@@ -0,0 +1,382 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "cloud/cloud_transfer_executor.h"
+#include "file/file_util.h"
+#include "rocksdb/cloud/cloud_file_cache.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "rocksdb/env.h"
+#include "rocksdb/file_checksum.h"
+#include "rocksdb/iostats_context.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/threadpool.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Readable file serving its contents from memory, counting the cloud reads
+class MemoryReadableFile : public CloudStorageReadableFileImpl {
+ public:
+  explicit MemoryReadableFile(const std::string& data)
+      : CloudStorageReadableFileImpl(nullptr, "bucket", "path/000010.sst",
+                                     data.size()),
+        data_(data) {}
+
+  int cloud_reads() const { return cloud_reads_.load(); }
+
+ protected:
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& /*options*/,
+                       char* scratch, uint64_t* bytes_read,
+                       IODebugContext* /*dbg*/) const override {
+    cloud_reads_++;
+    *bytes_read = std::min<uint64_t>(n, data_.size() - offset);
+    memcpy(scratch, data_.data() + offset, *bytes_read);
+    return IOStatus::OK();
+  }
+
+ private:
+  std::string data_;
+  mutable std::atomic<int> cloud_reads_{0};
+};
+}  // namespace
+
+class CloudStorageReadableFileTest : public testing::Test {
+ public:
+  CloudStorageReadableFileTest() {
+    Random rnd(301);
+    data_ = rnd.RandomString(1 << 20);
+    file_.reset(new MemoryReadableFile(data_));
+  }
+
+  std::string data_;
+  std::unique_ptr<MemoryReadableFile> file_;
+};
+
+TEST_F(CloudStorageReadableFileTest, MultiReadCoalescesRanges) {
+  char scratch[3][100];
+  FSReadRequest reqs[3];
+  // The first two requests are close enough to share a cloud read
+  reqs[0].offset = 500000;
+  reqs[1].offset = 0;
+  reqs[2].offset = 200;
+  for (int i = 0; i < 3; i++) {
+    reqs[i].len = 100;
+    reqs[i].scratch = scratch[i];
+  }
+  ASSERT_OK(file_->MultiRead(reqs, 3, IOOptions(), nullptr));
+  ASSERT_EQ(file_->cloud_reads(), 2);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(reqs[i].status);
+    ASSERT_EQ(reqs[i].result.ToString(), data_.substr(reqs[i].offset, 100));
+  }
+}
+
+TEST_F(CloudStorageReadableFileTest, MultiReadPastEndOfFile) {
+  char scratch[2][100];
+  FSReadRequest reqs[2];
+  reqs[0].offset = data_.size() - 50;
+  reqs[1].offset = data_.size() + 10;
+  for (int i = 0; i < 2; i++) {
+    reqs[i].len = 100;
+    reqs[i].scratch = scratch[i];
+  }
+  ASSERT_OK(file_->MultiRead(reqs, 2, IOOptions(), nullptr));
+  ASSERT_OK(reqs[0].status);
+  ASSERT_EQ(reqs[0].result.ToString(), data_.substr(data_.size() - 50));
+  ASSERT_OK(reqs[1].status);
+  ASSERT_TRUE(reqs[1].result.empty());
+}
+
+TEST_F(CloudStorageReadableFileTest, MultiReadAsync) {
+  std::shared_ptr<ThreadPool> executor(NewThreadPool(2), [](ThreadPool* p) {
+    p->WaitForJobsAndJoinAllThreads();
+    delete p;
+  });
+  file_->SetAsyncReadExecutor(executor);
+
+  char scratch[2][100];
+  FSReadRequest reqs[2];
+  for (int i = 0; i < 2; i++) {
+    reqs[i].offset = i * 300000;
+    reqs[i].len = 100;
+    reqs[i].scratch = scratch[i];
+  }
+  int callbacks = 0;
+  void* io_handles[2] = {nullptr, nullptr};
+  IOHandleDeleter del_fns[2];
+  size_t num_io_handles = 2;
+  ASSERT_OK(file_->MultiReadAsync(
+      reqs, 2, IOOptions(),
+      [](const FSReadRequest*, size_t n, void* arg) {
+        ASSERT_EQ(n, 2);
+        (*static_cast<int*>(arg))++;
+      },
+      &callbacks, io_handles, &num_io_handles, del_fns, nullptr));
+  ASSERT_EQ(num_io_handles, 1);
+
+  std::vector<void*> handles{io_handles[0], &callbacks};
+  std::vector<void*> other_handles;
+  ASSERT_OK(CloudStorageReadableFileImpl::PollAsyncReads(handles,
+                                                         &other_handles));
+  // Handles that don't belong to cloud reads are handed back
+  ASSERT_EQ(other_handles.size(), 1);
+  ASSERT_EQ(other_handles[0], &callbacks);
+  ASSERT_EQ(callbacks, 1);
+  for (int i = 0; i < 2; i++) {
+    ASSERT_OK(reqs[i].status);
+    ASSERT_EQ(reqs[i].result.ToString(), data_.substr(reqs[i].offset, 100));
+  }
+
+  // Polling again doesn't run the callback twice
+  other_handles.clear();
+  ASSERT_OK(CloudStorageReadableFileImpl::PollAsyncReads({io_handles[0]},
+                                                         &other_handles));
+  ASSERT_EQ(callbacks, 1);
+  del_fns[0](io_handles[0]);
+}
+
+TEST_F(CloudStorageReadableFileTest, ReadThroughFileCache) {
+  CloudFileCacheOptions cache_options;
+  cache_options.cache_dir = test::PerThreadDBPath("cloud_readable_file_cache");
+  cache_options.extent_size = 4096;
+  DestroyDir(Env::Default(), cache_options.cache_dir).PermitUncheckedError();
+  std::shared_ptr<CloudFileCache> cache;
+  ASSERT_OK(NewCloudFileCache(cache_options, &cache));
+  file_->SetFileCache(cache);
+  get_iostats_context()->Reset();
+
+  char scratch[100];
+  Slice result;
+  ASSERT_OK(file_->Read(4000, 100, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(4000, 100));
+  // The read spans two extents
+  ASSERT_EQ(file_->cloud_reads(), 2);
+  ASSERT_EQ(get_iostats_context()->cloud_file_cache_hit_bytes, 0u);
+
+  ASSERT_OK(file_->Read(4010, 50, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(4010, 50));
+  ASSERT_EQ(file_->cloud_reads(), 2);
+  ASSERT_EQ(get_iostats_context()->cloud_file_cache_hit_bytes, 50u);
+
+  file_.reset();
+  cache.reset();
+  DestroyDir(Env::Default(), cache_options.cache_dir).PermitUncheckedError();
+}
+
+TEST_F(CloudStorageReadableFileTest, Prefetch) {
+  // Disabled by default
+  ASSERT_TRUE(file_->Prefetch(0, 100, IOOptions(), nullptr).IsNotSupported());
+
+  Random rnd(302);
+  auto data = rnd.RandomString(8 << 20);
+  MemoryReadableFile file(data);
+  file.SetReadahead(
+      std::make_shared<CloudTransferExecutor>(4, std::vector<int>()), 4 << 20,
+      4);
+  ASSERT_OK(file.Prefetch(0, 1 << 20, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 1);
+  ASSERT_OK(file.Prefetch(1000, 1000, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 1);
+  // Reads of prefetched ranges are served locally
+  get_iostats_context()->Reset();
+  std::string scratch(1 << 20, '\0');
+  Slice result;
+  ASSERT_OK(file.Read(1000, 5000, IOOptions(), &result, &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data.substr(1000, 5000));
+  ASSERT_EQ(file.cloud_reads(), 1);
+  ASSERT_EQ(get_iostats_context()->cloud_readahead_hit_bytes, 5000u);
+
+  // A sequential prefetch fetches twice as much, with a read per 1MB
+  ASSERT_OK(file.Prefetch((1 << 20) - 100, 200, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 3);
+  ASSERT_OK(file.Read((1 << 20) - 100, 1000, IOOptions(), &result,
+                      &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data.substr((1 << 20) - 100, 1000));
+  ASSERT_EQ(file.cloud_reads(), 3);
+  // Up to the readahead size, in as many reads as streams
+  ASSERT_OK(file.Prefetch(3 << 20, 100, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 7);
+  ASSERT_OK(file.Read((7 << 20) - 500, 500, IOOptions(), &result, &scratch[0],
+                      nullptr));
+  ASSERT_EQ(result.ToString(), data.substr((7 << 20) - 500, 500));
+  ASSERT_EQ(file.cloud_reads(), 7);
+
+  // A random prefetch isn't extended
+  ASSERT_OK(file.Prefetch((7 << 20) + 1000, 100, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 8);
+  ASSERT_OK(file.Read((7 << 20) + 1000, 200, IOOptions(), &result,
+                      &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data.substr((7 << 20) + 1000, 200));
+  ASSERT_EQ(file.cloud_reads(), 9);
+
+  // Nothing to prefetch past the end of the file
+  ASSERT_OK(file.Prefetch(data.size(), 100, IOOptions(), nullptr));
+  ASSERT_EQ(file.cloud_reads(), 9);
+}
+
+TEST_F(CloudStorageReadableFileTest, Tail) {
+  const size_t kTailSize = 64 << 10;
+  file_->SetTail(data_.substr(data_.size() - kTailSize));
+  std::string scratch(1 << 20, '\0');
+  Slice result;
+  // Reads and prefetches within the tail make no cloud read
+  ASSERT_OK(file_->Read(data_.size() - 1000, 1000, IOOptions(), &result,
+                        &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(data_.size() - 1000));
+  ASSERT_OK(file_->Read(data_.size() - kTailSize, 100, IOOptions(), &result,
+                        &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(data_.size() - kTailSize, 100));
+  ASSERT_OK(file_->Prefetch(data_.size() - 5000, 5000, IOOptions(), nullptr));
+  ASSERT_EQ(file_->cloud_reads(), 0);
+
+  // A read overlapping the tail reads the rest from the cloud
+  const uint64_t offset = data_.size() - kTailSize - 100;
+  ASSERT_OK(file_->Read(offset, 300, IOOptions(), &result, &scratch[0],
+                        nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(offset, 300));
+  ASSERT_EQ(file_->cloud_reads(), 1);
+  ASSERT_OK(file_->Read(0, 100, IOOptions(), &result, &scratch[0], nullptr));
+  ASSERT_EQ(result.ToString(), data_.substr(0, 100));
+  ASSERT_EQ(file_->cloud_reads(), 2);
+}
+
+TEST_F(CloudStorageReadableFileTest, DownloadRanges) {
+  auto fs = FileSystem::Default();
+  auto dir = test::PerThreadDBPath("download_ranges");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto path = dir + "/000010.sst";
+  std::unique_ptr<ThreadPool> pool(NewThreadPool(3));
+
+  for (bool direct : {false, true}) {
+    FileOptions foptions;
+    foptions.use_direct_writes = direct;
+    std::unique_ptr<FSWritableFile> dst;
+    auto st = fs->NewWritableFile(path, foptions, &dst, nullptr);
+    if (direct && !st.ok()) {
+      // Direct IO isn't supported by the file system of the test directory
+      continue;
+    }
+    ASSERT_OK(st);
+    // Parts not aligned to the block size, the last one partial
+    uint32_t crc32c = 0;
+    ASSERT_OK(CloudStorageProviderImpl::DownloadRanges(
+        file_.get(), data_.size(), dst.get(), pool.get(), 4, 100000,
+        &crc32c));
+    ASSERT_OK(dst->Close(IOOptions(), nullptr));
+    ASSERT_EQ(file_->cloud_reads(), 11);
+    ASSERT_EQ(crc32c, crc32c::Value(data_.data(), data_.size()));
+    std::string contents;
+    ASSERT_OK(ReadFileToString(fs.get(), path, &contents));
+    ASSERT_EQ(contents, data_);
+    file_.reset(new MemoryReadableFile(data_));
+  }
+
+  // A truncated object fails the download
+  std::unique_ptr<FSWritableFile> dst;
+  ASSERT_OK(fs->NewWritableFile(path, FileOptions(), &dst, nullptr));
+  ASSERT_TRUE(CloudStorageProviderImpl::DownloadRanges(
+                  file_.get(), data_.size() + 1000, dst.get(), pool.get(), 4,
+                  100000)
+                  .IsIOError());
+  ASSERT_OK(dst->Close(IOOptions(), nullptr));
+  pool->WaitForJobsAndJoinAllThreads();
+  ASSERT_OK(DestroyDir(Env::Default(), dir));
+}
+
+TEST(CloudStorageProviderTest, VerifyChecksum) {
+  auto crc = crc32c::Value("abc", 3);
+  auto str = CloudStorageProviderImpl::ChecksumToString(crc);
+  ASSERT_EQ(str.size(), 8u);
+  // The hex of the file_checksum of FileChecksumGenCrc32cFactory
+  FileChecksumGenContext context;
+  auto gen =
+      GetFileChecksumGenCrc32cFactory()->CreateFileChecksumGenerator(context);
+  gen->Update("abc", 3);
+  gen->Finalize();
+  auto file_checksum = Slice(gen->GetChecksum()).ToString(true /* hex */);
+  std::transform(file_checksum.begin(), file_checksum.end(),
+                 file_checksum.begin(), ::tolower);
+  ASSERT_EQ(str, file_checksum);
+
+  ASSERT_OK(CloudStorageProviderImpl::VerifyChecksum("db/000010.sst", str,
+                                                     crc));
+  // Objects uploaded without checksums aren't verified
+  ASSERT_OK(CloudStorageProviderImpl::VerifyChecksum("db/000010.sst", "",
+                                                     crc));
+  ASSERT_TRUE(CloudStorageProviderImpl::VerifyChecksum("db/000010.sst", str,
+                                                       crc + 1)
+                  .IsCorruption());
+}
+
+TEST(CloudStorageProviderTest, RecordRequest) {
+  auto stats = CreateDBStatistics();
+  SetPerfLevel(PerfLevel::kEnableTimeExceptForMutex);
+  get_iostats_context()->Reset();
+
+  CloudStorageProviderImpl::RecordRequest(
+      stats.get(), CloudRequestOpType::kReadOp, 100, 20, true);
+  CloudStorageProviderImpl::RecordRequest(
+      stats.get(), CloudRequestOpType::kReadOp, 50, 10, false);
+  CloudStorageProviderImpl::RecordRequest(
+      stats.get(), CloudRequestOpType::kWriteOp, 200, 30, true);
+  CloudStorageProviderImpl::RecordRequest(
+      stats.get(), CloudRequestOpType::kInfoOp, 0, 5, true);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_READ_REQUESTS), 2u);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_WRITE_REQUESTS), 1u);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_INFO_REQUESTS), 1u);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_LIST_REQUESTS), 0u);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_REQUEST_FAILURES), 1u);
+  // Failed requests transfer nothing
+  ASSERT_EQ(stats->getTickerCount(CLOUD_READ_BYTES), 100u);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_WRITE_BYTES), 200u);
+  HistogramData data;
+  stats->histogramData(CLOUD_READ_MICROS, &data);
+  ASSERT_EQ(data.count, 2u);
+  ASSERT_EQ(data.sum, 30u);
+  stats->histogramData(CLOUD_INFO_MICROS, &data);
+  ASSERT_EQ(data.count, 1u);
+
+  // The reads of the calling thread
+  ASSERT_EQ(get_iostats_context()->cloud_read_count, 2u);
+  ASSERT_EQ(get_iostats_context()->cloud_read_bytes, 100u);
+  ASSERT_EQ(get_iostats_context()->cloud_read_nanos, 30000u);
+
+  // Timers follow the stats and perf levels
+  stats->set_stats_level(StatsLevel::kExceptTimers);
+  SetPerfLevel(PerfLevel::kEnableCount);
+  CloudStorageProviderImpl::RecordRequest(
+      stats.get(), CloudRequestOpType::kReadOp, 100, 20, true);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_READ_REQUESTS), 3u);
+  stats->histogramData(CLOUD_READ_MICROS, &data);
+  ASSERT_EQ(data.count, 2u);
+  ASSERT_EQ(get_iostats_context()->cloud_read_count, 3u);
+  ASSERT_EQ(get_iostats_context()->cloud_read_nanos, 30000u);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudStorageReadableFileTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,157 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_table_prefetcher.h"
+
+#include <cinttypes>
+
+#include "cloud/cloud_transfer_executor.h"
+#include "db/column_family.h"
+#include "db/db_impl/db_impl.h"
+#include "db/table_cache.h"
+#include "db/version_set.h"
+#include "util/cast_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudTablePrefetcher::CloudTablePrefetcher(
+    std::shared_ptr<CloudTransferExecutor> executor, uint64_t max_bytes,
+    std::shared_ptr<Logger> info_log)
+    : executor_(std::move(executor)),
+      max_bytes_(max_bytes),
+      info_log_(std::move(info_log)) {}
+
+CloudTablePrefetcher::~CloudTablePrefetcher() { Stop(); }
+
+void CloudTablePrefetcher::Start(DB* db, const std::vector<uint32_t>& cf_ids) {
+  for (auto cf_id : cf_ids) {
+    Prefetch(db, cf_id, nullptr /* file_numbers */);
+  }
+}
+
+void CloudTablePrefetcher::OnFlushCompleted(DB* db, const FlushJobInfo& info) {
+  std::unordered_set<uint64_t> file_numbers{info.file_number};
+  Prefetch(db, info.cf_id, &file_numbers);
+}
+
+void CloudTablePrefetcher::OnCompactionCompleted(
+    DB* db, const CompactionJobInfo& info) {
+  if (!info.status.ok()) {
+    return;
+  }
+  std::unordered_set<uint64_t> file_numbers;
+  for (const auto& output : info.output_file_infos) {
+    file_numbers.insert(output.file_number);
+  }
+  Prefetch(db, info.cf_id, &file_numbers);
+}
+
+void CloudTablePrefetcher::Stop() {
+  stopped_ = true;
+  WaitForPrefetches();
+}
+
+void CloudTablePrefetcher::WaitForPrefetches() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void CloudTablePrefetcher::Prefetch(
+    DB* db, uint32_t cf_id, const std::unordered_set<uint64_t>* file_numbers) {
+  if (stopped_) {
+    return;
+  }
+  auto* db_impl = static_cast_with_check<DBImpl>(db->GetRootDB());
+  auto handle = db_impl->GetColumnFamilyHandleUnlocked(cf_id);
+  if (!handle) {
+    // Dropped column family
+    return;
+  }
+  auto* cfd =
+      static_cast_with_check<ColumnFamilyHandleImpl>(handle.get())->cfd();
+  std::vector<uint64_t> selected;
+  uint64_t bytes = 0;
+  SuperVersion* sv = db_impl->GetAndRefSuperVersion(cfd);
+  const auto* vstorage = sv->current->storage_info();
+  bool full = false;
+  for (int level = 0; level < vstorage->num_non_empty_levels() && !full;
+       level++) {
+    for (const auto* meta : vstorage->LevelFiles(level)) {
+      const uint64_t number = meta->fd.GetNumber();
+      if (file_numbers != nullptr && file_numbers->count(number) == 0) {
+        continue;
+      }
+      // The tail holds the index and filter blocks
+      const uint64_t charge =
+          meta->tail_size > 0 ? meta->tail_size : meta->fd.GetFileSize();
+      if (max_bytes_ > 0 && bytes + charge > max_bytes_) {
+        full = true;
+        break;
+      }
+      bytes += charge;
+      selected.push_back(number);
+    }
+  }
+  db_impl->ReturnAndCleanupSuperVersion(cfd, sv);
+  if (selected.empty()) {
+    return;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[table_prefetcher] Prefetching %" ROCKSDB_PRIszt
+      " files of column family %" PRIu32 ", %" PRIu64 " bytes%s",
+      selected.size(), cf_id, bytes, full ? ", budget reached" : "");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Stop() may be waiting already
+  if (stopped_) {
+    return;
+  }
+  pending_ += selected.size();
+  for (auto number : selected) {
+    executor_->Submit(CloudTransferExecutor::kPrefetch,
+                      [this, db, cf_id, number]() {
+                        PrefetchFile(db, cf_id, number);
+                        std::lock_guard<std::mutex> job_lock(mutex_);
+                        if (--pending_ == 0) {
+                          cv_.notify_all();
+                        }
+                      });
+  }
+}
+
+void CloudTablePrefetcher::PrefetchFile(DB* db, uint32_t cf_id,
+                                        uint64_t file_number) {
+  if (stopped_) {
+    return;
+  }
+  auto* db_impl = static_cast_with_check<DBImpl>(db->GetRootDB());
+  auto handle = db_impl->GetColumnFamilyHandleUnlocked(cf_id);
+  if (!handle) {
+    return;
+  }
+  auto* cfd =
+      static_cast_with_check<ColumnFamilyHandleImpl>(handle.get())->cfd();
+  SuperVersion* sv = db_impl->GetAndRefSuperVersion(cfd);
+  const auto* vstorage = sv->current->storage_info();
+  const auto location = vstorage->GetFileLocation(file_number);
+  // Skips the files compacted away in the meantime
+  if (location.IsValid()) {
+    const int level = location.GetLevel();
+    const auto* meta = vstorage->LevelFiles(level)[location.GetPosition()];
+    Status s = cfd->table_cache()->CacheDependencies(
+        ReadOptions(), *cfd->soptions(), cfd->internal_comparator(), *meta,
+        sv->mutable_cf_options.block_protection_bytes_per_key,
+        sv->mutable_cf_options.prefix_extractor, level);
+    if (s.ok()) {
+      num_prefetched_++;
+    } else {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[table_prefetcher] Unable to prefetch file %" PRIu64 ": %s",
+          file_number, s.ToString().c_str());
+    }
+  }
+  db_impl->ReturnAndCleanupSuperVersion(cfd, sv);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
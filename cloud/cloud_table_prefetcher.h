@@ -0,0 +1,72 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/listener.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class CloudTransferExecutor;
+class Logger;
+
+// Opens the tables of the SST files of a DBCloud ahead of their first reads,
+// which loads the partitions of their indexes and filters into the block
+// cache: the live files once the DB is open, then the outputs of its
+// flushes and compactions. Each file is a job of the transfer executor. See
+// CloudFileSystemOptions::table_prefetch_threads.
+//
+// Thread safe.
+class CloudTablePrefetcher : public EventListener {
+ public:
+  // Each call to Start, and each flush or compaction, prefetches at most
+  // max_bytes of metadata, unlimited if 0
+  CloudTablePrefetcher(std::shared_ptr<CloudTransferExecutor> executor,
+                       uint64_t max_bytes, std::shared_ptr<Logger> info_log);
+  ~CloudTablePrefetcher() override;
+
+  const char* Name() const override { return "CloudTablePrefetcher"; }
+
+  // Prefetches the live files of the column families of db with ids cf_ids
+  void Start(DB* db, const std::vector<uint32_t>& cf_ids);
+
+  void OnFlushCompleted(DB* db, const FlushJobInfo& info) override;
+  void OnCompactionCompleted(DB* db, const CompactionJobInfo& info) override;
+
+  // Drops the files not started yet and waits for the others. Nothing is
+  // prefetched afterwards.
+  void Stop();
+
+  // Waits for the files queued so far
+  void WaitForPrefetches();
+
+  // Number of files prefetched successfully
+  uint64_t GetNumPrefetched() const { return num_prefetched_.load(); }
+
+ private:
+  // Queues the files of the column family cf_id with numbers in
+  // file_numbers, all of them if null, lower levels first, until max_bytes_
+  // is reached
+  void Prefetch(DB* db, uint32_t cf_id,
+                const std::unordered_set<uint64_t>* file_numbers);
+  void PrefetchFile(DB* db, uint32_t cf_id, uint64_t file_number);
+
+  const std::shared_ptr<CloudTransferExecutor> executor_;
+  const uint64_t max_bytes_;
+  const std::shared_ptr<Logger> info_log_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // Jobs submitted and not done yet
+  size_t pending_ = 0;
+  std::atomic<bool> stopped_{false};
+  std::atomic<uint64_t> num_prefetched_{0};
+};
+
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,239 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_transfer_executor.h"
+
+#include <algorithm>
+
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Priority the transfers of the calling thread are charged at
+thread_local Env::IOPriority current_io_priority = Env::IO_USER;
+
+// ThreadPool facade of one transfer class of a CloudTransferExecutor
+class TransferClassThreadPool : public ThreadPool {
+ public:
+  TransferClassThreadPool(std::shared_ptr<CloudTransferExecutor> executor,
+                          CloudTransferExecutor::TransferClass cls)
+      : executor_(std::move(executor)), cls_(cls) {}
+
+  ~TransferClassThreadPool() override { WaitForJobsAndJoinAllThreads(); }
+
+  // The jobs can't be taken back from the executor, wait for them instead
+  void JoinAllThreads() override { WaitForJobsAndJoinAllThreads(); }
+
+  // The concurrency is set by the executor
+  void SetBackgroundThreads(int /*num*/) override {}
+  int GetBackgroundThreads() override {
+    return executor_->GetMaxRunning(cls_);
+  }
+
+  unsigned int GetQueueLen() const override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return static_cast<unsigned int>(pending_);
+  }
+
+  void WaitForJobsAndJoinAllThreads() override {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return pending_ == 0; });
+  }
+
+  void SubmitJob(const std::function<void()>& job) override {
+    SubmitJob(std::function<void()>(job));
+  }
+
+  void SubmitJob(std::function<void()>&& job) override {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      pending_++;
+    }
+    executor_->Submit(cls_, [this, job = std::move(job)]() mutable {
+      job();
+      // Release what the job holds before the pool may go away
+      job = nullptr;
+      std::lock_guard<std::mutex> lk(mutex_);
+      pending_--;
+      cv_.notify_all();
+    });
+  }
+
+ private:
+  std::shared_ptr<CloudTransferExecutor> executor_;
+  const CloudTransferExecutor::TransferClass cls_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t pending_ = 0;
+};
+}  // namespace
+
+CloudTransferExecutor::CloudTransferExecutor(
+    int num_threads, const std::vector<int>& max_running)
+    : num_threads_(std::max(num_threads, 1)),
+      max_running_(kNumTransferClasses, num_threads_),
+      threads_(ROCKSDB_NAMESPACE::NewThreadPool(num_threads_)) {
+  for (size_t i = 0; i < max_running.size() && i < max_running_.size(); i++) {
+    if (max_running[i] > 0) {
+      max_running_[i] = std::min(max_running[i], num_threads_);
+    }
+  }
+}
+
+CloudTransferExecutor::~CloudTransferExecutor() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    shutdown_ = true;
+    cv_.notify_all();
+  }
+  threads_->WaitForJobsAndJoinAllThreads();
+}
+
+void CloudTransferExecutor::Submit(TransferClass cls,
+                                   std::function<void()> job) {
+  assert(cls >= 0 && cls < kNumTransferClasses);
+  bool new_worker = false;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    assert(!shutdown_);
+    queues_[cls].push_back(std::move(job));
+    if (idle_workers_ == 0 && num_workers_ < num_threads_) {
+      num_workers_++;
+      new_worker = true;
+    }
+    cv_.notify_one();
+  }
+  if (new_worker) {
+    threads_->SubmitJob([this]() { RunWorker(); });
+  }
+}
+
+int CloudTransferExecutor::NextClass() const {
+  for (int cls = 0; cls < kNumTransferClasses; cls++) {
+    if (!queues_[cls].empty() && running_[cls] < max_running_[cls]) {
+      return cls;
+    }
+  }
+  return kNumTransferClasses;
+}
+
+void CloudTransferExecutor::RunWorker() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    int cls = NextClass();
+    if (cls == kNumTransferClasses) {
+      bool drained = std::all_of(std::begin(queues_), std::end(queues_),
+                                 [](const std::deque<std::function<void()>>&
+                                        queue) { return queue.empty(); });
+      if (shutdown_ && drained) {
+        break;
+      }
+      idle_workers_++;
+      cv_.wait(lk);
+      idle_workers_--;
+      continue;
+    }
+    auto job = std::move(queues_[cls].front());
+    queues_[cls].pop_front();
+    running_[cls]++;
+    lk.unlock();
+    current_io_priority = GetIOPriority(static_cast<TransferClass>(cls));
+    job();
+    job = nullptr;
+    current_io_priority = Env::IO_USER;
+    lk.lock();
+    running_[cls]--;
+    // A job of a class that was at its limit may be able to start
+    cv_.notify_all();
+  }
+  num_workers_--;
+  // Let the other workers see that the queues are drained
+  cv_.notify_all();
+}
+
+IOStatus CloudTransferExecutor::RunAll(
+    TransferClass cls, size_t n, const std::function<IOStatus(size_t)>& job,
+    size_t max_in_flight) {
+  max_in_flight = std::max<size_t>(max_in_flight, 1);
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t in_flight = 0;
+  IOStatus first_error;
+  std::unique_lock<std::mutex> lk(mutex);
+  for (size_t i = 0; i < n; i++) {
+    cv.wait(lk, [&] { return in_flight < max_in_flight; });
+    if (!first_error.ok()) {
+      break;
+    }
+    in_flight++;
+    lk.unlock();
+    Submit(cls, [&, i]() {
+      auto st = job(i);
+      std::lock_guard<std::mutex> job_lk(mutex);
+      if (!st.ok() && first_error.ok()) {
+        first_error = st;
+      }
+      in_flight--;
+      cv.notify_all();
+    });
+    lk.lock();
+  }
+  cv.wait(lk, [&] { return in_flight == 0; });
+  return first_error;
+}
+
+std::shared_ptr<ThreadPool> CloudTransferExecutor::NewThreadPool(
+    TransferClass cls) {
+  return std::make_shared<TransferClassThreadPool>(shared_from_this(), cls);
+}
+
+size_t CloudTransferExecutor::NumQueued(TransferClass cls) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return queues_[cls].size();
+}
+
+Env::IOPriority CloudTransferExecutor::GetIOPriority(TransferClass cls) {
+  switch (cls) {
+    case kUpload:
+      return Env::IO_HIGH;
+    case kHydrate:
+      return Env::IO_MID;
+    default:
+      return Env::IO_LOW;
+  }
+}
+
+void CloudTransferExecutor::RequestBytes(RateLimiter* rate_limiter,
+                                         uint64_t bytes) {
+  if (rate_limiter == nullptr) {
+    return;
+  }
+  // Charged whatever the mode of the rate limiter, which is meant for local
+  // reads and writes
+  const auto burst = static_cast<uint64_t>(
+      std::max<int64_t>(rate_limiter->GetSingleBurstBytes(), 1));
+  while (bytes > 0) {
+    auto chunk = std::min(bytes, burst);
+    rate_limiter->Request(static_cast<int64_t>(chunk), current_io_priority,
+                          nullptr /*stats*/);
+    bytes -= chunk;
+  }
+}
+
+CloudTransferExecutor::ScopedIOPriority::ScopedIOPriority(
+    Env::IOPriority priority)
+    : saved_(current_io_priority) {
+  if (priority != Env::IO_TOTAL) {
+    current_io_priority = priority;
+  }
+}
+
+CloudTransferExecutor::ScopedIOPriority::~ScopedIOPriority() {
+  current_io_priority = saved_;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,120 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class RateLimiter;
+class ThreadPool;
+
+// Runs the background transfers of a CloudFileSystem on one set of threads.
+// Every job belongs to a transfer class. When a thread frees up, it runs the
+// oldest queued job of the highest priority class that is below its
+// concurrency limit, so a burst of low priority transfers (a checkpoint)
+// can neither delay the uploads of flushed files nor take more than its
+// share of the threads.
+//
+// Jobs must not wait for other jobs of the executor.
+//
+// Thread safe.
+class CloudTransferExecutor
+    : public std::enable_shared_from_this<CloudTransferExecutor> {
+ public:
+  // From the highest to the lowest priority
+  enum TransferClass : int {
+    // Uploads of SST files: async_sst_upload and multipart upload parts
+    kUpload = 0,
+    // Downloads of SST files into the local directory
+    kHydrate,
+    // Opens of the tables of SST files ahead of their first reads
+    kPrefetch,
+    // CheckpointToCloud
+    kCheckpoint,
+    // Delayed deletions of cloud files
+    kDelete,
+    // The purger's reads of MANIFESTs, of the dbid registry and listings of
+    // DB paths
+    kPurge,
+    kNumTransferClasses,
+  };
+
+  // max_running[c] is the maximum number of jobs of class c running at once,
+  // num_threads if it is missing or not positive.
+  CloudTransferExecutor(int num_threads, const std::vector<int>& max_running);
+  // Runs the queued jobs and joins the threads
+  ~CloudTransferExecutor();
+
+  void Submit(TransferClass cls, std::function<void()> job);
+
+  // Runs job(0) ... job(n - 1) as jobs of class cls, in order, with at most
+  // max_in_flight of them running at once, and waits for them. Stops
+  // submitting jobs after the first error, which is returned.
+  IOStatus RunAll(TransferClass cls, size_t n,
+                  const std::function<IOStatus(size_t)>& job,
+                  size_t max_in_flight);
+
+  // Returns a ThreadPool that submits its jobs to this executor as jobs of
+  // class cls. Its WaitForJobsAndJoinAllThreads waits for the jobs submitted
+  // through it, and it keeps the executor alive.
+  std::shared_ptr<ThreadPool> NewThreadPool(TransferClass cls);
+
+  int GetMaxRunning(TransferClass cls) const { return max_running_[cls]; }
+  size_t NumQueued(TransferClass cls) const;
+
+  // The priority transfers of class cls are charged at to a rate limiter
+  static Env::IOPriority GetIOPriority(TransferClass cls);
+
+  // Charges a transfer of `bytes` bytes to rate_limiter, if not null, and
+  // waits until it is allowed. The transfer is charged at the priority of
+  // the class of the calling job, or at Env::IO_USER outside of the
+  // executor: transfers done on behalf of the DB's own reads and writes are
+  // then never held back by background ones.
+  static void RequestBytes(RateLimiter* rate_limiter, uint64_t bytes);
+
+  // Charges the transfers of the calling thread at `priority` instead, until
+  // destroyed, unless priority is Env::IO_TOTAL. Used for the uploads of the
+  // files the DB writes, so that they are charged at the priority the DB
+  // writes them at, e.g. Env::IO_LOW for compaction outputs.
+  class ScopedIOPriority {
+   public:
+    explicit ScopedIOPriority(Env::IOPriority priority);
+    ~ScopedIOPriority();
+
+    ScopedIOPriority(const ScopedIOPriority&) = delete;
+    ScopedIOPriority& operator=(const ScopedIOPriority&) = delete;
+
+   private:
+    const Env::IOPriority saved_;
+  };
+
+ private:
+  void RunWorker();
+  // Returns the class of the next job to run, kNumTransferClasses if no
+  // queued job can run. REQUIRES: mutex_ is held
+  int NextClass() const;
+
+  const int num_threads_;
+  std::vector<int> max_running_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queues_[kNumTransferClasses];
+  int running_[kNumTransferClasses] = {};
+  int num_workers_ = 0;
+  int idle_workers_ = 0;
+  bool shutdown_ = false;
+  // Started on demand, up to num_threads_. Declared last so that its
+  // threads are joined before the members above go away.
+  std::unique_ptr<ThreadPool> threads_;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
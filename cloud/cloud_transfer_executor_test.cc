@@ -0,0 +1,182 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_transfer_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/threadpool.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudTransferExecutorTest : public testing::Test {
+ public:
+  // Blocks the calling job until Release()
+  void Blocked() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    blocked_++;
+    cv_.notify_all();
+    cv_.wait(lk, [this] { return released_; });
+  }
+  void WaitBlocked(int n) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this, n] { return blocked_ >= n; });
+  }
+  void Release() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+  void Record(int id) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    order_.push_back(id);
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int blocked_ = 0;
+  bool released_ = false;
+  std::vector<int> order_;
+};
+
+TEST_F(CloudTransferExecutorTest, HigherClassesFirst) {
+  auto executor =
+      std::make_shared<CloudTransferExecutor>(1, std::vector<int>());
+  executor->Submit(CloudTransferExecutor::kUpload, [this]() { Blocked(); });
+  WaitBlocked(1);
+  executor->Submit(CloudTransferExecutor::kCheckpoint,
+                   [this]() { Record(1); });
+  executor->Submit(CloudTransferExecutor::kHydrate, [this]() { Record(2); });
+  executor->Submit(CloudTransferExecutor::kUpload, [this]() { Record(3); });
+  executor->Submit(CloudTransferExecutor::kUpload, [this]() { Record(4); });
+  Release();
+  executor.reset();
+  ASSERT_EQ(order_, std::vector<int>({3, 4, 2, 1}));
+}
+
+TEST_F(CloudTransferExecutorTest, ClassLimit) {
+  std::vector<int> max_running(CloudTransferExecutor::kNumTransferClasses);
+  max_running[CloudTransferExecutor::kCheckpoint] = 2;
+  CloudTransferExecutor executor(8, max_running);
+  ASSERT_EQ(executor.GetMaxRunning(CloudTransferExecutor::kCheckpoint), 2);
+  ASSERT_EQ(executor.GetMaxRunning(CloudTransferExecutor::kUpload), 8);
+
+  std::atomic<int> running{0};
+  std::atomic<int> max_seen{0};
+  auto checkpoint_job = [&](size_t /*idx*/) {
+    int now = ++running;
+    int seen = max_seen.load();
+    while (now > seen && !max_seen.compare_exchange_weak(seen, now)) {
+    }
+    Env::Default()->SleepForMicroseconds(1000);
+    running--;
+    return IOStatus::OK();
+  };
+  ASSERT_OK(executor.RunAll(CloudTransferExecutor::kCheckpoint, 20,
+                            checkpoint_job, 8));
+  ASSERT_LE(max_seen.load(), 2);
+
+  // The limited class leaves threads to the others
+  for (int i = 0; i < 2; i++) {
+    executor.Submit(CloudTransferExecutor::kCheckpoint,
+                    [this]() { Blocked(); });
+  }
+  WaitBlocked(2);
+  ASSERT_OK(executor.RunAll(
+      CloudTransferExecutor::kUpload, 4,
+      [](size_t /*idx*/) { return IOStatus::OK(); }, 4));
+  Release();
+}
+
+TEST_F(CloudTransferExecutorTest, RunAllStopsOnError) {
+  CloudTransferExecutor executor(2, std::vector<int>());
+  std::atomic<int> runs{0};
+  auto st = executor.RunAll(
+      CloudTransferExecutor::kHydrate, 100,
+      [&](size_t idx) {
+        runs++;
+        return idx == 3 ? IOStatus::IOError("failed") : IOStatus::OK();
+      },
+      1);
+  ASSERT_TRUE(st.IsIOError());
+  ASSERT_EQ(runs.load(), 4);
+}
+
+TEST_F(CloudTransferExecutorTest, ThreadPool) {
+  auto executor =
+      std::make_shared<CloudTransferExecutor>(4, std::vector<int>({2}));
+  auto pool = executor->NewThreadPool(CloudTransferExecutor::kUpload);
+  executor.reset();
+  ASSERT_EQ(pool->GetBackgroundThreads(), 2);
+
+  std::atomic<int> runs{0};
+  for (int i = 0; i < 10; i++) {
+    pool->SubmitJob([&runs]() {
+      Env::Default()->SleepForMicroseconds(100);
+      runs++;
+    });
+  }
+  pool->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(runs.load(), 10);
+  ASSERT_EQ(pool->GetQueueLen(), 0u);
+}
+
+TEST_F(CloudTransferExecutorTest, ScopedIOPriority) {
+  std::shared_ptr<RateLimiter> rate_limiter(
+      NewGenericRateLimiter(1 << 30 /* rate_bytes_per_sec */));
+  CloudTransferExecutor::RequestBytes(rate_limiter.get(), 100);
+  {
+    CloudTransferExecutor::ScopedIOPriority scoped(Env::IO_LOW);
+    CloudTransferExecutor::RequestBytes(rate_limiter.get(), 200);
+  }
+  {
+    // Keeps the priority of the thread
+    CloudTransferExecutor::ScopedIOPriority scoped(Env::IO_TOTAL);
+    CloudTransferExecutor::RequestBytes(rate_limiter.get(), 300);
+  }
+
+  // Overrides the priority of the job class, and only for the scope
+  CloudTransferExecutor executor(1, std::vector<int>());
+  ASSERT_OK(executor.RunAll(
+      CloudTransferExecutor::kUpload, 1,
+      [&](size_t /*idx*/) {
+        {
+          CloudTransferExecutor::ScopedIOPriority scoped(Env::IO_LOW);
+          CloudTransferExecutor::RequestBytes(rate_limiter.get(), 400);
+        }
+        CloudTransferExecutor::RequestBytes(rate_limiter.get(), 500);
+        return IOStatus::OK();
+      },
+      1));
+
+  ASSERT_EQ(rate_limiter->GetTotalBytesThrough(Env::IO_USER), 400);
+  ASSERT_EQ(rate_limiter->GetTotalBytesThrough(Env::IO_LOW), 600);
+  ASSERT_EQ(rate_limiter->GetTotalBytesThrough(Env::IO_HIGH), 500);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudTransferExecutorTest is not supported in "
+          "ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
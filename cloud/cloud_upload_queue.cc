@@ -0,0 +1,90 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_upload_queue.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CloudUploadQueue::CloudUploadQueue(std::shared_ptr<ThreadPool> executor,
+                                   size_t max_pending, Logger* info_log)
+    : executor_(std::move(executor)),
+      max_pending_(std::max<size_t>(max_pending, 1)),
+      info_log_(info_log) {}
+
+CloudUploadQueue::~CloudUploadQueue() {
+  WaitAll().PermitUncheckedError();
+  executor_->WaitForJobsAndJoinAllThreads();
+}
+
+void CloudUploadQueue::Enqueue(const std::string& name,
+                               std::function<IOStatus()> upload) {
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (num_pending_ >= max_pending_) {
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
+          "[CloudUploadQueue] %" ROCKSDB_PRIszt
+          " uploads pending, waiting to enqueue %s",
+          num_pending_, name.c_str());
+      cv_.wait(lk, [this] { return num_pending_ < max_pending_; });
+    }
+    num_pending_++;
+    pending_[name]++;
+    failed_.erase(name);
+  }
+  executor_->SubmitJob([this, name, upload = std::move(upload)]() {
+    auto st = upload();
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+          "[CloudUploadQueue] Upload of %s failed: %s", name.c_str(),
+          st.ToString().c_str());
+    }
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!st.ok()) {
+      failed_[name] = st;
+      if (first_error_.ok()) {
+        first_error_ = st;
+      }
+    }
+    auto it = pending_.find(name);
+    if (--it->second == 0) {
+      pending_.erase(it);
+    }
+    num_pending_--;
+    cv_.notify_all();
+  });
+}
+
+IOStatus CloudUploadQueue::Wait(const std::string& name) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  cv_.wait(lk, [this, &name] { return pending_.count(name) == 0; });
+  auto it = failed_.find(name);
+  if (it == failed_.end()) {
+    return IOStatus::OK();
+  }
+  auto st = it->second;
+  failed_.erase(it);
+  return st;
+}
+
+IOStatus CloudUploadQueue::WaitAll() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  cv_.wait(lk, [this] { return num_pending_ == 0; });
+  auto st = first_error_;
+  first_error_ = IOStatus::OK();
+  return st;
+}
+
+size_t CloudUploadQueue::NumPending() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return num_pending_;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,62 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rocksdb/io_status.h"
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+#ifndef ROCKSDB_LITE
+class Logger;
+class ThreadPool;
+
+// Bounded queue of files being uploaded to the cloud in the background.
+// Lets flush and compaction threads move on to their next job while the
+// SST files they produced are uploaded. Enqueue blocks once max_pending
+// uploads are queued or running, which throttles the producers when the
+// cloud cannot keep up.
+//
+// Thread safe.
+class CloudUploadQueue {
+ public:
+  // The uploads run on executor
+  CloudUploadQueue(std::shared_ptr<ThreadPool> executor, size_t max_pending,
+                   Logger* info_log);
+  // Waits for the queued uploads
+  ~CloudUploadQueue();
+
+  // Runs upload() in the background. `name` identifies the file in Wait().
+  void Enqueue(const std::string& name, std::function<IOStatus()> upload);
+
+  // Waits until the upload of `name`, if any, is done. Returns its status.
+  IOStatus Wait(const std::string& name);
+
+  // Waits until all queued uploads are done. Returns the first error of the
+  // uploads that completed since the previous call to WaitAll.
+  IOStatus WaitAll();
+
+  size_t NumPending() const;
+
+ private:
+  std::shared_ptr<ThreadPool> executor_;
+  const size_t max_pending_;
+  Logger* info_log_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  // Files queued or being uploaded, with their number of uploads in flight
+  std::unordered_map<std::string, int> pending_;
+  size_t num_pending_ = 0;
+  // Status of the finished uploads of files that are no longer pending,
+  // consumed by Wait()
+  std::unordered_map<std::string, IOStatus> failed_;
+  IOStatus first_error_;
+};
+#endif  // ROCKSDB_LITE
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Rockset
+
+#ifndef ROCKSDB_LITE
+#include "cloud/cloud_upload_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "cloud/cloud_transfer_executor.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudUploadQueueTest : public testing::Test {
+ public:
+  static std::shared_ptr<ThreadPool> NewExecutor(int num_threads) {
+    return std::make_shared<CloudTransferExecutor>(
+               num_threads, std::vector<int>())
+        ->NewThreadPool(CloudTransferExecutor::kUpload);
+  }
+
+  // Blocks the uploads until Release()
+  IOStatus Blocked(IOStatus st) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return released_; });
+    uploads_++;
+    return st;
+  }
+  void Release() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_ = false;
+  std::atomic<int> uploads_{0};
+};
+
+TEST_F(CloudUploadQueueTest, WaitForFile) {
+  CloudUploadQueue queue(NewExecutor(2), 8, nullptr);
+  queue.Enqueue("000010.sst", [this] { return Blocked(IOStatus::OK()); });
+  queue.Enqueue("000011.sst",
+                [this] { return Blocked(IOStatus::IOError("injected")); });
+  ASSERT_EQ(queue.NumPending(), 2u);
+  Release();
+  ASSERT_OK(queue.Wait("000010.sst"));
+  ASSERT_TRUE(queue.Wait("000011.sst").IsIOError());
+  // The failure was consumed by Wait
+  ASSERT_OK(queue.Wait("000011.sst"));
+  ASSERT_OK(queue.Wait("000012.sst"));
+  ASSERT_EQ(uploads_, 2);
+}
+
+TEST_F(CloudUploadQueueTest, WaitAll) {
+  CloudUploadQueue queue(NewExecutor(2), 8, nullptr);
+  for (int i = 0; i < 5; i++) {
+    queue.Enqueue(std::to_string(i) + ".sst", [this, i] {
+      return Blocked(i == 3 ? IOStatus::IOError("injected") : IOStatus::OK());
+    });
+  }
+  Release();
+  ASSERT_TRUE(queue.WaitAll().IsIOError());
+  ASSERT_EQ(queue.NumPending(), 0u);
+  ASSERT_EQ(uploads_, 5);
+  // The error is only reported once
+  ASSERT_OK(queue.WaitAll());
+}
+
+TEST_F(CloudUploadQueueTest, Backpressure) {
+  CloudUploadQueue queue(NewExecutor(1), 2, nullptr);
+  queue.Enqueue("1.sst", [this] { return Blocked(IOStatus::OK()); });
+  queue.Enqueue("2.sst", [this] { return Blocked(IOStatus::OK()); });
+  std::atomic<bool> enqueued{false};
+  port::Thread producer([&] {
+    queue.Enqueue("3.sst", [this] { return Blocked(IOStatus::OK()); });
+    enqueued = true;
+  });
+  // The queue is full until the uploads are released
+  Env::Default()->SleepForMicroseconds(100000);
+  ASSERT_FALSE(enqueued);
+  Release();
+  producer.join();
+  ASSERT_TRUE(enqueued);
+  ASSERT_OK(queue.WaitAll());
+  ASSERT_EQ(uploads_, 3);
+}
+
+}  //  namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CloudUploadQueueTest is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
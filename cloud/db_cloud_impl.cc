@@ -3,9 +3,19 @@
 
 #include "cloud/db_cloud_impl.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "cloud/cloud_block_cache_warmer.h"
 #include "cloud/cloud_manifest.h"
+#include "cloud/cloud_scheduler.h"
+#include "cloud/cloud_sst_file_manager.h"
+#include "cloud/cloud_sst_scrubber.h"
+#include "cloud/cloud_table_prefetcher.h"
+#include "cloud/cloud_transfer_executor.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
 #include "env/composite_env_wrapper.h"
@@ -25,39 +35,52 @@
 
 namespace ROCKSDB_NAMESPACE {
 
-namespace {
-/**
- * This ConstantSstFileManager uses the same size for every sst files added.
- */
-class ConstantSizeSstFileManager : public SstFileManagerImpl {
- public:
-  ConstantSizeSstFileManager(int64_t constant_file_size,
-                             const std::shared_ptr<SystemClock>& clock,
-                             const std::shared_ptr<FileSystem>& fs,
-                             std::shared_ptr<Logger> logger,
-                             int64_t rate_bytes_per_sec,
-                             double max_trash_db_ratio,
-                             uint64_t bytes_max_delete_chunk)
-      : SstFileManagerImpl(clock, fs, std::move(logger), rate_bytes_per_sec,
-                           max_trash_db_ratio, bytes_max_delete_chunk),
-        constant_file_size_(constant_file_size) {
-    assert(constant_file_size_ >= 0);
-  }
-
-  Status OnAddFile(const std::string& file_path) override {
-    return SstFileManagerImpl::OnAddFile(file_path,
-                                         uint64_t(constant_file_size_));
-  }
-
- private:
-  const int64_t constant_file_size_;
-};
-}  // namespace
-
 DBCloudImpl::DBCloudImpl(DB* db, std::unique_ptr<Env> local_env)
     : DBCloud(db), cfs_(nullptr), local_env_(std::move(local_env)) {}
 
-DBCloudImpl::~DBCloudImpl() {}
+DBCloudImpl::~DBCloudImpl() {
+  StopScrubber();
+  StopSavepoint();
+  StopBlockCacheWarmer();
+}
+
+Status DBCloudImpl::Close() {
+  StopScrubber();
+  StopSavepoint();
+  StopBlockCacheWarmer();
+  return DBCloud::Close();
+}
+
+void DBCloudImpl::StopScrubber() {
+  if (sst_scrubber_ == nullptr) {
+    return;
+  }
+  sst_scrubber_->Stop();
+  // Waits for a running pass
+  scheduler_->CancelJob(scrub_job_);
+  sst_scrubber_.reset();
+}
+
+void DBCloudImpl::GetScrubStats(ScrubStats* stats) {
+  if (sst_scrubber_ == nullptr) {
+    *stats = ScrubStats();
+    return;
+  }
+  sst_scrubber_->GetStats(stats);
+}
+
+void DBCloudImpl::StopBlockCacheWarmer() {
+  if (scheduler_) {
+    // Waits for a running save
+    scheduler_->CancelJob(save_hot_block_keys_job_);
+    scheduler_.reset();
+  }
+  block_cache_warmer_.reset();
+  if (table_prefetcher_) {
+    // The jobs use the DB
+    table_prefetcher_->Stop();
+  }
+}
 
 Status DBCloud::Open(const Options& options, const std::string& dbname,
                      const std::string& persistent_cache_path,
@@ -88,6 +111,45 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
                      const uint64_t persistent_cache_size_gb,
                      std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr,
                      bool read_only) {
+  return DBCloudImpl::DoOpen(opt, local_dbname, column_families,
+                             persistent_cache_path, persistent_cache_size_gb,
+                             handles, dbptr, read_only,
+                             "" /* secondary_path */);
+}
+
+Status DBCloud::OpenAsFollower(
+    const Options& options, const std::string& dbname,
+    const std::string& secondary_path,
+    const std::vector<ColumnFamilyDescriptor>& column_families,
+    std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr) {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(options.env->GetFileSystem().get());
+  if (cfs == nullptr) {
+    return Status::InvalidArgument("A follower needs a cloud file system");
+  }
+  if (!cfs->HasSrcBucket() || cfs->HasDestBucket() ||
+      cfs->GetCloudFileSystemOptions().roll_cloud_manifest_on_open) {
+    return Status::InvalidArgument(
+        "A follower reads the leader from the src bucket, and has no dest "
+        "bucket nor rolls the cloud manifest on open");
+  }
+  if (secondary_path.empty()) {
+    return Status::InvalidArgument("A follower needs a secondary path");
+  }
+  return DBCloudImpl::DoOpen(options, dbname, column_families,
+                             "" /* persistent_cache_path */,
+                             0 /* persistent_cache_size_gb */, handles, dbptr,
+                             false /* read_only */, secondary_path);
+}
+
+Status DBCloudImpl::DoOpen(
+    const Options& opt, const std::string& local_dbname,
+    const std::vector<ColumnFamilyDescriptor>& column_families,
+    const std::string& persistent_cache_path,
+    const uint64_t persistent_cache_size_gb,
+    std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr, bool read_only,
+    const std::string& secondary_path) {
+  const bool follower = !secondary_path.empty();
   Status st;
   Options options = opt;
 
@@ -102,21 +164,24 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
   if (!cfs->GetLogger()) {
     cfs->SetLogger(options.info_log);
   }
-  // Use a constant sized SST File Manager if necesary.
+  // Track the local copies apart from the cloud-only files.
   // NOTE: if user already passes in an SST File Manager, we will respect user's
   // SST File Manager instead.
-  auto constant_sst_file_size = cfs->GetCloudFileSystemOptions()
-                                    .constant_sst_file_size_in_sst_file_manager;
-  if (constant_sst_file_size >= 0 && options.sst_file_manager == nullptr) {
+  auto* cfs_impl = dynamic_cast<CloudFileSystemImpl*>(cfs);
+  if (options.sst_file_manager == nullptr && cfs_impl != nullptr) {
     // rate_bytes_per_sec, max_trash_db_ratio, bytes_max_delete_chunk are
     // default values in NewSstFileManager.
     // If users don't use Options.sst_file_manager, then these values are used
     // currently when creating an SST File Manager.
-    options.sst_file_manager = std::make_shared<ConstantSizeSstFileManager>(
-        constant_sst_file_size, options.env->GetSystemClock(),
-        options.env->GetFileSystem(), options.info_log,
-        0 /* rate_bytes_per_sec */, 0.25 /* max_trash_db_ratio */,
+    auto sfm = std::make_shared<CloudSstFileManager>(
+        cfs->GetCloudFileSystemOptions()
+            .constant_sst_file_size_in_sst_file_manager,
+        options.env->GetSystemClock(), options.env->GetFileSystem(),
+        cfs->GetBaseFileSystem(), options.info_log, 0 /* rate_bytes_per_sec */,
+        0.25 /* max_trash_db_ratio */,
         64 * 1024 * 1024 /* bytes_max_delete_chunk */);
+    cfs_impl->SetSstFileManager(sfm);
+    options.sst_file_manager = sfm;
   }
 
   const auto& local_fs = cfs->GetBaseFileSystem();
@@ -147,7 +212,7 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
     }
   }
   if (new_db) {
-    if (read_only || !options.create_if_missing) {
+    if (read_only || follower || !options.create_if_missing) {
       return Status::NotFound(
           "CLOUDMANIFEST not found and not creating new db");
     }
@@ -157,6 +222,22 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
       return st;
     }
   }
+  if (follower) {
+    // The local MANIFEST is only fetched when the epoch is rolled
+    assert(cfs_impl);
+    st = cfs_impl->RefreshFollowerManifest(local_dbname);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  if (!new_db) {
+    // Fetch the SST files a fresh local directory lacks in parallel, rather
+    // than one by one as DB::Open gets to them
+    st = cfs->HydrateLocalDirectory(local_dbname);
+    if (!st.ok()) {
+      return st;
+    }
+  }
 
   // Local environment, to be owned by DBCloudImpl, so that it outlives the
   // cache object created below.
@@ -192,9 +273,23 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
   // uploaded to S3 for every update, so always enable rolling of Manifest file
   options.max_manifest_file_size = DBCloudImpl::max_manifest_file_size;
 
+  std::shared_ptr<CloudTablePrefetcher> table_prefetcher;
+  if (cfs->GetCloudFileSystemOptions().table_prefetch_threads > 0 &&
+      cfs_impl != nullptr && cfs_impl->GetTransferExecutor()) {
+    // Sees the outputs of the flushes and compactions of the DB
+    table_prefetcher = std::make_shared<CloudTablePrefetcher>(
+        cfs_impl->GetTransferExecutor(),
+        cfs->GetCloudFileSystemOptions().table_prefetch_max_bytes,
+        options.info_log);
+    options.listeners.push_back(table_prefetcher);
+  }
+
   DB* db = nullptr;
   std::string dbid;
-  if (read_only) {
+  if (follower) {
+    st = DB::OpenAsSecondary(options, local_dbname, secondary_path,
+                             column_families, handles, &db);
+  } else if (read_only) {
     st = DB::OpenForReadOnly(options, local_dbname, column_families, handles,
                              &db);
   } else {
@@ -221,6 +316,75 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
 
   if (st.ok()) {
     DBCloudImpl* cloud = new DBCloudImpl(db, std::move(local_env));
+    if (follower) {
+      cloud->follower_dbname_ = local_dbname;
+    }
+    const auto& cloud_opts = cfs->GetCloudFileSystemOptions();
+    const bool save_hot_block_keys =
+        cloud_opts.hot_block_keys_interval_secs > 0 && !read_only &&
+        !follower && cfs->HasDestBucket();
+    const bool warm_up = cloud_opts.block_cache_warmup_threads > 0 &&
+                         !new_db && cfs->HasSrcBucket();
+    if (save_hot_block_keys || warm_up) {
+      std::vector<uint32_t> cf_ids;
+      for (auto* handle : *handles) {
+        cf_ids.push_back(handle->GetID());
+      }
+      cloud->block_cache_warmer_ = std::make_unique<CloudBlockCacheWarmer>(
+          db, cfs, local_dbname, cf_ids);
+    }
+    if (warm_up) {
+      if (cloud_opts.block_cache_warmup_in_background) {
+        cloud->block_cache_warmer_->StartWarmUp(
+            cloud_opts.block_cache_warmup_threads);
+      } else {
+        // Best effort, the DB serves with a cold cache otherwise
+        cloud->block_cache_warmer_
+            ->WarmUp(cloud_opts.block_cache_warmup_threads)
+            .PermitUncheckedError();
+      }
+    }
+    if (save_hot_block_keys) {
+      const std::chrono::microseconds interval =
+          std::chrono::seconds(cloud_opts.hot_block_keys_interval_secs);
+      cloud->scheduler_ = CloudScheduler::Get();
+      cloud->save_hot_block_keys_job_ = cloud->scheduler_->ScheduleRecurringJob(
+          interval, interval,
+          [warmer = cloud->block_cache_warmer_.get()](void*) {
+            warmer->SaveHotBlockKeys().PermitUncheckedError();
+          },
+          nullptr);
+    }
+    if (cloud_opts.scrub_interval_secs > 0 && !read_only && !follower &&
+        cfs_impl != nullptr) {
+      std::vector<uint32_t> cf_ids;
+      for (auto* handle : *handles) {
+        cf_ids.push_back(handle->GetID());
+      }
+      cloud->sst_scrubber_ = std::make_unique<CloudSstScrubber>(
+          db, cfs_impl, cloud->local_env_.get(), cf_ids,
+          cloud_opts.scrub_bytes_per_sec);
+      const std::chrono::microseconds interval =
+          std::chrono::seconds(cloud_opts.scrub_interval_secs);
+      if (!cloud->scheduler_) {
+        cloud->scheduler_ = CloudScheduler::Get();
+      }
+      cloud->scrub_job_ = cloud->scheduler_->ScheduleRecurringJob(
+          interval, interval,
+          [scrubber = cloud->sst_scrubber_.get()](void*) {
+            // Corruptions are logged and counted
+            scrubber->RunPass().PermitUncheckedError();
+          },
+          nullptr);
+    }
+    if (table_prefetcher) {
+      std::vector<uint32_t> cf_ids;
+      for (auto* handle : *handles) {
+        cf_ids.push_back(handle->GetID());
+      }
+      table_prefetcher->Start(db, cf_ids);
+      cloud->table_prefetcher_ = std::move(table_prefetcher);
+    }
     *dbptr = cloud;
     db->GetDbIdentity(dbid);
   }
@@ -231,6 +395,14 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
 }
 
 Status DBCloudImpl::Savepoint() {
+  auto st = StartSavepoint();
+  if (st.ok()) {
+    st = WaitForSavepoint();
+  }
+  return st;
+}
+
+Status DBCloudImpl::StartSavepoint() {
   std::string dbid;
   Options default_options = GetOptions();
   Status st = GetDbIdentity(dbid);
@@ -243,6 +415,18 @@ Status DBCloudImpl::Savepoint() {
       dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
   assert(cfs);
 
+  std::unique_lock<std::mutex> lk(savepoint_mutex_);
+  if (!savepoint_progress_.done) {
+    return Status::Busy("Savepoint in progress");
+  }
+  if (savepoint_stopped_) {
+    return Status::Aborted("DB closed");
+  }
+  if (savepoint_thread_.joinable()) {
+    savepoint_thread_.join();
+  }
+  savepoint_progress_ = SavepointProgress();
+
   // If there is no destination bucket, then nothing to do
   if (!cfs->HasDestBucket()) {
     Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
@@ -254,60 +438,170 @@ Status DBCloudImpl::Savepoint() {
   Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
       "Savepoint on cloud dbid  %s", dbid.c_str());
 
-  // find all sst files in the db
+  // find all sst files in the db, by level: the files of the lowest levels
+  // are compacted away the soonest, and go first
   std::vector<LiveFileMetaData> live_files;
   GetLiveFilesMetaData(&live_files);
+  std::sort(live_files.begin(), live_files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.level != b.level ? a.level < b.level
+                                        : a.file_number < b.file_number;
+            });
 
   auto provider = cfs->GetStorageProvider();
-  // If an sst file does not exist in the destination path, then remember it
-  std::vector<std::string> to_copy;
-  for (auto onefile : live_files) {
-    auto remapped_fname = cfs->RemapFilename(onefile.name);
-    std::string destpath = cfs->GetDestObjectPath() + "/" + remapped_fname;
-    if (!provider->ExistsCloudObject(cfs->GetDestBucketName(), destpath).ok()) {
-      to_copy.push_back(remapped_fname);
+  std::vector<std::pair<std::string, uint64_t>> live_fnames;
+  for (const auto& onefile : live_files) {
+    live_fnames.emplace_back(onefile.name, onefile.size);
+  }
+  if (cfs->GetCloudFileSystemOptions().cloud_blob_files) {
+    // and all blob files
+    std::vector<ColumnFamilyMetaData> cf_metas;
+    GetAllColumnFamilyMetaData(&cf_metas);
+    for (const auto& cf_meta : cf_metas) {
+      for (const auto& blob_meta : cf_meta.blob_files) {
+        live_fnames.emplace_back(
+            BlobFileName("", blob_meta.blob_file_number),
+            blob_meta.blob_file_size);
+      }
     }
   }
 
-  // copy all files in parallel
-  std::atomic<size_t> next_file_meta_idx(0);
-  int max_threads = default_options.max_file_opening_threads;
+  // If an sst file does not exist in the destination path, then remember
+  // it. One listing of the destination tells them all.
+  std::unordered_set<std::string> existing_objects;
+  auto list_st = provider->ListCloudObjectsInBatches(
+      cfs->GetDestBucketName(), cfs->GetDestObjectPath(),
+      [&](const std::vector<std::string>& objects) {
+        existing_objects.insert(objects.begin(), objects.end());
+        return IOStatus::OK();
+      });
+  if (!list_st.ok() && !list_st.IsNotFound()) {
+    Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
+        "Savepoint on cloud dbid  %s error in listing dest bucket %s dest "
+        "path %s. %s",
+        dbid.c_str(), cfs->GetDestBucketName().c_str(),
+        cfs->GetDestObjectPath().c_str(), list_st.ToString().c_str());
+    return list_st;
+  }
+  std::vector<std::pair<std::string, uint64_t>> to_copy;
+  for (const auto& fname : live_fnames) {
+    auto object_name = cfs->ObjectName(cfs->RemapFilename(fname.first));
+    if (existing_objects.count(object_name) == 0) {
+      savepoint_progress_.total_bytes += fname.second;
+      to_copy.emplace_back(std::move(object_name), fname.second);
+    }
+  }
+  savepoint_progress_.num_files = to_copy.size();
+  if (to_copy.empty()) {
+    return st;
+  }
+  savepoint_progress_.done = false;
 
-  std::function<void()> load_handlers_func = [&]() {
-    while (true) {
-      size_t idx = next_file_meta_idx.fetch_add(1);
-      if (idx >= to_copy.size()) {
-        break;
+  // copy all files in parallel, as checkpoint jobs of the transfer executor
+  auto info_log = default_options.info_log;
+  int max_threads = default_options.max_file_opening_threads;
+  savepoint_thread_ = port::Thread([this, cfs, provider, dbid, info_log,
+                                    max_threads,
+                                    to_copy = std::move(to_copy)]() {
+    const auto& low_latency_bucket =
+        cfs->GetCloudFileSystemOptions().low_latency_bucket;
+    auto copy_file = [&](const std::string& onefile) {
+      // A small file in a pack of sst_pack_threshold
+      auto s = cfs->CopyPackedFileToDest(GetName() + "/" + basename(onefile));
+      if (s.IsNotFound()) {
+        s = provider->CopyCloudObject(
+            cfs->GetSrcBucketName(), cfs->GetSrcObjectPath() + "/" + onefile,
+            cfs->GetDestBucketName(),
+            cfs->GetDestObjectPath() + "/" + onefile);
       }
-      auto& onefile = to_copy[idx];
-      auto s = provider->CopyCloudObject(
-          cfs->GetSrcBucketName(), cfs->GetSrcObjectPath() + "/" + onefile,
-          cfs->GetDestBucketName(), cfs->GetDestObjectPath() + "/" + onefile);
-      if (!s.ok()) {
-        Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
-            "Savepoint on cloud dbid  %s error in copying srcbucket %s srcpath "
-            "%s dest bucket %s dest path %s. %s",
-            dbid.c_str(), cfs->GetSrcBucketName().c_str(),
-            cfs->GetSrcObjectPath().c_str(), cfs->GetDestBucketName().c_str(),
-            cfs->GetDestObjectPath().c_str(), s.ToString().c_str());
-        if (st.ok()) {
-          st = s;  // save at least one error
+      if (s.IsNotFound() && !low_latency_bucket.empty()) {
+        // A young file of the src DB
+        s = provider->CopyCloudObject(
+            low_latency_bucket, cfs->GetSrcObjectPath() + "/" + onefile,
+            cfs->GetDestBucketName(), cfs->GetDestObjectPath() + "/" + onefile);
+      }
+      for (const auto& ancestor : cfs->GetCloneAncestors()) {
+        if (!s.IsNotFound()) {
+          break;
         }
-        break;
+        // A file of an ancestor of a copy-on-write clone
+        s = provider->CopyCloudObject(
+            ancestor.first, ancestor.second + "/" + onefile,
+            cfs->GetDestBucketName(), cfs->GetDestObjectPath() + "/" + onefile);
       }
-    }
-  };
+      cfs->InvalidateCloudObjectMetadata(
+          cfs->GetDestBucketName(), cfs->GetDestObjectPath() + "/" + onefile);
+      return s;
+    };
+    Status copy_st = cfs->GetTransferExecutor()->RunAll(
+        CloudTransferExecutor::kCheckpoint, to_copy.size(),
+        [&](size_t idx) {
+          {
+            std::lock_guard<std::mutex> l(savepoint_mutex_);
+            if (savepoint_stopped_) {
+              return IOStatus::Aborted("DB closed");
+            }
+          }
+          auto s = copy_file(to_copy[idx].first);
+          if (!s.ok()) {
+            Log(InfoLogLevel::INFO_LEVEL, info_log,
+                "Savepoint on cloud dbid  %s error in copying srcbucket %s "
+                "srcpath %s dest bucket %s dest path %s. %s",
+                dbid.c_str(), cfs->GetSrcBucketName().c_str(),
+                cfs->GetSrcObjectPath().c_str(),
+                cfs->GetDestBucketName().c_str(),
+                cfs->GetDestObjectPath().c_str(), s.ToString().c_str());
+            return s;
+          }
+          std::lock_guard<std::mutex> l(savepoint_mutex_);
+          savepoint_progress_.num_copied++;
+          savepoint_progress_.copied_bytes += to_copy[idx].second;
+          return s;
+        },
+        std::max(1, max_threads));
+    Log(InfoLogLevel::INFO_LEVEL, info_log,
+        "Savepoint on cloud dbid  %s copied %" ROCKSDB_PRIszt " files. %s",
+        dbid.c_str(), to_copy.size(), copy_st.ToString().c_str());
+    std::lock_guard<std::mutex> l(savepoint_mutex_);
+    savepoint_progress_.status = copy_st;
+    savepoint_progress_.done = true;
+    savepoint_cv_.notify_all();
+  });
+  return st;
+}
 
-  if (max_threads <= 1) {
-    load_handlers_func();
-  } else {
-    std::vector<port::Thread> threads;
-    for (int i = 0; i < max_threads; i++) {
-      threads.emplace_back(load_handlers_func);
-    }
-    for (auto& t : threads) {
-      t.join();
-    }
+Status DBCloudImpl::WaitForSavepoint() {
+  std::unique_lock<std::mutex> lk(savepoint_mutex_);
+  savepoint_cv_.wait(lk, [this]() { return savepoint_progress_.done; });
+  return savepoint_progress_.status;
+}
+
+void DBCloudImpl::GetSavepointProgress(SavepointProgress* progress) {
+  std::lock_guard<std::mutex> lk(savepoint_mutex_);
+  *progress = savepoint_progress_;
+}
+
+void DBCloudImpl::StopSavepoint() {
+  std::unique_lock<std::mutex> lk(savepoint_mutex_);
+  savepoint_stopped_ = true;
+  savepoint_cv_.wait(lk, [this]() { return savepoint_progress_.done; });
+  lk.unlock();
+  if (savepoint_thread_.joinable()) {
+    savepoint_thread_.join();
+  }
+}
+
+Status DBCloudImpl::TryCatchUpWithLeader() {
+  if (follower_dbname_.empty()) {
+    return Status::NotSupported("Not a follower");
+  }
+  std::lock_guard<std::mutex> lk(follower_mutex_);
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  Status st = cfs->RefreshFollowerManifest(follower_dbname_);
+  if (st.ok()) {
+    st = TryCatchUpWithPrimary();
   }
   return st;
 }
@@ -324,7 +618,8 @@ Status DBCloudImpl::DoCheckpointToCloud(
     const BucketOptions& destination, const CheckpointToCloudOptions& options) {
   std::vector<std::string> live_files;
   uint64_t manifest_file_size{0};
-  auto* cfs = dynamic_cast<CloudFileSystem*>(GetEnv()->GetFileSystem().get());
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
   assert(cfs);
   const auto& local_fs = cfs->GetBaseFileSystem();
 
@@ -333,6 +628,15 @@ Status DBCloudImpl::DoCheckpointToCloud(
   if (!st.ok()) {
     return st;
   }
+  // Sizes of the live SST files, by file number
+  std::unordered_map<uint64_t, uint64_t> sst_sizes;
+  {
+    std::vector<LiveFileMetaData> metadata;
+    GetLiveFilesMetaData(&metadata);
+    for (const auto& md : metadata) {
+      sst_sizes[md.file_number] = md.size;
+    }
+  }
 
   // Create a temp MANIFEST file first as this captures all the files we need
   auto current_epoch = cfs->GetCloudManifest()->GetCurrentEpoch();
@@ -346,6 +650,10 @@ Status DBCloudImpl::DoCheckpointToCloud(
   }
 
   std::vector<std::pair<std::string, std::string>> files_to_copy;
+  // Sizes of the SST files of files_to_copy, 0 if unknown
+  std::unordered_map<std::string, uint64_t> expected_sizes;
+  // Numbers of the table files of files_to_copy
+  std::unordered_map<std::string, uint64_t> table_numbers;
   for (auto& f : live_files) {
     uint64_t number = 0;
     FileType type;
@@ -353,12 +661,19 @@ Status DBCloudImpl::DoCheckpointToCloud(
     if (!ok) {
       return Status::InvalidArgument("Unknown file " + f);
     }
-    if (type != kTableFile) {
+    if (type != kTableFile &&
+        !(type == kBlobFile &&
+          cfs->GetCloudFileSystemOptions().cloud_blob_files)) {
       // ignore
       continue;
     }
     auto remapped_fname = cfs->RemapFilename(f);
-    files_to_copy.emplace_back(remapped_fname, remapped_fname);
+    files_to_copy.emplace_back(remapped_fname, cfs->ObjectName(remapped_fname));
+    auto it = sst_sizes.find(number);
+    expected_sizes[remapped_fname] = it != sst_sizes.end() ? it->second : 0;
+    if (type == kTableFile) {
+      table_numbers[remapped_fname] = number;
+    }
   }
 
   // IDENTITY file
@@ -370,11 +685,6 @@ Status DBCloudImpl::DoCheckpointToCloud(
   dbid = rtrim_if(trim(dbid), '\n');
   files_to_copy.emplace_back(IdentityFileName(""), IdentityFileName(""));
 
-  std::atomic<size_t> next_file_to_copy{0};
-  int thread_count = std::max(1, options.thread_count);
-  std::vector<Status> thread_statuses;
-  thread_statuses.resize(thread_count);
-
   auto upload_file = [&](const std::shared_ptr<CloudStorageProvider>& provider,
                          const std::string& localName,
                          const std::string& destName) {
@@ -382,45 +692,148 @@ Status DBCloudImpl::DoCheckpointToCloud(
         GetName() + "/" + localName, destination.GetBucketName(),
         destination.GetObjectPath() + "/" + destName);
   };
-  auto do_copy = [&](size_t threadId) {
-    auto provider = cfs->GetStorageProvider();
-    while (true) {
-      size_t idx = next_file_to_copy.fetch_add(1);
-      if (idx >= files_to_copy.size()) {
-        break;
-      }
 
-      auto& f = files_to_copy[idx];
-      auto copy_st = upload_file(provider, f.first, f.second);
-      if (!copy_st.ok()) {
-        thread_statuses[threadId] = std::move(copy_st);
-        break;
-      }
-    }
-  };
-
-  if (thread_count == 1) {
-    do_copy(0);
-  } else {
-    std::vector<std::thread> threads;
-    for (int i = 0; i < thread_count; ++i) {
-      threads.emplace_back([&, i]() { do_copy(i); });
+  // Objects the destination already holds, for incremental checkpoints
+  std::unordered_set<std::string> existing_objects;
+  if (options.incremental) {
+    std::vector<std::string> objects;
+    auto list_st = cfs->GetStorageProvider()->ListCloudObjects(
+        destination.GetBucketName(), destination.GetObjectPath(), &objects);
+    if (!list_st.ok() && !list_st.IsNotFound()) {
+      return list_st;
     }
-    for (auto& t : threads) {
-      t.join();
+    // By file name, without the shards of the data objects
+    for (const auto& object : objects) {
+      existing_objects.insert(RemoveObjectShard(object));
     }
   }
-
-  for (auto& s : thread_statuses) {
-    if (!s.ok()) {
-      st = s;
-      break;
+  // The table files the destination already holds with the same contents:
+  // the MANIFEST of the destination has them with the same unique id (from
+  // the DB session id and file number) and checksum. These need no size
+  // request
+  std::unordered_set<std::string> same_tables;
+  if (!existing_objects.empty()) {
+    ManifestReader reader(GetDBOptions().info_log, cfs,
+                          destination.GetBucketName());
+    std::set<uint64_t> local_list;
+    std::set<uint64_t> dest_list;
+    std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo>
+        local_infos;
+    std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo> dest_infos;
+    std::string dest_manifest;
+    auto read_st = reader.GetManifestLiveFiles(
+        local_fs.get(), GetName() + "/" + tmp_manifest_fname, &local_list,
+        &local_infos);
+    if (read_st.ok()) {
+      read_st = reader.GetCurrentManifestFile(destination.GetObjectPath(),
+                                              &dest_manifest);
+    }
+    if (read_st.ok()) {
+      read_st = reader.GetManifestLiveFilesFromCloud(dest_manifest, &dest_list,
+                                                     &dest_infos);
+    }
+    if (read_st.ok()) {
+      for (const auto& [fname, number] : table_numbers) {
+        auto local_it = local_infos.find(number);
+        auto dest_it = dest_infos.find(number);
+        if (local_it == local_infos.end() || dest_it == dest_infos.end() ||
+            existing_objects.count(fname) == 0) {
+          continue;
+        }
+        const auto& local = local_it->second;
+        const auto& dest = dest_it->second;
+        if (local.unique_id != kNullUniqueId64x2 &&
+            local.unique_id == dest.unique_id &&
+            local.file_size == dest.file_size &&
+            (local.file_checksum.empty() || dest.file_checksum.empty() ||
+             local.file_checksum == dest.file_checksum)) {
+          same_tables.insert(fname);
+        }
+      }
+    } else if (!read_st.IsNotFound()) {
+      // Falls back to comparing the sizes of the objects
+      Log(InfoLogLevel::WARN_LEVEL, cfs->GetLogger(),
+          "[db_cloud_impl] CheckpointToCloud failed to read the MANIFEST of "
+          "%s/%s: %s",
+          destination.GetBucketName().c_str(),
+          destination.GetObjectPath().c_str(), read_st.ToString().c_str());
     }
   }
+  const auto& db_dest = cfs->GetCloudFileSystemOptions().dest_bucket;
+  bool server_side_copy = options.server_side_copy && cfs->HasDestBucket() &&
+                          db_dest.GetRegion() == destination.GetRegion();
+  std::atomic<size_t> num_skipped{0};
+  std::atomic<size_t> num_copied{0};
 
+  auto checkpoint_file =
+      [&](const std::shared_ptr<CloudStorageProvider>& provider,
+          const std::string& localName, const std::string& destName) {
+        auto size_it = expected_sizes.find(localName);
+        if (size_it == expected_sizes.end()) {
+          // Not an SST file
+          return upload_file(provider, localName, destName);
+        }
+        if (same_tables.count(localName) > 0) {
+          num_skipped++;
+          return IOStatus::OK();
+        }
+        auto dest_path = destination.GetObjectPath() + "/" + destName;
+        if (size_it->second > 0 &&
+            existing_objects.count(RemoveObjectShard(destName)) > 0) {
+          uint64_t dest_size = 0;
+          auto size_st = provider->GetCloudObjectSize(
+              destination.GetBucketName(), dest_path, &dest_size);
+          if (size_st.ok() && dest_size == size_it->second) {
+            num_skipped++;
+            return IOStatus::OK();
+          }
+        }
+        if (server_side_copy) {
+          auto src_path =
+              db_dest.GetObjectPath() + "/" + cfs->ObjectName(localName);
+          auto copy_st =
+              provider->CopyCloudObject(db_dest.GetBucketName(), src_path,
+                                        destination.GetBucketName(), dest_path);
+          const auto& low_latency_bucket =
+              cfs->GetCloudFileSystemOptions().low_latency_bucket;
+          if (copy_st.IsNotFound() && !low_latency_bucket.empty()) {
+            // A young file of the DB
+            copy_st = provider->CopyCloudObject(low_latency_bucket, src_path,
+                                                destination.GetBucketName(),
+                                                dest_path);
+          }
+          cfs->InvalidateCloudObjectMetadata(destination.GetBucketName(),
+                                             dest_path);
+          if (copy_st.ok()) {
+            num_copied++;
+            return copy_st;
+          }
+          Log(InfoLogLevel::WARN_LEVEL, cfs->GetLogger(),
+              "[db_cloud_impl] CheckpointToCloud failed to copy %s, "
+              "uploading it: %s",
+              localName.c_str(), copy_st.ToString().c_str());
+        }
+        return upload_file(provider, localName, destName);
+      };
+  // The files are transferred by the checkpoint jobs of the transfer
+  // executor, which leaves room for the uploads and downloads of the DB
+  auto provider = cfs->GetStorageProvider();
+  st = cfs->GetTransferExecutor()->RunAll(
+      CloudTransferExecutor::kCheckpoint, files_to_copy.size(),
+      [&](size_t idx) {
+        const auto& f = files_to_copy[idx];
+        return checkpoint_file(provider, f.first, f.second);
+      },
+      std::max(1, options.thread_count));
   if (!st.ok()) {
     return st;
   }
+  Log(InfoLogLevel::INFO_LEVEL, cfs->GetLogger(),
+      "[db_cloud_impl] CheckpointToCloud %s/%s: %" ROCKSDB_PRIszt
+      " files, %" ROCKSDB_PRIszt " already there, %" ROCKSDB_PRIszt
+      " copied in the cloud",
+      destination.GetBucketName().c_str(), destination.GetObjectPath().c_str(),
+      files_to_copy.size(), num_skipped.load(), num_copied.load());
 
   // Upload MANIFEST and CLOUDMANIFEST sequentially only after copying all data
   // files
@@ -447,6 +860,160 @@ Status DBCloudImpl::DoCheckpointToCloud(
   return st;
 }
 
+Status DBCloudImpl::CheckpointToLocal(const std::string& checkpoint_dir,
+                                      const CheckpointToLocalOptions& options) {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  if (!cfs->GetCloudFileSystemOptions().keep_local_log_files) {
+    return Status::NotSupported("CheckpointToLocal needs local WAL files");
+  }
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  Status st = local_fs->FileExists(checkpoint_dir, IOOptions(), nullptr);
+  if (st.ok()) {
+    return Status::InvalidArgument("Directory exists", checkpoint_dir);
+  } else if (!st.IsNotFound()) {
+    return st;
+  }
+  auto dir = rtrim_if(checkpoint_dir, '/');
+  if (dir.empty()) {
+    return Status::InvalidArgument("Invalid checkpoint directory");
+  }
+
+  // The files go to a temporary directory, renamed once complete
+  auto tmp_dir = dir + ".tmp";
+  DestroyDir(local_env_.get(), tmp_dir).PermitUncheckedError();
+  st = local_fs->CreateDir(tmp_dir, IOOptions(), nullptr);
+  if (st.ok()) {
+    DisableFileDeletions();
+    st = DoCheckpointToLocal(tmp_dir, options);
+    EnableFileDeletions();
+  }
+  if (st.ok()) {
+    st = local_fs->RenameFile(tmp_dir, dir, IOOptions(), nullptr);
+  }
+  if (st.ok()) {
+    std::unique_ptr<FSDirectory> checkpoint_directory;
+    st = local_fs->NewDirectory(dir, IOOptions(), &checkpoint_directory,
+                                nullptr);
+    if (st.ok()) {
+      st = checkpoint_directory->FsyncWithDirOptions(
+          IOOptions(), nullptr,
+          DirFsyncOptions(DirFsyncOptions::FsyncReason::kDirRenamed));
+    }
+  } else {
+    DestroyDir(local_env_.get(), tmp_dir).PermitUncheckedError();
+  }
+  return st;
+}
+
+Status DBCloudImpl::DoCheckpointToLocal(
+    const std::string& dir, const CheckpointToLocalOptions& options) {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const bool use_fsync = GetDBOptions().use_fsync;
+
+  LiveFilesStorageInfoOptions info_options;
+  info_options.wal_size_for_flush = options.log_size_for_flush;
+  std::vector<LiveFileStorageInfo> infos;
+  auto st = GetLiveFilesStorageInfo(info_options, &infos);
+  if (!st.ok()) {
+    return st;
+  }
+
+  // The local files under their names with the epoch
+  struct FileToCopy {
+    std::string src;
+    std::string dest;
+    uint64_t size;
+  };
+  std::vector<FileToCopy> to_copy;
+  size_t num_linked = 0;
+  size_t num_in_cloud = 0;
+  for (const auto& info : infos) {
+    auto fname = cfs->RemapFilename(info.relative_filename);
+    if (!info.replacement_contents.empty()) {
+      // CURRENT
+      st = CreateFile(local_fs, dir + "/" + fname, info.replacement_contents,
+                      use_fsync);
+      if (!st.ok()) {
+        return st;
+      }
+      continue;
+    }
+    auto src = info.directory + "/" + fname;
+    auto dest = dir + "/" + fname;
+    if (info.file_type == kTableFile ||
+        (info.file_type == kBlobFile &&
+         cfs->GetCloudFileSystemOptions().cloud_blob_files)) {
+      st = local_fs->FileExists(src, IOOptions(), nullptr);
+      if (st.IsNotFound()) {
+        // Read from the cloud by the checkpoint
+        num_in_cloud++;
+        continue;
+      } else if (!st.ok()) {
+        return st;
+      }
+      st = local_fs->LinkFile(src, dest, IOOptions(), nullptr);
+      if (st.ok()) {
+        num_linked++;
+        continue;
+      } else if (!st.IsNotSupported()) {
+        return st;
+      }
+    }
+    to_copy.push_back({std::move(src), std::move(dest), info.size});
+  }
+  // The CLOUDMANIFEST maps the files to their epochs
+  to_copy.push_back({cfs->CloudManifestFile(GetName()),
+                     cfs->CloudManifestFile(dir), 0});
+
+  // Copies the WAL, MANIFEST and other files in parallel
+  std::atomic<size_t> next{0};
+  std::mutex copy_mutex;
+  IOStatus copy_st;
+  auto copy_files = [&]() {
+    for (size_t i = next++; i < to_copy.size(); i = next++) {
+      {
+        std::lock_guard<std::mutex> l(copy_mutex);
+        if (!copy_st.ok()) {
+          return;
+        }
+      }
+      const auto& f = to_copy[i];
+      auto s = CopyFile(local_fs, f.src, Temperature::kUnknown, f.dest,
+                        Temperature::kUnknown, f.size, use_fsync, nullptr);
+      if (!s.ok()) {
+        std::lock_guard<std::mutex> l(copy_mutex);
+        if (copy_st.ok()) {
+          copy_st = s;
+        }
+      }
+    }
+  };
+  size_t num_threads = std::min(
+      to_copy.size(), static_cast<size_t>(std::max(1, options.thread_count)));
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(copy_files);
+  }
+  copy_files();
+  for (auto& t : threads) {
+    t.join();
+  }
+  if (!copy_st.ok()) {
+    return copy_st;
+  }
+  Log(InfoLogLevel::INFO_LEVEL, cfs->GetLogger(),
+      "[db_cloud_impl] CheckpointToLocal %s: %" ROCKSDB_PRIszt
+      " files linked, %" ROCKSDB_PRIszt " copied, %" ROCKSDB_PRIszt
+      " left in the cloud",
+      dir.c_str(), num_linked, to_copy.size(), num_in_cloud);
+  return Status::OK();
+}
+
 Status DBCloud::ListColumnFamilies(const DBOptions& db_options,
                                    const std::string& name,
                                    std::vector<std::string>* column_families) {
@@ -3,16 +3,23 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <condition_variable>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "port/port.h"
 #include "rocksdb/cloud/db_cloud.h"
 #include "rocksdb/db.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class CloudBlockCacheWarmer;
+class CloudSstScrubber;
+class CloudTablePrefetcher;
+class CloudScheduler;
 class Env;
 
 //
@@ -25,9 +32,21 @@ class DBCloudImpl : public DBCloud {
  public:
   virtual ~DBCloudImpl();
   Status Savepoint() override;
+  Status StartSavepoint() override;
+  Status WaitForSavepoint() override;
+  void GetSavepointProgress(SavepointProgress* progress) override;
+  void GetScrubStats(ScrubStats* stats) override;
 
   Status CheckpointToCloud(const BucketOptions& destination,
                            const CheckpointToCloudOptions& options) override;
+  Status CheckpointToLocal(const std::string& checkpoint_dir,
+                           const CheckpointToLocalOptions& options) override;
+
+  Status TryCatchUpWithLeader() override;
+
+  // Stops the scrubber, saving the hot block keys and warming up the block
+  // cache first
+  Status Close() override;
 
  protected:
   // The CloudFileSystem used by this open instance.
@@ -36,13 +55,56 @@ class DBCloudImpl : public DBCloud {
  private:
   Status DoCheckpointToCloud(const BucketOptions& destination,
                              const CheckpointToCloudOptions& options);
+  // Links and copies the files of a local checkpoint into dir
+  Status DoCheckpointToLocal(const std::string& dir,
+                             const CheckpointToLocalOptions& options);
 
   // Maximum manifest file size
   static const uint64_t max_manifest_file_size = 4 * 1024L * 1024L;
 
   DBCloudImpl(DB* db, std::unique_ptr<Env> local_env);
 
+  // Opens a secondary instance if secondary_path is not empty
+  static Status DoOpen(
+      const Options& options, const std::string& local_dbname,
+      const std::vector<ColumnFamilyDescriptor>& column_families,
+      const std::string& persistent_cache_path,
+      const uint64_t persistent_cache_size_gb,
+      std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr,
+      bool read_only, const std::string& secondary_path);
+
   std::unique_ptr<Env> local_env_;
+
+  // Saves the hot block keys and warms up the block cache, null unless
+  // hot_block_keys_interval_secs or block_cache_warmup_threads is set
+  std::unique_ptr<CloudBlockCacheWarmer> block_cache_warmer_;
+  std::shared_ptr<CloudScheduler> scheduler_;
+  long save_hot_block_keys_job_ = -1;
+  // Also one of the listeners of the DB
+  std::shared_ptr<CloudTablePrefetcher> table_prefetcher_;
+  void StopBlockCacheWarmer();
+
+  // Verifies the live SST files on scheduler_, null unless
+  // scrub_interval_secs is set
+  std::unique_ptr<CloudSstScrubber> sst_scrubber_;
+  long scrub_job_ = -1;
+  // Stops a running pass and waits for it
+  void StopScrubber();
+
+  // Stops copying the files of a running savepoint and waits for it
+  void StopSavepoint();
+
+  // The background savepoint. Protected by savepoint_mutex_
+  std::mutex savepoint_mutex_;
+  std::condition_variable savepoint_cv_;
+  port::Thread savepoint_thread_;
+  SavepointProgress savepoint_progress_;
+  bool savepoint_stopped_ = false;
+
+  // Local directory of a follower, empty otherwise
+  std::string follower_dbname_;
+  // Serializes TryCatchUpWithLeader
+  std::mutex follower_mutex_;
 };
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
@@ -594,6 +594,123 @@ TEST_F(CloudTest, GetChildrenTest) {
   EXPECT_EQ(sst_files, 1);
 }
 
+// Reopening a database drops the epochs of CLOUDMANIFEST without live files
+TEST_F(CloudTest, PruneCloudManifestEpochsTest) {
+  cloud_fs_options_.prune_cloud_manifest_epochs = true;
+  cloud_fs_options_.cloud_manifest_format_version =
+      CloudManifest::kCompactFormatVersion;
+  OpenDB();
+  ASSERT_OK(db_->Put({}, "k1", "v1"));
+  ASSERT_OK(db_->Flush({}));
+  CloseDB();
+  for (int i = 0; i < 5; i++) {
+    OpenDB();
+    CloseDB();
+  }
+
+  OpenDB();
+  // The epoch of the flushed file and the most recent one are left
+  EXPECT_LE(GetCloudFileSystemImpl()
+                ->GetCloudManifest()
+                ->TEST_GetPastEpochs()
+                .size(),
+            2u);
+  std::string value;
+  ASSERT_OK(db_->Get({}, "k1", &value));
+  EXPECT_EQ(value, "v1");
+  CloseDB();
+}
+
+// A follower catches up with the flushes of the leader, also across a
+// reopen of the leader, without reopening
+TEST_F(CloudTest, FollowerTest) {
+  OpenDB();
+  ASSERT_OK(db_->Put({}, "k1", "v1"));
+  ASSERT_OK(db_->Flush({}));
+
+  // The follower reads the destination of the leader
+  auto copt = cloud_fs_options_;
+  copt.src_bucket = copt.dest_bucket;
+  copt.dest_bucket.SetBucketName("");
+  copt.dest_bucket.SetObjectPath("");
+  copt.roll_cloud_manifest_on_open = false;
+  CloudFileSystem* cfs;
+  ASSERT_OK(CloudFileSystemEnv::NewAwsFileSystem(
+      base_env_->GetFileSystem(), copt, options_.info_log, &cfs));
+  std::unique_ptr<Env> env(
+      new CompositeEnvWrapper(base_env_, std::shared_ptr<FileSystem>(cfs)));
+  Options options = options_;
+  options.env = env.get();
+  options.max_open_files = -1;
+  std::vector<ColumnFamilyDescriptor> column_families{
+      {kDefaultColumnFamilyName, options}};
+  std::vector<ColumnFamilyHandle*> handles;
+  DBCloud* follower_db = nullptr;
+  ASSERT_OK(DBCloud::OpenAsFollower(options, clone_dir_ + "/follower",
+                                    clone_dir_ + "/follower_secondary",
+                                    column_families, &handles, &follower_db));
+  std::unique_ptr<DBCloud> follower(follower_db);
+
+  std::string value;
+  ASSERT_OK(follower->Get({}, "k1", &value));
+  EXPECT_EQ(value, "v1");
+  ASSERT_TRUE(follower->Get({}, "k2", &value).IsNotFound());
+
+  ASSERT_OK(db_->Put({}, "k2", "v2"));
+  ASSERT_OK(db_->Flush({}));
+  ASSERT_OK(follower->TryCatchUpWithLeader());
+  ASSERT_OK(follower->Get({}, "k2", &value));
+  EXPECT_EQ(value, "v2");
+
+  // The leader reopens in a new epoch
+  CloseDB();
+  OpenDB();
+  ASSERT_OK(db_->Put({}, "k3", "v3"));
+  ASSERT_OK(db_->Flush({}));
+  ASSERT_OK(follower->TryCatchUpWithLeader());
+  ASSERT_OK(follower->Get({}, "k3", &value));
+  EXPECT_EQ(value, "v3");
+  ASSERT_OK(follower->Get({}, "k1", &value));
+  EXPECT_EQ(value, "v1");
+
+  ASSERT_TRUE(db_->TryCatchUpWithLeader().IsNotSupported());
+  for (auto h : handles) {
+    delete h;
+  }
+  follower.reset();
+  CloseDB();
+}
+
+TEST_F(CloudTest, GetChildrenFromManifestTest) {
+  cloud_fs_options_.getchildren_from_manifest = true;
+  options_.disable_auto_compactions = true;
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "Hello", "World"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  CloseDB();
+  DestroyDir(dbname_);
+  OpenDB();
+
+  auto count_sst_files = [&]() {
+    std::vector<std::string> children;
+    EXPECT_OK(aenv_->GetFileSystem()->GetChildren(dbname_, kIOOptions,
+                                                  &children, kDbg));
+    return std::count_if(children.begin(), children.end(),
+                         [](const std::string& c) { return IsSstFile(c); });
+  };
+  // The file is only in the cloud, and known from the MANIFEST
+  EXPECT_EQ(count_sst_files(), 1);
+
+  // New files are tracked, the compacted ones drop out
+  ASSERT_OK(db_->Put(WriteOptions(), "Hello", "Universe"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  EXPECT_EQ(count_sst_files(), 2);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  GetDBImpl()->TEST_WaitForBackgroundWork();
+  EXPECT_EQ(count_sst_files(), 1);
+  CloseDB();
+}
+
 TEST_F(CloudTest, FindLiveFilesFromLocalManifestTest) {
   OpenDB();
   ASSERT_OK(db_->Put(WriteOptions(), "Hello", "Universe"));
@@ -868,6 +985,15 @@ TEST_F(CloudTest, DISABLED_TrueClone) {
     // TODO(igor): Re-enable once purger code is fixed
     // ASSERT_EQ(to_be_deleted.size(), 0);
 
+    // The MANIFESTs are unchanged, the second pass reuses their live files
+    std::vector<std::string> to_be_deleted_again;
+    ASSERT_OK(cimpl->FindObsoleteFiles(cimpl->GetSrcBucketName(),
+                                       &to_be_deleted_again));
+    std::sort(to_be_deleted.begin(), to_be_deleted.end());
+    std::sort(to_be_deleted_again.begin(), to_be_deleted_again.end());
+    ASSERT_EQ(to_be_deleted, to_be_deleted_again);
+    to_be_deleted.clear();
+
     // Assert that there are no redundant dbid
     ASSERT_OK(
         cimpl->FindObsoleteDbid(cimpl->GetSrcBucketName(), &to_be_deleted));
@@ -940,6 +1066,33 @@ TEST_F(CloudTest, KeepLocalFiles) {
   }
 }
 
+TEST_F(CloudTest, HydrateLocalDirectoryOnOpen) {
+  cloud_fs_options_.keep_local_sst_files = true;
+  cloud_fs_options_.sst_download_threads = 4;
+  OpenDB();
+  for (int i = 0; i < 5; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), "Hello" + std::to_string(i), "World"));
+    ASSERT_OK(db_->Flush(FlushOptions()));
+  }
+  CloseDB();
+  DestroyDir(dbname_);
+
+  // With max_open_files != -1, DB::Open alone doesn't fetch every file
+  options_.max_open_files = 10;
+  OpenDB();
+  std::vector<std::string> files;
+  ASSERT_OK(Env::Default()->GetChildren(dbname_, &files));
+  long sst_files =
+      std::count_if(files.begin(), files.end(), [](const std::string& file) {
+        return file.find("sst") != std::string::npos;
+      });
+  ASSERT_EQ(sst_files, 5);
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "Hello3", &value));
+  ASSERT_EQ(value, "World");
+  CloseDB();
+}
+
 TEST_F(CloudTest, CopyToFromS3) {
   std::string fname = dbname_ + "/100000.sst";
 
@@ -1321,6 +1474,55 @@ TEST_F(CloudTest, TwoDBsOneBucket) {
   CloseDB();
 }
 
+// The MANIFEST of the epoch of the local CLOUDMANIFEST is fetched with the
+// CLOUDMANIFEST on open, and only used if that epoch is still the current one
+TEST_F(CloudTest, PrefetchManifestOnOpen) {
+  auto firstDB = dbname_;
+  auto secondDB = dbname_ + "-1";
+  cloud_fs_options_.resync_on_open = true;
+  std::atomic<int> num_checked(0);
+  std::atomic<bool> prefetched(false);
+  SyncPoint::GetInstance()->SetCallBack(
+      "CloudFileSystemImpl::LoadCloudManifest:Prefetched", [&](void* arg) {
+        prefetched = *static_cast<bool*>(arg);
+        num_checked++;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "key", "first"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  CloseDB();
+
+  num_checked = 0;
+  OpenDB();
+  ASSERT_GT(num_checked, 0);
+  ASSERT_TRUE(prefetched);
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ("first", value);
+  CloseDB();
+
+  // Another directory rolls the epoch of the bucket
+  dbname_ = secondDB;
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "key", "second"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  CloseDB();
+
+  dbname_ = firstDB;
+  num_checked = 0;
+  OpenDB();
+  ASSERT_GT(num_checked, 0);
+  ASSERT_FALSE(prefetched);
+  ASSERT_OK(db_->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ("second", value);
+  CloseDB();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // This test is similar to TwoDBsOneBucket, but is much more chaotic and illegal
 // -- it runs two databases on exact same S3 bucket. The work on CLOUDMANIFEST
 // enables us to run in that configuration for extended amount of time (1 hour
@@ -1798,6 +2000,88 @@ TEST_F(CloudTest, CheckpointToCloud) {
       checkpoint_bucket.GetBucketName(), checkpoint_bucket.GetObjectPath());
 }
 
+TEST_F(CloudTest, IncrementalCheckpointToCloud) {
+  cloud_fs_options_.keep_local_sst_files = true;
+  options_.level0_file_num_compaction_trigger = 100;  // never compact
+
+  // Pre-create the bucket.
+  CreateCloudEnv();
+  aenv_.reset();
+
+  // S3 is eventual consistency.
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  auto checkpoint_bucket = cloud_fs_options_.dest_bucket;
+
+  cloud_fs_options_.src_bucket = BucketOptions();
+  cloud_fs_options_.dest_bucket = BucketOptions();
+
+  CheckpointToCloudOptions checkpoint_options;
+  checkpoint_options.incremental = true;
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "b"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CheckpointToCloud(checkpoint_bucket, checkpoint_options));
+
+  // Only the new file has to go, the checkpoint still has both
+  ASSERT_OK(db_->Put(WriteOptions(), "c", "d"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CheckpointToCloud(checkpoint_bucket, checkpoint_options));
+  CloseDB();
+
+  DestroyDir(dbname_);
+
+  cloud_fs_options_.src_bucket = checkpoint_bucket;
+
+  OpenDB();
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(db_->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ(value, "d");
+  CloseDB();
+
+  GetCloudFileSystem()->GetStorageProvider()->EmptyBucket(
+      checkpoint_bucket.GetBucketName(), checkpoint_bucket.GetObjectPath());
+}
+
+TEST_F(CloudTest, CheckpointToLocal) {
+  cloud_fs_options_.keep_local_sst_files = false;
+  options_.level0_file_num_compaction_trigger = 100;  // never compact
+
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "b"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->Put(WriteOptions(), "c", "d"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  // Only in the WAL
+  ASSERT_OK(db_->Put(WriteOptions(), "e", "f"));
+
+  ASSERT_OK(base_env_->CreateDirIfMissing(clone_dir_));
+  auto checkpoint_dir = clone_dir_ + "/checkpoint";
+  ASSERT_OK(db_->CheckpointToLocal(checkpoint_dir, CheckpointToLocalOptions()));
+  ASSERT_TRUE(
+      db_->CheckpointToLocal(checkpoint_dir, CheckpointToLocalOptions())
+          .IsInvalidArgument());
+  // The SST files are left in the cloud
+  ASSERT_EQ(0, GetSSTFilesClone("checkpoint").size());
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "changed"));
+  CloseDB();
+
+  // Opened as an ephemeral clone reading the SST files of the DB
+  std::unique_ptr<Env> env;
+  std::unique_ptr<DBCloud> cloud_db;
+  ASSERT_OK(CloneDB("checkpoint", "", "", &cloud_db, &env,
+                    false /* force_keep_local_on_invalid_dest_bucket */));
+  std::string value;
+  ASSERT_OK(cloud_db->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(cloud_db->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ(value, "d");
+  ASSERT_OK(cloud_db->Get(ReadOptions(), "e", &value));
+  ASSERT_EQ(value, "f");
+}
+
 // Basic test to copy object within S3.
 TEST_F(CloudTest, CopyObjectTest) {
   CreateCloudEnv();
@@ -3040,6 +3324,36 @@ TEST_F(CloudTest, ScheduleFileDeletionTest) {
   EXPECT_EQ(deletion_scheduler->TEST_FilesToDelete().size(), 0);
 }
 
+TEST_F(CloudTest, BatchedFileDeletionTest) {
+  auto scheduler = CloudScheduler::Get();
+  auto deletion_scheduler =
+      CloudFileDeletionScheduler::Create(scheduler, std::chrono::seconds(0));
+
+  std::mutex mutex;
+  std::vector<std::vector<std::string>> batches;
+  auto runnable = [&](const std::vector<std::string>& object_paths) {
+    std::lock_guard<std::mutex> lk(mutex);
+    batches.push_back(object_paths);
+  };
+  int num_file_deletions = 10;
+  for (int i = 0; i < num_file_deletions; i++) {
+    auto fname = std::to_string(i) + ".sst";
+    ASSERT_OK(deletion_scheduler->ScheduleBatchedFileDeletion(
+        fname, "path/" + fname, runnable));
+  }
+  // Unscheduled files are left out of their batch
+  deletion_scheduler->UnscheduleFileDeletion("3.sst");
+
+  while (scheduler->TEST_NumScheduledJobs() > 0) {
+    usleep(100);
+  }
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_EQ(batches[0].size(), num_file_deletions - 1);
+  EXPECT_EQ(std::count(batches[0].begin(), batches[0].end(), "path/3.sst"), 0);
+  EXPECT_EQ(deletion_scheduler->TEST_FilesToDelete().size(), 0);
+}
+
 TEST_F(CloudTest, SameFileDeletedMultipleTimesTest) {
   auto scheduler = CloudScheduler::Get();
   auto deletion_scheduler =
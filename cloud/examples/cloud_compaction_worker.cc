@@ -0,0 +1,54 @@
+// Copyright (c) 2017-present, Rockset, Inc.  All rights reserved.
+#include <cstdio>
+#include <string>
+
+#include "rocksdb/cloud/cloud_compaction_service.h"
+#include "rocksdb/env.h"
+
+using namespace ROCKSDB_NAMESPACE;
+
+// Runs one job of a CloudCompactionService. The dispatcher of the DB writes
+// the job to job_file, runs this worker on any host that can reach the
+// bucket of the DB, and returns the contents of result_file to the DB.
+//
+// cloud_fs_config configures the CloudFileSystem of the worker, e.g.
+// "id=aws" with the credentials in the environment. The MANIFEST of the DB
+// and the output files are kept in local_dir until the job is done.
+int main(int argc, char** argv) {
+  if (argc != 5) {
+    fprintf(stderr,
+            "Usage: %s <cloud_fs_config> <local_dir> <job_file> "
+            "<result_file>\n",
+            argv[0]);
+    return 1;
+  }
+  CloudCompactionWorkerOptions options;
+  options.cloud_fs_config = argv[1];
+  options.local_dir = argv[2];
+
+  auto env = Env::Default();
+  std::string job;
+  Status s = ReadFileToString(env, argv[3], &job);
+  if (!s.ok()) {
+    fprintf(stderr, "Unable to read the job %s. %s\n", argv[3],
+            s.ToString().c_str());
+    return 1;
+  }
+
+  std::string result;
+  s = CloudCompactionWorker::Run(options, job, &result);
+  if (!result.empty()) {
+    // The DB reads the status of a failed compaction from its result
+    Status ws = WriteStringToFile(env, result, argv[4], true /* sync */);
+    if (!ws.ok()) {
+      fprintf(stderr, "Unable to write the result %s. %s\n", argv[4],
+              ws.ToString().c_str());
+      return 1;
+    }
+  }
+  if (!s.ok()) {
+    fprintf(stderr, "Compaction job failed. %s\n", s.ToString().c_str());
+    return 1;
+  }
+  return 0;
+}
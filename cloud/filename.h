@@ -5,9 +5,12 @@
 #include <rocksdb/slice.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <functional>
 #include <string>
 
+#include "util/hash.h"
+
 //
 // These are inlined methods to deal with pathnames and filenames.
 
@@ -122,6 +125,115 @@ inline std::string GetCookie(const std::string& cloud_manifest_file_path) {
   return cloud_manifest_fname.substr(firstDash + 1);
 }
 
+// Directory of the output files of remote compaction jobs, relative to the
+// DB directory. It only exists in the dest bucket (see
+// CloudCompactionService).
+const std::string kRemoteCompactionDir = "remote_compaction";
+
+inline std::string RemoteCompactionOutputDir(const std::string& dbname,
+                                             const std::string& job_id) {
+  return dbname + "/" + kRemoteCompactionDir + "/" + job_id;
+}
+
+// If pathname is in a RemoteCompactionOutputDir(), returns its path relative
+// to the DB directory, or else an empty string
+inline std::string RemoteCompactionOutputPath(const std::string& pathname) {
+  auto job_dir = dirname(pathname);
+  if (job_dir.empty() || basename(dirname(job_dir)) != kRemoteCompactionDir) {
+    return "";
+  }
+  return kRemoteCompactionDir + "/" + basename(job_dir) + "/" +
+         basename(pathname);
+}
+
+// Prefix of the paths that name an object of a bucket rather than a file,
+// "cloud://<bucket>/<object path>" (see CloudFileSystem::CloudObjectFilePath)
+const std::string kCloudObjectPathPrefix = "cloud://";
+
+inline std::string MakeCloudObjectFilePath(const std::string& bucket,
+                                           const std::string& object_path) {
+  return kCloudObjectPathPrefix + bucket + "/" + object_path;
+}
+
+// If pathname is from MakeCloudObjectFilePath(), returns true with its bucket
+// and object path
+inline bool ParseCloudObjectFilePath(const std::string& pathname,
+                                     std::string* bucket,
+                                     std::string* object_path) {
+  if (pathname.compare(0, kCloudObjectPathPrefix.size(),
+                       kCloudObjectPathPrefix) != 0) {
+    return false;
+  }
+  auto slash = pathname.find('/', kCloudObjectPathPrefix.size());
+  if (slash == std::string::npos || slash == kCloudObjectPathPrefix.size() ||
+      slash + 1 == pathname.size()) {
+    return false;
+  }
+  *bucket = pathname.substr(kCloudObjectPathPrefix.size(),
+                            slash - kCloudObjectPathPrefix.size());
+  *object_path = pathname.substr(slash + 1);
+  return true;
+}
+
+// The object of a copy-on-write clone that names its parent DB, as a
+// MakeCloudObjectFilePath() of its bucket and object path (see
+// CloudFileSystemOptions::copy_on_write_clones)
+inline std::string CloudParentFileName(const std::string& dbname) {
+  return dbname + "/CLOUDPARENT";
+}
+
+// The shard of an object in the sharded layout of the data files (see
+// CloudFileSystemOptions::shard_data_object_names): two hex digits of a hash
+// of its name
+inline std::string ObjectShard(const std::string& object_name) {
+  char shard[3];
+  snprintf(shard, sizeof(shard), "%02x",
+           ROCKSDB_NAMESPACE::Hash(object_name.data(), object_name.size(),
+                                   0 /* seed */) &
+               0xffu);
+  return shard;
+}
+
+// The name of object_name in the sharded layout, relative to the object path
+// of the DB
+inline std::string ShardedObjectName(const std::string& object_name) {
+  return ObjectShard(object_name) + "/" + object_name;
+}
+
+// If name, relative to the object path of a DB, is a ShardedObjectName(),
+// returns the name of the object without its shard, or else name
+inline std::string RemoveObjectShard(const std::string& name) {
+  if (name.size() < 4 || name[2] != '/' ||
+      name.find('/', 3) != std::string::npos) {
+    return name;
+  }
+  auto object_name = name.substr(3);
+  if (name.compare(0, 2, ObjectShard(object_name)) != 0) {
+    return name;
+  }
+  return object_name;
+}
+
+// The packs of small SST files (see CloudFileSystemOptions::sst_pack_threshold)
+// are named after their first file, in the packs directory of the object
+// path of the DB
+const std::string kSstPackDir = "packs";
+const std::string kSstPackSuffix = ".pack";
+
+inline std::string SstPackFileName(const std::string& first_file) {
+  return basename(first_file) + kSstPackSuffix;
+}
+
+inline bool IsSstPackFile(const std::string& pathname) {
+  return pathname.size() >= kSstPackSuffix.size() &&
+         pathname.compare(pathname.size() - kSstPackSuffix.size(),
+                          kSstPackSuffix.size(), kSstPackSuffix) == 0;
+}
+
+// Object of the dest bucket with the hot block keys of the DB (see
+// CloudFileSystemOptions::hot_block_keys_interval_secs)
+const std::string kHotBlockKeysFile = "HOTBLOCKKEYS";
+
 // pathaname seperator
 const std::string pathsep = "/";
 
@@ -129,6 +241,7 @@ const std::string pathsep = "/";
 const std::string sst = ".sst";
 const std::string ldb = ".ldb";
 const std::string log = ".log";
+const std::string blob = ".blob";
 
 // Is this a sst file, i.e. ends in ".sst" or ".ldb"
 inline bool IsSstFile(const std::string& pathname) {
@@ -143,6 +256,15 @@ inline bool IsSstFile(const std::string& pathname) {
   return false;
 }
 
+// A blob file has ".blob" suffix
+inline bool IsBlobFile(const std::string& pathname) {
+  if (pathname.size() < blob.size()) {
+    return false;
+  }
+  const char* ptr = pathname.c_str() + pathname.size() - blob.size();
+  return memcmp(ptr, blob.c_str(), blob.size()) == 0;
+}
+
 // A log file has ".log" suffix
 inline bool IsWalFile(const std::string& pathname) {
   if (pathname.size() < log.size()) {
@@ -200,6 +322,7 @@ inline bool IsCloudManifestFile(const std::string& pathname) {
 
 enum class RocksDBFileType {
   kSstFile,
+  kBlobFile,
   kLogFile,
   kManifestFile,
   kIdentityFile,
@@ -207,7 +330,7 @@ enum class RocksDBFileType {
 };
 
 // Determine type of a file based on filename. Rules:
-// 1. filename ends with a .sst is a sst file.
+// 1. filename ends with a .sst is a sst file, with .blob a blob file.
 // 2. filename ends with .log or starts with MANIFEST is a logfile
 // 3. filename starts with MANIFEST is a manifest file
 // 3. filename starts with IDENTITY is a ID file
@@ -216,6 +339,9 @@ inline RocksDBFileType GetFileType(const std::string& fname_with_epoch) {
   if (IsSstFile(fname)) {
     return RocksDBFileType::kSstFile;
   }
+  if (IsBlobFile(fname)) {
+    return RocksDBFileType::kBlobFile;
+  }
   if (IsLogFile(fname)) {
     return RocksDBFileType::kLogFile;
   }
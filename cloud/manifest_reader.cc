@@ -3,14 +3,18 @@
 
 #include "cloud/manifest_reader.h"
 
+#include <algorithm>
+#include <cstring>
 #include <unordered_map>
 
 #include "cloud/cloud_manifest.h"
 #include "cloud/db_cloud_impl.h"
 #include "cloud/filename.h"
+#include "db/log_reader.h"
 #include "db/version_set.h"
 #include "env/composite_env_wrapper.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
@@ -18,12 +22,262 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Replays the VersionEdits of a MANIFEST to find its live files
+class LiveFilesBuilder {
+ public:
+  // with_infos and with_blobs tell whether GetLiveFiles() is asked for the
+  // infos or the blob files
+  LiveFilesBuilder(bool with_infos, bool with_blobs)
+      : with_infos_(with_infos), with_blobs_(with_blobs) {}
+
+  IOStatus Apply(const VersionEdit& edit) {
+    // add the files that are added by this transaction
+    for (auto& one : edit.GetNewFiles()) {
+      uint64_t num = one.second.fd.GetNumber();
+      cf_live_files_[edit.GetColumnFamily()][one.first].insert(num);
+      if (with_infos_) {
+        file_infos_[num] = LocalManifestReader::LiveFileInfo{
+            one.first, one.second.fd.GetFileSize(), one.second.temperature,
+            one.second.unique_id, one.second.file_checksum};
+      }
+    }
+    // delete the files that are removed by this transaction
+    for (auto& one : edit.GetDeletedFiles()) {
+      int level = one.first;
+      uint64_t num = one.second;
+      // Deleted files should belong to some CF
+      auto it = cf_live_files_.find(edit.GetColumnFamily());
+      if ((it == cf_live_files_.end()) || (it->second.count(level) == 0) ||
+          (it->second[level].count(num) == 0)) {
+        return IOStatus::Corruption(
+            "Corrupted Manifest file with unrecognized deleted file: " +
+            std::to_string(level) + "," + std::to_string(num));
+      }
+      it->second[level].erase(num);
+    }
+
+    if (with_blobs_) {
+      auto& blob_files = cf_blob_files_[edit.GetColumnFamily()];
+      for (const auto& addition : edit.GetBlobFileAdditions()) {
+        blob_files[addition.GetBlobFileNumber()] = {
+            addition.GetTotalBlobCount(), 0};
+      }
+      for (const auto& garbage : edit.GetBlobFileGarbages()) {
+        auto it = blob_files.find(garbage.GetBlobFileNumber());
+        if (it == blob_files.end()) {
+          continue;
+        }
+        it->second.second += garbage.GetGarbageBlobCount();
+        if (it->second.second >= it->second.first) {
+          blob_files.erase(it);
+        }
+      }
+    }
+
+    // Removing the files from dropped CF, since we don't mark the files as
+    // deleted in Manifest when a CF is dropped,
+    if (edit.IsColumnFamilyDrop()) {
+      cf_live_files_.erase(edit.GetColumnFamily());
+      cf_blob_files_.erase(edit.GetColumnFamily());
+    }
+    return IOStatus::OK();
+  }
+
+  // The live files of the edits applied so far
+  void GetLiveFiles(
+      std::set<uint64_t>* list,
+      std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo>* infos,
+      std::set<uint64_t>* blob_list) const {
+    for (auto& [cf_id, live_files] : cf_live_files_) {
+      for (auto& [level, level_live_files] : live_files) {
+        (void)cf_id;
+        list->insert(level_live_files.begin(), level_live_files.end());
+        if (infos) {
+          for (auto num : level_live_files) {
+            auto& info = (*infos)[num];
+            auto it = file_infos_.find(num);
+            if (it != file_infos_.end()) {
+              info = it->second;
+            }
+            info.level = level;
+          }
+        }
+      }
+    }
+
+    if (blob_list) {
+      for (auto& [cf_id, blob_files] : cf_blob_files_) {
+        (void)cf_id;
+        for (auto& [num, counts] : blob_files) {
+          (void)counts;
+          blob_list->insert(num);
+        }
+      }
+    }
+  }
+
+ private:
+  const bool with_infos_;
+  const bool with_blobs_;
+  // keep track of each CF's live files on each level
+  std::unordered_map<uint32_t,                // CF id
+                     std::unordered_map<int,  // level
+                                        std::unordered_set<uint64_t>>>
+      cf_live_files_;
+  // size, temperature and identity of every file added, live or not. The
+  // level is set in GetLiveFiles()
+  std::unordered_map<uint64_t, LocalManifestReader::LiveFileInfo> file_infos_;
+  // each CF's blob files that are not entirely garbage, with their total and
+  // garbage blob counts
+  std::unordered_map<
+      uint32_t,  // CF id
+      std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>>>
+      cf_blob_files_;
+};
+
+// Reads a MANIFEST of the cloud sequentially, in ranged requests of
+// kReadaheadSize rather than one per block of the log reader. Can be moved
+// to a newer version of the object that the DB appended to, to go on
+// reading where it was.
+class CloudManifestFile : public FSSequentialFile {
+ public:
+  static constexpr size_t kReadaheadSize = 2 << 20;
+
+  explicit CloudManifestFile(std::unique_ptr<CloudStorageReadableFile> file)
+      : file_(std::move(file)) {}
+
+  IOStatus Read(size_t n, const IOOptions& options, Slice* result,
+                char* scratch, IODebugContext* dbg) override {
+    size_t copied = 0;
+    while (copied < n) {
+      if (buffer_pos_ == buffer_.size()) {
+        auto st = Fill(file_.get(), offset_, kReadaheadSize, options, dbg);
+        if (!st.ok()) {
+          return st;
+        }
+        if (buffer_.empty()) {
+          break;
+        }
+      }
+      auto len = std::min(n - copied, buffer_.size() - buffer_pos_);
+      memcpy(scratch + copied, buffer_.data() + buffer_pos_, len);
+      buffer_pos_ += len;
+      copied += len;
+    }
+    offset_ += copied;
+    *result = Slice(scratch, copied);
+    // Keep the last bytes read for Reopen()
+    tail_.append(scratch, copied);
+    if (tail_.size() > kTailSize) {
+      tail_.erase(0, tail_.size() - kTailSize);
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus Skip(uint64_t n) override {
+    auto in_buffer = std::min<uint64_t>(n, buffer_.size() - buffer_pos_);
+    buffer_pos_ += static_cast<size_t>(in_buffer);
+    offset_ += n;
+    tail_.clear();
+    return IOStatus::OK();
+  }
+
+  // Goes on reading from *file, a newer version of the object, if the bytes
+  // read last are still in it at the same offset, i.e. if the object was
+  // appended to rather than rewritten. *file is left as is otherwise.
+  IOStatus Reopen(std::unique_ptr<CloudStorageReadableFile>* file) {
+    const IOOptions options;
+    auto st = Fill(file->get(), offset_ - tail_.size(),
+                   tail_.size() + kReadaheadSize, options, nullptr /*dbg*/);
+    if (!st.ok()) {
+      return st;
+    }
+    if (buffer_.compare(0, tail_.size(), tail_) != 0) {
+      buffer_.clear();
+      return IOStatus::Aborted("MANIFEST was rewritten");
+    }
+    buffer_pos_ = tail_.size();
+    file_ = std::move(*file);
+    return st;
+  }
+
+ private:
+  // The number of bytes that Reopen() checks
+  static constexpr size_t kTailSize = 512;
+
+  // Fills buffer_ with up to n bytes of file at offset
+  IOStatus Fill(CloudStorageReadableFile* file, uint64_t offset, size_t n,
+                const IOOptions& options, IODebugContext* dbg) {
+    std::string scratch(n, '\0');
+    Slice data;
+    FSRandomAccessFile* random_file = file;
+    auto st = random_file->Read(offset, n, options, &data, &scratch[0], dbg);
+    buffer_pos_ = 0;
+    if (!st.ok()) {
+      buffer_.clear();
+      return st;
+    }
+    buffer_.assign(data.data(), data.size());
+    return st;
+  }
+
+  std::unique_ptr<CloudStorageReadableFile> file_;
+  // The offset in the file of the next byte to return
+  uint64_t offset_ = 0;
+  std::string buffer_;
+  size_t buffer_pos_ = 0;
+  std::string tail_;
+};
+}  // namespace
+
+// The MANIFEST of a DB as read so far, to read only the records that the
+// DB appends to it next time
+struct CloudManifestReadState {
+  CloudManifestReadState(const std::string& _manifest_file,
+                         std::unique_ptr<CloudStorageReadableFile> cloud_file)
+      : manifest_file(_manifest_file), builder(false, false) {
+    file = new CloudManifestFile(std::move(cloud_file));
+    reporter.status = &status;
+    reader.reset(new log::FragmentBufferedReader(
+        nullptr,
+        std::unique_ptr<SequentialFileReader>(new SequentialFileReader(
+            std::unique_ptr<FSSequentialFile>(file), manifest_file)),
+        &reporter, true /*checksum*/, 0));
+  }
+
+  // Applies the records after the last one read
+  IOStatus ReadRecords() {
+    Slice record;
+    std::string scratch;
+    while (status.ok() && reader->ReadRecord(&record, &scratch)) {
+      VersionEdit edit;
+      status = edit.DecodeFrom(record);
+      if (status.ok()) {
+        status = builder.Apply(edit);
+      }
+    }
+    return status_to_io_status(Status(status));
+  }
+
+  const std::string manifest_file;
+  // Owned by reader
+  CloudManifestFile* file;
+  Status status;
+  VersionSet::LogReporter reporter;
+  // Keeps the fragments of a record cut by the end of the object
+  std::unique_ptr<log::FragmentBufferedReader> reader;
+  LiveFilesBuilder builder;
+};
+
 LocalManifestReader::LocalManifestReader(std::shared_ptr<Logger> info_log,
                                          CloudFileSystem* cfs)
     : info_log_(std::move(info_log)), cfs_(cfs) {}
 
 IOStatus LocalManifestReader::GetLiveFilesLocally(
-    const std::string& local_dbname, std::set<uint64_t>* list) const {
+    const std::string& local_dbname, std::set<uint64_t>* list,
+    std::unordered_map<uint64_t, LiveFileInfo>* infos,
+    std::set<uint64_t>* blob_list) const {
   auto* cfs_impl = dynamic_cast<CloudFileSystemImpl*>(cfs_);
   assert(cfs_impl);
   // cloud manifest should be set in CloudFileSystem, and it should map to local
@@ -51,7 +305,8 @@ IOStatus LocalManifestReader::GetLiveFilesLocally(
         new SequentialFileReader(std::move(file), local_manifest_file));
   }
 
-  return GetLiveFilesFromFileReader(std::move(manifest_file_reader), list);
+  return GetLiveFilesFromFileReader(std::move(manifest_file_reader), list,
+                                    infos, blob_list);
 }
 
 IOStatus LocalManifestReader::GetManifestLiveFiles(
@@ -75,9 +330,25 @@ IOStatus LocalManifestReader::GetManifestLiveFiles(
   return GetLiveFilesFromFileReader(std::move(manifest_file_reader), list);
 }
 
+IOStatus LocalManifestReader::GetManifestLiveFiles(
+    FileSystem* fs, const std::string& manifest_file, std::set<uint64_t>* list,
+    std::unordered_map<uint64_t, LiveFileInfo>* infos) const {
+  std::unique_ptr<FSSequentialFile> file;
+  auto s = fs->NewSequentialFile(manifest_file, FileOptions(), &file,
+                                 nullptr /*dbg*/);
+  if (!s.ok()) {
+    return s;
+  }
+  return GetLiveFilesFromFileReader(
+      std::unique_ptr<SequentialFileReader>(
+          new SequentialFileReader(std::move(file), manifest_file)),
+      list, infos);
+}
+
 IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
-    std::unique_ptr<SequentialFileReader> file_reader,
-    std::set<uint64_t>* list) const {
+    std::unique_ptr<SequentialFileReader> file_reader, std::set<uint64_t>* list,
+    std::unordered_map<uint64_t, LiveFileInfo>* infos,
+    std::set<uint64_t>* blob_list) const {
   Status s;
   // create a callback that gets invoked whil looping through the log records
   VersionSet::LogReporter reporter;
@@ -87,58 +358,19 @@ IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
 
   Slice record;
   std::string scratch;
-
-  // keep track of each CF's live files on each level
-  std::unordered_map<uint32_t,                // CF id
-                     std::unordered_map<int,  // level
-                                        std::unordered_set<uint64_t>>>
-      cf_live_files;
-
+  LiveFilesBuilder builder(infos != nullptr, blob_list != nullptr);
   while (reader.ReadRecord(&record, &scratch) && s.ok()) {
     VersionEdit edit;
     s = edit.DecodeFrom(record);
     if (!s.ok()) {
       break;
     }
-
-    // add the files that are added by this transaction
-    std::vector<std::pair<int, FileMetaData>> new_files = edit.GetNewFiles();
-    for (auto& one : new_files) {
-      uint64_t num = one.second.fd.GetNumber();
-      cf_live_files[edit.GetColumnFamily()][one.first].insert(num);
-    }
-    // delete the files that are removed by this transaction
-    std::set<std::pair<int, uint64_t>> deleted_files = edit.GetDeletedFiles();
-    for (auto& one : deleted_files) {
-      int level = one.first;
-      uint64_t num = one.second;
-      // Deleted files should belong to some CF
-      auto it = cf_live_files.find(edit.GetColumnFamily());
-      if ((it == cf_live_files.end()) || (it->second.count(level) == 0) ||
-          (it->second[level].count(num) == 0)) {
-        return IOStatus::Corruption(
-            "Corrupted Manifest file with unrecognized deleted file: " +
-            std::to_string(level) + "," + std::to_string(num));
-      }
-      it->second[level].erase(num);
-    }
-
-    // Removing the files from dropped CF, since we don't mark the files as
-    // deleted in Manifest when a CF is dropped,
-    if (edit.IsColumnFamilyDrop()) {
-      cf_live_files.erase(edit.GetColumnFamily());
-    }
-  }
-
-  for (auto& [cf_id, live_files] : cf_live_files) {
-    for (auto& [level, level_live_files] : live_files) {
-      (void)cf_id;
-      (void)level;
-      list->insert(level_live_files.begin(), level_live_files.end());
+    auto st = builder.Apply(edit);
+    if (!st.ok()) {
+      return st;
     }
   }
-
-  file_reader.reset();
+  builder.GetLiveFiles(list, infos, blob_list);
   return status_to_io_status(std::move(s));
 }
 
@@ -154,6 +386,16 @@ ManifestReader::ManifestReader(std::shared_ptr<Logger> info_log,
 //
 IOStatus ManifestReader::GetLiveFiles(const std::string& bucket_path,
                                       std::set<uint64_t>* list) const {
+  std::string manifest_file;
+  auto s = GetCurrentManifestFile(bucket_path, &manifest_file);
+  if (!s.ok()) {
+    return s;
+  }
+  return GetManifestLiveFilesFromCloud(manifest_file, list);
+}
+
+IOStatus ManifestReader::GetCurrentManifestFile(
+    const std::string& bucket_path, std::string* manifest_file) const {
   IOStatus s;
   std::unique_ptr<CloudManifest> cloud_manifest;
   const FileOptions file_opts;
@@ -177,20 +419,62 @@ IOStatus ManifestReader::GetLiveFiles(const std::string& bucket_path,
       return s;
     }
   }
-  std::unique_ptr<SequentialFileReader> file_reader;
-  {
-    auto manifestFile =
-        ManifestFileWithEpoch(bucket_path, cloud_manifest->GetCurrentEpoch());
-    std::unique_ptr<FSSequentialFile> file;
-    s = cfs_->NewSequentialFileCloud(bucket_prefix_, manifestFile, file_opts,
-                                     &file, dbg);
-    if (!s.ok()) {
-      return s;
-    }
-    file_reader.reset(new SequentialFileReader(std::move(file), manifestFile));
+  *manifest_file =
+      ManifestFileWithEpoch(bucket_path, cloud_manifest->GetCurrentEpoch());
+  return s;
+}
+
+IOStatus ManifestReader::GetManifestLiveFilesFromCloud(
+    const std::string& manifest_file, std::set<uint64_t>* list,
+    std::unordered_map<uint64_t, LiveFileInfo>* infos) const {
+  std::unique_ptr<CloudStorageReadableFile> file;
+  auto s = cfs_->GetStorageProvider()->NewCloudReadableFile(
+      bucket_prefix_, manifest_file, FileOptions(), &file, nullptr /*dbg*/);
+  if (!s.ok()) {
+    return s;
   }
+  return GetLiveFilesFromFileReader(
+      std::unique_ptr<SequentialFileReader>(new SequentialFileReader(
+          std::make_unique<CloudManifestFile>(std::move(file)),
+          manifest_file)),
+      list, infos);
+}
 
-  return GetLiveFilesFromFileReader(std::move(file_reader), list);
+IOStatus ManifestReader::GetManifestLiveFilesIncrementally(
+    const std::string& manifest_file,
+    std::shared_ptr<CloudManifestReadState>* state,
+    std::vector<uint64_t>* list) const {
+  std::unique_ptr<CloudStorageReadableFile> file;
+  auto s = cfs_->GetStorageProvider()->NewCloudReadableFile(
+      bucket_prefix_, manifest_file, FileOptions(), &file, nullptr /*dbg*/);
+  if (!s.ok()) {
+    state->reset();
+    return s;
+  }
+  bool resumed = false;
+  if (*state && (*state)->manifest_file == manifest_file) {
+    s = (*state)->file->Reopen(&file);
+    if (s.ok()) {
+      (*state)->reader->UnmarkEOF();
+      resumed = true;
+    } else {
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
+          "[pg] Reading MANIFEST %s from the start: %s", manifest_file.c_str(),
+          s.ToString().c_str());
+    }
+  }
+  if (!resumed) {
+    state->reset(new CloudManifestReadState(manifest_file, std::move(file)));
+  }
+  s = (*state)->ReadRecords();
+  if (!s.ok()) {
+    state->reset();
+    return s;
+  }
+  std::set<uint64_t> live_files;
+  (*state)->builder.GetLiveFiles(&live_files, nullptr, nullptr);
+  list->assign(live_files.begin(), live_files.end());
+  return s;
 }
 
 IOStatus ManifestReader::GetMaxFileNumberFromManifest(FileSystem* fs,
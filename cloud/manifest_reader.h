@@ -3,14 +3,20 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "rocksdb/advanced_options.h"
 #include "rocksdb/io_status.h"
+#include "table/unique_id_impl.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 class CloudFileSystem;
+struct CloudManifestReadState;
 class FileSystem;
 class Logger;
 class SequentialFileReader;
@@ -18,6 +24,17 @@ class SequentialFileReader;
 // Operates on MANIFEST files stored locally
 class LocalManifestReader {
  public:
+  // Where a live SST file sits in the LSM tree
+  struct LiveFileInfo {
+    int level;
+    uint64_t file_size;
+    Temperature temperature;
+    // Identify the contents of the file whatever its name: null and empty
+    // if unknown
+    UniqueId64x2 unique_id;
+    std::string file_checksum;
+  };
+
   LocalManifestReader(std::shared_ptr<Logger> info_log, CloudFileSystem* cfs);
 
   // Retrive all live files by reading manifest files locally.
@@ -26,8 +43,16 @@ class LocalManifestReader {
   // REQUIRES: cfs_ should have cloud_manifest_ set, and it should have the
   // same content as the CLOUDMANIFEST file stored locally. cloud_manifest_ is
   // not updated when calling the function
-  IOStatus GetLiveFilesLocally(const std::string& local_dbname,
-                               std::set<uint64_t>* list) const;
+  //
+  // If infos is not null, it is filled with the level, size and temperature
+  // of every live file.
+  // If blob_list is not null, it is filled with the numbers of the blob files
+  // that may be live: the ones added and not entirely garbage yet. A blob
+  // file that the DB dropped without it being entirely garbage is in it too.
+  IOStatus GetLiveFilesLocally(
+      const std::string& local_dbname, std::set<uint64_t>* list,
+      std::unordered_map<uint64_t, LiveFileInfo>* infos = nullptr,
+      std::set<uint64_t>* blob_list = nullptr) const;
 
   // Read given local manifest file and return all live files that it
   // references. This doesn't rely on CLOUDMANIFEST and just accepts (any valid)
@@ -38,12 +63,22 @@ class LocalManifestReader {
   IOStatus GetManifestLiveFiles(const std::string& manifest_file,
                                 std::set<uint64_t>* list) const;
 
+  // Like GetManifestLiveFiles(), but reads manifest_file from fs as is, e.g.
+  // a copy of a MANIFEST under a name the cloud file system does not know.
+  // If infos is not null, it is filled like in GetLiveFilesLocally().
+  IOStatus GetManifestLiveFiles(
+      FileSystem* fs, const std::string& manifest_file,
+      std::set<uint64_t>* list,
+      std::unordered_map<uint64_t, LiveFileInfo>* infos = nullptr) const;
+
  protected:
   // Get all the live SST file numbers by reading version_edit records from
   // file_reader
   IOStatus GetLiveFilesFromFileReader(
       std::unique_ptr<SequentialFileReader> file_reader,
-      std::set<uint64_t>* list) const;
+      std::set<uint64_t>* list,
+      std::unordered_map<uint64_t, LiveFileInfo>* infos = nullptr,
+      std::set<uint64_t>* blob_list = nullptr) const;
 
   std::shared_ptr<Logger> info_log_;
   CloudFileSystem* cfs_;
@@ -64,6 +99,26 @@ class ManifestReader : public LocalManifestReader {
   IOStatus GetLiveFiles(const std::string& bucket_path,
                         std::set<uint64_t>* list) const;
 
+  // The two halves of GetLiveFiles: reads the CLOUDMANIFEST of bucket_path
+  // to find the path of its current MANIFEST, then the live files of that
+  // MANIFEST. Lets the caller skip MANIFESTs it has already read.
+  IOStatus GetCurrentManifestFile(const std::string& bucket_path,
+                                  std::string* manifest_file) const;
+  IOStatus GetManifestLiveFilesFromCloud(
+      const std::string& manifest_file, std::set<uint64_t>* list,
+      std::unordered_map<uint64_t, LiveFileInfo>* infos = nullptr) const;
+
+  // Like GetManifestLiveFilesFromCloud(), but sets *list to the sorted
+  // numbers of the live files, and reads only the records appended to
+  // manifest_file since *state was left if it was read from the same
+  // MANIFEST and the DB only appended to it. Otherwise the MANIFEST is read
+  // from the start. *state is left where the MANIFEST was read up to, or
+  // reset on error.
+  IOStatus GetManifestLiveFilesIncrementally(
+      const std::string& manifest_file,
+      std::shared_ptr<CloudManifestReadState>* state,
+      std::vector<uint64_t>* list) const;
+
   static IOStatus GetMaxFileNumberFromManifest(FileSystem* fs,
                                                const std::string& fname,
                                                uint64_t* maxFileNumber);
@@ -4,9 +4,12 @@
 #include "cloud/purge.h"
 
 #include <chrono>
-#include <set>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "cloud/cloud_transfer_executor.h"
 #include "cloud/db_cloud_impl.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
@@ -68,11 +71,51 @@ void CloudFileSystemImpl::Purger() {
   }
 }
 
+IOStatus CloudFileSystemImpl::GetPurgerLiveFiles(
+    const std::string& bucket_name_prefix, const std::string& dbid,
+    const std::string& db_path, std::vector<uint64_t>* live_files) {
+  ManifestReader extractor(info_log_, this, bucket_name_prefix);
+  PurgerManifest manifest;
+  auto st = extractor.GetCurrentManifestFile(db_path, &manifest.manifest_file);
+  if (!st.ok()) {
+    return st;
+  }
+  CloudObjectInformation info;
+  st = GetStorageProvider()->GetCloudObjectMetadata(
+      bucket_name_prefix, manifest.manifest_file, &info);
+  if (!st.ok()) {
+    return st;
+  }
+  manifest.size = info.size;
+  manifest.modification_time = info.modification_time;
+  {
+    std::lock_guard<std::mutex> lk(purger_manifests_mutex_);
+    auto it = purger_manifests_.find(dbid);
+    if (it != purger_manifests_.end()) {
+      if (it->second.manifest_file == manifest.manifest_file &&
+          it->second.size == manifest.size &&
+          it->second.modification_time == manifest.modification_time) {
+        *live_files = it->second.live_files;
+        return st;
+      }
+      // Only one run of the purger at a time reads the MANIFEST of a DB
+      manifest.read_state = std::move(it->second.read_state);
+    }
+  }
+  st = extractor.GetManifestLiveFilesIncrementally(
+      manifest.manifest_file, &manifest.read_state, &manifest.live_files);
+  if (!st.ok()) {
+    return st;
+  }
+  *live_files = manifest.live_files;
+  std::lock_guard<std::mutex> lk(purger_manifests_mutex_);
+  purger_manifests_[dbid] = std::move(manifest);
+  return st;
+}
+
 IOStatus CloudFileSystemImpl::FindObsoleteFiles(
     const std::string& bucket_name_prefix,
     std::vector<std::string>* pathnames) {
-  std::set<std::string> live_files;
-
   // fetch list of all registered dbids
   DbidList dbid_list;
   auto st = GetDbidList(bucket_name_prefix, &dbid_list);
@@ -93,67 +136,110 @@ IOStatus CloudFileSystemImpl::FindObsoleteFiles(
     return st;
   }
 
-  std::unique_ptr<ManifestReader> extractor(
-      new ManifestReader(info_log_, this, bucket_name_prefix));
-
-  // Step2: from all MANIFEST files in Step 1, compile a list of all live files
-  for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
-    std::unique_ptr<SequentialFile> result;
-    std::set<uint64_t> file_nums;
-    st = extractor->GetLiveFiles(iter->second, &file_nums);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-          "[pg] dbid %s extracted files from path %s %s", iter->first.c_str(),
-          iter->second.c_str(), st.ToString().c_str());
-    } else {
-      // This file can reside either in this leaf db's path or reside in any of
-      // the parent db's paths. Compute all possible paths and insert them into
-      // live_files
-      for (auto it = file_nums.begin(); it != file_nums.end(); ++it) {
-        // list of all parent dbids
-        const std::vector<std::string>& parent_dbids = parents[iter->first];
-
-        for (const auto& db : parent_dbids) {
-          // parent db's paths
-          const std::string& parent_path = dbid_list[db];
-          live_files.insert(MakeTableFileName(parent_path, *it));
-        }
+  std::vector<DbidList::const_iterator> dbids;
+  dbids.reserve(dbid_list.size());
+  for (auto iter = dbid_list.cbegin(); iter != dbid_list.cend(); ++iter) {
+    dbids.push_back(iter);
+  }
+  {
+    // Forget the DBs that are gone
+    std::lock_guard<std::mutex> lk(purger_manifests_mutex_);
+    for (auto it = purger_manifests_.begin(); it != purger_manifests_.end();) {
+      if (dbid_list.count(it->first) == 0) {
+        it = purger_manifests_.erase(it);
+      } else {
+        ++it;
       }
     }
   }
+  const size_t parallelism = transfer_executor_->GetMaxRunning(
+      CloudTransferExecutor::kPurge);
 
-  // Get all files from all dbpaths in this bucket
-  std::vector<std::string> all_files;
-
-  // Scan all the db directories in this bucket. Retrieve the list
-  // of files in all these db directories.
-  for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
-    std::unique_ptr<SequentialFile> result;
-    std::string mpath = iter->second;
-
-    std::vector<std::string> objects;
-    st = GetStorageProvider()->ListCloudObjects(bucket_name_prefix, mpath,
-                                                &objects);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-          "[pg] Unable to list objects in bucketprefix %s path_prefix %s. %s",
-          bucket_name_prefix.c_str(), mpath.c_str(), st.ToString().c_str());
-    }
-    for (auto& o : objects) {
-      all_files.push_back(mpath + "/" + o);
-    }
+  // Step2: from the MANIFESTs of all dbids, compile the numbers of the live
+  // files of every db path. A file can reside either in this leaf db's path
+  // or in any of the parent db's paths.
+  std::unordered_map<std::string, std::unordered_set<uint64_t>> live_files;
+  std::mutex live_files_mutex;
+  st = transfer_executor_->RunAll(
+      CloudTransferExecutor::kPurge, dbids.size(),
+      [&](size_t idx) {
+        const auto& dbid = dbids[idx]->first;
+        std::vector<uint64_t> file_nums;
+        auto s = GetPurgerLiveFiles(bucket_name_prefix, dbid,
+                                    dbids[idx]->second, &file_nums);
+        if (!s.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[pg] dbid %s extracted files from path %s %s", dbid.c_str(),
+              dbids[idx]->second.c_str(), s.ToString().c_str());
+          return s;
+        }
+        auto parent_dbids = parents.find(dbid);
+        if (parent_dbids == parents.end()) {
+          return s;
+        }
+        std::lock_guard<std::mutex> lk(live_files_mutex);
+        for (const auto& db : parent_dbids->second) {
+          auto parent = dbid_list.find(db);
+          if (parent != dbid_list.end()) {
+            auto& path_live_files = live_files[parent->second];
+            path_live_files.insert(file_nums.begin(), file_nums.end());
+          }
+        }
+        return s;
+      },
+      parallelism);
+  if (!st.ok()) {
+    // The files of an unreadable MANIFEST could be anywhere in its parents'
+    // paths, nothing can be deemed obsolete
+    return st;
   }
 
-  // If a file does not belong to live_files, then it can be deleted
-  for (const auto& candidate : all_files) {
-    if (live_files.find(candidate) == live_files.end() &&
-        ends_with(candidate, ".sst")) {
-      Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
-          "[pg] bucket prefix %s path %s marked for deletion",
-          bucket_name_prefix.c_str(), candidate.c_str());
-      pathnames->push_back(candidate);
-    }
-  }
+  // Scan all the db directories in this bucket. A file that is not live in
+  // its db path can be deleted.
+  std::mutex pathnames_mutex;
+  transfer_executor_
+      ->RunAll(
+          CloudTransferExecutor::kPurge, dbids.size(),
+          [&](size_t idx) {
+            const std::string& mpath = dbids[idx]->second;
+            auto it = live_files.find(mpath);
+            auto s = GetStorageProvider()->ListCloudObjectsInBatches(
+                bucket_name_prefix, mpath,
+                [&](const std::vector<std::string>& objects) {
+                  for (auto& o : objects) {
+                    auto noepoch = RemoveEpoch(o);
+                    uint64_t num;
+                    FileType type;
+                    // Data objects can be in a shard directory
+                    if (!ends_with(o, ".sst") ||
+                        !ParseFileName(basename(noepoch), &num, &type) ||
+                        type != kTableFile) {
+                      continue;
+                    }
+                    if (it != live_files.end() && it->second.count(num) > 0) {
+                      continue;
+                    }
+                    auto candidate = mpath + "/" + o;
+                    Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+                        "[pg] bucket prefix %s path %s marked for deletion",
+                        bucket_name_prefix.c_str(), candidate.c_str());
+                    std::lock_guard<std::mutex> lk(pathnames_mutex);
+                    pathnames->push_back(std::move(candidate));
+                  }
+                  return IOStatus::OK();
+                });
+            if (!s.ok()) {
+              Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+                  "[pg] Unable to list objects in bucketprefix %s "
+                  "path_prefix %s. %s",
+                  bucket_name_prefix.c_str(), mpath.c_str(),
+                  s.ToString().c_str());
+              // Go on with the other paths
+            }
+            return IOStatus::OK();
+          },
+          parallelism)
+      .PermitUncheckedError();
   return IOStatus::OK();
 }
 
@@ -163,24 +249,39 @@ IOStatus CloudFileSystemImpl::FindObsoleteDbid(
   // fetch list of all registered dbids
   DbidList dbid_list;
   auto st = GetDbidList(bucket_name_prefix, &dbid_list);
+  if (!st.ok()) {
+    return st;
+  }
+  std::vector<DbidList::const_iterator> dbids;
+  dbids.reserve(dbid_list.size());
+  for (auto iter = dbid_list.cbegin(); iter != dbid_list.cend(); ++iter) {
+    dbids.push_back(iter);
+  }
 
   // loop though all dbids. If the pathname does not exist in the bucket, then
   // this dbid is a candidate for deletion.
-  if (st.ok()) {
-    for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
-      std::unique_ptr<SequentialFile> result;
-      std::string path = CloudManifestFile(iter->second);
-      st = GetStorageProvider()->ExistsCloudObject(GetDestBucketName(), path);
-      // this dbid can be cleaned up
-      if (st.IsNotFound()) {
-        to_delete_list->push_back(iter->first);
-
-        Log(InfoLogLevel::WARN_LEVEL, info_log_,
-            "[pg] dbid %s non-existent dbpath %s scheduled for deletion",
-            iter->first.c_str(), iter->second.c_str());
-        // We don't want to fail the final call
-        st = IOStatus::OK();
-      }
+  std::vector<char> obsolete(dbids.size(), false);
+  st = transfer_executor_->RunAll(
+      CloudTransferExecutor::kPurge, dbids.size(),
+      [&](size_t idx) {
+        std::string path = CloudManifestFile(dbids[idx]->second);
+        auto s =
+            GetStorageProvider()->ExistsCloudObject(GetDestBucketName(), path);
+        // this dbid can be cleaned up
+        if (s.IsNotFound()) {
+          obsolete[idx] = true;
+          // We don't want to fail the final call
+          return IOStatus::OK();
+        }
+        return s;
+      },
+      transfer_executor_->GetMaxRunning(CloudTransferExecutor::kPurge));
+  for (size_t i = 0; i < dbids.size(); i++) {
+    if (obsolete[i]) {
+      to_delete_list->push_back(dbids[i]->first);
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[pg] dbid %s non-existent dbpath %s scheduled for deletion",
+          dbids[i]->first.c_str(), dbids[i]->second.c_str());
     }
   }
   return st;
@@ -197,73 +298,115 @@ IOStatus CloudFileSystemImpl::extractParents(
   std::srand(static_cast<unsigned int>(std::time(0)));
   const std::string random = std::to_string(std::rand());
   const std::string scratch(SCRATCH_LOCAL_DIR);
-  IOStatus st;
-  for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
-    // download IDENTITY
-    std::string cloudfile = iter->second + "/IDENTITY";
-    std::string localfile = scratch + "/.rockset_IDENTITY." + random;
-    st = GetStorageProvider()->GetCloudObject(bucket_name_prefix, cloudfile,
-                                              localfile);
-    if (!st.ok() && !st.IsNotFound()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-          "[pg] Unable to download IDENTITY file from "
-          "bucket %s. %s. Aborting...",
-          bucket_name_prefix.c_str(), st.ToString().c_str());
-      return st;
-    } else if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-          "[pg] Unable to download IDENTITY file from "
-          "bucket %s. %s. Skipping...",
-          bucket_name_prefix.c_str(), st.ToString().c_str());
-      continue;
-    }
 
-    // Read the dbid from the ID file
-    std::string all_dbid;
-    st = ReadFileToString(base_fs_.get(), localfile, &all_dbid);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_, "[pg] Unable to read %s %s",
-          localfile.c_str(), st.ToString().c_str());
-      return st;
+  // The IDENTITY of a DB never changes: only the dbids that are new, or
+  // that moved to another path, are read
+  std::vector<DbidList::const_iterator> dbids;
+  {
+    std::lock_guard<std::mutex> lk(purger_manifests_mutex_);
+    for (auto it = purger_parents_.begin(); it != purger_parents_.end();) {
+      if (dbid_list.count(it->first) == 0) {
+        it = purger_parents_.erase(it);
+      } else {
+        ++it;
+      }
     }
-    st = base_fs_->DeleteFile(localfile, IOOptions(), nullptr /*dbg*/);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, info_log_, "[pg] Unable to delete %s %s",
-          localfile.c_str(), st.ToString().c_str());
-      return st;
+    for (auto iter = dbid_list.cbegin(); iter != dbid_list.cend(); ++iter) {
+      auto it = purger_parents_.find(iter->first);
+      if (it != purger_parents_.end() && it->second.first == iter->second) {
+        if (!it->second.second.empty()) {
+          (*parents)[iter->first] = it->second.second;
+        }
+      } else {
+        dbids.push_back(iter);
+      }
     }
+  }
 
-    // all_dbids is of the form 1x45-555rockset678a-6577rockset7789-9aef
-    all_dbid = rtrim_if(trim(all_dbid), '\n');
+  std::mutex parents_mutex;
+  auto st = transfer_executor_->RunAll(
+      CloudTransferExecutor::kPurge, dbids.size(),
+      [&](size_t idx) {
+        auto iter = dbids[idx];
+        // download IDENTITY
+        std::string cloudfile = iter->second + "/IDENTITY";
+        std::string localfile = scratch + "/.rockset_IDENTITY." + random +
+                                "." + std::to_string(idx);
+        auto s = GetStorageProvider()->GetCloudObject(bucket_name_prefix,
+                                                      cloudfile, localfile);
+        if (!s.ok() && !s.IsNotFound()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[pg] Unable to download IDENTITY file from "
+              "bucket %s. %s. Aborting...",
+              bucket_name_prefix.c_str(), s.ToString().c_str());
+          return s;
+        } else if (!s.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[pg] Unable to download IDENTITY file from "
+              "bucket %s. %s. Skipping...",
+              bucket_name_prefix.c_str(), s.ToString().c_str());
+          return IOStatus::OK();
+        }
 
-    // We want to return parents[1x45-555] = [678a-6577, 7789-9aef]
-    std::vector<std::string> parent_dbids;
-    size_t start = 0, end = 0;
-    while (end != std::string::npos) {
-      end = all_dbid.find(delimiter, start);
+        // Read the dbid from the ID file
+        std::string all_dbid;
+        s = ReadFileToString(base_fs_.get(), localfile, &all_dbid);
+        if (!s.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[pg] Unable to read %s %s", localfile.c_str(),
+              s.ToString().c_str());
+          return s;
+        }
+        s = base_fs_->DeleteFile(localfile, IOOptions(), nullptr /*dbg*/);
+        if (!s.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+              "[pg] Unable to delete %s %s", localfile.c_str(),
+              s.ToString().c_str());
+          return s;
+        }
 
-      // If at end, use length=maxLength.  Else use length=end-start.
-      parent_dbids.push_back(all_dbid.substr(
-          start, (end == std::string::npos) ? std::string::npos : end - start));
+        // all_dbids is of the form 1x45-555rockset678a-6577rockset7789-9aef
+        all_dbid = rtrim_if(trim(all_dbid), '\n');
 
-      // If at end, use start=maxSize.  Else use start=end+delimiter.
-      start = ((end > (std::string::npos - delimiter.size()))
-                   ? std::string::npos
-                   : end + delimiter.size());
-    }
-    if (parent_dbids.size() > 0) {
-      std::string leaf_dbid = parent_dbids[parent_dbids.size() - 1];
-      // Verify that the leaf dbid matches the one that we retrived from
-      // CloudFileSystem
-      if (leaf_dbid != iter->first) {
-        Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-            "[pg] The IDENTITY file for dbid '%s' contains leaf dbid as '%s'",
-            iter->first.c_str(), leaf_dbid.c_str());
-        return st;
-      }
-      (*parents)[leaf_dbid] = parent_dbids;
-    }
-  }
+        // We want to return parents[1x45-555] = [678a-6577, 7789-9aef]
+        std::vector<std::string> parent_dbids;
+        size_t start = 0, end = 0;
+        while (end != std::string::npos) {
+          end = all_dbid.find(delimiter, start);
+
+          // If at end, use length=maxLength.  Else use length=end-start.
+          parent_dbids.push_back(all_dbid.substr(
+              start,
+              (end == std::string::npos) ? std::string::npos : end - start));
+
+          // If at end, use start=maxSize.  Else use start=end+delimiter.
+          start = ((end > (std::string::npos - delimiter.size()))
+                       ? std::string::npos
+                       : end + delimiter.size());
+        }
+        if (parent_dbids.size() > 0) {
+          std::string leaf_dbid = parent_dbids[parent_dbids.size() - 1];
+          // Verify that the leaf dbid matches the one that we retrived from
+          // CloudFileSystem
+          if (leaf_dbid != iter->first) {
+            Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+                "[pg] The IDENTITY file for dbid '%s' contains leaf dbid as "
+                "'%s'",
+                iter->first.c_str(), leaf_dbid.c_str());
+            return s;
+          }
+        }
+        {
+          std::lock_guard<std::mutex> lk(purger_manifests_mutex_);
+          purger_parents_[iter->first] = {iter->second, parent_dbids};
+        }
+        if (parent_dbids.size() > 0) {
+          std::lock_guard<std::mutex> lk(parents_mutex);
+          (*parents)[iter->first] = std::move(parent_dbids);
+        }
+        return s;
+      },
+      transfer_executor_->GetMaxRunning(CloudTransferExecutor::kPurge));
   return st;
 }
 
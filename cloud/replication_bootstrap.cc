@@ -0,0 +1,175 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#ifndef ROCKSDB_LITE
+#include "rocksdb/cloud/replication_bootstrap.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+class ReplicationBootstrapImpl : public ReplicationBootstrap {
+ public:
+  explicit ReplicationBootstrapImpl(ReplicationBootstrapOptions options)
+      : options_(std::move(options)) {}
+
+  ~ReplicationBootstrapImpl() override {
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    if (!handed_over_ && db_ != nullptr) {
+      for (auto h : handles_) {
+        db_->DestroyColumnFamilyHandle(h);
+      }
+      delete db_;
+    }
+  }
+
+  void Start(Options options, std::string dbname,
+             std::vector<ColumnFamilyDescriptor> column_families,
+             std::string persistent_cache_path,
+             uint64_t persistent_cache_size_gb) {
+    thread_ = std::thread([this, options, dbname, column_families,
+                           persistent_cache_path, persistent_cache_size_gb] {
+      std::vector<ColumnFamilyHandle*> handles;
+      DBCloud* db = nullptr;
+      std::string persisted_sequence;
+      auto s = DBCloud::Open(options, dbname, column_families,
+                             persistent_cache_path, persistent_cache_size_gb,
+                             &handles, &db);
+      if (s.ok()) {
+        s = db->GetPersistedReplicationSequence(&persisted_sequence);
+      }
+      std::lock_guard<std::mutex> lk(mutex_);
+      status_ = s;
+      db_ = db;
+      handles_ = std::move(handles);
+      persisted_sequence_ = std::move(persisted_sequence);
+      skipping_ = !persisted_sequence_.empty();
+      opened_ = true;
+      cv_.notify_all();
+    });
+  }
+
+  Status AddRecord(ReplicationLogRecord record,
+                   std::string replication_sequence,
+                   DB::ApplyReplicationLogRecordInfo* info) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!status_.ok()) {
+      return status_;
+    }
+    if (!handed_over_) {
+      auto size = record.GetContents().size();
+      if (options_.max_buffered_bytes > 0 && !buffered_.empty() &&
+          buffered_bytes_ + size > options_.max_buffered_bytes) {
+        return Status::Busy("Replication tail buffer is full");
+      }
+      buffered_bytes_ += size;
+      buffered_.emplace_back(std::move(record),
+                             std::move(replication_sequence));
+      return Status::OK();
+    }
+    if (SkipRecord(replication_sequence)) {
+      return Status::OK();
+    }
+    status_ = db_->ApplyReplicationLogRecord(
+        std::move(record), std::move(replication_sequence),
+        options_.cf_options_factory, options_.snapshot_replication_epoch,
+        info, options_.apply_flags);
+    return status_;
+  }
+
+  Status WaitForOpen(DB::ApplyReplicationLogRecordInfo* info,
+                     std::vector<ColumnFamilyHandle*>* handles,
+                     DBCloud** dbptr) override {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return opened_; });
+    if (handed_over_) {
+      return Status::InvalidArgument("The DB was already handed over");
+    }
+    if (!status_.ok()) {
+      return status_;
+    }
+    std::vector<DB::ReplicationLogRecordAndSequence> records;
+    records.reserve(buffered_.size());
+    for (auto& record : buffered_) {
+      if (!SkipRecord(record.second)) {
+        records.push_back(std::move(record));
+      }
+    }
+    buffered_.clear();
+    buffered_bytes_ = 0;
+    status_ = db_->ApplyReplicationLogRecords(
+        std::move(records), options_.cf_options_factory,
+        options_.snapshot_replication_epoch, info, options_.apply_flags,
+        nullptr /* num_applied */);
+    if (!status_.ok()) {
+      return status_;
+    }
+    handed_over_ = true;
+    *handles = std::move(handles_);
+    *dbptr = db_;
+    return Status::OK();
+  }
+
+  uint64_t GetNumSkippedRecords() const override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return num_skipped_;
+  }
+
+ private:
+  // REQUIRES: mutex_ held, the snapshot is opened
+  bool SkipRecord(const std::string& replication_sequence) {
+    if (!skipping_) {
+      return false;
+    }
+    if (replication_sequence == persisted_sequence_) {
+      skipping_ = false;
+    }
+    ++num_skipped_;
+    return true;
+  }
+
+  const ReplicationBootstrapOptions options_;
+  std::thread thread_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  // Set by the open thread
+  bool opened_ = false;
+  Status status_;
+  DBCloud* db_ = nullptr;
+  std::vector<ColumnFamilyHandle*> handles_;
+  std::string persisted_sequence_;
+
+  // True until the record of persisted_sequence_ is seen
+  bool skipping_ = false;
+  uint64_t num_skipped_ = 0;
+  bool handed_over_ = false;
+  std::vector<DB::ReplicationLogRecordAndSequence> buffered_;
+  uint64_t buffered_bytes_ = 0;
+};
+}  // namespace
+
+Status ReplicationBootstrap::Start(
+    const Options& options, const std::string& dbname,
+    const std::vector<ColumnFamilyDescriptor>& column_families,
+    const std::string& persistent_cache_path, uint64_t persistent_cache_size_gb,
+    ReplicationBootstrapOptions bootstrap_options,
+    std::unique_ptr<ReplicationBootstrap>* result) {
+  if (options.replication_log_listener) {
+    return Status::InvalidArgument(
+        "A follower can't have a replication_log_listener");
+  }
+  std::unique_ptr<ReplicationBootstrapImpl> bootstrap(
+      new ReplicationBootstrapImpl(std::move(bootstrap_options)));
+  bootstrap->Start(options, dbname, column_families, persistent_cache_path,
+                   persistent_cache_size_gb);
+  *result = std::move(bootstrap);
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
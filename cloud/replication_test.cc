@@ -51,6 +51,15 @@ class Listener : public ReplicationLogListener {
       return "";
     }
     assert(state_ == TAILING);
+    if (!record.pinned_contents.empty() && !record.pinned_buffer) {
+      // Only valid during the call. Keep a copy that the follower applies
+      // in place, as it would a network buffer.
+      auto buffer =
+          std::make_shared<std::string>(record.pinned_contents.ToString());
+      record.pinned_contents = Slice(*buffer);
+      record.pinned_buffer = std::move(buffer);
+      ++num_pinned_records_;
+    }
     {
       MutexLock lock(log_records_mutex_);
       std::string replication_sequence;
@@ -63,11 +72,21 @@ class Listener : public ReplicationLogListener {
 
   void UpdateEpoch(uint64_t epoch) { epoch_ = epoch; }
 
+  bool AcceptsPinnedContents() const override {
+    return accept_pinned_contents_;
+  }
+  void setAcceptPinnedContents(bool accept) {
+    accept_pinned_contents_ = accept;
+  }
+  size_t numPinnedRecords() const { return num_pinned_records_; }
+
  private:
   port::Mutex* log_records_mutex_;
   LogRecordsVector* log_records_;
   State state_{OPEN};
   uint64_t epoch_{0};
+  bool accept_pinned_contents_{false};
+  std::atomic<size_t> num_pinned_records_{0};
 };
 
 class FollowerEnv : public EnvWrapper {
@@ -218,6 +237,13 @@ class ReplicationTest : public testing::Test {
   //
   // Returns the number of log records applied
   size_t catchUpFollower(std::optional<size_t> num_records = std::nullopt);
+  // Catches up follower until end of log with a single
+  // ApplyReplicationLogRecords() call
+  //
+  // Returns the number of log records applied
+  size_t catchUpFollowerInBatch();
+  // Tracks the column families created and dropped by the applied records
+  void updateFollowerColumnFamilies(DB::ApplyReplicationLogRecordInfo* info);
 
   WriteOptions wo() const {
     WriteOptions w;
@@ -345,8 +371,11 @@ class ReplicationTest : public testing::Test {
     listener_->UpdateEpoch(epoch);
   }
 
+  size_t numPinnedRecords() const { return listener_->numPinnedRecords(); }
+
   std::shared_ptr<Logger> info_log_;
   bool replicate_epoch_number_{true};
+  bool accept_pinned_contents_{false};
   bool consistency_check_on_epoch_replication{true};
   void resetFollowerSequence(int new_seq) { followerSequence_ = new_seq; }
 
@@ -394,6 +423,7 @@ DB* ReplicationTest::openLeader(Options options, uint64_t snapshot_replication_e
   }
 
   listener_ = std::make_shared<Listener>(&log_records_mutex_, &log_records_);
+  listener_->setAcceptPinnedContents(accept_pinned_contents_);
   options.replication_log_listener = listener_;
 
   listener_->setState(firstOpen ? Listener::TAILING : Listener::OPEN);
@@ -495,12 +525,36 @@ size_t ReplicationTest::catchUpFollower(std::optional<size_t> num_records) {
     assert(s.ok());
     ++ret;
   }
-  for (auto& cf : info.added_column_families) {
+  updateFollowerColumnFamilies(&info);
+  return ret;
+}
+
+size_t ReplicationTest::catchUpFollowerInBatch() {
+  MutexLock lock(&log_records_mutex_);
+  DB::ApplyReplicationLogRecordInfo info;
+  std::vector<DB::ReplicationLogRecordAndSequence> records(
+      log_records_.begin() + followerSequence_, log_records_.end());
+  size_t ret = 0;
+  auto s = follower_db_->ApplyReplicationLogRecords(
+      std::move(records),
+      [this](Slice) {
+        return ColumnFamilyOptions(follower_db_->GetOptions());
+      },
+      snapshot_replication_epoch_, &info, DB::AR_EVICT_OBSOLETE_FILES, &ret);
+  assert(s.ok());
+  followerSequence_ += static_cast<int>(ret);
+  updateFollowerColumnFamilies(&info);
+  return ret;
+}
+
+void ReplicationTest::updateFollowerColumnFamilies(
+    DB::ApplyReplicationLogRecordInfo* info) {
+  for (auto& cf : info->added_column_families) {
     auto inserted =
         follower_cfs_.try_emplace(cf->GetName(), std::move(cf)).second;
     assert(inserted);
   }
-  for (auto& d : info.deleted_column_families) {
+  for (auto& d : info->deleted_column_families) {
     bool found = false;
     for (auto& [name, cf] : follower_cfs_) {
       if (cf->GetID() == d) {
@@ -511,7 +565,6 @@ size_t ReplicationTest::catchUpFollower(std::optional<size_t> num_records) {
     }
     assert(found);
   }
-  return ret;
 }
 
 void ReplicationTest::createColumnFamily(std::string name) {
@@ -638,6 +691,194 @@ TEST_F(ReplicationTest, Simple) {
   EXPECT_EQ(leaderManifestUpdateSeq, 14);
 }
 
+TEST_F(ReplicationTest, ApplyRecordsInBatch) {
+  auto leader = openLeader();
+  openFollower();
+
+  createColumnFamily("cf1");
+  for (int i = 0; i < 100; ++i) {
+    auto key = "key" + std::to_string(i);
+    ASSERT_OK(leader->Put(wo(), key, "val"));
+    ASSERT_OK(leader->Put(wo(), leaderCF("cf1"), key, "val1"));
+    if (i % 30 == 29) {
+      ASSERT_OK(leader->Flush(FlushOptions()));
+    }
+  }
+  ASSERT_OK(leader->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_OK(leader->Put(wo(), "tail", "val"));
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+
+  // Memtable writes, memtable switches and manifest writes in one call
+  EXPECT_GT(catchUpFollowerInBatch(), 0);
+  verifyEqual();
+
+  // Nothing left to apply
+  EXPECT_EQ(catchUpFollowerInBatch(), 0);
+  ASSERT_OK(leader->Put(wo(), "key0", "val2"));
+  EXPECT_EQ(catchUpFollowerInBatch(), 1);
+  verifyEqual();
+}
+
+TEST_F(ReplicationTest, ConcurrentMemtableApply) {
+  auto leader = openLeader();
+  auto options = leaderOptions();
+  options.replication_apply_threads = 4;
+  auto follower = openFollower(options);
+
+  createColumnFamily("cf1");
+  for (int i = 0; i < 1000; ++i) {
+    auto key = "key" + std::to_string(i % 300);
+    ASSERT_OK(leader->Put(wo(), key, std::to_string(i)));
+    ASSERT_OK(leader->Put(wo(), leaderCF("cf1"), key, std::to_string(i)));
+    if (i % 400 == 399) {
+      ASSERT_OK(leader->Flush(FlushOptions()));
+    }
+  }
+  ASSERT_OK(leader->Delete(wo(), "key1"));
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+
+  EXPECT_GT(catchUpFollowerInBatch(), 0);
+  verifyEqual();
+  std::string val;
+  ASSERT_TRUE(follower->Get(ReadOptions(), "key1", &val).IsNotFound());
+  ASSERT_OK(follower->Get(ReadOptions(), "key299", &val));
+  EXPECT_EQ(val, "899");
+}
+
+TEST_F(ReplicationTest, PipelinedWrite) {
+  auto options = leaderOptions();
+  options.enable_pipelined_write = true;
+  auto leader = openLeader(options);
+  openFollower();
+
+  createColumnFamily("cf1");
+
+  constexpr auto kThreadCount = 4;
+  constexpr auto kWritesPerThread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kWritesPerThread; ++i) {
+        WriteBatch wb;
+        auto key = "key" + std::to_string(t) + "_" + std::to_string(i % 500);
+        ASSERT_OK(wb.Put(key, std::to_string(i)));
+        ASSERT_OK(wb.Put(leaderCF("cf1"), key, std::to_string(i)));
+        ASSERT_OK(leader->Write(wo(), &wb));
+      }
+    });
+  }
+  // Memtable switches in between the pipelined writes
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_OK(leader->Flush(FlushOptions()));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+
+  catchUpFollower();
+  verifyEqual();
+}
+
+TEST_F(ReplicationTest, PinnedContents) {
+  accept_pinned_contents_ = true;
+  auto leader = openLeader();
+  auto follower = openFollower();
+
+  createColumnFamily("cf1");
+  for (int i = 0; i < 100; ++i) {
+    auto key = "key" + std::to_string(i);
+    ASSERT_OK(leader->Put(wo(), key, std::to_string(i)));
+    ASSERT_OK(leader->Put(wo(), leaderCF("cf1"), key, std::to_string(i)));
+    if (i == 49) {
+      ASSERT_OK(leader->Flush(FlushOptions()));
+    }
+  }
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+  EXPECT_EQ(numPinnedRecords(), 200u);
+
+  catchUpFollower();
+  verifyEqual();
+
+  ASSERT_OK(leader->Put(wo(), "key1", "updated"));
+  ASSERT_OK(leader->Delete(wo(), leaderCF("cf1"), "key2"));
+  EXPECT_EQ(catchUpFollowerInBatch(), 2u);
+  verifyEqual();
+  std::string val;
+  ASSERT_TRUE(
+      follower->Get(ReadOptions(), followerCF("cf1"), "key2", &val)
+          .IsNotFound());
+}
+
+TEST_F(ReplicationTest, ReplicationStats) {
+  auto leader = openLeader();
+  auto options = leaderOptions();
+  options.statistics = CreateDBStatistics();
+  auto follower = openFollower(options);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(leader->Put(wo(), "key" + std::to_string(i), "val"));
+  }
+  ASSERT_OK(leader->Flush(FlushOptions()));
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+  auto num_records = catchUpFollower();
+  verifyEqual();
+
+  std::map<std::string, std::string> stats;
+  ASSERT_TRUE(
+      follower->GetMapProperty(DB::Properties::kReplicationStats, &stats));
+  EXPECT_EQ(stats["records-applied"], std::to_string(num_records));
+  EXPECT_EQ(stats["memtable-writes-applied"], "10");
+  EXPECT_EQ(stats["memtable-switches-applied"], "1");
+  EXPECT_EQ(stats["leader-sequence"],
+            std::to_string(leader->GetLatestSequenceNumber()));
+  EXPECT_EQ(stats["applied-sequence"], stats["leader-sequence"]);
+  EXPECT_EQ(stats["sequence-gap"], "0");
+  uint64_t gap = 1;
+  ASSERT_TRUE(
+      follower->GetIntProperty(DB::Properties::kReplicationSequenceGap, &gap));
+  EXPECT_EQ(gap, 0u);
+
+  EXPECT_EQ(options.statistics->getTickerCount(REPLICATION_RECORDS_APPLIED),
+            num_records);
+  EXPECT_EQ(options.statistics->getTickerCount(REPLICATION_BYTES_APPLIED),
+            std::stoull(stats["bytes-applied"]));
+  HistogramData hist;
+  options.statistics->histogramData(REPLICATION_SWITCH_MEMTABLE_MICROS,
+                                    &hist);
+  EXPECT_EQ(hist.count, 1u);
+}
+
+TEST_F(ReplicationTest, ManyColumnFamiliesFlush) {
+  auto leader = openLeader();
+  auto options = leaderOptions();
+  options.max_file_opening_threads = 4;
+  openFollower(options);
+
+  constexpr int kColumnFamilyCount = 20;
+  auto cf = [](int i) { return "cf" + std::to_string(i); };
+  for (int i = 0; i < kColumnFamilyCount; ++i) {
+    createColumnFamily(cf(i));
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kColumnFamilyCount; ++i) {
+      ASSERT_OK(leader->Put(wo(), leaderCF(cf(i)),
+                            "key" + std::to_string(round),
+                            "val" + std::to_string(i)));
+    }
+    // Atomic flush of all the column families
+    ASSERT_OK(leader->Flush(FlushOptions()));
+  }
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+
+  catchUpFollower();
+  verifyEqual();
+  for (int i = 0; i < kColumnFamilyCount; ++i) {
+    EXPECT_EQ(followerCFD(cf(i))->current()->storage_info()->NumLevelFiles(0),
+              leaderCFD(cf(i))->current()->storage_info()->NumLevelFiles(0));
+  }
+}
+
 TEST_F(ReplicationTest, ReproSYS3320) {
   auto leader = openLeader();
   auto follower = openFollower();
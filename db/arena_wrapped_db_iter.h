@@ -69,6 +69,10 @@ class ArenaWrappedDBIter : public Iterator {
     db_iter_->SeekForPrev(target);
   }
   void Next() override { db_iter_->Next(); }
+  size_t NextBatch(size_t max_entries, std::vector<Slice>* keys,
+                   std::vector<Slice>* values, std::string* buffer) override {
+    return db_iter_->NextBatch(max_entries, keys, values, buffer);
+  }
   void Prev() override { db_iter_->Prev(); }
   Slice key() const override { return db_iter_->key(); }
   Slice value() const override { return db_iter_->value(); }
@@ -331,7 +331,10 @@ Status BlobFileReader::GetBlob(
 
   if (prefetch_buffer) {
     Status s;
-    constexpr bool for_compaction = true;
+    // Compactions read ahead synchronously, while the readahead of user
+    // scans may be partly asynchronous
+    const bool for_compaction = prefetch_buffer->GetUsage() !=
+                                FilePrefetchBufferUsage::kUserScanPrefetch;
 
     IOOptions io_options;
     s = file_reader_->PrepareIOOptions(read_options, io_options);
@@ -232,6 +232,67 @@ TEST_F(DBBlobBasicTest, IterateBlobsFromCache) {
   }
 }
 
+TEST_F(DBBlobBasicTest, IterateBlobsWithReadahead) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+
+  constexpr int kNumBlobs = 100;
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%03d", i);
+    return std::string(buf);
+  };
+  auto blob = [](int i) {
+    return std::string(100, static_cast<char>('a' + i % 26));
+  };
+  for (int i = 0; i < kNumBlobs; ++i) {
+    ASSERT_OK(Put(key(i), blob(i)));
+  }
+  ASSERT_OK(Flush());
+
+  int file_reads = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::GetBlob:ReadFromFile",
+      [&](void* /* arg */) { ++file_reads; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool async_io : {false, true}) {
+    for (size_t readahead_size : {size_t{0}, size_t{64 << 10}}) {
+      ReadOptions read_options;
+      read_options.fill_cache = false;
+      read_options.async_io = async_io;
+      read_options.blob_readahead_size = readahead_size;
+
+      file_reads = 0;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+      int i = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(iter->key().ToString(), key(i));
+        ASSERT_EQ(iter->value().ToString(), blob(i));
+        ++i;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(i, kNumBlobs);
+      // One read per blob, or readahead of all of them
+      ASSERT_EQ(file_reads, readahead_size == 0 ? kNumBlobs : 0);
+
+      // Backward, the blobs before the readahead are read from the file
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        --i;
+        ASSERT_EQ(iter->key().ToString(), key(i));
+        ASSERT_EQ(iter->value().ToString(), blob(i));
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(i, 0);
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBlobBasicTest, IterateBlobsFromCachePinning) {
   constexpr size_t min_blob_size = 6;
 
@@ -14,7 +14,10 @@ FilePrefetchBuffer* PrefetchBufferCollection::GetOrCreatePrefetchBuffer(
     ReadaheadParams readahead_params;
     readahead_params.initial_readahead_size = readahead_size_;
     readahead_params.max_readahead_size = readahead_size_;
-    prefetch_buffer.reset(new FilePrefetchBuffer(readahead_params));
+    readahead_params.num_buffers = num_buffers_;
+    prefetch_buffer.reset(new FilePrefetchBuffer(
+        readahead_params, true /* enable */, false /* track_min_offset */, fs_,
+        clock_, stats_, nullptr /* cb */, usage_));
   }
 
   return prefetch_buffer.get();
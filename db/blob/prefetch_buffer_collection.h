@@ -16,21 +16,39 @@
 namespace ROCKSDB_NAMESPACE {
 
 // A class that owns a collection of FilePrefetchBuffers using the file number
-// as key. Used for implementing compaction readahead for blob files. Designed
-// to be accessed by a single thread only: every (sub)compaction needs its own
-// buffers since they are guaranteed to read different blobs from different
-// positions even when reading the same file.
+// as key. Used for implementing compaction and iterator readahead for blob
+// files. Designed to be accessed by a single thread only: every
+// (sub)compaction or iterator needs its own buffers since they are guaranteed
+// to read different blobs from different positions even when reading the
+// same file.
 class PrefetchBufferCollection {
  public:
-  explicit PrefetchBufferCollection(uint64_t readahead_size)
-      : readahead_size_(readahead_size) {
+  // With num_buffers > 1, the buffers read part of the readahead
+  // asynchronously, which takes the file system and clock to poll the reads
+  explicit PrefetchBufferCollection(
+      uint64_t readahead_size, size_t num_buffers = 1,
+      FileSystem* fs = nullptr, SystemClock* clock = nullptr,
+      Statistics* stats = nullptr,
+      FilePrefetchBufferUsage usage = FilePrefetchBufferUsage::kUnknown)
+      : readahead_size_(readahead_size),
+        num_buffers_(num_buffers),
+        fs_(fs),
+        clock_(clock),
+        stats_(stats),
+        usage_(usage) {
     assert(readahead_size_ > 0);
+    assert(num_buffers_ > 0);
   }
 
   FilePrefetchBuffer* GetOrCreatePrefetchBuffer(uint64_t file_number);
 
  private:
   uint64_t readahead_size_;
+  size_t num_buffers_;
+  FileSystem* fs_;
+  SystemClock* clock_;
+  Statistics* stats_;
+  FilePrefetchBufferUsage usage_;
   std::unordered_map<uint64_t, std::unique_ptr<FilePrefetchBuffer>>
       prefetch_buffers_;  // maps file number to prefetch buffer
 };
@@ -259,6 +259,10 @@ struct rocksdb_perfcontext_t {
 struct rocksdb_pinnableslice_t {
   PinnableSlice rep;
 };
+struct rocksdb_pinnableslices_t {
+  std::vector<PinnableSlice> values;
+  std::vector<Status> statuses;
+};
 struct rocksdb_transactiondb_options_t {
   TransactionDBOptions rep;
 };
@@ -1543,6 +1547,24 @@ void rocksdb_batched_multi_get_cf(rocksdb_t* db,
   delete[] statuses;
 }
 
+rocksdb_pinnableslices_t* rocksdb_batched_multi_get_pinned_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* const* keys_list, const size_t* keys_list_sizes,
+    unsigned char sorted_input) {
+  std::vector<Slice> key_slices(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    key_slices[i] = Slice(keys_list[i], keys_list_sizes[i]);
+  }
+  auto result = new rocksdb_pinnableslices_t;
+  result->values.resize(num_keys);
+  result->statuses.resize(num_keys);
+  db->rep->MultiGet(options->rep, column_family->rep, num_keys,
+                    key_slices.data(), result->values.data(),
+                    result->statuses.data(), sorted_input);
+  return result;
+}
+
 unsigned char rocksdb_key_may_exist(rocksdb_t* db,
                                     const rocksdb_readoptions_t* options,
                                     const char* key, size_t key_len,
@@ -1947,6 +1969,27 @@ void rocksdb_iter_get_error(const rocksdb_iterator_t* iter, char** errptr) {
   SaveError(errptr, iter->rep->status());
 }
 
+size_t rocksdb_iter_next_batch(rocksdb_iterator_t* iter, size_t max_entries,
+                               char* buf, size_t buf_len, size_t* keys_lens,
+                               size_t* values_lens) {
+  size_t n = 0;
+  size_t pos = 0;
+  for (; n < max_entries && iter->rep->Valid(); ++n, iter->rep->Next()) {
+    Slice key = iter->rep->key();
+    Slice value = iter->rep->value();
+    if (key.size() + value.size() > buf_len - pos) {
+      break;
+    }
+    memcpy(buf + pos, key.data(), key.size());
+    pos += key.size();
+    memcpy(buf + pos, value.data(), value.size());
+    pos += value.size();
+    keys_lens[n] = key.size();
+    values_lens[n] = value.size();
+  }
+  return n;
+}
+
 rocksdb_writebatch_t* rocksdb_writebatch_create() {
   return new rocksdb_writebatch_t;
 }
@@ -6671,6 +6714,25 @@ const char* rocksdb_pinnableslice_value(const rocksdb_pinnableslice_t* v,
   return v->rep.data();
 }
 
+void rocksdb_pinnableslices_destroy(rocksdb_pinnableslices_t* v) { delete v; }
+
+const char* rocksdb_pinnableslices_value(const rocksdb_pinnableslices_t* v,
+                                         size_t index, size_t* vlen) {
+  if (!v->statuses[index].ok()) {
+    *vlen = 0;
+    return nullptr;
+  }
+  *vlen = v->values[index].size();
+  return v->values[index].data();
+}
+
+void rocksdb_pinnableslices_error(const rocksdb_pinnableslices_t* v,
+                                  size_t index, char** errptr) {
+  if (!v->statuses[index].IsNotFound()) {
+    SaveError(errptr, v->statuses[index]);
+  }
+}
+
 // container to keep databases and caches in order to use
 // ROCKSDB_NAMESPACE::MemoryUtil
 struct rocksdb_memory_consumers_t {
@@ -1638,6 +1638,16 @@ int main(int argc, char** argv) {
         CheckEqual(expected_value[i], val, val_len);
         rocksdb_pinnableslice_destroy(pvals[i]);
       }
+
+      rocksdb_pinnableslices_t* pinned = rocksdb_batched_multi_get_pinned_cf(
+          db, roptions, handles[1], 4, batched_keys, batched_keys_sizes, 0);
+      for (i = 0; i < 4; ++i) {
+        val = rocksdb_pinnableslices_value(pinned, i, &val_len);
+        rocksdb_pinnableslices_error(pinned, i, &err);
+        CheckNoError(err);
+        CheckEqual(expected_value[i], val, val_len);
+      }
+      rocksdb_pinnableslices_destroy(pinned);
     }
 
     {
@@ -1675,6 +1685,27 @@ int main(int argc, char** argv) {
     CheckCondition(i == 4);
     rocksdb_iter_get_error(iter, &err);
     CheckNoError(err);
+
+    {
+      char batch_buf[64];
+      size_t batch_keys_lens[4];
+      size_t batch_values_lens[4];
+      rocksdb_iter_seek_to_first(iter);
+      // Too small for any entry
+      CheckCondition(rocksdb_iter_next_batch(iter, 4, batch_buf, 1,
+                                             batch_keys_lens,
+                                             batch_values_lens) == 0);
+      CheckCondition(rocksdb_iter_valid(iter));
+      CheckCondition(rocksdb_iter_next_batch(iter, 3, batch_buf,
+                                             sizeof(batch_buf), batch_keys_lens,
+                                             batch_values_lens) == 3);
+      CheckCondition(batch_keys_lens[0] == 3 && batch_values_lens[0] == 1);
+      CheckEqual("boxc", batch_buf, 4);
+      CheckCondition(rocksdb_iter_next_batch(iter, 4, batch_buf,
+                                             sizeof(batch_buf), batch_keys_lens,
+                                             batch_values_lens) == 1);
+      CheckCondition(!rocksdb_iter_valid(iter));
+    }
     rocksdb_iter_destroy(iter);
 
     rocksdb_column_family_handle_t* iters_cf_handles[2] = {handles[0],
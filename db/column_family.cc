@@ -166,6 +166,11 @@ Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
         "In-place memtable updates (inplace_update_support) is not compatible "
         "with concurrent writes (allow_concurrent_memtable_write)");
   }
+  if (cf_options.inplace_merge_support) {
+    return Status::InvalidArgument(
+        "In-place memtable merges (inplace_merge_support) is not compatible "
+        "with concurrent writes (allow_concurrent_memtable_write)");
+  }
   if (!cf_options.memtable_factory->IsInsertConcurrentlySupported()) {
     return Status::InvalidArgument(
         "Memtable doesn't concurrent writes (allow_concurrent_memtable_write)");
@@ -272,6 +277,12 @@ ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
   } else if (result.memtable_prefix_bloom_size_ratio < 0) {
     result.memtable_prefix_bloom_size_ratio = 0;
   }
+  // Nor should the hash index
+  if (result.memtable_hash_index_size_ratio > 0.25) {
+    result.memtable_hash_index_size_ratio = 0.25;
+  } else if (result.memtable_hash_index_size_ratio < 0) {
+    result.memtable_hash_index_size_ratio = 0;
+  }
 
   if (!result.prefix_extractor) {
     assert(result.memtable_factory);
@@ -777,6 +788,7 @@ const double kIncSlowdownRatio = 0.8;
 const double kDecSlowdownRatio = 1 / kIncSlowdownRatio;
 const double kNearStopSlowdownRatio = 0.6;
 const double kDelayRecoverSlowdownRatio = 1.4;
+const uint64_t kMinWriteRate = 16 * 1024u;  // Minimum write rate 16KB/s.
 
 namespace {
 // If penalize_stop is true, we further reduce slowdown rate.
@@ -784,8 +796,6 @@ std::unique_ptr<WriteControllerToken> SetupDelay(
     WriteController* write_controller, uint64_t compaction_needed_bytes,
     uint64_t prev_compaction_need_bytes, bool penalize_stop,
     bool auto_compactions_disabled) {
-  const uint64_t kMinWriteRate = 16 * 1024u;  // Minimum write rate 16KB/s.
-
   uint64_t max_write_rate = write_controller->max_delayed_write_rate();
   uint64_t write_rate = write_controller->delayed_write_rate();
 
@@ -955,6 +965,82 @@ ColumnFamilyData::GetWriteStallConditionAndCause(
   return {WriteStallCondition::kNormal, WriteStallCause::kNone};
 }
 
+double ColumnFamilyData::PredictSecondsToWriteStall(
+    const MutableCFOptions& mutable_cf_options) {
+  // Rates over shorter intervals are too noisy to predict from
+  const uint64_t kMinSampleMicros = 1000000;
+  // The weight of the latest interval in the smoothed rates
+  const double kRateSmoothing = 0.5;
+
+  auto* vstorage = current_->storage_info();
+  // The writes to all the column families, which the delays apply to
+  auto* default_cfd = column_family_set_->GetDefault();
+  const uint64_t bytes_written =
+      default_cfd != nullptr ? default_cfd->internal_stats()->GetDBStats(
+                                   InternalStats::kIntStatsBytesWritten)
+                             : 0;
+  const int l0_files = vstorage->l0_delay_trigger_count();
+  const uint64_t compaction_needed_bytes =
+      vstorage->estimated_compaction_needed_bytes();
+  const uint64_t now_micros = ioptions_.clock->NowMicros();
+
+  auto& prediction = write_stall_prediction_;
+  if (prediction.sample_micros == 0 ||
+      now_micros >= prediction.sample_micros + kMinSampleMicros) {
+    if (prediction.sample_micros > 0) {
+      const double secs =
+          static_cast<double>(now_micros - prediction.sample_micros) / 1e6;
+      // The DB stats go back to 0 on DB::ResetStats()
+      const double ingest_rate =
+          bytes_written >= prediction.bytes_written
+              ? static_cast<double>(bytes_written - prediction.bytes_written) /
+                    secs
+              : 0;
+      const double l0_files_rate = (l0_files - prediction.l0_files) / secs;
+      const double compaction_needed_bytes_rate =
+          (static_cast<double>(compaction_needed_bytes) -
+           static_cast<double>(prediction.compaction_needed_bytes)) /
+          secs;
+      const double weight = prediction.has_rates ? kRateSmoothing : 1;
+      prediction.ingest_rate +=
+          weight * (ingest_rate - prediction.ingest_rate);
+      prediction.l0_files_rate +=
+          weight * (l0_files_rate - prediction.l0_files_rate);
+      prediction.compaction_needed_bytes_rate +=
+          weight * (compaction_needed_bytes_rate -
+                    prediction.compaction_needed_bytes_rate);
+      prediction.has_rates = true;
+    }
+    prediction.sample_micros = now_micros;
+    prediction.bytes_written = bytes_written;
+    prediction.l0_files = l0_files;
+    prediction.compaction_needed_bytes = compaction_needed_bytes;
+  }
+
+  // The rates are net of the compactions, so they predict the stall at the
+  // current compaction throughput
+  double secs_to_stall = std::numeric_limits<double>::infinity();
+  if (!prediction.has_rates) {
+    return secs_to_stall;
+  }
+  if (prediction.l0_files_rate > 0) {
+    secs_to_stall = std::min(
+        secs_to_stall,
+        (mutable_cf_options.level0_slowdown_writes_trigger - l0_files) /
+            prediction.l0_files_rate);
+  }
+  if (mutable_cf_options.soft_pending_compaction_bytes_limit > 0 &&
+      prediction.compaction_needed_bytes_rate > 0) {
+    secs_to_stall = std::min(
+        secs_to_stall,
+        (static_cast<double>(
+             mutable_cf_options.soft_pending_compaction_bytes_limit) -
+         static_cast<double>(compaction_needed_bytes)) /
+            prediction.compaction_needed_bytes_rate);
+  }
+  return std::max(secs_to_stall, 0.0);
+}
+
 WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     const MutableCFOptions& mutable_cf_options) {
   auto write_stall_condition = WriteStallCondition::kNormal;
@@ -992,6 +1078,15 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
 
+    // Sampled in all the conditions, so that the rates stay current
+    double secs_to_stall = std::numeric_limits<double>::infinity();
+    const double prediction_secs =
+        static_cast<double>(mutable_cf_options.write_stall_prediction_secs);
+    if (prediction_secs > 0 && !mutable_cf_options_.disable_write_stall &&
+        !mutable_cf_options.disable_auto_compactions) {
+      secs_to_stall = PredictSecondsToWriteStall(mutable_cf_options);
+    }
+
     if (write_stall_condition == WriteStallCondition::kStopped &&
         write_stall_cause == WriteStallCause::kMemtableLimit) {
       write_controller_token_ = write_controller->GetStopToken();
@@ -1087,10 +1182,39 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
           write_controller->delayed_write_rate());
     } else {
       assert(write_stall_condition == WriteStallCondition::kNormal);
-      if (vstorage->l0_delay_trigger_count() >=
-          GetL0FileCountForCompactionSpeedup(
-              mutable_cf_options.level0_file_num_compaction_trigger,
-              mutable_cf_options.level0_slowdown_writes_trigger)) {
+      if (secs_to_stall < prediction_secs) {
+        // Slower the nearer the stall, and by at most kIncSlowdownRatio at a
+        // time while already delayed
+        uint64_t write_rate = static_cast<uint64_t>(
+            write_stall_prediction_.ingest_rate * secs_to_stall /
+            prediction_secs);
+        if (needed_delay) {
+          write_rate = std::max(
+              write_rate,
+              static_cast<uint64_t>(
+                  static_cast<double>(write_controller->delayed_write_rate()) *
+                  kIncSlowdownRatio));
+        }
+        write_rate = std::max(write_rate, kMinWriteRate);
+        write_controller_token_ = write_controller->GetDelayToken(write_rate);
+        ROCKS_LOG_INFO(
+            ioptions_.logger,
+            "[%s] Slowing down writes because a write stall is predicted in "
+            "%.1f seconds rate %" PRIu64,
+            name_.c_str(), secs_to_stall,
+            write_controller->delayed_write_rate());
+      } else if (secs_to_stall < 2 * prediction_secs) {
+        write_controller_token_ =
+            write_controller->GetCompactionPressureToken();
+        ROCKS_LOG_INFO(
+            ioptions_.logger,
+            "[%s] Increasing compaction threads because a write stall is "
+            "predicted in %.1f seconds",
+            name_.c_str(), secs_to_stall);
+      } else if (vstorage->l0_delay_trigger_count() >=
+                 GetL0FileCountForCompactionSpeedup(
+                     mutable_cf_options.level0_file_num_compaction_trigger,
+                     mutable_cf_options.level0_slowdown_writes_trigger)) {
         write_controller_token_ =
             write_controller->GetCompactionPressureToken();
         ROCKS_LOG_INFO(
@@ -1130,7 +1254,7 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       // If the DB recovers from delay conditions, we reward with reducing
       // double the slowdown ratio. This is to balance the long term slowdown
       // increase signal.
-      if (needed_delay) {
+      if (needed_delay && secs_to_stall >= prediction_secs) {
         uint64_t write_rate = write_controller->delayed_write_rate();
         write_controller->set_delayed_write_rate(static_cast<uint64_t>(
             static_cast<double>(write_rate) * kDelayRecoverSlowdownRatio));
@@ -1537,6 +1661,11 @@ Status ColumnFamilyData::ValidateOptions(
           "The garbage ratio threshold for forcing blob garbage collection "
           "should be in the range [0.0, 1.0].");
     }
+    if (cf_options.blob_garbage_collection_force_max_batches < 1) {
+      return Status::InvalidArgument(
+          "The maximum number of blob file batches for forced blob garbage "
+          "collection should be at least 1.");
+    }
   }
 
   if (cf_options.compaction_style == kCompactionStyleFIFO &&
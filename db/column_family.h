@@ -584,6 +584,13 @@ class ColumnFamilyData {
 
   std::vector<std::string> GetDbPaths() const;
 
+  // Samples the growth of L0 and of the compaction debt, and returns the
+  // seconds until either is predicted to reach its slowdown trigger, or
+  // infinity if neither grows. See
+  // ColumnFamilyOptions::write_stall_prediction_secs.
+  // REQUIRES: DB mutex held
+  double PredictSecondsToWriteStall(const MutableCFOptions& mutable_cf_options);
+
   uint32_t id_;
   const std::string name_;
   Version* dummy_versions_;  // Head of circular doubly-linked list of versions.
@@ -651,6 +658,20 @@ class ColumnFamilyData {
 
   uint64_t prev_compaction_needed_bytes_;
 
+  // The last sample and the smoothed rates per second of the write stall
+  // prediction, see ColumnFamilyOptions::write_stall_prediction_secs
+  struct WriteStallPrediction {
+    uint64_t sample_micros = 0;
+    uint64_t bytes_written = 0;
+    int l0_files = 0;
+    uint64_t compaction_needed_bytes = 0;
+    bool has_rates = false;
+    double ingest_rate = 0;
+    double l0_files_rate = 0;
+    double compaction_needed_bytes_rate = 0;
+  };
+  WriteStallPrediction write_stall_prediction_;
+
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
 
@@ -24,6 +24,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/utilities/object_registry.h"
+#include "test_util/mock_time_env.h"
 #include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -2835,6 +2836,72 @@ TEST_P(ColumnFamilyTest, CompactionSpeedupSingleColumnFamily) {
   ASSERT_EQ(1, dbfull()->TEST_BGCompactionsAllowed());
 }
 
+TEST_P(ColumnFamilyTest, WriteStallPrediction) {
+  auto mock_clock = std::make_shared<MockSystemClock>(env_->GetSystemClock());
+  auto mock_env = std::make_unique<CompositeEnvWrapper>(env_, mock_clock);
+  mock_clock->SetCurrentTime(100);
+  db_options_.env = mock_env.get();
+  db_options_.max_background_compactions = 6;
+  Open({"default"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+
+  // Speed up threshold = min(4 * 2, 4 + (20 - 4)/4) = 8
+  mutable_cf_options.level0_file_num_compaction_trigger = 4;
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 30;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 1 << 30;
+  mutable_cf_options.write_stall_prediction_secs = 10;
+
+  vstorage->set_l0_delay_trigger_count(2);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(1, dbfull()->TEST_BGCompactionsAllowed());
+
+  // 2 files and about 1MB a second: the slowdown trigger is 8 seconds away,
+  // the writes are delayed to 8/10 of their rate
+  const int kNumKeys = 100;
+  const int kLargeValueSize = 10000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(
+        Put(0, "key" + std::to_string(i), rnd_.RandomString(kLargeValueSize)));
+  }
+  mock_clock->MockSleepForSeconds(1);
+  vstorage->set_l0_delay_trigger_count(4);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_GT(GetDbDelayedWriteRate(), kNumKeys * kLargeValueSize * 0.75);
+  ASSERT_LT(GetDbDelayedWriteRate(), kNumKeys * kLargeValueSize * 0.85);
+  ASSERT_EQ(6, dbfull()->TEST_BGCompactionsAllowed());
+
+  // Half the rate: 16 seconds away, only the compactions are sped up
+  mock_clock->MockSleepForSeconds(1);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(6, dbfull()->TEST_BGCompactionsAllowed());
+
+  // Shrinking
+  mock_clock->MockSleepForSeconds(1);
+  vstorage->set_l0_delay_trigger_count(2);
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(1, dbfull()->TEST_BGCompactionsAllowed());
+
+  // The compaction debt is predicted likewise
+  mock_clock->MockSleepForSeconds(1);
+  vstorage->TEST_set_estimated_compaction_needed_bytes(
+      (1 << 30) - (1 << 20), dbfull()->TEST_Mutex());
+  RecalculateWriteStallConditions(cfd, mutable_cf_options);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+
+  Close();
+  db_options_.env = env_;
+}
+
 TEST_P(ColumnFamilyTest, WriteStallTwoColumnFamilies) {
   const uint64_t kBaseRate = 810000u;
   db_options_.delayed_write_rate = kBaseRate;
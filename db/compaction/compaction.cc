@@ -9,6 +9,7 @@
 
 #include "db/compaction/compaction.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <vector>
 
@@ -597,11 +598,172 @@ bool Compaction::IsTrivialMove() const {
 void Compaction::AddInputDeletions(VersionEdit* out_edit) {
   for (size_t which = 0; which < num_input_levels(); which++) {
     for (size_t i = 0; i < inputs_[which].size(); i++) {
-      out_edit->DeleteFile(level(which), inputs_[which][i]->fd.GetNumber());
+      FileMetaData* f = inputs_[which][i];
+      if (level(which) == output_level_ && IsReusedInput(f)) {
+        continue;
+      }
+      out_edit->DeleteFile(level(which), f->fd.GetNumber());
     }
   }
 }
 
+void Compaction::ReuseNonOverlappingInputs() {
+  assert(reused_inputs_.empty());
+  // A compaction filter or per key placement must see every key, and a
+  // compaction within one level or into level 0 has no level to keep files
+  // in. Other compaction reasons, like TTL or a change of temperature, are
+  // there to rewrite the files.
+  // Round-robin compactions split their work by the input files.
+  if (immutable_options_.compaction_style != kCompactionStyleLevel ||
+      immutable_options_.compaction_pri == kRoundRobin ||
+      start_level_ == output_level_ || output_level_ == 0 ||
+      SupportsPerKeyPlacement() ||
+      immutable_options_.compaction_filter != nullptr ||
+      immutable_options_.compaction_filter_factory != nullptr ||
+      (compaction_reason_ != CompactionReason::kLevelL0FilesNum &&
+       compaction_reason_ != CompactionReason::kLevelMaxLevelSize)) {
+    return;
+  }
+
+  const Comparator* ucmp = cfd_->user_comparator();
+  auto overlaps = [ucmp](const FileMetaData* a, const FileMetaData* b) {
+    return ucmp->CompareWithoutTimestamp(a->largest.user_key(),
+                                         b->smallest.user_key()) >= 0 &&
+           ucmp->CompareWithoutTimestamp(b->largest.user_key(),
+                                         a->smallest.user_key()) >= 0;
+  };
+
+  // A file of a higher level only moves to the output level if
+  // IsTrivialMove() would allow moving it on its own
+  const bool compression_matches = InputCompressionMatchesOutput();
+  std::unique_ptr<SstPartitioner> partitioner = CreateSstPartitioner();
+  auto can_move = [&](FileMetaData* f) {
+    if (!compression_matches || f->fd.GetPathId() != output_path_id_) {
+      return false;
+    }
+    if (output_level_ + 1 < number_levels_) {
+      std::vector<FileMetaData*> file_grand_parents;
+      input_vstorage_->GetOverlappingInputs(output_level_ + 1, &f->smallest,
+                                            &f->largest, &file_grand_parents);
+      if (f->fd.GetFileSize() + TotalFileSize(file_grand_parents) >
+          max_compaction_bytes_) {
+        return false;
+      }
+    }
+    return partitioner == nullptr ||
+           partitioner->CanDoTrivialMove(f->smallest.user_key(),
+                                         f->largest.user_key());
+  };
+
+  std::vector<std::pair<int, FileMetaData*>> reused;
+  size_t num_compacted = 0;
+  for (size_t which = 0; which < num_input_levels(); which++) {
+    const int lvl = level(which);
+    for (FileMetaData* f : inputs_[which].files) {
+      bool reuse = true;
+      for (size_t other = 0; reuse && other < num_input_levels(); other++) {
+        for (const FileMetaData* g : inputs_[other].files) {
+          if (g != f && overlaps(f, g)) {
+            reuse = false;
+            break;
+          }
+        }
+      }
+      if (reuse && lvl == 0) {
+        // Moving the file below an older overlapping file that stays in
+        // level 0 would hide its newer keys
+        for (const FileMetaData* g : input_vstorage_->LevelFiles(0)) {
+          if (g != f && overlaps(f, g)) {
+            reuse = false;
+            break;
+          }
+        }
+      }
+      if (reuse && (lvl == output_level_ || can_move(f))) {
+        reused.emplace_back(lvl, f);
+      } else {
+        num_compacted++;
+      }
+    }
+  }
+  if (reused.empty() || num_compacted == 0) {
+    return;
+  }
+
+  const InternalKeyComparator& icmp = cfd_->internal_comparator();
+  std::sort(reused.begin(), reused.end(),
+            [&icmp](const std::pair<int, FileMetaData*>& a,
+                    const std::pair<int, FileMetaData*>& b) {
+              return icmp.Compare(a.second->smallest, b.second->smallest) < 0;
+            });
+  reused_inputs_ = std::move(reused);
+
+  // The boundaries of an atomic compaction unit never include a reused file,
+  // which would overlap the other files of the unit
+  read_boundaries_.resize(num_input_levels());
+  for (size_t which = 0; which < num_input_levels(); which++) {
+    const auto& all_boundaries =
+        inputs_[which].atomic_compaction_unit_boundaries;
+    std::vector<FileMetaData*> files;
+    for (size_t i = 0; i < inputs_[which].size(); i++) {
+      FileMetaData* f = inputs_[which][i];
+      if (IsReusedInput(f)) {
+        continue;
+      }
+      files.push_back(f);
+      if (!all_boundaries.empty()) {
+        read_boundaries_[which].push_back(all_boundaries[i]);
+      }
+    }
+    DoGenerateLevelFilesBrief(&input_levels_[which], files, &arena_);
+  }
+}
+
+bool Compaction::IsReusedInput(const FileMetaData* f) const {
+  for (const auto& reused : reused_inputs_) {
+    if (reused.second == f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Compaction::HasReusedInputBetween(const Slice& prev_user_key,
+                                       const Slice& next_user_key) const {
+  if (reused_inputs_.empty()) {
+    return false;
+  }
+  const Comparator* ucmp = cfd_->user_comparator();
+  // The first reused file after prev_user_key, which cannot contain it
+  auto it = std::upper_bound(
+      reused_inputs_.begin(), reused_inputs_.end(), prev_user_key,
+      [ucmp](const Slice& key, const std::pair<int, FileMetaData*>& reused) {
+        return ucmp->CompareWithoutTimestamp(
+                   key, reused.second->smallest.user_key()) < 0;
+      });
+  return it != reused_inputs_.end() &&
+         ucmp->CompareWithoutTimestamp(it->second->smallest.user_key(),
+                                       next_user_key) < 0;
+}
+
+void Compaction::AddMovedInputs(VersionEdit* out_edit) const {
+  for (const auto& reused : reused_inputs_) {
+    if (reused.first == output_level_) {
+      continue;
+    }
+    const FileMetaData* f = reused.second;
+    out_edit->AddFile(
+        output_level_, f->fd.GetNumber(), f->fd.GetPathId(),
+        f->fd.GetFileSize(), f->smallest, f->largest, f->fd.smallest_seqno,
+        f->fd.largest_seqno, f->marked_for_compaction, f->temperature,
+        f->oldest_blob_file_number, f->oldest_ancester_time,
+        f->file_creation_time, f->epoch_number, f->file_checksum,
+        f->file_checksum_func_name, f->unique_id,
+        f->compensated_range_deletion_size, f->tail_size,
+        f->user_defined_timestamps_persisted);
+  }
+}
+
 bool Compaction::KeyNotExistsBeyondOutputLevel(
     const Slice& user_key, std::vector<size_t>* level_ptrs) const {
   assert(input_version_ != nullptr);
@@ -871,6 +1033,13 @@ bool Compaction::ShouldFormSubcompactions() const {
     return output_level_ > 0;
   }
 
+  // So does universal compaction with reserve_threads_for_subcompactions
+  if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal &&
+      mutable_cf_options_.compaction_options_universal
+          .reserve_threads_for_subcompactions) {
+    return number_levels_ > 1 && output_level_ > 0;
+  }
+
   if (max_subcompactions_ <= 1) {
     return false;
   }
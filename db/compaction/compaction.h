@@ -157,9 +157,14 @@ class Compaction {
     return inputs_[compaction_input_level][i];
   }
 
+  // Returns the atomic compaction unit boundaries of the files in
+  // input_levels(compaction_input_level), one per file, or none for level 0.
   const std::vector<AtomicCompactionUnitBoundary>* boundaries(
       size_t compaction_input_level) const {
     assert(compaction_input_level < inputs_.size());
+    if (!reused_inputs_.empty()) {
+      return &read_boundaries_[compaction_input_level];
+    }
     return &inputs_[compaction_input_level].atomic_compaction_unit_boundaries;
   }
 
@@ -175,7 +180,8 @@ class Compaction {
 
   const std::vector<CompactionInputFiles>* inputs() { return &inputs_; }
 
-  // Returns the LevelFilesBrief of the specified compaction input level.
+  // Returns the LevelFilesBrief of the specified compaction input level,
+  // which leaves out the files reused by ReuseNonOverlappingInputs().
   const LevelFilesBrief* input_levels(size_t compaction_input_level) const {
     return &input_levels_[compaction_input_level];
   }
@@ -210,9 +216,34 @@ class Compaction {
   // If true, then the compaction can be done by simply deleting input files.
   bool deletion_compaction() const { return deletion_compaction_; }
 
-  // Add all inputs to this compaction as delete operations to *edit.
+  // Add all inputs to this compaction as delete operations to *edit, except
+  // for the reused files that stay in the output level.
   void AddInputDeletions(VersionEdit* edit);
 
+  // Keeps the input files whose key ranges overlap no other input file out
+  // of the compaction when a leveled compaction into a lower level allows
+  // it: the ones of the output level stay there, and the others move to the
+  // output level if they could be trivially moved. Does nothing unless at
+  // least one input file is left to compact. Must be called before the
+  // input is read.
+  void ReuseNonOverlappingInputs();
+
+  // Returns the number of input files kept by ReuseNonOverlappingInputs().
+  size_t num_reused_inputs() const { return reused_inputs_.size(); }
+
+  // Returns true if `f` is an input file kept by ReuseNonOverlappingInputs().
+  bool IsReusedInput(const FileMetaData* f) const;
+
+  // Returns true if a file kept by ReuseNonOverlappingInputs() lies between
+  // the user keys `prev_user_key` and `next_user_key`, so that an output file
+  // must not contain both.
+  bool HasReusedInputBetween(const Slice& prev_user_key,
+                             const Slice& next_user_key) const;
+
+  // Adds the files that ReuseNonOverlappingInputs() moves from a higher
+  // level to the output level to *edit.
+  void AddMovedInputs(VersionEdit* edit) const;
+
   // Returns true if the available information we have guarantees that
   // the input "user_key" does not exist in any level beyond `output_level()`.
   bool KeyNotExistsBeyondOutputLevel(const Slice& user_key,
@@ -508,9 +539,18 @@ class Compaction {
   // Compaction input files organized by level. Constant after construction
   const std::vector<CompactionInputFiles> inputs_;
 
-  // A copy of inputs_, organized more closely in memory
+  // A copy of inputs_, organized more closely in memory, without the reused
+  // input files
   autovector<LevelFilesBrief, 2> input_levels_;
 
+  // The input files kept by ReuseNonOverlappingInputs(), with the level of
+  // each, sorted by key
+  std::vector<std::pair<int, FileMetaData*>> reused_inputs_;
+
+  // The atomic compaction unit boundaries of the files in input_levels_
+  // when some input files are reused
+  autovector<std::vector<AtomicCompactionUnitBoundary>, 2> read_boundaries_;
+
   // State used to check for number of overlapping grandparent files
   // (grandparent == "output_level_ + 1")
   std::vector<FileMetaData*> grandparents_;
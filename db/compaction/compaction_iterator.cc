@@ -22,6 +22,79 @@
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
+FilterBatchingIterator::FilterBatchingIterator(InternalIterator* iter,
+                                               const Comparator* cmp,
+                                               const CompactionFilter* filter,
+                                               int level)
+    : icmp_(cmp),
+      inner_iter_(iter),
+      filter_(filter),
+      level_(level),
+      batch_size_(filter->FilterBatchSize()) {
+  assert(batch_size_ > 0);
+  Fill();
+}
+
+void FilterBatchingIterator::Next() {
+  assert(Valid());
+  if (++pos_ == entries_.size()) {
+    Fill();
+  }
+}
+
+void FilterBatchingIterator::Seek(const Slice& target) {
+  // The target is usually a little ahead, within the entries read
+  while (Valid() && icmp_.Compare(entries_[pos_].key, target) < 0) {
+    pos_++;
+  }
+  if (!Valid()) {
+    inner_iter_->Seek(target);
+    has_last_user_key_ = false;
+    Fill();
+  }
+}
+
+void FilterBatchingIterator::SeekToFirst() {
+  inner_iter_->SeekToFirst();
+  has_last_user_key_ = false;
+  Fill();
+}
+
+void FilterBatchingIterator::Fill() {
+  entries_.clear();
+  batch_.clear();
+  pos_ = 0;
+  while (inner_iter_->Valid() && entries_.size() < batch_size_) {
+    entries_.push_back({inner_iter_->key().ToString(),
+                        inner_iter_->value().ToString(),
+                        inner_iter_->IsDeleteRangeSentinelKey(), SIZE_MAX});
+    inner_iter_->Next();
+  }
+  // The slices of the batch point into the entries, which no longer move
+  for (auto& entry : entries_) {
+    ParsedInternalKey ikey;
+    if (entry.is_range_del_sentinel ||
+        !ParseInternalKey(entry.key, &ikey, false /* log_err_key */).ok()) {
+      has_last_user_key_ = false;
+      continue;
+    }
+    bool latest = !has_last_user_key_ ||
+                  !icmp_.user_comparator()->Equal(ikey.user_key,
+                                                  last_user_key_);
+    last_user_key_.assign(ikey.user_key.data(), ikey.user_key.size());
+    has_last_user_key_ = true;
+    if (latest && ikey.type == kTypeValue) {
+      entry.batch_index = batch_.size();
+      batch_.emplace_back();
+      batch_.back().key = ikey.user_key;
+      batch_.back().existing_value = entry.value;
+    }
+  }
+  if (!batch_.empty()) {
+    filter_->FilterBatch(level_, &batch_);
+  }
+}
+
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
     SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
@@ -68,7 +141,10 @@ CompactionIterator::CompactionIterator(
     const std::string* full_history_ts_low,
     const SequenceNumber preserve_time_min_seqno,
     const SequenceNumber preclude_last_level_min_seqno)
-    : input_(input, cmp, must_count_input_entries),
+    : filter_batching_iter_(CreateFilterBatchingIteratorIfNeeded(
+          input, cmp, compaction_filter, snapshot_checker, compaction.get())),
+      input_(filter_batching_iter_ ? filter_batching_iter_.get() : input, cmp,
+             must_count_input_entries),
       cmp_(cmp),
       merge_helper_(merge_helper),
       snapshots_(snapshots),
@@ -311,6 +387,19 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
       }
     }
 
+    if (decision == CompactionFilter::Decision::kUndetermined &&
+        ikey_.type == kTypeValue && filter_batching_iter_ != nullptr) {
+      // Entries left out of the batches, e.g. after a corrupted key, still
+      // go to FilterV3()
+      const auto* batched = filter_batching_iter_->FilterDecision();
+      if (batched != nullptr) {
+        decision = batched->decision;
+        compaction_filter_value_ = batched->new_value;
+        new_columns = batched->new_columns;
+        *compaction_filter_skip_until_.rep() = batched->skip_until;
+      }
+    }
+
     if (decision == CompactionFilter::Decision::kUndetermined) {
       const Slice* existing_val = nullptr;
       const WideColumns* existing_col = nullptr;
@@ -1469,6 +1558,23 @@ std::unique_ptr<BlobFetcher> CompactionIterator::CreateBlobFetcherIfNeeded(
   return std::unique_ptr<BlobFetcher>(new BlobFetcher(version, read_options));
 }
 
+std::unique_ptr<FilterBatchingIterator>
+CompactionIterator::CreateFilterBatchingIteratorIfNeeded(
+    InternalIterator* input, const Comparator* cmp,
+    const CompactionFilter* compaction_filter,
+    const SnapshotChecker* snapshot_checker,
+    const CompactionProxy* compaction) {
+  // Which version of a key gets filtered depends on the snapshot checker and
+  // on the timestamps, which the batches leave to FilterV3()
+  if (!compaction_filter || compaction_filter->FilterBatchSize() == 0 ||
+      compaction_filter->IsStackedBlobDbInternalCompactionFilter() ||
+      snapshot_checker != nullptr || cmp->timestamp_size() > 0) {
+    return nullptr;
+  }
+  return std::make_unique<FilterBatchingIterator>(
+      input, cmp, compaction_filter, compaction ? compaction->level() : 0);
+}
+
 std::unique_ptr<PrefetchBufferCollection>
 CompactionIterator::CreatePrefetchBufferCollectionIfNeeded(
     const CompactionProxy* compaction) {
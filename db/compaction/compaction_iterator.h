@@ -26,6 +26,72 @@ class BlobFileBuilder;
 class BlobFetcher;
 class PrefetchBufferCollection;
 
+// Reads up to CompactionFilter::FilterBatchSize() entries of an internal
+// iterator ahead, and passes the plain values among them that are the latest
+// version of their user key to CompactionFilter::FilterBatch() together.
+class FilterBatchingIterator : public InternalIterator {
+ public:
+  // REQUIRES: iter is positioned, filter->FilterBatchSize() > 0
+  FilterBatchingIterator(InternalIterator* iter, const Comparator* cmp,
+                         const CompactionFilter* filter, int level);
+  bool Valid() const override { return pos_ < entries_.size(); }
+  Status status() const override {
+    return Valid() ? Status::OK() : inner_iter_->status();
+  }
+  void Next() override;
+  void Seek(const Slice& target) override;
+  void SeekToFirst() override;
+  Slice key() const override {
+    assert(Valid());
+    return entries_[pos_].key;
+  }
+  Slice value() const override {
+    assert(Valid());
+    return entries_[pos_].value;
+  }
+  bool IsDeleteRangeSentinelKey() const override {
+    assert(Valid());
+    return entries_[pos_].is_range_del_sentinel;
+  }
+
+  // Unused InternalIterator methods
+  void Prev() override { assert(false); }
+  void SeekForPrev(const Slice& /* target */) override { assert(false); }
+  void SeekToLast() override { assert(false); }
+
+  // Returns the decision of the filter for the current entry, or nullptr if
+  // it was not passed to the filter
+  const CompactionFilter::BatchEntry* FilterDecision() const {
+    assert(Valid());
+    size_t i = entries_[pos_].batch_index;
+    return i < batch_.size() ? &batch_[i] : nullptr;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    bool is_range_del_sentinel;
+    // The index of the entry in batch_, or SIZE_MAX if not filtered
+    size_t batch_index;
+  };
+
+  // Reads the next entries of inner_iter_ and filters them
+  void Fill();
+
+  InternalKeyComparator icmp_;
+  InternalIterator* inner_iter_;  // not owned
+  const CompactionFilter* filter_;
+  const int level_;
+  const size_t batch_size_;
+  std::vector<Entry> entries_;
+  size_t pos_ = 0;
+  std::vector<CompactionFilter::BatchEntry> batch_;
+  // The user key of the last entry read, if it may continue in inner_iter_
+  std::string last_user_key_;
+  bool has_last_user_key_ = false;
+};
+
 // A wrapper of internal iterator whose purpose is to count how
 // many entries there are in the iterator.
 class SequenceIterWrapper : public InternalIterator {
@@ -351,7 +417,15 @@ class CompactionIterator {
       const CompactionProxy* compaction);
   static std::unique_ptr<PrefetchBufferCollection>
   CreatePrefetchBufferCollectionIfNeeded(const CompactionProxy* compaction);
+  static std::unique_ptr<FilterBatchingIterator>
+  CreateFilterBatchingIteratorIfNeeded(
+      InternalIterator* input, const Comparator* cmp,
+      const CompactionFilter* compaction_filter,
+      const SnapshotChecker* snapshot_checker,
+      const CompactionProxy* compaction);
 
+  // Between the input and input_ if the filter takes batches
+  std::unique_ptr<FilterBatchingIterator> filter_batching_iter_;
   SequenceIterWrapper input_;
   const Comparator* cmp_;
   MergeHelper* merge_helper_;
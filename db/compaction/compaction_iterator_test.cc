@@ -587,6 +587,70 @@ TEST_P(CompactionIteratorTest, CompactionFilterSkipUntil) {
   ASSERT_EQ(expected_actions, iter_->log);
 }
 
+TEST_P(CompactionIteratorTest, CompactionFilterBatch) {
+  class Filter : public CompactionFilter {
+   public:
+    Decision FilterV2(int /*level*/, const Slice& key, ValueType /*t*/,
+                      const Slice& /*existing_value*/, std::string* new_value,
+                      std::string* skip_until) const override {
+      if (key == "b") {
+        return Decision::kRemove;
+      }
+      if (key == "c") {
+        *new_value = "new";
+        return Decision::kChangeValue;
+      }
+      if (key == "d") {
+        *skip_until = "f";
+        return Decision::kRemoveAndSkipUntil;
+      }
+      return Decision::kKeep;
+    }
+
+    size_t FilterBatchSize() const override { return 3; }
+
+    void FilterBatch(int level,
+                     std::vector<BatchEntry>* entries) const override {
+      for (const auto& entry : *entries) {
+        batched_keys.push_back(entry.key.ToString());
+      }
+      CompactionFilter::FilterBatch(level, entries);
+    }
+
+    const char* Name() const override {
+      return "CompactionIteratorTest.CompactionFilterBatch::Filter";
+    }
+
+    mutable std::vector<std::string> batched_keys;
+  };
+
+  Filter filter;
+  RunTest({test::KeyStr("a", 50, kTypeValue),
+           test::KeyStr("a", 40, kTypeValue),
+           test::KeyStr("b", 60, kTypeValue),
+           test::KeyStr("c", 55, kTypeValue),
+           test::KeyStr("d", 70, kTypeValue),
+           test::KeyStr("e", 65, kTypeValue),
+           test::KeyStr("f", 30, kTypeValue),
+           test::KeyStr("g", 20, kTypeValue)},
+          {"av50", "av40", "bv60", "cv55", "dv70", "ev65", "fv30", "gv20"},
+          {test::KeyStr("a", 50, kTypeValue),
+           test::KeyStr("b", 60, kTypeDeletion),
+           test::KeyStr("c", 55, kTypeValue), test::KeyStr("f", 30, kTypeValue),
+           test::KeyStr("g", 20, kTypeValue)},
+          {"av50", "", "new", "fv30", "gv20"}, kMaxSequenceNumber,
+          nullptr /* merge_operator */, &filter);
+  if (GetParam()) {
+    // FilterV3() decides the keys of transactions one at a time
+    ASSERT_TRUE(filter.batched_keys.empty());
+  } else {
+    // "e" is filtered in the batch of "d", and then skipped
+    const std::vector<std::string> expected{"a", "b", "c", "d",
+                                            "e", "f", "g"};
+    ASSERT_EQ(filter.batched_keys, expected);
+  }
+}
+
 TEST_P(CompactionIteratorTest, ShuttingDownInFilter) {
   NoMergingMergeOp merge_op;
   StallingFilter filter;
@@ -23,6 +23,7 @@
 #include "db/builder.h"
 #include "db/compaction/clipping_iterator.h"
 #include "db/compaction/compaction_state.h"
+#include "db/compaction/pipelined_input_iterator.h"
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
 #include "db/error_handler.h"
@@ -50,6 +51,7 @@
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
+#include "rocksdb/tenant_usage.h"
 #include "rocksdb/utilities/options_type.h"
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
@@ -181,6 +183,7 @@ CompactionJob::CompactionJob(
       event_logger_(event_logger),
       paranoid_file_checks_(paranoid_file_checks),
       measure_io_stats_(measure_io_stats),
+      num_subcompaction_threads_(0),
       thread_pri_(thread_pri),
       full_history_ts_low_(std::move(full_history_ts_low)),
       trim_ts_(std::move(trim_ts)),
@@ -256,6 +259,18 @@ void CompactionJob::Prepare() {
   write_hint_ = cfd->CalculateSSTWriteHint(c->output_level());
   bottommost_level_ = c->bottommost_level();
 
+  // Remote compactions read all of their input files
+  if (c->mutable_cf_options()->compaction_reuse_non_overlapping_files &&
+      db_options_.compaction_service == nullptr) {
+    c->ReuseNonOverlappingInputs();
+    if (c->num_reused_inputs() > 0) {
+      ROCKS_LOG_INFO(db_options_.info_log,
+                     "[%s] [JOB %d] Reusing %" ROCKSDB_PRIszt
+                     " input files that overlap no other input",
+                     cfd->GetName().c_str(), job_id_, c->num_reused_inputs());
+    }
+  }
+
   if (c->ShouldFormSubcompactions()) {
     StopWatch sw(db_options_.clock, stats_, SUBCOMPACTION_SETUP_TIME);
     GenSubcompactionBoundaries();
@@ -438,7 +453,8 @@ void CompactionJob::ReleaseSubcompactionResources() {
   {
     InstrumentedMutexLock l(db_mutex_);
     // The number of reserved threads becomes larger than 0 only if the
-    // compaction prioity is round robin and there is no sufficient
+    // compaction prioity is round robin, or the compaction is universal with
+    // reserve_threads_for_subcompactions, and there is no sufficient
     // sub-compactions available
 
     // The scheduled compaction must be no less than 1 + extra number
@@ -481,9 +497,15 @@ void CompactionJob::GenSubcompactionBoundaries() {
   ReadOptions read_options(Env::IOActivity::kCompaction);
   read_options.rate_limiter_priority = GetRateLimiterPriority();
   auto* c = compact_->compaction;
-  if (c->max_subcompactions() <= 1 &&
-      !(c->immutable_options()->compaction_pri == kRoundRobin &&
-        c->immutable_options()->compaction_style == kCompactionStyleLevel)) {
+  const bool round_robin =
+      c->immutable_options()->compaction_pri == kRoundRobin &&
+      c->immutable_options()->compaction_style == kCompactionStyleLevel;
+  const bool universal_reserve_threads =
+      c->immutable_options()->compaction_style == kCompactionStyleUniversal &&
+      c->mutable_cf_options()
+          ->compaction_options_universal.reserve_threads_for_subcompactions;
+  if (c->max_subcompactions() <= 1 && !round_robin &&
+      !universal_reserve_threads) {
     return;
   }
   auto* cfd = c->column_family_data();
@@ -553,16 +575,27 @@ void CompactionJob::GenSubcompactionBoundaries() {
 
   // Get the number of planned subcompactions, may update reserve threads
   // and update extra_num_subcompaction_threads_reserved_ for round-robin
+  // and for universal compaction with reserve_threads_for_subcompactions
   uint64_t num_planned_subcompactions;
-  if (c->immutable_options()->compaction_pri == kRoundRobin &&
-      c->immutable_options()->compaction_style == kCompactionStyleLevel) {
+  if (round_robin ||
+      (universal_reserve_threads && bg_compaction_scheduled_ != nullptr &&
+       bg_bottom_compaction_scheduled_ != nullptr)) {
     // For round-robin compaction prioity, we need to employ more
     // subcompactions (may exceed the max_subcompaction limit). The extra
     // subcompactions will be executed using reserved threads and taken into
     // account bg_compaction_scheduled or bg_bottom_compaction_scheduled.
 
-    // Initialized by the number of input files
-    num_planned_subcompactions = static_cast<uint64_t>(c->num_input_files(0));
+    // Initialized by the number of input files, of the start level for
+    // round-robin and of all the sorted runs for universal compaction
+    if (round_robin) {
+      num_planned_subcompactions =
+          static_cast<uint64_t>(c->num_input_files(0));
+    } else {
+      num_planned_subcompactions = 0;
+      for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+        num_planned_subcompactions += c->num_input_files(lvl_idx);
+      }
+    }
     uint64_t max_subcompactions_limit = GetSubcompactionsLimit();
     if (max_subcompactions_limit < num_planned_subcompactions) {
       // Assert two pointers are not empty so that we can use extra
@@ -590,9 +623,18 @@ void CompactionJob::GenSubcompactionBoundaries() {
     return;
   }
 
+  // With more than one range per subcompaction thread, the threads take the
+  // ranges in turn, so a thread that is done early moves on to a range that
+  // would otherwise wait for the slowest thread
+  const uint64_t ranges_per_thread =
+      std::max(mutable_db_options_copy_.subcompaction_ranges_per_thread,
+               uint32_t{1});
+  const uint64_t num_planned_ranges =
+      num_planned_subcompactions * ranges_per_thread;
+
   // Group the ranges into subcompactions
   uint64_t target_range_size = std::max(
-      total_size / num_planned_subcompactions,
+      total_size / num_planned_ranges,
       MaxFileSizeForLevel(
           *(c->mutable_cf_options()), out_lvl,
           c->immutable_options()->compaction_style, base_level,
@@ -604,18 +646,21 @@ void CompactionJob::GenSubcompactionBoundaries() {
 
   uint64_t next_threshold = target_range_size;
   uint64_t cumulative_size = 0;
-  uint64_t num_actual_subcompactions = 1U;
+  uint64_t num_actual_ranges = 1U;
   for (TableReader::Anchor& anchor : all_anchors) {
     cumulative_size += anchor.range_size;
     if (cumulative_size > next_threshold) {
       next_threshold += target_range_size;
-      num_actual_subcompactions++;
+      num_actual_ranges++;
       boundaries_.push_back(anchor.user_key);
     }
-    if (num_actual_subcompactions == num_planned_subcompactions) {
+    if (num_actual_ranges == num_planned_ranges) {
       break;
     }
   }
+  uint64_t num_actual_subcompactions =
+      std::min(num_actual_ranges, num_planned_subcompactions);
+  num_subcompaction_threads_ = static_cast<size_t>(num_actual_subcompactions);
   TEST_SYNC_POINT_CALLBACK("CompactionJob::GenSubcompactionBoundaries:1",
                            &num_actual_subcompactions);
   // Shrink extra subcompactions resources when extra resrouces are acquired
@@ -624,6 +669,57 @@ void CompactionJob::GenSubcompactionBoundaries() {
                extra_num_subcompaction_threads_reserved_));
 }
 
+void CompactionJob::CollectHotKeyRanges() {
+  Compaction* const c = compact_->compaction;
+  ColumnFamilyData* const cfd = c->column_family_data();
+  const auto* table_options =
+      cfd->ioptions()->table_factory->GetOptions<BlockBasedTableOptions>();
+  if (table_options == nullptr || table_options->block_cache == nullptr ||
+      table_options->prepopulate_block_cache !=
+          BlockBasedTableOptions::PrepopulateBlockCache::
+              kFlushAndHotCompaction) {
+    return;
+  }
+
+  ReadOptions read_options(Env::IOActivity::kCompaction);
+  read_options.fill_cache = false;
+  for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+    const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+    for (size_t i = 0; i < flevel->num_files; i++) {
+      // Best effort: a file whose ranges cannot be read is not warmed
+      cfd->table_cache()
+          ->GetCachedKeyRanges(
+              read_options, cfd->internal_comparator(),
+              *flevel->files[i].file_metadata,
+              c->mutable_cf_options()->block_protection_bytes_per_key,
+              hot_key_ranges_)
+          .PermitUncheckedError();
+    }
+  }
+  if (hot_key_ranges_.empty()) {
+    return;
+  }
+
+  // The ranges of the files of different levels overlap
+  const Comparator* ucmp = cfd->user_comparator();
+  std::sort(hot_key_ranges_.begin(), hot_key_ranges_.end(),
+            [ucmp](const OwnedUserKeyRange& a, const OwnedUserKeyRange& b) {
+              return ucmp->Compare(a.start, b.start) < 0;
+            });
+  size_t last = 0;
+  for (size_t i = 1; i < hot_key_ranges_.size(); i++) {
+    OwnedUserKeyRange& range = hot_key_ranges_[i];
+    if (ucmp->Compare(range.start, hot_key_ranges_[last].limit) <= 0) {
+      if (ucmp->Compare(range.limit, hot_key_ranges_[last].limit) > 0) {
+        hot_key_ranges_[last].limit = std::move(range.limit);
+      }
+    } else if (++last != i) {
+      hot_key_ranges_[last] = std::move(range);
+    }
+  }
+  hot_key_ranges_.resize(last + 1);
+}
+
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
@@ -631,21 +727,37 @@ Status CompactionJob::Run() {
   log_buffer_->FlushBufferToLog();
   LogCompaction();
 
-  const size_t num_threads = compact_->sub_compact_states.size();
-  assert(num_threads > 0);
+  const size_t num_subcompactions = compact_->sub_compact_states.size();
+  assert(num_subcompactions > 0);
+  const size_t num_threads =
+      num_subcompaction_threads_ > 0
+          ? std::min(num_subcompaction_threads_, num_subcompactions)
+          : num_subcompactions;
   const uint64_t start_micros = db_options_.clock->NowMicros();
 
-  // Launch a thread for each of subcompactions 1...num_threads-1
+  CollectHotKeyRanges();
+
+  // Each thread runs the subcompactions in key order, taking the next one
+  // no thread has started, until none is left
+  std::atomic<size_t> next_subcompaction(num_threads);
+  auto process_subcompactions = [&](size_t first) {
+    for (size_t i = first; i < num_subcompactions;
+         i = next_subcompaction.fetch_add(1, std::memory_order_relaxed)) {
+      ProcessKeyValueCompaction(&compact_->sub_compact_states[i]);
+    }
+  };
+
+  // Launch threads 1...num_threads-1, which start with the subcompaction of
+  // the same index
   std::vector<port::Thread> thread_pool;
   thread_pool.reserve(num_threads - 1);
-  for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
-    thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this,
-                             &compact_->sub_compact_states[i]);
+  for (size_t i = 1; i < num_threads; i++) {
+    thread_pool.emplace_back(process_subcompactions, i);
   }
 
   // Always schedule the first subcompaction (whether or not there are also
   // others) in the current thread to be efficient with resources
-  ProcessKeyValueCompaction(compact_->sub_compact_states.data());
+  process_subcompactions(0);
 
   // Wait for all other threads (if there are any) to finish execution
   for (auto& thread : thread_pool) {
@@ -780,7 +892,7 @@ Status CompactionJob::Run() {
         }
       }
     };
-    for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
+    for (size_t i = 1; i < num_threads; i++) {
       thread_pool.emplace_back(
           verify_table, std::ref(compact_->sub_compact_states[i].status));
     }
@@ -816,6 +928,14 @@ Status CompactionJob::Run() {
   compact_->AggregateCompactionStats(compaction_stats_, *compaction_job_stats_);
   uint64_t num_input_range_del = 0;
   bool ok = UpdateCompactionStats(&num_input_range_del);
+  TenantUsage* const tenant_usage =
+      compact_->compaction->immutable_options()->tenant_usage.get();
+  if (tenant_usage != nullptr) {
+    tenant_usage->Add(kTenantCompactionBytesWritten,
+                      compaction_stats_.TotalBytesWritten());
+    tenant_usage->Add(kTenantCompactionCpuMicros,
+                      compaction_stats_.stats.cpu_micros);
+  }
   // (Sub)compactions returned ok, do sanity check on the number of input keys.
   if (status.ok() && ok && compaction_job_stats_->has_num_input_records) {
     size_t ts_sz = compact_->compaction->column_family_data()
@@ -1159,10 +1279,23 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     }
   }
 
+  // With an input pipeline, the input iterators are read on another thread,
+  // so they add their range tombstones to deferred_range_del_agg, and the
+  // pipeline moves them over to range_del_agg.
+  const size_t input_pipeline_size =
+      mutable_db_options_copy_.compaction_input_pipeline_size;
+  std::unique_ptr<DeferredRangeDelAggregator> deferred_range_del_agg;
+  RangeDelAggregator* input_range_del_agg = range_del_agg.get();
+  if (input_pipeline_size > 0) {
+    deferred_range_del_agg = std::make_unique<DeferredRangeDelAggregator>(
+        &cfd->internal_comparator());
+    input_range_del_agg = deferred_range_del_agg.get();
+  }
+
   // Although the v2 aggregator is what the level iterator(s) know about,
   // the AddTombstones calls will be propagated down to the v1 aggregator.
   std::unique_ptr<InternalIterator> raw_input(versions_->MakeInputIterator(
-      read_options, sub_compact->compaction, range_del_agg.get(),
+      read_options, sub_compact->compaction, input_range_del_agg,
       file_options_for_read_, start, end));
   InternalIterator* input = raw_input.get();
 
@@ -1228,6 +1361,14 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     input = trim_history_iter.get();
   }
 
+  std::unique_ptr<InternalIterator> pipelined_input;
+  if (deferred_range_del_agg) {
+    pipelined_input = std::make_unique<PipelinedInputIterator>(
+        input, deferred_range_del_agg.get(), range_del_agg.get(),
+        input_pipeline_size);
+    input = pipelined_input.get();
+  }
+
   input->SeekToFirst();
 
   AutoThreadOperationStageUpdater stage_updater(
@@ -1493,6 +1634,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   }
 #endif  // ROCKSDB_ASSERT_STATUS_CHECKED
 
+  // Stop the reader thread before the iterators below it go away
+  pipelined_input.reset();
   blob_counter.reset();
   clip.reset();
   raw_input.reset();
@@ -1751,6 +1894,7 @@ Status CompactionJob::InstallCompactionResults(
 
   // Add compaction inputs
   compaction->AddInputDeletions(edit);
+  compaction->AddMovedInputs(edit);
 
   std::unordered_map<uint64_t, BlobGarbageMeter::BlobStats> blob_total_garbage;
 
@@ -1972,6 +2116,7 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
       bottommost_level_, TableFileCreationReason::kCompaction,
       0 /* oldest_key_time */, current_time, db_id_, db_session_id_,
       sub_compact->compaction->max_output_file_size(), file_number);
+  tboptions.hot_key_ranges = &hot_key_ranges_;
 
   outputs.NewBuilder(tboptions);
 
@@ -2008,7 +2153,9 @@ bool CompactionJob::UpdateCompactionStats(uint64_t* num_input_range_del) {
   for (int input_level = 0;
        input_level < static_cast<int>(compaction->num_input_levels());
        ++input_level) {
-    size_t num_input_files = compaction->num_input_files(input_level);
+    // The files kept by Compaction::ReuseNonOverlappingInputs() are not read
+    const LevelFilesBrief* flevel = compaction->input_levels(input_level);
+    size_t num_input_files = flevel->num_files;
     uint64_t* bytes_read;
     if (compaction->level(input_level) != compaction->output_level()) {
       compaction_stats_.stats.num_input_files_in_non_output_levels +=
@@ -2020,7 +2167,7 @@ bool CompactionJob::UpdateCompactionStats(uint64_t* num_input_range_del) {
       bytes_read = &compaction_stats_.stats.bytes_read_output_level;
     }
     for (size_t i = 0; i < num_input_files; ++i) {
-      const FileMetaData* file_meta = compaction->input(input_level, i);
+      const FileMetaData* file_meta = flevel->files[i].file_metadata;
       *bytes_read += file_meta->fd.GetFileSize();
       uint64_t file_input_entries = file_meta->num_entries;
       uint64_t file_num_range_del = file_meta->num_range_deletions;
@@ -2045,6 +2192,21 @@ bool CompactionJob::UpdateCompactionStats(uint64_t* num_input_range_del) {
     }
   }
 
+  compaction_stats_.stats.bytes_moved = 0;
+  for (int input_level = 0;
+       input_level < static_cast<int>(compaction->num_input_levels());
+       ++input_level) {
+    if (compaction->level(input_level) == compaction->output_level()) {
+      continue;
+    }
+    for (const FileMetaData* file_meta :
+         *compaction->inputs(input_level)) {
+      if (compaction->IsReusedInput(file_meta)) {
+        compaction_stats_.stats.bytes_moved += file_meta->fd.GetFileSize();
+      }
+    }
+  }
+
   assert(compaction_job_stats_);
   compaction_stats_.stats.bytes_read_blob =
       compaction_job_stats_->total_blob_bytes_read;
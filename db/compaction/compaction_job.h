@@ -247,6 +247,13 @@ class CompactionJob {
   // extra reserved resources
   uint64_t GetSubcompactionsLimit();
 
+  // Collects into hot_key_ranges_ the key ranges of the input data blocks
+  // that are in the block cache, if the table options ask to warm the data
+  // blocks of those ranges in the output files (see
+  // BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction).
+  // Does not need the DB mutex.
+  void CollectHotKeyRanges();
+
   // Additional reserved threads are reserved and the number is stored in
   // extra_num_subcompaction_threads_reserved__. For now, this happens only if
   // the compaction priority is round-robin and max_subcompactions is not
@@ -331,6 +338,13 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<std::string> boundaries_;
+  // The sorted, disjoint user key ranges of the data blocks to warm in the
+  // block cache when writing the output files
+  std::vector<OwnedUserKeyRange> hot_key_ranges_;
+  // The number of threads that run the subcompactions, each taking the next
+  // subcompaction no thread has started, or 0 for one thread per
+  // subcompaction
+  size_t num_subcompaction_threads_;
   Env::Priority thread_pri_;
   std::string full_history_ts_low_;
   std::string trim_ts_;
@@ -261,6 +261,13 @@ bool CompactionOutputs::ShouldStopBefore(const CompactionIterator& c_iter) {
     return true;
   }
 
+  // An output file must not span an input file that stays in the output
+  // level
+  if (compaction_->HasReusedInputBetween(
+          current_output().meta.largest.user_key(), c_iter.user_key())) {
+    return true;
+  }
+
   // If there's user defined partitioner, check that first
   if (partitioner_ && partitioner_->ShouldPartition(PartitionerRequest(
                           last_key_for_partitioner_, c_iter.user_key(),
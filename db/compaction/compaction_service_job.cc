@@ -10,6 +10,7 @@
 
 #include "db/compaction/compaction_job.h"
 #include "db/compaction/compaction_state.h"
+#include "file/filename.h"
 #include "logging/logging.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/thread_status_util.h"
@@ -74,6 +75,14 @@ CompactionJob::ProcessKeyValueCompactionWithCompactionService(
       compaction_input.output_level, input_files_oss.str().c_str());
   CompactionServiceJobInfo info(dbname_, db_id_, db_session_id_,
                                 GetCompactionId(sub_compact), thread_pri_);
+  // Greater than the pending outputs of the compaction, so not deleted as
+  // obsolete before they are installed
+  info.num_reserved_file_numbers =
+      db_options_.compaction_service->GetNumReservedFileNumbers();
+  if (info.num_reserved_file_numbers > 0) {
+    info.first_reserved_file_number =
+        versions_->FetchAddFileNumber(info.num_reserved_file_numbers);
+  }
   CompactionServiceScheduleResponse response =
       db_options_.compaction_service->Schedule(info, compaction_input_binary);
   switch (response.status) {
@@ -166,15 +175,36 @@ CompactionJob::ProcessKeyValueCompactionWithCompactionService(
     return CompactionServiceJobStatus::kFailure;
   }
 
+  std::vector<bool> reserved_file_number_used(info.num_reserved_file_numbers);
   for (const auto& file : compaction_result.output_files) {
-    uint64_t file_num = versions_->NewFileNumber();
     auto src_file = compaction_result.output_path + "/" + file.file_name;
-    auto tgt_file = TableFileName(compaction->immutable_options()->cf_paths,
-                                  file_num, compaction->output_path_id());
-    s = fs_->RenameFile(src_file, tgt_file, IOOptions(), nullptr);
-    if (!s.ok()) {
-      sub_compact->status = s;
-      return CompactionServiceJobStatus::kFailure;
+    // Installed where it is if the worker put it in place of a file number
+    // reserved for the job
+    uint64_t file_num = 0;
+    FileType file_type;
+    std::string tgt_file;
+    if (ParseFileName(file.file_name, &file_num, &file_type) &&
+        file_type == kTableFile &&
+        file_num >= info.first_reserved_file_number &&
+        file_num - info.first_reserved_file_number <
+            info.num_reserved_file_numbers &&
+        !reserved_file_number_used[file_num -
+                                   info.first_reserved_file_number]) {
+      tgt_file = TableFileName(compaction->immutable_options()->cf_paths,
+                               file_num, compaction->output_path_id());
+    }
+    if (!tgt_file.empty() && tgt_file == src_file) {
+      reserved_file_number_used[file_num - info.first_reserved_file_number] =
+          true;
+    } else {
+      file_num = versions_->NewFileNumber();
+      tgt_file = TableFileName(compaction->immutable_options()->cf_paths,
+                               file_num, compaction->output_path_id());
+      s = fs_->RenameFile(src_file, tgt_file, IOOptions(), nullptr);
+      if (!s.ok()) {
+        sub_compact->status = s;
+        return CompactionServiceJobStatus::kFailure;
+      }
     }
 
     FileMetaData meta;
@@ -0,0 +1,183 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/pipelined_input_iterator.h"
+
+#include <algorithm>
+
+#include "monitoring/iostats_context_imp.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The number of batches the reader thread may queue up. More batches smooth
+// out the stalls of both threads, fewer make each batch larger.
+constexpr size_t kMaxBatches = 4;
+}  // namespace
+
+PipelinedInputIterator::PipelinedInputIterator(
+    InternalIterator* iter, DeferredRangeDelAggregator* deferred_agg,
+    RangeDelAggregator* range_del_agg, size_t max_buffered_bytes)
+    : iter_(iter),
+      deferred_agg_(deferred_agg),
+      range_del_agg_(range_del_agg),
+      batch_bytes_(std::max<size_t>(max_buffered_bytes / kMaxBatches, 1)),
+      max_batches_(kMaxBatches),
+      stop_(false),
+      pos_(0) {
+  assert(iter_);
+  assert(deferred_agg_);
+  assert(range_del_agg_);
+}
+
+PipelinedInputIterator::~PipelinedInputIterator() { Stop(); }
+
+void PipelinedInputIterator::SeekToFirst() { Start(nullptr); }
+
+void PipelinedInputIterator::Seek(const Slice& target) {
+  // The target may point into the current batch, which Start() drops
+  const std::string target_copy = target.ToString();
+  Start(&target_copy);
+}
+
+void PipelinedInputIterator::SeekToLast() {
+  assert(false);
+  Stop();
+  status_ = Status::NotSupported("SeekToLast() on a compaction input");
+}
+
+void PipelinedInputIterator::SeekForPrev(const Slice& /*target*/) {
+  assert(false);
+  Stop();
+  status_ = Status::NotSupported("SeekForPrev() on a compaction input");
+}
+
+void PipelinedInputIterator::Prev() {
+  assert(false);
+  Stop();
+  status_ = Status::NotSupported("Prev() on a compaction input");
+}
+
+void PipelinedInputIterator::Next() {
+  assert(Valid());
+  ++pos_;
+  if (pos_ == current_->entries.size() && !current_->last) {
+    NextBatch();
+  }
+}
+
+bool PipelinedInputIterator::NextAndGetResult(IterateResult* result) {
+  Next();
+  const bool is_valid = Valid();
+  if (is_valid) {
+    result->key = key();
+    result->bound_check_result = IterBoundCheck::kUnknown;
+    result->value_prepared = true;
+  }
+  return is_valid;
+}
+
+void PipelinedInputIterator::Start(const std::string* target) {
+  Stop();
+  status_ = Status::OK();
+  queue_.reset(new WorkQueue<Batch*>(max_batches_));
+  stop_.store(false, std::memory_order_relaxed);
+  reader_ = port::Thread(&PipelinedInputIterator::ReadInput, this,
+                         target != nullptr,
+                         target != nullptr ? *target : std::string());
+  NextBatch();
+}
+
+void PipelinedInputIterator::Stop() {
+  if (!reader_.joinable()) {
+    return;
+  }
+  stop_.store(true, std::memory_order_relaxed);
+  queue_->finish();
+  reader_.join();
+  // The files whose tombstones these are were read already, so their
+  // tombstones would not be added again after a restart
+  Batch* batch = nullptr;
+  while (queue_->pop(batch)) {
+    std::unique_ptr<Batch> dropped(batch);
+    ApplyTombstones(dropped.get());
+    IOSTATS_ADD(bytes_read, dropped->bytes_read);
+  }
+  Batch rest;
+  deferred_agg_->TakePending(&rest.tombstones);
+  ApplyTombstones(&rest);
+  current_.reset();
+  previous_.reset();
+  pos_ = 0;
+}
+
+void PipelinedInputIterator::ReadInput(bool seek, std::string target) {
+  if (seek) {
+    iter_->Seek(target);
+  } else {
+    iter_->SeekToFirst();
+  }
+  while (!stop_.load(std::memory_order_relaxed)) {
+    std::unique_ptr<Batch> batch(new Batch);
+    while (iter_->Valid() && batch->data.size() < batch_bytes_) {
+      const Slice k = iter_->key();
+      const Slice v = iter_->value();
+      batch->entries.push_back({batch->data.size(), k.size(), v.size(),
+                                iter_->IsDeleteRangeSentinelKey()});
+      batch->data.append(k.data(), k.size());
+      batch->data.append(v.data(), v.size());
+      iter_->Next();
+    }
+    if (!iter_->Valid()) {
+      batch->last = true;
+      batch->status = iter_->status();
+    }
+    deferred_agg_->TakePending(&batch->tombstones);
+    batch->bytes_read = IOSTATS(bytes_read);
+    IOSTATS_RESET(bytes_read);
+    TEST_SYNC_POINT("PipelinedInputIterator::ReadInput:BatchReady");
+
+    const bool last = batch->last;
+    if (!queue_->push(batch.get())) {
+      // Stopped. Leave the tombstones for Stop() to apply.
+      for (auto& t : batch->tombstones) {
+        deferred_agg_->AddTombstones(std::move(t.iter), t.smallest,
+                                     t.largest);
+      }
+      return;
+    }
+    batch.release();
+    if (last) {
+      return;
+    }
+  }
+}
+
+void PipelinedInputIterator::NextBatch() {
+  previous_ = std::move(current_);
+  pos_ = 0;
+  Batch* batch = nullptr;
+  // Only Stop() finishes the queue, and the reader thread queues a last
+  // batch before it exits on its own
+  bool popped = queue_->pop(batch);
+  assert(popped);
+  (void)popped;
+  current_.reset(batch);
+  ApplyTombstones(batch);
+  IOSTATS_ADD(bytes_read, batch->bytes_read);
+  if (batch->last) {
+    status_ = batch->status;
+  }
+}
+
+void PipelinedInputIterator::ApplyTombstones(Batch* batch) {
+  for (auto& t : batch->tombstones) {
+    range_del_agg_->AddTombstones(std::move(t.iter), t.smallest, t.largest);
+  }
+  batch->tombstones.clear();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
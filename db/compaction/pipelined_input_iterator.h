@@ -0,0 +1,170 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/range_del_aggregator.h"
+#include "port/port.h"
+#include "table/internal_iterator.h"
+#include "util/work_queue.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A RangeDelAggregator that only holds on to the range tombstones added to
+// it. The input iterators of a pipelined compaction add the tombstones of
+// each file they open to one of these on the reader thread, and
+// PipelinedInputIterator hands them over to the aggregator of the compaction
+// on the merge thread.
+class DeferredRangeDelAggregator : public RangeDelAggregator {
+ public:
+  struct Tombstones {
+    std::unique_ptr<FragmentedRangeTombstoneIterator> iter;
+    const InternalKey* smallest;
+    const InternalKey* largest;
+  };
+
+  explicit DeferredRangeDelAggregator(const InternalKeyComparator* icmp)
+      : RangeDelAggregator(icmp) {}
+
+  void AddTombstones(
+      std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter,
+      const InternalKey* smallest = nullptr,
+      const InternalKey* largest = nullptr) override {
+    if (input_iter == nullptr || input_iter->empty()) {
+      return;
+    }
+    pending_.push_back({std::move(input_iter), smallest, largest});
+  }
+
+  using RangeDelAggregator::ShouldDelete;
+  bool ShouldDelete(const ParsedInternalKey& /*parsed*/,
+                    RangeDelPositioningMode /*mode*/) override {
+    assert(false);
+    return false;
+  }
+
+  void InvalidateRangeDelMapPositions() override {}
+
+  bool IsEmpty() const override { return pending_.empty(); }
+
+  // Moves the tombstones added since the last call to *tombstones
+  void TakePending(std::vector<Tombstones>* tombstones) {
+    for (auto& t : pending_) {
+      tombstones->push_back(std::move(t));
+    }
+    pending_.clear();
+  }
+
+ private:
+  std::vector<Tombstones> pending_;
+};
+
+// An internal iterator that reads another one, together with the files and
+// blocks below it, on a separate thread. The reader thread copies the keys
+// and values into batches and queues up to `max_buffered_bytes` of them
+// ahead of the thread that reads this iterator, which only ever waits for a
+// whole batch. The range tombstones that the input added to `deferred_agg`
+// while reading a batch are added to `range_del_agg` before any entry of the
+// batch is returned, so the tombstones covering a key are known as early as
+// without the pipeline.
+//
+// Only forward iteration is supported, which is all a compaction needs. A
+// Seek() stops the reader thread, which then restarts at the target. The
+// input is only touched by the reader thread between SeekToFirst() or Seek()
+// and the next Seek() or the destruction of this iterator.
+class PipelinedInputIterator : public InternalIterator {
+ public:
+  PipelinedInputIterator(InternalIterator* iter,
+                         DeferredRangeDelAggregator* deferred_agg,
+                         RangeDelAggregator* range_del_agg,
+                         size_t max_buffered_bytes);
+  ~PipelinedInputIterator() override;
+
+  bool Valid() const override {
+    return current_ != nullptr && pos_ < current_->entries.size();
+  }
+
+  void SeekToFirst() override;
+  void SeekToLast() override;
+  void Seek(const Slice& target) override;
+  void SeekForPrev(const Slice& target) override;
+  void Next() override;
+  bool NextAndGetResult(IterateResult* result) override;
+  void Prev() override;
+
+  Slice key() const override {
+    assert(Valid());
+    const Entry& entry = current_->entries[pos_];
+    return Slice(current_->data.data() + entry.offset, entry.key_size);
+  }
+
+  Slice value() const override {
+    assert(Valid());
+    const Entry& entry = current_->entries[pos_];
+    return Slice(current_->data.data() + entry.offset + entry.key_size,
+                 entry.value_size);
+  }
+
+  Status status() const override { return status_; }
+
+  bool IsDeleteRangeSentinelKey() const override {
+    assert(Valid());
+    return current_->entries[pos_].is_sentinel;
+  }
+
+ private:
+  struct Entry {
+    size_t offset;
+    size_t key_size;
+    size_t value_size;
+    bool is_sentinel;
+  };
+
+  struct Batch {
+    // The keys and values, each key followed by its value
+    std::string data;
+    std::vector<Entry> entries;
+    std::vector<DeferredRangeDelAggregator::Tombstones> tombstones;
+    // The input bytes read from files while filling the batch
+    uint64_t bytes_read = 0;
+    // Whether the input ended after this batch, with status
+    bool last = false;
+    Status status;
+  };
+
+  // Starts the reader thread at target, or at the first key if null
+  void Start(const std::string* target);
+  // Stops the reader thread and drops the batches it queued
+  void Stop();
+  void ReadInput(bool seek, std::string target);
+  // Moves to the next batch, waiting for the reader thread if needed
+  void NextBatch();
+  void ApplyTombstones(Batch* batch);
+
+  InternalIterator* const iter_;
+  DeferredRangeDelAggregator* const deferred_agg_;
+  RangeDelAggregator* const range_del_agg_;
+  const size_t batch_bytes_;
+  const size_t max_batches_;
+
+  std::unique_ptr<WorkQueue<Batch*>> queue_;
+  port::Thread reader_;
+  // Tells the reader thread to stop before filling another batch
+  std::atomic<bool> stop_;
+
+  std::unique_ptr<Batch> current_;
+  // The batch before current_, kept so that the entries returned last stay
+  // valid for one more batch
+  std::unique_ptr<Batch> previous_;
+  size_t pos_;
+  Status status_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,239 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/pipelined_input_iterator.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/range_tombstone_fragmenter.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/vector_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+static auto bytewise_icmp = InternalKeyComparator(BytewiseComparator());
+
+// A vector iterator that adds range tombstones to an aggregator when it
+// reaches a given key, like a LevelIterator does when it opens a file
+class TombstoneAddingIterator : public VectorIterator {
+ public:
+  TombstoneAddingIterator(const std::vector<std::string>& keys,
+                          const std::vector<std::string>& values,
+                          const std::string& open_key,
+                          FragmentedRangeTombstoneList* tombstones,
+                          RangeDelAggregator* range_del_agg)
+      : VectorIterator(keys, values, &bytewise_icmp),
+        open_key_(open_key),
+        tombstones_(tombstones),
+        range_del_agg_(range_del_agg),
+        added_(false) {}
+
+  bool added() const { return added_.load(); }
+
+  void SeekToFirst() override {
+    VectorIterator::SeekToFirst();
+    MaybeAddTombstones();
+  }
+
+  void Seek(const Slice& target) override {
+    VectorIterator::Seek(target);
+    MaybeAddTombstones();
+  }
+
+  void Next() override {
+    VectorIterator::Next();
+    MaybeAddTombstones();
+  }
+
+ private:
+  void MaybeAddTombstones() {
+    if (tombstones_ == nullptr || !Valid() ||
+        ExtractUserKey(key()) != Slice(open_key_)) {
+      return;
+    }
+    range_del_agg_->AddTombstones(
+        std::make_unique<FragmentedRangeTombstoneIterator>(
+            tombstones_, bytewise_icmp, kMaxSequenceNumber));
+    tombstones_ = nullptr;
+    added_.store(true);
+  }
+
+  const std::string open_key_;
+  FragmentedRangeTombstoneList* tombstones_;
+  RangeDelAggregator* const range_del_agg_;
+  std::atomic<bool> added_;
+};
+
+}  // namespace
+
+class PipelinedInputIteratorTest : public testing::Test {
+ protected:
+  PipelinedInputIteratorTest() {
+    for (int i = 0; i < 100; i++) {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "key%03d", i);
+      keys_.push_back(test::KeyStr(buf, 1000 - i, kTypeValue));
+      values_.push_back("value" + std::to_string(i));
+    }
+  }
+
+  std::vector<std::string> keys_;
+  std::vector<std::string> values_;
+};
+
+TEST_F(PipelinedInputIteratorTest, ForwardIteration) {
+  // From one entry per batch to all entries in one batch
+  for (size_t buffered_bytes : {1, 256, 4096, 1 << 20}) {
+    VectorIterator input(keys_, values_, &bytewise_icmp);
+    std::vector<SequenceNumber> snapshots;
+    CompactionRangeDelAggregator range_del_agg(&bytewise_icmp, snapshots);
+    DeferredRangeDelAggregator deferred_agg(&bytewise_icmp);
+    PipelinedInputIterator iter(&input, &deferred_agg, &range_del_agg,
+                                buffered_bytes);
+
+    size_t i = 0;
+    for (iter.SeekToFirst(); iter.Valid(); iter.Next(), i++) {
+      ASSERT_LT(i, keys_.size());
+      ASSERT_EQ(keys_[i], iter.key().ToString());
+      ASSERT_EQ(values_[i], iter.value().ToString());
+      ASSERT_FALSE(iter.IsDeleteRangeSentinelKey());
+    }
+    ASSERT_OK(iter.status());
+    ASSERT_EQ(keys_.size(), i);
+  }
+}
+
+TEST_F(PipelinedInputIteratorTest, Seek) {
+  VectorIterator input(keys_, values_, &bytewise_icmp);
+  std::vector<SequenceNumber> snapshots;
+  CompactionRangeDelAggregator range_del_agg(&bytewise_icmp, snapshots);
+  DeferredRangeDelAggregator deferred_agg(&bytewise_icmp);
+  PipelinedInputIterator iter(&input, &deferred_agg, &range_del_agg, 256);
+
+  iter.SeekToFirst();
+  ASSERT_TRUE(iter.Valid());
+  iter.Next();
+  ASSERT_EQ(keys_[1], iter.key().ToString());
+
+  // Seek to a key in a batch that is still queued
+  iter.Seek(keys_[60]);
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(keys_[60], iter.key().ToString());
+  iter.Next();
+  ASSERT_EQ(keys_[61], iter.key().ToString());
+
+  // Seek to the key iter is on
+  iter.Seek(iter.key());
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(keys_[61], iter.key().ToString());
+
+  // Seek past the last key
+  iter.Seek(test::KeyStr("zzz", kMaxSequenceNumber, kValueTypeForSeek));
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_OK(iter.status());
+
+  // Seek back to a key before the previous seeks
+  iter.Seek(keys_[10]);
+  size_t i = 10;
+  for (; iter.Valid(); iter.Next(), i++) {
+    ASSERT_EQ(keys_[i], iter.key().ToString());
+  }
+  ASSERT_OK(iter.status());
+  ASSERT_EQ(keys_.size(), i);
+}
+
+TEST_F(PipelinedInputIteratorTest, RangeTombstones) {
+  // Covers key010 through key019 below sequence number 995, which the
+  // entries of key010 through key019 are
+  std::vector<std::string> tombstone_keys;
+  std::vector<std::string> tombstone_values;
+  auto key_and_value = RangeTombstone("key010", "key020", 995).Serialize();
+  tombstone_keys.push_back(key_and_value.first.Encode().ToString());
+  tombstone_values.push_back(key_and_value.second.ToString());
+  FragmentedRangeTombstoneList tombstones(
+      std::make_unique<VectorIterator>(tombstone_keys, tombstone_values,
+                                       &bytewise_icmp),
+      bytewise_icmp);
+
+  for (size_t buffered_bytes : {1, 256, 1 << 20}) {
+    std::vector<SequenceNumber> snapshots;
+    CompactionRangeDelAggregator range_del_agg(&bytewise_icmp, snapshots);
+    DeferredRangeDelAggregator deferred_agg(&bytewise_icmp);
+    TombstoneAddingIterator input(keys_, values_, "key005", &tombstones,
+                                  &deferred_agg);
+    PipelinedInputIterator iter(&input, &deferred_agg, &range_del_agg,
+                                buffered_bytes);
+
+    size_t i = 0;
+    for (iter.SeekToFirst(); iter.Valid(); iter.Next(), i++) {
+      // The tombstones are added no later than the key that brought them
+      if (i >= 5) {
+        ASSERT_FALSE(range_del_agg.IsEmpty());
+      }
+      ParsedInternalKey ikey;
+      ASSERT_OK(ParseInternalKey(iter.key(), &ikey, true));
+      ASSERT_EQ(i >= 10 && i < 20,
+                range_del_agg.ShouldDelete(
+                    ikey, RangeDelPositioningMode::kForwardTraversal));
+    }
+    ASSERT_OK(iter.status());
+    ASSERT_EQ(keys_.size(), i);
+  }
+}
+
+TEST_F(PipelinedInputIteratorTest, RangeTombstonesOfDroppedBatches) {
+  std::vector<std::string> tombstone_keys;
+  std::vector<std::string> tombstone_values;
+  auto key_and_value = RangeTombstone("key050", "key060", 995).Serialize();
+  tombstone_keys.push_back(key_and_value.first.Encode().ToString());
+  tombstone_values.push_back(key_and_value.second.ToString());
+  FragmentedRangeTombstoneList tombstones(
+      std::make_unique<VectorIterator>(tombstone_keys, tombstone_values,
+                                       &bytewise_icmp),
+      bytewise_icmp);
+
+  std::vector<SequenceNumber> snapshots;
+  CompactionRangeDelAggregator range_del_agg(&bytewise_icmp, snapshots);
+  DeferredRangeDelAggregator deferred_agg(&bytewise_icmp);
+  TombstoneAddingIterator input(keys_, values_, "key003", &tombstones,
+                                &deferred_agg);
+  // One entry per batch
+  PipelinedInputIterator iter(&input, &deferred_agg, &range_del_agg, 1);
+
+  iter.SeekToFirst();
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(keys_[0], iter.key().ToString());
+  ASSERT_TRUE(range_del_agg.IsEmpty());
+  // Wait for the reader thread to queue the batch with the tombstones
+  while (!input.added()) {
+    std::this_thread::yield();
+  }
+
+  // The seek drops the queued batches, but not their tombstones, which the
+  // input will not add again
+  iter.Seek(keys_[50]);
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_FALSE(range_del_agg.IsEmpty());
+  ParsedInternalKey ikey;
+  ASSERT_OK(ParseInternalKey(iter.key(), &ikey, true));
+  ASSERT_TRUE(range_del_agg.ShouldDelete(
+      ikey, RangeDelPositioningMode::kForwardTraversal));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
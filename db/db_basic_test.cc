@@ -852,6 +852,76 @@ TEST_F(DBBasicTest, Snapshot) {
   } while (ChangeOptions());
 }
 
+TEST_F(DBBasicTest, SharedSnapshots) {
+  Options options = CurrentOptions();
+  options.share_snapshots = true;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  const Snapshot* s1 = db_->GetSnapshot();
+  const Snapshot* s2 = db_->GetSnapshot();
+  // No write in between
+  ASSERT_EQ(s1, s2);
+  ASSERT_EQ(1U, GetNumSnapshots());
+
+  ASSERT_OK(Put("foo", "v2"));
+  const Snapshot* s3 = db_->GetSnapshot();
+  ASSERT_NE(s1, s3);
+  ASSERT_EQ(2U, GetNumSnapshots());
+  ASSERT_EQ(GetSequenceOldestSnapshots(), s1->GetSequenceNumber());
+
+  // The first release only drops a reference
+  db_->ReleaseSnapshot(s1);
+  ASSERT_EQ(2U, GetNumSnapshots());
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("v1", Get("foo", s2));
+  ASSERT_EQ("v2", Get("foo", s3));
+
+  db_->ReleaseSnapshot(s2);
+  ASSERT_EQ(1U, GetNumSnapshots());
+  ASSERT_EQ(GetSequenceOldestSnapshots(), s3->GetSequenceNumber());
+  db_->ReleaseSnapshot(s3);
+  ASSERT_EQ(0U, GetNumSnapshots());
+
+  // Released snapshots are recycled for later sequence numbers
+  ASSERT_OK(Put("foo", "v3"));
+  const Snapshot* s4 = db_->GetSnapshot();
+  ASSERT_EQ("v3", Get("foo", s4));
+  ASSERT_EQ(1U, GetNumSnapshots());
+
+  // Concurrently with writes
+  std::atomic<bool> stop{false};
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      while (!stop.load()) {
+        const Snapshot* s = db_->GetSnapshot();
+        ASSERT_NE(s, nullptr);
+        ReadOptions read_options;
+        read_options.snapshot = s;
+        std::string value1, value2;
+        ASSERT_OK(db_->Get(read_options, "foo", &value1));
+        ASSERT_OK(db_->Get(read_options, "foo", &value2));
+        ASSERT_EQ(value1, value2);
+        db_->ReleaseSnapshot(s);
+      }
+    });
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put("foo", "v" + std::to_string(i)));
+  }
+  stop.store(true);
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(1U, GetNumSnapshots());
+  ASSERT_EQ("v3", Get("foo", s4));
+  db_->ReleaseSnapshot(s4);
+  ASSERT_EQ(0U, GetNumSnapshots());
+}
+
 
 class DBBasicMultiConfigs : public DBBasicTest,
                             public ::testing::WithParamInterface<int> {
@@ -466,6 +466,60 @@ TEST_F(DBBlockCacheTest, WarmCacheWithDataBlocksDuringFlush) {
             options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
 }
 
+TEST_F(DBBlockCacheTest, WarmCacheWithHotDataBlocksDuringCompaction) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  table_options.cache_index_and_filter_blocks = false;
+  // One key per data block
+  table_options.block_size = kValueSize / 2;
+  table_options.prepopulate_block_cache =
+      BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  std::string value(kValueSize, 'a');
+  for (int file = 0; file < 2; file++) {
+    for (size_t i = 0; i < kNumBlocks; i++) {
+      ASSERT_OK(Put(Key(static_cast<int>(i)), value));
+    }
+    ASSERT_OK(Flush());
+  }
+  // Drop the blocks warmed by the flushes, then read a few keys so that only
+  // their blocks are in the cache when the compaction starts
+  table_options.block_cache->EraseUnRefEntries();
+  const std::vector<int> hot_keys = {1, 5, 6};
+  for (int k : hot_keys) {
+    ASSERT_EQ(value, Get(Key(k)));
+  }
+
+  const uint64_t data_add =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), /*begin=*/nullptr,
+                              /*end=*/nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  // Only the output blocks of the hot keys are added, plus at most a
+  // neighbor of each range whose start the index separators round down to
+  const uint64_t compaction_data_add =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD) - data_add;
+  ASSERT_GE(compaction_data_add, hot_keys.size());
+  ASSERT_LE(compaction_data_add, 2 * hot_keys.size());
+
+  ASSERT_OK(options.statistics->Reset());
+  for (int k : hot_keys) {
+    ASSERT_EQ(value, Get(Key(k)));
+  }
+  ASSERT_EQ(0, options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(hot_keys.size(),
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_HIT));
+  ASSERT_EQ(value, Get(Key(9)));
+  ASSERT_EQ(1, options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+}
+
 // This test cache data, index and filter blocks during flush.
 class DBBlockCacheTest1 : public DBTestBase,
                           public ::testing::WithParamInterface<uint32_t> {
@@ -896,6 +950,57 @@ TEST_F(DBBlockCacheTest, ParanoidFileChecks) {
             TestGetTickerCount(options, BLOCK_CACHE_ADD));
 }
 
+TEST_F(DBBlockCacheTest, CacheMmapReadBlocks) {
+  if (!IsMemoryMappedAccessSupported()) {
+    ROCKSDB_GTEST_SKIP("Test requires default environment");
+    return;
+  }
+  for (bool cache_mmap_read_blocks : {false, true}) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    options.allow_mmap_reads = true;
+    options.populate_mmap_reads = true;
+    options.huge_pages_for_mmap_reads = true;
+    options.compression = kNoCompression;
+    BlockBasedTableOptions table_options;
+    table_options.block_cache = NewLRUCache(1 << 20);
+    table_options.cache_mmap_read_blocks = cache_mmap_read_blocks;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    ASSERT_OK(Put("foo", "bar"));
+    ASSERT_OK(Flush());
+    ASSERT_OK(options.statistics->Reset());
+
+    for (int i = 0; i < 3; ++i) {
+      PinnableSlice value;
+      ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), "foo",
+                         &value));
+      ASSERT_EQ("bar", value.ToString());
+      // The mapping can go away before the cache entry
+      ASSERT_FALSE(value.IsPinned());
+    }
+    if (cache_mmap_read_blocks) {
+      ASSERT_EQ(1, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+      ASSERT_EQ(2, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+      // Only the block structures are charged, not the mapped contents
+      ASSERT_LT(table_options.block_cache->GetUsage(),
+                table_options.block_size);
+    } else {
+      ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+      ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+    }
+
+    // A reopened file does not find the entries referencing the old mapping
+    Close();
+    ASSERT_OK(options.statistics->Reset());
+    Reopen(options);
+    ASSERT_EQ("bar", Get("foo"));
+    ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  }
+}
+
 TEST_F(DBBlockCacheTest, CacheCompressionDict) {
   const int kNumFiles = 4;
   const int kNumEntriesPerFile = 128;
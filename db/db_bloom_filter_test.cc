@@ -3887,6 +3887,220 @@ TEST_F(DBBloomFilterTest, SstQueryFilter) {
   EXPECT_EQ(TestGetAndResetTickerCount(options, NON_LAST_LEVEL_SEEK_DATA), 0);
 }
 
+TEST_F(DBBloomFilterTest, RangeFilter) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.range_filter_bits_per_key = 10;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  };
+  // Two files over the same key range, one with the keys ending with 0 and
+  // one with the keys ending with 5
+  constexpr int kNumKeys = 1000;
+  for (int offset : {0, 5}) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(key(i * 10 + offset), "value"));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("2", FilesPerLevel());
+  ASSERT_OK(options.statistics->Reset());
+
+  std::string bound;
+  Slice bound_slice;
+  for (int i = 0; i < kNumKeys; i++) {
+    ReadOptions ro;
+    ro.iterate_upper_bound = &bound_slice;
+    // No key in the range
+    bound = key(i * 10 + 4);
+    bound_slice = bound;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek(key(i * 10 + 1));
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+
+    // One key in the range
+    bound = key(i * 10 + 7);
+    bound_slice = bound;
+    iter.reset(db_->NewIterator(ro));
+    iter->Seek(key(i * 10 + 1));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key(i * 10 + 5), iter->key());
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+
+    // Backward, with the lower bound
+    ro.iterate_upper_bound = nullptr;
+    ro.iterate_lower_bound = &bound_slice;
+    bound = key(i * 10 + 6);
+    bound_slice = bound;
+    iter.reset(db_->NewIterator(ro));
+    iter->SeekForPrev(key(i * 10 + 9));
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+  }
+
+  // Each seek checks both files, and nearly all of the 5 checks per key of a
+  // file without keys in range skip the file
+  const uint64_t num_keys = kNumKeys;
+  const uint64_t checked = TestGetTickerCount(options, RANGE_FILTER_CHECKED);
+  const uint64_t useful = TestGetTickerCount(options, RANGE_FILTER_USEFUL);
+  ASSERT_EQ(checked, 6 * num_keys);
+  ASSERT_GT(useful, 5 * num_keys * 9 / 10);
+  ASSERT_LE(useful, 5 * num_keys);
+  ASSERT_LT(TestGetTickerCount(options, NON_LAST_LEVEL_SEEK_DATA),
+            2 * num_keys);
+
+  // Without bounds, the filter is not checked
+  ASSERT_OK(options.statistics->Reset());
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek(key(1));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(key(5), iter->key());
+  ASSERT_EQ(TestGetTickerCount(options, RANGE_FILTER_CHECKED), 0);
+}
+
+TEST_F(DBBloomFilterTest, LevelFilter) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  options.level_filter_bits_per_key = 10;
+  DestroyAndReopen(options);
+
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  };
+  // Two files over the same key range, one with the even keys and one with
+  // the odd keys, and a file with only a range tombstone, which has no level
+  // filter
+  constexpr int kNumKeys = 1000;
+  for (int offset : {0, 1}) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(key(i * 2 + offset), "value" + std::to_string(offset)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             key(100), key(110)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("3", FilesPerLevel());
+
+  auto check = [&]() {
+    ASSERT_OK(options.statistics->Reset());
+    const uint64_t num_keys = kNumKeys;
+    // Keys in the key range of the files, but in neither of them. The range
+    // tombstone covers 5 of them, which stops the lookup at its file.
+    for (int i = 0; i < kNumKeys - 1; i++) {
+      ASSERT_EQ("NOT_FOUND", Get(key(i * 2 + 1) + "x"));
+    }
+    uint64_t checked = TestGetTickerCount(options, LEVEL_FILTER_CHECKED);
+    uint64_t useful = TestGetTickerCount(options, LEVEL_FILTER_USEFUL);
+    ASSERT_EQ(checked, 2 * (num_keys - 6));
+    ASSERT_GT(useful, 2 * (num_keys - 6) * 9 / 10);
+
+    // The keys of the file with the even keys, which the file with the odd
+    // keys, checked first, nearly always rules out
+    ASSERT_OK(options.statistics->Reset());
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(i >= 50 && i < 55 ? "NOT_FOUND" : "value0", Get(key(i * 2)));
+    }
+    checked = TestGetTickerCount(options, LEVEL_FILTER_CHECKED);
+    useful = TestGetTickerCount(options, LEVEL_FILTER_USEFUL);
+    ASSERT_EQ(checked, 2 * (num_keys - 5));
+    ASSERT_GT(useful, (num_keys - 5) * 9 / 10);
+    ASSERT_LE(useful, num_keys - 5);
+
+    std::vector<std::string> keys;
+    std::vector<std::string> expected;
+    for (int i = 95; i < 115; i++) {
+      keys.push_back(key(i));
+      expected.push_back(i >= 100 && i < 110 ? "NOT_FOUND"
+                                             : "value" + std::to_string(i % 2));
+      keys.push_back(key(i) + "x");
+      expected.push_back("NOT_FOUND");
+    }
+    ASSERT_EQ(expected, MultiGet(keys));
+  };
+  check();
+
+  // The level filters of the files whose table readers are not pinned are
+  // loaded too
+  options.max_open_files = 20;
+  Reopen(options);
+  check();
+
+  // Without the option, the level filters are not used
+  options.level_filter_bits_per_key = 0;
+  Reopen(options);
+  ASSERT_OK(options.statistics->Reset());
+  ASSERT_EQ("NOT_FOUND", Get(key(1) + "x"));
+  ASSERT_EQ("value0", Get(key(0)));
+  ASSERT_EQ(TestGetTickerCount(options, LEVEL_FILTER_CHECKED), 0);
+}
+
+TEST_F(DBBloomFilterTest, FilterMemoryBudget) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  };
+  // A large file in L2 and a small one in L0 over the even keys, with
+  // filters of about 12KB and 128 bytes
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_OK(Put(key(i * 2), "value"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  constexpr int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(key(i * 2), "value"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,0,1", FilesPerLevel());
+
+  // Returns the number of filter checks that ruled out an odd key
+  auto filtered = [&]() {
+    EXPECT_OK(options.statistics->Reset());
+    for (int i = 0; i < kNumKeys; i++) {
+      EXPECT_EQ("NOT_FOUND", Get(key(i * 2 + 1)));
+      EXPECT_EQ("value", Get(key(i * 2)));
+    }
+    return TestGetTickerCount(options, BLOOM_FILTER_USEFUL);
+  };
+  ASSERT_GT(filtered(), 2 * kNumKeys * 9 / 10);
+
+  // The filters of L0 fit in the budget, not those of L2
+  ASSERT_OK(dbfull()->SetOptions({{"filter_memory_budget", "4096"}}));
+  uint64_t useful = filtered();
+  ASSERT_GT(useful, kNumKeys * 9 / 10);
+  ASSERT_LE(useful, kNumKeys);
+
+  // No filter fits
+  ASSERT_OK(dbfull()->SetOptions({{"filter_memory_budget", "1"}}));
+  ASSERT_EQ(filtered(), 0);
+
+  ASSERT_OK(dbfull()->SetOptions({{"filter_memory_budget", "0"}}));
+  ASSERT_GT(filtered(), 2 * kNumKeys * 9 / 10);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -442,6 +442,178 @@ TEST_P(DBCompactionTestWithParam, CompactionDeletionTrigger) {
 }
 #endif  // !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 
+TEST_F(DBCompactionTest, InputPipeline) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compaction_input_pipeline_size = 4096;
+  DestroyAndReopen(options);
+
+  std::atomic<int> num_batches{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "PipelinedInputIterator::ReadInput:BatchReady",
+      [&](void*) { num_batches++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int f = 0; f < 3; f++) {
+    for (int i = 0; i < 200; i++) {
+      const std::string key = Key((i * 7 + f) % 300);
+      const std::string value = rnd.RandomString(100);
+      ASSERT_OK(Put(key, value));
+      expected[key] = value;
+    }
+    if (f == 1) {
+      ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                                 Key(50), Key(100)));
+      expected.erase(expected.lower_bound(Key(50)),
+                     expected.lower_bound(Key(100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel(0));
+  // The input was read in many batches
+  ASSERT_GT(num_batches.load(), 10);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  for (int i = 0; i < 300; i++) {
+    auto it = expected.find(Key(i));
+    ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(Key(i)));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_TRUE(it != expected.end());
+    ASSERT_EQ(it->first, iter->key().ToString());
+    ASSERT_EQ(it->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(it == expected.end());
+}
+
+TEST_F(DBCompactionTest, SubcompactionRangesPerThread) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 2;
+  options.subcompaction_ranges_per_thread = 4;
+  options.target_file_size_base = 4096;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  uint64_t num_threads = 0;
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::GenSubcompactionBoundaries:1",
+      [&](void* arg) { num_threads = *static_cast<uint64_t*>(arg); });
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::ProcessKeyValueCompaction()::Processing",
+      [&](void*) {
+        std::lock_guard<std::mutex> lock(mutex);
+        thread_ids.insert(std::this_thread::get_id());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int f = 0; f < 2; f++) {
+    for (int i = 0; i < 1000; i++) {
+      const std::string value = rnd.RandomString(100);
+      ASSERT_OK(Put(Key(i), value));
+      expected[Key(i)] = value;
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // More ranges than threads, and no more threads than max_subcompactions
+  HistogramData num_subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &num_subcompactions);
+  ASSERT_EQ(2U, num_threads);
+  ASSERT_GT(num_subcompactions.sum, 2U);
+  ASSERT_LE(thread_ids.size(), 2U);
+
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(expected[Key(i)], Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, ReuseNonOverlappingFiles) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.level_compaction_dynamic_level_bytes = false;
+  options.level0_file_num_compaction_trigger = 3;
+  options.compaction_reuse_non_overlapping_files = true;
+  DestroyAndReopen(options);
+
+  // L1: [b] [k] [t]
+  for (const char* key : {"b", "k", "t"}) {
+    ASSERT_OK(Put(key, std::string("L1_") + key));
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+  }
+  // L0: [a c] [n] [s u], where only [n] and [k] overlap no other input
+  ASSERT_OK(Put("a", "L0_a"));
+  ASSERT_OK(Put("c", "L0_c"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("n", "L0_n"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("s", "L0_s"));
+  ASSERT_OK(Put("u", "L0_u"));
+  ASSERT_OK(Put("t", "L0_t"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("3,3", FilesPerLevel());
+
+  auto get_files = [&]() {
+    std::vector<LiveFileMetaData> files;
+    db_->GetLiveFilesMetaData(&files);
+    std::map<std::string, std::pair<int, uint64_t>> files_by_key;
+    for (const auto& f : files) {
+      files_by_key[f.smallestkey] = {f.level, f.file_number};
+    }
+    return files_by_key;
+  };
+  auto files_before = get_files();
+
+  int num_trivial_moves = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:TrivialMove",
+      [&](void* /*arg*/) { num_trivial_moves++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(db_->SetOptions({{"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // [k] stays, [n] moves, and the other files are compacted into outputs
+  // cut around them
+  ASSERT_EQ(0, num_trivial_moves);
+  ASSERT_EQ("0,4", FilesPerLevel());
+  auto files_after = get_files();
+  ASSERT_EQ(4U, files_after.size());
+  ASSERT_EQ(files_before["k"].second, files_after["k"].second);
+  ASSERT_EQ(files_before["n"].second, files_after["n"].second);
+  ASSERT_EQ(1, files_after["n"].first);
+  ASSERT_NE(files_before["a"].second, files_after["a"].second);
+  ASSERT_EQ(1U, files_after.count("s"));
+
+  ASSERT_EQ("L0_a", Get("a"));
+  ASSERT_EQ("L1_b", Get("b"));
+  ASSERT_EQ("L0_c", Get("c"));
+  ASSERT_EQ("L1_k", Get("k"));
+  ASSERT_EQ("L0_n", Get("n"));
+  ASSERT_EQ("L0_s", Get("s"));
+  ASSERT_EQ("L0_t", Get("t"));
+  ASSERT_EQ("L0_u", Get("u"));
+}
+
 TEST_F(DBCompactionTest, SkipStatsUpdateTest) {
   // This test verify UpdateAccumulatedStats is not on
   // if options.skip_stats_update_on_db_open = true
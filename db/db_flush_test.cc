@@ -1477,6 +1477,75 @@ class ConditionalUpdateFilterFactory : public CompactionFilterFactory {
   std::string filtered_key_;
 };
 
+TEST_F(DBFlushTest, MemPurgeSortedArray) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.write_buffer_size = 1 << 20;
+  options.experimental_mempurge_threshold = 15.0;
+  options.experimental_mempurge_sorted_array = true;
+  ASSERT_OK(TryReopen(options));
+
+  std::atomic<uint32_t> mempurge_count{0};
+  std::atomic<uint32_t> sst_count{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:MemPurgeSuccessful",
+      [&](void* /*arg*/) { mempurge_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:SSTFileCreated", [&](void* /*arg*/) { sst_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Overwrite the same keys many times, keeping the first version of each
+  // alive with a snapshot
+  Random rnd(301);
+  const int kNumKeys = 100;
+  std::vector<std::string> first_values(kNumKeys);
+  std::vector<std::string> values(kNumKeys);
+  const Snapshot* snapshot = nullptr;
+  for (int round = 0; round < 40; round++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      values[i] = rnd.RandomString(1024);
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    if (round == 0) {
+      first_values = values;
+      snapshot = db_->GetSnapshot();
+    }
+  }
+  ASSERT_GE(mempurge_count.load(), 1U);
+  ASSERT_EQ(sst_count.load(), 0U);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+    ASSERT_EQ(first_values[i], Get(Key(i), snapshot));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = kNumKeys - 1;
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), i--) {
+    ASSERT_EQ(Key(i), iter->key());
+    ASSERT_EQ(values[i], iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(-1, i);
+  iter->SeekForPrev(Key(50) + "a");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(50), iter->key());
+  iter->Seek(Key(50) + "a");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(51), iter->key());
+  iter.reset();
+  db_->ReleaseSnapshot(snapshot);
+
+  // The sorted array memtables flush like any other
+  ASSERT_OK(Flush());
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(values[k], Get(Key(k)));
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBFlushTest, MemPurgeAndCompactionFilter) {
   Options options = CurrentOptions();
 
@@ -0,0 +1,134 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Counts the heap allocations of point lookups, through a replacement of the
+// global operator new for this test binary.
+
+#include <cstdlib>
+#include <new>
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/merge_operator.h"
+
+namespace {
+// Only the allocations of the thread counting are counted, not the ones of
+// the background threads of the DB
+thread_local bool count_allocations = false;
+thread_local size_t num_allocations = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  if (count_allocations) {
+    ++num_allocations;
+  }
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t /*size*/) noexcept { free(p); }
+
+namespace ROCKSDB_NAMESPACE {
+
+class DBGetAllocationTest : public DBTestBase {
+ public:
+  DBGetAllocationTest()
+      : DBTestBase("db_get_allocation_test", /*env_do_fsync=*/false) {}
+
+  // The allocations of a Get of key into value
+  size_t CountGetAllocations(const std::string& key, std::string* value) {
+    num_allocations = 0;
+    count_allocations = true;
+    Status s = db_->Get(ReadOptions(), key, value);
+    count_allocations = false;
+    EXPECT_OK(s);
+    return num_allocations;
+  }
+};
+
+namespace {
+// Returns the last operand, which fits in the inline buffer of a string, so
+// that a merge allocates the same whatever the number of operands
+class LastOperandMergeOperator : public MergeOperator {
+ public:
+  bool FullMergeV2(const MergeOperationInput& merge_in,
+                   MergeOperationOutput* merge_out) const override {
+    const Slice& last = merge_in.operand_list.back();
+    merge_out->new_value.assign(last.data(), last.size());
+    return true;
+  }
+  const char* Name() const override { return "LastOperandMergeOperator"; }
+};
+}  // namespace
+
+TEST_F(DBGetAllocationTest, CountingHook) {
+  count_allocations = true;
+  num_allocations = 0;
+  std::unique_ptr<std::string> s(new std::string(1000, 'a'));
+  count_allocations = false;
+  ASSERT_GE(num_allocations, 2u);
+}
+
+TEST_F(DBGetAllocationTest, LongKey) {
+  Options options = CurrentOptions();
+  Reopen(options);
+  const std::string short_key = "short";
+  const std::string long_key(1000, 'k');
+  ASSERT_OK(Put(short_key, std::string(100, 's')));
+  ASSERT_OK(Put(long_key, std::string(100, 'l')));
+
+  std::string value;
+  value.reserve(1000);
+  // The lookup state of the thread grows on the first lookups
+  for (int i = 0; i < 2; i++) {
+    CountGetAllocations(short_key, &value);
+    CountGetAllocations(long_key, &value);
+  }
+  // The lookup key of the long key costs no allocation of its own
+  const size_t short_key_allocations = CountGetAllocations(short_key, &value);
+  ASSERT_EQ(std::string(100, 's'), value);
+  ASSERT_EQ(short_key_allocations, CountGetAllocations(long_key, &value));
+  ASSERT_EQ(std::string(100, 'l'), value);
+}
+
+TEST_F(DBGetAllocationTest, MergeOperands) {
+  for (bool inplace_update_support : {false, true}) {
+    Options options = CurrentOptions();
+    options.merge_operator = std::make_shared<LastOperandMergeOperator>();
+    // The operands are copied out of the memtable
+    options.inplace_update_support = inplace_update_support;
+    options.allow_concurrent_memtable_write = !inplace_update_support;
+    DestroyAndReopen(options);
+    ASSERT_OK(Merge("one", "a"));
+    for (int i = 0; i < 30; i++) {
+      ASSERT_OK(Merge("many", std::string(1, static_cast<char>('a' + i % 26))));
+    }
+
+    std::string value;
+    value.reserve(100);
+    for (int i = 0; i < 2; i++) {
+      CountGetAllocations("one", &value);
+      CountGetAllocations("many", &value);
+    }
+    // The operands reuse the memory of the previous lookups
+    const size_t one_allocations = CountGetAllocations("one", &value);
+    ASSERT_EQ("a", value);
+    ASSERT_EQ(one_allocations, CountGetAllocations("many", &value));
+    ASSERT_EQ("d", value);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -41,6 +41,7 @@
 #include "db/job_context.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
+#include "db/lookup_scratch.h"
 #include "db/malloc_stats.h"
 #include "db/memtable.h"
 #include "db/memtable_list.h"
@@ -67,6 +68,7 @@
 #include "monitoring/instrumented_mutex.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/perf_sampling.h"
 #include "monitoring/persistent_stats_history.h"
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
@@ -83,6 +85,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/statistics.h"
+#include "rocksdb/stats_exporter.h"
 #include "rocksdb/stats_history.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
@@ -209,6 +212,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       write_thread_(immutable_db_options_),
       nonmem_write_thread_(immutable_db_options_),
       write_controller_(mutable_db_options_.delayed_write_rate),
+      memory_governor_(immutable_db_options_.memory_governor.get()),
+      memory_governor_delayed_write_rate_(0),
+      memory_governor_delayed_(false),
       last_batch_group_size_(0),
       unscheduled_flushes_(0),
       unscheduled_compactions_(0),
@@ -218,6 +224,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_flatten_scheduled_(0),
+      bg_job_weight_(1),
       disable_delete_obsolete_files_(static_cast<int>(
           immutable_db_options_.disable_delete_obsolete_files_on_open)),
       pending_purge_obsolete_files_(0),
@@ -274,6 +282,18 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   // dealt with
   co.hash_seed = 0;
   table_cache_ = NewLRUCache(co);
+  // With unordered_write, a write may be visible before it is in the
+  // memtable, so before it invalidates the cached results
+  if (immutable_db_options_.point_lookup_cache && !read_only &&
+      !immutable_db_options_.unordered_write) {
+    point_lookup_cache_.reset(
+        new PointLookupCache(immutable_db_options_.point_lookup_cache));
+  }
+  if (immutable_db_options_.multi_cf_iterator_seek_threads > 1) {
+    // The calling thread seeks, too
+    multi_cf_seek_pool_.reset(NewThreadPool(static_cast<int>(
+        immutable_db_options_.multi_cf_iterator_seek_threads - 1)));
+  }
   SetDbSessionId();
   assert(!db_session_id_.empty());
 
@@ -283,6 +303,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                                    [this]() { this->PersistStats(); });
   periodic_task_functions_.emplace(PeriodicTaskType::kFlushInfoLog,
                                    [this]() { this->FlushInfoLog(); });
+  periodic_task_functions_.emplace(PeriodicTaskType::kExportStats,
+                                   [this]() { this->ExportStats(); });
   periodic_task_functions_.emplace(
       PeriodicTaskType::kRecordSeqnoTime, [this]() {
         this->RecordSeqnoToTimeMapping(/*populate_historical_seconds=*/0);
@@ -555,6 +577,10 @@ Status DBImpl::CloseHelper() {
   if (HasPendingManualCompaction()) {
     DisableManualCompaction();
   }
+  // The iterators using it are all gone
+  if (multi_cf_seek_pool_) {
+    multi_cf_seek_pool_->JoinAllThreads();
+  }
   mutex_.Lock();
   // Unschedule all tasks for this DB
   for (uint8_t i = 0; i < static_cast<uint8_t>(TaskType::kCount); i++) {
@@ -562,12 +588,13 @@ Status DBImpl::CloseHelper() {
     env_->UnSchedule(GetTaskTag(i), Env::Priority::LOW);
     env_->UnSchedule(GetTaskTag(i), Env::Priority::HIGH);
   }
+  SetBGJobWeight(1);
 
   Status ret = Status::OK();
 
   // Wait for background work to finish
   while (bg_bottom_compaction_scheduled_ || bg_compaction_scheduled_ ||
-         bg_flush_scheduled_ || bg_purge_scheduled_ ||
+         bg_flush_scheduled_ || bg_purge_scheduled_ || bg_flatten_scheduled_ ||
          pending_purge_obsolete_files_ ||
          error_handler_.IsRecoveryInProgress()) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
@@ -816,6 +843,16 @@ Status DBImpl::StartPeriodicTaskScheduler() {
       return s;
     }
   }
+  if (immutable_db_options_.stats_exporter &&
+      immutable_db_options_.stats_export_period_sec > 0) {
+    Status s = periodic_task_scheduler_.Register(
+        PeriodicTaskType::kExportStats,
+        periodic_task_functions_.at(PeriodicTaskType::kExportStats),
+        immutable_db_options_.stats_export_period_sec);
+    if (!s.ok()) {
+      return s;
+    }
+  }
 
   Status s = periodic_task_scheduler_.Register(
       PeriodicTaskType::kFlushInfoLog,
@@ -1194,6 +1231,67 @@ void DBImpl::DumpStats() {
   PrintStatistics();
 }
 
+void DBImpl::ExportStats() {
+  TEST_SYNC_POINT("DBImpl::ExportStats:Start");
+  if (shutdown_initiated_) {
+    return;
+  }
+  const auto& exporter = immutable_db_options_.stats_exporter;
+  assert(exporter != nullptr);
+  ExportedStats stats;
+  stats.time_micros = immutable_db_options_.clock->NowMicros();
+  if (last_export_micros_ != 0 && stats.time_micros > last_export_micros_) {
+    stats.interval_micros = stats.time_micros - last_export_micros_;
+  }
+  last_export_micros_ = stats.time_micros;
+
+  if (stats_ != nullptr) {
+    // Not supported by a Statistics other than StatisticsImpl
+    stats_
+        ->getStatsDelta(&export_snapshot_, &stats.tickers, &stats.histograms)
+        .PermitUncheckedError();
+  }
+  for (const auto& property : exporter->GetIntProperties()) {
+    uint64_t value = 0;
+    if (GetAggregatedIntProperty(property, &value)) {
+      stats.int_properties[property] = value;
+    }
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->initialized() || cfd->IsDropped()) {
+        continue;
+      }
+      const auto& levels = cfd->internal_stats()->GetCompactionStats();
+      auto& previous = export_compaction_stats_[cfd->GetName()];
+      previous.resize(levels.size());
+      auto& exported = stats.compactions[cfd->GetName()];
+      exported.resize(levels.size());
+      for (size_t level = 0; level < levels.size(); ++level) {
+        InternalStats::CompactionStats delta(levels[level]);
+        // Unless the stats were reset since
+        if (levels[level].count >= previous[level].count) {
+          delta.Subtract(previous[level]);
+        }
+        previous[level] = levels[level];
+        auto& e = exported[level];
+        e.count = static_cast<uint64_t>(delta.count);
+        e.micros = delta.micros;
+        e.cpu_micros = delta.cpu_micros;
+        e.bytes_read = delta.bytes_read_non_output_levels +
+                       delta.bytes_read_output_level + delta.bytes_read_blob;
+        e.bytes_written = delta.bytes_written + delta.bytes_written_blob;
+        e.bytes_moved = delta.bytes_moved;
+        e.input_records = delta.num_input_records;
+        e.dropped_records = delta.num_dropped_records;
+      }
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::ExportStats:BeforeExport", &stats);
+  exporter->Export(dbname_, stats);
+}
+
 // Periodically flush info log out of application buffer at a low frequency.
 // This improves debuggability in case of RocksDB hanging since it ensures the
 // log messages leading up to the hang will eventually become visible in the
@@ -1324,345 +1422,623 @@ Status DBImpl::ApplyReplicationLogRecord(ReplicationLogRecord record,
                                          uint64_t snapshot_replication_epoch,
                                          ApplyReplicationLogRecordInfo* info,
                                          unsigned flags) {
+  std::vector<ReplicationLogRecordAndSequence> records;
+  records.emplace_back(std::move(record), std::move(replication_sequence));
+  return ApplyReplicationLogRecords(std::move(records),
+                                    std::move(cf_options_factory),
+                                    snapshot_replication_epoch, info, flags,
+                                    nullptr /* num_applied */);
+}
+
+Status DBImpl::ApplyReplicationLogRecords(
+    std::vector<ReplicationLogRecordAndSequence> records,
+    CFOptionsFactory cf_options_factory, uint64_t snapshot_replication_epoch,
+    ApplyReplicationLogRecordInfo* info, unsigned flags, size_t* num_applied) {
   JobContext job_context(0, false);
   Status s;
   bool evictObsoleteFiles = flags & AR_EVICT_OBSOLETE_FILES;
+  bool applied_manifest_writes = false;
+  size_t applied = 0;
 
   {
     WriteThread::Writer w;
     InstrumentedMutexLock l(&mutex_);
     write_thread_.EnterUnbatched(&w, &mutex_);
 
-    switch (record.type) {
-      case ReplicationLogRecord::kMemtableWrite: {
-        mutex_.Unlock();
-        WriteBatch batch;
-        s = WriteBatchInternal::SetContents(&batch, std::move(record.contents));
-        assert(s.ok());
-
-        if (versions_->LastSequence() + 1 !=
-            WriteBatchInternal::Sequence(&batch)) {
-          std::ostringstream oss;
-          oss << "Gap in sequence numbers, expected="
-              << versions_->LastSequence() + 1
-              << " got=" << WriteBatchInternal::Sequence(&batch);
-          s = Status::Corruption(oss.str());
-        }
-
-        SequenceNumber next_seq{0};
-        if (s.ok()) {
-          s = WriteBatchInternal::InsertInto(
-              &batch, column_family_memtables_.get(), &flush_scheduler_,
-              &trim_history_scheduler_,
-              true /* ignore_missing_column_families_ */, 0 /* log_number */,
-              this, false /* concurrent_memtable_writes */, &next_seq,
-              nullptr /* has_valid_writes */, seq_per_batch_, batch_per_txn_);
-        }
-        if (s.ok()) {
-          versions_->SetLastSequence(next_seq - 1);
-        }
-        mutex_.Lock();
-        break;
-      }
-      case ReplicationLogRecord::kMemtableSwitch: {
-        WriteContext write_context;
-        MemTableSwitchRecord mem_switch_record;
-        Slice contents_slice(record.contents);
-        s = DeserializeMemTableSwitchRecord(&contents_slice, &mem_switch_record);
-        if (!s.ok()) {
+    UpdateReplicationLeaderSequence(records);
+
+    while (s.ok() && !info->diverged_manifest_writes &&
+           applied < records.size()) {
+      auto& record = records[applied].first;
+      const auto& replication_sequence = records[applied].second;
+      const size_t begin = applied;
+      uint64_t apply_micros = 0;
+      switch (record.type) {
+        case ReplicationLogRecord::kMemtableWrite: {
+          StopWatch sw(immutable_db_options_.clock, stats_,
+                       REPLICATION_MEMTABLE_WRITE_APPLY_MICROS,
+                       Histograms::HISTOGRAM_ENUM_MAX, &apply_micros);
+          // A run of memtable writes is inserted with the mutex released once
+          size_t run_end = applied + 1;
+          while (run_end < records.size() &&
+                 records[run_end].first.type ==
+                     ReplicationLogRecord::kMemtableWrite) {
+            ++run_end;
+          }
+          size_t inserted = 0;
+          s = ApplyReplicationMemtableWrites(&records, applied, run_end,
+                                             &inserted);
+          applied += inserted;
           break;
         }
-        ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                       "Applying memtable switch with next log file: %" PRIu64
-                       ", replication sequence (hex): %s",
-                       mem_switch_record.next_log_num,
-                       Slice(replication_sequence).ToString(true).c_str());
-        autovector<ColumnFamilyData*> cfds;
-        SelectColumnFamiliesForAtomicFlush(&cfds);
-
-        for (auto cfd: cfds) {
-          if (cfd->mem()->IsEmpty()) {
-            continue;
+        case ReplicationLogRecord::kMemtableSwitch: {
+          StopWatch sw(immutable_db_options_.clock, stats_,
+                       REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS,
+                       Histograms::HISTOGRAM_ENUM_MAX, &apply_micros);
+          s = ApplyReplicationMemtableSwitch(record, replication_sequence);
+          if (s.ok()) {
+            ++applied;
           }
-
-          cfd->Ref();
-          s = SwitchMemtableWithoutCreatingWAL(cfd, &write_context,
-                                               mem_switch_record.next_log_num,
-                                               replication_sequence);
-          cfd->UnrefAndTryDelete();
-          if (!s.ok()) {
-            break;
+          break;
+        }
+        case ReplicationLogRecord::kManifestWrite: {
+          StopWatch sw(immutable_db_options_.clock, stats_,
+                       REPLICATION_MANIFEST_WRITE_APPLY_MICROS,
+                       Histograms::HISTOGRAM_ENUM_MAX, &apply_micros);
+          s = ApplyReplicationManifestWrite(
+              record, replication_sequence, cf_options_factory,
+              snapshot_replication_epoch, info, &job_context);
+          if (s.ok() && !info->diverged_manifest_writes) {
+            applied_manifest_writes = true;
+            ++applied;
           }
+          break;
         }
+        default:
+          s = Status::InvalidArgument("Unknown replication log record type");
+          break;
+      }
+      RecordReplicationApplyStats(records, begin, applied, apply_micros);
+    }
 
-        // `next_log_number` is allocated by bumping `next_file_number`. We need
-        // to set file number to make sure follower's file number is
-        // consistent with leader. Otherwise, file number might be reused when
-        // follower tries to take over after memtable switch event.
-        if (mem_switch_record.next_log_num >=
-            versions_->current_next_file_number()) {
-          versions_->SetNextFileNumber(mem_switch_record.next_log_num + 1);
-        }
+    // The files made obsolete by all the manifest writes are evicted at once
+    if (evictObsoleteFiles && applied_manifest_writes) {
+      versions_->GetObsoleteFiles(&job_context.sst_delete_files,
+                                  &job_context.blob_delete_files,
+                                  &job_context.manifest_delete_files,
+                                  std::numeric_limits<uint64_t>::max());
+      versions_->RemoveLiveFiles(job_context.sst_delete_files,
+                                 job_context.blob_delete_files);
+    }
+
+    write_thread_.ExitUnbatched(&w);
+  }
+
+
+  if (evictObsoleteFiles) {
+    for (auto& file : job_context.sst_delete_files) {
+      auto number = file.metadata->fd.GetNumber();
+      if (file.metadata->table_reader_handle) {
+        table_cache_->Release(file.metadata->table_reader_handle);
+        versions_->UnpinTableReaders(1);
+      }
+      file.DeleteMetadata();
+
+      if (!file.only_delete_metadata) {
+        TableCache::Evict(table_cache_.get(), number);
+      }
+    }
+  }
+  job_context.Clean();
+
+  if (num_applied) {
+    *num_applied = applied;
+  }
+  return s;
+}
+
+void DBImpl::UpdateReplicationLeaderSequence(
+    const std::vector<ReplicationLogRecordAndSequence>& records) {
+  SequenceNumber leader_sequence = 0;
+  for (const auto& record : records) {
+    if (record.first.type != ReplicationLogRecord::kMemtableWrite) {
+      continue;
+    }
+    auto contents = record.first.GetContents();
+    if (contents.size() < WriteBatchInternal::kHeader) {
+      continue;
+    }
+    auto count = DecodeFixed32(contents.data() + 8);
+    if (count > 0) {
+      leader_sequence = std::max(leader_sequence,
+                                 DecodeFixed64(contents.data()) + count - 1);
+    }
+  }
+  default_cf_internal_stats_->UpdateDBStatsMax(
+      InternalStats::kIntStatsReplicationLeaderSequence, leader_sequence);
+}
+
+void DBImpl::RecordReplicationApplyStats(
+    const std::vector<ReplicationLogRecordAndSequence>& records, size_t begin,
+    size_t end, uint64_t apply_micros) {
+  default_cf_internal_stats_->AddDBStats(
+      InternalStats::kIntStatsReplicationApplyMicros, apply_micros);
+  if (begin == end) {
+    return;
+  }
+  uint64_t bytes = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bytes += records[i].first.GetContents().size();
+  }
+  // The records of [begin, end) are all of the same type
+  InternalStats::InternalDBStatsType type_stat;
+  switch (records[begin].first.type) {
+    case ReplicationLogRecord::kMemtableWrite:
+      type_stat = InternalStats::kIntStatsReplicationMemtableWritesApplied;
+      break;
+    case ReplicationLogRecord::kMemtableSwitch:
+      type_stat = InternalStats::kIntStatsReplicationMemtableSwitchesApplied;
+      break;
+    default:
+      type_stat = InternalStats::kIntStatsReplicationManifestWritesApplied;
+      break;
+  }
+  auto num_records = static_cast<uint64_t>(end - begin);
+  default_cf_internal_stats_->AddDBStats(type_stat, num_records);
+  default_cf_internal_stats_->AddDBStats(
+      InternalStats::kIntStatsReplicationRecordsApplied, num_records);
+  default_cf_internal_stats_->AddDBStats(
+      InternalStats::kIntStatsReplicationBytesApplied, bytes);
+  RecordTick(stats_, REPLICATION_RECORDS_APPLIED, num_records);
+  RecordTick(stats_, REPLICATION_BYTES_APPLIED, bytes);
+}
+
+Status DBImpl::ApplyReplicationMemtableWrites(
+    std::vector<ReplicationLogRecordAndSequence>* records, size_t begin,
+    size_t end, size_t* num_applied) {
+  mutex_.AssertHeld();
+  // The leader assigned the sequence numbers, so the batches don't have to
+  // be inserted in order
+  bool concurrent = immutable_db_options_.replication_apply_threads > 1 &&
+                    immutable_db_options_.allow_concurrent_memtable_write &&
+                    !seq_per_batch_ && end - begin > 1;
+  if (concurrent && !replication_apply_pool_) {
+    // The calling thread inserts, too
+    replication_apply_pool_.reset(NewThreadPool(
+        static_cast<int>(immutable_db_options_.replication_apply_threads - 1)));
+  }
+  Status s;
+  auto last_sequence = versions_->LastSequence();
+  mutex_.Unlock();
+  // The write batch contents are inserted in place, the records own them.
+  // Batches queued for concurrent insertion, and the next sequence number
+  // expected after them
+  std::vector<Slice> pending;
+  auto next_sequence = last_sequence + 1;
+  auto insert_pending = [&]() {
+    size_t inserted = 0;
+    auto st = InsertReplicatedBatchesConcurrently(pending, &inserted);
+    if (inserted > 0) {
+      const auto& last = pending[inserted - 1];
+      last_sequence =
+          DecodeFixed64(last.data()) + DecodeFixed32(last.data() + 8) - 1;
+    }
+    *num_applied += inserted;
+    pending.clear();
+    return st;
+  };
+  for (size_t i = begin; i < end; ++i) {
+    auto batch = (*records)[i].first.GetContents();
+    if (batch.size() < WriteBatchInternal::kHeader) {
+      s = Status::Corruption("malformed WriteBatch (too small)");
+      break;
+    }
+    auto batch_sequence = DecodeFixed64(batch.data());
+
+    if (next_sequence != batch_sequence) {
+      std::ostringstream oss;
+      oss << "Gap in sequence numbers, expected=" << next_sequence
+          << " got=" << batch_sequence;
+      s = Status::Corruption(oss.str());
+      break;
+    }
+
+    if (concurrent && !WriteBatchInternal::HasMerge(batch)) {
+      next_sequence += DecodeFixed32(batch.data() + 8);
+      pending.push_back(batch);
+      continue;
+    }
+    // Merges may read the memtable, the batches before them go first
+    if (!pending.empty()) {
+      s = insert_pending();
+      if (!s.ok()) {
         break;
       }
-      case ReplicationLogRecord::kManifestWrite: {
-        Slice contents_slice(record.contents);
-        autovector<VersionEdit> edits;
-        s = DeserializeReplicationLogManifestWrite(&contents_slice, &edits);
-        if (!s.ok()) {
-          break;
-        }
+    }
 
-        auto mutable_options =
-            default_cf_handle_->cfd()->GetLatestMutableCFOptions();
-        std::optional<ColumnFamilyOptions> cf_options;
+    SequenceNumber next_seq{0};
+    s = WriteBatchInternal::InsertInto(
+        batch, column_family_memtables_.get(), &flush_scheduler_,
+        &trim_history_scheduler_, true /* ignore_missing_column_families_ */,
+        0 /* log_number */, this, false /* concurrent_memtable_writes */,
+        &next_seq, nullptr /* has_valid_writes */, seq_per_batch_,
+        batch_per_txn_);
+    if (!s.ok()) {
+      break;
+    }
+    last_sequence = next_seq - 1;
+    next_sequence = next_seq;
+    ++*num_applied;
+  }
+  if (!pending.empty()) {
+    auto st = insert_pending();
+    if (!st.ok()) {
+      // Precedes the gap in sequence numbers, if any
+      s.PermitUncheckedError();
+      s = st;
+    }
+  }
+  // The writes of the run become visible together
+  versions_->SetLastSequence(last_sequence);
+  mutex_.Lock();
+  return s;
+}
 
-        autovector<ColumnFamilyData*> cfds;
-        autovector<const MutableCFOptions*> mutable_cf_options_list;
-        autovector<autovector<VersionEdit*>> edit_lists;
+Status DBImpl::InsertReplicatedBatchesConcurrently(
+    const std::vector<Slice>& batches, size_t* num_inserted) {
+  std::vector<Status> statuses(batches.size());
+  std::atomic<size_t> next_batch{0};
+  auto insert = [&]() {
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    for (size_t i = next_batch.fetch_add(1); i < batches.size();
+         i = next_batch.fetch_add(1)) {
+      statuses[i] = WriteBatchInternal::InsertInto(
+          batches[i], &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_, true /* ignore_missing_column_families_ */,
+          0 /* log_number */, this, true /* concurrent_memtable_writes */,
+          nullptr /* next_seq */, nullptr /* has_valid_writes */,
+          seq_per_batch_, batch_per_txn_);
+    }
+  };
 
-        std::vector<uint32_t> added_column_families;
+  size_t num_helpers = 0;
+  if (replication_apply_pool_) {
+    num_helpers = std::min<size_t>(
+        batches.size() - 1,
+        static_cast<size_t>(replication_apply_pool_->GetBackgroundThreads()));
+  }
+  port::Mutex helpers_mutex;
+  port::CondVar helpers_cv(&helpers_mutex);
+  size_t running_helpers = num_helpers;
+  for (size_t i = 0; i < num_helpers; ++i) {
+    replication_apply_pool_->SubmitJob([&]() {
+      insert();
+      MutexLock l(&helpers_mutex);
+      if (--running_helpers == 0) {
+        helpers_cv.SignalAll();
+      }
+    });
+  }
+  insert();
+  {
+    MutexLock l(&helpers_mutex);
+    while (running_helpers > 0) {
+      helpers_cv.Wait();
+    }
+  }
 
-        auto current_update_sequence = versions_->GetManifestUpdateSequence();
-        uint64_t latest_applied_update_sequence = 0;
-        uint64_t replication_epoch{0};
-        if (immutable_db_options_.replication_epoch_extractor) {
-          replication_epoch =
-              immutable_db_options_.replication_epoch_extractor
-                  ->EpochOfReplicationSequence(replication_sequence);
-        }
-        for (auto& e : edits) {
-          if (!e.HasManifestUpdateSequence()) {
-            s = Status::InvalidArgument(
-                "Manifest write doesn't have a ManifestUpdateSequence");
-            break;
-          }
-          latest_applied_update_sequence = e.GetManifestUpdateSequence();
+  // Report the batches inserted before the first failure
+  Status s;
+  *num_inserted = 0;
+  for (auto& st : statuses) {
+    if (!s.ok()) {
+      st.PermitUncheckedError();
+    } else if (!st.ok()) {
+      s = st;
+    } else {
+      ++*num_inserted;
+    }
+  }
+  return s;
+}
 
-          // Epoch based divergence detection, used to detect if the local log
-          // is diverged from the MANIFEST file the db is opened with.
-          //
-          // High level idea: we maintain all the (epoch, first mus of the
-          // epoch) after the persisted replication sequence, i.e., the
-          // `ReplicationEpochSet`, in VersionSet/Manifest file. When recovering
-          // local log, we infer the epoch based on the `ReplicationEpochSet`
-          // and the VersionEdit's manifest update sequence, and compare that
-          // with the actual epoch of the replication record.
-          //
-          // A few special cases:
-          // 1. if epoch based divergence detection is
-          // enabled, `ReplicationEpochSet` can only be empty when this is a
-          // new db opening with epoch 0, i.e., no new epoch is generated yet,
-          // and follower starts tailing from leader when epoch is 0.
-          // Currently, this is only possible in tests. In practice, follower
-          // will always have non empty replication epoch set when applying
-          // version edits.
-          // 2. If the mus of `e` is smaller than the smallest mus in the
-          // `ReplicationEpochSet`, we can't infer the exact epoch. So the only
-          // verification we do here is to make sure the epoch of the record is
-          // also smaller than the smallest epoch in the `ReplicationEpochSet`
-          // 3. We have to do divergence detection even if mus of `e` is greater
-          // than `current_update_sequence`. Reason is, it's possible a snapshot
-          // at epoch `e` is generated while there is no manifest writes for the
-          // latest epoch yet.
-          if (latest_applied_update_sequence <= current_update_sequence) {
-            if (!versions_->IsReplicationEpochsEmpty()) {
-              auto inferred_epoch_of_mus = versions_->GetReplicationEpochForMUS(
-                  latest_applied_update_sequence);
-              // If mus is smaller than mus in the epoch set, the replication
-              // epoch should also be smaller than epoch in the epoch set.
-              if (!inferred_epoch_of_mus &&
-                  replication_epoch >=
-                      versions_->replication_epochs_.GetSmallestEpoch()) {
-                info->diverged_manifest_writes = true;
-                ROCKS_LOG_INFO(
-                    immutable_db_options_.info_log,
-                    "Diverged manifest found: mus: %" PRIu64
-                    ", smallest epoch: %" PRIu64 ", actual epoch: %" PRIu64,
-                    latest_applied_update_sequence,
-                    versions_->replication_epochs_.GetSmallestEpoch(),
-                    replication_epoch);
-                break;
-              }
-              // If we can infer epoch, make sure the epoch actually matches
-              // with epoch in the `replication_sequence`
-              if (inferred_epoch_of_mus &&
-                  (*inferred_epoch_of_mus != replication_epoch)) {
-                info->diverged_manifest_writes = true;
-                ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                               "Diverged manifest found: mus: %" PRIu64
-                               ", inferred epoch: %" PRIu64
-                               ", actual epoch: %" PRIu64,
-                               latest_applied_update_sequence,
-                               *inferred_epoch_of_mus, replication_epoch);
-                break;
-              }
-            }
+Status DBImpl::ApplyReplicationMemtableSwitch(
+    const ReplicationLogRecord& record,
+    const std::string& replication_sequence) {
+  mutex_.AssertHeld();
+  Status s;
+  WriteContext write_context;
+  MemTableSwitchRecord mem_switch_record;
+  Slice contents_slice = record.GetContents();
+  s = DeserializeMemTableSwitchRecord(&contents_slice, &mem_switch_record);
+  if (!s.ok()) {
+    return s;
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Applying memtable switch with next log file: %" PRIu64
+                 ", replication sequence (hex): %s",
+                 mem_switch_record.next_log_num,
+                 Slice(replication_sequence).ToString(true).c_str());
+  autovector<ColumnFamilyData*> cfds;
+  SelectColumnFamiliesForAtomicFlush(&cfds);
+
+  for (auto cfd: cfds) {
+    if (cfd->mem()->IsEmpty()) {
+      continue;
+    }
 
-            // don't apply the manifest write if it's already applied
-            continue;
-          } else {
-            if (!versions_->IsReplicationEpochsEmpty() &&
-                versions_->replication_epochs_.GetLargestEpoch() <
-                    snapshot_replication_epoch) {
-              // This should be the first mus of `snapshotEpoch`
-              if (replication_epoch != snapshot_replication_epoch) {
-                info->diverged_manifest_writes = true;
-                ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                               "Diverged manifest found: mus: %" PRIu64
-                               ", replication epoch: %" PRIu64
-                               ", snapshot epoch: %" PRIu64,
-                               latest_applied_update_sequence,
-                               replication_epoch, snapshot_replication_epoch);
-                break;
-              }
-            }
-          }
+    cfd->Ref();
+    uint64_t switch_micros = 0;
+    {
+      StopWatch sw(immutable_db_options_.clock, stats_,
+                   REPLICATION_SWITCH_MEMTABLE_MICROS,
+                   Histograms::HISTOGRAM_ENUM_MAX, &switch_micros);
+      s = SwitchMemtableWithoutCreatingWAL(cfd, &write_context,
+                                           mem_switch_record.next_log_num,
+                                           replication_sequence);
+    }
+    default_cf_internal_stats_->AddDBStats(
+        InternalStats::kIntStatsReplicationSwitchMemtableMicros,
+        switch_micros);
+    cfd->UnrefAndTryDelete();
+    if (!s.ok()) {
+      break;
+    }
+  }
 
-          ++current_update_sequence;
-          if (e.GetManifestUpdateSequence() != current_update_sequence) {
-            std::ostringstream oss;
-            oss << "Gap in ManifestUpdateSequence, expected="
-                << current_update_sequence
-                << " got=" << e.GetManifestUpdateSequence();
-            s = Status::Corruption(oss.str());
-            break;
-          }
+  // `next_log_number` is allocated by bumping `next_file_number`. We need
+  // to set file number to make sure follower's file number is
+  // consistent with leader. Otherwise, file number might be reused when
+  // follower tries to take over after memtable switch event.
+  if (mem_switch_record.next_log_num >=
+      versions_->current_next_file_number()) {
+    versions_->SetNextFileNumber(mem_switch_record.next_log_num + 1);
+  }
+  return s;
+}
 
-          // We only update log number if it's greater than what we have when
-          // applying kManifestWrite. The log number in `kManifestWrite` is
-          // usually equal to the log number we assign for the corresponding
-          // memtable switch. If there is another memtable switch following it
-          // and bumps the log number, we don't want to reset the log number
-          // here to previous value.
-          if (e.HasLogNumber() &&
-              e.GetLogNumber() > alive_log_files_.begin()->number) {
-            // Physical replication does not support WAL, but RocksDB expects
-            // some invariants of alive_log_files_ and logs_ and who are we to
-            // argue: at least one alive_log_files_ and logs_ always needs to be
-            // alive and alive means that its log number is greater or equal to
-            // the latest log number.
-            alive_log_files_.begin()->number = e.GetLogNumber();
-            logs_.front().number = e.GetLogNumber();
-          }
+Status DBImpl::ApplyReplicationManifestWrite(
+    const ReplicationLogRecord& record,
+    const std::string& replication_sequence,
+    const CFOptionsFactory& cf_options_factory,
+    uint64_t snapshot_replication_epoch, ApplyReplicationLogRecordInfo* info,
+    JobContext* job_context) {
+  mutex_.AssertHeld();
+  Status s;
+  Slice contents_slice = record.GetContents();
+  autovector<VersionEdit> edits;
+  s = DeserializeReplicationLogManifestWrite(&contents_slice, &edits);
+  if (!s.ok()) {
+    return s;
+  }
 
-          if (e.HasNextFile()) {
-              versions_->SetNextFileNumber(e.GetNextFile());
-          }
+  auto mutable_options =
+      default_cf_handle_->cfd()->GetLatestMutableCFOptions();
+  std::optional<ColumnFamilyOptions> cf_options;
 
-          ColumnFamilyData* cfd{nullptr};
-          if (!e.IsColumnFamilyAdd()) {
-            cfd = versions_->GetColumnFamilySet()->GetColumnFamily(
-                e.GetColumnFamily());
-          }
-          if (e.IsColumnFamilyAdd()) {
-            added_column_families.push_back(e.GetColumnFamily());
-            // We need to invoke the factory outside of the DB mutex
-            mutex_.Unlock();
-            // CF manipulation (CF add or drop) cannot be a part of the group
-            // commit, only a single VersionEdit is allowed.
-            assert(edits.size() == 1 && !cf_options);
-            cf_options.emplace(cf_options_factory(e.GetAddColumnFamily()));
-            mutex_.Lock();
-          } else if (e.IsColumnFamilyDrop()) {
-            info->deleted_column_families.push_back(e.GetColumnFamily());
-          }
-          cfds.push_back(cfd);
-          mutable_cf_options_list.push_back(mutable_options);
-          autovector<VersionEdit*> el;
-          el.push_back(&e);
-          edit_lists.push_back(std::move(el));
-          ROCKS_LOG_INFO(immutable_db_options_.info_log, "%s",
-                         DescribeVersionEdit(e, cfd).c_str());
-          if (!s.ok()) {
-            break;
-          }
+  autovector<ColumnFamilyData*> cfds;
+  autovector<const MutableCFOptions*> mutable_cf_options_list;
+  autovector<autovector<VersionEdit*>> edit_lists;
 
-          s = CheckNextEpochNumberConsistency(e, cfd);
-          if (!s.ok()) {
-            break;
-          }
+  std::vector<uint32_t> added_column_families;
 
-          auto& newFiles = e.GetNewFiles();
-          auto& deletedFiles = e.GetDeletedFiles();
+  auto current_update_sequence = versions_->GetManifestUpdateSequence();
+  uint64_t latest_applied_update_sequence = 0;
+  uint64_t replication_epoch{0};
+  if (immutable_db_options_.replication_epoch_extractor) {
+    replication_epoch =
+        immutable_db_options_.replication_epoch_extractor
+            ->EpochOfReplicationSequence(replication_sequence);
+  }
+  for (auto& e : edits) {
+    if (!e.HasManifestUpdateSequence()) {
+      s = Status::InvalidArgument(
+          "Manifest write doesn't have a ManifestUpdateSequence");
+      break;
+    }
+    latest_applied_update_sequence = e.GetManifestUpdateSequence();
 
-          // Maintain next epoch number on follower
-          if (deletedFiles.empty() && !newFiles.empty()) {
-            cfd->SetNextEpochNumber(newFiles.rbegin()->second.epoch_number + 1);
-          }
-        }
-        // break early if there are errors or manifest write is diverged. DB should
-        // be reopened for this case
-        if (!s.ok() || info->diverged_manifest_writes) {
+    // Epoch based divergence detection, used to detect if the local log
+    // is diverged from the MANIFEST file the db is opened with.
+    //
+    // High level idea: we maintain all the (epoch, first mus of the
+    // epoch) after the persisted replication sequence, i.e., the
+    // `ReplicationEpochSet`, in VersionSet/Manifest file. When recovering
+    // local log, we infer the epoch based on the `ReplicationEpochSet`
+    // and the VersionEdit's manifest update sequence, and compare that
+    // with the actual epoch of the replication record.
+    //
+    // A few special cases:
+    // 1. if epoch based divergence detection is
+    // enabled, `ReplicationEpochSet` can only be empty when this is a
+    // new db opening with epoch 0, i.e., no new epoch is generated yet,
+    // and follower starts tailing from leader when epoch is 0.
+    // Currently, this is only possible in tests. In practice, follower
+    // will always have non empty replication epoch set when applying
+    // version edits.
+    // 2. If the mus of `e` is smaller than the smallest mus in the
+    // `ReplicationEpochSet`, we can't infer the exact epoch. So the only
+    // verification we do here is to make sure the epoch of the record is
+    // also smaller than the smallest epoch in the `ReplicationEpochSet`
+    // 3. We have to do divergence detection even if mus of `e` is greater
+    // than `current_update_sequence`. Reason is, it's possible a snapshot
+    // at epoch `e` is generated while there is no manifest writes for the
+    // latest epoch yet.
+    if (latest_applied_update_sequence <= current_update_sequence) {
+      if (!versions_->IsReplicationEpochsEmpty()) {
+        auto inferred_epoch_of_mus = versions_->GetReplicationEpochForMUS(
+            latest_applied_update_sequence);
+        // If mus is smaller than mus in the epoch set, the replication
+        // epoch should also be smaller than epoch in the epoch set.
+        if (!inferred_epoch_of_mus &&
+            replication_epoch >=
+                versions_->replication_epochs_.GetSmallestEpoch()) {
+          info->diverged_manifest_writes = true;
+          ROCKS_LOG_INFO(
+              immutable_db_options_.info_log,
+              "Diverged manifest found: mus: %" PRIu64
+              ", smallest epoch: %" PRIu64 ", actual epoch: %" PRIu64,
+              latest_applied_update_sequence,
+              versions_->replication_epochs_.GetSmallestEpoch(),
+              replication_epoch);
           break;
         }
-        s = versions_->LogAndApply(
-            cfds, mutable_cf_options_list, ReadOptions(), WriteOptions(),
-            edit_lists, &mutex_, directories_.GetDbDir(),
-            false /* new_descriptor_log */, &*cf_options);
-        if (!s.ok()) {
+        // If we can infer epoch, make sure the epoch actually matches
+        // with epoch in the `replication_sequence`
+        if (inferred_epoch_of_mus &&
+            (*inferred_epoch_of_mus != replication_epoch)) {
+          info->diverged_manifest_writes = true;
+          ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                         "Diverged manifest found: mus: %" PRIu64
+                         ", inferred epoch: %" PRIu64
+                         ", actual epoch: %" PRIu64,
+                         latest_applied_update_sequence,
+                         *inferred_epoch_of_mus, replication_epoch);
           break;
         }
-        for (auto cfd : cfds) {
-          if (!cfd) {
-            continue;
-          }
-          cfd->imm()->RemoveOldMemTables(cfd->GetLogNumber(),
-                                         &job_context.memtables_to_free);
-          auto& sv_context = job_context.superversion_contexts.back();
-          if (!sv_context.new_superversion) {
-            sv_context.NewSuperVersion();
-          }
-          cfd->InstallSuperVersion(&sv_context, &mutex_);
-        }
+      }
 
-        if (evictObsoleteFiles) {
-          versions_->GetObsoleteFiles(&job_context.sst_delete_files,
-                                      &job_context.blob_delete_files,
-                                      &job_context.manifest_delete_files,
-                                      std::numeric_limits<uint64_t>::max());
-          versions_->RemoveLiveFiles(job_context.sst_delete_files,
-                                     job_context.blob_delete_files);
+      // don't apply the manifest write if it's already applied
+      continue;
+    } else {
+      if (!versions_->IsReplicationEpochsEmpty() &&
+          versions_->replication_epochs_.GetLargestEpoch() <
+              snapshot_replication_epoch) {
+        // This should be the first mus of `snapshotEpoch`
+        if (replication_epoch != snapshot_replication_epoch) {
+          info->diverged_manifest_writes = true;
+          ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                         "Diverged manifest found: mus: %" PRIu64
+                         ", replication epoch: %" PRIu64
+                         ", snapshot epoch: %" PRIu64,
+                         latest_applied_update_sequence,
+                         replication_epoch, snapshot_replication_epoch);
+          break;
         }
+      }
+    }
 
-        info->has_manifest_writes = true;
-        info->current_manifest_update_seq = current_update_sequence;
-        info->latest_applied_manifest_update_seq =
-            latest_applied_update_sequence;
+    ++current_update_sequence;
+    if (e.GetManifestUpdateSequence() != current_update_sequence) {
+      std::ostringstream oss;
+      oss << "Gap in ManifestUpdateSequence, expected="
+          << current_update_sequence
+          << " got=" << e.GetManifestUpdateSequence();
+      s = Status::Corruption(oss.str());
+      break;
+    }
 
-        for (auto& cf : added_column_families) {
-          auto* cfd = versions_->GetColumnFamilySet()->GetColumnFamily(cf);
-          auto& sv_context = job_context.superversion_contexts.back();
-          if (!sv_context.new_superversion) {
-            sv_context.NewSuperVersion();
-          }
-          cfd->InstallSuperVersion(&sv_context, &mutex_);
-          cfd->set_initialized();
-          info->added_column_families.push_back(
-              std::make_unique<ColumnFamilyHandleImpl>(cfd, this, &mutex_));
-        }
+    // We only update log number if it's greater than what we have when
+    // applying kManifestWrite. The log number in `kManifestWrite` is
+    // usually equal to the log number we assign for the corresponding
+    // memtable switch. If there is another memtable switch following it
+    // and bumps the log number, we don't want to reset the log number
+    // here to previous value.
+    if (e.HasLogNumber() &&
+        e.GetLogNumber() > alive_log_files_.begin()->number) {
+      // Physical replication does not support WAL, but RocksDB expects
+      // some invariants of alive_log_files_ and logs_ and who are we to
+      // argue: at least one alive_log_files_ and logs_ always needs to be
+      // alive and alive means that its log number is greater or equal to
+      // the latest log number.
+      alive_log_files_.begin()->number = e.GetLogNumber();
+      logs_.front().number = e.GetLogNumber();
+    }
 
-        break;
-      }
+    if (e.HasNextFile()) {
+        versions_->SetNextFileNumber(e.GetNextFile());
     }
 
-    write_thread_.ExitUnbatched(&w);
+    ColumnFamilyData* cfd{nullptr};
+    if (!e.IsColumnFamilyAdd()) {
+      cfd = versions_->GetColumnFamilySet()->GetColumnFamily(
+          e.GetColumnFamily());
+    }
+    if (e.IsColumnFamilyAdd()) {
+      added_column_families.push_back(e.GetColumnFamily());
+      // We need to invoke the factory outside of the DB mutex
+      mutex_.Unlock();
+      // CF manipulation (CF add or drop) cannot be a part of the group
+      // commit, only a single VersionEdit is allowed.
+      assert(edits.size() == 1 && !cf_options);
+      cf_options.emplace(cf_options_factory(e.GetAddColumnFamily()));
+      mutex_.Lock();
+    } else if (e.IsColumnFamilyDrop()) {
+      info->deleted_column_families.push_back(e.GetColumnFamily());
+    }
+    cfds.push_back(cfd);
+    mutable_cf_options_list.push_back(mutable_options);
+    autovector<VersionEdit*> el;
+    el.push_back(&e);
+    edit_lists.push_back(std::move(el));
+    ROCKS_LOG_INFO(immutable_db_options_.info_log, "%s",
+                   DescribeVersionEdit(e, cfd).c_str());
+    if (!s.ok()) {
+      break;
+    }
+
+    s = CheckNextEpochNumberConsistency(e, cfd);
+    if (!s.ok()) {
+      break;
+    }
+
+    auto& newFiles = e.GetNewFiles();
+    auto& deletedFiles = e.GetDeletedFiles();
+
+    // Maintain next epoch number on follower
+    if (deletedFiles.empty() && !newFiles.empty()) {
+      cfd->SetNextEpochNumber(newFiles.rbegin()->second.epoch_number + 1);
+    }
+  }
+  // return early if there are errors or manifest write is diverged. DB should
+  // be reopened for this case
+  if (!s.ok() || info->diverged_manifest_writes) {
+    return s;
+  }
+  // The edits may add or remove data without a write, e.g. ingested files
+  if (point_lookup_cache_) {
+    point_lookup_cache_->InvalidateAll();
+  }
+  s = versions_->LogAndApply(
+      cfds, mutable_cf_options_list, ReadOptions(), WriteOptions(),
+      edit_lists, &mutex_, directories_.GetDbDir(),
+      false /* new_descriptor_log */, &*cf_options);
+  if (!s.ok()) {
+    return s;
+  }
+  for (auto cfd : cfds) {
+    if (!cfd) {
+      continue;
+    }
+    cfd->imm()->RemoveOldMemTables(cfd->GetLogNumber(),
+                                   &job_context->memtables_to_free);
+    auto& sv_context = job_context->superversion_contexts.back();
+    if (!sv_context.new_superversion) {
+      sv_context.NewSuperVersion();
+    }
+    cfd->InstallSuperVersion(&sv_context, &mutex_);
+  }
+  if (point_lookup_cache_) {
+    point_lookup_cache_->InvalidateAll();
   }
 
-  if (evictObsoleteFiles) {
-    for (auto& file : job_context.sst_delete_files) {
-      auto number = file.metadata->fd.GetNumber();
-      if (file.metadata->table_reader_handle) {
-        table_cache_->Release(file.metadata->table_reader_handle);
-      }
-      file.DeleteMetadata();
+  info->has_manifest_writes = true;
+  info->current_manifest_update_seq = current_update_sequence;
+  info->latest_applied_manifest_update_seq =
+      latest_applied_update_sequence;
 
-      if (!file.only_delete_metadata) {
-        TableCache::Evict(table_cache_.get(), number);
-      }
+  for (auto& cf : added_column_families) {
+    auto* cfd = versions_->GetColumnFamilySet()->GetColumnFamily(cf);
+    auto& sv_context = job_context->superversion_contexts.back();
+    if (!sv_context.new_superversion) {
+      sv_context.NewSuperVersion();
     }
+    cfd->InstallSuperVersion(&sv_context, &mutex_);
+    cfd->set_initialized();
+    info->added_column_families.push_back(
+        std::make_unique<ColumnFamilyHandleImpl>(cfd, this, &mutex_));
   }
-  job_context.Clean();
 
   return s;
 }
@@ -1727,18 +2103,19 @@ Status DBImpl::GetReplicationRecordDebugString(
   auto s = Status::OK();
   switch (record.type) {
     case ReplicationLogRecord::kMemtableWrite: {
-      if (record.contents.size() < 8) {
+      auto contents = record.GetContents();
+      if (contents.size() < 8) {
         s = Status::Corruption("corrupted kMemtableWrite record");
         break;
       }
-      auto seq = DecodeFixed64(record.contents.data());
-      oss << "kMemtableWrite " << record.contents.size() << " bytes, sequence=" << seq;
+      auto seq = DecodeFixed64(contents.data());
+      oss << "kMemtableWrite " << contents.size() << " bytes, sequence=" << seq;
       break;
     }
     case ReplicationLogRecord::kMemtableSwitch: {
       WriteContext write_context;
       MemTableSwitchRecord mem_switch_record;
-      Slice contents_slice(record.contents);
+      Slice contents_slice = record.GetContents();
       s = DeserializeMemTableSwitchRecord(&contents_slice, &mem_switch_record);
       if (!s.ok()) {
         break;
@@ -1747,7 +2124,7 @@ Status DBImpl::GetReplicationRecordDebugString(
       break;
     }
     case ReplicationLogRecord::kManifestWrite: {
-      Slice contents_slice(record.contents);
+      Slice contents_slice = record.GetContents();
       autovector<VersionEdit> edits;
       s = DeserializeReplicationLogManifestWrite(&contents_slice, &edits);
       if (!s.ok()) {
@@ -2403,6 +2780,47 @@ void DBImpl::SchedulePurge() {
   env_->Schedule(&DBImpl::BGWorkPurge, this, Env::Priority::HIGH, nullptr);
 }
 
+void DBImpl::ScheduleFlattenMemTable(MemTable* mem) {
+  mutex_.AssertHeld();
+  mem->Ref();
+  memtables_to_flatten_.push_back(mem);
+  // One job flattens all the queued memtables
+  if (bg_flatten_scheduled_ == 0) {
+    bg_flatten_scheduled_++;
+    env_->Schedule(&DBImpl::BGWorkFlattenMemTables, this, Env::Priority::HIGH,
+                   nullptr);
+  }
+}
+
+void DBImpl::BackgroundCallFlattenMemTables() {
+  mutex_.Lock();
+  assert(bg_flatten_scheduled_ > 0);
+  while (!memtables_to_flatten_.empty()) {
+    MemTable* mem = memtables_to_flatten_.front();
+    memtables_to_flatten_.pop_front();
+    const bool shutting_down = shutting_down_.load(std::memory_order_acquire);
+    mutex_.Unlock();
+    if (!shutting_down) {
+      mem->Flatten();
+    }
+    mutex_.Lock();
+    MemTable* to_delete = mem->Unref();
+    if (to_delete != nullptr) {
+      mutex_.Unlock();
+      delete to_delete;
+      mutex_.Lock();
+    }
+  }
+  TEST_SYNC_POINT("DBImpl::BackgroundCallFlattenMemTables:Done");
+
+  bg_flatten_scheduled_--;
+
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll. This call may
+  // signal the DB destructor that it's OK to proceed with destruction.
+  mutex_.Unlock();
+}
+
 void DBImpl::BackgroundCallPurge() {
   mutex_.Lock();
 
@@ -2803,6 +3221,8 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
 
   GetWithTimestampReadCallback read_cb(0);  // Will call Refresh
 
+  PerfSampleGuard perf_sample(immutable_db_options_.perf_sample_one_in, stats_,
+                              PerfSampleOp::kGet);
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
   StopWatch sw(immutable_db_options_.clock, stats_, DB_GET);
   PERF_TIMER_GUARD(get_snapshot_time);
@@ -2838,7 +3258,35 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         << " doesn't match provided column family " << cfd->GetName();
     return Status::InvalidArgument(oss.str());
   }
+  // RocksDB-Cloud contribution end
+
+  PointLookupCache* const lookup_cache =
+      !super_snapshot &&
+              UsePointLookupCache(read_options, get_impl_options, cfd)
+          ? point_lookup_cache_.get()
+          : nullptr;
+  uint64_t lookup_epoch = 0;
+  if (lookup_cache != nullptr) {
+    lookup_epoch = lookup_cache->GetEpoch();
+    const SequenceNumber cache_snapshot =
+        read_options.snapshot != nullptr
+            ? static_cast<const SnapshotImpl*>(read_options.snapshot)->number_
+            : GetLastPublishedSequence();
+    Status cache_s;
+    if (lookup_cache->Lookup(cfd->GetID(), key, cache_snapshot,
+                             get_impl_options.value, &cache_s)) {
+      RecordTick(stats_, POINT_LOOKUP_CACHE_HIT);
+      RecordTick(stats_, NUMBER_KEYS_READ);
+      const size_t size = get_impl_options.value->size();
+      RecordTick(stats_, BYTES_READ, size);
+      PERF_COUNTER_ADD(get_read_bytes, size);
+      RecordInHistogram(stats_, BYTES_PER_READ, size);
+      return cache_s;
+    }
+    RecordTick(stats_, POINT_LOOKUP_CACHE_MISS);
+  }
 
+  // RocksDB-Cloud contribution begin
   // Acquire SuperVersion
   SuperVersion* sv =
       super_snapshot ? super_snapshot->sv() : GetAndRefSuperVersion(cfd);
@@ -2906,8 +3354,11 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   TEST_SYNC_POINT("DBImpl::GetImpl:3");
   TEST_SYNC_POINT("DBImpl::GetImpl:4");
 
-  // Prepare to store a list of merge operations if merge occurs.
-  MergeContext merge_context;
+  // Prepare to store a list of merge operations if merge occurs. Like the
+  // buffer of a long lookup key, it keeps its memory from the previous
+  // lookups of the thread.
+  LookupScratch scratch;
+  MergeContext& merge_context = scratch.merge_context();
   merge_context.get_merge_operands_options =
       get_impl_options.get_merge_operands_options;
   SequenceNumber max_covering_tombstone_seq = 0;
@@ -2916,7 +3367,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   // First look in the memtable, then in the immutable memtable (if any).
   // s is both in/out. When in, s could either be OK or MergeInProgress.
   // merge_operands will contain the sequence of merges in the latter case.
-  LookupKey lkey(key, snapshot, read_options.timestamp);
+  LookupKey lkey(key, snapshot, read_options.timestamp, scratch.key_buffer());
   PERF_TIMER_STOP(get_snapshot_time);
 
   bool skip_memtable = (read_options.read_tier == kPersistedTier &&
@@ -3096,9 +3547,43 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
 
     RecordInHistogram(stats_, BYTES_PER_READ, size);
   }
+  // A snapshot taken by the write path, e.g. for an in-place update, may not
+  // be published yet
+  if (lookup_cache != nullptr && (s.ok() || s.IsNotFound()) &&
+      snapshot <= GetLastPublishedSequence()) {
+    lookup_cache->Insert(cfd->GetID(), key, snapshot, lookup_epoch, s,
+                         *get_impl_options.value);
+  }
   return s;
 }
 
+bool DBImpl::UsePointLookupCache(const ReadOptions& read_options,
+                                 const GetImplOptions& get_impl_options,
+                                 ColumnFamilyData* cfd) const {
+  if (point_lookup_cache_ == nullptr || !get_impl_options.get_value ||
+      get_impl_options.value == nullptr ||
+      get_impl_options.columns != nullptr ||
+      get_impl_options.callback != nullptr ||
+      get_impl_options.is_blob_index != nullptr ||
+      get_impl_options.value_found != nullptr ||
+      get_impl_options.timestamp != nullptr) {
+    return false;
+  }
+  if (read_options.read_tier != kReadAllTier ||
+      read_options.timestamp != nullptr ||
+      read_options.ignore_range_deletions ||
+      read_options.merge_operand_count_threshold.has_value()) {
+    return false;
+  }
+  // A compaction filter, or a FIFO compaction dropping files, may change the
+  // result of a read without a write
+  const ImmutableOptions& ioptions = *cfd->ioptions();
+  return ioptions.compaction_filter == nullptr &&
+         ioptions.compaction_filter_factory == nullptr &&
+         ioptions.compaction_style != kCompactionStyleFIFO &&
+         cfd->user_comparator()->timestamp_size() == 0;
+}
+
 template <class T>
 Status DBImpl::MultiCFSnapshot(
     const ReadOptions& read_options, ReadCallback* callback,
@@ -4405,8 +4890,9 @@ std::unique_ptr<Iterator> DBImpl::NewMultiCfIterator(
   std::vector<Iterator*> child_iterators;
   Status s = NewIterators(_read_options, column_families, &child_iterators);
   if (s.ok()) {
-    return std::make_unique<MultiCfIterator>(first_comparator, column_families,
-                                             std::move(child_iterators));
+    return std::make_unique<MultiCfIterator>(
+        first_comparator, column_families, std::move(child_iterators),
+        multi_cf_seek_pool_.get());
   }
   return std::unique_ptr<Iterator>(NewErrorIterator(s));
 }
@@ -4527,7 +5013,14 @@ SequenceNumber DBImpl::GetIteratorSequenceNumber(Iterator* it) {
   return arena_wrapped->get_sequence();
 }
 
-const Snapshot* DBImpl::GetSnapshot() { return GetSnapshotImpl(false); }
+const Snapshot* DBImpl::GetSnapshot() {
+  // The snapshots of WritePrepared transaction DBs each have their own
+  // min_uncommitted_
+  if (immutable_db_options_.share_snapshots && snapshot_checker_ == nullptr) {
+    return GetSharedSnapshot();
+  }
+  return GetSnapshotImpl(false);
+}
 
 // RocksDB-Cloud contribution begin
 Status DBImpl::GetSuperSnapshots(
@@ -4641,6 +5134,45 @@ SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary,
   return snapshot;
 }
 
+SnapshotImpl* DBImpl::GetSharedSnapshot() {
+  SequenceNumber snapshot_seq = GetLastPublishedSequence();
+  SnapshotImpl* s = shared_snapshot_.load(std::memory_order_acquire);
+  if (s != nullptr && s->TryRef()) {
+    if (s->number_ == snapshot_seq) {
+      return s;
+    }
+    // Recycled, or taken before the last write
+    ReleaseSnapshot(s);
+  }
+
+  int64_t unix_time = 0;
+  immutable_db_options_.clock->GetCurrentTime(&unix_time)
+      .PermitUncheckedError();  // Ignore error
+  InstrumentedMutexLock l(&mutex_);
+  // returns null if the underlying memtable does not support snapshot.
+  if (!is_snapshot_supported_) {
+    return nullptr;
+  }
+  // Another caller may have added it meanwhile
+  snapshot_seq = GetLastPublishedSequence();
+  s = shared_snapshot_.load(std::memory_order_relaxed);
+  if (s != nullptr && s->number_ == snapshot_seq && s->TryRef()) {
+    return s;
+  }
+  if (free_shared_snapshots_.empty()) {
+    shared_snapshots_.emplace_back(new SnapshotImpl);
+    s = shared_snapshots_.back().get();
+    s->shared_ = true;
+  } else {
+    s = free_shared_snapshots_.back();
+    free_shared_snapshots_.pop_back();
+  }
+  snapshots_.New(s, snapshot_seq, unix_time,
+                 false /* is_write_conflict_boundary */);
+  shared_snapshot_.store(s, std::memory_order_release);
+  return s;
+}
+
 std::pair<Status, std::shared_ptr<const SnapshotImpl>>
 DBImpl::CreateTimestampedSnapshotImpl(SequenceNumber snapshot_seq, uint64_t ts,
                                       bool lock) {
@@ -4776,9 +5308,16 @@ void DBImpl::ReleaseSnapshot(const Snapshot* s) {
   // RocksDB-Cloud contribution end
 
   const SnapshotImpl* casted_s = static_cast<const SnapshotImpl*>(s);
+  if (casted_s->shared_ && !casted_s->Unref()) {
+    // Other callers of GetSnapshot() still hold it
+    return;
+  }
   {
     InstrumentedMutexLock l(&mutex_);
     snapshots_.Delete(casted_s);
+    if (casted_s->shared_) {
+      free_shared_snapshots_.push_back(const_cast<SnapshotImpl*>(casted_s));
+    }
     uint64_t oldest_snapshot;
     if (snapshots_.empty()) {
       oldest_snapshot = GetLastPublishedSequence();
@@ -4820,7 +5359,9 @@ void DBImpl::ReleaseSnapshot(const Snapshot* s) {
       bottommost_files_mark_threshold_ = new_bottommost_files_mark_threshold;
     }
   }
-  delete casted_s;
+  if (!casted_s->shared_) {
+    delete casted_s;
+  }
 }
 
 Status DBImpl::GetPropertiesOfAllTables(ColumnFamilyHandle* column_family,
@@ -5364,6 +5905,9 @@ Status DBImpl::DeleteFile(std::string name) {
     }
     edit.SetColumnFamily(cfd->GetID());
     edit.DeleteFile(level, number);
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
     status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
                                     read_options, write_options, &edit, &mutex_,
                                     directories_.GetDbDir());
@@ -5372,6 +5916,9 @@ Status DBImpl::DeleteFile(std::string name) {
           cfd, job_context.superversion_contexts.data(),
           *cfd->GetLatestMutableCFOptions());
     }
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
     FindObsoleteFiles(&job_context, false);
   }  // lock released here
 
@@ -5477,6 +6024,9 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
       return status;
     }
     input_version->Ref();
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
     status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
                                     read_options, write_options, &edit, &mutex_,
                                     directories_.GetDbDir());
@@ -5485,6 +6035,78 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
           cfd, job_context.superversion_contexts.data(),
           *cfd->GetLatestMutableCFOptions());
     }
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
+    for (auto* deleted_file : deleted_files) {
+      deleted_file->being_compacted = false;
+    }
+    input_version->Unref();
+    FindObsoleteFiles(&job_context, false);
+  }  // lock released here
+
+  LogFlush(immutable_db_options_.info_log);
+  // remove files outside the db-lock
+  if (job_context.HaveSomethingToDelete()) {
+    // Call PurgeObsoleteFiles() without holding mutex.
+    PurgeObsoleteFiles(job_context);
+  }
+  job_context.Clean();
+  return status;
+}
+
+Status DBImpl::DeleteTableFiles(ColumnFamilyHandle* column_family,
+                                const std::vector<uint64_t>& file_numbers) {
+  // TODO: plumb Env::IOActivity, Env::IOPriority
+  const ReadOptions read_options;
+  const WriteOptions write_options;
+
+  Status status = Status::OK();
+  auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
+  ColumnFamilyData* cfd = cfh->cfd();
+  std::unordered_set<uint64_t> numbers(file_numbers.begin(),
+                                       file_numbers.end());
+
+  VersionEdit edit;
+  std::vector<FileMetaData*> deleted_files;
+  JobContext job_context(next_job_id_.fetch_add(1), true);
+  {
+    InstrumentedMutexLock l(&mutex_);
+    Version* input_version = cfd->current();
+    auto* vstorage = input_version->storage_info();
+    for (int i = 0; i < cfd->NumberLevels(); i++) {
+      for (FileMetaData* level_file : vstorage->LevelFiles(i)) {
+        if (level_file->being_compacted ||
+            numbers.count(level_file->fd.GetNumber()) == 0) {
+          continue;
+        }
+        edit.SetColumnFamily(cfd->GetID());
+        edit.DeleteFile(i, level_file->fd.GetNumber());
+        deleted_files.push_back(level_file);
+        level_file->being_compacted = true;
+      }
+    }
+    if (deleted_files.empty()) {
+      job_context.Clean();
+      return status;
+    }
+    vstorage->ComputeCompactionScore(*cfd->ioptions(),
+                                     *cfd->GetLatestMutableCFOptions());
+    input_version->Ref();
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
+    status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
+                                    read_options, write_options, &edit, &mutex_,
+                                    directories_.GetDbDir());
+    if (status.ok()) {
+      InstallSuperVersionAndScheduleWork(
+          cfd, job_context.superversion_contexts.data(),
+          *cfd->GetLatestMutableCFOptions());
+    }
+    if (point_lookup_cache_) {
+      point_lookup_cache_->InvalidateAll();
+    }
     for (auto* deleted_file : deleted_files) {
       deleted_file->being_compacted = false;
     }
@@ -6516,6 +7138,11 @@ Status DBImpl::IngestExternalFiles(
         }
         assert(0 == num_entries);
       }
+      // Ingested files may be given sequence numbers older than the results
+      // cached for their keys
+      if (point_lookup_cache_) {
+        point_lookup_cache_->InvalidateAll();
+      }
       status = versions_->LogAndApply(
           cfds_to_commit, mutable_cf_options_list, read_options, write_options,
 
@@ -6564,6 +7191,9 @@ Status DBImpl::IngestExternalFiles(
 #endif  // !NDEBUG
         }
       }
+      if (point_lookup_cache_) {
+        point_lookup_cache_->InvalidateAll();
+      }
     } else if (versions_->io_status().IsIOError()) {
       // Error while writing to MANIFEST.
       // In fact, versions_->io_status() can also be the result of renaming
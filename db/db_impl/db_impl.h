@@ -35,6 +35,7 @@
 #include "db/logs_with_prep_tracker.h"
 #include "db/memtable_list.h"
 #include "db/periodic_task_scheduler.h"
+#include "db/point_lookup_cache.h"
 #include "db/post_memtable_callback.h"
 #include "db/range_del_aggregator.h"
 #include "db/read_callback.h"
@@ -54,7 +55,9 @@
 #include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/pre_release_callback.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/utilities/replayer.h"
@@ -430,6 +433,11 @@ class DBImpl : public DB {
                                    uint64_t snapshot_replication_epoch,
                                    ApplyReplicationLogRecordInfo* info,
                                    unsigned flags) override;
+  Status ApplyReplicationLogRecords(
+      std::vector<ReplicationLogRecordAndSequence> records,
+      CFOptionsFactory cf_options_factory, uint64_t snapshot_replication_epoch,
+      ApplyReplicationLogRecordInfo* info, unsigned flags,
+      size_t* num_applied) override;
 
   // Check that replicated epoch number of newly flushed files >= cfd's next
   // epoch number.
@@ -528,6 +536,14 @@ class DBImpl : public DB {
   Status DeleteFilesInRanges(ColumnFamilyHandle* column_family,
                              const RangePtr* ranges, size_t n,
                              bool include_end = true);
+  // Deletes the live table files of `column_family` with the given numbers,
+  // whatever their levels, in a single version edit. Files being compacted
+  // and numbers not found are skipped. Unlike DeleteFile(), does not make
+  // sure that no older version of their keys is left below them: only for
+  // callers to which that older data is as obsolete as the files, like the
+  // expired files of a DBWithTTL.
+  virtual Status DeleteTableFiles(ColumnFamilyHandle* column_family,
+                                  const std::vector<uint64_t>& file_numbers);
 
   void GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) override;
 
@@ -835,6 +851,12 @@ class DBImpl : public DB {
                                     int max_background_jobs,
                                     bool parallelize_compactions);
 
+  // Sets the weight of the flushes and compactions of this DB in the thread
+  // pools (Env::SetThreadPoolTagWeight()) from how close it is to a write
+  // stall, for the pools that schedule fairly among DBs
+  void UpdateBGJobWeight();
+  void SetBGJobWeight(uint32_t weight);
+
   // move logs pending closing from job_context to the DB queue and
   // schedule a purge
   void ScheduleBgLogWriterClose(JobContext* job_context);
@@ -1069,6 +1091,10 @@ class DBImpl : public DB {
 
   InstrumentedMutex* mutex() const { return &mutex_; }
 
+  PointLookupCache* point_lookup_cache() const {
+    return point_lookup_cache_.get();
+  }
+
   // Initialize a brand new DB. The DB directory is expected to be empty before
   // calling it. Push new manifest file name into `new_filenames`.
   Status NewDB(std::vector<std::string>* new_filenames);
@@ -1251,6 +1277,9 @@ class DBImpl : public DB {
   // dump rocksdb.stats to LOG
   void DumpStats();
 
+  // pass a snapshot of the stats to DBOptions::stats_exporter
+  void ExportStats();
+
   // flush LOG out of application buffer
   void FlushInfoLog();
 
@@ -1376,6 +1405,10 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
 
+  // Caches the results of Get(), if DBOptions::point_lookup_cache is set.
+  // Provides its own synchronization.
+  std::unique_ptr<PointLookupCache> point_lookup_cache_;
+
   ErrorHandler error_handler_;
 
   // Unified interface for logging events
@@ -1392,6 +1425,12 @@ class DBImpl : public DB {
   FileOptions file_options_for_compaction_;
 
   std::unique_ptr<ColumnFamilyMemTablesImpl> column_family_memtables_;
+  // Helper threads of ApplyReplicationLogRecords(), created on first use if
+  // replication_apply_threads > 1
+  std::unique_ptr<ThreadPool> replication_apply_pool_;
+  // Helper threads of the seeks of MultiCfIterators, created on open if
+  // multi_cf_iterator_seek_threads > 1
+  std::unique_ptr<ThreadPool> multi_cf_seek_pool_;
 
   // Increase the sequence number after writing each batch, whether memtable is
   // disabled for that or not. Otherwise the sequence number is increased after
@@ -1532,6 +1571,12 @@ class DBImpl : public DB {
                             bool disable_memtable = false,
                             uint64_t* seq_used = nullptr);
 
+  // Sends the batches of the writers in write_group that are written to the
+  // memtable, starting at sequence, to the replication log listener as one
+  // kMemtableWrite record
+  void RecordMemTableWrite(const WriteThread::WriteGroup& write_group,
+                           SequenceNumber sequence);
+
   // Write only to memtables without joining any write queue
   Status UnorderedWriteMemtable(const WriteOptions& write_options,
                                 WriteBatch* my_batch, WriteCallback* callback,
@@ -1990,6 +2035,12 @@ class DBImpl : public DB {
   // threshold.
   void WriteBufferManagerStallWrites();
 
+  // Delays the writes according to the pressure reported by the memory
+  // governor: the closer the mem-tables are to their limit, the lower the
+  // delayed write rate. No delay at zero pressure.
+  // REQUIRES: mutex_ is held
+  void UpdateMemoryGovernorWriteDelay(double pressure);
+
   Status ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                       WriteBatch* my_batch);
 
@@ -2016,6 +2067,41 @@ class DBImpl : public DB {
       ColumnFamilyData* cfd, WriteContext* context, uint64_t next_log_num,
       const std::string& replication_sequence);
 
+  // The steps of ApplyReplicationLogRecords(), one per record type.
+  //
+  // REQUIRES: mutex_ is held
+  // REQUIRES: this thread is currently at the front of the writer queue
+  //
+  // Inserts the kMemtableWrite records [begin, end) of records, releasing
+  // mutex_ once for all of them. Sets *num_applied to the number inserted.
+  // With replication_apply_threads, the batches without merges are inserted
+  // concurrently.
+  Status ApplyReplicationMemtableWrites(
+      std::vector<ReplicationLogRecordAndSequence>* records, size_t begin,
+      size_t end, size_t* num_applied);
+  // Replication apply stats, see DB::Properties::kReplicationStats
+  void UpdateReplicationLeaderSequence(
+      const std::vector<ReplicationLogRecordAndSequence>& records);
+  void RecordReplicationApplyStats(
+      const std::vector<ReplicationLogRecordAndSequence>& records,
+      size_t begin, size_t end, uint64_t apply_micros);
+  // Inserts the write batch contents with concurrent memtable writes, on this
+  // thread and replication_apply_pool_. Sets *num_inserted to the number of
+  // batches inserted before the first one that failed.
+  // REQUIRES: mutex_ is not held
+  Status InsertReplicatedBatchesConcurrently(const std::vector<Slice>& batches,
+                                             size_t* num_inserted);
+  Status ApplyReplicationMemtableSwitch(
+      const ReplicationLogRecord& record,
+      const std::string& replication_sequence);
+  // Collects the memtables to free in job_context
+  Status ApplyReplicationManifestWrite(
+      const ReplicationLogRecord& record,
+      const std::string& replication_sequence,
+      const CFOptionsFactory& cf_options_factory,
+      uint64_t snapshot_replication_epoch, ApplyReplicationLogRecordInfo* info,
+      JobContext* job_context);
+
   Status SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context);
 
   // Select and output column families qualified for atomic flush in
@@ -2135,7 +2221,8 @@ class DBImpl : public DB {
                       const WriteOptions& write_options,
                       log::Writer* log_writer, uint64_t* log_used,
                       uint64_t* log_size,
-                      LogFileNumberSize& log_file_number_size);
+                      LogFileNumberSize& log_file_number_size,
+                      bool sync_follows = false);
 
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
@@ -2203,18 +2290,22 @@ class DBImpl : public DB {
   void SchedulePendingCompaction(ColumnFamilyData* cfd);
   void SchedulePendingPurge(std::string fname, std::string dir_to_sync,
                             FileType type, uint64_t number, int job_id);
+  // Schedules a background job to flatten mem, which just turned immutable
+  void ScheduleFlattenMemTable(MemTable* mem);
   static void BGWorkCompaction(void* arg);
   // Runs a pre-chosen universal compaction involving bottom level in a
   // separate, bottom-pri thread pool.
   static void BGWorkBottomCompaction(void* arg);
   static void BGWorkFlush(void* arg);
   static void BGWorkPurge(void* arg);
+  static void BGWorkFlattenMemTables(void* arg);
   static void UnscheduleCompactionCallback(void* arg);
   static void UnscheduleFlushCallback(void* arg);
   void BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
                                 Env::Priority thread_pri);
   void BackgroundCallFlush(Env::Priority thread_pri);
   void BackgroundCallPurge();
+  void BackgroundCallFlattenMemTables();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer,
                               PrepickedCompaction* prepicked_compaction,
@@ -2285,6 +2376,11 @@ class DBImpl : public DB {
   SnapshotImpl* GetSnapshotImpl(bool is_write_conflict_boundary,
                                 bool lock = true);
 
+  // GetSnapshot() with DBOptions::share_snapshots: takes another reference
+  // to shared_snapshot_ if no write was published since it was taken, else
+  // adds a shared snapshot under the DB mutex
+  SnapshotImpl* GetSharedSnapshot();
+
   // If snapshot_seq != kMaxSequenceNumber, then this function can only be
   // called from the write thread that publishes sequence numbers to readers.
   // For 1) write-committed, or 2) write-prepared + one-write-queue, this will
@@ -2350,9 +2446,12 @@ class DBImpl : public DB {
   size_t GetWalPreallocateBlockSize(uint64_t write_buffer_size) const;
   Env::WriteLifeTimeHint CalculateWALWriteHint() { return Env::WLTH_SHORT; }
 
+  // compression_dict is the WAL compression dictionary of the new WAL, if
+  // any (see DBOptions::wal_compression_dict_bytes)
   IOStatus CreateWAL(const WriteOptions& write_options, uint64_t log_file_num,
                      uint64_t recycle_log_number, size_t preallocate_block_size,
-                     log::Writer** new_log);
+                     log::Writer** new_log,
+                     const Slice& compression_dict = Slice());
 
   // Validate self-consistency of DB options
   static Status ValidateOptions(const DBOptions& db_options);
@@ -2467,6 +2566,12 @@ class DBImpl : public DB {
 
   bool ShouldReferenceSuperVersion(const MergeContext& merge_context);
 
+  // Whether the result of a Get() can be looked up in and added to
+  // point_lookup_cache_
+  bool UsePointLookupCache(const ReadOptions& read_options,
+                           const GetImplOptions& get_impl_options,
+                           ColumnFamilyData* cfd) const;
+
   // Lock over the persistent DB state.  Non-nullptr iff successfully acquired.
   FileLock* db_lock_;
 
@@ -2502,7 +2607,8 @@ class DBImpl : public DB {
   // * if AnyManualCompaction, whenever a compaction finishes, even if it hasn't
   // made any progress
   // * whenever a compaction made any progress
-  // * whenever bg_flush_scheduled_ or bg_purge_scheduled_ value decreases
+  // * whenever bg_flush_scheduled_, bg_purge_scheduled_ or
+  // bg_flatten_scheduled_ value decreases
   // (i.e. whenever a flush is done, even if it didn't make any progress)
   // * whenever there is an error in background purge, flush or compaction
   // * whenever num_running_ingest_file_ goes to 0.
@@ -2644,6 +2750,13 @@ class DBImpl : public DB {
 
   bool stats_slice_initialized_ = false;
 
+  // The stats as of the previous ExportStats(), which only the thread of the
+  // periodic tasks uses. The compaction stats are by column family name.
+  StatisticsSnapshot export_snapshot_;
+  std::map<std::string, std::vector<InternalStats::CompactionStats>>
+      export_compaction_stats_;
+  uint64_t last_export_micros_ = 0;
+
   Directories directories_;
 
   WriteBufferManager* write_buffer_manager_;
@@ -2656,6 +2769,15 @@ class DBImpl : public DB {
 
   WriteController write_controller_;
 
+  MemoryGovernor* memory_governor_;
+  // Delays the writes while the memory governor reports pressure. It shares
+  // the delayed write rate with the column families that need a delay, and
+  // sets it to memory_governor_delayed_write_rate_. Protected by mutex_.
+  std::unique_ptr<WriteControllerToken> memory_governor_delay_token_;
+  uint64_t memory_governor_delayed_write_rate_;
+  // Whether memory_governor_delay_token_ is held, read without mutex_
+  std::atomic<bool> memory_governor_delayed_;
+
   // Size of the last batch group. In slowdown mode, next write needs to
   // sleep if it uses up the quota.
   // Note: This is to protect memtable and compaction. If the batch only writes
@@ -2670,6 +2792,15 @@ class DBImpl : public DB {
 
   TimestampedSnapshotList timestamped_snapshots_;
 
+  // The latest shared snapshot, see GetSharedSnapshot(). It may have been
+  // released since.
+  std::atomic<SnapshotImpl*> shared_snapshot_{nullptr};
+  // The shared snapshots, which are recycled through free_shared_snapshots_
+  // and only deleted with the DB, so that shared_snapshot_ always points to
+  // one. Protected by mutex_.
+  std::vector<std::unique_ptr<SnapshotImpl>> shared_snapshots_;
+  std::vector<SnapshotImpl*> free_shared_snapshots_;
+
   // For each background job, pending_outputs_ keeps the current file number at
   // the time that background job started.
   // FindObsoleteFiles()/PurgeObsoleteFiles() never deletes any file that has
@@ -2718,6 +2849,10 @@ class DBImpl : public DB {
 
   std::deque<SuperVersion*> superversions_to_free_queue_;
 
+  // The immutable memtables to flatten, each referenced until it is.
+  // Protected by db mutex_.
+  std::deque<MemTable*> memtables_to_flatten_;
+
   int unscheduled_flushes_;
 
   int unscheduled_compactions_;
@@ -2741,6 +2876,12 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of background memtable flattening jobs, submitted to the HIGH pool
+  int bg_flatten_scheduled_;
+
+  // weight of the background jobs of this DB in the thread pools
+  uint32_t bg_job_weight_;
+
   std::deque<ManualCompactionState*> manual_compaction_dequeue_;
 
   // shall we disable deletion of obsolete files
@@ -2867,6 +2867,7 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     // DB is being deleted; no more background compactions
     return;
   }
+  UpdateBGJobWeight();
   auto bg_job_limits = GetBGJobLimits();
   bool is_flush_pool_empty =
       env_->GetBackgroundThreads(Env::Priority::HIGH) == 0;
@@ -2935,6 +2936,33 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
   }
 }
 
+void DBImpl::UpdateBGJobWeight() {
+  mutex_.AssertHeld();
+  uint32_t weight = 1;
+  if (write_controller_.IsStopped()) {
+    weight = 8;
+  } else if (write_controller_.NeedsDelay()) {
+    weight = 4;
+  } else if (write_controller_.NeedSpeedupCompaction()) {
+    weight = 2;
+  }
+  SetBGJobWeight(weight);
+}
+
+void DBImpl::SetBGJobWeight(uint32_t weight) {
+  mutex_.AssertHeld();
+  if (weight == bg_job_weight_) {
+    return;
+  }
+  bg_job_weight_ = weight;
+  for (auto pri :
+       {Env::Priority::BOTTOM, Env::Priority::LOW, Env::Priority::HIGH}) {
+    // Not supported by all Envs, in which case jobs are run in FIFO order
+    env_->SetThreadPoolTagWeight(pri, GetTaskTag(TaskType::kDefault), weight)
+        .PermitUncheckedError();
+  }
+}
+
 DBImpl::BGJobLimits DBImpl::GetBGJobLimits() const {
   mutex_.AssertHeld();
   return GetBGJobLimits(mutable_db_options_.max_background_flushes,
@@ -3119,6 +3147,11 @@ void DBImpl::BGWorkPurge(void* db) {
   TEST_SYNC_POINT("DBImpl::BGWorkPurge:end");
 }
 
+void DBImpl::BGWorkFlattenMemTables(void* db) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::HIGH);
+  static_cast<DBImpl*>(db)->BackgroundCallFlattenMemTables();
+}
+
 void DBImpl::UnscheduleCompactionCallback(void* arg) {
   CompactionArg* ca_ptr = static_cast<CompactionArg*>(arg);
   Env::Priority compaction_pri = ca_ptr->compaction_pri_;
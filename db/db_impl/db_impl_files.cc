@@ -436,6 +436,7 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
     }
     if (file.metadata->table_reader_handle) {
       table_cache_->Release(file.metadata->table_reader_handle);
+      versions_->UnpinTableReaders(1);
     }
     file.DeleteMetadata();
   }
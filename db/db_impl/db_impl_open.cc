@@ -12,6 +12,7 @@
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
 #include "db/periodic_task_scheduler.h"
+#include "db/pipelined_log_reader.h"
 #include "env/composite_env_wrapper.h"
 #include "file/filename.h"
 #include "file/read_write_util.h"
@@ -21,6 +22,7 @@
 #include "monitoring/persistent_stats_history.h"
 #include "monitoring/thread_status_util.h"
 #include "options/options_helper.h"
+#include "rocksdb/memory_governor.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
 #include "rocksdb/wal_filter.h"
@@ -70,6 +72,10 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src,
     }
   }
 
+  if (result.memory_governor) {
+    result.write_buffer_manager =
+        result.memory_governor->write_buffer_manager();
+  }
   if (!result.write_buffer_manager) {
     result.write_buffer_manager.reset(
         new WriteBufferManager(result.db_write_buffer_size));
@@ -1237,8 +1243,10 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
+    PipelinedLogReader reader(
+        immutable_db_options_.info_log, std::move(file_reader), &reporter,
+        true /*checksum*/, wal_number, immutable_db_options_.wal_recovery_mode,
+        immutable_db_options_.wal_recovery_pipeline_size);
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
@@ -1252,9 +1260,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                              /*arg=*/nullptr);
     uint64_t record_checksum;
     while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode,
-                             &record_checksum) &&
+           reader.ReadRecord(&record, &scratch, &record_checksum) &&
            status.ok()) {
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
@@ -1938,7 +1944,8 @@ Status DB::OpenAndTrimHistory(
 IOStatus DBImpl::CreateWAL(const WriteOptions& write_options,
                            uint64_t log_file_num, uint64_t recycle_log_number,
                            size_t preallocate_block_size,
-                           log::Writer** new_log) {
+                           log::Writer** new_log,
+                           const Slice& compression_dict) {
   IOStatus io_s;
   std::unique_ptr<FSWritableFile> lfile;
 
@@ -1978,7 +1985,15 @@ IOStatus DBImpl::CreateWAL(const WriteOptions& write_options,
                                immutable_db_options_.recycle_log_file_num > 0,
                                immutable_db_options_.manual_wal_flush,
                                immutable_db_options_.wal_compression);
-    io_s = (*new_log)->AddCompressionTypeRecord(write_options);
+    if (immutable_db_options_.wal_compression != kNoCompression &&
+        immutable_db_options_.wal_compression_dict_bytes > 0) {
+      // For the next WAL
+      (*new_log)->SampleForCompressionDict(
+          std::min(immutable_db_options_.wal_compression_dict_bytes,
+                   log::Writer::kMaxCompressionDictBytes));
+    }
+    io_s = (*new_log)->AddCompressionTypeRecord(write_options,
+                                                compression_dict);
   }
   return io_s;
 }
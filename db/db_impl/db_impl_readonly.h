@@ -101,6 +101,12 @@ class DBImplReadOnly : public DBImpl {
     return Status::NotSupported("Not supported operation in read only mode.");
   }
 
+  Status DeleteTableFiles(
+      ColumnFamilyHandle* /*column_family*/,
+      const std::vector<uint64_t>& /*file_numbers*/) override {
+    return Status::NotSupported("Not supported operation in read only mode.");
+  }
+
   Status EnableFileDeletions() override {
     return Status::NotSupported("Not supported operation in read only mode.");
   }
@@ -102,8 +102,26 @@ Status DBImplSecondary::FindNewLogNumbers(std::vector<uint64_t>* logs) {
   Status s;
   IOOptions io_opts;
   io_opts.do_not_recurse = true;
-  s = immutable_db_options_.fs->GetChildren(immutable_db_options_.GetWalDir(),
-                                            io_opts, &filenames,
+  const std::string& wal_dir = immutable_db_options_.GetWalDir();
+  uint64_t mtime = 0;
+  uint64_t now = 0;
+  if (immutable_db_options_.secondary_skip_unchanged_wal_dir) {
+    now = immutable_db_options_.clock->NowMicros() / 1000000;
+    Status mtime_s = immutable_db_options_.fs->GetFileModificationTime(
+        wal_dir, io_opts, &mtime, /*IODebugContext*=*/nullptr);
+    if (!mtime_s.ok()) {
+      mtime = 0;
+    } else if (mtime == wal_dir_mtime_ && mtime < wal_dir_listed_at_) {
+      // Not modified since a listing taken after the second it was last
+      // modified in: no new WAL, keep tailing the ones being read
+      for (const auto& reader : log_readers_) {
+        logs->push_back(reader.first);
+      }
+      TEST_SYNC_POINT("DBImplSecondary::FindNewLogNumbers:SkipListing");
+      return s;
+    }
+  }
+  s = immutable_db_options_.fs->GetChildren(wal_dir, io_opts, &filenames,
                                             /*IODebugContext*=*/nullptr);
   if (s.IsNotFound()) {
     return Status::InvalidArgument("Failed to open wal_dir",
@@ -111,6 +129,8 @@ Status DBImplSecondary::FindNewLogNumbers(std::vector<uint64_t>* logs) {
   } else if (!s.ok()) {
     return s;
   }
+  wal_dir_mtime_ = mtime;
+  wal_dir_listed_at_ = now;
 
   // if log_readers_ is non-empty, it means we have applied all logs with log
   // numbers smaller than the smallest log in log_readers_, so there is no
@@ -682,8 +702,12 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
             ->ReadAndApply(&mutex_, &manifest_reader_,
                            manifest_reader_status_.get(), &cfds_changed);
 
-    ROCKS_LOG_INFO(immutable_db_options_.info_log, "Last sequence is %" PRIu64,
-                   static_cast<uint64_t>(versions_->LastSequence()));
+    // Frequent polls of an idle primary don't fill the log
+    if (!cfds_changed.empty()) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Last sequence is %" PRIu64,
+                     static_cast<uint64_t>(versions_->LastSequence()));
+    }
     for (ColumnFamilyData* cfd : cfds_changed) {
       if (cfd->IsDropped()) {
         ROCKS_LOG_DEBUG(immutable_db_options_.info_log, "[%s] is dropped\n",
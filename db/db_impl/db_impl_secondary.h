@@ -315,6 +315,12 @@ class DBImplSecondary : public DBImpl {
   // Current WAL number replayed for each column family.
   std::unordered_map<ColumnFamilyData*, uint64_t> cfd_to_current_log_;
 
+  // Modification time of the WAL directory at its last listing, and the time
+  // just before that listing, in seconds. See
+  // DBOptions::secondary_skip_unchanged_wal_dir.
+  uint64_t wal_dir_mtime_ = 0;
+  uint64_t wal_dir_listed_at_ = 0;
+
   const std::string secondary_path_;
 };
 
@@ -14,7 +14,9 @@
 #include "db/db_impl/replication_codec.h"
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/perf_sampling.h"
 #include "options/options_helper.h"
+#include "rocksdb/memory_governor.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
 
@@ -185,6 +187,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          size_t batch_cnt,
                          PreReleaseCallback* pre_release_callback,
                          PostMemTableCallback* post_memtable_callback) {
+  PerfSampleGuard perf_sample(immutable_db_options_.perf_sample_one_in, stats_,
+                              PerfSampleOp::kWrite);
   if (!pre_release_callback) {
     pre_release_callback = write_options.pre_release_callback;
   }
@@ -239,11 +243,6 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       return Status::NotSupported(
           "replication_log_listener is not compatible with two_write_queues");
     }
-    if (immutable_db_options_.enable_pipelined_write) {
-      return Status::NotSupported(
-          "replication_log_listener is not compatible with "
-          "enable_pipelined_write");
-    }
     if (!write_options.disableWAL) {
       return Status::NotSupported(
           "replication_log_listener is not compatible with "
@@ -555,25 +554,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     last_sequence += seq_inc;
 
     if (status.ok() && immutable_db_options_.replication_log_listener) {
-      WriteBatch wb;
-      bool first = true;
-      for (auto writer : write_group) {
-        Status s;
-        if (first) {
-          s = WriteBatchInternal::SetContents(&wb, writer->batch->Data());
-          first = false;
-        } else {
-          s = WriteBatchInternal::Append(&wb, writer->batch, true);
-        }
-        assert(s.ok());
-      }
-      WriteBatchInternal::SetSequence(&wb, current_sequence);
-
-      ReplicationLogRecord rlr;
-      rlr.contents = WriteBatchInternal::StealContents(&wb);
-      rlr.type = ReplicationLogRecord::kMemtableWrite;
-      immutable_db_options_.replication_log_listener->OnReplicationLogRecord(
-          std::move(rlr));
+      RecordMemTableWrite(write_group, current_sequence);
     }
 
     // PreReleaseCallback is called after WAL write and before memtable write
@@ -719,6 +700,55 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   return status;
 }
 
+void DBImpl::RecordMemTableWrite(const WriteThread::WriteGroup& write_group,
+                                 SequenceNumber sequence) {
+  auto* listener = immutable_db_options_.replication_log_listener.get();
+  // Only the writers that were assigned sequence numbers
+  auto recorded = [](WriteThread::Writer* writer) {
+    return !writer->CallbackFailed() && writer->ShouldWriteToMemtable();
+  };
+  WriteBatch* single_batch = nullptr;
+  size_t num_batches = 0;
+  for (auto writer : write_group) {
+    if (recorded(writer)) {
+      single_batch = writer->batch;
+      ++num_batches;
+    }
+  }
+  if (num_batches == 0) {
+    return;
+  }
+
+  ReplicationLogRecord rlr;
+  rlr.type = ReplicationLogRecord::kMemtableWrite;
+  if (num_batches == 1 && listener->AcceptsPinnedContents()) {
+    // The batch outlives the call, hand it out as is
+    WriteBatchInternal::SetSequence(single_batch, sequence);
+    rlr.pinned_contents = WriteBatchInternal::Contents(single_batch);
+    listener->OnReplicationLogRecord(std::move(rlr));
+    return;
+  }
+
+  WriteBatch wb;
+  bool first = true;
+  for (auto writer : write_group) {
+    if (!recorded(writer)) {
+      continue;
+    }
+    Status s;
+    if (first) {
+      s = WriteBatchInternal::SetContents(&wb, writer->batch->Data());
+      first = false;
+    } else {
+      s = WriteBatchInternal::Append(&wb, writer->batch, true);
+    }
+    assert(s.ok());
+  }
+  WriteBatchInternal::SetSequence(&wb, sequence);
+  rlr.contents = WriteBatchInternal::StealContents(&wb);
+  listener->OnReplicationLogRecord(std::move(rlr));
+}
+
 Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                                   WriteBatch* my_batch, WriteCallback* callback,
                                   uint64_t* log_used, uint64_t log_ref,
@@ -738,7 +768,18 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (w.callback && !w.callback->AllowWriteBatching()) {
       write_thread_.WaitForMemTableWriters();
     }
-    LogContext log_context(!write_options.disableWAL && write_options.sync);
+    // With pipelined_wal_sync the memtable writers sync the WAL, so that the
+    // next groups can append to it meanwhile. That needs a WAL file that can
+    // be synced while being appended to.
+    bool defer_wal_sync = false;
+    if (write_options.sync && !write_options.disableWAL &&
+        immutable_db_options_.pipelined_wal_sync && !manual_wal_flush_) {
+      InstrumentedMutexLock l(&log_write_mutex_);
+      defer_wal_sync =
+          logs_.back().writer->file()->writable_file()->IsSyncThreadSafe();
+    }
+    LogContext log_context(!write_options.disableWAL && write_options.sync &&
+                           !defer_wal_sync);
     // PreprocessWrite does its own perf timing.
     PERF_TIMER_STOP(write_pre_and_post_process_time);
     w.status = PreprocessWrite(write_options, &log_context, &write_context);
@@ -822,6 +863,31 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
       WriteStatusCheck(w.status);
     }
 
+    if (w.status.ok() && defer_wal_sync) {
+      bool sync_now = false;
+      for (auto* writer : wal_write_group) {
+        if (!writer->sync || writer->CallbackFailed()) {
+          continue;
+        }
+        if (writer->ShouldWriteToMemtable()) {
+          writer->wal_sync_deferred = true;
+        } else {
+          // Completed when the group leaves the WAL stage
+          sync_now = true;
+        }
+      }
+      if (sync_now) {
+        w.status = SyncWAL();
+      }
+    }
+
+    // The WAL stage runs one group at a time, in sequence order, and memtable
+    // switches wait for the memtable writers of the groups before them, so
+    // the records are in the same order as without pipelining.
+    if (w.status.ok() && immutable_db_options_.replication_log_listener) {
+      RecordMemTableWrite(wal_write_group, current_sequence);
+    }
+
     VersionEdit synced_wals;
     if (log_context.need_log_sync) {
       InstrumentedMutexLock l(&log_write_mutex_);
@@ -851,8 +917,18 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
     assert(w.ShouldWriteToMemtable());
     write_thread_.EnterAsMemTableWriter(&w, &memtable_write_group);
-    if (memtable_write_group.size > 1 &&
-        immutable_db_options_.allow_concurrent_memtable_write) {
+    // One sync covers the deferred WAL syncs of the whole group
+    for (auto* writer : memtable_write_group) {
+      if (writer->wal_sync_deferred) {
+        TEST_SYNC_POINT("DBImpl::PipelinedWriteImpl:DeferredWalSync");
+        memtable_write_group.status = SyncWAL();
+        break;
+      }
+    }
+    if (!memtable_write_group.status.ok()) {
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
+    } else if (memtable_write_group.size > 1 &&
+               immutable_db_options_.allow_concurrent_memtable_write) {
       write_thread_.LaunchParallelMemTableWriters(&memtable_write_group);
     } else {
       memtable_write_group.status = WriteBatchInternal::InsertInto(
@@ -1276,6 +1352,15 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
   PERF_TIMER_STOP(write_scheduling_flushes_compactions_time);
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
 
+  if (UNLIKELY(status.ok() && memory_governor_ != nullptr)) {
+    const double pressure = memory_governor_->GetWritePressure();
+    if (pressure > 0 ||
+        memory_governor_delayed_.load(std::memory_order_relaxed)) {
+      InstrumentedMutexLock l(&mutex_);
+      UpdateMemoryGovernorWriteDelay(pressure);
+    }
+  }
+
   if (UNLIKELY(status.ok() && (write_controller_.IsStopped() ||
                                write_controller_.NeedsDelay()))) {
     PERF_TIMER_STOP(write_pre_and_post_process_time);
@@ -1388,7 +1473,8 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             const WriteOptions& write_options,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size,
-                            LogFileNumberSize& log_file_number_size) {
+                            LogFileNumberSize& log_file_number_size,
+                            bool sync_follows) {
   assert(log_size != nullptr);
 
   Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
@@ -1414,7 +1500,9 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (!io_s.ok()) {
     return io_s;
   }
-  io_s = log_writer->AddRecord(write_options, log_entry);
+  // A sync that follows writes the record itself, with the sync
+  io_s = log_writer->AddRecord(write_options, log_entry,
+                               /*flush=*/!sync_follows);
 
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
@@ -1463,14 +1551,16 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   write_options.rate_limiter_priority =
       write_group.leader->rate_limiter_priority;
   io_s = WriteToWAL(*merged_batch, write_options, log_writer, log_used,
-                    &log_size, log_file_number_size);
+                    &log_size, log_file_number_size, need_log_sync);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
     cached_recoverable_state_empty_ = false;
   }
 
+  uint64_t sync_micros = 0;
   if (io_s.ok() && need_log_sync) {
-    StopWatch sw(immutable_db_options_.clock, stats_, WAL_FILE_SYNC_MICROS);
+    StopWatch sw(immutable_db_options_.clock, stats_, WAL_FILE_SYNC_MICROS,
+                 Histograms::HISTOGRAM_ENUM_MAX, &sync_micros);
     // It's safe to access logs_ with unlocked mutex_ here because:
     //  - we've set getting_synced=true for all logs,
     //    so other threads won't pop from logs_ while we're here,
@@ -1526,6 +1616,7 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
     if (need_log_sync) {
       stats->AddDBStats(InternalStats::kIntStatsWalFileSynced, 1);
       RecordTick(stats_, WAL_FILE_SYNCED);
+      write_thread_.RecordWalSyncTime(sync_micros);
     }
     stats->AddDBStats(InternalStats::kIntStatsWalFileBytes, log_size);
     RecordTick(stats_, WAL_FILE_BYTES, log_size);
@@ -2052,6 +2143,37 @@ void DBImpl::WriteBufferManagerStallWrites() {
   write_thread_.EndWriteStall();
 }
 
+void DBImpl::UpdateMemoryGovernorWriteDelay(double pressure) {
+  mutex_.AssertHeld();
+  if (pressure <= 0) {
+    memory_governor_delay_token_.reset();
+    if (memory_governor_delayed_write_rate_ > 0 &&
+        !write_controller_.NeedsDelay()) {
+      // Don't leave the rate of the memory pressure to the next delay of a
+      // column family
+      write_controller_.set_delayed_write_rate(
+          write_controller_.max_delayed_write_rate());
+    }
+    memory_governor_delayed_write_rate_ = 0;
+    memory_governor_delayed_.store(false, std::memory_order_relaxed);
+    return;
+  }
+  // The rate falls in steps from the max delayed write rate, so that it only
+  // changes when the pressure does noticeably, down to 1/kSteps of it before
+  // the write buffer manager stalls the writes
+  const uint64_t kSteps = 32;
+  const uint64_t step = std::min<uint64_t>(
+      static_cast<uint64_t>(pressure * kSteps), kSteps - 1);
+  const uint64_t write_rate =
+      write_controller_.max_delayed_write_rate() / kSteps * (kSteps - step);
+  if (memory_governor_delay_token_ == nullptr ||
+      write_rate != memory_governor_delayed_write_rate_) {
+    memory_governor_delay_token_ = write_controller_.GetDelayToken(write_rate);
+    memory_governor_delayed_write_rate_ = write_rate;
+    memory_governor_delayed_.store(true, std::memory_order_relaxed);
+  }
+}
+
 Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                             WriteBatch* my_batch) {
   assert(write_options.low_pri);
@@ -2291,6 +2413,9 @@ Status DBImpl::SwitchMemtableWithoutCreatingWAL(
   cfd->mem()->SetNextLogNumber(logfile_number_);
   cfd->mem()->SetReplicationSequence(replication_sequence);
   cfd->imm()->Add(cfd->mem(), &context->memtables_to_free_);
+  if (mutable_cf_options.flatten_immutable_memtables) {
+    ScheduleFlattenMemTable(cfd->mem());
+  }
   new_mem->Ref();
   cfd->SetMemtable(new_mem);
   InstallSuperVersionAndScheduleWork(cfd, &context->superversion_context,
@@ -2358,12 +2483,18 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   int num_imm_unflushed = cfd->imm()->NumNotFlushed();
   const auto preallocate_block_size =
       GetWalPreallocateBlockSize(mutable_cf_options.write_buffer_size);
+  // The new WAL is compressed with the start of the current one. No writer
+  // adds to it while this thread is at the front of the writer queues.
+  std::string wal_compression_dict;
+  if (creating_new_log && !logs_.empty()) {
+    wal_compression_dict = logs_.back().writer->compression_dict_samples();
+  }
   mutex_.Unlock();
   if (creating_new_log) {
     // TODO: Write buffer size passed in should be max of all CF's instead
     // of mutable_cf_options.write_buffer_size.
     io_s = CreateWAL(write_options, new_log_number, recycle_log_number,
-                     preallocate_block_size, &new_log);
+                     preallocate_block_size, &new_log, wal_compression_dict);
     if (s.ok()) {
       s = io_s;
     }
@@ -2507,6 +2638,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   cfd->mem()->SetNextLogNumber(logfile_number_);
   assert(new_mem != nullptr);
   cfd->imm()->Add(cfd->mem(), &context->memtables_to_free_);
+  if (mutable_cf_options.flatten_immutable_memtables) {
+    ScheduleFlattenMemTable(cfd->mem());
+  }
   new_mem->Ref();
   cfd->SetMemtable(new_mem);
   InstallSuperVersionAndScheduleWork(cfd, &context->superversion_context,
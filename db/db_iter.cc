@@ -9,10 +9,12 @@
 
 #include "db/db_iter.h"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 #include <string>
 
+#include "db/blob/blob_index.h"
 #include "db/dbformat.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
@@ -29,6 +31,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/system_clock.h"
 #include "table/internal_iterator.h"
+#include "table/iterator_batch.h"
 #include "table/iterator_wrapper.h"
 #include "trace_replay/trace_replay.h"
 #include "util/mutexlock.h"
@@ -90,6 +93,23 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
   if (iter_.iter()) {
     iter_.iter()->SetPinnedItersMgr(&pinned_iters_mgr_);
   }
+  if (read_options.column_projection) {
+    column_projection_ = *read_options.column_projection;
+    std::sort(column_projection_.begin(), column_projection_.end(),
+              [](const Slice& lhs, const Slice& rhs) {
+                return lhs.compare(rhs) < 0;
+              });
+    column_projection_.erase(
+        std::unique(column_projection_.begin(), column_projection_.end()),
+        column_projection_.end());
+    has_column_projection_ = true;
+  }
+  if (read_options.blob_readahead_size > 0) {
+    blob_prefetch_buffers_.reset(new PrefetchBufferCollection(
+        read_options.blob_readahead_size, read_options.async_io ? 2 : 1,
+        ioptions.fs.get(), clock_, statistics_,
+        FilePrefetchBufferUsage::kUserScanPrefetch));
+  }
   status_.PermitUncheckedError();
   assert(timestamp_size_ ==
          user_comparator_.user_comparator()->timestamp_size());
@@ -182,6 +202,31 @@ void DBIter::Next() {
   }
 }
 
+size_t DBIter::NextBatch(size_t max_entries, std::vector<Slice>* keys,
+                         std::vector<Slice>* values, std::string* buffer) {
+  IteratorBatchBuilder batch(keys, values, buffer);
+  size_t n = 0;
+  for (; n < max_entries && valid_; n++) {
+    const bool key_pinned = pin_thru_lifetime_ && saved_key_.IsKeyPinned();
+    // The value is pinned if it is in the pinned value of the current
+    // internal key, rather than a merge result, blob or saved copy
+    bool value_pinned = false;
+    if (pin_thru_lifetime_ && direction_ == kForward && !is_blob_ &&
+        !current_entry_is_merged_ && iter_.Valid() &&
+        iter_.iter()->IsValuePinned()) {
+      const Slice raw_value = iter_.value();
+      value_pinned = value_.empty() ||
+                     (value_.data() >= raw_value.data() &&
+                      value_.data() + value_.size() <=
+                          raw_value.data() + raw_value.size());
+    }
+    batch.Add(key(), key_pinned, value_, value_pinned);
+    Next();
+  }
+  batch.Finish();
+  return n;
+}
+
 bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
                                   const Slice& blob_index) {
   assert(!is_blob_);
@@ -206,11 +251,19 @@ bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
   read_options.fill_cache = fill_cache_;
   read_options.verify_checksums = verify_checksums_;
   read_options.io_activity = io_activity_;
-  constexpr FilePrefetchBuffer* prefetch_buffer = nullptr;
   constexpr uint64_t* bytes_read = nullptr;
 
-  const Status s = version_->GetBlob(read_options, user_key, blob_index,
-                                     prefetch_buffer, &blob_value_, bytes_read);
+  BlobIndex decoded_blob_index;
+  Status s = decoded_blob_index.DecodeFrom(blob_index);
+  if (s.ok()) {
+    FilePrefetchBuffer* const prefetch_buffer =
+        blob_prefetch_buffers_ && !decoded_blob_index.IsInlined()
+            ? blob_prefetch_buffers_->GetOrCreatePrefetchBuffer(
+                  decoded_blob_index.file_number())
+            : nullptr;
+    s = version_->GetBlob(read_options, user_key, decoded_blob_index,
+                          prefetch_buffer, &blob_value_, bytes_read);
+  }
 
   if (!s.ok()) {
     status_ = s;
@@ -226,7 +279,11 @@ bool DBIter::SetValueAndColumnsFromEntity(Slice slice) {
   assert(value_.empty());
   assert(wide_columns_.empty());
 
-  const Status s = WideColumnSerialization::Deserialize(slice, wide_columns_);
+  const Status s = has_column_projection_
+                       ? WideColumnSerialization::Deserialize(
+                             slice, column_projection_, wide_columns_)
+                       : WideColumnSerialization::Deserialize(slice,
+                                                              wide_columns_);
 
   if (!s.ok()) {
     status_ = s;
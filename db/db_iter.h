@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <string>
 
+#include "db/blob/prefetch_buffer_collection.h"
 #include "db/db_impl/db_impl.h"
 #include "db/range_del_aggregator.h"
 #include "memory/arena.h"
@@ -201,6 +202,8 @@ class DBIter final : public Iterator {
   Status GetProperty(std::string prop_name, std::string* prop) override;
 
   void Next() final override;
+  size_t NextBatch(size_t max_entries, std::vector<Slice>* keys,
+                   std::vector<Slice>* values, std::string* buffer) override;
   void Prev() final override;
   // 'target' does not contain timestamp, even if user timestamp feature is
   // enabled.
@@ -379,6 +382,8 @@ class DBIter final : public Iterator {
   Slice pinned_value_;
   // for prefix seek mode to support prev()
   PinnableSlice blob_value_;
+  // Set if ReadOptions::blob_readahead_size > 0
+  std::unique_ptr<PrefetchBufferCollection> blob_prefetch_buffers_;
   // Value of the default column
   Slice value_;
   // All columns (i.e. name-value pairs)
@@ -421,6 +426,9 @@ class DBIter final : public Iterator {
   bool is_blob_;
   bool arena_mode_;
   const Env::IOActivity io_activity_;
+  // ReadOptions::column_projection, sorted
+  std::vector<Slice> column_projection_;
+  bool has_column_projection_ = false;
   // List of operands for merge operator.
   MergeContext merge_context_;
   LocalStatistics local_stats_;
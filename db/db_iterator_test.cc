@@ -18,6 +18,7 @@
 #include "rocksdb/perf_context.h"
 #include "table/block_based/flush_block_policy_impl.h"
 #include "util/random.h"
+#include "utilities/merge_operators.h"
 #include "utilities/merge_operators/string_append/stringappend2.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -367,6 +368,57 @@ TEST_P(DBIteratorTest, IterNextWithNewerSeq) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, NextBatch) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  // Keys in the SST file and the memtable, with merges and deletions
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+    expected[Key(i)] = "v" + std::to_string(i);
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_OK(Merge(Key(i), "m"));
+    expected[Key(i)] += ",m";
+  }
+  for (int i = 1; i < 100; i += 7) {
+    ASSERT_OK(Delete(Key(i)));
+    expected.erase(Key(i));
+  }
+
+  for (bool pin_data : {false, true}) {
+    ReadOptions read_options;
+    read_options.pin_data = pin_data;
+    std::unique_ptr<Iterator> iter(NewIterator(read_options));
+    std::vector<Slice> keys;
+    std::vector<Slice> values;
+    std::string buffer;
+    iter->Seek(Key(10));
+    // The current entry comes after a reverse move
+    iter->Prev();
+    iter->Next();
+    size_t n = 0;
+    do {
+      n = iter->NextBatch(16, &keys, &values, &buffer);
+    } while (n == 16);
+    ASSERT_OK(iter->status());
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_EQ(iter->NextBatch(16, &keys, &values, &buffer), 0u);
+
+    ASSERT_EQ(keys.size(), values.size());
+    auto it = expected.lower_bound(Key(10));
+    for (size_t i = 0; i < keys.size(); i++, it++) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(keys[i], it->first);
+      ASSERT_EQ(values[i], it->second);
+    }
+    ASSERT_TRUE(it == expected.end());
+  }
+}
+
 TEST_P(DBIteratorTest, IterPrevWithNewerSeq) {
   ASSERT_OK(Put("0", "0"));
   EXPECT_OK(dbfull()->Flush(FlushOptions()));
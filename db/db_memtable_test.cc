@@ -277,6 +277,130 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+TEST_F(DBMemTableTest, HashIndex) {
+  Options options;
+  options.memtable_hash_index_size_ratio = 0.01;
+  InternalKeyComparator cmp(BytewiseComparator());
+  options.memtable_factory = std::make_shared<SkipListFactory>();
+  ImmutableOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+
+  int from_entry = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "MemTable::GetFromTable:FromEntry", [&](void*) { from_entry++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Versions of "key" at 10, 12, ..., 48, deleted at 50, with other keys
+  // around it
+  SequenceNumber seq = 10;
+  for (; seq < 50; seq += 2) {
+    ASSERT_OK(mem->Add(seq, kTypeValue, "key", "v" + std::to_string(seq),
+                       nullptr /* kv_prot_info */));
+    ASSERT_OK(mem->Add(seq + 1, kTypeValue, "key" + std::to_string(seq), "v",
+                       nullptr /* kv_prot_info */));
+  }
+  ASSERT_OK(
+      mem->Add(seq, kTypeDeletion, "key", "", nullptr /* kv_prot_info */));
+
+  // Each snapshot sees the latest version at or before it, whether it is
+  // before or after the latest entry
+  ReadOptions roptions;
+  for (SequenceNumber snapshot = 5; snapshot <= 55; snapshot++) {
+    std::string value;
+    Status s;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    LookupKey lkey("key", snapshot);
+    bool found = mem->Get(lkey, &value, /*columns=*/nullptr,
+                          /*timestamp=*/nullptr, &s, &merge_context,
+                          &max_covering_tombstone_seq, roptions,
+                          false /* immutable_memtable */);
+    if (snapshot < 10) {
+      ASSERT_FALSE(found);
+    } else if (snapshot < 50) {
+      ASSERT_TRUE(found);
+      ASSERT_OK(s);
+      ASSERT_EQ(value, "v" + std::to_string(snapshot - snapshot % 2));
+    } else {
+      ASSERT_TRUE(found);
+      ASSERT_TRUE(s.IsNotFound());
+    }
+  }
+  ASSERT_EQ(from_entry, 51);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  delete mem;
+}
+
+TEST_F(DBMemTableTest, FlattenImmutable) {
+  Options options = CurrentOptions();
+  options.max_write_buffer_number = 4;
+  options.min_write_buffer_number_to_merge = 3;
+  options.flatten_immutable_memtables = true;
+  Reopen(options);
+
+  std::atomic<int> flattened{0};
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BackgroundCallFlattenMemTables:Done",
+        "DBMemTableTest::FlattenImmutable:Flattened"}});
+  SyncPoint::GetInstance()->SetCallBack("MemTable::Flatten:Done",
+                                        [&](void*) { flattened++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v1_" + std::to_string(i)));
+    expected[Key(i)] = "v1_" + std::to_string(i);
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  const std::map<std::string, std::string> expected_at_snapshot = expected;
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_OK(Put(Key(i), "v2_" + std::to_string(i)));
+    expected[Key(i)] = "v2_" + std::to_string(i);
+    ASSERT_OK(Delete(Key(i + 1)));
+    expected.erase(Key(i + 1));
+  }
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  TEST_SYNC_POINT("DBMemTableTest::FlattenImmutable:Flattened");
+  ASSERT_EQ(flattened.load(), 1);
+  // Not flushed yet
+  ASSERT_EQ(NumTableFilesAtLevel(0), 0);
+
+  auto verify = [&](const Snapshot* s,
+                    const std::map<std::string, std::string>& kvs) {
+    for (int i = 0; i < 100; i++) {
+      auto it = kvs.find(Key(i));
+      ASSERT_EQ(it == kvs.end() ? "NOT_FOUND" : it->second, Get(Key(i), s));
+    }
+    ReadOptions read_options;
+    read_options.snapshot = s;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    auto it = kvs.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++it) {
+      ASSERT_TRUE(it != kvs.rend());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == kvs.rend());
+  };
+  verify(nullptr, expected);
+  verify(snapshot, expected_at_snapshot);
+
+  // The flush reads the flattened memtable
+  ASSERT_OK(Flush());
+  ASSERT_EQ(NumTableFilesAtLevel(0), 1);
+  verify(nullptr, expected);
+  verify(snapshot, expected_at_snapshot);
+  db_->ReleaseSnapshot(snapshot);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
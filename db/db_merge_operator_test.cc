@@ -1043,6 +1043,67 @@ TEST_F(DBMergeOperatorTest, MaxSuccessiveMergesBaseValues) {
   }
 }
 
+TEST_F(DBMergeOperatorTest, InplaceMergeSupport) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+  options.inplace_merge_support = true;
+  options.allow_concurrent_memtable_write = false;
+  options.env = env_;
+  Reopen(options);
+
+  auto encode = [](uint64_t v) {
+    std::string s;
+    PutFixed64(&s, v);
+    return s;
+  };
+  auto num_versions = [&](const std::string& key) {
+    std::vector<KeyVersion> key_versions;
+    EXPECT_OK(GetAllKeyVersions(db_, db_->DefaultColumnFamily(), key, key,
+                                8 /* max_num_ikeys */, &key_versions));
+    return key_versions.size();
+  };
+
+  // The operands fold into the first one
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(db_->Merge(WriteOptions(), "counter", encode(1)));
+  }
+  ASSERT_EQ(num_versions("counter"), 1u);
+  ASSERT_EQ(Get("counter"), encode(3));
+
+  // Not into an entry a snapshot reads
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->Merge(WriteOptions(), "counter", encode(1)));
+  ASSERT_EQ(num_versions("counter"), 2u);
+  ASSERT_EQ(Get("counter", snapshot), encode(3));
+  db_->ReleaseSnapshot(snapshot);
+  ASSERT_OK(db_->Merge(WriteOptions(), "counter", encode(1)));
+  ASSERT_EQ(num_versions("counter"), 2u);
+  ASSERT_EQ(Get("counter"), encode(5));
+
+  // Into a value, with a full merge
+  ASSERT_OK(db_->Put(WriteOptions(), "value", encode(10)));
+  ASSERT_OK(db_->Merge(WriteOptions(), "value", encode(1)));
+  ASSERT_EQ(num_versions("value"), 1u);
+  ASSERT_EQ(Get("value"), encode(11));
+
+  // Not across a range deletion
+  ASSERT_OK(db_->Merge(WriteOptions(), "deleted", encode(1)));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             "deleted", "deletee"));
+  ASSERT_OK(db_->Merge(WriteOptions(), "deleted", encode(1)));
+  ASSERT_EQ(Get("deleted"), encode(1));
+
+  // Nor across a flush
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->Merge(WriteOptions(), "counter", encode(1)));
+  ASSERT_EQ(Get("counter"), encode(6));
+
+  // Not compatible with concurrent memtable writes
+  options.allow_concurrent_memtable_write = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -2103,6 +2103,37 @@ TEST_F(DBPropertiesTest, GetMapPropertyBlockCacheEntryStats) {
   ASSERT_EQ(3 * kNumCacheEntryRoles + 4, values.size());
 }
 
+TEST_F(DBPropertiesTest, GetMapPropertyMemoryBreakdown) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  ASSERT_OK(Put("a", std::string(1000, 'a')));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b", std::string(1000, 'b')));
+  ASSERT_EQ(std::string(1000, 'a'), Get("a"));
+
+  std::map<std::string, std::string> values;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kMemoryBreakdown, &values));
+  uint64_t active = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kCurSizeActiveMemTable,
+                                  &active));
+  ASSERT_EQ(std::to_string(active), values["mem-table-active"]);
+  ASSERT_GT(ParseUint64(values["table-readers"]), 0u);
+  ASSERT_GT(ParseUint64(values["block-cache-usage"]), 0u);
+  ASSERT_TRUE(values.find("block-cache-pinned-usage") != values.end());
+  ASSERT_TRUE(values.find("mem-table-immutable-unflushed") != values.end());
+  ASSERT_TRUE(values.find("mem-table-flushed-pinned") != values.end());
+  // The arenas of the mem-tables of the process are tracked
+  ASSERT_GT(ParseUint64(values["tracked.memtable"]), 0u);
+
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kMemoryBreakdown, &value));
+  ASSERT_NE(value.find("mem-table-active: "), std::string::npos);
+}
+
 TEST_F(DBPropertiesTest, WriteStallStatsSanityCheck) {
   for (uint32_t i = 0; i < static_cast<uint32_t>(WriteStallCause::kNone); ++i) {
     WriteStallCause cause = static_cast<WriteStallCause>(i);
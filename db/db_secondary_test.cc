@@ -615,6 +615,46 @@ TEST_F(DBSecondaryTest, OpenAsSecondaryWALTailing) {
   verify_db_func("new_foo_value_1", "new_bar_value");
 }
 
+TEST_F(DBSecondaryTest, SkipUnchangedWalDir) {
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "v0"));
+  // The WAL directory is not modified in the second of the listings below
+  env_->SleepForMicroseconds(1100000);
+
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  options1.secondary_skip_unchanged_wal_dir = true;
+  OpenSecondary(options1);
+
+  std::atomic<int> skipped{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImplSecondary::FindNewLogNumbers:SkipListing",
+      [&](void* /*arg*/) { skipped++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Appends to the WAL being tailed are read without listing the directory
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(1, skipped.load());
+  std::string value;
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("v1", value);
+
+  // A new WAL is found once the directory is modified
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(1, skipped.load());
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("v2", value);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBSecondaryTest, SecondaryTailingBug_ISSUE_8467) {
   Options options;
   options.env = env_;
@@ -1468,6 +1468,95 @@ TEST_F(DBSSTTest, OpenDBWithInfiniteMaxOpenFiles) {
   }
 }
 
+TEST_F(DBSSTTest, MaxPinnedTableReaders) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  // A table cache of 10 entries, which pins 2 files on open by default
+  options.max_open_files = 20;
+  options.max_pinned_table_readers = 5;
+  DestroyAndReopen(options);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    ASSERT_OK(Put(Key(100), "value"));
+    ASSERT_OK(Flush());
+  }
+
+  auto count_pinned = [&]() {
+    std::vector<std::vector<FileMetaData>> files;
+    dbfull()->TEST_GetFilesMetaData(db_->DefaultColumnFamily(), &files);
+    int num_pinned = 0;
+    for (const auto& level : files) {
+      for (const auto& file : level) {
+        num_pinned += file.table_reader_handle != nullptr;
+      }
+    }
+    return num_pinned;
+  };
+  ASSERT_EQ(5, count_pinned());
+  ASSERT_EQ(5U, dbfull()->GetVersionSet()->TEST_num_pinned_table_readers());
+
+  Reopen(options);
+  ASSERT_EQ(5, count_pinned());
+  ASSERT_EQ(5U, dbfull()->GetVersionSet()->TEST_num_pinned_table_readers());
+
+  // The readers of the compacted files are released with them, which leaves
+  // room for the output
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(1, TotalTableFiles());
+  ASSERT_EQ(1, count_pinned());
+  ASSERT_EQ(1U, dbfull()->GetVersionSet()->TEST_num_pinned_table_readers());
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+
+  options.max_pinned_table_readers = 0;
+  Reopen(options);
+  ASSERT_EQ(1, count_pinned());
+}
+
+TEST_F(DBSSTTest, OpenFilesOfColumnFamiliesConcurrently) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.max_open_files = -1;
+  options.max_file_opening_threads = 4;
+  CreateAndReopenWithCF({"one", "two", "three"}, options);
+  for (int cf = 0; cf < 4; cf++) {
+    ASSERT_OK(Put(cf, "key", "value" + std::to_string(cf)));
+    ASSERT_OK(Flush(cf));
+  }
+  Close();
+
+  // Each column family has a single file, which is opened by its own thread
+  std::atomic<int> num_opening(0);
+  std::atomic<int> max_opening(0);
+  SyncPoint::GetInstance()->SetCallBack("TableCache::FindTable:0", [&](void*) {
+    int opening = num_opening.fetch_add(1) + 1;
+    int max = max_opening.load();
+    while (opening > max && !max_opening.compare_exchange_weak(max, opening)) {
+    }
+    // Wait for the other files to be opened concurrently
+    for (int i = 0; i < 1000 && max_opening.load() < 4; i++) {
+      env_->SleepForMicroseconds(1000);
+    }
+    num_opening.fetch_sub(1);
+  });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ReopenWithColumnFamilies({"default", "one", "two", "three"}, options);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(4, max_opening.load());
+
+  for (int cf = 0; cf < 4; cf++) {
+    std::vector<std::vector<FileMetaData>> files;
+    dbfull()->TEST_GetFilesMetaData(handles_[cf], &files);
+    ASSERT_EQ(1U, files[0].size());
+    ASSERT_TRUE(files[0][0].table_reader_handle != nullptr);
+    ASSERT_EQ("value" + std::to_string(cf), Get(cf, "key"));
+  }
+}
+
 TEST_F(DBSSTTest, OpenDBWithInfiniteMaxOpenFilesSubjectToMemoryLimit) {
   for (CacheEntryRoleOptions::Decision charge_table_reader :
        {CacheEntryRoleOptions::Decision::kEnabled,
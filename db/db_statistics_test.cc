@@ -10,6 +10,7 @@
 #include "monitoring/thread_status_util.h"
 #include "port/stack_trace.h"
 #include "rocksdb/statistics.h"
+#include "rocksdb/tenant_usage.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "util/random.h"
 
@@ -133,6 +134,62 @@ TEST_F(DBStatisticsTest, CompressionStatsTest) {
   }
 }
 
+TEST_F(DBStatisticsTest, AdaptiveCompressionStatsTest) {
+  for (CompressionType type : GetSupportedCompressions()) {
+    if (type == kNoCompression || type == kBZip2Compression) {
+      continue;
+    }
+    SCOPED_TRACE("Compression type: " + std::to_string(type));
+
+    Options options = CurrentOptions();
+    options.compression = type;
+    options.compression_opts.adaptive_sample_one_in = 4;
+    options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    options.statistics->set_stats_level(StatsLevel::kExceptTimeForMutex);
+    BlockBasedTableOptions bbto;
+    bbto.enable_index_compression = false;
+    options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+    DestroyAndReopen(options);
+
+    auto PopStat = [&](Tickers t) -> uint64_t {
+      return options.statistics->getAndResetTickerCount(t);
+    };
+
+    int kNumKeysWritten = 100;
+    // About three KVs per block
+    int len = static_cast<int>(BlockBasedTableOptions().block_size / 3);
+
+    Random rnd(301);
+    std::string buf;
+    std::vector<std::string> values;
+
+    // Compressible blocks are all compressed, whichever candidate they get
+    for (int i = 0; i < kNumKeysWritten; ++i) {
+      values.push_back(
+          test::CompressibleString(&rnd, 0.5, len, &buf).ToString());
+      ASSERT_OK(Put(Key(i), values.back()));
+    }
+    ASSERT_OK(Flush());
+    EXPECT_EQ(34, PopStat(NUMBER_BLOCK_COMPRESSED));
+    EXPECT_EQ(0, PopStat(NUMBER_BLOCK_COMPRESSION_BYPASSED));
+    EXPECT_EQ(0, PopStat(NUMBER_BLOCK_COMPRESSION_REJECTED));
+    for (int i = 0; i < kNumKeysWritten; ++i) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+
+    // Incompressible blocks are not even attempted once measured so, rather
+    // than compressed and rejected
+    DestroyAndReopen(options);
+    for (int i = 0; i < kNumKeysWritten; ++i) {
+      ASSERT_OK(Put(Key(i), rnd.RandomBinaryString(len)));
+    }
+    ASSERT_OK(Flush());
+    EXPECT_EQ(34, PopStat(NUMBER_BLOCK_COMPRESSION_BYPASSED));
+    EXPECT_EQ(0, PopStat(NUMBER_BLOCK_COMPRESSION_REJECTED));
+    EXPECT_EQ(0, PopStat(NUMBER_BLOCK_COMPRESSED));
+  }
+}
+
 TEST_F(DBStatisticsTest, MutexWaitStatsDisabledByDefault) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -357,6 +414,48 @@ TEST_F(DBStatisticsTest, BytesWrittenStats) {
   }
 }
 
+TEST_F(DBStatisticsTest, TenantUsage) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  std::shared_ptr<TenantUsage> tenant(NewTenantUsage("tenant1"));
+  Options tenant_options = options;
+  tenant_options.tenant_usage = tenant;
+  CreateColumnFamilies({"pikachu"}, tenant_options);
+  ReopenWithColumnFamilies({"default", "pikachu"},
+                           std::vector<Options>{options, tenant_options});
+  ASSERT_EQ("tenant1", tenant->GetName());
+
+  // Only the column family of the tenant is charged to it
+  for (int cf = 0; cf < 2; ++cf) {
+    for (int file = 0; file < 2; ++file) {
+      for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(Put(cf, Key(i), "val" + std::to_string(file)));
+      }
+      ASSERT_OK(Flush(cf));
+    }
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), handles_[cf], nullptr,
+                                nullptr));
+    ASSERT_EQ("val1", Get(cf, Key(0)));
+    if (cf == 0) {
+      for (uint32_t type = 0; type < kTenantUsageTypeMax; ++type) {
+        ASSERT_EQ(0, tenant->Get(static_cast<TenantUsageType>(type)));
+      }
+    }
+  }
+  ASSERT_GT(tenant->Get(kTenantSstBytesRead), 0);
+  ASSERT_GT(tenant->Get(kTenantBlockCacheBytesInserted), 0);
+  ASSERT_GT(tenant->Get(kTenantFlushBytesWritten), 0);
+  ASSERT_GT(tenant->Get(kTenantCompactionBytesWritten), 0);
+  ASSERT_NE(std::string::npos,
+            tenant->ToString().find("compaction_bytes_written="));
+
+  tenant->Reset();
+  ASSERT_EQ(0, tenant->Get(kTenantFlushBytesWritten));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -18,6 +18,7 @@
 #include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/compression_dict_trainer.h"
 #include "rocksdb/experimental.h"
 #include "rocksdb/iostats_context.h"
 #include "rocksdb/persistent_cache.h"
@@ -1414,6 +1415,65 @@ TEST_F(DBTest2, PresetCompressionDictLocality) {
   }
 }
 
+TEST_F(DBTest2, CompressionDictTrainer) {
+  if (!ZSTD_Supported()) {
+    return;
+  }
+  // Verifies that the files built once a dictionary is trained are compressed
+  // with it, however small, that their samples train the next dictionary, and
+  // that the files stay readable without the trainer.
+  const int kNumEntriesPerFile = 1 << 10;
+  const int kNumBytesPerEntry = 1 << 10;
+  Options options = CurrentOptions();
+  options.compression = kZSTD;
+  options.compression_opts.max_dict_bytes = 1 << 14;
+  options.disable_auto_compactions = true;
+  std::shared_ptr<CompressionDictTrainer> trainer =
+      NewCompressionDictTrainer();
+  options.compression_dict_trainer = trainer;
+  Reopen(options);
+
+  std::vector<std::string> compression_dicts;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::WriteCompressionDictBlock:RawDict",
+      [&](void* arg) {
+        compression_dicts.emplace_back(static_cast<Slice*>(arg)->ToString());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumEntriesPerFile; ++i) {
+    values.push_back(rnd.RandomString(kNumBytesPerEntry));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+  trainer->WaitForTraining();
+  ASSERT_EQ(trainer->GetNumTrained(), 1U);
+  ASSERT_EQ(compression_dicts.size(), 1U);
+
+  std::string dict = trainer->GetDict(kZSTD, options.compression_opts);
+  ASSERT_FALSE(dict.empty());
+  for (int i = kNumEntriesPerFile; i < kNumEntriesPerFile + 4; ++i) {
+    values.push_back(rnd.RandomString(kNumBytesPerEntry));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(compression_dicts.size(), 2U);
+  ASSERT_EQ(compression_dicts[1], dict);
+  trainer->WaitForTraining();
+  ASSERT_EQ(trainer->GetNumTrained(), 2U);
+  ASSERT_NE(trainer->GetDict(kZSTD, options.compression_opts), dict);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  options.compression_dict_trainer = nullptr;
+  Reopen(options);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(Get(Key(static_cast<int>(i))), values[i]);
+  }
+}
+
 class PresetCompressionDictTest
     : public DBTestBase,
       public testing::WithParamInterface<std::tuple<CompressionType, bool>> {
@@ -1898,6 +1958,134 @@ TEST_F(DBTest2, CompressionOptions) {
   }
 }
 
+// A CompressionAccelerator that runs the software codecs, so that the blocks
+// it writes and reads are those of the software path
+class SoftwareCompressionAccelerator : public CompressionAccelerator {
+ public:
+  explicit SoftwareCompressionAccelerator(CompressionType type)
+      : type_(type) {}
+
+  const char* Name() const override { return "SoftwareCompressionAccelerator"; }
+
+  bool Supports(CompressionType type) const override { return type == type_; }
+
+  Status Compress(CompressionType type, const CompressionOptions& opts,
+                  const Slice& input, std::string* output) override {
+    compress_calls_.fetch_add(1);
+    if (fail_) {
+      return Status::Busy();
+    }
+    CompressionContext context(type, opts);
+    CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(), type,
+                         0 /* sample_for_compression */);
+    std::string block;
+    if (!CompressData(input, info, 2 /* compress_format_version */, &block)) {
+      return Status::Corruption();
+    }
+    // Drop the uncompressed size, which RocksDB adds
+    Slice payload(block);
+    uint32_t size = 0;
+    EXPECT_TRUE(GetVarint32(&payload, &size));
+    EXPECT_EQ(input.size(), size);
+    output->append(payload.data(), payload.size());
+    return Status::OK();
+  }
+
+  Status Uncompress(CompressionType type, const Slice& input, char* output,
+                    size_t output_size) override {
+    uncompress_calls_.fetch_add(1);
+    if (fail_) {
+      return Status::Busy();
+    }
+    std::string block;
+    PutVarint32(&block, static_cast<uint32_t>(output_size));
+    block.append(input.data(), input.size());
+    UncompressionContext context(type);
+    UncompressionInfo info(context, UncompressionDict::GetEmptyDict(), type);
+    size_t size = 0;
+    CacheAllocationPtr data =
+        UncompressData(info, block.data(), block.size(), &size,
+                       2 /* compress_format_version */);
+    if (!data || size != output_size) {
+      return Status::Corruption();
+    }
+    memcpy(output, data.get(), size);
+    return Status::OK();
+  }
+
+  void SetFail(bool fail) { fail_ = fail; }
+
+  std::atomic<int> compress_calls_{0};
+  std::atomic<int> uncompress_calls_{0};
+
+ private:
+  const CompressionType type_;
+  std::atomic<bool> fail_{false};
+};
+
+TEST_F(DBTest2, CompressionAccelerator) {
+  CompressionType type;
+  if (LZ4_Supported()) {
+    type = kLZ4Compression;
+  } else if (Zlib_Supported()) {
+    type = kZlibCompression;
+  } else {
+    ROCKSDB_GTEST_SKIP("Test requires LZ4 or zlib support");
+    return;
+  }
+
+  Options options = CurrentOptions();
+  options.compression = type;
+  options.compression_opts.parallel_threads = 4;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 256;
+  table_options.verify_compression = true;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  auto accelerator = std::make_shared<SoftwareCompressionAccelerator>(type);
+  options.compression_accelerator = accelerator;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 200; i++) {
+    std::string key = Key(i);
+    // Compressible values
+    expected[key] = rnd.RandomString(10) + std::string(90, 'v');
+    ASSERT_OK(Put(key, expected[key]));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(accelerator->compress_calls_.load(), 0);
+
+  auto verify = [&]() {
+    for (const auto& kv : expected) {
+      ASSERT_EQ(kv.second, Get(kv.first));
+    }
+  };
+  verify();
+  ASSERT_GT(accelerator->uncompress_calls_.load(), 0);
+
+  // The blocks read the same in software
+  options.compression_accelerator = nullptr;
+  Reopen(options);
+  verify();
+
+  // And the accelerator falling back to software writes and reads them too
+  accelerator->SetFail(true);
+  options.compression_accelerator = accelerator;
+  Reopen(options);
+  for (int i = 0; i < 200; i += 2) {
+    ASSERT_OK(Put(Key(i), expected[Key(i)]));
+  }
+  ASSERT_OK(Flush());
+  verify();
+
+  accelerator->SetFail(false);
+  options.compression_accelerator = nullptr;
+  Reopen(options);
+  verify();
+}
+
 class CompactionStallTestListener : public EventListener {
  public:
   CompactionStallTestListener()
@@ -5667,6 +5855,67 @@ TEST_F(DBTest2, RowCacheSnapshot) {
   db_->ReleaseSnapshot(s3);
 }
 
+TEST_F(DBTest2, PointLookupCache) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.point_lookup_cache = NewLRUCache(8 * 8192);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar1"));
+  ASSERT_OK(Put("baz", "qux"));
+  const Snapshot* s1 = db_->GetSnapshot();
+
+  ASSERT_EQ(Get("foo"), "bar1");
+  ASSERT_EQ(Get("foo"), "bar1");
+  ASSERT_EQ(Get("baz"), "qux");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_MISS), 2);
+
+  // A write invalidates the result of its key only
+  ASSERT_OK(Put("foo", "bar2"));
+  ASSERT_EQ(Get("baz"), "qux");
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 3);
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_MISS), 3);
+
+  // A result is valid at a snapshot if no write to the key falls between the
+  // two
+  ASSERT_EQ(Get("baz", s1), "qux");
+  ASSERT_EQ(Get("foo", s1), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 4);
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_MISS), 4);
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_MISS), 5);
+
+  // Flushes do not invalidate the results
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 5);
+
+  // Nor are NotFound results
+  ASSERT_EQ(Get("missing"), "NOT_FOUND");
+  ASSERT_EQ(Get("missing"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 6);
+  ASSERT_OK(Put("missing", "found"));
+  ASSERT_EQ(Get("missing"), "found");
+
+  ASSERT_OK(Delete("foo"));
+  ASSERT_EQ(Get("foo"), "NOT_FOUND");
+
+  // A range deletion invalidates all the results
+  ASSERT_EQ(Get("baz"), "qux");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 7);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  ASSERT_EQ(Get("baz"), "NOT_FOUND");
+  ASSERT_EQ(Get("missing"), "found");
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_HIT), 7);
+  ASSERT_EQ(TestGetTickerCount(options, POINT_LOOKUP_CACHE_MISS), 10);
+
+  db_->ReleaseSnapshot(s1);
+}
+
 // When DB is reopened with multiple column families, the manifest file
 // is written after the first CF is flushed, and it is written again
 // after each flush. If DB crashes between the flushes, the flushed CF
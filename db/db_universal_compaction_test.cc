@@ -906,6 +906,52 @@ TEST_P(DBTestUniversalCompactionParallel, PickByFileNumberBug) {
   EXPECT_GE(total_picked_compactions, 2);
 }
 
+TEST_P(DBTestUniversalCompactionParallel, ReserveThreadsForSubcompactions) {
+  if (num_levels_ == 1) {
+    // Only compactions to a level other than level 0 are split
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = num_levels_;
+  options.write_buffer_size = 100 << 10;  // 100KB
+  options.target_file_size_base = 32 << 10;  // 32KB
+  options.level0_file_num_compaction_trigger = 100;
+  options.max_background_compactions = 4;
+  options.max_subcompactions = 1;
+  options.compaction_options_universal.reserve_threads_for_subcompactions =
+      true;
+  env_->SetBackgroundThreads(4, Env::LOW);
+  DestroyAndReopen(options);
+
+  uint64_t num_subcompactions = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::GenSubcompactionBoundaries:1", [&](void* arg) {
+        num_subcompactions = *static_cast<uint64_t*>(arg);
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  const int kNumKeys = 1000;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < kNumKeys; j++) {
+      ASSERT_OK(Put(Key(j), rnd.RandomString(100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Split among the idle background compaction threads
+  ASSERT_GT(num_subcompactions, 1u);
+  ASSERT_LE(num_subcompactions, 4u);
+  ASSERT_EQ(NumTableFilesAtLevel(0), 0);
+  for (int j = 0; j < kNumKeys; j++) {
+    ASSERT_NE(Get(Key(j)), "NOT_FOUND");
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(Parallel, DBTestUniversalCompactionParallel,
                         ::testing::Combine(::testing::Values(1, 10),
                                            ::testing::Values(false)));
@@ -4730,6 +4730,71 @@ TEST_F(DBBasicTestWithTimestamp, TimestampFilterTableReadOnGet) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, TimestampFilterBlockReadOnIterate) {
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  for (uint32_t parallel_threads : {1, 2}) {
+    Options options = CurrentOptions();
+    options.env = env_;
+    options.create_if_missing = true;
+    options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    options.comparator = &test_cmp;
+    options.compression_opts.parallel_threads = parallel_threads;
+    BlockBasedTableOptions bbto;
+    bbto.block_size = 100;
+    bbto.block_timestamp_index = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+    DestroyAndReopen(options);
+
+    // Keys [0, 50) were written at timestamp 10, and keys [50, 100) at
+    // timestamp 30, in the same file
+    for (uint64_t i = 0; i < 100; i++) {
+      ASSERT_OK(db_->Put(WriteOptions(), Key1(i),
+                         Timestamp(i < 50 ? 10 : 30, 0),
+                         "value" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+
+    auto count_keys = [&](uint64_t read_ts, const Slice* upper_bound) {
+      std::string read_ts_str = Timestamp(read_ts, 0);
+      Slice read_ts_slice(read_ts_str);
+      ReadOptions read_opts;
+      read_opts.timestamp = &read_ts_slice;
+      read_opts.iterate_upper_bound = upper_bound;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+      uint64_t count = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        EXPECT_EQ(iter->key().ToString(), Key1(count));
+        EXPECT_EQ(iter->value().ToString(), "value" + std::to_string(count));
+        count++;
+      }
+      EXPECT_OK(iter->status());
+      return count;
+    };
+
+    // The data blocks of keys [50, 100) are stepped over at timestamp 20
+    ASSERT_EQ(count_keys(20, nullptr), 50u);
+    const uint64_t filtered = options.statistics->getTickerCount(
+        Tickers::TIMESTAMP_FILTER_BLOCK_FILTERED);
+    ASSERT_GT(filtered, 0u);
+
+    std::string upper_bound_str = Key1(75);
+    Slice upper_bound(upper_bound_str);
+    ASSERT_EQ(count_keys(20, &upper_bound), 50u);
+    ASSERT_GT(options.statistics->getTickerCount(
+                  Tickers::TIMESTAMP_FILTER_BLOCK_FILTERED),
+              filtered);
+
+    // Nothing is stepped over at timestamp 40
+    ASSERT_OK(options.statistics->Reset());
+    ASSERT_EQ(count_keys(40, nullptr), 100u);
+    ASSERT_EQ(options.statistics->getTickerCount(
+                  Tickers::TIMESTAMP_FILTER_BLOCK_FILTERED),
+              0u);
+    Close();
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
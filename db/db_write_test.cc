@@ -6,6 +6,7 @@
 #include <atomic>
 #include <cstdint>
 #include <fstream>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -493,6 +494,114 @@ TEST_F(DBWriteTestUnparameterized, PipelinedWriteRace) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
 
+TEST_F(DBWriteTestUnparameterized, PipelinedWalSync) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = fault_env.get();
+  options.enable_pipelined_write = true;
+  options.pipelined_wal_sync = true;
+  Reopen(options);
+
+  std::atomic<int> deferred_syncs{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::PipelinedWriteImpl:DeferredWalSync",
+      [&](void* /* arg */) { deferred_syncs.fetch_add(1); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  const int kThreads = 4;
+  const int kKeysPerThread = 100;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      WriteOptions write_options;
+      write_options.sync = true;
+      for (int i = 0; i < kKeysPerThread; i++) {
+        ASSERT_OK(db_->Put(write_options, Key(t * kKeysPerThread + i),
+                           "val" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_GT(deferred_syncs.load(), 0);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_OK(Put("unsynced", "val"));
+  Close();
+
+  // Simulate full loss of unsynced data. The sync writes were synced before
+  // they returned.
+  ASSERT_OK(fault_env->DropUnsyncedFileData());
+  Reopen(options);
+  for (int t = 0; t < kThreads; t++) {
+    for (int i = 0; i < kKeysPerThread; i++) {
+      ASSERT_EQ("val" + std::to_string(i), Get(Key(t * kKeysPerThread + i)));
+    }
+  }
+  ASSERT_EQ("NOT_FOUND", Get("unsynced"));
+
+  // Need to close before `fault_env` goes out of scope.
+  Close();
+}
+
+TEST_F(DBWriteTestUnparameterized, WriteGroupLinger) {
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = env_;
+  options.write_group_linger_usec = 500;
+  Reopen(options);
+
+  std::atomic<int> lingers{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::LingerForWriters:Begin",
+      [&](void* /* arg */) { lingers.fetch_add(1); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Slow WAL writes and syncs let the writers join faster than a sync takes
+  env_->log_write_slowdown_ = 1000;
+  const int kThreads = 8;
+  const int kKeysPerThread = 50;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      WriteOptions write_options;
+      write_options.sync = true;
+      for (int i = 0; i < kKeysPerThread; i++) {
+        ASSERT_OK(db_->Put(write_options, Key(t * kKeysPerThread + i),
+                           "val" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  env_->log_write_slowdown_ = 0;
+  ASSERT_GT(lingers.load(), 0);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Writes without sync never wait
+  lingers = 0;
+  SyncPoint::GetInstance()->EnableProcessing();
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("nosync" + std::to_string(i), "val"));
+  }
+  ASSERT_EQ(0, lingers.load());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  Reopen(options);
+  for (int t = 0; t < kThreads; t++) {
+    for (int i = 0; i < kKeysPerThread; i++) {
+      ASSERT_EQ("val" + std::to_string(i), Get(Key(t * kKeysPerThread + i)));
+    }
+  }
+}
+
 TEST_P(DBWriteTest, ManualWalFlushInEffect) {
   Options options = GetOptions();
   Reopen(options);
@@ -910,6 +1019,135 @@ TEST_P(DBWriteTest, RecycleLogTestCFAheadOfWAL) {
             Status::Corruption());
 }
 
+TEST_P(DBWriteTest, SortedMemtableInsert) {
+  Options options = GetOptions();
+  options.memtable_sorted_insert_threshold = 100;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::atomic<size_t> sorted_entries{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "MemTable::FinishSortedInsert:NumEntries", [&](void* arg) {
+        sorted_entries.fetch_add(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Keys repeat within a batch, in random order
+  Random rnd(301);
+  std::map<std::string, std::string> expected[2];
+  for (int b = 0; b < 3; b++) {
+    WriteBatch batch;
+    for (int i = 0; i < 500; i++) {
+      std::string key = Key(static_cast<int>(rnd.Uniform(200)));
+      std::string value = std::to_string(b * 1000 + i);
+      if (i % 10 == 9) {
+        ASSERT_OK(batch.Delete(handles_[0], key));
+        expected[0].erase(key);
+      } else {
+        ASSERT_OK(batch.Put(handles_[0], key, value));
+        expected[0][key] = value;
+      }
+      ASSERT_OK(batch.Merge(handles_[1], key, value));
+      std::string& merged = expected[1][key];
+      merged = merged.empty() ? value : merged + "," + value;
+    }
+    // Range deletions are not deferred
+    std::string begin = Key(50);
+    std::string end = Key(60);
+    ASSERT_OK(batch.DeleteRange(handles_[0], begin, end));
+    expected[0].erase(expected[0].lower_bound(begin),
+                      expected[0].lower_bound(end));
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  }
+  // A batch below the threshold
+  ASSERT_OK(Put(0, Key(0), "small"));
+  expected[0][Key(0)] = "small";
+  ASSERT_EQ(sorted_entries.load(), 3 * 1000);
+
+  auto verify = [&]() {
+    for (int cf = 0; cf < 2; cf++) {
+      for (int i = 0; i < 200; i++) {
+        auto it = expected[cf].find(Key(i));
+        ASSERT_EQ(it == expected[cf].end() ? "NOT_FOUND" : it->second,
+                  Get(cf, Key(i)));
+      }
+      std::unique_ptr<Iterator> iter(
+          db_->NewIterator(ReadOptions(), handles_[cf]));
+      auto it = expected[cf].begin();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+        ASSERT_TRUE(it != expected[cf].end());
+        ASSERT_EQ(it->first, iter->key().ToString());
+        ASSERT_EQ(it->second, iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(it == expected[cf].end());
+    }
+  };
+  verify();
+
+  // The batches are inserted in key order on recovery as well
+  sorted_entries = 0;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ(sorted_entries.load(), 3 * 1000);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_P(DBWriteTest, CollapseOverwrites) {
+  Options options = GetOptions();
+  options.memtable_collapse_overwrites = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  ASSERT_OK(Put("b", "old"));
+  ASSERT_OK(Put("c", "old"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("a", "1"));
+  ASSERT_OK(batch.Put("a", "2"));
+  ASSERT_OK(batch.Put("b", "1"));
+  ASSERT_OK(batch.Delete("b"));
+  ASSERT_OK(batch.Put("b", "2"));
+  ASSERT_OK(batch.Put("c", "1"));
+  ASSERT_OK(batch.Delete("c"));
+  // The entries before and after a merge are kept
+  ASSERT_OK(batch.Merge("d", "x"));
+  ASSERT_OK(batch.Put("d", "1"));
+  ASSERT_OK(batch.Merge("d", "y"));
+  ASSERT_OK(batch.Put("e", "1"));
+  ASSERT_OK(batch.Merge("e", "m"));
+  ASSERT_OK(batch.Put("e", "2"));
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+  // The skipped entries still consume their sequence numbers
+  ASSERT_EQ(uint64_t{2 + 13}, db_->GetLatestSequenceNumber());
+  uint64_t num_entries = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kNumEntriesActiveMemTable,
+                                  &num_entries));
+  ASSERT_EQ(uint64_t{2 + 13 - 4}, num_entries);
+
+  auto verify = [&]() {
+    ASSERT_EQ("2", Get("a"));
+    ASSERT_EQ("2", Get("b"));
+    ASSERT_EQ("NOT_FOUND", Get("c"));
+    ASSERT_EQ("1,y", Get("d"));
+    ASSERT_EQ("2", Get("e"));
+  };
+  verify();
+  ASSERT_EQ("NOT_FOUND", Get("a", snapshot));
+  ASSERT_EQ("old", Get("b", snapshot));
+  ASSERT_EQ("old", Get("c", snapshot));
+  db_->ReleaseSnapshot(snapshot);
+
+  ASSERT_OK(Flush());
+  verify();
+  Reopen(options);
+  verify();
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -231,14 +231,30 @@ int InternalKeyComparator::Compare(const ParsedInternalKey& a,
 
 LookupKey::LookupKey(const Slice& _user_key, SequenceNumber s,
                      const Slice* ts) {
+  Init(_user_key, s, ts, nullptr);
+}
+
+LookupKey::LookupKey(const Slice& _user_key, SequenceNumber s, const Slice* ts,
+                     std::string* buf) {
+  Init(_user_key, s, ts, buf);
+}
+
+void LookupKey::Init(const Slice& _user_key, SequenceNumber s, const Slice* ts,
+                     std::string* buf) {
   size_t usize = _user_key.size();
   size_t ts_sz = (nullptr == ts) ? 0 : ts->size();
   size_t needed = usize + ts_sz + 13;  // A conservative estimate
   char* dst;
   if (needed <= sizeof(space_)) {
     dst = space_;
+  } else if (buf != nullptr) {
+    if (buf->size() < needed) {
+      buf->resize(needed);
+    }
+    dst = &(*buf)[0];
   } else {
     dst = new char[needed];
+    owned_ = true;
   }
   start_ = dst;
   // NOTE: We don't support users keys of more than 2GB :)
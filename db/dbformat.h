@@ -92,6 +92,17 @@ struct UserKeyRange {
   UserKeyRange(const Slice& s, const Slice& l) : start(s), limit(l) {}
 };
 
+// A range of user keys from `start` to `limit`, both inclusive, that owns
+// its keys. Also see `UserKeyRange`.
+struct OwnedUserKeyRange {
+  std::string start;
+  std::string limit;
+
+  OwnedUserKeyRange() = default;
+  OwnedUserKeyRange(const Slice& s, const Slice& l)
+      : start(s.ToString()), limit(l.ToString()) {}
+};
+
 // A range of user keys used internally by RocksDB. Also see `RangePtr` used by
 // public APIs.
 struct UserKeyRangePtr {
@@ -1295,6 +1295,44 @@ TEST_F(ExternalSSTFileBasicTest, VerifyChecksumReadahead) {
   Destroy(options);
 }
 
+TEST_F(ExternalSSTFileBasicTest, ParallelPrepare) {
+  Options options = CurrentOptions();
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DestroyAndReopen(options);
+
+  std::vector<std::string> files;
+  for (int f = 0; f < 8; f++) {
+    SstFileWriter sst_file_writer(EnvOptions(), options);
+    files.push_back(sst_files_dir_ + "parallel_" + std::to_string(f) + ".sst");
+    ASSERT_OK(sst_file_writer.Open(files.back()));
+    for (int i = f * 100; i < (f + 1) * 100; i++) {
+      ASSERT_OK(sst_file_writer.Put(Key(i), Key(i) + "_val"));
+    }
+    ASSERT_OK(sst_file_writer.Finish());
+  }
+
+  // A missing file fails the whole ingestion
+  IngestExternalFileOptions ingest_opt;
+  ingest_opt.verify_checksums_before_ingest = true;
+  ingest_opt.prepare_threads = 4;
+  std::vector<std::string> with_missing = files;
+  with_missing.push_back(sst_files_dir_ + "missing.sst");
+  ASSERT_NOK(db_->IngestExternalFile(with_missing, ingest_opt));
+  ASSERT_EQ(Get(Key(0)), "NOT_FOUND");
+
+  ASSERT_OK(db_->IngestExternalFile(files, ingest_opt));
+  for (int i = 0; i < 800; i++) {
+    ASSERT_EQ(Get(Key(i)), Key(i) + "_val");
+  }
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+  ASSERT_EQ(live_files.size(), files.size());
+  for (const auto& f : live_files) {
+    ASSERT_EQ(f.file_checksum_func_name, "FileChecksumCrc32c");
+    ASSERT_NE(f.file_checksum, kUnknownFileChecksum);
+  }
+}
+
 TEST_F(ExternalSSTFileBasicTest, ReadOldValueOfIngestedKeyBug) {
   Options options = CurrentOptions();
   options.compaction_style = kCompactionStyleUniversal;
@@ -6,7 +6,9 @@
 #include "db/external_sst_file_ingestion_job.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <functional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -16,6 +18,7 @@
 #include "file/file_util.h"
 #include "file/random_access_file_reader.h"
 #include "logging/logging.h"
+#include "port/port.h"
 #include "table/merging_iterator.h"
 #include "table/sst_file_writer_collectors.h"
 #include "table/table_builder.h"
@@ -34,14 +37,15 @@ Status ExternalSstFileIngestionJob::Prepare(
   Status status;
 
   // Read the information of files we are ingesting
-  for (const std::string& file_path : external_files_paths) {
-    IngestedFileInfo file_to_ingest;
+  std::vector<IngestedFileInfo> infos(external_files_paths.size());
+  status = ForEachFile(infos.size(), [&](size_t i) {
+    IngestedFileInfo& file_to_ingest = infos[i];
     // For temperature, first assume it matches provided hint
     file_to_ingest.file_temperature = file_temperature;
-    status =
-        GetIngestedFileInfo(file_path, next_file_number++, &file_to_ingest, sv);
-    if (!status.ok()) {
-      return status;
+    Status s = GetIngestedFileInfo(external_files_paths[i],
+                                   next_file_number + i, &file_to_ingest, sv);
+    if (!s.ok()) {
+      return s;
     }
 
     if (file_to_ingest.cf_id !=
@@ -60,7 +64,12 @@ Status ExternalSstFileIngestionJob::Prepare(
         !file_to_ingest.largest_internal_key.Valid()) {
       return Status::Corruption("Generated table have corrupted keys");
     }
-
+    return Status::OK();
+  });
+  if (!status.ok()) {
+    return status;
+  }
+  for (IngestedFileInfo& file_to_ingest : infos) {
     files_to_ingest_.emplace_back(std::move(file_to_ingest));
   }
 
@@ -104,16 +113,17 @@ Status ExternalSstFileIngestionJob::Prepare(
   }
 
   // Copy/Move external files into DB
-  std::unordered_set<size_t> ingestion_path_ids;
-  for (IngestedFileInfo& f : files_to_ingest_) {
+  status = ForEachFile(files_to_ingest_.size(), [&](size_t i) {
+    IngestedFileInfo& f = files_to_ingest_[i];
+    Status file_status;
     f.copy_file = false;
     const std::string path_outside_db = f.external_file_path;
     const std::string path_inside_db = TableFileName(
         cfd_->ioptions()->cf_paths, f.fd.GetNumber(), f.fd.GetPathId());
     if (ingestion_options_.move_files) {
-      status =
+      file_status =
           fs_->LinkFile(path_outside_db, path_inside_db, IOOptions(), nullptr);
-      if (status.ok()) {
+      if (file_status.ok()) {
         if (!ingestion_options_.unsafe_disable_sync) {
           // It is unsafe to assume application had sync the file and file
           // directory before ingest the file. For integrity of RocksDB we need
@@ -127,28 +137,29 @@ Status ExternalSstFileIngestionJob::Prepare(
           // reopening a file for writing and don't require reopening and
           // syncing the file. Ignore the NotSupported error in that case.
           if (!s.IsNotSupported()) {
-            status = s;
-            if (status.ok()) {
+            file_status = s;
+            if (file_status.ok()) {
               TEST_SYNC_POINT(
                   "ExternalSstFileIngestionJob::BeforeSyncIngestedFile");
-              status = SyncIngestedFile(file_to_sync.get());
+              file_status = SyncIngestedFile(file_to_sync.get());
               TEST_SYNC_POINT(
                   "ExternalSstFileIngestionJob::AfterSyncIngestedFile");
-              if (!status.ok()) {
+              if (!file_status.ok()) {
                 ROCKS_LOG_WARN(db_options_.info_log,
                                "Failed to sync ingested file %s: %s",
-                               path_inside_db.c_str(), status.ToString().c_str());
+                               path_inside_db.c_str(),
+                               file_status.ToString().c_str());
               }
             }
           }
         }
-      } else if (status.IsNotSupported() &&
+      } else if (file_status.IsNotSupported() &&
                  ingestion_options_.failed_move_fall_back_to_copy) {
         // Original file is on a different FS, use copy instead of hard linking.
         f.copy_file = true;
         ROCKS_LOG_INFO(db_options_.info_log,
                        "Tried to link file %s but it's not supported : %s",
-                       path_outside_db.c_str(), status.ToString().c_str());
+                       path_outside_db.c_str(), file_status.ToString().c_str());
       }
     } else {
       f.copy_file = true;
@@ -168,7 +179,7 @@ Status ExternalSstFileIngestionJob::Prepare(
               ? sv->mutable_cf_options.last_level_temperature
               : sv->mutable_cf_options.default_write_temperature;
       // Note: CopyFile also syncs the new file.
-      status = CopyFile(fs_.get(), path_outside_db, f.file_temperature,
+      file_status = CopyFile(fs_.get(), path_outside_db, f.file_temperature,
                         path_inside_db, dst_temp, 0, db_options_.use_fsync,
                         io_tracer_);
       // The destination of the copy will be ingested
@@ -178,13 +189,17 @@ Status ExternalSstFileIngestionJob::Prepare(
       // temperatures, so no need to change f.file_temperature
     }
     TEST_SYNC_POINT("ExternalSstFileIngestionJob::Prepare:FileAdded");
-    if (!status.ok()) {
-      break;
+    if (!file_status.ok()) {
+      return file_status;
     }
     f.internal_file_path = path_inside_db;
     // Initialize the checksum information of ingested files.
     f.file_checksum = kUnknownFileChecksum;
     f.file_checksum_func_name = kUnknownFileChecksumFuncName;
+    return file_status;
+  });
+  std::unordered_set<size_t> ingestion_path_ids;
+  for (IngestedFileInfo& f : files_to_ingest_) {
     ingestion_path_ids.insert(f.fd.GetPathId());
   }
 
@@ -227,13 +242,12 @@ Status ExternalSstFileIngestionJob::Prepare(
     std::unique_ptr<FileChecksumGenerator> file_checksum_gen =
         db_options_.file_checksum_gen_factory->CreateFileChecksumGenerator(
             gen_context);
-    std::vector<std::string> generated_checksums;
-    std::vector<std::string> generated_checksum_func_names;
+    std::vector<std::string> generated_checksums(files_to_ingest_.size());
+    std::vector<std::string> generated_checksum_func_names(
+        files_to_ingest_.size());
     // Step 1: generate the checksum for ingested sst file.
     if (need_generate_file_checksum_) {
-      for (size_t i = 0; i < files_to_ingest_.size(); i++) {
-        std::string generated_checksum;
-        std::string generated_checksum_func_name;
+      status = ForEachFile(files_to_ingest_.size(), [&](size_t i) {
         std::string requested_checksum_func_name;
         // TODO: rate limit file reads for checksum calculation during file
         // ingestion.
@@ -242,28 +256,26 @@ Status ExternalSstFileIngestionJob::Prepare(
         IOStatus io_s = GenerateOneFileChecksum(
             fs_.get(), files_to_ingest_[i].internal_file_path,
             db_options_.file_checksum_gen_factory.get(),
-            requested_checksum_func_name, &generated_checksum,
-            &generated_checksum_func_name,
+            requested_checksum_func_name, &generated_checksums[i],
+            &generated_checksum_func_names[i],
             ingestion_options_.verify_checksums_readahead_size,
             db_options_.allow_mmap_reads, io_tracer_,
             db_options_.rate_limiter.get(), ro, db_options_.stats,
             db_options_.clock);
         if (!io_s.ok()) {
-          status = io_s;
           ROCKS_LOG_WARN(db_options_.info_log,
                          "Sst file checksum generation of file: %s failed: %s",
                          files_to_ingest_[i].internal_file_path.c_str(),
-                         status.ToString().c_str());
-          break;
+                         io_s.ToString().c_str());
+          return Status(io_s);
         }
         if (ingestion_options_.write_global_seqno == false) {
-          files_to_ingest_[i].file_checksum = generated_checksum;
+          files_to_ingest_[i].file_checksum = generated_checksums[i];
           files_to_ingest_[i].file_checksum_func_name =
-              generated_checksum_func_name;
+              generated_checksum_func_names[i];
         }
-        generated_checksums.push_back(generated_checksum);
-        generated_checksum_func_names.push_back(generated_checksum_func_name);
-      }
+        return Status::OK();
+      });
     }
 
     // Step 2: based on the verify_file_checksum and ingested checksum
@@ -338,6 +350,57 @@ Status ExternalSstFileIngestionJob::Prepare(
   return status;
 }
 
+Status ExternalSstFileIngestionJob::ForEachFile(
+    size_t num_files, const std::function<Status(size_t)>& fn) {
+  const size_t num_threads =
+      std::min(num_files, static_cast<size_t>(std::max(
+                              ingestion_options_.prepare_threads, 1)));
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < num_files; i++) {
+      Status s = fn(i);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return Status::OK();
+  }
+
+  // The threads take the next file until all are done or one fails
+  std::vector<Status> statuses(num_files);
+  std::atomic<size_t> next_file{0};
+  std::atomic<bool> failed{false};
+  auto work = [&]() {
+    while (!failed.load(std::memory_order_relaxed)) {
+      const size_t i = next_file.fetch_add(1, std::memory_order_relaxed);
+      if (i >= num_files) {
+        break;
+      }
+      statuses[i] = fn(i);
+      if (!statuses[i].ok()) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& t : threads) {
+    t.join();
+  }
+  // The failure of the first file in order, as when running serially
+  Status status;
+  for (Status& s : statuses) {
+    if (status.ok()) {
+      status = std::move(s);
+    } else {
+      s.PermitUncheckedError();
+    }
+  }
+  return status;
+}
+
 Status ExternalSstFileIngestionJob::NeedsFlush(bool* flush_needed,
                                                SuperVersion* super_version) {
   size_t n = files_to_ingest_.size();
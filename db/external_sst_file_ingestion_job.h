@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #pragma once
+#include <functional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -159,6 +160,13 @@ class ExternalSstFileIngestionJob {
   int ConsumedSequenceNumbersCount() const { return consumed_seqno_count_; }
 
  private:
+  // Calls fn with the index of each of num_files files, on up to
+  // IngestExternalFileOptions::prepare_threads threads. Returns the failure
+  // of the first file in order, if any; the files after a failure may not
+  // be processed.
+  Status ForEachFile(size_t num_files,
+                     const std::function<Status(size_t)>& fn);
+
   Status ResetTableReader(const std::string& external_file,
                           uint64_t new_file_number,
                           bool user_defined_timestamps_persisted,
@@ -30,6 +30,7 @@
 #include "logging/event_logger.h"
 #include "logging/log_buffer.h"
 #include "logging/logging.h"
+#include "memtable/sorted_array_rep.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_util.h"
@@ -39,6 +40,7 @@
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
+#include "rocksdb/tenant_usage.h"
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
@@ -492,9 +494,15 @@ Status FlushJob::MemPurge() {
       }
     }
 
-    new_mem = new MemTable((cfd_->internal_comparator()), *(cfd_->ioptions()),
-                           mutable_cf_options_, cfd_->write_buffer_mgr(),
-                           earliest_seqno, cfd_->GetID());
+    // The entries are copied in key order, as a sorted array requires
+    SortedArrayRepFactory sorted_array_factory;
+    new_mem = new MemTable(
+        (cfd_->internal_comparator()), *(cfd_->ioptions()),
+        mutable_cf_options_, cfd_->write_buffer_mgr(), earliest_seqno,
+        cfd_->GetID(),
+        mutable_cf_options_.experimental_mempurge_sorted_array
+            ? &sorted_array_factory
+            : nullptr);
     assert(new_mem != nullptr);
 
     Env* env = db_options_.env;
@@ -1091,6 +1099,11 @@ Status FlushJob::WriteLevel0Table() {
   cfd_->internal_stats()->AddCFStats(
       InternalStats::BYTES_FLUSHED,
       stats.bytes_written + stats.bytes_written_blob);
+  if (cfd_->ioptions()->tenant_usage) {
+    cfd_->ioptions()->tenant_usage->Add(
+        kTenantFlushBytesWritten,
+        stats.bytes_written + stats.bytes_written_blob);
+  }
   RecordFlushIOStats();
 
   return s;
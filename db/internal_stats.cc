@@ -25,6 +25,8 @@
 #include "db/db_impl/db_impl.h"
 #include "db/write_stall_stats.h"
 #include "port/port.h"
+#include "rocksdb/memory_tracker.h"
+#include "rocksdb/stats_exporter.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table.h"
 #include "table/block_based/cachable_entry.h"
@@ -82,6 +84,22 @@ const std::map<InternalStats::InternalDBStatsType, DBStatInfo>
          DBStatInfo{WriteStallStatsMapKeys::CauseConditionCount(
              WriteStallCause::kWriteBufferManagerLimit,
              WriteStallCondition::kStopped)}},
+        {InternalStats::kIntStatsReplicationRecordsApplied,
+         DBStatInfo{"db.replication_records_applied"}},
+        {InternalStats::kIntStatsReplicationBytesApplied,
+         DBStatInfo{"db.replication_bytes_applied"}},
+        {InternalStats::kIntStatsReplicationMemtableWritesApplied,
+         DBStatInfo{"db.replication_memtable_writes_applied"}},
+        {InternalStats::kIntStatsReplicationMemtableSwitchesApplied,
+         DBStatInfo{"db.replication_memtable_switches_applied"}},
+        {InternalStats::kIntStatsReplicationManifestWritesApplied,
+         DBStatInfo{"db.replication_manifest_writes_applied"}},
+        {InternalStats::kIntStatsReplicationApplyMicros,
+         DBStatInfo{"db.replication_apply_micros"}},
+        {InternalStats::kIntStatsReplicationSwitchMemtableMicros,
+         DBStatInfo{"db.replication_switch_memtable_micros"}},
+        {InternalStats::kIntStatsReplicationLeaderSequence,
+         DBStatInfo{"db.replication_leader_sequence"}},
 };
 
 namespace {
@@ -311,6 +329,7 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string memory_breakdown = "memory-breakdown";
 static const std::string options_statistics = "options-statistics";
 static const std::string num_blob_files = "num-blob-files";
 static const std::string blob_stats = "blob-stats";
@@ -321,6 +340,8 @@ static const std::string live_blob_file_garbage_size =
 static const std::string blob_cache_capacity = "blob-cache-capacity";
 static const std::string blob_cache_usage = "blob-cache-usage";
 static const std::string blob_cache_pinned_usage = "blob-cache-pinned-usage";
+static const std::string replication_stats = "replication-stats";
+static const std::string replication_sequence_gap = "replication-sequence-gap";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -420,6 +441,8 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kMemoryBreakdown =
+    rocksdb_prefix + memory_breakdown;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
 const std::string DB::Properties::kLiveSstFilesSizeAtTemperature =
@@ -439,9 +462,21 @@ const std::string DB::Properties::kBlobCacheUsage =
     rocksdb_prefix + blob_cache_usage;
 const std::string DB::Properties::kBlobCachePinnedUsage =
     rocksdb_prefix + blob_cache_pinned_usage;
+const std::string DB::Properties::kReplicationStats =
+    rocksdb_prefix + replication_stats;
+const std::string DB::Properties::kReplicationSequenceGap =
+    rocksdb_prefix + replication_sequence_gap;
 
 const std::string InternalStats::kPeriodicCFStats =
     DB::Properties::kCFStats + ".periodic";
+
+std::vector<std::string> StatsExporter::GetIntProperties() const {
+  return {DB::Properties::kCurSizeAllMemTables,
+          DB::Properties::kNumImmutableMemTable,
+          DB::Properties::kLiveSstFilesSize,
+          DB::Properties::kEstimateNumKeys,
+          DB::Properties::kEstimatePendingCompactionBytes};
+}
 const int InternalStats::kMaxNoChangePeriodSinceDump = 8;
 
 const UnorderedMap<std::string, DBPropertyInfo>
@@ -605,6 +640,9 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kMemoryBreakdown,
+         {false, &InternalStats::HandleMemoryBreakdown, nullptr,
+          &InternalStats::HandleMemoryBreakdownMap, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {true, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
@@ -631,6 +669,12 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlobCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlobCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kReplicationStats,
+         {false, &InternalStats::HandleReplicationStats, nullptr,
+          &InternalStats::HandleReplicationStatsMap, nullptr}},
+        {DB::Properties::kReplicationSequenceGap,
+         {false, nullptr, &InternalStats::HandleReplicationSequenceGap, nullptr,
+          nullptr}},
 };
 
 InternalStats::InternalStats(int num_levels, SystemClock* clock,
@@ -964,6 +1008,55 @@ bool InternalStats::HandleBlobCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return false;
 }
 
+bool InternalStats::HandleReplicationStats(std::string* value,
+                                           Slice suffix) {
+  std::map<std::string, std::string> values;
+  HandleReplicationStatsMap(&values, suffix);
+  std::ostringstream oss;
+  for (const auto& name_and_value : values) {
+    oss << name_and_value.first << ": " << name_and_value.second << "\n";
+  }
+  *value = oss.str();
+  return true;
+}
+
+bool InternalStats::HandleReplicationStatsMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  // DB-level stats, only available from default column family
+  uint64_t applied_sequence = cfd_->current()->version_set()->LastSequence();
+  uint64_t leader_sequence = GetDBStats(kIntStatsReplicationLeaderSequence);
+  (*values)["records-applied"] =
+      std::to_string(GetDBStats(kIntStatsReplicationRecordsApplied));
+  (*values)["bytes-applied"] =
+      std::to_string(GetDBStats(kIntStatsReplicationBytesApplied));
+  (*values)["memtable-writes-applied"] =
+      std::to_string(GetDBStats(kIntStatsReplicationMemtableWritesApplied));
+  (*values)["memtable-switches-applied"] =
+      std::to_string(GetDBStats(kIntStatsReplicationMemtableSwitchesApplied));
+  (*values)["manifest-writes-applied"] =
+      std::to_string(GetDBStats(kIntStatsReplicationManifestWritesApplied));
+  (*values)["apply-micros"] =
+      std::to_string(GetDBStats(kIntStatsReplicationApplyMicros));
+  (*values)["switch-memtable-micros"] =
+      std::to_string(GetDBStats(kIntStatsReplicationSwitchMemtableMicros));
+  (*values)["leader-sequence"] = std::to_string(leader_sequence);
+  (*values)["applied-sequence"] = std::to_string(applied_sequence);
+  (*values)["sequence-gap"] = std::to_string(
+      leader_sequence > applied_sequence ? leader_sequence - applied_sequence
+                                         : 0);
+  return true;
+}
+
+bool InternalStats::HandleReplicationSequenceGap(uint64_t* value, DBImpl* db,
+                                                 Version* /*version*/) {
+  uint64_t applied_sequence = db->GetLatestSequenceNumber();
+  uint64_t leader_sequence = GetDBStats(kIntStatsReplicationLeaderSequence);
+  *value = leader_sequence > applied_sequence
+               ? leader_sequence - applied_sequence
+               : 0;
+  return true;
+}
+
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
   std::string ppt_name = GetPropertyNameAndArg(property).first.ToString();
   auto ppt_info_iter = InternalStats::ppt_name_to_info.find(ppt_name);
@@ -1544,6 +1637,61 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return false;
 }
 
+void InternalStats::DumpMemoryBreakdown(
+    std::map<std::string, uint64_t>* usage) {
+  MemoryTracker::GetAllUsage(usage);
+  std::map<std::string, uint64_t> tracked;
+  tracked.swap(*usage);
+  for (const auto& component : tracked) {
+    (*usage)["tracked." + component.first] = component.second;
+  }
+
+  const uint64_t imm_total = cfd_->imm()->ApproximateMemoryUsage();
+  const uint64_t imm_unflushed =
+      cfd_->imm()->ApproximateUnflushedMemTablesMemoryUsage();
+  (*usage)["mem-table-active"] = cfd_->mem()->ApproximateMemoryUsageFast();
+  (*usage)["mem-table-immutable-unflushed"] = imm_unflushed;
+  // Flushed mem-tables kept for the iterators and the write history
+  (*usage)["mem-table-flushed-pinned"] =
+      imm_total > imm_unflushed ? imm_total - imm_unflushed : 0;
+
+  Version* current = cfd_->current();
+  if (current != nullptr) {
+    // TODO: plumb Env::IOActivity, Env::IOPriority
+    const ReadOptions read_options;
+    (*usage)["table-readers"] =
+        current->GetMemoryUsageByTableReaders(read_options);
+  }
+
+  Cache* block_cache = GetBlockCacheForStats();
+  if (block_cache) {
+    (*usage)["block-cache-usage"] = block_cache->GetUsage();
+    (*usage)["block-cache-pinned-usage"] = block_cache->GetPinnedUsage();
+  }
+}
+
+bool InternalStats::HandleMemoryBreakdown(std::string* value,
+                                          Slice /*suffix*/) {
+  std::map<std::string, uint64_t> usage;
+  DumpMemoryBreakdown(&usage);
+  std::ostringstream oss;
+  for (const auto& component : usage) {
+    oss << component.first << ": " << component.second << "\n";
+  }
+  *value = oss.str();
+  return true;
+}
+
+bool InternalStats::HandleMemoryBreakdownMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  std::map<std::string, uint64_t> usage;
+  DumpMemoryBreakdown(&usage);
+  for (const auto& component : usage) {
+    (*values)[component.first] = std::to_string(component.second);
+  }
+  return true;
+}
+
 void InternalStats::DumpDBMapStats(
     std::map<std::string, std::string>* db_stats) {
   for (int i = 0; i < static_cast<int>(kIntStatsNumMax); ++i) {
@@ -146,6 +146,17 @@ class InternalStats {
     // So we should improve, rename or clarify it
     kIntStatsWriteStallMicros,
     kIntStatsWriteBufferManagerLimitStopsCounts,
+    // Replication log records applied by a follower, see
+    // DB::Properties::kReplicationStats
+    kIntStatsReplicationRecordsApplied,
+    kIntStatsReplicationBytesApplied,
+    kIntStatsReplicationMemtableWritesApplied,
+    kIntStatsReplicationMemtableSwitchesApplied,
+    kIntStatsReplicationManifestWritesApplied,
+    kIntStatsReplicationApplyMicros,
+    kIntStatsReplicationSwitchMemtableMicros,
+    // Highest leader sequence number the follower was given to apply
+    kIntStatsReplicationLeaderSequence,
     kIntStatsNumMax,
   };
 
@@ -561,6 +572,16 @@ class InternalStats {
     }
   }
 
+  // Raises the stat to value if it is lower
+  void UpdateDBStatsMax(InternalDBStatsType type, uint64_t value) {
+    auto& v = db_stats_[type];
+    auto current = v.load(std::memory_order_relaxed);
+    while (current < value &&
+           !v.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+    }
+  }
+
   uint64_t GetDBStats(InternalDBStatsType type) {
     return db_stats_[type].load(std::memory_order_relaxed);
   }
@@ -595,6 +616,11 @@ class InternalStats {
   // This should only be called while NOT holding the DB mutex.
   void CollectCacheEntryStats(bool foreground);
 
+  // The compaction stats of each output level. REQUIRES: DB mutex held
+  const std::vector<CompactionStats>& GetCompactionStats() const {
+    return comp_stats_;
+  }
+
   const uint64_t* TEST_GetCFStatsValue() const { return cf_stats_value_; }
 
   const std::vector<CompactionStats>& TEST_GetCompactionStats() const {
@@ -639,6 +665,10 @@ class InternalStats {
   void DumpCFStatsWriteStall(std::string* value,
                              uint64_t* total_stall_count = nullptr);
 
+  // The memory usage of the column family by component, see
+  // DB::Properties::kMemoryBreakdown
+  void DumpMemoryBreakdown(std::map<std::string, uint64_t>* usage);
+
   Cache* GetBlockCacheForStats();
   Cache* GetBlobCacheForStats();
 
@@ -841,6 +871,9 @@ class InternalStats {
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
+  bool HandleMemoryBreakdown(std::string* value, Slice suffix);
+  bool HandleMemoryBreakdownMap(std::map<std::string, std::string>* values,
+                                Slice suffix);
   bool HandleBlockCacheEntryStatsInternal(std::string* value, bool fast);
   bool HandleBlockCacheEntryStatsMapInternal(
       std::map<std::string, std::string>* values, bool fast);
@@ -861,6 +894,11 @@ class InternalStats {
   bool HandleBlobCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlobCachePinnedUsage(uint64_t* value, DBImpl* db,
                                   Version* version);
+  bool HandleReplicationStats(std::string* value, Slice suffix);
+  bool HandleReplicationStatsMap(std::map<std::string, std::string>* values,
+                                 Slice suffix);
+  bool HandleReplicationSequenceGap(uint64_t* value, DBImpl* db,
+                                    Version* version);
 
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <array>
 #include <type_traits>
 
 #include "db/dbformat.h"
@@ -87,6 +88,13 @@ class ProtectionInfo {
   static const uint64_t kSeedS = 0x77A00858DDD37F21;
   static const uint64_t kSeedC = 0x4A2AB5CBD26F542C;
 
+  // Hashing the one byte of an op type or the four of a column family ID
+  // costs about as much as hashing a short key, so the hashes of all op types
+  // and of the first column family IDs are computed once.
+  static constexpr ColumnFamilyId kNumCachedColumnFamilyIds = 256;
+  static uint64_t HashO(ValueType op_type);
+  static uint64_t HashC(ColumnFamilyId column_family_id);
+
   ProtectionInfo(T val) : val_(val) {
     static_assert(sizeof(ProtectionInfo<T>) == sizeof(T), "");
   }
@@ -284,6 +292,37 @@ class ProtectionInfoKV {
   ProtectionInfo<T> info_;
 };
 
+template <typename T>
+uint64_t ProtectionInfo<T>::HashO(ValueType op_type) {
+  static const std::array<uint64_t, 256> kHashes = [] {
+    std::array<uint64_t, 256> hashes;
+    for (size_t i = 0; i < hashes.size(); i++) {
+      ValueType type = static_cast<ValueType>(i);
+      hashes[i] =
+          NPHash64(reinterpret_cast<char*>(&type), sizeof(type), kSeedO);
+    }
+    return hashes;
+  }();
+  static_assert(sizeof(ValueType) == 1);
+  return kHashes[static_cast<uint8_t>(op_type)];
+}
+
+template <typename T>
+uint64_t ProtectionInfo<T>::HashC(ColumnFamilyId column_family_id) {
+  static const std::array<uint64_t, kNumCachedColumnFamilyIds> kHashes = [] {
+    std::array<uint64_t, kNumCachedColumnFamilyIds> hashes;
+    for (ColumnFamilyId id = 0; id < kNumCachedColumnFamilyIds; id++) {
+      hashes[id] = NPHash64(reinterpret_cast<char*>(&id), sizeof(id), kSeedC);
+    }
+    return hashes;
+  }();
+  if (column_family_id < kNumCachedColumnFamilyIds) {
+    return kHashes[column_family_id];
+  }
+  return NPHash64(reinterpret_cast<char*>(&column_family_id),
+                  sizeof(column_family_id), kSeedC);
+}
+
 template <typename T>
 Status ProtectionInfo<T>::GetStatus() const {
   if (val_ != 0) {
@@ -300,9 +339,7 @@ ProtectionInfoKVO<T> ProtectionInfo<T>::ProtectKVO(const Slice& key,
   val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
   val =
       val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(op_type));
   return ProtectionInfoKVO<T>(val);
 }
 
@@ -315,9 +352,7 @@ ProtectionInfoKVO<T> ProtectionInfo<T>::ProtectKVO(const SliceParts& key,
         static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
   val = val ^
         static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(op_type));
   return ProtectionInfoKVO<T>(val);
 }
 
@@ -378,12 +413,8 @@ template <typename T>
 void ProtectionInfoKVO<T>::UpdateO(ValueType old_op_type,
                                    ValueType new_op_type) {
   T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&old_op_type),
-                                      sizeof(old_op_type),
-                                      ProtectionInfo<T>::kSeedO));
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&new_op_type),
-                                      sizeof(new_op_type),
-                                      ProtectionInfo<T>::kSeedO));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(old_op_type));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(new_op_type));
   SetVal(val);
 }
 
@@ -395,9 +426,7 @@ ProtectionInfo<T> ProtectionInfoKVO<T>::StripKVO(const Slice& key,
   val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
   val =
       val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(op_type));
   return ProtectionInfo<T>(val);
 }
 
@@ -410,9 +439,7 @@ ProtectionInfo<T> ProtectionInfoKVO<T>::StripKVO(const SliceParts& key,
         static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
   val = val ^
         static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashO(op_type));
   return ProtectionInfo<T>(val);
 }
 
@@ -420,9 +447,7 @@ template <typename T>
 ProtectionInfoKVOC<T> ProtectionInfoKVO<T>::ProtectC(
     ColumnFamilyId column_family_id) const {
   T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&column_family_id),
-                  sizeof(column_family_id), ProtectionInfo<T>::kSeedC));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashC(column_family_id));
   return ProtectionInfoKVOC<T>(val);
 }
 
@@ -430,9 +455,7 @@ template <typename T>
 ProtectionInfoKVO<T> ProtectionInfoKVOC<T>::StripC(
     ColumnFamilyId column_family_id) const {
   T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&column_family_id),
-                  sizeof(column_family_id), ProtectionInfo<T>::kSeedC));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashC(column_family_id));
   return ProtectionInfoKVO<T>(val);
 }
 
@@ -440,12 +463,8 @@ template <typename T>
 void ProtectionInfoKVOC<T>::UpdateC(ColumnFamilyId old_column_family_id,
                                     ColumnFamilyId new_column_family_id) {
   T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&old_column_family_id),
-                  sizeof(old_column_family_id), ProtectionInfo<T>::kSeedC));
-  val = val ^ static_cast<T>(NPHash64(
-                  reinterpret_cast<char*>(&new_column_family_id),
-                  sizeof(new_column_family_id), ProtectionInfo<T>::kSeedC));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashC(old_column_family_id));
+  val = val ^ static_cast<T>(ProtectionInfo<T>::HashC(new_column_family_id));
   SetVal(val);
 }
 
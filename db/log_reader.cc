@@ -605,7 +605,8 @@ void Reader::InitCompression(const CompressionTypeRecord& compression_record) {
   compression_type_record_read_ = true;
   constexpr uint32_t compression_format_version = 2;
   uncompress_ = StreamingUncompress::Create(
-      compression_type_, compression_format_version, kBlockSize);
+      compression_type_, compression_format_version, kBlockSize,
+      compression_record.GetDictionary());
   assert(uncompress_ != nullptr);
   uncompressed_buffer_ = std::unique_ptr<char[]>(new char[kBlockSize]);
   assert(uncompressed_buffer_);
@@ -1131,6 +1131,56 @@ TEST_P(CompressionLogTest, AlignedFragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(CompressionLogTest, Dictionary) {
+  CompressionType compression_type = std::get<2>(GetParam());
+  if (compression_type == kNoCompression ||
+      !StreamingCompressionTypeSupported(compression_type)) {
+    ROCKSDB_GTEST_SKIP("Test requires support for compression type");
+    return;
+  }
+  auto doc = [](int i) {
+    return "{\"id\": " + std::to_string(i) +
+           ", \"status\": \"active\", \"region\": \"us-east-1\", "
+           "\"tags\": [\"alpha\", \"beta\", \"gamma\"]}";
+  };
+  std::string dict;
+  for (int i = 0; i < 10; i++) {
+    dict += doc(i);
+  }
+  ASSERT_OK(writer_->AddCompressionTypeRecord(WriteOptions(), dict));
+  writer_->SampleForCompressionDict(100);
+  size_t header_bytes = WrittenBytes();
+  std::string written;
+  for (int i = 100; i < 200; i++) {
+    Write(doc(i));
+    written += doc(i);
+  }
+  ASSERT_EQ(written.substr(0, 100), writer_->compression_dict_samples());
+  size_t dict_record_bytes = WrittenBytes() - header_bytes;
+
+  for (int i = 100; i < 200; i++) {
+    ASSERT_EQ(doc(i), Read());
+  }
+  ASSERT_EQ("EOF", Read());
+
+  // The same records compressed without the dictionary
+  CompressionOptions opts;
+  constexpr uint32_t compression_format_version = 2;
+  std::unique_ptr<StreamingCompress> compress(StreamingCompress::Create(
+      compression_type, opts, compression_format_version, kBlockSize));
+  std::unique_ptr<char[]> output(new char[kBlockSize]);
+  size_t no_dict_bytes = 0;
+  for (int i = 100; i < 200; i++) {
+    const std::string record = doc(i);
+    size_t output_pos = 0;
+    ASSERT_EQ(0, compress->Compress(record.data(), record.size(),
+                                    output.get(), &output_pos));
+    no_dict_bytes += output_pos;
+    compress->Reset();
+  }
+  ASSERT_LT(dict_record_bytes, no_dict_bytes);
+}
+
 INSTANTIATE_TEST_CASE_P(
     Compression, CompressionLogTest,
     ::testing::Combine(::testing::Values(0, 1), ::testing::Bool(),
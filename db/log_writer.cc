@@ -9,6 +9,7 @@
 
 #include "db/log_writer.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "file/writable_file_writer.h"
@@ -73,10 +74,16 @@ IOStatus Writer::Close(const WriteOptions& write_options) {
 }
 
 IOStatus Writer::AddRecord(const WriteOptions& write_options,
-                           const Slice& slice) {
+                           const Slice& slice, bool flush) {
   if (dest_->seen_error()) {
     return IOStatus::IOError("Seen error. Skip writing buffer.");
   }
+  if (compression_dict_samples_.size() < compression_dict_sample_bytes_) {
+    compression_dict_samples_.append(
+        slice.data(),
+        std::min(slice.size(), compression_dict_sample_bytes_ -
+                                   compression_dict_samples_.size()));
+  }
   const char* ptr = slice.data();
   size_t left = slice.size();
 
@@ -168,7 +175,7 @@ IOStatus Writer::AddRecord(const WriteOptions& write_options,
     } while (s.ok() && (left > 0 || compress_remaining > 0));
   }
   if (s.ok()) {
-    if (!manual_flush_) {
+    if (!manual_flush_ && flush) {
       s = dest_->Flush(opts);
     }
   }
@@ -176,7 +183,8 @@ IOStatus Writer::AddRecord(const WriteOptions& write_options,
   return s;
 }
 
-IOStatus Writer::AddCompressionTypeRecord(const WriteOptions& write_options) {
+IOStatus Writer::AddCompressionTypeRecord(const WriteOptions& write_options,
+                                          const Slice& dict) {
   // Should be the first record
   assert(block_offset_ == 0);
 
@@ -189,7 +197,8 @@ IOStatus Writer::AddCompressionTypeRecord(const WriteOptions& write_options) {
     return IOStatus::IOError("Seen error. Skip writing buffer.");
   }
 
-  CompressionTypeRecord record(compression_type_);
+  assert(dict.size() <= kMaxCompressionDictBytes);
+  CompressionTypeRecord record(compression_type_, dict);
   std::string encode;
   record.EncodeTo(&encode);
   IOStatus s = EmitPhysicalRecord(write_options, kSetCompressionType,
@@ -209,7 +218,7 @@ IOStatus Writer::AddCompressionTypeRecord(const WriteOptions& write_options) {
     constexpr uint32_t compression_format_version = 2;
     compress_ = StreamingCompress::Create(compression_type_, opts,
                                           compression_format_version,
-                                          max_output_buffer_len);
+                                          max_output_buffer_len, dict);
     assert(compress_ != nullptr);
     compressed_buffer_ =
         std::unique_ptr<char[]>(new char[max_output_buffer_len]);
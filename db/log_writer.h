@@ -86,8 +86,26 @@ class Writer {
 
   ~Writer();
 
-  IOStatus AddRecord(const WriteOptions& write_options, const Slice& slice);
-  IOStatus AddCompressionTypeRecord(const WriteOptions& write_options);
+  // If flush is false, the record is left in file()'s buffer for the Sync()
+  // that follows, which writes and syncs it at once.
+  IOStatus AddRecord(const WriteOptions& write_options, const Slice& slice,
+                     bool flush = true);
+  // dict, if not empty, is the dictionary the records that follow are
+  // compressed with. It is stored in the record, so it can be at most
+  // kMaxCompressionDictBytes.
+  IOStatus AddCompressionTypeRecord(const WriteOptions& write_options,
+                                    const Slice& dict = Slice());
+
+  // Keeps a copy of the first max_bytes of the records added from now on,
+  // as the compression dictionary of the next log
+  void SampleForCompressionDict(size_t max_bytes) {
+    compression_dict_sample_bytes_ = max_bytes;
+  }
+  const std::string& compression_dict_samples() const {
+    return compression_dict_samples_;
+  }
+
+  static constexpr size_t kMaxCompressionDictBytes = kBlockSize / 2;
 
   // If there are column families in `cf_to_ts_sz` not included in
   // `recorded_cf_to_ts_sz_` and its user-defined timestamp size is non-zero,
@@ -132,6 +150,9 @@ class Writer {
   StreamingCompress* compress_;
   // Reusable compressed output buffer
   std::unique_ptr<char[]> compressed_buffer_;
+  // See SampleForCompressionDict()
+  size_t compression_dict_sample_bytes_ = 0;
+  std::string compression_dict_samples_;
 
   // The recorded user-defined timestamp size that have been written so far.
   // Since the user-defined timestamp size cannot be changed while the DB is
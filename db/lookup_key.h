@@ -24,6 +24,13 @@ class LookupKey {
   LookupKey(const Slice& _user_key, SequenceNumber sequence,
             const Slice* ts = nullptr);
 
+  // Same as above, but a key too long for the inline space is built in *buf
+  // rather than in an allocation of its own, so that a buffer reused across
+  // lookups saves the allocation once it is large enough. *buf must not be
+  // modified or destroyed while *this is in use.
+  LookupKey(const Slice& _user_key, SequenceNumber sequence, const Slice* ts,
+            std::string* buf);
+
   ~LookupKey();
 
   // Return a key suitable for lookup in a MemTable.
@@ -54,15 +61,20 @@ class LookupKey {
   const char* start_;
   const char* kstart_;
   const char* end_;
+  // Whether start_ was allocated by this LookupKey
+  bool owned_ = false;
   char space_[200];  // Avoid allocation for short keys
 
+  void Init(const Slice& _user_key, SequenceNumber s, const Slice* ts,
+            std::string* buf);
+
   // No copying allowed
   LookupKey(const LookupKey&);
   void operator=(const LookupKey&);
 };
 
 inline LookupKey::~LookupKey() {
-  if (start_ != space_) delete[] start_;
+  if (owned_) delete[] start_;
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,74 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+
+#include "db/merge_context.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The state of a point lookup that each thread keeps across its lookups, so
+// that DBImpl::Get() does not allocate its MergeContext and the LookupKey of
+// a long key anew: both keep their memory from the previous lookups of the
+// thread.
+//
+// A lookup nested in another one on the same thread, e.g. from a merge
+// operator or a read callback, gets a scratch of its own.
+class LookupScratch {
+ public:
+  LookupScratch() {
+    Shared* shared = GetShared();
+    if (!shared->in_use) {
+      shared->in_use = true;
+      shared_ = shared;
+    }
+  }
+
+  ~LookupScratch() {
+    if (shared_ != nullptr) {
+      shared_->merge_context.ClearForReuse();
+      if (shared_->key_buffer.capacity() > kMaxReusedKeyBufferSize) {
+        std::string().swap(shared_->key_buffer);
+      }
+      shared_->in_use = false;
+    }
+  }
+
+  // No copying allowed
+  LookupScratch(const LookupScratch&) = delete;
+  void operator=(const LookupScratch&) = delete;
+
+  MergeContext& merge_context() {
+    return shared_ != nullptr ? shared_->merge_context : merge_context_;
+  }
+
+  // For LookupKey
+  std::string* key_buffer() {
+    return shared_ != nullptr ? &shared_->key_buffer : nullptr;
+  }
+
+ private:
+  static constexpr size_t kMaxReusedKeyBufferSize = 16 << 10;
+
+  struct Shared {
+    MergeContext merge_context;
+    std::string key_buffer;
+    bool in_use = false;
+  };
+
+  static Shared* GetShared() {
+    static thread_local Shared shared;
+    return &shared;
+  }
+
+  // The scratch of the thread, null if a lookup of the thread already
+  // uses it
+  Shared* shared_ = nullptr;
+  MergeContext merge_context_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
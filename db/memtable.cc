@@ -25,6 +25,7 @@
 #include "logging/logging.h"
 #include "memory/arena.h"
 #include "memory/memory_usage.h"
+#include "memtable/sorted_array_rep.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics_impl.h"
 #include "port/lang.h"
@@ -59,6 +60,7 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
           mutable_cf_options.memtable_whole_key_filtering),
       inplace_update_support(ioptions.inplace_update_support),
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
+      inplace_merge_support(ioptions.inplace_merge_support),
       inplace_callback(ioptions.inplace_callback),
       max_successive_merges(mutable_cf_options.max_successive_merges),
       strict_max_successive_merges(
@@ -74,26 +76,28 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                    const ImmutableOptions& ioptions,
                    const MutableCFOptions& mutable_cf_options,
                    WriteBufferManager* write_buffer_manager,
-                   SequenceNumber latest_seq, uint32_t column_family_id)
+                   SequenceNumber latest_seq, uint32_t column_family_id,
+                   MemTableRepFactory* table_factory)
     : comparator_(cmp),
       moptions_(ioptions, mutable_cf_options),
       refs_(0),
       kArenaBlockSize(Arena::OptimizeBlockSize(moptions_.arena_block_size)),
-      mem_tracker_(write_buffer_manager),
-      arena_(moptions_.arena_block_size,
-             (write_buffer_manager != nullptr &&
-              (write_buffer_manager->enabled() ||
-               write_buffer_manager->cost_to_cache()))
-                 ? &mem_tracker_
-                 : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
-      table_(ioptions.memtable_factory->CreateMemTableRep(
-          comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
-          ioptions.logger, column_family_id)),
+      mem_tracker_(write_buffer_manager,
+                   MemoryTracker::Get(MemoryTrackerNames::kMemTable())),
+      arena_(moptions_.arena_block_size, &mem_tracker_,
+             mutable_cf_options.memtable_huge_page_size,
+             mutable_cf_options.memtable_numa_local_alloc,
+             ioptions.memtable_allocator.get()),
+      table_((table_factory != nullptr ? table_factory
+                                       : ioptions.memtable_factory.get())
+                 ->CreateMemTableRep(comparator_, &arena_,
+                                     mutable_cf_options.prefix_extractor.get(),
+                                     ioptions.logger, column_family_id)),
       range_del_table_(SkipListFactory().CreateMemTableRep(
           comparator_, &arena_, nullptr /* transform */, ioptions.logger,
           column_family_id)),
       is_range_del_table_empty_(true),
+      flat_table_(nullptr),
       data_size_(0),
       num_entries_(0),
       num_deletes_(0),
@@ -107,7 +111,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       creation_seq_(latest_seq),
       mem_next_logfile_number_(0),
       min_prep_log_referenced_(0),
-      locks_(moptions_.inplace_update_support
+      locks_(moptions_.inplace_update_support || moptions_.inplace_merge_support
                  ? moptions_.inplace_update_num_locks
                  : 0),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
@@ -153,6 +157,21 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
   assert(ucmp);
   ts_sz_ = ucmp->timestamp_size();
   persist_user_defined_timestamps_ = ioptions.persist_user_defined_timestamps;
+
+  const double hash_index_buckets =
+      static_cast<double>(mutable_cf_options.write_buffer_size) *
+      mutable_cf_options.memtable_hash_index_size_ratio / sizeof(void*);
+  if (hash_index_buckets >= 1 && ts_sz_ == 0 &&
+      !ucmp->CanKeysWithDifferentByteContentsBeEqual() &&
+      table_factory == nullptr &&
+      ioptions.memtable_factory->IsInstanceOf(SkipListFactory::kClassName())) {
+    hash_index_.reset(new MemTableHashIndex(
+        &arena_,
+        static_cast<uint32_t>(std::min(
+            hash_index_buckets,
+            static_cast<double>(std::numeric_limits<uint32_t>::max()))),
+        moptions_.memtable_huge_page_size, ioptions.logger));
+  }
 }
 
 MemTable::~MemTable() {
@@ -163,7 +182,7 @@ MemTable::~MemTable() {
 size_t MemTable::ApproximateMemoryUsage() {
   autovector<size_t> usages = {
       arena_.ApproximateMemoryUsage(), table_->ApproximateMemoryUsage(),
-      range_del_table_->ApproximateMemoryUsage(),
+      FlatTableMemoryUsage(), range_del_table_->ApproximateMemoryUsage(),
       ROCKSDB_NAMESPACE::ApproximateMemoryUsage(insert_hints_)};
   size_t total_usage = 0;
   for (size_t usage : usages) {
@@ -179,6 +198,27 @@ size_t MemTable::ApproximateMemoryUsage() {
   return total_usage;
 }
 
+void MemTable::Flatten() {
+  if (IsFlattened()) {
+    return;
+  }
+  SortedArrayRepFactory factory(
+      static_cast<size_t>(num_entries_.load(std::memory_order_relaxed)));
+  std::unique_ptr<MemTableRep> flat_table(factory.CreateMemTableRep(
+      comparator_, &arena_, nullptr /* transform */, moptions_.info_log));
+  std::unique_ptr<MemTableRep::Iterator> iter(table_->GetIterator());
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    // The entries are already encoded in the arena
+    if (!flat_table->InsertKey(const_cast<char*>(iter->key()))) {
+      // Not in strictly ascending order, which the rep does not guarantee
+      return;
+    }
+  }
+  flat_table_owner_ = std::move(flat_table);
+  flat_table_.store(flat_table_owner_.get(), std::memory_order_release);
+  TEST_SYNC_POINT("MemTable::Flatten:Done");
+}
+
 bool MemTable::ShouldFlushNow() {
   // This is set if memtable_max_range_deletions is > 0,
   // and that many range deletions are done
@@ -200,6 +240,7 @@ bool MemTable::ShouldFlushNow() {
   // If arena still have room for new block allocation, we can safely say it
   // shouldn't flush.
   auto allocated_memory = table_->ApproximateMemoryUsage() +
+                          FlatTableMemoryUsage() +
                           range_del_table_->ApproximateMemoryUsage() +
                           arena_.MemoryAllocatedBytes();
 
@@ -390,7 +431,8 @@ class MemTableIterator : public InternalIterator {
         seqno_to_time_mapping_(seqno_to_time_mapping),
         arena_mode_(arena != nullptr),
         value_pinned_(
-            !mem.GetImmutableMemTableOptions()->inplace_update_support),
+            !mem.GetImmutableMemTableOptions()->inplace_update_support &&
+            !mem.GetImmutableMemTableOptions()->inplace_merge_support),
         protection_bytes_per_key_(mem.moptions_.protection_bytes_per_key),
         status_(Status::OK()),
         logger_(mem.moptions_.info_log),
@@ -401,9 +443,9 @@ class MemTableIterator : public InternalIterator {
                !read_options.auto_prefix_mode) {
       // Auto prefix mode is not implemented in memtable yet.
       bloom_ = mem.bloom_filter_.get();
-      iter_ = mem.table_->GetDynamicPrefixIterator(arena);
+      iter_ = mem.GetTableForRead()->GetDynamicPrefixIterator(arena);
     } else {
-      iter_ = mem.table_->GetIterator(arena);
+      iter_ = mem.GetTableForRead()->GetIterator(arena);
     }
     status_.PermitUncheckedError();
   }
@@ -781,10 +823,14 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
 
   Slice key_without_ts = StripTimestampFromUserKey(key, ts_sz_);
 
+  const bool deferred =
+      !allow_concurrent && sorted_insert_ && type != kTypeRangeDeletion;
   if (!allow_concurrent) {
-    // Extract prefix for insert with hint.
-    if (insert_with_hint_prefix_extractor_ != nullptr &&
-        insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
+    if (deferred) {
+      sorted_insert_entries_.emplace_back(buf, handle);
+    } else if (insert_with_hint_prefix_extractor_ != nullptr &&
+               insert_with_hint_prefix_extractor_->InDomain(key_slice)) {
+      // Extract prefix for insert with hint.
       Slice prefix = insert_with_hint_prefix_extractor_->Transform(key_slice);
       bool res = table->InsertKeyWithHint(handle, &insert_hints_[prefix]);
       if (UNLIKELY(!res)) {
@@ -819,6 +865,9 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->Add(key_without_ts);
     }
+    if (hash_index_ && type != kTypeRangeDeletion && !deferred) {
+      hash_index_->Add(key, s, buf);
+    }
 
     // The first sequence number inserted into the memtable
     assert(first_seqno_ == 0 || s >= first_seqno_);
@@ -859,6 +908,9 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->AddConcurrently(key_without_ts);
     }
+    if (hash_index_ && type != kTypeRangeDeletion) {
+      hash_index_->Add(key, s, buf);
+    }
 
     // atomically update first_seqno_ and earliest_seqno_.
     uint64_t cur_seq_num = first_seqno_.load(std::memory_order_relaxed);
@@ -907,6 +959,42 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   return Status::OK();
 }
 
+bool MemTable::StartSortedInsert() {
+  if (sorted_insert_ || moptions_.inplace_update_support ||
+      moptions_.inplace_merge_support || moptions_.max_successive_merges > 0) {
+    return false;
+  }
+  sorted_insert_ = true;
+  return true;
+}
+
+Status MemTable::FinishSortedInsert() {
+  assert(sorted_insert_);
+  sorted_insert_ = false;
+  std::sort(sorted_insert_entries_.begin(), sorted_insert_entries_.end(),
+            [this](const std::pair<const char*, KeyHandle>& a,
+                   const std::pair<const char*, KeyHandle>& b) {
+              return comparator_(a.first, b.first) < 0;
+            });
+  size_t num_entries = sorted_insert_entries_.size();
+  TEST_SYNC_POINT_CALLBACK("MemTable::FinishSortedInsert:NumEntries",
+                           &num_entries);
+  Status s;
+  for (const auto& entry : sorted_insert_entries_) {
+    if (UNLIKELY(!table_->InsertKey(entry.second))) {
+      s = Status::TryAgain("key+seq exists");
+      continue;
+    }
+    if (hash_index_) {
+      Slice internal_key = GetLengthPrefixedSlice(entry.first);
+      hash_index_->Add(ExtractUserKey(internal_key),
+                       GetInternalKeySeqno(internal_key), entry.first);
+    }
+  }
+  sorted_insert_entries_.clear();
+  return s;
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -926,7 +1014,9 @@ struct Saver {
   MemTable* mem;
   Logger* logger;
   Statistics* statistics;
+  // Whether values, or also merge operands, may be updated in place
   bool inplace_update_support;
+  bool inplace_merge_support;
   bool do_merge;
   SystemClock* clock;
 
@@ -1232,10 +1322,16 @@ static bool SaveValue(void* arg, const char* entry) {
           *(s->found_final_value) = true;
           return false;
         }
+        if (s->inplace_merge_support) {
+          s->mem->GetLock(s->key->user_key())->ReadLock();
+        }
         Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
         *(s->merge_in_progress) = true;
         merge_context->PushOperand(
             v, s->inplace_update_support == false /* operand_pinned */);
+        if (s->inplace_merge_support) {
+          s->mem->GetLock(s->key->user_key())->ReadUnlock();
+        }
         PERF_COUNTER_ADD(internal_merge_point_lookup_count, 1);
 
         if (s->do_merge && merge_operator->ShouldMerge(
@@ -1381,7 +1477,9 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.max_covering_tombstone_seq = max_covering_tombstone_seq;
   saver.merge_operator = moptions_.merge_operator;
   saver.logger = moptions_.info_log;
-  saver.inplace_update_support = moptions_.inplace_update_support;
+  saver.inplace_update_support =
+      moptions_.inplace_update_support || moptions_.inplace_merge_support;
+  saver.inplace_merge_support = moptions_.inplace_merge_support;
   saver.statistics = moptions_.statistics;
   saver.clock = clock_;
   saver.callback_ = callback;
@@ -1389,7 +1487,15 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.do_merge = do_merge;
   saver.allow_data_in_errors = moptions_.allow_data_in_errors;
   saver.protection_bytes_per_key = moptions_.protection_bytes_per_key;
-  table_->Get(key, &saver, SaveValue);
+  // The latest entry of the key is either before the lookup key, for a
+  // snapshot older than the entry, or the first entry after it
+  const char* entry =
+      hash_index_ ? hash_index_->Find(key.user_key()) : nullptr;
+  if (entry != nullptr && table_->GetFromEntry(key, entry, &saver, SaveValue)) {
+    TEST_SYNC_POINT("MemTable::GetFromTable:FromEntry");
+  } else {
+    GetTableForRead()->Get(key, &saver, SaveValue);
+  }
   *seq = saver.seq;
 }
 
@@ -1647,6 +1753,101 @@ Status MemTable::UpdateCallback(SequenceNumber seq, const Slice& key,
   return Status::NotFound();
 }
 
+Status MemTable::MergeInPlace(SequenceNumber seq, const Slice& key,
+                              const Slice& operand,
+                              SequenceNumber newest_snapshot,
+                              const ProtectionInfoKVOS64* kv_prot_info) {
+  // A range deletion between the entry and the operand would cover the
+  // entry but not the operand
+  if (!is_range_del_table_empty_.load(std::memory_order_relaxed)) {
+    return Status::NotFound();
+  }
+  LookupKey lkey(key, seq);
+  Slice mem_key = lkey.memtable_key();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), mem_key.data());
+  if (!iter->Valid()) {
+    return Status::NotFound();
+  }
+  // Refer to comments under MemTable::Add() for entry format.
+  const char* entry = iter->key();
+  uint32_t key_length = 0;
+  const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+  if (!comparator_.comparator.user_comparator()->Equal(
+          Slice(key_ptr, key_length - 8), lkey.user_key())) {
+    return Status::NotFound();
+  }
+  const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+  ValueType type;
+  SequenceNumber existing_seq;
+  UnPackSequenceAndType(tag, &existing_seq, &type);
+  // A snapshot may read the entry as it is
+  if (existing_seq <= newest_snapshot ||
+      (type != kTypeMerge && type != kTypeValue)) {
+    return Status::NotFound();
+  }
+
+  Slice prev_value = GetLengthPrefixedSlice(key_ptr + key_length);
+  std::string new_value;
+  if (type == kTypeMerge) {
+    if (!moptions_.merge_operator->PartialMerge(key, prev_value, operand,
+                                                &new_value,
+                                                moptions_.info_log)) {
+      return Status::NotFound();
+    }
+    if (new_value.size() > prev_value.size()) {
+      return Status::NotFound();
+    }
+  } else {
+    ValueType new_value_type;
+    // `op_failure_scope` (an output parameter) is not provided (set to
+    // nullptr) since a failed merge is left to the reads of the operand.
+    Status s = MergeHelper::TimedFullMerge(
+        moptions_.merge_operator, key, MergeHelper::kPlainBaseValue,
+        prev_value, {operand}, moptions_.info_log, moptions_.statistics,
+        clock_, /* update_num_ops_stats */ false,
+        /* op_failure_scope */ nullptr, &new_value,
+        /* result_operand */ nullptr, &new_value_type);
+    if (!s.ok() || new_value_type != kTypeValue) {
+      return Status::NotFound();
+    }
+    if (new_value.size() > prev_value.size()) {
+      // The merged value hides the older one
+      if (kv_prot_info != nullptr) {
+        ProtectionInfoKVOS64 updated_kv_prot_info(*kv_prot_info);
+        updated_kv_prot_info.UpdateV(operand, new_value);
+        updated_kv_prot_info.UpdateO(kTypeMerge, kTypeValue);
+        return Add(seq, kTypeValue, key, new_value, &updated_kv_prot_info);
+      }
+      return Add(seq, kTypeValue, key, new_value, nullptr /* kv_prot_info */);
+    }
+  }
+
+  uint32_t new_size = static_cast<uint32_t>(new_value.size());
+  WriteLock wl(GetLock(lkey.user_key()));
+  char* p = EncodeVarint32(const_cast<char*>(key_ptr) + key_length, new_size);
+  memcpy(p, new_value.data(), new_size);
+  RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+  if (kv_prot_info != nullptr) {
+    ProtectionInfoKVOS64 updated_kv_prot_info(*kv_prot_info);
+    // `seq` is swallowed and `existing_seq` prevails.
+    updated_kv_prot_info.UpdateS(seq, existing_seq);
+    updated_kv_prot_info.UpdateV(operand, new_value);
+    if (type != kTypeMerge) {
+      updated_kv_prot_info.UpdateO(kTypeMerge, type);
+    }
+    UpdateEntryChecksum(&updated_kv_prot_info, key, new_value, type,
+                        existing_seq, p + new_size);
+    Slice encoded(entry, p + new_size - entry);
+    return VerifyEncodedEntry(encoded, updated_kv_prot_info);
+  }
+  UpdateEntryChecksum(nullptr, key, new_value, type, existing_seq,
+                      p + new_size);
+  return Status::OK();
+}
+
 size_t MemTable::CountSuccessiveMergeEntries(const LookupKey& key,
                                              size_t limit) {
   Slice memkey = key.memtable_key();
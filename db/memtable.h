@@ -24,6 +24,7 @@
 #include "db/version_edit.h"
 #include "memory/allocator.h"
 #include "memory/concurrent_arena.h"
+#include "memtable/memtable_hash_index.h"
 #include "monitoring/instrumented_mutex.h"
 #include "options/cf_options.h"
 #include "rocksdb/db.h"
@@ -51,6 +52,7 @@ struct ImmutableMemTableOptions {
   bool memtable_whole_key_filtering;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
+  bool inplace_merge_support;
   UpdateStatus (*inplace_callback)(char* existing_value,
                                    uint32_t* existing_value_size,
                                    Slice delta_value,
@@ -108,11 +110,15 @@ class MemTable {
   // If the earliest sequence number is not known, kMaxSequenceNumber may be
   // used, but this may prevent some transactions from succeeding until the
   // first key is inserted into the memtable.
+  //
+  // The entries are kept in a rep created by table_factory, or by
+  // ioptions.memtable_factory if it is nullptr.
   explicit MemTable(const InternalKeyComparator& comparator,
                     const ImmutableOptions& ioptions,
                     const MutableCFOptions& mutable_cf_options,
                     WriteBufferManager* write_buffer_manager,
-                    SequenceNumber earliest_seq, uint32_t column_family_id);
+                    SequenceNumber earliest_seq, uint32_t column_family_id,
+                    MemTableRepFactory* table_factory = nullptr);
   // No copying allowed
   MemTable(const MemTable&) = delete;
   MemTable& operator=(const MemTable&) = delete;
@@ -153,7 +159,7 @@ class MemTable {
 
   // used by MemTableListVersion::MemoryAllocatedBytesExcludingLast
   size_t MemoryAllocatedBytes() const {
-    return table_->ApproximateMemoryUsage() +
+    return table_->ApproximateMemoryUsage() + FlatTableMemoryUsage() +
            range_del_table_->ApproximateMemoryUsage() +
            arena_.MemoryAllocatedBytes();
   }
@@ -244,6 +250,26 @@ class MemTable {
              MemTablePostProcessInfo* post_process_info = nullptr,
              void** hint = nullptr);
 
+  // Defers the table inserts of the following non-concurrent Add() calls,
+  // except those of range deletions, to FinishSortedInsert(), which inserts
+  // them in key order. A skip list inserts a sorted run several times faster
+  // than the same keys in random order, as each insert moves the splice of
+  // the previous one forward rather than searching from the top. The
+  // entries added in between are not visible to reads, so their sequence
+  // numbers must not be published before FinishSortedInsert().
+  //
+  // Returns false, and defers nothing, if the inserts are already deferred,
+  // or if an insert may read the memtable (inplace_update_support,
+  // max_successive_merges).
+  //
+  // REQUIRES: external synchronization to prevent simultaneous operations on
+  // the same MemTable.
+  bool StartSortedInsert();
+
+  // Returns `Status::TryAgain` as Add() does if the `seq`, `key` combination
+  // of a deferred entry already exists, after inserting the other entries.
+  Status FinishSortedInsert();
+
   // Used to Get value associated with key or Get Merge Operands associated
   // with key.
   // If do_merge = true the default behavior which is Get value for key is
@@ -325,6 +351,21 @@ class MemTable {
                         const Slice& delta,
                         const ProtectionInfoKVOS64* kv_prot_info);
 
+  // If the newest entry of `key` in current memtable is a merge operand or has
+  // type `kTypeValue`, and is newer than `newest_snapshot`, merges `operand`
+  // into it: in-place if the result is not larger than the entry, or else,
+  // onto a `kTypeValue`, as a new value. See inplace_merge_support.
+  //
+  // Returns `Status::NotFound` if `operand` was not merged, e.g. if `key` does
+  // not exist in current memtable or the merge operator cannot merge it, in
+  // which case the caller adds it as a merge operand.
+  //
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable.
+  Status MergeInPlace(SequenceNumber seq, const Slice& key,
+                      const Slice& operand, SequenceNumber newest_snapshot,
+                      const ProtectionInfoKVOS64* kv_prot_info);
+
   // Returns the number of successive merge entries starting from the newest
   // entry for the key. The count ends when the oldest entry in the memtable
   // with which the newest entry would be merged is reached, or the count
@@ -481,6 +522,17 @@ class MemTable {
   // operations on the same MemTable.
   void MarkFlushed() { table_->MarkFlushed(); }
 
+  // Copies the entries of this immutable memtable, in key order, into an
+  // array that the point lookups and the iterators, including the flush's,
+  // then binary search instead of the memtable rep. The entries themselves
+  // stay in the arena. Does nothing if the memtable is flattened already.
+  // REQUIRES: MarkImmutable() was called, and no concurrent Flatten().
+  void Flatten();
+
+  bool IsFlattened() const {
+    return flat_table_.load(std::memory_order_acquire) != nullptr;
+  }
+
   // return true if the current MemTableRep supports merge operator.
   bool IsMergeOperatorSupported() const {
     return table_->IsMergeOperatorSupported();
@@ -577,6 +629,17 @@ class MemTable {
  private:
   enum FlushStateEnum { FLUSH_NOT_REQUESTED, FLUSH_REQUESTED, FLUSH_SCHEDULED };
 
+  // Returns the rep that the reads search
+  MemTableRep* GetTableForRead() const {
+    MemTableRep* flat_table = flat_table_.load(std::memory_order_acquire);
+    return flat_table != nullptr ? flat_table : table_.get();
+  }
+
+  size_t FlatTableMemoryUsage() const {
+    MemTableRep* flat_table = flat_table_.load(std::memory_order_acquire);
+    return flat_table != nullptr ? flat_table->ApproximateMemoryUsage() : 0;
+  }
+
   friend class MemTableIterator;
   friend class MemTableBackwardIterator;
   friend class MemTableList;
@@ -590,6 +653,9 @@ class MemTable {
   std::unique_ptr<MemTableRep> table_;
   std::unique_ptr<MemTableRep> range_del_table_;
   std::atomic_bool is_range_del_table_empty_;
+  // The sorted array made by Flatten(), published through flat_table_
+  std::unique_ptr<MemTableRep> flat_table_owner_;
+  std::atomic<MemTableRep*> flat_table_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
@@ -632,6 +698,8 @@ class MemTable {
 
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> bloom_filter_;
+  // Latest entry of each key, for GetFromTable() to start from
+  std::unique_ptr<MemTableHashIndex> hash_index_;
 
   std::atomic<FlushStateEnum> flush_state_;
 
@@ -643,6 +711,11 @@ class MemTable {
   // Insert hints for each prefix.
   UnorderedMapH<Slice, void*, SliceHasher32> insert_hints_;
 
+  // Whether the table inserts of Add() are deferred to FinishSortedInsert()
+  bool sorted_insert_ = false;
+  // The entries of the deferred inserts, with their handles
+  std::vector<std::pair<const char*, KeyHandle>> sorted_insert_entries_;
+
   // Timestamp of oldest key
   std::atomic<uint64_t> oldest_key_time_;
 
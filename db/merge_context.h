@@ -30,6 +30,30 @@ class MergeContext {
       operand_list_->clear();
       copied_operands_->clear();
     }
+    num_copied_operands_ = 0;
+  }
+
+  // Clears the operands like Clear(), but keeps the memory of the operand
+  // list and of the copies of unpinned operands to hold the next ones, for
+  // a MergeContext reused across lookups. Memory beyond a few small
+  // operands is released.
+  void ClearForReuse() {
+    get_merge_operands_options = nullptr;
+    num_copied_operands_ = 0;
+    if (!operand_list_) {
+      return;
+    }
+    operand_list_->clear();
+    if (operand_list_->capacity() > kMaxReusedOperands) {
+      operand_list_.reset();
+      copied_operands_.reset();
+      return;
+    }
+    for (auto& copy : *copied_operands_) {
+      if (copy->capacity() > kMaxReusedOperandSize) {
+        std::string().swap(*copy);
+      }
+    }
   }
 
   // Push a merge operand
@@ -41,9 +65,7 @@ class MergeContext {
       operand_list_->push_back(operand_slice);
     } else {
       // We need to have our own copy of the operand since it's not pinned
-      copied_operands_->emplace_back(
-          new std::string(operand_slice.data(), operand_slice.size()));
-      operand_list_->push_back(*copied_operands_->back());
+      operand_list_->push_back(CopyOperand(operand_slice));
     }
   }
 
@@ -57,9 +79,7 @@ class MergeContext {
       operand_list_->push_back(operand_slice);
     } else {
       // We need to have our own copy of the operand since it's not pinned
-      copied_operands_->emplace_back(
-          new std::string(operand_slice.data(), operand_slice.size()));
-      operand_list_->push_back(*copied_operands_->back());
+      operand_list_->push_back(CopyOperand(operand_slice));
     }
   }
 
@@ -119,10 +139,26 @@ class MergeContext {
   }
 
  private:
+  // Limits of the memory kept by ClearForReuse()
+  static constexpr size_t kMaxReusedOperands = 64;
+  static constexpr size_t kMaxReusedOperandSize = 1024;
+
+  // Copies an unpinned operand into the next copy, reusing the ones left by
+  // ClearForReuse()
+  Slice CopyOperand(const Slice& operand_slice) {
+    if (num_copied_operands_ == copied_operands_->size()) {
+      copied_operands_->emplace_back(new std::string());
+    }
+    std::string* copy = (*copied_operands_)[num_copied_operands_++].get();
+    copy->assign(operand_slice.data(), operand_slice.size());
+    return *copy;
+  }
+
   void Initialize() {
     if (!operand_list_) {
       operand_list_.reset(new std::vector<Slice>());
       copied_operands_.reset(new std::vector<std::unique_ptr<std::string>>());
+      num_copied_operands_ = 0;
     }
   }
 
@@ -144,6 +180,8 @@ class MergeContext {
   mutable std::unique_ptr<std::vector<Slice>> operand_list_;
   // Copy of operands that are not pinned.
   std::unique_ptr<std::vector<std::unique_ptr<std::string>>> copied_operands_;
+  // The copies in copied_operands_ in use, the others are kept for reuse
+  size_t num_copied_operands_ = 0;
   mutable bool operands_reversed_ = true;
 };
 
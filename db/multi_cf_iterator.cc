@@ -5,19 +5,64 @@
 
 #include "db/multi_cf_iterator.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 
+#include "port/port.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+
 namespace ROCKSDB_NAMESPACE {
 
+void MultiCfIterator::SeekChildrenInParallel(
+    const std::function<void(Iterator*)>& child_seek_func) {
+  std::atomic<size_t> next_child{0};
+  auto seek = [&]() {
+    for (size_t i = next_child.fetch_add(1); i < cfh_iter_pairs_.size();
+         i = next_child.fetch_add(1)) {
+      child_seek_func(cfh_iter_pairs_[i].second.get());
+    }
+  };
+
+  const size_t num_helpers = std::min<size_t>(
+      cfh_iter_pairs_.size() - 1,
+      static_cast<size_t>(seek_pool_->GetBackgroundThreads()));
+  port::Mutex helpers_mutex;
+  port::CondVar helpers_cv(&helpers_mutex);
+  size_t running_helpers = num_helpers;
+  for (size_t i = 0; i < num_helpers; ++i) {
+    seek_pool_->SubmitJob([&]() {
+      TEST_SYNC_POINT("MultiCfIterator::SeekChildrenInParallel:Helper");
+      seek();
+      MutexLock l(&helpers_mutex);
+      if (--running_helpers == 0) {
+        helpers_cv.SignalAll();
+      }
+    });
+  }
+  seek();
+  MutexLock l(&helpers_mutex);
+  while (running_helpers > 0) {
+    helpers_cv.Wait();
+  }
+}
+
 template <typename BinaryHeap, typename ChildSeekFuncType>
 void MultiCfIterator::SeekCommon(BinaryHeap& heap,
                                  ChildSeekFuncType child_seek_func) {
   heap.clear();
+  if (seek_pool_ != nullptr && cfh_iter_pairs_.size() > 1) {
+    SeekChildrenInParallel(child_seek_func);
+  } else {
+    for (auto& cfh_iter_pair : cfh_iter_pairs_) {
+      child_seek_func(cfh_iter_pair.second.get());
+    }
+  }
   int i = 0;
   for (auto& cfh_iter_pair : cfh_iter_pairs_) {
     auto& cfh = cfh_iter_pair.first;
     auto& iter = cfh_iter_pair.second;
-    child_seek_func(iter.get());
     if (iter->Valid()) {
       assert(iter->status().ok());
       heap.push(MultiCfIteratorInfo{iter.get(), cfh, i});
@@ -31,34 +76,30 @@ void MultiCfIterator::SeekCommon(BinaryHeap& heap,
 template <typename BinaryHeap, typename AdvanceFuncType>
 void MultiCfIterator::AdvanceIterator(BinaryHeap& heap,
                                       AdvanceFuncType advance_func) {
-  // 1. Keep the top iterator (by popping it from the heap)
-  // 2. Make sure all others have iterated past the top iterator key slice
-  // 3. Advance the top iterator, and add it back to the heap if valid
-  auto top = heap.top();
-  heap.pop();
-  if (!heap.empty()) {
+  // 1. Advance the top iterator in place. While it stays ahead of the
+  //    others, the heap only compares it with the one it cached as next, so
+  //    a run of keys from one column family doesn't rebalance the heap.
+  // 2. Advance the others that were at the same key, which are then on top
+  const bool check_same_key = heap.size() > 1;
+  if (check_same_key) {
+    const Slice top_key = heap.top().iterator->key();
+    prev_key_.assign(top_key.data(), top_key.size());
+  }
+  auto advance_top = [&]() {
     auto* current = heap.top().iterator;
-    while (current->Valid() &&
-           comparator_->Compare(top.iterator->key(), current->key()) == 0) {
+    advance_func(current);
+    if (current->Valid()) {
       assert(current->status().ok());
-      advance_func(current);
-      if (current->Valid()) {
-        heap.replace_top(heap.top());
-      } else {
-        considerStatus(current->status());
-        heap.pop();
-      }
-      if (!heap.empty()) {
-        current = heap.top().iterator;
-      }
+      heap.replace_top(heap.top());
+    } else {
+      considerStatus(current->status());
+      heap.pop();
     }
-  }
-  advance_func(top.iterator);
-  if (top.iterator->Valid()) {
-    assert(top.iterator->status().ok());
-    heap.push(top);
-  } else {
-    considerStatus(top.iterator->status());
+  };
+  advance_top();
+  while (check_same_key && !heap.empty() &&
+         comparator_->Compare(heap.top().iterator->key(), prev_key_) == 0) {
+    advance_top();
   }
 }
 
@@ -5,11 +5,13 @@
 
 #pragma once
 
+#include <functional>
 #include <variant>
 
 #include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
+#include "rocksdb/threadpool.h"
 #include "util/heap.h"
 #include "util/overload.h"
 
@@ -20,12 +22,16 @@ namespace ROCKSDB_NAMESPACE {
 // When the same key exists in more than one column families, the iterator
 // selects the value from the first column family containing the key, in the
 // order provided in the `column_families` parameter.
+// With a `seek_pool`, the child iterators are sought in parallel on its
+// threads and the calling one.
 class MultiCfIterator : public Iterator {
  public:
   MultiCfIterator(const Comparator* comparator,
                   const std::vector<ColumnFamilyHandle*>& column_families,
-                  const std::vector<Iterator*>& child_iterators)
-      : comparator_(comparator),
+                  const std::vector<Iterator*>& child_iterators,
+                  ThreadPool* seek_pool = nullptr)
+      : seek_pool_(seek_pool),
+        comparator_(comparator),
         heap_(MultiCfMinHeap(
             MultiCfHeapItemComparator<std::greater<int>>(comparator_))) {
     assert(column_families.size() > 0 &&
@@ -45,8 +51,11 @@ class MultiCfIterator : public Iterator {
  private:
   std::vector<std::pair<ColumnFamilyHandle*, std::unique_ptr<Iterator>>>
       cfh_iter_pairs_;
+  ThreadPool* const seek_pool_;
   ReadOptions read_options_;
   Status status_;
+  // The key the iterator was at before advancing
+  std::string prev_key_;
 
   AttributeGroups attribute_groups_;
 
@@ -143,6 +152,8 @@ class MultiCfIterator : public Iterator {
         MultiCfHeapItemComparator<std::less<int>>(comparator_));
   }
 
+  void SeekChildrenInParallel(
+      const std::function<void(Iterator*)>& child_seek_func);
   template <typename BinaryHeap, typename ChildSeekFuncType>
   void SeekCommon(BinaryHeap& heap, ChildSeekFuncType child_seek_func);
   template <typename BinaryHeap, typename AdvanceFuncType>
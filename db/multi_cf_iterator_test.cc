@@ -215,6 +215,60 @@ TEST_F(MultiCfIteratorTest, SimpleValues) {
   }
 }
 
+TEST_F(MultiCfIteratorTest, ParallelSeeks) {
+  Options options = GetDefaultOptions();
+  options.multi_cf_iterator_seek_threads = 3;
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"cf_1", "cf_2", "cf_3", "cf_4"}, options);
+
+  std::atomic<int> helper_seeks{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "MultiCfIterator::SeekChildrenInParallel:Helper",
+      [&](void* /*arg*/) { helper_seeks++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Runs of keys from one CF, and keys in more than one CF. The value comes
+  // from the first CF in the order given that has the key.
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (int i = 0; i < 40; ++i) {
+    const int cf = (i / 4) % 5;
+    keys.push_back("key_" + std::to_string(100 + i));
+    values.push_back(keys.back() + "_cf_" + std::to_string(cf));
+    ASSERT_OK(Put(cf, keys.back(), values.back()));
+    if (i % 3 == 0 && cf < 4) {
+      ASSERT_OK(Put(cf + 1, keys.back(), "shadowed"));
+    }
+  }
+  ASSERT_OK(Flush(2));
+  std::vector<ColumnFamilyHandle*> cfhs = {handles_[0], handles_[1],
+                                           handles_[2], handles_[3],
+                                           handles_[4]};
+  std::vector<Slice> expected_keys(keys.begin(), keys.end());
+  std::vector<Slice> expected_values(values.begin(), values.end());
+  verifyMultiCfIterator(cfhs, expected_keys, expected_values);
+  ASSERT_GT(helper_seeks.load(), 0);
+
+  std::unique_ptr<Iterator> iter =
+      db_->NewMultiCfIterator(ReadOptions(), cfhs);
+  iter->Seek("key_117");
+  ASSERT_EQ(IterStatus(iter.get()), "key_117->" + values[17]);
+  iter->Next();
+  ASSERT_EQ(IterStatus(iter.get()), "key_118->" + values[18]);
+  iter->SeekForPrev("key_130x");
+  ASSERT_EQ(IterStatus(iter.get()), "key_130->" + values[30]);
+  iter->Prev();
+  ASSERT_EQ(IterStatus(iter.get()), "key_129->" + values[29]);
+  iter->Next();
+  iter->Next();
+  ASSERT_EQ(IterStatus(iter.get()), "key_131->" + values[31]);
+  ASSERT_OK(iter->status());
+  iter.reset();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(MultiCfIteratorTest, EmptyCfs) {
   Options options = GetDefaultOptions();
   {
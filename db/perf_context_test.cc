@@ -1138,6 +1138,52 @@ TEST_F(PerfContextTest, WriteMemtableTimePerfLevel) {
   ASSERT_EQ(perf_context.write_memtable_time, 0);
 }
 
+TEST_F(PerfContextTest, PerfSampling) {
+  ASSERT_OK(DestroyDB(kDbName, Options()));
+  Options options;
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  options.perf_sample_one_in = 4;
+  DB* db_ptr;
+  ASSERT_OK(DB::Open(options, kDbName, &db_ptr));
+  std::unique_ptr<DB> db(db_ptr);
+
+  SetPerfLevel(PerfLevel::kEnableCount);
+  get_perf_context()->Reset();
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_OK(db->Put(WriteOptions(), "k" + std::to_string(i), "v"));
+  }
+  ASSERT_OK(db->Flush(FlushOptions()));
+  std::string value;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_OK(db->Get(ReadOptions(), "k" + std::to_string(i), &value));
+  }
+
+  // One in four of the operations are sampled...
+  HistogramData data;
+  options.statistics->histogramData(SAMPLED_WRITE_WAL_MICROS, &data);
+  ASSERT_EQ(data.count, 5u);
+  options.statistics->histogramData(SAMPLED_WRITE_MEMTABLE_MICROS, &data);
+  ASSERT_EQ(data.count, 5u);
+  options.statistics->histogramData(SAMPLED_GET_FROM_FILES_MICROS, &data);
+  ASSERT_EQ(data.count, 5u);
+  // ...without changing the perf context of the thread
+  ASSERT_EQ(perf_context.write_wal_time, 0u);
+  ASSERT_EQ(perf_context.write_memtable_time, 0u);
+  ASSERT_EQ(perf_context.get_from_output_files_time, 0u);
+  ASSERT_EQ(GetPerfLevel(), PerfLevel::kEnableCount);
+
+  // A thread timing its operations is not sampled
+  SetPerfLevel(PerfLevel::kEnableTimeExceptForMutex);
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_OK(db->Put(WriteOptions(), "k" + std::to_string(i), "v"));
+  }
+  ASSERT_GT(perf_context.write_memtable_time, 0u);
+  options.statistics->histogramData(SAMPLED_WRITE_MEMTABLE_MICROS, &data);
+  ASSERT_EQ(data.count, 5u);
+  SetPerfLevel(PerfLevel::kEnableCount);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
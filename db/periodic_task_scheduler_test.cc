@@ -8,6 +8,7 @@
 
 #include "db/db_test_util.h"
 #include "env/composite_env_wrapper.h"
+#include "rocksdb/stats_exporter.h"
 #include "test_util/mock_time_env.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -219,6 +220,73 @@ TEST_F(PeriodicTaskSchedulerTest, MultiEnv) {
   Close();
 }
 
+TEST_F(PeriodicTaskSchedulerTest, ExportStats) {
+  // Keeps the exported snapshots
+  class TestExporter : public StatsExporter {
+   public:
+    const char* Name() const override { return "TestExporter"; }
+    void Export(const std::string& /*db_name*/,
+                const ExportedStats& stats) override {
+      exported.push_back(stats);
+    }
+    std::vector<ExportedStats> exported;
+  };
+
+  constexpr unsigned int kPeriodSec = 10;
+  Close();
+  auto exporter = std::make_shared<TestExporter>();
+  Options options;
+  options.stats_dump_period_sec = 0;
+  options.stats_persist_period_sec = 0;
+  options.stats_exporter = exporter;
+  options.stats_export_period_sec = kPeriodSec;
+  options.statistics = CreateDBStatistics();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.env = mock_env_.get();
+  Reopen(options);
+
+  const PeriodicTaskScheduler& scheduler =
+      dbfull()->TEST_GetPeriodicTaskScheduler();
+  ASSERT_EQ(2, scheduler.TEST_GetValidTaskNum());
+
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b", "2"));
+  ASSERT_OK(Flush());
+  dbfull()->TEST_WaitForPeriodicTaskRun([&] {
+    mock_clock_->MockSleepForSeconds(static_cast<int>(kPeriodSec) - 1);
+  });
+  ASSERT_EQ(1u, exporter->exported.size());
+  ASSERT_EQ(0u, exporter->exported[0].interval_micros);
+  ASSERT_EQ(1u, exporter->exported[0].int_properties.count(
+                    DB::Properties::kLiveSstFilesSize));
+
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  dbfull()->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(static_cast<int>(kPeriodSec)); });
+  ASSERT_EQ(2u, exporter->exported.size());
+  ASSERT_EQ(kPeriodSec * 1000000u, exporter->exported[1].interval_micros);
+
+  // The snapshots have the counts since the previous one, which add up to
+  // the totals
+  uint64_t keys_written = 0;
+  uint64_t flushes = 0;
+  uint64_t compactions = 0;
+  for (const auto& stats : exporter->exported) {
+    keys_written +=
+        stats.tickers.at(TickersNameMap[NUMBER_KEYS_WRITTEN].second);
+    flushes += stats.histograms.at(HistogramsNameMap[FLUSH_TIME].second).count;
+    for (const auto& level : stats.compactions.at(kDefaultColumnFamilyName)) {
+      compactions += level.count;
+    }
+  }
+  ASSERT_EQ(2u, keys_written);
+  ASSERT_EQ(2u, flushes);
+  ASSERT_EQ(1u, compactions);
+  Close();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
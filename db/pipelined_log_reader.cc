@@ -0,0 +1,149 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/pipelined_log_reader.h"
+
+#include <algorithm>
+
+#include "monitoring/iostats_context_imp.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The number of batches the reader thread may queue up
+constexpr size_t kMaxBatches = 4;
+}  // namespace
+
+PipelinedLogReader::PipelinedLogReader(
+    std::shared_ptr<Logger> info_log,
+    std::unique_ptr<SequentialFileReader>&& file,
+    log::Reader::Reporter* reporter, bool checksum, uint64_t log_num,
+    WALRecoveryMode wal_recovery_mode, size_t max_buffered_bytes)
+    : reporter_(reporter),
+      wal_recovery_mode_(wal_recovery_mode),
+      batch_bytes_(std::max<size_t>(max_buffered_bytes / kMaxBatches, 1)),
+      queue_(kMaxBatches),
+      stop_(false),
+      pos_(0) {
+  reader_.reset(new log::Reader(
+      std::move(info_log), std::move(file),
+      max_buffered_bytes > 0 ? &queueing_reporter_ : reporter, checksum,
+      log_num));
+  if (max_buffered_bytes > 0) {
+    reader_thread_ = port::Thread(&PipelinedLogReader::ReadRecords, this);
+  }
+}
+
+PipelinedLogReader::~PipelinedLogReader() {
+  if (!reader_thread_.joinable()) {
+    return;
+  }
+  stop_.store(true, std::memory_order_relaxed);
+  queue_.finish();
+  reader_thread_.join();
+  Batch* batch = nullptr;
+  while (queue_.pop(batch)) {
+    std::unique_ptr<Batch> dropped(batch);
+    IOSTATS_ADD(bytes_read, dropped->bytes_read);
+  }
+}
+
+bool PipelinedLogReader::ReadRecord(Slice* record, std::string* scratch,
+                                    uint64_t* record_checksum) {
+  if (!reader_thread_.joinable()) {
+    return reader_->ReadRecord(record, scratch, wal_recovery_mode_,
+                               record_checksum);
+  }
+  while (true) {
+    if (current_ == nullptr || pos_ == current_->events.size()) {
+      if (current_ != nullptr && current_->last) {
+        return false;
+      }
+      Batch* batch = nullptr;
+      // The reader thread queues a last batch before it exits on its own
+      bool popped = queue_.pop(batch);
+      assert(popped);
+      (void)popped;
+      current_.reset(batch);
+      pos_ = 0;
+      IOSTATS_ADD(bytes_read, batch->bytes_read);
+      continue;
+    }
+    const Event& event = current_->events[pos_++];
+    switch (event.type) {
+      case Event::kRecord:
+        *record = Slice(current_->data.data() + event.offset, event.size);
+        if (record_checksum != nullptr) {
+          *record_checksum = event.checksum;
+        }
+        return true;
+      case Event::kCorruption:
+        if (reporter_ != nullptr) {
+          reporter_->Corruption(event.size, event.status);
+        }
+        break;
+      case Event::kOldLogRecord:
+        if (reporter_ != nullptr) {
+          reporter_->OldLogRecord(event.size);
+        }
+        break;
+      case Event::kTimestampSize:
+        recorded_ts_sz_.insert(
+            {static_cast<uint32_t>(event.checksum), event.size});
+        break;
+    }
+  }
+}
+
+void PipelinedLogReader::ReadRecords() {
+  std::string scratch;
+  size_t num_recorded_ts_sz = 0;
+  UnorderedMap<uint32_t, size_t> sent_ts_sz;
+  while (true) {
+    std::unique_ptr<Batch> batch(new Batch);
+    queueing_reporter_.batch = batch.get();
+    while (batch->data.size() < batch_bytes_ &&
+           !stop_.load(std::memory_order_relaxed)) {
+      Slice record;
+      uint64_t checksum = 0;
+      if (!reader_->ReadRecord(&record, &scratch, wal_recovery_mode_,
+                               &checksum)) {
+        batch->last = true;
+        break;
+      }
+      // The recorded timestamp sizes only grow, one column family at a time
+      const auto& recorded_ts_sz = reader_->GetRecordedTimestampSize();
+      if (recorded_ts_sz.size() != num_recorded_ts_sz) {
+        for (const auto& ts_sz : recorded_ts_sz) {
+          if (sent_ts_sz.insert(ts_sz).second) {
+            batch->events.push_back(
+                {Event::kTimestampSize, 0, ts_sz.second, ts_sz.first,
+                 Status::OK()});
+          }
+        }
+        num_recorded_ts_sz = recorded_ts_sz.size();
+      }
+      batch->events.push_back({Event::kRecord, batch->data.size(),
+                               record.size(), checksum, Status::OK()});
+      batch->data.append(record.data(), record.size());
+    }
+    batch->bytes_read = IOSTATS(bytes_read);
+    IOSTATS_RESET(bytes_read);
+    TEST_SYNC_POINT("PipelinedLogReader::ReadRecords:BatchReady");
+
+    const bool last = batch->last;
+    if (!queue_.push(batch.get())) {
+      // Stopped
+      return;
+    }
+    batch.release();
+    if (last) {
+      return;
+    }
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
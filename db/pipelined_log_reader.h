@@ -0,0 +1,116 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/log_reader.h"
+#include "port/port.h"
+#include "util/work_queue.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Reads the records of a WAL with a log::Reader, optionally on a separate
+// thread. With a non-zero `max_buffered_bytes`, the reader thread reads,
+// checksums and decompresses the records and queues up to that many bytes of
+// them ahead of the thread that calls ReadRecord(), which only ever waits for
+// a whole batch. The corruptions and old records that the log::Reader
+// reports on the reader thread are passed on to `reporter` from
+// ReadRecord(), in their order among the records, so the caller sees the
+// same calls in the same order as without the pipeline.
+//
+// With `max_buffered_bytes` == 0, ReadRecord() calls the log::Reader
+// directly.
+class PipelinedLogReader {
+ public:
+  PipelinedLogReader(std::shared_ptr<Logger> info_log,
+                     std::unique_ptr<SequentialFileReader>&& file,
+                     log::Reader::Reporter* reporter, bool checksum,
+                     uint64_t log_num, WALRecoveryMode wal_recovery_mode,
+                     size_t max_buffered_bytes);
+  // Stops the reader thread
+  ~PipelinedLogReader();
+
+  // No copying allowed
+  PipelinedLogReader(const PipelinedLogReader&) = delete;
+  void operator=(const PipelinedLogReader&) = delete;
+
+  // Like log::Reader::ReadRecord(). The contents of *record are valid until
+  // the next call.
+  bool ReadRecord(Slice* record, std::string* scratch,
+                  uint64_t* record_checksum);
+
+  // Like log::Reader::GetRecordedTimestampSize(), as of the record returned
+  // last
+  const UnorderedMap<uint32_t, size_t>& GetRecordedTimestampSize() const {
+    return reader_thread_.joinable() ? recorded_ts_sz_
+                                     : reader_->GetRecordedTimestampSize();
+  }
+
+ private:
+  // A record, a report of the log::Reader, or a timestamp size it recorded
+  struct Event {
+    enum Type : char {
+      kRecord,
+      kCorruption,
+      kOldLogRecord,
+      kTimestampSize,
+    };
+    Type type;
+    // kRecord: the record is data[offset, offset + size), with checksum.
+    // kCorruption and kOldLogRecord: size is the bytes dropped.
+    // kTimestampSize: the timestamp size of column family checksum is size.
+    size_t offset;
+    size_t size;
+    uint64_t checksum;
+    Status status;
+  };
+
+  struct Batch {
+    std::string data;
+    std::vector<Event> events;
+    // The bytes read from the WAL while filling the batch
+    uint64_t bytes_read = 0;
+    // Whether the WAL ended after this batch
+    bool last = false;
+  };
+
+  // Adds the reports of the log::Reader to the batch the reader thread fills
+  class QueueingReporter : public log::Reader::Reporter {
+   public:
+    void Corruption(size_t bytes, const Status& status) override {
+      batch->events.push_back({Event::kCorruption, 0, bytes, 0, status});
+    }
+    void OldLogRecord(size_t bytes) override {
+      batch->events.push_back(
+          {Event::kOldLogRecord, 0, bytes, 0, Status::OK()});
+    }
+
+    Batch* batch = nullptr;
+  };
+
+  void ReadRecords();
+
+  log::Reader::Reporter* const reporter_;
+  const WALRecoveryMode wal_recovery_mode_;
+  const size_t batch_bytes_;
+  QueueingReporter queueing_reporter_;
+  std::unique_ptr<log::Reader> reader_;
+
+  WorkQueue<Batch*> queue_;
+  port::Thread reader_thread_;
+  // Tells the reader thread to stop before reading another record
+  std::atomic<bool> stop_;
+
+  std::unique_ptr<Batch> current_;
+  size_t pos_;
+  UnorderedMap<uint32_t, size_t> recorded_ts_sz_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,130 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/pipelined_log_reader.h"
+
+#include "db/log_writer.h"
+#include "file/writable_file_writer.h"
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class PipelinedLogReaderTest : public testing::Test {
+ protected:
+  // Records the reports, in order among the records
+  struct Reporter : public log::Reader::Reporter {
+    std::vector<std::string>* trace = nullptr;
+    void Corruption(size_t bytes, const Status& status) override {
+      trace->push_back("corruption " + std::to_string(bytes) + " " +
+                       status.ToString());
+    }
+    void OldLogRecord(size_t bytes) override {
+      trace->push_back("old " + std::to_string(bytes));
+    }
+  };
+
+  void Write(const std::string& record,
+             const UnorderedMap<uint32_t, size_t>* cf_to_ts_sz = nullptr) {
+    if (writer_ == nullptr) {
+      auto sink = new test::StringSink();
+      sink_ = sink;
+      std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+          std::unique_ptr<FSWritableFile>(sink), "" /* don't care */,
+          FileOptions()));
+      writer_.reset(new log::Writer(std::move(file_writer), 7 /* log_number */,
+                                    false /* recycle_log_files */));
+    }
+    if (cf_to_ts_sz != nullptr) {
+      ASSERT_OK(writer_->MaybeAddUserDefinedTimestampSizeRecord(WriteOptions(),
+                                                                *cf_to_ts_sz));
+    }
+    ASSERT_OK(writer_->AddRecord(WriteOptions(), record));
+  }
+
+  std::string& Contents() { return sink_->contents_; }
+
+  // Returns the records, reports and timestamp sizes of reading the WAL, and
+  // stops after max_records records
+  std::vector<std::string> Read(size_t max_buffered_bytes,
+                                WALRecoveryMode wal_recovery_mode,
+                                size_t max_records = SIZE_MAX) {
+    std::vector<std::string> trace;
+    Reporter reporter;
+    reporter.trace = &trace;
+    std::atomic<int> read_count{0};
+    std::unique_ptr<SequentialFileReader> file_reader(new SequentialFileReader(
+        std::make_unique<test::SeqStringSource>(Contents(), &read_count),
+        "" /* file name */));
+    PipelinedLogReader reader(nullptr, std::move(file_reader), &reporter,
+                              true /* checksum */, 7 /* log_num */,
+                              wal_recovery_mode, max_buffered_bytes);
+    Slice record;
+    std::string scratch;
+    uint64_t checksum = 0;
+    for (size_t i = 0;
+         i < max_records && reader.ReadRecord(&record, &scratch, &checksum);
+         i++) {
+      trace.push_back("record " + record.ToString() + " " +
+                      std::to_string(checksum) + " ts_sz " +
+                      std::to_string(reader.GetRecordedTimestampSize().size()));
+    }
+    return trace;
+  }
+
+  test::StringSink* sink_ = nullptr;
+  std::unique_ptr<log::Writer> writer_;
+};
+
+TEST_F(PipelinedLogReaderTest, SameAsReader) {
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    // Some records span blocks
+    Write(rnd.RandomString(i % 7 == 0 ? 50000 : 100));
+    if (i == 10 || i == 150) {
+      UnorderedMap<uint32_t, size_t> cf_to_ts_sz{
+          {static_cast<uint32_t>(i), 8}};
+      Write("with timestamp size", &cf_to_ts_sz);
+    }
+  }
+  const auto expected =
+      Read(0, WALRecoveryMode::kTolerateCorruptedTailRecords);
+  ASSERT_EQ(expected.size(), 202u);
+  for (size_t max_buffered_bytes : {1, 1000, 1 << 20}) {
+    ASSERT_EQ(expected,
+              Read(max_buffered_bytes,
+                   WALRecoveryMode::kTolerateCorruptedTailRecords));
+  }
+
+  // The reports come in their place among the records
+  Contents()[Contents().size() / 2] ^= 0x55;
+  for (auto mode : {WALRecoveryMode::kTolerateCorruptedTailRecords,
+                    WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    const auto corrupted = Read(0, mode);
+    ASSERT_NE(expected, corrupted);
+    ASSERT_EQ(corrupted, Read(1000, mode));
+  }
+}
+
+TEST_F(PipelinedLogReaderTest, StopEarly) {
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    Write(rnd.RandomString(1000));
+  }
+  // The reader thread is stopped while it waits for room in the queue
+  const auto trace =
+      Read(4000, WALRecoveryMode::kTolerateCorruptedTailRecords, 3);
+  ASSERT_EQ(trace.size(), 3u);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
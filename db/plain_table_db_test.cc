@@ -1250,6 +1250,42 @@ TEST_P(PlainTableDBTest, NonExistingKeyToNonEmptyBucket) {
   delete iter;
 }
 
+TEST_P(PlainTableDBTest, MultiGet) {
+  for (int bloom_bits : {0, 10}) {
+    // One bucket for all the prefixes, or about one per prefix
+    for (double hash_table_ratio : {0.0, 0.75}) {
+      Options options = CurrentOptions();
+      PlainTableOptions plain_table_options;
+      plain_table_options.user_key_len = 16;
+      plain_table_options.bloom_bits_per_key = bloom_bits;
+      plain_table_options.hash_table_ratio = hash_table_ratio;
+      plain_table_options.index_sparseness = 2;
+      options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+      DestroyAndReopen(&options);
+
+      // 5 prefixes of 8 keys, and keys of the same and of other prefixes
+      // that don't exist
+      std::vector<std::string> keys;
+      for (int i = 0; i < 56; i++) {
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%08d%08d", i % 7, i);
+        keys.emplace_back(buf);
+        if (i < 40 || i % 7 < 5) {
+          ASSERT_OK(Put(keys.back(), "v" + std::to_string(i)));
+        }
+      }
+      ASSERT_OK(dbfull()->TEST_FlushMemTable());
+
+      std::vector<Slice> key_slices(keys.begin(), keys.end());
+      std::vector<std::string> values;
+      auto statuses = dbfull()->MultiGet(ReadOptions(), key_slices, &values);
+      for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(Get(keys[i]), statuses[i].ok() ? values[i] : "NOT_FOUND");
+      }
+    }
+  }
+}
+
 static std::string Key(int i) {
   char buf[100];
   snprintf(buf, sizeof(buf), "key_______%06d", i);
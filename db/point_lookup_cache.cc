@@ -0,0 +1,97 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/point_lookup_cache.h"
+
+#include <algorithm>
+
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+PointLookupCache::PointLookupCache(std::shared_ptr<Cache> cache)
+    : cache_(std::move(cache)),
+      slots_(new std::atomic<SequenceNumber>[size_t{1} << kNumSlotsBits]) {
+  assert(cache_);
+  // If the same cache is shared by multiple instances, we need to
+  // disambiguate its entries.
+  PutVarint64(&cache_id_, cache_->NewId());
+  for (size_t i = 0; i < (size_t{1} << kNumSlotsBits); i++) {
+    slots_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t PointLookupCache::SlotIndex(uint32_t cf_id,
+                                   const Slice& user_key) const {
+  return static_cast<size_t>(GetSliceNPHash64(user_key, cf_id) >>
+                             (64 - kNumSlotsBits));
+}
+
+void PointLookupCache::MakeCacheKey(uint32_t cf_id, const Slice& user_key,
+                                    std::string* key) const {
+  key->reserve(cache_id_.size() + 5 + user_key.size());
+  key->assign(cache_id_);
+  PutVarint32(key, cf_id);
+  key->append(user_key.data(), user_key.size());
+}
+
+bool PointLookupCache::Lookup(uint32_t cf_id, const Slice& user_key,
+                              SequenceNumber snapshot, PinnableSlice* value,
+                              Status* s) {
+  std::string key;
+  MakeCacheKey(cf_id, user_key, &key);
+  CacheInterface cache{cache_.get()};
+  auto handle = cache.Lookup(key);
+  if (handle == nullptr) {
+    return false;
+  }
+  const Entry* entry = cache.Value(handle);
+  // The latest write to the key is visible both at the cached read and at
+  // this one, so both have the same result. The snapshot is published, so
+  // the writes up to it have been recorded.
+  const SequenceNumber visible = std::min(snapshot, entry->read_seq);
+  bool hit = entry->epoch == GetEpoch() &&
+             range_seq_.load(std::memory_order_acquire) <= visible &&
+             slots_[SlotIndex(cf_id, user_key)].load(
+                 std::memory_order_acquire) <= visible;
+  if (!hit) {
+    cache_->Release(handle);
+    return false;
+  }
+  if (entry->found) {
+    *s = Status::OK();
+    // The value stays on the cache until it is reset
+    value->PinSlice(entry->value, nullptr);
+    cache.RegisterReleaseAsCleanup(handle, *value);
+  } else {
+    *s = Status::NotFound();
+    cache_->Release(handle);
+  }
+  return true;
+}
+
+void PointLookupCache::Insert(uint32_t cf_id, const Slice& user_key,
+                              SequenceNumber snapshot, uint64_t epoch,
+                              const Status& s, const Slice& value) {
+  if (!s.ok() && !s.IsNotFound()) {
+    return;
+  }
+  std::string key;
+  MakeCacheKey(cf_id, user_key, &key);
+  auto entry = new Entry{snapshot, epoch, s.ok(),
+                         s.ok() ? value.ToString() : std::string()};
+  const size_t charge = sizeof(Entry) + key.size() + entry->value.capacity();
+  CacheInterface cache{cache_.get()};
+  Status cs = cache.Insert(key, entry, charge);
+  if (!cs.ok()) {
+    // If the cache is full, it's OK to continue, but we keep ownership of
+    // the entry.
+    delete entry;
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,96 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "cache/typed_cache.h"
+#include "db/dbformat.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class PinnableSlice;
+
+// The results of DB::Get() (DBOptions::point_lookup_cache), keyed by column
+// family and user key. Each result remembers the sequence number it was read
+// at, and is valid for a read at another sequence number when no write to
+// the key falls between the two.
+//
+// The write path records the sequence number of each write in a fixed
+// table of atomic sequence numbers indexed by a hash of the key, before the
+// write is published, so a lookup needs no lock besides the cache's own.
+// Keys sharing a slot invalidate each other's results. Range deletions
+// invalidate every result through one more sequence number, and changes that
+// bypass the write path, such as file ingestion, through an epoch.
+class PointLookupCache {
+ public:
+  explicit PointLookupCache(std::shared_ptr<Cache> cache);
+
+  // Called by the write path before a write of user_key at seq is published
+  void Invalidate(uint32_t cf_id, const Slice& user_key, SequenceNumber seq) {
+    RaiseTo(&slots_[SlotIndex(cf_id, user_key)], seq);
+  }
+
+  // Called by the write path before a range deletion at seq is published
+  void InvalidateRange(SequenceNumber seq) { RaiseTo(&range_seq_, seq); }
+
+  // Invalidates all the results, read before or concurrently with the call.
+  // Called both before and after a change that bypasses the write path is
+  // installed.
+  void InvalidateAll() { epoch_.fetch_add(1, std::memory_order_acq_rel); }
+
+  // To be passed to Insert(): taken before the read whose result is cached
+  uint64_t GetEpoch() const { return epoch_.load(std::memory_order_acquire); }
+
+  // Returns true and sets *s, and *value if found, when the result of the
+  // read of user_key at snapshot is cached
+  bool Lookup(uint32_t cf_id, const Slice& user_key, SequenceNumber snapshot,
+              PinnableSlice* value, Status* s);
+
+  // Caches the result of the read of user_key at snapshot, which must be
+  // published. Only OK and NotFound are cached.
+  void Insert(uint32_t cf_id, const Slice& user_key, SequenceNumber snapshot,
+              uint64_t epoch, const Status& s, const Slice& value);
+
+ private:
+  struct Entry {
+    SequenceNumber read_seq;
+    uint64_t epoch;
+    bool found;
+    std::string value;
+  };
+  using CacheInterface = BasicTypedCacheInterface<Entry, CacheEntryRole::kMisc>;
+
+  static constexpr int kNumSlotsBits = 16;
+
+  static void RaiseTo(std::atomic<SequenceNumber>* seq_ptr,
+                      SequenceNumber seq) {
+    SequenceNumber cur = seq_ptr->load(std::memory_order_relaxed);
+    while (cur < seq && !seq_ptr->compare_exchange_weak(
+                            cur, seq, std::memory_order_acq_rel)) {
+    }
+  }
+
+  size_t SlotIndex(uint32_t cf_id, const Slice& user_key) const;
+
+  void MakeCacheKey(uint32_t cf_id, const Slice& user_key,
+                    std::string* key) const;
+
+  std::shared_ptr<Cache> cache_;
+  // Distinguishes the keys of this DB in a shared cache
+  std::string cache_id_;
+  // The latest write to any key of each slot
+  std::unique_ptr<std::atomic<SequenceNumber>[]> slots_;
+  std::atomic<SequenceNumber> range_seq_{0};
+  std::atomic<uint64_t> epoch_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -279,6 +279,26 @@ bool FragmentedRangeTombstoneList::ContainsRange(SequenceNumber lower,
   return seq_it != seq_set_.end() && *seq_it <= upper;
 }
 
+SequenceNumber FragmentedRangeTombstoneList::MaxCoveringTombstoneSeqnum(
+    const Slice& user_key, SequenceNumber upper_bound,
+    const Comparator* ucmp) const {
+  assert(ucmp->timestamp_size() == 0);
+  // The first fragment ending after the key is the only one that may cover it
+  auto pos = std::upper_bound(
+      tombstones_.begin(), tombstones_.end(), user_key,
+      [ucmp](const Slice& key, const RangeTombstoneStack& tombstone) {
+        return ucmp->Compare(key, tombstone.end_key) < 0;
+      });
+  if (pos == tombstones_.end() || ucmp->Compare(pos->start_key, user_key) > 0) {
+    return 0;
+  }
+  // The sequence numbers of a fragment are in decreasing order
+  auto seq_end = seq_iter(pos->seq_end_idx);
+  auto seq_pos = std::lower_bound(seq_iter(pos->seq_start_idx), seq_end,
+                                  upper_bound, std::greater<SequenceNumber>());
+  return seq_pos == seq_end ? 0 : *seq_pos;
+}
+
 FragmentedRangeTombstoneIterator::FragmentedRangeTombstoneIterator(
     FragmentedRangeTombstoneList* tombstones, const InternalKeyComparator& icmp,
     SequenceNumber _upper_bound, const Slice* ts_upper_bound,
@@ -89,6 +89,15 @@ struct FragmentedRangeTombstoneList {
   // sequence numbers (`seq_set_`).
   bool ContainsRange(SequenceNumber lower, SequenceNumber upper);
 
+  // Returns the max sequence number, at most `upper_bound`, of the
+  // tombstones covering `user_key`, or 0 if there is none. Same as
+  // FragmentedRangeTombstoneIterator::MaxCoveringTombstoneSeqnum(), but
+  // searches the fragments in place, without an iterator to allocate. Only
+  // for tombstones without timestamp.
+  SequenceNumber MaxCoveringTombstoneSeqnum(const Slice& user_key,
+                                            SequenceNumber upper_bound,
+                                            const Comparator* ucmp) const;
+
   uint64_t num_unfragmented_tombstones() const {
     return num_unfragmented_tombstones_;
   }
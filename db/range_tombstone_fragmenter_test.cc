@@ -297,6 +297,39 @@ TEST_F(RangeTombstoneFragmenterTest, OverlapAndRepeatedStartKey) {
       &iter5, {{"a", 0}, {"c", 0}, {"e", 0}, {"i", 0}, {"j", 2}, {"m", 0}});
 }
 
+TEST_F(RangeTombstoneFragmenterTest, ListMaxCoveringTombstoneSeqnum) {
+  auto range_del_iter = MakeRangeDelIter({{"a", "e", 10},
+                                          {"c", "g", 8},
+                                          {"c", "i", 6},
+                                          {"j", "n", 4},
+                                          {"j", "l", 2}});
+  FragmentedRangeTombstoneList fragment_list(std::move(range_del_iter),
+                                             bytewise_icmp);
+
+  // Searching the list in place finds what an iterator finds
+  for (SequenceNumber upper_bound :
+       {kMaxSequenceNumber, SequenceNumber{10}, SequenceNumber{9},
+        SequenceNumber{7}, SequenceNumber{5}, SequenceNumber{3},
+        SequenceNumber{1}}) {
+    FragmentedRangeTombstoneIterator iter(&fragment_list, bytewise_icmp,
+                                          upper_bound);
+    for (const char* key :
+         {"", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m",
+          "n", "o"}) {
+      EXPECT_EQ(iter.MaxCoveringTombstoneSeqnum(key),
+                fragment_list.MaxCoveringTombstoneSeqnum(
+                    key, upper_bound, BytewiseComparator()))
+          << "key " << key << " upper bound " << upper_bound;
+    }
+  }
+  EXPECT_EQ(8, fragment_list.MaxCoveringTombstoneSeqnum(
+                   "f", kMaxSequenceNumber, BytewiseComparator()));
+  EXPECT_EQ(6, fragment_list.MaxCoveringTombstoneSeqnum("f", 7,
+                                                        BytewiseComparator()));
+  EXPECT_EQ(0, fragment_list.MaxCoveringTombstoneSeqnum(
+                   "i", kMaxSequenceNumber, BytewiseComparator()));
+}
+
 TEST_F(RangeTombstoneFragmenterTest, OverlapAndRepeatedStartKeyUnordered) {
   auto range_del_iter = MakeRangeDelIter({{"a", "e", 10},
                                           {"j", "n", 4},
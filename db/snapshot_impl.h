@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <atomic>
 #include <vector>
 
 #include "db/dbformat.h"
@@ -34,9 +35,38 @@ class SnapshotImpl : public Snapshot {
 
   uint64_t GetTimestamp() const override { return timestamp_; }
 
+  // Set for the snapshots that DB::GetSnapshot() shares among its callers,
+  // see DBOptions::share_snapshots. Such a snapshot stays in the list until
+  // its last caller releases it, and is then recycled rather than deleted, so
+  // that a stale pointer to it can still be tried with TryRef().
+  bool shared_ = false;  // const after creation
+
+  // Takes another reference to a shared snapshot, unless its last reference
+  // was released already. The snapshot may have been recycled for another
+  // sequence number, which the caller has to check afterwards.
+  bool TryRef() const {
+    uint64_t refs = refs_.load(std::memory_order_relaxed);
+    while (refs > 0) {
+      if (refs_.compare_exchange_weak(refs, refs + 1,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns true if it released the last reference to a shared snapshot
+  bool Unref() const {
+    return refs_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
  private:
   friend class SnapshotList;
 
+  // The references to a shared snapshot, 1 from SnapshotList::New()
+  mutable std::atomic<uint64_t> refs_{0};
+
   // SnapshotImpl is kept in a doubly-linked circular list
   SnapshotImpl* prev_;
   SnapshotImpl* next_;
@@ -106,12 +136,15 @@ class SnapshotList {
     s->unix_time_ = unix_time;
     s->timestamp_ = ts;
     s->is_write_conflict_boundary_ = is_write_conflict_boundary;
+    // Publishes the fields above to TryRef()
+    s->refs_.store(1, std::memory_order_release);
     s->list_ = this;
     s->next_ = &list_;
     s->prev_ = list_.prev_;
     s->prev_->next_ = s;
     s->next_->prev_ = s;
     count_++;
+    newest_number_.store(seq, std::memory_order_release);
     return s;
   }
 
@@ -121,6 +154,8 @@ class SnapshotList {
     s->prev_->next_ = s->next_;
     s->next_->prev_ = s->prev_;
     count_--;
+    newest_number_.store(empty() ? 0 : newest()->number_,
+                         std::memory_order_release);
   }
 
   // retrieve all snapshot numbers up until max_seq. They are sorted in
@@ -196,10 +231,16 @@ class SnapshotList {
 
   uint64_t count() const { return count_; }
 
+  // Like GetNewest(), but may be called without the DB mutex, e.g. by writers
+  SequenceNumber GetNewestNoLock() const {
+    return newest_number_.load(std::memory_order_acquire);
+  }
+
  private:
   // Dummy head of doubly-linked list of snapshots
   SnapshotImpl list_;
   uint64_t count_;
+  std::atomic<SequenceNumber> newest_number_{0};
 };
 
 // All operations on TimestampedSnapshotList must be protected by db mutex.
@@ -467,8 +467,16 @@ Status TableCache::Get(
     }
     SequenceNumber* max_covering_tombstone_seq =
         get_context->max_covering_tombstone_seq();
+    SequenceNumber tombstone_seq = 0;
     if (s.ok() && max_covering_tombstone_seq != nullptr &&
-        !options.ignore_range_deletions) {
+        !options.ignore_range_deletions &&
+        t->MaxCoveringTombstoneSeqnum(options, ExtractUserKey(k),
+                                      &tombstone_seq)) {
+      // Searched in place, without a range tombstone iterator
+      *max_covering_tombstone_seq =
+          std::max(*max_covering_tombstone_seq, tombstone_seq);
+    } else if (s.ok() && max_covering_tombstone_seq != nullptr &&
+               !options.ignore_range_deletions) {
       std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
           t->NewRangeTombstoneIterator(options));
       if (range_del_iter != nullptr) {
@@ -516,6 +524,23 @@ Status TableCache::Get(
 void TableCache::UpdateRangeTombstoneSeqnums(
     const ReadOptions& options, TableReader* t,
     MultiGetContext::Range& table_range) {
+  // Whether the table can search its tombstones without an iterator does not
+  // depend on the key, so it is only tried on the first one
+  bool searched = true;
+  for (auto iter = table_range.begin(); iter != table_range.end(); ++iter) {
+    SequenceNumber seq = 0;
+    if (!t->MaxCoveringTombstoneSeqnum(options, iter->ukey_with_ts, &seq)) {
+      searched = false;
+      break;
+    }
+    SequenceNumber* max_covering_tombstone_seq =
+        iter->get_context->max_covering_tombstone_seq();
+    *max_covering_tombstone_seq = std::max(*max_covering_tombstone_seq, seq);
+  }
+  if (searched) {
+    return;
+  }
+
   std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
       t->NewRangeTombstoneIterator(options));
   if (range_del_iter != nullptr) {
@@ -641,6 +666,88 @@ Status TableCache::ApproximateKeyAnchors(
   return s;
 }
 
+Status TableCache::GetCachedKeyRanges(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+    std::vector<OwnedUserKeyRange>& ranges) {
+  Status s;
+  TableReader* t = file_meta.fd.table_reader;
+  TypedHandle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, file_meta, &handle,
+                  block_protection_bytes_per_key);
+    if (s.ok()) {
+      t = cache_.Value(handle);
+    }
+  }
+  if (s.ok() && t != nullptr) {
+    s = t->GetCachedKeyRanges(ro, file_meta.smallest.user_key(), ranges);
+  }
+  if (handle != nullptr) {
+    cache_.Release(handle);
+  }
+  return s;
+}
+
+void TableCache::PrefetchForScan(
+    const ReadOptions& read_options, const FileOptions& file_options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+    const std::shared_ptr<const SliceTransform>& prefix_extractor,
+    HistogramImpl* file_read_hist, bool skip_filters, int level) {
+  TableReader* t = file_meta.fd.table_reader;
+  TypedHandle* handle = nullptr;
+  if (t == nullptr) {
+    Status s = FindTable(read_options, file_options, internal_comparator,
+                         file_meta, &handle, block_protection_bytes_per_key,
+                         prefix_extractor,
+                         read_options.read_tier == kBlockCacheTier /* no_io */,
+                         file_read_hist, skip_filters, level,
+                         true /* prefetch_index_and_filter_in_cache */,
+                         0 /* max_file_size_for_l0_meta_pin */,
+                         file_meta.temperature);
+    if (s.ok()) {
+      t = cache_.Value(handle);
+    }
+  }
+  if (t != nullptr) {
+    t->PrefetchForScan(read_options);
+  }
+  if (handle != nullptr) {
+    cache_.Release(handle);
+  }
+}
+
+Status TableCache::CacheDependencies(
+    const ReadOptions& read_options, const FileOptions& file_options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+    const std::shared_ptr<const SliceTransform>& prefix_extractor,
+    int level) {
+  Status s;
+  TableReader* t = file_meta.fd.table_reader;
+  TypedHandle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(read_options, file_options, internal_comparator, file_meta,
+                  &handle, block_protection_bytes_per_key, prefix_extractor,
+                  false /* no_io */, nullptr /* file_read_hist */,
+                  false /* skip_filters */, level,
+                  true /* prefetch_index_and_filter_in_cache */,
+                  0 /* max_file_size_for_l0_meta_pin */,
+                  file_meta.temperature);
+    if (s.ok()) {
+      t = cache_.Value(handle);
+    }
+  }
+  if (s.ok()) {
+    s = t->CacheDependencies(read_options);
+  }
+  if (handle != nullptr) {
+    cache_.Release(handle);
+  }
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const FileOptions& file_options, const ReadOptions& read_options,
     const InternalKeyComparator& internal_comparator,
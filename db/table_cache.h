@@ -201,6 +201,35 @@ class TableCache {
                                uint8_t block_protection_bytes_per_key,
                                std::vector<TableReader::Anchor>& anchors);
 
+  // See TableReader::GetCachedKeyRanges()
+  Status GetCachedKeyRanges(const ReadOptions& ro,
+                            const InternalKeyComparator& internal_comparator,
+                            const FileMetaData& file_meta,
+                            uint8_t block_protection_bytes_per_key,
+                            std::vector<OwnedUserKeyRange>& ranges);
+
+  // Opens the table of the file if it is not open yet, and hints its reader
+  // that a scan will soon read the table from its first key (see
+  // TableReader::PrefetchForScan()). Errors are ignored: the scan opens the
+  // table again when it gets there and reports them then.
+  void PrefetchForScan(
+      const ReadOptions& read_options, const FileOptions& toptions,
+      const InternalKeyComparator& internal_comparator,
+      const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor = nullptr,
+      HistogramImpl* file_read_hist = nullptr, bool skip_filters = false,
+      int level = -1);
+
+  // Opens the table of the file if it is not open yet, and loads the blocks
+  // its lookups depend on into the block cache (see
+  // TableReader::CacheDependencies()).
+  Status CacheDependencies(
+      const ReadOptions& read_options, const FileOptions& toptions,
+      const InternalKeyComparator& internal_comparator,
+      const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor = nullptr,
+      int level = -1);
+
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
   size_t GetMemoryUsageByTableReader(
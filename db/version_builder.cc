@@ -18,6 +18,7 @@
 #include <set>
 #include <sstream>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -298,6 +299,9 @@ class VersionBuilder::Rep {
         // TypedHandle for FileMetaData::table_reader_handle
         table_cache_->get_cache().get()->Release(f->table_reader_handle);
         f->table_reader_handle = nullptr;
+        if (version_set_ != nullptr) {
+          version_set_->UnpinTableReaders(1);
+        }
       }
 
       if (file_metadata_cache_res_mgr_) {
@@ -1259,20 +1263,32 @@ class VersionBuilder::Rep {
     return s;
   }
 
-  Status LoadTableHandlers(
-      InternalStats* internal_stats, int max_threads,
-      bool prefetch_index_and_filter_in_cache, bool is_initial_load,
+  void PrepareTableLoads(
+      InternalStats* internal_stats, bool prefetch_index_and_filter_in_cache,
+      bool is_initial_load,
       const std::shared_ptr<const SliceTransform>& prefix_extractor,
       size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
-      uint8_t block_protection_bytes_per_key) {
+      uint8_t block_protection_bytes_per_key, size_t* num_pending_loads,
+      std::vector<std::function<Status()>>* loads) {
     assert(table_cache_ != nullptr);
+    assert(num_pending_loads != nullptr);
+    assert(loads != nullptr);
 
     size_t table_cache_capacity =
         table_cache_->get_cache().get()->GetCapacity();
     bool always_load = (table_cache_capacity == TableCache::kInfiniteCapacity);
     size_t max_load = std::numeric_limits<size_t>::max();
-
-    if (!always_load) {
+    // The level filters of the files are kept in the file metadata, so they
+    // are loaded for all the files, whether or not the table readers are
+    // pinned
+    const bool load_level_filters = ioptions_->level_filter_bits_per_key > 0;
+    // With max_pinned_table_readers, the files are pinned within it instead
+    // of within the room left in the table cache
+    const bool limit_pinned =
+        version_set_ != nullptr &&
+        version_set_->db_options()->max_pinned_table_readers > 0;
+
+    if (!always_load && !limit_pinned) {
       // If it is initial loading and not set to always loading all the
       // files, we only load up to kInitialLoadLimit files, to limit the
       // time reopening the DB.
@@ -1290,78 +1306,115 @@ class VersionBuilder::Rep {
         load_limit = table_cache_capacity / 4;
       }
 
-      size_t table_cache_usage = table_cache_->get_cache().get()->GetUsage();
+      // The files that the loads prepared before this one will open count
+      // as if they were already in the table cache
+      size_t table_cache_usage =
+          table_cache_->get_cache().get()->GetUsage() + *num_pending_loads;
       if (table_cache_usage >= load_limit) {
-        // TODO (yanqin) find a suitable status code.
-        return Status::OK();
+        if (!load_level_filters) {
+          // TODO (yanqin) find a suitable status code.
+          return;
+        }
+        max_load = 0;
       } else {
         max_load = load_limit - table_cache_usage;
       }
     }
 
-    // <file metadata, level>
-    std::vector<std::pair<FileMetaData*, int>> files_meta;
-    std::vector<Status> statuses;
-    for (int level = 0; level < num_levels_; level++) {
-      for (auto& file_meta_pair : levels_[level].added_files) {
-        auto* file_meta = file_meta_pair.second;
-        // If the file has been opened before, just skip it.
-        if (!file_meta->table_reader_handle) {
-          files_meta.emplace_back(file_meta, level);
-          statuses.emplace_back(Status::OK());
-        }
-        if (files_meta.size() >= max_load) {
-          break;
-        }
-      }
-      if (files_meta.size() >= max_load) {
-        break;
-      }
-    }
-
-    std::atomic<size_t> next_file_meta_idx(0);
-    std::function<void()> load_handlers_func([&]() {
-      while (true) {
-        size_t file_idx = next_file_meta_idx.fetch_add(1);
-        if (file_idx >= files_meta.size()) {
-          break;
+    struct LoadParams {
+      InternalStats* internal_stats;
+      bool prefetch_index_and_filter_in_cache;
+      std::shared_ptr<const SliceTransform> prefix_extractor;
+      size_t max_file_size_for_l0_meta_pin;
+      ReadOptions read_options;
+      uint8_t block_protection_bytes_per_key;
+    };
+    auto params = std::make_shared<const LoadParams>(
+        LoadParams{internal_stats, prefetch_index_and_filter_in_cache,
+                   prefix_extractor, max_file_size_for_l0_meta_pin,
+                   read_options, block_protection_bytes_per_key});
+
+    // Opens the table of `file_meta`, and pins its reader if `pin`
+    auto load = [this, params, load_level_filters](FileMetaData* file_meta,
+                                                   int level, bool pin) {
+      TableCache::TypedHandle* handle = nullptr;
+      Status s = table_cache_->FindTable(
+          params->read_options, file_options_,
+          *(base_vstorage_->InternalComparator()), *file_meta, &handle,
+          params->block_protection_bytes_per_key, params->prefix_extractor,
+          false /*no_io */, params->internal_stats->GetFileReadHist(level),
+          false, level, params->prefetch_index_and_filter_in_cache,
+          params->max_file_size_for_l0_meta_pin, file_meta->temperature);
+      if (handle != nullptr) {
+        TableReader* table_reader = table_cache_->get_cache().Value(handle);
+        if (load_level_filters) {
+          file_meta->level_filter = table_reader->GetLevelFilter();
         }
-
-        auto* file_meta = files_meta[file_idx].first;
-        int level = files_meta[file_idx].second;
-        TableCache::TypedHandle* handle = nullptr;
-        statuses[file_idx] = table_cache_->FindTable(
-            read_options, file_options_,
-            *(base_vstorage_->InternalComparator()), *file_meta, &handle,
-            block_protection_bytes_per_key, prefix_extractor, false /*no_io */,
-            internal_stats->GetFileReadHist(level), false, level,
-            prefetch_index_and_filter_in_cache, max_file_size_for_l0_meta_pin,
-            file_meta->temperature);
-        if (handle != nullptr) {
+        if (pin) {
           file_meta->table_reader_handle = handle;
           // Load table_reader
-          file_meta->fd.table_reader = table_cache_->get_cache().Value(handle);
+          file_meta->fd.table_reader = table_reader;
+        } else {
+          table_cache_->get_cache().Release(handle);
         }
+      } else if (pin && version_set_ != nullptr) {
+        version_set_->UnpinTableReaders(1);
       }
-    });
+      return s;
+    };
 
-    std::vector<port::Thread> threads;
-    for (int i = 1; i < max_threads; i++) {
-      threads.emplace_back(load_handlers_func);
+    size_t num_to_pin = 0;
+    for (int level = 0; level < num_levels_; level++) {
+      for (auto& file_meta_pair : levels_[level].added_files) {
+        if (!file_meta_pair.second->table_reader_handle) {
+          num_to_pin++;
+        }
+      }
     }
-    load_handlers_func();
-    for (auto& t : threads) {
-      t.join();
+    num_to_pin = std::min(num_to_pin, max_load);
+    if (version_set_ != nullptr) {
+      num_to_pin = version_set_->ReservePinnedTableReaders(num_to_pin);
     }
-    Status ret;
-    for (const auto& s : statuses) {
-      if (!s.ok()) {
-        if (ret.ok()) {
-          ret = s;
+
+    size_t num_pinned = 0;
+    for (int level = 0; level < num_levels_; level++) {
+      for (auto& file_meta_pair : levels_[level].added_files) {
+        auto* file_meta = file_meta_pair.second;
+        // If the file has been opened before, just skip it.
+        if (file_meta->table_reader_handle) {
+          continue;
         }
+        if (num_pinned < num_to_pin) {
+          loads->emplace_back([load, file_meta, level]() {
+            return load(file_meta, level, true);
+          });
+          num_pinned++;
+        } else if (load_level_filters && !file_meta->level_filter) {
+          loads->emplace_back([load, file_meta, level]() {
+            return load(file_meta, level, false);
+          });
+        } else {
+          continue;
+        }
+        ++*num_pending_loads;
       }
     }
-    return ret;
+  }
+
+  Status LoadTableHandlers(
+      InternalStats* internal_stats, int max_threads,
+      bool prefetch_index_and_filter_in_cache, bool is_initial_load,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor,
+      size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+      uint8_t block_protection_bytes_per_key) {
+    std::vector<std::function<Status()>> loads;
+    size_t num_pending_loads = 0;
+    PrepareTableLoads(internal_stats, prefetch_index_and_filter_in_cache,
+                      is_initial_load, prefix_extractor,
+                      max_file_size_for_l0_meta_pin, read_options,
+                      block_protection_bytes_per_key, &num_pending_loads,
+                      &loads);
+    return RunTableLoads(loads, max_threads);
   }
 };
 
@@ -1387,6 +1440,56 @@ Status VersionBuilder::SaveTo(VersionStorageInfo* vstorage) const {
   return rep_->SaveTo(vstorage);
 }
 
+void VersionBuilder::PrepareTableLoads(
+    InternalStats* internal_stats, bool prefetch_index_and_filter_in_cache,
+    bool is_initial_load,
+    const std::shared_ptr<const SliceTransform>& prefix_extractor,
+    size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+    uint8_t block_protection_bytes_per_key, size_t* num_pending_loads,
+    std::vector<std::function<Status()>>* loads) {
+  rep_->PrepareTableLoads(internal_stats, prefetch_index_and_filter_in_cache,
+                          is_initial_load, prefix_extractor,
+                          max_file_size_for_l0_meta_pin, read_options,
+                          block_protection_bytes_per_key, num_pending_loads,
+                          loads);
+}
+
+Status VersionBuilder::RunTableLoads(
+    const std::vector<std::function<Status()>>& loads, int max_threads) {
+  std::vector<Status> statuses(loads.size());
+  std::atomic<size_t> next_load_idx(0);
+  std::function<void()> load_handlers_func([&]() {
+    while (true) {
+      size_t load_idx = next_load_idx.fetch_add(1);
+      if (load_idx >= loads.size()) {
+        break;
+      }
+      statuses[load_idx] = loads[load_idx]();
+    }
+  });
+
+  std::vector<port::Thread> threads;
+  int num_threads =
+      static_cast<int>(std::min(loads.size(), static_cast<size_t>(
+                                                  std::max(max_threads, 1))));
+  for (int i = 1; i < num_threads; i++) {
+    threads.emplace_back(load_handlers_func);
+  }
+  load_handlers_func();
+  for (auto& t : threads) {
+    t.join();
+  }
+  Status ret;
+  for (const auto& s : statuses) {
+    if (!s.ok()) {
+      if (ret.ok()) {
+        ret = s;
+      }
+    }
+  }
+  return ret;
+}
+
 Status VersionBuilder::LoadTableHandlers(
     InternalStats* internal_stats, int max_threads,
     bool prefetch_index_and_filter_in_cache, bool is_initial_load,
@@ -9,7 +9,9 @@
 //
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "db/version_edit.h"
 #include "rocksdb/file_system.h"
@@ -50,6 +52,23 @@ class VersionBuilder {
       const std::shared_ptr<const SliceTransform>& prefix_extractor,
       size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
       uint8_t block_protection_bytes_per_key);
+  // Like LoadTableHandlers(), but appends to `*loads` a job opening each
+  // table file instead of opening them, so that the files of several builders
+  // can be opened by the same threads with RunTableLoads().
+  // `*num_pending_loads` is the number of files that the jobs prepared so far
+  // for the same table cache will add to it, and is increased by those
+  // prepared here.
+  void PrepareTableLoads(
+      InternalStats* internal_stats, bool prefetch_index_and_filter_in_cache,
+      bool is_initial_load,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor,
+      size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+      uint8_t block_protection_bytes_per_key, size_t* num_pending_loads,
+      std::vector<std::function<Status()>>* loads);
+  // Runs `loads` on up to `max_threads` threads, including the calling one,
+  // and returns the first failure
+  static Status RunTableLoads(
+      const std::vector<std::function<Status()>>& loads, int max_threads);
   uint64_t GetMinOldestBlobFileNumber() const;
 
  private:
@@ -190,6 +190,10 @@ struct FileMetaData {
   // Needs to be disposed when refs becomes 0.
   Cache::Handle* table_reader_handle = nullptr;
 
+  // The level filter of the table, if it has one and it has been loaded.
+  // Unlike the table reader, it stays in memory while the file is live.
+  std::shared_ptr<const LevelFilter> level_filter;
+
   FileSampledStats stats;
 
   // Stats for compensating deletion entries during compaction
@@ -207,6 +211,7 @@ struct FileMetaData {
   uint64_t num_deletions = 0;
   uint64_t raw_key_size = 0;    // total uncompressed key size.
   uint64_t raw_value_size = 0;  // total uncompressed value size.
+  uint64_t filter_size = 0;     // total size of the filter blocks.
   uint64_t num_range_deletions = 0;
   // This is computed during Flush/Compaction, and is added to
   // `compensated_file_size`. Currently, this estimates the size of keys in the
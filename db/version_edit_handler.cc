@@ -427,23 +427,19 @@ void VersionEditHandler::CheckIterationResult(const log::Reader& reader,
     }
   }
   if (s->ok()) {
-    for (auto* cfd : *(version_set_->GetColumnFamilySet())) {
-      if (cfd->IsDropped()) {
-        continue;
-      }
-      if (read_only_) {
-        cfd->table_cache()->SetTablesAreImmortal();
-      }
-      *s = LoadTables(cfd, /*prefetch_index_and_filter_in_cache=*/false,
-                      /*is_initial_load=*/true);
-      if (!s->ok()) {
-        // If s is IOError::PathNotFound, then we mark the db as corrupted.
-        if (s->IsPathNotFound()) {
-          *s = Status::Corruption("Corruption: " + s->ToString());
+    if (read_only_) {
+      for (auto* cfd : *(version_set_->GetColumnFamilySet())) {
+        if (!cfd->IsDropped()) {
+          cfd->table_cache()->SetTablesAreImmortal();
         }
-        break;
       }
     }
+    *s = LoadTables(/*prefetch_index_and_filter_in_cache=*/false,
+                    /*is_initial_load=*/true);
+    // If s is IOError::PathNotFound, then we mark the db as corrupted.
+    if (s->IsPathNotFound()) {
+      *s = Status::Corruption("Corruption: " + s->ToString());
+    }
   }
 
   if (s->ok()) {
@@ -574,8 +570,7 @@ Status VersionEditHandler::MaybeCreateVersion(const VersionEdit& /*edit*/,
   return s;
 }
 
-Status VersionEditHandler::LoadTables(ColumnFamilyData* cfd,
-                                      bool prefetch_index_and_filter_in_cache,
+Status VersionEditHandler::LoadTables(bool prefetch_index_and_filter_in_cache,
                                       bool is_initial_load) {
   bool skip_load_table_files = skip_load_table_files_;
   TEST_SYNC_POINT_CALLBACK(
@@ -584,20 +579,30 @@ Status VersionEditHandler::LoadTables(ColumnFamilyData* cfd,
   if (skip_load_table_files) {
     return Status::OK();
   }
-  assert(cfd != nullptr);
-  assert(!cfd->IsDropped());
-  auto builder_iter = builders_.find(cfd->GetID());
-  assert(builder_iter != builders_.end());
-  assert(builder_iter->second != nullptr);
-  VersionBuilder* builder = builder_iter->second->version_builder();
-  assert(builder);
-  const MutableCFOptions* moptions = cfd->GetLatestMutableCFOptions();
-  Status s = builder->LoadTableHandlers(
-      cfd->internal_stats(),
-      version_set_->db_options_->max_file_opening_threads,
-      prefetch_index_and_filter_in_cache, is_initial_load,
-      moptions->prefix_extractor, MaxFileSizeForL0MetaPin(*moptions),
-      read_options_, moptions->block_protection_bytes_per_key);
+  // The files of all the column families are opened by the same threads, so
+  // the column families with few files do not leave threads idle while the
+  // files of the others are opened
+  std::vector<std::function<Status()>> loads;
+  // The column families share the table cache
+  size_t num_pending_loads = 0;
+  for (auto* cfd : *(version_set_->GetColumnFamilySet())) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    auto builder_iter = builders_.find(cfd->GetID());
+    assert(builder_iter != builders_.end());
+    assert(builder_iter->second != nullptr);
+    VersionBuilder* builder = builder_iter->second->version_builder();
+    assert(builder);
+    const MutableCFOptions* moptions = cfd->GetLatestMutableCFOptions();
+    builder->PrepareTableLoads(
+        cfd->internal_stats(), prefetch_index_and_filter_in_cache,
+        is_initial_load, moptions->prefix_extractor,
+        MaxFileSizeForL0MetaPin(*moptions), read_options_,
+        moptions->block_protection_bytes_per_key, &num_pending_loads, &loads);
+  }
+  Status s = VersionBuilder::RunTableLoads(
+      loads, version_set_->db_options_->max_file_opening_threads);
   if ((s.IsPathNotFound() || s.IsCorruption()) && no_error_if_files_missing_) {
     s = Status::OK();
   }
@@ -1070,8 +1075,7 @@ Status VersionEditHandlerPointInTime::VerifyBlobFile(
 }
 
 Status VersionEditHandlerPointInTime::LoadTables(
-    ColumnFamilyData* /*cfd*/, bool /*prefetch_index_and_filter_in_cache*/,
-    bool /*is_initial_load*/) {
+    bool /*prefetch_index_and_filter_in_cache*/, bool /*is_initial_load*/) {
   return Status::OK();
 }
 
@@ -179,8 +179,8 @@ class VersionEditHandler : public VersionEditHandlerBase {
                                     ColumnFamilyData* cfd,
                                     bool force_create_version);
 
-  virtual Status LoadTables(ColumnFamilyData* cfd,
-                            bool prefetch_index_and_filter_in_cache,
+  // Opens the table files of all the column families
+  virtual Status LoadTables(bool prefetch_index_and_filter_in_cache,
                             bool is_initial_load);
 
   virtual bool MustOpenAllColumnFamilies() const { return !read_only_; }
@@ -257,8 +257,7 @@ class VersionEditHandlerPointInTime : public VersionEditHandler {
   virtual Status VerifyBlobFile(ColumnFamilyData* cfd, uint64_t blob_file_num,
                                 const BlobFileAddition& blob_addition);
 
-  Status LoadTables(ColumnFamilyData* cfd,
-                    bool prefetch_index_and_filter_in_cache,
+  Status LoadTables(bool prefetch_index_and_filter_in_cache,
                     bool is_initial_load) override;
 
   std::unordered_map<uint32_t, Version*> versions_;
@@ -65,6 +65,7 @@
 #include "table/format.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
+#include "table/level_filter.h"
 #include "table/merging_iterator.h"
 #include "table/meta_blocks.h"
 #include "table/multiget_context.h"
@@ -1113,6 +1114,10 @@ class LevelIterator final : public InternalIterator {
   void SkipEmptyFileBackward();
   void SetFileIterator(InternalIterator* iter);
   void InitFileIterator(size_t new_file_index);
+  // With async_io, opens the file after the current one ahead of a forward
+  // scan and has its table start reading ahead, so that the scan does not
+  // stall on the first reads of each file.
+  void PrefetchNextFile();
 
   const Slice& file_smallest_key(size_t file_index) {
     assert(file_index < flevel_->num_files);
@@ -1230,6 +1235,9 @@ class LevelIterator final : public InternalIterator {
   bool allow_unprepared_value_;
   bool may_be_out_of_lower_bound_ = true;
   bool is_next_read_sequential_;
+  // The file last passed to PrefetchNextFile(), 0 if none (the first file is
+  // never the next one)
+  size_t prefetched_file_index_ = 0;
   // Set in Seek() when a prefix seek reaches end of the current file,
   // and the next file has a different prefix. SkipEmptyFileForward()
   // will not move to next file when this flag is set.
@@ -1509,9 +1517,31 @@ bool LevelIterator::SkipEmptyFileForward() {
       }
     }
   }
+  if (read_options_.async_io && file_iter_.iter() != nullptr) {
+    PrefetchNextFile();
+  }
   return seen_empty_file;
 }
 
+void LevelIterator::PrefetchNextFile() {
+  const size_t next_file_index = file_index_ + 1;
+  if (next_file_index == prefetched_file_index_ || prefix_exhausted_) {
+    return;
+  }
+  prefetched_file_index_ = next_file_index;
+  if (next_file_index >= flevel_->num_files ||
+      KeyReachedUpperBound(file_smallest_key(next_file_index))) {
+    return;
+  }
+  TEST_SYNC_POINT_CALLBACK("LevelIterator::PrefetchNextFile",
+                           &prefetched_file_index_);
+  table_cache_->PrefetchForScan(
+      read_options_, file_options_, icomparator_,
+      *flevel_->files[next_file_index].file_metadata,
+      block_protection_bytes_per_key_, prefix_extractor_, file_read_hist_,
+      skip_filters_, level_);
+}
+
 void LevelIterator::SkipEmptyFileBackward() {
   // Pause at sentinel key
   while (!to_return_sentinel_ &&
@@ -2196,6 +2226,7 @@ VersionStorageInfo::VersionStorageInfo(
       accumulated_file_size_(0),
       accumulated_raw_key_size_(0),
       accumulated_raw_value_size_(0),
+      accumulated_filter_size_(0),
       accumulated_num_non_deletions_(0),
       accumulated_num_deletions_(0),
       current_num_non_deletions_(0),
@@ -2212,6 +2243,7 @@ VersionStorageInfo::VersionStorageInfo(
     accumulated_file_size_ = ref_vstorage->accumulated_file_size_;
     accumulated_raw_key_size_ = ref_vstorage->accumulated_raw_key_size_;
     accumulated_raw_value_size_ = ref_vstorage->accumulated_raw_value_size_;
+    accumulated_filter_size_ = ref_vstorage->accumulated_filter_size_;
     accumulated_num_non_deletions_ =
         ref_vstorage->accumulated_num_non_deletions_;
     accumulated_num_deletions_ = ref_vstorage->accumulated_num_deletions_;
@@ -2458,6 +2490,13 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       // stop here.
       break;
     }
+    const bool skip_filters =
+        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()), read_options,
+                        fp.IsHitFileLastInLevel());
+    if (!skip_filters && !LevelFilterMayMatch(*f->file_metadata, user_key)) {
+      f = fp.GetNextFile();
+      continue;
+    }
     if (get_context.sample()) {
       sample_file_read_inc(f->file_metadata);
     }
@@ -2471,9 +2510,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
         &get_context, mutable_cf_options_.block_protection_bytes_per_key,
         mutable_cf_options_.prefix_extractor,
         cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()), read_options,
-                        fp.IsHitFileLastInLevel()),
-        fp.GetHitFileLevel(), max_file_size_for_l0_meta_pin_);
+        skip_filters, fp.GetHitFileLevel(), max_file_size_for_l0_meta_pin_);
     // TODO: examine the behavior for corrupted key
     if (timer_enabled) {
       PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
@@ -3124,6 +3161,9 @@ Status Version::MultiGetAsync(
 
 bool Version::IsFilterSkipped(int level, const ReadOptions& read_options,
                               bool is_file_last_in_level) {
+  if (level >= storage_info_.FirstLevelWithoutFilters()) {
+    return true;
+  }
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
   auto optimize_for_hits = cfd_->ioptions()->optimize_filters_for_hits ||
@@ -3132,6 +3172,44 @@ bool Version::IsFilterSkipped(int level, const ReadOptions& read_options,
          level == storage_info_.num_non_empty_levels() - 1;
 }
 
+bool Version::LevelFilterMayMatch(const FileMetaData& file_meta,
+                                  const Slice& user_key) const {
+  const LevelFilter* const level_filter = file_meta.level_filter.get();
+  if (level_filter == nullptr) {
+    return true;
+  }
+  RecordTick(db_statistics_, LEVEL_FILTER_CHECKED);
+  if (level_filter->KeyMayMatch(
+          StripTimestampFromUserKey(user_key,
+                                    user_comparator()->timestamp_size()))) {
+    return true;
+  }
+  RecordTick(db_statistics_, LEVEL_FILTER_USEFUL);
+  return false;
+}
+
+void VersionStorageInfo::ComputeFirstLevelWithoutFilters(
+    const MutableCFOptions& mutable_cf_options) {
+  first_level_without_filters_ = std::numeric_limits<int>::max();
+  const uint64_t budget = mutable_cf_options.filter_memory_budget;
+  if (budget == 0 || accumulated_file_size_ == 0) {
+    return;
+  }
+  // Assume the filters take the same share of the bytes of every level as
+  // of the sampled files. The upper levels are read the most, and are the
+  // smallest, so their filters are the last ones to go.
+  const double filter_ratio = static_cast<double>(accumulated_filter_size_) /
+                              static_cast<double>(accumulated_file_size_);
+  double filter_size = 0;
+  for (int level = 0; level < num_non_empty_levels_; level++) {
+    filter_size += filter_ratio * static_cast<double>(NumLevelBytes(level));
+    if (filter_size > static_cast<double>(budget)) {
+      first_level_without_filters_ = level;
+      break;
+    }
+  }
+}
+
 void VersionStorageInfo::GenerateLevelFilesBrief() {
   level_files_brief_.resize(num_non_empty_levels_);
   for (int level = 0; level < num_non_empty_levels_; level++) {
@@ -3152,6 +3230,7 @@ void VersionStorageInfo::PrepareForVersionAppend(
   GenerateLevel0NonOverlapping();
   GenerateBottommostFiles();
   GenerateFileLocationIndex();
+  ComputeFirstLevelWithoutFilters(mutable_cf_options);
 }
 
 void Version::PrepareAppend(const MutableCFOptions& mutable_cf_options,
@@ -3190,6 +3269,7 @@ bool Version::MaybeInitializeFileMetaData(const ReadOptions& read_options,
   file_meta->num_deletions = tp->num_deletions;
   file_meta->raw_value_size = tp->raw_value_size;
   file_meta->raw_key_size = tp->raw_key_size;
+  file_meta->filter_size = tp->filter_size;
   file_meta->num_range_deletions = tp->num_range_deletions;
   return true;
 }
@@ -3202,6 +3282,7 @@ void VersionStorageInfo::UpdateAccumulatedStats(FileMetaData* file_meta) {
   accumulated_file_size_ += file_meta->fd.GetFileSize();
   accumulated_raw_key_size_ += file_meta->raw_key_size;
   accumulated_raw_value_size_ += file_meta->raw_value_size;
+  accumulated_filter_size_ += file_meta->filter_size;
   accumulated_num_non_deletions_ +=
       file_meta->num_entries - file_meta->num_deletions;
   accumulated_num_deletions_ += file_meta->num_deletions;
@@ -3383,7 +3464,8 @@ void VersionStorageInfo::EstimateCompactionBytesNeeded(
     // Add size added by previous compaction
     level_size += bytes_compact_to_next_level;
     bytes_compact_to_next_level = 0;
-    uint64_t level_target = MaxBytesForLevel(level);
+    uint64_t level_target =
+        CompactionTriggerBytesForLevel(level, mutable_cf_options);
     if (level_size > level_target) {
       bytes_compact_to_next_level = level_size - level_target;
       // Estimate the actual compaction fan-out ratio as size ratio between
@@ -3407,6 +3489,21 @@ void VersionStorageInfo::EstimateCompactionBytesNeeded(
   }
 }
 
+uint64_t VersionStorageInfo::CompactionTriggerBytesForLevel(
+    int level, const MutableCFOptions& mutable_cf_options) const {
+  uint64_t level_target = MaxBytesForLevel(level);
+  const double trigger =
+      mutable_cf_options.penultimate_level_compaction_trigger;
+  if (level > 0 && level == MaxInputLevel() && trigger > 1) {
+    const double scaled = static_cast<double>(level_target) * trigger;
+    const uint64_t max_target = std::numeric_limits<uint64_t>::max();
+    level_target = scaled >= static_cast<double>(max_target)
+                       ? max_target
+                       : static_cast<uint64_t>(scaled);
+  }
+  return level_target;
+}
+
 namespace {
 uint32_t GetExpiredTtlFilesCount(const ImmutableOptions& ioptions,
                                  const MutableCFOptions& mutable_cf_options,
@@ -3607,6 +3704,8 @@ void VersionStorageInfo::ComputeCompactionScore(
       }
     } else {  // level > 0
       // Compute the ratio of current size to size limit.
+      const uint64_t level_target =
+          CompactionTriggerBytesForLevel(level, mutable_cf_options);
       uint64_t level_bytes_no_compacting = 0;
       uint64_t level_total_bytes = 0;
       for (auto f : files_[level]) {
@@ -3616,12 +3715,10 @@ void VersionStorageInfo::ComputeCompactionScore(
         }
       }
       if (!immutable_options.level_compaction_dynamic_level_bytes) {
-        score = static_cast<double>(level_bytes_no_compacting) /
-                MaxBytesForLevel(level);
+        score = static_cast<double>(level_bytes_no_compacting) / level_target;
       } else {
-        if (level_bytes_no_compacting < MaxBytesForLevel(level)) {
-          score = static_cast<double>(level_bytes_no_compacting) /
-                  MaxBytesForLevel(level);
+        if (level_bytes_no_compacting < level_target) {
+          score = static_cast<double>(level_bytes_no_compacting) / level_target;
         } else {
           // If there are a large mount of data being compacted down to the
           // current level soon, we would de-prioritize compaction from
@@ -3629,8 +3726,7 @@ void VersionStorageInfo::ComputeCompactionScore(
           // it by dividing level size not by target level size, but
           // the target size and the incoming compaction bytes.
           score = static_cast<double>(level_bytes_no_compacting) /
-                  (MaxBytesForLevel(level) + total_downcompact_bytes) *
-                  kScoreScale;
+                  (level_target + total_downcompact_bytes) * kScoreScale;
         }
         // Drain unnecessary levels, but with lower priority compared to
         // when L0 is eligible. Only non-empty levels can be unnecessary.
@@ -3644,9 +3740,9 @@ void VersionStorageInfo::ComputeCompactionScore(
       }
       if (level <= lowest_unnecessary_level_) {
         total_downcompact_bytes += level_total_bytes;
-      } else if (level_total_bytes > MaxBytesForLevel(level)) {
+      } else if (level_total_bytes > level_target) {
         total_downcompact_bytes +=
-            static_cast<double>(level_total_bytes - MaxBytesForLevel(level));
+            static_cast<double>(level_total_bytes - level_target);
       }
     }
     compaction_level_[level] = level;
@@ -3677,7 +3773,8 @@ void VersionStorageInfo::ComputeCompactionScore(
   ComputeFilesMarkedForForcedBlobGC(
       mutable_cf_options.blob_garbage_collection_age_cutoff,
       mutable_cf_options.blob_garbage_collection_force_threshold,
-      mutable_cf_options.enable_blob_garbage_collection);
+      mutable_cf_options.enable_blob_garbage_collection,
+      mutable_cf_options.blob_garbage_collection_force_max_batches);
 
   EstimateCompactionBytesNeeded(mutable_cf_options);
 }
@@ -3803,7 +3900,8 @@ void VersionStorageInfo::ComputeFilesMarkedForPeriodicCompaction(
 void VersionStorageInfo::ComputeFilesMarkedForForcedBlobGC(
     double blob_garbage_collection_age_cutoff,
     double blob_garbage_collection_force_threshold,
-    bool enable_blob_garbage_collection) {
+    bool enable_blob_garbage_collection,
+    int blob_garbage_collection_force_max_batches) {
   files_marked_for_forced_blob_gc_.clear();
   if (!(enable_blob_garbage_collection &&
         blob_garbage_collection_age_cutoff > 0.0 &&
@@ -3852,63 +3950,114 @@ void VersionStorageInfo::ComputeFilesMarkedForForcedBlobGC(
   // blob_garbage_collection_force_threshold and the entire batch has to be
   // eligible for GC according to blob_garbage_collection_age_cutoff in order
   // for us to schedule any compactions.
-  const auto& oldest_meta = blob_files_.front();
-  assert(oldest_meta);
-
-  const auto& linked_ssts = oldest_meta->GetLinkedSsts();
-  assert(!linked_ssts.empty());
+  //
+  // With blob_garbage_collection_force_max_batches > 1, the later batches are
+  // considered as well (in the example, blob files 12 and 13, which we can get
+  // rid of by forcing the compaction of SST 3, provided no older SST refers
+  // to them), as long as each of them is entirely eligible for GC. The oldest
+  // batch is targeted first if it meets the threshold, followed by the other
+  // batches meeting it in the order of decreasing garbage ratio.
+  struct Batch {
+    size_t first;
+    uint64_t total_blob_bytes;
+    uint64_t garbage_blob_bytes;
+  };
 
-  size_t count = 1;
-  uint64_t sum_total_blob_bytes = oldest_meta->GetTotalBlobBytes();
-  uint64_t sum_garbage_blob_bytes = oldest_meta->GetGarbageBlobBytes();
+  std::vector<Batch> batches;
 
   assert(cutoff_count <= blob_files_.size());
 
-  for (; count < cutoff_count; ++count) {
-    const auto& meta = blob_files_[count];
-    assert(meta);
+  for (size_t first = 0; first < cutoff_count;) {
+    const auto& first_meta = blob_files_[first];
+    assert(first_meta);
+    assert(!first_meta->GetLinkedSsts().empty());
 
-    if (!meta->GetLinkedSsts().empty()) {
-      // Found the beginning of the next batch of blob files
-      break;
+    Batch batch{first, first_meta->GetTotalBlobBytes(),
+                first_meta->GetGarbageBlobBytes()};
+
+    size_t count = first + 1;
+
+    for (; count < cutoff_count; ++count) {
+      const auto& meta = blob_files_[count];
+      assert(meta);
+
+      if (!meta->GetLinkedSsts().empty()) {
+        // Found the beginning of the next batch of blob files
+        break;
+      }
+
+      batch.total_blob_bytes += meta->GetTotalBlobBytes();
+      batch.garbage_blob_bytes += meta->GetGarbageBlobBytes();
     }
 
-    sum_total_blob_bytes += meta->GetTotalBlobBytes();
-    sum_garbage_blob_bytes += meta->GetGarbageBlobBytes();
-  }
+    if (count < blob_files_.size()) {
+      const auto& meta = blob_files_[count];
+      assert(meta);
 
-  if (count < blob_files_.size()) {
-    const auto& meta = blob_files_[count];
-    assert(meta);
+      if (meta->GetLinkedSsts().empty()) {
+        // Some files in this batch are not eligible for GC, and neither are
+        // any of the later batches
+        break;
+      }
+    }
 
-    if (meta->GetLinkedSsts().empty()) {
-      // Some files in the oldest batch are not eligible for GC
-      return;
+    if (batch.garbage_blob_bytes >=
+        blob_garbage_collection_force_threshold * batch.total_blob_bytes) {
+      batches.emplace_back(batch);
     }
+
+    if (blob_garbage_collection_force_max_batches <= 1) {
+      break;
+    }
+
+    first = count;
   }
 
-  if (sum_garbage_blob_bytes <
-      blob_garbage_collection_force_threshold * sum_total_blob_bytes) {
+  if (batches.empty()) {
     return;
   }
 
-  for (uint64_t sst_file_number : linked_ssts) {
-    const FileLocation location = GetFileLocation(sst_file_number);
-    assert(location.IsValid());
+  auto garbage_ratio = [](const Batch& batch) {
+    return batch.total_blob_bytes
+               ? static_cast<double>(batch.garbage_blob_bytes) /
+                     static_cast<double>(batch.total_blob_bytes)
+               : 0.0;
+  };
+
+  const auto later_batches_begin =
+      batches.front().first == 0 ? batches.begin() + 1 : batches.begin();
+  std::stable_sort(later_batches_begin, batches.end(),
+                   [&](const Batch& lhs, const Batch& rhs) {
+                     return garbage_ratio(lhs) > garbage_ratio(rhs);
+                   });
 
-    const int level = location.GetLevel();
-    assert(level >= 0);
+  const size_t max_batches = static_cast<size_t>(
+      std::max(blob_garbage_collection_force_max_batches, 1));
+  if (batches.size() > max_batches) {
+    batches.resize(max_batches);
+  }
 
-    const size_t pos = location.GetPosition();
+  for (const Batch& batch : batches) {
+    const auto& linked_ssts = blob_files_[batch.first]->GetLinkedSsts();
 
-    FileMetaData* const sst_meta = files_[level][pos];
-    assert(sst_meta);
+    for (uint64_t sst_file_number : linked_ssts) {
+      const FileLocation location = GetFileLocation(sst_file_number);
+      assert(location.IsValid());
 
-    if (sst_meta->being_compacted) {
-      continue;
-    }
+      const int level = location.GetLevel();
+      assert(level >= 0);
+
+      const size_t pos = location.GetPosition();
 
-    files_marked_for_forced_blob_gc_.emplace_back(level, sst_meta);
+      FileMetaData* const sst_meta = files_[level][pos];
+      assert(sst_meta);
+
+      if (sst_meta->being_compacted) {
+        continue;
+      }
+
+      files_marked_for_forced_blob_gc_.emplace_back(level, sst_meta);
+    }
   }
 }
 
@@ -5247,6 +5396,7 @@ VersionSet::~VersionSet() {
   for (auto& file : obsolete_files_) {
     if (file.metadata->table_reader_handle) {
       table_cache_->Release(file.metadata->table_reader_handle);
+      UnpinTableReaders(1);
       TableCache::Evict(table_cache_, file.metadata->fd.GetNumber());
     }
     file.DeleteMetadata();
@@ -5637,25 +5787,54 @@ Status VersionSet::ProcessManifestWrites(
     mu->Unlock();
     TEST_SYNC_POINT("VersionSet::LogAndApply:WriteManifestStart");
     TEST_SYNC_POINT_CALLBACK("VersionSet::LogAndApply:WriteManifest", nullptr);
+
+    // The new versions of different column families are independent, e.g.
+    // those of an atomic flush, so they are prepared on up to
+    // max_file_opening_threads threads
+    auto for_each_version = [&](const std::function<void(size_t)>& func) {
+      std::atomic<size_t> next_version_idx(0);
+      auto prepare_versions_func = [&]() {
+        for (size_t i = next_version_idx.fetch_add(1); i < versions.size();
+             i = next_version_idx.fetch_add(1)) {
+          func(i);
+        }
+      };
+      size_t max_threads = std::min(
+          versions.size(),
+          static_cast<size_t>(
+              std::max(db_options_->max_file_opening_threads, 1)));
+      std::vector<port::Thread> threads;
+      for (size_t i = 1; i < max_threads; i++) {
+        threads.emplace_back(prepare_versions_func);
+      }
+      prepare_versions_func();
+      for (auto& t : threads) {
+        t.join();
+      }
+    };
+
     if (!first_writer.edit_list.front()->IsColumnFamilyManipulation()) {
-      for (int i = 0; i < static_cast<int>(versions.size()); ++i) {
-        assert(!builder_guards.empty() &&
-               builder_guards.size() == versions.size());
-        assert(!mutable_cf_options_ptrs.empty() &&
-               builder_guards.size() == versions.size());
+      assert(!builder_guards.empty() &&
+             builder_guards.size() == versions.size());
+      assert(!mutable_cf_options_ptrs.empty() &&
+             builder_guards.size() == versions.size());
+      std::vector<Status> load_statuses(versions.size());
+      for_each_version([&](size_t i) {
         ColumnFamilyData* cfd = versions[i]->cfd_;
-        s = builder_guards[i]->version_builder()->LoadTableHandlers(
+        auto* builder = builder_guards[i]->version_builder();
+        load_statuses[i] = builder->LoadTableHandlers(
             cfd->internal_stats(), 1 /* max_threads */,
             true /* prefetch_index_and_filter_in_cache */,
             false /* is_initial_load */,
             mutable_cf_options_ptrs[i]->prefix_extractor,
             MaxFileSizeForL0MetaPin(*mutable_cf_options_ptrs[i]), read_options,
             mutable_cf_options_ptrs[i]->block_protection_bytes_per_key);
-        if (!s.ok()) {
-          if (db_options_->paranoid_checks) {
-            break;
-          }
-          s = Status::OK();
+      });
+      for (auto& load_status : load_statuses) {
+        if (s.ok() && !load_status.ok() && db_options_->paranoid_checks) {
+          s = load_status;
+        } else {
+          load_status.PermitUncheckedError();
         }
       }
     }
@@ -5701,10 +5880,10 @@ Status VersionSet::ProcessManifestWrites(
       if (!first_writer.edit_list.front()->IsColumnFamilyManipulation()) {
         constexpr bool update_stats = true;
 
-        for (int i = 0; i < static_cast<int>(versions.size()); ++i) {
+        for_each_version([&](size_t i) {
           versions[i]->PrepareAppend(*mutable_cf_options_ptrs[i], read_options,
                                      update_stats);
-        }
+        });
       }
     }
 
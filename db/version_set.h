@@ -207,6 +207,12 @@ class VersionStorageInfo {
   void EstimateCompactionBytesNeeded(
       const MutableCFOptions& mutable_cf_options);
 
+  // Returns the size of `level` beyond which leveled compaction compacts it
+  // into the next level: its target size, times
+  // penultimate_level_compaction_trigger for the level above the last one.
+  uint64_t CompactionTriggerBytesForLevel(
+      int level, const MutableCFOptions& mutable_cf_options) const;
+
   // This computes files_marked_for_compaction_ and is called by
   // ComputeCompactionScore()
   void ComputeFilesMarkedForCompaction(int last_level);
@@ -241,7 +247,8 @@ class VersionStorageInfo {
   void ComputeFilesMarkedForForcedBlobGC(
       double blob_garbage_collection_age_cutoff,
       double blob_garbage_collection_force_threshold,
-      bool enable_blob_garbage_collection);
+      bool enable_blob_garbage_collection,
+      int blob_garbage_collection_force_max_batches = 1);
 
   bool level0_non_overlapping() const { return level0_non_overlapping_; }
 
@@ -576,6 +583,10 @@ class VersionStorageInfo {
 
   double GetEstimatedCompressionRatioAtLevel(int level) const;
 
+  // Returns the first level whose filters the reads skip to keep within
+  // MutableCFOptions::filter_memory_budget, or a level beyond the last one
+  int FirstLevelWithoutFilters() const { return first_level_without_filters_; }
+
   // re-initializes the index that is used to offset into
   // files_by_compaction_pri_
   // to find the next compaction candidate file.
@@ -635,6 +646,8 @@ class VersionStorageInfo {
   void GenerateLevel0NonOverlapping();
   void GenerateBottommostFiles();
   void GenerateFileLocationIndex();
+  void ComputeFirstLevelWithoutFilters(
+      const MutableCFOptions& mutable_cf_options);
 
   const InternalKeyComparator* internal_comparator_;
   const Comparator* user_comparator_;
@@ -749,6 +762,8 @@ class VersionStorageInfo {
   uint64_t accumulated_raw_key_size_;
   // the current accumulated size of all raw keys based on the sampled files.
   uint64_t accumulated_raw_value_size_;
+  // the current accumulated size of the filters of the sampled files.
+  uint64_t accumulated_filter_size_;
   // total number of non-deletion entries
   uint64_t accumulated_num_non_deletions_;
   // total number of deletion entries
@@ -763,6 +778,8 @@ class VersionStorageInfo {
   // target sizes.
   uint64_t estimated_compaction_needed_bytes_;
 
+  int first_level_without_filters_ = std::numeric_limits<int>::max();
+
   // Used for computing bottommost files marked for compaction and checking for
   // offpeak time.
   SystemClock* clock_;
@@ -1054,6 +1071,11 @@ class Version {
   bool IsFilterSkipped(int level, const ReadOptions& read_options,
                        bool is_file_last_in_level = false);
 
+  // Returns false if the level filter of the file, if any, rules out that
+  // the file has an entry for the user key (with timestamp, if any)
+  bool LevelFilterMayMatch(const FileMetaData& file_meta,
+                           const Slice& user_key) const;
+
   // The helper function of UpdateAccumulatedStats, which may fill the missing
   // fields of file_meta from its associated TableProperties.
   // Returns true if it does initialize FileMetaData.
@@ -1556,6 +1578,33 @@ class VersionSet {
 
   const ImmutableDBOptions* db_options() const { return db_options_; }
 
+  // Reserves room for up to `num` more table readers pinned in the metadata
+  // of their file (FileMetaData::table_reader_handle), within
+  // max_pinned_table_readers if set, and returns how many were reserved.
+  // Each reserved reader is given back with UnpinTableReaders() once it is
+  // released or was not pinned after all.
+  size_t ReservePinnedTableReaders(size_t num) {
+    const size_t limit = db_options_->max_pinned_table_readers;
+    size_t pinned = num_pinned_table_readers_.load(std::memory_order_relaxed);
+    size_t reserved;
+    do {
+      reserved =
+          limit == 0 ? num : std::min(num, limit - std::min(limit, pinned));
+    } while (reserved > 0 && !num_pinned_table_readers_.compare_exchange_weak(
+                                 pinned, pinned + reserved,
+                                 std::memory_order_relaxed));
+    return reserved;
+  }
+
+  void UnpinTableReaders(size_t num) {
+    assert(num_pinned_table_readers_.load(std::memory_order_relaxed) >= num);
+    num_pinned_table_readers_.fetch_sub(num, std::memory_order_relaxed);
+  }
+
+  uint64_t TEST_num_pinned_table_readers() const {
+    return num_pinned_table_readers_.load(std::memory_order_relaxed);
+  }
+
   static uint64_t GetNumLiveVersions(Version* dummy_versions);
 
   static uint64_t GetTotalSstFilesSize(Version* dummy_versions);
@@ -1601,6 +1650,7 @@ class VersionSet {
   friend class DBImplReadOnly;
   friend class LocalManifestReader;
   friend class ManifestReader;
+  friend struct CloudManifestReadState;
 
   struct LogReporter : public log::Reader::Reporter {
     Status* status;
@@ -1663,6 +1713,9 @@ class VersionSet {
   const std::string dbname_;
   std::string db_id_;
   const ImmutableDBOptions* const db_options_;
+  // Number of table readers pinned in the metadata of their file, or
+  // reserved to be
+  std::atomic<size_t> num_pinned_table_readers_{0};
   std::atomic<uint64_t> next_file_number_;
   // Any WAL number smaller than this should be ignored during recovery,
   // and is qualified for being deleted.
@@ -21,6 +21,20 @@ DEFINE_SYNC_AND_ASYNC(Status, Version::MultiGetFromSST)
   bool timer_enabled = GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
                        get_perf_context()->per_level_perf_context_enabled;
 
+  if (!skip_filters && f->file_metadata->level_filter) {
+    for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
+      if (!LevelFilterMayMatch(*f->file_metadata, iter->ukey_with_ts)) {
+        file_range.SkipKey(iter);
+      }
+    }
+    if (file_range.empty()) {
+      if (table_handle != nullptr) {
+        table_cache_->get_cache().Release(table_handle);
+      }
+      CO_RETURN Status::OK();
+    }
+  }
+
   Status s;
   StopWatchNano timer(clock_, timer_enabled /* auto_start */);
   s = CO_AWAIT(table_cache_->MultiGet)(
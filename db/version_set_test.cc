@@ -491,6 +491,35 @@ TEST_F(VersionStorageInfoTest, DrainUnnecessaryLevel) {
   ASSERT_GT(vstorage_.CompactionScore(1), 10);
 }
 
+TEST_F(VersionStorageInfoTest, PenultimateLevelCompactionTrigger) {
+  ioptions_.level_compaction_dynamic_level_bytes = false;
+  mutable_cf_options_.max_bytes_for_level_base = 1000;
+  mutable_cf_options_.max_bytes_for_level_multiplier = 10;
+
+  Add(3, 1U, "1", "2", 110000U);   // target size 100000
+  Add(4, 2U, "1", "2", 1500000U);  // target size 1000000
+  Add(5, 3U, "1", "2", 10000000U);
+
+  UpdateVersionStorageInfo();
+  vstorage_.ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  ASSERT_EQ(4, vstorage_.CompactionScoreLevel(0));
+  ASSERT_EQ(3, vstorage_.CompactionScoreLevel(1));
+  ASSERT_GT(vstorage_.CompactionScore(1), 1.0);
+  const uint64_t estimated_bytes =
+      vstorage_.estimated_compaction_needed_bytes();
+
+  // L4 is only compacted into L5 beyond twice its target size, while L3
+  // keeps its trigger
+  mutable_cf_options_.penultimate_level_compaction_trigger = 2;
+  vstorage_.ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  ASSERT_EQ(3, vstorage_.CompactionScoreLevel(0));
+  ASSERT_GT(vstorage_.CompactionScore(0), 1.0);
+  ASSERT_EQ(4, vstorage_.CompactionScoreLevel(1));
+  ASSERT_LT(vstorage_.CompactionScore(1), 1.0);
+  ASSERT_GT(vstorage_.estimated_compaction_needed_bytes(), 0U);
+  ASSERT_LT(vstorage_.estimated_compaction_needed_bytes(), estimated_bytes);
+}
+
 TEST_F(VersionStorageInfoTest, EstimateLiveDataSize) {
   // Test whether the overlaps are detected as expected
   Add(1, 1U, "4", "7", 1U);  // Perfect overlap with last level
@@ -972,6 +1001,117 @@ TEST_F(VersionStorageInfoTest, ForcedBlobGCMultipleBatches) {
   }
 }
 
+TEST_F(VersionStorageInfoTest, ForcedBlobGCDensestBatches) {
+  // Add three L0 SSTs (1, 2, and 3) and three blob files (10, 11, and 12),
+  // each SST's oldest blob file being a different blob file, so that each
+  // blob file is a batch of its own. The newer batches have more garbage than
+  // the oldest one.
+
+  constexpr int level = 0;
+
+  constexpr uint64_t first_sst = 1;
+  constexpr uint64_t second_sst = 2;
+  constexpr uint64_t third_sst = 3;
+
+  constexpr uint64_t first_blob = 10;
+  constexpr uint64_t second_blob = 11;
+  constexpr uint64_t third_blob = 12;
+
+  Add(level, first_sst, "bar1", "foo1", 1000, first_blob);
+  Add(level, second_sst, "bar2", "foo2", 2000, second_blob);
+  Add(level, third_sst, "bar3", "foo3", 3000, third_blob);
+
+  constexpr uint64_t total_blob_count = 10;
+  constexpr uint64_t total_blob_bytes = 100000;
+
+  AddBlob(first_blob, total_blob_count, total_blob_bytes,
+          BlobFileMetaData::LinkedSsts{first_sst},
+          /*garbage_blob_count=*/1, /*garbage_blob_bytes=*/10000);
+  AddBlob(second_blob, total_blob_count, total_blob_bytes,
+          BlobFileMetaData::LinkedSsts{second_sst},
+          /*garbage_blob_count=*/8, /*garbage_blob_bytes=*/80000);
+  AddBlob(third_blob, total_blob_count, total_blob_bytes,
+          BlobFileMetaData::LinkedSsts{third_sst},
+          /*garbage_blob_count=*/5, /*garbage_blob_bytes=*/50000);
+
+  UpdateVersionStorageInfo();
+
+  const auto& level_files = vstorage_.LevelFiles(level);
+  ASSERT_EQ(level_files.size(), 3);
+
+  // Only the oldest batch is considered by default, and its garbage ratio is
+  // below threshold
+
+  {
+    constexpr double age_cutoff = 1.0;
+    constexpr double force_threshold = 0.4;
+    vstorage_.ComputeFilesMarkedForForcedBlobGC(
+        age_cutoff, force_threshold, /*enable_blob_garbage_collection=*/true);
+
+    ASSERT_TRUE(vstorage_.FilesMarkedForForcedBlobGC().empty());
+  }
+
+  // The newer batches meeting the threshold are targeted, densest first
+
+  {
+    constexpr double age_cutoff = 1.0;
+    constexpr double force_threshold = 0.4;
+    vstorage_.ComputeFilesMarkedForForcedBlobGC(
+        age_cutoff, force_threshold, /*enable_blob_garbage_collection=*/true,
+        /*blob_garbage_collection_force_max_batches=*/3);
+
+    const autovector<std::pair<int, FileMetaData*>>
+        expected_ssts_to_be_compacted{{level, level_files[1]},
+                                      {level, level_files[2]}};
+    const auto& ssts_to_be_compacted = vstorage_.FilesMarkedForForcedBlobGC();
+    ASSERT_EQ(ssts_to_be_compacted.size(),
+              expected_ssts_to_be_compacted.size());
+    for (size_t i = 0; i < ssts_to_be_compacted.size(); ++i) {
+      ASSERT_EQ(ssts_to_be_compacted[i], expected_ssts_to_be_compacted[i]);
+    }
+  }
+
+  // The oldest batch comes first when it meets the threshold, and the number
+  // of batches is limited
+
+  {
+    constexpr double age_cutoff = 1.0;
+    constexpr double force_threshold = 0.05;
+    vstorage_.ComputeFilesMarkedForForcedBlobGC(
+        age_cutoff, force_threshold, /*enable_blob_garbage_collection=*/true,
+        /*blob_garbage_collection_force_max_batches=*/2);
+
+    const autovector<std::pair<int, FileMetaData*>>
+        expected_ssts_to_be_compacted{{level, level_files[0]},
+                                      {level, level_files[1]}};
+    const auto& ssts_to_be_compacted = vstorage_.FilesMarkedForForcedBlobGC();
+    ASSERT_EQ(ssts_to_be_compacted.size(),
+              expected_ssts_to_be_compacted.size());
+    for (size_t i = 0; i < ssts_to_be_compacted.size(); ++i) {
+      ASSERT_EQ(ssts_to_be_compacted[i], expected_ssts_to_be_compacted[i]);
+    }
+  }
+
+  // The newest batch is not eligible for GC due to the age cutoff
+
+  {
+    constexpr double age_cutoff = 0.7;
+    constexpr double force_threshold = 0.4;
+    vstorage_.ComputeFilesMarkedForForcedBlobGC(
+        age_cutoff, force_threshold, /*enable_blob_garbage_collection=*/true,
+        /*blob_garbage_collection_force_max_batches=*/3);
+
+    const autovector<std::pair<int, FileMetaData*>>
+        expected_ssts_to_be_compacted{{level, level_files[1]}};
+    const auto& ssts_to_be_compacted = vstorage_.FilesMarkedForForcedBlobGC();
+    ASSERT_EQ(ssts_to_be_compacted.size(),
+              expected_ssts_to_be_compacted.size());
+    for (size_t i = 0; i < ssts_to_be_compacted.size(); ++i) {
+      ASSERT_EQ(ssts_to_be_compacted[i], expected_ssts_to_be_compacted[i]);
+    }
+  }
+}
+
 class VersionStorageInfoTimestampTest : public VersionStorageInfoTestBase {
  public:
   VersionStorageInfoTimestampTest()
@@ -236,6 +236,77 @@ TEST_F(DBWideBasicTest, PutEntityColumnFamily) {
   ASSERT_OK(db_->Write(WriteOptions(), &batch));
 }
 
+TEST_F(DBWideBasicTest, IteratorColumnProjection) {
+  Options options = GetDefaultOptions();
+  Reopen(options);
+
+  constexpr char first_key[] = "first";
+  WideColumns first_columns{{kDefaultWideColumnName, "hello"},
+                            {"attr_name1", "foo"},
+                            {"attr_name2", "bar"}};
+  constexpr char second_key[] = "second";
+  WideColumns second_columns{{"attr_name2", "two"}, {"attr_three", "four"}};
+  constexpr char third_key[] = "third";
+  constexpr char third_value[] = "baz";
+
+  ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                           first_key, first_columns));
+  ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                           second_key, second_columns));
+  ASSERT_OK(db_->Put(WriteOptions(), third_key, third_value));
+
+  auto verify = [&]() {
+    // Unsorted, with duplicates and a column no entity has
+    const std::vector<Slice> projection{"attr_name2", "missing", "attr_name2"};
+    ReadOptions read_options;
+    read_options.column_projection = &projection;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->key(), first_key);
+    ASSERT_TRUE(iter->value().empty());
+    WideColumns expected_first{{"attr_name2", "bar"}};
+    ASSERT_EQ(iter->columns(), expected_first);
+
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->key(), second_key);
+    WideColumns expected_second{{"attr_name2", "two"}};
+    ASSERT_EQ(iter->columns(), expected_second);
+
+    // Plain key-values are not projected
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->key(), third_key);
+    ASSERT_EQ(iter->value(), third_value);
+    WideColumns expected_third{{kDefaultWideColumnName, third_value}};
+    ASSERT_EQ(iter->columns(), expected_third);
+
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+
+    // The default column is the value only if it is projected
+    const std::vector<Slice> default_projection{kDefaultWideColumnName};
+    read_options.column_projection = &default_projection;
+    iter.reset(db_->NewIterator(read_options));
+    iter->SeekForPrev(first_key);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->value(), "hello");
+    WideColumns expected_default{{kDefaultWideColumnName, "hello"}};
+    ASSERT_EQ(iter->columns(), expected_default);
+    ASSERT_OK(iter->status());
+  };
+
+  // Try reading from memtable
+  verify();
+
+  // Try reading from storage
+  ASSERT_OK(Flush());
+  verify();
+}
+
 TEST_F(DBWideBasicTest, GetEntityAsPinnableAttributeGroups) {
   Options options = GetDefaultOptions();
   CreateAndReopenWithCF({"hot_cf", "cold_cf"}, options);
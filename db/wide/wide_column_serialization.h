@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "rocksdb/rocksdb_namespace.h"
 #include "rocksdb/status.h"
@@ -47,6 +48,13 @@ class WideColumnSerialization {
 
   static Status Deserialize(Slice& input, WideColumns& columns);
 
+  // Same as above, but only the columns named in column_names, which are
+  // sorted by name without duplicates, are returned. The values of the other
+  // columns are skipped.
+  static Status Deserialize(Slice& input,
+                            const std::vector<Slice>& column_names,
+                            WideColumns& columns);
+
   static WideColumns::const_iterator Find(const WideColumns& columns,
                                           const Slice& column_name);
   static Status GetValueOfDefaultColumn(Slice& input, Slice& value);
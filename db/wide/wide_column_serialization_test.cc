@@ -124,6 +124,56 @@ TEST(WideColumnSerializationTest, SerializeDeserialize) {
   }
 }
 
+TEST(WideColumnSerializationTest, DeserializeProjection) {
+  WideColumns columns{{kDefaultWideColumnName, "baz"},
+                      {"foo", "bar"},
+                      {"hello", "world"},
+                      {"snafu", "fubar"}};
+  std::string output;
+
+  ASSERT_OK(WideColumnSerialization::Serialize(columns, output));
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(WideColumnSerialization::Deserialize(
+        input, {"bad", "foo", "snafu", "zzz"}, deserialized_columns));
+    WideColumns expected_columns{{"foo", "bar"}, {"snafu", "fubar"}};
+    ASSERT_EQ(deserialized_columns, expected_columns);
+  }
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(WideColumnSerialization::Deserialize(
+        input, {kDefaultWideColumnName}, deserialized_columns));
+    WideColumns expected_columns{{kDefaultWideColumnName, "baz"}};
+    ASSERT_EQ(deserialized_columns, expected_columns);
+  }
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(
+        WideColumnSerialization::Deserialize(input, {}, deserialized_columns));
+    ASSERT_TRUE(deserialized_columns.empty());
+  }
+
+  {
+    // The payload is checked even if no values are returned
+    std::string truncated(output, 0, output.size() - 1);
+    Slice input(truncated);
+    WideColumns deserialized_columns;
+
+    ASSERT_TRUE(WideColumnSerialization::Deserialize(input, {"foo"},
+                                                     deserialized_columns)
+                    .IsCorruption());
+  }
+}
+
 TEST(WideColumnSerializationTest, SerializeDuplicateError) {
   WideColumns columns{{"foo", "bar"}, {"foo", "baz"}};
   std::string output;
@@ -69,6 +69,7 @@
 #include "util/cast_util.h"
 #include "util/coding.h"
 #include "util/duplicate_detector.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -335,6 +336,15 @@ bool WriteBatch::HasMerge() const {
   return (ComputeContentFlags() & ContentFlags::HAS_MERGE) != 0;
 }
 
+bool WriteBatchInternal::HasMerge(const Slice& contents) {
+  assert(contents.size() >= WriteBatchInternal::kHeader);
+  BatchContentClassifier classifier;
+  Iterate(contents, ContentFlags::DEFERRED, &classifier,
+          WriteBatchInternal::kHeader, contents.size())
+      .PermitUncheckedError();
+  return (classifier.content_flags & ContentFlags::HAS_MERGE) != 0;
+}
+
 bool ReadKeyFromWriteBatchEntry(Slice* input, Slice* key, bool cf_record) {
   assert(input != nullptr && key != nullptr);
   // Skip tag byte
@@ -509,13 +519,24 @@ Status WriteBatch::Iterate(Handler* handler) const {
 Status WriteBatchInternal::Iterate(const WriteBatch* wb,
                                    WriteBatch::Handler* handler, size_t begin,
                                    size_t end) {
-  if (begin > wb->rep_.size() || end > wb->rep_.size() || end < begin) {
+  return Iterate(Slice(wb->rep_),
+                 wb->content_flags_.load(std::memory_order_relaxed), handler,
+                 begin, end);
+}
+
+Status WriteBatchInternal::Iterate(const Slice& rep, uint32_t content_flags,
+                                   WriteBatch::Handler* handler, size_t begin,
+                                   size_t end) {
+#ifdef NDEBUG
+  (void)content_flags;
+#endif
+  if (begin > rep.size() || end > rep.size() || end < begin) {
     return Status::Corruption("Invalid start/end bounds for Iterate");
   }
   assert(begin <= end);
-  Slice input(wb->rep_.data() + begin, static_cast<size_t>(end - begin));
+  Slice input(rep.data() + begin, static_cast<size_t>(end - begin));
   bool whole_batch =
-      (begin == WriteBatchInternal::kHeader) && (end == wb->rep_.size());
+      (begin == WriteBatchInternal::kHeader) && (end == rep.size());
 
   Slice key, value, blob, xid;
   uint64_t write_unix_time = 0;
@@ -562,7 +583,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
     switch (tag) {
       case kTypeColumnFamilyValue:
       case kTypeValue:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_PUT));
         s = handler->PutCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -572,7 +593,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeColumnFamilyDeletion:
       case kTypeDeletion:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_DELETE));
         s = handler->DeleteCF(column_family, key);
         if (LIKELY(s.ok())) {
@@ -582,7 +603,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeColumnFamilySingleDeletion:
       case kTypeSingleDeletion:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_SINGLE_DELETE));
         s = handler->SingleDeleteCF(column_family, key);
         if (LIKELY(s.ok())) {
@@ -592,7 +613,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeColumnFamilyRangeDeletion:
       case kTypeRangeDeletion:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_DELETE_RANGE));
         s = handler->DeleteRangeCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -602,7 +623,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeColumnFamilyMerge:
       case kTypeMerge:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_MERGE));
         s = handler->MergeCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -612,7 +633,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeColumnFamilyBlobIndex:
       case kTypeBlobIndex:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BLOB_INDEX));
         s = handler->PutBlobIndexCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -625,7 +646,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         empty_batch = false;
         break;
       case kTypeBeginPrepareXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
         s = handler->MarkBeginPrepare();
         assert(s.ok());
@@ -647,7 +668,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         }
         break;
       case kTypeBeginPersistedPrepareXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
         s = handler->MarkBeginPrepare();
         assert(s.ok());
@@ -662,7 +683,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         }
         break;
       case kTypeBeginUnprepareXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_UNPREPARE));
         s = handler->MarkBeginPrepare(true /* unprepared */);
         assert(s.ok());
@@ -684,21 +705,21 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         }
         break;
       case kTypeEndPrepareXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_END_PREPARE));
         s = handler->MarkEndPrepare(xid);
         assert(s.ok());
         empty_batch = true;
         break;
       case kTypeCommitXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_COMMIT));
         s = handler->MarkCommit(xid);
         assert(s.ok());
         empty_batch = true;
         break;
       case kTypeCommitXIDAndTimestamp:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_COMMIT));
         // key stores the commit timestamp.
         assert(!key.empty());
@@ -708,7 +729,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         }
         break;
       case kTypeRollbackXID:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_ROLLBACK));
         s = handler->MarkRollback(xid);
         assert(s.ok());
@@ -721,7 +742,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeWideColumnEntity:
       case kTypeColumnFamilyWideColumnEntity:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_PUT_ENTITY));
         s = handler->PutEntityCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -731,7 +752,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
         break;
       case kTypeValuePreferredSeqno:
       case kTypeColumnFamilyValuePreferredSeqno:
-        assert(wb->content_flags_.load(std::memory_order_relaxed) &
+        assert(content_flags &
                (ContentFlags::DEFERRED | ContentFlags::HAS_TIMED_PUT));
         s = handler->TimedPutCF(column_family, key, value, write_unix_time);
         if (LIKELY(s.ok())) {
@@ -747,7 +768,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
     return s;
   }
   if (handler_continue && whole_batch &&
-      found != WriteBatchInternal::Count(wb)) {
+      found != DecodeFixed32(rep.data() + 8)) {
     return Status::Corruption("WriteBatch has wrong count");
   } else {
     return Status::OK();
@@ -1871,6 +1892,99 @@ Status WriteBatch::VerifyChecksum() const {
 
 namespace {
 
+// Finds the Put and Delete entries of a write group that are overwritten by a
+// later Put or Delete of the same key in the same write group. The entries
+// are numbered in the order they are inserted into the memtables.
+class OverwriteCollector : public WriteBatch::Handler {
+ public:
+  explicit OverwriteCollector(std::vector<bool>* overwritten)
+      : overwritten_(overwritten) {}
+
+  Status PutCF(uint32_t column_family_id, const Slice& key,
+               const Slice& /*value*/) override {
+    Overwrite(column_family_id, key);
+    return Status::OK();
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+    Overwrite(column_family_id, key);
+    return Status::OK();
+  }
+
+  // The entries below depend on the older versions of their key, so the
+  // entries before them are kept
+  Status SingleDeleteCF(uint32_t column_family_id, const Slice& key) override {
+    last_entry_.erase(CFKey{column_family_id, key});
+    return Status::OK();
+  }
+
+  Status MergeCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& /*value*/) override {
+    last_entry_.erase(CFKey{column_family_id, key});
+    return Status::OK();
+  }
+
+  Status TimedPutCF(uint32_t column_family_id, const Slice& key,
+                    const Slice& /*value*/,
+                    uint64_t /*unix_write_time*/) override {
+    last_entry_.erase(CFKey{column_family_id, key});
+    return Status::OK();
+  }
+
+  Status PutEntityCF(uint32_t column_family_id, const Slice& key,
+                     const Slice& /*entity*/) override {
+    last_entry_.erase(CFKey{column_family_id, key});
+    return Status::OK();
+  }
+
+  Status PutBlobIndexCF(uint32_t column_family_id, const Slice& key,
+                        const Slice& /*value*/) override {
+    last_entry_.erase(CFKey{column_family_id, key});
+    return Status::OK();
+  }
+
+  // A range deletion does not change which version of a key is the newest
+  Status DeleteRangeCF(uint32_t /*column_family_id*/,
+                       const Slice& /*begin_key*/,
+                       const Slice& /*end_key*/) override {
+    return Status::OK();
+  }
+
+  // The transaction markers are left to the default handlers, which fail
+  // the collection
+
+ private:
+  struct CFKey {
+    uint32_t column_family_id;
+    Slice key;
+
+    bool operator==(const CFKey& other) const {
+      return column_family_id == other.column_family_id && key == other.key;
+    }
+  };
+
+  struct CFKeyHash {
+    size_t operator()(const CFKey& k) const {
+      return static_cast<size_t>(GetSliceNPHash64(k.key, k.column_family_id));
+    }
+  };
+
+  void Overwrite(uint32_t column_family_id, const Slice& key) {
+    const size_t idx = overwritten_->size();
+    auto res = last_entry_.emplace(CFKey{column_family_id, key}, idx);
+    if (!res.second) {
+      (*overwritten_)[res.first->second] = true;
+      res.first->second = idx;
+    }
+    overwritten_->push_back(false);
+  }
+
+  std::vector<bool>* const overwritten_;
+  // The index of the last Put or Delete of each key, unless followed by an
+  // entry that depends on it
+  std::unordered_map<CFKey, size_t, CFKeyHash> last_entry_;
+};
+
 class MemTableInserter : public WriteBatch::Handler {
   SequenceNumber sequence_;
   ColumnFamilyMemTables* const cf_mems_;
@@ -1881,6 +1995,7 @@ class MemTableInserter : public WriteBatch::Handler {
   // log number that all Memtables inserted into should reference
   uint64_t log_number_ref_;
   DBImpl* db_;
+  PointLookupCache* const point_lookup_cache_;
   const bool concurrent_memtable_writes_;
   bool post_info_created_;
   const WriteBatch::ProtectionInfo* prot_info_;
@@ -1918,6 +2033,22 @@ class MemTableInserter : public WriteBatch::Handler {
   using HintMapType = std::aligned_storage<sizeof(HintMap)>::type;
   HintMapType hint_;
 
+  // The entries of a batch with at least this many entries are inserted into
+  // the memtable of each column family in key order; 0 if never
+  const size_t sorted_insert_threshold_;
+  // Whether the entries of the current batch are inserted in key order
+  bool sorted_insert_;
+  // The memtables deferring the inserts of the current batch
+  autovector<MemTable*> sorted_insert_mems_;
+
+  // Whether the Put and Delete entries overwritten later in the write group
+  // are skipped
+  const bool collapse_overwrites_;
+  // Whether each Put and Delete entry of the write group, in insert order, is
+  // overwritten later in the write group; empty if none is skipped
+  std::vector<bool> overwritten_;
+  size_t overwritten_idx_;
+
   HintMap& GetHintMap() {
     assert(hint_per_batch_);
     if (!hint_created_) {
@@ -1947,6 +2078,27 @@ class MemTableInserter : public WriteBatch::Handler {
         ->IsDuplicateKeySeq(column_family_id, key, sequence_);
   }
 
+  // Returns true if the current Put or Delete entry, which is overwritten
+  // later in the write group, was skipped. It still consumes its sequence
+  // number.
+  bool SkipOverwritten(uint32_t column_family_id) {
+    if (overwritten_.empty()) {
+      return false;
+    }
+    assert(overwritten_idx_ < overwritten_.size());
+    if (!overwritten_[overwritten_idx_++]) {
+      return false;
+    }
+    // A missing column family is reported by the regular insert
+    if (!cf_mems_->Seek(column_family_id) || cf_mems_->GetMemTable()
+                                                 ->GetImmutableMemTableOptions()
+                                                 ->inplace_update_support) {
+      return false;
+    }
+    MaybeAdvanceSeq();
+    return true;
+  }
+
   const ProtectionInfoKVOC64* NextProtectionInfo() {
     const ProtectionInfoKVOC64* res = nullptr;
     if (prot_info_ != nullptr) {
@@ -1968,6 +2120,30 @@ class MemTableInserter : public WriteBatch::Handler {
     prot_info_ = nullptr;
   }
 
+  // Returns the memtable of the current column family, which defers its
+  // inserts when the current batch is inserted in key order
+  MemTable* GetMemTableForInsert() {
+    MemTable* mem = cf_mems_->GetMemTable();
+    if (sorted_insert_ && mem->StartSortedInsert()) {
+      sorted_insert_mems_.push_back(mem);
+    }
+    return mem;
+  }
+
+  // Invalidates the cached Get() results of key, or of all the keys for a
+  // range deletion. Must be called before the write is published.
+  void InvalidatePointLookups(uint32_t column_family_id, const Slice& key,
+                              ValueType value_type) {
+    if (point_lookup_cache_ == nullptr) {
+      return;
+    }
+    if (value_type == kTypeRangeDeletion) {
+      point_lookup_cache_->InvalidateRange(sequence_);
+    } else {
+      point_lookup_cache_->Invalidate(column_family_id, key, sequence_);
+    }
+  }
+
  protected:
   Handler::OptionState WriteBeforePrepare() const override {
     return write_before_prepare_ ? Handler::OptionState::kEnabled
@@ -1997,6 +2173,8 @@ class MemTableInserter : public WriteBatch::Handler {
         recovering_log_number_(recovering_log_number),
         log_number_ref_(0),
         db_(static_cast_with_check<DBImpl>(db)),
+        point_lookup_cache_(db_ != nullptr ? db_->point_lookup_cache()
+                                           : nullptr),
         concurrent_memtable_writes_(concurrent_memtable_writes),
         post_info_created_(false),
         prot_info_(prot_info),
@@ -2016,7 +2194,18 @@ class MemTableInserter : public WriteBatch::Handler {
         duplicate_detector_(),
         dup_dectector_on_(false),
         hint_per_batch_(hint_per_batch),
-        hint_created_(false) {
+        hint_created_(false),
+        // The inserts of seq_per_batch_ batches may have to be retried with
+        // another sequence number
+        sorted_insert_threshold_(
+            db_ != nullptr && !concurrent_memtable_writes && !seq_per_batch
+                ? db_->immutable_db_options().memtable_sorted_insert_threshold
+                : 0),
+        sorted_insert_(false),
+        collapse_overwrites_(
+            db_ != nullptr && !concurrent_memtable_writes && !seq_per_batch &&
+            db_->immutable_db_options().memtable_collapse_overwrites),
+        overwritten_idx_(0) {
     assert(cf_mems_);
   }
 
@@ -2064,6 +2253,53 @@ class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence() const { return sequence_; }
 
+  // Called before the num_entries entries of a batch are inserted
+  void StartBatch(uint32_t num_entries) {
+    assert(!sorted_insert_);
+    sorted_insert_ = sorted_insert_threshold_ > 0 &&
+                     num_entries >= sorted_insert_threshold_;
+  }
+
+  // Called after the entries of a batch were inserted, successfully or not,
+  // before their sequence numbers are published
+  Status FinishBatch() {
+    Status s;
+    for (MemTable* mem : sorted_insert_mems_) {
+      Status finish_status = mem->FinishSortedInsert();
+      if (s.ok()) {
+        s = finish_status;
+      }
+    }
+    sorted_insert_mems_.clear();
+    sorted_insert_ = false;
+    return s;
+  }
+
+  // Finds the Put and Delete entries of write_group that are overwritten
+  // later in it, which are then skipped if overwrites are collapsed. Must be
+  // called before the write group is inserted.
+  void CollectOverwrites(WriteThread::WriteGroup& write_group) {
+    assert(overwritten_.empty());
+    if (!collapse_overwrites_) {
+      return;
+    }
+    OverwriteCollector collector(&overwritten_);
+    for (auto w : write_group) {
+      if (w->CallbackFailed() || !w->ShouldWriteToMemtable()) {
+        continue;
+      }
+      // The entries of a transaction reference its prepare section
+      if (w->log_ref != 0 || !w->batch->Iterate(&collector).ok()) {
+        overwritten_.clear();
+        return;
+      }
+    }
+    if (std::find(overwritten_.begin(), overwritten_.end(), true) ==
+        overwritten_.end()) {
+      overwritten_.clear();
+    }
+  }
+
   void PostProcess() {
     assert(concurrent_memtable_writes_);
     // If post info was not created there is nothing
@@ -2143,8 +2379,9 @@ class MemTableInserter : public WriteBatch::Handler {
       return ret_status;
     }
     assert(ret_status.ok());
+    InvalidatePointLookups(column_family_id, key, value_type);
 
-    MemTable* mem = cf_mems_->GetMemTable();
+    MemTable* mem = GetMemTableForInsert();
     auto* moptions = mem->GetImmutableMemTableOptions();
     // inplace_update_support is inconsistent with snapshots, and therefore with
     // any kind of transactions including the ones that use seq_per_batch
@@ -2266,6 +2503,9 @@ class MemTableInserter : public WriteBatch::Handler {
   Status PutCF(uint32_t column_family_id, const Slice& key,
                const Slice& value) override {
     const auto* kv_prot_info = NextProtectionInfo();
+    if (UNLIKELY(SkipOverwritten(column_family_id))) {
+      return Status::OK();
+    }
     Status ret_status;
     if (kv_prot_info != nullptr) {
       // Memtable needs seqno, doesn't need CF ID
@@ -2338,11 +2578,12 @@ class MemTableInserter : public WriteBatch::Handler {
     return s;
   }
 
-  Status DeleteImpl(uint32_t /*column_family_id*/, const Slice& key,
+  Status DeleteImpl(uint32_t column_family_id, const Slice& key,
                     const Slice& value, ValueType delete_type,
                     const ProtectionInfoKVOS64* kv_prot_info) {
     Status ret_status;
-    MemTable* mem = cf_mems_->GetMemTable();
+    InvalidatePointLookups(column_family_id, key, delete_type);
+    MemTable* mem = GetMemTableForInsert();
     ret_status =
         mem->Add(sequence_, delete_type, key, value, kv_prot_info,
                  concurrent_memtable_writes_, get_post_process_info(mem),
@@ -2360,6 +2601,9 @@ class MemTableInserter : public WriteBatch::Handler {
 
   Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
     const auto* kv_prot_info = NextProtectionInfo();
+    if (UNLIKELY(SkipOverwritten(column_family_id))) {
+      return Status::OK();
+    }
     // optimize for non-recovery mode
     if (UNLIKELY(write_after_commit_ && rebuilding_trx_ != nullptr)) {
       // TODO(ajkr): propagate `ProtectionInfoKVOS64`.
@@ -2602,13 +2846,40 @@ class MemTableInserter : public WriteBatch::Handler {
       return ret_status;
     }
     assert(ret_status.ok());
+    InvalidatePointLookups(column_family_id, key, kTypeMerge);
 
-    MemTable* mem = cf_mems_->GetMemTable();
+    MemTable* mem = GetMemTableForInsert();
     auto* moptions = mem->GetImmutableMemTableOptions();
     if (moptions->merge_operator == nullptr) {
       return Status::InvalidArgument(
           "Merge requires `ColumnFamilyOptions::merge_operator != nullptr`");
     }
+    // Fold the operand into the newest entry of the key, unless a snapshot
+    // may read that entry or the key belongs to a transaction
+    if (moptions->inplace_merge_support && !seq_per_batch_ &&
+        rebuilding_trx_ == nullptr) {
+      assert(!concurrent_memtable_writes_);
+      SequenceNumber newest_snapshot =
+          db_ != nullptr ? db_->snapshots().GetNewestNoLock() : 0;
+      if (kv_prot_info != nullptr) {
+        auto mem_kv_prot_info =
+            kv_prot_info->StripC(column_family_id).ProtectS(sequence_);
+        ret_status = mem->MergeInPlace(sequence_, key, value, newest_snapshot,
+                                       &mem_kv_prot_info);
+      } else {
+        ret_status = mem->MergeInPlace(sequence_, key, value, newest_snapshot,
+                                       nullptr /* kv_prot_info */);
+      }
+      if (ret_status.ok()) {
+        MaybeAdvanceSeq();
+        CheckMemtableFull();
+        return ret_status;
+      } else if (!ret_status.IsNotFound()) {
+        return ret_status;
+      }
+      ret_status = Status::OK();
+    }
+
     bool perform_merge = false;
     assert(!concurrent_memtable_writes_ ||
            moptions->max_successive_merges == 0);
@@ -3073,6 +3344,7 @@ Status WriteBatchInternal::InsertInto(
       ignore_missing_column_families, recovery_log_number, db,
       concurrent_memtable_writes, nullptr /* prot_info */,
       nullptr /*has_valid_writes*/, seq_per_batch, batch_per_txn);
+  inserter.CollectOverwrites(write_group);
   for (auto w : write_group) {
     if (w->CallbackFailed()) {
       continue;
@@ -3086,7 +3358,12 @@ Status WriteBatchInternal::InsertInto(
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
     inserter.set_prot_info(w->batch->prot_info_.get());
+    inserter.StartBatch(WriteBatchInternal::Count(w->batch));
     w->status = w->batch->Iterate(&inserter);
+    Status finish_status = inserter.FinishBatch();
+    if (w->status.ok()) {
+      w->status = finish_status;
+    }
     if (!w->status.ok()) {
       return w->status;
     }
@@ -3116,7 +3393,12 @@ Status WriteBatchInternal::InsertInto(
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
   inserter.set_prot_info(writer->batch->prot_info_.get());
+  inserter.StartBatch(WriteBatchInternal::Count(writer->batch));
   Status s = writer->batch->Iterate(&inserter);
+  Status finish_status = inserter.FinishBatch();
+  if (s.ok()) {
+    s = finish_status;
+  }
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -3137,7 +3419,43 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, batch->prot_info_.get(),
                             has_valid_writes, seq_per_batch, batch_per_txn);
+  inserter.StartBatch(WriteBatchInternal::Count(batch));
   Status s = batch->Iterate(&inserter);
+  Status finish_status = inserter.FinishBatch();
+  if (s.ok()) {
+    s = finish_status;
+  }
+  if (next_seq != nullptr) {
+    *next_seq = inserter.sequence();
+  }
+  if (concurrent_memtable_writes) {
+    inserter.PostProcess();
+  }
+  return s;
+}
+
+Status WriteBatchInternal::InsertInto(
+    const Slice& contents, ColumnFamilyMemTables* memtables,
+    FlushScheduler* flush_scheduler,
+    TrimHistoryScheduler* trim_history_scheduler,
+    bool ignore_missing_column_families, uint64_t log_number, DB* db,
+    bool concurrent_memtable_writes, SequenceNumber* next_seq,
+    bool* has_valid_writes, bool seq_per_batch, bool batch_per_txn) {
+  if (contents.size() < WriteBatchInternal::kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  MemTableInserter inserter(DecodeFixed64(contents.data()), memtables,
+                            flush_scheduler, trim_history_scheduler,
+                            ignore_missing_column_families, log_number, db,
+                            concurrent_memtable_writes, nullptr /* prot_info */,
+                            has_valid_writes, seq_per_batch, batch_per_txn);
+  inserter.StartBatch(DecodeFixed32(contents.data() + 8));
+  Status s = Iterate(contents, ContentFlags::DEFERRED, &inserter,
+                     WriteBatchInternal::kHeader, contents.size());
+  Status finish_status = inserter.FinishBatch();
+  if (s.ok()) {
+    s = finish_status;
+  }
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
@@ -202,6 +202,17 @@ class WriteBatchInternal {
       SequenceNumber* next_seq = nullptr, bool* has_valid_writes = nullptr,
       bool seq_per_batch = false, bool batch_per_txn = true);
 
+  // Same as above for the contents of a write batch held outside of a
+  // WriteBatch, e.g. a replication log record, so they don't have to be copied
+  static Status InsertInto(
+      const Slice& contents, ColumnFamilyMemTables* memtables,
+      FlushScheduler* flush_scheduler,
+      TrimHistoryScheduler* trim_history_scheduler,
+      bool ignore_missing_column_families = false, uint64_t log_number = 0,
+      DB* db = nullptr, bool concurrent_memtable_writes = false,
+      SequenceNumber* next_seq = nullptr, bool* has_valid_writes = nullptr,
+      bool seq_per_batch = false, bool batch_per_txn = true);
+
   static Status InsertInto(WriteThread::Writer* writer, SequenceNumber sequence,
                            ColumnFamilyMemTables* memtables,
                            FlushScheduler* flush_scheduler,
@@ -227,6 +238,14 @@ class WriteBatchInternal {
   // Iterate over [begin, end) range of a write batch
   static Status Iterate(const WriteBatch* wb, WriteBatch::Handler* handler,
                         size_t begin, size_t end);
+  // Iterate over [begin, end) range of the write batch contents rep, whose
+  // ContentFlags are content_flags
+  static Status Iterate(const Slice& rep, uint32_t content_flags,
+                        WriteBatch::Handler* handler, size_t begin, size_t end);
+
+  // Returns true if the write batch contents have a merge operand. The
+  // contents must be at least kHeader bytes.
+  static bool HasMerge(const Slice& contents);
 
   // This write batch includes the latest state that should be persisted. Such
   // state meant to be used only during recovery.
@@ -5,6 +5,7 @@
 
 #include "db/write_thread.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -26,6 +27,7 @@ WriteThread::WriteThread(const ImmutableDBOptions& db_options)
       enable_pipelined_write_(db_options.enable_pipelined_write),
       max_write_batch_group_size_bytes(
           db_options.max_write_batch_group_size_bytes),
+      max_linger_usec_(db_options.write_group_linger_usec),
       newest_writer_(nullptr),
       newest_memtable_writer_(nullptr),
       last_sequence_(0),
@@ -402,6 +404,9 @@ void WriteThread::JoinBatchGroup(Writer* w) {
   TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:Start", w);
   assert(w->batch != nullptr);
 
+  if (max_linger_usec_ > 0) {
+    RecordJoin();
+  }
   bool linked_as_leader = LinkOne(w, &newest_writer_);
 
   if (linked_as_leader) {
@@ -434,12 +439,58 @@ void WriteThread::JoinBatchGroup(Writer* w) {
   }
 }
 
+void WriteThread::RecordJoin() {
+  const uint64_t now = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+  const uint64_t last = last_join_nanos_.exchange(now);
+  if (last != 0 && now > last) {
+    // A pause in the writes longer than any linger only needs to show that
+    // no writer is expected in time, without holding up the average
+    UpdateAverage(&avg_join_interval_nanos_,
+                  std::min(now - last, 2 * max_linger_usec_ * 1000));
+  }
+  joined_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WriteThread::LingerForWriters(Writer* leader) {
+  if (max_linger_usec_ == 0 || !leader->sync || leader->disable_wal ||
+      !leader->status.ok()) {
+    return;
+  }
+  // Waiting longer than a WAL sync would hold up the writers more than
+  // syncing for them in the next group
+  const uint64_t linger_nanos =
+      std::min(max_linger_usec_ * 1000,
+               avg_wal_sync_nanos_.load(std::memory_order_relaxed));
+  const uint64_t join_interval_nanos =
+      avg_join_interval_nanos_.load(std::memory_order_relaxed);
+  if (join_interval_nanos == 0 || join_interval_nanos >= linger_nanos) {
+    return;
+  }
+  // Stop waiting once as many writers as expected in the wait joined
+  const uint64_t expected = linger_nanos / join_interval_nanos;
+  const uint64_t joined_before =
+      joined_count_.load(std::memory_order_relaxed);
+  TEST_SYNC_POINT_CALLBACK("WriteThread::LingerForWriters:Begin", leader);
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::nanoseconds(linger_nanos);
+  while (joined_count_.load(std::memory_order_relaxed) - joined_before <
+             expected &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
 size_t WriteThread::EnterAsBatchGroupLeader(Writer* leader,
                                             WriteGroup* write_group) {
   assert(leader->link_older == nullptr);
   assert(leader->batch != nullptr);
   assert(write_group != nullptr);
 
+  LingerForWriters(leader);
+
   size_t size = WriteBatchInternal::ByteSize(leader->batch);
 
   // Allow the group to grow up to a maximum size, but if the
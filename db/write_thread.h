@@ -126,6 +126,7 @@ class WriteThread {
     PostMemTableCallback* post_memtable_callback;
     uint64_t log_used;  // log number that this batch was inserted into
     uint64_t log_ref;   // log number that memtable insert should reference
+    bool wal_sync_deferred;  // WAL to be synced by the memtable writer
     WriteCallback* callback;
     bool made_waitable;          // records lazy construction of mutex and cv
     std::atomic<uint8_t> state;  // write under StateMutex() or pre-link
@@ -152,6 +153,7 @@ class WriteThread {
           post_memtable_callback(nullptr),
           log_used(0),
           log_ref(0),
+          wal_sync_deferred(false),
           callback(nullptr),
           made_waitable(false),
           state(STATE_INIT),
@@ -179,6 +181,7 @@ class WriteThread {
           post_memtable_callback(_post_memtable_callback),
           log_used(0),
           log_ref(_log_ref),
+          wal_sync_deferred(false),
           callback(_callback),
           made_waitable(false),
           state(STATE_INIT),
@@ -357,6 +360,15 @@ class WriteThread {
     return last_sequence_;
   }
 
+  // Records how long the WAL sync of a write group took, which bounds how
+  // long later leaders of sync write groups wait for more writers. See
+  // DBOptions::write_group_linger_usec.
+  void RecordWalSyncTime(uint64_t micros) {
+    if (max_linger_usec_ > 0) {
+      UpdateAverage(&avg_wal_sync_nanos_, micros * 1000);
+    }
+  }
+
   // Insert a dummy writer at the tail of the write queue to indicate a write
   // stall, and fail any writers in the queue with no_slowdown set to true
   // REQUIRES: db mutex held, no other stall on this queue outstanding
@@ -392,6 +404,18 @@ class WriteThread {
   // is larger than 1/8 of this limit.
   const uint64_t max_write_batch_group_size_bytes;
 
+  // See DBOptions::write_group_linger_usec.
+  const uint64_t max_linger_usec_;
+
+  // Moving averages of the time between writers joining a batch group, and
+  // of the time WAL syncs took, which size the wait of a sync group leader
+  // for more writers
+  std::atomic<uint64_t> last_join_nanos_{0};
+  std::atomic<uint64_t> avg_join_interval_nanos_{0};
+  std::atomic<uint64_t> avg_wal_sync_nanos_{0};
+  // The number of writers that joined a batch group
+  std::atomic<uint64_t> joined_count_{0};
+
   // Points to the newest pending writer. Only leader can remove
   // elements, adding can be done lock-free by anybody.
   std::atomic<Writer*> newest_writer_;
@@ -440,6 +464,21 @@ class WriteThread {
   // Set writer state and wake the writer up if it is waiting.
   void SetState(Writer* w, uint8_t new_state);
 
+  // Moves the moving average *avg towards sample. Concurrent updates may
+  // lose a sample.
+  static void UpdateAverage(std::atomic<uint64_t>* avg, uint64_t sample) {
+    uint64_t cur = avg->load(std::memory_order_relaxed);
+    avg->store(cur == 0 ? sample : cur - cur / 8 + sample / 8,
+               std::memory_order_relaxed);
+  }
+
+  // Updates the rate at which writers join batch groups
+  void RecordJoin();
+
+  // Waits while the leader of a group with sync writes expects more writers
+  // to join the group before its WAL sync
+  void LingerForWriters(Writer* leader);
+
   // Links w into the newest_writer list. Return true if w was linked directly
   // into the leader position.  Safe to call from multiple threads without
   // external locking.
@@ -358,6 +358,15 @@ class CompositeEnvWrapper : public CompositeEnv {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolFairScheduling(Priority pool, bool fair) override {
+    return target_.env->SetThreadPoolFairScheduling(pool, fair);
+  }
+
+  Status SetThreadPoolTagWeight(Priority pool, void* tag,
+                                uint32_t weight) override {
+    return target_.env->SetThreadPoolTagWeight(pool, tag, weight);
+  }
+
   Status GetThreadList(std::vector<ThreadStatus>* thread_list) override {
     return target_.env->GetThreadList(thread_list);
   }
@@ -1066,6 +1066,8 @@ namespace {  // anonymous namespace
 
 void AssignEnvOptions(EnvOptions* env_options, const DBOptions& options) {
   env_options->use_mmap_reads = options.allow_mmap_reads;
+  env_options->populate_mmap_reads = options.populate_mmap_reads;
+  env_options->huge_pages_for_mmap_reads = options.huge_pages_for_mmap_reads;
   env_options->use_mmap_writes = options.allow_mmap_writes;
   env_options->use_direct_reads = options.use_direct_reads;
   env_options->set_fd_cloexec = options.is_fd_close_on_exec;
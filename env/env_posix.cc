@@ -395,6 +395,19 @@ class PosixEnv : public CompositeEnv {
     return Status::OK();
   }
 
+  Status SetThreadPoolFairScheduling(Priority pool, bool fair) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    thread_pools_[pool].SetFairScheduling(fair);
+    return Status::OK();
+  }
+
+  Status SetThreadPoolTagWeight(Priority pool, void* tag,
+                                uint32_t weight) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    thread_pools_[pool].SetTagWeight(tag, weight);
+    return Status::OK();
+  }
+
  private:
   friend Env* Env::Default();
   // Constructs the default Env, a singleton
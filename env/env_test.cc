@@ -64,6 +64,7 @@
 #include "util/mutexlock.h"
 #include "util/random.h"
 #include "util/string_util.h"
+#include "util/threadpool_imp.h"
 #include "utilities/counted_fs.h"
 #include "utilities/env_timed.h"
 #include "utilities/fault_injection_env.h"
@@ -429,6 +430,85 @@ TEST_P(EnvPosixTestWithParam, UnSchedule) {
   WaitThreadPoolsEmpty();
 }
 
+TEST_F(EnvPosixTest, FairScheduling) {
+  ThreadPoolImpl pool;
+  pool.SetBackgroundThreads(1);
+  pool.SetFairScheduling(true);
+
+  // Block the pool while the jobs are queued
+  test::SleepingBackgroundTask sleeping_task;
+  pool.Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                nullptr, nullptr);
+  sleeping_task.WaitUntilSleeping();
+
+  struct Job {
+    std::string* order;
+    std::string name;
+    static void Run(void* arg) {
+      Job* job = static_cast<Job*>(arg);
+      job->order->append(job->name);
+    }
+  };
+  std::string order;
+  int tag_a = 0;
+  int tag_b = 0;
+  std::vector<Job> jobs;
+  for (const char* name : {"a1", "a2", "a3", "b1", "b2", "b3", "b4"}) {
+    jobs.push_back(Job{&order, name});
+  }
+  pool.SetTagWeight(&tag_b, 2);
+  for (auto& job : jobs) {
+    pool.Schedule(&Job::Run, &job, job.name[0] == 'a' ? &tag_a : &tag_b,
+                  nullptr);
+  }
+
+  // b gets twice the share of a, whatever the order the jobs were queued in
+  sleeping_task.WakeUp();
+  pool.WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ("a1b1b2a2b3b4a3", order);
+}
+
+TEST_F(EnvPosixTest, SubmitJobWorkStealing) {
+  ThreadPoolImpl pool;
+  pool.SetBackgroundThreads(4);
+
+  // Jobs submitted from outside and from within the pool all run, with
+  // threads being added, removed and reserved meanwhile
+  std::atomic<int> num_run(0);
+  constexpr int kNumJobs = 1000;
+  int num_reserved = 0;
+  for (int i = 0; i < kNumJobs; ++i) {
+    pool.SubmitJob([&]() {
+      num_run.fetch_add(1);
+      pool.SubmitJob([&]() { num_run.fetch_add(1); });
+    });
+    if (i == kNumJobs / 4) {
+      pool.SetBackgroundThreads(2);
+    } else if (i == kNumJobs / 2) {
+      // Only succeeds if a thread is waiting
+      num_reserved = pool.ReserveThreads(1);
+    } else if (i == kNumJobs * 3 / 4) {
+      ASSERT_EQ(num_reserved, pool.ReleaseThreads(num_reserved));
+      pool.SetBackgroundThreads(8);
+    }
+  }
+  // A job scheduled with a tag still runs along the submitted ones
+  test::SleepingBackgroundTask sleeping_task;
+  pool.Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                &sleeping_task, nullptr);
+  sleeping_task.WaitUntilSleeping();
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+
+  // Jobs submitted once the threads are being joined are dropped
+  while (num_run.load() < 2 * kNumJobs) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  pool.WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(2 * kNumJobs, num_run.load());
+  ASSERT_EQ(0U, pool.GetQueueLen());
+}
+
 // This tests assumes that the last scheduled
 // task will run last. In fact, in the allotted
 // sleeping time nothing may actually run or they may
@@ -1140,6 +1220,36 @@ TEST_F(EnvPosixTest, PositionedAppend) {
   ASSERT_EQ('b', result[kBlockSize]);
 }
 
+TEST_F(EnvPosixTest, AppendAndSync) {
+  std::shared_ptr<FileSystem> fs = env_->GetFileSystem();
+  FileOptions file_opts;
+  file_opts.use_direct_writes = false;
+  file_opts.use_mmap_writes = false;
+  std::string fname = test::PerThreadDBPath(env_, "append_and_sync");
+  std::unique_ptr<FSWritableFile> file;
+  ASSERT_OK(fs->NewWritableFile(fname, file_opts, &file, nullptr));
+
+  // Mixed with appends, which write at the same file position
+  std::string expected;
+  for (int i = 0; i < 10; i++) {
+    std::string data(static_cast<size_t>(100 * (i + 1)),
+                     static_cast<char>('a' + i));
+    if (i % 3 == 0) {
+      ASSERT_OK(file->Append(data, IOOptions(), nullptr));
+    } else {
+      ASSERT_OK(file->AppendAndSync(data, /*use_fsync=*/i % 2 == 0,
+                                    IOOptions(), nullptr));
+    }
+    expected += data;
+    ASSERT_EQ(expected.size(), file->GetFileSize(IOOptions(), nullptr));
+  }
+  ASSERT_OK(file->Close(IOOptions(), nullptr));
+
+  std::string contents;
+  ASSERT_OK(ReadFileToString(fs.get(), fname, &contents));
+  ASSERT_EQ(expected, contents);
+}
+
 // `GetUniqueId()` temporarily returns zero on Windows. `BlockBasedTable` can
 // handle a return value of zero but this test case cannot.
 #ifndef OS_WIN
@@ -1732,6 +1842,95 @@ TEST_F(EnvPosixTest, MultiReadIOUringError2) {
   SyncPoint::GetInstance()->DisableProcessing();
   SyncPoint::GetInstance()->ClearAllCallBacks();
 }
+
+TEST_F(EnvPosixTest, MultiReadAsyncIOUring) {
+  // In this test we don't do aligned read, so we can't do direct I/O.
+  std::shared_ptr<FileSystem> fs = env_->GetFileSystem();
+  const size_t kTotalSize = 81920;
+  const size_t kNumFiles = 2;
+  const size_t kNumReads = 3;
+  Random rnd(301);
+  std::vector<std::string> expected_data;
+  std::vector<std::unique_ptr<FSRandomAccessFile>> files(kNumFiles);
+  for (size_t i = 0; i < kNumFiles; i++) {
+    std::string fname =
+        test::PerThreadDBPath(env_, "testfile" + std::to_string(i));
+    expected_data.push_back(rnd.RandomString(kTotalSize));
+    ASSERT_OK(WriteStringToFile(env_, expected_data.back(), fname));
+    ASSERT_OK(fs->NewRandomAccessFile(fname, FileOptions(), &files[i],
+                                      nullptr));
+  }
+
+  // Returns half of some reads, which are completed synchronously
+  SyncPoint::GetInstance()->SetCallBack(
+      "UpdateResults::io_uring_result", [&](void* arg) {
+        size_t& bytes_read = *static_cast<size_t*>(arg);
+        if (rnd.OneIn(2)) {
+          bytes_read /= 2;
+        }
+      });
+  // Nothing is submitted until Poll()
+  unsigned int queued = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PosixRandomAccessFile::MultiReadAsync:Queued", [&](void* arg) {
+        queued = io_uring_sq_ready(static_cast<struct io_uring*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::vector<std::string> scratches;
+  scratches.reserve(kNumFiles * kNumReads);
+  std::vector<std::vector<FSReadRequest>> reqs(kNumFiles);
+  std::vector<size_t> callbacks(kNumFiles, 0);
+  std::vector<void*> io_handles(kNumFiles * kNumReads, nullptr);
+  std::vector<IOHandleDeleter> del_fns(kNumFiles * kNumReads);
+  size_t num_handles = 0;
+  for (size_t i = 0; i < kNumFiles; i++) {
+    reqs[i].resize(kNumReads);
+    for (size_t j = 0; j < kNumReads; j++) {
+      reqs[i][j].offset = (j + 1) * 10000 + i;
+      reqs[i][j].len = 1000 * (j + 1);
+      scratches.emplace_back(reqs[i][j].len, ' ');
+      reqs[i][j].scratch = const_cast<char*>(scratches.back().data());
+    }
+    size_t num_file_handles = kNumReads;
+    IOStatus s = files[i]->MultiReadAsync(
+        reqs[i].data(), kNumReads, IOOptions(),
+        [](const FSReadRequest*, size_t n, void* arg) {
+          *static_cast<size_t*>(arg) += n;
+        },
+        &callbacks[i], &io_handles[num_handles], &num_file_handles,
+        &del_fns[num_handles], nullptr);
+    ASSERT_OK(s);
+    if (num_file_handles == 0) {
+      // io_uring is not available, and the reads were synchronous
+      SyncPoint::GetInstance()->DisableProcessing();
+      SyncPoint::GetInstance()->ClearAllCallBacks();
+      ROCKSDB_GTEST_BYPASS("io_uring is not available");
+      return;
+    }
+    ASSERT_EQ(kNumReads, num_file_handles);
+    num_handles += num_file_handles;
+    ASSERT_EQ(num_handles, queued);
+    ASSERT_EQ(0u, callbacks[i]);
+  }
+
+  ASSERT_OK(fs->Poll(io_handles, io_handles.size()));
+  for (size_t i = 0; i < kNumFiles; i++) {
+    // One callback with all the requests of the file
+    ASSERT_EQ(kNumReads, callbacks[i]);
+    for (const FSReadRequest& req : reqs[i]) {
+      ASSERT_OK(req.status);
+      ASSERT_EQ(Slice(expected_data[i].data() + req.offset, req.len),
+                req.result);
+    }
+  }
+  for (size_t i = 0; i < io_handles.size(); i++) {
+    del_fns[i](io_handles[i]);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
 #endif  // ROCKSDB_IOURING_PRESENT
 
 // Only works in linux platforms
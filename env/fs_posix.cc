@@ -244,8 +244,21 @@ class PosixFileSystem : public FileSystem {
       IOOptions opts;
       s = GetFileSize(fname, opts, &size, nullptr);
       if (s.ok()) {
-        void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        int mmap_flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (options.populate_mmap_reads) {
+          mmap_flags |= MAP_POPULATE;
+        }
+#endif
+        void* base = mmap(nullptr, size, PROT_READ, mmap_flags, fd, 0);
         if (base != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+          if (options.huge_pages_for_mmap_reads && size > 0) {
+            // Only a hint; file systems without huge page support for the
+            // page cache ignore or reject it
+            madvise(base, size, MADV_HUGEPAGE);
+          }
+#endif
           result->reset(
               new PosixMmapReadableFile(fd, fname, base, size, options));
         } else {
@@ -342,16 +355,26 @@ class PosixFileSystem : public FileSystem {
 #endif
       result->reset(new PosixWritableFile(
           fname, fd, GetLogicalBlockSizeForWriteIfNeeded(options, fname, fd),
-          options));
+          options
+#if defined(ROCKSDB_IOURING_PRESENT)
+          ,
+          !IsIOUringEnabled() ? nullptr : thread_local_write_io_urings_.get()
+#endif
+              ));
     } else {
       // disable mmap writes
       EnvOptions no_mmap_writes_options = options;
       no_mmap_writes_options.use_mmap_writes = false;
-      result->reset(
-          new PosixWritableFile(fname, fd,
-                                GetLogicalBlockSizeForWriteIfNeeded(
-                                    no_mmap_writes_options, fname, fd),
-                                no_mmap_writes_options));
+      result->reset(new PosixWritableFile(
+          fname, fd,
+          GetLogicalBlockSizeForWriteIfNeeded(no_mmap_writes_options, fname,
+                                              fd),
+          no_mmap_writes_options
+#if defined(ROCKSDB_IOURING_PRESENT)
+          ,
+          !IsIOUringEnabled() ? nullptr : thread_local_write_io_urings_.get()
+#endif
+              ));
     }
     return s;
   }
@@ -437,16 +460,26 @@ class PosixFileSystem : public FileSystem {
 #endif
       result->reset(new PosixWritableFile(
           fname, fd, GetLogicalBlockSizeForWriteIfNeeded(options, fname, fd),
-          options));
+          options
+#if defined(ROCKSDB_IOURING_PRESENT)
+          ,
+          !IsIOUringEnabled() ? nullptr : thread_local_write_io_urings_.get()
+#endif
+              ));
     } else {
       // disable mmap writes
       FileOptions no_mmap_writes_options = options;
       no_mmap_writes_options.use_mmap_writes = false;
-      result->reset(
-          new PosixWritableFile(fname, fd,
-                                GetLogicalBlockSizeForWriteIfNeeded(
-                                    no_mmap_writes_options, fname, fd),
-                                no_mmap_writes_options));
+      result->reset(new PosixWritableFile(
+          fname, fd,
+          GetLogicalBlockSizeForWriteIfNeeded(no_mmap_writes_options, fname,
+                                              fd),
+          no_mmap_writes_options
+#if defined(ROCKSDB_IOURING_PRESENT)
+          ,
+          !IsIOUringEnabled() ? nullptr : thread_local_write_io_urings_.get()
+#endif
+              ));
     }
     return s;
   }
@@ -1018,6 +1051,16 @@ class PosixFileSystem : public FileSystem {
       return IOStatus::NotSupported("Poll");
     }
 
+    // Submit the reads queued by MultiReadAsync(), of all the files at once
+    if (io_uring_sq_ready(iu) > 0) {
+      ssize_t ret = io_uring_submit(iu);
+      if (ret < 0) {
+        fprintf(stderr, "io_uring_submit error: %ld\n", long(ret));
+        return IOStatus::IOError("io_uring_submit() requested but returned " +
+                                 std::to_string(ret));
+      }
+    }
+
     for (size_t i = 0; i < io_handles.size(); i++) {
       // The request has been completed in earlier runs.
       if ((static_cast<Posix_IOHandle*>(io_handles[i]))->is_finished) {
@@ -1195,6 +1238,9 @@ class PosixFileSystem : public FileSystem {
 #if defined(ROCKSDB_IOURING_PRESENT)
   // io_uring instance
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance of PosixWritableFile::AppendAndSync(), apart from the
+  // one with the reads queued by MultiReadAsync()
+  std::unique_ptr<ThreadLocalPtr> thread_local_write_io_urings_;
 #endif
 
   size_t page_size_;
@@ -1255,6 +1301,7 @@ PosixFileSystem::PosixFileSystem()
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
     thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
+    thread_local_write_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
     delete new_io_uring;
   }
 #endif
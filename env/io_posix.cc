@@ -633,6 +633,16 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs, size_t num_reqs,
     return FSRandomAccessFile::MultiRead(reqs, num_reqs, options, dbg);
   }
 
+  // Submit the reads queued by MultiReadAsync() first, so that
+  // io_uring_submit_and_wait() below only submits these requests
+  if (io_uring_sq_ready(iu) > 0) {
+    ssize_t ret = io_uring_submit(iu);
+    if (ret < 0) {
+      return IOStatus::IOError("io_uring_submit() requested but returned " +
+                               std::to_string(ret));
+    }
+  }
+
   IOStatus ios = IOStatus::OK();
 
   struct WrappedReadRequest {
@@ -927,6 +937,104 @@ IOStatus PosixRandomAccessFile::ReadAsync(
 #endif
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+namespace {
+// The requests of a MultiReadAsync() still being read
+struct PosixMultiReadAsyncState {
+  FSReadRequest* reqs;
+  size_t num_reqs;
+  size_t num_pending;
+  IOOptions opts;
+  std::function<void(const FSReadRequest*, size_t, void*)> cb;
+  void* cb_arg;
+};
+}  // namespace
+#endif
+
+IOStatus PosixRandomAccessFile::MultiReadAsync(
+    FSReadRequest* reqs, size_t num_reqs, const IOOptions& opts,
+    std::function<void(const FSReadRequest*, size_t, void*)> cb, void* cb_arg,
+    void** io_handles, size_t* num_io_handles, IOHandleDeleter* del_fns,
+    IODebugContext* dbg) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  struct io_uring* iu = nullptr;
+  if (thread_local_io_urings_) {
+    iu = static_cast<struct io_uring*>(thread_local_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_io_urings_->Reset(iu);
+      }
+    }
+  }
+
+  // Read synchronously if the platform doesn't support io_uring, or the
+  // requests can't all be queued at once
+  if (iu == nullptr || use_direct_io() || num_reqs == 0 ||
+      num_reqs > kIoUringDepth) {
+    return FSRandomAccessFile::MultiReadAsync(reqs, num_reqs, opts, cb,
+                                              cb_arg, io_handles,
+                                              num_io_handles, del_fns, dbg);
+  }
+  if (io_uring_sq_space_left(iu) < num_reqs) {
+    ssize_t ret = io_uring_submit(iu);
+    if (ret < 0) {
+      return IOStatus::IOError("io_uring_submit() requested but returned " +
+                               std::to_string(ret));
+    }
+  }
+
+  IOHandleDeleter deletefn = [](void* args) -> void {
+    delete (static_cast<Posix_IOHandle*>(args));
+    args = nullptr;
+  };
+
+  auto state = new PosixMultiReadAsyncState{reqs, num_reqs, num_reqs,
+                                            opts, std::move(cb), cb_arg};
+  for (size_t i = 0; i < num_reqs; i++) {
+    // Completes reqs[i], and calls cb once all the requests are done
+    auto req_cb = [this, i](FSReadRequest& result, void* arg) {
+      auto s = static_cast<PosixMultiReadAsyncState*>(arg);
+      FSReadRequest& req = s->reqs[i];
+      req.status = result.status;
+      req.result = result.result;
+      const size_t done = req.result.size();
+      if (req.status.ok() && done < req.len) {
+        // Short read, which may be a partial result or the end of the file
+        Slice rest;
+        req.status = Read(req.offset + done, req.len - done, s->opts, &rest,
+                          req.scratch + done, nullptr);
+        req.result = Slice(req.scratch, done + rest.size());
+      }
+      if (--s->num_pending == 0) {
+        s->cb(s->reqs, s->num_reqs, s->cb_arg);
+        delete s;
+      }
+    };
+    Posix_IOHandle* posix_handle = new Posix_IOHandle(
+        iu, req_cb, state, reqs[i].offset, reqs[i].len, reqs[i].scratch,
+        use_direct_io(), GetRequiredBufferAlignment());
+    posix_handle->iov.iov_base = reqs[i].scratch;
+    posix_handle->iov.iov_len = reqs[i].len;
+    io_handles[i] = posix_handle;
+    del_fns[i] = deletefn;
+
+    struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+    io_uring_prep_readv(sqe, fd_, /*sqe->addr=*/&posix_handle->iov,
+                        /*sqe->len=*/1, /*sqe->offset=*/posix_handle->offset);
+    io_uring_sqe_set_data(sqe, posix_handle);
+  }
+  *num_io_handles = num_reqs;
+  TEST_SYNC_POINT_CALLBACK("PosixRandomAccessFile::MultiReadAsync:Queued",
+                           iu);
+  return IOStatus::OK();
+#else
+  return FSRandomAccessFile::MultiReadAsync(reqs, num_reqs, opts, cb, cb_arg,
+                                            io_handles, num_io_handles,
+                                            del_fns, dbg);
+#endif
+}
+
 /*
  * PosixMmapReadableFile
  *
@@ -1273,13 +1381,24 @@ IOStatus PosixMmapFile::Allocate(uint64_t offset, uint64_t len,
  */
 PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
                                      size_t logical_block_size,
-                                     const EnvOptions& options)
+                                     const EnvOptions& options
+#if defined(ROCKSDB_IOURING_PRESENT)
+                                     ,
+                                     ThreadLocalPtr* thread_local_io_urings
+#endif
+                                     )
     : FSWritableFile(options),
       filename_(fname),
       use_direct_io_(options.use_direct_writes),
       fd_(fd),
       filesize_(0),
-      logical_sector_size_(logical_block_size) {
+      logical_sector_size_(logical_block_size)
+#if defined(ROCKSDB_IOURING_PRESENT)
+      ,
+      thread_local_io_urings_(thread_local_io_urings),
+      io_uring_write_supported_(true)
+#endif
+{
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   allow_fallocate_ = options.allow_fallocate;
   fallocate_with_keep_size_ = options.fallocate_with_keep_size;
@@ -1430,6 +1549,103 @@ IOStatus PosixWritableFile::Fsync(const IOOptions& /*opts*/,
   return IOStatus::OK();
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+IOStatus PosixWritableFile::AppendAndSync(const Slice& data, bool use_fsync,
+                                          const IOOptions& opts,
+                                          IODebugContext* dbg) {
+  struct io_uring* iu = nullptr;
+  if (thread_local_io_urings_ && io_uring_write_supported_ &&
+      !use_direct_io()) {
+    iu = static_cast<struct io_uring*>(thread_local_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring(kIoUringWriteDepth);
+      if (iu != nullptr) {
+        thread_local_io_urings_->Reset(iu);
+      }
+    }
+  }
+  // Writing at the file position, like write(), needs Linux 5.6
+  if (iu != nullptr && !(iu->features & IORING_FEAT_RW_CUR_POS)) {
+    io_uring_write_supported_ = false;
+    iu = nullptr;
+  }
+  if (iu == nullptr) {
+    return FSWritableFile::AppendAndSync(data, use_fsync, opts, dbg);
+  }
+
+  // The sync only runs once the write completed in full
+  ssize_t write_res = 0;
+  ssize_t sync_res = 0;
+  struct io_uring_sqe* sqe = io_uring_get_sqe(iu);
+  io_uring_prep_write(sqe, fd_, data.data(),
+                      static_cast<unsigned int>(data.size()),
+                      static_cast<uint64_t>(-1));
+  io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+  io_uring_sqe_set_data(sqe, &write_res);
+  sqe = io_uring_get_sqe(iu);
+  io_uring_prep_fsync(sqe, fd_, use_fsync ? 0 : IORING_FSYNC_DATASYNC);
+  io_uring_sqe_set_data(sqe, &sync_res);
+
+  ssize_t ret = io_uring_submit_and_wait(iu, kIoUringWriteDepth);
+  TEST_SYNC_POINT_CALLBACK(
+      "PosixWritableFile::AppendAndSync:io_uring_submit_and_wait:return",
+      &ret);
+  // The requests left in the ring after an error point to this frame, so
+  // the ring of this thread is dropped
+  auto drop_ring = [&]() {
+    io_uring_queue_exit(iu);
+    thread_local_io_urings_->Reset(nullptr);
+    delete iu;
+  };
+  if (ret < 0) {
+    // Nothing was written
+    drop_ring();
+    return FSWritableFile::AppendAndSync(data, use_fsync, opts, dbg);
+  }
+  for (ssize_t i = 0; i < ret; i++) {
+    struct io_uring_cqe* cqe = nullptr;
+    int err;
+    do {
+      err = io_uring_wait_cqe(iu, &cqe);
+    } while (err == -EINTR);
+    if (err != 0 || cqe == nullptr) {
+      drop_ring();
+      return IOStatus::IOError("io_uring_wait_cqe() returned " +
+                               std::to_string(err));
+    }
+    *static_cast<ssize_t*>(io_uring_cqe_get_data(cqe)) = cqe->res;
+    io_uring_cqe_seen(iu, cqe);
+  }
+  if (ret != kIoUringWriteDepth) {
+    drop_ring();
+    return IOStatus::IOError("io_uring_submit_and_wait() requested " +
+                             std::to_string(kIoUringWriteDepth) +
+                             " but returned " + std::to_string(ret));
+  }
+
+  if (write_res < 0) {
+    return IOError("While appending to file", filename_,
+                   static_cast<int>(-write_res));
+  }
+  size_t written = static_cast<size_t>(write_res);
+  filesize_ += written;
+  if (written < data.size()) {
+    // A short write cancels the sync linked to it
+    IOStatus s = Append(Slice(data.data() + written, data.size() - written),
+                        opts, dbg);
+    if (s.ok()) {
+      s = use_fsync ? Fsync(opts, dbg) : Sync(opts, dbg);
+    }
+    return s;
+  }
+  if (sync_res < 0) {
+    return IOError(use_fsync ? "While fsync" : "While fdatasync", filename_,
+                   static_cast<int>(-sync_res));
+  }
+  return IOStatus::OK();
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 bool PosixWritableFile::IsSyncThreadSafe() const { return true; }
 
 uint64_t PosixWritableFile::GetFileSize(const IOOptions& /*opts*/,
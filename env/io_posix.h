@@ -268,9 +268,13 @@ inline void DeleteIOUring(void* p) {
   delete iu;
 }
 
-inline struct io_uring* CreateIOUring() {
+// io_uring instance queue depth for PosixWritableFile::AppendAndSync(): a
+// write and the sync linked to it
+const unsigned int kIoUringWriteDepth = 2;
+
+inline struct io_uring* CreateIOUring(unsigned int depth = kIoUringDepth) {
   struct io_uring* new_io_uring = new struct io_uring;
-  int ret = io_uring_queue_init(kIoUringDepth, new_io_uring, 0);
+  int ret = io_uring_queue_init(depth, new_io_uring, 0);
   if (ret) {
     delete new_io_uring;
     new_io_uring = nullptr;
@@ -323,6 +327,16 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                              void* cb_arg, void** io_handle,
                              IOHandleDeleter* del_fn,
                              IODebugContext* dbg) override;
+
+  // Queues one io_uring read per request without submitting them. The next
+  // submission on the thread's ring, usually the Poll() of the handles,
+  // submits all the reads queued since, e.g. those of all the files a
+  // MultiGet reads in one round, with a single io_uring_submit().
+  IOStatus MultiReadAsync(
+      FSReadRequest* reqs, size_t num_reqs, const IOOptions& opts,
+      std::function<void(const FSReadRequest*, size_t, void*)> cb,
+      void* cb_arg, void** io_handles, size_t* num_io_handles,
+      IOHandleDeleter* del_fns, IODebugContext* dbg) override;
 };
 
 class PosixWritableFile : public FSWritableFile {
@@ -341,11 +355,21 @@ class PosixWritableFile : public FSWritableFile {
   // support it, so we need to do a dynamic check too.
   bool sync_file_range_supported_;
 #endif  // ROCKSDB_RANGESYNC_PRESENT
+#if defined(ROCKSDB_IOURING_PRESENT)
+  ThreadLocalPtr* thread_local_io_urings_;
+  // Cleared if the kernel can't write at the file position with io_uring
+  bool io_uring_write_supported_;
+#endif
 
  public:
   explicit PosixWritableFile(const std::string& fname, int fd,
                              size_t logical_block_size,
-                             const EnvOptions& options);
+                             const EnvOptions& options
+#if defined(ROCKSDB_IOURING_PRESENT)
+                             ,
+                             ThreadLocalPtr* thread_local_io_urings
+#endif
+  );
   virtual ~PosixWritableFile();
 
   // Need to implement this so the file is truncated correctly
@@ -372,6 +396,10 @@ class PosixWritableFile : public FSWritableFile {
   IOStatus Flush(const IOOptions& opts, IODebugContext* dbg) override;
   IOStatus Sync(const IOOptions& opts, IODebugContext* dbg) override;
   IOStatus Fsync(const IOOptions& opts, IODebugContext* dbg) override;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  IOStatus AppendAndSync(const Slice& data, bool use_fsync,
+                         const IOOptions& opts, IODebugContext* dbg) override;
+#endif
   bool IsSyncThreadSafe() const override;
   bool use_direct_io() const override { return use_direct_io_; }
   void SetWriteLifeTimeHint(Env::WriteLifeTimeHint hint) override;
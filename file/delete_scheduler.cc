@@ -6,6 +6,7 @@
 
 #include "file/delete_scheduler.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <thread>
 #include <vector>
@@ -34,13 +35,17 @@ DeleteScheduler::DeleteScheduler(SystemClock* clock, FileSystem* fs,
       bytes_max_delete_chunk_(bytes_max_delete_chunk),
       closing_(false),
       cv_(&mu_),
-      bg_thread_(nullptr),
+      num_threads_(1),
+      window_start_time_(0),
+      window_deleted_bytes_(0),
+      window_delete_rate_(0),
+      window_idle_(true),
       info_log_(info_log),
       sst_file_manager_(sst_file_manager),
       max_trash_db_ratio_(max_trash_db_ratio) {
   assert(sst_file_manager != nullptr);
   assert(max_trash_db_ratio >= 0);
-  MaybeCreateBackgroundThread();
+  MaybeCreateBackgroundThreads();
 }
 
 DeleteScheduler::~DeleteScheduler() {
@@ -49,8 +54,8 @@ DeleteScheduler::~DeleteScheduler() {
     closing_ = true;
     cv_.SignalAll();
   }
-  if (bg_thread_) {
-    bg_thread_->join();
+  for (auto& bg_thread : bg_threads_) {
+    bg_thread.join();
   }
   for (const auto& it : bg_errors_) {
     it.second.PermitUncheckedError();
@@ -115,7 +120,7 @@ Status DeleteScheduler::DeleteFile(const std::string& file_path,
   {
     InstrumentedMutexLock l(&mu_);
     RecordTick(stats_.get(), FILES_MARKED_TRASH);
-    queue_.emplace(trash_file, dir_to_sync);
+    queue_.emplace_back(trash_file, dir_to_sync);
     pending_files_++;
     if (pending_files_ == 1) {
       cv_.SignalAll();
@@ -215,12 +220,12 @@ Status DeleteScheduler::MarkAsTrash(const std::string& file_path,
   return s;
 }
 
-void DeleteScheduler::BackgroundEmptyTrash() {
+void DeleteScheduler::BackgroundEmptyTrash(int thread_idx) {
   TEST_SYNC_POINT("DeleteScheduler::BackgroundEmptyTrash");
 
+  InstrumentedMutexLock l(&mu_);
   while (true) {
-    InstrumentedMutexLock l(&mu_);
-    while (queue_.empty() && !closing_) {
+    while ((queue_.empty() || thread_idx >= num_threads_) && !closing_) {
       cv_.Wait();
     }
 
@@ -228,72 +233,86 @@ void DeleteScheduler::BackgroundEmptyTrash() {
       return;
     }
 
-    // Delete all files in queue_
-    uint64_t start_time = clock_->NowMicros();
-    uint64_t total_deleted_bytes = 0;
-    int64_t current_delete_rate = rate_bytes_per_sec_.load();
-    while (!queue_.empty() && !closing_) {
-      if (current_delete_rate != rate_bytes_per_sec_.load()) {
-        // User changed the delete rate
-        current_delete_rate = rate_bytes_per_sec_.load();
-        start_time = clock_->NowMicros();
-        total_deleted_bytes = 0;
-        ROCKS_LOG_INFO(info_log_, "rate_bytes_per_sec is changed to %" PRIi64,
-                       current_delete_rate);
-      }
-
-      // Get new file to delete
-      const FileAndDir& fad = queue_.front();
-      std::string path_in_trash = fad.fname;
-
-      // We don't need to hold the lock while deleting the file
-      mu_.Unlock();
-      uint64_t deleted_bytes = 0;
-      bool is_complete = true;
-      // Delete file from trash and update total_penlty value
-      Status s =
-          DeleteTrashFile(path_in_trash, fad.dir, &deleted_bytes, &is_complete);
-      total_deleted_bytes += deleted_bytes;
-      mu_.Lock();
-      if (is_complete) {
-        RecordTick(stats_.get(), FILES_DELETED_FROM_TRASH_QUEUE);
-        queue_.pop();
-      }
+    if (window_idle_) {
+      // Start emptying the trash
+      window_idle_ = false;
+      window_delete_rate_ = rate_bytes_per_sec_.load();
+      window_start_time_ = clock_->NowMicros();
+      window_deleted_bytes_ = 0;
+    } else if (window_delete_rate_ != rate_bytes_per_sec_.load()) {
+      // User changed the delete rate
+      window_delete_rate_ = rate_bytes_per_sec_.load();
+      window_start_time_ = clock_->NowMicros();
+      window_deleted_bytes_ = 0;
+      ROCKS_LOG_INFO(info_log_, "rate_bytes_per_sec is changed to %" PRIi64,
+                     window_delete_rate_);
+    }
 
-      if (!s.ok()) {
-        bg_errors_[path_in_trash] = s;
+    // Get new file to delete, other threads take the next ones meanwhile
+    FileAndDir fad = std::move(queue_.front());
+    queue_.pop_front();
+
+    // We don't need to hold the lock while deleting the file
+    mu_.Unlock();
+    uint64_t deleted_bytes = 0;
+    bool is_complete = true;
+    // Delete file from trash and update total_penlty value
+    Status s =
+        DeleteTrashFile(fad.fname, fad.dir, &deleted_bytes, &is_complete);
+    // Reclaiming the space comes first once the DBs ran out of it
+    const bool max_space_reached =
+        sst_file_manager_->IsMaxAllowedSpaceReached();
+    mu_.Lock();
+    if (!s.ok()) {
+      bg_errors_[fad.fname] = s;
+    }
+    const std::string path_in_trash = fad.fname;
+    if (is_complete) {
+      RecordTick(stats_.get(), FILES_DELETED_FROM_TRASH_QUEUE);
+    } else {
+      queue_.push_front(std::move(fad));
+    }
+    window_deleted_bytes_ += deleted_bytes;
+
+    // Apply penalty if necessary
+    uint64_t total_penalty;
+    if (window_delete_rate_ > 0 && !max_space_reached) {
+      // rate limiting is enabled
+      total_penalty =
+          ((window_deleted_bytes_ * kMicrosInSecond) / window_delete_rate_);
+      ROCKS_LOG_INFO(info_log_,
+                     "Rate limiting is enabled with penalty %" PRIu64
+                     " after deleting file %s",
+                     total_penalty, path_in_trash.c_str());
+      const uint64_t penalty_end_time = window_start_time_ + total_penalty;
+      while (!closing_ && !cv_.TimedWait(penalty_end_time)) {
       }
-
-      // Apply penalty if necessary
-      uint64_t total_penalty;
-      if (current_delete_rate > 0) {
-        // rate limiting is enabled
-        total_penalty =
-            ((total_deleted_bytes * kMicrosInSecond) / current_delete_rate);
-        ROCKS_LOG_INFO(info_log_,
-                       "Rate limiting is enabled with penalty %" PRIu64
-                       " after deleting file %s",
-                       total_penalty, path_in_trash.c_str());
-        while (!closing_ && !cv_.TimedWait(start_time + total_penalty)) {
-        }
-      } else {
-        // rate limiting is disabled
-        total_penalty = 0;
-        ROCKS_LOG_INFO(info_log_,
-                       "Rate limiting is disabled after deleting file %s",
-                       path_in_trash.c_str());
+    } else {
+      // rate limiting is disabled, or bypassed until the space is reclaimed
+      total_penalty = 0;
+      if (max_space_reached) {
+        // The deletions so far are not held against the rate afterwards
+        window_start_time_ = clock_->NowMicros();
+        window_deleted_bytes_ = 0;
       }
-      TEST_SYNC_POINT_CALLBACK("DeleteScheduler::BackgroundEmptyTrash:Wait",
-                               &total_penalty);
+      ROCKS_LOG_INFO(info_log_,
+                     "Rate limiting is %s after deleting file %s",
+                     max_space_reached ? "bypassed as max allowed space is "
+                                         "reached"
+                                       : "disabled",
+                     path_in_trash.c_str());
+    }
+    TEST_SYNC_POINT_CALLBACK("DeleteScheduler::BackgroundEmptyTrash:Wait",
+                             &total_penalty);
 
-      if (is_complete) {
-        pending_files_--;
-      }
-      if (pending_files_ == 0) {
-        // Unblock WaitForEmptyTrash since there are no more files waiting
-        // to be deleted
-        cv_.SignalAll();
-      }
+    if (is_complete) {
+      pending_files_--;
+    }
+    if (pending_files_ == 0) {
+      // Unblock WaitForEmptyTrash since there are no more files waiting
+      // to be deleted
+      window_idle_ = true;
+      cv_.SignalAll();
     }
   }
 }
@@ -344,13 +363,12 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
                          "as it has other links",
                          path_in_trash.c_str());
         }
-      } else if (!num_link_error_printed_) {
+      } else if (!num_link_error_printed_.exchange(true)) {
         ROCKS_LOG_INFO(
             info_log_,
             "Cannot delete files slowly through ftruncate from trash "
             "as Env::NumFileLinks() returns error: %s",
             my_status.ToString().c_str());
-        num_link_error_printed_ = true;
       }
     }
 
@@ -395,16 +413,30 @@ void DeleteScheduler::WaitForEmptyTrash() {
   }
 }
 
-void DeleteScheduler::MaybeCreateBackgroundThread() {
-  if (bg_thread_ == nullptr && rate_bytes_per_sec_.load() > 0) {
-    bg_thread_.reset(
-        new port::Thread(&DeleteScheduler::BackgroundEmptyTrash, this));
+void DeleteScheduler::SetNumThreads(int num_threads) {
+  assert(num_threads > 0);
+  {
+    InstrumentedMutexLock l(&mu_);
+    num_threads_ = std::max(num_threads, 1);
+    // Wake up the threads that may now take files
+    cv_.SignalAll();
+  }
+  MaybeCreateBackgroundThreads();
+}
+
+void DeleteScheduler::MaybeCreateBackgroundThreads() {
+  if (rate_bytes_per_sec_.load() <= 0) {
+    return;
+  }
+  InstrumentedMutexLock l(&mu_);
+  while (static_cast<int>(bg_threads_.size()) < num_threads_) {
+    bg_threads_.emplace_back(&DeleteScheduler::BackgroundEmptyTrash, this,
+                             static_cast<int>(bg_threads_.size()));
     ROCKS_LOG_INFO(info_log_,
-                   "Created background thread for deletion scheduler with "
-                   "rate_bytes_per_sec: %" PRIi64,
-                   rate_bytes_per_sec_.load());
+                   "Created background thread %" ROCKSDB_PRIszt
+                   " for deletion scheduler with rate_bytes_per_sec: %" PRIi64,
+                   bg_threads_.size() - 1, rate_bytes_per_sec_.load());
   }
 }
 
 }  // namespace ROCKSDB_NAMESPACE
-
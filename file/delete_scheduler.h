@@ -6,10 +6,11 @@
 #pragma once
 
 
+#include <deque>
 #include <map>
-#include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "monitoring/instrumented_mutex.h"
 #include "port/port.h"
@@ -27,6 +28,9 @@ class SystemClock;
 // Instead of deleteing files immediately, files are marked as trash
 // and deleted in a background thread that apply sleep penalty between deletes
 // if they are happening in a rate faster than rate_bytes_per_sec,
+// The trash can be emptied by several background threads that share the rate
+// limit. While the SstFileManager reports that the maximum allowed space is
+// reached, the threads delete the trash without penalty.
 //
 // Rate limiting can be turned off by setting rate_bytes_per_sec = 0, In this
 // case DeleteScheduler will delete files immediately.
@@ -45,9 +49,19 @@ class DeleteScheduler {
   // Set delete rate limit in bytes per second
   void SetRateBytesPerSecond(int64_t bytes_per_sec) {
     rate_bytes_per_sec_.store(bytes_per_sec);
-    MaybeCreateBackgroundThread();
+    MaybeCreateBackgroundThreads();
   }
 
+  // Return the number of background threads that delete trash files
+  int GetNumThreads() {
+    InstrumentedMutexLock l(&mu_);
+    return num_threads_;
+  }
+
+  // Set the number of background threads that delete trash files. Threads
+  // beyond the number stay idle until it grows again.
+  void SetNumThreads(int num_threads);
+
   // Mark file as trash directory and schedule its deletion. If force_bg is
   // set, it forces the file to always be deleted in the background thread,
   // except when rate limiting is disabled
@@ -93,9 +107,10 @@ class DeleteScheduler {
                          const std::string& dir_to_sync,
                          uint64_t* deleted_bytes, bool* is_complete);
 
-  void BackgroundEmptyTrash();
+  // Run by the background thread of the given index
+  void BackgroundEmptyTrash(int thread_idx);
 
-  void MaybeCreateBackgroundThread();
+  void MaybeCreateBackgroundThreads();
 
   SystemClock* clock_;
   FileSystem* fs_;
@@ -104,7 +119,8 @@ class DeleteScheduler {
   std::atomic<uint64_t> total_trash_size_;
   // Maximum number of bytes that should be deleted per second
   std::atomic<int64_t> rate_bytes_per_sec_;
-  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_
+  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_,
+  // num_threads_, bg_threads_ and the rate limiting state
   InstrumentedMutex mu_;
 
   struct FileAndDir {
@@ -113,24 +129,36 @@ class DeleteScheduler {
     std::string dir;  // empty will be skipped.
   };
 
-  // Queue of trash files that need to be deleted
-  std::queue<FileAndDir> queue_;
+  // Queue of trash files that need to be deleted. A background thread takes
+  // a file off the front while deleting it, and puts it back there when only
+  // a chunk of it was deleted.
+  std::deque<FileAndDir> queue_;
   // Number of trash files that are waiting to be deleted
   int32_t pending_files_;
   uint64_t bytes_max_delete_chunk_;
   // Errors that happened in BackgroundEmptyTrash (file_path => error)
   std::map<std::string, Status> bg_errors_;
 
-  bool num_link_error_printed_ = false;
+  std::atomic<bool> num_link_error_printed_{false};
   // Set to true in ~DeleteScheduler() to force BackgroundEmptyTrash to stop
   bool closing_;
   // Condition variable signaled in these conditions
   //    - pending_files_ value change from 0 => 1
   //    - pending_files_ value change from 1 => 0
   //    - closing_ value is set to true
+  //    - num_threads_ value grows
   InstrumentedCondVar cv_;
-  // Background thread running BackgroundEmptyTrash
-  std::unique_ptr<port::Thread> bg_thread_;
+  // Number of background threads that delete files, the others stay idle
+  int num_threads_;
+  // Background threads running BackgroundEmptyTrash
+  std::vector<port::Thread> bg_threads_;
+  // The penalties of the background threads are relative to the time the
+  // trash started to be emptied at the current rate, and to the bytes deleted
+  // since then. The window restarts whenever the trash empties.
+  uint64_t window_start_time_;
+  uint64_t window_deleted_bytes_;
+  int64_t window_delete_rate_;
+  bool window_idle_;
   // Mutex to protect threads from file name conflicts
   InstrumentedMutex file_move_mu_;
   Logger* info_log_;
@@ -5,6 +5,7 @@
 
 #include "file/delete_scheduler.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cinttypes>
 #include <thread>
@@ -697,6 +698,81 @@ TEST_F(DeleteSchedulerTest, ImmediateDeleteOn25PercDBSize) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+// Several background threads delete the files of the trash at once, and
+// share the rate limit
+TEST_F(DeleteSchedulerTest, MultipleThreads) {
+  std::vector<uint64_t> penalties;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::BackgroundEmptyTrash:Wait",
+      [&](void* arg) { penalties.push_back(*(static_cast<uint64_t*>(arg))); });
+  std::atomic<int> num_deleting{0};
+  std::atomic<int> max_num_deleting{0};
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile", [&](void* /*arg*/) {
+        int n = num_deleting.fetch_add(1) + 1;
+        int max_n = max_num_deleting.load();
+        while (n > max_n && !max_num_deleting.compare_exchange_weak(max_n, n)) {
+        }
+        env_->SleepForMicroseconds(10000);
+        num_deleting.fetch_sub(1);
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1024 * 1024;  // 1 MB / sec
+  NewDeleteScheduler();
+  ASSERT_EQ(sst_file_mgr_->GetDeleteThreads(), 1);
+  sst_file_mgr_->SetDeleteThreads(4);
+  ASSERT_EQ(sst_file_mgr_->GetDeleteThreads(), 4);
+
+  const int num_files = 40;
+  const uint64_t file_size = 1024;
+  for (int i = 0; i < num_files; i++) {
+    std::string file_name = "file" + std::to_string(i) + ".data";
+    ASSERT_OK(delete_scheduler_->DeleteFile(
+        NewDummyFile(file_name, file_size), dummy_files_dirs_[0]));
+  }
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_EQ(delete_scheduler_->GetBackgroundErrors().size(), 0U);
+  ASSERT_EQ(CountNormalFiles(), 0);
+  ASSERT_EQ(CountTrashFiles(), 0);
+  ASSERT_GE(max_num_deleting.load(), 2);
+
+  // The penalties grow with the bytes deleted by all the threads
+  ASSERT_EQ(penalties.size(), num_files);
+  ASSERT_EQ(*std::max_element(penalties.begin(), penalties.end()),
+            num_files * file_size * 1000000 / rate_bytes_per_sec_);
+  ASSERT_EQ(num_files,
+            stats_->getAndResetTickerCount(FILES_DELETED_FROM_TRASH_QUEUE));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
+// The trash is deleted without penalty while the max allowed space is reached
+TEST_F(DeleteSchedulerTest, NoPenaltyWhenMaxAllowedSpaceReached) {
+  std::vector<uint64_t> penalties;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::BackgroundEmptyTrash:Wait",
+      [&](void* arg) { penalties.push_back(*(static_cast<uint64_t*>(arg))); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1024;  // 1 Kb / sec
+  NewDeleteScheduler();
+  sst_file_mgr_->SetMaxAllowedSpaceUsage(1);
+
+  // Would take 10 seconds at the rate limit
+  const int num_files = 10;
+  for (int i = 0; i < num_files; i++) {
+    std::string file_name = "file" + std::to_string(i) + ".data";
+    ASSERT_OK(delete_scheduler_->DeleteFile(NewDummyFile(file_name),
+                                            dummy_files_dirs_[0]));
+  }
+  uint64_t delete_start_time = env_->NowMicros();
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_LT(env_->NowMicros() - delete_start_time, 5000000U);
+  ASSERT_EQ(CountTrashFiles(), 0);
+  ASSERT_EQ(penalties, std::vector<uint64_t>(num_files, 0));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DeleteSchedulerTest, IsTrashCheck) {
   // Trash files
   ASSERT_TRUE(DeleteScheduler::IsTrashFile("x.trash"));
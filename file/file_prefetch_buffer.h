@@ -329,6 +329,8 @@ class FilePrefetchBuffer {
 
   size_t GetPrefetchOffset() const { return bufs_.front()->offset_; }
 
+  FilePrefetchBufferUsage GetUsage() const { return usage_; }
+
   // Called in case of implicit auto prefetching.
   void UpdateReadPattern(const uint64_t& offset, const size_t& len,
                          bool decrease_readaheadsize) {
@@ -1882,6 +1882,192 @@ TEST_P(PrefetchTest, DBIterAsyncIONoIOUring) {
   enable_io_uring = true;
 }
 
+// With learned_auto_readahead, the implicit readahead of new iterators starts
+// at the size the scans of the file usually read.
+TEST_P(PrefetchTest, LearnedAutoReadahead) {
+  if (mem_env_ || encrypted_env_) {
+    ROCKSDB_GTEST_SKIP("Test requires non-mem or non-encrypted environment");
+    return;
+  }
+  const int kNumKeys = 1000;
+  bool use_direct_io = std::get<0>(GetParam());
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), false);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options;
+  SetGenericOptions(env.get(), use_direct_io, options);
+  options.write_buffer_size = 64 << 20;
+  BlockBasedTableOptions table_options;
+  SetBlockBasedTableOptions(table_options);
+  // Only data blocks are read through the prefetch buffer
+  table_options.index_type = BlockBasedTableOptions::IndexType::kBinarySearch;
+  table_options.learned_auto_readahead = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  Random rnd(309);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+  // The readahead size of each read through a prefetch buffer
+  std::vector<size_t> readahead_sizes;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::TryReadFromCache", [&](void* arg) {
+        readahead_sizes.push_back(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto full_scan = [&]() {
+    readahead_sizes.clear();
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, num_keys);
+    ASSERT_FALSE(readahead_sizes.empty());
+  };
+
+  // No history yet
+  full_scan();
+  ASSERT_EQ(table_options.initial_auto_readahead_size,
+            readahead_sizes.front());
+
+  // The file was read in full, which is more than max_auto_readahead_size
+  full_scan();
+  ASSERT_EQ(table_options.max_auto_readahead_size, readahead_sizes.front());
+
+  // Point lookups through iterators read one data block each
+  for (int i = 0; i < 64; i++) {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    iter->Seek(Key(i * 15));
+    ASSERT_TRUE(iter->Valid());
+  }
+  full_scan();
+  ASSERT_GT(readahead_sizes.front(), 0);
+  ASSERT_LT(readahead_sizes.front(),
+            table_options.initial_auto_readahead_size);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
+// With async_io, the level iterator opens each next file of the level ahead
+// of the scan and has the table read ahead its first data blocks.
+TEST_P(PrefetchTest, PrefetchNextFileWithAsyncIO) {
+  if (mem_env_ || encrypted_env_) {
+    ROCKSDB_GTEST_SKIP("Test requires non-mem or non-encrypted environment");
+    return;
+  }
+  const int kNumKeys = 100;
+  const int kNumFiles = 5;
+  bool use_direct_io = std::get<0>(GetParam());
+  std::shared_ptr<MockFS> fs =
+      std::make_shared<MockFS>(env_->GetFileSystem(), true);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+
+  Options options;
+  SetGenericOptions(env.get(), use_direct_io, options);
+  BlockBasedTableOptions table_options;
+  SetBlockBasedTableOptions(table_options);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  Random rnd(309);
+  for (int j = 0; j < kNumFiles; j++) {
+    for (int i = j * kNumKeys; i < (j + 1) * kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(2);
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(2));
+
+  std::vector<size_t> next_files;
+  int table_prefetches = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "LevelIterator::PrefetchNextFile", [&](void* arg) {
+        next_files.push_back(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::PrefetchForScan", [&](void* arg) {
+        ASSERT_EQ(table_options.initial_auto_readahead_size,
+                  *static_cast<size_t*>(arg));
+        table_prefetches++;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Each file but the first is prefetched once, while the scan reads the
+  // file before it
+  {
+    ReadOptions ro;
+    ro.async_io = true;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumFiles * kNumKeys, num_keys);
+    ASSERT_EQ(std::vector<size_t>({1, 2, 3, 4}), next_files);
+    ASSERT_EQ(kNumFiles - 1, table_prefetches);
+  }
+
+  // Not past the upper bound
+  next_files.clear();
+  table_prefetches = 0;
+  {
+    ReadOptions ro;
+    ro.async_io = true;
+    std::string upper_bound = Key(kNumKeys);
+    Slice upper_bound_slice = upper_bound;
+    ro.iterate_upper_bound = &upper_bound_slice;
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    int num_keys = 0;
+    for (iter->Seek(Key(1)); iter->Valid(); iter->Next()) {
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys - 1, num_keys);
+    ASSERT_TRUE(next_files.empty());
+    ASSERT_EQ(0, table_prefetches);
+  }
+
+  // Not without async_io
+  {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ReadOptions()));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(next_files.empty());
+    ASSERT_EQ(0, table_prefetches);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 class PrefetchTest1 : public DBTestBase,
                       public ::testing::WithParamInterface<bool> {
  public:
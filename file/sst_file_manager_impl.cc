@@ -236,6 +236,14 @@ void SstFileManagerImpl::SetMaxTrashDBRatio(double r) {
   return delete_scheduler_.SetMaxTrashDBRatio(r);
 }
 
+int SstFileManagerImpl::GetDeleteThreads() {
+  return delete_scheduler_.GetNumThreads();
+}
+
+void SstFileManagerImpl::SetDeleteThreads(int num_threads) {
+  return delete_scheduler_.SetNumThreads(num_threads);
+}
+
 uint64_t SstFileManagerImpl::GetTotalTrashSize() {
   return delete_scheduler_.GetTotalTrashSize();
 }
@@ -37,10 +37,10 @@ class SstFileManagerImpl : public SstFileManager {
 
   // Overload where size of the file is provided by the caller rather than
   // queried from the filesystem. This is an optimization.
-  Status OnAddFile(const std::string& file_path, uint64_t file_size);
+  virtual Status OnAddFile(const std::string& file_path, uint64_t file_size);
 
   // DB will call OnDeleteFile whenever a sst/blob file is deleted.
-  Status OnDeleteFile(const std::string& file_path);
+  virtual Status OnDeleteFile(const std::string& file_path);
 
   // DB will call OnMoveFile whenever a sst/blob file is move to a new path.
   Status OnMoveFile(const std::string& old_path, const std::string& new_path,
@@ -99,6 +99,12 @@ class SstFileManagerImpl : public SstFileManager {
   // Update trash/DB size ratio where new files will be deleted immediately
   void SetMaxTrashDBRatio(double ratio) override;
 
+  // Return the number of background threads that delete trash files
+  int GetDeleteThreads() override;
+
+  // Update the number of background threads that delete trash files
+  void SetDeleteThreads(int num_threads) override;
+
   // Return the total size of trash files
   uint64_t GetTotalTrashSize() override;
 
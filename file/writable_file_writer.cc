@@ -457,6 +457,20 @@ IOStatus WritableFileWriter::Sync(const IOOptions& opts, bool use_fsync) {
   }
 
   IOOptions io_options = FinalizeIOOptions(opts);
+  if (buf_.CurrentSize() > 0 && !use_direct_io() && pending_sync_ &&
+      !perform_data_verification_ && !ShouldNotifyListeners() &&
+      (rate_limiter_ == nullptr ||
+       io_options.rate_limiter_priority == Env::IO_TOTAL)) {
+    // Nothing needs the buffered data written on its own, so the file may
+    // write and sync it in one request
+    IOStatus s = WriteBufferedAndSync(io_options, use_fsync);
+    if (!s.ok()) {
+      return s;
+    }
+    TEST_KILL_RANDOM("WritableFileWriter::Sync:1");
+    pending_sync_ = false;
+    return IOStatus::OK();
+  }
   IOStatus s = Flush(io_options);
   if (!s.ok()) {
     set_seen_error();
@@ -654,6 +668,33 @@ IOStatus WritableFileWriter::WriteBuffered(const IOOptions& opts,
   return s;
 }
 
+IOStatus WritableFileWriter::WriteBufferedAndSync(const IOOptions& opts,
+                                                  bool use_fsync) {
+  assert(!use_direct_io());
+  const size_t size = buf_.CurrentSize();
+  IOStatus s;
+  {
+    IOSTATS_TIMER_GUARD(fsync_nanos);
+    TEST_SYNC_POINT("WritableFileWriter::Flush:BeforeAppend");
+    auto prev_perf_level = GetPerfLevel();
+    IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, clock_);
+    s = writable_file_->AppendAndSync(Slice(buf_.BufferStart(), size),
+                                      use_fsync, opts, nullptr);
+    SetPerfLevel(prev_perf_level);
+  }
+  // As in WriteBuffered(), the data is not written again after an error
+  buf_.Size(0);
+  buffered_data_crc32c_checksum_ = 0;
+  if (!s.ok()) {
+    set_seen_error();
+    return s;
+  }
+  IOSTATS_ADD(bytes_written, size);
+  uint64_t cur_size = flushed_size_.load(std::memory_order_acquire);
+  flushed_size_.store(cur_size + size, std::memory_order_release);
+  return s;
+}
+
 IOStatus WritableFileWriter::WriteBufferedWithChecksum(const IOOptions& opts,
                                                        const char* data,
                                                        size_t size) {
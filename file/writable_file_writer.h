@@ -325,6 +325,10 @@ class WritableFileWriter {
   // Normal write.
   // `opts` should've been called with `FinalizeIOOptions()` before passing in
   IOStatus WriteBuffered(const IOOptions& opts, const char* data, size_t size);
+  // Writes the buffered data and syncs the file with one
+  // FSWritableFile::AppendAndSync().
+  // `opts` should've been called with `FinalizeIOOptions()` before passing in
+  IOStatus WriteBufferedAndSync(const IOOptions& opts, bool use_fsync);
   // `opts` should've been called with `FinalizeIOOptions()` before passing in
   IOStatus WriteBufferedWithChecksum(const IOOptions& opts, const char* data,
                                      size_t size);
@@ -249,6 +249,25 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t inplace_update_num_locks = 10000;
 
+  // If true, a merge into a key whose newest entry in the current memtable is
+  // a merge operand or a put folds into that entry instead of adding one:
+  //   * onto a merge operand with MergeOperator::PartialMerge(), in place iff
+  //     the result is not larger than the operand
+  //   * onto a put with a full merge, in place iff the result is not larger
+  //     than the value, or else as a new put
+  // The entry is only folded into if no snapshot can read it, i.e. it is
+  // newer than the newest snapshot. A point lookup of a hot counter, e.g.
+  // with the uint64add merge operator, then reads one entry from the
+  // memtable instead of all the operands written since the last flush.
+  //
+  // Like inplace_update_support, this is not compatible with concurrent
+  // memtable writes nor with transactions (whose keys are not folded into),
+  // and reads without a snapshot, including iterators, may see operands
+  // merged after they started. The locks of inplace_update_num_locks guard
+  // the entries against concurrent reads.
+  // Default: false.
+  bool inplace_merge_support = false;
+
   // [experimental]
   // Used to activate or deactive the Mempurge feature (memtable garbage
   // collection). (deactivated by default). At every flush, the total useful
@@ -266,6 +285,27 @@ struct AdvancedColumnFamilyOptions {
   // [experimental]
   double experimental_mempurge_threshold = 0.0;
 
+  // [experimental]
+  // If true, the memtable produced by a mempurge (see
+  // experimental_mempurge_threshold) keeps its entries in one array sorted by
+  // key rather than in a rep created by memtable_factory. The array is more
+  // compact than a skip list and is searched by binary search without any
+  // lock, which makes the reads and flushes of the immutable memtables
+  // cheaper.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool experimental_mempurge_sorted_array = false;
+
+  // If true, once a memtable turns immutable, a background job in the HIGH
+  // priority thread pool copies its entries, in key order, into an array
+  // that is binary searched by the reads and by the flush instead of the
+  // memtable rep. The array costs one pointer per entry on top of the
+  // memtable. It helps when the immutable memtables wait long enough for
+  // their flush to be read, e.g. with max_write_buffer_number > 2.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool flatten_immutable_memtables = false;
+
   // existing_value - pointer to previous value (from both memtable and sst).
   //                  nullptr if key doesn't exist
   // existing_value_size - pointer to size of existing_value).
@@ -337,6 +377,24 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool memtable_whole_key_filtering = false;
 
+  // A hash index in memtable from each user key to its latest entry, so a
+  // point lookup of a key in the memtable starts at its entry rather than
+  // searching the memtable from the top. The size in bytes of the index is
+  // write_buffer_size * memtable_hash_index_size_ratio, 8 bytes per bucket.
+  // A bucket that two keys hash to is given up for the life of the
+  // memtable, so the index should have several buckets per entry.
+  //
+  // Only the default skip list memtable supports the index, and only
+  // without user-defined timestamps and with a comparator for which keys are
+  // equal only if their bytes are.
+  //
+  // If this value is larger than 0.25, it is sanitized to 0.25.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  double memtable_hash_index_size_ratio = 0.0;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
@@ -349,6 +407,19 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If true, each core allocates memtable entries from arena blocks whose
+  // pages are placed on the core's NUMA node, so concurrent writers on a
+  // multi-socket machine write to local memory. Only has an effect when
+  // RocksDB is built with NUMA support (libnuma), the machine has more than
+  // one NUMA node, and allow_concurrent_memtable_write spreads the inserts
+  // across the cores. A memtable may use up to one more arena block per
+  // node.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_numa_local_alloc = false;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -564,6 +635,21 @@ struct AdvancedColumnFamilyOptions {
   std::vector<int> max_bytes_for_level_multiplier_additional =
       std::vector<int>(static_cast<size_t>(num_levels), 1);
 
+  // If larger than 1, the level above the last level is only compacted into
+  // the last level once its size reaches this multiple of its target size.
+  // Each of these compactions then merges more data into the last level
+  // files it rewrites, which cuts the bytes rewritten in the last level, and
+  // with it the uploads and deletions of cloud objects, at the cost of more
+  // space and read amplification. The estimate of pending compaction bytes
+  // that soft_pending_compaction_bytes_limit and
+  // hard_pending_compaction_bytes_limit are compared to uses the same
+  // trigger. This option only applies to leveled compaction.
+  //
+  // Default: 1
+  //
+  // Dynamically changeable through SetOptions() API
+  double penultimate_level_compaction_trigger = 1;
+
   // We try to limit number of bytes in one compaction to be lower than this
   // threshold. But it's not guaranteed.
   // Value 0 will be sanitized.
@@ -573,6 +659,20 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint64_t max_compaction_bytes = 0;
 
+  // If true, a leveled compaction from a level into the next one does not
+  // rewrite the input files whose key ranges overlap no other input file.
+  // Such files of the output level stay where they are and such files of
+  // the start level move to the output level, like in a trivial move, while
+  // the other inputs are compacted into output files that are cut around
+  // them. A file of the start level only moves if a trivial move could move
+  // it, e.g. its compression must match that of the output level. Compactions
+  // with a compaction filter never reuse files.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool compaction_reuse_non_overlapping_files = false;
+
   // All writes will be slowed down to at least delayed_write_rate if estimated
   // bytes needed to be compaction exceed this threshold.
   //
@@ -688,6 +788,42 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // If positive, each new table file also stores a Bloom filter of its user
+  // keys at this many bits per key, the "level filter", which stays in memory
+  // for as long as the file is live, even while the table reader of the file
+  // is not in the table cache. Point lookups check it before opening the
+  // file, so that with max_open_files limited, a key missing from a level
+  // does not cost loading the table reader and the filter of the file.
+  // Level filters are loaded when the table files are opened on DB::Open(),
+  // and take about bits_per_key / 8 bytes of memory per key of the DB.
+  //
+  // Files with range tombstones get no level filter, and files written with
+  // optimize_filters_for_hits to the last level neither. Changing this option
+  // on reopen applies to the files written from then on, except that 0 also
+  // stops using the level filters of existing files.
+  //
+  // Default: 0 (disabled)
+  double level_filter_bits_per_key = 0;
+
+  // If nonzero, the approximate number of bytes the filter blocks of the
+  // table files of the column family may take. Reads check the filters of
+  // the levels from L0 down as long as their filters fit in the budget, and
+  // skip the filters of the deeper levels, like optimize_filters_for_hits
+  // does for the last level. The filter blocks that are no longer read then
+  // leave the block cache over time, without rewriting the files, and
+  // raising the budget brings them back on demand. The filter size of each
+  // level is estimated from the table properties of the files sampled for
+  // the version stats (see skip_stats_update_on_db_open).
+  //
+  // Only filters held in the block cache are shed (see
+  // BlockBasedTableOptions::cache_index_and_filter_blocks), and not those
+  // pinned there or held by the table readers.
+  //
+  // Default: 0 (no budget)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t filter_memory_budget = 0;
+
   // After writing every SST file, reopen it and read all the keys.
   // Checks the hash of all of the keys and values written versus the
   // keys in the file and signals a corruption if they do not match
@@ -947,6 +1083,24 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   double blob_garbage_collection_force_threshold = 1.0;
 
+  // The maximum number of batches of blob files that forced garbage
+  // collection (see blob_garbage_collection_force_threshold above) targets at
+  // a time. A batch is a blob file that is the oldest one referenced by some
+  // SSTs, along with the newer blob files up to the next such file. With the
+  // default of 1, only the oldest batch is considered. With a larger value,
+  // the newer batches that are entirely eligible based on the age cutoff are
+  // considered as well: the SSTs of the oldest batch (if it meets the
+  // threshold) and of the newer ones with the highest garbage ratios meeting
+  // the threshold get compacted, so space held by garbage in newer blob files
+  // is reclaimed without waiting for the oldest ones to accumulate garbage.
+  // Keeping the value small bounds the amount of background I/O that forced
+  // garbage collection causes at any one time.
+  //
+  // Default: 1
+  //
+  // Dynamically changeable through the SetOptions() API
+  int blob_garbage_collection_force_max_batches = 1;
+
   // Compaction readahead for blob files.
   //
   // Default: 0
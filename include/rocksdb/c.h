@@ -124,6 +124,7 @@ typedef struct rocksdb_sstfilewriter_t rocksdb_sstfilewriter_t;
 typedef struct rocksdb_ratelimiter_t rocksdb_ratelimiter_t;
 typedef struct rocksdb_perfcontext_t rocksdb_perfcontext_t;
 typedef struct rocksdb_pinnableslice_t rocksdb_pinnableslice_t;
+typedef struct rocksdb_pinnableslices_t rocksdb_pinnableslices_t;
 typedef struct rocksdb_transactiondb_options_t rocksdb_transactiondb_options_t;
 typedef struct rocksdb_transactiondb_t rocksdb_transactiondb_t;
 typedef struct rocksdb_transaction_options_t rocksdb_transaction_options_t;
@@ -571,6 +572,17 @@ extern ROCKSDB_LIBRARY_API void rocksdb_batched_multi_get_cf(
     const char* const* keys_list, const size_t* keys_list_sizes,
     rocksdb_pinnableslice_t** values, char** errs, const bool sorted_input);
 
+// Like rocksdb_batched_multi_get_cf(), but keeps all the values pinned in the
+// single returned object instead of allocating one rocksdb_pinnableslice_t
+// per key. The values are read with rocksdb_pinnableslices_value() and stay
+// valid until rocksdb_pinnableslices_destroy().
+extern ROCKSDB_LIBRARY_API rocksdb_pinnableslices_t*
+rocksdb_batched_multi_get_pinned_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, size_t num_keys,
+    const char* const* keys_list, const size_t* keys_list_sizes,
+    unsigned char sorted_input);
+
 // The value is only allocated (using malloc) and returned if it is found and
 // value_found isn't NULL. In that case the user is responsible for freeing it.
 extern ROCKSDB_LIBRARY_API unsigned char rocksdb_key_may_exist(
@@ -727,6 +739,15 @@ extern ROCKSDB_LIBRARY_API const char* rocksdb_iter_timestamp(
     const rocksdb_iterator_t*, size_t* tslen);
 extern ROCKSDB_LIBRARY_API void rocksdb_iter_get_error(
     const rocksdb_iterator_t*, char** errptr);
+// Copies up to max_entries entries, starting at the current one, into buf
+// and moves the iterator past them. Each entry is its key followed by its
+// value, back to back, with their sizes in keys_lens and values_lens. Stops
+// early at the end of the iteration, or at an entry that does not fit in the
+// rest of buf. Returns the number of entries copied; 0 with a valid iterator
+// means the current entry is larger than buf_len.
+extern ROCKSDB_LIBRARY_API size_t rocksdb_iter_next_batch(
+    rocksdb_iterator_t* iter, size_t max_entries, char* buf, size_t buf_len,
+    size_t* keys_lens, size_t* values_lens);
 
 extern ROCKSDB_LIBRARY_API void rocksdb_wal_iter_next(
     rocksdb_wal_iterator_t* iter);
@@ -2923,6 +2944,14 @@ extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslice_destroy(
     rocksdb_pinnableslice_t* v);
 extern ROCKSDB_LIBRARY_API const char* rocksdb_pinnableslice_value(
     const rocksdb_pinnableslice_t* t, size_t* vlen);
+extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslices_destroy(
+    rocksdb_pinnableslices_t* v);
+// Returns NULL if the index-th key was not found or could not be read
+extern ROCKSDB_LIBRARY_API const char* rocksdb_pinnableslices_value(
+    const rocksdb_pinnableslices_t* v, size_t index, size_t* vlen);
+// Sets *errptr if reading the index-th key failed, other than not finding it
+extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslices_error(
+    const rocksdb_pinnableslices_t* v, size_t index, char** errptr);
 
 extern ROCKSDB_LIBRARY_API rocksdb_memory_consumers_t*
 rocksdb_memory_consumers_create(void);
@@ -23,7 +23,9 @@
 namespace ROCKSDB_NAMESPACE {
 
 class Cache;  // defined in advanced_cache.h
+class CacheAdmissionFilter;
 struct ConfigOptions;
+class Env;
 class SecondaryCache;
 
 // These definitions begin source compatibility for a future change in which
@@ -160,6 +162,18 @@ struct ShardedCacheOptions {
   // this option must be kept as default empty.
   std::shared_ptr<SecondaryCache> secondary_cache;
 
+  // If non-nullptr, the cache only takes in a new entry while it is full if
+  // the filter admits the entry, which keeps entries read once, e.g. by
+  // scans, from evicting the entries read often. All Lookup()s are reported
+  // to the filter. See CacheAdmissionFilter and NewTinyLfuAdmissionFilter()
+  // in rocksdb/cache_admission_filter.h.
+  //
+  // For a CompressedSecondaryCache, this filters the entries that the
+  // primary cache demotes to it, by how often they were demoted to or looked
+  // up in the secondary cache. A filter should not be shared between a
+  // primary and a secondary cache.
+  std::shared_ptr<CacheAdmissionFilter> admission_filter;
+
   // See hash_seed comments below
   static constexpr int32_t kQuasiRandomHashSeed = -1;
   static constexpr int32_t kHostHashSeed = -2;
@@ -371,6 +385,53 @@ inline std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
   return opts.MakeSharedSecondaryCache();
 }
 
+// EXPERIMENTAL
+// Options for a SecondaryCache that keeps the entries in files on a local
+// file system, typically on an NVMe SSD, as a tier between the DRAM caches
+// and remote storage. The files survive restarts: a new cache opened on the
+// same `path` serves the entries written by the previous one, as long as the
+// block cache keys of the DB stay the same, which they do for SST files.
+// Lookups with wait=false read from the files in the background, so that
+// MultiGet can overlap many reads with SecondaryCache::WaitAll().
+//
+// The cache can be a plain secondary cache (LRUCacheOptions::secondary_cache
+// or HyperClockCacheOptions::secondary_cache) or the nvm_sec_cache of a
+// TieredCacheOptions.
+struct PersistentSecondaryCacheOptions {
+  // The directory of the cache files, created if missing. It must not be
+  // used by anything else, including another cache at the same time.
+  std::string path;
+
+  // The Env of the files. nullptr means Env::Default().
+  Env* env = nullptr;
+
+  // The total size of the cache files. The entries are written to segment
+  // files of `segment_size` bytes, and the oldest segment is deleted when the
+  // files exceed the capacity. Must be less than 32768 * `segment_size`.
+  uint64_t capacity = 0;
+
+  // The size of a segment file, between 1MB and 32GB.
+  uint64_t segment_size = 64 << 20;
+
+  // Entries are written in batches of this many bytes, and are not found by
+  // Lookup() until written. Capped at `segment_size`.
+  size_t write_buffer_size = 1 << 20;
+
+  // The average size of an entry, which sizes the in-memory index of the
+  // cache files, at 10 to 20 bytes per `capacity` / `estimated_entry_size`.
+  // Lookups read this many bytes past the key at once, and need a second
+  // read for larger entries.
+  size_t estimated_entry_size = 8 << 10;
+
+  // The number of threads that serve the lookups with wait=false.
+  int num_io_threads = 4;
+};
+
+// Creates a PersistentSecondaryCache with the given options, reusing the
+// cache files in `opts.path`.
+Status NewPersistentSecondaryCache(const PersistentSecondaryCacheOptions& opts,
+                                   std::shared_ptr<SecondaryCache>* cache);
+
 // HyperClockCache - A lock-free Cache alternative for RocksDB block cache
 // that offers much improved CPU efficiency vs. LRUCache under high parallel
 // load or high contention, with some caveats:
@@ -478,6 +539,37 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
   // keep operations very fast.
   int eviction_effort_cap = 30;
 
+  // EXPERIMENTAL
+  // If non-zero, each core gets a small direct-mapped table of this many
+  // slots (rounded up to a power of two) in front of the shared table, each
+  // slot holding a reference to a recently hit entry. A lookup that finds
+  // its entry there hands out a reference counted in the slot, which lives
+  // in memory private to the core, instead of updating the shared entry, so
+  // repeated hits on hot entries from many threads don't contend. An entry
+  // takes over a slot on a hit in the shared table when the slot is empty or
+  // has missed several lookups in a row. Entries held by the slots count as
+  // pinned and are not evicted while held, so this can keep up to
+  // (number of cores * front_cache_entries_per_core) entries beyond what
+  // eviction would otherwise keep; an erased entry is only freed once its
+  // slots are reused.
+  size_t front_cache_entries_per_core = 0;
+
+  // EXPERIMENTAL
+  // With estimated_entry_charge > 0, back the hash table of each shard with
+  // huge pages, explicitly reserved ones (MAP_HUGETLB on Linux) if available
+  // and otherwise transparent huge pages where supported, to cut the TLB
+  // misses of lookups in multi-GB caches. Falls back silently to regular
+  // memory.
+  bool use_huge_pages_for_table = false;
+
+  // EXPERIMENTAL
+  // With estimated_entry_charge > 0, probe the hash table by groups of four
+  // adjacent slots (256 bytes): a probe sequence goes through the group of
+  // its first slot before moving on to another group, and Lookup prefetches
+  // the whole group up front, so that most lookups only wait for one memory
+  // access. Can be slower for small caches that fit in the CPU caches.
+  bool bucketized_table = false;
+
   HyperClockCacheOptions(
       size_t _capacity, size_t _estimated_entry_charge,
       int _num_shard_bits = -1, bool _strict_capacity_limit = false,
@@ -550,6 +642,19 @@ struct TieredCacheOptions {
   // divided between the primary block cache and compressed secondary cache
   size_t total_capacity = 0;
   double compressed_secondary_ratio = 0.0;
+  // If true, compressed_secondary_ratio is only the initial split of
+  // total_capacity, which the cache then keeps adjusting between
+  // min_compressed_secondary_ratio and max_compressed_secondary_ratio. The
+  // cache remembers the keys recently evicted from the primary cache, and
+  // periodically compares the blocks it had to decompress from the
+  // compressed secondary cache against the lookups of such keys that missed
+  // in both tiers although the secondary cache would have admitted them.
+  // Many decompressions and few such misses move memory to the primary
+  // cache, so that hot blocks are served without decompression, and the
+  // other way around. Not supported with nvm_sec_cache.
+  bool adaptive_compressed_secondary_ratio = false;
+  double min_compressed_secondary_ratio = 0.05;
+  double max_compressed_secondary_ratio = 0.8;
   // An optional secondary cache that will serve as the persistent cache
   // tier. If present, compressed blocks will be written to this
   // secondary cache.
@@ -0,0 +1,63 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A CacheAdmissionFilter decides which entries a full cache takes in, so
+// that entries read only once, e.g. by compactions with fill_cache, one-off
+// scans or large MultiGet sweeps, do not evict the entries that are read
+// over and over. See ShardedCacheOptions::admission_filter.
+//
+// The cache reports every Lookup() to RecordAccess() and asks Admit() before
+// it inserts an entry while it is at or over its capacity. While the cache
+// has room, all entries are admitted. A rejected entry is not kept in the
+// cache: Insert() returns OK, and either hands out a standalone handle to
+// the entry, if the caller asked for a handle, or destroys the entry right
+// away, just like an entry inserted and then evicted at once.
+//
+// The methods are called concurrently by all the threads that use the
+// cache, with the same filter shared by all the shards of the cache.
+class CacheAdmissionFilter {
+ public:
+  virtual ~CacheAdmissionFilter() {}
+
+  // Returns a name that identifies this filter in the cache options.
+  virtual const char* Name() const = 0;
+
+  // Records an access to the entry with the given key, whether or not it
+  // is in the cache.
+  virtual void RecordAccess(const Slice& key) = 0;
+
+  // Returns whether the entry with the given key should be inserted into
+  // a full cache, evicting other entries.
+  virtual bool Admit(const Slice& key) = 0;
+};
+
+// Creates a TinyLFU admission filter, which estimates how often each key was
+// accessed recently with a count-min sketch of 4-bit counters behind a
+// doorkeeper Bloom filter, and admits the keys accessed at least
+// `min_frequency` times. The first access to a key only goes to the
+// doorkeeper, so keys accessed once do not take space in the sketch. The
+// doorkeeper is cleared about every 2 * `expected_entries` recorded
+// accesses, and all counters are halved about every 10 * `expected_entries`
+// recorded accesses, so the estimates follow changes of the working set.
+//
+// `expected_entries` should be about the number of entries the cache holds,
+// e.g. the capacity divided by the block size for a block cache. The filter
+// takes 4 to 8 bytes of memory per expected entry. `min_frequency` is
+// capped at 16, the highest frequency the filter can estimate.
+std::shared_ptr<CacheAdmissionFilter> NewTinyLfuAdmissionFilter(
+    size_t expected_entries, uint32_t min_frequency = 2);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,94 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/options.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// CompactionService that runs the compactions of a cloud DB on workers.
+//
+// Each compaction becomes a job, a string that describes its inputs and the
+// bucket of the DB. The dispatcher ships the job to a worker, which passes
+// it to CloudCompactionWorker::Run(), and returns the result of the worker.
+// The worker reads the input files from the cloud and puts the output
+// files in the dest bucket of the DB, under the remote_compaction directory
+// of the job. The DB then installs them with a copy in the cloud: they are
+// neither uploaded nor downloaded by the DB.
+//
+// With num_reserved_file_numbers, the DB reserves that many file numbers for
+// each job, and a worker whose outputs fit puts them right where the DB
+// keeps its SST files of those numbers, named with the epoch of the DB. The
+// DB installs them where they are, without a copy, checking only that they
+// exist. The worker must then name the objects as the DB does, e.g. with
+// the same shard_data_object_names.
+//
+// REQUIRES: the DB's CloudFileSystem has the dest bucket given here.
+class CloudCompactionService : public CompactionService {
+ public:
+  // Returns kSuccess and the result of the worker, kFailure and the result
+  // of the worker if it has one, or kUseLocal to run the compaction in the
+  // DB. Called from the compaction threads of the DB.
+  using Dispatcher = std::function<CompactionServiceJobStatus(
+      const std::string& job, std::string* result)>;
+
+  CloudCompactionService(BucketOptions dest_bucket, Dispatcher dispatcher,
+                         uint64_t num_reserved_file_numbers = 0);
+
+  static const char* kClassName() { return "CloudCompactionService"; }
+  const char* Name() const override { return kClassName(); }
+
+  CompactionServiceScheduleResponse Schedule(
+      const CompactionServiceJobInfo& info,
+      const std::string& compaction_service_input) override;
+
+  // Dispatches the job
+  CompactionServiceJobStatus Wait(const std::string& scheduled_job_id,
+                                  std::string* result) override;
+
+  uint64_t GetNumReservedFileNumbers() const override {
+    return num_reserved_file_numbers_;
+  }
+
+ private:
+  const BucketOptions dest_bucket_;
+  const Dispatcher dispatcher_;
+  const uint64_t num_reserved_file_numbers_;
+
+  std::mutex mutex_;
+  // The jobs scheduled but not dispatched, by id
+  std::unordered_map<std::string, std::string> jobs_;
+};
+
+struct CloudCompactionWorkerOptions {
+  // Configuration of the CloudFileSystem of the worker, as given to
+  // CloudFileSystemEnv::CreateFromString(), e.g. "id=aws". Its src bucket
+  // is set to the bucket of the job, and it can't have a dest bucket.
+  std::string cloud_fs_config;
+
+  // Local directory where the worker keeps the MANIFEST of the DB and the
+  // output files of a job until they are uploaded. The job's subdirectory
+  // is deleted when the job is done.
+  std::string local_dir;
+
+  // Passed to DB::OpenAndCompact(). The env is replaced with the one of the
+  // CloudFileSystem.
+  OpenAndCompactOptions open_and_compact_options;
+  CompactionServiceOptionsOverride override_options;
+};
+
+class CloudCompactionWorker {
+ public:
+  // Runs the job of a CloudCompactionService, and sets result to the result
+  // the dispatcher returns to the DB, if any.
+  static Status Run(const CloudCompactionWorkerOptions& options,
+                    const std::string& job, std::string* result);
+};
+
+}  // namespace ROCKSDB_NAMESPACE
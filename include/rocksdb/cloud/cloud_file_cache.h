@@ -0,0 +1,77 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+//
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/io_status.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+class FileSystem;
+class Logger;
+
+struct CloudFileCacheOptions {
+  // Local directory where cached extents are stored. The directory is created
+  // if it does not exist. Extents found in this directory when the cache is
+  // created are reused, so the cache survives process restarts.
+  std::string cache_dir;
+
+  // Maximum number of bytes of extent data kept in cache_dir. When an insert
+  // would exceed the capacity, the least recently used extents are evicted.
+  // Default: 1GB
+  uint64_t capacity = 1ull << 30;
+
+  // Granularity of the cache. Cloud reads that miss the cache are widened to
+  // whole, extent_size-aligned extents before they are fetched.
+  // Default: 1MB
+  uint64_t extent_size = 1ull << 20;
+
+  // File system used to store the extents. If null, FileSystem::Default() is
+  // used.
+  std::shared_ptr<FileSystem> fs;
+
+  std::shared_ptr<Logger> info_log;
+};
+
+// A bounded, persistent cache of byte ranges ("extents") of cloud objects.
+// Used by CloudStorageReadableFile to serve reads of cloud-only SST files
+// (keep_local_sst_files=false) without a round trip to the storage provider.
+//
+// Cloud object names are never reused with different contents (every SST
+// carries the epoch suffix), so cached extents never have to be invalidated
+// because of overwrites; they only need to be erased when the object is
+// deleted.
+//
+// All methods are thread safe.
+class CloudFileCache {
+ public:
+  virtual ~CloudFileCache() {}
+
+  virtual const char* Name() const = 0;
+
+  // Looks up extent number `extent` of the object identified by `object_key`.
+  // Returns OK and fills data on hit, NotFound on miss.
+  virtual IOStatus Lookup(const std::string& object_key, uint64_t extent,
+                          std::string* data) = 0;
+
+  // Stores extent number `extent` of `object_key`. Might evict other extents
+  // to stay within the capacity.
+  virtual IOStatus Insert(const std::string& object_key, uint64_t extent,
+                          const Slice& data) = 0;
+
+  // Drops all the cached extents of `object_key`
+  virtual void Erase(const std::string& object_key) = 0;
+
+  virtual uint64_t GetExtentSize() const = 0;
+  virtual uint64_t GetCapacity() const = 0;
+  virtual uint64_t GetUsage() const = 0;
+};
+
+// Creates a CloudFileCache storing its extents in options.cache_dir.
+Status NewCloudFileCache(const CloudFileCacheOptions& options,
+                         std::shared_ptr<CloudFileCache>* cache);
+
+}  // namespace ROCKSDB_NAMESPACE
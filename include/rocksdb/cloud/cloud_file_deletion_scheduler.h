@@ -5,6 +5,8 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "rocksdb/io_status.h"
 
@@ -35,6 +37,24 @@ class CloudFileDeletionScheduler
   rocksdb::IOStatus ScheduleFileDeletion(const std::string& filename,
                                          FileDeletionRunnable runnable);
 
+  // Deletes the given objects from the cloud
+  using BatchFileDeletionRunnable =
+      std::function<void(const std::vector<std::string>& object_paths)>;
+  // Like ScheduleFileDeletion, but the deletion of object_path is coalesced
+  // with the other batched deletions scheduled within kBatchWindow of the
+  // first one, up to kMaxBatchSize of them, into one call of the runnable of
+  // the first. They are all run once the last one is due. The runnables must
+  // all delete from the same bucket.
+  rocksdb::IOStatus ScheduleBatchedFileDeletion(
+      const std::string& filename, const std::string& object_path,
+      BatchFileDeletionRunnable runnable);
+
+  // Short enough not to hold the deletions back, long enough for the files
+  // obsoleted by a compaction
+  static constexpr std::chrono::milliseconds kBatchWindow{100};
+  // The most keys an S3 DeleteObjects request takes
+  static constexpr size_t kMaxBatchSize = 1000;
+
 #ifndef NDEBUG
   size_t TEST_NumScheduledJobs() const;
 
@@ -51,12 +71,30 @@ class CloudFileDeletionScheduler
 #endif
 
  private:
+  struct FileDeletionBatch {
+    // Deletions scheduled until then join the batch
+    std::chrono::steady_clock::time_point open_until;
+    // File names and object paths
+    std::vector<std::pair<std::string, std::string>> files;
+    BatchFileDeletionRunnable runnable;
+  };
+  struct ScheduledDeletion {
+    // Job of a deletion scheduled alone
+    long job_handle = -1;
+    // Batch of a batched deletion
+    std::shared_ptr<FileDeletionBatch> batch;
+  };
+
   // execute the `FileDeletionRunnable`
   void DoDeleteFile(const std::string& fname, FileDeletionRunnable cb);
+  // Deletes the files of the batch that are still scheduled
+  void DoDeleteBatch(const std::shared_ptr<FileDeletionBatch>& batch);
   std::shared_ptr<CloudScheduler> scheduler_;
 
   mutable std::mutex files_to_delete_mutex_;
-  std::unordered_map<std::string, int> files_to_delete_;
+  std::unordered_map<std::string, ScheduledDeletion> files_to_delete_;
+  // The batch new batched deletions join. Protected by files_to_delete_mutex_
+  std::shared_ptr<FileDeletionBatch> open_batch_;
   std::chrono::seconds file_deletion_delay_;
 };
 
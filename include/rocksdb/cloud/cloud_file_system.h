@@ -3,9 +3,11 @@
 #pragma once
 #include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/configurable.h"
@@ -27,10 +29,15 @@ class S3Client;
 
 namespace ROCKSDB_NAMESPACE {
 
+class BlockCipher;
+class CloudFileCache;
 class CloudFileSystem;
 class CloudLogController;
+class CloudLogTailer;
 class CloudManifest;
 class CloudStorageProvider;
+class RateLimiter;
+class Statistics;
 
 enum CloudType : unsigned char {
   kCloudNone = 0x0,       // Not really a cloud env
@@ -107,6 +114,16 @@ class KafkaLogOptions {
   //  ("metadata.broker.list", "kafka1.rockset.com,kafka2.rockset.com"
   //
   std::unordered_map<std::string, std::string> client_config_params;
+
+  // If non-zero, log files don't wait for the producer queue to drain on
+  // every Flush. Up to max_in_flight_messages messages per file are left in
+  // flight, and Sync only waits for the delivery reports of the messages
+  // produced before it. Appends carry their offset in the file, so the
+  // tailer copes with them being reordered by retries; Close waits for the
+  // appends before logging the end of the file.
+  //
+  // Default: 0 (Flush waits for every message)
+  size_t max_in_flight_messages = 0;
 };
 
 enum class CloudRequestOpType {
@@ -183,6 +200,11 @@ class AwsCloudOptions {
   static Status GetClientConfiguration(
       CloudFileSystem* fs, const std::string& region,
       Aws::Client::ClientConfiguration* config);
+  // The configuration of a client shared by file systems (share_s3_client),
+  // which can outlive fs
+  static Status GetSharedClientConfiguration(
+      CloudFileSystem* fs, const std::string& region,
+      Aws::Client::ClientConfiguration* config);
 };
 
 //
@@ -227,6 +249,56 @@ class CloudFileSystemOptions {
   // Default:  false
   bool keep_local_sst_files;
 
+  // If keep_local_sst_files is true, the SST files written with one of these
+  // temperatures are nevertheless kept only in the cloud, as if
+  // keep_local_sst_files was false for them: they are read through the
+  // cloud, and neither downloaded on open nor on read. With
+  // last_level_temperature=kCold and kCold here, for example, the upper
+  // levels stay on local disk and the last level is only in the cloud. The
+  // local space of a file is reclaimed when compaction moves its data down
+  // to a cloud-only temperature.
+  // The temperature of a file is the one RocksDB passes in FileOptions, see
+  // last_level_temperature, default_write_temperature and
+  // preclude_last_level_data_seconds.
+  //
+  // Default: empty
+  std::vector<Temperature> cloud_only_sst_temperatures;
+
+  // If positive, the SST files that would otherwise only be in the cloud
+  // (all of them if keep_local_sst_files is false, else the ones of
+  // cloud_only_sst_temperatures) are kept on local disk, up to this many
+  // bytes: the files just written stay local after their upload, and the
+  // files read from the cloud are downloaded in the background. Reads of
+  // retained files are local. When the pool is full, the least recently
+  // opened files are deleted locally, they stay in the cloud.
+  // The pool is rebuilt from the local files of the DB on open.
+  //
+  // Default: 0 (disabled)
+  uint64_t local_sst_retention_bytes = 0;
+
+  // Returns whether an SST file of the given temperature is kept locally
+  bool KeepLocalSstFile(Temperature temperature) const;
+
+  // If not empty, the storage class of the objects of the SST files written
+  // with one of cloud_only_sst_temperatures, such as STANDARD_IA or
+  // GLACIER_IR for S3: a class that is cheaper to store but still readable
+  // with ranged reads. With FIFO compaction and
+  // CompactionOptionsFIFO::file_temperature_age_thresholds moving the files
+  // past an age to kCold, and kCold in cloud_only_sst_temperatures, for
+  // example, the old files of a time series are rewritten into the cheaper
+  // class and dropped from local disk, and stay readable through the cloud
+  // until FIFO compaction deletes them (max_table_files_size still counts
+  // them). These files are uploaded whole when closed, not streamed with
+  // multipart uploads, and their copies, e.g. by savepoints, are in the
+  // default class of the bucket.
+  //
+  // Default: empty (the default class of the bucket)
+  std::string cloud_only_sst_storage_class;
+
+  // Returns the storage class of the object of an SST file of the given
+  // temperature, empty for the default class of the bucket
+  std::string SstStorageClass(Temperature temperature) const;
+
   // If true,  then .log and MANIFEST files are stored in a local file system.
   //           they are not uploaded to any cloud logging system.
   // If false, then .log and MANIFEST files are not stored locally, and are
@@ -254,6 +326,12 @@ class CloudFileSystemOptions {
   // parameters: (op, size, latency in microseconds, is_success)
   std::shared_ptr<CloudRequestCallback> cloud_request_callback;
 
+  // If non-null, every cloud operation is recorded in these statistics: the
+  // CLOUD_*_REQUESTS tickers and CLOUD_*_MICROS histograms of its type, the
+  // bytes it read or wrote, failures, retries and throttles. Usually the
+  // statistics of the DB (Options::statistics). Respects their StatsLevel.
+  std::shared_ptr<Statistics> statistics;
+
   // If true, enables server side encryption. If used with encryption_key_id in
   // S3 mode uses AWS KMS. Otherwise, uses S3 server-side encryption where
   // key is automatically created by Amazon.
@@ -264,6 +342,19 @@ class CloudFileSystemOptions {
   // Default: empty
   std::string encryption_key_id;
 
+  // If non-null, the objects are encrypted on the client with this cipher in
+  // CTR mode as they are uploaded, streamed uploads included, and decrypted
+  // as they are read. The initial counter and IV of an object are random and
+  // kept in its metadata, so the object has the size of its file and a
+  // ranged read decrypts only the blocks it reads. The cipher is typically
+  // AES from a library that uses the AES instructions of the CPU. Objects
+  // without the metadata are read as they are; encrypted objects can't be
+  // read without the cipher. Their integrity is checked by
+  // cloud_object_checksums and by the block checksums of the files.
+  //
+  // Default: null
+  std::shared_ptr<BlockCipher> cloud_encryption_cipher;
+
   // If false, it will not attempt to create cloud bucket if it doesn't exist.
   // Default: true
   bool create_bucket_if_missing;
@@ -302,10 +393,13 @@ class CloudFileSystemOptions {
   // listing the results of a directory Default: 5000
   int number_objects_listed_in_one_iteration;
 
-  // During opening, we get the size of all SST files currently in the
-  // folder/bucket for bookkeeping. This operation might be expensive,
-  // especially if the bucket is in the cloud. This option allows to use a
-  // constant size instead. Non-negative value means use this option.
+  // Unless the user passes an SST File Manager through
+  // Options.sst_file_manager, a DBCloud tracks its SST files with one that
+  // applies the space limits to the local copies only, and counts the files
+  // only in the cloud on the side. The sizes of the live files come from the
+  // MANIFEST at open. The sizes of the other files the DB adds are stat'ed,
+  // in the cloud if they have no local copy. This option uses a constant
+  // size for all files instead. Non-negative value means use this option.
   //
   // NOTE: If users already passes an SST File Manager through
   // Options.sst_file_manager, constant_sst_file_size_in_sst_file_manager is
@@ -387,6 +481,541 @@ class CloudFileSystemOptions {
   // Default: 1 hour
   std::optional<std::chrono::seconds> cloud_file_deletion_delay;
 
+  // If non-null and keep_local_sst_files is false, reads of cloud SST files
+  // are served from this persistent local cache of file extents before going
+  // to the storage provider. Missed reads are widened to whole extents, which
+  // are added to the cache. See NewCloudFileCache().
+  // The same cache can be shared by multiple CloudFileSystem instances.
+  //
+  // Default: null
+  std::shared_ptr<CloudFileCache> sst_file_cache;
+
+  // Number of threads serving asynchronous reads of cloud files
+  // (MultiReadAsync/ReadAsync, used by MultiGet and iterators with
+  // ReadOptions::async_io). Reads issued against different cloud files are
+  // then in flight at the same time instead of costing one round trip each.
+  // If 0, asynchronous reads are executed synchronously.
+  //
+  // Default: 0
+  int async_read_threads = 0;
+
+  // If non-zero, cloud files implement FSRandomAccessFile::Prefetch, which
+  // the block based table calls for the readahead of compactions and of
+  // sequential scans (compaction_readahead_size, auto readahead), instead of
+  // reading ahead through a FilePrefetchBuffer a block at a time. Prefetches
+  // that continue a previous one are extended, doubling their size up to
+  // cloud_readahead_size, and are fetched with up to cloud_readahead_streams
+  // ranged reads in parallel on the transfer threads.
+  //
+  // Default: 0
+  uint64_t cloud_readahead_size = 0;
+
+  // Maximum number of ranged reads a prefetch of cloud_readahead_size is
+  // split into. Each of them reads at least 1MB.
+  //
+  // Default: 4
+  int cloud_readahead_streams = 4;
+
+  // If non-zero, a cloud SST file is opened with a single ranged read of its
+  // last sst_open_tail_size bytes, which also tells its size, instead of a
+  // request for its size that the reads of its footer and meta blocks then
+  // follow. The reads within that tail, of the footer, the metaindex and
+  // properties blocks, and of the index and filter blocks if they fit, are
+  // served from memory for as long as the file is open. Best set to a bit
+  // more than the tail of most SST files, from the end of their data blocks.
+  //
+  // Default: 0
+  uint64_t sst_open_tail_size = 0;
+
+  // If non-zero, cloud reads are hedged: a ranged read (or a download) that
+  // hasn't completed after this percentile of the latencies of recent ones
+  // is sent a second time, and whichever response arrives first is used.
+  // Cuts the tail latency of point lookups due to slow cloud requests, for
+  // a few percent more requests. E.g. 95.
+  //
+  // Default: 0
+  double cloud_read_hedge_percentile = 0;
+
+  // Minimum delay before a cloud read is hedged, so that fast reads are
+  // never sent twice.
+  //
+  // Default: 5000 (5ms)
+  uint64_t cloud_read_hedge_min_delay_micros = 5000;
+
+  // If greater than 1, objects of at least 16MB are downloaded with this
+  // many ranged reads of 8MB in flight, written at their offset in the
+  // preallocated local file (with direct IO if
+  // use_direct_io_for_cloud_download), instead of with a single request.
+  // The download fails if the object changed while it was read. Used by
+  // all the downloads of whole files, unless use_aws_transfer_manager.
+  //
+  // Default: 1
+  int cloud_download_streams = 1;
+
+  // If true, the objects uploaded by PutCloudObject carry the CRC32C of their
+  // contents in their metadata (the 8 hex digits of the file_checksum that
+  // FileChecksumGenCrc32cFactory computes), and the downloads of whole
+  // objects verify it as they are written, failing with Corruption on a
+  // mismatch. Objects without the checksum are downloaded unverified.
+  // Cached SST files are then not checked with a request per file on open
+  // (validate_filesize): RocksDB checks their size against the MANIFEST.
+  // Streamed multipart uploads and downloads through the AWS transfer
+  // manager carry and verify no checksum.
+  //
+  // Default: false
+  bool cloud_object_checksums = false;
+
+  // Maximum number of connections the S3 client opens to S3. If 0, the
+  // default of the AWS SDK (25).
+  //
+  // Default: 0
+  int s3_max_connections = 0;
+
+  // Idle connections of the S3 client send TCP keep-alive probes at this
+  // interval, so that NATs and load balancers don't drop them while they
+  // wait for reuse in the connection pool. If 0, keep-alive is disabled.
+  //
+  // Default: 30000 (30s)
+  uint64_t s3_tcp_keep_alive_interval_ms = 30000;
+
+  // If true, the S3 storage providers of the process which connect with the
+  // same configuration (region, endpoint, timeouts, connections) and
+  // credentials share one S3 client: processes with many DBs then keep one
+  // pool of open connections, and do one TLS handshake and DNS lookup per
+  // connection, instead of one per DB. The retries of a shared client are
+  // neither logged nor counted in statistics. Ignored if s3_client_factory
+  // is set, which can return a shared client itself.
+  //
+  // Default: false
+  bool share_s3_client = false;
+
+  // If true, the S3 requests go through a client-side limit on the request
+  // rate to their bucket and prefix (the path of the object up to its last
+  // slash), which S3 throttles past a few thousand requests per second. The
+  // limits are shared by the storage providers of the process that enable
+  // this option. A limit only kicks in once S3 throttles a request (503
+  // SlowDown): it then halves the allowed rate, and raises it again steadily
+  // while no request is throttled. Requests over the allowed rate, retries
+  // included, are delayed instead of all retrying at once. The number and
+  // duration of the delays are counted in CLOUD_REQUEST_THROTTLE_DELAYS and
+  // CLOUD_REQUEST_THROTTLE_DELAY_MICROS, and the state of the limits is
+  // returned by CloudStorageProvider::GetRequestRateLimits(). Requests of the
+  // AWS transfer manager are not limited.
+  //
+  // Default: false
+  bool s3_adaptive_throttling = false;
+
+  // If non-zero, SST files are streamed to the cloud with a multipart upload
+  // while they are written: every time part_size bytes have been appended,
+  // the part is uploaded in the background by one of upload_threads, so
+  // closing the file only has to send the tail. Files smaller than the part
+  // size and providers without multipart support use a single upload on
+  // close, as when this is 0. S3 requires parts of at least 5MB.
+  //
+  // Default: 0
+  uint64_t multipart_upload_part_size = 0;
+
+  // Maximum number of SST uploads (multipart upload parts,
+  // async_sst_upload) running at once on the transfer_threads.
+  //
+  // Default: 4
+  int upload_threads = 4;
+
+  // If true, closing an SST file only enqueues its upload; the upload runs in
+  // the background on upload_threads threads, and the local file is deleted
+  // (unless keep_local_sst_files) once it is uploaded. Flush and compaction
+  // threads can then go on with their next job. Every MANIFEST sync first
+  // waits for the queued uploads, so the cloud MANIFEST never references an
+  // SST that is not in the cloud yet.
+  //
+  // Default: false
+  bool async_sst_upload = false;
+
+  // Maximum number of SST uploads queued or running with async_sst_upload.
+  // Closing an SST file blocks while the queue is full, throttling flushes
+  // and compactions (and, through them, writes) when the uploads can't keep
+  // up.
+  //
+  // Default: 16
+  int max_pending_sst_uploads = 16;
+
+  // If non-zero, the SST files smaller than sst_pack_threshold bytes that are
+  // written to the dest bucket are not uploaded one object each, but packed
+  // several to an object under <dest object path>/packs/. This saves the
+  // requests of their uploads, deletions and listings, which are most of
+  // the cost of the many small flushes of a DB with thousands of column
+  // families. A closed file stays local until its pack is uploaded: once
+  // sst_pack_target_size bytes wait for a pack, and before every MANIFEST
+  // upload, so that the cloud MANIFEST never references a file that is not
+  // in the cloud. Coalescing the MANIFEST uploads with
+  // manifest_upload_interval_millis packs the files of several flushes
+  // together. A packed file is read with ranged reads of its pack. The
+  // indexes of the packs of the src and dest paths are read on open, a few
+  // requests per pack, and a pack is deleted once all of its files are; the
+  // purger leaves packs alone. A DB that packed files must keep the option
+  // set for them to be found.
+  //
+  // Default: 0
+  uint64_t sst_pack_threshold = 0;
+
+  // Size from which the files waiting with sst_pack_threshold are packed
+  // without waiting for the next MANIFEST upload.
+  //
+  // Default: 8MB
+  uint64_t sst_pack_target_size = 8 << 20;
+
+  // If non-zero, Kinesis log files buffer appended data instead of sending a
+  // record per append, and send the buffered records with PutRecords once
+  // cloud_log_batch_size bytes are buffered, cloud_log_batch_delay_micros
+  // after the oldest buffered append, or on Sync. Appends are coalesced into
+  // records of up to 1000KB, so a batch costs a round trip per few MB rather
+  // than per write. Data that was appended but not synced is lost if the
+  // process crashes.
+  //
+  // Default: 0 (a PutRecord per append)
+  uint64_t cloud_log_batch_size = 0;
+
+  // Maximum time an append stays buffered with cloud_log_batch_size. Checked
+  // on the next append or flush of the file.
+  //
+  // Default: 1000
+  uint64_t cloud_log_batch_delay_micros = 1000;
+
+  // Number of threads the Kinesis and Kafka tailers apply a batch of records
+  // read from the stream on. The records of a file are always applied in
+  // order, by one thread; more threads apply the records of different files
+  // in parallel.
+  //
+  // Default: 1
+  int cloud_log_apply_threads = 1;
+
+  // Maximum number of local copies of log files that the tailers keep open
+  // between batches of records. The least recently appended ones are closed
+  // beyond it, and opened again by their next record. If 0, the copies stay
+  // open until the log closes or deletes them.
+  //
+  // Default: 0
+  int cloud_log_max_open_files = 0;
+
+  // If positive, the tailers preallocate the local copies of log files in
+  // extents of this many bytes ahead of the appends, with fallocate where
+  // the local file system supports it, so that the file system allocates
+  // their blocks at once rather than on every append. The unused part of
+  // the last extent stays allocated until the file is deleted.
+  //
+  // Default: 0
+  uint64_t cloud_log_preallocation_size = 0;
+
+  // Number of shards of the Kinesis stream created for the log. All the
+  // records of a log file go to the shard that its name hashes to, so the
+  // records of a file keep their order, and each shard is tailed by a thread
+  // of its own. Kinesis caps writes at 1MB/s per shard, so more shards raise
+  // the write throughput of the log. An existing stream keeps its shards.
+  //
+  // Default: 1
+  int cloud_log_stream_shards = 1;
+
+  // If not empty, the Kinesis tailers register an enhanced fan-out consumer
+  // of this name on the stream, or reuse the one already registered, and
+  // have the records pushed to them with SubscribeToShard as soon as they are
+  // written, instead of polling every shard with GetRecords. Each reader of
+  // the stream needs a name of its own. Enhanced fan-out is billed by AWS
+  // per consumer and shard.
+  //
+  // Default: empty (polling)
+  std::string cloud_log_consumer_name;
+
+  // If non-null, the Kinesis and Kafka tailers of the log poll the
+  // partitions of the stream on the threads of this tailer instead of
+  // starting threads of their own. The same tailer is meant to be shared by
+  // all the CloudFileSystem instances of a process. The Kinesis tailers of
+  // a cloud_log_consumer_name, which have the records pushed to them, keep
+  // their own threads. See NewCloudLogTailer().
+  //
+  // Default: null
+  std::shared_ptr<CloudLogTailer> cloud_log_tailer;
+
+  // If positive and keep_local_sst_files is true, DBCloud::Open downloads
+  // the live SST files that are missing locally (e.g. in a new clone) with
+  // this many transfer_threads before opening the DB, lower levels and
+  // smaller files first. Otherwise the files are downloaded one at a time, when the DB
+  // first opens them.
+  //
+  // Default: 0
+  int sst_download_threads = 0;
+
+  // If true, the download of sst_download_threads runs in the background and
+  // DBCloud::Open doesn't wait for it. Until a file is downloaded, it is read
+  // straight from the cloud; its readers switch to the local copy once it
+  // lands. New replicas then serve reads as soon as their MANIFEST is in
+  // place.
+  //
+  // Default: false
+  bool hydrate_in_background = false;
+
+  // Number of threads shared by the background transfers of the file
+  // system: SST uploads, SST downloads of sst_download_threads, table
+  // prefetches, CheckpointToCloud, delayed deletions of cloud files and the
+  // purger. Each kind of transfer is bounded by its own limit
+  // (upload_threads, sst_download_threads, table_prefetch_threads,
+  // max_checkpoint_transfers, purger_threads). When all threads are busy,
+  // queued uploads start first, then downloads, prefetches, checkpoints,
+  // deletions and the purger.
+  //
+  // Default: 16
+  int transfer_threads = 16;
+
+  // Maximum number of files CheckpointToCloud transfers at once, whatever
+  // its thread_count, so that checkpoints leave transfer_threads to the
+  // uploads and downloads of the DB.
+  //
+  // Default: 4
+  int max_checkpoint_transfers = 4;
+
+  // Maximum number of DBs the purger reads the MANIFEST of, or lists the
+  // objects of, at once. Runs on the transfer_threads, after every other
+  // transfer.
+  //
+  // Default: 4
+  int purger_threads = 4;
+
+  // If set, cloud uploads and downloads of whole objects are charged to this
+  // rate limiter, whatever its mode: SST uploads at Env::IO_HIGH, downloads
+  // of sst_download_threads at IO_MID, checkpoints at IO_LOW, and the
+  // transfers the DB waits for (e.g. fetching an SST file it opens, MANIFEST
+  // uploads) at IO_USER. The SST files the DB writes are charged at the
+  // priority it writes them at instead: flush outputs at IO_HIGH and
+  // compaction outputs at IO_LOW, either at IO_USER while writes stall, so
+  // a compaction that uploads its outputs is held back by both its local
+  // writes and its share of the network. The rate limiter serves the higher
+  // priorities first, so neither a checkpoint nor a burst of compactions can
+  // hold back foreground fetches. Reads of cloud files that are not
+  // downloaded are not charged.
+  //
+  // Default: null
+  std::shared_ptr<RateLimiter> transfer_rate_limiter;
+
+  // If positive, the existence, size and modification time of SST files in
+  // the cloud and the listings of the cloud directories are cached for this
+  // long, sparing FileExists, GetFileSize and GetChildren a HEAD or LIST
+  // request per call. The objects written or deleted through this file
+  // system are invalidated right away; changes made by other writers are
+  // seen once their entries expire.
+  //
+  // Default: 0 (disabled)
+  uint64_t cloud_metadata_cache_ttl_micros = 0;
+
+  // Maximum number of objects (and of directory listings) in the cache of
+  // cloud_metadata_cache_ttl_micros.
+  //
+  // Default: 100000
+  size_t cloud_metadata_cache_capacity = 100000;
+
+  // If true, GetChildren of the local DB directory doesn't list the cloud:
+  // the SST files it returns besides the local ones are the live files of
+  // the MANIFEST when the cloud manifest was loaded, plus the files created
+  // through this file system since, minus the ones it deleted. Unlike
+  // skip_cloud_files_in_getchildren, RocksDB still sees all the files it
+  // tracks, so its obsolete-file cleanup keeps working. Files the cloud has
+  // but the DB doesn't know about (e.g. left behind by a crash) are only
+  // found by the purger. Other directories are still listed.
+  //
+  // Default: false
+  bool getchildren_from_manifest = false;
+
+  // If true, rolling a new epoch on open also drops the past epochs of
+  // CLOUDMANIFEST that don't contain any live file of the MANIFEST, except
+  // the most recent one. Remapping live files is unaffected, and the
+  // CLOUDMANIFEST of a database that restarts often stays small. Obsolete
+  // files of a dropped epoch are left to the purger.
+  //
+  // Default: false
+  bool prune_cloud_manifest_epochs = false;
+
+  // Format of the CLOUDMANIFEST files written. 1 stores a log record per
+  // epoch; 2 stores all epochs in one record with delta-encoded file
+  // numbers. Both are readable, but versions before 2 was introduced can't
+  // read it.
+  //
+  // Default: 1
+  int cloud_manifest_format_version = 1;
+
+  // If positive, the syncs of the MANIFEST within this interval of its last
+  // upload are coalesced: the MANIFEST is uploaded once the interval is
+  // over, rather than on every Sync. A new MANIFEST file is still uploaded
+  // on its first sync, and a closed one right away. SST files are not
+  // deleted from the dest bucket until the MANIFEST that no longer
+  // references them is uploaded.
+  //
+  // The MANIFEST in the cloud, and the followers that read it, then lag by
+  // up to this interval, so the DB must not rely on it for durability, e.g.
+  // because a replication log (see ReplicationLogListener) provides it. A
+  // failed deferred upload is returned by the next sync.
+  //
+  // Default: 0 (every sync uploads the MANIFEST)
+  uint64_t manifest_upload_interval_millis = 0;
+
+  // If positive, a DBCloud with a dest bucket saves its hot block keys, the
+  // first key of each data block in its block cache, to the dest bucket
+  // every this many seconds. The keys take a small fraction of the space of
+  // the blocks. See block_cache_warmup_threads.
+  //
+  // Default: 0
+  uint64_t hot_block_keys_interval_secs = 0;
+
+  // If positive, DBCloud::Open reads the hot block keys saved in the src
+  // bucket (see hot_block_keys_interval_secs) with this many threads, which
+  // loads the blocks that were hot in the DB that saved them, possibly on
+  // another host, into the block cache. A new leader then doesn't start
+  // with a cold cache after a failover. The warm-up is best effort: its
+  // errors are only logged.
+  //
+  // Default: 0
+  int block_cache_warmup_threads = 0;
+
+  // If true, the warm-up of block_cache_warmup_threads runs in the
+  // background and DBCloud::Open doesn't wait for it.
+  //
+  // Default: false
+  bool block_cache_warmup_in_background = false;
+
+  // If positive, a DBCloud verifies its live SST files every this many
+  // seconds, in the background: the local copies first, then the objects in
+  // the dest bucket, against the file checksums in the MANIFEST if
+  // file_checksum_gen_factory is set, else against their block checksums. A
+  // corrupted local copy is downloaded again, and a corrupted object is
+  // uploaded again from a sound local copy. See DBCloud::GetScrubStats.
+  //
+  // Default: 0
+  uint64_t scrub_interval_secs = 0;
+
+  // The bytes per second the verification of scrub_interval_secs reads at
+  // most, so that it doesn't take the I/O of the foreground reads. 0 for no
+  // limit.
+  //
+  // Default: 8MB
+  uint64_t scrub_bytes_per_sec = 8 << 20;
+
+  // If positive, a DBCloud opens the tables of its live SST files in the
+  // background after DBCloud::Open, and those of the outputs of its flushes
+  // and compactions, with at most this many running at once on the
+  // transfer_threads. Opening a table loads the partitions of its index and
+  // filter into the block cache, read with one ranged read each, so the
+  // first lookups in a file don't each wait for a remote read of its
+  // metadata. Only useful with a block cache and partitioned indexes or
+  // filters (see BlockBasedTableOptions::partition_filters). Best effort:
+  // errors are only logged.
+  //
+  // Default: 0
+  int table_prefetch_threads = 0;
+
+  // If positive, the prefetch of table_prefetch_threads stops after this
+  // many bytes of metadata for the files of an open, and for each flush or
+  // compaction. A file is charged the size of its tail, the part of the file
+  // after its data blocks, or its whole size if that is not known. The
+  // files of the lower levels are prefetched first.
+  //
+  // Default: 0 (unlimited)
+  uint64_t table_prefetch_max_bytes = 0;
+
+  // If true, blob files (see ColumnFamilyOptions::enable_blob_files) are
+  // stored in the cloud like SST files: their names carry the epoch of
+  // their file number, they are uploaded when closed, and they follow
+  // keep_local_sst_files, cloud_only_sst_temperatures and
+  // local_sst_retention_bytes. A blob file that is only in the cloud is read
+  // with ranged reads of the blobs it is asked for, so large values don't
+  // take local space. Use a blob_cache to keep the hot ones in memory.
+  // If false, blob files are local files that are not uploaded.
+  // It should not be changed for an existing DB with blob files, since the
+  // names of its blob files change with it.
+  //
+  // Default: false
+  bool cloud_blob_files = false;
+
+  // If true, the objects of the cloud data files (SST files, and blob files
+  // with cloud_blob_files) are named <object path>/<shard>/<file name>,
+  // where the shard is two hex digits of a hash of the file name. S3 scales
+  // the request rate it allows by key prefix, so the requests of a busy DB
+  // are spread over 256 prefixes instead of one. The other objects of the DB
+  // (CLOUDMANIFEST, MANIFEST, IDENTITY) stay at the top of its object path.
+  // The layout applies to both the src and the dest bucket: the DBs cloned
+  // from one another, the checkpoints they make with CheckpointToCloud() and
+  // their compaction workers must all use the same value. It should not be
+  // changed for an existing DB, whose data files would not be found anymore.
+  //
+  // Default: false
+  bool shard_data_object_names = false;
+
+  // If not empty, the name of a second bucket for the SST files written with
+  // one of low_latency_sst_temperatures, in the region of the dest bucket:
+  // a bucket with a lower request latency, such as an S3 Express One Zone
+  // directory bucket. With default_write_temperature=kHot,
+  // last_level_temperature=kWarm and kHot here, for example, the young SST
+  // files of the upper levels are read from the low-latency bucket, and
+  // compaction rewrites their data into the dest bucket as it reaches the
+  // last level. The objects have the same names as in the dest bucket, under
+  // the object path of the DB. The CLOUDMANIFEST, MANIFEST and IDENTITY
+  // files stay in the dest bucket, which holds everything needed to recover
+  // the DB but the files of the low-latency bucket.
+  // A file is looked up in the low-latency bucket first if RocksDB opens it
+  // with one of low_latency_sst_temperatures, else after the src and dest
+  // buckets, so that the clones and the compaction workers of the DB find its
+  // files as long as they are given the same bucket. The bucket must exist.
+  //
+  // Default: empty
+  std::string low_latency_bucket;
+
+  // The temperatures of the SST files written to low_latency_bucket, see
+  // there
+  //
+  // Default: empty
+  std::vector<Temperature> low_latency_sst_temperatures;
+
+  // Returns whether an SST file of the given temperature is written to the
+  // low-latency bucket
+  bool UseLowLatencyBucket(Temperature temperature) const;
+
+  // The number of concurrent requests with which the S3 provider lists a
+  // path of many objects, such as the DB directory purged or checked for
+  // invisible files. When more than 1 and the first page of the path is
+  // truncated, the rest of the path is split by key range and by
+  // sub-directory, e.g. the shards of shard_data_object_names, and the parts
+  // are listed in parallel, number_objects_listed_in_one_iteration at a time.
+  //
+  // Default: 1
+  int list_objects_parallelism = 1;
+
+  // If true, a DB opened with a src bucket or path other than its dest is a
+  // copy-on-write clone of its src: its first open writes a CLOUDPARENT
+  // object naming the src into the dest path, and every open follows the
+  // CLOUDPARENT objects from the dest up, looking the data files up in these
+  // ancestors after the src and dest buckets. The clone can then be reopened
+  // with its dest as src, and be cloned in turn. Its writes go to its dest,
+  // and the files of its ancestors are neither copied nor deleted by it;
+  // Savepoint() copies them to the dest. With keep_local_sst_files=false,
+  // they are read in place through the cloud random access path, so that
+  // creating a clone of a DB of any size transfers its CLOUDMANIFEST,
+  // MANIFEST and IDENTITY only.
+  // The ancestors must keep the files their clones use: the purger keeps
+  // the files of the clones registered in the same bucket, but a DB still
+  // open deletes its obsolete files after cloud_file_deletion_delay, so clone
+  // a checkpoint or a DB that no longer changes. The clones should use the
+  // same shard_data_object_names as their ancestors.
+  //
+  // Default: false
+  bool copy_on_write_clones = false;
+
+  // If not empty, the requests sent to the storage provider by this file
+  // system are traced to this local file: the reads of the cloud files, the
+  // downloads and uploads of whole objects and the metadata requests of
+  // opening the cloud files. The trace records the object, the range, the
+  // bytes, the latency and the result of each request, and can be replayed
+  // with the cloud_trace_analyzer tool to estimate the requests that a file
+  // cache, readahead or a metadata cache would save.
+  //
+  // Default: "" (disabled)
+  std::string request_trace_file;
+
   // Type info map for this class.
   static const std::unordered_map<std::string, OptionTypeInfo>
       cloud_fs_option_type_info;
@@ -460,6 +1089,23 @@ class CloudFileSystemOptions {
 struct CheckpointToCloudOptions {
   int thread_count = 8;
   bool flush_memtable = false;
+  // If true, SST files that the destination already holds with the same
+  // name and size are not uploaded again. SST files are never rewritten, so
+  // repeated checkpoints to the same destination only send the new files.
+  bool incremental = false;
+  // If true and the DB's dest_bucket is in the destination's region, SST
+  // files are copied from dest_bucket with CopyCloudObject instead of being
+  // uploaded from the local directory.
+  bool server_side_copy = true;
+};
+
+struct CheckpointToLocalOptions {
+  // Maximum number of WAL, MANIFEST and other files copied at once
+  int thread_count = 8;
+  // If the live WAL files are at least this many bytes, the memtables are
+  // flushed first, like Checkpoint::CreateCheckpoint's log_size_for_flush.
+  // By default the WAL files are copied and nothing is flushed.
+  uint64_t log_size_for_flush = std::numeric_limits<uint64_t>::max();
 };
 
 // A map of dbid to the pathname where the db is stored
@@ -481,6 +1127,19 @@ class CloudFileSystem : public FileSystem {
   static const char* kCloud() { return "cloud"; }
   static const char* kAws() { return "aws"; }
 
+  // Returns the path of the object object_path of bucket_name (the full
+  // bucket name, see BucketOptions::GetBucketName()) as an external file, for
+  // DB::IngestExternalFile() of SST files that are already in the cloud, e.g.
+  // produced offline. Their properties and keys are read with ranged reads of
+  // the object, without downloading it. With
+  // IngestExternalFileOptions::move_files, each object is copied into the
+  // dest bucket in the cloud (CopyCloudObject), so it has to be in the region
+  // of the dest bucket, and it is deleted once the ingestion succeeds, like
+  // the original link of a moved file. Without move_files, the object is
+  // downloaded and uploaded like any external file.
+  static std::string CloudObjectFilePath(const std::string& bucket_name,
+                                         const std::string& object_path);
+
   // Returns the underlying file system
   virtual const std::shared_ptr<FileSystem>& GetBaseFileSystem() const = 0;
 
@@ -509,9 +1168,40 @@ class CloudFileSystem : public FileSystem {
 
   // Deletes file from a destination bucket.
   virtual IOStatus DeleteCloudFileFromDest(const std::string& fname) = 0;
-  // Copies a local file to a destination bucket.
+  // Copies a local file to a destination bucket, in the given storage class
+  // of the provider if not empty.
   virtual IOStatus CopyLocalFileToDest(const std::string& local_name,
-                                       const std::string& cloud_name) = 0;
+                                       const std::string& cloud_name,
+                                       const std::string& storage_class) = 0;
+  IOStatus CopyLocalFileToDest(const std::string& local_name,
+                               const std::string& cloud_name) {
+    return CopyLocalFileToDest(local_name, cloud_name, "");
+  }
+  // The MANIFEST local_name was synced: uploads it to cloud_name in the
+  // destination bucket once the SST files it references are uploaded, right
+  // away if force, or else as manifest_upload_interval_millis allows.
+  virtual IOStatus SyncManifestToDest(const std::string& local_name,
+                                      const std::string& cloud_name,
+                                      bool force) = 0;
+  // Uploads the MANIFEST deferred by SyncManifestToDest, if any.
+  virtual IOStatus FlushManifestUpload() = 0;
+
+  // Runs upload, which makes local_name durable in the cloud. With
+  // async_sst_upload, upload is queued and runs in the background.
+  virtual IOStatus ScheduleUpload(const std::string& local_name,
+                                  std::function<IOStatus()> upload) = 0;
+  // Waits for the uploads queued by ScheduleUpload. Returns the first error
+  // since the previous call.
+  virtual IOStatus WaitForPendingUploads() = 0;
+  // The cloud-only SST file local_name was uploaded, its local copy is no
+  // longer needed: deletes it, or keeps it in the pool of
+  // local_sst_retention_bytes.
+  virtual IOStatus ReleaseLocalSstFile(const std::string& local_name) = 0;
+  // With sst_pack_threshold, adds the closed SST file local_name of the dest
+  // bucket to the next pack instead of uploading it on its own. Sets *packed
+  // to false if the file is not to be packed, the caller uploads it then.
+  virtual IOStatus PackSstFile(const std::string& local_name, bool keep_local,
+                               bool* packed) = 0;
 
   // Returns CloudManifest file name for a given db.
   virtual std::string CloudManifestFile(const std::string& dbname) = 0;
@@ -534,6 +1224,10 @@ class CloudFileSystem : public FileSystem {
                                           const std::string& local_name,
                                           bool read_only) = 0;
 
+  // Downloads the live SST files missing from the local directory, see
+  // sst_download_threads. REQUIRES: the cloud manifest is loaded.
+  virtual IOStatus HydrateLocalDirectory(const std::string& local_name) = 0;
+
   // Transfers the filename from RocksDB's domain to the physical domain, based
   // on information stored in CLOUDMANIFEST.
   // For example, it will map 00010.sst to 00010.sst-[epoch] where [epoch] is
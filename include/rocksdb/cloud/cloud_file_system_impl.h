@@ -2,10 +2,12 @@
 
 #pragma once
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <unordered_set>
 
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/file_system.h"
@@ -14,10 +16,20 @@
 
 namespace ROCKSDB_NAMESPACE {
 class CloudManifest;
+struct CloudManifestReadState;
 class CloudScheduler;
 class CloudStorageReadableFile;
 class ObjectLibrary;
 class CloudFileDeletionScheduler;
+class CloudUploadQueue;
+class CloudFileHydrator;
+class CloudTransferExecutor;
+class CloudMetadataCache;
+class CloudSstRetention;
+class CloudSstPacker;
+class CloudSstFileManager;
+struct CloudObjectInformation;
+struct CloudPackedFile;
 
 //
 // The Cloud file system
@@ -144,6 +156,11 @@ class CloudFileSystemImpl : public CloudFileSystem {
   IOStatus SanitizeLocalDirectory(const DBOptions& options,
                                   const std::string& local_name,
                                   bool read_only) override;
+  IOStatus HydrateLocalDirectory(const std::string& local_name) override;
+#ifndef NDEBUG
+  // Waits for the background downloads of hydrate_in_background
+  void TEST_WaitForHydration();
+#endif
   IOStatus LoadCloudManifest(const std::string& local_dbname,
                              bool read_only) override;
   // The separator used to separate dbids while creating the dbid of a clone
@@ -194,6 +211,12 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // Files both in S3 and in the local directory have this [epoch] suffix.
   std::string RemapFilename(const std::string& logical_path) const override;
 
+  // The name of the object of a (remapped) file, relative to the object path
+  // of a bucket: its basename, in its shard directory if it is a data file
+  // and shard_data_object_names is set, or in the packs directory if it is a
+  // pack of sst_pack_threshold
+  std::string ObjectName(const std::string& fname) const;
+
   FileOptions OptimizeForLogRead(
       const FileOptions& file_options) const override {
     return base_fs_->OptimizeForLogRead(file_options);
@@ -238,11 +261,44 @@ class CloudFileSystemImpl : public CloudFileSystem {
         "CloudFileSystemImpl::IsDirectory() not supported.");
   }
 
+  // Completes the asynchronous reads of cloud files, and forwards the other
+  // handles to the base file system.
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override;
+  IOStatus AbortIO(std::vector<void*>& io_handles) override;
+
   CloudManifest* GetCloudManifest() override { return cloud_manifest_.get(); }
 
   IOStatus DeleteCloudFileFromDest(const std::string& fname) override;
+  using CloudFileSystem::CopyLocalFileToDest;
   IOStatus CopyLocalFileToDest(const std::string& local_name,
-                               const std::string& cloud_name) override;
+                               const std::string& cloud_name,
+                               const std::string& storage_class) override;
+  IOStatus SyncManifestToDest(const std::string& local_name,
+                              const std::string& cloud_name,
+                              bool force) override;
+  IOStatus FlushManifestUpload() override;
+  IOStatus ScheduleUpload(const std::string& local_name,
+                          std::function<IOStatus()> upload) override;
+  IOStatus WaitForPendingUploads() override;
+  IOStatus ReleaseLocalSstFile(const std::string& local_name) override;
+  IOStatus PackSstFile(const std::string& local_name, bool keep_local,
+                       bool* packed) override;
+
+  // Runs the background transfers of this file system
+  const std::shared_ptr<CloudTransferExecutor>& GetTransferExecutor() const {
+    return transfer_executor_;
+  }
+
+  // Reports the local copies of SST files that this file system downloads
+  // and evicts to sst_file_manager, which may be null
+  void SetSstFileManager(
+      const std::shared_ptr<CloudSstFileManager>& sst_file_manager);
+
+  // The object was written to or deleted from bucket: forgets its cached
+  // metadata, if any
+  void InvalidateCloudObjectMetadata(const std::string& bucket,
+                                     const std::string& object_path);
 
   Status PrepareOptions(const ConfigOptions& config_options) override;
   Status ValidateOptions(const DBOptions& /*db_opts*/,
@@ -272,6 +328,19 @@ class CloudFileSystemImpl : public CloudFileSystem {
   IOStatus UploadCloudManifest(const std::string& local_dbname,
                                const std::string& cookie) const override;
 
+  // For a follower of the database that a leader writes to the source
+  // bucket: applies the epochs the leader added to its CLOUDMANIFEST, and
+  // brings the local MANIFEST up to date with the cloud. New MANIFEST records
+  // are appended to the local file in place, so that a secondary instance
+  // tailing it picks them up. If the leader started a new MANIFEST, it is
+  // downloaded whole and CURRENT is pointed to a new name, so that the
+  // secondary switches to it. Returns Aborted if the epochs of the leader
+  // no longer extend ours (e.g. they were pruned); the follower then has to
+  // be reopened.
+  //
+  // REQUIRES: Src bucket set, CLOUDMANIFEST loaded
+  IOStatus RefreshFollowerManifest(const std::string& local_dbname);
+
   // Delete invisible files in cloud.
   //
   // REQUIRES: Dest bucket set
@@ -316,6 +385,10 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // Returns the list of cloud objects from the src and dest buckets.
   IOStatus ListCloudObjects(const std::string& path,
                             std::vector<std::string>* result);
+  // Appends the cloud objects under object_path in bucket to result
+  IOStatus ListCloudObjects(const std::string& bucket,
+                            const std::string& object_path,
+                            std::vector<std::string>* result);
 
   // Returns a CloudStorageReadableFile from the dest or src bucket
   IOStatus NewCloudReadableFile(
@@ -326,6 +399,18 @@ class CloudFileSystemImpl : public CloudFileSystem {
   IOStatus SaveIdentityToCloud(const std::string& localfile,
                                const std::string& idfile);
 
+  // Moves the output file of a remote compaction, which a worker put in the
+  // dest bucket, to the SST file fname of the DB (see
+  // CloudCompactionService)
+  IOStatus InstallRemoteCompactionOutput(const std::string& logical_src,
+                                         const std::string& fname);
+
+  // Copies the object object_path of bucket to the SST file target of the DB
+  // in the cloud (see CloudFileSystem::CloudObjectFilePath())
+  IOStatus LinkCloudObject(const std::string& bucket,
+                           const std::string& object_path,
+                           const std::string& logical_target);
+
   // Check if options are compatible with the storage system
   virtual Status CheckOption(const FileOptions& file_opts);
 
@@ -348,6 +433,19 @@ class CloudFileSystemImpl : public CloudFileSystem {
 
   IOStatus FetchCloudManifest(const std::string& local_dbname);
 
+  // For copy_on_write_clones: writes the CLOUDPARENT of a new clone, naming
+  // its src, and reads the chain of CLOUDPARENTs into clone_ancestors_
+  IOStatus WriteCloudParent(const std::string& local_dbname);
+  IOStatus LoadCloneAncestors();
+  // For sst_pack_threshold: indexes the packs of the src and dest paths that
+  // are not indexed yet
+  IOStatus LoadSstPacks();
+  // The parent of the DB at object_path in bucket, NotFound if none
+  IOStatus ReadCloudParent(const std::string& bucket,
+                           const std::string& object_path,
+                           std::string* parent_bucket,
+                           std::string* parent_path);
+
   IOStatus RollNewEpoch(const std::string& local_dbname);
 
   // The dbid of the source database that is cloned
@@ -368,6 +466,32 @@ class CloudFileSystemImpl : public CloudFileSystem {
   void Purger();
   void StopPurger();
 
+  // The live files of the MANIFEST of a DB, as last read by
+  // FindObsoleteFiles
+  struct PurgerManifest {
+    std::string manifest_file;
+    uint64_t size = 0;
+    uint64_t modification_time = 0;
+    std::vector<uint64_t> live_files;
+    // Where the MANIFEST was read up to
+    std::shared_ptr<CloudManifestReadState> read_state;
+  };
+  // Sets *live_files to the live files of the current MANIFEST of the DB
+  // at db_path, reading the MANIFEST only if it changed since the last call
+  // for dbid, and only its new records if it was appended to
+  IOStatus GetPurgerLiveFiles(const std::string& bucket_name_prefix,
+                              const std::string& dbid,
+                              const std::string& db_path,
+                              std::vector<uint64_t>* live_files);
+  // Keyed by dbid. Protected by purger_manifests_mutex_
+  std::mutex purger_manifests_mutex_;
+  std::unordered_map<std::string, PurgerManifest> purger_manifests_;
+  // The db path and the parent dbids of each dbid, as last read from its
+  // IDENTITY by extractParents. Protected by purger_manifests_mutex_
+  std::unordered_map<std::string,
+                     std::pair<std::string, std::vector<std::string>>>
+      purger_parents_;
+
   // Delete all local files that are invisible
   IOStatus DeleteLocalInvisibleFiles(
       const std::string& dbname,
@@ -417,6 +541,21 @@ class CloudFileSystemImpl : public CloudFileSystem {
     info_log_ = std::move(l);
   }
 
+  // The (bucket, object path) of the ancestors of a copy-on-write clone
+  // other than its src, from its parent up. Set when the DB is opened.
+  const std::vector<std::pair<std::string, std::string>>& GetCloneAncestors()
+      const {
+    return clone_ancestors_;
+  }
+
+  // Returns true and sets *packed if the data file fname is in one of the
+  // packs of sst_pack_threshold
+  bool LookupPackedFile(const std::string& fname, CloudPackedFile* packed);
+  // Makes the packed file at the local path fname an object of the dest
+  // bucket, unless its pack is in the dest already. NotFound if the file is
+  // not packed.
+  IOStatus CopyPackedFileToDest(const std::string& fname);
+
  private:
   // Files are invisibile if:
   // - It's CLOUDMANFIEST file and cookie is not active. NOTE: empty cookie is
@@ -428,6 +567,11 @@ class CloudFileSystemImpl : public CloudFileSystem {
   bool IsFileInvisible(const std::vector<std::string>& active_cookies,
                        const std::string& fname) const;
 
+  // Whether fname, with or without epoch, is stored in the cloud the way SST
+  // files are, which blob files also are with
+  // CloudFileSystemOptions::cloud_blob_files
+  bool IsCloudDataFile(const std::string& fname) const;
+
   void log(InfoLogLevel level, const std::string& fname,
            const std::string& msg);
 
@@ -435,6 +579,66 @@ class CloudFileSystemImpl : public CloudFileSystem {
   void RemapFileNumbers(const std::set<uint64_t>& file_numbers,
                         std::vector<std::string>* sst_file_names);
 
+  // Local paths of the live SST files of local_dbname that are not present
+  // locally, in the order they should be downloaded: lower levels first,
+  // then smaller files first. If retained_paths is not null, appends to it
+  // the local paths of the live cloud-only SST files that are present
+  // locally, in the same order.
+  IOStatus FindLiveFilesToHydrate(
+      const std::string& local_dbname, std::vector<std::string>* local_paths,
+      std::vector<std::string>* retained_paths = nullptr);
+
+  // Adds the local copy of the cloud-only SST file fname to sst_retention_,
+  // and deletes the local copies it evicts
+  IOStatus RetainLocalSstFile(const std::string& fname);
+
+  // Tells sst_file_manager_ that the local copy of fname was added or removed
+  void OnLocalSstCopyChanged(const std::string& fname, bool added);
+
+  // Uploads the files waiting for a pack of sst_pack_threshold as one pack,
+  // and releases their local copies
+  IOStatus UploadSstPack();
+  // Downloads the packed file to local_path
+  IOStatus GetPackedFile(const CloudPackedFile& packed,
+                         const std::string& local_path);
+
+  // The buckets and object paths where the cloud object of fname can be, in
+  // lookup order: the dest then the src bucket, and low_latency_bucket for
+  // a data file, first if temperature is one of low_latency_sst_temperatures,
+  // then the clone ancestors for a data file
+  std::vector<std::pair<std::string, std::string>> CloudObjectLocations(
+      const std::string& fname,
+      Temperature temperature = Temperature::kUnknown);
+
+  // Gets the metadata of the cloud object fname from the dest or src bucket,
+  // from metadata_cache_ if it is an SST file
+  IOStatus StatCloudObject(const std::string& fname,
+                           CloudObjectInformation* info);
+  IOStatus StatCloudObject(const std::string& bucket,
+                           const std::string& object_path,
+                           CloudObjectInformation* info);
+
+  // With getchildren_from_manifest, makes the live SST files of the MANIFEST
+  // of local_dbname the cloud children of the directory, or none for a new
+  // DB. On failure, GetChildren keeps listing the cloud.
+  void LoadManifestChildren(const std::string& local_dbname, bool new_db);
+  // Returns true and appends the cloud children of dir to result if they are
+  // known without listing the cloud
+  bool GetManifestChildren(const std::string& dir,
+                           std::vector<std::string>* result);
+  // The SST file fname was created or deleted
+  void UpdateManifestChildren(const std::string& fname, bool created);
+
+  // Deletes the files from the dest bucket, in as few requests as possible,
+  // or schedules their deletion with cloud_file_deletion_delay
+  IOStatus DeleteCloudFilesFromDest(const std::vector<std::string>& fnames);
+
+  // Uploads the MANIFEST of manifest_upload_. REQUIRES: its mutex is held
+  IOStatus UploadDeferredManifest();
+  // Schedules the upload of the MANIFEST of manifest_upload_ in delay.
+  // REQUIRES: its mutex is held
+  void ScheduleManifestUpload(std::chrono::microseconds delay);
+
   // Fetch the cloud manifest based on the cookie
   IOStatus FetchCloudManifest(const std::string& local_dbname,
                               const std::string& cookie);
@@ -452,6 +656,44 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // scratch space in local dir
   static constexpr const char* SCRATCH_LOCAL_DIR = "/tmp";
   std::shared_ptr<CloudFileDeletionScheduler> cloud_file_deletion_scheduler_;
+  std::shared_ptr<CloudTransferExecutor> transfer_executor_;
+  // The MANIFEST synced but not uploaded yet, null unless
+  // manifest_upload_interval_millis is set. Shared with the scheduled
+  // upload, which may outlive this file system.
+  struct DeferredManifestUpload;
+  std::shared_ptr<DeferredManifestUpload> manifest_upload_;
+  std::shared_ptr<CloudScheduler> manifest_upload_scheduler_;
+  // Background uploads of SST files, null unless async_sst_upload
+  std::unique_ptr<CloudUploadQueue> upload_queue_;
+  // Background downloads of SST files, created by HydrateLocalDirectory with
+  // hydrate_in_background
+  std::unique_ptr<CloudFileHydrator> hydrator_;
+  // Metadata of SST files and listings of cloud directories, null unless
+  // cloud_metadata_cache_ttl_micros is set
+  std::shared_ptr<CloudMetadataCache> metadata_cache_;
+  // See GetCloneAncestors()
+  std::vector<std::pair<std::string, std::string>> clone_ancestors_;
+  // Local copies of cloud-only SST files, null unless
+  // local_sst_retention_bytes is set
+  std::unique_ptr<CloudSstRetention> sst_retention_;
+  // Background downloads of the cloud-only SST files read from the cloud
+  // into sst_retention_, null unless local_sst_retention_bytes is set
+  std::unique_ptr<CloudFileHydrator> retention_hydrator_;
+  // Small SST files packed several to an object, null unless
+  // sst_pack_threshold is set. Held while a pack is uploaded, so that the
+  // files being packed are not deleted meanwhile.
+  std::unique_ptr<CloudSstPacker> sst_packer_;
+  std::mutex sst_pack_mutex_;
+
+  // See SetSstFileManager(), not owned: the DB outlives its use
+  std::mutex sst_file_manager_mutex_;
+  std::weak_ptr<CloudSstFileManager> sst_file_manager_;
+
+  // Cloud children of manifest_children_dir_, with their epochs, for
+  // getchildren_from_manifest. The directory is empty until they are known.
+  std::mutex manifest_children_mutex_;
+  std::string manifest_children_dir_;
+  std::unordered_set<std::string> manifest_children_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -88,6 +88,10 @@ class CloudLogController : public Configurable {
   virtual IOStatus FileExists(const std::string& fname) = 0;
   virtual IOStatus GetFileSize(const std::string& logical_fname,
                                uint64_t* size) = 0;
+
+  // Bytes written to the stream whose delivery has not been acknowledged
+  // yet, if the controller tracks them.
+  virtual uint64_t GetInFlightBytes() const { return 0; }
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,38 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+//
+#pragma once
+
+#include <memory>
+
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A pool of threads that tails the Kinesis and Kafka log streams of many
+// CloudFileSystems, each polling one partition of a stream at a time,
+// instead of the threads of their own that every log controller starts.
+// Meant for processes with many DBs, see
+// CloudFileSystemOptions::cloud_log_tailer.
+//
+// The records of a partition are still read and applied in order, by one
+// thread at a time. A partition that had nothing new is polled again after
+// a short delay.
+//
+// All methods are thread safe.
+class CloudLogTailer {
+ public:
+  virtual ~CloudLogTailer() {}
+
+  virtual const char* Name() const = 0;
+
+  virtual int GetNumThreads() const = 0;
+
+  // The partitions of streams that are being tailed
+  virtual size_t GetNumStreams() const = 0;
+};
+
+// Creates a CloudLogTailer of num_threads threads.
+Status NewCloudLogTailer(int num_threads,
+                         std::shared_ptr<CloudLogTailer>* tailer);
+
+}  // namespace ROCKSDB_NAMESPACE
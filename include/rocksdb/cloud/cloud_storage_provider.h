@@ -2,7 +2,10 @@
 //
 #pragma once
 
+#include <functional>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/configurable.h"
 #include "rocksdb/file_system.h"
@@ -40,6 +43,22 @@ struct CloudObjectInformation {
   // Cloud-vendor dependent. In S3, we will provide ETag of the object.
   std::string content_hash;
   std::unordered_map<std::string, std::string> metadata;
+  // Empty for the default storage class of the bucket
+  std::string storage_class;
+};
+
+// The state of the client-side limit on the request rate to a prefix of a
+// bucket (see CloudFileSystemOptions::s3_adaptive_throttling)
+struct CloudRequestRateLimitState {
+  std::string bucket;
+  std::string prefix;
+  // Requests per second allowed, 0 when the requests are not limited
+  double rate = 0;
+  // Number of requests the store throttled
+  uint64_t throttles = 0;
+  // Number and total duration of the delays of the requests over the rate
+  uint64_t delayed_requests = 0;
+  uint64_t delay_micros = 0;
 };
 
 // A CloudStorageProvider provides the interface to the cloud object
@@ -51,11 +70,16 @@ class CloudStorageProvider : public Configurable {
   virtual ~CloudStorageProvider();
   static const char* Type() { return "CloudStorageProvider"; }
   // Creates and configures a new CloudStorageProvider from the input options
-  // and id.
+  // and value, an id or "id=<id>;<option>=<value>;...".
   static Status CreateFromString(
-      const ConfigOptions& config_options, const std::string& id,
+      const ConfigOptions& config_options, const std::string& value,
       std::shared_ptr<CloudStorageProvider>* provider);
 
+  // Returns the state of the request rate limits of the process, one per
+  // bucket and prefix that requests were sent to
+  static void GetRequestRateLimits(
+      std::vector<CloudRequestRateLimitState>* states);
+
   // Returns name of the cloud storage provider type (e.g., S3)
   virtual const char* Name() const = 0;
 
@@ -69,6 +93,14 @@ class CloudStorageProvider : public Configurable {
   virtual IOStatus DeleteCloudObject(const std::string& bucket_name,
                                      const std::string& object_path) = 0;
 
+  // Delete the specified objects from the specified cloud bucket, with as
+  // few requests as the provider allows. Objects that don't exist are not an
+  // error. Returns the first error, after trying all the objects. The
+  // default implementation deletes them one by one.
+  virtual IOStatus DeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths);
+
   // Does the specified object exist in the cloud storage
   // returns all the objects that have the specified path prefix and
   // are stored in a cloud bucket
@@ -76,6 +108,17 @@ class CloudStorageProvider : public Configurable {
                                     const std::string& object_path,
                                     std::vector<std::string>* path_names) = 0;
 
+  // Like ListCloudObjects, but calls fn with the objects in batches as they
+  // are listed, in no particular order, instead of returning all of them at
+  // once. The calls to fn are not concurrent. Stops at the first error of
+  // fn, which is returned. The default implementation calls fn once with the
+  // result of ListCloudObjects.
+  using ListCloudObjectsCallback =
+      std::function<IOStatus(const std::vector<std::string>& path_names)>;
+  virtual IOStatus ListCloudObjectsInBatches(
+      const std::string& bucket_name, const std::string& object_path,
+      const ListCloudObjectsCallback& fn);
+
   // Does the specified object exist in the cloud storage
   virtual IOStatus ExistsCloudObject(const std::string& bucket_name,
                                      const std::string& object_path) = 0;
@@ -112,6 +155,48 @@ class CloudStorageProvider : public Configurable {
                                   const std::string& bucket_name,
                                   const std::string& object_path) = 0;
 
+  // Uploads object to the cloud in the given storage class, such as
+  // STANDARD_IA for S3. Providers without storage classes upload it like
+  // PutCloudObject().
+  virtual IOStatus PutCloudObjectInStorageClass(
+      const std::string& local_path, const std::string& bucket_name,
+      const std::string& object_path, const std::string& /*storage_class*/) {
+    return PutCloudObject(local_path, bucket_name, object_path);
+  }
+
+  // Multipart upload: the object is uploaded in parts that can be sent
+  // concurrently, and becomes visible once CompleteMultipartUpload succeeds.
+  // Parts are numbered from 1. upload_id identifies the upload in the
+  // following calls, part_id the uploaded part. The object gets metadata.
+  // Providers that do not support multipart uploads return NotSupported and
+  // objects are uploaded with PutCloudObject instead.
+  virtual IOStatus CreateMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::unordered_map<std::string, std::string>& /*metadata*/,
+      std::string* /*upload_id*/) {
+    return IOStatus::NotSupported("Multipart upload not supported");
+  }
+  virtual IOStatus UploadPart(const std::string& /*bucket_name*/,
+                              const std::string& /*object_path*/,
+                              const std::string& /*upload_id*/,
+                              int /*part_number*/, const Slice& /*data*/,
+                              std::string* /*part_id*/) {
+    return IOStatus::NotSupported("Multipart upload not supported");
+  }
+  // part_ids[i] is the part_id returned for part number i + 1
+  virtual IOStatus CompleteMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::string& /*upload_id*/,
+      const std::vector<std::string>& /*part_ids*/) {
+    return IOStatus::NotSupported("Multipart upload not supported");
+  }
+  // Discards the parts uploaded so far
+  virtual IOStatus AbortMultipartUpload(const std::string& /*bucket_name*/,
+                                        const std::string& /*object_path*/,
+                                        const std::string& /*upload_id*/) {
+    return IOStatus::NotSupported("Multipart upload not supported");
+  }
+
   // Updates/Sets the metadata of the object in cloud storage
   virtual IOStatus PutCloudObjectMetadata(
       const std::string& bucket_name, const std::string& object_path,
@@ -3,9 +3,21 @@
 #pragma once
 
 #include "rocksdb/cloud/cloud_storage_provider.h"
+#include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace ROCKSDB_NAMESPACE {
+class BlockAccessCipherStream;
+class CloudFileCache;
+class CloudMultipartUploader;
+class CloudRequestTracer;
+class CloudTransferExecutor;
+class Statistics;
+class ThreadPool;
+enum class CloudRequestOpType;
+
 class CloudStorageReadableFileImpl : public CloudStorageReadableFile {
  public:
   CloudStorageReadableFileImpl(Logger* info_log, const std::string& bucket,
@@ -21,17 +33,140 @@ class CloudStorageReadableFileImpl : public CloudStorageReadableFile {
 
   IOStatus Skip(uint64_t n) override;
 
+  // Requests whose ranges are close to each other are served by a single
+  // cloud read.
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override;
+
+  // If an async read executor is set, the reads are executed by it and
+  // completed by CloudFileSystem::Poll(). Otherwise they are executed
+  // synchronously, as in FSRandomAccessFile.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& options,
+                     std::function<void(FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override;
+  IOStatus MultiReadAsync(
+      FSReadRequest* reqs, size_t num_reqs, const IOOptions& options,
+      std::function<void(const FSReadRequest*, size_t, void*)> cb,
+      void* cb_arg, void** io_handles, size_t* num_io_handles,
+      IOHandleDeleter* del_fns, IODebugContext* dbg) override;
+
+  void SetAsyncReadExecutor(const std::shared_ptr<ThreadPool>& executor) {
+    async_read_executor_ = executor;
+  }
+
+  // Waits for the asynchronous reads among io_handles that were submitted by
+  // a CloudStorageReadableFileImpl and runs their callbacks. The handles that
+  // do not belong to a cloud read are appended to other_handles.
+  static IOStatus PollAsyncReads(const std::vector<void*>& io_handles,
+                                 std::vector<void*>* other_handles);
+  // Same as PollAsyncReads, but does not run the callbacks.
+  static IOStatus AbortAsyncReads(const std::vector<void*>& io_handles,
+                                  std::vector<void*>* other_handles);
+
+  // Serve random reads from the given extent cache, falling back to the
+  // provider for the extents that are not cached yet.
+  void SetFileCache(const std::shared_ptr<CloudFileCache>& file_cache) {
+    file_cache_ = file_cache;
+  }
+
+  // Records the requests of the file in tracer, see
+  // CloudFileSystemOptions::request_trace_file
+  void SetRequestTracer(const std::shared_ptr<CloudRequestTracer>& tracer) {
+    request_tracer_ = tracer;
+  }
+
+  // Fetches [offset, offset + n) into a readahead buffer that the following
+  // reads are served from. A prefetch that starts in the last buffered range
+  // is taken for a sequential scan: it is extended to twice the size of that
+  // range, up to the readahead size. Returns NotSupported if readahead is
+  // disabled, so that the caller reads ahead by itself.
+  IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
+                    IODebugContext* dbg) override;
+
+  // Enables Prefetch. A prefetch is fetched with up to `streams` ranged reads
+  // run in parallel on executor, if not null.
+  void SetReadahead(const std::shared_ptr<CloudTransferExecutor>& executor,
+                    uint64_t readahead_size, int streams);
+
+  // Serves the reads of the last tail.size() bytes of the file from tail,
+  // see CloudFileSystemOptions::sst_open_tail_size. REQUIRES: called before
+  // the file is read.
+  void SetTail(std::string tail);
+
+  // Decrypts what is read from the cloud with cipher, at its offset in the
+  // object, see CloudFileSystemOptions::cloud_encryption_cipher. The tail,
+  // if any, has to be decrypted already. REQUIRES: called before the file is
+  // read.
+  void SetCipher(std::shared_ptr<BlockAccessCipherStream> cipher) {
+    cipher_ = std::move(cipher);
+  }
+
  protected:
   virtual IOStatus DoCloudRead(uint64_t offset, size_t n,
                                const IOOptions& options, char* scratch,
                                uint64_t* bytes_read,
                                IODebugContext* dbg) const = 0;
 
+  // DoCloudRead, recorded in request_tracer_ and decrypted with cipher_ if
+  // they are set
+  IOStatus CloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                     char* scratch, uint64_t* bytes_read,
+                     IODebugContext* dbg) const;
+
+  // Reads [offset, offset + n) extent by extent through file_cache_.
+  // REQUIRES: file_cache_ != nullptr, offset + n <= file_size_
+  IOStatus ReadThroughFileCache(uint64_t offset, size_t n,
+                                const IOOptions& options, char* scratch,
+                                uint64_t* bytes_read,
+                                IODebugContext* dbg) const;
+
+  // Runs MultiRead(reqs) on async_read_executor_. `complete` is invoked by
+  // PollAsyncReads once the reads are done.
+  void SubmitAsyncRead(FSReadRequest* reqs, size_t num_reqs,
+                       const IOOptions& options, std::function<void()> complete,
+                       void** io_handle, IOHandleDeleter* del_fn);
+
+  // Copies [offset, offset + n) to scratch if the readahead buffers hold all
+  // of it
+  bool ReadFromReadahead(uint64_t offset, size_t n, char* scratch) const;
+
   Logger* info_log_;
   std::string bucket_;
   std::string fname_;
   uint64_t offset_;
   uint64_t file_size_;
+  std::shared_ptr<CloudFileCache> file_cache_;
+  std::shared_ptr<ThreadPool> async_read_executor_;
+  std::shared_ptr<CloudRequestTracer> request_tracer_;
+
+ private:
+  struct ReadaheadBuffer {
+    uint64_t offset;
+    std::shared_ptr<const std::string> data;
+    uint64_t last_use;
+  };
+  // Returns the buffer holding offset, null if none. REQUIRES:
+  // readahead_mutex_ is held
+  ReadaheadBuffer* FindReadahead(uint64_t offset) const;
+
+  // A file is read by every iterator and compaction over it, so a few
+  // buffers are kept rather than one that they would keep replacing
+  static constexpr size_t kMaxReadaheadBuffers = 4;
+  static constexpr uint64_t kMinReadaheadStreamSize = 1 << 20;
+
+  // Null if none. Immutable once set.
+  std::unique_ptr<const std::string> tail_;
+  uint64_t tail_offset_ = 0;
+  // Null if the object isn't encrypted. Immutable once set.
+  std::shared_ptr<BlockAccessCipherStream> cipher_;
+
+  std::shared_ptr<CloudTransferExecutor> readahead_executor_;
+  uint64_t readahead_size_ = 0;
+  int readahead_streams_ = 1;
+  mutable std::mutex readahead_mutex_;
+  mutable std::vector<ReadaheadBuffer> readahead_buffers_;
+  mutable uint64_t readahead_clock_ = 0;
 };
 
 // Appends to a file in S3.
@@ -46,6 +181,19 @@ class CloudStorageWritableFileImpl : public CloudStorageWritableFile {
   std::string bucket_;
   std::string cloud_fname_;
   bool is_manifest_;
+  // Whether the SST file stays local once uploaded, see
+  // CloudFileSystemOptions::cloud_only_sst_temperatures
+  bool keep_local_;
+  // The storage class of the object, see
+  // CloudFileSystemOptions::cloud_only_sst_storage_class
+  std::string storage_class_;
+  // Streams the file to the cloud while it is written, if set
+  std::unique_ptr<CloudMultipartUploader> uploader_;
+
+  // Passes appended data to uploader_, cancelling the streaming upload on
+  // error so that the file is uploaded as a whole on Close instead.
+  void AppendToUploader(const Slice& data);
+  void CancelUploader(const char* reason);
 
  public:
   CloudStorageWritableFileImpl(CloudFileSystem* fs,
@@ -60,17 +208,27 @@ class CloudStorageWritableFileImpl : public CloudStorageWritableFile {
                   IODebugContext* dbg) override {
     assert(status_.ok());
     // write to temporary file
-    return local_file_->Append(data, opts, dbg);
+    auto st = local_file_->Append(data, opts, dbg);
+    if (st.ok() && uploader_) {
+      AppendToUploader(data);
+    }
+    return st;
   }
 
   using CloudStorageWritableFile::PositionedAppend;
   IOStatus PositionedAppend(const Slice& data, uint64_t offset,
                             const IOOptions& opts,
                             IODebugContext* dbg) override {
+    if (uploader_) {
+      CancelUploader("PositionedAppend");
+    }
     return local_file_->PositionedAppend(data, offset, opts, dbg);
   }
   IOStatus Truncate(uint64_t size, const IOOptions& opts,
                     IODebugContext* dbg) override {
+    if (uploader_) {
+      CancelUploader("Truncate");
+    }
     return local_file_->Truncate(size, opts, dbg);
   }
   IOStatus Fsync(const IOOptions& opts, IODebugContext* dbg) override {
@@ -108,6 +266,49 @@ class CloudStorageWritableFileImpl : public CloudStorageWritableFile {
   IOStatus status() override { return status_; }
   IOStatus Sync(const IOOptions& opts, IODebugContext* dbg) override;
   IOStatus Close(const IOOptions& opts, IODebugContext* dbg) override;
+  // The upload of the file is charged to the transfer_rate_limiter at this
+  // priority
+  void SetIOPriority(Env::IOPriority pri) override;
+
+  // Stream the file to the cloud with the given uploader while it is written
+  void SetMultipartUploader(std::unique_ptr<CloudMultipartUploader> uploader);
+};
+
+// Configures the provider of kLocal(), which stores the objects in a
+// directory instead of a remote object store, and simulates the latency,
+// bandwidth and failures of the requests of one. It is meant to benchmark
+// and test the cloud code paths without a cloud account.
+//
+// The object `key` of bucket `b` is the file root/b/key of the base file
+// system of the CloudFileSystem. Its metadata is kept in a file of its own:
+// concurrent overwrites of an object may be seen with the metadata of the
+// other write.
+struct LocalStorageOptions {
+  static const char* kName() { return "LocalStorageOptions"; }
+
+  // The directory holding the buckets. Required.
+  std::string root;
+
+  // Every request takes at least this long
+  uint64_t request_latency_micros = 0;
+
+  // Up to this much, drawn uniformly, is added to the latency of a request
+  uint64_t latency_jitter_micros = 0;
+
+  // This fraction of the requests take tail_latency_micros longer, to
+  // simulate the long tail of the latencies of an object store
+  double tail_latency_probability = 0;
+  uint64_t tail_latency_micros = 0;
+
+  // The rate, per request, at which its data is transferred. 0 for no limit.
+  uint64_t bandwidth_bytes_per_sec = 0;
+
+  // This fraction of the requests fail with IOError, as requests which
+  // failed all their retries would
+  double error_probability = 0;
+
+  // Seeds the draws of the latencies and failures, for reproducible runs
+  uint64_t seed = 0;
 };
 
 // All writes to this DB can be configured to be persisted
@@ -118,20 +319,70 @@ class CloudStorageProviderImpl : public CloudStorageProvider {
  public:
   static Status CreateS3Provider(std::unique_ptr<CloudStorageProvider>* result);
   static const char* kS3() { return "s3"; }
+  static Status CreateLocalProvider(
+      const LocalStorageOptions& options,
+      std::unique_ptr<CloudStorageProvider>* result);
+  static const char* kLocal() { return "local"; }
 
   CloudStorageProviderImpl();
   virtual ~CloudStorageProviderImpl();
+
+  // Records a request of the given type that took micros, and read or wrote
+  // bytes if it succeeded, in stats if not null, and in the IOStatsContext
+  // of the calling thread
+  static void RecordRequest(Statistics* stats, CloudRequestOpType type,
+                            uint64_t bytes, uint64_t micros, bool success);
+
+  // Copies the first size bytes of src to dst, an empty file, with parts of
+  // part_size bytes read by up to streams ranged reads at once: the calling
+  // thread and streams - 1 jobs of pool. The parts are written at their
+  // offset, aligned if dst uses direct IO.
+  // Sets *crc32c, if not null, to the CRC32C of the bytes copied.
+  static IOStatus DownloadRanges(FSRandomAccessFile* src, uint64_t size,
+                                 FSWritableFile* dst, ThreadPool* pool,
+                                 int streams, size_t part_size,
+                                 uint32_t* crc32c = nullptr);
+
+  // The metadata of an object which holds the CRC32C of its contents, see
+  // CloudFileSystemOptions::cloud_object_checksums
+  static const char* kChecksumMetadataKey() { return "rocksdb-crc32c"; }
+  static std::string ChecksumToString(uint32_t crc32c);
+  // Returns Corruption if expected, the checksum from the metadata of the
+  // object, isn't empty and doesn't match the CRC32C of the data received
+  static IOStatus VerifyChecksum(const std::string& object_path,
+                                 const std::string& expected,
+                                 uint32_t actual);
+
+  // The metadata of an encrypted object which holds the initial counter and
+  // the IV of its encryption, in hex, see
+  // CloudFileSystemOptions::cloud_encryption_cipher. The checksum of the
+  // object is the one of its encrypted contents.
+  static const char* kEncryptionMetadataKey() { return "rocksdb-ctr"; }
+
   IOStatus GetCloudObject(const std::string& bucket_name,
                           const std::string& object_path,
                           const std::string& local_destination) override;
   IOStatus PutCloudObject(const std::string& local_file,
                           const std::string& bucket_name,
                           const std::string& object_path) override;
+  IOStatus PutCloudObjectInStorageClass(
+      const std::string& local_file, const std::string& bucket_name,
+      const std::string& object_path,
+      const std::string& storage_class) override;
+  IOStatus UploadPart(const std::string& bucket_name,
+                      const std::string& object_path,
+                      const std::string& upload_id, int part_number,
+                      const Slice& data, std::string* part_id) override;
   IOStatus NewCloudReadableFile(
       const std::string& bucket, const std::string& fname,
       const FileOptions& options,
       std::unique_ptr<CloudStorageReadableFile>* result,
       IODebugContext* dbg) override;
+  IOStatus NewCloudWritableFile(
+      const std::string& local_path, const std::string& bucket_name,
+      const std::string& object_path, const FileOptions& options,
+      std::unique_ptr<CloudStorageWritableFile>* result,
+      IODebugContext* dbg) override;
   Status PrepareOptions(const ConfigOptions& options) override;
 
  protected:
@@ -141,18 +392,75 @@ class CloudStorageProviderImpl : public CloudStorageProvider {
       const std::string& content_hash, const FileOptions& options,
       std::unique_ptr<CloudStorageReadableFile>* result,
       IODebugContext* dbg) = 0;
+  virtual IOStatus DoNewCloudWritableFile(
+      const std::string& local_path, const std::string& bucket_name,
+      const std::string& object_path, const FileOptions& options,
+      std::unique_ptr<CloudStorageWritableFile>* result,
+      IODebugContext* dbg) = 0;
+  // Reads the last n bytes of the object, all of it if it is smaller, with a
+  // single request that also sets the size, content hash and metadata of
+  // info. Returns NotSupported if the provider can't.
+  virtual IOStatus DoReadCloudObjectTail(const std::string& /*bucket_name*/,
+                                         const std::string& /*object_path*/,
+                                         size_t /*n*/, std::string* /*tail*/,
+                                         CloudObjectInformation* /*info*/) {
+    return IOStatus::NotSupported("Tail reads not supported");
+  }
 
   // Downloads object from the cloud into a local directory
   virtual IOStatus DoGetCloudObject(const std::string& bucket_name,
                                     const std::string& object_path,
                                     const std::string& local_path,
                                     uint64_t* remote_size) = 0;
-  virtual IOStatus DoPutCloudObject(const std::string& local_file,
-                                    const std::string& object_path,
-                                    const std::string& bucket_name,
-                                    uint64_t file_size) = 0;
+  // Uploads local_file with the given metadata, in the given storage class
+  // if not empty
+  virtual IOStatus DoPutCloudObject(
+      const std::string& local_file, const std::string& bucket_name,
+      const std::string& object_path, uint64_t file_size,
+      const std::unordered_map<std::string, std::string>& metadata,
+      const std::string& storage_class) = 0;
+  virtual IOStatus DoUploadPart(const std::string& /*bucket_name*/,
+                                const std::string& /*object_path*/,
+                                const std::string& /*upload_id*/,
+                                int /*part_number*/, const Slice& /*data*/,
+                                std::string* /*part_id*/) {
+    return IOStatus::NotSupported("Multipart upload not supported");
+  }
 
   CloudFileSystem* cfs_;
   Status status_;
+  // Executes the asynchronous reads of the readable files, null if
+  // async_read_threads is 0
+  std::shared_ptr<ThreadPool> async_read_executor_;
+  // Uploads the parts of streamed files on the transfer executor of cfs_,
+  // null if multipart_upload_part_size is 0
+  std::shared_ptr<ThreadPool> upload_executor_;
+  // Reads the parts of the downloads, null if cloud_download_streams <= 1
+  std::shared_ptr<ThreadPool> download_executor_;
+  // Null if request_trace_file is empty
+  std::shared_ptr<CloudRequestTracer> request_tracer_;
+
+ private:
+  // Objects at least twice this size are downloaded in parts
+  static constexpr size_t kDownloadPartSize = 8 << 20;
+
+  // Sets *cipher to the cipher stream of a new object, with a random initial
+  // counter and IV, and *encoded to their value of kEncryptionMetadataKey.
+  // REQUIRES: cloud_encryption_cipher is set
+  IOStatus NewObjectCipher(std::string* encoded,
+                           std::shared_ptr<BlockAccessCipherStream>* cipher);
+  // Sets *cipher to the cipher stream of the object with the given metadata,
+  // null if the object isn't encrypted
+  IOStatus GetObjectCipher(
+      const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata,
+      std::shared_ptr<BlockAccessCipherStream>* cipher);
+
+  // Downloads the object with DownloadRanges() if it's large enough,
+  // otherwise with DoGetCloudObject()
+  IOStatus DownloadInParts(const std::string& bucket_name,
+                           const std::string& object_path,
+                           const std::string& local_path,
+                           uint64_t* remote_size);
 };
 }  // namespace ROCKSDB_NAMESPACE
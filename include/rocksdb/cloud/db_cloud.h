@@ -44,10 +44,66 @@ class DBCloud : public StackableDB {
                      std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr,
                      bool read_only = false);
 
+  // Opens a follower: a read replica of the database that a leader writes to
+  // the cloud. The CloudFileSystem of options.env reads the database of the
+  // leader from its src bucket; it must have no dest bucket, and must not
+  // roll the cloud manifest on open. The follower is a secondary instance
+  // (see DB::OpenAsSecondary) whose info log goes to secondary_path. It sees
+  // the data the leader flushed, as of the last TryCatchUpWithLeader(), and
+  // reads the SST files from the cloud as it needs them.
+  static Status OpenAsFollower(
+      const Options& options, const std::string& dbname,
+      const std::string& secondary_path,
+      const std::vector<ColumnFamilyDescriptor>& column_families,
+      std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr);
+
+  // For a follower, applies the changes the leader made to its MANIFEST in
+  // the cloud since the last call, without reopening. The leader deletes
+  // obsolete files cloud_file_deletion_delay after they become obsolete, so
+  // a follower should catch up well within that. Returns NotSupported if this
+  // database is not a follower, and Aborted if the follower has to be
+  // reopened to catch up.
+  virtual Status TryCatchUpWithLeader() {
+    return Status::NotSupported("Not a follower");
+  }
+
   // Synchronously copy all relevant files (if any) from source cloud storage to
   // destination cloud storage.
   virtual Status Savepoint() = 0;
 
+  // The progress of the last savepoint
+  struct SavepointProgress {
+    // The live files that the destination was missing when the savepoint
+    // started, and their bytes
+    uint64_t num_files = 0;
+    uint64_t total_bytes = 0;
+    // Of these, the ones copied so far
+    uint64_t num_copied = 0;
+    uint64_t copied_bytes = 0;
+    bool done = true;
+    // The status of the savepoint once done
+    Status status;
+  };
+
+  // Like Savepoint(), but copies the files in the background: returns once
+  // the files the destination is missing are known, from a listing of the
+  // destination. The files of the lowest levels, which are compacted away
+  // the soonest, are copied first. Returns Busy if a savepoint is running.
+  //
+  // The destination itself records what was copied: a savepoint that is
+  // interrupted, e.g. by a restart, is resumed by the next one, which only
+  // copies the files that are still missing.
+  virtual Status StartSavepoint() {
+    return Status::NotSupported("StartSavepoint");
+  }
+  // Waits for the savepoint started last and returns its status
+  virtual Status WaitForSavepoint() {
+    return Status::NotSupported("WaitForSavepoint");
+  }
+  virtual void GetSavepointProgress(SavepointProgress* progress) {
+    *progress = SavepointProgress();
+  }
+
   // Synchronously copy all local files to the cloud destination given by
   // 'destination' parameter.
   // Important: This will overwrite the database in 'destination', if any.
@@ -55,6 +111,40 @@ class DBCloud : public StackableDB {
   virtual Status CheckpointToCloud(const BucketOptions& destination,
                                    const CheckpointToCloudOptions& options) = 0;
 
+  // Creates an openable snapshot of the DB in the local directory
+  // checkpoint_dir, which must not exist, by manifest rather than by bytes:
+  // the SST and blob files that are in the local directory are hard linked,
+  // the ones that are only in the cloud (keep_local_sst_files=false) are
+  // left there, referenced by the MANIFEST of the checkpoint, and the WAL,
+  // MANIFEST, CLOUDMANIFEST and other files are copied in parallel.
+  //
+  // The checkpoint is opened as an ephemeral clone whose src bucket is the
+  // dest bucket of this DB (its src bucket if it has none), which reads the
+  // files left in the cloud from there. This DB deletes its obsolete files
+  // from the cloud after cloud_file_deletion_delay, so the checkpoint has to
+  // be opened before then, or copied with CheckpointToCloud. The WAL files
+  // have to be local (keep_local_log_files).
+  virtual Status CheckpointToLocal(
+      const std::string& /*checkpoint_dir*/,
+      const CheckpointToLocalOptions& /*options*/) {
+    return Status::NotSupported("CheckpointToLocal");
+  }
+
+  // The verification of the live SST files so far, see
+  // CloudFileSystemOptions::scrub_interval_secs
+  struct ScrubStats {
+    // The passes over all the live SST files completed
+    uint64_t num_passes = 0;
+    // The local copies and objects verified, and their bytes
+    uint64_t num_verified = 0;
+    uint64_t verified_bytes = 0;
+    // The local copies and objects found corrupted, and the ones of these
+    // replaced by a sound copy
+    uint64_t num_corrupted = 0;
+    uint64_t num_repaired = 0;
+  };
+  virtual void GetScrubStats(ScrubStats* stats) { *stats = ScrubStats(); }
+
   // ListColumnFamilies will open the DB specified by argument name
   // and return the list of all column families in that DB
   // through column_families argument. The ordering of
@@ -0,0 +1,81 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cloud/db_cloud.h"
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct ReplicationBootstrapOptions {
+  // Passed to DB::ApplyReplicationLogRecords() for the tail records
+  DB::CFOptionsFactory cf_options_factory;
+  uint64_t snapshot_replication_epoch = 0;
+  unsigned apply_flags = 0;
+
+  // If positive, AddRecord() returns Busy instead of buffering more than
+  // this many bytes of record contents while the snapshot is opened. The
+  // caller is expected to pause the tail and retry.
+  //
+  // Default: 0 (unbounded)
+  uint64_t max_buffered_bytes = 0;
+};
+
+// Brings up a new follower from a CheckpointToCloud() snapshot of the
+// leader while the replication log tail is read.
+//
+// Start() opens the snapshot with DBCloud::Open on a background thread.
+// options.env must be a CloudFileSystem whose src bucket is the
+// CheckpointToCloud destination; its sst_download_threads and
+// hydrate_in_background decide how the SST files are hydrated. In the
+// meantime, the caller feeds the tail to AddRecord(), which buffers it.
+// WaitForOpen() applies the buffered records after the snapshot's
+// persisted replication sequence (see DB::GetPersistedReplicationSequence)
+// and hands over the DB; the later AddRecord() calls apply the records
+// right away.
+//
+// The tail has to start at or before the record of the snapshot's persisted
+// replication sequence. Records up to and including it are skipped, whether
+// they are added before or after WaitForOpen(). The SST files that manifest
+// writes of the tail add must be readable through options.env.
+//
+// AddRecord() and WaitForOpen() are thread safe.
+class ReplicationBootstrap {
+ public:
+  static Status Start(
+      const Options& options, const std::string& dbname,
+      const std::vector<ColumnFamilyDescriptor>& column_families,
+      const std::string& persistent_cache_path,
+      uint64_t persistent_cache_size_gb,
+      ReplicationBootstrapOptions bootstrap_options,
+      std::unique_ptr<ReplicationBootstrap>* result);
+
+  // Closes the DB if it was not handed over by WaitForOpen()
+  virtual ~ReplicationBootstrap() {}
+
+  // Adds the next record of the tail with the replication sequence the
+  // leader's ReplicationLogListener returned for it. info is filled in if
+  // the record is applied right away. Returns the error of the open, or of
+  // the apply, if any.
+  virtual Status AddRecord(ReplicationLogRecord record,
+                           std::string replication_sequence,
+                           DB::ApplyReplicationLogRecordInfo* info) = 0;
+
+  // Waits for the snapshot to be opened, applies the buffered records and
+  // returns the DB and the handles of column_families. The caller owns them
+  // from then on, but keeps adding the tail through AddRecord() until it
+  // switches to DB::ApplyReplicationLogRecord() itself. info covers the
+  // buffered records, e.g. the column families they created.
+  virtual Status WaitForOpen(DB::ApplyReplicationLogRecordInfo* info,
+                             std::vector<ColumnFamilyHandle*>* handles,
+                             DBCloud** dbptr) = 0;
+
+  // Number of tail records skipped as already in the snapshot
+  virtual uint64_t GetNumSkippedRecords() const = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -177,6 +177,17 @@ class CompactionFilter : public Customizable {
     static const int kUnknownStartLevel = -1;
   };
 
+  // A plain value passed to FilterBatch(), with the outputs of FilterV3() for
+  // it
+  struct BatchEntry {
+    Slice key;
+    Slice existing_value;
+    Decision decision = Decision::kKeep;
+    std::string new_value;
+    std::vector<std::pair<std::string, std::string>> new_columns;
+    std::string skip_until;
+  };
+
   virtual ~CompactionFilter() {}
   static const char* Type() { return "CompactionFilter"; }
   static Status CreateFromString(const ConfigOptions& config_options,
@@ -300,6 +311,31 @@ class CompactionFilter : public Customizable {
                     skip_until);
   }
 
+  // If not zero, the plain values that would be passed to FilterV3() are
+  // instead passed to FilterBatch() up to this many at a time. The
+  // compaction reads that many entries ahead of the ones it processes.
+  virtual size_t FilterBatchSize() const { return 0; }
+
+  // Batched FilterV3() for plain values: sets the decision and the outputs of
+  // each entry, which is for the latest version of its key and in key order.
+  // Implementations can, for example, decode or look up the entries together
+  // or split them across threads, as the batch is complete when this
+  // returns. An entry may turn out not to be compacted, e.g. if an earlier
+  // entry of the batch returns kRemoveAndSkipUntil past it, in which case
+  // its decision is ignored. Not used for the table files of transactions
+  // (with a snapshot checker) or with user-defined timestamps, for which
+  // FilterV3() is called.
+  //
+  // The default implementation calls FilterV3() for each entry.
+  virtual void FilterBatch(int level, std::vector<BatchEntry>* entries) const {
+    for (auto& entry : *entries) {
+      entry.decision =
+          FilterV3(level, entry.key, ValueType::kValue, &entry.existing_value,
+                   nullptr /* existing_columns */, &entry.new_value,
+                   &entry.new_columns, &entry.skip_until);
+    }
+  }
+
   // Internal (BlobDB) use only. Do not override in application code.
   virtual BlobDecision PrepareBlobOutput(const Slice& /* key */,
                                          const Slice& /* existing_value */,
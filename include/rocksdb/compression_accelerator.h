@@ -0,0 +1,65 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A CompressionAccelerator offloads the compression and decompression of
+// SST blocks to a device, such as Intel QAT or IAA, or to any other
+// implementation of the block compression algorithms.
+//
+// The accelerator has to produce and accept exactly the streams of the
+// software codec of the compression type, as configured by the
+// CompressionOptions, so that files written with an accelerator stay
+// readable without one and the other way around. RocksDB keeps adding and
+// parsing the block header with the uncompressed size, so the accelerator
+// only sees the codec payload. Blocks compressed with a dictionary and
+// blocks of table files with format_version < 2 always take the software
+// path.
+//
+// Whenever the accelerator does not support a block or fails on it, RocksDB
+// falls back to the software codec for that block, e.g. when the device is
+// busy or unavailable, or the block is too small to be worth offloading.
+//
+// The methods are called concurrently: by the flush and compaction threads,
+// by the compression workers of the block-based table builder (see
+// CompressionOptions::parallel_threads), and by all threads that read
+// blocks. An implementation can take advantage of that to keep many
+// requests in flight on the device at once.
+class CompressionAccelerator {
+ public:
+  virtual ~CompressionAccelerator() {}
+
+  // Returns a name that identifies this accelerator in the info log.
+  virtual const char* Name() const = 0;
+
+  // Returns whether blocks of the given compression type go to this
+  // accelerator. Must not change over the lifetime of the accelerator.
+  virtual bool Supports(CompressionType type) const = 0;
+
+  // Appends the payload of `input` compressed with `type` and `opts` to
+  // `output`. Returning a non-OK status makes RocksDB compress the block in
+  // software instead, whatever the accelerator appended.
+  virtual Status Compress(CompressionType type, const CompressionOptions& opts,
+                          const Slice& input, std::string* output) = 0;
+
+  // Uncompresses the payload `input`, compressed with `type`, into the
+  // `output_size` bytes at `output`, which is the uncompressed size that
+  // RocksDB recorded for the block. Returning a non-OK status makes RocksDB
+  // uncompress the block in software instead.
+  virtual Status Uncompress(CompressionType type, const Slice& input,
+                            char* output, size_t output_size) = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,67 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Trains the compression dictionaries of the block-based tables of the
+// column families using it (ColumnFamilyOptions::compression_dict_trainer)
+// on a thread of its own, from the data blocks of the table files they
+// recently built, and hands the latest dictionary to the next table files.
+//
+// Without a trainer, each table file built with
+// CompressionOptions::max_dict_bytes > 0 buffers its first data blocks and
+// trains its own dictionary on the flush or compaction thread. With one,
+// table files are built unbuffered with the latest dictionary trained for
+// their compression type and options, and only sample their data blocks for
+// the next training. Small files, like L0 files, then compress as well as
+// large ones. Each table file still stores the dictionary it was built with,
+// so the table files stay self-contained and readable without the trainer.
+//
+// This is NOT an extensible interface but a public interface for result of
+// NewCompressionDictTrainer. Any derived classes must be RocksDB internal.
+class CompressionDictTrainer {
+ public:
+  virtual ~CompressionDictTrainer() {}
+
+  // Returns the latest dictionary trained for table files compressed with
+  // `type` and `opts`, or an empty string if none was trained yet. Called by
+  // RocksDB.
+  virtual std::string GetDict(CompressionType type,
+                              const CompressionOptions& opts) = 0;
+
+  // Queues the samples of the data blocks of a table file compressed with
+  // `type` and `opts` to train the next dictionary for such files from. Only
+  // the latest samples queued for the same type and options are trained
+  // from. Called by RocksDB.
+  virtual void AddSamples(CompressionType type, const CompressionOptions& opts,
+                          std::string&& samples,
+                          std::vector<size_t>&& sample_lens) = 0;
+
+  // Waits until the samples queued so far have been trained from
+  virtual void WaitForTraining() = 0;
+
+  // Returns the number of dictionaries trained since the creation of the
+  // trainer
+  virtual uint64_t GetNumTrained() const = 0;
+};
+
+// Create a CompressionDictTrainer, with its training thread, that can be
+// shared with multiple CFs across RocksDB instances. Only the CFs with the
+// same compression options share dictionaries.
+std::shared_ptr<CompressionDictTrainer> NewCompressionDictTrainer();
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -175,6 +175,27 @@ struct CompressionOptions {
   // decompression.
   bool checksum = false;
 
+  // EXPERIMENTAL Block-based tables only. If > 0, each data block is
+  // compressed with the type among the configured one, LZ4 and no compression
+  // that is estimated to cost the least, as defined by
+  // `adaptive_bytes_per_cpu_micro`. One in `adaptive_sample_one_in` data
+  // blocks of a table file, starting with the first one, is compressed with
+  // every candidate to measure their ratio and speed on the data of the file.
+  // The sampled block gets the best candidate for it, and the blocks that
+  // follow the best one averaged over the recent samples. The type of each
+  // block is recorded in its trailer, so readers need no setting.
+  //
+  // Ignored when `max_dict_bytes` > 0, since all the blocks of a file share
+  // its dictionary.
+  uint32_t adaptive_sample_one_in = 0;
+
+  // With `adaptive_sample_one_in` > 0, how many bytes of output one
+  // microsecond of compression CPU is worth. The cost of a block compressed
+  // with a candidate is its compressed size plus this times its compression
+  // time in microseconds, and the cost of a block left uncompressed its size.
+  // 0 picks the smallest output whatever its CPU cost.
+  double adaptive_bytes_per_cpu_micro = 0;
+
   // A convenience function for setting max_compressed_bytes_per_kb based on a
   // minimum acceptable compression ratio (uncompressed size over compressed
   // size).
@@ -1269,6 +1269,14 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    // "rocksdb.memory-breakdown" - returns the memory usage of the column
+    //      family by component: its mem-tables, its table readers, the block
+    //      cache it uses and, prefixed with "tracked.", the usage of each
+    //      process-wide MemoryTracker (see rocksdb/memory_tracker.h). The
+    //      block cache and the trackers may be shared with other column
+    //      families and DBs.
+    static const std::string kMemoryBreakdown;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
@@ -1304,6 +1312,23 @@ class DB {
     // "rocksdb.blob-cache-pinned-usage" - returns the memory size for the
     //      entries being pinned in blob cache.
     static const std::string kBlobCachePinnedUsage;
+
+    // "rocksdb.replication-stats" - returns a multi-line string or map with
+    //      the cumulative stats of the replication log records a follower
+    //      applied: records-applied, bytes-applied, memtable-writes-applied,
+    //      memtable-switches-applied, manifest-writes-applied, apply-micros
+    //      and switch-memtable-micros (time spent switching memtables).
+    //      leader-sequence is the highest leader sequence number in the
+    //      kMemtableWrite records given to ApplyReplicationLogRecord(s),
+    //      applied-sequence the last sequence number applied, and
+    //      sequence-gap the difference. Only available from the default
+    //      column family.
+    static const std::string kReplicationStats;
+
+    // "rocksdb.replication-sequence-gap" - returns the sequence-gap of
+    //      kReplicationStats, i.e. how many sequence numbers the follower
+    //      was given but did not apply.
+    static const std::string kReplicationSequenceGap;
   };
 
   // DB implementations export properties about their state via this method.
@@ -1512,6 +1537,39 @@ class DB {
                                            uint64_t snapshot_replication_epoch,
                                            ApplyReplicationLogRecordInfo* info,
                                            unsigned flags = 0) = 0;
+  // A replication record and the replication sequence returned for it by the
+  // leader's ReplicationLogListener
+  using ReplicationLogRecordAndSequence =
+      std::pair<ReplicationLogRecord, std::string>;
+  // ApplyReplicationLogRecords() applies the records in order, as many
+  // calls to ApplyReplicationLogRecord() would, but enters the write thread
+  // once and inserts consecutive memtable writes together. Meant for a
+  // follower catching up with the replication log.
+  //
+  // Stops at the first error or diverged manifest write. If num_applied is
+  // not null, it is set to the number of records applied; the records after
+  // them need to be applied again.
+  virtual Status ApplyReplicationLogRecords(
+      std::vector<ReplicationLogRecordAndSequence> records,
+      CFOptionsFactory cf_options_factory, uint64_t snapshot_replication_epoch,
+      ApplyReplicationLogRecordInfo* info, unsigned flags = 0,
+      size_t* num_applied = nullptr) {
+    Status s;
+    size_t applied = 0;
+    for (auto& record : records) {
+      s = ApplyReplicationLogRecord(
+          std::move(record.first), std::move(record.second),
+          cf_options_factory, snapshot_replication_epoch, info, flags);
+      if (!s.ok() || info->diverged_manifest_writes) {
+        break;
+      }
+      ++applied;
+    }
+    if (num_applied) {
+      *num_applied = applied;
+    }
+    return s;
+  }
   virtual Status GetReplicationRecordDebugString(
       const ReplicationLogRecord& record, std::string* out) const = 0;
   // Returns the latest replication log sequence number (returned by
@@ -83,6 +83,13 @@ struct EnvOptions {
   // Not recommended for 32-bit OS.
   bool use_mmap_reads = false;
 
+  // If true, populate the mappings of files read with mmap when opening them
+  bool populate_mmap_reads = false;
+
+  // If true, advise the kernel to back the mappings of files read with mmap
+  // with huge pages
+  bool huge_pages_for_mmap_reads = false;
+
   // If true, then use mmap to write data
   bool use_mmap_writes = true;
 
@@ -583,6 +590,25 @@ class Env : public Customizable {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Run the jobs of the specified pool fairly among the tags they were
+  // scheduled with, in proportion to the weights of the tags (see
+  // SetThreadPoolTagWeight()), instead of in the order they were scheduled.
+  // A DB schedules its flushes and compactions with itself as the tag, so
+  // the DBs sharing the pool get their share of its threads whatever the
+  // backlog of the others, and a DB close to a write stall gets more.
+  virtual Status SetThreadPoolFairScheduling(Priority /*pool*/,
+                                             bool /*fair*/) {
+    return Status::NotSupported(
+        "Env::SetThreadPoolFairScheduling() not supported");
+  }
+
+  // Set the weight of the jobs scheduled with `tag` in the specified pool
+  // for fair scheduling. The default weight is 1.
+  virtual Status SetThreadPoolTagWeight(Priority /*pool*/, void* /*tag*/,
+                                        uint32_t /*weight*/) {
+    return Status::NotSupported("Env::SetThreadPoolTagWeight() not supported");
+  }
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1624,6 +1650,15 @@ class EnvWrapper : public Env {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolFairScheduling(Priority pool, bool fair) override {
+    return target_.env->SetThreadPoolFairScheduling(pool, fair);
+  }
+
+  Status SetThreadPoolTagWeight(Priority pool, void* tag,
+                                uint32_t weight) override {
+    return target_.env->SetThreadPoolTagWeight(pool, tag, weight);
+  }
+
   std::string TimeToString(uint64_t time) override {
     return target_.env->TimeToString(time);
   }
@@ -1183,6 +1183,23 @@ class FSWritableFile {
     return Sync(options, dbg);
   }
 
+  // Appends data and syncs the file, with Fsync() if use_fsync is true.
+  // Implementations may issue both in one request to the OS, e.g. the
+  // write linked to the sync in one io_uring submission. By default, the
+  // same as Append(), Flush() then Sync() or Fsync().
+  virtual IOStatus AppendAndSync(const Slice& data, bool use_fsync,
+                                 const IOOptions& options,
+                                 IODebugContext* dbg) {
+    IOStatus s = Append(data, options, dbg);
+    if (s.ok()) {
+      s = Flush(options, dbg);
+    }
+    if (s.ok()) {
+      s = use_fsync ? Fsync(options, dbg) : Sync(options, dbg);
+    }
+    return s;
+  }
+
   // true if Sync() and Fsync() are safe to call concurrently with Append()
   // and Flush().
   virtual bool IsSyncThreadSafe() const { return false; }
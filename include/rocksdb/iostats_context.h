@@ -78,6 +78,31 @@ struct IOStatsContext {
 
   FileIOByTemperature file_io_stats_by_temperature;
 
+  // RocksDB-Cloud contribution begin
+
+  // Number of GETs of cloud objects, the bytes they read and the time spent
+  // in them. The time is only counted if the perf level is at least
+  // PerfLevel::kEnableTimeExceptForMutex.
+  uint64_t cloud_read_count;
+  uint64_t cloud_read_bytes;
+  uint64_t cloud_read_nanos;
+  // Bytes of reads of cloud files served without a request, from the
+  // readahead buffers (see CloudFileSystemOptions::cloud_readahead_size) and
+  // from CloudFileSystemOptions::sst_file_cache.
+  uint64_t cloud_readahead_hit_bytes;
+  uint64_t cloud_file_cache_hit_bytes;
+  // Time the thread waited for cloud reads made by other threads: async reads
+  // and the streams of a readahead. Only counted if the perf level is at
+  // least PerfLevel::kEnableTimeExceptForMutex.
+  uint64_t cloud_read_wait_nanos;
+  // Number of retries of the cloud requests of the thread, and the time the
+  // client slept before them (with the same perf level as above). The cloud
+  // requests above include the retries.
+  uint64_t cloud_request_retry_count;
+  uint64_t cloud_request_retry_delay_nanos;
+
+  // RocksDB-Cloud contribution end
+
   // It is not consistent that whether iostats follows PerfLevel.Timer counters
   // follows it but BackupEngine relies on counter metrics to always be there.
   // Here we create a backdoor option to disable some counters, so that some
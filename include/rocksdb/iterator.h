@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "rocksdb/cleanable.h"
 #include "rocksdb/slice.h"
@@ -69,6 +70,19 @@ class Iterator : public Cleanable {
   // REQUIRES: Valid()
   virtual void Next() = 0;
 
+  // Appends the key and value of the current entry and of up to
+  // max_entries - 1 entries after it to keys and values, and moves to the
+  // entry after the last one appended. Returns the number of entries
+  // appended, which is less than max_entries only if the iterator became
+  // invalid (check status()). Saves a call per entry through the iterator
+  // stack on long scans.
+  //
+  // The keys and values that the iterator pins (see ReadOptions::pin_data)
+  // point into the iterator's data. The others are copied into buffer, which
+  // is appended to, and stay valid until buffer is modified or destroyed.
+  virtual size_t NextBatch(size_t max_entries, std::vector<Slice>* keys,
+                           std::vector<Slice>* values, std::string* buffer);
+
   // Moves to the previous entry in the source.  After this call, Valid() is
   // true iff the iterator was not positioned at the first entry in source.
   // REQUIRES: Valid()
@@ -60,6 +60,29 @@ struct JemallocAllocatorOptions {
   // this setting can mitigate arena mutex contention. The value must be
   // positive.
   size_t num_arenas = 1;
+
+  // If true, a request uses the arena of the CPU it runs on (modulo
+  // num_arenas) rather than a random one, so that with num_arenas set to the
+  // number of CPUs, threads on different CPUs do not contend on an arena
+  // mutex and a block tends to be freed to the arena of the CPU that
+  // allocated it.
+  bool cpu_local_arenas = false;
+
+  // If true, the memory of the arenas is advised with MADV_HUGEPAGE to be
+  // backed by transparent huge pages, which saves TLB misses for large,
+  // long-lived allocations such as memtable arena blocks. Requires
+  // transparent huge pages set to "madvise" or "always".
+  bool use_huge_pages = false;
+
+  // Limits the tcache to the sizes of the blocks of a block cache built
+  // with BlockBasedTableOptions::block_size = block_size. Blocks are
+  // somewhat larger than block_size before compression and smaller after,
+  // so the sizes from block_size/4 to 2*block_size are cached.
+  void OptimizeForBlockSize(size_t block_size) {
+    limit_tcache_size = true;
+    tcache_size_lower_bound = block_size / 4;
+    tcache_size_upper_bound = 2 * block_size;
+  }
 };
 
 // Generate memory allocator which allocates through Jemalloc and utilize
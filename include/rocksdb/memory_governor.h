@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryGovernor keeps the mem-tables, a block cache and other components of
+// the process tracked by MemoryTracker under a single memory limit, for the
+// DBs it is given to through DBOptions::memory_governor.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/memory_tracker.h"
+#include "rocksdb/write_buffer_manager.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SystemClock;
+
+struct MemoryGovernorOptions {
+  // The memory that the mem-tables, the block cache and the tracked
+  // components may use together, in bytes. REQUIRED > 0.
+  size_t memory_limit = 0;
+
+  // The block cache whose capacity is given what the mem-tables do not use.
+  // Its capacity is set by the governor from then on.
+  //
+  // Default: null, in which case only the mem-tables are governed
+  std::shared_ptr<Cache> block_cache = nullptr;
+
+  // The names of the MemoryTracker components whose usage is taken out of
+  // memory_limit before it is shared between the mem-tables and the block
+  // cache.
+  std::vector<std::string> tracked_components = {
+      MemoryTrackerNames::kCloudLogController(),
+      MemoryTrackerNames::kCloudMultipartUpload()};
+
+  // The largest fraction of the memory left by the tracked components that
+  // the mem-tables may use.
+  double max_write_buffer_ratio = 0.5;
+
+  // The smallest fraction of the memory left by the tracked components that
+  // the block cache keeps, however much the mem-tables use.
+  double min_block_cache_ratio = 0.2;
+
+  // Once the mem-tables use this fraction of their limit, the writes to the
+  // DBs are delayed, more and more as the usage approaches the limit, where
+  // they stall.
+  double write_delay_start_ratio = 0.8;
+
+  // The writes to the DBs rebalance the memory at most this often
+  uint64_t rebalance_period_micros = 100 * 1000;
+};
+
+// Thread safe. The same governor can be shared by several DBs.
+class MemoryGovernor final {
+ public:
+  explicit MemoryGovernor(const MemoryGovernorOptions& options);
+  // No copying allowed
+  MemoryGovernor(const MemoryGovernor&) = delete;
+  MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+  // The write buffer manager that limits the mem-tables of the DBs, which
+  // replaces their DBOptions::write_buffer_manager. It stalls the writes
+  // when the mem-tables reach their limit.
+  const std::shared_ptr<WriteBufferManager>& write_buffer_manager() const {
+    return write_buffer_manager_;
+  }
+
+  size_t memory_limit() const {
+    return memory_limit_.load(std::memory_order_relaxed);
+  }
+  // Takes effect at the next rebalance
+  void SetMemoryLimit(size_t memory_limit) {
+    memory_limit_.store(memory_limit, std::memory_order_relaxed);
+  }
+
+  // Sets the limit of the mem-tables and the capacity of the block cache
+  // from the current usage of the tracked components and the mem-tables
+  void Rebalance();
+
+  // Rebalances if it has not been done for rebalance_period_micros, and
+  // returns how close the mem-tables are to their limit: 0 below
+  // write_delay_start_ratio of it, growing to 1 at the limit.
+  double GetWritePressure();
+
+ private:
+  const MemoryGovernorOptions options_;
+  std::atomic<size_t> memory_limit_;
+  std::shared_ptr<WriteBufferManager> write_buffer_manager_;
+  std::vector<MemoryTracker*> trackers_;
+  SystemClock* clock_;
+  std::atomic<uint64_t> next_rebalance_time_;
+  // Serializes the rebalances
+  std::mutex rebalance_mutex_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,80 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryTracker accounts the memory of one component of the process, such as
+// the mem-tables or the descriptors cached by the cloud log controller, so
+// that allocations outside of the block cache and the write buffer manager
+// are visible.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class MemoryAllocator;
+
+// The names of the components tracked by RocksDB itself
+struct MemoryTrackerNames {
+  // The arenas of all the mem-tables of the process
+  static const char* kMemTable() { return "memtable"; }
+  // The log files cached by the cloud log controllers
+  static const char* kCloudLogController() { return "cloud-log-controller"; }
+  // The parts of the cloud multipart uploads that are being uploaded
+  static const char* kCloudMultipartUpload() {
+    return "cloud-multipart-upload";
+  }
+};
+
+// The usage of a component, in bytes. Thread safe.
+class MemoryTracker {
+ public:
+  // Returns the tracker of the named component, created on first use. The
+  // trackers live until the process exits, so that the pointer returned
+  // stays valid for the lifetime of the process.
+  static MemoryTracker* Get(const std::string& name);
+
+  // Fills usage with the current usage of each component, by name
+  static void GetAllUsage(std::map<std::string, uint64_t>* usage);
+
+  // No copying allowed
+  MemoryTracker(const MemoryTracker&) = delete;
+  void operator=(const MemoryTracker&) = delete;
+
+  const std::string& Name() const { return name_; }
+
+  void Add(size_t bytes);
+  // bytes must have been added before
+  void Release(size_t bytes);
+
+  uint64_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
+  // The highest usage seen since the process started or the last
+  // ResetPeakUsage()
+  uint64_t GetPeakUsage() const {
+    return peak_usage_.load(std::memory_order_relaxed);
+  }
+  void ResetPeakUsage();
+
+ private:
+  explicit MemoryTracker(const std::string& name);
+
+  const std::string name_;
+  std::atomic<uint64_t> usage_;
+  std::atomic<uint64_t> peak_usage_;
+};
+
+// Returns an allocator that charges the blocks allocated by target to
+// tracker, for instance to account the blocks of a cache under their own
+// component. Each block costs 16 more bytes to remember its size.
+std::shared_ptr<MemoryAllocator> NewTrackingMemoryAllocator(
+    const std::shared_ptr<MemoryAllocator>& target, MemoryTracker* tracker);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -194,6 +194,16 @@ class MemTableRep {
   virtual void Get(const LookupKey& k, void* callback_args,
                    bool (*callback_func)(void* arg, const char* entry));
 
+  // Like Get(), but looks up k from entry, a key inserted into this rep,
+  // rather than searching the rep. No key may fall between k and entry.
+  // Returns false, without calling callback_func(), if not supported.
+  virtual bool GetFromEntry(const LookupKey& /*k*/, const char* /*entry*/,
+                            void* /*callback_args*/,
+                            bool (* /*callback_func*/)(void* arg,
+                                                       const char* entry)) {
+    return false;
+  }
+
   virtual uint64_t ApproximateNumEntries(const Slice& /*start_ikey*/,
                                          const Slice& /*end_key*/) {
     return 0;
@@ -386,6 +396,31 @@ class VectorRepFactory : public MemTableRepFactory {
                                  Logger* logger) override;
 };
 
+// This uses a B+tree to store keys, with 32 keys per node. Concurrent
+// inserts lock the nodes they change, and reads take no lock. Compared to
+// the skip list, a read visits fewer nodes, more densely packed, at the cost
+// of some space left unused in the nodes.
+class BTreeRepFactory : public MemTableRepFactory {
+ public:
+  BTreeRepFactory() {}
+
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "BTreeRepFactory"; }
+  static const char* kNickName() { return "btree"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
@@ -44,6 +44,7 @@ class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
 class Comparator;
+class CompressionAccelerator;
 class ConcurrentTaskLimiter;
 class Env;
 enum InfoLogLevel : unsigned char;
@@ -53,9 +54,14 @@ class Logger;
 class MergeOperator;
 class Snapshot;
 class MemTableRepFactory;
+class MemoryAllocator;
+class MemoryGovernor;
 class RateLimiter;
 class Slice;
 class Statistics;
+class StatsExporter;
+class TenantUsage;
+class CompressionDictTrainer;
 class InternalKeyComparator;
 class WalFilter;
 class FileSystem;
@@ -335,6 +341,47 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Default: nullptr
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory = nullptr;
 
+  // If non-nullptr, offloads the compression and decompression of the blocks
+  // of block-based tables to this accelerator, falling back to the software
+  // codecs for the blocks it does not support or fails on. The accelerator
+  // can be shared with multiple column families across db instances. See
+  // rocksdb/compression_accelerator.h.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompressionAccelerator> compression_accelerator = nullptr;
+
+  // If non-nullptr, the resources this column family uses are charged to
+  // this tenant: the blocks read from its table files and inserted into the
+  // block cache, the bytes written by its flushes and compactions, and the
+  // CPU time of its compactions. Can be shared with multiple column families
+  // across db instances, e.g. all the column families of the DB instances of
+  // a tenant on a host sharing caches and a WriteBufferManager. See
+  // rocksdb/tenant_usage.h.
+  //
+  // Default: nullptr
+  std::shared_ptr<TenantUsage> tenant_usage = nullptr;
+
+  // If non-nullptr and CompressionOptions::max_dict_bytes > 0, the table
+  // files of this column family are compressed with the latest dictionary
+  // trained by this trainer, in the background and from the samples of the
+  // table files recently built with the same compression options, instead of
+  // each training its own. Can be shared with multiple column families across
+  // db instances. See rocksdb/compression_dict_trainer.h.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompressionDictTrainer> compression_dict_trainer = nullptr;
+
+  // If non-nullptr, the arena blocks of the memtables of this column family
+  // are allocated from this allocator instead of malloc, e.g. a
+  // JemallocNodumpAllocator of its own, apart from the block cache's, with
+  // JemallocAllocatorOptions::use_huge_pages to back them with transparent
+  // huge pages. Unlike memtable_huge_page_size, this needs no reserved huge
+  // pages. memtable_huge_page_size and memtable_numa_local_alloc take
+  // precedence when they are set.
+  //
+  // Default: nullptr
+  std::shared_ptr<MemoryAllocator> memtable_allocator = nullptr;
+
   // Disable automatic flush(exceed `write_buffer_size` limit). Manual flush
   // (including exceeding `db_write_buffer_size` limit) can still be issued
   //
@@ -348,6 +395,20 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Default: false, write stall will be enabled
   bool disable_write_stall = false;
 
+  // If non-zero, writes are delayed and compactions are sped up before the
+  // L0 file count or the estimated pending compaction bytes reach their
+  // slowdown triggers, rather than only once they do. The rates at which the
+  // two grow, net of compactions, and the rate of the writes to the DB are
+  // estimated from the recent past, to predict when a trigger would be
+  // reached: within twice this many seconds, the compactions are sped up as
+  // by the triggers; within this many seconds, the writes are also delayed,
+  // to a rate that falls from the current one as the prediction nears. Writes
+  // then slow down smoothly instead of stalling abruptly at the triggers.
+  //
+  // Dynamically changeable through SetOptions() API
+  // Default: 0 (disabled)
+  uint64_t write_stall_prediction_secs = 0;
+
   // RocksDB will try to flush the current memtable after the number of range
   // deletions is >= this limit. For workloads with many range
   // deletions, limiting the number of range deletions in memtable can help
@@ -433,6 +494,11 @@ struct CompactionServiceJobInfo {
 
   Env::Priority priority;
 
+  // The file numbers the DB reserved for the output files of the job, see
+  // CompactionService::GetNumReservedFileNumbers()
+  uint64_t first_reserved_file_number = 0;
+  uint64_t num_reserved_file_numbers = 0;
+
   CompactionServiceJobInfo(std::string db_name_, std::string db_id_,
                            std::string db_session_id_, uint64_t job_id_,
                            Env::Priority priority_)
@@ -479,6 +545,14 @@ class CompactionService : public Customizable {
     return CompactionServiceJobStatus::kUseLocal;
   }
 
+  // The number of file numbers the DB reserves for the output files of each
+  // job, see CompactionServiceJobInfo. An output file of the result named
+  // after one of them, in the directory of the DB's output files as the
+  // output path, is installed where it is, without a rename: the worker put
+  // it where the DB keeps its file of that number. The other output files
+  // are renamed to new file numbers.
+  virtual uint64_t GetNumReservedFileNumbers() const { return 0; }
+
   // Deprecated. Please implement Schedule() and Wait() API to handle remote
   // compaction
 
@@ -505,6 +579,20 @@ struct ReplicationLogRecord {
   enum Type { kMemtableWrite, kMemtableSwitch, kManifestWrite };
   Type type;
   std::string contents;
+  // Alternative to contents that refers to a buffer owned elsewhere, e.g. the
+  // network buffer the record was received in, without copying it. It is
+  // used instead of contents when not empty. pinned_buffer keeps the buffer
+  // alive for as long as the record, or any copy of it, exists.
+  //
+  // Records passed to ReplicationLogListener::OnReplicationLogRecord() only
+  // have pinned contents if the listener AcceptsPinnedContents(). Then
+  // pinned_buffer is null, and pinned_contents is only valid during the call.
+  Slice pinned_contents;
+  std::shared_ptr<const void> pinned_buffer;
+
+  Slice GetContents() const {
+    return pinned_contents.empty() ? Slice(contents) : pinned_contents;
+  }
 };
 
 // ReplicationLogListener provides a mechanism to implement physical replication
@@ -523,7 +611,6 @@ struct ReplicationLogRecord {
 // The support for physical replication is experimental and currently does not
 // support any of the following options:
 // * unordered_write
-// * enable_pipelined_write
 // * two_write_queues
 // * write-ahead logging, i.e. WriteOptions::disableWAL needs to be set to true.
 // Replication log provides write durability.
@@ -546,6 +633,11 @@ class ReplicationLogListener {
   // the database needs to re-apply all replication log records since
   // DB::GetPersistedReplicationSequence() (non-inclusive).
   virtual std::string OnReplicationLogRecord(ReplicationLogRecord record) = 0;
+
+  // If true, kMemtableWrite records of a single write batch refer to the
+  // batch in ReplicationLogRecord::pinned_contents instead of copying it, so
+  // the listener must copy the contents it keeps past OnReplicationLogRecord.
+  virtual bool AcceptsPinnedContents() const { return false; }
 };
 
 // TODO(wei): a temporary hack so that we can get epoch from replication_sequence.
@@ -741,6 +833,9 @@ struct DBOptions {
 
   // If max_open_files is -1, DB will open all files on DB::Open(). You can
   // use this option to increase the number of threads used to open the files.
+  // It is also the number of threads that prepare the new versions of the
+  // column families updated together, e.g. by an atomic flush or by a
+  // replicated manifest write on a follower.
   // Default: 16
   int max_file_opening_threads = 16;
 
@@ -821,6 +916,18 @@ struct DBOptions {
   //   all log files in wal_dir and the dir itself is deleted
   std::string wal_dir = "";
 
+  // If true, TryCatchUpWithPrimary() on a secondary instance only lists the
+  // WAL directory to look for new WAL files when the modification time of
+  // the directory shows that files were added or removed since its last
+  // listing. The WAL files it already tails are read from where it stopped
+  // either way. Polling an idle primary, or a primary with many files in
+  // its WAL directory, is then cheap. Modification times are in seconds, so
+  // a directory modified in the second of its last listing is listed again.
+  // Requires the clocks of the secondary and of the file system of the WAL
+  // directory to agree, e.g. a local directory.
+  // Default: false
+  bool secondary_skip_unchanged_wal_dir = false;
+
   // The periodicity when obsolete files get deleted. The default
   // value is 6 hours. The files that get out of scope by compaction
   // process will still get automatically delete on every compaction,
@@ -864,6 +971,19 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   uint32_t max_subcompactions = 1;
 
+  // The number of key ranges a compaction with subcompactions is split into
+  // per subcompaction thread. With more than one, each thread compacts one
+  // range after another, taking the next range nobody has started yet, so a
+  // thread that finishes early takes over work that would otherwise wait for
+  // the slowest thread. This helps when some key ranges are much slower to
+  // compact than their size suggests, at the cost of more output files. A
+  // range still spans at least one target output file size.
+  //
+  // Default: 1 (one range per subcompaction thread)
+  //
+  // Dynamically changeable through SetDBOptions() API.
+  uint32_t subcompaction_ranges_per_thread = 1;
+
   // DEPRECATED: RocksDB automatically decides this based on the
   // value of max_background_jobs. For backwards compatibility we will set
   // `max_background_jobs = max_background_compactions + max_background_flushes`
@@ -961,6 +1081,19 @@ struct DBOptions {
   // Default: false
   bool allow_mmap_reads = false;
 
+  // With allow_mmap_reads, map table files with MAP_POPULATE so their pages
+  // are read ahead and mapped when the file is opened instead of faulting in
+  // on first access. Only takes effect on Linux.
+  // Default: false
+  bool populate_mmap_reads = false;
+
+  // With allow_mmap_reads, advise the kernel with MADV_HUGEPAGE to back the
+  // mappings of table files with transparent huge pages where the file
+  // system supports it, cutting TLB misses on large hot files. Only takes
+  // effect on Linux.
+  // Default: false
+  bool huge_pages_for_mmap_reads = false;
+
   // Allow the OS to mmap file for writing.
   // DB::SyncWAL() only works if this is set to false.
   // Default: false
@@ -1024,6 +1157,20 @@ struct DBOptions {
   // Default: 1MB
   size_t stats_history_buffer_size = 1024 * 1024;
 
+  // If set, receives a structured snapshot of the statistics, integer
+  // properties and compaction stats of the DB every stats_export_period_sec,
+  // with the counts since the previous snapshot. See
+  // rocksdb/stats_exporter.h.
+  //
+  // Default: null
+  std::shared_ptr<StatsExporter> stats_exporter = nullptr;
+
+  // The seconds between two snapshots for stats_exporter. Taking a snapshot
+  // is cheap enough for a period of 1.
+  //
+  // Default: 60
+  unsigned int stats_export_period_sec = 60;
+
   // If set true, will hint the underlying file system that the file
   // access pattern is random, when a sst file is opened.
   // Default: true
@@ -1058,6 +1205,16 @@ struct DBOptions {
   // Default: null
   std::shared_ptr<WriteBufferManager> write_buffer_manager = nullptr;
 
+  // Keeps the mem-tables of the DB, together with those of the other DBs
+  // given the same governor, a block cache and the memory of other
+  // components under one limit. See rocksdb/memory_governor.h. When set, its
+  // write buffer manager replaces write_buffer_manager, and the writes are
+  // delayed more and more as the mem-tables approach their limit, before
+  // they stall at it.
+  //
+  // Default: null
+  std::shared_ptr<MemoryGovernor> memory_governor = nullptr;
+
   // If non-zero, we perform bigger reads when doing compaction. If you're
   // running RocksDB on spinning disks, you should set this to at least 2MB.
   // That way RocksDB's compaction is doing sequential instead of random reads.
@@ -1067,6 +1224,19 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   size_t compaction_readahead_size = 2 * 1024 * 1024;
 
+  // If non-zero, each subcompaction reads and decompresses its input files on
+  // a separate thread, which runs up to this many bytes of decoded keys and
+  // values ahead of the thread that merges the entries and builds the output
+  // files. Reading then overlaps with merging, and with
+  // CompressionOptions::parallel_threads > 1 also compressing and writing
+  // run on their own threads, so a compaction is no longer bound by the
+  // speed of one core.
+  //
+  // Default: 0 (read on the compaction thread)
+  //
+  // Dynamically changeable through SetDBOptions() API.
+  size_t compaction_input_pipeline_size = 0;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -1198,6 +1368,19 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // If true, and enable_pipelined_write is true, a sync write syncs the WAL
+  // in the memtable writer queue instead of the WAL writer queue. The next
+  // write groups can then append to the WAL while it is being synced, and a
+  // single sync covers all the groups that reached the memtable writer queue
+  // by then, so throughput of sync writes is no longer bounded by one WAL
+  // sync per write group. A write is still synced before it is inserted
+  // into the memtable and before it returns.
+  //
+  // Has no effect with manual_wal_flush or allow_mmap_writes.
+  //
+  // Default: false
+  bool pipelined_wal_sync = false;
+
   // Setting unordered_write to true trades higher write throughput with
   // relaxing the immutability guarantee of snapshots. This violates the
   // repeatability one expects from ::Get from a snapshot, as well as
@@ -1224,6 +1407,22 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // If true, DB::GetSnapshot() hands out the same Snapshot to the callers
+  // that find no write published since it was taken, and ReleaseSnapshot()
+  // only drops a reference to it until the last caller releases it. Taking
+  // and releasing a snapshot then is mostly an atomic increment and
+  // decrement, without the DB mutex, which helps with many readers taking
+  // a snapshot per request. The DB mutex is still taken to add a snapshot
+  // after a write, and to drop one when its last caller releases it.
+  //
+  // A shared snapshot reports the unix time of its first caller, and the
+  // "rocksdb.num-snapshots" property counts it once. Snapshots of
+  // transactions, for write conflict checking or of WritePrepared
+  // transaction DBs, are never shared.
+  //
+  // Default: false
+  bool share_snapshots = false;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
   // is implemented only for SkipListFactory.  Concurrent memtable writes
@@ -1249,6 +1448,33 @@ struct DBOptions {
   // Default: 1 MB
   uint64_t max_write_batch_group_size_bytes = 1 << 20;
 
+  // If positive, the entries of a WriteBatch with at least this many entries
+  // are sorted by key for each column family before they are inserted into
+  // its memtable, which makes the inserts into a skip list memtable several
+  // times faster for a large batch of random keys. Does not apply to the
+  // batches written concurrently into the memtables (see
+  // allow_concurrent_memtable_write), to column families with
+  // inplace_update_support or max_successive_merges, nor to transactions
+  // that use one sequence number per batch (e.g. WritePrepared).
+  //
+  // Default: 0 (disabled)
+  size_t memtable_sorted_insert_threshold = 0;
+
+  // If true, a Put or Delete that is overwritten by a later Put or Delete of
+  // the same key in the same write group (one or more WriteBatches committed
+  // together) is not inserted into the memtable, which saves memtable space
+  // and flush work for workloads that repeatedly overwrite hot keys. The
+  // skipped entry still consumes its sequence number, and since no snapshot
+  // can be taken in the middle of a write group, reads see the same results.
+  // The entries are still written to the WAL. Keys with a SingleDelete,
+  // Merge, TimedPut, PutEntity or blob index in the same write group are
+  // never collapsed. Does not apply to the batches written concurrently into
+  // the memtables (see allow_concurrent_memtable_write), to column families
+  // with inplace_update_support, nor to transactions.
+  //
+  // Default: false
+  bool memtable_collapse_overwrites = false;
+
   // The maximum number of microseconds that a write operation will use
   // a yielding spin loop to coordinate with other write threads before
   // blocking on a mutex.  (Assuming write_thread_slow_yield_usec is
@@ -1268,6 +1494,16 @@ struct DBOptions {
   // Default: 3
   uint64_t write_thread_slow_yield_usec = 3;
 
+  // The maximum number of microseconds that the leader of a write group
+  // with sync writes waits for more writers to join the group before it
+  // writes and syncs the WAL, so that they share the sync. The leader only
+  // waits when, going by the recent rate of writes, another writer is
+  // expected in time, and never longer than recent WAL syncs took, or after
+  // as many writers as expected joined.
+  //
+  // Default: 0 (disabled)
+  uint64_t write_group_linger_usec = 0;
+
   // If true, then DB::Open() will not update the statistics used to optimize
   // compaction decision by loading table properties from many files.
   // Turning off this feature will improve DBOpen time especially in
@@ -1290,6 +1526,16 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // If non-zero, DB::Open() reads, checksums and decompresses the records of
+  // each WAL on a separate thread, which runs up to this many bytes of
+  // records ahead of the thread that inserts them into the memtables. The
+  // records are still inserted one after the other, in WAL order, so
+  // recovery is the same for every wal_recovery_mode; it just no longer
+  // waits for the reads of large WALs.
+  //
+  // Default: 0 (read on the recovering thread)
+  size_t wal_recovery_pipeline_size = 0;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1298,6 +1544,17 @@ struct DBOptions {
   // Default: nullptr (disabled)
   std::shared_ptr<RowCache> row_cache = nullptr;
 
+  // A cache for the results of DB::Get(), keyed by column family and user
+  // key. Unlike row_cache, a hit skips the memtables and all the levels. A
+  // write to a key invalidates its cached result, so it is only useful for
+  // hot keys read much more often than written. Gets with a read callback,
+  // user-defined timestamps, a non-default read_tier, or on column families
+  // with a compaction filter or FIFO compaction bypass the cache, as do all
+  // Gets when unordered_write is set. Other Get variants (MultiGet, GetEntity,
+  // GetMergeOperands) do not use it.
+  // Default: nullptr (disabled)
+  std::shared_ptr<Cache> point_lookup_cache = nullptr;
+
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
   // records, ignoring a particular record or skipping replay.
@@ -1374,6 +1631,17 @@ struct DBOptions {
   // the WAL is read.
   CompressionType wal_compression = kNoCompression;
 
+  // If non-zero and wal_compression is enabled, the records of each WAL
+  // are compressed with a dictionary: the first wal_compression_dict_bytes
+  // bytes of the records written to the previous WAL, which is stored at
+  // the start of the WAL. This helps WALs of small, similar records, such
+  // as repeated JSON documents. At most 16KB is used.
+  // The WALs can't be read by versions without WAL compression
+  // dictionaries.
+  //
+  // Default: 0 (disabled)
+  size_t wal_compression_dict_bytes = 0;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1600,6 +1868,50 @@ struct DBOptions {
   // persisted replication sequence, so the max limit here shouldn't be quite
   // large
   uint32_t max_num_replication_epochs = 100;
+
+  // Number of threads DB::ApplyReplicationLogRecords() inserts the memtable
+  // writes of a follower with, including the calling thread. The sequence
+  // numbers of the writes are assigned by the leader, so consecutive
+  // memtable writes are inserted concurrently and become visible together.
+  // Only used if allow_concurrent_memtable_write is true; writes with merges
+  // are inserted by the calling thread.
+  //
+  // Default: 1 (single-threaded)
+  uint32_t replication_apply_threads = 1;
+
+  // If non-zero and `statistics` is set, each thread times one in
+  // `perf_sample_one_in` of its Get() and Write() calls as if its perf level
+  // were kEnableTimeExceptForMutex, and records the time spent in their steps
+  // in the SAMPLED_* histograms, for an always-on latency breakdown at a
+  // fraction of the cost of the perf level. The timings in the perf context
+  // of the thread are not affected. Threads whose perf level already times
+  // operations (kEnableWait or higher) are not sampled.
+  //
+  // Default: 0 (no sampling)
+  uint32_t perf_sample_one_in = 0;
+
+  // If non-zero, the table readers of up to `max_pinned_table_readers` files
+  // of the current versions of the column families are pinned in the metadata
+  // of their file when the file is added to a version, whatever the usage of
+  // the table cache. Reads of a pinned file use its reader without looking it
+  // up in the table cache. A pinned reader is only released, and the room it
+  // took given to the files added next, once no version has its file
+  // anymore. Pinned readers do not count against max_open_files.
+  // If zero, a file is pinned when it is added only if the table cache is
+  // less than a quarter full (always if max_open_files is -1).
+  //
+  // Default: 0
+  uint32_t max_pinned_table_readers = 0;
+
+  // Number of threads the iterators of DB::NewMultiCfIterator() seek their
+  // column families with, including the calling thread. The iterator of
+  // each column family still seeks on one thread, so this helps when the
+  // seeks of many column families wait on reads from storage. The helper
+  // threads are started when the DB is opened and shared by all the
+  // iterators of the DB.
+  //
+  // Default: 1 (the column families are sought one after the other)
+  uint32_t multi_cf_iterator_seek_threads = 1;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1777,6 +2089,14 @@ struct ReadOptions {
   // of forward iteration on spinning disks.
   size_t readahead_size = 0;
 
+  // If nonzero, the iterator reads this many bytes ahead in each blob file
+  // it reads values from (see AdvancedColumnFamilyOptions::enable_blob_files).
+  // Since flushes and compactions write the blobs in key order, a forward
+  // scan then reads the blob files in chunks of this size instead of with
+  // one read per value. With async_io, half of the readahead is read
+  // asynchronously.
+  size_t blob_readahead_size = 0;
+
   // A threshold for the number of keys that can be skipped before failing an
   // iterator seek as incomplete. The default value of 0 should be used to
   // never fail a request as incomplete, even on skipping too many keys.
@@ -1897,6 +2217,15 @@ struct ReadOptions {
   // Default: empty (every table will be scanned)
   std::function<bool(const TableProperties&)> table_filter;
 
+  // If non-null, iterators only materialize the wide columns named here of
+  // the entities they read: columns() has only those columns, and value() is
+  // the default column of an entity only if it is named here. The values of
+  // the other columns are skipped rather than decoded. Plain key-values are
+  // not affected. The names need not be sorted, and must outlive the
+  // iterators. This option only affects Iterators.
+  // Default: nullptr (all columns)
+  const std::vector<Slice>* column_projection = nullptr;
+
   // If auto_readahead_size is set to true, it will auto tune the readahead_size
   // during scans internally.
   // For this feature to enabled, iterate_upper_bound must also be specified.
@@ -2223,6 +2552,16 @@ struct IngestExternalFileOptions {
   //
   // XXX: "bottommost" is obsolete/confusing terminology to refer to last level
   bool fail_if_not_bottommost_level = false;
+
+  // The number of threads that prepare the files of one ingestion before it
+  // is applied: they read and validate the files (see
+  // verify_checksums_before_ingest), link or copy them into the DB and
+  // generate their checksums (see verify_file_checksum). The threads are
+  // started for the ingestion, on top of the calling thread. Values below 2
+  // prepare the files one after the other on the calling thread.
+  //
+  // Default: 1
+  int prepare_threads = 1;
 };
 
 enum TraceFilterType : uint64_t {
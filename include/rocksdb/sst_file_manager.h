@@ -78,6 +78,17 @@ class SstFileManager {
   // thread-safe
   virtual void SetMaxTrashDBRatio(double ratio) = 0;
 
+  // Return the number of background threads that delete trash files
+  // thread-safe
+  virtual int GetDeleteThreads() = 0;
+
+  // Update the number of background threads that delete trash files. The
+  // threads share the delete rate limit, so more of them only help when a
+  // single one cannot keep up with it, e.g. when deleting a file is slow on
+  // the file system.
+  // thread-safe
+  virtual void SetDeleteThreads(int num_threads) = 0;
+
   // Return the total size of trash files
   // thread-safe
   virtual uint64_t GetTotalTrashSize() = 0;
@@ -529,6 +529,64 @@ enum Tickers : uint32_t {
   // Footer corruption detected when opening an SST file for reading
   SST_FOOTER_CORRUPTION_COUNT,
 
+  // RocksDB-Cloud contribution begin
+
+  // Number of requests to the cloud storage provider, by type, in the order
+  // of CloudRequestOpType. Recorded when CloudFileSystemOptions::statistics
+  // is set.
+  CLOUD_READ_REQUESTS,    // GET
+  CLOUD_WRITE_REQUESTS,   // PUT, multipart upload parts
+  CLOUD_LIST_REQUESTS,    // LIST
+  CLOUD_CREATE_REQUESTS,  // bucket creation, multipart upload creation
+  CLOUD_DELETE_REQUESTS,  // DELETE
+  CLOUD_COPY_REQUESTS,    // COPY
+  CLOUD_INFO_REQUESTS,    // HEAD
+  // Number of cloud requests that failed, after their retries
+  CLOUD_REQUEST_FAILURES,
+  // Bytes read and written by cloud requests
+  CLOUD_READ_BYTES,
+  CLOUD_WRITE_BYTES,
+  // Number of times the cloud client retried a failed request, and how many
+  // of them were throttled by the provider
+  CLOUD_REQUEST_RETRIES,
+  CLOUD_REQUEST_THROTTLES,
+  // Number of cloud requests delayed by the client-side limit on the request
+  // rate (see CloudFileSystemOptions::s3_adaptive_throttling), and the total
+  // duration of the delays
+  CLOUD_REQUEST_THROTTLE_DELAYS,
+  CLOUD_REQUEST_THROTTLE_DELAY_MICROS,
+
+  // Number and total size of the replication log records a follower applied
+  // with DB::ApplyReplicationLogRecord(s)
+  REPLICATION_RECORDS_APPLIED,
+  REPLICATION_BYTES_APPLIED,
+
+  // Number of Gets answered, and not answered, by
+  // DBOptions::point_lookup_cache
+  POINT_LOOKUP_CACHE_HIT,
+  POINT_LOOKUP_CACHE_MISS,
+
+  // Number of iterator seeks checked against the range filter of a table
+  // file (see BlockBasedTableOptions::range_filter_bits_per_key), and number
+  // of those that skipped the file because its range filter had no key in
+  // the range of the seek
+  RANGE_FILTER_CHECKED,
+  RANGE_FILTER_USEFUL,
+
+  // Number of point lookups of a key checked against the level filter of a
+  // table file (see AdvancedColumnFamilyOptions::level_filter_bits_per_key),
+  // and number of those that skipped the file because its level filter
+  // ruled out the key
+  LEVEL_FILTER_CHECKED,
+  LEVEL_FILTER_USEFUL,
+
+  // Number of data blocks that iterators reading at ReadOptions::timestamp
+  // stepped over because they hold no version that old (see
+  // BlockBasedTableOptions::block_timestamp_index)
+  TIMESTAMP_FILTER_BLOCK_FILTERED,
+
+  // RocksDB-Cloud contribution end
+
   TICKER_ENUM_MAX
 };
 
@@ -662,6 +720,40 @@ enum Histograms : uint32_t {
   // system's prefetch) from the end of SST table during block based table open
   TABLE_OPEN_PREFETCH_TAIL_READ_BYTES,
 
+  // RocksDB-Cloud contribution begin
+
+  // Latency of the requests to the cloud storage provider, by type, in the
+  // order of CloudRequestOpType, including their retries
+  CLOUD_READ_MICROS,
+  CLOUD_WRITE_MICROS,
+  CLOUD_LIST_MICROS,
+  CLOUD_CREATE_MICROS,
+  CLOUD_DELETE_MICROS,
+  CLOUD_COPY_MICROS,
+  CLOUD_INFO_MICROS,
+
+  // Time a follower takes to apply replication log records, by type. A run of
+  // consecutive kMemtableWrite records is applied, and recorded, at once.
+  REPLICATION_MEMTABLE_WRITE_APPLY_MICROS,
+  REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS,
+  REPLICATION_MANIFEST_WRITE_APPLY_MICROS,
+  // Time a follower spends switching memtables for a kMemtableSwitch record
+  REPLICATION_SWITCH_MEMTABLE_MICROS,
+
+  // Time spent in the steps of the Get() and Write() operations sampled with
+  // DBOptions::perf_sample_one_in, as timed by the matching PerfContext
+  // fields
+  SAMPLED_GET_SNAPSHOT_MICROS,
+  SAMPLED_GET_FROM_MEMTABLE_MICROS,
+  SAMPLED_GET_FROM_FILES_MICROS,
+  SAMPLED_GET_BLOCK_READ_MICROS,
+  SAMPLED_WRITE_THREAD_WAIT_MICROS,
+  SAMPLED_WRITE_DELAY_MICROS,
+  SAMPLED_WRITE_WAL_MICROS,
+  SAMPLED_WRITE_MEMTABLE_MICROS,
+
+  // RocksDB-Cloud contribution end
+
   HISTOGRAM_ENUM_MAX
 };
 
@@ -681,6 +773,14 @@ struct HistogramData {
   double min = 0.0;
 };
 
+// The cumulative counts of a Statistics, from which
+// Statistics::getStatsDelta() computes the counts since. Opaque to the
+// caller.
+struct StatisticsSnapshot {
+  std::vector<uint64_t> tickers;
+  std::vector<std::vector<uint64_t>> histograms;
+};
+
 // StatsLevel can be used to reduce statistics overhead by skipping certain
 // types of stats in the stats collection process.
 // Usage:
@@ -773,6 +873,20 @@ class Statistics : public Customizable {
     return false;
   }
 
+  // For exporters that scrape often: fills *tickers and *histograms, by
+  // name, with the ticker counts and the histograms of the values recorded
+  // since *snapshot was taken, and then updates *snapshot. A snapshot that
+  // was never updated gives the totals. Unlike getAndResetTickerCount(), a
+  // scrape only reads the per-core counts, once each, so it doesn't contend
+  // with the threads that record, and several exporters don't interfere.
+  // The min and max of a histogram of the delta are bounded by its buckets.
+  virtual Status getStatsDelta(
+      StatisticsSnapshot* /*snapshot*/,
+      std::map<std::string, uint64_t>* /*tickers*/,
+      std::map<std::string, HistogramData>* /*histograms*/) const {
+    return Status::NotSupported("getStatsDelta");
+  }
+
   // Override this function to disable particular histogram collection
   virtual bool HistEnabledForType(uint32_t type) const {
     return type < HISTOGRAM_ENUM_MAX;
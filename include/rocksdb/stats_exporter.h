@@ -0,0 +1,84 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// StatsExporter receives structured snapshots of the metrics of a DB every
+// DBOptions::stats_export_period_sec, for monitoring systems to scrape,
+// rather than the text that stats_dump_period_sec dumps to the LOG.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/statistics.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The compactions whose output level is a level of a column family
+struct CompactionExportStats {
+  uint64_t count = 0;
+  uint64_t micros = 0;
+  uint64_t cpu_micros = 0;
+  // From the table files of all the input levels, and from blob files
+  uint64_t bytes_read = 0;
+  // To table and blob files
+  uint64_t bytes_written = 0;
+  // By trivial moves
+  uint64_t bytes_moved = 0;
+  uint64_t input_records = 0;
+  uint64_t dropped_records = 0;
+};
+
+// A snapshot of the metrics of a DB. The counts are the ones since the
+// previous snapshot of the DB, the totals in the first one.
+struct ExportedStats {
+  // When the snapshot was taken, by the clock of the DB, and the time since
+  // the previous one (0 for the first)
+  uint64_t time_micros = 0;
+  uint64_t interval_micros = 0;
+
+  // The tickers and histograms of DBOptions::statistics, by name, see
+  // Statistics::getStatsDelta(). They include the cloud request metrics of a
+  // cloud file system that records into the same Statistics. Empty without
+  // statistics.
+  std::map<std::string, uint64_t> tickers;
+  std::map<std::string, HistogramData> histograms;
+
+  // The current values of the integer properties of
+  // StatsExporter::GetIntProperties(), summed over the column families as by
+  // DB::GetAggregatedIntProperty()
+  std::map<std::string, uint64_t> int_properties;
+
+  // The compactions, by column family name, then by output level
+  std::map<std::string, std::vector<CompactionExportStats>> compactions;
+};
+
+// Receives the snapshots of a DB, or of several DBs that share it. The
+// snapshots of a DB are taken and exported one at a time, on the thread of
+// the periodic tasks of all the DBs of the process, so Export() should hand
+// the stats off rather than block.
+//
+// Exceptions MUST NOT propagate out of overridden functions into RocksDB,
+// because RocksDB is not exception-safe.
+class StatsExporter {
+ public:
+  virtual ~StatsExporter() {}
+
+  virtual const char* Name() const = 0;
+
+  // The integer properties of the column families to export, e.g.
+  // DB::Properties::kEstimateNumKeys. By default, the sizes of the memtables
+  // and of the live SST files, the number of immutable memtables, and the
+  // estimates of the keys and of the pending compaction bytes.
+  virtual std::vector<std::string> GetIntProperties() const;
+
+  // db_name is the name the DB was opened with
+  virtual void Export(const std::string& db_name,
+                      const ExportedStats& stats) = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
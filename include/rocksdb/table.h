@@ -248,6 +248,34 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, a data block read into memory also keeps the first 8 bytes of
+  // the user key of each of its restart points in a contiguous array. A seek
+  // in the block then narrows down its binary search with integer compares
+  // on that array before decoding any key. Costs 8 bytes of memory per
+  // restart point (see block_restart_interval). Only used with the bytewise
+  // comparator, and doesn't change the file format.
+  bool data_block_restart_key_prefixes = false;
+
+  // If true, an index block read into memory also fits a piecewise-linear
+  // model from the first 8 bytes of the user key of each restart point to
+  // its position. A seek in the block evaluates the model and binary
+  // searches only the few restart points around the prediction. Works best
+  // with evenly spread keys, such as fixed-width ids or timestamps. Costs 8
+  // bytes of memory per restart point (see index_block_restart_interval),
+  // plus the model. Not used with the hash index or a comparator other than
+  // the bytewise comparator, and doesn't change the file format.
+  bool index_block_restart_key_model = false;
+
+  // If true and DBOptions::allow_mmap_reads is set, blocks stored
+  // uncompressed are inserted into the block cache as they are read,
+  // referencing the mapped file instead of a copy. They are charged only the
+  // size of their in-memory structures, not the size of the block, and are
+  // never saved to a secondary cache. Such entries are only found by the
+  // table reader that inserted them, so a reopened file (or one warmed up by
+  // prepopulate_block_cache) starts out cold. Without this, blocks read from
+  // mapped files are parsed again on every access.
+  bool cache_mmap_read_blocks = false;
+
   // Option hash_index_allow_collision is now deleted.
   // It will behave as if hash_index_allow_collision=true.
 
@@ -448,6 +476,42 @@ struct BlockBasedTableOptions {
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
 
+  // If positive, each table file gets a range filter, which lets iterator
+  // seeks skip the file without reading its index or data blocks when it has
+  // no key between the seek target and ReadOptions::iterate_upper_bound
+  // (iterate_lower_bound for SeekForPrev). This helps short range scans
+  // with bounds, which filter_policy doesn't help unless they stay within a
+  // prefix of prefix_extractor.
+  //
+  // The filter stores, in a Bloom filter, the 8 bytes of each user key
+  // that follow the prefix that all the keys of the file share, at several
+  // resolutions. It takes about this many bits for each distinct such
+  // value, more for keys spread far apart, and is held in memory while the
+  // file is open, outside of the block cache. Each Bloom probe has the false
+  // positive rate of a Bloom filter with this many bits per key, and a seek
+  // takes up to 64 probes, fewer for shorter ranges. Ranges that the 8 bytes
+  // cannot tell apart from a key of the file are never skipped.
+  //
+  // Only used with the bytewise comparator. Files written without this
+  // option are read as before.
+  //
+  // Default: 0 (disabled)
+  double range_filter_bits_per_key = 0;
+
+  // If true, and the comparator has a user-defined timestamp that is
+  // persisted (see AdvancedColumnFamilyOptions::
+  // persist_user_defined_timestamps), each table file records the smallest
+  // timestamp of each of its data blocks. Iterators reading at an old
+  // ReadOptions::timestamp then step over the data blocks holding only
+  // newer versions, without reading them, instead of scanning past every
+  // one of their entries. The timestamps take 8 bytes plus the timestamp
+  // size for each data block, held in memory while the file is open.
+  //
+  // Files written without this option are read as before.
+  //
+  // Default: false
+  bool block_timestamp_index = false;
+
   // If true, detect corruption during Bloom Filter (format_version >= 5)
   // and Ribbon Filter construction.
   //
@@ -519,6 +583,12 @@ struct BlockBasedTableOptions {
   // misplaced within or between files is as likely to fail checksum
   // verification as random corruption. Also checksum-protects SST footer.
   // Can be read by RocksDB versions >= 8.6.0.
+  // 7 -- The keys of the restart points of data and index blocks, other than
+  // the first of each block, drop the prefix they share with the first key
+  // of the block. Long key prefixes common to a block are then stored once
+  // per block instead of once per restart point, which mostly shrinks index
+  // blocks, where every entry is a restart point by default
+  // (index_block_restart_interval = 1).
   //
   // Using the default setting of format_version is strongly recommended, so
   // that available enhancements are adopted eventually and automatically. The
@@ -616,6 +686,13 @@ struct BlockBasedTableOptions {
     kDisable,
     // Prepopulate blocks during flush only.
     kFlushOnly,
+    // Prepopulate blocks during flush, like kFlushOnly, and during
+    // compaction, the data blocks whose key ranges overlap the data blocks of
+    // the compaction inputs that were in the block cache when the compaction
+    // started. The compaction evicts the cached blocks of its inputs sooner
+    // or later, so this keeps the reads of the hot key ranges from missing
+    // the cache once the output files replace the inputs.
+    kFlushAndHotCompaction,
   };
 
   PrepopulateBlockCache prepopulate_block_cache =
@@ -669,6 +746,19 @@ struct BlockBasedTableOptions {
   //
   // Default: 2
   uint64_t num_file_reads_for_auto_readahead = 2;
+
+  // If true, each table file learns how many bytes its iterators usually
+  // read sequentially, and the implicit auto-readahead of new iterators on
+  // the file starts at that size (at most max_auto_readahead_size) instead
+  // of initial_auto_readahead_size. Short scans then read ahead less, and
+  // long scans do not have to ramp up again on every iterator. Files start
+  // at initial_auto_readahead_size until an iterator over them is done.
+  //
+  // Has no effect on explicit readahead (ReadOptions::readahead_size) and on
+  // compactions.
+  //
+  // Default: false
+  bool learned_auto_readahead = false;
 };
 
 // Table Properties that are specific to block-based table properties.
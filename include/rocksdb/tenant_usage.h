@@ -0,0 +1,64 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The resources a tenant is charged for
+enum TenantUsageType : uint32_t {
+  // Bytes of table blocks read from the files, for reads and compactions
+  kTenantSstBytesRead = 0,
+  // Charge of the table blocks inserted into the block cache
+  kTenantBlockCacheBytesInserted,
+  // Bytes of the table and blob files written by flushes
+  kTenantFlushBytesWritten,
+  // Bytes of the table and blob files written by compactions
+  kTenantCompactionBytesWritten,
+  // CPU time of the compactions
+  kTenantCompactionCpuMicros,
+  kTenantUsageTypeMax
+};
+
+// The resources used on behalf of a tenant by the column families tagged
+// with it (ColumnFamilyOptions::tenant_usage), which may belong to any number
+// of DB instances sharing caches and background threads. The counters are
+// kept per core, so charging them does not contend across threads.
+//
+// This is NOT an extensible interface but a public interface for result of
+// NewTenantUsage. Any derived classes must be RocksDB internal.
+class TenantUsage {
+ public:
+  virtual ~TenantUsage() {}
+
+  // Returns the name of the tenant
+  virtual const std::string& GetName() const = 0;
+
+  // Returns the amount of `type` used by the tenant since its creation or
+  // the last Reset()
+  virtual uint64_t Get(TenantUsageType type) const = 0;
+
+  virtual void Reset() = 0;
+
+  // Returns the counters as "name=value" pairs separated by spaces
+  virtual std::string ToString() const = 0;
+
+  // Charges `value` of `type` to the tenant. Called by RocksDB.
+  virtual void Add(TenantUsageType type, uint64_t value) = 0;
+};
+
+// Create a TenantUsage that can be shared with multiple CFs across RocksDB
+// instances to account for the resources they use.
+//
+// @param name: Name of the tenant.
+TenantUsage* NewTenantUsage(const std::string& name);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -81,6 +81,15 @@ class CompactionOptionsUniversal {
   // Default: false
   bool incremental;
 
+  // If true, a compaction to a level other than level 0 is split by key range
+  // into subcompactions even with max_subcompactions <= 1, and, like the
+  // compactions of kRoundRobin in leveled compaction, takes idle background
+  // compaction threads (within max_background_compactions) for up to one
+  // subcompaction per input file. A large merge of sorted runs then runs in
+  // parallel instead of holding back the compactions of newer runs.
+  // Default: false
+  bool reserve_threads_for_subcompactions;
+
   // Default set of parameters
   CompactionOptionsUniversal()
       : size_ratio(1),
@@ -90,7 +99,8 @@ class CompactionOptionsUniversal {
         compression_size_percent(-1),
         stop_style(kCompactionStopStyleTotalSize),
         allow_trivial_move(false),
-        incremental(false) {}
+        incremental(false),
+        reserve_threads_for_subcompactions(false) {}
 };
 
 }  // namespace ROCKSDB_NAMESPACE
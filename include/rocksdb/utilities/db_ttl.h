@@ -32,6 +32,8 @@ namespace ROCKSDB_NAMESPACE {
 //          Open2 at t=3 with ttl=5. Now k1,k2 should be deleted at t>=5
 // read_only=true opens in the usual read-only mode. Compactions will not be
 //  triggered(neither manual nor automatic), so no expired entries removed
+// DropExpiredFiles() deletes the files whose values have all expired without
+//  waiting for a compaction to reach them
 //
 // CONSTRAINTS:
 // Not specifying/passing or non-positive TTL behaves like TTL = infinity
@@ -63,6 +65,14 @@ class DBWithTTL : public StackableDB {
 
   virtual void SetTtl(ColumnFamilyHandle* h, int32_t ttl) = 0;
 
+  // Deletes the table files of the column family whose values have all
+  // expired, as a whole and without compacting them. Only the files written
+  // since their column family is opened with this API, and holding no
+  // deletion, can be dropped this way; the others are left to compactions.
+  virtual Status DropExpiredFiles() = 0;
+
+  virtual Status DropExpiredFiles(ColumnFamilyHandle* h) = 0;
+
  protected:
   explicit DBWithTTL(DB* db) : StackableDB(db) {}
 };
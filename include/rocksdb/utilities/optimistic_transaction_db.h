@@ -80,6 +80,20 @@ struct OptimisticTransactionDBOptions {
   // an OccLockBuckets will be created using the count in occ_lock_buckets.
   // See MakeSharedOccLockBuckets()
   std::shared_ptr<OccLockBuckets> shared_lock_buckets;
+
+  // If positive and validate_policy == OccValidationPolicy::kValidateParallel,
+  // transactions are validated against a table of this many slots holding
+  // the sequence number of the latest write to the keys hashing to them,
+  // which the writes through this DB keep up to date, instead of by looking
+  // up their keys in the memtables. Validation then costs one table lookup
+  // per key, and does not need the memtable history that
+  // max_write_buffer_size_to_maintain otherwise has to keep around (and that
+  // Open() then leaves disabled). Keys sharing a slot may cause false
+  // conflicts, which more slots make rarer, at 8 bytes per slot.
+  //
+  // REQUIRES: all writes go through this DB (not through GetBaseDB() or
+  // GetRootDB()), and no column family uses user-defined timestamps.
+  size_t recent_writes_slots = 0;
 };
 
 // Range deletions (including those in `WriteBatch`es passed to `Write()`) are
@@ -0,0 +1,49 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <functional>
+
+#include "rocksdb/db.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct ParallelScanOptions {
+  // Number of threads that scan the range, including the calling thread
+  int threads = 4;
+
+  // Number of partitions the range is split into, at the boundaries of the
+  // SST files of the column family, weighted by their sizes. 0 means four
+  // per thread.
+  int max_partitions = 0;
+
+  // If true, the callback gets the entries in key order from one thread at
+  // a time. The partitions ahead of the one being delivered are buffered in
+  // memory, at most threads - 1 of them at once.
+  // If false, the callback is called from all the threads at once, in key
+  // order within a partition only.
+  bool ordered = false;
+};
+
+// Called with each entry of the scan. The slices are only valid during the
+// call. Returning false stops the scan.
+using ParallelScanCallback =
+    std::function<bool(const Slice& key, const Slice& value)>;
+
+// Reads the entries of column_family in [begin, end) with several
+// iterators at once, all with the same snapshot: read_options.snapshot, or
+// one taken for the scan. A null begin (end) starts (ends) the scan at the
+// first (last) key. The iterate bounds of read_options are replaced with
+// those of each partition.
+//
+// Returns the first error of the iterators, or OK, including when the
+// callback stopped the scan.
+Status ParallelScan(DB* db, const ReadOptions& read_options,
+                    ColumnFamilyHandle* column_family, const Slice* begin,
+                    const Slice* end, const ParallelScanOptions& options,
+                    const ParallelScanCallback& callback);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -536,6 +536,15 @@ class StackableDB : public DB {
         record, replication_sequence, std::move(cf_options_factory),
         snapshot_replication_epoch, info, flags);
   }
+  Status ApplyReplicationLogRecords(
+      std::vector<ReplicationLogRecordAndSequence> records,
+      CFOptionsFactory cf_options_factory, uint64_t snapshot_replication_epoch,
+      ApplyReplicationLogRecordInfo* info, unsigned flags,
+      size_t* num_applied) override {
+    return db_->ApplyReplicationLogRecords(
+        std::move(records), std::move(cf_options_factory),
+        snapshot_replication_epoch, info, flags, num_applied);
+  }
   Status GetReplicationRecordDebugString(const ReplicationLogRecord& record,
                                          std::string* out) const override {
     return db_->GetReplicationRecordDebugString(record, out);
@@ -13,6 +13,8 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "include/org_rocksdb_RocksIterator.h"
 #include "rocksjni/portal.h"
@@ -339,6 +341,49 @@ jint Java_org_rocksdb_RocksIterator_valueDirect0(JNIEnv* env, jclass /*jcls*/,
                                                   jtarget_off, jtarget_len);
 }
 
+/*
+ * Class:     org_rocksdb_RocksIterator
+ * Method:    nextBatchDirect0
+ * Signature: (JLjava/nio/ByteBuffer;II[I)I
+ */
+jint Java_org_rocksdb_RocksIterator_nextBatchDirect0(
+    JNIEnv* env, jclass /*jcls*/, jlong handle, jobject jtarget,
+    jint jtarget_off, jint jtarget_len, jintArray jlengths) {
+  auto* it = reinterpret_cast<ROCKSDB_NAMESPACE::Iterator*>(handle);
+  char* target = reinterpret_cast<char*>(env->GetDirectBufferAddress(jtarget));
+  if (target == nullptr ||
+      env->GetDirectBufferCapacity(jtarget) < (jtarget_off + jtarget_len)) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env,
+                                                     "Invalid target argument");
+    return 0;
+  }
+  target += jtarget_off;
+
+  // The entries are copied straight from the blocks the iterator pins
+  const size_t max_lengths = 2 * (env->GetArrayLength(jlengths) / 2);
+  std::vector<jint> lengths;
+  size_t left = static_cast<size_t>(jtarget_len);
+  while (lengths.size() < max_lengths && it->Valid()) {
+    ROCKSDB_NAMESPACE::Slice key = it->key();
+    ROCKSDB_NAMESPACE::Slice value = it->value();
+    if (key.size() + value.size() > left) {
+      break;
+    }
+    memcpy(target, key.data(), key.size());
+    memcpy(target + key.size(), value.data(), value.size());
+    target += key.size() + value.size();
+    left -= key.size() + value.size();
+    lengths.push_back(static_cast<jint>(key.size()));
+    lengths.push_back(static_cast<jint>(value.size()));
+    it->Next();
+  }
+  if (!lengths.empty()) {
+    env->SetIntArrayRegion(jlengths, 0, static_cast<jsize>(lengths.size()),
+                           lengths.data());
+  }
+  return static_cast<jint>(lengths.size() / 2);
+}
+
 /*
  * This method supports fetching into indirect byte buffers;
  * the Java wrapper extracts the byte[] and passes it here.
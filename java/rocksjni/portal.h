@@ -5269,6 +5269,52 @@ class TickerTypeJni {
         return -0x53;
       case ROCKSDB_NAMESPACE::Tickers::SST_FOOTER_CORRUPTION_COUNT:
         return -0x55;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_REQUESTS:
+        return -0x56;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_REQUESTS:
+        return -0x57;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_LIST_REQUESTS:
+        return -0x58;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_CREATE_REQUESTS:
+        return -0x59;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_DELETE_REQUESTS:
+        return -0x5A;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_COPY_REQUESTS:
+        return -0x5B;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_INFO_REQUESTS:
+        return -0x5C;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_FAILURES:
+        return -0x5D;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_BYTES:
+        return -0x5E;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_BYTES:
+        return -0x5F;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_RETRIES:
+        return -0x60;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLES:
+        return -0x61;
+      case ROCKSDB_NAMESPACE::Tickers::REPLICATION_RECORDS_APPLIED:
+        return -0x62;
+      case ROCKSDB_NAMESPACE::Tickers::REPLICATION_BYTES_APPLIED:
+        return -0x63;
+      case ROCKSDB_NAMESPACE::Tickers::POINT_LOOKUP_CACHE_HIT:
+        return -0x64;
+      case ROCKSDB_NAMESPACE::Tickers::POINT_LOOKUP_CACHE_MISS:
+        return -0x65;
+      case ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_CHECKED:
+        return -0x66;
+      case ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_USEFUL:
+        return -0x67;
+      case ROCKSDB_NAMESPACE::Tickers::LEVEL_FILTER_CHECKED:
+        return -0x68;
+      case ROCKSDB_NAMESPACE::Tickers::LEVEL_FILTER_USEFUL:
+        return -0x69;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLE_DELAYS:
+        return -0x6A;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLE_DELAY_MICROS:
+        return -0x6B;
+      case ROCKSDB_NAMESPACE::Tickers::TIMESTAMP_FILTER_BLOCK_FILTERED:
+        return -0x6C;
       case ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // -0x54 is the max value at this time. Since these values are exposed
         // directly to Java clients, we'll keep the value the same till the next
@@ -5726,6 +5772,52 @@ class TickerTypeJni {
         return ROCKSDB_NAMESPACE::Tickers::PREFETCH_HITS;
       case -0x55:
         return ROCKSDB_NAMESPACE::Tickers::SST_FOOTER_CORRUPTION_COUNT;
+      case -0x56:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_REQUESTS;
+      case -0x57:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_REQUESTS;
+      case -0x58:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_LIST_REQUESTS;
+      case -0x59:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_CREATE_REQUESTS;
+      case -0x5A:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_DELETE_REQUESTS;
+      case -0x5B:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_COPY_REQUESTS;
+      case -0x5C:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_INFO_REQUESTS;
+      case -0x5D:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_FAILURES;
+      case -0x5E:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_BYTES;
+      case -0x5F:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_BYTES;
+      case -0x60:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_RETRIES;
+      case -0x61:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLES;
+      case -0x62:
+        return ROCKSDB_NAMESPACE::Tickers::REPLICATION_RECORDS_APPLIED;
+      case -0x63:
+        return ROCKSDB_NAMESPACE::Tickers::REPLICATION_BYTES_APPLIED;
+      case -0x64:
+        return ROCKSDB_NAMESPACE::Tickers::POINT_LOOKUP_CACHE_HIT;
+      case -0x65:
+        return ROCKSDB_NAMESPACE::Tickers::POINT_LOOKUP_CACHE_MISS;
+      case -0x66:
+        return ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_CHECKED;
+      case -0x67:
+        return ROCKSDB_NAMESPACE::Tickers::RANGE_FILTER_USEFUL;
+      case -0x68:
+        return ROCKSDB_NAMESPACE::Tickers::LEVEL_FILTER_CHECKED;
+      case -0x69:
+        return ROCKSDB_NAMESPACE::Tickers::LEVEL_FILTER_USEFUL;
+      case -0x6A:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLE_DELAYS;
+      case -0x6B:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLE_DELAY_MICROS;
+      case -0x6C:
+        return ROCKSDB_NAMESPACE::Tickers::TIMESTAMP_FILTER_BLOCK_FILTERED;
       case -0x54:
         // -0x54 is the max value at this time. Since these values are exposed
         // directly to Java clients, we'll keep the value the same till the next
@@ -5880,6 +5972,47 @@ class HistogramTypeJni {
         return 0x3C;
       case ROCKSDB_NAMESPACE::Histograms::TABLE_OPEN_PREFETCH_TAIL_READ_BYTES:
         return 0x3D;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_READ_MICROS:
+        return 0x3F;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_WRITE_MICROS:
+        return 0x40;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_LIST_MICROS:
+        return 0x41;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_CREATE_MICROS:
+        return 0x42;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_DELETE_MICROS:
+        return 0x43;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_COPY_MICROS:
+        return 0x44;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_INFO_MICROS:
+        return 0x45;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MEMTABLE_WRITE_APPLY_MICROS:
+        return 0x46;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS:
+        return 0x47;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MANIFEST_WRITE_APPLY_MICROS:
+        return 0x48;
+      case ROCKSDB_NAMESPACE::Histograms::REPLICATION_SWITCH_MEMTABLE_MICROS:
+        return 0x49;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_SNAPSHOT_MICROS:
+        return 0x4A;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FROM_MEMTABLE_MICROS:
+        return 0x4B;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FROM_FILES_MICROS:
+        return 0x4C;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_BLOCK_READ_MICROS:
+        return 0x4D;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_THREAD_WAIT_MICROS:
+        return 0x4E;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_DELAY_MICROS:
+        return 0x4F;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_WAL_MICROS:
+        return 0x50;
+      case ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_MEMTABLE_MICROS:
+        return 0x51;
       case ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x3D for backwards compatibility on current minor version.
         return 0x3E;
@@ -6024,6 +6157,48 @@ class HistogramTypeJni {
       case 0x3D:
         return ROCKSDB_NAMESPACE::Histograms::
             TABLE_OPEN_PREFETCH_TAIL_READ_BYTES;
+      case 0x3F:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_READ_MICROS;
+      case 0x40:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_WRITE_MICROS;
+      case 0x41:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_LIST_MICROS;
+      case 0x42:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_CREATE_MICROS;
+      case 0x43:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_DELETE_MICROS;
+      case 0x44:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_COPY_MICROS;
+      case 0x45:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_INFO_MICROS;
+      case 0x46:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MEMTABLE_WRITE_APPLY_MICROS;
+      case 0x47:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS;
+      case 0x48:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MANIFEST_WRITE_APPLY_MICROS;
+      case 0x49:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_SWITCH_MEMTABLE_MICROS;
+      case 0x4A:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_SNAPSHOT_MICROS;
+      case 0x4B:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FROM_MEMTABLE_MICROS;
+      case 0x4C:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_FROM_FILES_MICROS;
+      case 0x4D:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_GET_BLOCK_READ_MICROS;
+      case 0x4E:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_THREAD_WAIT_MICROS;
+      case 0x4F:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_DELAY_MICROS;
+      case 0x50:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_WAL_MICROS;
+      case 0x51:
+        return ROCKSDB_NAMESPACE::Histograms::SAMPLED_WRITE_MEMTABLE_MICROS;
       case 0x3E:
         // 0x1F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
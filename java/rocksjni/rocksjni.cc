@@ -1817,6 +1817,93 @@ void Java_org_rocksdb_RocksDB_multiGet__JJ_3J_3Ljava_nio_ByteBuffer_2_3I_3I_3Lja
       env, values, statuses, jvalues, jvalues_sizes, jstatus_objects);
 }
 
+/*
+ * MultiGet() of keys packed in a direct buffer, copying the values found
+ * into another one without creating any Java object per key or value
+ *
+ * Class:     org_rocksdb_RocksDB
+ * Method:    multiGetDirect
+ * Signature: (JJJLjava/nio/ByteBuffer;[I[ILjava/nio/ByteBuffer;II[I)I
+ */
+jint Java_org_rocksdb_RocksDB_multiGetDirect(
+    JNIEnv* env, jclass, jlong jdb_handle, jlong jropt_handle,
+    jlong jcf_handle, jobject jkeys, jintArray jkey_offs, jintArray jkey_lens,
+    jobject jvalues, jint jvalues_off, jint jvalues_len,
+    jintArray jvalue_lens) {
+  const char* keys_data =
+      reinterpret_cast<const char*>(env->GetDirectBufferAddress(jkeys));
+  char* values_data =
+      reinterpret_cast<char*>(env->GetDirectBufferAddress(jvalues));
+  const jlong keys_capacity = env->GetDirectBufferCapacity(jkeys);
+  if (keys_data == nullptr || values_data == nullptr || jvalues_off < 0 ||
+      jvalues_len < 0 ||
+      env->GetDirectBufferCapacity(jvalues) <
+          static_cast<jlong>(jvalues_off) + jvalues_len) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env, "Invalid direct buffer argument");
+    return 0;
+  }
+  values_data += jvalues_off;
+
+  const jsize num_keys = env->GetArrayLength(jkey_offs);
+  std::vector<jint> key_offs(num_keys);
+  std::vector<jint> key_lens(num_keys);
+  env->GetIntArrayRegion(jkey_offs, 0, num_keys, key_offs.data());
+  env->GetIntArrayRegion(jkey_lens, 0, num_keys, key_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  std::vector<ROCKSDB_NAMESPACE::Slice> keys;
+  keys.reserve(num_keys);
+  for (jsize i = 0; i < num_keys; i++) {
+    if (key_offs[i] < 0 || key_lens[i] < 0 ||
+        static_cast<jlong>(key_offs[i]) + key_lens[i] > keys_capacity) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+          env, "Key out of the key buffer");
+      return 0;
+    }
+    keys.emplace_back(keys_data + key_offs[i], key_lens[i]);
+  }
+
+  auto* db = reinterpret_cast<ROCKSDB_NAMESPACE::DB*>(jdb_handle);
+  auto* cf_handle =
+      jcf_handle == 0
+          ? db->DefaultColumnFamily()
+          : reinterpret_cast<ROCKSDB_NAMESPACE::ColumnFamilyHandle*>(
+                jcf_handle);
+  const auto& ro =
+      *reinterpret_cast<ROCKSDB_NAMESPACE::ReadOptions*>(jropt_handle);
+  std::vector<ROCKSDB_NAMESPACE::PinnableSlice> values(num_keys);
+  std::vector<ROCKSDB_NAMESPACE::Status> statuses(num_keys);
+  db->MultiGet(ro, cf_handle, keys.size(), keys.data(), values.data(),
+               statuses.data(), false /* sorted_input */);
+
+  // The values are copied straight from the blocks they are pinned in
+  std::vector<jint> value_lens(num_keys);
+  jint copied = 0;
+  for (jsize i = 0; i < num_keys; i++) {
+    if (statuses[i].IsNotFound()) {
+      value_lens[i] = -1;  // RocksDB.NOT_FOUND
+    } else if (!statuses[i].ok()) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env, statuses[i]);
+      return 0;
+    } else if (values[i].size() > static_cast<size_t>(jvalues_len - copied)) {
+      value_lens[i] = -2;  // RocksDB.VALUE_DOES_NOT_FIT
+    } else {
+      memcpy(values_data + copied, values[i].data(), values[i].size());
+      value_lens[i] = static_cast<jint>(values[i].size());
+      copied += value_lens[i];
+    }
+  }
+  env->SetIntArrayRegion(jvalue_lens, 0, num_keys, value_lens.data());
+  if (env->ExceptionCheck()) {
+    // exception thrown: ArrayIndexOutOfBoundsException
+    return 0;
+  }
+  return copied;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ROCKSDB_NAMESPACE::DB::KeyMayExist
 bool key_may_exist_helper(JNIEnv* env, jlong jdb_handle, jlong jcf_handle,
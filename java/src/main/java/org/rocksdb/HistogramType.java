@@ -210,6 +210,101 @@ public enum HistogramType {
    */
   TABLE_OPEN_PREFETCH_TAIL_READ_BYTES((byte) 0x3D),
 
+  /**
+   * Latency of GET requests to the cloud storage provider.
+   */
+  CLOUD_READ_MICROS((byte) 0x3F),
+
+  /**
+   * Latency of PUT and multipart upload part requests to the cloud storage provider.
+   */
+  CLOUD_WRITE_MICROS((byte) 0x40),
+
+  /**
+   * Latency of LIST requests to the cloud storage provider.
+   */
+  CLOUD_LIST_MICROS((byte) 0x41),
+
+  /**
+   * Latency of bucket and multipart upload creation requests to the cloud storage provider.
+   */
+  CLOUD_CREATE_MICROS((byte) 0x42),
+
+  /**
+   * Latency of DELETE requests to the cloud storage provider.
+   */
+  CLOUD_DELETE_MICROS((byte) 0x43),
+
+  /**
+   * Latency of COPY requests to the cloud storage provider.
+   */
+  CLOUD_COPY_MICROS((byte) 0x44),
+
+  /**
+   * Latency of HEAD requests to the cloud storage provider.
+   */
+  CLOUD_INFO_MICROS((byte) 0x45),
+
+  /**
+   * Time a follower takes to apply a run of memtable write replication log records.
+   */
+  REPLICATION_MEMTABLE_WRITE_APPLY_MICROS((byte) 0x46),
+
+  /**
+   * Time a follower takes to apply a memtable switch replication log record.
+   */
+  REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS((byte) 0x47),
+
+  /**
+   * Time a follower takes to apply a manifest write replication log record.
+   */
+  REPLICATION_MANIFEST_WRITE_APPLY_MICROS((byte) 0x48),
+
+  /**
+   * Time a follower spends switching memtables for a memtable switch replication log record.
+   */
+  REPLICATION_SWITCH_MEMTABLE_MICROS((byte) 0x49),
+
+  /**
+   * Time a sampled Get() spends getting its snapshot.
+   */
+  SAMPLED_GET_SNAPSHOT_MICROS((byte) 0x4A),
+
+  /**
+   * Time a sampled Get() spends looking up the memtables.
+   */
+  SAMPLED_GET_FROM_MEMTABLE_MICROS((byte) 0x4B),
+
+  /**
+   * Time a sampled Get() spends looking up the SST files.
+   */
+  SAMPLED_GET_FROM_FILES_MICROS((byte) 0x4C),
+
+  /**
+   * Time a sampled Get() spends reading blocks.
+   */
+  SAMPLED_GET_BLOCK_READ_MICROS((byte) 0x4D),
+
+  /**
+   * Time a sampled write spends waiting to join a write group.
+   */
+  SAMPLED_WRITE_THREAD_WAIT_MICROS((byte) 0x4E),
+
+  /**
+   * Time a sampled write is delayed by write stalls.
+   */
+  SAMPLED_WRITE_DELAY_MICROS((byte) 0x4F),
+
+  /**
+   * Time a sampled write spends writing the WAL.
+   */
+  SAMPLED_WRITE_WAL_MICROS((byte) 0x50),
+
+  /**
+   * Time a sampled write spends inserting into the memtables.
+   */
+  SAMPLED_WRITE_MEMTABLE_MICROS((byte) 0x51),
+
   // 0x3E for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x3E);
 
@@ -23,6 +23,11 @@ import org.rocksdb.util.Environment;
 public class RocksDB extends RocksObject {
   public static final byte[] DEFAULT_COLUMN_FAMILY = "default".getBytes(UTF_8);
   public static final int NOT_FOUND = -1;
+  /**
+   * The length {@link #multiGetDirect} reports for a value that is found but does not fit
+   * in what is left of the values buffer.
+   */
+  public static final int VALUE_DOES_NOT_FIT = -2;
 
   private enum LibraryState {
     NOT_LOADED,
@@ -2570,6 +2575,46 @@ public class RocksDB extends RocksObject {
     return results;
   }
 
+  /**
+   * Fetches the values of many keys of a column family in a single JNI call, without
+   * creating any Java object per key or value. The keys are read from a single direct buffer,
+   * and the values found are copied one after the other into another one, straight from the
+   * blocks they are pinned in.
+   *
+   * @param readOptions Read options
+   * @param columnFamilyHandle the column family of the keys, or null for the default one
+   * @param keys direct buffer holding the keys
+   * @param keyOffsets the offset of each key in {@code keys}
+   * @param keyLengths the length of each key
+   * @param values direct buffer the values are copied into from its position, which is
+   *     advanced past them. The value of a key starts where the value of the previous key
+   *     found ends.
+   * @param valueLengths receives the length of the value of each key, {@link #NOT_FOUND} if
+   *     the key is not found, or {@link #VALUE_DOES_NOT_FIT} if its value is not copied
+   *     because it does not fit in the rest of {@code values}
+   * @return the number of bytes copied into {@code values}
+   * @throws RocksDBException if reading a key fails
+   * @throws IllegalArgumentException if the buffers are not direct or the arrays do not have
+   *     a length per key
+   */
+  public int multiGetDirect(final ReadOptions readOptions,
+      final ColumnFamilyHandle columnFamilyHandle, final ByteBuffer keys, final int[] keyOffsets,
+      final int[] keyLengths, final ByteBuffer values, final int[] valueLengths)
+      throws RocksDBException {
+    if (!keys.isDirect() || !values.isDirect()) {
+      throw new IllegalArgumentException("The key and value buffers must be direct byte buffers");
+    }
+    if (keyLengths.length != keyOffsets.length || valueLengths.length != keyOffsets.length) {
+      throw new IllegalArgumentException(
+          "keyOffsets, keyLengths and valueLengths must have a length per key");
+    }
+    final int copied = multiGetDirect(nativeHandle_, readOptions.nativeHandle_,
+        columnFamilyHandle == null ? 0 : columnFamilyHandle.nativeHandle_, keys, keyOffsets,
+        keyLengths, values, values.position(), values.remaining(), valueLengths);
+    values.position(values.position() + copied);
+    return copied;
+  }
+
   /**
    *  Check if a key exists in the database.
    *  This method is not as lightweight as {@code keyMayExist} but it gives a 100% guarantee
@@ -4967,6 +5012,10 @@ public class RocksDB extends RocksObject {
       final long[] columnFamilyHandles, final ByteBuffer[] keysArray, final int[] keyOffsets,
       final int[] keyLengths, final ByteBuffer[] valuesArray, final int[] valuesSizeArray,
       final Status[] statusArray);
+  private static native int multiGetDirect(final long dbHandle, final long rOptHandle,
+      final long cfHandle, final ByteBuffer keys, final int[] keyOffsets, final int[] keyLengths,
+      final ByteBuffer values, final int valuesOffset, final int valuesLength,
+      final int[] valueLengths) throws RocksDBException;
 
   private static native boolean keyExists(final long handle, final long cfHandle,
       final long readOptHandle, final byte[] key, final int keyOffset, final int keyLength);
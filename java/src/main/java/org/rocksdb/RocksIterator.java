@@ -188,6 +188,37 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
     return valueByteArray0(nativeHandle_, value, offset, len);
   }
 
+  /**
+   * <p>Copies the entries from the current one on into a direct buffer and moves past each
+   * entry copied, all in a single JNI call instead of one per {@link #next()},
+   * {@link #key()} and {@link #value()}.</p>
+   *
+   * <p>Entry {@code i} is copied as its key followed by its value, of lengths
+   * {@code lengths[2 * i]} and {@code lengths[2 * i + 1]}, right after entry
+   * {@code i - 1}. The first entry is copied at the position of the buffer, which is advanced
+   * past the entries copied. The copy stops when the iterator becomes invalid, when
+   * {@code lengths} is full, or at the first entry that does not fit in the rest of the
+   * buffer, which the iterator stays at.</p>
+   *
+   * @param buffer direct buffer to copy the entries into
+   * @param lengths receives the key and value lengths of the entries copied
+   * @return the number of entries copied, 0 if the current entry does not fit
+   */
+  public int nextBatch(final ByteBuffer buffer, final int[] lengths) {
+    assert isOwningHandle();
+    if (!buffer.isDirect()) {
+      throw new IllegalArgumentException("buffer must be a direct byte buffer");
+    }
+    final int count =
+        nextBatchDirect0(nativeHandle_, buffer, buffer.position(), buffer.remaining(), lengths);
+    int copied = 0;
+    for (int i = 0; i < 2 * count; i++) {
+      copied += lengths[i];
+    }
+    buffer.position(buffer.position() + copied);
+    return count;
+  }
+
   @Override final native void refresh1(long handle, long snapshotHandle);
   @Override
   protected final void disposeInternal(final long handle) {
@@ -270,6 +301,8 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
 
   private static native byte[] key0(long handle);
   private static native byte[] value0(long handle);
+  private static native int nextBatchDirect0(
+      long handle, ByteBuffer buffer, int bufferOffset, int bufferLen, int[] lengths);
   private static native int keyDirect0(
       long handle, ByteBuffer buffer, int bufferOffset, int bufferLen);
   private static native int keyByteArray0(long handle, byte[] array, int arrayOffset, int arrayLen);
@@ -878,6 +878,130 @@ public enum TickerType {
 
     SST_FOOTER_CORRUPTION_COUNT((byte) -0x55),
 
+    /**
+     * Number of GET requests to the cloud storage provider.
+     */
+    CLOUD_READ_REQUESTS((byte) -0x56),
+
+    /**
+     * Number of PUT and multipart upload part requests to the cloud storage
+     * provider.
+     */
+    CLOUD_WRITE_REQUESTS((byte) -0x57),
+
+    /**
+     * Number of LIST requests to the cloud storage provider.
+     */
+    CLOUD_LIST_REQUESTS((byte) -0x58),
+
+    /**
+     * Number of bucket and multipart upload creations in the cloud storage
+     * provider.
+     */
+    CLOUD_CREATE_REQUESTS((byte) -0x59),
+
+    /**
+     * Number of DELETE requests to the cloud storage provider.
+     */
+    CLOUD_DELETE_REQUESTS((byte) -0x5A),
+
+    /**
+     * Number of COPY requests to the cloud storage provider.
+     */
+    CLOUD_COPY_REQUESTS((byte) -0x5B),
+
+    /**
+     * Number of HEAD requests to the cloud storage provider.
+     */
+    CLOUD_INFO_REQUESTS((byte) -0x5C),
+
+    /**
+     * Number of cloud requests that failed, after their retries.
+     */
+    CLOUD_REQUEST_FAILURES((byte) -0x5D),
+
+    /**
+     * Bytes read by cloud requests.
+     */
+    CLOUD_READ_BYTES((byte) -0x5E),
+
+    /**
+     * Bytes written by cloud requests.
+     */
+    CLOUD_WRITE_BYTES((byte) -0x5F),
+
+    /**
+     * Number of times the cloud client retried a failed request.
+     */
+    CLOUD_REQUEST_RETRIES((byte) -0x60),
+
+    /**
+     * Number of cloud request retries caused by throttling.
+     */
+    CLOUD_REQUEST_THROTTLES((byte) -0x61),
+
+    /**
+     * Number of replication log records applied by a follower.
+     */
+    REPLICATION_RECORDS_APPLIED((byte) -0x62),
+
+    /**
+     * Bytes of replication log records applied by a follower.
+     */
+    REPLICATION_BYTES_APPLIED((byte) -0x63),
+
+    /**
+     * Number of Gets answered by the point lookup cache.
+     */
+    POINT_LOOKUP_CACHE_HIT((byte) -0x64),
+
+    /**
+     * Number of Gets not answered by the point lookup cache.
+     */
+    POINT_LOOKUP_CACHE_MISS((byte) -0x65),
+
+    /**
+     * Number of iterator seeks checked against the range filter of a table
+     * file.
+     */
+    RANGE_FILTER_CHECKED((byte) -0x66),
+
+    /**
+     * Number of iterator seeks that skipped a table file because its range
+     * filter had no key in the range of the seek.
+     */
+    RANGE_FILTER_USEFUL((byte) -0x67),
+
+    /**
+     * Number of point lookups of a key checked against the level filter of a
+     * table file.
+     */
+    LEVEL_FILTER_CHECKED((byte) -0x68),
+
+    /**
+     * Number of point lookups that skipped a table file because its level
+     * filter ruled out the key.
+     */
+    LEVEL_FILTER_USEFUL((byte) -0x69),
+
+    /**
+     * Number of cloud requests delayed by the client-side limit on the
+     * request rate.
+     */
+    CLOUD_REQUEST_THROTTLE_DELAYS((byte) -0x6A),
+
+    /**
+     * Total duration of the delays of cloud requests by the client-side limit
+     * on the request rate, in microseconds.
+     */
+    CLOUD_REQUEST_THROTTLE_DELAY_MICROS((byte) -0x6B),
+
+    /**
+     * Number of data blocks that iterators reading at a timestamp stepped
+     * over because they hold no version that old.
+     */
+    TIMESTAMP_FILTER_BLOCK_FILTERED((byte) -0x6C),
+
     TICKER_ENUM_MAX((byte) -0x54);
 
     private final byte value;
@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 package org.rocksdb;
 
+import static java.nio.charset.StandardCharsets.UTF_8;
 import static org.assertj.core.api.Assertions.*;
 
 import java.nio.ByteBuffer;
@@ -1018,4 +1019,39 @@ public class MultiGetTest {
       }
     }
   }
+
+  @Test
+  public void multiGetDirect() throws RocksDBException {
+    try (final Options opt = new Options().setCreateIfMissing(true);
+         final RocksDB db = RocksDB.open(opt, dbFolder.getRoot().getAbsolutePath());
+         final ReadOptions readOptions = new ReadOptions()) {
+      db.put("key1".getBytes(), "value1ForKey1".getBytes());
+      db.put("key3".getBytes(), "value3ForKey3".getBytes());
+      db.put("key4".getBytes(), "value4ForKey4".getBytes());
+
+      final ByteBuffer keys = ByteBuffer.allocateDirect(16);
+      keys.put("key1key2key3key4".getBytes());
+      final int[] keyOffsets = {0, 4, 8, 12};
+      final int[] keyLengths = {4, 4, 4, 4};
+      // Room for two values only
+      final ByteBuffer values = ByteBuffer.allocateDirect(30);
+      final int[] valueLengths = new int[4];
+      assertThat(db.multiGetDirect(
+                     readOptions, null, keys, keyOffsets, keyLengths, values, valueLengths))
+          .isEqualTo(26);
+      assertThat(valueLengths)
+          .isEqualTo(new int[] {13, RocksDB.NOT_FOUND, 13, RocksDB.VALUE_DOES_NOT_FIT});
+      assertThat(values.position()).isEqualTo(26);
+      values.flip();
+      final byte[] found = new byte[26];
+      values.get(found);
+      assertThat(new String(found, UTF_8)).isEqualTo("value1ForKey1value3ForKey3");
+
+      assertThatThrownBy(()
+                             -> db.multiGetDirect(readOptions, db.getDefaultColumnFamily(),
+                                 keys, keyOffsets, keyLengths, ByteBuffer.allocate(30),
+                                 valueLengths))
+          .isInstanceOf(IllegalArgumentException.class);
+    }
+  }
 }
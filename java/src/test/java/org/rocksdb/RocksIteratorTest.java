@@ -464,4 +464,40 @@ public class RocksIteratorTest {
       }
     }
   }
+
+  @Test
+  public void rocksIteratorNextBatch() throws RocksDBException {
+    try (final Options options = new Options().setCreateIfMissing(true);
+         final RocksDB db = RocksDB.open(options, dbFolder.getRoot().getAbsolutePath())) {
+      db.put("key1".getBytes(), "value1".getBytes());
+      db.put("key2".getBytes(), "value2".getBytes());
+      db.put("key3".getBytes(), "value3".getBytes());
+
+      try (final RocksIterator iterator = db.newIterator()) {
+        iterator.seekToFirst();
+        final int[] lengths = new int[4];
+        // Two entries and a bit
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(25);
+        assertThat(iterator.nextBatch(buffer, lengths)).isEqualTo(2);
+        assertThat(lengths).isEqualTo(new int[] {4, 6, 4, 6});
+        assertThat(buffer.position()).isEqualTo(20);
+        buffer.flip();
+        final byte[] entries = new byte[20];
+        buffer.get(entries);
+        assertThat(new String(entries, StandardCharsets.UTF_8)).isEqualTo("key1value1key2value2");
+
+        // The iterator is at the entry after the batch
+        assertThat(iterator.isValid()).isTrue();
+        assertThat(iterator.key()).isEqualTo("key3".getBytes());
+        buffer.clear();
+        buffer.limit(5);
+        assertThat(iterator.nextBatch(buffer, lengths)).isEqualTo(0);
+        assertThat(iterator.key()).isEqualTo("key3".getBytes());
+        buffer.clear();
+        assertThat(iterator.nextBatch(buffer, lengths)).isEqualTo(1);
+        assertThat(iterator.isValid()).isFalse();
+        assertThat(iterator.nextBatch(buffer, lengths)).isEqualTo(0);
+      }
+    }
+  }
 }
@@ -14,6 +14,7 @@
 #include <cerrno>
 #include <cstddef>
 
+#include "rocksdb/memory_tracker.h"
 #include "rocksdb/write_buffer_manager.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -31,9 +32,12 @@ class Allocator {
   virtual size_t BlockSize() const = 0;
 };
 
+// Charges the memory of an allocator to the write buffer manager and, if
+// given, to a MemoryTracker until the memory is freed.
 class AllocTracker {
  public:
-  explicit AllocTracker(WriteBufferManager* write_buffer_manager);
+  explicit AllocTracker(WriteBufferManager* write_buffer_manager,
+                        MemoryTracker* memory_tracker = nullptr);
   // No copying allowed
   AllocTracker(const AllocTracker&) = delete;
   void operator=(const AllocTracker&) = delete;
@@ -46,11 +50,17 @@ class AllocTracker {
 
   void FreeMem();
 
-  bool is_freed() const { return write_buffer_manager_ == nullptr || freed_; }
+  bool is_freed() const {
+    return (write_buffer_manager_ == nullptr && memory_tracker_ == nullptr) ||
+           freed_;
+  }
 
  private:
   WriteBufferManager* write_buffer_manager_;
+  MemoryTracker* memory_tracker_;
   std::atomic<size_t> bytes_allocated_;
+  // The bytes charged to memory_tracker_
+  std::atomic<size_t> bytes_tracked_;
   bool done_allocating_;
   bool freed_;
 };
@@ -9,6 +9,11 @@
 
 #include "memory/arena.h"
 
+#ifdef NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif  // NUMA
+
 #include <algorithm>
 
 #include "logging/logging.h"
@@ -20,6 +25,21 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+#ifdef NUMA
+namespace {
+// Asks for the pages of [addr, addr + length) to be allocated on node when
+// first touched, falling back to other nodes when it is out of memory
+void PreferNumaNode(void* addr, size_t length, int node) {
+  bitmask* nodes = numa_allocate_nodemask();
+  numa_bitmask_setbit(nodes, static_cast<unsigned int>(node));
+  // Best effort: on failure the pages follow the default policy
+  (void)mbind(addr, length, MPOL_PREFERRED, nodes->maskp, nodes->size + 1,
+              0);
+  numa_bitmask_free(nodes);
+}
+}  // namespace
+#endif  // NUMA
+
 size_t Arena::OptimizeBlockSize(size_t block_size) {
   // Make sure block_size is in optimal range
   block_size = std::max(Arena::kMinBlockSize, block_size);
@@ -33,8 +53,11 @@ size_t Arena::OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             int numa_node, MemoryAllocator* allocator)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      allocator_(allocator),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -48,6 +71,11 @@ Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
       hugetlb_size_ = ((kBlockSize - 1U) / hugetlb_size_ + 1U) * hugetlb_size_;
     }
   }
+#ifdef NUMA
+  numa_node_ = numa_node;
+#else
+  (void)numa_node;
+#endif  // NUMA
   if (tracker_ != nullptr) {
     tracker_->Allocate(kInlineSize);
   }
@@ -93,9 +121,17 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
 }
 
 char* Arena::AllocateFromHugePage(size_t bytes) {
-  MemMapping mm = MemMapping::AllocateHuge(bytes);
+  return AllocateMapping(MemMapping::AllocateHuge(bytes), bytes);
+}
+
+char* Arena::AllocateMapping(MemMapping mm, size_t bytes) {
   auto addr = static_cast<char*>(mm.Get());
   if (addr) {
+#ifdef NUMA
+    if (numa_node_ >= 0) {
+      PreferNumaNode(addr, mm.Length(), numa_node_);
+    }
+#endif  // NUMA
     huge_blocks_.push_back(std::move(mm));
     blocks_memory_ += bytes;
     if (tracker_ != nullptr) {
@@ -143,23 +179,36 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
 }
 
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+  if (numa_node_ >= 0) {
+    // Pages of a fresh mapping are not touched yet, so they can be placed
+    char* addr = AllocateMapping(MemMapping::AllocateLazyZeroed(block_bytes),
+                                 block_bytes);
+    if (addr != nullptr) {
+      return addr;
+    }
+  }
+
   // NOTE: std::make_unique zero-initializes the block so is not appropriate
-  // here
-  char* block = new char[block_bytes];
-  blocks_.push_back(std::unique_ptr<char[]>(block));
+  // here. Neither does AllocateBlock().
+  blocks_.push_back(AllocateBlock(block_bytes, allocator_));
+  char* block = blocks_.back().get();
 
   size_t allocated_size;
+  if (allocator_ != nullptr) {
+    allocated_size = allocator_->UsableSize(block, block_bytes);
+  } else {
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
-  allocated_size = malloc_usable_size(block);
+    allocated_size = malloc_usable_size(block);
 #ifndef NDEBUG
-  // It's hard to predict what malloc_usable_size() returns.
-  // A callback can allow users to change the costed size.
-  std::pair<size_t*, size_t*> pair(&allocated_size, &block_bytes);
-  TEST_SYNC_POINT_CALLBACK("Arena::AllocateNewBlock:0", &pair);
+    // It's hard to predict what malloc_usable_size() returns.
+    // A callback can allow users to change the costed size.
+    std::pair<size_t*, size_t*> pair(&allocated_size, &block_bytes);
+    TEST_SYNC_POINT_CALLBACK("Arena::AllocateNewBlock:0", &pair);
 #endif  // NDEBUG
 #else
-  allocated_size = block_bytes;
+    allocated_size = block_bytes;
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
+  }
   blocks_memory_ += allocated_size;
   if (tracker_ != nullptr) {
     tracker_->Allocate(allocated_size);
@@ -17,6 +17,7 @@
 #include <deque>
 
 #include "memory/allocator.h"
+#include "memory/memory_allocator_impl.h"
 #include "port/mmap.h"
 #include "rocksdb/env.h"
 
@@ -39,8 +40,14 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // numa_node: if >= 0 and built with NUMA support, blocks are mapped with
+  // mmap and their pages placed on that NUMA node (preferably) when first
+  // touched. Falls back to normal allocation if the mapping fails.
+  // allocator: if not null, the blocks that are neither huge pages nor
+  // placed on numa_node are allocated from it instead of malloc.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 int numa_node = -1, MemoryAllocator* allocator = nullptr);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -92,8 +99,8 @@ class Arena : public Allocator {
   // Number of bytes allocated in one block
   const size_t kBlockSize;
   // Allocated memory blocks
-  std::deque<std::unique_ptr<char[]>> blocks_;
-  // Huge page allocations
+  std::deque<CacheAllocationPtr> blocks_;
+  // Huge page allocations, and blocks placed on numa_node_
   std::deque<MemMapping> huge_blocks_;
   size_t irregular_block_num = 0;
 
@@ -109,7 +116,14 @@ class Arena : public Allocator {
 
   size_t hugetlb_size_ = 0;
 
+  // The NUMA node of the blocks, or -1 for no placement
+  int numa_node_ = -1;
+
+  // Non-owned, null to allocate the blocks with new[]
+  MemoryAllocator* allocator_;
+
   char* AllocateFromHugePage(size_t bytes);
+  char* AllocateMapping(MemMapping mm, size_t bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
 
@@ -12,10 +12,14 @@
 #ifndef OS_WIN
 #include <sys/resource.h>
 #endif
+#include <vector>
+
+#include "memory/concurrent_arena.h"
 #include "port/jemalloc_helper.h"
 #include "port/port.h"
 #include "test_util/testharness.h"
 #include "util/random.h"
+#include "utilities/memory_allocators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -308,6 +312,87 @@ TEST_F(ArenaTest, UnmappedAllocation) {
   }
 }
 
+TEST_F(ArenaTest, NumaNode) {
+  // Without NUMA support the node is ignored
+  Arena arena(Arena::kMinBlockSize, nullptr, 0, /*numa_node=*/0);
+  std::vector<std::pair<size_t, char*>> allocated;
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    size_t bytes = 1 + rnd.Uniform(i % 10 == 0 ? 10000 : 100);
+    char* p = arena.AllocateAligned(bytes);
+    memset(p, i % 256, bytes);
+    allocated.emplace_back(bytes, p);
+  }
+  size_t total = 0;
+  for (size_t i = 0; i < allocated.size(); i++) {
+    for (size_t b = 0; b < allocated[i].first; b++) {
+      ASSERT_EQ(int(allocated[i].second[b]) & 0xff, (int)(i % 256));
+    }
+    total += allocated[i].first;
+  }
+  ASSERT_GE(arena.MemoryAllocatedBytes(), total);
+  ASSERT_GE(arena.ApproximateMemoryUsage(), total);
+}
+
+TEST_F(ArenaTest, ConcurrentArenaNumaLocal) {
+  const int kThreads = 4;
+  const int kAllocations = 10000;
+  ConcurrentArena arena(64 << 10, nullptr, 0, /*numa_local=*/true);
+  std::vector<std::vector<char*>> allocated(kThreads);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kAllocations; i++) {
+        char* p = arena.Allocate(16);
+        memset(p, t, 16);
+        allocated[t].push_back(p);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kThreads; t++) {
+    for (char* p : allocated[t]) {
+      for (int b = 0; b < 16; b++) {
+        ASSERT_EQ(t, p[b]);
+      }
+    }
+  }
+  const size_t total = size_t{kThreads} * kAllocations * 16;
+  ASSERT_GE(arena.ApproximateMemoryUsage(), total);
+  ASSERT_GE(arena.MemoryAllocatedBytes(), total + arena.AllocatedAndUnused());
+}
+
+TEST_F(ArenaTest, MemoryAllocator) {
+  CountedMemoryAllocator allocator;
+  {
+    Arena arena(Arena::kMinBlockSize, nullptr, 0, /*numa_node=*/-1,
+                &allocator);
+    // Served from the inline block
+    char* p = arena.Allocate(100);
+    memset(p, 1, 100);
+    ASSERT_EQ(allocator.GetNumAllocations(), 0u);
+    // A block of its own
+    p = arena.Allocate(Arena::kMinBlockSize);
+    memset(p, 2, Arena::kMinBlockSize);
+    ASSERT_EQ(allocator.GetNumAllocations(), 1u);
+    for (int i = 0; i < 100; i++) {
+      p = arena.AllocateAligned(100);
+      memset(p, 3, 100);
+    }
+    ASSERT_GT(allocator.GetNumAllocations(), 1u);
+    ASSERT_GE(arena.MemoryAllocatedBytes(),
+              Arena::kInlineSize + Arena::kMinBlockSize + 100 * 100);
+  }
+  ASSERT_EQ(allocator.GetNumDeallocations(), allocator.GetNumAllocations());
+
+  ConcurrentArena concurrent_arena(Arena::kMinBlockSize, nullptr, 0,
+                                   /*numa_local=*/false, &allocator);
+  concurrent_arena.Allocate(Arena::kMinBlockSize);
+  ASSERT_GT(allocator.GetNumAllocations(), allocator.GetNumDeallocations());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -9,6 +9,10 @@
 
 #include "memory/concurrent_arena.h"
 
+#ifdef NUMA
+#include <numa.h>
+#endif  // NUMA
+
 #include <thread>
 
 #include "port/port.h"
@@ -27,10 +31,22 @@ const size_t kMaxShardBlockSize = size_t{128 * 1024};
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size, bool numa_local,
+                                 MemoryAllocator* allocator)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size, /*numa_node=*/-1,
+             allocator) {
+#ifdef NUMA
+  if (numa_local && numa_available() >= 0 && numa_max_node() > 0) {
+    for (int node = 0; node <= numa_max_node(); ++node) {
+      node_arenas_.emplace_back(
+          new Arena(block_size, tracker, huge_page_size, node, allocator));
+    }
+  }
+#else
+  (void)numa_local;
+#endif  // NUMA
   Fixup();
 }
 
@@ -42,4 +58,16 @@ ConcurrentArena::Shard* ConcurrentArena::Repick() {
   return shard_and_index.first;
 }
 
+Arena* ConcurrentArena::LocalNodeArena() {
+  assert(!node_arenas_.empty());
+#ifdef NUMA
+  int core = port::PhysicalCoreID();
+  int node = core >= 0 ? numa_node_of_cpu(core) : -1;
+  if (node >= 0 && static_cast<size_t>(node) < node_arenas_.size()) {
+    return node_arenas_[node].get();
+  }
+#endif  // NUMA
+  return node_arenas_[0].get();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "memory/allocator.h"
 #include "memory/arena.h"
@@ -45,9 +46,19 @@ class ConcurrentArena : public Allocator {
   // in fact just passed to the constructor of arena_.  The core-local
   // shards compute their shard_block_size as a fraction of block_size
   // that varies according to the hardware concurrency level.
+  //
+  // numa_local: if true, built with NUMA support and the machine has more
+  // than one NUMA node, the core-local shards refill from one arena per
+  // node, whose pages are placed on that node, so the memory of an
+  // allocation from a shard is local to the core that made it. This costs
+  // up to one partially used block per node.
+  //
+  // allocator: if not null, the blocks of the arenas are allocated from it,
+  // see Arena.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0, bool numa_local = false,
+                           MemoryAllocator* allocator = nullptr);
 
   char* Allocate(size_t bytes) override {
     return AllocateImpl(bytes, false /*force_arena*/,
@@ -70,7 +81,11 @@ class ConcurrentArena : public Allocator {
   size_t ApproximateMemoryUsage() const {
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    size_t usage = arena_.ApproximateMemoryUsage();
+    for (const auto& node_arena : node_arenas_) {
+      usage += node_arena->ApproximateMemoryUsage();
+    }
+    return usage - ShardAllocatedAndUnused();
   }
 
   size_t MemoryAllocatedBytes() const {
@@ -79,6 +94,7 @@ class ConcurrentArena : public Allocator {
 
   size_t AllocatedAndUnused() const {
     return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
+           node_allocated_and_unused_.load(std::memory_order_relaxed) +
            ShardAllocatedAndUnused();
   }
 
@@ -107,8 +123,12 @@ class ConcurrentArena : public Allocator {
   CoreLocalArray<Shard> shards_;
 
   Arena arena_;
+  // The arenas the shards refill from with numa_local, indexed by node.
+  // Also protected by arena_mutex_.
+  std::vector<std::unique_ptr<Arena>> node_arenas_;
   mutable SpinMutex arena_mutex_;
   std::atomic<size_t> arena_allocated_and_unused_;
+  std::atomic<size_t> node_allocated_and_unused_;
   std::atomic<size_t> memory_allocated_bytes_;
   std::atomic<size_t> irregular_block_num_;
 
@@ -116,6 +136,9 @@ class ConcurrentArena : public Allocator {
 
   Shard* Repick();
 
+  // The arena of the NUMA node of the current core. Requires numa_local.
+  Arena* LocalNodeArena();
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -179,10 +202,16 @@ class ConcurrentArena : public Allocator {
         return rv;
       }
 
-      avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
-                  ? exact
-                  : shard_block_size_;
-      s->free_begin_ = arena_.AllocateAligned(avail);
+      if (!node_arenas_.empty()) {
+        avail = shard_block_size_;
+        s->free_begin_ = LocalNodeArena()->AllocateAligned(avail);
+      } else {
+        avail =
+            exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
+                ? exact
+                : shard_block_size_;
+        s->free_begin_ = arena_.AllocateAligned(avail);
+      }
       Fixup();
     }
     s->allocated_and_unused_.store(avail - bytes, std::memory_order_relaxed);
@@ -200,9 +229,17 @@ class ConcurrentArena : public Allocator {
   }
 
   void Fixup() {
+    size_t memory_allocated_bytes = arena_.MemoryAllocatedBytes();
+    size_t node_allocated_and_unused = 0;
+    for (const auto& node_arena : node_arenas_) {
+      memory_allocated_bytes += node_arena->MemoryAllocatedBytes();
+      node_allocated_and_unused += node_arena->AllocatedAndUnused();
+    }
     arena_allocated_and_unused_.store(arena_.AllocatedAndUnused(),
                                       std::memory_order_relaxed);
-    memory_allocated_bytes_.store(arena_.MemoryAllocatedBytes(),
+    node_allocated_and_unused_.store(node_allocated_and_unused,
+                                     std::memory_order_relaxed);
+    memory_allocated_bytes_.store(memory_allocated_bytes,
                                   std::memory_order_relaxed);
     irregular_block_num_.store(arena_.IrregularBlockNum(),
                                std::memory_order_relaxed);
@@ -40,6 +40,14 @@ static std::unordered_map<std::string, OptionTypeInfo> jemalloc_type_info = {
     {"num_arenas",
      {offsetof(struct JemallocAllocatorOptions, num_arenas), OptionType::kSizeT,
       OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+    {"cpu_local_arenas",
+     {offsetof(struct JemallocAllocatorOptions, cpu_local_arenas),
+      OptionType::kBoolean, OptionVerificationType::kNormal,
+      OptionTypeFlags::kNone}},
+    {"use_huge_pages",
+     {offsetof(struct JemallocAllocatorOptions, use_huge_pages),
+      OptionType::kBoolean, OptionVerificationType::kNormal,
+      OptionTypeFlags::kNone}},
 };
 bool JemallocNodumpAllocator::IsSupported(std::string* why) {
 #ifndef ROCKSDB_JEMALLOC
@@ -118,6 +126,14 @@ uint32_t JemallocNodumpAllocator::GetArenaIndex() const {
     return arena_indexes_[0];
   }
 
+  if (options_.cpu_local_arenas) {
+    int cpu = port::PhysicalCoreID();
+    if (cpu >= 0) {
+      return arena_indexes_[static_cast<size_t>(cpu) % arena_indexes_.size()];
+    }
+    // Falls back to a random arena where the CPU is not known
+  }
+
   static std::atomic<uint32_t> next_seed = 0;
   // Core-local may work in place of `thread_local` as we should be able to
   // tolerate occasional stale reads in thread migration cases. However we need
@@ -172,7 +188,9 @@ Status JemallocNodumpAllocator::InitializeArenas() {
     // Set the custom hook.
     per_arena_hooks_.emplace_back();
     per_arena_hooks_.back().reset(new extent_hooks_t(*hooks));
-    per_arena_hooks_.back()->alloc = &JemallocNodumpAllocator::Alloc;
+    per_arena_hooks_.back()->alloc =
+        options_.use_huge_pages ? &JemallocNodumpAllocator::AllocHugePages
+                                : &JemallocNodumpAllocator::Alloc;
     extent_hooks_t* hooks_ptr = per_arena_hooks_.back().get();
     ret = mallctl(key.c_str(), nullptr, nullptr, &hooks_ptr, sizeof(hooks_ptr));
     if (ret != 0) {
@@ -198,6 +216,10 @@ Status JemallocNodumpAllocator::PrepareOptions(
         "tcache_size_lower_bound larger or equal to tcache_size_upper_bound.");
   } else if (options_.num_arenas < 1) {
     return Status::InvalidArgument("num_arenas must be a positive integer");
+#ifndef MADV_HUGEPAGE
+  } else if (options_.use_huge_pages) {
+    return Status::NotSupported("use_huge_pages requires MADV_HUGEPAGE");
+#endif  // MADV_HUGEPAGE
   } else if (IsMutable()) {
     Status s = MemoryAllocator::PrepareOptions(config_options);
 #ifdef ROCKSDB_JEMALLOC_NODUMP_ALLOCATOR
@@ -258,6 +280,23 @@ void* JemallocNodumpAllocator::Alloc(extent_hooks_t* extent, void* new_addr,
   return result;
 }
 
+void* JemallocNodumpAllocator::AllocHugePages(extent_hooks_t* extent,
+                                              void* new_addr, size_t size,
+                                              size_t alignment, bool* zero,
+                                              bool* commit,
+                                              unsigned arena_ind) {
+  void* result =
+      Alloc(extent, new_addr, size, alignment, zero, commit, arena_ind);
+#ifdef MADV_HUGEPAGE
+  if (result != nullptr) {
+    // Only advice: the extent is still usable with regular pages
+    int ret = madvise(result, size, MADV_HUGEPAGE);
+    (void)ret;
+  }
+#endif  // MADV_HUGEPAGE
+  return result;
+}
+
 Status JemallocNodumpAllocator::DestroyArena(uint32_t arena_index) {
   assert(arena_index != 0);
   std::string key = "arena." + std::to_string(arena_index) + ".destroy";
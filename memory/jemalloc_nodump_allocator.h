@@ -27,7 +27,7 @@ namespace ROCKSDB_NAMESPACE {
 
 // Allocation requests are randomly sharded across
 // `JemallocAllocatorOptions::num_arenas` arenas to reduce contention on per-
-// arena mutexes.
+// arena mutexes, or by CPU with `JemallocAllocatorOptions::cpu_local_arenas`.
 class JemallocNodumpAllocator : public BaseMemoryAllocator {
  public:
   explicit JemallocNodumpAllocator(const JemallocAllocatorOptions& options);
@@ -62,6 +62,11 @@ class JemallocNodumpAllocator : public BaseMemoryAllocator {
   static void* Alloc(extent_hooks_t* extent, void* new_addr, size_t size,
                      size_t alignment, bool* zero, bool* commit,
                      unsigned arena_ind);
+  // Alloc() that also advises the extent to be backed by huge pages, for
+  // JemallocAllocatorOptions::use_huge_pages
+  static void* AllocHugePages(extent_hooks_t* extent, void* new_addr,
+                              size_t size, size_t alignment, bool* zero,
+                              bool* commit, unsigned arena_ind);
 
   // Destroy arena on destruction of the allocator, or on failure.
   static Status DestroyArena(uint32_t arena_index);
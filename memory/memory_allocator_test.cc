@@ -11,6 +11,7 @@
 #include "rocksdb/cache.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
+#include "rocksdb/memory_tracker.h"
 #include "rocksdb/options.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "test_util/testharness.h"
@@ -171,6 +172,38 @@ TEST_F(CreateMemoryAllocatorTest, JemallocOptionsTest) {
   ASSERT_EQ(opts->limit_tcache_size, true);
   ASSERT_EQ(opts->tcache_size_lower_bound, 1024U);
   ASSERT_EQ(opts->tcache_size_upper_bound, 4096U);
+
+  ASSERT_OK(MemoryAllocator::CreateFromString(
+      config_options_, id + "; num_arenas=4; cpu_local_arenas=true",
+      &allocator));
+  opts = allocator->GetOptions<JemallocAllocatorOptions>();
+  ASSERT_NE(opts, nullptr);
+  ASSERT_EQ(opts->num_arenas, 4U);
+  ASSERT_TRUE(opts->cpu_local_arenas);
+  ASSERT_FALSE(opts->use_huge_pages);
+  void* p = allocator->Allocate(1024);
+  allocator->Deallocate(p);
+}
+
+TEST_F(CreateMemoryAllocatorTest, JemallocOptimizeForBlockSize) {
+  JemallocAllocatorOptions jopts;
+  jopts.OptimizeForBlockSize(16 * 1024);
+  ASSERT_TRUE(jopts.limit_tcache_size);
+  ASSERT_EQ(jopts.tcache_size_lower_bound, 4 * 1024U);
+  ASSERT_EQ(jopts.tcache_size_upper_bound, 32 * 1024U);
+
+  jopts.use_huge_pages = true;
+  std::shared_ptr<MemoryAllocator> allocator;
+  Status s = NewJemallocNodumpAllocator(jopts, &allocator);
+  if (!JemallocNodumpAllocator::IsSupported()) {
+    ASSERT_NOK(s);
+    ROCKSDB_GTEST_BYPASS("JEMALLOC not supported");
+    return;
+  }
+  ASSERT_OK(s);
+  void* p = allocator->Allocate(64 * 1024);
+  memset(p, 0, 64 * 1024);
+  allocator->Deallocate(p);
 }
 
 TEST_F(CreateMemoryAllocatorTest, NewJemallocNodumpAllocator) {
@@ -221,6 +254,34 @@ TEST(JemallocNodumpAllocatorTest, LimitCacheSize) {
 }
 #endif
 
+TEST(TrackingMemoryAllocatorTest, ChargesTracker) {
+  auto* tracker = MemoryTracker::Get("tracking_memory_allocator_test");
+  ASSERT_EQ(tracker, MemoryTracker::Get("tracking_memory_allocator_test"));
+  ASSERT_EQ(tracker->GetUsage(), 0u);
+  auto counted = std::make_shared<CountedMemoryAllocator>();
+  auto allocator = NewTrackingMemoryAllocator(counted, tracker);
+  auto* p1 = allocator->Allocate(100);
+  auto* p2 = allocator->Allocate(1000);
+  ASSERT_EQ(tracker->GetUsage(), 1100u);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(p1) %
+                TrackingMemoryAllocator::kHeaderSize,
+            0u);
+  memset(p2, 0, 1000);
+  allocator->Deallocate(p2);
+  ASSERT_EQ(tracker->GetUsage(), 100u);
+  ASSERT_EQ(tracker->GetPeakUsage(), 1100u);
+  allocator->Deallocate(p1);
+  ASSERT_EQ(tracker->GetUsage(), 0u);
+  ASSERT_EQ(counted->GetNumAllocations(), 2u);
+  ASSERT_EQ(counted->GetNumDeallocations(), 2u);
+  tracker->ResetPeakUsage();
+  ASSERT_EQ(tracker->GetPeakUsage(), 0u);
+
+  std::map<std::string, uint64_t> usage;
+  MemoryTracker::GetAllUsage(&usage);
+  ASSERT_EQ(usage.count("tracking_memory_allocator_test"), 1u);
+}
+
 INSTANTIATE_TEST_CASE_P(DefaultMemoryAllocator, MemoryAllocatorTest,
                         ::testing::Values(std::make_tuple(
                             DefaultMemoryAllocator::kClassName(), true)));
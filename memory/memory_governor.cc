@@ -0,0 +1,99 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+MemoryGovernor::MemoryGovernor(const MemoryGovernorOptions& options)
+    : options_(options),
+      memory_limit_(options.memory_limit),
+      clock_(SystemClock::Default().get()),
+      next_rebalance_time_(0) {
+  assert(options.memory_limit > 0);
+  for (const auto& name : options.tracked_components) {
+    trackers_.push_back(MemoryTracker::Get(name));
+  }
+  // Stalls the writes at the limit, the delays before are up to the DBs
+  write_buffer_manager_ = std::make_shared<WriteBufferManager>(
+      std::max<size_t>(
+          static_cast<size_t>(static_cast<double>(options.memory_limit) *
+                              options.max_write_buffer_ratio),
+          1),
+      nullptr /* cache */, true /* allow_stall */);
+  Rebalance();
+}
+
+void MemoryGovernor::Rebalance() {
+  std::lock_guard<std::mutex> lock(rebalance_mutex_);
+  uint64_t tracked_usage = 0;
+  for (auto* tracker : trackers_) {
+    tracked_usage += tracker->GetUsage();
+  }
+  const size_t limit = memory_limit();
+  const size_t available =
+      limit > tracked_usage ? static_cast<size_t>(limit - tracked_usage) : 0;
+  const size_t min_block_cache_size =
+      options_.block_cache == nullptr
+          ? 0
+          : static_cast<size_t>(static_cast<double>(available) *
+                                options_.min_block_cache_ratio);
+  const size_t write_buffer_size = std::max<size_t>(
+      std::min(static_cast<size_t>(static_cast<double>(available) *
+                                   options_.max_write_buffer_ratio),
+               available - min_block_cache_size),
+      1);
+  if (write_buffer_manager_->buffer_size() != write_buffer_size) {
+    write_buffer_manager_->SetBufferSize(write_buffer_size);
+  }
+
+  if (options_.block_cache != nullptr) {
+    // The block cache gets what the mem-tables do not use right now, and
+    // shrinks as they grow
+    const size_t memtable_usage =
+        std::min(write_buffer_manager_->memory_usage(), write_buffer_size);
+    const size_t capacity = std::max(
+        available > memtable_usage ? available - memtable_usage : 0,
+        min_block_cache_size);
+    if (options_.block_cache->GetCapacity() != capacity) {
+      options_.block_cache->SetCapacity(capacity);
+    }
+  }
+  next_rebalance_time_.store(
+      clock_->NowMicros() + options_.rebalance_period_micros,
+      std::memory_order_relaxed);
+}
+
+double MemoryGovernor::GetWritePressure() {
+  uint64_t next_rebalance_time =
+      next_rebalance_time_.load(std::memory_order_relaxed);
+  if (clock_->NowMicros() >= next_rebalance_time &&
+      next_rebalance_time_.compare_exchange_strong(
+          next_rebalance_time, UINT64_MAX, std::memory_order_relaxed)) {
+    // Only one of the writes that find the rebalance due does it
+    Rebalance();
+  }
+
+  const size_t limit = write_buffer_manager_->buffer_size();
+  const size_t usage = write_buffer_manager_->memory_usage();
+  const size_t delay_start = static_cast<size_t>(
+      static_cast<double>(limit) * options_.write_delay_start_ratio);
+  if (usage <= delay_start) {
+    return 0;
+  }
+  if (usage >= limit) {
+    return 1;
+  }
+  return static_cast<double>(usage - delay_start) /
+         static_cast<double>(limit - delay_start);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
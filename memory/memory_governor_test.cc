@@ -0,0 +1,120 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include "db/db_impl/db_impl.h"
+#include "port/stack_trace.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+#include "test_util/testharness.h"
+#include "util/cast_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class MemoryGovernorTest : public testing::Test {};
+
+TEST_F(MemoryGovernorTest, Rebalance) {
+  MemoryTracker* tracker = MemoryTracker::Get("memory-governor-test");
+  tracker->Add(2 << 20);
+  MemoryGovernorOptions options;
+  options.memory_limit = 10 << 20;
+  options.block_cache = NewLRUCache(1 << 20);
+  options.tracked_components = {"memory-governor-test"};
+  MemoryGovernor governor(options);
+  const auto& wbm = governor.write_buffer_manager();
+  const auto& cache = options.block_cache;
+
+  // The tracked component leaves 8MB, half of which the mem-tables may use
+  // and all of which the block cache gets while they use none
+  ASSERT_EQ(wbm->buffer_size(), 4u << 20);
+  ASSERT_EQ(cache->GetCapacity(), 8u << 20);
+  ASSERT_EQ(governor.GetWritePressure(), 0);
+
+  // The block cache shrinks as the mem-tables grow
+  wbm->ReserveMem(3 << 20);
+  governor.Rebalance();
+  ASSERT_EQ(cache->GetCapacity(), 5u << 20);
+  ASSERT_EQ(governor.GetWritePressure(), 0);
+  // Past 80% of their limit, the writes are delayed more and more
+  wbm->ReserveMem(1 << 19);
+  ASSERT_NEAR(governor.GetWritePressure(), 0.375, 0.001);
+
+  // The tracked component takes from both
+  tracker->Add(4 << 20);
+  governor.Rebalance();
+  ASSERT_EQ(wbm->buffer_size(), 2u << 20);
+  ASSERT_EQ(cache->GetCapacity(), 2u << 20);
+  ASSERT_EQ(governor.GetWritePressure(), 1);
+
+  // The block cache keeps its minimum when the mem-tables may use more than
+  // the rest
+  tracker->Add(2 << 20);
+  options.max_write_buffer_ratio = 0.9;
+  MemoryGovernor greedy_governor(options);
+  const auto& greedy_wbm = greedy_governor.write_buffer_manager();
+  ASSERT_EQ(greedy_wbm->buffer_size(), (2u << 20) - (2u << 20) / 5);
+  greedy_wbm->ReserveMem(2 << 20);
+  greedy_governor.Rebalance();
+  ASSERT_EQ(cache->GetCapacity(), (2u << 20) / 5);
+  greedy_wbm->FreeMem(2 << 20);
+
+  wbm->FreeMem((3 << 20) + (1 << 19));
+  tracker->Release(8 << 20);
+  ASSERT_EQ(wbm->memory_usage(), 0u);
+  governor.Rebalance();
+  ASSERT_EQ(cache->GetCapacity(), 10u << 20);
+}
+
+TEST_F(MemoryGovernorTest, WriteDelay) {
+  MemoryGovernorOptions governor_options;
+  governor_options.memory_limit = 64 << 20;
+  governor_options.tracked_components = {};
+  governor_options.rebalance_period_micros = 0;
+  auto governor = std::make_shared<MemoryGovernor>(governor_options);
+  const auto& wbm = governor->write_buffer_manager();
+
+  Options options;
+  options.create_if_missing = true;
+  options.memory_governor = governor;
+  std::string dbname = test::PerThreadDBPath("memory_governor_test");
+  ASSERT_OK(DestroyDB(dbname, options));
+  DB* db = nullptr;
+  ASSERT_OK(DB::Open(options, dbname, &db));
+  auto* db_impl = static_cast_with_check<DBImpl>(db);
+  ASSERT_EQ(db->GetDBOptions().write_buffer_manager, wbm);
+  WriteController& write_controller = db_impl->TEST_write_controler();
+
+  ASSERT_OK(db->Put(WriteOptions(), "k1", "v"));
+  ASSERT_FALSE(write_controller.NeedsDelay());
+
+  // Immutable mem-tables at 90% of their limit
+  const size_t reserved = wbm->buffer_size() / 10 * 9 - wbm->memory_usage();
+  wbm->ReserveMem(reserved);
+  wbm->ScheduleFreeMem(reserved);
+  ASSERT_OK(db->Put(WriteOptions(), "k2", "v"));
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  ASSERT_LT(write_controller.delayed_write_rate(),
+            write_controller.max_delayed_write_rate());
+
+  // The delay ends with the pressure
+  wbm->FreeMem(reserved);
+  ASSERT_OK(db->Put(WriteOptions(), "k3", "v"));
+  ASSERT_FALSE(write_controller.NeedsDelay());
+  ASSERT_EQ(write_controller.delayed_write_rate(),
+            write_controller.max_delayed_write_rate());
+
+  delete db;
+  ASSERT_OK(DestroyDB(dbname, options));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
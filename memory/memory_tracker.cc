@@ -0,0 +1,95 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_tracker.h"
+
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
+#include "utilities/memory_allocators.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+struct MemoryTrackerRegistry {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<MemoryTracker>> trackers;
+};
+
+MemoryTrackerRegistry* GetRegistry() {
+  // Never destroyed, so that the components freed by static destructors can
+  // still release their memory
+  static MemoryTrackerRegistry* registry = new MemoryTrackerRegistry();
+  return registry;
+}
+}  // namespace
+
+MemoryTracker::MemoryTracker(const std::string& name)
+    : name_(name), usage_(0), peak_usage_(0) {}
+
+MemoryTracker* MemoryTracker::Get(const std::string& name) {
+  auto* registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  auto& tracker = registry->trackers[name];
+  if (!tracker) {
+    tracker.reset(new MemoryTracker(name));
+  }
+  return tracker.get();
+}
+
+void MemoryTracker::GetAllUsage(std::map<std::string, uint64_t>* usage) {
+  usage->clear();
+  auto* registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  for (const auto& tracker : registry->trackers) {
+    (*usage)[tracker.first] = tracker.second->GetUsage();
+  }
+}
+
+void MemoryTracker::Add(size_t bytes) {
+  uint64_t usage = usage_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  uint64_t peak = peak_usage_.load(std::memory_order_relaxed);
+  while (usage > peak && !peak_usage_.compare_exchange_weak(
+                             peak, usage, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryTracker::Release(size_t bytes) {
+  assert(usage_.load(std::memory_order_relaxed) >= bytes);
+  usage_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::ResetPeakUsage() {
+  peak_usage_.store(usage_.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+}
+
+void* TrackingMemoryAllocator::Allocate(size_t size) {
+  char* block =
+      static_cast<char*>(MemoryAllocatorWrapper::Allocate(size + kHeaderSize));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  memcpy(block, &size, sizeof(size));
+  tracker_->Add(size);
+  return block + kHeaderSize;
+}
+
+void TrackingMemoryAllocator::Deallocate(void* p) {
+  char* block = static_cast<char*>(p) - kHeaderSize;
+  size_t size;
+  memcpy(&size, block, sizeof(size));
+  tracker_->Release(size);
+  MemoryAllocatorWrapper::Deallocate(block);
+}
+
+std::shared_ptr<MemoryAllocator> NewTrackingMemoryAllocator(
+    const std::shared_ptr<MemoryAllocator>& target, MemoryTracker* tracker) {
+  assert(target != nullptr);
+  assert(tracker != nullptr);
+  return std::make_shared<TrackingMemoryAllocator>(target, tracker);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
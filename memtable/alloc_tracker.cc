@@ -15,18 +15,26 @@
 
 namespace ROCKSDB_NAMESPACE {
 
-AllocTracker::AllocTracker(WriteBufferManager* write_buffer_manager)
+AllocTracker::AllocTracker(WriteBufferManager* write_buffer_manager,
+                           MemoryTracker* memory_tracker)
     : write_buffer_manager_(write_buffer_manager),
+      memory_tracker_(memory_tracker),
       bytes_allocated_(0),
+      bytes_tracked_(0),
       done_allocating_(false),
       freed_(false) {}
 
 AllocTracker::~AllocTracker() { FreeMem(); }
 
 void AllocTracker::Allocate(size_t bytes) {
-  assert(write_buffer_manager_ != nullptr);
-  if (write_buffer_manager_->enabled() ||
-      write_buffer_manager_->cost_to_cache()) {
+  assert(write_buffer_manager_ != nullptr || memory_tracker_ != nullptr);
+  if (memory_tracker_ != nullptr) {
+    bytes_tracked_.fetch_add(bytes, std::memory_order_relaxed);
+    memory_tracker_->Add(bytes);
+  }
+  if (write_buffer_manager_ != nullptr &&
+      (write_buffer_manager_->enabled() ||
+       write_buffer_manager_->cost_to_cache())) {
     bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
     write_buffer_manager_->ReserveMem(bytes);
   }
@@ -49,13 +57,18 @@ void AllocTracker::FreeMem() {
   if (!done_allocating_) {
     DoneAllocating();
   }
-  if (write_buffer_manager_ != nullptr && !freed_) {
-    if (write_buffer_manager_->enabled() ||
-        write_buffer_manager_->cost_to_cache()) {
-      write_buffer_manager_->FreeMem(
-          bytes_allocated_.load(std::memory_order_relaxed));
-    } else {
-      assert(bytes_allocated_.load(std::memory_order_relaxed) == 0);
+  if (!freed_) {
+    if (write_buffer_manager_ != nullptr) {
+      if (write_buffer_manager_->enabled() ||
+          write_buffer_manager_->cost_to_cache()) {
+        write_buffer_manager_->FreeMem(
+            bytes_allocated_.load(std::memory_order_relaxed));
+      } else {
+        assert(bytes_allocated_.load(std::memory_order_relaxed) == 0);
+      }
+    }
+    if (memory_tracker_ != nullptr) {
+      memory_tracker_->Release(bytes_tracked_.load(std::memory_order_relaxed));
     }
     freed_ = true;
   }
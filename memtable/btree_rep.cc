@@ -0,0 +1,648 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A B+tree of memtable entries, for concurrent inserts and reads, using
+// optimistic lock coupling ("The ART of Practical Synchronization", Leis et
+// al., DaMoN 2016). Writers lock the nodes they change, one leaf in the
+// common case. Readers take no lock: they read a node's version before and
+// after reading the node, and restart from the root when it changed.
+//
+// Nodes are allocated from the memtable's allocator and never freed or
+// reused until the memtable is, so a reader may follow a stale pointer
+// safely before finding out it has to restart. A split keeps the lower half
+// of a node in place and moves the upper half to a new right sibling, and
+// leaves are linked to their right siblings, so keys only move right: a
+// reader that reached the leaf of a key before a split finds the key in the
+// leaf or one of its right siblings (the B-link tree of Lehman and Yao).
+//
+// Keys are not stored in the nodes: memtable keys are ordered by the
+// column family's comparator, rather than by their bytes, which rules out a
+// radix tree. Each node instead holds 32 entries spanning a few cache lines,
+// for a tree of about a quarter of the height of a skip list.
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+class BTreeRep : public MemTableRep {
+ public:
+  BTreeRep(const MemTableRep::KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator), cmp_(compare) {
+    root_.store(NewLeaf(), std::memory_order_release);
+  }
+
+  // Insert key into the tree.
+  // REQUIRES: nothing that compares equal to key is currently in the tree.
+  void Insert(KeyHandle handle) override {
+    bool res = InsertKey(handle);
+    (void)res;
+    assert(res);
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return DoInsert(static_cast<const char*>(handle));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    bool res = InsertKeyConcurrently(handle);
+    (void)res;
+    assert(res);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return DoInsert(static_cast<const char*>(handle));
+  }
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const char* key) const override {
+    Position pos;
+    FindFirst(key, /*inclusive=*/true, &pos);
+    return pos.key != nullptr && cmp_(pos.key, key) == 0;
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    BTreeRep::Iterator iter(this);
+    for (iter.Seek(Slice(), k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  ~BTreeRep() override = default;
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(BTreeRep::Iterator))
+                      :
+                      operator new(sizeof(BTreeRep::Iterator));
+    return new (mem) BTreeRep::Iterator(this);
+  }
+
+ private:
+  static constexpr uint32_t kLeafKeys = 32;
+  static constexpr uint32_t kInnerKeys = 31;
+
+  // The version of a node is incremented by 2 when a writer locks the node,
+  // setting kLockedBit, and by 2 again when it unlocks the node.
+  static constexpr uint64_t kLockedBit = 2;
+
+  struct Node {
+    explicit Node(bool leaf) : is_leaf(leaf) {}
+
+    // Returns the version to validate the reads of the node with, or sets
+    // *restart when the node is locked.
+    uint64_t ReadLockOrRestart(bool* restart) const {
+      uint64_t v = version.load(std::memory_order_acquire);
+      if ((v & kLockedBit) != 0) {
+        *restart = true;
+      }
+      return v;
+    }
+
+    // Sets *restart when the node changed since version v was read
+    void ReadUnlockOrRestart(uint64_t v, bool* restart) const {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version.load(std::memory_order_relaxed) != v) {
+        *restart = true;
+      }
+    }
+
+    // Locks the node, or sets *restart when it changed since version v was
+    // read
+    void UpgradeToWriteLockOrRestart(uint64_t v, bool* restart) {
+      if (!version.compare_exchange_strong(v, v + kLockedBit,
+                                           std::memory_order_acquire)) {
+        *restart = true;
+        return;
+      }
+      // Orders the version before the writes under the lock for the
+      // readers
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void WriteUnlock() {
+      version.fetch_add(kLockedBit, std::memory_order_release);
+    }
+
+    uint32_t Count(uint32_t max_count) const {
+      uint32_t n = count.load(std::memory_order_relaxed);
+      // Bounds an inconsistent read, which fails validation later
+      return n < max_count ? n : max_count;
+    }
+
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint32_t> count{0};
+    const bool is_leaf;
+  };
+
+  // The keys and children are stored with release and loaded with acquire,
+  // as readers dereference them before validating the reads.
+  struct Leaf : public Node {
+    Leaf() : Node(true) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    std::atomic<const char*> keys[kLeafKeys];
+    std::atomic<Leaf*> next{nullptr};
+  };
+
+  // keys[i] is the smallest key in the subtree of children[i + 1]
+  struct Inner : public Node {
+    Inner() : Node(false) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+      for (auto& child : children) {
+        child.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    std::atomic<const char*> keys[kInnerKeys];
+    std::atomic<Node*> children[kInnerKeys + 1];
+  };
+
+  // A key of a leaf, and its index in the leaf when it was found
+  struct Position {
+    Leaf* leaf = nullptr;
+    uint32_t index = 0;
+    const char* key = nullptr;
+  };
+
+  Leaf* NewLeaf() {
+    return new (allocator_->AllocateAligned(sizeof(Leaf))) Leaf();
+  }
+
+  Inner* NewInner() {
+    return new (allocator_->AllocateAligned(sizeof(Inner))) Inner();
+  }
+
+  // Returns the number of the first n keys that are before target, or not
+  // after target when after_equal. Sets *restart when a concurrent write
+  // left a key unset.
+  uint32_t Search(const std::atomic<const char*>* keys, uint32_t n,
+                  const char* target, bool after_equal, bool* restart) const {
+    uint32_t lo = 0;
+    uint32_t hi = n;
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      const char* key = keys[mid].load(std::memory_order_acquire);
+      if (key == nullptr) {
+        *restart = true;
+        return 0;
+      }
+      int c = cmp_(key, target);
+      if (c < 0 || (c == 0 && after_equal)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // Descends to the leaf where target would be inserted, taking at each
+  // inner node the child after the separators before target, or not after
+  // target when after_equal. A null target descends to the first leaf, or
+  // the last one when last.
+  Leaf* FindLeaf(const char* target, bool after_equal, bool last,
+                 bool* restart) const {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t v = node->ReadLockOrRestart(restart);
+    while (!*restart && !node->is_leaf) {
+      const Inner* inner = static_cast<const Inner*>(node);
+      uint32_t n = inner->Count(kInnerKeys);
+      uint32_t index =
+          target == nullptr
+              ? (last ? n : 0)
+              : Search(inner->keys, n, target, after_equal, restart);
+      Node* child = inner->children[index].load(std::memory_order_acquire);
+      inner->ReadUnlockOrRestart(v, restart);
+      if (*restart || child == nullptr) {
+        *restart = true;
+        break;
+      }
+      node = child;
+      v = node->ReadLockOrRestart(restart);
+    }
+    return *restart ? nullptr : static_cast<Leaf*>(node);
+  }
+
+  // Finds the first key after target, or not before target when inclusive,
+  // scanning right from leaf. A null target finds the first key.
+  void FirstFrom(Leaf* leaf, const char* target, bool inclusive,
+                 Position* pos, bool* restart) const {
+    *pos = Position();
+    while (leaf != nullptr) {
+      uint64_t v = leaf->ReadLockOrRestart(restart);
+      if (*restart) {
+        return;
+      }
+      uint32_t n = leaf->Count(kLeafKeys);
+      uint32_t index =
+          target == nullptr
+              ? 0
+              : Search(leaf->keys, n, target, !inclusive, restart);
+      const char* key =
+          index < n ? leaf->keys[index].load(std::memory_order_acquire)
+                    : nullptr;
+      Leaf* next = leaf->next.load(std::memory_order_acquire);
+      leaf->ReadUnlockOrRestart(v, restart);
+      if (*restart) {
+        return;
+      }
+      if (key != nullptr) {
+        *pos = {leaf, index, key};
+        return;
+      }
+      leaf = next;
+    }
+  }
+
+  void FindFirst(const char* target, bool inclusive, Position* pos) const {
+    for (;;) {
+      bool restart = false;
+      Leaf* leaf =
+          FindLeaf(target, /*after_equal=*/true, /*last=*/false, &restart);
+      if (!restart) {
+        FirstFrom(leaf, target, inclusive, pos, &restart);
+      }
+      if (!restart) {
+        return;
+      }
+      port::AsmVolatilePause();
+    }
+  }
+
+  // Finds the last key before target, or not after target when inclusive. A
+  // null target finds the last key.
+  //
+  // The descent takes the child that holds a key before target when there
+  // is one, since the separator of a child is a key of the child. The key
+  // may have moved to a right sibling of the leaf by the time the leaf is
+  // read, hence the scan right.
+  void FindLast(const char* target, bool inclusive, Position* pos) const {
+    for (;;) {
+      bool restart = false;
+      *pos = Position();
+      Leaf* leaf =
+          FindLeaf(target, /*after_equal=*/inclusive, /*last=*/true, &restart);
+      while (!restart && leaf != nullptr) {
+        uint64_t v = leaf->ReadLockOrRestart(&restart);
+        if (restart) {
+          break;
+        }
+        uint32_t n = leaf->Count(kLeafKeys);
+        uint32_t index =
+            target == nullptr
+                ? n
+                : Search(leaf->keys, n, target, inclusive, &restart);
+        const char* key =
+            index > 0 ? leaf->keys[index - 1].load(std::memory_order_acquire)
+                      : nullptr;
+        Leaf* next = leaf->next.load(std::memory_order_acquire);
+        leaf->ReadUnlockOrRestart(v, &restart);
+        if (restart) {
+          break;
+        }
+        if (key != nullptr) {
+          *pos = {leaf, index - 1, key};
+        }
+        // The keys of the right siblings are after target
+        leaf = index < n ? nullptr : next;
+      }
+      if (!restart) {
+        return;
+      }
+      port::AsmVolatilePause();
+    }
+  }
+
+  // Links right, with separator sep, into inner after its child left
+  void InsertChild(Inner* inner, const char* sep, Node* right) {
+    bool restart = false;
+    uint32_t n = inner->Count(kInnerKeys);
+    assert(n < kInnerKeys);
+    uint32_t index =
+        Search(inner->keys, n, sep, /*after_equal=*/true, &restart);
+    assert(!restart);
+    for (uint32_t i = n; i > index; i--) {
+      inner->keys[i].store(inner->keys[i - 1].load(std::memory_order_acquire),
+                           std::memory_order_release);
+      inner->children[i + 1].store(
+          inner->children[i].load(std::memory_order_acquire),
+          std::memory_order_release);
+    }
+    inner->keys[index].store(sep, std::memory_order_release);
+    inner->children[index + 1].store(right, std::memory_order_release);
+    inner->count.store(n + 1, std::memory_order_relaxed);
+  }
+
+  // Moves the upper half of the locked inner to a new node. Returns the new
+  // node and sets *sep to the key separating it from inner.
+  Inner* SplitInner(Inner* inner, const char** sep) {
+    Inner* right = NewInner();
+    uint32_t mid = kInnerKeys / 2;
+    *sep = inner->keys[mid].load(std::memory_order_acquire);
+    uint32_t moved = kInnerKeys - mid - 1;
+    for (uint32_t i = 0; i < moved; i++) {
+      right->keys[i].store(
+          inner->keys[mid + 1 + i].load(std::memory_order_acquire),
+          std::memory_order_release);
+    }
+    for (uint32_t i = 0; i <= moved; i++) {
+      right->children[i].store(
+          inner->children[mid + 1 + i].load(std::memory_order_acquire),
+          std::memory_order_release);
+    }
+    right->count.store(moved, std::memory_order_relaxed);
+    inner->count.store(mid, std::memory_order_relaxed);
+    return right;
+  }
+
+  // Moves the upper half of the locked leaf to a new right sibling. Returns
+  // the new leaf and sets *sep to its first key.
+  Leaf* SplitLeaf(Leaf* leaf, const char** sep) {
+    Leaf* right = NewLeaf();
+    uint32_t mid = kLeafKeys / 2;
+    for (uint32_t i = mid; i < kLeafKeys; i++) {
+      right->keys[i - mid].store(leaf->keys[i].load(std::memory_order_acquire),
+                                 std::memory_order_release);
+    }
+    right->count.store(kLeafKeys - mid, std::memory_order_relaxed);
+    right->next.store(leaf->next.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+    *sep = right->keys[0].load(std::memory_order_acquire);
+    leaf->next.store(right, std::memory_order_release);
+    leaf->count.store(mid, std::memory_order_relaxed);
+    return right;
+  }
+
+  // Links the split halves of the locked root under a new root
+  void NewRoot(Node* left, const char* sep, Node* right) {
+    Inner* root = NewInner();
+    root->keys[0].store(sep, std::memory_order_release);
+    root->children[0].store(left, std::memory_order_release);
+    root->children[1].store(right, std::memory_order_release);
+    root->count.store(1, std::memory_order_relaxed);
+    root_.store(root, std::memory_order_release);
+  }
+
+  // Splits the full node, whose version is v, under parent, whose version is
+  // parent_v, or under a new root when parent is null. Sets *restart when
+  // either changed.
+  void Split(Node* node, uint64_t v, Inner* parent, uint64_t parent_v,
+             bool* restart) {
+    if (parent != nullptr) {
+      parent->UpgradeToWriteLockOrRestart(parent_v, restart);
+      if (*restart) {
+        return;
+      }
+    }
+    node->UpgradeToWriteLockOrRestart(v, restart);
+    if (!*restart && parent == nullptr &&
+        node != root_.load(std::memory_order_acquire)) {
+      node->WriteUnlock();
+      *restart = true;
+    }
+    if (*restart) {
+      if (parent != nullptr) {
+        parent->WriteUnlock();
+      }
+      return;
+    }
+    const char* sep = nullptr;
+    Node* right =
+        node->is_leaf
+            ? static_cast<Node*>(SplitLeaf(static_cast<Leaf*>(node), &sep))
+            : static_cast<Node*>(SplitInner(static_cast<Inner*>(node), &sep));
+    if (parent != nullptr) {
+      InsertChild(parent, sep, right);
+    } else {
+      NewRoot(node, sep, right);
+    }
+    node->WriteUnlock();
+    if (parent != nullptr) {
+      parent->WriteUnlock();
+    }
+  }
+
+  // Inner nodes are split on the way down, so that the parent of a leaf
+  // always has room for the leaf's split.
+  bool DoInsert(const char* key) {
+    for (;; port::AsmVolatilePause()) {
+      bool restart = false;
+      Node* node = root_.load(std::memory_order_acquire);
+      uint64_t v = node->ReadLockOrRestart(&restart);
+      if (restart || node != root_.load(std::memory_order_acquire)) {
+        continue;
+      }
+      Inner* parent = nullptr;
+      uint64_t parent_v = 0;
+      while (!node->is_leaf) {
+        Inner* inner = static_cast<Inner*>(node);
+        if (inner->Count(kInnerKeys) == kInnerKeys) {
+          Split(inner, v, parent, parent_v, &restart);
+          // Restarts to take the new separator into account
+          restart = true;
+          break;
+        }
+        if (parent != nullptr) {
+          parent->ReadUnlockOrRestart(parent_v, &restart);
+          if (restart) {
+            break;
+          }
+        }
+        parent = inner;
+        parent_v = v;
+        uint32_t index = Search(inner->keys, inner->Count(kInnerKeys), key,
+                                /*after_equal=*/true, &restart);
+        node = inner->children[index].load(std::memory_order_acquire);
+        inner->ReadUnlockOrRestart(v, &restart);
+        if (restart) {
+          break;
+        }
+        v = node->ReadLockOrRestart(&restart);
+        if (restart) {
+          break;
+        }
+      }
+      if (restart) {
+        continue;
+      }
+
+      Leaf* leaf = static_cast<Leaf*>(node);
+      if (leaf->Count(kLeafKeys) == kLeafKeys) {
+        Split(leaf, v, parent, parent_v, &restart);
+        continue;
+      }
+      leaf->UpgradeToWriteLockOrRestart(v, &restart);
+      if (restart) {
+        continue;
+      }
+      if (parent != nullptr) {
+        // The leaf still holds the range of the key
+        parent->ReadUnlockOrRestart(parent_v, &restart);
+        if (restart) {
+          leaf->WriteUnlock();
+          continue;
+        }
+      }
+      uint32_t n = leaf->Count(kLeafKeys);
+      uint32_t index =
+          Search(leaf->keys, n, key, /*after_equal=*/false, &restart);
+      assert(!restart);
+      if (index < n &&
+          cmp_(leaf->keys[index].load(std::memory_order_acquire), key) == 0) {
+        leaf->WriteUnlock();
+        return false;
+      }
+      for (uint32_t i = n; i > index; i--) {
+        leaf->keys[i].store(leaf->keys[i - 1].load(std::memory_order_acquire),
+                            std::memory_order_release);
+      }
+      leaf->keys[index].store(key, std::memory_order_release);
+      leaf->count.store(n + 1, std::memory_order_relaxed);
+      leaf->WriteUnlock();
+      return true;
+    }
+  }
+
+  const MemTableRep::KeyComparator& cmp_;
+  std::atomic<Node*> root_{nullptr};
+
+ public:
+  // Iteration over the contents of the tree. The position is the current
+  // key, so that a Next() or Prev() after concurrent inserts finds the key
+  // after or before it wherever the inserts moved it.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const BTreeRep* rep) : rep_(rep) {}
+
+    ~Iterator() override = default;
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const override { return pos_.key != nullptr; }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const override {
+      assert(Valid());
+      return pos_.key;
+    }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next() override {
+      assert(Valid());
+      if (Step(/*forward=*/true)) {
+        return;
+      }
+      const Position cur = pos_;
+      bool restart = false;
+      rep_->FirstFrom(cur.leaf, cur.key, /*inclusive=*/false, &pos_,
+                      &restart);
+      if (restart) {
+        rep_->FindFirst(cur.key, /*inclusive=*/false, &pos_);
+      }
+    }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev() override {
+      assert(Valid());
+      if (!Step(/*forward=*/false)) {
+        const char* cur = pos_.key;
+        rep_->FindLast(cur, /*inclusive=*/false, &pos_);
+      }
+    }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& user_key, const char* memtable_key) override {
+      rep_->FindFirst(
+          memtable_key != nullptr ? memtable_key : EncodeKey(&tmp_, user_key),
+          /*inclusive=*/true, &pos_);
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& user_key, const char* memtable_key) override {
+      rep_->FindLast(
+          memtable_key != nullptr ? memtable_key : EncodeKey(&tmp_, user_key),
+          /*inclusive=*/true, &pos_);
+    }
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst() override {
+      rep_->FindFirst(nullptr, /*inclusive=*/true, &pos_);
+    }
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast() override {
+      rep_->FindLast(nullptr, /*inclusive=*/true, &pos_);
+    }
+
+   private:
+    // Moves to the adjacent key in the current leaf when the leaf did not
+    // change around the current key. Returns false if the caller has to
+    // search instead.
+    bool Step(bool forward) {
+      Leaf* leaf = pos_.leaf;
+      bool restart = false;
+      uint64_t v = leaf->ReadLockOrRestart(&restart);
+      if (restart) {
+        return false;
+      }
+      uint32_t n = leaf->Count(kLeafKeys);
+      uint32_t index = pos_.index;
+      if (index >= n ||
+          leaf->keys[index].load(std::memory_order_acquire) != pos_.key ||
+          (forward ? index + 1 >= n : index == 0)) {
+        return false;
+      }
+      index = forward ? index + 1 : index - 1;
+      const char* key = leaf->keys[index].load(std::memory_order_acquire);
+      leaf->ReadUnlockOrRestart(v, &restart);
+      if (restart || key == nullptr) {
+        return false;
+      }
+      pos_.index = index;
+      pos_.key = key;
+      return true;
+    }
+
+    const BTreeRep* const rep_;
+    Position pos_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+};
+}  // namespace
+
+MemTableRep* BTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new BTreeRep(compare, allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
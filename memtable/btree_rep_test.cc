@@ -0,0 +1,226 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Our test tree stores 8-byte unsigned integers
+using Key = uint64_t;
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+class TestComparator : public MemTableRep::KeyComparator {
+ public:
+  int operator()(const char* a, const char* b) const override {
+    return Compare(Decode(a), Decode(b));
+  }
+
+  int operator()(const char* a, const Slice& b) const override {
+    return Compare(Decode(a), Decode(b.data()));
+  }
+
+ private:
+  static int Compare(Key a, Key b) { return a < b ? -1 : (a > b ? 1 : 0); }
+};
+
+class BTreeRepTest : public testing::Test {
+ public:
+  BTreeRepTest()
+      : rep_(BTreeRepFactory().CreateMemTableRep(cmp_, &arena_, nullptr,
+                                                 nullptr)) {}
+
+  bool Insert(Key key, bool concurrently = false) {
+    char* buf = nullptr;
+    KeyHandle handle = rep_->Allocate(sizeof(Key), &buf);
+    memcpy(buf, &key, sizeof(Key));
+    return concurrently ? rep_->InsertKeyConcurrently(handle)
+                        : rep_->InsertKey(handle);
+  }
+
+  bool Contains(Key key) const {
+    return rep_->Contains(reinterpret_cast<const char*>(&key));
+  }
+
+  static void Seek(MemTableRep::Iterator* iter, Key key) {
+    iter->Seek(Slice(), reinterpret_cast<const char*>(&key));
+  }
+
+  static void SeekForPrev(MemTableRep::Iterator* iter, Key key) {
+    iter->SeekForPrev(Slice(), reinterpret_cast<const char*>(&key));
+  }
+
+  TestComparator cmp_;
+  ConcurrentArena arena_;
+  std::unique_ptr<MemTableRep> rep_;
+};
+
+TEST_F(BTreeRepTest, Empty) {
+  ASSERT_FALSE(Contains(10));
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+  Seek(iter.get(), 100);
+  ASSERT_FALSE(iter->Valid());
+  SeekForPrev(iter.get(), 100);
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekToLast();
+  ASSERT_FALSE(iter->Valid());
+}
+
+TEST_F(BTreeRepTest, InsertAndLookup) {
+  const int N = 5000;
+  const Key R = 10000;
+  Random rnd(1000);
+  std::set<Key> keys;
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    ASSERT_EQ(keys.insert(key).second, Insert(key));
+  }
+
+  for (Key i = 0; i < R; i++) {
+    ASSERT_EQ(keys.count(i) == 1, Contains(i));
+  }
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+  for (Key i = 0; i < R; i++) {
+    auto it = keys.lower_bound(i);
+    Seek(iter.get(), i);
+    if (it == keys.end()) {
+      ASSERT_FALSE(iter->Valid());
+    } else {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(*it, Decode(iter->key()));
+    }
+
+    it = keys.upper_bound(i);
+    SeekForPrev(iter.get(), i);
+    if (it == keys.begin()) {
+      ASSERT_FALSE(iter->Valid());
+    } else {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(*std::prev(it), Decode(iter->key()));
+    }
+  }
+
+  // Forward iteration
+  iter->SeekToFirst();
+  for (Key key : keys) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, Decode(iter->key()));
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  // Backward iteration
+  iter->SeekToLast();
+  for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(*it, Decode(iter->key()));
+    iter->Prev();
+  }
+  ASSERT_FALSE(iter->Valid());
+}
+
+#if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
+// Threads insert interleaved keys while another one checks that iterators
+// see the keys in order, without skipping a key that was inserted before
+// they moved.
+TEST_F(BTreeRepTest, ConcurrentInsert) {
+  const int kThreads = 4;
+  const Key kKeysPerThread = 20000;
+  // The number of keys each thread inserted so far
+  std::atomic<Key> inserted[kThreads];
+  for (auto& count : inserted) {
+    count.store(0);
+  }
+  std::atomic<int> writers_done{0};
+
+  std::vector<port::Thread> writers;
+  for (int t = 0; t < kThreads; t++) {
+    writers.emplace_back([&, t]() {
+      for (Key i = 0; i < kKeysPerThread; i++) {
+        ASSERT_TRUE(Insert(i * kThreads + t, /*concurrently=*/true));
+        inserted[t].store(i + 1, std::memory_order_release);
+      }
+      writers_done.fetch_add(1);
+    });
+  }
+
+  Random rnd(301);
+  while (writers_done.load() < kThreads) {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+    Key snapshot[kThreads];
+    auto take_snapshot = [&]() {
+      for (int t = 0; t < kThreads; t++) {
+        snapshot[t] = inserted[t].load(std::memory_order_acquire);
+      }
+    };
+    Key start = rnd.Next() % (kKeysPerThread * kThreads);
+    take_snapshot();
+    Seek(iter.get(), start);
+    // The first key that the iterator must not have skipped
+    Key expected = start;
+    for (int i = 0; i < 100 && iter->Valid(); i++) {
+      Key key = Decode(iter->key());
+      ASSERT_GE(key, expected);
+      // The keys skipped were not inserted when the iterator moved
+      for (Key skipped = expected; skipped < key; skipped++) {
+        int t = static_cast<int>(skipped % kThreads);
+        ASSERT_LE(snapshot[t], skipped / kThreads);
+      }
+      expected = key + 1;
+      take_snapshot();
+      iter->Next();
+    }
+
+    iter->SeekToLast();
+    Key last = iter->Valid() ? Decode(iter->key()) : 0;
+    for (int i = 0; i < 10 && iter->Valid(); i++) {
+      iter->Prev();
+      if (iter->Valid()) {
+        ASSERT_LT(Decode(iter->key()), last);
+        last = Decode(iter->key());
+      }
+    }
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep_->GetIterator());
+  iter->SeekToFirst();
+  for (Key i = 0; i < kKeysPerThread * kThreads; i++) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(i, Decode(iter->key()));
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_FALSE(Insert(kThreads, /*concurrently=*/true));
+}
+#endif  // !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
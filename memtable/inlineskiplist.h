@@ -176,6 +176,11 @@ class InlineSkipList {
     // Advance to the first entry with a key >= target
     void Seek(const char* target);
 
+    // Like Seek(), but walks the list from key, which must have been
+    // inserted into the list, when it is close before target. No key may
+    // fall between target and key.
+    void SeekFrom(const char* key, const char* target);
+
     // Retreat to the last entry with a key <= target
     void SeekForPrev(const char* target);
 
@@ -408,6 +413,22 @@ inline void InlineSkipList<Comparator>::Iterator::Seek(const char* target) {
   node_ = list_->FindGreaterOrEqual(target);
 }
 
+template <class Comparator>
+inline void InlineSkipList<Comparator>::Iterator::SeekFrom(
+    const char* key, const char* target) {
+  // Further keys are found faster from the top of the list
+  static const int kMaxSteps = 8;
+  Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+  for (int i = 0; x != nullptr && list_->LessThan(x->Key(), target); i++) {
+    if (i == kMaxSteps) {
+      Seek(target);
+      return;
+    }
+    x = x->Next(0);
+  }
+  node_ = x;
+}
+
 template <class Comparator>
 inline void InlineSkipList<Comparator>::Iterator::SeekForPrev(
     const char* target) {
@@ -0,0 +1,88 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/memtable_hash_index.h"
+
+#include <cassert>
+#include <new>
+
+#include "memory/allocator.h"
+#include "util/coding.h"
+#include "util/fastrange.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Decodes the user key and sequence number of a memtable entry
+Slice EntryUserKey(const char* entry, SequenceNumber* seq) {
+  uint32_t key_length = 0;
+  const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+  assert(key_ptr != nullptr && key_length >= 8);
+  if (seq != nullptr) {
+    *seq = DecodeFixed64(key_ptr + key_length - 8) >> 8;
+  }
+  return Slice(key_ptr, key_length - 8);
+}
+}  // namespace
+
+const char* const MemTableHashIndex::kCollision =
+    reinterpret_cast<const char*>(uintptr_t{1});
+
+MemTableHashIndex::MemTableHashIndex(Allocator* allocator,
+                                     uint32_t num_buckets,
+                                     size_t huge_page_tlb_size, Logger* logger)
+    : num_buckets_(num_buckets) {
+  assert(allocator);
+  assert(num_buckets_ > 0);
+  char* raw = allocator->AllocateAligned(
+      sizeof(std::atomic<const char*>) * num_buckets_, huge_page_tlb_size,
+      logger);
+  buckets_ = reinterpret_cast<std::atomic<const char*>*>(raw);
+  for (uint32_t i = 0; i < num_buckets_; i++) {
+    new (&buckets_[i]) std::atomic<const char*>(nullptr);
+  }
+}
+
+std::atomic<const char*>& MemTableHashIndex::Bucket(
+    const Slice& user_key) const {
+  return buckets_[FastRange32(Lower32of64(GetSliceNPHash64(user_key)),
+                              num_buckets_)];
+}
+
+void MemTableHashIndex::Add(const Slice& user_key, SequenceNumber seq,
+                            const char* entry) {
+  std::atomic<const char*>& bucket = Bucket(user_key);
+  const char* cur = bucket.load(std::memory_order_acquire);
+  for (;;) {
+    const char* desired = entry;
+    if (cur == kCollision) {
+      return;
+    } else if (cur != nullptr) {
+      SequenceNumber cur_seq = 0;
+      if (EntryUserKey(cur, &cur_seq) != user_key) {
+        desired = kCollision;
+      } else if (cur_seq >= seq) {
+        // A concurrent writer recorded a newer entry of the key
+        return;
+      }
+    }
+    if (bucket.compare_exchange_weak(cur, desired,
+                                     std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+}
+
+const char* MemTableHashIndex::Find(const Slice& user_key) const {
+  const char* entry = Bucket(user_key).load(std::memory_order_acquire);
+  if (entry == nullptr || entry == kCollision ||
+      EntryUserKey(entry, nullptr) != user_key) {
+    return nullptr;
+  }
+  return entry;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,52 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "db/dbformat.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Allocator;
+class Logger;
+
+// Maps the user keys of a memtable to their latest entry, the encoded
+// internal key and value (see MemTable::Add()), for point lookups to start
+// from (ColumnFamilyOptions::memtable_hash_index_size_ratio).
+//
+// Each bucket holds one entry, updated with a CAS as the key is written.
+// When a second key hashes to a bucket, the bucket is given up instead of
+// switching keys: a later write to the first key could otherwise leave its
+// bucket pointing at an older entry than the latest one.
+//
+// Add() must complete before the entry is published, and the user keys must
+// have no timestamp. Thread-safe.
+class MemTableHashIndex {
+ public:
+  MemTableHashIndex(Allocator* allocator, uint32_t num_buckets,
+                    size_t huge_page_tlb_size = 0, Logger* logger = nullptr);
+
+  // Records entry, which has user_key and seq, if it is the latest entry of
+  // the key
+  void Add(const Slice& user_key, SequenceNumber seq, const char* entry);
+
+  // Returns the latest entry of user_key, or nullptr if not known
+  const char* Find(const Slice& user_key) const;
+
+ private:
+  // The bucket of two keys or more
+  static const char* const kCollision;
+
+  std::atomic<const char*>& Bucket(const Slice& user_key) const;
+
+  uint32_t num_buckets_;
+  std::atomic<const char*>* buckets_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -92,6 +92,18 @@ class SkipListRep : public MemTableRep {
     }
   }
 
+  bool GetFromEntry(const LookupKey& k, const char* entry, void* callback_args,
+                    bool (*callback_func)(void* arg,
+                                          const char* entry)) override {
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter(
+        &skip_list_);
+    for (iter.SeekFrom(entry, k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+    return true;
+  }
+
   uint64_t ApproximateNumEntries(const Slice& start_ikey,
                                  const Slice& end_ikey) override {
     std::string tmp;
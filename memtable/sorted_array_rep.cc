@@ -0,0 +1,191 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#include "memtable/sorted_array_rep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "db/memtable.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+class SortedArrayRep : public MemTableRep {
+ public:
+  SortedArrayRep(const KeyComparator& compare, Allocator* allocator,
+                 size_t count)
+      : MemTableRep(allocator), compare_(compare) {
+    entries_.reserve(count);
+    memory_usage_.store(entries_.capacity() * sizeof(const char*),
+                        std::memory_order_relaxed);
+  }
+
+  void Insert(KeyHandle handle) override {
+    bool inserted = InsertKey(handle);
+    assert(inserted);
+    (void)inserted;
+  }
+
+  // Returns false, without inserting, unless the key sorts after all the
+  // keys inserted before
+  bool InsertKey(KeyHandle handle) override {
+    const char* key = static_cast<char*>(handle);
+    if (!entries_.empty() && compare_(entries_.back(), key) >= 0) {
+      return false;
+    }
+    entries_.push_back(key);
+    memory_usage_.store(entries_.capacity() * sizeof(const char*),
+                        std::memory_order_relaxed);
+    return true;
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKey(handle);
+  }
+
+  bool Contains(const char* key) const override {
+    auto it = LowerBound(key);
+    return it != entries_.end() && compare_(*it, key) == 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    for (auto it = LowerBound(k.memtable_key().data());
+         it != entries_.end() && callback_func(callback_args, *it); ++it) {
+    }
+  }
+
+  uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                 const Slice& end_ikey) override {
+    std::string tmp;
+    auto start = LowerBound(EncodeKey(&tmp, start_ikey));
+    auto end = LowerBound(EncodeKey(&tmp, end_ikey));
+    return end > start ? static_cast<uint64_t>(end - start) : 0;
+  }
+
+  void UniqueRandomSample(const uint64_t num_entries,
+                          const uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    (void)num_entries;
+    entries->clear();
+    const uint64_t size = entries_.size();
+    if (target_sample_size >= size) {
+      entries->insert(entries_.begin(), entries_.end());
+      return;
+    }
+    Random* rnd = Random::GetTLSInstance();
+    // Like SkipListRep, give each pick 5 attempts to find a new entry
+    for (uint64_t i = 0; i < 5 * target_sample_size &&
+                         entries->size() < target_sample_size;
+         i++) {
+      entries->insert(entries_[rnd->Next() % size]);
+    }
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    return memory_usage_.load(std::memory_order_relaxed);
+  }
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const SortedArrayRep* rep)
+        : rep_(rep), pos_(rep->entries_.size()) {}
+
+    bool Valid() const override { return pos_ < rep_->entries_.size(); }
+
+    const char* key() const override {
+      assert(Valid());
+      return rep_->entries_[pos_];
+    }
+
+    void Next() override {
+      assert(Valid());
+      ++pos_;
+    }
+
+    void Prev() override {
+      assert(Valid());
+      // Moving before the first entry invalidates the iterator
+      pos_ = pos_ == 0 ? rep_->entries_.size() : pos_ - 1;
+    }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      const char* encoded_key = memtable_key != nullptr
+                                    ? memtable_key
+                                    : EncodeKey(&tmp_, internal_key);
+      pos_ = rep_->LowerBound(encoded_key) - rep_->entries_.begin();
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      const char* encoded_key = memtable_key != nullptr
+                                    ? memtable_key
+                                    : EncodeKey(&tmp_, internal_key);
+      const auto& entries = rep_->entries_;
+      auto it = std::upper_bound(
+          entries.begin(), entries.end(), encoded_key,
+          [this](const char* a, const char* b) {
+            return rep_->compare_(a, b) < 0;
+          });
+      pos_ = it == entries.begin() ? entries.size()
+                                   : (it - entries.begin()) - 1;
+    }
+
+    void RandomSeek() override {
+      const size_t size = rep_->entries_.size();
+      pos_ = size == 0 ? 0 : Random::GetTLSInstance()->Next() % size;
+    }
+
+    void SeekToFirst() override { pos_ = 0; }
+
+    void SeekToLast() override {
+      const size_t size = rep_->entries_.size();
+      pos_ = size == 0 ? 0 : size - 1;
+    }
+
+   private:
+    const SortedArrayRep* const rep_;
+    size_t pos_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena) override {
+    if (arena == nullptr) {
+      return new Iterator(this);
+    }
+    char* mem = arena->AllocateAligned(sizeof(Iterator));
+    return new (mem) Iterator(this);
+  }
+
+ private:
+  // Returns the first entry not less than key
+  std::vector<const char*>::const_iterator LowerBound(const char* key) const {
+    return std::lower_bound(entries_.begin(), entries_.end(), key,
+                            [this](const char* a, const char* b) {
+                              return compare_(a, b) < 0;
+                            });
+  }
+
+  const KeyComparator& compare_;
+  std::vector<const char*> entries_;
+  // The memory used by entries_, read by other threads
+  std::atomic<size_t> memory_usage_;
+};
+
+}  // namespace
+
+MemTableRep* SortedArrayRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform*, Logger* /*logger*/) {
+  return new SortedArrayRep(compare, allocator, count_);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,40 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Creates MemTableReps that keep their entries in a single array sorted by
+// key, searched by binary search without any lock. Each entry costs one
+// pointer besides its key and value. The entries must be inserted in
+// ascending key order by a single thread before the rep is read, as a
+// mempurge does when it copies the merged immutable memtables and
+// MemTable::Flatten() does when it indexes an immutable memtable; an insert
+// out of order fails.
+//
+// Parameters:
+//   count: The number of entries the array of each rep reserves room for.
+class SortedArrayRepFactory : public MemTableRepFactory {
+ public:
+  explicit SortedArrayRepFactory(size_t count = 0) : count_(count) {}
+
+  static const char* kClassName() { return "SortedArrayRepFactory"; }
+  const char* Name() const override { return kClassName(); }
+
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+
+ private:
+  size_t count_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,279 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+// Micro-benchmarks of the components of the cloud layer that sit on the hot
+// paths of a DBCloud: the epoch lookups of the CLOUDMANIFEST, the records of
+// the log controller, the cloud scheduler, the delayed deletion of cloud
+// files and the remapping of directory listings.
+
+#include "benchmark/benchmark.h"
+#include "cloud/cloud_log_controller_impl.h"
+#include "cloud/cloud_manifest.h"
+#include "cloud/cloud_scheduler.h"
+#include "file/file_util.h"
+#include "file/filename.h"
+#include "rocksdb/cloud/cloud_file_deletion_scheduler.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/env.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Each epoch of the manifests below holds this many file numbers
+static const uint64_t kFilesPerEpoch = 100;
+
+static void CloudManifestGetEpoch(benchmark::State& state) {
+  static std::unique_ptr<CloudManifest> manifest;
+  const uint64_t num_epochs = state.range(0);
+  if (state.thread_index() == 0) {
+    CloudManifest::CreateForEmptyDatabase("epoch0", &manifest)
+        .PermitUncheckedError();
+    for (uint64_t i = 1; i < num_epochs; i++) {
+      manifest->AddEpoch(i * kFilesPerEpoch, "epoch" + std::to_string(i));
+    }
+  }
+  auto rnd = Random(301 + state.thread_index());
+  const int max_file_number = static_cast<int>(num_epochs * kFilesPerEpoch);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manifest->GetEpoch(rnd.Uniform(max_file_number)));
+  }
+
+  if (state.thread_index() == 0) {
+    manifest.reset();
+  }
+}
+
+BENCHMARK(CloudManifestGetEpoch)
+    ->ThreadRange(1, 16)
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(10000)
+    ->ArgName("epochs");
+
+// A cloud file system whose provider stores the bucket in a local directory,
+// with a CLOUDMANIFEST of num_epochs epochs
+struct LocalCloudFileSystem {
+  static Status Create(uint64_t num_epochs,
+                       std::unique_ptr<LocalCloudFileSystem>* result) {
+    auto* env = Env::Default();
+    result->reset(new LocalCloudFileSystem());
+    auto& fs = **result;
+    Status s = env->GetTestDirectory(&fs.dir);
+    if (!s.ok()) {
+      return s;
+    }
+    fs.dir += "/cloud_bench";
+    fs.local_dbname = fs.dir + "/local";
+    DestroyDir(env, fs.dir).PermitUncheckedError();
+    s = env->CreateDirIfMissing(fs.dir);
+    if (s.ok()) {
+      s = env->CreateDirIfMissing(fs.local_dbname);
+    }
+    ConfigOptions config_options;
+    config_options.env = env;
+    if (s.ok()) {
+      // Only the listing of the local directory, which has all the files
+      s = CloudFileSystemEnv::CreateFromString(
+          config_options,
+          "skip_cloud_files_in_getchildren=true;provider={id=local;root=" +
+              fs.dir + "/store};src={bucket=bench;object=db};"
+              "dest={bucket=bench;object=db}",
+          &fs.cfs);
+    }
+    if (s.ok()) {
+      s = fs.cfs->CreateCloudManifest(fs.local_dbname, "");
+    }
+    if (s.ok()) {
+      for (uint64_t i = 1; i < num_epochs; i++) {
+        fs.cfs->GetCloudManifest()->AddEpoch(i * kFilesPerEpoch,
+                                             "epoch" + std::to_string(i));
+      }
+    }
+    return s;
+  }
+
+  ~LocalCloudFileSystem() {
+    cfs.reset();
+    DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  }
+
+  std::string dir;
+  std::string local_dbname;
+  std::unique_ptr<CloudFileSystem> cfs;
+};
+
+static void CloudRemapFilename(benchmark::State& state) {
+  static std::unique_ptr<LocalCloudFileSystem> fs;
+  const uint64_t num_epochs = state.range(0);
+  if (state.thread_index() == 0) {
+    Status s = LocalCloudFileSystem::Create(num_epochs, &fs);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      return;
+    }
+  }
+  auto rnd = Random(301 + state.thread_index());
+  const int max_file_number = static_cast<int>(num_epochs * kFilesPerEpoch);
+  std::vector<std::string> fnames(1024);
+  for (auto& fname : fnames) {
+    fname = MakeTableFileName(fs->local_dbname,
+                              1 + rnd.Uniform(max_file_number));
+  }
+  size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fs->cfs->RemapFilename(fnames[i++ % fnames.size()]));
+  }
+
+  if (state.thread_index() == 0) {
+    fs.reset();
+  }
+}
+
+BENCHMARK(CloudRemapFilename)
+    ->ThreadRange(1, 16)
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(10000)
+    ->ArgName("epochs");
+
+// Lists a local directory with num_files SST files of the current epochs,
+// and as many of past epochs, which GetChildren drops
+static void CloudGetChildren(benchmark::State& state) {
+  const uint64_t num_files = state.range(0);
+  const uint64_t num_epochs = 100;
+  std::unique_ptr<LocalCloudFileSystem> fs;
+  Status s = LocalCloudFileSystem::Create(num_epochs, &fs);
+  for (uint64_t i = 1; s.ok() && i <= num_files; i++) {
+    auto fname = MakeTableFileName(fs->local_dbname, i);
+    s = WriteStringToFile(Env::Default(), "", fs->cfs->RemapFilename(fname));
+    if (s.ok()) {
+      s = WriteStringToFile(Env::Default(), "", fname + "-old");
+    }
+  }
+  if (!s.ok()) {
+    state.SkipWithError(s.ToString().c_str());
+    return;
+  }
+
+  std::vector<std::string> children;
+  for (auto _ : state) {
+    IOStatus io_s = fs->cfs->GetChildren(fs->local_dbname, IOOptions(),
+                                         &children, nullptr /*dbg*/);
+    if (!io_s.ok()) {
+      state.SkipWithError(io_s.ToString().c_str());
+      break;
+    }
+  }
+  state.counters["children"] = static_cast<double>(children.size());
+}
+
+BENCHMARK(CloudGetChildren)->Arg(1000)->Arg(10000)->ArgName("files");
+
+// A log controller whose record codec can be called directly
+struct LogRecordCodec : public CloudLogControllerImpl {
+  using CloudLogControllerImpl::ExtractLogRecord;
+};
+
+static void CloudLogRecordSerialize(benchmark::State& state) {
+  const std::string data(state.range(0), 'v');
+  const std::string fname = "/db/000123.log";
+  std::string record;
+  uint64_t offset = 0;
+
+  for (auto _ : state) {
+    record.clear();
+    CloudLogControllerImpl::SerializeLogRecordAppend(fname, data, offset,
+                                                     &record);
+    offset += data.size();
+    benchmark::DoNotOptimize(record.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(CloudLogRecordSerialize)->Arg(100)->Arg(4096)->ArgName("bytes");
+
+static void CloudLogRecordExtract(benchmark::State& state) {
+  const std::string data(state.range(0), 'v');
+  std::string record;
+  CloudLogControllerImpl::SerializeLogRecordAppend("/db/000123.log", data, 0,
+                                                   &record);
+  uint32_t operation = 0;
+  Slice filename;
+  uint64_t offset = 0;
+  uint64_t file_size = 0;
+  Slice extracted;
+
+  for (auto _ : state) {
+    if (!LogRecordCodec::ExtractLogRecord(record, &operation, &filename,
+                                          &offset, &file_size, &extracted)) {
+      state.SkipWithError("Bad log record");
+      break;
+    }
+    benchmark::DoNotOptimize(extracted.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(CloudLogRecordExtract)->Arg(100)->Arg(4096)->ArgName("bytes");
+
+// Schedules and cancels a job, with `pending` other jobs queued
+static void CloudSchedulerScheduleCancel(benchmark::State& state) {
+  static std::shared_ptr<CloudScheduler> scheduler;
+  const int64_t num_pending = state.range(0);
+  const std::chrono::hours far_future(1);
+  if (state.thread_index() == 0) {
+    scheduler = CloudScheduler::Get();
+    for (int64_t i = 0; i < num_pending; i++) {
+      scheduler->ScheduleJob(far_future, [](void*) {}, nullptr);
+    }
+  }
+
+  for (auto _ : state) {
+    auto handle = scheduler->ScheduleJob(far_future, [](void*) {}, nullptr);
+    scheduler->CancelJob(handle);
+  }
+
+  if (state.thread_index() == 0) {
+    // Cancels the pending jobs
+    scheduler.reset();
+  }
+}
+
+BENCHMARK(CloudSchedulerScheduleCancel)
+    ->ThreadRange(1, 8)
+    ->Arg(0)
+    ->Arg(100000)
+    ->ArgName("pending");
+
+// Schedules and unschedules the deletion of a file, with `pending` other
+// deletions scheduled
+static void CloudFileDeletionScheduleUnschedule(benchmark::State& state) {
+  const int64_t num_pending = state.range(0);
+  auto deletion_scheduler = CloudFileDeletionScheduler::Create(
+      CloudScheduler::Get(), std::chrono::hours(1));
+  for (int64_t i = 0; i < num_pending; i++) {
+    deletion_scheduler
+        ->ScheduleFileDeletion(MakeTableFileName(i + 1), []() {})
+        .PermitUncheckedError();
+  }
+  // Unscheduled right away, so it can be scheduled again
+  const auto fname = MakeTableFileName(num_pending + 1);
+
+  for (auto _ : state) {
+    deletion_scheduler->ScheduleFileDeletion(fname, []() {})
+        .PermitUncheckedError();
+    deletion_scheduler->UnscheduleFileDeletion(fname);
+  }
+}
+
+BENCHMARK(CloudFileDeletionScheduleUnschedule)
+    ->Arg(0)
+    ->Arg(100000)
+    ->ArgName("pending");
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
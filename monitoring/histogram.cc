@@ -17,6 +17,7 @@
 
 #include "port/port.h"
 #include "util/cast_util.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -39,6 +40,11 @@ HistogramBucketMapper::HistogramBucketMapper() {
   }
   maxBucketValue_ = bucketValues_.back();
   minBucketValue_ = bucketValues_.front();
+  for (int i = 0; i < 64; i++) {
+    indexForLog2_[i] = std::lower_bound(bucketValues_.begin(),
+                                        bucketValues_.end(), uint64_t{1} << i) -
+                       bucketValues_.begin();
+  }
 }
 
 size_t HistogramBucketMapper::IndexForValue(const uint64_t value) const {
@@ -46,9 +52,16 @@ size_t HistogramBucketMapper::IndexForValue(const uint64_t value) const {
   auto end = bucketValues_.end();
   if (value >= maxBucketValue_) {
     return end - beg - 1;  // bucketValues_.size() - 1
-  } else {
-    return std::lower_bound(beg, end, value) - beg;
   }
+  if (value == 0) {
+    return 0;
+  }
+  // Same as std::lower_bound(beg, end, value) - beg
+  size_t index = indexForLog2_[FloorLog2(value)];
+  while (bucketValues_[index] < value) {
+    index++;
+  }
+  return index;
 }
 
 namespace {
@@ -228,6 +241,35 @@ std::string HistogramStat::ToString() const {
   return r;
 }
 
+void HistogramStat::AddCountsTo(uint64_t* counts) const {
+  for (unsigned int b = 0; b < num_buckets_; b++) {
+    counts[b] += bucket_at(b);
+  }
+  counts[num_buckets_] += num();
+  counts[num_buckets_ + 1] += sum();
+  counts[num_buckets_ + 2] += sum_squares();
+}
+
+void HistogramStat::SetCounts(const uint64_t* counts, uint64_t min_value,
+                              uint64_t max_value) {
+  uint64_t low = bucketMapper.LastValue();
+  uint64_t high = 0;
+  for (unsigned int b = 0; b < num_buckets_; b++) {
+    buckets_[b].store(counts[b], std::memory_order_relaxed);
+    if (counts[b] > 0) {
+      if (high == 0) {
+        low = (b == 0) ? 0 : bucketMapper.BucketLimit(b - 1) + 1;
+      }
+      high = bucketMapper.BucketLimit(b);
+    }
+  }
+  min_.store(std::max(low, min_value), std::memory_order_relaxed);
+  max_.store(std::min(high, max_value), std::memory_order_relaxed);
+  num_.store(counts[num_buckets_], std::memory_order_relaxed);
+  sum_.store(counts[num_buckets_ + 1], std::memory_order_relaxed);
+  sum_squares_.store(counts[num_buckets_ + 2], std::memory_order_relaxed);
+}
+
 void HistogramStat::Data(HistogramData* const data) const {
   assert(data);
   data->median = Median();
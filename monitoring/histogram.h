@@ -22,7 +22,9 @@ class HistogramBucketMapper {
  public:
   HistogramBucketMapper();
 
-  // converts a value to the bucket index.
+  // converts a value to the bucket index, in constant time: the buckets grow
+  // by 1.5x, so the values with the same floor(log2(value)) fall in one of a
+  // few adjacent buckets.
   size_t IndexForValue(uint64_t value) const;
   // number of buckets required.
 
@@ -41,6 +43,8 @@ class HistogramBucketMapper {
   std::vector<uint64_t> bucketValues_;
   uint64_t maxBucketValue_;
   uint64_t minBucketValue_;
+  // The first bucket of the values with each floor(log2(value))
+  size_t indexForLog2_[64];
 };
 
 struct HistogramStat {
@@ -73,6 +77,15 @@ struct HistogramStat {
   void Data(HistogramData* const data) const;
   std::string ToString() const;
 
+  // Adds the counts of the buckets, then the number, sum and sum of squares
+  // of the values, to counts[0, kNumCounts): the counts that add up over the
+  // cores and subtract between two snapshots.
+  void AddCountsTo(uint64_t* counts) const;
+  // Sets the counts of AddCountsTo(). The min and max are bounded by the
+  // nonempty buckets and by [min_value, max_value].
+  void SetCounts(const uint64_t* counts, uint64_t min_value,
+                 uint64_t max_value);
+
   // To be able to use HistogramStat as thread local variable, it
   // cannot have dynamic allocated member. That's why we're
   // using manually values from BucketMapper
@@ -83,6 +96,9 @@ struct HistogramStat {
   std::atomic_uint_fast64_t sum_squares_;
   std::atomic_uint_fast64_t buckets_[109];  // 109==BucketMapper::BucketCount()
   const uint64_t num_buckets_;
+
+  static constexpr size_t kNumCounts =
+      sizeof(buckets_) / sizeof(*buckets_) + 3;
 };
 
 class Histogram {
@@ -133,6 +149,7 @@ class HistogramImpl : public Histogram {
 
   virtual ~HistogramImpl() {}
 
+  const HistogramStat& GetStats() const { return stats_; }
   inline HistogramStat& TEST_GetStats() { return stats_; }
 
  private:
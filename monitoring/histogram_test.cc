@@ -5,7 +5,9 @@
 //
 #include "monitoring/histogram.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "monitoring/histogram_windowing.h"
 #include "rocksdb/system_clock.h"
@@ -245,6 +247,36 @@ TEST_F(HistogramTest, LostUpdateStandardDeviation) {
   ASSERT_GE(histogram.StandardDeviation(), 0.0);
 }
 
+TEST_F(HistogramTest, IndexForValue) {
+  std::vector<uint64_t> limits;
+  for (size_t b = 0; b < bucketMapper.BucketCount(); b++) {
+    limits.push_back(bucketMapper.BucketLimit(b));
+  }
+  auto expected = [&](uint64_t value) -> size_t {
+    if (value >= bucketMapper.LastValue()) {
+      return limits.size() - 1;
+    }
+    return std::lower_bound(limits.begin(), limits.end(), value) -
+           limits.begin();
+  };
+  for (uint64_t value = 0; value < 100000; value++) {
+    ASSERT_EQ(bucketMapper.IndexForValue(value), expected(value)) << value;
+  }
+  for (auto limit : limits) {
+    for (uint64_t value : {limit - 1, limit, limit + 1}) {
+      ASSERT_EQ(bucketMapper.IndexForValue(value), expected(value)) << value;
+    }
+  }
+  for (int i = 0; i < 64; i++) {
+    uint64_t value = uint64_t{1} << i;
+    for (uint64_t v : {value - 1, value, value + 1}) {
+      ASSERT_EQ(bucketMapper.IndexForValue(v), expected(v)) << v;
+    }
+  }
+  ASSERT_EQ(bucketMapper.IndexForValue(std::numeric_limits<uint64_t>::max()),
+            limits.size() - 1);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -36,6 +36,14 @@ void IOStatsContext::Reset() {
   cpu_write_nanos = 0;
   cpu_read_nanos = 0;
   file_io_stats_by_temperature.Reset();
+  cloud_read_count = 0;
+  cloud_read_bytes = 0;
+  cloud_read_nanos = 0;
+  cloud_readahead_hit_bytes = 0;
+  cloud_file_cache_hit_bytes = 0;
+  cloud_read_wait_nanos = 0;
+  cloud_request_retry_count = 0;
+  cloud_request_retry_delay_nanos = 0;
 #endif  //! NIOSTATS_CONTEXT
 }
 
@@ -69,6 +77,14 @@ std::string IOStatsContext::ToString(bool exclude_zero_counters) const {
   IOSTATS_CONTEXT_OUTPUT(file_io_stats_by_temperature.hot_file_read_count);
   IOSTATS_CONTEXT_OUTPUT(file_io_stats_by_temperature.warm_file_read_count);
   IOSTATS_CONTEXT_OUTPUT(file_io_stats_by_temperature.cold_file_read_count);
+  IOSTATS_CONTEXT_OUTPUT(cloud_read_count);
+  IOSTATS_CONTEXT_OUTPUT(cloud_read_bytes);
+  IOSTATS_CONTEXT_OUTPUT(cloud_read_nanos);
+  IOSTATS_CONTEXT_OUTPUT(cloud_readahead_hit_bytes);
+  IOSTATS_CONTEXT_OUTPUT(cloud_file_cache_hit_bytes);
+  IOSTATS_CONTEXT_OUTPUT(cloud_read_wait_nanos);
+  IOSTATS_CONTEXT_OUTPUT(cloud_request_retry_count);
+  IOSTATS_CONTEXT_OUTPUT(cloud_request_retry_delay_nanos);
   std::string str = ss.str();
   str.erase(str.find_last_not_of(", ") + 1);
   return str;
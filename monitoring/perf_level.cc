@@ -11,6 +11,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 thread_local PerfLevel perf_level = kEnableCount;
+thread_local uint32_t perf_sample_countdown = 0;
 
 void SetPerfLevel(PerfLevel level) {
   assert(level > kUninitialized);
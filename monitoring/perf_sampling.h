@@ -0,0 +1,103 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+
+#include "monitoring/perf_context_imp.h"
+#include "monitoring/perf_level_imp.h"
+#include "monitoring/statistics_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Count down of the operations of the thread until the next sampled one
+extern thread_local uint32_t perf_sample_countdown;
+
+enum class PerfSampleOp { kGet, kWrite };
+
+// Times one in `one_in` operations of the calling thread, as if the perf
+// level were kEnableTimeExceptForMutex for it, and records the time spent in
+// its steps in the SAMPLED_* histograms of `stats` (see
+// DBOptions::perf_sample_one_in). The other operations pay a thread-local
+// decrement. The timings in the perf context of the thread are left as they
+// were before a sampled operation, so a caller reading its own perf context
+// is not affected.
+//
+// Does nothing if the perf level of the thread already times operations
+// (kEnableWait or higher).
+class PerfSampleGuard {
+ public:
+  PerfSampleGuard(uint32_t one_in, Statistics* stats, PerfSampleOp op)
+      : stats_(nullptr), op_(op), saved_level_(perf_level) {
+#if !defined(NPERF_CONTEXT)
+    if (one_in == 0 || stats == nullptr ||
+        perf_level >= PerfLevel::kEnableWait ||
+        stats->get_stats_level() <= StatsLevel::kExceptHistogramOrTimers) {
+      return;
+    }
+    if (perf_sample_countdown > 1) {
+      --perf_sample_countdown;
+      return;
+    }
+    perf_sample_countdown = one_in;
+    stats_ = stats;
+    perf_level = PerfLevel::kEnableTimeExceptForMutex;
+    for (size_t i = 0; i < kNumSteps; ++i) {
+      saved_[i] = *Step(i);
+    }
+#else
+    (void)one_in;
+    (void)stats;
+#endif
+  }
+
+  ~PerfSampleGuard() {
+    if (stats_ == nullptr) {
+      return;
+    }
+    for (size_t i = 0; i < kNumSteps; ++i) {
+      uint64_t* metric = Step(i);
+      RecordInHistogram(stats_, Histogram(i), (*metric - saved_[i]) / 1000);
+      *metric = saved_[i];
+    }
+    perf_level = saved_level_;
+  }
+
+  PerfSampleGuard(const PerfSampleGuard&) = delete;
+  PerfSampleGuard& operator=(const PerfSampleGuard&) = delete;
+
+ private:
+  static constexpr size_t kNumSteps = 4;
+
+  uint64_t* Step(size_t i) const {
+    static uint64_t PerfContext::*const kGetSteps[kNumSteps] = {
+        &PerfContext::get_snapshot_time, &PerfContext::get_from_memtable_time,
+        &PerfContext::get_from_output_files_time,
+        &PerfContext::block_read_time};
+    static uint64_t PerfContext::*const kWriteSteps[kNumSteps] = {
+        &PerfContext::write_thread_wait_nanos, &PerfContext::write_delay_time,
+        &PerfContext::write_wal_time, &PerfContext::write_memtable_time};
+    return &(perf_context.*
+             (op_ == PerfSampleOp::kGet ? kGetSteps : kWriteSteps)[i]);
+  }
+
+  Histograms Histogram(size_t i) const {
+    static const Histograms kGetHistograms[kNumSteps] = {
+        SAMPLED_GET_SNAPSHOT_MICROS, SAMPLED_GET_FROM_MEMTABLE_MICROS,
+        SAMPLED_GET_FROM_FILES_MICROS, SAMPLED_GET_BLOCK_READ_MICROS};
+    static const Histograms kWriteHistograms[kNumSteps] = {
+        SAMPLED_WRITE_THREAD_WAIT_MICROS, SAMPLED_WRITE_DELAY_MICROS,
+        SAMPLED_WRITE_WAL_MICROS, SAMPLED_WRITE_MEMTABLE_MICROS};
+    return (op_ == PerfSampleOp::kGet ? kGetHistograms : kWriteHistograms)[i];
+  }
+
+  Statistics* stats_;
+  const PerfSampleOp op_;
+  const PerfLevel saved_level_;
+  uint64_t saved_[kNumSteps];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
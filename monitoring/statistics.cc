@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdio>
+#include <limits>
 
 #include "monitoring/statistics_impl.h"
 #include "rocksdb/convenience.h"
@@ -266,6 +267,31 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {PREFETCH_BYTES_USEFUL, "rocksdb.prefetch.bytes.useful"},
     {PREFETCH_HITS, "rocksdb.prefetch.hits"},
     {SST_FOOTER_CORRUPTION_COUNT, "rocksdb.footer.corruption.count"},
+    {CLOUD_READ_REQUESTS, "rocksdb.cloud.read.requests"},
+    {CLOUD_WRITE_REQUESTS, "rocksdb.cloud.write.requests"},
+    {CLOUD_LIST_REQUESTS, "rocksdb.cloud.list.requests"},
+    {CLOUD_CREATE_REQUESTS, "rocksdb.cloud.create.requests"},
+    {CLOUD_DELETE_REQUESTS, "rocksdb.cloud.delete.requests"},
+    {CLOUD_COPY_REQUESTS, "rocksdb.cloud.copy.requests"},
+    {CLOUD_INFO_REQUESTS, "rocksdb.cloud.info.requests"},
+    {CLOUD_REQUEST_FAILURES, "rocksdb.cloud.request.failures"},
+    {CLOUD_READ_BYTES, "rocksdb.cloud.read.bytes"},
+    {CLOUD_WRITE_BYTES, "rocksdb.cloud.write.bytes"},
+    {CLOUD_REQUEST_RETRIES, "rocksdb.cloud.request.retries"},
+    {CLOUD_REQUEST_THROTTLES, "rocksdb.cloud.request.throttles"},
+    {CLOUD_REQUEST_THROTTLE_DELAYS, "rocksdb.cloud.request.throttle.delays"},
+    {CLOUD_REQUEST_THROTTLE_DELAY_MICROS,
+     "rocksdb.cloud.request.throttle.delay.micros"},
+    {REPLICATION_RECORDS_APPLIED, "rocksdb.replication.records.applied"},
+    {REPLICATION_BYTES_APPLIED, "rocksdb.replication.bytes.applied"},
+    {POINT_LOOKUP_CACHE_HIT, "rocksdb.point.lookup.cache.hit"},
+    {POINT_LOOKUP_CACHE_MISS, "rocksdb.point.lookup.cache.miss"},
+    {RANGE_FILTER_CHECKED, "rocksdb.range.filter.checked"},
+    {RANGE_FILTER_USEFUL, "rocksdb.range.filter.useful"},
+    {LEVEL_FILTER_CHECKED, "rocksdb.level.filter.checked"},
+    {LEVEL_FILTER_USEFUL, "rocksdb.level.filter.useful"},
+    {TIMESTAMP_FILTER_BLOCK_FILTERED,
+     "rocksdb.timestamp.filter.block.filtered"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -336,6 +362,31 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {ASYNC_PREFETCH_ABORT_MICROS, "rocksdb.async.prefetch.abort.micros"},
     {TABLE_OPEN_PREFETCH_TAIL_READ_BYTES,
      "rocksdb.table.open.prefetch.tail.read.bytes"},
+    {CLOUD_READ_MICROS, "rocksdb.cloud.read.micros"},
+    {CLOUD_WRITE_MICROS, "rocksdb.cloud.write.micros"},
+    {CLOUD_LIST_MICROS, "rocksdb.cloud.list.micros"},
+    {CLOUD_CREATE_MICROS, "rocksdb.cloud.create.micros"},
+    {CLOUD_DELETE_MICROS, "rocksdb.cloud.delete.micros"},
+    {CLOUD_COPY_MICROS, "rocksdb.cloud.copy.micros"},
+    {CLOUD_INFO_MICROS, "rocksdb.cloud.info.micros"},
+    {REPLICATION_MEMTABLE_WRITE_APPLY_MICROS,
+     "rocksdb.replication.memtable.write.apply.micros"},
+    {REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS,
+     "rocksdb.replication.memtable.switch.apply.micros"},
+    {REPLICATION_MANIFEST_WRITE_APPLY_MICROS,
+     "rocksdb.replication.manifest.write.apply.micros"},
+    {REPLICATION_SWITCH_MEMTABLE_MICROS,
+     "rocksdb.replication.switch.memtable.micros"},
+    {SAMPLED_GET_SNAPSHOT_MICROS, "rocksdb.sampled.get.snapshot.micros"},
+    {SAMPLED_GET_FROM_MEMTABLE_MICROS,
+     "rocksdb.sampled.get.from.memtable.micros"},
+    {SAMPLED_GET_FROM_FILES_MICROS, "rocksdb.sampled.get.from.files.micros"},
+    {SAMPLED_GET_BLOCK_READ_MICROS, "rocksdb.sampled.get.block.read.micros"},
+    {SAMPLED_WRITE_THREAD_WAIT_MICROS,
+     "rocksdb.sampled.write.thread.wait.micros"},
+    {SAMPLED_WRITE_DELAY_MICROS, "rocksdb.sampled.write.delay.micros"},
+    {SAMPLED_WRITE_WAL_MICROS, "rocksdb.sampled.write.wal.micros"},
+    {SAMPLED_WRITE_MEMTABLE_MICROS, "rocksdb.sampled.write.memtable.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
@@ -554,6 +605,66 @@ bool StatisticsImpl::getTickerMap(
   return true;
 }
 
+Status StatisticsImpl::getStatsDelta(
+    StatisticsSnapshot* snapshot, std::map<std::string, uint64_t>* tickers,
+    std::map<std::string, HistogramData>* histograms) const {
+  assert(snapshot && tickers && histograms);
+  StatisticsSnapshot current;
+  current.tickers.assign(TICKER_ENUM_MAX, 0);
+  current.histograms.assign(HISTOGRAM_ENUM_MAX,
+                            std::vector<uint64_t>(HistogramStat::kNumCounts));
+  std::vector<uint64_t> mins(HISTOGRAM_ENUM_MAX,
+                             std::numeric_limits<uint64_t>::max());
+  std::vector<uint64_t> maxes(HISTOGRAM_ENUM_MAX, 0);
+  {
+    MutexLock lock(&aggregate_lock_);
+    // One pass over the data of each core
+    for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
+      const auto* data = per_core_stats_.AccessAtCore(core_idx);
+      for (uint32_t t = 0; t < TICKER_ENUM_MAX; ++t) {
+        current.tickers[t] += data->tickers_[t].load(std::memory_order_relaxed);
+      }
+      for (uint32_t h = 0; h < HISTOGRAM_ENUM_MAX; ++h) {
+        const auto& stat = data->histograms_[h].GetStats();
+        stat.AddCountsTo(current.histograms[h].data());
+        mins[h] = std::min(mins[h], stat.min());
+        maxes[h] = std::max(maxes[h], stat.max());
+      }
+    }
+  }
+
+  // A count lower than in the snapshot was reset since
+  auto delta = [](uint64_t count, uint64_t previous) {
+    return count >= previous ? count - previous : count;
+  };
+  const bool has_previous = snapshot->tickers.size() == TICKER_ENUM_MAX &&
+                            snapshot->histograms.size() == HISTOGRAM_ENUM_MAX;
+  tickers->clear();
+  for (const auto& t : TickersNameMap) {
+    (*tickers)[t.second] =
+        delta(current.tickers[t.first],
+              has_previous ? snapshot->tickers[t.first] : 0);
+  }
+  histograms->clear();
+  std::vector<uint64_t> counts(HistogramStat::kNumCounts);
+  for (const auto& h : HistogramsNameMap) {
+    const auto& now = current.histograms[h.first];
+    const std::vector<uint64_t>* previous =
+        has_previous ? &snapshot->histograms[h.first] : nullptr;
+    if (previous != nullptr && previous->size() != counts.size()) {
+      previous = nullptr;
+    }
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] = delta(now[i], previous != nullptr ? (*previous)[i] : 0);
+    }
+    HistogramStat stat;
+    stat.SetCounts(counts.data(), mins[h.first], maxes[h.first]);
+    stat.Data(&(*histograms)[h.second]);
+  }
+  *snapshot = std::move(current);
+  return Status::OK();
+}
+
 bool StatisticsImpl::HistEnabledForType(uint32_t type) const {
   return type < HISTOGRAM_ENUM_MAX;
 }
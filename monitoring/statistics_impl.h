@@ -66,6 +66,9 @@ class StatisticsImpl : public Statistics {
   Status Reset() override;
   std::string ToString() const override;
   bool getTickerMap(std::map<std::string, uint64_t>*) const override;
+  Status getStatsDelta(
+      StatisticsSnapshot* snapshot, std::map<std::string, uint64_t>* tickers,
+      std::map<std::string, HistogramData>* histograms) const override;
   bool HistEnabledForType(uint32_t type) const override;
 
   const Customizable* Inner() const override { return stats_.get(); }
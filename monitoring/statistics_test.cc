@@ -79,6 +79,56 @@ TEST_F(StatisticsTest, NoNameStats) {
   ASSERT_NE(stats->inner, nullptr);
   ASSERT_NE("", stats->inner->ToString(options));  // ... even if it does...
 }
+
+TEST_F(StatisticsTest, StatsDelta) {
+  auto stats = CreateDBStatistics();
+  stats->set_stats_level(StatsLevel::kAll);
+  const auto& ticker_name = TickersNameMap[BLOCK_CACHE_MISS].second;
+  const auto& histogram_name = HistogramsNameMap[DB_GET].second;
+  StatisticsSnapshot snapshot;
+  std::map<std::string, uint64_t> tickers;
+  std::map<std::string, HistogramData> histograms;
+
+  // The totals first
+  stats->recordTick(BLOCK_CACHE_MISS, 5);
+  for (uint64_t i = 1; i <= 100; i++) {
+    stats->recordInHistogram(DB_GET, i);
+  }
+  ASSERT_OK(stats->getStatsDelta(&snapshot, &tickers, &histograms));
+  ASSERT_EQ(tickers.size(), TickersNameMap.size());
+  ASSERT_EQ(histograms.size(), HistogramsNameMap.size());
+  ASSERT_EQ(tickers[ticker_name], 5u);
+  ASSERT_EQ(histograms[histogram_name].count, 100u);
+  ASSERT_EQ(histograms[histogram_name].sum, 5050u);
+  ASSERT_EQ(histograms[histogram_name].max, 100);
+
+  // Then the counts since, which the scrape doesn't reset
+  stats->recordTick(BLOCK_CACHE_MISS, 2);
+  for (uint64_t i = 0; i < 10; i++) {
+    stats->recordInHistogram(DB_GET, 1000);
+  }
+  ASSERT_OK(stats->getStatsDelta(&snapshot, &tickers, &histograms));
+  ASSERT_EQ(tickers[ticker_name], 2u);
+  ASSERT_EQ(stats->getTickerCount(BLOCK_CACHE_MISS), 7u);
+  const auto& data = histograms[histogram_name];
+  ASSERT_EQ(data.count, 10u);
+  ASSERT_EQ(data.sum, 10000u);
+  // Bounded by the bucket of 1000 rather than the min over all time
+  ASSERT_GT(data.min, 100);
+  ASSERT_LE(data.min, 1000);
+  ASSERT_EQ(data.max, 1000);
+  ASSERT_GT(data.median, 100);
+  HistogramData total;
+  stats->histogramData(DB_GET, &total);
+  ASSERT_EQ(total.count, 110u);
+
+  // A reset is seen as counts starting over
+  ASSERT_OK(stats->Reset());
+  stats->recordTick(BLOCK_CACHE_MISS, 1);
+  ASSERT_OK(stats->getStatsDelta(&snapshot, &tickers, &histograms));
+  ASSERT_EQ(tickers[ticker_name], 1u);
+  ASSERT_EQ(histograms[histogram_name].count, 0u);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,80 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/tenant_usage.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "port/port.h"
+#include "util/core_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const char* const kTenantUsageTypeNames[kTenantUsageTypeMax] = {
+    "sst_bytes_read",          "block_cache_bytes_inserted",
+    "flush_bytes_written",     "compaction_bytes_written",
+    "compaction_cpu_micros",
+};
+
+class TenantUsageImpl : public TenantUsage {
+ public:
+  explicit TenantUsageImpl(const std::string& name) : name_(name) {}
+
+  const std::string& GetName() const override { return name_; }
+
+  uint64_t Get(TenantUsageType type) const override {
+    assert(type < kTenantUsageTypeMax);
+    uint64_t sum = 0;
+    for (size_t core = 0; core < per_core_.Size(); ++core) {
+      sum += per_core_.AccessAtCore(core)->counters[type].load(
+          std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  void Reset() override {
+    for (size_t core = 0; core < per_core_.Size(); ++core) {
+      for (auto& counter : per_core_.AccessAtCore(core)->counters) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::string ToString() const override {
+    std::string result;
+    for (uint32_t type = 0; type < kTenantUsageTypeMax; ++type) {
+      if (type > 0) {
+        result.push_back(' ');
+      }
+      result.append(kTenantUsageTypeNames[type]);
+      result.push_back('=');
+      result.append(std::to_string(Get(static_cast<TenantUsageType>(type))));
+    }
+    return result;
+  }
+
+  void Add(TenantUsageType type, uint64_t value) override {
+    assert(type < kTenantUsageTypeMax);
+    per_core_.Access()->counters[type].fetch_add(value,
+                                                 std::memory_order_relaxed);
+  }
+
+ private:
+  struct ALIGN_AS(CACHE_LINE_SIZE) Counters {
+    std::atomic<uint64_t> counters[kTenantUsageTypeMax] = {};
+  };
+
+  const std::string name_;
+  CoreLocalArray<Counters> per_core_;
+};
+}  // namespace
+
+TenantUsage* NewTenantUsage(const std::string& name) {
+  return new TenantUsageImpl(name);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -176,6 +176,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"checksum",
          {offsetof(struct CompressionOptions, checksum), OptionType::kBoolean,
           OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
+        {"adaptive_sample_one_in",
+         {offsetof(struct CompressionOptions, adaptive_sample_one_in),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"adaptive_bytes_per_cpu_micro",
+         {offsetof(struct CompressionOptions, adaptive_bytes_per_cpu_micro),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -250,6 +258,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"allow_trivial_move",
          {offsetof(class CompactionOptionsUniversal, allow_trivial_move),
           OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"reserve_threads_for_subcompactions",
+         {offsetof(class CompactionOptionsUniversal,
+                   reserve_threads_for_subcompactions),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}}};
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -295,6 +308,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, max_compaction_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"compaction_reuse_non_overlapping_files",
+         {offsetof(struct MutableCFOptions,
+                   compaction_reuse_non_overlapping_files),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"ignore_max_compaction_bytes_for_input",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -347,6 +365,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_numa_local_alloc",
+         {offsetof(struct MutableCFOptions, memtable_numa_local_alloc),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_prefix_bloom_huge_page_tlb_size",
          {0, OptionType::kSizeT, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -368,6 +390,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_hash_index_size_ratio",
+         {offsetof(struct MutableCFOptions, memtable_hash_index_size_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"min_partial_merge_operands",
          {0, OptionType::kUInt32T, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -388,10 +414,19 @@ static std::unordered_map<std::string, OptionTypeInfo>
                       max_bytes_for_level_multiplier_additional),
              OptionVerificationType::kNormal, OptionTypeFlags::kMutable,
              {0, OptionType::kInt})},
+        {"penultimate_level_compaction_trigger",
+         {offsetof(struct MutableCFOptions,
+                   penultimate_level_compaction_trigger),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"max_sequential_skip_in_iterations",
          {offsetof(struct MutableCFOptions, max_sequential_skip_in_iterations),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"filter_memory_budget",
+         {offsetof(struct MutableCFOptions, filter_memory_budget),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"target_file_size_base",
          {offsetof(struct MutableCFOptions, target_file_size_base),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -482,6 +517,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    blob_garbage_collection_force_threshold),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"blob_garbage_collection_force_max_batches",
+         {offsetof(struct MutableCFOptions,
+                   blob_garbage_collection_force_max_batches),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"blob_compaction_readahead_size",
          {offsetof(struct MutableCFOptions, blob_compaction_readahead_size),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -511,6 +551,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, experimental_mempurge_threshold),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"experimental_mempurge_sorted_array",
+         {offsetof(struct MutableCFOptions, experimental_mempurge_sorted_array),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"flatten_immutable_memtables",
+         {offsetof(struct MutableCFOptions, flatten_immutable_memtables),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_protection_bytes_per_key",
          {offsetof(struct MutableCFOptions, memtable_protection_bytes_per_key),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
@@ -571,6 +619,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, disable_write_stall),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"write_stall_prediction_secs",
+         {offsetof(struct MutableCFOptions, write_stall_prediction_secs),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         // End special case properties
         {"memtable_max_range_deletions",
          {offsetof(struct MutableCFOptions, memtable_max_range_deletions),
@@ -602,6 +654,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableCFOptions, inplace_update_support),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"inplace_merge_support",
+         {offsetof(struct ImmutableCFOptions, inplace_merge_support),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"level_compaction_dynamic_level_bytes",
          {offsetof(struct ImmutableCFOptions,
                    level_compaction_dynamic_level_bytes),
@@ -826,6 +882,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableCFOptions, persist_user_defined_timestamps),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kCompareLoose}},
+        {"level_filter_bits_per_key",
+         {offsetof(struct ImmutableCFOptions, level_filter_bits_per_key),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 const std::string OptionsHelper::kCFOptionsName = "ColumnFamilyOptions";
@@ -948,6 +1008,7 @@ ImmutableCFOptions::ImmutableCFOptions(const ColumnFamilyOptions& cf_options)
       max_write_buffer_size_to_maintain(
           cf_options.max_write_buffer_size_to_maintain),
       inplace_update_support(cf_options.inplace_update_support),
+      inplace_merge_support(cf_options.inplace_merge_support),
       inplace_callback(cf_options.inplace_callback),
       memtable_factory(cf_options.memtable_factory),
       table_factory(cf_options.table_factory),
@@ -968,9 +1029,14 @@ ImmutableCFOptions::ImmutableCFOptions(const ColumnFamilyOptions& cf_options)
       cf_paths(cf_options.cf_paths),
       compaction_thread_limiter(cf_options.compaction_thread_limiter),
       sst_partitioner_factory(cf_options.sst_partitioner_factory),
+      compression_accelerator(cf_options.compression_accelerator),
+      tenant_usage(cf_options.tenant_usage),
+      compression_dict_trainer(cf_options.compression_dict_trainer),
+      memtable_allocator(cf_options.memtable_allocator),
       blob_cache(cf_options.blob_cache),
       persist_user_defined_timestamps(
-          cf_options.persist_user_defined_timestamps) {}
+          cf_options.persist_user_defined_timestamps),
+      level_filter_bits_per_key(cf_options.level_filter_bits_per_key) {}
 
 ImmutableOptions::ImmutableOptions() : ImmutableOptions(Options()) {}
 
@@ -1063,9 +1129,13 @@ void MutableCFOptions::Dump(Logger* log) const {
                  memtable_prefix_bloom_size_ratio);
   ROCKS_LOG_INFO(log, "              memtable_whole_key_filtering: %d",
                  memtable_whole_key_filtering);
+  ROCKS_LOG_INFO(log, "            memtable_hash_index_size_ratio: %f",
+                 memtable_hash_index_size_ratio);
   ROCKS_LOG_INFO(log,
                  "                  memtable_huge_page_size: %" ROCKSDB_PRIszt,
                  memtable_huge_page_size);
+  ROCKS_LOG_INFO(log, "                memtable_numa_local_alloc: %d",
+                 memtable_numa_local_alloc);
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
@@ -1092,6 +1162,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  level0_stop_writes_trigger);
   ROCKS_LOG_INFO(log, "                     max_compaction_bytes: %" PRIu64,
                  max_compaction_bytes);
+  ROCKS_LOG_INFO(log, "   compaction_reuse_non_overlapping_files: %d",
+                 compaction_reuse_non_overlapping_files);
   ROCKS_LOG_INFO(log, "                    target_file_size_base: %" PRIu64,
                  target_file_size_base);
   ROCKS_LOG_INFO(log, "              target_file_size_multiplier: %d",
@@ -1116,10 +1188,14 @@ void MutableCFOptions::Dump(Logger* log) const {
     result = "";
   }
 
+  ROCKS_LOG_INFO(log, "     penultimate_level_compaction_trigger: %f",
+                 penultimate_level_compaction_trigger);
   ROCKS_LOG_INFO(log, "max_bytes_for_level_multiplier_additional: %s",
                  result.c_str());
   ROCKS_LOG_INFO(log, "        max_sequential_skip_in_iterations: %" PRIu64,
                  max_sequential_skip_in_iterations);
+  ROCKS_LOG_INFO(log, "                     filter_memory_budget: %" PRIu64,
+                 filter_memory_budget);
   ROCKS_LOG_INFO(log, "                     paranoid_file_checks: %d",
                  paranoid_file_checks);
   ROCKS_LOG_INFO(log, "                       report_bg_io_stats: %d",
@@ -1129,6 +1205,12 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                       experimental_mempurge_threshold: %f",
                  experimental_mempurge_threshold);
+  ROCKS_LOG_INFO(log,
+                 "                    experimental_mempurge_sorted_array: %d",
+                 experimental_mempurge_sorted_array);
+  ROCKS_LOG_INFO(log,
+                 "                           flatten_immutable_memtables: %d",
+                 flatten_immutable_memtables);
   ROCKS_LOG_INFO(log, "         bottommost_file_compaction_delay: %" PRIu32,
                  bottommost_file_compaction_delay);
 
@@ -1152,6 +1234,11 @@ void MutableCFOptions::Dump(Logger* log) const {
       static_cast<int>(compaction_options_universal.allow_trivial_move));
   ROCKS_LOG_INFO(log, "compaction_options_universal.incremental        : %d",
                  static_cast<int>(compaction_options_universal.incremental));
+  ROCKS_LOG_INFO(log,
+                 "compaction_options_universal."
+                 "reserve_threads_for_subcompactions : %d",
+                 static_cast<int>(compaction_options_universal
+                                      .reserve_threads_for_subcompactions));
 
   // FIFO Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_fifo.max_table_files_size : %" PRIu64,
@@ -1174,10 +1261,14 @@ void MutableCFOptions::Dump(Logger* log) const {
                  blob_garbage_collection_age_cutoff);
   ROCKS_LOG_INFO(log, "  blob_garbage_collection_force_threshold: %f",
                  blob_garbage_collection_force_threshold);
+  ROCKS_LOG_INFO(log, "blob_garbage_collection_force_max_batches: %d",
+                 blob_garbage_collection_force_max_batches);
   ROCKS_LOG_INFO(log, "           blob_compaction_readahead_size: %" PRIu64,
                  blob_compaction_readahead_size);
   ROCKS_LOG_INFO(log, "                       disable_auto_flush: %d",
                  static_cast<int>(disable_auto_flush));
+  ROCKS_LOG_INFO(log, "              write_stall_prediction_secs: %" PRIu64,
+                 write_stall_prediction_secs);
   ROCKS_LOG_INFO(log, "                 blob_file_starting_level: %d",
                  blob_file_starting_level);
   ROCKS_LOG_INFO(log, "                   prepopulate_blob_cache: %s",
@@ -46,6 +46,8 @@ struct ImmutableCFOptions {
 
   bool inplace_update_support;
 
+  bool inplace_merge_support;
+
   UpdateStatus (*inplace_callback)(char* existing_value,
                                    uint32_t* existing_value_size,
                                    Slice delta_value,
@@ -85,9 +87,19 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory;
 
+  std::shared_ptr<CompressionAccelerator> compression_accelerator;
+
+  std::shared_ptr<TenantUsage> tenant_usage;
+
+  std::shared_ptr<CompressionDictTrainer> compression_dict_trainer;
+
+  std::shared_ptr<MemoryAllocator> memtable_allocator;
+
   std::shared_ptr<Cache> blob_cache;
 
   bool persist_user_defined_timestamps;
+
+  double level_filter_bits_per_key;
 };
 
 struct ImmutableOptions : public ImmutableDBOptions, public ImmutableCFOptions {
@@ -116,13 +128,18 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+        memtable_hash_index_size_ratio(options.memtable_hash_index_size_ratio),
         memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_numa_local_alloc(options.memtable_numa_local_alloc),
         max_successive_merges(options.max_successive_merges),
         strict_max_successive_merges(options.strict_max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
         experimental_mempurge_threshold(
             options.experimental_mempurge_threshold),
+        experimental_mempurge_sorted_array(
+            options.experimental_mempurge_sorted_array),
+        flatten_immutable_memtables(options.flatten_immutable_memtables),
         disable_auto_compactions(options.disable_auto_compactions),
         soft_pending_compaction_bytes_limit(
             options.soft_pending_compaction_bytes_limit),
@@ -133,6 +150,8 @@ struct MutableCFOptions {
         level0_slowdown_writes_trigger(options.level0_slowdown_writes_trigger),
         level0_stop_writes_trigger(options.level0_stop_writes_trigger),
         max_compaction_bytes(options.max_compaction_bytes),
+        compaction_reuse_non_overlapping_files(
+            options.compaction_reuse_non_overlapping_files),
         target_file_size_base(options.target_file_size_base),
         target_file_size_multiplier(options.target_file_size_multiplier),
         max_bytes_for_level_base(options.max_bytes_for_level_base),
@@ -141,6 +160,8 @@ struct MutableCFOptions {
         periodic_compaction_seconds(options.periodic_compaction_seconds),
         max_bytes_for_level_multiplier_additional(
             options.max_bytes_for_level_multiplier_additional),
+        penultimate_level_compaction_trigger(
+            options.penultimate_level_compaction_trigger),
         compaction_options_fifo(options.compaction_options_fifo),
         compaction_options_universal(options.compaction_options_universal),
         enable_blob_files(options.enable_blob_files),
@@ -152,11 +173,14 @@ struct MutableCFOptions {
             options.blob_garbage_collection_age_cutoff),
         blob_garbage_collection_force_threshold(
             options.blob_garbage_collection_force_threshold),
+        blob_garbage_collection_force_max_batches(
+            options.blob_garbage_collection_force_max_batches),
         blob_compaction_readahead_size(options.blob_compaction_readahead_size),
         blob_file_starting_level(options.blob_file_starting_level),
         prepopulate_blob_cache(options.prepopulate_blob_cache),
         max_sequential_skip_in_iterations(
             options.max_sequential_skip_in_iterations),
+        filter_memory_budget(options.filter_memory_budget),
         paranoid_file_checks(options.paranoid_file_checks),
         report_bg_io_stats(options.report_bg_io_stats),
         compression(options.compression),
@@ -175,7 +199,8 @@ struct MutableCFOptions {
         bottommost_file_compaction_delay(
             options.bottommost_file_compaction_delay),
         disable_auto_flush(options.disable_auto_flush),
-        disable_write_stall(options.disable_write_stall) {
+        disable_write_stall(options.disable_write_stall),
+        write_stall_prediction_secs(options.write_stall_prediction_secs) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
   }
 
@@ -185,12 +210,16 @@ struct MutableCFOptions {
         arena_block_size(0),
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
+        memtable_hash_index_size_ratio(0),
         memtable_huge_page_size(0),
+        memtable_numa_local_alloc(false),
         max_successive_merges(0),
         strict_max_successive_merges(false),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
         experimental_mempurge_threshold(0.0),
+        experimental_mempurge_sorted_array(false),
+        flatten_immutable_memtables(false),
         disable_auto_compactions(false),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
@@ -198,12 +227,14 @@ struct MutableCFOptions {
         level0_slowdown_writes_trigger(0),
         level0_stop_writes_trigger(0),
         max_compaction_bytes(0),
+        compaction_reuse_non_overlapping_files(false),
         target_file_size_base(0),
         target_file_size_multiplier(0),
         max_bytes_for_level_base(0),
         max_bytes_for_level_multiplier(0),
         ttl(0),
         periodic_compaction_seconds(0),
+        penultimate_level_compaction_trigger(1),
         compaction_options_fifo(),
         enable_blob_files(false),
         min_blob_size(0),
@@ -212,10 +243,12 @@ struct MutableCFOptions {
         enable_blob_garbage_collection(false),
         blob_garbage_collection_age_cutoff(0.0),
         blob_garbage_collection_force_threshold(0.0),
+        blob_garbage_collection_force_max_batches(0),
         blob_compaction_readahead_size(0),
         blob_file_starting_level(0),
         prepopulate_blob_cache(PrepopulateBlobCache::kDisable),
         max_sequential_skip_in_iterations(0),
+        filter_memory_budget(0),
         paranoid_file_checks(false),
         report_bg_io_stats(false),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
@@ -227,7 +260,8 @@ struct MutableCFOptions {
         sample_for_compression(0),
         memtable_max_range_deletions(0),
         disable_auto_flush(false),
-        disable_write_stall(false) {}
+        disable_write_stall(false),
+        write_stall_prediction_secs(0) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -254,7 +288,9 @@ struct MutableCFOptions {
   size_t arena_block_size;
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
+  double memtable_hash_index_size_ratio;
   size_t memtable_huge_page_size;
+  bool memtable_numa_local_alloc;
   size_t max_successive_merges;
   bool strict_max_successive_merges;
   size_t inplace_update_num_locks;
@@ -275,6 +311,8 @@ struct MutableCFOptions {
   //   ratios.
   // [experimental]
   double experimental_mempurge_threshold;
+  bool experimental_mempurge_sorted_array;
+  bool flatten_immutable_memtables;
 
   // Compaction related options
   bool disable_auto_compactions;
@@ -284,6 +322,7 @@ struct MutableCFOptions {
   int level0_slowdown_writes_trigger;
   int level0_stop_writes_trigger;
   uint64_t max_compaction_bytes;
+  bool compaction_reuse_non_overlapping_files;
   uint64_t target_file_size_base;
   int target_file_size_multiplier;
   uint64_t max_bytes_for_level_base;
@@ -291,6 +330,7 @@ struct MutableCFOptions {
   uint64_t ttl;
   uint64_t periodic_compaction_seconds;
   std::vector<int> max_bytes_for_level_multiplier_additional;
+  double penultimate_level_compaction_trigger;
   CompactionOptionsFIFO compaction_options_fifo;
   CompactionOptionsUniversal compaction_options_universal;
 
@@ -302,12 +342,14 @@ struct MutableCFOptions {
   bool enable_blob_garbage_collection;
   double blob_garbage_collection_age_cutoff;
   double blob_garbage_collection_force_threshold;
+  int blob_garbage_collection_force_max_batches;
   uint64_t blob_compaction_readahead_size;
   int blob_file_starting_level;
   PrepopulateBlobCache prepopulate_blob_cache;
 
   // Misc options
   uint64_t max_sequential_skip_in_iterations;
+  uint64_t filter_memory_budget;
   bool paranoid_file_checks;
   bool report_bg_io_stats;
   CompressionType compression;
@@ -330,6 +372,7 @@ struct MutableCFOptions {
 
   bool disable_auto_flush;
   bool disable_write_stall;
+  uint64_t write_stall_prediction_secs;
 };
 
 uint64_t MultiplyCheckOverflow(uint64_t op1, double op2);
@@ -20,6 +20,7 @@
 #include "rocksdb/rate_limiter.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/statistics.h"
+#include "rocksdb/stats_exporter.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/utilities/options_type.h"
 #include "rocksdb/wal_filter.h"
@@ -67,6 +68,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableDBOptions, max_subcompactions),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"subcompaction_ranges_per_thread",
+         {offsetof(struct MutableDBOptions, subcompaction_ranges_per_thread),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"avoid_flush_during_shutdown",
          {offsetof(struct MutableDBOptions, avoid_flush_during_shutdown),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -119,6 +124,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableDBOptions, compaction_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"compaction_input_pipeline_size",
+         {offsetof(struct MutableDBOptions, compaction_input_pipeline_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"max_background_flushes",
          {offsetof(struct MutableDBOptions, max_background_flushes),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -134,6 +143,7 @@ static std::unordered_map<std::string, OptionTypeInfo>
         /*
          // not yet supported
           std::shared_ptr<Cache> row_cache;
+          std::shared_ptr<Cache> point_lookup_cache;
           std::shared_ptr<DeleteScheduler> delete_scheduler;
           std::shared_ptr<Logger> info_log;
           std::shared_ptr<RateLimiter> rate_limiter;
@@ -149,6 +159,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, allow_mmap_reads),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"populate_mmap_reads",
+         {offsetof(struct ImmutableDBOptions, populate_mmap_reads),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"huge_pages_for_mmap_reads",
+         {offsetof(struct ImmutableDBOptions, huge_pages_for_mmap_reads),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_fallocate",
          {offsetof(struct ImmutableDBOptions, allow_fallocate),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -297,6 +315,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"wal_dir",
          {offsetof(struct ImmutableDBOptions, wal_dir), OptionType::kString,
           OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+        {"secondary_skip_unchanged_wal_dir",
+         {offsetof(struct ImmutableDBOptions,
+                   secondary_skip_unchanged_wal_dir),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"WAL_size_limit_MB",
          {offsetof(struct ImmutableDBOptions, WAL_size_limit_MB),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -313,6 +336,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, persist_stats_to_disk),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"stats_export_period_sec",
+         {offsetof(struct ImmutableDBOptions, stats_export_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"fail_if_options_file_error",
          {offsetof(struct ImmutableDBOptions, fail_if_options_file_error),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -325,10 +352,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, enable_pipelined_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"pipelined_wal_sync",
+         {offsetof(struct ImmutableDBOptions, pipelined_wal_sync),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"unordered_write",
          {offsetof(struct ImmutableDBOptions, unordered_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"share_snapshots",
+         {offsetof(struct ImmutableDBOptions, share_snapshots),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_concurrent_memtable_write",
          {offsetof(struct ImmutableDBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -337,6 +372,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          OptionTypeInfo::Enum<WALRecoveryMode>(
              offsetof(struct ImmutableDBOptions, wal_recovery_mode),
              &wal_recovery_mode_string_map)},
+        {"wal_recovery_pipeline_size",
+         {offsetof(struct ImmutableDBOptions, wal_recovery_pipeline_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct ImmutableDBOptions,
                    enable_write_thread_adaptive_yield),
@@ -346,10 +385,23 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, write_thread_slow_yield_usec),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"write_group_linger_usec",
+         {offsetof(struct ImmutableDBOptions, write_group_linger_usec),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"max_write_batch_group_size_bytes",
          {offsetof(struct ImmutableDBOptions, max_write_batch_group_size_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"memtable_sorted_insert_threshold",
+         {offsetof(struct ImmutableDBOptions,
+                   memtable_sorted_insert_threshold),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"memtable_collapse_overwrites",
+         {offsetof(struct ImmutableDBOptions, memtable_collapse_overwrites),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"write_thread_max_yield_usec",
          {offsetof(struct ImmutableDBOptions, write_thread_max_yield_usec),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -391,6 +443,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, wal_compression),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_compression_dict_bytes",
+         {offsetof(struct ImmutableDBOptions, wal_compression_dict_bytes),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kNone}},
@@ -571,6 +627,22 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    disable_delete_obsolete_files_on_open),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"replication_apply_threads",
+         {offsetof(struct ImmutableDBOptions, replication_apply_threads),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"perf_sample_one_in",
+         {offsetof(struct ImmutableDBOptions, perf_sample_one_in),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_pinned_table_readers",
+         {offsetof(struct ImmutableDBOptions, max_pinned_table_readers),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"multi_cf_iterator_seek_threads",
+         {offsetof(struct ImmutableDBOptions, multi_cf_iterator_seek_threads),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 const std::string OptionsHelper::kDBOptionsName = "DBOptions";
@@ -710,6 +782,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       db_paths(options.db_paths),
       db_log_dir(options.db_log_dir),
       wal_dir(options.wal_dir),
+      secondary_skip_unchanged_wal_dir(
+          options.secondary_skip_unchanged_wal_dir),
       max_log_file_size(options.max_log_file_size),
       log_file_time_to_roll(options.log_file_time_to_roll),
       keep_log_file_num(options.keep_log_file_num),
@@ -720,8 +794,13 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       WAL_size_limit_MB(options.WAL_size_limit_MB),
       max_write_batch_group_size_bytes(
           options.max_write_batch_group_size_bytes),
+      memtable_sorted_insert_threshold(
+          options.memtable_sorted_insert_threshold),
+      memtable_collapse_overwrites(options.memtable_collapse_overwrites),
       manifest_preallocation_size(options.manifest_preallocation_size),
       allow_mmap_reads(options.allow_mmap_reads),
+      populate_mmap_reads(options.populate_mmap_reads),
+      huge_pages_for_mmap_reads(options.huge_pages_for_mmap_reads),
       allow_mmap_writes(options.allow_mmap_writes),
       use_direct_reads(options.use_direct_reads),
       use_direct_io_for_flush_and_compaction(
@@ -731,23 +810,29 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       advise_random_on_open(options.advise_random_on_open),
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
+      memory_governor(options.memory_governor),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
       listeners(options.listeners),
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
+      pipelined_wal_sync(options.pipelined_wal_sync),
       unordered_write(options.unordered_write),
+      share_snapshots(options.share_snapshots),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
       write_thread_max_yield_usec(options.write_thread_max_yield_usec),
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
+      write_group_linger_usec(options.write_group_linger_usec),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       skip_checking_sst_file_sizes_on_db_open(
           options.skip_checking_sst_file_sizes_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_recovery_pipeline_size(options.wal_recovery_pipeline_size),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      point_lookup_cache(options.point_lookup_cache),
       wal_filter(options.wal_filter),
       fail_if_options_file_error(options.fail_if_options_file_error),
       use_options_file(options.use_options_file),
@@ -757,9 +842,12 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
       wal_compression(options.wal_compression),
+      wal_compression_dict_bytes(options.wal_compression_dict_bytes),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
       persist_stats_to_disk(options.persist_stats_to_disk),
+      stats_exporter(options.stats_exporter),
+      stats_export_period_sec(options.stats_export_period_sec),
       write_dbid_to_manifest(options.write_dbid_to_manifest),
       log_readahead_size(options.log_readahead_size),
       file_checksum_gen_factory(options.file_checksum_gen_factory),
@@ -774,7 +862,11 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       compaction_service(options.compaction_service),
       enforce_single_del_contracts(options.enforce_single_del_contracts),
       disable_delete_obsolete_files_on_open(options.disable_delete_obsolete_files_on_open),
-      max_num_replication_epochs(options.max_num_replication_epochs) {
+      max_num_replication_epochs(options.max_num_replication_epochs),
+      replication_apply_threads(options.replication_apply_threads),
+      perf_sample_one_in(options.perf_sample_one_in),
+      max_pinned_table_readers(options.max_pinned_table_readers),
+      multi_cf_iterator_seek_threads(options.multi_cf_iterator_seek_threads) {
   fs = env->GetFileSystem();
   clock = env->GetSystemClock().get();
   logger = info_log.get();
@@ -834,6 +926,10 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    allow_fallocate);
   ROCKS_LOG_HEADER(log, "                       Options.allow_mmap_reads: %d",
                    allow_mmap_reads);
+  ROCKS_LOG_HEADER(log, "                    Options.populate_mmap_reads: %d",
+                   populate_mmap_reads);
+  ROCKS_LOG_HEADER(log, "              Options.huge_pages_for_mmap_reads: %d",
+                   huge_pages_for_mmap_reads);
   ROCKS_LOG_HEADER(log, "                      Options.allow_mmap_writes: %d",
                    allow_mmap_writes);
   ROCKS_LOG_HEADER(log, "                       Options.use_direct_reads: %d",
@@ -848,6 +944,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    db_log_dir.c_str());
   ROCKS_LOG_HEADER(log, "                                Options.wal_dir: %s",
                    wal_dir.c_str());
+  ROCKS_LOG_HEADER(log, "       Options.secondary_skip_unchanged_wal_dir: %d",
+                   secondary_skip_unchanged_wal_dir);
   ROCKS_LOG_HEADER(log, "               Options.table_cache_numshardbits: %d",
                    table_cache_numshardbits);
   ROCKS_LOG_HEADER(log,
@@ -860,6 +958,12 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    "                       "
                    "Options.max_write_batch_group_size_bytes: %" PRIu64,
                    max_write_batch_group_size_bytes);
+  ROCKS_LOG_HEADER(log,
+                   "                       "
+                   "Options.memtable_sorted_insert_threshold: %" ROCKSDB_PRIszt,
+                   memtable_sorted_insert_threshold);
+  ROCKS_LOG_HEADER(log, "          Options.memtable_collapse_overwrites: %d",
+                   memtable_collapse_overwrites);
   ROCKS_LOG_HEADER(
       log, "            Options.manifest_preallocation_size: %" ROCKSDB_PRIszt,
       manifest_preallocation_size);
@@ -872,6 +976,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       db_write_buffer_size);
   ROCKS_LOG_HEADER(log, "                   Options.write_buffer_manager: %p",
                    write_buffer_manager.get());
+  ROCKS_LOG_HEADER(log, "                        Options.memory_governor: %p",
+                   memory_governor.get());
   ROCKS_LOG_HEADER(
       log, "          Options.random_access_max_buffer_size: %" ROCKSDB_PRIszt,
       random_access_max_buffer_size);
@@ -884,12 +990,19 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    static_cast<int>(wal_recovery_mode));
+  ROCKS_LOG_HEADER(
+      log, "             Options.wal_recovery_pipeline_size: %" ROCKSDB_PRIszt,
+      wal_recovery_pipeline_size);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
+  ROCKS_LOG_HEADER(log, "                     Options.pipelined_wal_sync: %d",
+                   pipelined_wal_sync);
   ROCKS_LOG_HEADER(log, "                 Options.unordered_write: %d",
                    unordered_write);
+  ROCKS_LOG_HEADER(log, "                        Options.share_snapshots: %d",
+                   share_snapshots);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
@@ -900,6 +1013,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "           Options.write_thread_slow_yield_usec: %" PRIu64,
                    write_thread_slow_yield_usec);
+  ROCKS_LOG_HEADER(log,
+                   "                Options.write_group_linger_usec: %" PRIu64,
+                   write_group_linger_usec);
   if (row_cache) {
     ROCKS_LOG_HEADER(
         log,
@@ -909,6 +1025,15 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  if (point_lookup_cache) {
+    ROCKS_LOG_HEADER(
+        log,
+        "                     Options.point_lookup_cache: %" ROCKSDB_PRIszt,
+        point_lookup_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                     Options.point_lookup_cache: None");
+  }
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
 
@@ -922,12 +1047,19 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    manual_wal_flush);
   ROCKS_LOG_HEADER(log, "            Options.wal_compression: %d",
                    wal_compression);
+  ROCKS_LOG_HEADER(
+      log, "            Options.wal_compression_dict_bytes: %" ROCKSDB_PRIszt,
+      wal_compression_dict_bytes);
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
                    avoid_unnecessary_blocking_io);
   ROCKS_LOG_HEADER(log, "                Options.persist_stats_to_disk: %u",
                    persist_stats_to_disk);
+  ROCKS_LOG_HEADER(log, "                       Options.stats_exporter: %s",
+                   stats_exporter ? stats_exporter->Name() : "None");
+  ROCKS_LOG_HEADER(log, "              Options.stats_export_period_sec: %u",
+                   stats_export_period_sec);
   ROCKS_LOG_HEADER(log, "                Options.write_dbid_to_manifest: %d",
                    write_dbid_to_manifest);
   ROCKS_LOG_HEADER(
@@ -955,6 +1087,18 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    disable_delete_obsolete_files_on_open ? "true" : "false");
   ROCKS_LOG_HEADER(log, "              Options.max_num_replication_epochs: %d",
                    max_num_replication_epochs);
+  ROCKS_LOG_HEADER(
+      log, "               Options.replication_apply_threads: %" PRIu32,
+      replication_apply_threads);
+  ROCKS_LOG_HEADER(
+      log, "                      Options.perf_sample_one_in: %" PRIu32,
+      perf_sample_one_in);
+  ROCKS_LOG_HEADER(
+      log, "                Options.max_pinned_table_readers: %" PRIu32,
+      max_pinned_table_readers);
+  ROCKS_LOG_HEADER(
+      log, "          Options.multi_cf_iterator_seek_threads: %" PRIu32,
+      multi_cf_iterator_seek_threads);
 }
 
 bool ImmutableDBOptions::IsWalDirSameAsDBPath() const {
@@ -996,6 +1140,7 @@ MutableDBOptions::MutableDBOptions()
     : max_background_jobs(2),
       max_background_compactions(-1),
       max_subcompactions(0),
+      subcompaction_ranges_per_thread(1),
       avoid_flush_during_shutdown(false),
       writable_file_max_buffer_size(1024 * 1024),
       delayed_write_rate(2 * 1024U * 1024U),
@@ -1009,12 +1154,14 @@ MutableDBOptions::MutableDBOptions()
       wal_bytes_per_sync(0),
       strict_bytes_per_sync(false),
       compaction_readahead_size(0),
+      compaction_input_pipeline_size(0),
       max_background_flushes(-1) {}
 
 MutableDBOptions::MutableDBOptions(const DBOptions& options)
     : max_background_jobs(options.max_background_jobs),
       max_background_compactions(options.max_background_compactions),
       max_subcompactions(options.max_subcompactions),
+      subcompaction_ranges_per_thread(options.subcompaction_ranges_per_thread),
       avoid_flush_during_shutdown(options.avoid_flush_during_shutdown),
       writable_file_max_buffer_size(options.writable_file_max_buffer_size),
       delayed_write_rate(options.delayed_write_rate),
@@ -1029,6 +1176,7 @@ MutableDBOptions::MutableDBOptions(const DBOptions& options)
       wal_bytes_per_sync(options.wal_bytes_per_sync),
       strict_bytes_per_sync(options.strict_bytes_per_sync),
       compaction_readahead_size(options.compaction_readahead_size),
+      compaction_input_pipeline_size(options.compaction_input_pipeline_size),
       max_background_flushes(options.max_background_flushes),
       daily_offpeak_time_utc(options.daily_offpeak_time_utc) {}
 
@@ -1039,6 +1187,9 @@ void MutableDBOptions::Dump(Logger* log) const {
                    max_background_compactions);
   ROCKS_LOG_HEADER(log, "            Options.max_subcompactions: %" PRIu32,
                    max_subcompactions);
+  ROCKS_LOG_HEADER(
+      log, "            Options.subcompaction_ranges_per_thread: %" PRIu32,
+      subcompaction_ranges_per_thread);
   ROCKS_LOG_HEADER(log, "            Options.avoid_flush_during_shutdown: %d",
                    avoid_flush_during_shutdown);
   ROCKS_LOG_HEADER(
@@ -1073,6 +1224,9 @@ void MutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "      Options.compaction_readahead_size: %" ROCKSDB_PRIszt,
                    compaction_readahead_size);
+  ROCKS_LOG_HEADER(
+      log, " Options.compaction_input_pipeline_size: %" ROCKSDB_PRIszt,
+      compaction_input_pipeline_size);
   ROCKS_LOG_HEADER(log, "                 Options.max_background_flushes: %d",
                           max_background_flushes);
   ROCKS_LOG_HEADER(log, "Options.daily_offpeak_time_utc: %s",
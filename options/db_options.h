@@ -44,6 +44,7 @@ struct ImmutableDBOptions {
   // directory in use, the GetWalDir or IsWalDirSameAsDBPath
   // methods should be used instead of accessing this variable directly.
   std::string wal_dir;
+  bool secondary_skip_unchanged_wal_dir;
   size_t max_log_file_size;
   size_t log_file_time_to_roll;
   size_t keep_log_file_num;
@@ -53,8 +54,12 @@ struct ImmutableDBOptions {
   uint64_t WAL_ttl_seconds;
   uint64_t WAL_size_limit_MB;
   uint64_t max_write_batch_group_size_bytes;
+  size_t memtable_sorted_insert_threshold;
+  bool memtable_collapse_overwrites;
   size_t manifest_preallocation_size;
   bool allow_mmap_reads;
+  bool populate_mmap_reads;
+  bool huge_pages_for_mmap_reads;
   bool allow_mmap_writes;
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
@@ -63,21 +68,27 @@ struct ImmutableDBOptions {
   bool advise_random_on_open;
   size_t db_write_buffer_size;
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
+  std::shared_ptr<MemoryGovernor> memory_governor;
   size_t random_access_max_buffer_size;
   bool use_adaptive_mutex;
   std::vector<std::shared_ptr<EventListener>> listeners;
   bool enable_thread_tracking;
   bool enable_pipelined_write;
+  bool pipelined_wal_sync;
   bool unordered_write;
+  bool share_snapshots;
   bool allow_concurrent_memtable_write;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
   uint64_t write_thread_slow_yield_usec;
+  uint64_t write_group_linger_usec;
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  size_t wal_recovery_pipeline_size;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<Cache> point_lookup_cache;
   WalFilter* wal_filter;
   bool fail_if_options_file_error;
   bool use_options_file;
@@ -87,9 +98,12 @@ struct ImmutableDBOptions {
   bool two_write_queues;
   bool manual_wal_flush;
   CompressionType wal_compression;
+  size_t wal_compression_dict_bytes;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
+  std::shared_ptr<StatsExporter> stats_exporter;
+  unsigned int stats_export_period_sec;
   bool write_dbid_to_manifest;
   size_t log_readahead_size;
   std::shared_ptr<FileChecksumGenFactory> file_checksum_gen_factory;
@@ -110,6 +124,10 @@ struct ImmutableDBOptions {
   bool enforce_single_del_contracts;
   bool disable_delete_obsolete_files_on_open;
   uint32_t max_num_replication_epochs;
+  uint32_t replication_apply_threads;
+  uint32_t perf_sample_one_in;
+  uint32_t max_pinned_table_readers;
+  uint32_t multi_cf_iterator_seek_threads;
 
   bool IsWalDirSameAsDBPath() const;
   bool IsWalDirSameAsDBPath(const std::string& path) const;
@@ -127,6 +145,7 @@ struct MutableDBOptions {
   int max_background_jobs;
   int max_background_compactions;
   uint32_t max_subcompactions;
+  uint32_t subcompaction_ranges_per_thread;
   bool avoid_flush_during_shutdown;
   size_t writable_file_max_buffer_size;
   uint64_t delayed_write_rate;
@@ -140,6 +159,7 @@ struct MutableDBOptions {
   uint64_t wal_bytes_per_sync;
   bool strict_bytes_per_sync;
   size_t compaction_readahead_size;
+  size_t compaction_input_pipeline_size;
   int max_background_flushes;
   std::string daily_offpeak_time_utc;
 };
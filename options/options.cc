@@ -19,6 +19,7 @@
 #include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/comparator.h"
+#include "rocksdb/compression_accelerator.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/memtablerep.h"
@@ -49,12 +50,18 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.max_write_buffer_size_to_maintain),
       inplace_update_support(options.inplace_update_support),
       inplace_update_num_locks(options.inplace_update_num_locks),
+      inplace_merge_support(options.inplace_merge_support),
       experimental_mempurge_threshold(options.experimental_mempurge_threshold),
+      experimental_mempurge_sorted_array(
+          options.experimental_mempurge_sorted_array),
+      flatten_immutable_memtables(options.flatten_immutable_memtables),
       inplace_callback(options.inplace_callback),
       memtable_prefix_bloom_size_ratio(
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+      memtable_hash_index_size_ratio(options.memtable_hash_index_size_ratio),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_numa_local_alloc(options.memtable_numa_local_alloc),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
       bloom_locality(options.bloom_locality),
@@ -70,7 +77,11 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       max_bytes_for_level_multiplier(options.max_bytes_for_level_multiplier),
       max_bytes_for_level_multiplier_additional(
           options.max_bytes_for_level_multiplier_additional),
+      penultimate_level_compaction_trigger(
+          options.penultimate_level_compaction_trigger),
       max_compaction_bytes(options.max_compaction_bytes),
+      compaction_reuse_non_overlapping_files(
+          options.compaction_reuse_non_overlapping_files),
       soft_pending_compaction_bytes_limit(
           options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
@@ -87,6 +98,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       max_successive_merges(options.max_successive_merges),
       strict_max_successive_merges(options.strict_max_successive_merges),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      level_filter_bits_per_key(options.level_filter_bits_per_key),
+      filter_memory_budget(options.filter_memory_budget),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
@@ -108,6 +121,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.blob_garbage_collection_age_cutoff),
       blob_garbage_collection_force_threshold(
           options.blob_garbage_collection_force_threshold),
+      blob_garbage_collection_force_max_batches(
+          options.blob_garbage_collection_force_max_batches),
       blob_compaction_readahead_size(options.blob_compaction_readahead_size),
       blob_file_starting_level(options.blob_file_starting_level),
       blob_cache(options.blob_cache),
@@ -155,6 +170,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, " Options.sst_partitioner_factory: %s",
       sst_partitioner_factory ? sst_partitioner_factory->Name() : "None");
+  ROCKS_LOG_HEADER(
+      log, " Options.compression_accelerator: %s",
+      compression_accelerator ? compression_accelerator->Name() : "None");
   ROCKS_LOG_HEADER(log, "        Options.memtable_factory: %s",
                    memtable_factory->Name());
   ROCKS_LOG_HEADER(log, "           Options.table_factory: %s",
@@ -285,12 +303,17 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                "]: %d",
           i, max_bytes_for_level_multiplier_additional[i]);
     }
+    ROCKS_LOG_HEADER(log, "   Options.penultimate_level_compaction_trigger: %f",
+                     penultimate_level_compaction_trigger);
     ROCKS_LOG_HEADER(
         log, "      Options.max_sequential_skip_in_iterations: %" PRIu64,
         max_sequential_skip_in_iterations);
     ROCKS_LOG_HEADER(
         log, "                   Options.max_compaction_bytes: %" PRIu64,
         max_compaction_bytes);
+    ROCKS_LOG_HEADER(
+        log, " Options.compaction_reuse_non_overlapping_files: %d",
+        compaction_reuse_non_overlapping_files);
     ROCKS_LOG_HEADER(
         log,
         "                       Options.arena_block_size: %" ROCKSDB_PRIszt,
@@ -376,6 +399,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                  Options.inplace_update_support: %d",
                      inplace_update_support);
+    ROCKS_LOG_HEADER(log,
+                     "                   Options.inplace_merge_support: %d",
+                     inplace_merge_support);
     ROCKS_LOG_HEADER(
         log,
         "                Options.inplace_update_num_locks: %" ROCKSDB_PRIszt,
@@ -387,9 +413,14 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "              Options.memtable_whole_key_filtering: %d",
                      memtable_whole_key_filtering);
+    ROCKS_LOG_HEADER(
+        log, "              Options.memtable_hash_index_size_ratio: %f",
+        memtable_hash_index_size_ratio);
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_numa_local_alloc: %d",
+                     memtable_numa_local_alloc);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
@@ -404,6 +435,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
+    ROCKS_LOG_HEADER(log,
+                     "               Options.level_filter_bits_per_key: %f",
+                     level_filter_bits_per_key);
+    ROCKS_LOG_HEADER(
+        log, "                    Options.filter_memory_budget: %" PRIu64,
+        filter_memory_budget);
     ROCKS_LOG_HEADER(log, "               Options.paranoid_file_checks: %d",
                      paranoid_file_checks);
     ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
@@ -446,6 +483,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      blob_garbage_collection_age_cutoff);
     ROCKS_LOG_HEADER(log, "Options.blob_garbage_collection_force_threshold: %f",
                      blob_garbage_collection_force_threshold);
+    ROCKS_LOG_HEADER(
+        log, "Options.blob_garbage_collection_force_max_batches: %d",
+        blob_garbage_collection_force_max_batches);
     ROCKS_LOG_HEADER(
         log, "         Options.blob_compaction_readahead_size: %" PRIu64,
         blob_compaction_readahead_size);
@@ -453,6 +493,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      disable_auto_flush);
     ROCKS_LOG_HEADER(log, "                    Options.disable_write_stall: %d",
                      disable_write_stall);
+    ROCKS_LOG_HEADER(
+        log, "            Options.write_stall_prediction_secs: %" PRIu64,
+        write_stall_prediction_secs);
     ROCKS_LOG_HEADER(log, "               Options.blob_file_starting_level: %d",
                      blob_file_starting_level);
     if (blob_cache) {
@@ -468,6 +511,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     }
     ROCKS_LOG_HEADER(log, "        Options.experimental_mempurge_threshold: %f",
                      experimental_mempurge_threshold);
+    ROCKS_LOG_HEADER(log, "     Options.experimental_mempurge_sorted_array: %d",
+                     experimental_mempurge_sorted_array);
+    ROCKS_LOG_HEADER(log, "            Options.flatten_immutable_memtables: %d",
+                     flatten_immutable_memtables);
     ROCKS_LOG_HEADER(log, "           Options.memtable_max_range_deletions: %d",
                      memtable_max_range_deletions);
 }  // ColumnFamilyOptions::Dump
@@ -83,6 +83,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.db_paths = immutable_db_options.db_paths;
   options.db_log_dir = immutable_db_options.db_log_dir;
   options.wal_dir = immutable_db_options.wal_dir;
+  options.secondary_skip_unchanged_wal_dir =
+      immutable_db_options.secondary_skip_unchanged_wal_dir;
   options.delete_obsolete_files_period_micros =
       mutable_db_options.delete_obsolete_files_period_micros;
   options.max_background_jobs = mutable_db_options.max_background_jobs;
@@ -92,6 +94,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_bytes_per_sync = mutable_db_options.wal_bytes_per_sync;
   options.strict_bytes_per_sync = mutable_db_options.strict_bytes_per_sync;
   options.max_subcompactions = mutable_db_options.max_subcompactions;
+  options.subcompaction_ranges_per_thread =
+      mutable_db_options.subcompaction_ranges_per_thread;
   options.max_background_flushes = mutable_db_options.max_background_flushes;
   options.max_log_file_size = immutable_db_options.max_log_file_size;
   options.log_file_time_to_roll = immutable_db_options.log_file_time_to_roll;
@@ -105,6 +109,9 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.manifest_preallocation_size =
       immutable_db_options.manifest_preallocation_size;
   options.allow_mmap_reads = immutable_db_options.allow_mmap_reads;
+  options.populate_mmap_reads = immutable_db_options.populate_mmap_reads;
+  options.huge_pages_for_mmap_reads =
+      immutable_db_options.huge_pages_for_mmap_reads;
   options.allow_mmap_writes = immutable_db_options.allow_mmap_writes;
   options.use_direct_reads = immutable_db_options.use_direct_reads;
   options.use_direct_io_for_flush_and_compaction =
@@ -115,13 +122,19 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.stats_persist_period_sec =
       mutable_db_options.stats_persist_period_sec;
   options.persist_stats_to_disk = immutable_db_options.persist_stats_to_disk;
+  options.stats_exporter = immutable_db_options.stats_exporter;
+  options.stats_export_period_sec =
+      immutable_db_options.stats_export_period_sec;
   options.stats_history_buffer_size =
       mutable_db_options.stats_history_buffer_size;
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
   options.db_write_buffer_size = immutable_db_options.db_write_buffer_size;
   options.write_buffer_manager = immutable_db_options.write_buffer_manager;
+  options.memory_governor = immutable_db_options.memory_governor;
   options.compaction_readahead_size =
       mutable_db_options.compaction_readahead_size;
+  options.compaction_input_pipeline_size =
+      mutable_db_options.compaction_input_pipeline_size;
   options.random_access_max_buffer_size =
       immutable_db_options.random_access_max_buffer_size;
   options.writable_file_max_buffer_size =
@@ -131,24 +144,35 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
+  options.pipelined_wal_sync = immutable_db_options.pipelined_wal_sync;
   options.unordered_write = immutable_db_options.unordered_write;
+  options.share_snapshots = immutable_db_options.share_snapshots;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
   options.enable_write_thread_adaptive_yield =
       immutable_db_options.enable_write_thread_adaptive_yield;
   options.max_write_batch_group_size_bytes =
       immutable_db_options.max_write_batch_group_size_bytes;
+  options.memtable_sorted_insert_threshold =
+      immutable_db_options.memtable_sorted_insert_threshold;
+  options.memtable_collapse_overwrites =
+      immutable_db_options.memtable_collapse_overwrites;
   options.write_thread_max_yield_usec =
       immutable_db_options.write_thread_max_yield_usec;
   options.write_thread_slow_yield_usec =
       immutable_db_options.write_thread_slow_yield_usec;
+  options.write_group_linger_usec =
+      immutable_db_options.write_group_linger_usec;
   options.skip_stats_update_on_db_open =
       immutable_db_options.skip_stats_update_on_db_open;
   options.skip_checking_sst_file_sizes_on_db_open =
       immutable_db_options.skip_checking_sst_file_sizes_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_pipeline_size =
+      immutable_db_options.wal_recovery_pipeline_size;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.point_lookup_cache = immutable_db_options.point_lookup_cache;
   options.wal_filter = immutable_db_options.wal_filter;
   options.fail_if_options_file_error =
       immutable_db_options.fail_if_options_file_error;
@@ -162,6 +186,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
   options.wal_compression = immutable_db_options.wal_compression;
+  options.wal_compression_dict_bytes =
+      immutable_db_options.wal_compression_dict_bytes;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
@@ -183,6 +209,13 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.enforce_single_del_contracts;
   options.disable_delete_obsolete_files_on_open =
       immutable_db_options.disable_delete_obsolete_files_on_open;
+  options.replication_apply_threads =
+      immutable_db_options.replication_apply_threads;
+  options.perf_sample_one_in = immutable_db_options.perf_sample_one_in;
+  options.max_pinned_table_readers =
+      immutable_db_options.max_pinned_table_readers;
+  options.multi_cf_iterator_seek_threads =
+      immutable_db_options.multi_cf_iterator_seek_threads;
   options.daily_offpeak_time_utc = mutable_db_options.daily_offpeak_time_utc;
   return options;
 }
@@ -206,15 +239,22 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->memtable_prefix_bloom_size_ratio =
       moptions.memtable_prefix_bloom_size_ratio;
   cf_opts->memtable_whole_key_filtering = moptions.memtable_whole_key_filtering;
+  cf_opts->memtable_hash_index_size_ratio =
+      moptions.memtable_hash_index_size_ratio;
   cf_opts->memtable_huge_page_size = moptions.memtable_huge_page_size;
+  cf_opts->memtable_numa_local_alloc = moptions.memtable_numa_local_alloc;
   cf_opts->max_successive_merges = moptions.max_successive_merges;
   cf_opts->strict_max_successive_merges = moptions.strict_max_successive_merges;
   cf_opts->inplace_update_num_locks = moptions.inplace_update_num_locks;
   cf_opts->prefix_extractor = moptions.prefix_extractor;
   cf_opts->disable_auto_flush = moptions.disable_auto_flush;
   cf_opts->disable_write_stall = moptions.disable_write_stall;
+  cf_opts->write_stall_prediction_secs = moptions.write_stall_prediction_secs;
   cf_opts->experimental_mempurge_threshold =
       moptions.experimental_mempurge_threshold;
+  cf_opts->experimental_mempurge_sorted_array =
+      moptions.experimental_mempurge_sorted_array;
+  cf_opts->flatten_immutable_memtables = moptions.flatten_immutable_memtables;
   cf_opts->memtable_protection_bytes_per_key =
       moptions.memtable_protection_bytes_per_key;
   cf_opts->block_protection_bytes_per_key =
@@ -234,11 +274,15 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.level0_slowdown_writes_trigger;
   cf_opts->level0_stop_writes_trigger = moptions.level0_stop_writes_trigger;
   cf_opts->max_compaction_bytes = moptions.max_compaction_bytes;
+  cf_opts->compaction_reuse_non_overlapping_files =
+      moptions.compaction_reuse_non_overlapping_files;
   cf_opts->target_file_size_base = moptions.target_file_size_base;
   cf_opts->target_file_size_multiplier = moptions.target_file_size_multiplier;
   cf_opts->max_bytes_for_level_base = moptions.max_bytes_for_level_base;
   cf_opts->max_bytes_for_level_multiplier =
       moptions.max_bytes_for_level_multiplier;
+  cf_opts->penultimate_level_compaction_trigger =
+      moptions.penultimate_level_compaction_trigger;
   cf_opts->ttl = moptions.ttl;
   cf_opts->periodic_compaction_seconds = moptions.periodic_compaction_seconds;
 
@@ -261,6 +305,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.blob_garbage_collection_age_cutoff;
   cf_opts->blob_garbage_collection_force_threshold =
       moptions.blob_garbage_collection_force_threshold;
+  cf_opts->blob_garbage_collection_force_max_batches =
+      moptions.blob_garbage_collection_force_max_batches;
   cf_opts->blob_compaction_readahead_size =
       moptions.blob_compaction_readahead_size;
   cf_opts->blob_file_starting_level = moptions.blob_file_starting_level;
@@ -269,6 +315,7 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   // Misc options
   cf_opts->max_sequential_skip_in_iterations =
       moptions.max_sequential_skip_in_iterations;
+  cf_opts->filter_memory_budget = moptions.filter_memory_budget;
   cf_opts->paranoid_file_checks = moptions.paranoid_file_checks;
   cf_opts->report_bg_io_stats = moptions.report_bg_io_stats;
   cf_opts->compression = moptions.compression;
@@ -297,6 +344,7 @@ void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
   cf_opts->max_write_buffer_size_to_maintain =
       ioptions.max_write_buffer_size_to_maintain;
   cf_opts->inplace_update_support = ioptions.inplace_update_support;
+  cf_opts->inplace_merge_support = ioptions.inplace_merge_support;
   cf_opts->inplace_callback = ioptions.inplace_callback;
   cf_opts->memtable_factory = ioptions.memtable_factory;
   cf_opts->table_factory = ioptions.table_factory;
@@ -307,12 +355,17 @@ void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
       ioptions.level_compaction_dynamic_level_bytes;
   cf_opts->num_levels = ioptions.num_levels;
   cf_opts->optimize_filters_for_hits = ioptions.optimize_filters_for_hits;
+  cf_opts->level_filter_bits_per_key = ioptions.level_filter_bits_per_key;
   cf_opts->force_consistency_checks = ioptions.force_consistency_checks;
   cf_opts->memtable_insert_with_hint_prefix_extractor =
       ioptions.memtable_insert_with_hint_prefix_extractor;
   cf_opts->cf_paths = ioptions.cf_paths;
   cf_opts->compaction_thread_limiter = ioptions.compaction_thread_limiter;
   cf_opts->sst_partitioner_factory = ioptions.sst_partitioner_factory;
+  cf_opts->compression_accelerator = ioptions.compression_accelerator;
+  cf_opts->tenant_usage = ioptions.tenant_usage;
+  cf_opts->compression_dict_trainer = ioptions.compression_dict_trainer;
+  cf_opts->memtable_allocator = ioptions.memtable_allocator;
   cf_opts->blob_cache = ioptions.blob_cache;
   cf_opts->preclude_last_level_data_seconds =
       ioptions.preclude_last_level_data_seconds;
@@ -183,6 +183,9 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
       "data_block_hash_table_util_ratio=0.75;"
+      "data_block_restart_key_prefixes=true;"
+      "index_block_restart_key_model=true;"
+      "cache_mmap_read_blocks=true;"
       "checksum=kxxHash;no_block_cache=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
@@ -193,6 +196,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;detect_filter_"
       "construct_corruption=false;"
+      "range_filter_bits_per_key=10;"
+      "block_timestamp_index=true;"
       "format_version=1;"
       "verify_compression=true;read_amp_bytes_per_bit=0;"
       "enable_index_compression=false;"
@@ -200,7 +205,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "max_auto_readahead_size=0;"
       "prepopulate_block_cache=kDisable;"
       "initial_auto_readahead_size=0;"
-      "num_file_reads_for_auto_readahead=0",
+      "num_file_reads_for_auto_readahead=0;"
+      "learned_auto_readahead=true",
       new_bbto));
 
   ASSERT_EQ(unset_bytes_base,
@@ -235,14 +241,20 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, info_log), sizeof(std::shared_ptr<Logger>)},
       {offsetof(struct DBOptions, statistics),
        sizeof(std::shared_ptr<Statistics>)},
+      {offsetof(struct DBOptions, stats_exporter),
+       sizeof(std::shared_ptr<StatsExporter>)},
       {offsetof(struct DBOptions, db_paths), sizeof(std::vector<DbPath>)},
       {offsetof(struct DBOptions, db_log_dir), sizeof(std::string)},
       {offsetof(struct DBOptions, wal_dir), sizeof(std::string)},
       {offsetof(struct DBOptions, write_buffer_manager),
        sizeof(std::shared_ptr<WriteBufferManager>)},
+      {offsetof(struct DBOptions, memory_governor),
+       sizeof(std::shared_ptr<MemoryGovernor>)},
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, point_lookup_cache),
+       sizeof(std::shared_ptr<Cache>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
       {offsetof(struct DBOptions, file_checksum_gen_factory),
        sizeof(std::shared_ptr<FileChecksumGenFactory>)},
@@ -288,9 +300,13 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "WAL_ttl_seconds=4295008036;"
                              "WAL_size_limit_MB=4295036161;"
                              "max_write_batch_group_size_bytes=1048576;"
+                             "memtable_sorted_insert_threshold=1024;"
+                             "memtable_collapse_overwrites=true;"
                              "wal_dir=path/to/wal_dir;"
+                             "secondary_skip_unchanged_wal_dir=true;"
                              "db_write_buffer_size=2587;"
                              "max_subcompactions=64330;"
+                             "subcompaction_ranges_per_thread=4;"
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
@@ -300,6 +316,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "use_adaptive_mutex=false;"
                              "max_total_wal_size=4295005604;"
                              "compaction_readahead_size=0;"
+                             "compaction_input_pipeline_size=0;"
                              "keep_log_file_num=4890;"
                              "skip_stats_update_on_db_open=false;"
                              "skip_checking_sst_file_sizes_on_db_open=false;"
@@ -328,8 +345,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "stats_persist_period_sec=54321;"
                              "persist_stats_to_disk=true;"
                              "stats_history_buffer_size=14159;"
+                             "stats_export_period_sec=17;"
                              "allow_fallocate=true;"
                              "allow_mmap_reads=false;"
+                             "populate_mmap_reads=false;"
+                             "huge_pages_for_mmap_reads=false;"
                              "use_direct_reads=false;"
                              "use_direct_io_for_flush_and_compaction=false;"
                              "max_log_file_size=4607;"
@@ -338,12 +358,16 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "fail_if_options_file_error=false;"
                              "use_options_file=false;"
                              "enable_pipelined_write=false;"
+                             "pipelined_wal_sync=false;"
                              "unordered_write=false;"
+                             "share_snapshots=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
+                             "wal_recovery_pipeline_size=1048576;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
+                             "write_group_linger_usec=50;"
                              "info_log_level=DEBUG_LEVEL;"
                              "dump_malloc_stats=false;"
                              "allow_2pc=false;"
@@ -355,6 +379,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "disable_manifest_sync=false;"
                              "manual_wal_flush=false;"
                              "wal_compression=kZSTD;"
+                             "wal_compression_dict_bytes=4096;"
                              "seq_per_batch=false;"
                              "atomic_flush=false;"
                              "avoid_unnecessary_blocking_io=false;"
@@ -367,6 +392,10 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "lowest_used_cache_tier=kNonVolatileBlockTier;"
                              "allow_data_in_errors=false;"
                              "enforce_single_del_contracts=false;"
+                             "replication_apply_threads=1;"
+                             "perf_sample_one_in=1;"
+                             "max_pinned_table_readers=1;"
+                             "multi_cf_iterator_seek_threads=1;"
                              "daily_offpeak_time_utc=08:30-19:00;",
                              new_options));
 
@@ -437,6 +466,14 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<ConcurrentTaskLimiter>)},
       {offsetof(struct ColumnFamilyOptions, sst_partitioner_factory),
        sizeof(std::shared_ptr<SstPartitionerFactory>)},
+      {offsetof(struct ColumnFamilyOptions, compression_accelerator),
+       sizeof(std::shared_ptr<CompressionAccelerator>)},
+      {offsetof(struct ColumnFamilyOptions, tenant_usage),
+       sizeof(std::shared_ptr<TenantUsage>)},
+      {offsetof(struct ColumnFamilyOptions, compression_dict_trainer),
+       sizeof(std::shared_ptr<CompressionDictTrainer>)},
+      {offsetof(struct ColumnFamilyOptions, memtable_allocator),
+       sizeof(std::shared_ptr<MemoryAllocator>)},
   };
 
   char* options_ptr = new char[sizeof(ColumnFamilyOptions)];
@@ -492,6 +529,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "bloom_locality=8016;"
       "target_file_size_base=4294976376;"
       "memtable_huge_page_size=2557;"
+      "memtable_numa_local_alloc=true;"
       "max_successive_merges=5497;"
       "strict_max_successive_merges=true;"
       "max_sequential_skip_in_iterations=4294971408;"
@@ -501,18 +539,22 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "max_write_buffer_number=84;"
       "write_buffer_size=1653;"
       "max_compaction_bytes=64;"
+      "compaction_reuse_non_overlapping_files=true;"
       "ignore_max_compaction_bytes_for_input=true;"
       "max_bytes_for_level_multiplier=60;"
+      "penultimate_level_compaction_trigger=2.5;"
       "memtable_factory=SkipListFactory;"
       "compression=kNoCompression;"
       "compression_opts={max_dict_buffer_bytes=5;use_zstd_dict_trainer=true;"
       "enabled=false;parallel_threads=6;zstd_max_train_bytes=7;strategy=8;max_"
       "dict_bytes=9;level=10;window_bits=11;max_compressed_bytes_per_kb=987;"
-      "checksum=true};"
+      "checksum=true;adaptive_sample_one_in=12;"
+      "adaptive_bytes_per_cpu_micro=13.5};"
       "bottommost_compression_opts={max_dict_buffer_bytes=4;use_zstd_dict_"
       "trainer=true;enabled=true;parallel_threads=5;zstd_max_train_bytes=6;"
       "strategy=7;max_dict_bytes=8;level=9;window_bits=10;max_compressed_bytes_"
-      "per_kb=876;checksum=true};"
+      "per_kb=876;checksum=true;adaptive_sample_one_in=11;"
+      "adaptive_bytes_per_cpu_micro=12.5};"
       "bottommost_compression=kDisableCompressionOption;"
       "level0_stop_writes_trigger=33;"
       "num_levels=99;"
@@ -525,16 +567,22 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "merge_operator=aabcxehazrMergeOperator;"
       "memtable_prefix_bloom_size_ratio=0.4642;"
       "memtable_whole_key_filtering=true;"
+      "memtable_hash_index_size_ratio=0.1234;"
       "memtable_insert_with_hint_prefix_extractor=rocksdb.CappedPrefix.13;"
       "check_flush_compaction_key_order=false;"
       "paranoid_file_checks=true;"
       "force_consistency_checks=true;"
       "inplace_update_num_locks=7429;"
       "experimental_mempurge_threshold=0.0001;"
+      "experimental_mempurge_sorted_array=true;"
+      "flatten_immutable_memtables=true;"
       "optimize_filters_for_hits=false;"
+      "level_filter_bits_per_key=0;"
+      "filter_memory_budget=1048576;"
       "level_compaction_dynamic_level_bytes=false;"
       "level_compaction_dynamic_file_size=true;"
       "inplace_update_support=false;"
+      "inplace_merge_support=false;"
       "compaction_style=kCompactionStyleFIFO;"
       "compaction_pri=kMinOverlappingRatio;"
       "hard_pending_compaction_bytes_limit=0;"
@@ -550,6 +598,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "enable_blob_garbage_collection=true;"
       "blob_garbage_collection_age_cutoff=0.5;"
       "blob_garbage_collection_force_threshold=0.75;"
+      "blob_garbage_collection_force_max_batches=2;"
       "blob_compaction_readahead_size=262144;"
       "blob_file_starting_level=1;"
       "prepopulate_blob_cache=kDisable;"
@@ -567,6 +616,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "persist_user_defined_timestamps=true;"
       "block_protection_bytes_per_key=1;"
       "memtable_max_range_deletions=999999;"
+      "write_stall_prediction_secs=30;"
       "bottommost_file_compaction_delay=7200;",
       new_options));
 
@@ -8,10 +8,12 @@ LIB_SOURCES =                                                   \
   cache/charged_cache.cc                                        \
   cache/clock_cache.cc                                          \
   cache/lru_cache.cc                                            \
+  cache/persistent_secondary_cache.cc                           \
   cache/compressed_secondary_cache.cc                           \
   cache/secondary_cache.cc                                      \
   cache/secondary_cache_adapter.cc                              \
   cache/sharded_cache.cc                                        \
+  cache/tiny_lfu_admission_filter.cc                            \
   cache/tiered_secondary_cache.cc				                \
   cloud/aws/aws_file_system.cc                                  \
   cloud/aws/aws_kafka.cc                                        \
@@ -22,12 +24,31 @@ LIB_SOURCES =                                                   \
   cloud/cloud_file_system.cc                                    \
   cloud/cloud_file_system_impl.cc                               \
   cloud/cloud_log_controller.cc                                 \
+  cloud/cloud_log_tailer.cc                                     \
   cloud/manifest_reader.cc                                      \
   cloud/purge.cc                                                \
   cloud/cloud_manifest.cc                                       \
   cloud/cloud_scheduler.cc                                      \
+  cloud/cloud_sst_scrubber.cc                                   \
   cloud/cloud_storage_provider.cc                               \
   cloud/cloud_file_deletion_scheduler.cc                        \
+  cloud/cloud_local_storage_provider.cc                         \
+  cloud/cloud_request_hedger.cc                                 \
+  cloud/cloud_request_throttler.cc                              \
+  cloud/cloud_request_tracer.cc                                 \
+  cloud/cloud_metadata_cache.cc                                 \
+  cloud/cloud_transfer_executor.cc                              \
+  cloud/cloud_file_hydrator.cc                                  \
+  cloud/cloud_upload_queue.cc                                   \
+  cloud/cloud_multipart_uploader.cc                             \
+  cloud/cloud_file_cache.cc                                     \
+  cloud/cloud_sst_retention.cc                                  \
+  cloud/cloud_sst_packer.cc                                     \
+  cloud/cloud_sst_file_manager.cc                               \
+  cloud/replication_bootstrap.cc                                \
+  cloud/cloud_compaction_service.cc                             \
+  cloud/cloud_block_cache_warmer.cc                             \
+  cloud/cloud_table_prefetcher.cc                               \
   db/arena_wrapped_db_iter.cc                                   \
   db/blob/blob_contents.cc                                      \
   db/blob/blob_fetcher.cc                                       \
@@ -56,6 +77,7 @@ LIB_SOURCES =                                                   \
   db/compaction/compaction_service_job.cc                       \
   db/compaction/compaction_state.cc                             \
   db/compaction/compaction_outputs.cc                           \
+  db/compaction/pipelined_input_iterator.cc                     \
   db/compaction/sst_partitioner.cc                              \
   db/compaction/subcompaction_state.cc                          \
   db/convenience.cc                                             \
@@ -95,6 +117,8 @@ LIB_SOURCES =                                                   \
   db/multi_cf_iterator.cc                                       \
   db/output_validator.cc                                        \
   db/periodic_task_scheduler.cc                                 \
+  db/pipelined_log_reader.cc                                    \
+  db/point_lookup_cache.cc                                      \
   db/range_del_aggregator.cc                                    \
   db/range_tombstone_fragmenter.cc                              \
   db/repair.cc                                                  \
@@ -150,10 +174,15 @@ LIB_SOURCES =                                                   \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
   memory/memory_allocator.cc                                    \
+  memory/memory_governor.cc                                     \
+  memory/memory_tracker.cc                                      \
   memtable/alloc_tracker.cc                                     \
+  memtable/btree_rep.cc                                         \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
+  memtable/memtable_hash_index.cc                               \
   memtable/skiplistrep.cc                                       \
+  memtable/sorted_array_rep.cc                                  \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
   monitoring/histogram.cc                                       \
@@ -165,6 +194,7 @@ LIB_SOURCES =                                                   \
   monitoring/perf_level.cc                                      \
   monitoring/persistent_stats_history.cc                        \
   monitoring/statistics.cc                                      \
+  monitoring/tenant_usage.cc                                    \
   monitoring/thread_status_impl.cc                              \
   monitoring/thread_status_updater.cc                           \
   monitoring/thread_status_updater_debug.cc                     \
@@ -211,7 +241,9 @@ LIB_SOURCES =                                                   \
   table/block_based/partitioned_filter_block.cc                 \
   table/block_based/partitioned_index_iterator.cc               \
   table/block_based/partitioned_index_reader.cc                 \
+  table/block_based/range_filter.cc                             \
   table/block_based/reader_common.cc                            \
+  table/block_based/restart_key_model.cc                        \
   table/block_based/uncompression_dict_reader.cc                \
   table/block_fetcher.cc                                        \
   table/cuckoo/cuckoo_table_builder.cc                          \
@@ -220,6 +252,7 @@ LIB_SOURCES =                                                   \
   table/format.cc                                               \
   table/get_context.cc                                          \
   table/iterator.cc                                             \
+  table/level_filter.cc                                         \
   table/merging_iterator.cc                                     \
   table/compaction_merging_iterator.cc                          \
   table/meta_blocks.cc                                          \
@@ -255,6 +288,7 @@ LIB_SOURCES =                                                   \
   util/comparator.cc                                            \
   util/compression.cc                                           \
   util/compression_context_cache.cc                             \
+  util/compression_dict_trainer.cc                              \
   util/concurrent_task_limiter_impl.cc                          \
   util/crc32c.cc                                                \
   util/crc32c_arm64.cc                                          \
@@ -311,6 +345,7 @@ LIB_SOURCES =                                                   \
   utilities/object_registry.cc                                  \
   utilities/option_change_migration/option_change_migration.cc  \
   utilities/options/options_util.cc                             \
+  utilities/parallel_scan/parallel_scan.cc                      \
   utilities/persistent_cache/block_cache_tier.cc                \
   utilities/persistent_cache/block_cache_tier_file.cc           \
   utilities/persistent_cache/block_cache_tier_metadata.cc       \
@@ -429,6 +464,7 @@ TOOLS_MAIN_SOURCES =                                                    \
   db_stress_tool/db_stress.cc                                           \
   tools/blob_dump.cc                                                    \
   tools/block_cache_analyzer/block_cache_trace_analyzer_tool.cc         \
+  tools/cloud_trace_analyzer.cc                                         \
   tools/db_repl_stress.cc                                               \
   tools/db_sanity_test.cc                                               \
   tools/ldb.cc                                                          \
@@ -457,9 +493,25 @@ TEST_MAIN_SOURCES =                                                     \
   cloud/cloud_file_system_test.cc                                       \
   cloud/cloud_manifest_test.cc                                          \
   cloud/cloud_scheduler_test.cc                                         \
+  cloud/cloud_local_storage_provider_test.cc                            \
+  cloud/cloud_request_hedger_test.cc                                    \
+  cloud/cloud_log_tailer_test.cc                                        \
+  cloud/cloud_request_throttler_test.cc                                 \
+  cloud/cloud_request_tracer_test.cc                                    \
+  cloud/cloud_metadata_cache_test.cc                                    \
+  cloud/cloud_transfer_executor_test.cc                                 \
+  cloud/cloud_file_hydrator_test.cc                                     \
+  cloud/cloud_upload_queue_test.cc                                      \
+  cloud/cloud_multipart_uploader_test.cc                                \
+  cloud/cloud_storage_provider_test.cc                                  \
+  cloud/cloud_file_cache_test.cc                                        \
+  cloud/cloud_sst_retention_test.cc                                     \
+  cloud/cloud_sst_packer_test.cc                                        \
+  cloud/cloud_sst_file_manager_test.cc                                  \
   cloud/replication_test.cc                                             \
   cache/compressed_secondary_cache_test.cc                              \
   cache/lru_cache_test.cc                                               \
+  cache/persistent_secondary_cache_test.cc                              \
   cache/tiered_secondary_cache_test.cc					\
   db/blob/blob_counting_iterator_test.cc                                \
   db/blob/blob_file_addition_test.cc                                    \
@@ -481,6 +533,7 @@ TEST_MAIN_SOURCES =                                                     \
   db/compaction/compaction_job_stats_test.cc                            \
   db/compaction/compaction_picker_test.cc                               \
   db/compaction/compaction_service_test.cc                              \
+  db/compaction/pipelined_input_iterator_test.cc                        \
   db/compaction/tiered_compaction_test.cc                               \
   db/comparator_db_test.cc                                              \
   db/corruption_test.cc                                                 \
@@ -494,6 +547,7 @@ TEST_MAIN_SOURCES =                                                     \
   db/db_dynamic_level_test.cc                                           \
   db/db_encryption_test.cc                                              \
   db/db_flush_test.cc                                                   \
+  db/db_get_allocation_test.cc                                          \
   db/db_readonly_with_timestamp_test.cc                                 \
   db/db_with_timestamp_basic_test.cc                                    \
   db/import_column_family_test.cc                                       \
@@ -544,6 +598,7 @@ TEST_MAIN_SOURCES =                                                     \
   db/options_file_test.cc                                               \
   db/perf_context_test.cc                                               \
   db/periodic_task_scheduler_test.cc                                    \
+  db/pipelined_log_reader_test.cc                                       \
   db/plain_table_db_test.cc                                             \
   db/prefix_test.cc                                                     \
   db/repair_test.cc                                                     \
@@ -573,6 +628,8 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memory_allocator_test.cc                                       \
+  memory/memory_governor_test.cc                                        \
+  memtable/btree_rep_test.cc                                            \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -589,9 +646,11 @@ TEST_MAIN_SOURCES =                                                     \
   table/block_based/data_block_hash_index_test.cc                       \
   table/block_based/full_filter_block_test.cc                           \
   table/block_based/partitioned_filter_block_test.cc                    \
+  table/block_based/range_filter_test.cc                                \
   table/cleanable_test.cc                                               \
   table/cuckoo/cuckoo_table_builder_test.cc                             \
   table/cuckoo/cuckoo_table_reader_test.cc                              \
+  table/level_filter_test.cc                                            \
   table/merger_test.cc                                                  \
   table/sst_file_reader_test.cc                                         \
   table/table_test.cc                                                   \
@@ -641,6 +700,7 @@ TEST_MAIN_SOURCES =                                                     \
   utilities/object_registry_test.cc                                     \
   utilities/option_change_migration/option_change_migration_test.cc     \
   utilities/options/options_util_test.cc                                \
+  utilities/parallel_scan/parallel_scan_test.cc                         \
   utilities/persistent_cache/hash_table_test.cc                         \
   utilities/persistent_cache/persistent_cache_test.cc                   \
   utilities/simulator_cache/cache_simulator_test.cc                     \
@@ -664,6 +724,7 @@ TEST_MAIN_SOURCES_C = \
 MICROBENCH_SOURCES =                                          \
   microbench/ribbon_bench.cc                                  \
   microbench/db_basic_bench.cc                                  \
+  microbench/cloud_bench.cc                                   \
 
 JNI_NATIVE_SOURCES =                                          \
   java/rocksjni/backupenginejni.cc                            \
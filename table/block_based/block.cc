@@ -299,15 +299,72 @@ void DataBlockIter::PrevImpl() {
   prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
 }
 
+namespace {
+// First 8 bytes of user_key as a big-endian integer, padded with zeros. If
+// the prefix of a key is less (greater) than the prefix of another key, the
+// key is less (greater) than the other in bytewise order.
+inline uint64_t RestartKeyPrefix(const Slice& user_key) {
+  uint64_t prefix = 0;
+  const size_t n = std::min(user_key.size(), sizeof(prefix));
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix <<= 8;
+    if (i < n) {
+      prefix |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return prefix;
+}
+
+// Sets *num_less and *num_not_greater to the number of prefixes, which are
+// sorted, less than and not greater than target_prefix
+inline void CountRestartKeyPrefixes(const uint64_t* prefixes, uint32_t num,
+                                    uint64_t target_prefix, uint32_t* num_less,
+                                    uint32_t* num_not_greater) {
+  // Small blocks are scanned: the loop has no branches and compiles to
+  // vector compares
+  constexpr uint32_t kMaxScanned = 64;
+  if (num <= kMaxScanned) {
+    uint32_t less = 0, not_greater = 0;
+    for (uint32_t i = 0; i < num; i++) {
+      less += prefixes[i] < target_prefix;
+      not_greater += prefixes[i] <= target_prefix;
+    }
+    *num_less = less;
+    *num_not_greater = not_greater;
+    return;
+  }
+  auto range = std::equal_range(prefixes, prefixes + num, target_prefix);
+  *num_less = static_cast<uint32_t>(range.first - prefixes);
+  *num_not_greater = static_cast<uint32_t>(range.second - prefixes);
+}
+}  // namespace
+
 void DataBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
   if (data_ == nullptr) {  // Not init yet
     return;
   }
+  // With timestamps, the hash index only has the user keys with the
+  // timestamps they were written with
+  if (data_block_hash_index_ != nullptr && ts_sz_ == 0 &&
+      HashSeekImpl(seek_key)) {
+    return;
+  }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  // Only the restart keys with the same prefix as the target are compared
+  int64_t left = -1, right = int64_t{num_restarts_} - 1;
+  if (restart_key_prefixes_ != nullptr && restarts_ != 0) {
+    uint32_t num_less = 0, num_not_greater = 0;
+    CountRestartKeyPrefixes(restart_key_prefixes_, num_restarts_,
+                            RestartKeyPrefix(ExtractUserKey(seek_key)),
+                            &num_less, &num_not_greater);
+    left = int64_t{num_less} - 1;
+    right = int64_t{num_not_greater} - 1;
+  }
+  bool ok = BinarySeek<DecodeKey>(seek_key, left, right, &index,
+                                  &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -331,6 +388,55 @@ void MetaBlockIter::SeekImpl(const Slice& target) {
   FindKeyAfterBinarySeek(seek_key, index, skip_linear_scan);
 }
 
+bool DataBlockIter::HashSeekImpl(const Slice& target) {
+  Slice target_user_key = ExtractUserKey(target);
+  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+  uint8_t entry =
+      data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
+  if (entry == kCollision || entry == kNoEntry || entry >= num_restarts_) {
+    return false;
+  }
+
+  // All the keys with the user key are in the restart interval, else it
+  // would be a collision
+  uint32_t restart_index = entry;
+  SeekToRestartPoint(restart_index);
+  current_ = GetRestartPoint(restart_index);
+  cur_entry_idx_ =
+      static_cast<int32_t>(restart_index * block_restart_interval_) - 1;
+  uint32_t limit = restarts_;
+  if (restart_index + 1 < num_restarts_) {
+    limit = GetRestartPoint(restart_index + 1);
+  }
+  while (current_ < limit) {
+    ++cur_entry_idx_;
+    bool shared;
+    if (!ParseNextDataKey(&shared)) {
+      return false;
+    }
+    if (CompareCurrentKey(target) >= 0) {
+      // Past the user key, the first key not less than `target` may be in a
+      // later restart interval
+      return icmp_->user_comparator()->Compare(raw_key_.GetUserKey(),
+                                               target_user_key) == 0;
+    }
+  }
+  return false;
+}
+
+void DataBlockIter::PrefetchForGet(const Slice& target) const {
+  if (data_block_hash_index_ == nullptr || data_ == nullptr) {
+    return;
+  }
+  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+  uint8_t entry =
+      data_block_hash_index_->Lookup(data_, map_offset, ExtractUserKey(target));
+  if (entry == kCollision || entry == kNoEntry || entry >= num_restarts_) {
+    return;
+  }
+  PREFETCH(data_ + GetRestartPoint(entry), 0 /* rw */, 3 /* locality */);
+}
+
 // Optimized Seek for point lookup for an internal key `target`
 // target = "seek_user_key @ type | seqno".
 //
@@ -494,10 +600,24 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
-  } else if (value_delta_encoded_) {
-    ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
-    ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+    // Only the restart keys around where the model puts the target are
+    // compared
+    int64_t left = -1, right = int64_t{num_restarts_} - 1;
+    if (restart_key_model_ != nullptr) {
+      uint32_t num_less = 0, num_not_greater = 0;
+      restart_key_model_->Count(RestartKeyPrefix(ExtractUserKey(target)),
+                                &num_less, &num_not_greater);
+      left = int64_t{num_less} - 1;
+      right = int64_t{num_not_greater} - 1;
+    }
+    if (value_delta_encoded_) {
+      ok = BinarySeek<DecodeKeyV4>(seek_key, left, right, &index,
+                                   &skip_linear_scan);
+    } else {
+      ok = BinarySeek<DecodeKey>(seek_key, left, right, &index,
+                                 &skip_linear_scan);
+    }
   }
 
   if (!ok) {
@@ -650,6 +770,18 @@ bool BlockIter<TValue>::ParseNextKey(bool* is_shared) {
   // Decode next entry
   uint32_t shared, non_shared, value_length;
   p = DecodeEntryFunc()(p, limit, &shared, &non_shared, &value_length);
+  if (p != nullptr && shared != 0 && raw_key_.Size() == 0 &&
+      !pad_min_timestamp_) {
+    // A restart point reached by SeekToRestartPoint(), whose key shares bytes
+    // with the first key of the block (format_version >= 7). Reached from the
+    // previous key, it shares the same bytes with that key.
+    uint32_t first_shared, first_non_shared, first_value_length;
+    const char* first_key = DecodeEntryFunc()(
+        data_, limit, &first_shared, &first_non_shared, &first_value_length);
+    if (first_key != nullptr && first_shared == 0) {
+      raw_key_.SetKey(Slice(first_key, first_non_shared), false /* copy */);
+    }
+  }
   if (p == nullptr || raw_key_.Size() < shared) {
     CorruptionError();
     return false;
@@ -674,14 +806,15 @@ bool BlockIter<TValue>::ParseNextKey(bool* is_shared) {
       }
     }
     value_ = Slice(p + non_shared, value_length);
-    if (shared == 0) {
-      while (restart_index_ + 1 < num_restarts_ &&
-             GetRestartPoint(restart_index_ + 1) < current_) {
-        ++restart_index_;
-      }
+    // Restart points are told by their offsets, as their keys may share bytes
+    // (format_version >= 7)
+    while (restart_index_ + 1 < num_restarts_ &&
+           GetRestartPoint(restart_index_ + 1) <= current_) {
+      ++restart_index_;
+    }
+    if (shared != 0 && GetRestartPoint(restart_index_) == current_) {
+      *is_shared = false;
     }
-    // else we are in the middle of a restart interval and the restart_index_
-    // thus has not changed
     return true;
   }
 }
@@ -826,7 +959,8 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
 // compared again later.
 template <class TValue>
 template <typename DecodeKeyFunc>
-bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
+bool BlockIter<TValue>::BinarySeek(const Slice& target, int64_t left,
+                                   int64_t right, uint32_t* index,
                                    bool* skip_linear_scan) {
   if (restarts_ == 0) {
     // SST files dedicated to range tombstones are written with index blocks
@@ -845,7 +979,7 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
+  assert(left >= -1 && left <= right && right < int64_t{num_restarts_});
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -853,12 +987,11 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
     uint32_t shared, non_shared;
     const char* key_ptr = DecodeKeyFunc()(
         data_ + region_offset, data_ + restarts_, &shared, &non_shared);
-    if (key_ptr == nullptr || (shared != 0)) {
+    if (key_ptr == nullptr ||
+        !SetRestartKey<DecodeKeyFunc>(shared, key_ptr, non_shared)) {
       CorruptionError();
       return false;
     }
-    Slice mid_key(key_ptr, non_shared);
-    UpdateRawKeyAndMaybePadMinTimestamp(mid_key);
     int cmp = CompareCurrentKey(target);
     if (cmp < 0) {
       // Key at "mid" is smaller than "target". Therefore all
@@ -885,6 +1018,26 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   return true;
 }
 
+template <class TValue>
+template <typename DecodeKeyFunc>
+bool BlockIter<TValue>::SetRestartKey(uint32_t shared, const char* key_ptr,
+                                      uint32_t non_shared) {
+  if (shared == 0) {
+    UpdateRawKeyAndMaybePadMinTimestamp(Slice(key_ptr, non_shared));
+    return true;
+  }
+  uint32_t first_shared, first_non_shared;
+  const char* first_key = DecodeKeyFunc()(data_, data_ + restarts_,
+                                          &first_shared, &first_non_shared);
+  if (first_key == nullptr || first_shared != 0 || first_non_shared < shared ||
+      pad_min_timestamp_) {
+    return false;
+  }
+  raw_key_.SetKey(Slice(first_key, shared), false /* copy */);
+  raw_key_.TrimAppend(shared, key_ptr, non_shared);
+  return true;
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -896,12 +1049,14 @@ int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
                           &non_shared)
           : DecodeKey()(data_ + region_offset, data_ + restarts_, &shared,
                         &non_shared);
-  if (key_ptr == nullptr || (shared != 0)) {
+  bool ok = key_ptr != nullptr &&
+            (value_delta_encoded_
+                 ? SetRestartKey<DecodeKeyV4>(shared, key_ptr, non_shared)
+                 : SetRestartKey<DecodeKey>(shared, key_ptr, non_shared));
+  if (!ok) {
     CorruptionError();
     return 1;  // Return target is smaller
   }
-  Slice block_key(key_ptr, non_shared);
-  UpdateRawKeyAndMaybePadMinTimestamp(block_key);
   return CompareCurrentKey(target);
 }
 
@@ -1112,6 +1267,94 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
   }
 }
 
+namespace {
+// Sets prefixes[i] to the RestartKeyPrefix() of the key of restart point i.
+// Returns false if the block is corrupted.
+template <typename DecodeKeyFunc>
+bool GetRestartKeyPrefixes(const char* data, uint32_t restart_offset,
+                           uint32_t num_restarts, bool key_includes_seq,
+                           uint64_t* prefixes) {
+  const char* limit = data + restart_offset;
+  const uint32_t internal_bytes = key_includes_seq ? kNumInternalBytes : 0;
+  Slice first_key;
+  std::string key_buf;
+  for (uint32_t i = 0; i < num_restarts; i++) {
+    uint32_t offset =
+        DecodeFixed32(data + restart_offset + i * sizeof(uint32_t));
+    uint32_t shared = 0, non_shared = 0;
+    const char* key_ptr =
+        offset < restart_offset
+            ? DecodeKeyFunc()(data + offset, limit, &shared, &non_shared)
+            : nullptr;
+    if (key_ptr == nullptr || shared > first_key.size() ||
+        non_shared > static_cast<uint32_t>(limit - key_ptr)) {
+      return false;
+    }
+    Slice key(key_ptr, non_shared);
+    if (shared != 0) {
+      // Shares bytes with the first key of the block (format_version >= 7)
+      key_buf.assign(first_key.data(), shared);
+      key_buf.append(key_ptr, non_shared);
+      key = key_buf;
+    }
+    if (i == 0) {
+      first_key = key;
+    }
+    if (key.size() < internal_bytes) {
+      return false;
+    }
+    key.remove_suffix(internal_bytes);
+    prefixes[i] = RestartKeyPrefix(key);
+  }
+  return true;
+}
+
+// Max distance between the position of a restart key predicted by the model
+// and its actual position
+constexpr uint32_t kRestartKeyModelMaxError = 8;
+}  // namespace
+
+void Block::InitializeDataBlockRestartKeyPrefixes(const Comparator* raw_ucmp) {
+  if (raw_ucmp != BytewiseComparator() || num_restarts_ == 0 ||
+      restart_offset_ == 0) {
+    return;
+  }
+  std::unique_ptr<uint64_t[]> prefixes(new uint64_t[num_restarts_]);
+  // Corrupted blocks are reported by the iterators
+  if (GetRestartKeyPrefixes<DecodeKey>(data_, restart_offset_, num_restarts_,
+                                       true /* key_includes_seq */,
+                                       prefixes.get())) {
+    restart_key_prefixes_ = std::move(prefixes);
+  }
+}
+
+void Block::InitializeIndexBlockRestartKeyModel(const Comparator* raw_ucmp,
+                                                bool value_is_full,
+                                                bool key_includes_seq) {
+  if (raw_ucmp != BytewiseComparator() || num_restarts_ == 0 ||
+      restart_offset_ == 0) {
+    return;
+  }
+  std::unique_ptr<uint64_t[]> prefixes(new uint64_t[num_restarts_]);
+  bool ok = value_is_full
+                ? GetRestartKeyPrefixes<DecodeKey>(data_, restart_offset_,
+                                                   num_restarts_,
+                                                   key_includes_seq,
+                                                   prefixes.get())
+                : GetRestartKeyPrefixes<DecodeKeyV4>(data_, restart_offset_,
+                                                     num_restarts_,
+                                                     key_includes_seq,
+                                                     prefixes.get());
+  if (!ok) {
+    return;
+  }
+  restart_key_prefixes_ = std::move(prefixes);
+  restart_key_model_.reset(new RestartKeyModel());
+  restart_key_model_->Build(restart_key_prefixes_.get(), num_restarts_,
+                            kRestartKeyModelMaxError);
+  restart_key_model_includes_seq_ = key_includes_seq;
+}
+
 void Block::InitializeDataBlockProtectionInfo(uint8_t protection_bytes_per_key,
                                               const Comparator* raw_ucmp) {
   protection_bytes_per_key_ = 0;
@@ -1279,7 +1522,9 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
         read_amp_bitmap_.get(), block_contents_pinned,
         user_defined_timestamps_persisted,
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        raw_ucmp == BytewiseComparator() ? restart_key_prefixes_.get()
+                                         : nullptr);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -1318,7 +1563,11 @@ IndexBlockIter* Block::NewIndexIterator(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         prefix_index_ptr, have_first_key, key_includes_seq, value_is_full,
         block_contents_pinned, user_defined_timestamps_persisted,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        prefix_index_ptr == nullptr && raw_ucmp == BytewiseComparator() &&
+                key_includes_seq == restart_key_model_includes_seq_
+            ? restart_key_model_.get()
+            : nullptr);
   }
 
   return ret_iter;
@@ -1335,6 +1584,13 @@ size_t Block::ApproximateMemoryUsage() const {
     usage += read_amp_bitmap_->ApproximateMemoryUsage();
   }
   usage += checksum_size_;
+  if (restart_key_prefixes_) {
+    usage += num_restarts_ * sizeof(uint64_t);
+  }
+  if (restart_key_model_) {
+    usage += sizeof(RestartKeyModel) +
+             restart_key_model_->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
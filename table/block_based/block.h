@@ -24,6 +24,7 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/restart_key_model.h"
 #include "table/format.h"
 #include "table/internal_iterator.h"
 #include "test_util/sync_point.h"
@@ -253,6 +254,31 @@ class Block {
   void InitializeDataBlockProtectionInfo(uint8_t protection_bytes_per_key,
                                          const Comparator* raw_ucmp);
 
+  // Keeps the first 8 bytes of the user key of each restart point in a
+  // contiguous array, if raw_ucmp is the bytewise comparator. After this
+  // method is called, the DataBlockIters returned by NewDataIterator narrow
+  // down the binary search of their seeks with it. See
+  // BlockBasedTableOptions::data_block_restart_key_prefixes.
+  void InitializeDataBlockRestartKeyPrefixes(const Comparator* raw_ucmp);
+
+  const uint64_t* TEST_GetRestartKeyPrefixes() const {
+    return restart_key_prefixes_.get();
+  }
+
+  // Fits a RestartKeyModel to the first 8 bytes of the user key of each
+  // restart point of an index block, if raw_ucmp is the bytewise comparator.
+  // After this method is called, the IndexBlockIters returned by
+  // NewIndexIterator with the same key_includes_seq start the binary search
+  // of their seeks where the model predicts. See
+  // BlockBasedTableOptions::index_block_restart_key_model.
+  void InitializeIndexBlockRestartKeyModel(const Comparator* raw_ucmp,
+                                           bool value_is_full,
+                                           bool key_includes_seq);
+
+  const RestartKeyModel* TEST_GetRestartKeyModel() const {
+    return restart_key_model_.get();
+  }
+
   // Initializes per key-value checksum protection.
   // After this method is called, each IndexBlockIterator returned
   // by NewIndexIterator will verify per key-value checksum for any key it read.
@@ -288,6 +314,11 @@ class Block {
   uint32_t block_restart_interval_{0};
   uint8_t protection_bytes_per_key_{0};
   DataBlockHashIndex data_block_hash_index_;
+  // See InitializeDataBlockRestartKeyPrefixes(), one per restart point
+  std::unique_ptr<uint64_t[]> restart_key_prefixes_;
+  // See InitializeIndexBlockRestartKeyModel(), over restart_key_prefixes_
+  std::unique_ptr<RestartKeyModel> restart_key_model_;
+  bool restart_key_model_includes_seq_{false};
 };
 
 // A `BlockIter` iterates over the entries in a `Block`'s data buffer. The
@@ -511,8 +542,8 @@ class BlockIter : public InternalIteratorBase<TValue> {
     return count;
   }
 
-  // Stores whether the current key has a shared bytes with prev key in
-  // *is_shared.
+  // Stores whether the current key has a shared bytes with prev key, and is
+  // not at a restart point, in *is_shared.
   // Sets raw_key_, value_ to the current parsed key and value.
   // Sets restart_index_ to point to the restart interval that contains
   // the current key.
@@ -673,7 +704,24 @@ class BlockIter : public InternalIteratorBase<TValue> {
  protected:
   template <typename DecodeKeyFunc>
   inline bool BinarySeek(const Slice& target, uint32_t* index,
-                         bool* is_index_key_result);
+                         bool* is_index_key_result) {
+    return BinarySeek<DecodeKeyFunc>(target, -1, int64_t{num_restarts_} - 1,
+                                     index, is_index_key_result);
+  }
+
+  // Same as above, when the restart keys up to index `left` are known to be
+  // less than `target`, and those after index `right` greater than it
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeek(const Slice& target, int64_t left, int64_t right,
+                         uint32_t* index, bool* is_index_key_result);
+
+  // Sets raw_key_ to the key of a restart point, decoded as `shared` and the
+  // `non_shared` bytes at `key_ptr`. The keys of the restart points other
+  // than the first may share bytes with the first key of the block
+  // (format_version >= 7). Returns false if the block is corrupted.
+  template <typename DecodeKeyFunc>
+  inline bool SetRestartKey(uint32_t shared, const char* key_ptr,
+                            uint32_t non_shared);
 
   // Find the first key in restart interval `index` that is >= `target`.
   // If there is no such key, iterator is positioned at the first key in
@@ -700,7 +748,8 @@ class DataBlockIter final : public BlockIter<Slice> {
                   bool user_defined_timestamps_persisted,
                   DataBlockHashIndex* data_block_hash_index,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const uint64_t* restart_key_prefixes) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned, user_defined_timestamps_persisted,
                    protection_bytes_per_key, kv_checksum,
@@ -709,6 +758,7 @@ class DataBlockIter final : public BlockIter<Slice> {
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_key_prefixes_ = restart_key_prefixes;
   }
 
   Slice value() const override {
@@ -737,6 +787,11 @@ class DataBlockIter final : public BlockIter<Slice> {
     return res;
   }
 
+  // Prefetches the restart interval that the hash index maps the user key of
+  // `target` to, if any, so that the keys of a MultiGet that share this block
+  // are probed together before the first of them is searched.
+  void PrefetchForGet(const Slice& target) const;
+
   void Invalidate(const Status& s) override {
     BlockIter::Invalidate(s);
     // Clear prev entries cache.
@@ -785,8 +840,16 @@ class DataBlockIter final : public BlockIter<Slice> {
   int32_t prev_entries_idx_ = -1;
 
   DataBlockHashIndex* data_block_hash_index_;
+  // See Block::InitializeDataBlockRestartKeyPrefixes(), null if not
+  // initialized
+  const uint64_t* restart_key_prefixes_ = nullptr;
 
   bool SeekForGetImpl(const Slice& target);
+  // Positions the iterator at the first key not less than `target` through
+  // the hash index. Returns false, with the iterator position undefined, if
+  // the user key of `target` is not in the block with a key not less than
+  // `target`, or the index can't tell where it is.
+  bool HashSeekImpl(const Slice& target);
 };
 
 // Iterator over MetaBlocks.  MetaBlocks are similar to Data Blocks and
@@ -844,13 +907,15 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   bool value_is_full, bool block_contents_pinned,
                   bool user_defined_timestamps_persisted,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const RestartKeyModel* restart_key_model) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned,
                    user_defined_timestamps_persisted, protection_bytes_per_key,
                    kv_checksum, block_restart_interval);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    restart_key_model_ = restart_key_model;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -920,6 +985,9 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  // See Block::InitializeIndexBlockRestartKeyModel(), null if not
+  // initialized or the seeks use prefix_index_
+  const RestartKeyModel* restart_key_model_ = nullptr;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -15,10 +15,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "block_cache.h"
 #include "cache/cache_entry_roles.h"
@@ -31,11 +33,13 @@
 #include "memory/memory_allocator_impl.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
+#include "rocksdb/compression_dict_trainer.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/table.h"
+#include "rocksdb/tenant_usage.h"
 #include "rocksdb/types.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
@@ -45,7 +49,9 @@
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/partitioned_filter_block.h"
+#include "table/block_based/range_filter.h"
 #include "table/format.h"
+#include "table/level_filter.h"
 #include "table/meta_blocks.h"
 #include "table/table_builder.h"
 #include "util/coding.h"
@@ -113,6 +119,139 @@ bool GoodCompressionRatio(size_t compressed_size, size_t uncomp_size,
          10;
 }
 
+// Picks the compression type of the data blocks of a table file among the
+// configured one, LZ4 and no compression, by their ratio and speed measured
+// on sampled blocks of the file (see
+// CompressionOptions::adaptive_sample_one_in). Thread-safe, for the parallel
+// compression workers.
+class AdaptiveCompressionSelector {
+ public:
+  AdaptiveCompressionSelector(CompressionType type,
+                              const CompressionOptions& opts)
+      : sample_one_in_(opts.adaptive_sample_one_in),
+        bytes_per_cpu_micro_(opts.adaptive_bytes_per_cpu_micro),
+        chosen_(type) {
+    assert(sample_one_in_ > 0);
+    candidates_.push_back(type);
+    candidate_opts_.push_back(opts);
+    if (LZ4_Supported() && type != kLZ4Compression &&
+        type != kLZ4HCCompression) {
+      // The level of the configured type does not apply to LZ4
+      CompressionOptions lz4_opts;
+      lz4_opts.max_compressed_bytes_per_kb = opts.max_compressed_bytes_per_kb;
+      candidates_.push_back(kLZ4Compression);
+      candidate_opts_.push_back(lz4_opts);
+    }
+    stats_.resize(candidates_.size());
+  }
+
+  // Returns the options to compress with `type`, one of the candidates
+  const CompressionOptions& OptionsFor(CompressionType type) const {
+    for (size_t i = 1; i < candidates_.size(); ++i) {
+      if (candidates_[i] == type) {
+        return candidate_opts_[i];
+      }
+    }
+    return candidate_opts_[0];
+  }
+
+  // Returns whether the next data block is to be compressed with every
+  // candidate, starting with the first one
+  bool ShouldSample() {
+    return num_blocks_.fetch_add(1, std::memory_order_relaxed) %
+               sample_one_in_ ==
+           0;
+  }
+
+  // The cost of an output of `output_size` bytes taking `nanos` to compress
+  double Cost(size_t output_size, uint64_t nanos) const {
+    return static_cast<double>(output_size) +
+           bytes_per_cpu_micro_ * static_cast<double>(nanos) / 1000;
+  }
+
+  // Compresses `raw` with every candidate, records their output sizes and
+  // compression times, and returns the type with the lowest cost for `raw`.
+  // `ctx` is the context of the configured type; LZ4 does not use one.
+  CompressionType Sample(const Slice& raw, const CompressionContext& ctx,
+                         uint32_t compress_format_version,
+                         SystemClock* clock) {
+    double best_cost = Cost(raw.size(), 0);
+    CompressionType best = kNoCompression;
+    std::string output;
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      CompressionInfo info(candidate_opts_[i], ctx,
+                           CompressionDict::GetEmptyDict(), candidates_[i],
+                           0 /* sample_for_compression */);
+      output.clear();
+      uint64_t start = clock->NowNanos();
+      bool compressed =
+          CompressData(raw, info, compress_format_version, &output);
+      uint64_t nanos = clock->NowNanos() - start;
+      size_t output_size = compressed ? output.size() : raw.size();
+      Record(i, raw.size(), output_size, nanos);
+      if (compressed && Cost(output_size, nanos) < best_cost) {
+        best_cost = Cost(output_size, nanos);
+        best = candidates_[i];
+      }
+    }
+    return best;
+  }
+
+  // Records the output size and the compression time of candidate `i` on a
+  // sampled block of `input_size` bytes, and picks the type of the next
+  // blocks by their cost per input byte, averaged over the recent samples
+  void Record(size_t i, size_t input_size, size_t output_size,
+              uint64_t nanos) {
+    assert(i < candidates_.size());
+    if (input_size == 0) {
+      return;
+    }
+    // Weight of the latest sample in the moving averages
+    const double kAlpha = 0.25;
+    double cost_per_byte =
+        Cost(output_size, nanos) / static_cast<double>(input_size);
+    std::lock_guard<std::mutex> lock(mu_);
+    Stats& stats = stats_[i];
+    stats.cost_per_byte =
+        stats.num_samples == 0
+            ? cost_per_byte
+            : kAlpha * cost_per_byte + (1 - kAlpha) * stats.cost_per_byte;
+    ++stats.num_samples;
+
+    // Not compressing costs one byte per byte
+    double best_cost_per_byte = 1;
+    CompressionType best = kNoCompression;
+    for (size_t j = 0; j < candidates_.size(); ++j) {
+      if (stats_[j].num_samples > 0 &&
+          stats_[j].cost_per_byte < best_cost_per_byte) {
+        best_cost_per_byte = stats_[j].cost_per_byte;
+        best = candidates_[j];
+      }
+    }
+    chosen_.store(best, std::memory_order_relaxed);
+  }
+
+  // Returns the compression type of the data blocks not sampled
+  CompressionType Chosen() const {
+    return chosen_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Stats {
+    double cost_per_byte = 0;
+    uint64_t num_samples = 0;
+  };
+
+  const uint32_t sample_one_in_;
+  const double bytes_per_cpu_micro_;
+  std::vector<CompressionType> candidates_;
+  std::vector<CompressionOptions> candidate_opts_;
+  std::atomic<uint64_t> num_blocks_{0};
+  std::atomic<CompressionType> chosen_;
+  std::mutex mu_;
+  std::vector<Stats> stats_;
+};
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -120,7 +259,8 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
                     CompressionType* type, uint32_t format_version,
                     bool allow_sample, std::string* compressed_output,
                     std::string* sampled_output_fast,
-                    std::string* sampled_output_slow) {
+                    std::string* sampled_output_slow,
+                    CompressionAccelerator* accelerator) {
   assert(type);
   assert(compressed_output);
   assert(compressed_output->empty());
@@ -169,10 +309,15 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
     return uncompressed_data;
   }
 
-  // Actually compress the data; if the compression method is not supported,
-  // or the compression fails etc., just fall back to uncompressed
-  if (!CompressData(uncompressed_data, info,
-                    GetCompressFormatForVersion(format_version),
+  // Actually compress the data, with the accelerator if it takes the block;
+  // if the compression method is not supported, or the compression fails
+  // etc., just fall back to uncompressed
+  const uint32_t compress_format_version =
+      GetCompressFormatForVersion(format_version);
+  if ((accelerator == nullptr ||
+       !AcceleratedCompressData(accelerator, uncompressed_data, info,
+                                compress_format_version, compressed_output)) &&
+      !CompressData(uncompressed_data, info, compress_format_version,
                     compressed_output)) {
     *type = kNoCompression;
     return uncompressed_data;
@@ -309,6 +454,23 @@ struct BlockBasedTableBuilder::Rep {
   std::vector<std::unique_ptr<CompressionContext>> compression_ctxs;
   std::vector<std::unique_ptr<UncompressionContext>> verify_ctxs;
   std::unique_ptr<UncompressionDict> verify_dict;
+  // Set if compression_opts.adaptive_sample_one_in > 0 and no dictionary is
+  // used
+  std::unique_ptr<AdaptiveCompressionSelector> adaptive_compression;
+
+  // Set if ioptions.compression_dict_trainer is and a dictionary is used.
+  // The samples of the data blocks are then queued to it on Finish().
+  CompressionDictTrainer* dict_trainer = nullptr;
+  // Whether the file is compressed with the latest dictionary of
+  // `dict_trainer` rather than one of its own, so its data blocks are sampled
+  // as they are written out. One in `dict_sample_stride` of them is kept,
+  // the stride doubling whenever the samples exceed the training budget, so
+  // that the samples spread over the whole file.
+  bool sample_for_dict_trainer = false;
+  std::vector<std::string> dict_samples;
+  size_t dict_samples_bytes = 0;
+  uint64_t dict_sample_stride = 1;
+  uint64_t num_data_blocks_sampled = 0;
 
   size_t data_begin_offset = 0;
 
@@ -345,8 +507,30 @@ struct BlockBasedTableBuilder::Rep {
       compression_dict_buffer_cache_res_mgr;
   const bool use_delta_encoding_for_index_values;
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  // Set if table_options.range_filter_bits_per_key > 0
+  std::unique_ptr<RangeFilterBuilder> range_filter_builder;
+  // Set if ioptions.level_filter_bits_per_key > 0, unless the filters of
+  // the file are skipped
+  std::unique_ptr<LevelFilterBuilder> level_filter_builder;
   OffsetableCacheKey base_cache_key;
   const TableFileCreationReason reason;
+  // The key ranges of the data blocks to warm in the block cache during a
+  // compaction, or nullptr
+  const std::vector<OwnedUserKeyRange>* hot_key_ranges;
+  // The first of `hot_key_ranges` that may overlap the next data block
+  size_t next_hot_key_range = 0;
+  // The first key of `data_block`, tracked while `hot_key_ranges` is set
+  std::string data_block_first_key;
+  // Whether the data block being written overlaps `hot_key_ranges`
+  bool hot_data_block = false;
+  // Set if table_options.block_timestamp_index and the timestamps are
+  // persisted
+  bool build_block_timestamp_index = false;
+  // The smallest timestamp of the data block being written, tracked while
+  // `build_block_timestamp_index` is set
+  std::string data_block_min_timestamp;
+  // The offset and smallest timestamp of each data block written
+  std::string block_timestamp_index;
 
   BlockHandle pending_handle;  // Handle to add to index block
 
@@ -372,6 +556,42 @@ struct BlockBasedTableBuilder::Rep {
     return compression_opts.parallel_threads > 1;
   }
 
+  // Lowers `data_block_min_timestamp` to the timestamp of `key`
+  void UpdateDataBlockMinTimestamp(const Slice& key) {
+    const Slice ts = ExtractTimestampFromKey(key, ts_sz);
+    if (data_block_min_timestamp.empty() ||
+        internal_comparator.user_comparator()->CompareTimestamp(
+            ts, data_block_min_timestamp) < 0) {
+      data_block_min_timestamp.assign(ts.data(), ts.size());
+    }
+  }
+
+  size_t DictSampleBytes() const {
+    return compression_opts.zstd_max_train_bytes > 0
+               ? compression_opts.zstd_max_train_bytes
+               : compression_opts.max_dict_bytes;
+  }
+
+  void AddDictSample(const Slice& block_contents) {
+    assert(sample_for_dict_trainer);
+    if (num_data_blocks_sampled++ % dict_sample_stride != 0) {
+      return;
+    }
+    dict_samples.emplace_back(block_contents.data(), block_contents.size());
+    dict_samples_bytes += block_contents.size();
+    while (dict_samples_bytes > DictSampleBytes() && dict_samples.size() > 1) {
+      // Keep every other sample and sample every other block from now on
+      size_t num_kept = 0;
+      dict_samples_bytes = 0;
+      for (size_t i = 0; i < dict_samples.size(); i += 2) {
+        dict_samples_bytes += dict_samples[i].size();
+        dict_samples[num_kept++] = std::move(dict_samples[i]);
+      }
+      dict_samples.resize(num_kept);
+      dict_sample_stride *= 2;
+    }
+  }
+
   Status GetStatus() {
     // We need to make modifications of status visible when status_ok is set
     // to false, and this is ensured by status_mutex, so no special memory
@@ -460,7 +680,9 @@ struct BlockBasedTableBuilder::Rep {
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
                    table_options.data_block_hash_table_util_ratio, ts_sz,
-                   persist_user_defined_timestamps),
+                   persist_user_defined_timestamps, false /* is_user_key */,
+                   FormatVersionDeltaEncodesRestartKeys(
+                       table_options.format_version)),
         range_del_block(
             1 /* block_restart_interval */, true /* use_delta_encoding */,
             false /* use_value_delta_encoding */,
@@ -487,6 +709,7 @@ struct BlockBasedTableBuilder::Rep {
         use_delta_encoding_for_index_values(table_opt.format_version >= 4 &&
                                             !table_opt.block_align),
         reason(tbo.reason),
+        hot_key_ranges(nullptr),
         flush_block_policy(
             table_options.flush_block_policy_factory->NewFlushBlockPolicy(
                 table_options, data_block)),
@@ -501,6 +724,29 @@ struct BlockBasedTableBuilder::Rep {
         tail_size(0),
         status_ok(true),
         io_status_ok(true) {
+    // The ranges come from the user keys of the input files, which only
+    // compare with the keys added here if both have the timestamps
+    if (table_options.prepopulate_block_cache ==
+            BlockBasedTableOptions::PrepopulateBlockCache::
+                kFlushAndHotCompaction &&
+        reason == TableFileCreationReason::kCompaction &&
+        tbo.hot_key_ranges != nullptr && !tbo.hot_key_ranges->empty() &&
+        (ts_sz == 0 || persist_user_defined_timestamps)) {
+      hot_key_ranges = tbo.hot_key_ranges;
+    }
+    // The range filter maps keys to integers in their bytewise order
+    if (table_options.range_filter_bits_per_key > 0 &&
+        tbo.internal_comparator.user_comparator() == BytewiseComparator()) {
+      range_filter_builder.reset(
+          new RangeFilterBuilder(table_options.range_filter_bits_per_key));
+    }
+    build_block_timestamp_index = table_options.block_timestamp_index &&
+                                  ts_sz > 0 && persist_user_defined_timestamps;
+    if (ioptions.level_filter_bits_per_key > 0 && !tbo.skip_filters &&
+        !(ioptions.optimize_filters_for_hits && tbo.is_bottommost)) {
+      level_filter_builder.reset(
+          new LevelFilterBuilder(ioptions.level_filter_bits_per_key));
+    }
     if (tbo.target_file_size == 0) {
       buffer_limit = compression_opts.max_dict_buffer_bytes;
     } else if (compression_opts.max_dict_buffer_bytes == 0) {
@@ -509,6 +755,21 @@ struct BlockBasedTableBuilder::Rep {
       buffer_limit = std::min(tbo.target_file_size,
                               compression_opts.max_dict_buffer_bytes);
     }
+    if (state == State::kBuffered && ioptions.compression_dict_trainer) {
+      dict_trainer = ioptions.compression_dict_trainer.get();
+      std::string dict =
+          dict_trainer->GetDict(compression_type, compression_opts);
+      if (!dict.empty()) {
+        // No need to buffer the data blocks to train a dictionary
+        compression_dict.reset(new CompressionDict(dict, compression_type,
+                                                   compression_opts.level));
+        verify_dict.reset(new UncompressionDict(
+            dict, compression_type == kZSTD ||
+                      compression_type == kZSTDNotFinalCompression));
+        state = State::kUnbuffered;
+        sample_for_dict_trainer = true;
+      }
+    }
 
     const auto compress_dict_build_buffer_charged =
         table_options.cache_usage_options.options_overrides
@@ -532,6 +793,14 @@ struct BlockBasedTableBuilder::Rep {
       compression_ctxs[i].reset(
           new CompressionContext(compression_type, compression_opts));
     }
+    // The blocks of a file share its dictionary, whatever their compression
+    // type, so they cannot switch types
+    if (compression_opts.adaptive_sample_one_in > 0 &&
+        compression_type != kNoCompression &&
+        compression_opts.max_dict_bytes == 0) {
+      adaptive_compression.reset(new AdaptiveCompressionSelector(
+          compression_type, compression_opts));
+    }
     if (table_options.index_type ==
         BlockBasedTableOptions::kTwoLevelIndexSearch) {
       p_index_builder_ = PartitionedIndexBuilder::CreateIndexBuilder(
@@ -1058,6 +1327,16 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
 
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
+    if (r->level_filter_builder != nullptr) {
+      r->level_filter_builder->Add(
+          ExtractUserKeyAndStripTimestamp(key, r->ts_sz));
+    }
+    if (r->hot_key_ranges != nullptr && r->data_block.empty()) {
+      r->data_block_first_key.assign(key.data(), key.size());
+    }
     r->data_block.AddWithLastKey(key, value, r->last_key);
     r->last_key.assign(key.data(), key.size());
     if (r->state == Rep::State::kBuffered) {
@@ -1066,6 +1345,9 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     } else {
       if (!r->IsParallelCompressionEnabled()) {
         r->index_builder->OnKeyAdded(key);
+        if (r->build_block_timestamp_index) {
+          r->UpdateDataBlockMinTimestamp(key);
+        }
       }
     }
     // TODO offset passed in is not accurate for parallel compression case
@@ -1128,10 +1410,16 @@ void BlockBasedTableBuilder::Flush() {
     ParallelCompressionRep::BlockRep* block_rep = r->pc_rep->PrepareBlock(
         r->compression_type, r->first_key_in_next_block, &(r->data_block));
     assert(block_rep != nullptr);
+    if (r->sample_for_dict_trainer) {
+      r->AddDictSample(*block_rep->data);
+    }
     r->pc_rep->file_size_estimator.EmitBlock(block_rep->data->size(),
                                              r->get_offset());
     r->pc_rep->EmitBlock(block_rep);
   } else {
+    if (r->hot_key_ranges != nullptr && r->state == Rep::State::kUnbuffered) {
+      r->hot_data_block = IsHotDataBlock(r->data_block_first_key, r->last_key);
+    }
     WriteBlock(&r->data_block, &r->pending_handle, BlockType::kData);
   }
 }
@@ -1161,6 +1449,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& uncompressed_block_data,
   CompressionType type;
   Status compress_status;
   bool is_data_block = block_type == BlockType::kData;
+  if (is_data_block && r->sample_for_dict_trainer) {
+    r->AddDictSample(uncompressed_block_data);
+  }
   CompressAndVerifyBlock(uncompressed_block_data, is_data_block,
                          *(r->compression_ctxs[0]), r->verify_ctxs[0].get(),
                          &(r->compressed_output), &(block_contents), &type,
@@ -1224,8 +1515,22 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       compression_dict = r->compression_dict.get();
     }
     assert(compression_dict != nullptr);
-    CompressionInfo compression_info(r->compression_opts, compression_ctx,
-                                     *compression_dict, r->compression_type,
+    CompressionType compression_type = r->compression_type;
+    const CompressionOptions* compression_opts = &r->compression_opts;
+    if (is_data_block && r->adaptive_compression != nullptr) {
+      AdaptiveCompressionSelector* selector = r->adaptive_compression.get();
+      if (selector->ShouldSample()) {
+        compression_type = selector->Sample(
+            uncompressed_block_data, compression_ctx,
+            GetCompressFormatForVersion(r->table_options.format_version),
+            r->ioptions.clock);
+      } else {
+        compression_type = selector->Chosen();
+      }
+      compression_opts = &selector->OptionsFor(compression_type);
+    }
+    CompressionInfo compression_info(*compression_opts, compression_ctx,
+                                     *compression_dict, compression_type,
                                      r->sample_for_compression);
 
     std::string sampled_output_fast;
@@ -1233,7 +1538,8 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
     *block_contents = CompressBlock(
         uncompressed_block_data, compression_info, type,
         r->table_options.format_version, is_data_block /* allow_sample */,
-        compressed_output, &sampled_output_fast, &sampled_output_slow);
+        compressed_output, &sampled_output_fast, &sampled_output_slow,
+        r->ioptions.compression_accelerator.get());
 
     if (sampled_output_slow.size() > 0 || sampled_output_fast.size() > 0) {
       // Currently compression sampling is only enabled for data block.
@@ -1263,8 +1569,7 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       }
       assert(verify_dict != nullptr);
       BlockContents contents;
-      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict,
-                                           r->compression_type);
+      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict, *type);
       Status uncompress_status = UncompressBlockData(
           uncompression_info, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
@@ -1347,6 +1652,12 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
   handle->set_size(block_contents.size());
   assert(status().ok());
   assert(io_status().ok());
+  if (is_data_block && r->build_block_timestamp_index) {
+    assert(!r->data_block_min_timestamp.empty());
+    PutFixed64(&r->block_timestamp_index, offset);
+    r->block_timestamp_index.append(r->data_block_min_timestamp);
+    r->data_block_min_timestamp.clear();
+  }
   if (uncompressed_block_data == nullptr) {
     uncompressed_block_data = &block_contents;
     assert(comp_type == kNoCompression);
@@ -1393,6 +1704,11 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
       case BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly:
         warm_cache = (r->reason == TableFileCreationReason::kFlush);
         break;
+      case BlockBasedTableOptions::PrepopulateBlockCache::
+          kFlushAndHotCompaction:
+        warm_cache = (r->reason == TableFileCreationReason::kFlush) ||
+                     (is_data_block && r->hot_data_block);
+        break;
       case BlockBasedTableOptions::PrepopulateBlockCache::kDisable:
         warm_cache = false;
         break;
@@ -1460,10 +1776,17 @@ void BlockBasedTableBuilder::BGWorkWriteMaybeCompressedBlock() {
         r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, r->ts_sz));
       }
       r->index_builder->OnKeyAdded(key);
+      if (r->build_block_timestamp_index) {
+        r->UpdateDataBlockMinTimestamp(key);
+      }
     }
 
     r->pc_rep->file_size_estimator.SetCurrBlockUncompSize(
         block_rep->data->size());
+    if (r->hot_key_ranges != nullptr) {
+      r->hot_data_block =
+          IsHotDataBlock((*block_rep->keys)[0], block_rep->keys->Back());
+    }
     WriteMaybeCompressedBlock(block_rep->compressed_contents,
                               block_rep->compression_type, &r->pending_handle,
                               BlockType::kData, &block_rep->contents);
@@ -1519,6 +1842,23 @@ IOStatus BlockBasedTableBuilder::io_status() const {
   return rep_->GetIOStatus();
 }
 
+bool BlockBasedTableBuilder::IsHotDataBlock(const Slice& first_key,
+                                            const Slice& last_key) {
+  Rep* r = rep_;
+  assert(r->hot_key_ranges != nullptr);
+  const Comparator* ucmp = r->internal_comparator.user_comparator();
+  const std::vector<OwnedUserKeyRange>& ranges = *r->hot_key_ranges;
+  const Slice first_user_key = ExtractUserKey(first_key);
+  while (r->next_hot_key_range < ranges.size() &&
+         ucmp->Compare(ranges[r->next_hot_key_range].limit, first_user_key) <
+             0) {
+    ++r->next_hot_key_range;
+  }
+  return r->next_hot_key_range < ranges.size() &&
+         ucmp->Compare(ranges[r->next_hot_key_range].start,
+                       ExtractUserKey(last_key)) <= 0;
+}
+
 Status BlockBasedTableBuilder::InsertBlockInCacheHelper(
     const Slice& block_contents, const BlockHandle* handle,
     BlockType block_type) {
@@ -1538,6 +1878,10 @@ Status BlockBasedTableBuilder::InsertBlockInCacheHelper(
       BlockBasedTable::UpdateCacheInsertionMetrics(
           block_type, nullptr /*get_context*/, charge, s.IsOkOverwritten(),
           rep_->ioptions.stats);
+      if (rep_->ioptions.tenant_usage) {
+        rep_->ioptions.tenant_usage->Add(kTenantBlockCacheBytesInserted,
+                                         charge);
+      }
     } else {
       RecordTick(rep_->ioptions.stats, BLOCK_CACHE_ADD_FAILURES);
     }
@@ -1808,6 +2152,57 @@ void BlockBasedTableBuilder::WriteRangeDelBlock(
   }
 }
 
+void BlockBasedTableBuilder::WriteRangeFilterBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && rep_->range_filter_builder != nullptr &&
+      !rep_->range_filter_builder->IsEmpty()) {
+    std::string contents;
+    rep_->range_filter_builder->Finish(&contents);
+    BlockHandle range_filter_block_handle;
+    WriteMaybeCompressedBlock(contents, kNoCompression,
+                              &range_filter_block_handle,
+                              BlockType::kRangeFilter);
+    if (ok()) {
+      meta_index_builder->Add(kRangeFilterBlockName,
+                              range_filter_block_handle);
+    }
+  }
+}
+
+void BlockBasedTableBuilder::WriteLevelFilterBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  // The range tombstones of a file apply to keys it has no entry for, so
+  // the file cannot be skipped for the keys missing from its filter
+  if (ok() && rep_->level_filter_builder != nullptr &&
+      !rep_->level_filter_builder->IsEmpty() &&
+      rep_->range_del_block.empty()) {
+    std::string contents;
+    rep_->level_filter_builder->Finish(&contents);
+    BlockHandle level_filter_block_handle;
+    WriteMaybeCompressedBlock(contents, kNoCompression,
+                              &level_filter_block_handle,
+                              BlockType::kLevelFilter);
+    if (ok()) {
+      meta_index_builder->Add(kLevelFilterBlockName,
+                              level_filter_block_handle);
+    }
+  }
+}
+
+void BlockBasedTableBuilder::WriteBlockTimestampIndexBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && !rep_->block_timestamp_index.empty()) {
+    BlockHandle block_timestamp_index_handle;
+    WriteMaybeCompressedBlock(rep_->block_timestamp_index, kNoCompression,
+                              &block_timestamp_index_handle,
+                              BlockType::kBlockTimestampIndex);
+    if (ok()) {
+      meta_index_builder->Add(kBlockTimestampIndexBlockName,
+                              block_timestamp_index_handle);
+    }
+  }
+}
+
 void BlockBasedTableBuilder::WriteFooter(BlockHandle& metaindex_block_handle,
                                          BlockHandle& index_block_handle) {
   assert(ok());
@@ -1888,22 +2283,19 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
     }
   }
 
+  if (r->dict_trainer != nullptr && !compression_dict_samples.empty()) {
+    // Train the dictionary of the next files in the background
+    r->dict_trainer->AddSamples(
+        r->compression_type, r->compression_opts,
+        std::string(compression_dict_samples),
+        std::vector<size_t>(compression_dict_sample_lens));
+  }
+
   // final data block flushed, now we can generate dictionary from the samples.
   // OK if compression_dict_samples is empty, we'll just get empty dictionary.
-  std::string dict;
-  if (r->compression_opts.zstd_max_train_bytes > 0) {
-    if (r->compression_opts.use_zstd_dict_trainer) {
-      dict = ZSTD_TrainDictionary(compression_dict_samples,
-                                  compression_dict_sample_lens,
-                                  r->compression_opts.max_dict_bytes);
-    } else {
-      dict = ZSTD_FinalizeDictionary(
-          compression_dict_samples, compression_dict_sample_lens,
-          r->compression_opts.max_dict_bytes, r->compression_opts.level);
-    }
-  } else {
-    dict = std::move(compression_dict_samples);
-  }
+  std::string dict =
+      BuildCompressionDict(std::move(compression_dict_samples),
+                           compression_dict_sample_lens, r->compression_opts);
   r->compression_dict.reset(new CompressionDict(dict, r->compression_type,
                                                 r->compression_opts.level));
   r->verify_dict.reset(new UncompressionDict(
@@ -1961,6 +2353,10 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
                                                r->get_offset());
       r->pc_rep->EmitBlock(block_rep);
     } else {
+      std::string first_key;
+      if (r->hot_key_ranges != nullptr) {
+        first_key = iter->key().ToString();
+      }
       for (; iter->Valid(); iter->Next()) {
         Slice key = iter->key();
         if (r->filter_builder != nullptr) {
@@ -1968,6 +2364,13 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
               ExtractUserKeyAndStripTimestamp(key, r->ts_sz));
         }
         r->index_builder->OnKeyAdded(key);
+        if (r->build_block_timestamp_index) {
+          r->UpdateDataBlockMinTimestamp(key);
+        }
+      }
+      if (r->hot_key_ranges != nullptr) {
+        iter->SeekToLast();
+        r->hot_data_block = IsHotDataBlock(first_key, iter->key());
       }
       WriteBlock(Slice(data_block), &r->pending_handle, BlockType::kData);
       if (ok() && i + 1 < r->data_block_buffers.size()) {
@@ -2003,6 +2406,23 @@ Status BlockBasedTableBuilder::Finish() {
   if (r->state == Rep::State::kBuffered) {
     EnterUnbuffered();
   }
+  if (r->sample_for_dict_trainer && !r->dict_samples.empty() && ok()) {
+    // Train the dictionary of the next files in the background
+    std::string samples;
+    std::vector<size_t> sample_lens;
+    for (const auto& sample : r->dict_samples) {
+      if (samples.size() >= r->DictSampleBytes()) {
+        break;
+      }
+      size_t len =
+          std::min(r->DictSampleBytes() - samples.size(), sample.size());
+      samples.append(sample, 0, len);
+      sample_lens.push_back(len);
+    }
+    r->dict_samples.clear();
+    r->dict_trainer->AddSamples(r->compression_type, r->compression_opts,
+                                std::move(samples), std::move(sample_lens));
+  }
   if (r->IsParallelCompressionEnabled()) {
     StopParallelCompression();
 #ifndef NDEBUG
@@ -2035,6 +2455,9 @@ Status BlockBasedTableBuilder::Finish() {
   WriteIndexBlock(&meta_index_builder, &index_block_handle);
   WriteCompressionDictBlock(&meta_index_builder);
   WriteRangeDelBlock(&meta_index_builder);
+  WriteRangeFilterBlock(&meta_index_builder);
+  WriteLevelFilterBlock(&meta_index_builder);
+  WriteBlockTimestampIndexBlock(&meta_index_builder);
   WritePropertiesBlock(&meta_index_builder);
   if (ok()) {
     // flush the meta index block
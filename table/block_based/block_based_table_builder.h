@@ -133,6 +133,11 @@ class BlockBasedTableBuilder : public TableBuilder {
 
   void SetupCacheKeyPrefix(const TableBuilderOptions& tbo);
 
+  // Whether the data block from `first_key` to `last_key` overlaps the hot
+  // key ranges. Must be called for the data blocks in order.
+  // REQUIRES: `rep_->hot_key_ranges != nullptr`
+  bool IsHotDataBlock(const Slice& first_key, const Slice& last_key);
+
   template <typename TBlocklike>
   Status InsertBlockInCache(const Slice& block_contents,
                             const BlockHandle* handle, BlockType block_type);
@@ -151,6 +156,9 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WritePropertiesBlock(MetaIndexBuilder* meta_index_builder);
   void WriteCompressionDictBlock(MetaIndexBuilder* meta_index_builder);
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteRangeFilterBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteLevelFilterBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteBlockTimestampIndexBlock(MetaIndexBuilder* meta_index_builder);
   void WriteFooter(BlockHandle& metaindex_block_handle,
                    BlockHandle& index_block_handle);
 
@@ -203,6 +211,7 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
                     CompressionType* type, uint32_t format_version,
                     bool do_sample, std::string* compressed_output,
                     std::string* sampled_output_fast,
-                    std::string* sampled_output_slow);
+                    std::string* sampled_output_slow,
+                    CompressionAccelerator* accelerator = nullptr);
 
 }  // namespace ROCKSDB_NAMESPACE
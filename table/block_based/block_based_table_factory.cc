@@ -222,7 +222,10 @@ static std::unordered_map<std::string,
     block_base_table_prepopulate_block_cache_string_map = {
         {"kDisable", BlockBasedTableOptions::PrepopulateBlockCache::kDisable},
         {"kFlushOnly",
-         BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly}};
+         BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly},
+        {"kFlushAndHotCompaction",
+         BlockBasedTableOptions::PrepopulateBlockCache::
+             kFlushAndHotCompaction}};
 
 static std::unordered_map<std::string, OptionTypeInfo>
     block_based_table_type_info = {
@@ -269,6 +272,20 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    data_block_hash_table_util_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"data_block_restart_key_prefixes",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_restart_key_prefixes),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"index_block_restart_key_model",
+         {offsetof(struct BlockBasedTableOptions,
+                   index_block_restart_key_model),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"cache_mmap_read_blocks",
+         {offsetof(struct BlockBasedTableOptions, cache_mmap_read_blocks),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal,
@@ -317,6 +334,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
              offsetof(struct BlockBasedTableOptions, filter_policy),
              OptionVerificationType::kByNameAllowFromNull,
              OptionTypeFlags::kNone)},
+        {"range_filter_bits_per_key",
+         {offsetof(struct BlockBasedTableOptions, range_filter_bits_per_key),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_timestamp_index",
+         {offsetof(struct BlockBasedTableOptions, block_timestamp_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"whole_key_filtering",
          {offsetof(struct BlockBasedTableOptions, whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -412,6 +437,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    num_file_reads_for_auto_readahead),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"learned_auto_readahead",
+         {offsetof(struct BlockBasedTableOptions, learned_auto_readahead),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 
 };
 
@@ -754,6 +783,15 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_restart_key_prefixes: %d\n",
+           table_options_.data_block_restart_key_prefixes);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  index_block_restart_key_model: %d\n",
+           table_options_.index_block_restart_key_model);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  cache_mmap_read_blocks: %d\n",
+           table_options_.cache_mmap_read_blocks);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  checksum: %d\n", table_options_.checksum);
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "  no_block_cache: %d\n",
@@ -809,6 +847,12 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  whole_key_filtering: %d\n",
            table_options_.whole_key_filtering);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_bits_per_key: %lf\n",
+           table_options_.range_filter_bits_per_key);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  block_timestamp_index: %d\n",
+           table_options_.block_timestamp_index);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  verify_compression: %d\n",
            table_options_.verify_compression);
   ret.append(buffer);
@@ -839,6 +883,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
            "  num_file_reads_for_auto_readahead: %" PRIu64 "\n",
            table_options_.num_file_reads_for_auto_readahead);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  learned_auto_readahead: %d\n",
+           table_options_.learned_auto_readahead);
+  ret.append(buffer);
   return ret;
 }
 
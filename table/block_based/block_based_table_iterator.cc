@@ -72,6 +72,10 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
                                             ? LAST_LEVEL_SEEK_FILTER_MATCH
                                             : NON_LAST_LEVEL_SEEK_FILTER_MATCH);
   }
+  if (target && !CheckRangeMayMatch(*target, IterDirection::kForward)) {
+    ResetDataIter();
+    return;
+  }
 
   bool need_seek_index = true;
 
@@ -191,6 +195,10 @@ void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
                                             ? LAST_LEVEL_SEEK_FILTER_MATCH
                                             : NON_LAST_LEVEL_SEEK_FILTER_MATCH);
   }
+  if (!CheckRangeMayMatch(target, IterDirection::kBackward)) {
+    ResetDataIter();
+    return;
+  }
 
   SavePrevIndexValue();
 
@@ -352,6 +360,7 @@ void BlockBasedTableIterator::InitDataBlock() {
     if (block_iter_points_to_real_block_) {
       ResetDataIter();
     }
+    TrackScanRun(data_block_handle);
 
     bool is_for_compaction =
         lookup_context_.caller == TableReaderCaller::kCompaction;
@@ -422,6 +431,7 @@ void BlockBasedTableIterator::AsyncInitDataBlock(bool is_first_pass) {
       if (block_iter_points_to_real_block_) {
         ResetDataIter();
       }
+      TrackScanRun(data_block_handle);
       auto* rep = table_->get_rep();
 
       std::function<void(bool, uint64_t&, uint64_t&)> readaheadsize_cb =
@@ -622,6 +632,18 @@ void BlockBasedTableIterator::FindBlockForward() {
       }
       IndexValue v = index_iter_->value();
 
+      // A block without a version as old as the read timestamp only holds
+      // entries the reader would skip. A block that reaches the upper bound
+      // is read, so that the bound is still checked on its keys.
+      if (!readahead_cache_lookup_ &&
+          !table_->BlockTimestampMayMatch(read_options_, v.handle.offset()) &&
+          (read_options_.iterate_upper_bound == nullptr ||
+           user_comparator_.CompareWithoutTimestamp(
+               *read_options_.iterate_upper_bound, /*a_has_ts=*/false,
+               index_iter_->user_key(), /*b_has_ts=*/true) > 0)) {
+        continue;
+      }
+
       if (!v.first_internal_key.empty() && allow_unprepared_value_) {
         // Index contains the first key of the block. Defer reading the block.
         is_at_first_key_from_index_ = true;
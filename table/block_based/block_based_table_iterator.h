@@ -37,9 +37,8 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
         pinned_iters_mgr_(nullptr),
         prefix_extractor_(prefix_extractor),
         lookup_context_(caller),
-        block_prefetcher_(
-            compaction_readahead_size,
-            table_->get_rep()->table_options.initial_auto_readahead_size),
+        block_prefetcher_(compaction_readahead_size,
+                          table_->get_rep()->InitialAutoReadaheadSize()),
         allow_unprepared_value_(allow_unprepared_value),
         block_iter_points_to_real_block_(false),
         check_filter_(check_filter),
@@ -47,7 +46,10 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
         async_read_in_progress_(false),
         is_last_level_(table->IsLastLevel()) {}
 
-  ~BlockBasedTableIterator() override { ClearBlockHandles(); }
+  ~BlockBasedTableIterator() override {
+    ClearBlockHandles();
+    FinishScanRun();
+  }
 
   void Seek(const Slice& target) override;
   void SeekForPrev(const Slice& target) override;
@@ -307,6 +309,10 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   BlockCacheLookupContext lookup_context_;
 
   BlockPrefetcher block_prefetcher_;
+  // The run of sequential data block reads in progress, [start, end) in the
+  // file, for BlockBasedTableOptions::learned_auto_readahead
+  uint64_t scan_run_start_ = 0;
+  uint64_t scan_run_end_ = 0;
 
   const bool allow_unprepared_value_;
   // True if block_iter_ is initialized and points to the same block
@@ -359,6 +365,31 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
 
   void InitDataBlock();
   void AsyncInitDataBlock(bool is_first_pass);
+
+  // Extends the run of sequential data block reads with the block, or
+  // records the run and starts another one if the block does not follow it
+  void TrackScanRun(const BlockHandle& handle) {
+    const BlockBasedTable::Rep* rep = table_->get_rep();
+    if (!rep->table_options.learned_auto_readahead ||
+        read_options_.readahead_size > 0 ||
+        lookup_context_.caller == TableReaderCaller::kCompaction) {
+      return;
+    }
+    if (handle.offset() != scan_run_end_) {
+      FinishScanRun();
+      scan_run_start_ = handle.offset();
+    }
+    scan_run_end_ =
+        handle.offset() + BlockBasedTable::BlockSizeWithTrailer(handle);
+  }
+
+  void FinishScanRun() {
+    if (scan_run_end_ > scan_run_start_) {
+      table_->get_rep()->RecordScanBytes(scan_run_end_ - scan_run_start_);
+    }
+    scan_run_start_ = 0;
+    scan_run_end_ = 0;
+  }
   bool MaterializeCurrentBlock();
   void FindKeyForward();
   void FindBlockForward();
@@ -393,6 +424,24 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     return true;
   }
 
+  // Checks the range filter of the table for keys between the seek target
+  // and the iterate bound in the direction of the seek
+  bool CheckRangeMayMatch(const Slice& ikey, IterDirection direction) {
+    if (!check_filter_) {
+      return true;
+    }
+    const Slice user_key = ExtractUserKey(ikey);
+    if (direction == IterDirection::kForward) {
+      return read_options_.iterate_upper_bound == nullptr ||
+             table_->RangeMayMatch(user_key,
+                                   *read_options_.iterate_upper_bound);
+    } else {
+      return read_options_.iterate_lower_bound == nullptr ||
+             table_->RangeMayMatch(*read_options_.iterate_lower_bound,
+                                   user_key);
+    }
+  }
+
   // *** BEGIN APIs relevant to auto tuning of readahead_size ***
 
   // This API is called to lookup the data blocks ahead in the cache to tune
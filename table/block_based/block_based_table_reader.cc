@@ -45,6 +45,7 @@
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table.h"
 #include "rocksdb/table_properties.h"
+#include "rocksdb/tenant_usage.h"
 #include "rocksdb/trace_record.h"
 #include "table/block_based/binary_search_index_reader.h"
 #include "table/block_based/block.h"
@@ -705,7 +706,7 @@ Status BlockBasedTable::Open(
       &rep->table_options, &rep->ioptions, rep->ioptions.stats,
       blocks_definitely_zstd_compressed, block_protection_bytes_per_key,
       rep->internal_comparator.user_comparator(), rep->index_value_is_full,
-      rep->index_has_first_key);
+      rep->index_has_first_key, rep->index_key_includes_seq);
 
   // Check expected unique id if provided
   if (expected_unique_id != kNullUniqueId64x2) {
@@ -790,12 +791,38 @@ Status BlockBasedTable::Open(
       PersistentCacheOptions(rep->table_options.persistent_cache,
                              rep->base_cache_key, rep->ioptions.stats);
 
+  // Blocks referencing the mapped file must not outlive the mapping in any
+  // lookup, so they are cached under keys no other reader of the same file
+  // can produce
+  rep->cache_mmap_read_blocks =
+      table_options.cache_mmap_read_blocks && ioptions.allow_mmap_reads;
+  if (rep->cache_mmap_read_blocks) {
+    CacheKey unique = CacheKey::CreateUniqueForProcessLifetime();
+    rep->base_cache_key = OffsetableCacheKey(
+        "mmap", unique.AsSlice().ToString(), cur_file_num);
+  }
+
   s = new_table->ReadRangeDelBlock(ro, prefetch_buffer.get(),
                                    metaindex_iter.get(), internal_comparator,
                                    &lookup_context);
   if (!s.ok()) {
     return s;
   }
+  s = new_table->ReadRangeFilterBlock(ro, prefetch_buffer.get(),
+                                      metaindex_iter.get());
+  if (!s.ok()) {
+    return s;
+  }
+  s = new_table->ReadLevelFilterBlock(ro, prefetch_buffer.get(),
+                                      metaindex_iter.get());
+  if (!s.ok()) {
+    return s;
+  }
+  s = new_table->ReadBlockTimestampIndexBlock(ro, prefetch_buffer.get(),
+                                              metaindex_iter.get());
+  if (!s.ok()) {
+    return s;
+  }
   rep->verify_checksum_set_on_open = ro.verify_checksums;
   s = new_table->PrefetchIndexAndFilterBlocks(
       ro, prefetch_buffer.get(), metaindex_iter.get(), new_table.get(),
@@ -1048,6 +1075,135 @@ Status BlockBasedTable::ReadRangeDelBlock(
   return s;
 }
 
+Status BlockBasedTable::ReadRangeFilterBlock(
+    const ReadOptions& read_options, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  // The range filter is only built for, and only valid with, the bytewise
+  // order of user keys without timestamps
+  if (rep_->internal_comparator.user_comparator() != BytewiseComparator()) {
+    return Status::OK();
+  }
+  BlockHandle range_filter_handle;
+  Status s = FindOptionalMetaBlock(meta_iter, kRangeFilterBlockName,
+                                   &range_filter_handle);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Error when seeking to range filter block from file: %s",
+                   s.ToString().c_str());
+    return s;
+  }
+  if (range_filter_handle.IsNull()) {
+    return s;
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, read_options,
+      range_filter_handle, &contents, rep_->ioptions, true /*decompress*/,
+      true /*maybe_compressed*/, BlockType::kRangeFilter,
+      UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+      GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (s.ok()) {
+    s = RangeFilter::Create(std::move(contents), &rep_->range_filter);
+  }
+  if (!s.ok()) {
+    // Like a missing filter, this only costs the reads it would have saved
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading range filter block: %s",
+                   s.ToString().c_str());
+    rep_->range_filter.reset();
+  }
+  return Status::OK();
+}
+
+Status BlockBasedTable::ReadLevelFilterBlock(
+    const ReadOptions& read_options, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  if (!(rep_->ioptions.level_filter_bits_per_key > 0)) {
+    return Status::OK();
+  }
+  BlockHandle level_filter_handle;
+  Status s = FindOptionalMetaBlock(meta_iter, kLevelFilterBlockName,
+                                   &level_filter_handle);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Error when seeking to level filter block from file: %s",
+                   s.ToString().c_str());
+    return s;
+  }
+  if (level_filter_handle.IsNull()) {
+    return s;
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, read_options,
+      level_filter_handle, &contents, rep_->ioptions, true /*decompress*/,
+      true /*maybe_compressed*/, BlockType::kLevelFilter,
+      UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
+      GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  std::unique_ptr<LevelFilter> level_filter;
+  if (s.ok()) {
+    s = LevelFilter::Create(std::move(contents), &level_filter);
+  }
+  if (s.ok()) {
+    rep_->level_filter = std::move(level_filter);
+  } else {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading level filter block: %s",
+                   s.ToString().c_str());
+  }
+  return Status::OK();
+}
+
+Status BlockBasedTable::ReadBlockTimestampIndexBlock(
+    const ReadOptions& read_options, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  const size_t ts_sz =
+      rep_->internal_comparator.user_comparator()->timestamp_size();
+  if (ts_sz == 0) {
+    return Status::OK();
+  }
+  BlockHandle block_timestamp_index_handle;
+  Status s = FindOptionalMetaBlock(meta_iter, kBlockTimestampIndexBlockName,
+                                   &block_timestamp_index_handle);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(
+        rep_->ioptions.logger,
+        "Error when seeking to block timestamp index block from file: %s",
+        s.ToString().c_str());
+    return s;
+  }
+  if (block_timestamp_index_handle.IsNull()) {
+    return s;
+  }
+  BlockContents contents;
+  BlockFetcher block_fetcher(
+      rep_->file.get(), prefetch_buffer, rep_->footer, read_options,
+      block_timestamp_index_handle, &contents, rep_->ioptions,
+      true /*decompress*/, true /*maybe_compressed*/,
+      BlockType::kBlockTimestampIndex, UncompressionDict::GetEmptyDict(),
+      rep_->persistent_cache_options, GetMemoryAllocator(rep_->table_options));
+  s = block_fetcher.ReadBlockContents();
+  if (s.ok() && contents.data.size() % (sizeof(uint64_t) + ts_sz) != 0) {
+    s = Status::Corruption("Bad block timestamp index block");
+  }
+  if (s.ok()) {
+    rep_->block_timestamp_index = std::move(contents);
+  } else {
+    // Like a missing index, this only costs the reads it would have saved
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading block timestamp index "
+                   "block: %s",
+                   s.ToString().c_str());
+  }
+  return Status::OK();
+}
+
+std::shared_ptr<const LevelFilter> BlockBasedTable::GetLevelFilter() const {
+  return rep_->level_filter;
+}
+
 Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
     InternalIterator* meta_iter, BlockBasedTable* new_table, bool prefetch_all,
@@ -1281,6 +1437,13 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->uncompression_dict_reader) {
     usage += rep_->uncompression_dict_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage();
+  }
+  if (rep_->level_filter) {
+    usage += rep_->level_filter->ApproximateMemoryUsage();
+  }
+  usage += rep_->block_timestamp_index.usable_size();
   if (rep_->table_properties) {
     usage += rep_->table_properties->ApproximateMemoryUsage();
   }
@@ -1415,13 +1578,18 @@ WithBlocklikeCheck<Status, TBlocklike> BlockBasedTable::PutDataBlockToCache(
                               std::move(uncompressed_block_contents));
 
   // insert into uncompressed block cache
-  if (block_cache && block_holder->own_bytes()) {
+  bool own_bytes = block_holder->own_bytes();
+  if (block_cache && (own_bytes || rep_->cache_mmap_read_blocks)) {
     size_t charge = block_holder->ApproximateMemoryUsage();
     BlockCacheTypedHandle<TBlocklike>* cache_handle = nullptr;
-    s = block_cache.InsertFull(cache_key, block_holder.get(), charge,
-                               &cache_handle, GetCachePriority<TBlocklike>(),
-                               rep_->ioptions.lowest_used_cache_tier,
-                               compressed_block_contents.data, block_comp_type);
+    // A block referencing the mapped file cannot be saved anywhere that
+    // outlives this reader
+    s = block_cache.InsertFull(
+        cache_key, block_holder.get(), charge, &cache_handle,
+        GetCachePriority<TBlocklike>(),
+        own_bytes ? rep_->ioptions.lowest_used_cache_tier
+                  : CacheTier::kVolatileTier,
+        compressed_block_contents.data, block_comp_type);
 
     if (s.ok()) {
       assert(cache_handle != nullptr);
@@ -1430,6 +1598,10 @@ WithBlocklikeCheck<Status, TBlocklike> BlockBasedTable::PutDataBlockToCache(
 
       UpdateCacheInsertionMetrics(TBlocklike::kBlockType, get_context, charge,
                                   s.IsOkOverwritten(), rep_->ioptions.stats);
+      if (rep_->ioptions.tenant_usage) {
+        rep_->ioptions.tenant_usage->Add(kTenantBlockCacheBytesInserted,
+                                         charge);
+      }
     } else {
       RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
     }
@@ -1991,6 +2163,23 @@ bool BlockBasedTable::PrefixRangeMayMatch(
   return may_match;
 }
 
+bool BlockBasedTable::RangeMayMatch(const Slice& lower,
+                                    const Slice& upper) const {
+  const RangeFilter* const range_filter = rep_->range_filter.get();
+  if (range_filter == nullptr ||
+      rep_->internal_comparator.user_comparator()->Compare(lower, upper) >
+          0) {
+    return true;
+  }
+  Statistics* const statistics = rep_->ioptions.stats;
+  RecordTick(statistics, RANGE_FILTER_CHECKED);
+  if (range_filter->RangeMayExist(lower, upper)) {
+    return true;
+  }
+  RecordTick(statistics, RANGE_FILTER_USEFUL);
+  return false;
+}
+
 bool BlockBasedTable::PrefixExtractorChanged(
     const SliceTransform* prefix_extractor) const {
   if (prefix_extractor == nullptr) {
@@ -2064,6 +2253,26 @@ FragmentedRangeTombstoneIterator* BlockBasedTable::NewRangeTombstoneIterator(
                                               read_seqno, timestamp);
 }
 
+bool BlockBasedTable::MaxCoveringTombstoneSeqnum(
+    const ReadOptions& read_options, const Slice& user_key,
+    SequenceNumber* seq) {
+  if (rep_->fragmented_range_dels == nullptr) {
+    *seq = 0;
+    return true;
+  }
+  const Comparator* ucmp = rep_->internal_comparator.user_comparator();
+  if (ucmp->timestamp_size() > 0) {
+    return false;
+  }
+  SequenceNumber snapshot = kMaxSequenceNumber;
+  if (read_options.snapshot != nullptr) {
+    snapshot = read_options.snapshot->GetSequenceNumber();
+  }
+  *seq = rep_->fragmented_range_dels->MaxCoveringTombstoneSeqnum(
+      user_key, snapshot, ucmp);
+  return true;
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(
     FilterBlockReader* filter, const Slice& internal_key, const bool no_io,
     const SliceTransform* prefix_extractor, GetContext* get_context,
@@ -2215,6 +2424,45 @@ Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
   return Status::OK();
 }
 
+Status BlockBasedTable::GetCachedKeyRanges(
+    const ReadOptions& read_options, const Slice& smallest_user_key,
+    std::vector<OwnedUserKeyRange>& ranges) {
+  Cache* const cache = rep_->table_options.block_cache.get();
+  if (cache == nullptr) {
+    return Status::OK();
+  }
+
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(
+      read_options, /*disable_prefix_seek=*/false, &iiter_on_stack,
+      /*get_context=*/nullptr, /*lookup_context=*/nullptr);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // The range of a data block starts at the index key of the previous one,
+  // which is no smaller than the last key of the previous block
+  std::string prev_key = smallest_user_key.ToString();
+  bool prev_cached = false;
+  for (iiter->SeekToFirst(); iiter->Valid(); iiter->Next()) {
+    CacheKey key = GetCacheKey(rep_->base_cache_key, iiter->value().handle);
+    Cache::Handle* const cache_handle = cache->Lookup(key.AsSlice());
+    const Slice user_key = iiter->user_key();
+    if (cache_handle != nullptr) {
+      cache->Release(cache_handle);
+      if (prev_cached) {
+        ranges.back().limit.assign(user_key.data(), user_key.size());
+      } else {
+        ranges.emplace_back(prev_key, user_key);
+      }
+    }
+    prev_cached = cache_handle != nullptr;
+    prev_key.assign(user_key.data(), user_key.size());
+  }
+  return iiter->status();
+}
+
 bool BlockBasedTable::TimestampMayMatch(const ReadOptions& read_options) const {
   if (read_options.timestamp != nullptr && !rep_->min_timestamp.empty()) {
     RecordTick(rep_->ioptions.stats, TIMESTAMP_FILTER_TABLE_CHECKED);
@@ -2228,6 +2476,39 @@ bool BlockBasedTable::TimestampMayMatch(const ReadOptions& read_options) const {
   return true;
 }
 
+bool BlockBasedTable::BlockTimestampMayMatch(const ReadOptions& read_options,
+                                             uint64_t block_offset) const {
+  const Slice& index = rep_->block_timestamp_index.data;
+  if (read_options.timestamp == nullptr || index.empty()) {
+    return true;
+  }
+  const Comparator* ucmp = rep_->internal_comparator.user_comparator();
+  const size_t ts_sz = ucmp->timestamp_size();
+  const size_t entry_size = sizeof(uint64_t) + ts_sz;
+  // The entries are in the order of the block offsets
+  size_t left = 0;
+  size_t right = index.size() / entry_size;
+  while (left < right) {
+    const size_t mid = left + (right - left) / 2;
+    if (DecodeFixed64(index.data() + mid * entry_size) < block_offset) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  const char* entry = index.data() + left * entry_size;
+  if (left == index.size() / entry_size ||
+      DecodeFixed64(entry) != block_offset) {
+    return true;
+  }
+  const Slice min_timestamp(entry + sizeof(uint64_t), ts_sz);
+  if (ucmp->CompareTimestamp(*read_options.timestamp, min_timestamp) < 0) {
+    RecordTick(rep_->ioptions.stats, TIMESTAMP_FILTER_BLOCK_FILTERED);
+    return false;
+  }
+  return true;
+}
+
 Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                             GetContext* get_context,
                             const SliceTransform* prefix_extractor,
@@ -2506,6 +2787,43 @@ Status BlockBasedTable::Prefetch(const ReadOptions& read_options,
   return Status::OK();
 }
 
+void BlockBasedTable::PrefetchForScan(const ReadOptions& read_options) {
+  if (read_options.read_tier == kBlockCacheTier) {
+    return;
+  }
+  // The data blocks start at the beginning of the file
+  size_t readahead_size = read_options.readahead_size > 0
+                              ? read_options.readahead_size
+                              : rep_->table_options.initial_auto_readahead_size;
+  readahead_size = static_cast<size_t>(
+      std::min(static_cast<uint64_t>(readahead_size), rep_->file_size));
+  if (readahead_size == 0) {
+    return;
+  }
+  TEST_SYNC_POINT_CALLBACK("BlockBasedTable::PrefetchForScan",
+                           &readahead_size);
+  IOOptions opts;
+  IOStatus s = rep_->file->PrepareIOOptions(read_options, opts);
+  if (s.ok()) {
+    // Only a hint, e.g. readahead() on posix
+    s = rep_->file->Prefetch(opts, 0, readahead_size);
+  }
+  s.PermitUncheckedError();
+}
+
+Status BlockBasedTable::CacheDependencies(const ReadOptions& read_options) {
+  if (rep_->table_options.block_cache == nullptr) {
+    return Status::OK();
+  }
+  Status s = rep_->index_reader->CacheDependencies(
+      read_options, false /* pin */, nullptr /* prefetch_buffer */);
+  if (s.ok() && rep_->filter) {
+    s = rep_->filter->CacheDependencies(read_options, false /* pin */,
+                                        nullptr /* prefetch_buffer */);
+  }
+  return s;
+}
+
 Status BlockBasedTable::VerifyChecksum(const ReadOptions& read_options,
                                        TableReaderCaller caller) {
   Status s;
@@ -2617,6 +2935,18 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kIndex;
   }
 
+  if (meta_block_name == kRangeFilterBlockName) {
+    return BlockType::kRangeFilter;
+  }
+
+  if (meta_block_name == kLevelFilterBlockName) {
+    return BlockType::kLevelFilter;
+  }
+
+  if (meta_block_name == kBlockTimestampIndexBlockName) {
+    return BlockType::kBlockTimestampIndex;
+  }
+
   if (meta_block_name.starts_with(kObsoleteFilterBlockPrefix)) {
     // Obsolete but possible in old files
     return BlockType::kInvalid;
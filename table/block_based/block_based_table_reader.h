@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -26,6 +28,8 @@
 #include "table/block_based/block_type.h"
 #include "table/block_based/cachable_entry.h"
 #include "table/block_based/filter_block.h"
+#include "table/block_based/range_filter.h"
+#include "table/level_filter.h"
 #include "table/block_based/uncompression_dict_reader.h"
 #include "table/format.h"
 #include "table/persistent_cache_options.h"
@@ -122,6 +126,18 @@ class BlockBasedTable : public TableReader {
                            BlockCacheLookupContext* lookup_context,
                            bool* filter_checked) const;
 
+  // Returns false if the range filter of the table shows that it has no key
+  // in [lower, upper] (user keys). Returns true if it may have some, or if
+  // the table has no range filter.
+  bool RangeMayMatch(const Slice& lower, const Slice& upper) const;
+
+  // Returns false if the block timestamp index of the table shows that the
+  // data block at `block_offset` has no version as old as
+  // ReadOptions::timestamp. Returns true otherwise, or if the table has no
+  // block timestamp index.
+  bool BlockTimestampMayMatch(const ReadOptions& read_options,
+                              uint64_t block_offset) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -142,6 +158,10 @@ class BlockBasedTable : public TableReader {
   FragmentedRangeTombstoneIterator* NewRangeTombstoneIterator(
       SequenceNumber read_seqno, const Slice* timestamp) override;
 
+  bool MaxCoveringTombstoneSeqnum(const ReadOptions& read_options,
+                                  const Slice& user_key,
+                                  SequenceNumber* seq) override;
+
   // @param skip_filters Disables loading/accessing the filter block
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context, const SliceTransform* prefix_extractor,
@@ -163,6 +183,14 @@ class BlockBasedTable : public TableReader {
   Status Prefetch(const ReadOptions& read_options, const Slice* begin,
                   const Slice* end) override;
 
+  // Asks the file system to read ahead the first data blocks, as much as
+  // the first readahead of an iterator over the table.
+  void PrefetchForScan(const ReadOptions& read_options) override;
+
+  // Reads the partitions of the index and of the filter into the block
+  // cache, with one read for each of them. A no-op without a block cache.
+  Status CacheDependencies(const ReadOptions& read_options) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file). The returned value is in terms of file
@@ -183,6 +211,10 @@ class BlockBasedTable : public TableReader {
   Status ApproximateKeyAnchors(const ReadOptions& read_options,
                                std::vector<Anchor>& anchors) override;
 
+  Status GetCachedKeyRanges(const ReadOptions& read_options,
+                            const Slice& smallest_user_key,
+                            std::vector<OwnedUserKeyRange>& ranges) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -198,6 +230,8 @@ class BlockBasedTable : public TableReader {
 
   std::shared_ptr<const TableProperties> GetTableProperties() const override;
 
+  std::shared_ptr<const LevelFilter> GetLevelFilter() const override;
+
   const SeqnoToTimeMapping& GetSeqnoToTimeMapping() const;
 
   size_t ApproximateMemoryUsage() const override;
@@ -495,6 +529,15 @@ class BlockBasedTable : public TableReader {
                            InternalIterator* meta_iter,
                            const InternalKeyComparator& internal_comparator,
                            BlockCacheLookupContext* lookup_context);
+  Status ReadRangeFilterBlock(const ReadOptions& ro,
+                              FilePrefetchBuffer* prefetch_buffer,
+                              InternalIterator* meta_iter);
+  Status ReadLevelFilterBlock(const ReadOptions& ro,
+                              FilePrefetchBuffer* prefetch_buffer,
+                              InternalIterator* meta_iter);
+  Status ReadBlockTimestampIndexBlock(const ReadOptions& ro,
+                                      FilePrefetchBuffer* prefetch_buffer,
+                                      InternalIterator* meta_iter);
   Status PrefetchIndexAndFilterBlocks(
       const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
       InternalIterator* meta_iter, BlockBasedTable* new_table,
@@ -619,6 +662,16 @@ struct BlockBasedTable::Rep {
 
   std::shared_ptr<FragmentedRangeTombstoneList> fragmented_range_dels;
 
+  // Held in memory while the table is open, if the table has one
+  std::unique_ptr<RangeFilter> range_filter;
+
+  // Handed to the versions, which keep it for as long as the file is live
+  std::shared_ptr<const LevelFilter> level_filter;
+
+  // The offset and smallest timestamp of each data block, in the order of
+  // the blocks, if the table has a block timestamp index. Empty otherwise.
+  BlockContents block_timestamp_index;
+
   // FIXME
   // If true, data blocks in this file are definitely ZSTD compressed. If false
   // they might not be. When false we skip creating a ZSTD digested
@@ -654,6 +707,9 @@ struct BlockBasedTable::Rep {
   bool index_has_first_key = false;
   bool index_key_includes_seq = true;
   bool index_value_is_full = true;
+  // Whether blocks referencing the mapped file are kept in the block cache,
+  // under cache keys unique to this reader
+  bool cache_mmap_read_blocks = false;
 
   // Whether block checksums in metadata blocks were verified on open.
   // This is only to mostly maintain current dubious behavior of VerifyChecksum
@@ -675,6 +731,33 @@ struct BlockBasedTable::Rep {
   std::unique_ptr<CacheReservationManager::CacheReservationHandle>
       table_reader_cache_res_handle = nullptr;
 
+  // Moving average of the bytes read by the runs of sequential data block
+  // reads of the iterators over this table, 0 until a run is recorded. Only
+  // maintained with table_options.learned_auto_readahead.
+  mutable std::atomic<uint64_t> scan_bytes_estimate{0};
+
+  // Adds a run of sequential data block reads to scan_bytes_estimate. Runs
+  // recorded concurrently may be lost, which only delays the estimate.
+  void RecordScanBytes(uint64_t bytes) const {
+    uint64_t estimate = scan_bytes_estimate.load(std::memory_order_relaxed);
+    estimate = estimate == 0 ? bytes : estimate - estimate / 8 + bytes / 8;
+    scan_bytes_estimate.store(estimate, std::memory_order_relaxed);
+  }
+
+  // The size the implicit auto-readahead of a new iterator starts at
+  size_t InitialAutoReadaheadSize() const {
+    const uint64_t estimate =
+        table_options.learned_auto_readahead
+            ? scan_bytes_estimate.load(std::memory_order_relaxed)
+            : 0;
+    if (estimate == 0) {
+      return table_options.initial_auto_readahead_size;
+    }
+    return static_cast<size_t>(
+        std::min(estimate, static_cast<uint64_t>(
+                               table_options.max_auto_readahead_size)));
+  }
+
   SequenceNumber get_global_seqno(BlockType block_type) const {
     return (block_type == BlockType::kFilterPartitionIndex ||
             block_type == BlockType::kCompressionDictionary)
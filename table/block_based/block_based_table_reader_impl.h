@@ -110,10 +110,11 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
   // 1. block cache handle is set to be released in cleanup function, or
   // 2. it's pointing to immortal source. If own_bytes is true then we are
   //    not reading data from the original source, whether immortal or not.
-  //    Otherwise, the block is pinned iff the source is immortal.
-  const bool block_contents_pinned =
-      block.IsCached() ||
-      (!block.GetValue()->own_bytes() && rep_->immortal_table);
+  //    Otherwise, the block is pinned iff the source is immortal, even when
+  //    cached (cache_mmap_read_blocks), as the mapping can go away first.
+  const bool own_bytes = block.GetValue()->own_bytes();
+  const bool block_contents_pinned = (block.IsCached() && own_bytes) ||
+                                     (!own_bytes && rep_->immortal_table);
   iter = InitBlockIterator<TBlockIter>(rep_, block.GetValue(), block_type, iter,
                                        block_contents_pinned);
 
@@ -170,10 +171,11 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(const ReadOptions& ro,
   // 1. block cache handle is set to be released in cleanup function, or
   // 2. it's pointing to immortal source. If own_bytes is true then we are
   //    not reading data from the original source, whether immortal or not.
-  //    Otherwise, the block is pinned iff the source is immortal.
-  const bool block_contents_pinned =
-      block.IsCached() ||
-      (!block.GetValue()->own_bytes() && rep_->immortal_table);
+  //    Otherwise, the block is pinned iff the source is immortal, even when
+  //    cached (cache_mmap_read_blocks), as the mapping can go away first.
+  const bool own_bytes = block.GetValue()->own_bytes();
+  const bool block_contents_pinned = (block.IsCached() && own_bytes) ||
+                                     (!own_bytes && rep_->immortal_table);
   iter = InitBlockIterator<TBlockIter>(rep_, block.GetValue(), BlockType::kData,
                                        iter, block_contents_pinned);
 
@@ -161,6 +161,38 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
     }
   }
 
+  // Verify the checksums of all the blocks read in full up front, together
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> checksum_idx_for_block;
+  std::array<Status, MultiGetContext::MAX_BATCH_SIZE> checksum_statuses;
+  size_t num_checksums = 0;
+  if (options.verify_checksums) {
+    std::array<const char*, MultiGetContext::MAX_BATCH_SIZE> block_data;
+    std::array<size_t, MultiGetContext::MAX_BATCH_SIZE> block_sizes;
+    std::array<uint64_t, MultiGetContext::MAX_BATCH_SIZE> block_offsets;
+    size_t block_idx = 0;
+    for (const BlockHandle& handle : *handles) {
+      if (handle.IsNull()) {
+        continue;
+      }
+      const FSReadRequest& req = read_reqs[req_idx_for_block[block_idx]];
+      const size_t req_offset = req_offset_for_block[block_idx];
+      block_idx++;
+      if (!req.status.ok() || req.result.size() != req.len ||
+          req_offset + BlockSizeWithTrailer(handle) > req.result.size()) {
+        checksum_idx_for_block.push_back(SIZE_MAX);
+        continue;
+      }
+      checksum_idx_for_block.push_back(num_checksums);
+      block_data[num_checksums] = req.result.data() + req_offset;
+      block_sizes[num_checksums] = handle.size();
+      block_offsets[num_checksums] = handle.offset();
+      num_checksums++;
+    }
+    VerifyBlockChecksums(footer, num_checksums, block_data.data(),
+                         block_sizes.data(), block_offsets.data(),
+                         rep_->file->file_name(), checksum_statuses.data());
+  }
+
   idx_in_batch = 0;
   size_t valid_batch_idx = 0;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
@@ -176,6 +208,9 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
     assert(req_idx_for_block[valid_batch_idx] < read_reqs.size());
     size_t& req_idx = req_idx_for_block[valid_batch_idx];
     size_t& req_offset = req_offset_for_block[valid_batch_idx];
+    const size_t checksum_idx = options.verify_checksums
+                                    ? checksum_idx_for_block[valid_batch_idx]
+                                    : SIZE_MAX;
     valid_batch_idx++;
     FSReadRequest& req = read_reqs[req_idx];
     Status s = req.status;
@@ -220,8 +255,9 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::RetrieveMultipleBlocks)
         // begin address of each read request, we need to add the offset
         // in each read request. Checksum is stored in the block trailer,
         // beyond the payload size.
-        s = VerifyBlockChecksum(footer, data, handle.size(),
-                                rep_->file->file_name(), handle.offset());
+        assert(checksum_idx < num_checksums);
+        assert(data == req.result.data() + req_offset);
+        s = checksum_statuses[checksum_idx];
         RecordTick(ioptions.stats, BLOCK_CHECKSUM_COMPUTE_COUNT);
         TEST_SYNC_POINT_CALLBACK("RetrieveMultipleBlocks:VerifyChecksum", &s);
         if (!s.ok() &&
@@ -629,6 +665,19 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
                 read_options, results[idx_in_batch].As<Block>(), &first_biter,
                 statuses[idx_in_batch]);
             reusing_prev_block = false;
+            if (first_biter.status().ok()) {
+              // The keys that reuse the block are probed together, so their
+              // restart intervals are in the cache when they are searched
+              size_t next_idx = idx_in_batch + 1;
+              auto next = miter;
+              for (++next; next != sst_file_range.end() &&
+                           next_idx < block_handles.size() &&
+                           block_handles[next_idx].IsNull() &&
+                           results[next_idx].GetValue() == nullptr;
+                   ++next, ++next_idx) {
+                first_biter.PrefetchForGet(next->ikey);
+              }
+            }
           } else {
             // If handle is null and result is empty, then the status is never
             // set, which should be the initial value: ok().
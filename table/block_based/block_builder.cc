@@ -24,7 +24,11 @@
 //     value_length: varint32
 //     key_delta: char[unshared_bytes]
 //     value: char[value_length]
-// shared_bytes == 0 for restart points.
+// shared_bytes == 0 for restart points, unless the block is built with
+// delta_encode_restart_keys (format_version >= 7). The key of a restart
+// point other than the first then drops the prefix shared with both the first
+// key of the block and the previous key, which is the same as the prefix it
+// shares with the first key when the keys are in bytewise order.
 //
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
@@ -48,12 +52,17 @@ BlockBuilder::BlockBuilder(
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
     double data_block_hash_table_util_ratio, size_t ts_sz,
-    bool persist_user_defined_timestamps, bool is_user_key)
+    bool persist_user_defined_timestamps, bool is_user_key,
+    bool delta_encode_restart_keys)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       strip_ts_sz_(persist_user_defined_timestamps ? 0 : ts_sz),
       is_user_key_(is_user_key),
+      // Not with stripped timestamps, which the readers pad back to the keys
+      // as they parse them
+      delta_encode_restart_keys_(delta_encode_restart_keys &&
+                                 use_delta_encoding && strip_ts_sz_ == 0),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
       finished_(false) {
@@ -79,6 +88,7 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  first_key_.clear();
   if (data_block_hash_index_builder_.Valid()) {
     data_block_hash_index_builder_.Reset();
   }
@@ -202,11 +212,17 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
           ? last_key
           : MaybeStripTimestampFromKey(&last_key_buf, last_key);
   size_t shared = 0;  // number of bytes shared with prev key
+  bool is_restart = false;
   if (counter_ >= block_restart_interval_) {
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_size));
     estimate_ += sizeof(uint32_t);
     counter_ = 0;
+    is_restart = true;
+    if (delta_encode_restart_keys_) {
+      shared = std::min(key_to_persist.difference_offset(first_key_),
+                        key_to_persist.difference_offset(last_key_persisted));
+    }
   } else if (use_delta_encoding_) {
     // See how much sharing to do with previous string
     shared = key_to_persist.difference_offset(last_key_persisted);
@@ -227,10 +243,11 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
 
   // Add string delta to buffer_ followed by value
   buffer_.append(key_to_persist.data() + shared, non_shared);
-  // Use value delta encoding only when the key has shared bytes. This would
-  // simplify the decoding, where it can figure which decoding to use simply by
-  // looking at the shared bytes size.
-  if (shared != 0 && use_value_delta_encoding_) {
+  // Use value delta encoding only when the key has shared bytes and is not a
+  // restart point. This would simplify the decoding, where it can figure
+  // which decoding to use simply by looking at the shared bytes size and the
+  // restart offsets.
+  if (shared != 0 && !is_restart && use_value_delta_encoding_) {
     buffer_.append(delta_value->data(), delta_value->size());
   } else {
     buffer_.append(value.data(), value.size());
@@ -246,6 +263,10 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
                                        restarts_.size() - 1);
   }
 
+  if (delta_encode_restart_keys_ && buffer_size == 0) {
+    first_key_.assign(key_to_persist.data(), key_to_persist.size());
+  }
+
   counter_++;
   estimate_ += buffer_.size() - buffer_size;
 }
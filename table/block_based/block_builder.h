@@ -31,7 +31,8 @@ class BlockBuilder {
                         double data_block_hash_table_util_ratio = 0.75,
                         size_t ts_sz = 0,
                         bool persist_user_defined_timestamps = true,
-                        bool is_user_key = false);
+                        bool is_user_key = false,
+                        bool delta_encode_restart_keys = false);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -112,6 +113,10 @@ class BlockBuilder {
   // index block for partitioned index blocks. In summary, this only applies to
   // block whose key are real user keys or internal keys created from user keys.
   const bool is_user_key_;
+  // Whether the keys of the restart points other than the first are delta
+  // encoded against the first key of the block (format_version >= 7). Only
+  // for blocks with sorted keys.
+  const bool delta_encode_restart_keys_;
 
   std::string buffer_;              // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
@@ -119,6 +124,8 @@ class BlockBuilder {
   int counter_;    // Number of entries emitted since restart
   bool finished_;  // Has Finish() been called?
   std::string last_key_;
+  // The first key of the block, if delta_encode_restart_keys_
+  std::string first_key_;
   DataBlockHashIndexBuilder data_block_hash_index_builder_;
 #ifndef NDEBUG
   bool add_with_last_key_called_ = false;
@@ -15,6 +15,9 @@ void BlockCreateContext::Create(std::unique_ptr<Block_kData>* parsed_out,
       std::move(block), table_options->read_amp_bytes_per_bit, statistics));
   parsed_out->get()->InitializeDataBlockProtectionInfo(protection_bytes_per_key,
                                                        raw_ucmp);
+  if (table_options->data_block_restart_key_prefixes) {
+    parsed_out->get()->InitializeDataBlockRestartKeyPrefixes(raw_ucmp);
+  }
 }
 void BlockCreateContext::Create(std::unique_ptr<Block_kIndex>* parsed_out,
                                 BlockContents&& block) {
@@ -23,6 +26,10 @@ void BlockCreateContext::Create(std::unique_ptr<Block_kIndex>* parsed_out,
   parsed_out->get()->InitializeIndexBlockProtectionInfo(
       protection_bytes_per_key, raw_ucmp, index_value_is_full,
       index_has_first_key);
+  if (table_options->index_block_restart_key_model) {
+    parsed_out->get()->InitializeIndexBlockRestartKeyModel(
+        raw_ucmp, index_value_is_full, index_key_includes_seq);
+  }
 }
 void BlockCreateContext::Create(
     std::unique_ptr<Block_kFilterPartitionIndex>* parsed_out,
@@ -75,6 +82,9 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetFullHelper(),
+        nullptr,  // kRangeFilter
+        nullptr,  // kLevelFilter
+        nullptr,  // kBlockTimestampIndex
         nullptr,  // kInvalid
     }};
 
@@ -92,6 +102,9 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetBasicHelper(),
+        nullptr,  // kRangeFilter
+        nullptr,  // kLevelFilter
+        nullptr,  // kBlockTimestampIndex
         nullptr,  // kInvalid
     }};
 }  // namespace
@@ -74,7 +74,8 @@ struct BlockCreateContext : public Cache::CreateContext {
                      bool _using_zstd, uint8_t _protection_bytes_per_key,
                      const Comparator* _raw_ucmp,
                      bool _index_value_is_full = false,
-                     bool _index_has_first_key = false)
+                     bool _index_has_first_key = false,
+                     bool _index_key_includes_seq = true)
       : table_options(_table_options),
         ioptions(_ioptions),
         statistics(_statistics),
@@ -82,7 +83,8 @@ struct BlockCreateContext : public Cache::CreateContext {
         using_zstd(_using_zstd),
         protection_bytes_per_key(_protection_bytes_per_key),
         index_value_is_full(_index_value_is_full),
-        index_has_first_key(_index_has_first_key) {}
+        index_has_first_key(_index_has_first_key),
+        index_key_includes_seq(_index_key_includes_seq) {}
 
   const BlockBasedTableOptions* table_options = nullptr;
   const ImmutableOptions* ioptions = nullptr;
@@ -94,6 +96,7 @@ struct BlockCreateContext : public Cache::CreateContext {
   uint8_t protection_bytes_per_key = 0;
   bool index_value_is_full;
   bool index_has_first_key;
+  bool index_key_includes_seq = true;
 
   // For TypedCacheInterface
   template <typename TBlocklike>
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <limits>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -353,6 +354,158 @@ class BlockReadAmpBitmapSlowAndAccurate {
   bool iter_valid_ = false;
 };
 
+TEST_F(BlockTest, RestartKeyPrefixes) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  // Groups of keys with the same first 8 bytes, and gaps between them
+  GenerateRandomKVs(&keys, &values, 0, 200, 2 /* step */,
+                    0 /* padding_size */, 3 /* keys_share_prefix */);
+  std::vector<std::string> targets;
+  for (int i = -1; i <= 201; i++) {
+    for (int j = 0; j <= 3; j++) {
+      targets.push_back(GenerateInternalKey(i, j, 0 /* padding_size */, &rnd));
+    }
+  }
+  std::string short_key = "  ";
+  AppendInternalKeyFooter(&short_key, 0 /* seqno */, kTypeValue);
+  targets.push_back(short_key);
+
+  // Few restart points are scanned, many are binary searched
+  for (int restart_interval : {1, 16}) {
+    BlockBuilder builder(restart_interval);
+    for (size_t i = 0; i < keys.size(); i++) {
+      builder.Add(keys[i], values[i]);
+    }
+    Slice rawblock = builder.Finish();
+    Block plain{BlockContents(rawblock)};
+    Block with_prefixes{BlockContents(rawblock)};
+    with_prefixes.InitializeDataBlockRestartKeyPrefixes(BytewiseComparator());
+    ASSERT_EQ(plain.TEST_GetRestartKeyPrefixes(), nullptr);
+    ASSERT_NE(with_prefixes.TEST_GetRestartKeyPrefixes(), nullptr);
+    ASSERT_GT(with_prefixes.ApproximateMemoryUsage(),
+              plain.ApproximateMemoryUsage());
+
+    std::unique_ptr<DataBlockIter> expected(plain.NewDataIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber));
+    std::unique_ptr<DataBlockIter> iter(with_prefixes.NewDataIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber));
+    for (const auto& target : targets) {
+      expected->Seek(target);
+      iter->Seek(target);
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(iter->Valid(), expected->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(iter->key(), expected->key());
+        ASSERT_EQ(iter->value(), expected->value());
+      }
+    }
+  }
+
+  // Other comparators don't get any
+  BlockBuilder builder(16);
+  builder.Add(keys[0], values[0]);
+  Block block{BlockContents(builder.Finish())};
+  block.InitializeDataBlockRestartKeyPrefixes(ReverseBytewiseComparator());
+  ASSERT_EQ(block.TEST_GetRestartKeyPrefixes(), nullptr);
+}
+
+TEST_F(BlockTest, DeltaEncodedRestartKeys) {
+  Random rnd(301);
+  // Keys sharing a long prefix, like the tenant and table of a key
+  const std::string kPrefix(40, 't');
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  GenerateRandomKVs(&keys, &values, 0, 200);
+  std::vector<std::string> targets;
+  for (auto& key : keys) {
+    key.insert(0, kPrefix);
+    targets.push_back(key);
+  }
+  for (int i = -1; i <= 200; i++) {
+    targets.push_back(
+        kPrefix + GenerateInternalKey(i, 1, 0 /* padding_size */, &rnd));
+  }
+
+  for (int restart_interval : {1, 16}) {
+    for (auto index_type : {BlockBasedTableOptions::kDataBlockBinarySearch,
+                            BlockBasedTableOptions::kDataBlockBinaryAndHash}) {
+      BlockBuilder plain_builder(restart_interval,
+                                 true /* use_delta_encoding */,
+                                 false /* use_value_delta_encoding */,
+                                 index_type);
+      BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                           false /* use_value_delta_encoding */, index_type,
+                           0.75 /* data_block_hash_table_util_ratio */,
+                           0 /* ts_sz */, true /* persist_udt */,
+                           false /* is_user_key */,
+                           true /* delta_encode_restart_keys */);
+      for (size_t i = 0; i < keys.size(); i++) {
+        plain_builder.Add(keys[i], values[i]);
+        builder.Add(keys[i], values[i]);
+      }
+      Block plain{BlockContents(plain_builder.Finish())};
+      Block block{BlockContents(builder.Finish())};
+      ASSERT_EQ(block.NumRestarts(), plain.NumRestarts());
+      ASSERT_EQ(block.IndexType(), index_type);
+      // The prefix is stored once per block instead of once per restart point
+      ASSERT_LE(block.size() + (block.NumRestarts() - 1) * kPrefix.size(),
+                plain.size());
+
+      plain.InitializeDataBlockRestartKeyPrefixes(BytewiseComparator());
+      block.InitializeDataBlockRestartKeyPrefixes(BytewiseComparator());
+      ASSERT_NE(block.TEST_GetRestartKeyPrefixes(), nullptr);
+      for (uint32_t i = 0; i < block.NumRestarts(); i++) {
+        ASSERT_EQ(block.TEST_GetRestartKeyPrefixes()[i],
+                  plain.TEST_GetRestartKeyPrefixes()[i]);
+      }
+
+      std::unique_ptr<DataBlockIter> expected(plain.NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber));
+      std::unique_ptr<DataBlockIter> iter(block.NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber));
+      size_t count = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(iter->key(), keys[count]);
+        ASSERT_EQ(iter->value(), values[count]);
+        count++;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(count, keys.size());
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        count--;
+        ASSERT_EQ(iter->key(), keys[count]);
+        ASSERT_EQ(iter->value(), values[count]);
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(count, 0U);
+
+      for (const auto& target : targets) {
+        expected->Seek(target);
+        iter->Seek(target);
+        ASSERT_OK(iter->status());
+        ASSERT_EQ(iter->Valid(), expected->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(iter->key(), expected->key());
+          ASSERT_EQ(iter->value(), expected->value());
+          // Also from a restart point reached backwards
+          iter->Prev();
+          expected->Prev();
+          ASSERT_EQ(iter->Valid(), expected->Valid());
+          if (iter->Valid()) {
+            ASSERT_EQ(iter->key(), expected->key());
+          }
+        }
+        ASSERT_EQ(iter->SeekForGet(target), expected->SeekForGet(target));
+        ASSERT_EQ(iter->Valid(), expected->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(iter->key(), expected->key());
+        }
+      }
+    }
+  }
+}
+
 TEST_F(BlockTest, BlockReadAmpBitmap) {
   uint32_t pin_offset = 0;
   SyncPoint::GetInstance()->SetCallBack(
@@ -748,6 +901,213 @@ TEST_P(IndexBlockTest, IndexValueEncodingTest) {
   delete iter;
 }
 
+TEST_P(IndexBlockTest, RestartKeyModel) {
+  if (isUDTEnabled()) {
+    // Only the bytewise comparator gets a model
+    return;
+  }
+  std::vector<std::string> separators;
+  std::vector<BlockHandle> block_handles;
+  std::vector<std::string> first_keys;
+  const int kNumRecords = 300;
+  GenerateRandomIndexEntries(&separators, &block_handles, &first_keys,
+                             kNumRecords);
+  // Evenly spread fixed-width ids
+  std::vector<std::string> ids;
+  for (uint64_t i = 0; i < kNumRecords; i++) {
+    std::string id(8, '\0');
+    for (int j = 0; j < 8; j++) {
+      id[j] = static_cast<char>(((i * 1000003) >> (8 * (7 - j))) & 0xff);
+    }
+    AppendInternalKeyFooter(&id, 0 /* seqno */, kTypeValue);
+    ids.push_back(std::move(id));
+  }
+
+  for (const auto *keys : {&separators, &ids}) {
+    std::vector<std::string> targets;
+    for (const auto &key : *keys) {
+      const Slice user_key = ExtractUserKey(key);
+      for (SequenceNumber seqno : {SequenceNumber{0}, kMaxSequenceNumber}) {
+        targets.push_back(key);
+        std::string target = user_key.ToString();
+        AppendInternalKeyFooter(&target, seqno, kTypeValue);
+        targets.push_back(target);
+        // Between the keys
+        target = user_key.ToString() + "0";
+        AppendInternalKeyFooter(&target, seqno, kTypeValue);
+        targets.push_back(target);
+      }
+    }
+    for (const std::string &user_key : {std::string(), std::string(" "),
+                                        std::string(9, '\xff')}) {
+      std::string target = user_key;
+      AppendInternalKeyFooter(&target, 0 /* seqno */, kTypeValue);
+      targets.push_back(target);
+    }
+
+    for (int restart_interval : {1, 4}) {
+      BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                           useValueDeltaEncoding(),
+                           BlockBasedTableOptions::kDataBlockBinarySearch,
+                           0.75 /* data_block_hash_table_util_ratio */,
+                           0 /* ts_sz */, true /* persist_user_defined_ts */,
+                           !keyIncludesSeq());
+      BlockHandle last_encoded_handle;
+      for (size_t i = 0; i < keys->size(); i++) {
+        IndexValue entry(block_handles[i], first_keys[i]);
+        std::string encoded_entry;
+        std::string delta_encoded_entry;
+        entry.EncodeTo(&encoded_entry, includeFirstKey(), nullptr);
+        if (useValueDeltaEncoding() && i > 0) {
+          entry.EncodeTo(&delta_encoded_entry, includeFirstKey(),
+                         &last_encoded_handle);
+        }
+        last_encoded_handle = entry.handle;
+        const Slice delta_encoded_entry_slice(delta_encoded_entry);
+        builder.Add(keyIncludesSeq() ? Slice((*keys)[i])
+                                     : ExtractUserKey((*keys)[i]),
+                    encoded_entry, &delta_encoded_entry_slice);
+      }
+      Slice rawblock = builder.Finish();
+      Block plain{BlockContents(rawblock)};
+      Block with_model{BlockContents(rawblock)};
+      with_model.InitializeIndexBlockRestartKeyModel(
+          BytewiseComparator(), !useValueDeltaEncoding(), keyIncludesSeq());
+      ASSERT_EQ(plain.TEST_GetRestartKeyModel(), nullptr);
+      ASSERT_NE(with_model.TEST_GetRestartKeyModel(), nullptr);
+      ASSERT_GT(with_model.ApproximateMemoryUsage(),
+                plain.ApproximateMemoryUsage());
+      if (keys == &ids) {
+        ASSERT_EQ(with_model.TEST_GetRestartKeyModel()->NumSegments(), 1u);
+      }
+
+      std::unique_ptr<IndexBlockIter> expected(plain.NewIndexIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr,
+          nullptr /* Statistics */, true /* total_order_seek */,
+          includeFirstKey(), keyIncludesSeq(), !useValueDeltaEncoding()));
+      std::unique_ptr<IndexBlockIter> iter(with_model.NewIndexIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr,
+          nullptr /* Statistics */, true /* total_order_seek */,
+          includeFirstKey(), keyIncludesSeq(), !useValueDeltaEncoding()));
+      for (const auto &target : targets) {
+        expected->Seek(target);
+        iter->Seek(target);
+        ASSERT_OK(iter->status());
+        ASSERT_EQ(iter->Valid(), expected->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(iter->key(), expected->key());
+          ASSERT_EQ(iter->value().handle.offset(),
+                    expected->value().handle.offset());
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BlockTest, DeltaEncodedIndexRestartKeys) {
+  const std::string kPrefix(40, 't');
+  std::vector<std::string> separators;
+  std::vector<BlockHandle> block_handles;
+  std::vector<std::string> first_keys;
+  const int kNumRecords = 100;
+  GenerateRandomIndexEntries(&separators, &block_handles, &first_keys,
+                             kNumRecords);
+  for (auto& separator : separators) {
+    separator.insert(0, kPrefix);
+  }
+
+  // The values of the restart points are not delta encoded, even though their
+  // keys share bytes
+  for (int restart_interval : {1, 3}) {
+    BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                         true /* use_value_delta_encoding */,
+                         BlockBasedTableOptions::kDataBlockBinarySearch,
+                         0.75 /* data_block_hash_table_util_ratio */,
+                         0 /* ts_sz */, true /* persist_udt */,
+                         true /* is_user_key */,
+                         true /* delta_encode_restart_keys */);
+    BlockHandle last_encoded_handle;
+    for (int i = 0; i < kNumRecords; i++) {
+      IndexValue entry(block_handles[i], Slice());
+      std::string encoded_entry;
+      std::string delta_encoded_entry;
+      entry.EncodeTo(&encoded_entry, false /* have_first_key */, nullptr);
+      if (i > 0) {
+        entry.EncodeTo(&delta_encoded_entry, false /* have_first_key */,
+                       &last_encoded_handle);
+      }
+      last_encoded_handle = entry.handle;
+      const Slice delta_encoded_entry_slice(delta_encoded_entry);
+      builder.Add(separators[i], encoded_entry, &delta_encoded_entry_slice);
+    }
+    Block reader{BlockContents(builder.Finish())};
+
+    std::unique_ptr<IndexBlockIter> iter(reader.NewIndexIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr /* iter */,
+        nullptr /* stats */, true /* total_order_seek */,
+        false /* have_first_key */, false /* key_includes_seq */,
+        false /* value_is_full */));
+    int index = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(iter->key(), separators[index]);
+      ASSERT_EQ(iter->value().handle.offset(), block_handles[index].offset());
+      ASSERT_EQ(iter->value().handle.size(), block_handles[index].size());
+      index++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(index, kNumRecords);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      index--;
+      ASSERT_EQ(iter->key(), separators[index]);
+      ASSERT_EQ(iter->value().handle.offset(), block_handles[index].offset());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(index, 0);
+    for (index = 0; index < kNumRecords; index++) {
+      iter->Seek(separators[index]);
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key(), separators[index]);
+      ASSERT_EQ(iter->value().handle.offset(), block_handles[index].offset());
+      ASSERT_EQ(iter->value().handle.size(), block_handles[index].size());
+    }
+  }
+}
+
+TEST_F(BlockTest, RestartKeyModelCount) {
+  Random rnd(301);
+  // Runs of equal prefixes longer than the max error, gaps and steps
+  std::vector<uint64_t> prefixes;
+  uint64_t prefix = 1000;
+  for (int i = 0; i < 2000; i++) {
+    if (rnd.OneIn(8)) {
+      prefix += rnd.Uniform(4) == 0 ? (uint64_t{1} << 40) : rnd.Uniform(1000);
+    }
+    prefixes.push_back(prefix);
+  }
+  prefixes.push_back(std::numeric_limits<uint64_t>::max());
+  const uint32_t num = static_cast<uint32_t>(prefixes.size());
+
+  for (uint32_t max_error : {0u, 1u, 8u, 64u}) {
+    RestartKeyModel model;
+    model.Build(prefixes.data(), num, max_error);
+    ASSERT_FALSE(model.Empty());
+    std::vector<uint64_t> targets{0, std::numeric_limits<uint64_t>::max()};
+    for (auto p : prefixes) {
+      targets.push_back(p - 1);
+      targets.push_back(p);
+      targets.push_back(p + 1);
+    }
+    for (auto target : targets) {
+      auto range = std::equal_range(prefixes.begin(), prefixes.end(), target);
+      uint32_t num_less = 0, num_not_greater = 0;
+      model.Count(target, &num_less, &num_not_greater);
+      ASSERT_EQ(num_less, range.first - prefixes.begin());
+      ASSERT_EQ(num_not_greater, range.second - prefixes.begin());
+    }
+  }
+}
+
 // Param 0: key includes sequence number (whether to use user key or internal
 // key as key entry in index block).
 // Param 1: use value delta encoding
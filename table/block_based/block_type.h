@@ -27,6 +27,9 @@ enum class BlockType : uint8_t {
   kHashIndexMetadata,
   kMetaIndex,
   kIndex,
+  kRangeFilter,
+  kLevelFilter,
+  kBlockTimestampIndex,
   // Note: keep kInvalid the last value when adding new enum values.
   kInvalid
 };
@@ -529,6 +529,63 @@ TEST(DataBlockHashIndex, BlockTestLarge) {
   }
 }
 
+TEST(DataBlockHashIndex, BlockTestSeek) {
+  Random rnd(1019);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  int num_records = 300;
+  GenerateRandomKVs(&keys, &values, 0, num_records);
+
+  // Some user keys have several versions, some of them spanning restart
+  // intervals
+  std::vector<std::unique_ptr<Block>> readers;
+  for (auto index_type : {BlockBasedTableOptions::kDataBlockBinarySearch,
+                          BlockBasedTableOptions::kDataBlockBinaryAndHash}) {
+    BlockBuilder builder(4 /* block_restart_interval */,
+                         true /* use_delta_encoding */,
+                         false /* use_value_delta_encoding */, index_type);
+    for (int i = 0; i < num_records; i++) {
+      std::string ukey(keys[i] + "1" /* existing key marker */);
+      for (int seq = 1 + i % 3; seq > 0; seq--) {
+        InternalKey ikey(ukey, seq * 10, kTypeValue);
+        builder.Add(ikey.Encode().ToString(), values[i]);
+      }
+    }
+    // A copy, the builder owns its block
+    Slice rawblock = builder.Finish();
+    CacheAllocationPtr data(new char[rawblock.size()]);
+    memcpy(data.get(), rawblock.data(), rawblock.size());
+    readers.emplace_back(
+        new Block(BlockContents(std::move(data), rawblock.size())));
+  }
+  const InternalKeyComparator icmp(BytewiseComparator());
+
+  // Seek finds the same keys through the hash index as by binary search
+  for (int i = 0; i < 2 * num_records; i++) {
+    int index = rnd.Uniform(num_records);
+    std::string ukey(keys[index] + (i % 2 ? "1" : "0"));
+    InternalKey ikey(ukey, rnd.Uniform(40), kTypeValue);
+    std::unique_ptr<DataBlockIter> binary_iter(readers[0]->NewDataIterator(
+        icmp.user_comparator(), kDisableGlobalSequenceNumber));
+    std::unique_ptr<DataBlockIter> hash_iter(readers[1]->NewDataIterator(
+        icmp.user_comparator(), kDisableGlobalSequenceNumber));
+    binary_iter->Seek(ikey.Encode());
+    hash_iter->Seek(ikey.Encode());
+    ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid());
+    if (binary_iter->Valid()) {
+      ASSERT_EQ(binary_iter->key(), hash_iter->key());
+      ASSERT_EQ(binary_iter->value(), hash_iter->value());
+      // Iterates on from there
+      hash_iter->Next();
+      binary_iter->Next();
+      ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid());
+      if (binary_iter->Valid()) {
+        ASSERT_EQ(binary_iter->key(), hash_iter->key());
+      }
+    }
+  }
+}
+
 // helper routine for DataBlockHashIndex.BlockBoundary
 void TestBoundary(InternalKey& ik1, std::string& v1, InternalKey& ik2,
                   std::string& v2, InternalKey& seek_ikey,
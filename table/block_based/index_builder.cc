@@ -128,13 +128,15 @@ PartitionedIndexBuilder::PartitionedIndexBuilder(
           use_value_delta_encoding,
           BlockBasedTableOptions::kDataBlockBinarySearch /* index_type */,
           0.75 /* data_block_hash_table_util_ratio */, ts_sz,
-          persist_user_defined_timestamps, false /* is_user_key */),
+          persist_user_defined_timestamps, false /* is_user_key */,
+          FormatVersionDeltaEncodesRestartKeys(table_opt.format_version)),
       index_block_builder_without_seq_(
           table_opt.index_block_restart_interval, true /*use_delta_encoding*/,
           use_value_delta_encoding,
           BlockBasedTableOptions::kDataBlockBinarySearch /* index_type */,
           0.75 /* data_block_hash_table_util_ratio */, ts_sz,
-          persist_user_defined_timestamps, true /* is_user_key */),
+          persist_user_defined_timestamps, true /* is_user_key */,
+          FormatVersionDeltaEncodesRestartKeys(table_opt.format_version)),
       sub_index_builder_(nullptr),
       table_opt_(table_opt),
       // We start by false. After each partition we revise the value based on
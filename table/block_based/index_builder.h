@@ -161,13 +161,15 @@ class ShortenedIndexBuilder : public IndexBuilder {
             use_value_delta_encoding,
             BlockBasedTableOptions::kDataBlockBinarySearch /* index_type */,
             0.75 /* data_block_hash_table_util_ratio */, ts_sz,
-            persist_user_defined_timestamps, false /* is_user_key */),
+            persist_user_defined_timestamps, false /* is_user_key */,
+            FormatVersionDeltaEncodesRestartKeys(format_version)),
         index_block_builder_without_seq_(
             index_block_restart_interval, true /*use_delta_encoding*/,
             use_value_delta_encoding,
             BlockBasedTableOptions::kDataBlockBinarySearch /* index_type */,
             0.75 /* data_block_hash_table_util_ratio */, ts_sz,
-            persist_user_defined_timestamps, true /* is_user_key */),
+            persist_user_defined_timestamps, true /* is_user_key */,
+            FormatVersionDeltaEncodesRestartKeys(format_version)),
         use_value_delta_encoding_(use_value_delta_encoding),
         include_first_key_(include_first_key),
         shortening_mode_(shortening_mode) {
@@ -0,0 +1,269 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "util/bloom_impl.h"
+#include "util/coding.h"
+#include "util/hash.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Block format:
+//   min value: fixed64
+//   max value: fixed64
+//   dropped trailing bits: uint8
+//   number of levels: uint8
+//   number of Bloom probes: uint8
+//   key prefix: varint32 length + bytes
+//   Bloom filter: the rest, a multiple of 64 bytes (FastLocalBloomImpl)
+namespace {
+constexpr size_t kFixedHeaderSize = 2 * sizeof(uint64_t) + 3;
+constexpr size_t kBloomLineBytes = 64;
+
+uint64_t EntryHash(int level, uint64_t entry) {
+  char buf[sizeof(uint64_t)];
+  EncodeFixed64(buf, entry);
+  return Hash64(buf, sizeof(buf), static_cast<uint64_t>(level));
+}
+
+// Calls fn with each distinct entry of `level` of the sorted values
+template <typename Fn>
+void ForEachEntry(const std::vector<uint64_t>& values, int shift, int level,
+                  const Fn& fn) {
+  const int entry_shift = shift + level * RangeFilter::kLevelBits;
+  bool first = true;
+  uint64_t prev = 0;
+  for (uint64_t value : values) {
+    const uint64_t entry = value >> entry_shift;
+    if (first || entry != prev) {
+      fn(entry);
+      prev = entry;
+      first = false;
+    }
+  }
+}
+}  // namespace
+
+RangeFilterBuilder::RangeFilterBuilder(double bits_per_key)
+    : bits_per_key_(bits_per_key) {
+  assert(bits_per_key > 0);
+}
+
+void RangeFilterBuilder::Add(const Slice& user_key) {
+  if (values_.empty()) {
+    first_key_.assign(user_key.data(), user_key.size());
+    prefix_len_ = first_key_.size();
+    values_.push_back(0);
+    return;
+  }
+  const size_t common =
+      std::min(prefix_len_, user_key.difference_offset(first_key_));
+  if (common < prefix_len_) {
+    // The keys so far share the first prefix_len_ bytes of first_key_, so
+    // their integers for the shorter prefix start with the bytes of
+    // first_key_ in between
+    const uint64_t first_value =
+        RangeFilter::KeyToValue(first_key_, Slice(first_key_.data(), common));
+    const size_t moved_bytes = prefix_len_ - common;
+    if (moved_bytes >= sizeof(uint64_t)) {
+      values_.assign(1, first_value);
+    } else {
+      const int moved_bits = static_cast<int>(moved_bytes * 8);
+      const uint64_t high_mask = ~uint64_t{0} << (64 - moved_bits);
+      for (uint64_t& value : values_) {
+        value = (first_value & high_mask) | (value >> moved_bits);
+      }
+      values_.erase(std::unique(values_.begin(), values_.end()),
+                    values_.end());
+    }
+    prefix_len_ = common;
+  }
+  const uint64_t value =
+      RangeFilter::KeyToValue(user_key, Slice(first_key_.data(), prefix_len_));
+  assert(value >= values_.back());
+  if (value != values_.back()) {
+    values_.push_back(value);
+  }
+}
+
+void RangeFilterBuilder::Finish(std::string* contents) {
+  assert(!values_.empty());
+  uint64_t all_bits = 0;
+  for (uint64_t value : values_) {
+    all_bits |= value;
+  }
+  const int shift = all_bits == 0 ? 0 : CountTrailingZeroBits(all_bits);
+  // The values are sorted, so they all agree above the highest bit where
+  // the first and the last differ
+  const uint64_t diff = (values_.front() ^ values_.back()) >> shift;
+  int num_levels = 1;
+  if (diff != 0) {
+    const int span_bits = FloorLog2(diff) + 1;
+    num_levels = std::min(
+        RangeFilter::kMaxLevels,
+        (span_bits + RangeFilter::kLevelBits - 1) / RangeFilter::kLevelBits);
+  }
+
+  size_t num_entries = 0;
+  for (int level = 0; level < num_levels; level++) {
+    ForEachEntry(values_, shift, level, [&](uint64_t) { num_entries++; });
+  }
+  const double millibits_per_key = bits_per_key_ * 1000;
+  size_t bloom_bytes =
+      static_cast<size_t>(num_entries * bits_per_key_ / 8) + kBloomLineBytes;
+  bloom_bytes -= bloom_bytes % kBloomLineBytes;
+  const int num_probes = FastLocalBloomImpl::ChooseNumProbes(
+      static_cast<int>(std::min(millibits_per_key, 100000.0)));
+
+  contents->clear();
+  PutFixed64(contents, values_.front());
+  PutFixed64(contents, values_.back());
+  contents->push_back(static_cast<char>(shift));
+  contents->push_back(static_cast<char>(num_levels));
+  contents->push_back(static_cast<char>(num_probes));
+  PutLengthPrefixedSlice(contents, Slice(first_key_.data(), prefix_len_));
+  const size_t bloom_offset = contents->size();
+  contents->resize(bloom_offset + bloom_bytes);
+  char* const bloom = &(*contents)[bloom_offset];
+  for (int level = 0; level < num_levels; level++) {
+    ForEachEntry(values_, shift, level, [&](uint64_t entry) {
+      const uint64_t h = EntryHash(level, entry);
+      FastLocalBloomImpl::AddHash(Lower32of64(h), Upper32of64(h),
+                                  static_cast<uint32_t>(bloom_bytes),
+                                  num_probes, bloom);
+    });
+  }
+}
+
+Status RangeFilter::Create(BlockContents&& contents,
+                           std::unique_ptr<RangeFilter>* filter) {
+  std::unique_ptr<RangeFilter> result(new RangeFilter());
+  result->contents_ = std::move(contents);
+  Slice input = result->contents_.data;
+  if (input.size() < kFixedHeaderSize) {
+    return Status::Corruption("Range filter block too short");
+  }
+  result->min_value_ = DecodeFixed64(input.data());
+  result->max_value_ = DecodeFixed64(input.data() + sizeof(uint64_t));
+  result->shift_ = static_cast<uint8_t>(input[2 * sizeof(uint64_t)]);
+  result->num_levels_ = static_cast<uint8_t>(input[2 * sizeof(uint64_t) + 1]);
+  result->num_probes_ = static_cast<uint8_t>(input[2 * sizeof(uint64_t) + 2]);
+  input.remove_prefix(kFixedHeaderSize);
+  if (!GetLengthPrefixedSlice(&input, &result->prefix_)) {
+    return Status::Corruption("Bad range filter key prefix");
+  }
+  if (result->min_value_ > result->max_value_ || result->shift_ >= 64 ||
+      result->num_levels_ < 1 || result->num_levels_ > kMaxLevels ||
+      result->shift_ + (result->num_levels_ - 1) * kLevelBits >= 64 ||
+      result->num_probes_ < 1 || input.empty() ||
+      input.size() % kBloomLineBytes != 0 || input.size() > UINT32_MAX) {
+    return Status::Corruption("Bad range filter parameters");
+  }
+  result->bloom_ = input;
+  *filter = std::move(result);
+  return Status::OK();
+}
+
+int RangeFilter::ComparePrefix(const Slice& user_key, const Slice& prefix) {
+  const size_t n = std::min(user_key.size(), prefix.size());
+  const int cmp = n == 0 ? 0 : memcmp(user_key.data(), prefix.data(), n);
+  if (cmp < 0 || (cmp == 0 && user_key.size() < prefix.size())) {
+    return -1;
+  }
+  return cmp > 0 ? 1 : 0;
+}
+
+uint64_t RangeFilter::KeyToValue(const Slice& user_key, const Slice& prefix) {
+  const int cmp = ComparePrefix(user_key, prefix);
+  if (cmp != 0) {
+    return cmp < 0 ? 0 : UINT64_MAX;
+  }
+  uint64_t value = 0;
+  for (size_t i = prefix.size(); i < prefix.size() + sizeof(uint64_t); i++) {
+    value <<= 8;
+    if (i < user_key.size()) {
+      value |= static_cast<uint8_t>(user_key[i]);
+    }
+  }
+  return value;
+}
+
+bool RangeFilter::ProbeMayMatch(int level, uint64_t entry) const {
+  const uint64_t h = EntryHash(level, entry);
+  return FastLocalBloomImpl::HashMayMatch(
+      Lower32of64(h), Upper32of64(h), static_cast<uint32_t>(bloom_.size()),
+      num_probes_, bloom_.data());
+}
+
+bool RangeFilter::LevelMayMatch(int level, uint64_t first, uint64_t last,
+                                uint64_t lo, uint64_t hi,
+                                int* probes_left) const {
+  for (uint64_t entry = first;; entry++) {
+    if (*probes_left <= 0) {
+      return true;
+    }
+    --*probes_left;
+    if (ProbeMayMatch(level, entry)) {
+      if (level == 0) {
+        return true;
+      }
+      const int child_shift = (level - 1) * kLevelBits;
+      const uint64_t first_child = entry << kLevelBits;
+      const uint64_t last_child = first_child | ((1 << kLevelBits) - 1);
+      if (LevelMayMatch(level - 1, std::max(first_child, lo >> child_shift),
+                        std::min(last_child, hi >> child_shift), lo, hi,
+                        probes_left)) {
+        return true;
+      }
+    }
+    if (entry == last) {
+      return false;
+    }
+  }
+}
+
+bool RangeFilter::RangeMayExist(const Slice& lower, const Slice& upper) const {
+  if (ComparePrefix(upper, prefix_) < 0 || ComparePrefix(lower, prefix_) > 0) {
+    // The range is below or above all the keys with the prefix
+    return false;
+  }
+  uint64_t lo = std::max(KeyToValue(lower, prefix_), min_value_);
+  uint64_t hi = std::min(KeyToValue(upper, prefix_), max_value_);
+  if (lo > hi) {
+    return false;
+  }
+  // The dropped bits are 0 in the values of the keys
+  const uint64_t dropped_mask = (uint64_t{1} << shift_) - 1;
+  lo = (lo >> shift_) + ((lo & dropped_mask) != 0 ? 1 : 0);
+  hi >>= shift_;
+  if (lo > hi) {
+    return false;
+  }
+  // Start from the lowest level where the range takes at most two entries
+  int level = 0;
+  while (level + 1 < num_levels_ &&
+         (hi >> (level * kLevelBits)) - (lo >> (level * kLevelBits)) > 1) {
+    level++;
+  }
+  const uint64_t first = lo >> (level * kLevelBits);
+  const uint64_t last = hi >> (level * kLevelBits);
+  if (last - first >= static_cast<uint64_t>(kMaxProbes)) {
+    return true;
+  }
+  int probes_left = kMaxProbes;
+  return LevelMayMatch(level, first, last, lo, hi, &probes_left);
+}
+
+size_t RangeFilter::ApproximateMemoryUsage() const {
+  return sizeof(*this) + contents_.ApproximateMemoryUsage();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
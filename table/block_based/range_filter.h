@@ -0,0 +1,105 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A range filter answers whether a table file may have a key in a range of
+// user keys, so that a short range scan can skip a file without reading its
+// data blocks (see BlockBasedTableOptions::range_filter_bits_per_key). It
+// assumes the bytewise order of the user keys.
+//
+// Keys. All the keys of a file share the prefix of its first and last keys.
+// Each key is mapped to the 8 bytes that follow this prefix, as a
+// big-endian integer, zero-padded if the key is shorter. The map keeps the
+// order of the keys (keys that differ only further on map to the same
+// integer), and keys without the prefix map to 0 or UINT64_MAX, so a range
+// of keys maps to the range of integers between the images of its bounds.
+// The trailing zero bits common to all integers of the file are dropped.
+//
+// Filter. Like Rosetta, the filter stores the integers at several
+// resolutions in a Bloom filter: at level j, the integer shifted right by
+// 4 * j bits, for j = 0 up to the level where all the integers agree (at most
+// kMaxLevels). A range is checked from the lowest level it covers with at
+// most two entries, going down to the 16 entries below each entry found, up
+// to the range of the lowest level. Only the entries found at level 0 make
+// the range "may exist", while a range with no entry at some level is known
+// to have no keys. Each Bloom probe has the false positive rate of
+// range_filter_bits_per_key, and a range whose check needs more than
+// kMaxProbes probes is assumed to have keys.
+class RangeFilterBuilder {
+ public:
+  explicit RangeFilterBuilder(double bits_per_key);
+
+  // REQUIRES: the keys are added in increasing bytewise order
+  void Add(const Slice& user_key);
+
+  bool IsEmpty() const { return values_.empty(); }
+
+  // Returns the contents of the range filter block in *contents
+  void Finish(std::string* contents);
+
+ private:
+  const double bits_per_key_;
+  std::string first_key_;
+  // The length of the common prefix of the keys so far
+  size_t prefix_len_ = 0;
+  // The distinct integers of the keys so far, in increasing order
+  std::vector<uint64_t> values_;
+};
+
+class RangeFilter {
+ public:
+  static constexpr int kLevelBits = 4;
+  static constexpr int kMaxLevels = 8;
+  static constexpr int kMaxProbes = 64;
+
+  // Takes the contents of a range filter block
+  static Status Create(BlockContents&& contents,
+                       std::unique_ptr<RangeFilter>* filter);
+
+  // Returns false only if the file has no key k with lower <= k <= upper
+  bool RangeMayExist(const Slice& lower, const Slice& upper) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+  // The integer that the user key maps to for `prefix`
+  static uint64_t KeyToValue(const Slice& user_key, const Slice& prefix);
+
+  // Returns -1, 0 or 1 if the user key is less than, starts with, or is
+  // greater than the keys that start with `prefix`
+  static int ComparePrefix(const Slice& user_key, const Slice& prefix);
+
+ private:
+  RangeFilter() = default;
+
+  bool ProbeMayMatch(int level, uint64_t entry) const;
+  // Checks the entries of `level` from first to last, with the integers
+  // limited to [lo, hi] (without the dropped bits)
+  bool LevelMayMatch(int level, uint64_t first, uint64_t last, uint64_t lo,
+                     uint64_t hi, int* probes_left) const;
+
+  BlockContents contents_;
+  Slice prefix_;
+  uint64_t min_value_ = 0;
+  uint64_t max_value_ = 0;
+  int shift_ = 0;
+  int num_levels_ = 0;
+  int num_probes_ = 0;
+  Slice bloom_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
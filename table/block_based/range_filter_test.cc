@@ -0,0 +1,182 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class RangeFilterTest : public testing::Test {
+ protected:
+  void Build(std::vector<std::string> keys, double bits_per_key = 10) {
+    std::sort(keys.begin(), keys.end());
+    keys_ = keys;
+    RangeFilterBuilder builder(bits_per_key);
+    ASSERT_TRUE(builder.IsEmpty());
+    for (const auto& key : keys_) {
+      builder.Add(key);
+    }
+    ASSERT_FALSE(builder.IsEmpty());
+    std::string contents;
+    builder.Finish(&contents);
+    contents_ = contents;
+    std::unique_ptr<char[]> buf(new char[contents.size()]);
+    memcpy(buf.get(), contents.data(), contents.size());
+    ASSERT_OK(RangeFilter::Create(
+        BlockContents(std::move(buf), contents.size()), &filter_));
+  }
+
+  bool HasKeyInRange(const std::string& lower, const std::string& upper) {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), lower);
+    return it != keys_.end() && *it <= upper;
+  }
+
+  // Checks that the filter finds every non-empty range, and returns whether
+  // it reports the range as possibly non-empty
+  bool Check(const std::string& lower, const std::string& upper) {
+    const bool may_exist = filter_->RangeMayExist(lower, upper);
+    if (HasKeyInRange(lower, upper)) {
+      EXPECT_TRUE(may_exist) << Slice(lower).ToString(true) << " "
+                             << Slice(upper).ToString(true);
+    }
+    return may_exist;
+  }
+
+  static std::string Fixed(uint64_t i) {
+    std::string key;
+    PutFixed64(&key, EndianSwapValue(i));
+    return key;
+  }
+
+  std::vector<std::string> keys_;
+  std::string contents_;
+  std::unique_ptr<RangeFilter> filter_;
+};
+
+TEST_F(RangeFilterTest, FixedWidthKeys) {
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 10000; i++) {
+    keys.push_back("id" + Fixed(1000 + i * 100));
+  }
+  Build(keys);
+
+  int false_positives = 0;
+  for (uint64_t i = 0; i < 10000; i++) {
+    const uint64_t key = 1000 + i * 100;
+    // Short ranges around and between the keys
+    ASSERT_TRUE(Check("id" + Fixed(key), "id" + Fixed(key)));
+    ASSERT_TRUE(Check("id" + Fixed(key - 10), "id" + Fixed(key + 10)));
+    if (Check("id" + Fixed(key + 1), "id" + Fixed(key + 50))) {
+      false_positives++;
+    }
+  }
+  // About 1% for each of the 12 values of the range at level 0
+  ASSERT_LT(false_positives, 2000);
+
+  // Ranges beyond the keys, or without the common prefix
+  ASSERT_FALSE(Check("id" + Fixed(0), "id" + Fixed(999)));
+  ASSERT_FALSE(Check("id" + Fixed(1000 + 10000 * 100), "iz"));
+  ASSERT_FALSE(Check("a", "ic"));
+  ASSERT_FALSE(Check("j", "k"));
+  ASSERT_TRUE(Check("a", "z"));
+  ASSERT_TRUE(Check("i", "id" + Fixed(1000)));
+  ASSERT_TRUE(Check("id" + Fixed(1000 + 9999 * 100), "j"));
+  // Wide ranges
+  ASSERT_TRUE(Check("id" + Fixed(0), "id" + Fixed(1000000)));
+}
+
+TEST_F(RangeFilterTest, StringKeys) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; i++) {
+    // Keys of varying length, with prefixes of each other
+    std::string key = "user" + std::to_string(rnd.Uniform(1000000));
+    if (rnd.OneIn(3)) {
+      key += rnd.RandomString(static_cast<int>(rnd.Uniform(20)));
+    }
+    keys.push_back(key);
+  }
+  Build(keys);
+
+  int empty = 0;
+  int false_positives = 0;
+  for (int i = 0; i < 20000; i++) {
+    std::string lower = "user" + std::to_string(rnd.Uniform(1000000));
+    std::string upper = lower + rnd.RandomString(2);
+    if (rnd.OneIn(2)) {
+      upper = lower;
+      upper.back()++;
+    }
+    if (!HasKeyInRange(lower, upper)) {
+      empty++;
+      if (Check(lower, upper)) {
+        false_positives++;
+      }
+    } else {
+      ASSERT_TRUE(Check(lower, upper));
+    }
+  }
+  ASSERT_GT(empty, 10000);
+  ASSERT_LT(false_positives, empty / 5);
+
+  for (const auto& key : keys_) {
+    ASSERT_TRUE(Check(key, key));
+  }
+}
+
+TEST_F(RangeFilterTest, CommonPrefixShrinks) {
+  // The common prefix of the keys is empty in the end, after the keys so
+  // far shared a prefix of 12, 11, 10 and then 5 bytes
+  Build({"abcdefghijkl", "abcdefghijkl", "abcdefghijkm", "abcdefghijz",
+         "abcdez", "b", "bcd"});
+  for (size_t i = 0; i < keys_.size(); i++) {
+    ASSERT_TRUE(Check(keys_[i], keys_[i]));
+    if (i > 0) {
+      ASSERT_TRUE(Check(keys_[i - 1], keys_[i]));
+    }
+  }
+  ASSERT_TRUE(Check("", "abcdefghijkl"));
+  ASSERT_FALSE(Check("", "a"));
+  ASSERT_TRUE(Check("abcdefghijkla", "abcdefghijkm"));
+  ASSERT_FALSE(Check("c", "d"));
+  // Keys that differ after 8 bytes of the prefix cannot be told apart
+  ASSERT_TRUE(Check("abcdefghijk", "abcdefghijk"));
+}
+
+TEST_F(RangeFilterTest, SingleKey) {
+  Build({"key"});
+  ASSERT_TRUE(Check("key", "key"));
+  ASSERT_TRUE(Check("a", "z"));
+  ASSERT_FALSE(Check("a", "b"));
+  ASSERT_FALSE(Check("key0", "z"));
+  ASSERT_FALSE(Check("kez", "z"));
+  ASSERT_TRUE(Check("ke", "kez"));
+}
+
+TEST_F(RangeFilterTest, Corruption) {
+  Build({"a", "b", "c"});
+  for (size_t size : {size_t{0}, size_t{10}, contents_.size() - 64,
+                      contents_.size() - 1}) {
+    std::unique_ptr<RangeFilter> filter;
+    Status s = RangeFilter::Create(
+        BlockContents(Slice(contents_.data(), size)), &filter);
+    ASSERT_TRUE(s.IsCorruption());
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/reader_common.h"
 
+#include <algorithm>
+
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/table.h"
 #include "table/format.h"
@@ -22,22 +24,14 @@ void ForceReleaseCachedEntry(void* arg, void* h) {
   cache->Release(handle, true /* erase_if_last_ref */);
 }
 
-// WART: this is specific to block-based table
-Status VerifyBlockChecksum(const Footer& footer, const char* data,
-                           size_t block_size, const std::string& file_name,
-                           uint64_t offset) {
-  PERF_TIMER_GUARD(block_checksum_time);
-
-  assert(footer.GetBlockTrailerSize() == 5);
+namespace {
+// Compares the checksum computed over the block and its compression type with
+// the one stored after them
+Status CheckBlockChecksum(const Footer& footer, const char* data,
+                          size_t block_size, const std::string& file_name,
+                          uint64_t offset, uint32_t computed) {
   ChecksumType type = footer.checksum_type();
-
-  // After block_size bytes is compression type (1 byte), which is part of
-  // the checksummed section.
-  size_t len = block_size + 1;
-  // And then the stored checksum value (4 bytes).
-  uint32_t stored = DecodeFixed32(data + len);
-
-  uint32_t computed = ComputeBuiltinChecksum(type, data, len);
+  uint32_t stored = DecodeFixed32(data + block_size + 1);
 
   // Unapply context to 'stored' rather than apply to 'computed, for people
   // who might look for reference crc value in error message
@@ -61,4 +55,47 @@ Status VerifyBlockChecksum(const Footer& footer, const char* data,
         std::to_string(offset) + " size " + std::to_string(block_size));
   }
 }
+}  // namespace
+
+// WART: this is specific to block-based table
+Status VerifyBlockChecksum(const Footer& footer, const char* data,
+                           size_t block_size, const std::string& file_name,
+                           uint64_t offset) {
+  PERF_TIMER_GUARD(block_checksum_time);
+
+  assert(footer.GetBlockTrailerSize() == 5);
+  // After block_size bytes is compression type (1 byte), which is part of
+  // the checksummed section. And then the stored checksum value (4 bytes).
+  uint32_t computed =
+      ComputeBuiltinChecksum(footer.checksum_type(), data, block_size + 1);
+  return CheckBlockChecksum(footer, data, block_size, file_name, offset,
+                            computed);
+}
+
+void VerifyBlockChecksums(const Footer& footer, size_t n,
+                          const char* const* data, const size_t* block_sizes,
+                          const uint64_t* offsets,
+                          const std::string& file_name, Status* statuses) {
+  PERF_TIMER_GUARD(block_checksum_time);
+
+  assert(footer.GetBlockTrailerSize() == 5);
+  // The blocks are checksummed in groups of a multiple of three, the number
+  // of buffers crc32c::ValueMulti() interleaves
+  constexpr size_t kGroupSize = 15;
+  size_t lens[kGroupSize];
+  uint32_t computed[kGroupSize];
+  for (size_t start = 0; start < n; start += kGroupSize) {
+    const size_t count = std::min(kGroupSize, n - start);
+    for (size_t i = 0; i < count; i++) {
+      lens[i] = block_sizes[start + i] + 1;
+    }
+    ComputeBuiltinChecksums(footer.checksum_type(), count, data + start, lens,
+                            computed);
+    for (size_t i = 0; i < count; i++) {
+      statuses[start + i] =
+          CheckBlockChecksum(footer, data[start + i], block_sizes[start + i],
+                             file_name, offsets[start + i], computed[i]);
+    }
+  }
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -33,4 +33,12 @@ inline MemoryAllocator* GetMemoryAllocator(
 Status VerifyBlockChecksum(const Footer& footer, const char* data,
                            size_t block_size, const std::string& file_name,
                            uint64_t offset);
+
+// Like VerifyBlockChecksum() on each of the n blocks, storing the results into
+// statuses[i]. Verifying the blocks together lets their checksums be computed
+// together, see ComputeBuiltinChecksums().
+void VerifyBlockChecksums(const Footer& footer, size_t n,
+                          const char* const* data, const size_t* block_sizes,
+                          const uint64_t* offsets,
+                          const std::string& file_name, Status* statuses);
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,95 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/restart_key_model.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ROCKSDB_NAMESPACE {
+
+void RestartKeyModel::Build(const uint64_t* prefixes, uint32_t num,
+                            uint32_t max_error) {
+  prefixes_ = prefixes;
+  num_ = num;
+  max_error_ = max_error;
+  segments_.clear();
+
+  uint32_t start = 0;
+  while (start < num) {
+    const uint64_t first_prefix = prefixes[start];
+    // The slopes that keep the points so far within max_error
+    double min_slope = 0;
+    double max_slope = std::numeric_limits<double>::infinity();
+    uint32_t end = start + 1;
+    for (; end < num; end++) {
+      const double dy = end - start;
+      const uint64_t dx = prefixes[end] - first_prefix;
+      if (dx == 0) {
+        // Equal prefixes are predicted at the start of the segment
+        if (dy > max_error) {
+          break;
+        }
+        continue;
+      }
+      const double lo = std::max(min_slope, (dy - max_error) / dx);
+      const double hi = std::min(max_slope, (dy + max_error) / dx);
+      if (lo > hi) {
+        break;
+      }
+      min_slope = lo;
+      max_slope = hi;
+    }
+    const double slope = max_slope == std::numeric_limits<double>::infinity()
+                             ? 0
+                             : (min_slope + max_slope) / 2;
+    segments_.push_back({first_prefix, start, slope});
+    start = end;
+  }
+  segments_.shrink_to_fit();
+}
+
+void RestartKeyModel::Count(uint64_t target, uint32_t* num_less,
+                            uint32_t* num_not_greater) const {
+  auto next = std::upper_bound(
+      segments_.begin(), segments_.end(), target,
+      [](uint64_t t, const Segment& s) { return t < s.first_prefix; });
+  if (next == segments_.begin()) {
+    *num_less = 0;
+    *num_not_greater = 0;
+    return;
+  }
+  const Segment& segment = *(next - 1);
+  const uint32_t end = next == segments_.end() ? num_ : next->first_index;
+
+  // Both counts are within max_error + 1 of the prediction
+  double predicted =
+      segment.first_index +
+      segment.slope * static_cast<double>(target - segment.first_prefix);
+  predicted = std::min(predicted, static_cast<double>(end));
+  const uint64_t pos = std::max(static_cast<uint64_t>(predicted),
+                                uint64_t{segment.first_index});
+  const uint32_t first = static_cast<uint32_t>(
+      std::max(pos, uint64_t{max_error_} + 1 + segment.first_index) -
+      max_error_ - 1);
+  const uint32_t last =
+      static_cast<uint32_t>(std::min(pos + max_error_ + 2, uint64_t{end}));
+  auto range = std::equal_range(prefixes_ + first, prefixes_ + last, target);
+  uint32_t less = static_cast<uint32_t>(range.first - prefixes_);
+  uint32_t not_greater = static_cast<uint32_t>(range.second - prefixes_);
+
+  // The range may extend past the window, e.g. through a run of equal
+  // prefixes across segments
+  if ((less == first && first > 0 && prefixes_[first - 1] >= target) ||
+      (not_greater == last && last < num_ && prefixes_[last] <= target)) {
+    range = std::equal_range(prefixes_, prefixes_ + num_, target);
+    less = static_cast<uint32_t>(range.first - prefixes_);
+    not_greater = static_cast<uint32_t>(range.second - prefixes_);
+  }
+  *num_less = less;
+  *num_not_greater = not_greater;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
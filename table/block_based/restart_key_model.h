@@ -0,0 +1,61 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A piecewise-linear model of the position of the restart keys of a block,
+// from the integer prefixes of the keys (see
+// Block::InitializeIndexBlockRestartKeyModel()). Each segment of the model
+// predicts the position of any of its prefixes within max_error. A lookup
+// is a binary search over the few segments, one evaluation of the segment,
+// and a binary search over the 2 * max_error + 2 prefixes around the
+// prediction.
+//
+// The segments are fitted greedily, growing each while some slope keeps all
+// of its points within max_error ("shrinking cone"). Evenly spread keys,
+// such as fixed-width ids or timestamps, need one segment per block.
+class RestartKeyModel {
+ public:
+  // Fits the model to the num prefixes, which are sorted and must outlive
+  // the model
+  void Build(const uint64_t* prefixes, uint32_t num, uint32_t max_error);
+
+  bool Empty() const { return segments_.empty(); }
+
+  // Sets *num_less and *num_not_greater to the number of prefixes less than
+  // and not greater than target. Exact whatever the model predicts: the
+  // prefixes are searched in full if the prediction was off.
+  void Count(uint64_t target, uint32_t* num_less,
+             uint32_t* num_not_greater) const;
+
+  size_t NumSegments() const { return segments_.size(); }
+
+  size_t ApproximateMemoryUsage() const {
+    return segments_.capacity() * sizeof(Segment);
+  }
+
+ private:
+  struct Segment {
+    uint64_t first_prefix;
+    uint32_t first_index;
+    // Restart points per unit of prefix
+    double slope;
+  };
+
+  const uint64_t* prefixes_ = nullptr;
+  uint32_t num_ = 0;
+  uint32_t max_error_ = 0;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
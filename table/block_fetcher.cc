@@ -18,6 +18,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/compression_type.h"
 #include "rocksdb/env.h"
+#include "rocksdb/tenant_usage.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_type.h"
@@ -318,6 +319,9 @@ void BlockFetcher::ReadBlock(bool retry, FSAllocationPtr& fs_buf) {
   }
 
   PERF_COUNTER_ADD(block_read_byte, block_size_with_trailer_);
+  if (ioptions_.tenant_usage) {
+    ioptions_.tenant_usage->Add(kTenantSstBytesRead, block_size_with_trailer_);
+  }
   if (io_status_.ok()) {
     if (use_fs_scratch_ && !read_req.status.ok()) {
       io_status_ = read_req.status;
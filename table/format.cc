@@ -583,6 +583,21 @@ uint32_t ComputeBuiltinChecksum(ChecksumType type, const char* data,
   }
 }
 
+void ComputeBuiltinChecksums(ChecksumType type, size_t n,
+                             const char* const* data, const size_t* sizes,
+                             uint32_t* checksums) {
+  if (type == kCRC32c) {
+    crc32c::ValueMulti(n, data, sizes, checksums);
+    for (size_t i = 0; i < n; i++) {
+      checksums[i] = crc32c::Mask(checksums[i]);
+    }
+    return;
+  }
+  for (size_t i = 0; i < n; i++) {
+    checksums[i] = ComputeBuiltinChecksum(type, data[i], sizes[i]);
+  }
+}
+
 uint32_t ComputeBuiltinChecksumWithLastByte(ChecksumType type, const char* data,
                                             size_t data_size, char last_byte) {
   switch (type) {
@@ -640,9 +655,19 @@ Status UncompressBlockData(const UncompressionInfo& uncompression_info,
                       ShouldReportDetailedTime(ioptions.env, ioptions.stats));
   size_t uncompressed_size = 0;
   const char* error_msg = nullptr;
-  CacheAllocationPtr ubuf = UncompressData(
-      uncompression_info, data, size, &uncompressed_size,
-      GetCompressFormatForVersion(format_version), allocator, &error_msg);
+  const uint32_t compress_format_version =
+      GetCompressFormatForVersion(format_version);
+  CacheAllocationPtr ubuf;
+  if (ioptions.compression_accelerator != nullptr) {
+    ubuf = AcceleratedUncompressData(ioptions.compression_accelerator.get(),
+                                     uncompression_info, data, size,
+                                     &uncompressed_size,
+                                     compress_format_version, allocator);
+  }
+  if (!ubuf) {
+    ubuf = UncompressData(uncompression_info, data, size, &uncompressed_size,
+                          compress_format_version, allocator, &error_msg);
+  }
   if (!ubuf) {
     if (!CompressionTypeSupported(uncompression_info.type())) {
       ret = Status::NotSupported(
@@ -160,7 +160,7 @@ inline uint32_t GetCompressFormatForVersion(uint32_t format_version) {
   return format_version >= 2 ? 2 : 1;
 }
 
-constexpr uint32_t kLatestFormatVersion = 6;
+constexpr uint32_t kLatestFormatVersion = 7;
 
 inline bool IsSupportedFormatVersion(uint32_t version) {
   return version <= kLatestFormatVersion;
@@ -175,6 +175,12 @@ inline bool FormatVersionUsesIndexHandleInFooter(uint32_t version) {
   return version < 6;
 }
 
+// The keys of the restart points of data and index blocks, other than the
+// first of each block, are delta encoded against the first key of the block.
+inline bool FormatVersionDeltaEncodesRestartKeys(uint32_t version) {
+  return version >= 7;
+}
+
 // Footer encapsulates the fixed information stored at the tail end of every
 // SST file. In general, it should only include things that cannot go
 // elsewhere under the metaindex block. For example, checksum_type is
@@ -316,6 +322,12 @@ uint32_t ComputeBuiltinChecksum(ChecksumType type, const char* data,
                                 size_t size);
 uint32_t ComputeBuiltinChecksumWithLastByte(ChecksumType type, const char* data,
                                             size_t size, char last_byte);
+// Stores ComputeBuiltinChecksum(type, data[i], sizes[i]) into checksums[i] for
+// each of the n buffers. kCRC32c checksums of several buffers are computed
+// together, see crc32c::ValueMulti().
+void ComputeBuiltinChecksums(ChecksumType type, size_t n,
+                             const char* const* data, const size_t* sizes,
+                             uint32_t* checksums);
 
 // Represents the contents of a block read from an SST file. Depending on how
 // it's created, it may or may not own the actual block bytes. As an example,
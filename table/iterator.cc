@@ -11,6 +11,7 @@
 
 #include "memory/arena.h"
 #include "table/internal_iterator.h"
+#include "table/iterator_batch.h"
 #include "table/iterator_wrapper.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -26,6 +27,18 @@ Status Iterator::GetProperty(std::string prop_name, std::string* prop) {
   return Status::InvalidArgument("Unidentified property.");
 }
 
+size_t Iterator::NextBatch(size_t max_entries, std::vector<Slice>* keys,
+                           std::vector<Slice>* values, std::string* buffer) {
+  IteratorBatchBuilder batch(keys, values, buffer);
+  size_t n = 0;
+  for (; n < max_entries && Valid(); n++) {
+    batch.Add(key(), false /* key_pinned */, value(), false /* value_pinned */);
+    Next();
+  }
+  batch.Finish();
+  return n;
+}
+
 namespace {
 class EmptyIterator : public Iterator {
  public:
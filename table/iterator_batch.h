@@ -0,0 +1,61 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "util/autovector.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Fills the output of Iterator::NextBatch(). The keys and values that are
+// not pinned are copied into the buffer, and only pointed at once the buffer
+// stops growing.
+class IteratorBatchBuilder {
+ public:
+  IteratorBatchBuilder(std::vector<Slice>* keys, std::vector<Slice>* values,
+                       std::string* buffer)
+      : keys_(keys), values_(values), buffer_(buffer) {}
+
+  void Add(const Slice& key, bool key_pinned, const Slice& value,
+           bool value_pinned) {
+    keys_->push_back(key_pinned ? key : Copy(key, keys_->size(), true));
+    values_->push_back(value_pinned ? value
+                                    : Copy(value, values_->size(), false));
+  }
+
+  // Points the copies at the buffer
+  void Finish() {
+    for (const auto& copy : copies_) {
+      Slice& slice =
+          copy.is_key ? (*keys_)[copy.index] : (*values_)[copy.index];
+      slice = Slice(buffer_->data() + copy.offset, slice.size());
+    }
+    copies_.clear();
+  }
+
+ private:
+  struct CopiedSlice {
+    size_t index;
+    size_t offset;
+    bool is_key;
+  };
+
+  Slice Copy(const Slice& slice, size_t index, bool is_key) {
+    copies_.push_back({index, buffer_->size(), is_key});
+    buffer_->append(slice.data(), slice.size());
+    return Slice(nullptr, slice.size());
+  }
+
+  std::vector<Slice>* const keys_;
+  std::vector<Slice>* const values_;
+  std::string* const buffer_;
+  autovector<CopiedSlice, 16> copies_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,96 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/level_filter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "util/bloom_impl.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Block format:
+//   number of Bloom probes: uint8
+//   Bloom filter: the rest, a multiple of 64 bytes (FastLocalBloomImpl over
+//   GetSliceHash64 of the user keys)
+namespace {
+constexpr size_t kBloomLineBytes = 64;
+}  // namespace
+
+LevelFilterBuilder::LevelFilterBuilder(double bits_per_key)
+    : bits_per_key_(std::min(bits_per_key, 100.0)) {
+  assert(bits_per_key > 0);
+}
+
+void LevelFilterBuilder::Add(const Slice& user_key) {
+  const uint64_t hash = GetSliceHash64(user_key);
+  // The entries of a user key come one after the other
+  if (hashes_.empty() || hashes_.back() != hash) {
+    hashes_.push_back(hash);
+  }
+}
+
+void LevelFilterBuilder::Finish(std::string* contents) {
+  assert(!hashes_.empty());
+  size_t bloom_bytes =
+      static_cast<size_t>(hashes_.size() * bits_per_key_ / 8) +
+      kBloomLineBytes;
+  bloom_bytes -= bloom_bytes % kBloomLineBytes;
+  const int num_probes = FastLocalBloomImpl::ChooseNumProbes(
+      static_cast<int>(bits_per_key_ * 1000));
+
+  contents->clear();
+  contents->push_back(static_cast<char>(num_probes));
+  contents->resize(1 + bloom_bytes);
+  char* const bloom = &(*contents)[1];
+  for (uint64_t hash : hashes_) {
+    FastLocalBloomImpl::AddHash(Lower32of64(hash), Upper32of64(hash),
+                                static_cast<uint32_t>(bloom_bytes),
+                                num_probes, bloom);
+  }
+}
+
+Status LevelFilter::Create(BlockContents&& contents,
+                           std::unique_ptr<LevelFilter>* filter) {
+  std::unique_ptr<LevelFilter> result(new LevelFilter());
+  if (contents.own_bytes()) {
+    result->contents_ = std::move(contents);
+  } else {
+    // E.g. with mmap reads, the contents point into the file
+    std::unique_ptr<char[]> buf(new char[contents.data.size()]);
+    memcpy(buf.get(), contents.data.data(), contents.data.size());
+    result->contents_ = BlockContents(std::move(buf), contents.data.size());
+  }
+  Slice input = result->contents_.data;
+  if (input.size() < 1 + kBloomLineBytes ||
+      (input.size() - 1) % kBloomLineBytes != 0 ||
+      input.size() - 1 > UINT32_MAX) {
+    return Status::Corruption("Bad level filter block size");
+  }
+  result->num_probes_ = static_cast<uint8_t>(input[0]);
+  if (result->num_probes_ < 1) {
+    return Status::Corruption("Bad level filter number of probes");
+  }
+  input.remove_prefix(1);
+  result->bloom_ = input;
+  *filter = std::move(result);
+  return Status::OK();
+}
+
+bool LevelFilter::KeyMayMatch(const Slice& user_key) const {
+  const uint64_t hash = GetSliceHash64(user_key);
+  return FastLocalBloomImpl::HashMayMatch(
+      Lower32of64(hash), Upper32of64(hash),
+      static_cast<uint32_t>(bloom_.size()), num_probes_, bloom_.data());
+}
+
+size_t LevelFilter::ApproximateMemoryUsage() const {
+  return sizeof(*this) + contents_.ApproximateMemoryUsage();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
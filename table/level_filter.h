@@ -0,0 +1,68 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A level filter is a Bloom filter of the user keys (without timestamps) of
+// a table file, which the versions hold in memory for as long as the file is
+// live, whether or not its table reader is in the table cache (see
+// AdvancedColumnFamilyOptions::level_filter_bits_per_key). Get() and
+// MultiGet() check it before looking up the file, so a key missing from a
+// level costs one probe in memory instead of loading the table reader and
+// the filter blocks of the file.
+//
+// A file with range tombstones has no level filter, since its tombstones
+// apply to keys it has no entry for.
+class LevelFilterBuilder {
+ public:
+  explicit LevelFilterBuilder(double bits_per_key);
+
+  // REQUIRES: the entries of a user key are added one after the other
+  void Add(const Slice& user_key);
+
+  bool IsEmpty() const { return hashes_.empty(); }
+
+  // Returns the contents of the level filter block in *contents
+  void Finish(std::string* contents);
+
+ private:
+  const double bits_per_key_;
+  // The hashes of the distinct user keys so far
+  std::vector<uint64_t> hashes_;
+};
+
+class LevelFilter {
+ public:
+  // Takes the contents of a level filter block, copying them if they are
+  // not owned, since the filter may outlive the table reader
+  static Status Create(BlockContents&& contents,
+                       std::unique_ptr<LevelFilter>* filter);
+
+  // Returns false only if the file has no entry for the user key
+  bool KeyMayMatch(const Slice& user_key) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  LevelFilter() = default;
+
+  BlockContents contents_;
+  int num_probes_ = 0;
+  Slice bloom_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,122 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/level_filter.h"
+
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class LevelFilterTest : public testing::Test {
+ protected:
+  void Build(const std::vector<std::string>& keys, double bits_per_key = 10) {
+    LevelFilterBuilder builder(bits_per_key);
+    ASSERT_TRUE(builder.IsEmpty());
+    for (const auto& key : keys) {
+      builder.Add(key);
+    }
+    ASSERT_FALSE(builder.IsEmpty());
+    builder.Finish(&contents_);
+    std::unique_ptr<char[]> buf(new char[contents_.size()]);
+    memcpy(buf.get(), contents_.data(), contents_.size());
+    ASSERT_OK(LevelFilter::Create(
+        BlockContents(std::move(buf), contents_.size()), &filter_));
+  }
+
+  static std::string Key(int i) { return "key" + std::to_string(i); }
+
+  std::string contents_;
+  std::unique_ptr<LevelFilter> filter_;
+};
+
+TEST_F(LevelFilterTest, NoFalseNegatives) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10000; i++) {
+    keys.push_back(Key(i * 2));
+  }
+  Build(keys);
+  for (const auto& key : keys) {
+    ASSERT_TRUE(filter_->KeyMayMatch(key));
+  }
+
+  int false_positives = 0;
+  for (int i = 0; i < 10000; i++) {
+    if (filter_->KeyMayMatch(Key(i * 2 + 1))) {
+      false_positives++;
+    }
+  }
+  // About 1% at 10 bits per key
+  ASSERT_LT(false_positives, 250);
+  ASSERT_GE(filter_->ApproximateMemoryUsage(), size_t{10000 * 10 / 8});
+}
+
+TEST_F(LevelFilterTest, BitsPerKey) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(Key(i));
+  }
+  Build(keys, 20);
+  const size_t size_20 = contents_.size();
+  Build(keys, 5);
+  ASSERT_GT(size_20, contents_.size() * 3);
+  for (const auto& key : keys) {
+    ASSERT_TRUE(filter_->KeyMayMatch(key));
+  }
+}
+
+TEST_F(LevelFilterTest, SameUserKey) {
+  // The entries of a user key take the space of one key
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(Key(i));
+  }
+  Build(keys);
+  const size_t size = contents_.size();
+  std::vector<std::string> repeated;
+  for (const auto& key : keys) {
+    repeated.insert(repeated.end(), 5, key);
+  }
+  Build(repeated);
+  ASSERT_EQ(size, contents_.size());
+}
+
+TEST_F(LevelFilterTest, NotOwnedContents) {
+  Build({"a", "b", "c"});
+  std::string copy = contents_;
+  std::unique_ptr<LevelFilter> filter;
+  ASSERT_OK(LevelFilter::Create(BlockContents(Slice(copy)), &filter));
+  // The filter does not depend on the original contents
+  copy.assign(copy.size(), '\0');
+  ASSERT_TRUE(filter->KeyMayMatch("a"));
+  ASSERT_TRUE(filter->KeyMayMatch("b"));
+  ASSERT_TRUE(filter->KeyMayMatch("c"));
+}
+
+TEST_F(LevelFilterTest, Corruption) {
+  Build({"a", "b", "c"});
+  for (size_t size : {size_t{0}, size_t{1}, size_t{10}, contents_.size() - 1}) {
+    std::unique_ptr<LevelFilter> filter;
+    Status s = LevelFilter::Create(
+        BlockContents(Slice(contents_.data(), size)), &filter);
+    ASSERT_TRUE(s.IsCorruption());
+  }
+  std::string no_probes = contents_;
+  no_probes[0] = 0;
+  std::unique_ptr<LevelFilter> filter;
+  ASSERT_TRUE(LevelFilter::Create(BlockContents(Slice(no_probes)), &filter)
+                  .IsCorruption());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -36,6 +36,9 @@ extern const std::string kIndexBlockName;
 extern const std::string kPropertiesBlockOldName;
 extern const std::string kCompressionDictBlockName;
 extern const std::string kRangeDelBlockName;
+extern const std::string kRangeFilterBlockName;
+extern const std::string kLevelFilterBlockName;
+extern const std::string kBlockTimestampIndexBlockName;
 
 class MetaIndexBuilder {
  public:
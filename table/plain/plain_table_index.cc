@@ -53,6 +53,13 @@ PlainTableIndex::IndexSearchResult PlainTableIndex::GetOffset(
   }
 }
 
+void PlainTableIndex::Prefetch(uint32_t prefix_hash) const {
+  if (index_size_ > 0) {
+    PREFETCH(index_ + GetBucketIdFromHash(prefix_hash, index_size_),
+             0 /* rw */, 3 /* locality */);
+  }
+}
+
 void PlainTableIndexBuilder::IndexRecordList::AddRecord(uint32_t hash,
                                                         uint32_t offset) {
   if (num_records_in_current_group_ == kNumRecordsPerGroup) {
@@ -12,6 +12,7 @@
 #include "memory/arena.h"
 #include "monitoring/histogram.h"
 #include "options/cf_options.h"
+#include "port/port.h"
 #include "rocksdb/options.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -84,6 +85,16 @@ class PlainTableIndex {
   IndexSearchResult GetOffset(uint32_t prefix_hash,
                               uint32_t* bucket_value) const;
 
+  // Prefetches the hash bucket of `prefix_hash` into the CPU cache, for a
+  // GetOffset() soon after
+  void Prefetch(uint32_t prefix_hash) const;
+
+  // Prefetches the start of the sub index at `offset`, the `bucket_value` of
+  // a kSubindex result of GetOffset()
+  void PrefetchSubIndex(uint32_t offset) const {
+    PREFETCH(&sub_index_[offset], 0 /* rw */, 3 /* locality */);
+  }
+
   // Initialize data from `index_data`, which points to raw data for
   // index stored in the SST file.
   Status InitFromRawData(Slice index_data);
@@ -6,6 +6,7 @@
 
 #include "table/plain/plain_table_reader.h"
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -551,33 +552,112 @@ void PlainTableReader::Prepare(const Slice& target) {
   }
 }
 
+uint32_t PlainTableReader::GetHashes(const Slice& target, Slice* prefix_slice,
+                                     uint32_t* prefix_hash) const {
+  if (IsTotalOrderMode()) {
+    // in total order mode, there is only one bucket 0, and we always use empty
+    // prefix.
+    *prefix_slice = Slice();
+    *prefix_hash = 0;
+    // Match whole user key for bloom filter check.
+    return GetSliceHash(ExtractUserKey(target));
+  }
+  *prefix_slice = GetPrefix(target);
+  *prefix_hash = GetSliceHash(*prefix_slice);
+  return *prefix_hash;
+}
+
 Status PlainTableReader::Get(const ReadOptions& /*ro*/, const Slice& target,
                              GetContext* get_context,
                              const SliceTransform* /* prefix_extractor */,
                              bool /*skip_filters*/) {
+  if (IsTotalOrderMode() && full_scan_mode_) {
+    status_ =
+        Status::InvalidArgument("Get() is not allowed in full scan mode.");
+  }
   // Check bloom filter first.
   Slice prefix_slice;
   uint32_t prefix_hash;
-  if (IsTotalOrderMode()) {
-    if (full_scan_mode_) {
-      status_ =
-          Status::InvalidArgument("Get() is not allowed in full scan mode.");
+  if (!MatchBloom(GetHashes(target, &prefix_slice, &prefix_hash))) {
+    return Status::OK();
+  }
+  return GetFromIndex(target, prefix_slice, prefix_hash, get_context);
+}
+
+void PlainTableReader::MultiGet(const ReadOptions& readOptions,
+                                const MultiGetContext::Range* mget_range,
+                                const SliceTransform* prefix_extractor,
+                                bool skip_filters) {
+  if (full_scan_mode_) {
+    TableReader::MultiGet(readOptions, mget_range, prefix_extractor,
+                          skip_filters);
+    return;
+  }
+  struct Lookup {
+    Slice prefix_slice;
+    uint32_t prefix_hash;
+    uint32_t bloom_hash;
+    bool may_match;
+  };
+  std::array<Lookup, MultiGetContext::MAX_BATCH_SIZE> lookups;
+  assert(mget_range->KeysLeft() <= lookups.size());
+  size_t num_keys = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    auto& lookup = lookups[num_keys++];
+    lookup.bloom_hash =
+        GetHashes(iter->ikey, &lookup.prefix_slice, &lookup.prefix_hash);
+    if (enable_bloom_) {
+      bloom_.Prefetch(lookup.bloom_hash);
     }
-    // Match whole user key for bloom filter check.
-    if (!MatchBloom(GetSliceHash(ExtractUserKey(target)))) {
-      return Status::OK();
+  }
+
+  num_keys = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    auto& lookup = lookups[num_keys++];
+    lookup.may_match = MatchBloom(lookup.bloom_hash);
+    if (lookup.may_match) {
+      index_.Prefetch(lookup.prefix_hash);
     }
-    // in total order mode, there is only one bucket 0, and we always use empty
-    // prefix.
-    prefix_slice = Slice();
-    prefix_hash = 0;
-  } else {
-    prefix_slice = GetPrefix(target);
-    prefix_hash = GetSliceHash(prefix_slice);
-    if (!MatchBloom(prefix_hash)) {
-      return Status::OK();
+  }
+
+  // The bucket tells where the row or the sub index of the prefix is
+  num_keys = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    const auto& lookup = lookups[num_keys++];
+    if (!lookup.may_match) {
+      continue;
+    }
+    uint32_t bucket_value;
+    switch (index_.GetOffset(lookup.prefix_hash, &bucket_value)) {
+      case PlainTableIndex::kDirectToFile:
+        if (file_info_.is_mmap_mode &&
+            bucket_value < file_info_.data_end_offset) {
+          PREFETCH(file_info_.file_data.data() + bucket_value, 0 /* rw */,
+                   3 /* locality */);
+        }
+        break;
+      case PlainTableIndex::kSubindex:
+        index_.PrefetchSubIndex(bucket_value);
+        break;
+      case PlainTableIndex::kNoPrefixForBucket:
+        break;
     }
   }
+
+  num_keys = 0;
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    const auto& lookup = lookups[num_keys++];
+    *iter->s = lookup.may_match
+                   ? GetFromIndex(iter->ikey, lookup.prefix_slice,
+                                  lookup.prefix_hash, iter->get_context)
+                   : Status::OK();
+  }
+}
+
+Status PlainTableReader::GetFromIndex(const Slice& target,
+                                      const Slice& prefix_slice,
+                                      uint32_t prefix_hash,
+                                      GetContext* get_context) {
   uint32_t offset;
   bool prefix_match;
   PlainTableKeyDecoder decoder(&file_info_, encoding_type_, user_key_len_,
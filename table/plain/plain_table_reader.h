@@ -92,6 +92,14 @@ class PlainTableReader : public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks up a batch of keys in stages, prefetching the bloom filter, the
+  // index buckets and then the rows of all the keys of a stage before the
+  // next stage reads them, so that the cache misses of the keys overlap
+  void MultiGet(const ReadOptions& readOptions,
+                const MultiGetContext::Range* mget_range,
+                const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   uint64_t ApproximateOffsetOf(const ReadOptions& read_options,
                                const Slice& key,
                                TableReaderCaller caller) override;
@@ -138,6 +146,15 @@ class PlainTableReader : public TableReader {
 
   Status MmapDataIfNeeded();
 
+  // Returns the hash of `target` for the bloom filter, and fills the prefix
+  // and its hash for the index
+  uint32_t GetHashes(const Slice& target, Slice* prefix_slice,
+                     uint32_t* prefix_hash) const;
+
+  // Get() once the bloom filter matched
+  Status GetFromIndex(const Slice& target, const Slice& prefix_slice,
+                      uint32_t prefix_hash, GetContext* get_context);
+
  private:
   const InternalKeyComparator internal_comparator_;
   EncodingType encoding_type_;
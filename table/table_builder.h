@@ -160,6 +160,11 @@ struct TableBuilderOptions {
   // in the table options of the ioptions.table_factory
   bool skip_filters = false;
   const uint64_t cur_file_num;
+
+  // The user key ranges of the data blocks to warm in the block cache, when
+  // the table options ask for it (see
+  // BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction)
+  const std::vector<OwnedUserKeyRange>* hot_key_ranges = nullptr;
 };
 
 // TableBuilder provides the interface used to build a Table
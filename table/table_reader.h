@@ -30,6 +30,7 @@ class Arena;
 struct ReadOptions;
 struct TableProperties;
 class GetContext;
+class LevelFilter;
 class MultiGetContext;
 
 // A Table (also referred to as SST) is a sorted map from strings to strings.
@@ -71,6 +72,18 @@ class TableReader {
     return nullptr;
   }
 
+  // Sets `*seq` to the max sequence number of the range tombstones of the
+  // table that cover `user_key` and are visible to `read_options`, or to 0 if
+  // there is none, without creating a range tombstone iterator. Returns false
+  // if the table cannot, in which case NewRangeTombstoneIterator() is to be
+  // used instead.
+  // read_options.snapshot needs to outlive this call.
+  virtual bool MaxCoveringTombstoneSeqnum(const ReadOptions& /*read_options*/,
+                                          const Slice& /*user_key*/,
+                                          SequenceNumber* /*seq*/) {
+    return false;
+  }
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -109,12 +122,29 @@ class TableReader {
     return Status::NotSupported("ApproximateKeyAnchors() not supported.");
   }
 
+  // Appends to `ranges`, in order, the user key ranges of the data blocks
+  // of this table that are in the block cache, with the ranges of adjacent
+  // blocks merged. `smallest_user_key` is the smallest user key of the
+  // table, which starts the range of its first data block. Used to find the
+  // key ranges of compaction inputs that were read recently.
+  virtual Status GetCachedKeyRanges(
+      const ReadOptions& /*read_options*/, const Slice& /*smallest_user_key*/,
+      std::vector<OwnedUserKeyRange>& /*ranges*/) {
+    return Status::NotSupported("GetCachedKeyRanges() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
 
   virtual std::shared_ptr<const TableProperties> GetTableProperties() const = 0;
 
+  // Returns the level filter of the table, if it has one (see
+  // table/level_filter.h)
+  virtual std::shared_ptr<const LevelFilter> GetLevelFilter() const {
+    return nullptr;
+  }
+
   // Prepare work that can be done before the real Get()
   virtual void Prepare(const Slice& /*target*/) {}
 
@@ -178,6 +208,19 @@ class TableReader {
     return Status::OK();
   }
 
+  // Hints that a scan will soon read this table from its first key, e.g.
+  // once an iterator over the files of a level is done with the file
+  // before, so that the table can start reading ahead in the background.
+  // Best effort: the default implementation is a no-op.
+  virtual void PrefetchForScan(const ReadOptions& /* read_options */) {}
+
+  // Loads the blocks that lookups in this table depend on, such as the
+  // partitions of a partitioned index or filter, into the block cache ahead
+  // of the first lookups. The default implementation is a no-op.
+  virtual Status CacheDependencies(const ReadOptions& /* read_options */) {
+    return Status::OK();
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* /*out_file*/) {
     return Status::NotSupported("DumpTable() not supported");
@@ -50,6 +50,7 @@ function display_usage() {
   echo -e "\tBLOCK_SIZE\t\t\tThe size of the database blocks in the benchmark (default: 8 KB)"
   echo -e "\tDB_BENCH_NO_SYNC\t\tDisable fsync on the WAL"
   echo -e "\tNUMACTL\t\t\t\tWhen defined use numactl --interleave=all"
+  echo -e "\tPERF_RECORD\t\t\tWhen defined profile db_bench with perf record into <log>.perf.data"
   echo -e "\tNUM_THREADS\t\t\tThe number of threads to use (default: 64)"
   echo -e "\tMB_WRITE_PER_SEC\t\t\tRate limit for background writer"
   echo -e "\tNUM_NEXTS_PER_SEEK\t\t(default: 10)"
@@ -430,7 +431,12 @@ function get_cmd() {
     fi
   fi
 
-  echo "/usr/bin/time -f '%e %U %S' -o $output $numa $timeout_cmd"
+  perf_cmd=""
+  if [ ! -z $PERF_RECORD ]; then
+    perf_cmd="perf record -g -o ${output%.time}.perf.data --"
+  fi
+
+  echo "/usr/bin/time -f '%e %U %S' -o $output $numa $timeout_cmd $perf_cmd"
 }
 
 function month_to_num() {
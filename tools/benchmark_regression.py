@@ -0,0 +1,354 @@
+#!/usr/bin/env python3
+#  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+"""Catch performance regressions by comparing benchmark runs to a baseline
+
+  run       Runs a fixed matrix of workloads through benchmark.sh (fillseq,
+            readrandom, multireadrandom, seekrandom, overwrite) and db_bench
+            (cloudopen, against the local storage provider), several times,
+            and stores the results as JSON. With --baseline, compares them
+            to it, and with --profile re-runs the regressed workloads under
+            perf record.
+  compare   Compares two stored results.
+
+A metric regresses when the confidence interval of the difference of its
+means, from Welch's t-test, excludes 0 and the change is worse than
+--min_change. Throughput is compared for every workload, the p99 latency
+of every operation type and, for cloudopen, the time to open the DB.
+"""
+
+import argparse
+import glob
+import json
+import logging
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+logging.basicConfig(level=logging.INFO)
+
+# benchmark.sh jobs, run in this order on the DB loaded by the first one
+BENCHMARK_SH_JOBS = [
+    "fillseq_disable_wal",
+    "readrandom",
+    "multireadrandom",
+    "fwdrange",
+    "overwrite",
+]
+
+# Two-sided critical values of Student's t distribution by confidence and
+# degrees of freedom, 1 to 30. The normal values are used beyond.
+T_TABLE = {
+    0.90: [6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833,
+           1.812, 1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734,
+           1.729, 1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703,
+           1.701, 1.699, 1.697],
+    0.95: [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+           2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+           2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+           2.048, 2.045, 2.042],
+    0.99: [63.657, 9.925, 5.841, 4.604, 4.032, 3.707, 3.499, 3.355, 3.250,
+           3.169, 3.106, 3.055, 3.012, 2.977, 2.947, 2.921, 2.898, 2.878,
+           2.861, 2.845, 2.831, 2.819, 2.807, 2.797, 2.787, 2.779, 2.771,
+           2.763, 2.756, 2.750],
+}
+Z_TABLE = {0.90: 1.645, 0.95: 1.960, 0.99: 2.576}
+
+
+def t_critical(confidence, df):
+    if df < 1:
+        return math.inf
+    index = int(math.floor(df))
+    if index > len(T_TABLE[confidence]):
+        return Z_TABLE[confidence]
+    return T_TABLE[confidence][index - 1]
+
+
+def extract_metrics(result):
+    """The metrics compared from one line of --json_results_file, as
+    {name: (value, higher_is_better)}"""
+    metrics = {}
+    if result["benchmark"] == "cloudopen":
+        metrics["open_micros"] = (result["open_micros"], False)
+        return metrics
+    metrics["ops_per_sec"] = (result["ops_per_sec"], True)
+    for key, value in result.items():
+        if key.endswith("_latency_micros"):
+            metrics[key[: -len("micros")] + "p99"] = (value["p99"], False)
+    return metrics
+
+
+def compare_metric(base, current, confidence):
+    """The relative change of the mean of current over base, and the
+    confidence interval of the difference of the means, from Welch's t-test
+    """
+    n1, n2 = len(base), len(current)
+    m1, m2 = sum(base) / n1, sum(current) / n2
+    v1 = sum((x - m1) ** 2 for x in base) / (n1 - 1) if n1 > 1 else 0.0
+    v2 = sum((x - m2) ** 2 for x in current) / (n2 - 1) if n2 > 1 else 0.0
+    se2 = v1 / n1 + v2 / n2
+    if se2 == 0:
+        half_width = 0.0 if n1 > 1 and n2 > 1 else math.inf
+    else:
+        df_denominator = 0.0
+        if n1 > 1:
+            df_denominator += (v1 / n1) ** 2 / (n1 - 1)
+        if n2 > 1:
+            df_denominator += (v2 / n2) ** 2 / (n2 - 1)
+        df = se2**2 / df_denominator
+        half_width = t_critical(confidence, df) * math.sqrt(se2)
+    diff = m2 - m1
+    change = diff / m1 if m1 != 0 else 0.0
+    return change, diff - half_width, diff + half_width
+
+
+def compare(baseline, current, confidence, min_change):
+    """Prints the comparison of each metric and returns the workloads that
+    regressed"""
+    regressed = []
+    print(
+        "%-16s %-24s %14s %14s %9s"
+        % ("workload", "metric", "baseline", "current", "change")
+    )
+    for workload, runs in sorted(current["workloads"].items()):
+        base_runs = baseline["workloads"].get(workload)
+        if not base_runs:
+            logging.warning(f"No baseline for {workload}")
+            continue
+        base_metrics = [extract_metrics(run) for run in base_runs]
+        cur_metrics = [extract_metrics(run) for run in runs]
+        for name, (_, higher_is_better) in sorted(cur_metrics[0].items()):
+            base = [m[name][0] for m in base_metrics if name in m]
+            cur = [m[name][0] for m in cur_metrics if name in m]
+            if not base:
+                continue
+            change, low, high = compare_metric(base, cur, confidence)
+            significant = low > 0 or high < 0
+            worse = -change if higher_is_better else change
+            verdict = ""
+            if significant and worse > min_change:
+                verdict = "REGRESSION"
+                if workload not in regressed:
+                    regressed.append(workload)
+            elif significant and -worse > min_change:
+                verdict = "improvement"
+            print(
+                "%-16s %-24s %14.1f %14.1f %+8.2f%%  %s"
+                % (
+                    workload,
+                    name,
+                    sum(base) / len(base),
+                    sum(cur) / len(cur),
+                    100.0 * change,
+                    verdict,
+                )
+            )
+    return regressed
+
+
+class Runner:
+    def __init__(self, args):
+        self.db_bench = os.path.abspath(args.db_bench)
+        self.benchmark_script = os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), "benchmark.sh"
+        )
+        self.output_dir = os.path.abspath(args.output_dir)
+        self.num_keys = args.num_keys
+        self.duration = args.duration
+        self.num_threads = args.num_threads
+        self.work_dir = tempfile.mkdtemp(prefix="benchmark_regression")
+        # benchmark.sh runs ./db_bench
+        os.symlink(self.db_bench, os.path.join(self.work_dir, "db_bench"))
+
+    def cleanup(self):
+        shutil.rmtree(self.work_dir, ignore_errors=True)
+
+    def run_benchmark_sh(self, jobs, json_file, log_dir, profile):
+        db_dir = os.path.join(self.work_dir, "db")
+        shutil.rmtree(db_dir, ignore_errors=True)
+        env = dict(os.environ)
+        env.update(
+            {
+                "DB_DIR": db_dir,
+                "WAL_DIR": db_dir,
+                "OUTPUT_DIR": log_dir,
+                "NUM_KEYS": str(self.num_keys),
+                "DURATION": str(self.duration),
+                "NUM_THREADS": str(self.num_threads),
+                "CACHE_SIZE": str(1 << 30),
+            }
+        )
+        if profile:
+            env["PERF_RECORD"] = "1"
+        cmd = [self.benchmark_script, ",".join(jobs),
+               f"--json_results_file={json_file}"]
+        logging.info(f"Run {cmd}")
+        subprocess.run(cmd, env=env, cwd=self.work_dir, check=True,
+                       stdout=subprocess.DEVNULL)
+
+    def run_cloudopen(self, json_file, log_dir, profile):
+        root = os.path.join(self.work_dir, "cloud")
+        shutil.rmtree(root, ignore_errors=True)
+        os.makedirs(os.path.join(root, "store"))
+        fs_uri = (
+            f"id=cloud;provider={{id=local;root={root}/store}};"
+            "create_bucket_if_missing=true;keep_local_sst_files=true;"
+            "src={bucket=bench;object=db};dest={bucket=bench;object=db}"
+        )
+        common = [
+            f"--fs_uri={fs_uri}",
+            f"--db={root}/db",
+            f"--num={self.num_keys}",
+        ]
+        subprocess.run(
+            [self.db_bench, "--benchmarks=fillrandom", "--use_existing_db=0"]
+            + common,
+            check=True,
+            stdout=subprocess.DEVNULL,
+        )
+        cmd = [
+            self.db_bench,
+            "--benchmarks=cloudopen",
+            "--use_existing_db=1",
+            f"--json_results_file={json_file}",
+        ] + common
+        if profile:
+            cmd = ["perf", "record", "-g", "-o",
+                   os.path.join(log_dir, "benchmark_cloudopen.perf.data"),
+                   "--"] + cmd
+        logging.info(f"Run {cmd}")
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+
+    def run(self, repetitions):
+        """Runs the matrix and returns the results"""
+        results = {
+            "revision": git_revision(),
+            "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "num_keys": self.num_keys,
+            "duration": self.duration,
+            "num_threads": self.num_threads,
+            "workloads": {},
+        }
+        for i in range(repetitions):
+            logging.info(f"Repetition {i + 1} of {repetitions}")
+            log_dir = os.path.join(self.output_dir, f"run{i}")
+            os.makedirs(log_dir, exist_ok=True)
+            json_file = os.path.join(self.work_dir, f"run{i}.json")
+            self.run_benchmark_sh(BENCHMARK_SH_JOBS, json_file, log_dir, False)
+            self.run_cloudopen(json_file, log_dir, False)
+            with open(json_file) as f:
+                for line in f:
+                    result = json.loads(line)
+                    results["workloads"].setdefault(
+                        result["benchmark"], []).append(result)
+        return results
+
+    def profile(self, workloads):
+        """Re-runs the workloads under perf record, and writes the output of
+        perf script of each, which stackcollapse-perf.pl folds for a
+        flamegraph"""
+        log_dir = os.path.join(self.output_dir, "profile")
+        os.makedirs(log_dir, exist_ok=True)
+        json_file = os.path.join(self.work_dir, "profile.json")
+        jobs = [job for job in BENCHMARK_SH_JOBS
+                if job_workload(job) in workloads]
+        if jobs:
+            if jobs[0] != BENCHMARK_SH_JOBS[0]:
+                jobs.insert(0, BENCHMARK_SH_JOBS[0])
+            self.run_benchmark_sh(jobs, json_file, log_dir, True)
+        if "cloudopen" in workloads:
+            self.run_cloudopen(json_file, log_dir, True)
+        for data in glob.glob(os.path.join(log_dir, "*.perf.data")):
+            perf_file = data[: -len(".data")]
+            with open(perf_file, "w") as f:
+                subprocess.run(["perf", "script", "-i", data], stdout=f,
+                               check=True)
+            logging.info(f"Wrote {perf_file}")
+
+
+def job_workload(job):
+    """The name of the db_bench benchmark of a benchmark.sh job"""
+    return {"fillseq_disable_wal": "fillseq", "fwdrange": "seekrandom"}.get(
+        job, job)
+
+
+def git_revision():
+    try:
+        return subprocess.run(
+            ["git", "rev-parse", "HEAD"],
+            cwd=os.path.dirname(os.path.abspath(__file__)),
+            capture_output=True,
+            text=True,
+            check=True,
+        ).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run a benchmark matrix and compare it to a baseline."
+    )
+    parser.add_argument("--confidence", type=float, default=0.95,
+                        choices=sorted(T_TABLE.keys()),
+                        help="Confidence of the intervals of the changes")
+    parser.add_argument("--min_change", type=float, default=0.03,
+                        help="Smallest relative change reported")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = subparsers.add_parser("run", help="Run the matrix")
+    run_parser.add_argument("--db_bench", default="./db_bench")
+    run_parser.add_argument("--output_dir", default="/tmp/benchmark_regression",
+                            help="Logs and profiles go here")
+    run_parser.add_argument("--results", required=True,
+                            help="JSON file the results are written to")
+    run_parser.add_argument("--repetitions", type=int, default=5)
+    run_parser.add_argument("--num_keys", type=int, default=1000000)
+    run_parser.add_argument("--duration", type=int, default=30,
+                            help="Seconds of each read and overwrite job")
+    run_parser.add_argument("--num_threads", type=int, default=16)
+    run_parser.add_argument("--baseline",
+                            help="JSON results of a previous run to compare "
+                            "to")
+    run_parser.add_argument("--profile", action="store_true",
+                            help="Profile the regressed workloads with perf")
+
+    compare_parser = subparsers.add_parser("compare",
+                                           help="Compare stored results")
+    compare_parser.add_argument("baseline")
+    compare_parser.add_argument("current")
+
+    args = parser.parse_args()
+    if args.command == "compare":
+        regressed = compare(load(args.baseline), load(args.current),
+                            args.confidence, args.min_change)
+        return 1 if regressed else 0
+
+    runner = Runner(args)
+    try:
+        results = runner.run(args.repetitions)
+        with open(args.results, "w") as f:
+            json.dump(results, f, indent=2)
+        logging.info(f"Wrote {args.results}")
+        if not args.baseline:
+            return 0
+        regressed = compare(load(args.baseline), results, args.confidence,
+                            args.min_change)
+        if regressed and args.profile:
+            runner.profile(regressed)
+        return 1 if regressed else 0
+    finally:
+        runner.cleanup()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,116 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+//
+// Replays a trace of the requests of a cloud file system (see
+// CloudFileSystemOptions::request_trace_file) in front of simulated caches
+// and readahead, and prints the requests and the latency each combination
+// of the given settings would have had.
+#if !defined(GFLAGS) || defined(ROCKSDB_LITE)
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else  // GFLAGS
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include "cloud/cloud_request_tracer.h"
+#include "rocksdb/file_system.h"
+#include "util/gflags_compat.h"
+#include "util/string_util.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(trace_file, "", "The trace of cloud requests to replay.");
+DEFINE_string(cache_sizes, "0",
+              "Comma-separated capacities of the simulated file cache, "
+              "0 for none. Sizes take a K, M, G or T suffix.");
+DEFINE_uint64(cache_extent_size, 1 << 20,
+              "The extent size of the simulated file cache.");
+DEFINE_string(readahead_sizes, "0",
+              "Comma-separated readahead sizes to simulate, 0 for none.");
+DEFINE_string(metadata_cache_ttl_micros, "0",
+              "Comma-separated TTLs of the simulated metadata cache, 0 for "
+              "none.");
+DEFINE_uint64(metadata_cache_capacity, 100000,
+              "The capacity in objects of the simulated metadata cache.");
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+std::vector<uint64_t> ParseList(const std::string& flag,
+                                const std::string& value) {
+  std::vector<uint64_t> result;
+  for (const auto& item : StringSplit(value, ',')) {
+    try {
+      result.push_back(ParseUint64(item));
+    } catch (const std::exception&) {
+      fprintf(stderr, "Invalid value '%s' in --%s\n", item.c_str(),
+              flag.c_str());
+      exit(1);
+    }
+  }
+  return result;
+}
+
+int cloud_trace_analyzer(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --trace_file=<trace> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_trace_file.empty()) {
+    fprintf(stderr, "--trace_file is required\n");
+    return 1;
+  }
+  auto cache_sizes = ParseList("cache_sizes", FLAGS_cache_sizes);
+  auto readahead_sizes = ParseList("readahead_sizes", FLAGS_readahead_sizes);
+  auto metadata_ttls =
+      ParseList("metadata_cache_ttl_micros", FLAGS_metadata_cache_ttl_micros);
+
+  std::vector<CloudRequestTraceRecord> records;
+  auto st = CloudRequestTracer::ReadTrace(FileSystem::Default(),
+                                          FLAGS_trace_file, &records);
+  if (!st.ok()) {
+    fprintf(stderr, "Cannot read %s: %s\n", FLAGS_trace_file.c_str(),
+            st.ToString().c_str());
+    return 1;
+  }
+  CloudRequestSimulator simulator(std::move(records));
+  const auto& trace = simulator.GetTraceStats();
+  fprintf(stdout, "trace: %s\n", trace.ToString().c_str());
+
+  CloudRequestSimulationOptions options;
+  options.cache_extent_size = FLAGS_cache_extent_size;
+  options.metadata_cache_capacity =
+      static_cast<size_t>(FLAGS_metadata_cache_capacity);
+  for (auto cache_size : cache_sizes) {
+    for (auto readahead_size : readahead_sizes) {
+      for (auto metadata_ttl : metadata_ttls) {
+        options.cache_size = cache_size;
+        options.readahead_size = readahead_size;
+        options.metadata_cache_ttl_micros = metadata_ttl;
+        auto stats = simulator.Simulate(options);
+        const double saved =
+            trace.TotalRequests() > 0
+                ? 100.0 * (1.0 - static_cast<double>(stats.TotalRequests()) /
+                                     trace.TotalRequests())
+                : 0.0;
+        fprintf(stdout,
+                "cache_size=%" PRIu64 " readahead_size=%" PRIu64
+                " metadata_cache_ttl_micros=%" PRIu64
+                ": %s requests_saved=%.2f%%\n",
+                cache_size, readahead_size, metadata_ttl,
+                stats.ToString().c_str(), saved);
+      }
+    }
+  }
+  return 0;
+}
+}  // namespace
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  return ROCKSDB_NAMESPACE::cloud_trace_analyzer(argc, argv);
+}
+#endif  // GFLAGS
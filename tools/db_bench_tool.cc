@@ -32,22 +32,29 @@
 #include <condition_variable>
 #include <cstddef>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <random>
 #include <thread>
 #include <unordered_map>
 
 #include "db/db_impl/db_impl.h"
 #include "db/malloc_stats.h"
 #include "db/version_set.h"
+#include "file/file_util.h"
 #include "monitoring/histogram.h"
 #include "monitoring/statistics_impl.h"
 #include "options/cf_options.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/cache.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/cloud/db_cloud.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
@@ -245,7 +252,18 @@ DEFINE_string(
     "have ever been seen by the thread (or eight initially)\n"
     "\tbackup --  Create a backup of the current DB and verify that a new backup is corrected. "
     "Rate limit can be specified through --backup_rate_limit\n"
-    "\trestore -- Restore the DB from the latest backup available, rate limit can be specified through --restore_rate_limit\n");
+    "\trestore -- Restore the DB from the latest backup available, rate limit can be specified through --restore_rate_limit\n"
+    "\nCloud operations, which require a cloud file system in --fs_uri:\n"
+    "\tcloudopen   -- Close and reopen the DB from its local directory\n"
+    "\tcloudclone  -- Open a clone of the DB from the cloud in an empty "
+    "directory, see --cloud_clone_dir\n"
+    "\tcloudcheckpoint -- Checkpoint the DB to the cloud, see "
+    "--cloud_checkpoint_object\n"
+    "\treadrandomcold -- readrandom after the DB is reopened and the block "
+    "cache emptied. With keep_local_sst_files=false the reads go to the "
+    "cloud\n"
+    "\tcloudpurge  -- Find the obsolete files and dbids of the dest bucket, "
+    "as the purger does\n");
 
 DEFINE_int64(num, 1000000, "Number of key/values to place in database");
 
@@ -347,6 +365,15 @@ DEFINE_int32(user_timestamp_size, 0,
 DEFINE_int32(num_multi_db, 0,
              "Number of DBs used in the benchmark. 0 means single DB.");
 
+DEFINE_double(multi_db_zipf_theta, 0,
+              "With --num_multi_db, the operations pick the i-th DB with a "
+              "probability proportional to 1 / (i + 1)^theta, so that the "
+              "first DBs are the hot tenants. 0 picks the DBs uniformly.");
+
+DEFINE_bool(per_db_latency, false,
+            "With --histogram and --num_multi_db, also report the latency "
+            "percentiles of the operations of each DB, busiest first.");
+
 DEFINE_double(compression_ratio, 0.5,
               "Arrange to generate values that shrink to this fraction of "
               "their original size after compression");
@@ -411,6 +438,23 @@ DEFINE_double(read_random_exp_range, 0.0,
 
 DEFINE_bool(histogram, false, "Print histogram of operation timings");
 
+DEFINE_double(target_qps, 0,
+              "If positive, the operations of each benchmark thread arrive at "
+              "the times of a Poisson process of rate target_qps / threads "
+              "rather than back to back: an operation that completes before "
+              "the arrival of the next waits for it. The latencies of "
+              "--histogram are measured from the arrivals, so that the time "
+              "an operation waits behind a slow one is counted (no "
+              "coordinated omission). The background writers of the "
+              "*whilewriting benchmarks are not paced. Not meant to be "
+              "combined with --benchmark_write_rate_limit or "
+              "--benchmark_read_rate_limit.");
+
+DEFINE_int32(latency_window_seconds, 0,
+             "If positive with --histogram, the percentiles of the latencies "
+             "are also reported for each window of this many seconds of the "
+             "run, by the time the operations started.");
+
 DEFINE_bool(confidence_interval_only, false,
             "Print 95% confidence interval upper and lower bounds only for "
             "aggregate stats.");
@@ -510,6 +554,14 @@ DEFINE_uint64(subcompactions, 1,
 static const bool FLAGS_subcompactions_dummy __attribute__((__unused__)) =
     RegisterFlagValidator(&FLAGS_subcompactions, &ValidateUint32Range);
 
+DEFINE_uint64(subcompaction_ranges_per_thread,
+              ROCKSDB_NAMESPACE::Options().subcompaction_ranges_per_thread,
+              "Number of key ranges a compaction with subcompactions is split "
+              "into per subcompaction thread");
+static const bool FLAGS_subcompaction_ranges_per_thread_dummy
+    __attribute__((__unused__)) = RegisterFlagValidator(
+        &FLAGS_subcompaction_ranges_per_thread, &ValidateUint32Range);
+
 DEFINE_int32(max_background_flushes,
              ROCKSDB_NAMESPACE::Options().max_background_flushes,
              "The maximum number of concurrent background flushes"
@@ -550,6 +602,10 @@ DEFINE_bool(universal_allow_trivial_move, false,
 DEFINE_bool(universal_incremental, false,
             "Enable incremental compactions in universal compaction.");
 
+DEFINE_bool(universal_reserve_threads_for_subcompactions, false,
+            "Split universal compactions into subcompactions run by idle "
+            "background compaction threads.");
+
 DEFINE_int64(cache_size, 32 << 20,  // 32MB
              "Number of bytes to use as a cache of uncompressed data");
 
@@ -701,8 +757,9 @@ DEFINE_bool(block_align,
             "Align data blocks on page size");
 
 DEFINE_int64(prepopulate_block_cache, 0,
-             "Pre-populate hot/warm blocks in block cache. 0 to disable and 1 "
-             "to insert during flush");
+             "Pre-populate hot/warm blocks in block cache. 0 to disable, 1 "
+             "to insert during flush and 2 to also insert the data blocks of "
+             "hot key ranges during compaction");
 
 DEFINE_bool(use_data_block_hash_index, false,
             "if use kDataBlockBinaryAndHash "
@@ -714,6 +771,18 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_key_prefixes,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .data_block_restart_key_prefixes,
+            "Keep the key prefixes of the restart points of the data blocks "
+            "in memory to speed up their seeks");
+
+DEFINE_bool(index_block_restart_key_model,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .index_block_restart_key_model,
+            "Fit a model of the restart keys of the index blocks in memory to "
+            "speed up their seeks");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -721,6 +790,10 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_int64(point_lookup_cache_size, 0,
+             "Number of bytes to use as a cache of the results of Get"
+             " (0 = disabled).");
+
 DEFINE_int32(open_files, ROCKSDB_NAMESPACE::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -734,8 +807,18 @@ DEFINE_uint64(compaction_readahead_size,
               ROCKSDB_NAMESPACE::Options().compaction_readahead_size,
               "Compaction readahead size");
 
+DEFINE_uint64(compaction_input_pipeline_size,
+              ROCKSDB_NAMESPACE::Options().compaction_input_pipeline_size,
+              "Bytes of decoded input that the compaction reader thread may "
+              "run ahead of the merge, 0 to read on the compaction thread");
+
 DEFINE_int32(log_readahead_size, 0, "WAL and manifest readahead size");
 
+DEFINE_uint64(wal_recovery_pipeline_size,
+              ROCKSDB_NAMESPACE::Options().wal_recovery_pipeline_size,
+              "Bytes of WAL records that the recovery reader thread may run "
+              "ahead of the memtable inserts, 0 to read on the opening thread");
+
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
              "Maximum windows randomaccess buffer size");
 
@@ -753,13 +836,31 @@ DEFINE_double(memtable_bloom_size_ratio, 0,
               "filter.");
 DEFINE_bool(memtable_whole_key_filtering, false,
             "Try to use whole key bloom filter in memtables.");
+DEFINE_double(memtable_hash_index_size_ratio, 0,
+              "Ratio of memtable size used for the hash index of point "
+              "lookups. 0 means no hash index.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
+DEFINE_bool(memtable_numa_local_alloc, false,
+            "Allocate memtable memory on the NUMA node of the writing core.");
 
 DEFINE_bool(whole_key_filtering,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().whole_key_filtering,
             "Use whole keys (in addition to prefixes) in SST bloom filter.");
 
+DEFINE_double(range_filter_bits_per_key,
+              ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                  .range_filter_bits_per_key,
+              "If positive, build a range filter in each SST file so that "
+              "bounded seeks skip files with no key in their range. 0 to "
+              "disable.");
+
+DEFINE_bool(block_timestamp_index,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_timestamp_index,
+            "If true, record the smallest user-defined timestamp of each data "
+            "block so that iterators reading at an old timestamp step over "
+            "the blocks holding only newer versions.");
+
 DEFINE_bool(use_existing_db, false,
             "If true, do not destroy the existing database.  If you set this "
             "flag and also specify a benchmark that wants a fresh database, "
@@ -841,6 +942,10 @@ DEFINE_string(wal_compression, "none",
 static enum ROCKSDB_NAMESPACE::CompressionType FLAGS_wal_compression_e =
     ROCKSDB_NAMESPACE::kNoCompression;
 
+DEFINE_uint64(wal_compression_dict_bytes, 0,
+              "Bytes of the records of the previous WAL used as the WAL "
+              "compression dictionary. 0 to disable.");
+
 DEFINE_string(wal_dir, "", "If not empty, use the given dir for WAL");
 
 DEFINE_string(truth_db, "/dev/shm/truth_db/dbbench",
@@ -866,6 +971,11 @@ DEFINE_bool(level_compaction_dynamic_level_bytes, false,
 DEFINE_double(max_bytes_for_level_multiplier, 10,
               "A multiplier to compute max bytes for level-N (N >= 2)");
 
+DEFINE_double(penultimate_level_compaction_trigger,
+              ROCKSDB_NAMESPACE::Options().penultimate_level_compaction_trigger,
+              "Compact the level above the last level into it once its size "
+              "reaches this multiple of its target size");
+
 static std::vector<int> FLAGS_max_bytes_for_level_multiplier_additional_v;
 DEFINE_string(max_bytes_for_level_multiplier_additional, "",
               "A vector that specifies additional fanout per level");
@@ -922,6 +1032,16 @@ DEFINE_bool(optimize_filters_for_hits,
             "a value. For now this doesn't create bloom filters for the max "
             "level of the LSM to reduce metadata that should fit in RAM. ");
 
+DEFINE_double(level_filter_bits_per_key,
+              ROCKSDB_NAMESPACE::Options().level_filter_bits_per_key,
+              "Bits per key of the level filters kept in memory for each "
+              "table file. 0 to disable.");
+
+DEFINE_uint64(filter_memory_budget,
+              ROCKSDB_NAMESPACE::Options().filter_memory_budget,
+              "Approximate bytes of filter blocks the reads use, skipping the "
+              "filters of the deeper levels beyond it. 0 for no budget.");
+
 DEFINE_bool(paranoid_checks, ROCKSDB_NAMESPACE::Options().paranoid_checks,
             "RocksDB will aggressively check consistency of the data.");
 
@@ -1087,6 +1207,12 @@ DEFINE_double(blob_garbage_collection_force_threshold,
               "[Integrated BlobDB] The threshold for the ratio of garbage in "
               "the oldest blob files for forcing garbage collection.");
 
+DEFINE_int32(blob_garbage_collection_force_max_batches,
+             ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
+                 .blob_garbage_collection_force_max_batches,
+             "[Integrated BlobDB] The maximum number of batches of blob files "
+             "targeted by forced garbage collection at a time.");
+
 DEFINE_uint64(blob_compaction_readahead_size,
               ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions()
                   .blob_compaction_readahead_size,
@@ -1252,6 +1378,11 @@ DEFINE_uint64(
     "num_file_reads_for_auto_readahead indicates after how many sequential "
     "reads into that file internal auto prefetching should be start.");
 
+DEFINE_bool(learned_auto_readahead,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().learned_auto_readahead,
+            "Start the implicit readahead of iterators at the size their scans "
+            "of each table file usually read.");
+
 DEFINE_bool(
     auto_readahead_size, false,
     "When set true, RocksDB does auto tuning of readahead size during Scans");
@@ -1366,7 +1497,25 @@ DEFINE_string(env_uri, "",
 DEFINE_string(fs_uri, "",
               "URI for registry Filesystem lookup. Mutually exclusive"
               " with --env_uri."
-              " Creates a default environment with the specified filesystem.");
+              " Creates a default environment with the specified filesystem."
+              " A cloud file system (id=cloud or id=aws) is configured from"
+              " the options of the URI, the DB is then opened as a DBCloud."
+              " For example, id=cloud;provider={id=local;root=/tmp/store};"
+              "src={bucket=b;object=db};dest={bucket=b;object=db}");
+DEFINE_string(cloud_clone_dir, "",
+              "Local directory of the clone that cloudclone opens, removed "
+              "after the benchmark. Defaults to <db>_clone.");
+DEFINE_string(cloud_checkpoint_object, "",
+              "Object path, in the dest bucket, that cloudcheckpoint "
+              "checkpoints to and empties afterwards. Defaults to the object "
+              "path of the DB followed by _checkpoint.");
+DEFINE_int32(cloud_checkpoint_threads,
+             ROCKSDB_NAMESPACE::CheckpointToCloudOptions().thread_count,
+             "Number of threads cloudcheckpoint transfers the files with");
+DEFINE_string(json_results_file, "",
+              "If not empty, one JSON object per benchmark run is appended to "
+              "this file, with its throughput, latency percentiles and "
+              "metrics, for tracking regressions across builds.");
 DEFINE_string(simulate_hybrid_fs_file, "",
               "File for Store Metadata for Simulate hybrid FS. Empty means "
               "disable the feature. Now, if it is set, last_level_temperature "
@@ -1387,6 +1536,21 @@ static std::shared_ptr<ROCKSDB_NAMESPACE::Env> env_guard;
 
 static ROCKSDB_NAMESPACE::Env* FLAGS_env = ROCKSDB_NAMESPACE::Env::Default();
 
+// Returns true if uri configures a CloudFileSystem
+static bool IsCloudFileSystemUri(const std::string& uri) {
+  using ROCKSDB_NAMESPACE::CloudFileSystem;
+  std::string id = uri;
+  if (uri.find('=') != std::string::npos) {
+    std::unordered_map<std::string, std::string> opts;
+    if (!ROCKSDB_NAMESPACE::StringToMap(uri, &opts).ok()) {
+      return false;
+    }
+    auto iter = opts.find("id");
+    id = iter != opts.end() ? iter->second : CloudFileSystem::kCloud();
+  }
+  return id == CloudFileSystem::kCloud() || id == CloudFileSystem::kAws();
+}
+
 DEFINE_int64(stats_interval, 0,
              "Stats are reported every N operations when this is greater than "
              "zero. When 0 the interval grows over time.");
@@ -1431,6 +1595,10 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(pipelined_wal_sync, false,
+            "With pipelined writes, sync the WAL in the memtable writer "
+            "queue");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
@@ -1439,14 +1607,34 @@ DEFINE_bool(
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_uint64(memtable_sorted_insert_threshold,
+              ROCKSDB_NAMESPACE::Options().memtable_sorted_insert_threshold,
+              "Sort the entries of write batches with at least this many "
+              "entries by key before inserting them into the memtable");
+
+DEFINE_bool(memtable_collapse_overwrites, false,
+            "Skip the memtable inserts of the keys overwritten later in the "
+            "same write group");
+
 DEFINE_double(experimental_mempurge_threshold, 0.0,
               "Maximum useful payload ratio estimate that triggers a mempurge "
               "(memtable garbage collection).");
 
+DEFINE_bool(experimental_mempurge_sorted_array, false,
+            "Keep the memtable produced by a mempurge in a sorted array.");
+
+DEFINE_bool(flatten_immutable_memtables, false,
+            "Index each immutable memtable with a sorted array in the "
+            "background.");
+
 DEFINE_bool(inplace_update_support,
             ROCKSDB_NAMESPACE::Options().inplace_update_support,
             "Support in-place memtable update for smaller or same-size values");
 
+DEFINE_bool(inplace_merge_support,
+            ROCKSDB_NAMESPACE::Options().inplace_merge_support,
+            "Fold merge operands into the newest memtable entry of their key");
+
 DEFINE_uint64(inplace_update_num_locks,
               ROCKSDB_NAMESPACE::Options().inplace_update_num_locks,
               "Number of RW locks to protect in-place memtable updates");
@@ -1462,6 +1650,10 @@ DEFINE_uint64(write_thread_slow_yield_usec, 3,
               "The threshold at which a slow yield is considered a signal that "
               "other processes or threads want the core.");
 
+DEFINE_uint64(write_group_linger_usec, 0,
+              "Maximum microseconds the leader of a sync write group waits "
+              "for more writers.");
+
 DEFINE_uint64(rate_limiter_bytes_per_sec, 0, "Set options.rate_limiter value.");
 
 DEFINE_int64(rate_limiter_refill_period_us, 100 * 1000,
@@ -1566,6 +1758,11 @@ DEFINE_uint64(max_compaction_bytes,
               ROCKSDB_NAMESPACE::Options().max_compaction_bytes,
               "Max bytes allowed in one compaction");
 
+DEFINE_bool(compaction_reuse_non_overlapping_files,
+            ROCKSDB_NAMESPACE::Options().compaction_reuse_non_overlapping_files,
+            "Keep the compaction input files that overlap no other input "
+            "instead of rewriting them.");
+
 DEFINE_bool(readonly, false, "Run read only benchmarks.");
 
 DEFINE_bool(print_malloc_stats, false,
@@ -1719,6 +1916,7 @@ DEFINE_bool(report_file_operations, false,
             "if report number of file operations");
 DEFINE_bool(report_open_timing, false, "if report open timing");
 DEFINE_int32(readahead_size, 0, "Iterator readahead size");
+DEFINE_uint64(blob_readahead_size, 0, "Iterator readahead size in blob files");
 
 DEFINE_bool(read_with_latest_user_timestamp, true,
             "If true, always use the current latest timestamp for read. If "
@@ -2168,7 +2366,20 @@ class Stats {
   std::unordered_map<OperationType, std::shared_ptr<HistogramImpl>,
                      std::hash<unsigned char>>
       hist_;
+  // The histograms of each --latency_window_seconds window of the run
+  std::map<uint64_t,
+           std::unordered_map<OperationType, std::shared_ptr<HistogramImpl>,
+                              std::hash<unsigned char>>>
+      window_hist_;
+  // With --per_db_latency, the histogram of the operations of each DB
+  std::unordered_map<DB*, std::shared_ptr<HistogramImpl>> db_hist_;
+  // With --target_qps, the arrival of the next operation and the generator
+  // of the times between arrivals
+  uint64_t next_arrival_;
+  std::mt19937_64 arrival_rng_;
   std::string message_;
+  // Results other than the ops and bytes, such as the size of the DB
+  std::map<std::string, double> metrics_;
   bool exclude_from_merge_;
   ReporterAgent* reporter_agent_;  // does not own
   friend class CombinedStats;
@@ -2193,7 +2404,16 @@ class Stats {
     sine_interval_ = clock_->NowMicros();
     finish_ = start_;
     last_report_finish_ = start_;
+    window_hist_.clear();
+    db_hist_.clear();
+    next_arrival_ = start_;
+    arrival_rng_.seed(static_cast<uint64_t>(seed_base.value_or(0) + id));
+    if (FLAGS_target_qps > 0) {
+      // The first operation arrives now
+      last_op_finish_ = start_;
+    }
     message_.clear();
+    metrics_.clear();
     // When set, stats from this thread won't be merged with others.
     exclude_from_merge_ = false;
   }
@@ -2211,6 +2431,23 @@ class Stats {
         hist_.insert({it->first, it->second});
       }
     }
+    for (const auto& window : other.window_hist_) {
+      auto& hists = window_hist_[window.first];
+      for (const auto& hist : window.second) {
+        auto& this_hist = hists[hist.first];
+        if (!this_hist) {
+          this_hist = std::make_shared<HistogramImpl>();
+        }
+        this_hist->Merge(*hist.second);
+      }
+    }
+    for (const auto& hist : other.db_hist_) {
+      auto& this_hist = db_hist_[hist.first];
+      if (!this_hist) {
+        this_hist = std::make_shared<HistogramImpl>();
+      }
+      this_hist->Merge(*hist.second);
+    }
 
     done_ += other.done_;
     bytes_ += other.bytes_;
@@ -2226,6 +2463,7 @@ class Stats {
     if (message_.empty()) {
       message_ = other.message_;
     }
+    metrics_.insert(other.metrics_.begin(), other.metrics_.end());
   }
 
   void Stop() {
@@ -2235,6 +2473,10 @@ class Stats {
 
   void AddMessage(Slice msg) { AppendWithSpace(&message_, msg); }
 
+  void AddMetric(const std::string& name, double value) {
+    metrics_[name] = value;
+  }
+
   void SetId(int id) { id_ = id; }
   void SetExcludeFromMerge() { exclude_from_merge_ = true; }
 
@@ -2275,6 +2517,10 @@ class Stats {
   uint64_t GetStart() { return start_; }
 
   void ResetLastOpTime() {
+    if (FLAGS_target_qps > 0) {
+      // The latency is measured from the arrival of the operation
+      return;
+    }
     // Set to now to avoid latency from calls to SleepForMicroseconds.
     last_op_finish_ = clock_->NowMicros();
   }
@@ -2284,8 +2530,12 @@ class Stats {
     if (reporter_agent_) {
       reporter_agent_->ReportFinishedOps(num_ops);
     }
+    const bool paced = FLAGS_target_qps > 0 && !exclude_from_merge_;
+    uint64_t now = 0;
+    if (FLAGS_histogram || paced) {
+      now = clock_->NowMicros();
+    }
     if (FLAGS_histogram) {
-      uint64_t now = clock_->NowMicros();
       uint64_t micros = now - last_op_finish_;
 
       if (hist_.find(op_type) == hist_.end()) {
@@ -2293,6 +2543,23 @@ class Stats {
         hist_.insert({op_type, std::move(hist_temp)});
       }
       hist_[op_type]->Add(micros);
+      if (FLAGS_latency_window_seconds > 0) {
+        uint64_t window =
+            (std::max(last_op_finish_, start_) - start_) /
+            (static_cast<uint64_t>(FLAGS_latency_window_seconds) * 1000000);
+        auto& hist = window_hist_[window][op_type];
+        if (!hist) {
+          hist = std::make_shared<HistogramImpl>();
+        }
+        hist->Add(micros);
+      }
+      if (FLAGS_per_db_latency && db != nullptr) {
+        auto& hist = db_hist_[db];
+        if (!hist) {
+          hist = std::make_shared<HistogramImpl>();
+        }
+        hist->Add(micros);
+      }
 
       if (micros >= FLAGS_slow_usecs && !FLAGS_stats_interval) {
         fprintf(stderr, "long op: %" PRIu64 " micros%30s\r", micros, "");
@@ -2300,6 +2567,9 @@ class Stats {
       }
       last_op_finish_ = now;
     }
+    if (paced) {
+      WaitForNextArrival(num_ops, now);
+    }
 
     done_ += num_ops;
     if (done_ >= next_report_ && FLAGS_progress_reports) {
@@ -2405,6 +2675,22 @@ class Stats {
     }
   }
 
+  // Waits for the arrival of the next operation, num_ops arrivals after the
+  // one of the operations just finished, and measures its latency from there
+  void WaitForNextArrival(int64_t num_ops, uint64_t now) {
+    std::exponential_distribution<double> interarrival_micros(
+        FLAGS_target_qps / std::max(FLAGS_threads, 1) / 1e6);
+    for (int64_t i = 0; i < num_ops; i++) {
+      next_arrival_ += static_cast<uint64_t>(interarrival_micros(arrival_rng_));
+    }
+    if (next_arrival_ > now) {
+      clock_->SleepForMicroseconds(static_cast<int>(
+          std::min<uint64_t>(next_arrival_ - now,
+                              std::numeric_limits<int32_t>::max())));
+    }
+    last_op_finish_ = next_arrival_;
+  }
+
   void AddBytes(int64_t n) { bytes_ += n; }
 
   void Report(const Slice& name) {
@@ -2425,6 +2711,12 @@ class Stats {
       extra = rate;
     }
     AppendWithSpace(&extra, message_);
+    for (const auto& metric : metrics_) {
+      char buf[100];
+      snprintf(buf, sizeof(buf), "%s: %.0f", metric.first.c_str(),
+               metric.second);
+      AppendWithSpace(&extra, buf);
+    }
     double throughput = (double)done_ / elapsed;
 
     fprintf(stdout,
@@ -2438,6 +2730,15 @@ class Stats {
                 OperationTypeString[it->first].c_str(),
                 it->second->ToString().c_str());
       }
+      if (!window_hist_.empty()) {
+        ReportWindows();
+      }
+      if (db_hist_.size() > 1) {
+        ReportDBs();
+      }
+    }
+    if (!FLAGS_json_results_file.empty()) {
+      ReportJson(name.ToString(), elapsed, throughput);
     }
     if (FLAGS_report_file_operations) {
       auto* counted_fs =
@@ -2448,6 +2749,83 @@ class Stats {
     }
     fflush(stdout);
   }
+
+ private:
+  void ReportWindows() {
+    fprintf(stdout,
+            "Microseconds per %d second window:\n%8s %-8s %10s %10s %10s "
+            "%10s %10s\n",
+            FLAGS_latency_window_seconds, "window", "op", "count", "p50",
+            "p99", "p99.9", "max");
+    for (const auto& window : window_hist_) {
+      for (const auto& hist : window.second) {
+        fprintf(stdout, "%8" PRIu64 " %-8s %10" PRIu64 " %10.1f %10.1f "
+                "%10.1f %10" PRIu64 "\n",
+                window.first * FLAGS_latency_window_seconds,
+                OperationTypeString[hist.first].c_str(), hist.second->num(),
+                hist.second->Percentile(50), hist.second->Percentile(99),
+                hist.second->Percentile(99.9), hist.second->max());
+      }
+    }
+    fprintf(stdout, "\n");
+  }
+
+  void ReportDBs() {
+    std::vector<std::pair<std::string, HistogramImpl*>> hists;
+    for (const auto& hist : db_hist_) {
+      hists.emplace_back(hist.first->GetName(), hist.second.get());
+    }
+    std::sort(hists.begin(), hists.end(), [](const auto& a, const auto& b) {
+      return a.second->num() > b.second->num();
+    });
+    fprintf(stdout, "Microseconds per DB:\n%10s %10s %10s %10s %10s  %s\n",
+            "count", "p50", "p99", "p99.9", "max", "db");
+    for (const auto& hist : hists) {
+      fprintf(stdout, "%10" PRIu64 " %10.1f %10.1f %10.1f %10" PRIu64 "  %s\n",
+              hist.second->num(), hist.second->Percentile(50),
+              hist.second->Percentile(99), hist.second->Percentile(99.9),
+              hist.second->max(), hist.first.c_str());
+    }
+    fprintf(stdout, "\n");
+  }
+
+  // Appends the results of the run as one line of JSON to
+  // --json_results_file
+  void ReportJson(const std::string& name, double elapsed,
+                  double throughput) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"benchmark\": \"%s\", \"micros_per_op\": %.3f, "
+             "\"ops_per_sec\": %.1f, \"seconds\": %.3f, \"ops\": %" PRIu64
+             ", \"mb_per_sec\": %.3f",
+             name.c_str(), seconds_ * 1e6 / done_, throughput, elapsed, done_,
+             (bytes_ / 1048576.0) / elapsed);
+    std::string json = buf;
+    for (const auto& hist : hist_) {
+      snprintf(buf, sizeof(buf),
+               ", \"%s_latency_micros\": {\"avg\": %.3f, \"p50\": %.3f, "
+               "\"p99\": %.3f, \"p99.9\": %.3f, \"max\": %.3f}",
+               OperationTypeString[hist.first].c_str(), hist.second->Average(),
+               hist.second->Percentile(50), hist.second->Percentile(99),
+               hist.second->Percentile(99.9),
+               static_cast<double>(hist.second->max()));
+      json.append(buf);
+    }
+    for (const auto& metric : metrics_) {
+      snprintf(buf, sizeof(buf), ", \"%s\": %.3f", metric.first.c_str(),
+               metric.second);
+      json.append(buf);
+    }
+    json.append("}\n");
+    FILE* file = fopen(FLAGS_json_results_file.c_str(), "a");
+    if (file == nullptr) {
+      fprintf(stderr, "Cannot open %s for the JSON results\n",
+              FLAGS_json_results_file.c_str());
+      return;
+    }
+    fputs(json.c_str(), file);
+    fclose(file);
+  }
 };
 
 class CombinedStats {
@@ -2711,6 +3089,11 @@ class Benchmark {
   std::shared_ptr<const SliceTransform> prefix_extractor_;
   DBWithColumnFamilies db_;
   std::vector<DBWithColumnFamilies> multi_dbs_;
+  // With a cloud --fs_uri, the Env of each of multi_dbs_, whose file
+  // system keeps the DB under its own object path
+  std::vector<std::unique_ptr<Env>> multi_db_envs_;
+  // With --multi_db_zipf_theta, the cumulative weights of multi_dbs_
+  std::vector<double> multi_db_cdf_;
   int64_t num_;
   int key_size_;
   int user_timestamp_size_;
@@ -3375,6 +3758,35 @@ class Benchmark {
     return base_name + std::to_string(id);
   }
 
+  // A cloud file system from --fs_uri that keeps the id-th of multi_dbs_
+  // under the id-th subpath of the object paths of its buckets, so that the
+  // DBs do not share their CLOUDMANIFEST
+  std::unique_ptr<Env> NewMultiDBCloudEnv(size_t id) {
+    std::unique_ptr<CloudFileSystem> cfs;
+    ConfigOptions config_options;
+    config_options.invoke_prepare_options = false;
+    ExitOnError("Creating the cloud file system",
+                CloudFileSystemEnv::CreateFromString(config_options,
+                                                     FLAGS_fs_uri, &cfs));
+    auto* cloud_options = cfs->GetOptions<CloudFileSystemOptions>();
+    for (auto* bucket :
+         {&cloud_options->src_bucket, &cloud_options->dest_bucket}) {
+      if (bucket->IsValid()) {
+        bucket->SetObjectPath(GetPathForMultiple(bucket->GetObjectPath(), id));
+      }
+    }
+    std::shared_ptr<FileSystem> fs(cfs.release());
+    auto env = CloudFileSystemEnv::NewCompositeEnv(Env::Default(), fs);
+    config_options.invoke_prepare_options = true;
+    config_options.env = env.get();
+    ExitOnError("Preparing the cloud file system",
+                fs->PrepareOptions(config_options));
+    Options tmp;
+    ExitOnError("Validating the cloud file system",
+                fs->ValidateOptions(tmp, tmp));
+    return env;
+  }
+
   void VerifyDBFromDB(std::string& truth_db_name) {
     DBWithColumnFamilies truth_db;
     auto s = DB::OpenForReadOnly(open_options_, truth_db_name, &truth_db.db);
@@ -3450,6 +3862,7 @@ class Benchmark {
           FLAGS_rate_limit_user_ops ? Env::IO_USER : Env::IO_TOTAL;
       read_options_.tailing = FLAGS_use_tailing_iterator;
       read_options_.readahead_size = FLAGS_readahead_size;
+      read_options_.blob_readahead_size = FLAGS_blob_readahead_size;
       read_options_.adaptive_readahead = FLAGS_adaptive_readahead;
       read_options_.async_io = FLAGS_async_io;
       read_options_.optimize_multiget_for_io = FLAGS_optimize_multiget_for_io;
@@ -3459,6 +3872,7 @@ class Benchmark {
       void (Benchmark::*post_process_method)() = nullptr;
 
       bool fresh_db = false;
+      bool cold_reads = false;
       int num_threads = FLAGS_threads;
 
       int num_repeat = 1;
@@ -3732,6 +4146,21 @@ class Benchmark {
         method = &Benchmark::Backup;
       } else if (name == "restore") {
         method = &Benchmark::Restore;
+      } else if (name == "cloudopen") {
+        num_threads = 1;
+        method = &Benchmark::CloudOpen;
+      } else if (name == "cloudclone") {
+        num_threads = 1;
+        method = &Benchmark::CloudClone;
+      } else if (name == "cloudcheckpoint") {
+        num_threads = 1;
+        method = &Benchmark::CloudCheckpoint;
+      } else if (name == "readrandomcold") {
+        cold_reads = true;
+        method = &Benchmark::ReadRandom;
+      } else if (name == "cloudpurge") {
+        num_threads = 1;
+        method = &Benchmark::CloudPurge;
       } else if (!name.empty()) {  // No error message for empty name
         fprintf(stderr, "unknown benchmark '%s'\n", name.c_str());
         ErrorExit();
@@ -3753,6 +4182,9 @@ class Benchmark {
             if (!open_options_.wal_dir.empty()) {
               options.wal_dir = GetPathForMultiple(open_options_.wal_dir, i);
             }
+            if (i < multi_db_envs_.size()) {
+              options.env = multi_db_envs_[i].get();
+            }
             DestroyDB(GetPathForMultiple(FLAGS_db, i), options);
           }
           multi_dbs_.clear();
@@ -3760,6 +4192,11 @@ class Benchmark {
         Open(&open_options_);  // use open_options for the last accessed
       }
 
+      if (method != nullptr && (name.rfind("cloud", 0) == 0 || cold_reads)) {
+        // Fails the benchmark early unless the DB is a DBCloud
+        GetCloudFileSystem();
+      }
+
       if (method != nullptr) {
         fprintf(stdout, "DB path: [%s]\n", FLAGS_db.c_str());
 
@@ -3848,6 +4285,9 @@ class Benchmark {
 
         CombinedStats combined_stats;
         for (int i = 0; i < num_repeat; i++) {
+          if (cold_reads) {
+            DropCloudCaches();
+          }
           Stats stats = RunBenchmark(num_threads, name, method);
           combined_stats.AddStats(stats);
           if (FLAGS_confidence_interval_only) {
@@ -4229,6 +4669,8 @@ class Benchmark {
     options.max_background_jobs = FLAGS_max_background_jobs;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
+    options.subcompaction_ranges_per_thread =
+        static_cast<uint32_t>(FLAGS_subcompaction_ranges_per_thread);
     options.max_background_flushes = FLAGS_max_background_flushes;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
@@ -4239,6 +4681,8 @@ class Benchmark {
         FLAGS_use_direct_io_for_flush_and_compaction;
     options.manual_wal_flush = FLAGS_manual_wal_flush;
     options.wal_compression = FLAGS_wal_compression_e;
+    options.wal_compression_dict_bytes =
+        static_cast<size_t>(FLAGS_wal_compression_dict_bytes);
     options.ttl = FLAGS_fifo_compaction_ttl;
     options.compaction_options_fifo = CompactionOptionsFIFO(
         FLAGS_fifo_compaction_max_table_files_size_mb * 1024 * 1024,
@@ -4256,8 +4700,11 @@ class Benchmark {
       options.info_log = std::make_shared<StderrLogger>();
     }
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
+    options.memtable_numa_local_alloc = FLAGS_memtable_numa_local_alloc;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
+    options.memtable_hash_index_size_ratio =
+        FLAGS_memtable_hash_index_size_ratio;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
       options.memtable_insert_with_hint_prefix_extractor.reset(
           NewCappedPrefixTransform(
@@ -4266,7 +4713,11 @@ class Benchmark {
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.compaction_input_pipeline_size =
+        static_cast<size_t>(FLAGS_compaction_input_pipeline_size);
     options.log_readahead_size = FLAGS_log_readahead_size;
+    options.wal_recovery_pipeline_size =
+        static_cast<size_t>(FLAGS_wal_recovery_pipeline_size);
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
     options.use_fsync = FLAGS_use_fsync;
@@ -4278,6 +4729,8 @@ class Benchmark {
         FLAGS_level_compaction_dynamic_level_bytes;
     options.max_bytes_for_level_multiplier =
         FLAGS_max_bytes_for_level_multiplier;
+    options.penultimate_level_compaction_trigger =
+        FLAGS_penultimate_level_compaction_trigger;
     Status s =
         CreateMemTableRepFactory(config_options, &options.memtable_factory);
     if (!s.ok()) {
@@ -4438,12 +4891,17 @@ class Benchmark {
           FLAGS_enable_index_compression;
       block_based_options.block_align = FLAGS_block_align;
       block_based_options.whole_key_filtering = FLAGS_whole_key_filtering;
+      block_based_options.range_filter_bits_per_key =
+          FLAGS_range_filter_bits_per_key;
+      block_based_options.block_timestamp_index = FLAGS_block_timestamp_index;
       block_based_options.max_auto_readahead_size =
           FLAGS_max_auto_readahead_size;
       block_based_options.initial_auto_readahead_size =
           FLAGS_initial_auto_readahead_size;
       block_based_options.num_file_reads_for_auto_readahead =
           FLAGS_num_file_reads_for_auto_readahead;
+      block_based_options.learned_auto_readahead =
+          FLAGS_learned_auto_readahead;
       BlockBasedTableOptions::PrepopulateBlockCache prepopulate_block_cache =
           block_based_options.prepopulate_block_cache;
       switch (FLAGS_prepopulate_block_cache) {
@@ -4455,6 +4913,10 @@ class Benchmark {
           prepopulate_block_cache =
               BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly;
           break;
+        case 2:
+          prepopulate_block_cache = BlockBasedTableOptions::
+              PrepopulateBlockCache::kFlushAndHotCompaction;
+          break;
         default:
           fprintf(stderr, "Unknown prepopulate block cache mode\n");
       }
@@ -4468,6 +4930,10 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
+      block_based_options.index_block_restart_key_model =
+          FLAGS_index_block_restart_key_model;
       if (FLAGS_read_cache_path != "") {
         Status rc_status;
 
@@ -4598,20 +5064,33 @@ class Benchmark {
     options.delayed_write_rate = FLAGS_delayed_write_rate;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
+    options.memtable_sorted_insert_threshold =
+        static_cast<size_t>(FLAGS_memtable_sorted_insert_threshold);
+    options.memtable_collapse_overwrites = FLAGS_memtable_collapse_overwrites;
     options.experimental_mempurge_threshold =
         FLAGS_experimental_mempurge_threshold;
+    options.experimental_mempurge_sorted_array =
+        FLAGS_experimental_mempurge_sorted_array;
+    options.flatten_immutable_memtables = FLAGS_flatten_immutable_memtables;
     options.inplace_update_support = FLAGS_inplace_update_support;
     options.inplace_update_num_locks = FLAGS_inplace_update_num_locks;
+    options.inplace_merge_support = FLAGS_inplace_merge_support;
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.pipelined_wal_sync = FLAGS_pipelined_wal_sync;
     options.unordered_write = FLAGS_unordered_write;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
+    options.write_group_linger_usec = FLAGS_write_group_linger_usec;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;
     options.max_compaction_bytes = FLAGS_max_compaction_bytes;
+    options.compaction_reuse_non_overlapping_files =
+        FLAGS_compaction_reuse_non_overlapping_files;
     options.disable_auto_compactions = FLAGS_disable_auto_compactions;
     options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
+    options.level_filter_bits_per_key = FLAGS_level_filter_bits_per_key;
+    options.filter_memory_budget = FLAGS_filter_memory_budget;
     options.paranoid_checks = FLAGS_paranoid_checks;
     options.force_consistency_checks = FLAGS_force_consistency_checks;
     options.periodic_compaction_seconds = FLAGS_periodic_compaction_seconds;
@@ -4661,6 +5140,8 @@ class Benchmark {
         FLAGS_universal_allow_trivial_move;
     options.compaction_options_universal.incremental =
         FLAGS_universal_incremental;
+    options.compaction_options_universal.reserve_threads_for_subcompactions =
+        FLAGS_universal_reserve_threads_for_subcompactions;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
@@ -4689,6 +5170,8 @@ class Benchmark {
         FLAGS_blob_garbage_collection_age_cutoff;
     options.blob_garbage_collection_force_threshold =
         FLAGS_blob_garbage_collection_force_threshold;
+    options.blob_garbage_collection_force_max_batches =
+        FLAGS_blob_garbage_collection_force_max_batches;
     options.blob_compaction_readahead_size =
         FLAGS_blob_compaction_readahead_size;
     options.blob_file_starting_level = FLAGS_blob_file_starting_level;
@@ -4760,6 +5243,14 @@ class Benchmark {
       }
     }
 
+    if (options.point_lookup_cache == nullptr &&
+        FLAGS_point_lookup_cache_size) {
+      HyperClockCacheOptions hcc_opts(
+          static_cast<size_t>(FLAGS_point_lookup_cache_size),
+          /*estimated_entry_charge=*/0, FLAGS_cache_numshardbits);
+      options.point_lookup_cache = hcc_opts.MakeSharedCache();
+    }
+
     if (options.env == Env::Default()) {
       options.env = FLAGS_env;
     }
@@ -4805,14 +5296,34 @@ class Benchmark {
     } else {
       multi_dbs_.clear();
       multi_dbs_.resize(FLAGS_num_multi_db);
+      // The DBs share the block cache, the write buffer manager and the
+      // thread pools of the Env
       auto wal_dir = options.wal_dir;
+      auto* env = options.env;
+      if (IsCloudFileSystemUri(FLAGS_fs_uri)) {
+        multi_db_envs_.resize(FLAGS_num_multi_db);
+      }
       for (int i = 0; i < FLAGS_num_multi_db; i++) {
         if (!wal_dir.empty()) {
           options.wal_dir = GetPathForMultiple(wal_dir, i);
         }
+        if (IsCloudFileSystemUri(FLAGS_fs_uri)) {
+          multi_db_envs_[i] = NewMultiDBCloudEnv(i);
+          options.env = multi_db_envs_[i].get();
+        }
         OpenDb(options, GetPathForMultiple(FLAGS_db, i), &multi_dbs_[i]);
       }
       options.wal_dir = wal_dir;
+      options.env = env;
+
+      multi_db_cdf_.clear();
+      if (FLAGS_multi_db_zipf_theta > 0) {
+        double sum = 0;
+        for (int i = 0; i < FLAGS_num_multi_db; i++) {
+          sum += 1.0 / std::pow(i + 1, FLAGS_multi_db_zipf_theta);
+          multi_db_cdf_.push_back(sum);
+        }
+      }
     }
 
     // KeepFilter is a noop filter, this can be used to test compaction filter
@@ -4907,6 +5418,13 @@ class Benchmark {
         if (s.ok()) {
           db->db = ptr;
         }
+      } else if (IsCloudFileSystemUri(FLAGS_fs_uri)) {
+        DBCloud* ptr = nullptr;
+        s = DBCloud::Open(options, db_name, column_families, "", 0, &db->cfh,
+                          &ptr);
+        if (s.ok()) {
+          db->db = ptr;
+        }
       } else {
         s = DB::Open(options, db_name, column_families, &db->cfh, &db->db);
       }
@@ -4979,6 +5497,12 @@ class Benchmark {
             },
             FLAGS_secondary_update_interval, db));
       }
+    } else if (IsCloudFileSystemUri(FLAGS_fs_uri)) {
+      DBCloud* ptr = nullptr;
+      s = DBCloud::Open(options, db_name, "", 0, &ptr);
+      if (s.ok()) {
+        db->db = ptr;
+      }
     } else {
       s = DB::Open(options, db_name, &db->db);
     }
@@ -5063,6 +5587,14 @@ class Benchmark {
   DB* SelectDB(ThreadState* thread) { return SelectDBWithCfh(thread)->db; }
 
   DBWithColumnFamilies* SelectDBWithCfh(ThreadState* thread) {
+    if (db_.db == nullptr && !multi_db_cdf_.empty()) {
+      // A uniform double in [0, 1) from the top 53 bits
+      const double u = (thread->rand.Next() >> 11) * (1.0 / (1ull << 53));
+      auto it = std::upper_bound(multi_db_cdf_.begin(), multi_db_cdf_.end(),
+                                 u * multi_db_cdf_.back());
+      return &multi_dbs_[std::min<size_t>(it - multi_db_cdf_.begin(),
+                                          multi_dbs_.size() - 1)];
+    }
     return SelectDBWithCfh(thread->rand.Next());
   }
 
@@ -8543,6 +9075,150 @@ class Benchmark {
     delete backup_engine;
   }
 
+  // Returns the cloud file system of the DB, exits unless there is one
+  CloudFileSystem* GetCloudFileSystem() {
+    auto* cfs =
+        dynamic_cast<CloudFileSystem*>(FLAGS_env->GetFileSystem().get());
+    if (cfs == nullptr || dynamic_cast<DBCloud*>(db_.db) == nullptr ||
+        FLAGS_num_multi_db > 1) {
+      fprintf(stderr,
+              "Cloud benchmarks require a single DB on a cloud file system, "
+              "see --fs_uri\n");
+      ErrorExit();
+    }
+    return cfs;
+  }
+
+  static uint64_t GetSstFilesSize(DB* db) {
+    uint64_t size = 0;
+    if (!db->GetIntProperty(DB::Properties::kTotalSstFilesSize, &size)) {
+      size = 0;
+    }
+    return size;
+  }
+
+  static void ExitOnError(const char* what, const Status& s) {
+    if (!s.ok()) {
+      fprintf(stderr, "%s failed: %s\n", what, s.ToString().c_str());
+      exit(1);
+    }
+  }
+
+  // Reopens the DB with an empty block cache, for the reads that follow to
+  // be cold: with keep_local_sst_files=false they go to the cloud
+  void DropCloudCaches() {
+    db_.DeleteDBs();
+    if (cache_) {
+      cache_->EraseUnRefEntries();
+    }
+    OpenDb(open_options_, FLAGS_db, &db_);
+  }
+
+  void CloudOpen(ThreadState* thread) {
+    GetCloudFileSystem();
+    thread->stats.AddMetric("db_size_bytes",
+                            static_cast<double>(GetSstFilesSize(db_.db)));
+    auto start = FLAGS_env->NowMicros();
+    db_.DeleteDBs();
+    auto opened = FLAGS_env->NowMicros();
+    OpenDb(open_options_, FLAGS_db, &db_);
+    auto now = FLAGS_env->NowMicros();
+    thread->stats.AddMetric("close_micros",
+                            static_cast<double>(opened - start));
+    thread->stats.AddMetric("open_micros", static_cast<double>(now - opened));
+    thread->stats.FinishedOps(nullptr, db_.db, 1, kOthers);
+  }
+
+  // Opens a clone of the DB, from its dest bucket and without one of its
+  // own, in an empty directory: the cold start of a new replica
+  void CloudClone(ThreadState* thread) {
+    GetCloudFileSystem();
+    if (FLAGS_num_column_families > 1) {
+      fprintf(stderr, "cloudclone supports a single column family\n");
+      ErrorExit();
+    }
+    ExitOnError("Flush", db_.db->Flush(FlushOptions()));
+    thread->stats.AddMetric("db_size_bytes",
+                            static_cast<double>(GetSstFilesSize(db_.db)));
+
+    std::string uri = FLAGS_fs_uri;
+    if (uri.find('=') == std::string::npos) {
+      uri = "id=" + uri;
+    }
+    std::unordered_map<std::string, std::string> opts;
+    ExitOnError("Parsing --fs_uri", StringToMap(uri, &opts));
+    const auto& src = opts.count("dest") > 0 ? opts["dest"] : opts["src"];
+    // Later options override earlier ones
+    uri += ";src={" + src + "};dest={bucket=;object=};run_purger=false";
+    std::unique_ptr<CloudFileSystem> cfs;
+    ConfigOptions config_options;
+    ExitOnError("Creating the clone file system",
+                CloudFileSystemEnv::CreateFromString(config_options, uri,
+                                                     &cfs));
+    auto env = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs.release()));
+    auto dir = FLAGS_cloud_clone_dir.empty() ? FLAGS_db + "_clone"
+                                             : FLAGS_cloud_clone_dir;
+    DestroyDir(Env::Default(), dir).PermitUncheckedError();
+
+    Options options = open_options_;
+    options.env = env.get();
+    options.create_if_missing = true;
+    options.listeners.clear();
+    DBCloud* clone = nullptr;
+    auto start = FLAGS_env->NowMicros();
+    ExitOnError("Opening the clone",
+                DBCloud::Open(options, dir, "", 0, &clone));
+    auto opened = FLAGS_env->NowMicros();
+    thread->stats.AddMetric("open_micros", static_cast<double>(opened - start));
+    thread->stats.FinishedOps(nullptr, clone, 1, kOthers);
+    delete clone;
+    env.reset();
+    DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  }
+
+  void CloudCheckpoint(ThreadState* thread) {
+    auto* cfs = GetCloudFileSystem();
+    auto dest = cfs->GetCloudFileSystemOptions().dest_bucket;
+    if (!dest.IsValid()) {
+      fprintf(stderr, "cloudcheckpoint requires a dest bucket\n");
+      ErrorExit();
+    }
+    dest.SetObjectPath(FLAGS_cloud_checkpoint_object.empty()
+                           ? dest.GetObjectPath() + "_checkpoint"
+                           : FLAGS_cloud_checkpoint_object);
+    CheckpointToCloudOptions options;
+    options.thread_count = FLAGS_cloud_checkpoint_threads;
+    options.flush_memtable = true;
+    auto* db = static_cast<DBCloud*>(db_.db);
+    ExitOnError("Checkpoint", db->CheckpointToCloud(dest, options));
+    thread->stats.AddBytes(static_cast<int64_t>(GetSstFilesSize(db)));
+    thread->stats.FinishedOps(nullptr, db, 1, kOthers);
+    cfs->GetStorageProvider()
+        ->EmptyBucket(dest.GetBucketName(), dest.GetObjectPath())
+        .PermitUncheckedError();
+  }
+
+  // Runs a pass of the purger over the dest bucket, without deleting
+  void CloudPurge(ThreadState* thread) {
+    auto* cfs = dynamic_cast<CloudFileSystemImpl*>(GetCloudFileSystem());
+    if (cfs == nullptr || !cfs->HasDestBucket()) {
+      fprintf(stderr, "cloudpurge requires a dest bucket\n");
+      ErrorExit();
+    }
+    std::vector<std::string> files;
+    std::vector<std::string> dbids;
+    ExitOnError("Finding obsolete files",
+                cfs->FindObsoleteFiles(cfs->GetDestBucketName(), &files));
+    ExitOnError("Finding obsolete dbids",
+                cfs->FindObsoleteDbid(cfs->GetDestBucketName(), &dbids));
+    thread->stats.AddMetric("obsolete_files",
+                            static_cast<double>(files.size()));
+    thread->stats.AddMetric("obsolete_dbids",
+                            static_cast<double>(dbids.size()));
+    thread->stats.FinishedOps(nullptr, db_.db, 1, kOthers);
+  }
+
 };
 
 int db_bench_tool(int argc, char** argv) {
@@ -8612,7 +9288,19 @@ int db_bench_tool(int argc, char** argv) {
     exit(1);
   }
 
-  if (env_opts == 1) {
+  if (env_opts == 1 && IsCloudFileSystemUri(FLAGS_fs_uri)) {
+    std::unique_ptr<CloudFileSystem> cfs;
+    Status s =
+        CloudFileSystemEnv::CreateFromString(config_options, FLAGS_fs_uri, &cfs);
+    if (!s.ok()) {
+      fprintf(stderr, "Failed creating cloud file system: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    env_guard = CloudFileSystemEnv::NewCompositeEnv(
+        Env::Default(), std::shared_ptr<FileSystem>(cfs.release()));
+    FLAGS_env = env_guard.get();
+  } else if (env_opts == 1) {
     Status s = Env::CreateFromUri(config_options, FLAGS_env_uri, FLAGS_fs_uri,
                                   &FLAGS_env, &env_guard);
     if (!s.ok()) {
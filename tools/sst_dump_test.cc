@@ -454,6 +454,44 @@ TEST_F(SSTDumpToolTest, ValidSSTPath) {
   }
 }
 
+TEST_F(SSTDumpToolTest, Threads) {
+  Options opts;
+  opts.env = env();
+  std::string dir = MakeFilePath("threads");
+  ASSERT_OK(opts.env->CreateDirIfMissing(dir));
+  std::vector<std::string> files;
+  for (int i = 0; i < 4; i++) {
+    files.push_back(dir + "/" + std::to_string(i) + ".sst");
+    createSST(opts, files.back());
+  }
+  std::string fake_sst = dir + "/fake_sst.sst";
+  ASSERT_OK(WriteStringToFile(opts.env, "Not an SST file!", fake_sst, false));
+  files.push_back(fake_sst);
+
+  char* usage[5];
+  PopulateCommandArgs(dir, "", usage);
+  snprintf(usage[3], kOptLength, "--threads=3");
+  snprintf(usage[4], kOptLength, "--show_summary");
+  SSTDumpTool tool;
+  for (const auto& command_arg :
+       {"--command=check", "--command=verify", "--command=identify"}) {
+    snprintf(usage[1], kOptLength, "%s", command_arg);
+    ASSERT_TRUE(!tool.Run(5, usage, opts));
+  }
+
+  // Only the fake SST file
+  for (size_t i = 0; i + 1 < files.size(); i++) {
+    ASSERT_OK(opts.env->DeleteFile(files[i]));
+  }
+  ASSERT_TRUE(tool.Run(5, usage, opts));
+  ASSERT_OK(opts.env->DeleteFile(fake_sst));
+  ASSERT_OK(opts.env->DeleteDir(dir));
+
+  for (int i = 0; i < 5; i++) {
+    delete[] usage[i];
+  }
+}
+
 TEST_F(SSTDumpToolTest, RawOutput) {
   Options opts;
   opts.env = env();
@@ -8,9 +8,13 @@
 
 #include <cinttypes>
 #include <iostream>
+#include <mutex>
 
+#include "cloud/filename.h"
 #include "options/options_helper.h"
 #include "port/port.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/utilities/ldb_cmd.h"
 #include "table/sst_file_dumper.h"
@@ -45,7 +49,10 @@ void print_help(bool to_stderr) {
       to_stderr ? stderr : stdout,
       R"(sst_dump --file=<data_dir_OR_sst_file> [--command=check|scan|raw|recompress|identify]
     --file=<data_dir_OR_sst_file>
-      Path to SST file or directory containing SST files
+      Path to SST file or directory containing SST files. With a cloud
+      FileSystem (--fs_uri), cloud://<bucket>/<object path> names an SST
+      object, or the prefix of SST objects, which are read in place with
+      ranged reads instead of being downloaded
 
     --env_uri=<uri of underlying Env>
       URI of underlying Env, mutually exclusive with fs_uri
@@ -93,6 +100,11 @@ void print_help(bool to_stderr) {
       Print table properties after iterating over the file when executing
       check|scan|raw|identify
 
+    --threads=<num>
+      Number of files to check, verify, identify or read the properties of
+      at once. The output is printed in the order of the files. Ignored by
+      the other commands, and with --read_num
+
     --set_block_size=<block_size>
       Can be combined with --command=recompress to set the block size that will
       be used when trying different compression algorithms
@@ -178,6 +190,7 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   std::string compression_level_to_str;
   size_t block_size = 0;
   size_t readahead_size = 2 * 1024 * 1024;
+  int num_threads = 1;
   std::vector<std::pair<CompressionType, const char*>> compression_types;
   uint64_t total_num_files = 0;
   uint64_t total_num_data_blocks = 0;
@@ -237,6 +250,9 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     } else if (ParseIntArg(argv[i], "--readahead_size=",
                            "readahead_size must be numeric", &tmp_val)) {
       readahead_size = static_cast<size_t>(tmp_val);
+    } else if (ParseIntArg(argv[i], "--threads=",
+                           "threads must be numeric", &tmp_val)) {
+      num_threads = static_cast<int>(tmp_val);
     } else if (strncmp(argv[i], "--compression_types=", 20) == 0) {
       std::string compression_types_csv = argv[i] + 20;
       std::istringstream iss(compression_types_csv);
@@ -370,6 +386,8 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   // than Env::Default(), then try to load custom env based on env_uri/fs_uri.
   // Otherwise, the caller is responsible for creating custom env.
   {
+    // The cloud FileSystems, for --fs_uri
+    CloudFileSystemEnv::RegisterCloudObjects();
     ConfigOptions config_options;
     config_options.env = options.env;
     Status s = Env::CreateFromUri(config_options, env_uri, fs_uri, &options.env,
@@ -384,7 +402,30 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
 
   std::vector<std::string> filenames;
   ROCKSDB_NAMESPACE::Env* env = options.env;
-  ROCKSDB_NAMESPACE::Status st = env->GetChildren(dir_or_file, &filenames);
+  ROCKSDB_NAMESPACE::Status st;
+  std::string bucket;
+  std::string object_path;
+  const bool cloud_objects =
+      ParseCloudObjectFilePath(dir_or_file, &bucket, &object_path);
+  if (cloud_objects) {
+    auto cfs = dynamic_cast<CloudFileSystem*>(env->GetFileSystem().get());
+    if (cfs == nullptr) {
+      fprintf(stderr, "%s: cloud objects need a cloud FileSystem (--fs_uri)\n",
+              dir_or_file);
+      return 1;
+    }
+    // The SST objects of a DB are named with their epoch
+    std::vector<std::string> objects;
+    st = cfs->GetStorageProvider()->ListCloudObjects(bucket, object_path,
+                                                     &objects);
+    for (const auto& object : objects) {
+      if (IsSstFile(RemoveEpoch(object))) {
+        filenames.push_back(object);
+      }
+    }
+  } else {
+    st = env->GetChildren(dir_or_file, &filenames);
+  }
   bool dir = true;
   if (!st.ok() || filenames.empty()) {
     // dir_or_file does not exist or does not contain children
@@ -406,25 +447,56 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     dir = false;
   }
 
-  uint64_t total_read = 0;
-  // List of RocksDB SST file without corruption
-  std::vector<std::string> valid_sst_files;
-  for (size_t i = 0; i < filenames.size(); i++) {
-    std::string filename = filenames.at(i);
-    if (filename.length() <= 4 ||
-        filename.rfind(".sst") != filename.length() - 4) {
-      // ignore
-      continue;
+  std::vector<std::string> sst_files;
+  for (const auto& filename : filenames) {
+    if (!dir) {
+      sst_files.push_back(filename);
+    } else if (cloud_objects ||
+               (filename.length() > 4 &&
+                filename.rfind(".sst") == filename.length() - 4)) {
+      sst_files.push_back(std::string(dir_or_file) + "/" + filename);
     }
+  }
+  if (command == "verify") {
+    verify_checksum = true;
+  }
 
-    if (dir) {
-      filename = std::string(dir_or_file) + "/" + filename;
+  auto print_table_properties = [&](const TableProperties* table_properties) {
+    if (show_properties) {
+      fprintf(stdout,
+              "Table Properties:\n"
+              "------------------------------\n"
+              "  %s",
+              table_properties->ToString("\n  ", ": ").c_str());
     }
-
-    if (command == "verify") {
-      verify_checksum = true;
+    total_num_files += 1;
+    total_num_data_blocks += table_properties->num_data_blocks;
+    total_data_block_size += table_properties->data_size;
+    total_index_block_size += table_properties->index_size;
+    total_filter_block_size += table_properties->filter_size;
+    if (show_properties) {
+      fprintf(stdout,
+              "Raw user collected properties\n"
+              "------------------------------\n");
+      for (const auto& kv : table_properties->user_collected_properties) {
+        std::string prop_name = kv.first;
+        std::string prop_val = Slice(kv.second).ToString(true);
+        fprintf(stdout, "  # %s: 0x%s\n", prop_name.c_str(),
+                prop_val.c_str());
+      }
     }
+  };
 
+  uint64_t total_read = 0;
+  // List of RocksDB SST file without corruption
+  std::vector<std::string> valid_sst_files;
+  const bool parallel =
+      num_threads > 1 && sst_files.size() > 1 &&
+      read_num == std::numeric_limits<uint64_t>::max() &&
+      (command == "" || command == "check" || command == "verify" ||
+       command == "identify");
+  for (size_t i = 0; !parallel && i < sst_files.size(); i++) {
+    const std::string& filename = sst_files[i];
     ROCKSDB_NAMESPACE::SstFileDumper dumper(
         options, filename, Temperature::kUnknown, readahead_size,
         verify_checksum, output_hex, decode_blob_index);
@@ -515,32 +587,110 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
         table_properties = table_properties_from_reader.get();
       }
       if (table_properties != nullptr) {
-        if (show_properties) {
-          fprintf(stdout,
-                  "Table Properties:\n"
-                  "------------------------------\n"
-                  "  %s",
-                  table_properties->ToString("\n  ", ": ").c_str());
+        print_table_properties(table_properties);
+      } else {
+        fprintf(stderr, "Reader unexpectedly returned null properties\n");
+      }
+    }
+  }
+
+  if (parallel) {
+    // What one file prints, printed once the files before it are done
+    struct FileResult {
+      bool done = false;
+      bool valid = false;
+      std::string out;
+      std::string err;
+      std::shared_ptr<const TableProperties> table_properties;
+    };
+    std::vector<FileResult> results(sst_files.size());
+    std::mutex mutex;
+    size_t next_file = 0;
+    size_t next_to_print = 0;
+    auto scan_file = [&](const std::string& filename, FileResult* result) {
+      result->out = "Process " + filename + "\n";
+      ROCKSDB_NAMESPACE::SstFileDumper dumper(
+          options, filename, Temperature::kUnknown, readahead_size,
+          verify_checksum, output_hex, decode_blob_index, EnvOptions(),
+          true /* silent */);
+      if (!dumper.getStatus().ok()) {
+        result->err = filename + ": " + dumper.getStatus().ToString() + "\n";
+        return;
+      }
+      result->valid = true;
+      if (command == "verify") {
+        Status s = dumper.VerifyChecksum();
+        if (!s.ok()) {
+          result->err = filename + " is corrupted: " + s.ToString() + "\n";
+        } else {
+          result->out += "The file is ok\n";
+        }
+        return;
+      }
+      if (command != "identify") {
+        Status s = dumper.ReadSequential(
+            false /* print_kv */, read_num, has_from || use_from_as_prefix,
+            from_key, has_to, to_key, use_from_as_prefix);
+        if (!s.ok()) {
+          result->err += filename + ": " + s.ToString() + "\n";
         }
-        total_num_files += 1;
-        total_num_data_blocks += table_properties->num_data_blocks;
-        total_data_block_size += table_properties->data_size;
-        total_index_block_size += table_properties->index_size;
-        total_filter_block_size += table_properties->filter_size;
-        if (show_properties) {
-          fprintf(stdout,
-                  "Raw user collected properties\n"
-                  "------------------------------\n");
-          for (const auto& kv : table_properties->user_collected_properties) {
-            std::string prop_name = kv.first;
-            std::string prop_val = Slice(kv.second).ToString(true);
-            fprintf(stdout, "  # %s: 0x%s\n", prop_name.c_str(),
-                    prop_val.c_str());
+      }
+      if (show_properties || show_summary) {
+        Status s = dumper.ReadTableProperties(&result->table_properties);
+        if (!s.ok()) {
+          result->err += filename + ": " + s.ToString() +
+                         "\nTry to use initial table properties\n";
+          if (dumper.GetInitTableProperties() != nullptr) {
+            result->table_properties = std::make_shared<TableProperties>(
+                *dumper.GetInitTableProperties());
           }
         }
-      } else {
-        fprintf(stderr, "Reader unexpectedly returned null properties\n");
+        if (result->table_properties == nullptr) {
+          result->err += "Reader unexpectedly returned null properties\n";
+        }
       }
+    };
+    auto scan_files = [&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (next_file < sst_files.size()) {
+        size_t i = next_file++;
+        lock.unlock();
+        FileResult result;
+        scan_file(sst_files[i], &result);
+        lock.lock();
+        results[i] = std::move(result);
+        results[i].done = true;
+        for (; next_to_print < results.size() && results[next_to_print].done;
+             next_to_print++) {
+          auto& printed = results[next_to_print];
+          fputs(printed.out.c_str(), stdout);
+          fputs(printed.err.c_str(), stderr);
+          if (printed.valid) {
+            valid_sst_files.push_back(sst_files[next_to_print]);
+            if (valid_sst_files.size() == 1 && command != "verify" &&
+                command != "identify") {
+              fprintf(stdout, "from [%s] to [%s]\n",
+                      ROCKSDB_NAMESPACE::Slice(from_key).ToString(true).c_str(),
+                      ROCKSDB_NAMESPACE::Slice(to_key).ToString(true).c_str());
+            }
+          }
+          if (printed.table_properties != nullptr) {
+            print_table_properties(printed.table_properties.get());
+          }
+          printed = FileResult();
+          printed.done = true;
+        }
+      }
+    };
+    std::vector<port::Thread> threads;
+    size_t max_threads = std::min(sst_files.size(),
+                                  static_cast<size_t>(num_threads));
+    for (size_t i = 1; i < max_threads; i++) {
+      threads.emplace_back(scan_files);
+    }
+    scan_files();
+    for (auto& t : threads) {
+      t.join();
     }
   }
   if (show_summary) {
@@ -28,8 +28,10 @@ int main() {
 #include "table/block_based/filter_policy_internal.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/bloom_impl.h"
 #include "util/gflags_compat.h"
 #include "util/hash.h"
+#include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 
@@ -1078,6 +1080,35 @@ INSTANTIATE_TEST_CASE_P(Full, FullBloomTest,
                         testing::Values(kLegacyBloom, kFastLocalBloom,
                                         kStandard128Ribbon));
 
+// The SIMD query code must agree with the byte-wise probes of AddHash
+TEST(FastLocalBloomTest, ProbesMatchScalar) {
+  Random64 rnd(301);
+  // Two cache lines, so that one is not cache-aligned
+  alignas(64) char data[3 * 64];
+  for (int num_probes = 1; num_probes <= 40; ++num_probes) {
+    SCOPED_TRACE("num_probes=" + std::to_string(num_probes));
+    for (int i = 0; i < 1000; ++i) {
+      const char* line = data + (i % 2 == 0 ? 0 : 64 + 7);
+      for (auto& byte : data) {
+        // Dense enough for some hashes to match
+        byte = static_cast<char>(rnd.Next() | rnd.Next() | rnd.Next());
+      }
+      const uint32_t h2 = static_cast<uint32_t>(rnd.Next());
+      bool expected = true;
+      uint32_t h = h2;
+      for (int p = 0; p < num_probes; ++p, h *= uint32_t{0x9e3779b9}) {
+        const uint32_t bitpos = h >> (32 - 9);
+        if ((static_cast<uint8_t>(line[bitpos >> 3]) &
+             (1U << (bitpos & 7))) == 0) {
+          expected = false;
+        }
+      }
+      ASSERT_EQ(expected, FastLocalBloomImpl::HashMayMatchPrepared(
+                              h2, num_probes, line));
+    }
+  }
+}
+
 static double GetEffectiveBitsPerKey(FilterBitsBuilder* builder) {
   union {
     uint64_t key_value = 0;
@@ -7,17 +7,91 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Whether blocks of `type` start with the uncompressed size, which the
+// accelerator needs, with the given compress_format_version
+bool HasDecompressedSizeInfo(CompressionType type,
+                             uint32_t compress_format_version) {
+  if (compress_format_version != 2) {
+    return false;
+  }
+  switch (type) {
+    case kZlibCompression:
+    case kBZip2Compression:
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace
+
+bool AcceleratedCompressData(CompressionAccelerator* accelerator,
+                             const Slice& raw,
+                             const CompressionInfo& compression_info,
+                             uint32_t compress_format_version,
+                             std::string* compressed_output) {
+  assert(accelerator != nullptr);
+  assert(compressed_output->empty());
+  const CompressionType type = compression_info.type();
+  if (!HasDecompressedSizeInfo(type, compress_format_version) ||
+      !compression_info.dict().GetRawDict().empty() ||
+      raw.size() > std::numeric_limits<uint32_t>::max() ||
+      !accelerator->Supports(type)) {
+    return false;
+  }
+  compression::PutDecompressedSizeInfo(compressed_output,
+                                       static_cast<uint32_t>(raw.size()));
+  Status s = accelerator->Compress(type, compression_info.options(), raw,
+                                   compressed_output);
+  if (!s.ok()) {
+    compressed_output->clear();
+    return false;
+  }
+  return true;
+}
+
+CacheAllocationPtr AcceleratedUncompressData(
+    CompressionAccelerator* accelerator,
+    const UncompressionInfo& uncompression_info, const char* data, size_t n,
+    size_t* uncompressed_size, uint32_t compress_format_version,
+    MemoryAllocator* allocator) {
+  assert(accelerator != nullptr);
+  const CompressionType type = uncompression_info.type();
+  if (!HasDecompressedSizeInfo(type, compress_format_version) ||
+      !uncompression_info.dict().GetRawDict().empty() ||
+      !accelerator->Supports(type)) {
+    return CacheAllocationPtr();
+  }
+  uint32_t output_len = 0;
+  if (!compression::GetDecompressedSizeInfo(&data, &n, &output_len)) {
+    return CacheAllocationPtr();
+  }
+  CacheAllocationPtr output = AllocateBlock(output_len, allocator);
+  Status s = accelerator->Uncompress(type, Slice(data, n), output.get(),
+                                     output_len);
+  if (!s.ok()) {
+    return CacheAllocationPtr();
+  }
+  *uncompressed_size = output_len;
+  return output;
+}
+
 StreamingCompress* StreamingCompress::Create(CompressionType compression_type,
                                              const CompressionOptions& opts,
                                              uint32_t compress_format_version,
-                                             size_t max_output_len) {
+                                             size_t max_output_len,
+                                             const Slice& dict) {
   switch (compression_type) {
     case kZSTD: {
       if (!ZSTD_Streaming_Supported()) {
         return nullptr;
       }
       return new ZSTDStreamingCompress(opts, compress_format_version,
-                                       max_output_len);
+                                       max_output_len, dict);
     }
     default:
       return nullptr;
@@ -26,14 +100,14 @@ StreamingCompress* StreamingCompress::Create(CompressionType compression_type,
 
 StreamingUncompress* StreamingUncompress::Create(
     CompressionType compression_type, uint32_t compress_format_version,
-    size_t max_output_len) {
+    size_t max_output_len, const Slice& dict) {
   switch (compression_type) {
     case kZSTD: {
       if (!ZSTD_Streaming_Supported()) {
         return nullptr;
       }
       return new ZSTDStreamingUncompress(compress_format_version,
-                                         max_output_len);
+                                         max_output_len, dict);
     }
     default:
       return nullptr;
@@ -21,6 +21,7 @@
 #include <string>
 
 #include "memory/memory_allocator_impl.h"
+#include "rocksdb/compression_accelerator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
 #include "table/block_based/block_type.h"
@@ -1620,6 +1621,22 @@ inline std::string ZSTD_FinalizeDictionary(
 #endif  // ZSTD_VERSION_NUMBER >= 10405
 }
 
+// Returns the compression dictionary built from `samples` of data blocks as
+// configured by `opts`: trained or finalized by ZSTD if
+// `opts.zstd_max_train_bytes` > 0, or else the raw samples.
+inline std::string BuildCompressionDict(std::string&& samples,
+                                        const std::vector<size_t>& sample_lens,
+                                        const CompressionOptions& opts) {
+  if (opts.zstd_max_train_bytes == 0) {
+    return std::move(samples);
+  }
+  if (opts.use_zstd_dict_trainer) {
+    return ZSTD_TrainDictionary(samples, sample_lens, opts.max_dict_bytes);
+  }
+  return ZSTD_FinalizeDictionary(samples, sample_lens, opts.max_dict_bytes,
+                                 opts.level);
+}
+
 inline bool CompressData(const Slice& raw,
                          const CompressionInfo& compression_info,
                          uint32_t compress_format_version,
@@ -1700,17 +1717,39 @@ inline CacheAllocationPtr UncompressData(
   }
 }
 
-// Records the compression type for subsequent WAL records.
+// Variants of CompressData() and UncompressData() that offload the codec to
+// `accelerator` and write and read the same blocks. They fail, without any
+// output, whenever the block has to take the software path instead.
+bool AcceleratedCompressData(CompressionAccelerator* accelerator,
+                             const Slice& raw,
+                             const CompressionInfo& compression_info,
+                             uint32_t compress_format_version,
+                             std::string* compressed_output);
+
+CacheAllocationPtr AcceleratedUncompressData(
+    CompressionAccelerator* accelerator,
+    const UncompressionInfo& uncompression_info, const char* data, size_t n,
+    size_t* uncompressed_size, uint32_t compress_format_version,
+    MemoryAllocator* allocator = nullptr);
+
+// Records the compression type for subsequent WAL records, and the
+// dictionary they are compressed with, if any.
 class CompressionTypeRecord {
  public:
-  explicit CompressionTypeRecord(CompressionType compression_type)
-      : compression_type_(compression_type) {}
+  explicit CompressionTypeRecord(CompressionType compression_type,
+                                 const Slice& dict = Slice())
+      : compression_type_(compression_type), dict_(dict.ToString()) {}
 
   CompressionType GetCompressionType() const { return compression_type_; }
+  const std::string& GetDictionary() const { return dict_; }
 
   inline void EncodeTo(std::string* dst) const {
     assert(dst != nullptr);
     PutFixed32(dst, compression_type_);
+    // Left out without a dictionary, as written by earlier versions
+    if (!dict_.empty()) {
+      PutLengthPrefixedSlice(dst, dict_);
+    }
   }
 
   inline Status DecodeFrom(Slice* src) {
@@ -1726,16 +1765,24 @@ class CompressionTypeRecord {
       return Status::Corruption(class_name,
                                 "WAL compression type not supported");
     }
+    Slice dict;
+    if (!src->empty() && !GetLengthPrefixedSlice(src, &dict)) {
+      return Status::Corruption(class_name,
+                                "Error decoding WAL compression dictionary");
+    }
     compression_type_ = compression_type;
+    dict_ = dict.ToString();
     return Status::OK();
   }
 
   inline std::string DebugString() const {
-    return "compression_type: " + CompressionTypeToString(compression_type_);
+    return "compression_type: " + CompressionTypeToString(compression_type_) +
+           ", dictionary_size: " + std::to_string(dict_.size());
   }
 
  private:
   CompressionType compression_type_;
+  std::string dict_;
 };
 
 // Base class to implement compression for a stream of buffers.
@@ -1767,11 +1814,14 @@ class StreamingCompress {
   virtual int Compress(const char* input, size_t input_size, char* output,
                        size_t* output_pos) = 0;
   // static method to create object of a class inherited from StreamingCompress
-  // based on the actual compression type.
+  // based on the actual compression type. If dict is not empty, the frames
+  // are compressed with it as a raw content dictionary, and can only be
+  // uncompressed with it.
   static StreamingCompress* Create(CompressionType compression_type,
                                    const CompressionOptions& opts,
                                    uint32_t compress_format_version,
-                                   size_t max_output_len);
+                                   size_t max_output_len,
+                                   const Slice& dict = Slice());
   virtual void Reset() = 0;
 
  protected:
@@ -1809,9 +1859,11 @@ class StreamingUncompress {
   // Returns -1 for errors, remaining input to be processed otherwise.
   virtual int Uncompress(const char* input, size_t input_size, char* output,
                          size_t* output_pos) = 0;
+  // dict is the dictionary the frames were compressed with, if any
   static StreamingUncompress* Create(CompressionType compression_type,
                                      uint32_t compress_format_version,
-                                     size_t max_output_len);
+                                     size_t max_output_len,
+                                     const Slice& dict = Slice());
   virtual void Reset() = 0;
 
  protected:
@@ -1820,11 +1872,23 @@ class StreamingUncompress {
   size_t max_output_len_;
 };
 
+#ifdef ZSTD_ADVANCED
+// Returns dict, without its first byte if ZSTD would take it for a trained
+// dictionary rather than raw content
+inline Slice ZSTD_RawContentDictionary(Slice dict) {
+  if (dict.size() >= 4 && DecodeFixed32(dict.data()) == ZSTD_MAGIC_DICTIONARY) {
+    dict.remove_prefix(1);
+  }
+  return dict;
+}
+#endif
+
 class ZSTDStreamingCompress final : public StreamingCompress {
  public:
   explicit ZSTDStreamingCompress(const CompressionOptions& opts,
                                  uint32_t compress_format_version,
-                                 size_t max_output_len)
+                                 size_t max_output_len,
+                                 const Slice& dict = Slice())
       : StreamingCompress(kZSTD, opts, compress_format_version,
                           max_output_len) {
 #ifdef ZSTD_ADVANCED
@@ -1832,7 +1896,14 @@ class ZSTDStreamingCompress final : public StreamingCompress {
     // Each compressed frame will have a checksum
     ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
     assert(cctx_ != nullptr);
+    if (!dict.empty()) {
+      // Kept across Reset()
+      const Slice raw = ZSTD_RawContentDictionary(dict);
+      ZSTD_CCtx_loadDictionary(cctx_, raw.data(), raw.size());
+    }
     input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+#else
+    (void)dict;
 #endif
   }
   ~ZSTDStreamingCompress() override {
@@ -1852,12 +1923,20 @@ class ZSTDStreamingCompress final : public StreamingCompress {
 class ZSTDStreamingUncompress final : public StreamingUncompress {
  public:
   explicit ZSTDStreamingUncompress(uint32_t compress_format_version,
-                                   size_t max_output_len)
+                                   size_t max_output_len,
+                                   const Slice& dict = Slice())
       : StreamingUncompress(kZSTD, compress_format_version, max_output_len) {
 #ifdef ZSTD_ADVANCED
     dctx_ = ZSTD_createDCtx();
     assert(dctx_ != nullptr);
+    if (!dict.empty()) {
+      // Kept across Reset()
+      const Slice raw = ZSTD_RawContentDictionary(dict);
+      ZSTD_DCtx_loadDictionary(dctx_, raw.data(), raw.size());
+    }
     input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+#else
+    (void)dict;
 #endif
   }
   ~ZSTDStreamingUncompress() override {
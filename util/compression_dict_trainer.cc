@@ -0,0 +1,126 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/compression_dict_trainer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "port/port.h"
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The options a dictionary is built with. Files compressed with different
+// ones do not share dictionaries.
+using DictKey = std::tuple<CompressionType, int /* level */,
+                           uint32_t /* max_dict_bytes */,
+                           uint64_t /* zstd_max_train_bytes */,
+                           bool /* use_zstd_dict_trainer */>;
+
+DictKey MakeDictKey(CompressionType type, const CompressionOptions& opts) {
+  return DictKey(type, opts.level, opts.max_dict_bytes,
+                 opts.zstd_max_train_bytes, opts.use_zstd_dict_trainer);
+}
+
+class CompressionDictTrainerImpl : public CompressionDictTrainer {
+ public:
+  CompressionDictTrainerImpl() : thread_([this]() { BGThread(); }) {}
+
+  ~CompressionDictTrainerImpl() override {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  std::string GetDict(CompressionType type,
+                      const CompressionOptions& opts) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = dicts_.find(MakeDictKey(type, opts));
+    return it != dicts_.end() ? it->second : std::string();
+  }
+
+  void AddSamples(CompressionType type, const CompressionOptions& opts,
+                  std::string&& samples,
+                  std::vector<size_t>&& sample_lens) override {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      Samples& pending = pending_[MakeDictKey(type, opts)];
+      pending.opts = opts;
+      pending.samples = std::move(samples);
+      pending.sample_lens = std::move(sample_lens);
+    }
+    cv_.notify_all();
+  }
+
+  void WaitForTraining() override {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this]() { return pending_.empty() && !training_; });
+  }
+
+  uint64_t GetNumTrained() const override {
+    return num_trained_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Samples {
+    CompressionOptions opts;
+    std::string samples;
+    std::vector<size_t> sample_lens;
+  };
+
+  void BGThread() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+      cv_.wait(lock, [this]() { return shutdown_ || !pending_.empty(); });
+      if (shutdown_) {
+        return;
+      }
+      auto it = pending_.begin();
+      DictKey key = it->first;
+      Samples samples = std::move(it->second);
+      pending_.erase(it);
+      training_ = true;
+      lock.unlock();
+
+      std::string dict = BuildCompressionDict(
+          std::move(samples.samples), samples.sample_lens, samples.opts);
+
+      lock.lock();
+      if (!dict.empty()) {
+        dicts_[key] = std::move(dict);
+        num_trained_.fetch_add(1, std::memory_order_relaxed);
+      }
+      training_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // The latest dictionary trained for each set of options
+  std::map<DictKey, std::string> dicts_;
+  // The latest samples queued for each set of options and not trained from
+  // yet
+  std::map<DictKey, Samples> pending_;
+  bool training_ = false;
+  bool shutdown_ = false;
+  std::atomic<uint64_t> num_trained_{0};
+  port::Thread thread_;
+};
+}  // namespace
+
+std::shared_ptr<CompressionDictTrainer> NewCompressionDictTrainer() {
+  return std::make_shared<CompressionDictTrainerImpl>();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
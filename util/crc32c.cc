@@ -11,6 +11,7 @@
 // four bytes at a time.
 #include "util/crc32c.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <utility>
@@ -1133,6 +1134,38 @@ uint32_t Extend(uint32_t crc, const char* buf, size_t size) {
   return ChosenExtend(crc, buf, size);
 }
 
+void ValueMulti(size_t n, const char* const* data, const size_t* sizes,
+                uint32_t* values) {
+  size_t i = 0;
+#if defined(__SSE4_2__) && (defined(__LP64__) || defined(_WIN64))
+  for (; i + 3 <= n; i += 3) {
+    // The common 8-byte aligned prefix of the three buffers
+    const size_t len =
+        std::min({sizes[i], sizes[i + 1], sizes[i + 2]}) & ~size_t{7};
+    const char* p0 = data[i];
+    const char* p1 = data[i + 1];
+    const char* p2 = data[i + 2];
+    uint64_t crc0 = 0xffffffffu;
+    uint64_t crc1 = 0xffffffffu;
+    uint64_t crc2 = 0xffffffffu;
+    for (size_t off = 0; off < len; off += 8) {
+      crc0 = _mm_crc32_u64(crc0, DecodeFixed64(p0 + off));
+      crc1 = _mm_crc32_u64(crc1, DecodeFixed64(p1 + off));
+      crc2 = _mm_crc32_u64(crc2, DecodeFixed64(p2 + off));
+    }
+    values[i] = Extend(static_cast<uint32_t>(crc0 ^ 0xffffffffu), p0 + len,
+                       sizes[i] - len);
+    values[i + 1] = Extend(static_cast<uint32_t>(crc1 ^ 0xffffffffu),
+                           p1 + len, sizes[i + 1] - len);
+    values[i + 2] = Extend(static_cast<uint32_t>(crc2 ^ 0xffffffffu),
+                           p2 + len, sizes[i + 2] - len);
+  }
+#endif
+  for (; i < n; i++) {
+    values[i] = Value(data[i], sizes[i]);
+  }
+}
+
 // The code for crc32c combine, copied with permission from folly
 
 // Standard galois-field multiply.  The only modification is that a,
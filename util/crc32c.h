@@ -34,6 +34,13 @@ uint32_t Crc32cCombine(uint32_t crc1, uint32_t crc2, size_t crc2len);
 // Return the crc32c of data[0,n-1]
 inline uint32_t Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Stores Value(data[i], sizes[i]) into values[i] for each of the n buffers.
+// With SSE4.2, the buffers are checksummed three at a time, interleaving
+// their crc32 instructions so that their latencies overlap, and without the
+// combining step of the 3-way Extend() of a single buffer.
+void ValueMulti(size_t n, const char* const* data, const size_t* sizes,
+                uint32_t* values);
+
 static const uint32_t kMaskDelta = 0xa282ead8ul;
 
 // Return a masked representation of crc.
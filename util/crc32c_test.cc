@@ -116,6 +116,29 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, ValueMulti) {
+  Random rnd(301);
+  std::vector<std::string> bufs;
+  for (size_t size : {0, 7, 8, 100, 216, 217, 1000, 4096, 5000, 3}) {
+    bufs.push_back(rnd.RandomString(static_cast<int>(size)));
+  }
+  std::vector<const char*> data;
+  std::vector<size_t> sizes;
+  for (const auto& buf : bufs) {
+    data.push_back(buf.data());
+    sizes.push_back(buf.size());
+  }
+  // Each count leaves a different number of buffers past the last group of
+  // three
+  for (size_t n = 0; n <= bufs.size(); n++) {
+    std::vector<uint32_t> values(n);
+    ValueMulti(n, data.data(), sizes.data(), values.data());
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_EQ(values[i], Value(data[i], sizes[i]));
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -26,6 +26,7 @@ int main() {
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/mock_block_based_table.h"
+#include "table/multiget_context.h"
 #include "table/plain/plain_table_bloom.h"
 #include "util/cast_util.h"
 #include "util/gflags_compat.h"
@@ -62,7 +63,9 @@ DEFINE_uint32(vary_key_size_log2_interval, 5,
               "Use same key size 2^n times, then change. Key size varies from "
               "-2 to +2 bytes vs. average, unless n>=30 to fix key size.");
 
-DEFINE_uint32(batch_size, 8, "Number of keys to group in each batch");
+DEFINE_uint32(batch_size, 8,
+              "Number of keys to group in each batch, at most the MultiGet "
+              "batch size");
 
 DEFINE_double(bits_per_key, 10.0, "Bits per key setting for filters");
 
@@ -796,6 +799,16 @@ int main(int argc, char **argv) {
                   " [-quick] [OTHER OPTIONS]...");
   ParseCommandLineFlags(&argc, &argv, true);
 
+  // The batched filter queries use arrays of MultiGet batch size
+  const uint32_t max_batch_size = static_cast<uint32_t>(
+      ROCKSDB_NAMESPACE::MultiGetContext::MAX_BATCH_SIZE);
+  if (FLAGS_batch_size < 1 || FLAGS_batch_size > max_batch_size) {
+    PrintError(("-batch_size must be between 1 and " +
+                std::to_string(max_batch_size))
+                   .c_str());
+    return 1;
+  }
+
   PrintWarnings();
 
   if (FLAGS_legend) {
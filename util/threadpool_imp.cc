@@ -26,6 +26,7 @@
 #include <mutex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "monitoring/thread_status_util.h"
@@ -52,7 +53,9 @@ struct ThreadPoolImpl::Impl {
   int GetBackgroundThreads();
 
   unsigned int GetQueueLen() const {
-    return queue_len_.load(std::memory_order_relaxed);
+    return queue_len_.load(std::memory_order_relaxed) +
+           static_cast<unsigned int>(
+               num_submitted_jobs_.load(std::memory_order_relaxed));
   }
 
   void LowerIOPriority();
@@ -63,13 +66,24 @@ struct ThreadPoolImpl::Impl {
 
   void BGThread(size_t thread_id);
 
+  // Runs a job taken by BGThread(), lowering the priorities of the thread
+  // first if they were lowered for the pool
+  void RunJob(bool* low_io_priority, CpuPriority* current_cpu_priority,
+              const std::function<void()>& func);
+
   void StartBGThreads();
 
   void Submit(std::function<void()>&& schedule,
               std::function<void()>&& unschedule, void* tag);
 
+  void SubmitJob(std::function<void()>&& job);
+
   int UnSchedule(void* arg);
 
+  void SetFairScheduling(bool fair);
+
+  void SetTagWeight(void* tag, uint32_t weight);
+
   void SetHostEnv(Env* env) { env_ = env; }
 
   Env* GetHostEnv() const { return env_; }
@@ -107,6 +121,7 @@ struct ThreadPoolImpl::Impl {
         std::min(std::max(num_waiting_threads_ - reserved_threads_, 0),
                  threads_to_be_reserved);
     reserved_threads_ += reserved_threads_in_success;
+    UpdateBypassMu();
     return reserved_threads_in_success;
   }
 
@@ -116,6 +131,7 @@ struct ThreadPoolImpl::Impl {
     int released_threads_in_success =
         std::min(reserved_threads_, threads_to_be_released);
     reserved_threads_ -= released_threads_in_success;
+    UpdateBypassMu();
     WakeUpAllThreads();
     return released_threads_in_success;
   }
@@ -123,8 +139,24 @@ struct ThreadPoolImpl::Impl {
  private:
   static void BGThreadWrapper(void* arg);
 
-  bool low_io_priority_;
-  CpuPriority cpu_priority_;
+  // Removes the next job to run from the queue and returns its function.
+  // REQUIRES: mu_ held and queue_ not empty
+  std::function<void()> PopJob();
+
+  // Takes a job submitted with SubmitJob(), from the job queue of the thread
+  // first, then from the others. Returns false if there is none.
+  bool TakeSubmittedJob(size_t thread_id, std::function<void()>* job);
+
+  // REQUIRES: mu_ held
+  void UpdateBypassMu() {
+    bypass_mu_.store(!exit_all_threads_ && reserved_threads_ == 0 &&
+                         static_cast<int>(bgthreads_.size()) ==
+                             total_threads_limit_,
+                     std::memory_order_release);
+  }
+
+  std::atomic<bool> low_io_priority_;
+  std::atomic<CpuPriority> cpu_priority_;
   Env::Priority priority_;
   Env* env_;
 
@@ -153,6 +185,47 @@ struct ThreadPoolImpl::Impl {
   using BGQueue = std::deque<BGItem>;
   BGQueue queue_;
 
+  // With fair scheduling, the next job to run is the oldest one of the tag
+  // with the least virtual time, which a job of the tag advances by the
+  // inverse of the tag's weight. A tag whose jobs were all run resumes from
+  // the virtual time of the last job run, so it neither catches up on the
+  // time it was idle nor is penalized for its past.
+  struct TagState {
+    double virtual_time = 0;
+    size_t num_queued = 0;
+  };
+
+  bool fair_;
+  // The virtual time of the last job run
+  double virtual_time_;
+  // The tags with queued jobs, with fair scheduling
+  std::unordered_map<void*, TagState> tag_states_;
+  // The tags whose weight is not 1
+  std::unordered_map<void*, uint32_t> tag_weights_;
+
+  // The jobs submitted with SubmitJob(), which are neither tagged nor
+  // unscheduled, are spread over job queues with their own mutex rather
+  // than queued under mu_, so that submitting and running many short jobs
+  // does not contend on it. A thread of the pool pushes the jobs it submits
+  // to its own job queue and runs the jobs of its own queue first, then
+  // steals from the others. Each queue is FIFO. While all the threads are
+  // started and none is reserved, being terminated or joined (bypass_mu_),
+  // a thread that has run a job takes the next submitted one, and SubmitJob()
+  // queues one, without mu_, which is only taken to wake up a waiting
+  // thread.
+  static constexpr size_t kNumJobQueues = 16;
+  struct ALIGN_AS(CACHE_LINE_SIZE) JobQueue {
+    std::mutex mu;
+    std::deque<std::function<void()>> jobs;
+  };
+  JobQueue job_queues_[kNumJobQueues];
+  std::atomic<size_t> num_submitted_jobs_;
+  std::atomic<size_t> next_job_queue_;
+  // Number of threads waiting on bgsignal_ or about to
+  std::atomic<int> num_sleeping_threads_;
+  // Whether submitted jobs may be queued and taken without mu_
+  std::atomic<bool> bypass_mu_;
+
   std::mutex mu_;
   std::condition_variable bgsignal_;
   std::vector<port::Thread> bgthreads_;
@@ -170,6 +243,12 @@ inline ThreadPoolImpl::Impl::Impl()
       exit_all_threads_(false),
       wait_for_jobs_to_complete_(false),
       queue_(),
+      fair_(false),
+      virtual_time_(0),
+      num_submitted_jobs_(0),
+      next_job_queue_(0),
+      num_sleeping_threads_(0),
+      bypass_mu_(true),
       mu_(),
       bgsignal_(),
       bgthreads_() {}
@@ -187,6 +266,7 @@ void ThreadPoolImpl::Impl::JoinThreads(bool wait_for_jobs_to_complete) {
   total_threads_limit_ = 0;
   reserved_threads_ = 0;
   num_waiting_threads_ = 0;
+  UpdateBypassMu();
 
   lock.unlock();
 
@@ -198,8 +278,10 @@ void ThreadPoolImpl::Impl::JoinThreads(bool wait_for_jobs_to_complete) {
 
   bgthreads_.clear();
 
+  lock.lock();
   exit_all_threads_ = false;
   wait_for_jobs_to_complete_ = false;
+  UpdateBypassMu();
 }
 
 inline void ThreadPoolImpl::Impl::LowerIOPriority() {
@@ -217,6 +299,13 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   CpuPriority current_cpu_priority = CpuPriority::kNormal;
 
   while (true) {
+    std::function<void()> func;
+    if (bypass_mu_.load(std::memory_order_acquire) &&
+        TakeSubmittedJob(thread_id, &func)) {
+      RunJob(&low_io_priority, &current_cpu_priority, func);
+      continue;
+    }
+
     // Wait until there is an item that is ready to run
     std::unique_lock<std::mutex> lock(mu_);
     // Stop waiting if the thread needs to do work or needs to terminate.
@@ -230,17 +319,24 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
     // 2) it is the excessive thread (not the last one)
     // 3) the number of waiting threads is not greater than reserved threads
     // (i.e, no available threads due to full reservation")
+    // num_sleeping_threads_ is increased before num_submitted_jobs_ is read,
+    // so a job submitted without mu_ either is seen here or makes its
+    // submitter take mu_ to wake up the thread.
+    num_sleeping_threads_.fetch_add(1);
     while (!exit_all_threads_ && !IsLastExcessiveThread(thread_id) &&
-           (queue_.empty() || IsExcessiveThread(thread_id) ||
+           ((queue_.empty() && num_submitted_jobs_.load() == 0) ||
+            IsExcessiveThread(thread_id) ||
             num_waiting_threads_ <= reserved_threads_)) {
       bgsignal_.wait(lock);
     }
+    num_sleeping_threads_.fetch_sub(1);
     // Decrease num_waiting_threads_ once the thread is not waiting
     num_waiting_threads_--;
 
     if (exit_all_threads_) {  // mechanism to let BG threads exit safely
 
-      if (!wait_for_jobs_to_complete_ || queue_.empty()) {
+      if (!wait_for_jobs_to_complete_ ||
+          (queue_.empty() && num_submitted_jobs_.load() == 0)) {
         break;
       }
     } else if (IsLastExcessiveThread(thread_id)) {
@@ -252,6 +348,7 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
       auto& terminating_thread = bgthreads_.back();
       terminating_thread.detach();
       bgthreads_.pop_back();
+      UpdateBypassMu();
       if (HasExcessiveThread()) {
         // There is still at least more excessive thread to terminate.
         WakeUpAllThreads();
@@ -262,56 +359,72 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
       break;
     }
 
-    auto func = std::move(queue_.front().function);
-    queue_.pop_front();
-
-    queue_len_.store(static_cast<unsigned int>(queue_.size()),
-                     std::memory_order_relaxed);
-
-    bool decrease_io_priority = (low_io_priority != low_io_priority_);
-    CpuPriority cpu_priority = cpu_priority_;
+    if (!queue_.empty()) {
+      func = PopJob();
+      queue_len_.store(static_cast<unsigned int>(queue_.size()),
+                       std::memory_order_relaxed);
+    } else if (!TakeSubmittedJob(thread_id, &func)) {
+      // Another thread took it first
+      continue;
+    }
     lock.unlock();
 
-    if (cpu_priority < current_cpu_priority) {
-      TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::BeforeSetCpuPriority",
-                               &current_cpu_priority);
-      // 0 means current thread.
-      port::SetCpuPriority(0, cpu_priority);
-      current_cpu_priority = cpu_priority;
-      TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::AfterSetCpuPriority",
-                               &current_cpu_priority);
-    }
+    RunJob(&low_io_priority, &current_cpu_priority, func);
+  }
+}
+
+void ThreadPoolImpl::Impl::RunJob(bool* low_io_priority,
+                                  CpuPriority* current_cpu_priority,
+                                  const std::function<void()>& func) {
+  bool decrease_io_priority =
+      (*low_io_priority != low_io_priority_.load(std::memory_order_relaxed));
+  CpuPriority cpu_priority = cpu_priority_.load(std::memory_order_relaxed);
+
+  if (cpu_priority < *current_cpu_priority) {
+    TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::BeforeSetCpuPriority",
+                             current_cpu_priority);
+    // 0 means current thread.
+    port::SetCpuPriority(0, cpu_priority);
+    *current_cpu_priority = cpu_priority;
+    TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::AfterSetCpuPriority",
+                             current_cpu_priority);
+  }
 
 #ifdef OS_LINUX
-    if (decrease_io_priority) {
+  if (decrease_io_priority) {
 #define IOPRIO_CLASS_SHIFT (13)
 #define IOPRIO_PRIO_VALUE(class, data) (((class) << IOPRIO_CLASS_SHIFT) | data)
-      // Put schedule into IOPRIO_CLASS_IDLE class (lowest)
-      // These system calls only have an effect when used in conjunction
-      // with an I/O scheduler that supports I/O priorities. As at
-      // kernel 2.6.17 the only such scheduler is the Completely
-      // Fair Queuing (CFQ) I/O scheduler.
-      // To change scheduler:
-      //  echo cfq > /sys/block/<device_name>/queue/schedule
-      // Tunables to consider:
-      //  /sys/block/<device_name>/queue/slice_idle
-      //  /sys/block/<device_name>/queue/slice_sync
-      syscall(SYS_ioprio_set, 1,  // IOPRIO_WHO_PROCESS
-              0,                  // current thread
-              IOPRIO_PRIO_VALUE(3, 0));
-      low_io_priority = true;
-    }
+    // Put schedule into IOPRIO_CLASS_IDLE class (lowest)
+    // These system calls only have an effect when used in conjunction
+    // with an I/O scheduler that supports I/O priorities. As at
+    // kernel 2.6.17 the only such scheduler is the Completely
+    // Fair Queuing (CFQ) I/O scheduler.
+    // To change scheduler:
+    //  echo cfq > /sys/block/<device_name>/queue/schedule
+    // Tunables to consider:
+    //  /sys/block/<device_name>/queue/slice_idle
+    //  /sys/block/<device_name>/queue/slice_sync
+    syscall(SYS_ioprio_set, 1,  // IOPRIO_WHO_PROCESS
+            0,                  // current thread
+            IOPRIO_PRIO_VALUE(3, 0));
+    *low_io_priority = true;
+  }
 #else
-    (void)decrease_io_priority;  // avoid 'unused variable' error
+  (void)decrease_io_priority;  // avoid 'unused variable' error
 #endif
 
-    TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::Impl::BGThread:BeforeRun",
-                             &priority_);
+  TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::Impl::BGThread:BeforeRun",
+                           &priority_);
 
-    func();
-  }
+  func();
 }
 
+namespace {
+// The pool of the background thread running, if any, and its id
+thread_local ThreadPoolImpl::Impl* current_pool = nullptr;
+thread_local size_t current_thread_id = 0;
+}  // namespace
+
 // Helper struct for passing arguments when creating threads.
 struct BGThreadMetadata {
   ThreadPoolImpl::Impl* thread_pool_;
@@ -349,6 +462,8 @@ void ThreadPoolImpl::Impl::BGThreadWrapper(void* arg) {
   ThreadStatusUtil::RegisterThread(tp->GetHostEnv(), thread_type);
 #endif
   delete meta;
+  current_pool = tp;
+  current_thread_id = thread_id;
   tp->BGThread(thread_id);
 #ifdef ROCKSDB_USING_THREAD_STATUS
   ThreadStatusUtil::UnregisterThread();
@@ -367,6 +482,7 @@ void ThreadPoolImpl::Impl::SetBackgroundThreadsInternal(int num,
     total_threads_limit_ = std::max(0, num);
     WakeUpAllThreads();
     StartBGThreads();
+    UpdateBypassMu();
   }
 }
 
@@ -398,6 +514,31 @@ void ThreadPoolImpl::Impl::StartBGThreads() {
   }
 }
 
+std::function<void()> ThreadPoolImpl::Impl::PopJob() {
+  assert(!queue_.empty());
+  BGQueue::iterator next = queue_.begin();
+  if (fair_) {
+    TagState* next_state = &tag_states_[next->tag];
+    for (auto it = std::next(queue_.begin()); it != queue_.end(); ++it) {
+      TagState* state = &tag_states_[it->tag];
+      if (state->virtual_time < next_state->virtual_time) {
+        next = it;
+        next_state = state;
+      }
+    }
+    virtual_time_ = next_state->virtual_time;
+    auto weight = tag_weights_.find(next->tag);
+    next_state->virtual_time +=
+        1.0 / (weight == tag_weights_.end() ? 1 : weight->second);
+    if (--next_state->num_queued == 0) {
+      tag_states_.erase(next->tag);
+    }
+  }
+  std::function<void()> func = std::move(next->function);
+  queue_.erase(next);
+  return func;
+}
+
 void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
                                   std::function<void()>&& unschedule,
                                   void* tag) {
@@ -408,6 +549,7 @@ void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
   }
 
   StartBGThreads();
+  UpdateBypassMu();
 
   // Add to priority queue
   queue_.push_back(BGItem());
@@ -416,6 +558,12 @@ void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
   item.tag = tag;
   item.function = std::move(schedule);
   item.unschedFunction = std::move(unschedule);
+  if (fair_) {
+    TagState& state = tag_states_[tag];
+    if (state.num_queued++ == 0) {
+      state.virtual_time = virtual_time_;
+    }
+  }
 
   queue_len_.store(static_cast<unsigned int>(queue_.size()),
                    std::memory_order_relaxed);
@@ -430,6 +578,57 @@ void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
   }
 }
 
+void ThreadPoolImpl::Impl::SubmitJob(std::function<void()>&& job) {
+  if (!bypass_mu_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (exit_all_threads_) {
+      return;
+    }
+    StartBGThreads();
+    UpdateBypassMu();
+  }
+
+  size_t idx = current_pool == this
+                   ? current_thread_id
+                   : next_job_queue_.fetch_add(1, std::memory_order_relaxed);
+  JobQueue& job_queue = job_queues_[idx % kNumJobQueues];
+  {
+    std::lock_guard<std::mutex> lock(job_queue.mu);
+    job_queue.jobs.push_back(std::move(job));
+  }
+  TEST_SYNC_POINT("ThreadPoolImpl::SubmitJob::Enqueue");
+  num_submitted_jobs_.fetch_add(1);
+
+  // Pairs with BGThread() increasing num_sleeping_threads_ before it reads
+  // num_submitted_jobs_
+  if (num_sleeping_threads_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!HasExcessiveThread()) {
+      bgsignal_.notify_one();
+    } else {
+      WakeUpAllThreads();
+    }
+  }
+}
+
+bool ThreadPoolImpl::Impl::TakeSubmittedJob(size_t thread_id,
+                                            std::function<void()>* job) {
+  if (num_submitted_jobs_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumJobQueues; ++i) {
+    JobQueue& job_queue = job_queues_[(thread_id + i) % kNumJobQueues];
+    std::lock_guard<std::mutex> lock(job_queue.mu);
+    if (!job_queue.jobs.empty()) {
+      *job = std::move(job_queue.jobs.front());
+      job_queue.jobs.pop_front();
+      num_submitted_jobs_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
 int ThreadPoolImpl::Impl::UnSchedule(void* arg) {
   int count = 0;
 
@@ -446,6 +645,9 @@ int ThreadPoolImpl::Impl::UnSchedule(void* arg) {
         }
         it = queue_.erase(it);
         count++;
+        if (fair_ && --tag_states_[arg].num_queued == 0) {
+          tag_states_.erase(arg);
+        }
       } else {
         ++it;
       }
@@ -462,6 +664,31 @@ int ThreadPoolImpl::Impl::UnSchedule(void* arg) {
   return count;
 }
 
+void ThreadPoolImpl::Impl::SetFairScheduling(bool fair) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (fair == fair_) {
+    return;
+  }
+  fair_ = fair;
+  tag_states_.clear();
+  if (fair_) {
+    for (const auto& item : queue_) {
+      TagState& state = tag_states_[item.tag];
+      state.virtual_time = virtual_time_;
+      state.num_queued++;
+    }
+  }
+}
+
+void ThreadPoolImpl::Impl::SetTagWeight(void* tag, uint32_t weight) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (weight <= 1) {
+    tag_weights_.erase(tag);
+  } else {
+    tag_weights_[tag] = weight;
+  }
+}
+
 ThreadPoolImpl::ThreadPoolImpl() : impl_(new Impl()) {}
 
 ThreadPoolImpl::~ThreadPoolImpl() = default;
@@ -496,11 +723,11 @@ void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
 
 void ThreadPoolImpl::SubmitJob(const std::function<void()>& job) {
   auto copy(job);
-  impl_->Submit(std::move(copy), std::function<void()>(), nullptr);
+  impl_->SubmitJob(std::move(copy));
 }
 
 void ThreadPoolImpl::SubmitJob(std::function<void()>&& job) {
-  impl_->Submit(std::move(job), std::function<void()>(), nullptr);
+  impl_->SubmitJob(std::move(job));
 }
 
 void ThreadPoolImpl::Schedule(void (*function)(void* arg1), void* arg,
@@ -515,6 +742,14 @@ void ThreadPoolImpl::Schedule(void (*function)(void* arg1), void* arg,
 
 int ThreadPoolImpl::UnSchedule(void* arg) { return impl_->UnSchedule(arg); }
 
+void ThreadPoolImpl::SetFairScheduling(bool fair) {
+  impl_->SetFairScheduling(fair);
+}
+
+void ThreadPoolImpl::SetTagWeight(void* tag, uint32_t weight) {
+  impl_->SetTagWeight(tag, weight);
+}
+
 void ThreadPoolImpl::SetHostEnv(Env* env) { impl_->SetHostEnv(env); }
 
 Env* ThreadPoolImpl::GetHostEnv() const { return impl_->GetHostEnv(); }
@@ -77,6 +77,14 @@ class ThreadPoolImpl : public ThreadPool {
   // if such was given at scheduling time.
   int UnSchedule(void* tag);
 
+  // Run the queued jobs fairly among their tags, in proportion to the
+  // weights of the tags, instead of in the order they were scheduled
+  void SetFairScheduling(bool fair);
+
+  // Set the weight of the jobs scheduled with `tag` for fair scheduling.
+  // The default weight is 1.
+  void SetTagWeight(void* tag, uint32_t weight);
+
   void SetHostEnv(Env* env);
 
   Env* GetHostEnv() const;
@@ -6,7 +6,9 @@
 #pragma once
 
 #include <atomic>
+
 #include "rocksdb/memory_allocator.h"
+#include "rocksdb/memory_tracker.h"
 
 namespace ROCKSDB_NAMESPACE {
 // A memory allocator using new/delete
@@ -100,4 +102,27 @@ class CountedMemoryAllocator : public MemoryAllocatorWrapper {
   std::atomic<uint64_t> allocations_;
   std::atomic<uint64_t> deallocations_;
 };
+
+// A memory allocator that charges the blocks it allocates to a
+// MemoryTracker. The size of each block is kept in a header before it, so
+// that Deallocate() releases what Allocate() charged.
+class TrackingMemoryAllocator : public MemoryAllocatorWrapper {
+ public:
+  // Keeps the blocks returned aligned as the ones of the target
+  static constexpr size_t kHeaderSize = 16;
+
+  TrackingMemoryAllocator(const std::shared_ptr<MemoryAllocator>& t,
+                          MemoryTracker* tracker)
+      : MemoryAllocatorWrapper(t), tracker_(tracker) {}
+  static const char* kClassName() { return "TrackingMemoryAllocator"; }
+  const char* Name() const override { return kClassName(); }
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* /*p*/, size_t allocation_size) const override {
+    return allocation_size;
+  }
+
+ private:
+  MemoryTracker* tracker_;
+};
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,267 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/parallel_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/metadata.h"
+#include "rocksdb/snapshot.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Returns the keys that split [begin, end) into at most max_partitions
+// partitions of about the same size: the smallest keys of some of the SST
+// files of the level that has the most data
+std::vector<std::string> GetPartitionBoundaries(
+    DB* db, ColumnFamilyHandle* column_family, const Slice* begin,
+    const Slice* end, size_t max_partitions) {
+  std::vector<std::string> boundaries;
+  const Comparator* ucmp = column_family->GetComparator();
+  if (max_partitions <= 1 || ucmp->timestamp_size() > 0) {
+    return boundaries;
+  }
+  ColumnFamilyMetaData meta;
+  db->GetColumnFamilyMetaData(column_family, &meta);
+  const LevelMetaData* largest = nullptr;
+  for (const auto& level : meta.levels) {
+    if (largest == nullptr || level.size > largest->size) {
+      largest = &level;
+    }
+  }
+  if (largest == nullptr) {
+    return boundaries;
+  }
+
+  std::vector<std::pair<Slice, uint64_t>> files;
+  uint64_t total_size = 0;
+  for (const auto& file : largest->files) {
+    const Slice key(file.smallestkey);
+    if ((begin == nullptr || ucmp->Compare(key, *begin) > 0) &&
+        (end == nullptr || ucmp->Compare(key, *end) < 0)) {
+      files.emplace_back(key, file.size);
+      total_size += file.size;
+    }
+  }
+  std::sort(files.begin(), files.end(),
+            [ucmp](const std::pair<Slice, uint64_t>& lhs,
+                   const std::pair<Slice, uint64_t>& rhs) {
+              return ucmp->Compare(lhs.first, rhs.first) < 0;
+            });
+
+  // A file starts a partition once the files before it fill the partitions
+  // so far
+  uint64_t size_before = 0;
+  for (const auto& file : files) {
+    if (boundaries.size() + 1 >= max_partitions) {
+      break;
+    }
+    const uint64_t filled =
+        (boundaries.size() + 1) * total_size / max_partitions;
+    if (size_before > 0 && size_before >= filled &&
+        (boundaries.empty() ||
+         ucmp->Compare(boundaries.back(), file.first) < 0)) {
+      boundaries.push_back(file.first.ToString());
+    }
+    size_before += file.second;
+  }
+  return boundaries;
+}
+
+class ParallelScanner {
+ public:
+  ParallelScanner(DB* db, const ReadOptions& read_options,
+                  ColumnFamilyHandle* column_family, const Slice* begin,
+                  const Slice* end, std::vector<std::string> boundaries,
+                  const ParallelScanOptions& options,
+                  const ParallelScanCallback& callback)
+      : db_(db),
+        read_options_(read_options),
+        column_family_(column_family),
+        begin_(begin),
+        end_(end),
+        boundaries_(std::move(boundaries)),
+        options_(options),
+        callback_(callback) {}
+
+  Status Run() {
+    std::vector<std::thread> threads;
+    for (int i = 1; i < options_.threads; i++) {
+      threads.emplace_back([this]() { Work(); });
+    }
+    Work();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return status_;
+  }
+
+ private:
+  size_t NumPartitions() const { return boundaries_.size() + 1; }
+
+  void Work() {
+    while (!stop_) {
+      size_t partition = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Bound the partitions buffered for the ordered callback
+        cv_.wait(lock, [&]() {
+          return stop_ || !options_.ordered ||
+                 next_partition_ >= NumPartitions() ||
+                 next_partition_ <
+                     delivering_ + static_cast<size_t>(options_.threads);
+        });
+        partition = next_partition_++;
+      }
+      if (stop_ || partition >= NumPartitions()) {
+        break;
+      }
+      Scan(partition);
+    }
+  }
+
+  void Scan(size_t partition) {
+    ReadOptions read_options = read_options_;
+    Slice lower, upper;
+    read_options.iterate_lower_bound = begin_;
+    read_options.iterate_upper_bound = end_;
+    if (partition > 0) {
+      lower = boundaries_[partition - 1];
+      read_options.iterate_lower_bound = &lower;
+    }
+    if (partition < boundaries_.size()) {
+      upper = boundaries_[partition];
+      read_options.iterate_upper_bound = &upper;
+    }
+    std::unique_ptr<Iterator> iter(
+        db_->NewIterator(read_options, column_family_));
+    if (read_options.iterate_lower_bound != nullptr) {
+      iter->Seek(*read_options.iterate_lower_bound);
+    } else {
+      iter->SeekToFirst();
+    }
+
+    // The entries of a partition read before its turn in an ordered scan
+    std::vector<std::pair<std::string, std::string>> buffered;
+    bool streaming = !options_.ordered;
+    for (; iter->Valid() && !stop_; iter->Next()) {
+      if (!streaming && delivering_ == partition) {
+        streaming = Deliver(&buffered);
+        if (!streaming) {
+          break;
+        }
+      }
+      if (!streaming) {
+        buffered.emplace_back(iter->key().ToString(),
+                              iter->value().ToString());
+      } else if (!callback_(iter->key(), iter->value())) {
+        Stop(Status::OK());
+        break;
+      }
+    }
+    if (!iter->status().ok()) {
+      Stop(iter->status());
+    }
+    if (!options_.ordered) {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return stop_ || delivering_ == partition; });
+    if (!stop_ && !streaming) {
+      lock.unlock();
+      Deliver(&buffered);
+      lock.lock();
+    }
+    delivering_++;
+    cv_.notify_all();
+  }
+
+  // Passes the buffered entries of the partition being delivered to the
+  // callback. Returns false if the scan stopped.
+  bool Deliver(std::vector<std::pair<std::string, std::string>>* buffered) {
+    for (const auto& entry : *buffered) {
+      if (stop_) {
+        return false;
+      }
+      if (!callback_(entry.first, entry.second)) {
+        Stop(Status::OK());
+        return false;
+      }
+    }
+    buffered->clear();
+    return true;
+  }
+
+  void Stop(const Status& s) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (status_.ok()) {
+      status_ = s;
+    }
+    stop_ = true;
+    cv_.notify_all();
+  }
+
+  DB* const db_;
+  const ReadOptions& read_options_;
+  ColumnFamilyHandle* const column_family_;
+  const Slice* const begin_;
+  const Slice* const end_;
+  const std::vector<std::string> boundaries_;
+  const ParallelScanOptions& options_;
+  const ParallelScanCallback& callback_;
+
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  Status status_;
+  // The next partition to scan
+  size_t next_partition_ = 0;
+  // The partition whose entries go to an ordered callback
+  std::atomic<size_t> delivering_{0};
+};
+}  // namespace
+
+Status ParallelScan(DB* db, const ReadOptions& read_options,
+                    ColumnFamilyHandle* column_family, const Slice* begin,
+                    const Slice* end, const ParallelScanOptions& options,
+                    const ParallelScanCallback& callback) {
+  if (options.threads < 1 || options.max_partitions < 0) {
+    return Status::InvalidArgument("Invalid parallel scan options");
+  }
+  if (column_family == nullptr) {
+    column_family = db->DefaultColumnFamily();
+  }
+  const size_t max_partitions =
+      options.max_partitions > 0
+          ? static_cast<size_t>(options.max_partitions)
+          : static_cast<size_t>(options.threads) * 4;
+
+  // All the partitions read the same snapshot
+  std::unique_ptr<ManagedSnapshot> snapshot;
+  ReadOptions scan_options = read_options;
+  if (scan_options.snapshot == nullptr) {
+    snapshot.reset(new ManagedSnapshot(db));
+    scan_options.snapshot = snapshot->snapshot();
+  }
+
+  ParallelScanner scanner(
+      db, scan_options, column_family, begin, end,
+      GetPartitionBoundaries(db, column_family, begin, end, max_partitions),
+      options, callback);
+  return scanner.Run();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
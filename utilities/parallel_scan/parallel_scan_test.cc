@@ -0,0 +1,121 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/parallel_scan.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ParallelScanTest : public DBTestBase {
+ public:
+  ParallelScanTest()
+      : DBTestBase("parallel_scan_test", /*env_do_fsync=*/false) {}
+
+  // Writes kNumKeys keys over several SST files of the last level, and a few
+  // in the memtable
+  void Load() {
+    Options options = CurrentOptions();
+    options.target_file_size_base = 16 << 10;
+    options.disable_auto_compactions = true;
+    options.num_levels = 2;
+    DestroyAndReopen(options);
+    Random rnd(301);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_GT(NumTableFilesAtLevel(1), 4);
+    for (int i = 0; i < kNumKeys; i += 100) {
+      ASSERT_OK(Put(Key(i), "new"));
+    }
+  }
+
+  static constexpr int kNumKeys = 2000;
+};
+
+TEST_F(ParallelScanTest, Ordered) {
+  Load();
+  const std::string begin = Key(10);
+  const std::string end = Key(1990);
+  const Slice begin_slice(begin), end_slice(end);
+  ParallelScanOptions options;
+  options.threads = 3;
+  options.ordered = true;
+
+  std::vector<std::string> keys;
+  ASSERT_OK(ParallelScan(db_, ReadOptions(), nullptr, &begin_slice,
+                         &end_slice, options,
+                         [&](const Slice& key, const Slice& value) {
+                           keys.push_back(key.ToString());
+                           if (key == Key(100)) {
+                             EXPECT_EQ(value, "new");
+                           }
+                           return true;
+                         }));
+  ASSERT_EQ(keys.size(), 1980u);
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(keys[i], Key(static_cast<int>(i) + 10));
+  }
+
+  // Stopped by the callback
+  keys.clear();
+  ASSERT_OK(ParallelScan(db_, ReadOptions(), nullptr, nullptr, nullptr,
+                         options, [&](const Slice& key, const Slice&) {
+                           keys.push_back(key.ToString());
+                           return keys.size() < 500;
+                         }));
+  ASSERT_EQ(keys.size(), 500u);
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(keys[i], Key(static_cast<int>(i)));
+  }
+}
+
+TEST_F(ParallelScanTest, Unordered) {
+  Load();
+  // Written after the snapshot of the scan
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put(Key(kNumKeys), "after"));
+  ReadOptions read_options;
+  read_options.snapshot = snapshot;
+
+  ParallelScanOptions options;
+  options.threads = 4;
+  std::mutex mutex;
+  std::set<std::string> keys;
+  std::atomic<size_t> num_entries{0};
+  ASSERT_OK(ParallelScan(db_, read_options, nullptr, nullptr, nullptr, options,
+                         [&](const Slice& key, const Slice&) {
+                           num_entries++;
+                           std::lock_guard<std::mutex> lock(mutex);
+                           keys.insert(key.ToString());
+                           return true;
+                         }));
+  ASSERT_EQ(num_entries.load(), static_cast<size_t>(kNumKeys));
+  ASSERT_EQ(keys.size(), static_cast<size_t>(kNumKeys));
+  ASSERT_EQ(*keys.begin(), Key(0));
+  ASSERT_EQ(*keys.rbegin(), Key(kNumKeys - 1));
+  db_->ReleaseSnapshot(snapshot);
+
+  options.threads = 0;
+  ASSERT_TRUE(ParallelScan(db_, ReadOptions(), nullptr, nullptr, nullptr,
+                           options,
+                           [](const Slice&, const Slice&) { return true; })
+                  .IsInvalidArgument());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -45,18 +45,76 @@ struct LockInfo {
 };
 
 struct LockMapStripe {
-  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory) {
+  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory)
+      : mutex_factory(factory) {
     stripe_mutex = factory->AllocateMutex();
     stripe_cv = factory->AllocateCondVar();
     assert(stripe_mutex);
     assert(stripe_cv);
   }
 
+  // Returns the condition variable to wait on for key to be unlocked.
+  // REQUIRES: stripe_mutex is held
+  std::shared_ptr<TransactionDBCondVar> AddKeyWaiter(const std::string& key) {
+    KeyWaiters& waiters = key_waiters[key];
+    if (waiters.num_waiters++ == 0) {
+      if (free_cvs.empty()) {
+        waiters.cv = mutex_factory->AllocateCondVar();
+        assert(waiters.cv);
+      } else {
+        waiters.cv = std::move(free_cvs.back());
+        free_cvs.pop_back();
+      }
+    }
+    return waiters.cv;
+  }
+
+  // REQUIRES: stripe_mutex is held
+  void RemoveKeyWaiter(const std::string& key) {
+    auto it = key_waiters.find(key);
+    assert(it != key_waiters.end());
+    if (--it->second.num_waiters == 0) {
+      // A late notification on a reused condition variable is only a
+      // spurious wakeup, which waiters tolerate
+      free_cvs.push_back(std::move(it->second.cv));
+      key_waiters.erase(it);
+    }
+  }
+
+  // Adds to *cvs the condition variable of the waiters of key, if any.
+  // REQUIRES: stripe_mutex is held
+  void GetKeyWaiters(
+      const std::string& key,
+      autovector<std::shared_ptr<TransactionDBCondVar>>* cvs) const {
+    if (!key_waiters.empty()) {
+      auto it = key_waiters.find(key);
+      if (it != key_waiters.end()) {
+        cvs->push_back(it->second.cv);
+      }
+    }
+  }
+
+  std::shared_ptr<TransactionDBMutexFactory> mutex_factory;
+
   // Mutex must be held before modifying keys map
   std::shared_ptr<TransactionDBMutex> stripe_mutex;
 
-  // Condition Variable per stripe for waiting on a lock
+  // Condition Variable per stripe for waiting on any lock of the stripe,
+  // i.e. when the number of locks is limited
   std::shared_ptr<TransactionDBCondVar> stripe_cv;
+  int num_stripe_waiters = 0;
+
+  // Transactions waiting for a locked key wait on the condition variable of
+  // the key, so that unlocking a key only wakes up its waiters rather than
+  // every waiter of the stripe.
+  struct KeyWaiters {
+    std::shared_ptr<TransactionDBCondVar> cv;
+    int num_waiters = 0;
+  };
+  UnorderedMap<std::string, KeyWaiters> key_waiters;
+
+  // Condition variables of keys that no longer have waiters, for reuse
+  std::vector<std::shared_ptr<TransactionDBCondVar>> free_cvs;
 
   // Locked keys mapped to the info about the transactions that locked them.
   // TODO(agiardullo): Explore performance of other data structures.
@@ -312,18 +370,33 @@ Status PointLockManager::AcquireWithTimeout(
         txn->SetWaitingTxn(wait_ids, column_family_id, &key);
       }
 
+      // Wait for the key to be unlocked, or for any key of the stripe if
+      // the lock limit was reached
+      std::shared_ptr<TransactionDBCondVar> cv;
+      if (wait_ids.size() != 0) {
+        cv = stripe->AddKeyWaiter(key);
+      } else {
+        cv = stripe->stripe_cv;
+        stripe->num_stripe_waiters++;
+      }
+
       TEST_SYNC_POINT("PointLockManager::AcquireWithTimeout:WaitingTxn");
       if (cv_end_time < 0) {
         // Wait indefinitely
-        result = stripe->stripe_cv->Wait(stripe->stripe_mutex);
+        result = cv->Wait(stripe->stripe_mutex);
       } else {
         uint64_t now = env->NowMicros();
         if (static_cast<uint64_t>(cv_end_time) > now) {
-          result = stripe->stripe_cv->WaitFor(stripe->stripe_mutex,
-                                              cv_end_time - now);
+          result = cv->WaitFor(stripe->stripe_mutex, cv_end_time - now);
         }
       }
 
+      if (wait_ids.size() != 0) {
+        stripe->RemoveKeyWaiter(key);
+      } else {
+        stripe->num_stripe_waiters--;
+      }
+
       if (wait_ids.size() != 0) {
         txn->ClearWaitingTxn();
         if (txn->IsDeadlockDetect()) {
@@ -590,12 +663,19 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
   assert(lock_map->lock_map_stripes_.size() > stripe_num);
   LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
+  autovector<std::shared_ptr<TransactionDBCondVar>> cvs;
   stripe->stripe_mutex->Lock().PermitUncheckedError();
   UnLockKey(txn, key, stripe, lock_map, env);
+  stripe->GetKeyWaiters(key, &cvs);
+  if (stripe->num_stripe_waiters > 0) {
+    cvs.push_back(stripe->stripe_cv);
+  }
   stripe->stripe_mutex->UnLock();
 
   // Signal waiting threads to retry locking
-  stripe->stripe_cv->NotifyAll();
+  for (auto& cv : cvs) {
+    cv->NotifyAll();
+  }
 }
 
 void PointLockManager::UnLock(PessimisticTransaction* txn,
@@ -632,16 +712,23 @@ void PointLockManager::UnLock(PessimisticTransaction* txn,
       assert(lock_map->lock_map_stripes_.size() > stripe_num);
       LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
+      autovector<std::shared_ptr<TransactionDBCondVar>> cvs;
       stripe->stripe_mutex->Lock().PermitUncheckedError();
 
       for (const std::string* key : stripe_keys) {
         UnLockKey(txn, *key, stripe, lock_map, env);
+        stripe->GetKeyWaiters(*key, &cvs);
+      }
+      if (stripe->num_stripe_waiters > 0) {
+        cvs.push_back(stripe->stripe_cv);
       }
 
       stripe->stripe_mutex->UnLock();
 
       // Signal waiting threads to retry locking
-      stripe->stripe_cv->NotifyAll();
+      for (auto& cv : cvs) {
+        cv->NotifyAll();
+      }
     }
   }
 }
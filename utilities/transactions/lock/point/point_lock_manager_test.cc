@@ -98,6 +98,73 @@ TEST_F(PointLockManagerTest, UnlockShared) {
   delete txn2;
 }
 
+TEST_F(PointLockManagerTest, UnlockWakesUpOnlyKeyWaiters) {
+  // All the keys are in the same stripe
+  TransactionDBOptions txn_db_opt;
+  txn_db_opt.num_stripes = 1;
+  ResetLocker(txn_db_opt);
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 10000000;
+  auto txn1 = NewTxn(txn_opt);
+  auto txn2 = NewTxn(txn_opt);
+  ASSERT_OK(locker_->TryLock(txn1, 1, "a", env_, true));
+  ASSERT_OK(locker_->TryLock(txn1, 1, "b", env_, true));
+
+  // Counts the waits of txn2 for "a"
+  std::atomic<int> num_waits(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      wait_sync_point_name_, [&](void* /*arg*/) { num_waits++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  port::Thread t([&]() {
+    ASSERT_OK(locker_->TryLock(txn2, 1, "a", env_, true));
+  });
+  while (num_waits.load() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // Unlocking another key of the stripe does not wake up txn2
+  locker_->UnLock(txn1, 1, "b", env_);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(num_waits.load(), 1);
+
+  locker_->UnLock(txn1, 1, "a", env_);
+  t.join();
+  ASSERT_EQ(num_waits.load(), 1);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  locker_->UnLock(txn2, 1, "a", env_);
+  delete txn1;
+  delete txn2;
+}
+
+TEST_F(PointLockManagerTest, UnlockWakesUpLockLimitWaiters) {
+  TransactionDBOptions txn_db_opt;
+  txn_db_opt.num_stripes = 1;
+  txn_db_opt.max_num_locks = 1;
+  ResetLocker(txn_db_opt);
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 10000000;
+  auto txn1 = NewTxn(txn_opt);
+  auto txn2 = NewTxn(txn_opt);
+  ASSERT_OK(locker_->TryLock(txn1, 1, "a", env_, true));
+
+  // txn2 waits for a lock to be released, not for "b"
+  port::Thread t = BlockUntilWaitingTxn(wait_sync_point_name_, [&]() {
+    ASSERT_OK(locker_->TryLock(txn2, 1, "b", env_, true));
+  });
+  locker_->UnLock(txn1, 1, "a", env_);
+  t.join();
+
+  locker_->UnLock(txn2, 1, "b", env_);
+  delete txn1;
+  delete txn2;
+}
+
 // This test doesn't work with Range Lock Manager, because Range Lock Manager
 // doesn't support deadlock_detect_depth.
 
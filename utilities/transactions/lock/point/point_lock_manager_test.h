@@ -66,6 +66,12 @@ class PointLockManagerTest : public testing::Test {
     EXPECT_OK(DestroyDir(env_, db_dir_));
   }
 
+  // Replaces locker_ with a lock manager using txn_opt
+  void ResetLocker(const TransactionDBOptions& txn_opt) {
+    locker_.reset(new PointLockManager(
+        static_cast<PessimisticTransactionDB*>(db_), txn_opt));
+  }
+
   PessimisticTransaction* NewTxn(
       TransactionOptions txn_opt = TransactionOptions()) {
     Transaction* txn = db_->BeginTransaction(WriteOptions(), txn_opt);
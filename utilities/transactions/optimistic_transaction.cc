@@ -17,6 +17,7 @@
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "util/cast_util.h"
 #include "util/defer.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 #include "utilities/transactions/lock/point/point_lock_tracker.h"
 #include "utilities/transactions/optimistic_transaction_db_impl.h"
@@ -97,6 +98,7 @@ Status OptimisticTransaction::CommitWithParallelValidate() {
   assert(txn_db_impl);
   DBImpl* db_impl = static_cast_with_check<DBImpl>(db_->GetRootDB());
   assert(db_impl);
+  OccRecentWrites* recent_writes = txn_db_impl->GetRecentWrites();
   std::set<port::Mutex*> lk_ptrs;
   std::unique_ptr<LockTracker::ColumnFamilyIterator> cf_it(
       tracked_locks_->GetColumnFamilyIterator());
@@ -106,20 +108,32 @@ Status OptimisticTransaction::CommitWithParallelValidate() {
 
     // To avoid the same key(s) contending across CFs or DBs, seed the
     // hash independently.
-    uint64_t seed = reinterpret_cast<uintptr_t>(db_impl) +
-                    uint64_t{0xb83c07fbc6ced699} /*random prime*/ * cf;
+    uint64_t seed = OptimisticTransactionDBImpl::GetKeyHashSeed(db_impl, cf);
 
     std::unique_ptr<LockTracker::KeyIterator> key_it(
         tracked_locks_->GetKeyIterator(cf));
     assert(key_it != nullptr);
     while (key_it->HasNext()) {
-      auto lock_bucket_ptr = &txn_db_impl->GetLockBucket(key_it->Next(), seed);
+      const std::string& key = key_it->Next();
+      auto lock_bucket_ptr = &txn_db_impl->GetLockBucket(key, seed);
       TEST_SYNC_POINT_CALLBACK(
           "OptimisticTransaction::CommitWithParallelValidate::lock_bucket_ptr",
           lock_bucket_ptr);
       lk_ptrs.insert(lock_bucket_ptr);
     }
   }
+  // The hashes of the written keys, to record in recent_writes
+  std::vector<uint64_t> write_key_hashes;
+  if (recent_writes != nullptr) {
+    // The keys written without being tracked must be locked too while the
+    // write is recorded
+    Status s = txn_db_impl->GetWriteBatchKeys(
+        db_impl, GetWriteBatch()->GetWriteBatch(), &lk_ptrs,
+        &write_key_hashes);
+    if (!s.ok()) {
+      return s;
+    }
+  }
   // NOTE: in a single txn, all bucket-locks are taken in ascending order.
   // In this way, txns from different threads all obey this rule so that
   // deadlock can be avoided.
@@ -134,14 +148,51 @@ Status OptimisticTransaction::CommitWithParallelValidate() {
     }
   });
 
-  Status s = TransactionUtil::CheckKeysForConflicts(db_impl, *tracked_locks_,
-                                                    true /* cache_only */);
+  // Check whether a tracked key was written since it was tracked in
+  // recent_writes, if it covers the sequence numbers of all the keys
+  bool use_recent_writes = recent_writes != nullptr;
+  bool recent_write_conflict = false;
+  if (use_recent_writes) {
+    cf_it.reset(tracked_locks_->GetColumnFamilyIterator());
+    while (cf_it->HasNext() && use_recent_writes && !recent_write_conflict) {
+      ColumnFamilyId cf = cf_it->Next();
+      uint64_t seed = OptimisticTransactionDBImpl::GetKeyHashSeed(db_impl, cf);
+      std::unique_ptr<LockTracker::KeyIterator> key_it(
+          tracked_locks_->GetKeyIterator(cf));
+      while (key_it->HasNext()) {
+        const std::string& key = key_it->Next();
+        const SequenceNumber key_seq =
+            tracked_locks_->GetPointLockStatus(cf, key).seq;
+        if (key_seq < recent_writes->floor_seq()) {
+          // Tracked before the table: look up the memtables instead
+          use_recent_writes = false;
+          break;
+        }
+        if (recent_writes->MayHaveWriteAfter(GetSliceNPHash64(key, seed),
+                                             key_seq)) {
+          recent_write_conflict = true;
+          break;
+        }
+      }
+    }
+  }
+  Status s;
+  if (recent_write_conflict) {
+    s = Status::Busy();
+  } else if (!use_recent_writes) {
+    s = TransactionUtil::CheckKeysForConflicts(db_impl, *tracked_locks_,
+                                               true /* cache_only */);
+  }
   if (!s.ok()) {
     return s;
   }
 
-  s = db_impl->Write(write_options_, GetWriteBatch()->GetWriteBatch());
+  WriteBatch* batch = GetWriteBatch()->GetWriteBatch();
+  s = db_impl->Write(write_options_, batch);
   if (s.ok()) {
+    if (recent_writes != nullptr) {
+      txn_db_impl->RecordRecentWrites(db_impl, *batch, write_key_hashes);
+    }
     Clear();
   }
 
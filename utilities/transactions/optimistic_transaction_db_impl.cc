@@ -10,9 +10,12 @@
 #include <vector>
 
 #include "db/db_impl/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "util/defer.h"
+#include "util/hash.h"
 #include "utilities/transactions/optimistic_transaction.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -78,10 +81,22 @@ Status OptimisticTransactionDB::Open(
 
   std::vector<ColumnFamilyDescriptor> column_families_copy = column_families;
 
+  const bool use_recent_writes =
+      occ_options.validate_policy == OccValidationPolicy::kValidateParallel &&
+      occ_options.recent_writes_slots > 0;
+
   // Enable MemTable History if not already enabled
   for (auto& column_family : column_families_copy) {
     ColumnFamilyOptions* options = &column_family.options;
 
+    if (use_recent_writes) {
+      if (options->comparator->timestamp_size() > 0) {
+        return Status::NotSupported(
+            "recent_writes_slots with user-defined timestamps");
+      }
+      // Validation does not look up the memtables
+      continue;
+    }
     if (options->max_write_buffer_size_to_maintain == 0 &&
         options->max_write_buffer_number_to_maintain == 0) {
       // Setting to -1 will set the History size to
@@ -99,6 +114,111 @@ Status OptimisticTransactionDB::Open(
   return s;
 }
 
+Status OptimisticTransactionDBImpl::Write(const WriteOptions& write_opts,
+                                          WriteBatch* batch) {
+  if (batch->HasDeleteRange()) {
+    return Status::NotSupported();
+  }
+  if (!recent_writes_) {
+    return OptimisticTransactionDB::Write(write_opts, batch);
+  }
+
+  // Hold the lock buckets of the keys from the write until it is recorded,
+  // so that validating transactions see either neither or both
+  DBImpl* db_impl = static_cast_with_check<DBImpl>(GetRootDB());
+  std::set<port::Mutex*> lk_ptrs;
+  std::vector<uint64_t> key_hashes;
+  Status s = GetWriteBatchKeys(db_impl, batch, &lk_ptrs, &key_hashes);
+  if (!s.ok()) {
+    return s;
+  }
+  // Locked in ascending order like transactions do
+  for (auto v : lk_ptrs) {
+    v->Lock();
+  }
+  Defer unlocks([&]() {
+    for (auto v : lk_ptrs) {
+      v->Unlock();
+    }
+  });
+  s = OptimisticTransactionDB::Write(write_opts, batch);
+  if (s.ok()) {
+    RecordRecentWrites(db_impl, *batch, key_hashes);
+  }
+  return s;
+}
+
+Status OptimisticTransactionDBImpl::GetWriteBatchKeys(
+    DBImpl* db_impl, WriteBatch* batch, std::set<port::Mutex*>* lk_ptrs,
+    std::vector<uint64_t>* key_hashes) {
+  class Handler : public WriteBatch::Handler {
+   public:
+    Handler(OptimisticTransactionDBImpl* txn_db, DBImpl* db_impl,
+            std::set<port::Mutex*>* lk_ptrs, std::vector<uint64_t>* key_hashes)
+        : txn_db_(txn_db),
+          db_impl_(db_impl),
+          lk_ptrs_(lk_ptrs),
+          key_hashes_(key_hashes) {}
+
+    Status AddKey(uint32_t column_family_id, const Slice& key) {
+      const uint64_t seed = GetKeyHashSeed(db_impl_, column_family_id);
+      lk_ptrs_->insert(&txn_db_->GetLockBucket(key, seed));
+      key_hashes_->push_back(GetSliceNPHash64(key, seed));
+      return Status::OK();
+    }
+
+    Status PutCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& /* unused */) override {
+      return AddKey(column_family_id, key);
+    }
+    Status PutEntityCF(uint32_t column_family_id, const Slice& key,
+                       const Slice& /* unused */) override {
+      return AddKey(column_family_id, key);
+    }
+    Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+      return AddKey(column_family_id, key);
+    }
+    Status SingleDeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+      return AddKey(column_family_id, key);
+    }
+    Status MergeCF(uint32_t column_family_id, const Slice& key,
+                   const Slice& /* unused */) override {
+      return AddKey(column_family_id, key);
+    }
+
+   private:
+    OptimisticTransactionDBImpl* txn_db_;
+    DBImpl* db_impl_;
+    std::set<port::Mutex*>* lk_ptrs_;
+    std::vector<uint64_t>* key_hashes_;
+  };
+
+  Handler handler(this, db_impl, lk_ptrs, key_hashes);
+  return batch->Iterate(&handler);
+}
+
+void OptimisticTransactionDBImpl::RecordRecentWrites(
+    DBImpl* db_impl, const WriteBatch& batch,
+    const std::vector<uint64_t>& key_hashes) {
+  assert(recent_writes_);
+  if (key_hashes.empty()) {
+    return;
+  }
+  // The sequence number of the last key of the batch, which is recorded for
+  // all of them
+  SequenceNumber seq = WriteBatchInternal::Sequence(&batch);
+  if (seq > 0) {
+    seq += WriteBatchInternal::Count(&batch) - 1;
+  } else {
+    // The write did not tell
+    seq = db_impl->GetLatestSequenceNumber();
+  }
+  for (uint64_t key_hash : key_hashes) {
+    recent_writes_->Record(key_hash, seq);
+  }
+}
+
 void OptimisticTransactionDBImpl::ReinitializeTransaction(
     Transaction* txn, const WriteOptions& write_options,
     const OptimisticTransactionOptions& txn_options) {
@@ -6,18 +6,23 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "util/cast_util.h"
+#include "util/fastrange.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class DBImpl;
+
 class OccLockBucketsImplBase : public OccLockBuckets {
  public:
   virtual port::Mutex& GetLockBucket(const Slice& key, uint64_t seed) = 0;
@@ -41,6 +46,48 @@ class OccLockBucketsImpl : public OccLockBucketsImplBase {
   Striped<M> locks_;
 };
 
+// The sequence number of the latest write to the keys hashing to each of a
+// fixed number of slots (see
+// OptimisticTransactionDBOptions::recent_writes_slots). Keys sharing a slot
+// share the largest sequence number, which can only cause false conflicts.
+class OccRecentWrites {
+ public:
+  // The writes up to floor_seq are not recorded
+  OccRecentWrites(size_t slot_count, SequenceNumber floor_seq)
+      : slot_count_(slot_count),
+        floor_seq_(floor_seq),
+        slots_(new std::atomic<SequenceNumber>[slot_count]) {
+    for (size_t i = 0; i < slot_count_; i++) {
+      slots_[i].store(floor_seq_, std::memory_order_relaxed);
+    }
+  }
+
+  // REQUIRES: the lock bucket of the key is held
+  void Record(uint64_t key_hash, SequenceNumber seq) {
+    auto& slot = slots_[FastRange64(key_hash, slot_count_)];
+    SequenceNumber old_seq = slot.load(std::memory_order_relaxed);
+    while (old_seq < seq &&
+           !slot.compare_exchange_weak(old_seq, seq,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  // Returns whether the key may have been written after seq.
+  // REQUIRES: the lock bucket of the key is held, seq >= floor_seq()
+  bool MayHaveWriteAfter(uint64_t key_hash, SequenceNumber seq) const {
+    assert(seq >= floor_seq_);
+    return slots_[FastRange64(key_hash, slot_count_)].load(
+               std::memory_order_relaxed) > seq;
+  }
+
+  SequenceNumber floor_seq() const { return floor_seq_; }
+
+ private:
+  const size_t slot_count_;
+  const SequenceNumber floor_seq_;
+  std::unique_ptr<std::atomic<SequenceNumber>[]> slots_;
+};
+
 class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
  public:
   explicit OptimisticTransactionDBImpl(
@@ -57,6 +104,10 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
       }
       bucketed_locks_ = static_cast_with_check<OccLockBucketsImplBase>(
           std::move(bucketed_locks));
+      if (occ_options.recent_writes_slots > 0) {
+        recent_writes_.reset(new OccRecentWrites(
+            occ_options.recent_writes_slots, db->GetLatestSequenceNumber()));
+      }
     }
   }
 
@@ -81,11 +132,44 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   // Range deletions also must not be snuck into `WriteBatch`es as they are
   // incompatible with `OptimisticTransactionDB`.
-  Status Write(const WriteOptions& write_opts, WriteBatch* batch) override {
-    if (batch->HasDeleteRange()) {
-      return Status::NotSupported();
-    }
-    return OptimisticTransactionDB::Write(write_opts, batch);
+  Status Write(const WriteOptions& write_opts, WriteBatch* batch) override;
+
+  // With a recent writes table, single writes also go through Write() to be
+  // recorded
+  using StackableDB::Put;
+  Status Put(const WriteOptions& options, ColumnFamilyHandle* column_family,
+             const Slice& key, const Slice& val) override {
+    return recent_writes_ ? DB::Put(options, column_family, key, val)
+                          : StackableDB::Put(options, column_family, key, val);
+  }
+  using StackableDB::PutEntity;
+  Status PutEntity(const WriteOptions& options,
+                   ColumnFamilyHandle* column_family, const Slice& key,
+                   const WideColumns& columns) override {
+    return recent_writes_
+               ? DB::PutEntity(options, column_family, key, columns)
+               : StackableDB::PutEntity(options, column_family, key, columns);
+  }
+  using StackableDB::Delete;
+  Status Delete(const WriteOptions& options, ColumnFamilyHandle* column_family,
+                const Slice& key) override {
+    return recent_writes_ ? DB::Delete(options, column_family, key)
+                          : StackableDB::Delete(options, column_family, key);
+  }
+  using StackableDB::SingleDelete;
+  Status SingleDelete(const WriteOptions& options,
+                      ColumnFamilyHandle* column_family,
+                      const Slice& key) override {
+    return recent_writes_
+               ? DB::SingleDelete(options, column_family, key)
+               : StackableDB::SingleDelete(options, column_family, key);
+  }
+  using StackableDB::Merge;
+  Status Merge(const WriteOptions& options, ColumnFamilyHandle* column_family,
+               const Slice& key, const Slice& value) override {
+    return recent_writes_
+               ? DB::Merge(options, column_family, key, value)
+               : StackableDB::Merge(options, column_family, key, value);
   }
 
   OccValidationPolicy GetValidatePolicy() const { return validate_policy_; }
@@ -94,9 +178,34 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
     return bucketed_locks_->GetLockBucket(key, seed);
   }
 
+  // Returns the seed of the hashes of the keys of column family cf in db_impl,
+  // so that the same keys do not contend across column families or DBs
+  static uint64_t GetKeyHashSeed(const DBImpl* db_impl, uint32_t cf) {
+    return reinterpret_cast<uintptr_t>(db_impl) +
+           uint64_t{0xb83c07fbc6ced699} /*random prime*/ * cf;
+  }
+
+  // nullptr unless transactions are validated against a table of the recent
+  // writes (see OptimisticTransactionDBOptions::recent_writes_slots)
+  OccRecentWrites* GetRecentWrites() { return recent_writes_.get(); }
+
+  // Adds to *lk_ptrs the lock buckets of the keys of batch, and to
+  // *key_hashes their hashes, for RecordRecentWrites()
+  Status GetWriteBatchKeys(DBImpl* db_impl, WriteBatch* batch,
+                           std::set<port::Mutex*>* lk_ptrs,
+                           std::vector<uint64_t>* key_hashes);
+
+  // Records in the recent writes table the keys of batch, which was just
+  // written.
+  // REQUIRES: the lock buckets of the keys are held
+  void RecordRecentWrites(DBImpl* db_impl, const WriteBatch& batch,
+                          const std::vector<uint64_t>& key_hashes);
+
  private:
   std::shared_ptr<OccLockBucketsImplBase> bucketed_locks_;
 
+  std::unique_ptr<OccRecentWrites> recent_writes_;
+
   bool db_owner_;
 
   const OccValidationPolicy validate_policy_;
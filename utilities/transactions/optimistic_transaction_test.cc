@@ -395,6 +395,57 @@ TEST_P(OptimisticTransactionTest, FlushTest2) {
   delete txn;
 }
 
+TEST_P(OptimisticTransactionTest, RecentWritesTest) {
+  // Only used with OccValidationPolicy::kValidateParallel
+  const bool use_recent_writes =
+      GetParam() == OccValidationPolicy::kValidateParallel;
+  occ_opts.recent_writes_slots = 1024;
+  Reopen();
+
+  WriteOptions write_options;
+  ReadOptions read_options;
+  std::string value;
+  ASSERT_OK(txn_db->Put(write_options, "foo", "bar"));
+
+  // Conflicts with a write outside of a transaction
+  std::unique_ptr<Transaction> txn(txn_db->BeginTransaction(write_options));
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_OK(txn->Put("foo2", "bar2"));
+  ASSERT_OK(txn_db->Put(write_options, "foo", "barz"));
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  ASSERT_OK(txn->Rollback());
+
+  // Conflicts with a write batch
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("foo2", "bar"));
+  ASSERT_OK(batch.Delete("foo"));
+  ASSERT_OK(txn_db->Write(write_options, &batch));
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  ASSERT_OK(txn->Rollback());
+
+  // Conflicts with another transaction
+  std::unique_ptr<Transaction> txn2(txn_db->BeginTransaction(write_options));
+  ASSERT_TRUE(txn->GetForUpdate(read_options, "foo", &value).IsNotFound());
+  ASSERT_OK(txn->Put("foo2", "bar2"));
+  ASSERT_OK(txn2->Put("foo", "bar3"));
+  ASSERT_OK(txn2->Commit());
+  ASSERT_TRUE(txn->Commit().IsBusy());
+  ASSERT_OK(txn->Rollback());
+
+  // No conflict, even with the writes flushed out of the memtable history
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_EQ(value, "bar3");
+  ASSERT_OK(txn->Put("foo", "bar4"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(txn_db->Put(write_options, "dummy", std::to_string(i)));
+    ASSERT_OK(txn_db->Flush(FlushOptions()));
+  }
+  // Without the table, the memtable history may be too short to tell
+  Status s = txn->Commit();
+  ASSERT_TRUE(s.ok() || (!use_recent_writes && s.IsTryAgain()));
+}
+
 // Trigger the condition where some old memtables are skipped when doing
 // TransactionUtil::CheckKey(), and make sure the result is still correct.
 TEST_P(OptimisticTransactionTest, CheckKeySkipOldMemtable) {
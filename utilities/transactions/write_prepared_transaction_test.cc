@@ -1079,6 +1079,57 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
   }
 }
 
+TEST_P(WritePreparedTransactionTest, AddCommittedBatch) {
+  const size_t snapshot_cache_bits = 0;
+  const size_t commit_cache_bits = 2;
+  DBImpl* mock_db = new DBImpl(options, dbname);
+  UpdateTransactionDBOptions(snapshot_cache_bits, commit_cache_bits);
+  std::unique_ptr<WritePreparedTxnDBMock> wp_db(
+      new WritePreparedTxnDBMock(mock_db, txn_db_options));
+  const size_t size = wp_db->COMMIT_CACHE_SIZE;
+  ASSERT_EQ(4, size);
+
+  // A snapshot in the middle of the first batch
+  const SequenceNumber prep_seq = 1;
+  const size_t batch_cnt = 6;
+  for (size_t i = 0; i < batch_cnt; i++) {
+    wp_db->AddPrepared(prep_seq + i);
+  }
+  const SequenceNumber snap_seq = 3;
+  wp_db->TakeSnapshot(snap_seq);
+  SequenceNumber commit_seq = prep_seq + batch_cnt;
+  // More entries than the commit cache has: the last ones evict the first
+  wp_db->AddCommittedBatch(prep_seq, batch_cnt, commit_seq);
+  wp_db->RemovePrepared(prep_seq, batch_cnt);
+  ASSERT_EQ(commit_seq, wp_db->max_evicted_seq_.load());
+  CommitEntry64b dont_care;
+  CommitEntry e;
+  for (size_t i = batch_cnt - size; i < batch_cnt; i++) {
+    ASSERT_TRUE(wp_db->GetCommitEntry((prep_seq + i) % size, &dont_care, &e));
+    ASSERT_EQ(CommitEntry(prep_seq + i, commit_seq), e);
+  }
+  // The evicted entries prepared before the snapshot are kept for it
+  {
+    ReadLock rl(&wp_db->old_commit_map_mutex_);
+    ASSERT_EQ(2, UniqueCnt(wp_db->old_commit_map_[snap_seq]));
+  }
+
+  // A second batch evicts the rest of the first one at once
+  const SequenceNumber prep_seq2 = commit_seq + 1;
+  for (size_t i = 0; i < size; i++) {
+    wp_db->AddPrepared(prep_seq2 + i);
+  }
+  const SequenceNumber commit_seq2 = prep_seq2 + size;
+  wp_db->AddCommittedBatch(prep_seq2, size, commit_seq2);
+  wp_db->RemovePrepared(prep_seq2, size);
+  ASSERT_EQ(commit_seq, wp_db->max_evicted_seq_.load());
+  for (size_t i = 0; i < size; i++) {
+    ASSERT_TRUE(wp_db->GetCommitEntry((prep_seq2 + i) % size, &dont_care, &e));
+    ASSERT_EQ(CommitEntry(prep_seq2 + i, commit_seq2), e);
+  }
+  wp_db->ReleaseSnapshotInternal(snap_seq);
+}
+
 TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshots) {
   std::vector<SequenceNumber> snapshots = {100l, 200l, 300l, 400l, 500l,
                                            600l, 700l, 800l, 900l};
@@ -19,6 +19,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "test_util/sync_point.h"
+#include "util/autovector.h"
 #include "util/cast_util.h"
 #include "util/mutexlock.h"
 #include "util/string_util.h"
@@ -584,23 +585,7 @@ void WritePreparedTxnDB::AddCommitted(uint64_t prepare_seq, uint64_t commit_seq,
                       "Evicting %" PRIu64 ",%" PRIu64 " with max %" PRIu64,
                       evicted.prep_seq, evicted.commit_seq, prev_max);
     if (prev_max < evicted.commit_seq) {
-      auto last = db_impl_->GetLastPublishedSequence();  // could be 0
-      SequenceNumber max_evicted_seq;
-      if (LIKELY(evicted.commit_seq < last)) {
-        assert(last > 0);
-        // Inc max in larger steps to avoid frequent updates
-        max_evicted_seq =
-            std::min(evicted.commit_seq + INC_STEP_FOR_MAX_EVICTED, last - 1);
-      } else {
-        // legit when a commit entry in a write batch overwrite the previous one
-        max_evicted_seq = evicted.commit_seq;
-      }
-#ifdef OS_LINUX
-      if (rocksdb_write_prepared_TEST_ShouldClearCommitCache &&
-          rocksdb_write_prepared_TEST_ShouldClearCommitCache()) {
-        max_evicted_seq = last;
-      }
-#endif  // OS_LINUX
+      SequenceNumber max_evicted_seq = NextMaxEvictedSeq(evicted.commit_seq);
       ROCKS_LOG_DETAILS(info_log_,
                         "%lu Evicting %" PRIu64 ",%" PRIu64 " with max %" PRIu64
                         " => %lu",
@@ -644,6 +629,101 @@ void WritePreparedTxnDB::AddCommitted(uint64_t prepare_seq, uint64_t commit_seq,
   TEST_SYNC_POINT("WritePreparedTxnDB::AddCommitted:end:pause");
 }
 
+void WritePreparedTxnDB::AddCommittedBatch(uint64_t prepare_seq,
+                                           size_t batch_cnt,
+                                           uint64_t commit_seq) {
+  if (batch_cnt == 1) {
+    AddCommitted(prepare_seq, commit_seq);
+    return;
+  }
+  ROCKS_LOG_DETAILS(info_log_,
+                    "Txn %" PRIu64 " cnt: %" ROCKSDB_PRIszt
+                    " Committing with %" PRIu64,
+                    prepare_seq, batch_cnt, commit_seq);
+  struct Eviction {
+    CommitEntry64b evicted_64b;
+    CommitEntry evicted;
+    bool to_be_evicted;
+  };
+  while (batch_cnt > 0) {
+    // Consecutive sequence numbers have distinct commit cache entries
+    const size_t cnt = std::min(batch_cnt, COMMIT_CACHE_SIZE);
+    autovector<Eviction> evictions;
+    evictions.resize(cnt);
+    bool any_evicted = false;
+    SequenceNumber max_evicted_commit_seq = 0;
+    for (size_t i = 0; i < cnt; i++) {
+      Eviction& e = evictions[i];
+      e.to_be_evicted = GetCommitEntry((prepare_seq + i) % COMMIT_CACHE_SIZE,
+                                       &e.evicted_64b, &e.evicted);
+      if (e.to_be_evicted) {
+        assert(e.evicted.prep_seq != prepare_seq + i);
+        any_evicted = true;
+        max_evicted_commit_seq =
+            std::max(max_evicted_commit_seq, e.evicted.commit_seq);
+      }
+    }
+    if (any_evicted) {
+      auto prev_max = max_evicted_seq_.load(std::memory_order_acquire);
+      if (prev_max < max_evicted_commit_seq) {
+        AdvanceMaxEvictedSeq(prev_max,
+                             NextMaxEvictedSeq(max_evicted_commit_seq));
+      }
+      if (UNLIKELY(!delayed_prepared_empty_.load(std::memory_order_acquire))) {
+        WriteLock wl(&prepared_mutex_);
+        for (const Eviction& e : evictions) {
+          if (e.to_be_evicted &&
+              delayed_prepared_.find(e.evicted.prep_seq) !=
+                  delayed_prepared_.end()) {
+            // Refer to delayed_prepared_commits_ definition for why it should
+            // be kept updated.
+            delayed_prepared_commits_[e.evicted.prep_seq] =
+                e.evicted.commit_seq;
+          }
+        }
+      }
+      for (const Eviction& e : evictions) {
+        if (e.to_be_evicted) {
+          CheckAgainstSnapshots(e.evicted);
+        }
+      }
+    }
+    for (size_t i = 0; i < cnt; i++) {
+      bool succ = ExchangeCommitEntry((prepare_seq + i) % COMMIT_CACHE_SIZE,
+                                      evictions[i].evicted_64b,
+                                      {prepare_seq + i, commit_seq});
+      if (UNLIKELY(!succ)) {
+        // The commit entry was updated before we did: start over for it
+        AddCommitted(prepare_seq + i, commit_seq, 1);
+      }
+    }
+    prepare_seq += cnt;
+    batch_cnt -= cnt;
+  }
+}
+
+SequenceNumber WritePreparedTxnDB::NextMaxEvictedSeq(
+    SequenceNumber evicted_commit_seq) {
+  auto last = db_impl_->GetLastPublishedSequence();  // could be 0
+  SequenceNumber max_evicted_seq;
+  if (LIKELY(evicted_commit_seq < last)) {
+    assert(last > 0);
+    // Inc max in larger steps to avoid frequent updates
+    max_evicted_seq =
+        std::min(evicted_commit_seq + INC_STEP_FOR_MAX_EVICTED, last - 1);
+  } else {
+    // legit when a commit entry in a write batch overwrite the previous one
+    max_evicted_seq = evicted_commit_seq;
+  }
+#ifdef OS_LINUX
+  if (rocksdb_write_prepared_TEST_ShouldClearCommitCache &&
+      rocksdb_write_prepared_TEST_ShouldClearCommitCache()) {
+    max_evicted_seq = last;
+  }
+#endif  // OS_LINUX
+  return max_evicted_seq;
+}
+
 void WritePreparedTxnDB::RemovePrepared(const uint64_t prepare_seq,
                                         const size_t batch_cnt) {
   TEST_SYNC_POINT_CALLBACK(
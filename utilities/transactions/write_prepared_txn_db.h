@@ -333,6 +333,13 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   // Note: must be called serially.
   void AddCommitted(uint64_t prepare_seq, uint64_t commit_seq,
                     uint8_t loop_cnt = 0);
+  // Same as calling AddCommitted(prepare_seq + i, commit_seq) for each i in
+  // [0, batch_cnt), but reads the commit cache entries to evict up front so
+  // that max_evicted_seq_ is advanced, and delayed_prepared_ is checked, once
+  // for the whole batch rather than once per entry.
+  // Note: must be called serially.
+  void AddCommittedBatch(uint64_t prepare_seq, size_t batch_cnt,
+                         uint64_t commit_seq);
 
   struct CommitEntry {
     uint64_t prep_seq;
@@ -480,6 +487,7 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   friend class WritePreparedTransactionTestBase;
   friend class WritePreparedTxn;
   friend class WritePreparedTxnDBMock;
+  friend class WritePreparedTransactionTest_AddCommittedBatch_Test;
   friend class WritePreparedTransactionTest_AddPreparedBeforeMax_Test;
   friend class WritePreparedTransactionTest_AdvanceMaxEvictedSeqBasic_Test;
   friend class
@@ -646,6 +654,10 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   void AdvanceMaxEvictedSeq(const SequenceNumber& prev_max,
                             const SequenceNumber& new_max);
 
+  // Returns the value to advance max_evicted_seq_ to once a commit entry with
+  // evicted_commit_seq is evicted from the commit cache
+  SequenceNumber NextMaxEvictedSeq(SequenceNumber evicted_commit_seq);
+
   inline SequenceNumber SmallestUnCommittedSeq() {
     // Note: We have two lists to look into, but for performance reasons they
     // are not read atomically. Since CheckPreparedAgainstMax copies the entry
@@ -954,24 +966,18 @@ class WritePreparedCommitEntryPreReleaseCallback : public PreReleaseCallback {
                                          ? commit_seq
                                          : commit_seq + data_batch_cnt_ - 1;
     if (prep_seq_ != kMaxSequenceNumber) {
-      for (size_t i = 0; i < prep_batch_cnt_; i++) {
-        db_->AddCommitted(prep_seq_ + i, last_commit_seq);
-      }
+      db_->AddCommittedBatch(prep_seq_, prep_batch_cnt_, last_commit_seq);
     }  // else there was no prepare phase
     if (includes_aux_batch_) {
-      for (size_t i = 0; i < aux_batch_cnt_; i++) {
-        db_->AddCommitted(aux_seq_ + i, last_commit_seq);
-      }
+      db_->AddCommittedBatch(aux_seq_, aux_batch_cnt_, last_commit_seq);
     }
     if (includes_data_) {
       assert(data_batch_cnt_);
-      // Commit the data that is accompanied with the commit request
-      for (size_t i = 0; i < data_batch_cnt_; i++) {
-        // For commit seq of each batch use the commit seq of the last batch.
-        // This would make debugging easier by having all the batches having
-        // the same sequence number.
-        db_->AddCommitted(commit_seq + i, last_commit_seq);
-      }
+      // Commit the data that is accompanied with the commit request. For
+      // commit seq of each batch use the commit seq of the last batch. This
+      // would make debugging easier by having all the batches having the same
+      // sequence number.
+      db_->AddCommittedBatch(commit_seq, data_batch_cnt_, last_commit_seq);
     }
     if (db_impl_->immutable_db_options().two_write_queues) {
       assert(is_mem_disabled);  // implies the 2nd queue
@@ -1042,9 +1048,7 @@ class WritePreparedRollbackPreReleaseCallback : public PreReleaseCallback {
 #endif
     const uint64_t last_commit_seq = commit_seq;
     db_->AddCommitted(rollback_seq_, last_commit_seq);
-    for (size_t i = 0; i < prep_batch_cnt_; i++) {
-      db_->AddCommitted(prep_seq_ + i, last_commit_seq);
-    }
+    db_->AddCommittedBatch(prep_seq_, prep_batch_cnt_, last_commit_seq);
     db_impl_->SetLastPublishedSequence(last_commit_seq);
     return Status::OK();
   }
@@ -169,6 +169,50 @@ void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
     options->merge_operator.reset(
         new TtlMergeOperator(options->merge_operator, clock));
   }
+
+  options->table_properties_collector_factories.push_back(
+      std::make_shared<TtlTablePropertiesCollectorFactory>());
+}
+
+Status TtlTablePropertiesCollector::AddUserKey(const Slice& /*key*/,
+                                               const Slice& value,
+                                               EntryType type,
+                                               SequenceNumber /*seq*/,
+                                               uint64_t /*file_size*/) {
+  if ((type != kEntryPut && type != kEntryMerge) ||
+      value.size() < DBWithTTLImpl::kTSLength) {
+    all_timestamped_ = false;
+    return Status::OK();
+  }
+  int32_t timestamp = static_cast<int32_t>(DecodeFixed32(
+      value.data() + value.size() - DBWithTTLImpl::kTSLength));
+  min_timestamp_ = std::min(min_timestamp_, timestamp);
+  max_timestamp_ = std::max(max_timestamp_, timestamp);
+  return Status::OK();
+}
+
+Status TtlTablePropertiesCollector::Finish(
+    UserCollectedProperties* properties) {
+  if (!all_timestamped_ || max_timestamp_ < min_timestamp_) {
+    return Status::OK();
+  }
+  std::string encoded;
+  PutFixed32(&encoded, static_cast<uint32_t>(min_timestamp_));
+  properties->emplace(kMinTimestampProperty(), encoded);
+  encoded.clear();
+  PutFixed32(&encoded, static_cast<uint32_t>(max_timestamp_));
+  properties->emplace(kMaxTimestampProperty(), encoded);
+  return Status::OK();
+}
+
+UserCollectedProperties TtlTablePropertiesCollector::GetReadableProperties()
+    const {
+  UserCollectedProperties readable;
+  if (all_timestamped_ && max_timestamp_ >= min_timestamp_) {
+    readable.emplace(kMinTimestampProperty(), std::to_string(min_timestamp_));
+    readable.emplace(kMaxTimestampProperty(), std::to_string(max_timestamp_));
+  }
+  return readable;
 }
 
 static std::unordered_map<std::string, OptionTypeInfo> ttl_type_info = {
@@ -635,4 +679,64 @@ void DBWithTTLImpl::SetTtl(ColumnFamilyHandle* h, int32_t ttl) {
   filter->SetTtl(ttl);
 }
 
+int32_t DBWithTTLImpl::GetTtl(ColumnFamilyHandle* h) {
+  Options opts = GetOptions(h);
+  if (opts.compaction_filter != nullptr) {
+    auto filter = opts.compaction_filter->CheckedCast<TtlCompactionFilter>();
+    return filter != nullptr ? filter->GetTtl() : 0;
+  }
+  if (opts.compaction_filter_factory != nullptr) {
+    auto factory = opts.compaction_filter_factory
+                       ->CheckedCast<TtlCompactionFilterFactory>();
+    return factory != nullptr ? factory->GetTtl() : 0;
+  }
+  return 0;
+}
+
+Status DBWithTTLImpl::DropExpiredFiles(ColumnFamilyHandle* h) {
+  int32_t ttl = GetTtl(h);
+  if (ttl <= 0) {  // Data is fresh if TTL is non-positive
+    return Status::OK();
+  }
+  int64_t curtime;
+  Status s = GetEnv()->GetSystemClock()->GetCurrentTime(&curtime);
+  if (!s.ok()) {
+    return s;
+  }
+
+  TablePropertiesCollection props;
+  s = GetPropertiesOfAllTables(h, &props);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<uint64_t> expired_files;
+  for (const auto& file_and_props : props) {
+    const auto& user_props = file_and_props.second->user_collected_properties;
+    auto max_timestamp =
+        user_props.find(TtlTablePropertiesCollector::kMaxTimestampProperty());
+    if (max_timestamp == user_props.end() ||
+        max_timestamp->second.size() != kTSLength) {
+      continue;
+    }
+    int64_t timestamp_value = static_cast<int32_t>(
+        DecodeFixed32(max_timestamp->second.data()));
+    if (timestamp_value + ttl >= curtime) {
+      continue;
+    }
+    const std::string& path = file_and_props.first;
+    uint64_t number;
+    FileType type;
+    if (ParseFileName(path.substr(path.find_last_of('/') + 1), &number,
+                      &type) &&
+        type == kTableFile) {
+      expired_files.push_back(number);
+    }
+  }
+  if (expired_files.empty()) {
+    return Status::OK();
+  }
+  auto db_impl = static_cast_with_check<DBImpl>(GetRootDB());
+  return db_impl->DeleteTableFiles(h, expired_files);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
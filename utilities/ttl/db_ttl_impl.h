@@ -14,6 +14,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/system_clock.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "utilities/compaction_filters/layered_compaction_filter_base.h"
 
@@ -100,7 +101,17 @@ class DBWithTTLImpl : public DBWithTTL {
 
   void SetTtl(ColumnFamilyHandle* h, int32_t ttl) override;
 
+  Status DropExpiredFiles() override {
+    return DropExpiredFiles(DefaultColumnFamily());
+  }
+
+  Status DropExpiredFiles(ColumnFamilyHandle* h) override;
+
  private:
+  // Returns the TTL the column family was opened with or last set to, or 0
+  // if it has none
+  int32_t GetTtl(ColumnFamilyHandle* h);
+
   // remember whether the Close completes or not
   bool closed_;
 };
@@ -170,6 +181,8 @@ class TtlCompactionFilter : public LayeredCompactionFilterBase {
   Status ValidateOptions(const DBOptions& db_opts,
                          const ColumnFamilyOptions& cf_opts) const override;
 
+  int32_t GetTtl() const { return ttl_; }
+
  private:
   int32_t ttl_;
   SystemClock* clock_;
@@ -184,6 +197,7 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
   std::unique_ptr<CompactionFilter> CreateCompactionFilter(
       const CompactionFilter::Context& context) override;
   void SetTtl(int32_t ttl) { ttl_ = ttl; }
+  int32_t GetTtl() const { return ttl_; }
 
   const char* Name() const override { return kClassName(); }
   static const char* kClassName() { return "TtlCompactionFilterFactory"; }
@@ -200,6 +214,49 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
   std::shared_ptr<CompactionFilterFactory> user_comp_filter_factory_;
 };
 
+// Records the range of the timestamps of the values of a table file, so that
+// DBWithTTL::DropExpiredFiles() can tell whether all of them have expired
+// without reading the file. The properties are only written if all the
+// entries of the file are timestamped puts and merges: dropping a file with a
+// deletion could bring back the older versions of its keys.
+class TtlTablePropertiesCollector : public TablePropertiesCollector {
+ public:
+  Status AddUserKey(const Slice& key, const Slice& value, EntryType type,
+                    SequenceNumber seq, uint64_t file_size) override;
+
+  Status Finish(UserCollectedProperties* properties) override;
+
+  UserCollectedProperties GetReadableProperties() const override;
+
+  const char* Name() const override { return "TtlTablePropertiesCollector"; }
+
+  static const char* kMinTimestampProperty() {
+    return "rocksdb.ttl.min.timestamp";
+  }
+  static const char* kMaxTimestampProperty() {
+    return "rocksdb.ttl.max.timestamp";
+  }
+
+ private:
+  int32_t min_timestamp_ = DBWithTTLImpl::kMaxTimestamp;
+  int32_t max_timestamp_ = 0;
+  bool all_timestamped_ = true;
+};
+
+class TtlTablePropertiesCollectorFactory
+    : public TablePropertiesCollectorFactory {
+ public:
+  TablePropertiesCollector* CreateTablePropertiesCollector(
+      TablePropertiesCollectorFactory::Context /*context*/) override {
+    return new TtlTablePropertiesCollector();
+  }
+
+  const char* Name() const override { return kClassName(); }
+  static const char* kClassName() {
+    return "TtlTablePropertiesCollectorFactory";
+  }
+};
+
 class TtlMergeOperator : public MergeOperator {
  public:
   explicit TtlMergeOperator(const std::shared_ptr<MergeOperator>& merge_op,
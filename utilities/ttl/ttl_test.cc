@@ -574,6 +574,39 @@ TEST_F(TtlTest, ReadOnlyPresentForever) {
   CloseTtl();
 }
 
+// Drops the files whose values have all expired, but not a file with a
+// deletion
+TEST_F(TtlTest, DropExpiredFiles) {
+  MakeKVMap(kSampleSize_);
+  int64_t boundary = kSampleSize_ / 2;
+  options_.disable_auto_compactions = true;
+
+  OpenTtl(2);
+  PutValues(0, boundary);  // T=0: Set1 expires at t=2
+  env_->Sleep(2);
+  PutValues(boundary, kSampleSize_ - boundary);  // T=2: Set2 expires at t=4
+  auto num_files = [&]() {
+    std::vector<LiveFileMetaData> metadata;
+    db_ttl_->GetLiveFilesMetaData(&metadata);
+    return metadata.size();
+  };
+  ASSERT_EQ(num_files(), 2U);
+
+  env_->Sleep(1);  // T=3
+  ASSERT_OK(db_ttl_->DropExpiredFiles());
+  ASSERT_EQ(num_files(), 1U);
+  CompactCheck(0, boundary, false);
+  CompactCheck(boundary, kSampleSize_ - boundary);
+
+  ASSERT_OK(db_ttl_->Delete(WriteOptions(), "keymock"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  env_->Sleep(5);  // T=8: Set2 expired, the deletion is not dropped
+  ASSERT_OK(db_ttl_->DropExpiredFiles());
+  ASSERT_EQ(num_files(), 1U);
+  CompactCheck(0, kSampleSize_, false);
+  CloseTtl();
+}
+
 // Checks whether WriteBatch works well with TTL
 // Puts all kvs in kvmap_ in a batch and writes first, then deletes first half
 TEST_F(TtlTest, WriteBatchTest) {
@@ -164,7 +164,8 @@ void WriteBatchWithIndex::Rep::AddNewEntry(uint32_t column_family_id) {
   auto* mem = arena.Allocate(sizeof(WriteBatchIndexEntry));
   auto* index_entry =
       new (mem) WriteBatchIndexEntry(last_entry_offset, column_family_id,
-                                     key.data() - wb_data.data(), key.size());
+                                     key.data() - wb_data.data(), key.size(),
+                                     WriteBatchIndexEntry::KeyPrefix(key));
   skip_list.Insert(index_entry);
 }
 
@@ -641,6 +641,12 @@ int WriteBatchEntryComparator::operator()(
     return 1;
   }
 
+  const Comparator* const ucmp = GetComparator(entry1->column_family);
+  if (ucmp == bytewise_comparator_ &&
+      entry1->key_prefix != entry2->key_prefix) {
+    return entry1->key_prefix < entry2->key_prefix ? -1 : 1;
+  }
+
   Slice key1, key2;
   if (entry1->search_key == nullptr) {
     key1 = Slice(write_batch_->Data().data() + entry1->key_offset,
@@ -655,7 +661,8 @@ int WriteBatchEntryComparator::operator()(
     key2 = *(entry2->search_key);
   }
 
-  int cmp = CompareKey(entry1->column_family, key1, key2);
+  int cmp = ucmp->CompareWithoutTimestamp(key1, /*a_has_ts=*/false, key2,
+                                          /*b_has_ts=*/false);
   if (cmp != 0) {
     return cmp;
   } else if (entry1->offset > entry2->offset) {
@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #pragma once
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
@@ -82,11 +83,13 @@ class BaseDeltaIterator : public Iterator {
 
 // Key used by skip list, as the binary searchable index of WriteBatchWithIndex.
 struct WriteBatchIndexEntry {
-  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz)
+  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz,
+                       uint64_t kp)
       : offset(o),
         column_family(c),
         key_offset(ko),
         key_size(ksz),
+        key_prefix(kp),
         search_key(nullptr) {}
   // Create a dummy entry as the search key. This index entry won't be backed
   // by an entry from the write batch, but a pointer to the search key. Or a
@@ -104,10 +107,23 @@ struct WriteBatchIndexEntry {
         column_family(_column_family),
         key_offset(0),
         key_size(is_seek_to_first ? kFlagMinInCf : 0),
+        key_prefix(_search_key ? KeyPrefix(*_search_key) : 0),
         search_key(_search_key) {
     assert(_search_key != nullptr || is_seek_to_first);
   }
 
+  // Returns the first 8 bytes of key, zero-padded, as a big-endian integer,
+  // which orders keys like their bytes, except that keys may have the same
+  // prefix without being equal
+  static uint64_t KeyPrefix(const Slice& key) {
+    uint64_t prefix = 0;
+    const size_t n = std::min(key.size(), sizeof(prefix));
+    for (size_t i = 0; i < n; i++) {
+      prefix |= uint64_t{static_cast<uint8_t>(key[i])} << (56 - 8 * i);
+    }
+    return prefix;
+  }
+
   // If this flag appears in the key_size, it indicates a
   // key that is smaller than any other entry for the same column family.
   static const size_t kFlagMinInCf = std::numeric_limits<size_t>::max();
@@ -134,6 +150,9 @@ struct WriteBatchIndexEntry {
                            // SeekToFirst() to the beginning of the column
                            // family. We use the flag here to save a boolean
                            // in the struct.
+  uint64_t key_prefix;     // KeyPrefix() of the key, which the comparator
+                           // compares first for a bytewise column family,
+                           // without reading the write batch.
 
   const Slice* search_key;  // if not null, instead of reading keys from
                             // write batch, use it to compare. This is used
@@ -157,7 +176,9 @@ class WriteBatchEntryComparator {
  public:
   WriteBatchEntryComparator(const Comparator* _default_comparator,
                             const ReadableWriteBatch* write_batch)
-      : default_comparator_(_default_comparator), write_batch_(write_batch) {}
+      : default_comparator_(_default_comparator),
+        bytewise_comparator_(BytewiseComparator()),
+        write_batch_(write_batch) {}
   // Compare a and b. Return a negative value if a is less than b, 0 if they
   // are equal, and a positive value if a is greater than b
   int operator()(const WriteBatchIndexEntry* entry1,
@@ -183,6 +204,7 @@ class WriteBatchEntryComparator {
 
  private:
   const Comparator* const default_comparator_;
+  const Comparator* const bytewise_comparator_;
   std::vector<const Comparator*> cf_comparators_;
   const ReadableWriteBatch* const write_batch_;
 };
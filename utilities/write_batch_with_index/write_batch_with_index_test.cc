@@ -9,6 +9,7 @@
 
 #include "rocksdb/utilities/write_batch_with_index.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 
@@ -804,6 +805,49 @@ TEST_P(WriteBatchWithIndexTest, TestWBWIIterator) {
   AssertIterEqual(iter2.get(), {"a", "b", "d", "f"});
 }
 
+TEST_P(WriteBatchWithIndexTest, TestKeyPrefixOrder) {
+  // Keys sharing their first 8 bytes, shorter than that, or with bytes that
+  // are negative as chars
+  std::vector<std::string> keys = {"",
+                                   "a",
+                                   std::string("a\0", 2),
+                                   std::string("a\0\0\0\0\0\0\0\0", 9),
+                                   "abcdefg",
+                                   "abcdefgh",
+                                   "abcdefgh\x01",
+                                   "abcdefgh\xff",
+                                   "abcdefgi",
+                                   "\x7f\xff",
+                                   "\x80",
+                                   "\xff",
+                                   "\xff\xff\xff\xff\xff\xff\xff\xff\xff"};
+  ColumnFamilyHandleImplDummy cf1(1, BytewiseComparator());
+  ColumnFamilyHandleImplDummy cf2(2, ReverseBytewiseComparator());
+  for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+    ASSERT_OK(batch_->Put(&cf1, *it, "v"));
+    ASSERT_OK(batch_->Put(&cf2, *it, "v"));
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const std::string& a, const std::string& b) {
+              return BytewiseComparator()->Compare(a, b) < 0;
+            });
+  std::unique_ptr<WBWIIteratorImpl> iter1(
+      static_cast<WBWIIteratorImpl*>(batch_->NewIterator(&cf1)));
+  AssertIterEqual(iter1.get(), keys);
+  std::reverse(keys.begin(), keys.end());
+  std::unique_ptr<WBWIIteratorImpl> iter2(
+      static_cast<WBWIIteratorImpl*>(batch_->NewIterator(&cf2)));
+  AssertIterEqual(iter2.get(), keys);
+
+  // Seek to keys sharing their prefix with others
+  iter1->Seek("abcdefgh\x02");
+  ASSERT_TRUE(iter1->Valid());
+  ASSERT_EQ("abcdefgh\xff", iter1->Entry().key);
+  iter1->SeekForPrev("abcdefgh\x02");
+  ASSERT_TRUE(iter1->Valid());
+  ASSERT_EQ("abcdefgh\x01", iter1->Entry().key);
+}
+
 TEST_P(WriteBatchWithIndexTest, TestRandomIteraratorWithBase) {
   std::vector<std::string> source_strings = {"a", "b", "c", "d", "e",
                                              "f", "g", "h", "i", "j"};